@@ -0,0 +1,591 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Microbenchmarks of the hot functions of the vehicle modules.
+//
+// Usage: bench_micro [output file] [filter] [repetitions] [min time]
+//
+// Each benchmark times a loop over one call (or one short sequence of calls)
+// of a function, in the style of Google Benchmark: the number of iterations is
+// first grown until a run lasts at least the minimum time (default: 0.1 s),
+// then the run is repeated (default: 10 times). The setup of a benchmark is
+// not timed. For each benchmark, the mean, median, standard deviation and
+// coefficient of variation of the time per iteration over the repetitions are
+// printed (compare the medians; a large variation means a noisy machine).
+//
+// All repetitions and their aggregates are written as JSON (default:
+// bench_micro.json) in the format of Google Benchmark, so that the results of
+// two commits can be compared with its tools/compare.py:
+//   compare.py benchmarks old.json new.json
+// If a filter is given, only the benchmarks with names containing it are run.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "physics/ChGlobal.h"
+#include "physics/ChSystem.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/vehicle/Vehicle.h"
+#include "subsys/driver/ChDataDriver.h"
+#include "subsys/tire/LugreTire.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/FlatTerrain.h"
+#include "subsys/terrain/RoadProfileTerrain.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+using namespace chrono;
+using vehicle::ChProfiler;
+
+// =============================================================================
+// Benchmark harness
+// =============================================================================
+
+// Keep the compiler from discarding the computation of the specified value.
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+// Loop state of a benchmark run: the timed loop is
+//   while (state.KeepRunning()) { ... }
+// and the code before the loop (setup) and after it is not timed.
+class BenchState
+{
+public:
+  BenchState(long iterations)
+  : m_iterations(iterations), m_remaining(iterations), m_started(false),
+    m_real_time(0), m_cpu_time(0)
+  {}
+
+  bool KeepRunning()
+  {
+    if (m_remaining > 0) {
+      if (!m_started)
+        start();
+      m_remaining--;
+      return true;
+    }
+    stop();
+    return false;
+  }
+
+  long GetIterations() const { return m_iterations; }
+
+  // Index of the current iteration.
+  long GetIndex() const { return m_iterations - m_remaining - 1; }
+
+  double GetRealTime() const { return m_real_time; }
+  double GetCpuTime() const { return m_cpu_time; }
+
+private:
+  void start()
+  {
+    m_started = true;
+    m_cpu_time = (double)std::clock() / CLOCKS_PER_SEC;
+    m_real_time = ChProfiler::GetTime();
+  }
+
+  void stop()
+  {
+    m_real_time = ChProfiler::GetTime() - m_real_time;
+    m_cpu_time = (double)std::clock() / CLOCKS_PER_SEC - m_cpu_time;
+  }
+
+  long    m_iterations;
+  long    m_remaining;
+  bool    m_started;
+  double  m_real_time;   // start time, then elapsed time, in seconds
+  double  m_cpu_time;
+};
+
+typedef void (*BenchFunction)(BenchState& state);
+
+struct Benchmark {
+  const char*    name;
+  BenchFunction  function;
+};
+
+// Time per iteration of one repetition, in nanoseconds.
+struct Run {
+  double  real_time;
+  double  cpu_time;
+};
+
+static const long MAX_ITERATIONS = 1000000000L;
+
+// Number of iterations of a run lasting at least the specified time.
+static long calibrate(BenchFunction function, double min_time)
+{
+  long n = 1;
+  for (;;) {
+    BenchState state(n);
+    function(state);
+    double t = state.GetRealTime();
+    if (t >= min_time || n >= MAX_ITERATIONS)
+      return n;
+
+    // Aim past the minimum time, growing at most tenfold per run.
+    double mult = (t > 0.1 * min_time) ? 1.4 * min_time / t : 10;
+    n = (long)std::min(std::ceil(n * std::max(mult, 1.1)), (double)MAX_ITERATIONS);
+  }
+}
+
+// =============================================================================
+// Benchmark fixtures
+// =============================================================================
+
+// Radius of the HMMWV tires.
+static const double tire_radius = 0.47;
+
+// State of a wheel rolling at 10 m/s along the x axis, with slowly varying
+// slip angle and longitudinal slip, at a depth of 1 cm below the terrain.
+static void rolling_wheel_state(double time, ChWheelState& state)
+{
+  double speed = 10;
+  double alpha = 0.05 * std::sin(2 * CH_C_PI * 0.5 * time);
+  double kappa = 0.05 * std::sin(2 * CH_C_PI * 0.3 * time);
+
+  state.pos = ChVector<>(speed * time, 0, tire_radius - 0.01);
+  state.rot = Q_from_AngAxis(alpha, ChVector<>(0, 0, 1));
+  state.lin_vel = ChVector<>(speed, 0, 0);
+  state.omega = speed * (1 + kappa) / tire_radius;
+  state.ang_vel = state.rot.GetYaxis() * state.omega;
+}
+
+// Tire exposing the disc-terrain collision detection of the base class.
+class ContactProbe : public ChTire
+{
+public:
+  ContactProbe(const ChTerrain& terrain) : ChTire("probe", terrain) {}
+
+  virtual ChTireForce GetTireForce() const { return ChTireForce(); }
+
+  bool Contact(const ChVector<>& center, const ChVector<>& normal, double radius, ChCoordsys<>& contact,
+               double& depth)
+  {
+    return disc_terrain_contact(center, normal, radius, contact, depth);
+  }
+};
+
+// Long driver trace: one entry per millisecond over 1000 s.
+static const std::vector<ChDataDriver::Entry>& long_trace()
+{
+  static std::vector<ChDataDriver::Entry> data;
+  if (data.empty()) {
+    data.resize(1000000);
+    for (size_t i = 0; i < data.size(); i++) {
+      double t = 1e-3 * i;
+      data[i] = ChDataDriver::Entry(t, 0.2 * std::sin(0.3 * t), 0.5 + 0.5 * std::sin(0.1 * t), 0);
+    }
+  }
+  return data;
+}
+
+// Slider-crank mechanism of the slider_crank model, without visualization.
+static void build_slider_crank(ChSystem& system)
+{
+  system.Set_G_acc(ChVector<>(0, 0, -9.81));
+
+  ChQuaternion<> z2y;
+  z2y.Q_from_AngAxis(-CH_C_PI / 2, ChVector<>(1, 0, 0));
+
+  ChSharedBodyPtr ground(new ChBody);
+  system.AddBody(ground);
+  ground->SetBodyFixed(true);
+  ground->SetCollide(false);
+
+  ChSharedBodyPtr crank(new ChBody);
+  system.AddBody(crank);
+  crank->SetPos(ChVector<>(1, 0, 0));
+  crank->SetCollide(false);
+
+  ChSharedBodyPtr rod(new ChBody);
+  system.AddBody(rod);
+  rod->SetPos(ChVector<>(4, 0, 0));
+  rod->SetCollide(false);
+
+  ChSharedPtr<ChLinkLockRevolute> rev_crank_rod(new ChLinkLockRevolute);
+  rev_crank_rod->Initialize(crank, rod, ChCoordsys<>(ChVector<>(2, 0, 0), z2y));
+  system.AddLink(rev_crank_rod);
+
+  ChSharedPtr<ChLinkLockPointLine> slider_rod_ground(new ChLinkLockPointLine);
+  slider_rod_ground->Initialize(rod, ground, ChCoordsys<>(ChVector<>(6, 0, 0)));
+  system.AddLink(slider_rod_ground);
+
+  ChSharedPtr<ChLinkEngine> engine_ground_crank(new ChLinkEngine);
+  engine_ground_crank->Initialize(ground, crank, ChCoordsys<>(ChVector<>(0, 0, 0), z2y));
+  engine_ground_crank->Set_eng_mode(ChLinkEngine::ENG_MODE_SPEED);
+  if (ChSharedPtr<ChFunction_Const> mfun = engine_ground_crank->Get_spe_funct().DynamicCastTo<ChFunction_Const>())
+    mfun->Set_yconst(CH_C_PI);
+  system.AddLink(engine_ground_crank);
+}
+
+// =============================================================================
+// Benchmarks
+// =============================================================================
+
+static void disc_contact(BenchState& state, const ChTerrain& terrain)
+{
+  ContactProbe probe(terrain);
+  ChVector<> normal(0, 1, 0);
+  ChCoordsys<> contact;
+  double depth = 0;
+
+  while (state.KeepRunning()) {
+    ChVector<> center(0.013 * (state.GetIndex() % 50000), 0.7, tire_radius - 0.01);
+    bool in_contact = probe.Contact(center, normal, tire_radius, contact, depth);
+    do_not_optimize(in_contact);
+    do_not_optimize(contact);
+  }
+}
+
+static void bm_disc_contact_flat(BenchState& state)
+{
+  FlatTerrain terrain(0);
+  disc_contact(state, terrain);
+}
+
+static void bm_disc_contact_road(BenchState& state)
+{
+  RoadProfileTerrain terrain(RoadProfileTerrain::CLASS_C, 1);
+  disc_contact(state, terrain);
+}
+
+// One step of a Pacejka tire (Update and Advance), with a prescribed load.
+static void pacejka_step(BenchState& state, bool transient)
+{
+  FlatTerrain terrain(0);
+  ChPacejkaTire tire("W0", vehicle::GetDataFile("hmmwv/tire/HMMWV_pacejka.tir"), terrain, 8000.0, transient);
+  tire.Initialize(LEFT, false);
+
+  double step = 1e-3;
+  ChWheelState wheel_state;
+
+  while (state.KeepRunning()) {
+    double time = step * (state.GetIndex() % 100000);
+    rolling_wheel_state(time, wheel_state);
+    tire.Update(time, wheel_state);
+    tire.Advance(step);
+    do_not_optimize(tire.GetTireForceLocal());
+  }
+}
+
+static void bm_pacejka_transient(BenchState& state)
+{
+  pacejka_step(state, true);
+}
+
+static void bm_pacejka_steady(BenchState& state)
+{
+  pacejka_step(state, false);
+}
+
+// One step of a LuGre tire (Update and Advance).
+static void bm_lugre(BenchState& state)
+{
+  FlatTerrain terrain(0);
+  LugreTire tire(vehicle::GetDataFile("hmmwv/tire/HMMWV_LugreTire.json"), terrain);
+  tire.Initialize();
+
+  double step = 1e-3;
+  ChWheelState wheel_state;
+
+  while (state.KeepRunning()) {
+    double time = step * (state.GetIndex() % 100000);
+    rolling_wheel_state(time, wheel_state);
+    tire.Update(time, wheel_state);
+    tire.Advance(step);
+    ChTireForce force = tire.GetTireForce();
+    do_not_optimize(force);
+  }
+}
+
+// Driver queries at increasing times (amortized constant time).
+static void bm_data_driver_sequential(BenchState& state)
+{
+  ChDataDriver driver(long_trace());
+
+  while (state.KeepRunning()) {
+    driver.Update(1e-3 * 0.7 * (state.GetIndex() % 1400000));
+    do_not_optimize(driver.GetSteering());
+  }
+}
+
+// Driver queries at random times (binary search).
+static void bm_data_driver_random(BenchState& state)
+{
+  ChDataDriver driver(long_trace());
+  unsigned int seed = 12345;
+
+  while (state.KeepRunning()) {
+    seed = 1664525u * seed + 1013904223u;
+    driver.Update(1000.0 * (seed >> 8) / 16777216.0);
+    do_not_optimize(driver.GetSteering());
+  }
+}
+
+// One row of 8 values streamed to a file.
+static void csv_stream(BenchState& state, bool fast_float)
+{
+  const char* filename = "bench_micro.csv";
+  utils::CSV_writer csv(",");
+  csv.set_fast_float(fast_float);
+  if (!csv.open(filename)) {
+    while (state.KeepRunning()) {}
+    return;
+  }
+
+  while (state.KeepRunning()) {
+    double t = 1e-3 * state.GetIndex();
+    csv << t << 10.0 + std::sin(t) << 0.1 * t << 0.5 << std::sqrt(t) << 1.0 / (1 + t) << -t << 3.0 << std::endl;
+  }
+
+  csv.close();
+  std::remove(filename);
+}
+
+static void bm_csv_stream(BenchState& state)
+{
+  csv_stream(state, false);
+}
+
+static void bm_csv_stream_fast_float(BenchState& state)
+{
+  csv_stream(state, true);
+}
+
+static void bm_get_wheel_state(BenchState& state)
+{
+  Vehicle vehicle(vehicle::GetDataFile("hmmwv/vehicle/HMMWV_Vehicle.json"));
+  vehicle.Initialize(ChCoordsys<>(ChVector<>(0, 0, 1), QUNIT));
+
+  int num_wheels = 2 * vehicle.GetNumberAxles();
+  ChWheelState wheel_state;
+
+  while (state.KeepRunning()) {
+    vehicle.GetWheelState(ChWheelID((int)(state.GetIndex() % num_wheels)), wheel_state);
+    do_not_optimize(wheel_state);
+  }
+}
+
+static void bm_get_wheel_states(BenchState& state)
+{
+  Vehicle vehicle(vehicle::GetDataFile("hmmwv/vehicle/HMMWV_Vehicle.json"));
+  vehicle.Initialize(ChCoordsys<>(ChVector<>(0, 0, 1), QUNIT));
+
+  ChWheelStates wheel_states(2 * vehicle.GetNumberAxles());
+
+  while (state.KeepRunning()) {
+    vehicle.GetWheelStates(wheel_states);
+    do_not_optimize(wheel_states[0]);
+  }
+}
+
+// One step of the slider-crank mechanism (joint solver baseline).
+static void bm_slider_crank(BenchState& state)
+{
+  ChSystem system;
+  build_slider_crank(system);
+
+  while (state.KeepRunning())
+    system.DoStepDynamics(0.01);
+}
+
+// -----------------------------------------------------------------------------
+
+static const Benchmark s_benchmarks[] = {
+  { "ChTire::disc_terrain_contact/flat",     bm_disc_contact_flat },
+  { "ChTire::disc_terrain_contact/road",     bm_disc_contact_road },
+  { "ChPacejkaTire::Advance/transient",      bm_pacejka_transient },
+  { "ChPacejkaTire::Advance/steady_state",   bm_pacejka_steady },
+  { "ChLugreTire::Update_Advance",           bm_lugre },
+  { "ChDataDriver::Update/sequential",       bm_data_driver_sequential },
+  { "ChDataDriver::Update/random",           bm_data_driver_random },
+  { "CSV_writer/stream",                     bm_csv_stream },
+  { "CSV_writer/stream_fast_float",          bm_csv_stream_fast_float },
+  { "ChVehicle::GetWheelState",              bm_get_wheel_state },
+  { "ChVehicle::GetWheelStates",             bm_get_wheel_states },
+  { "slider_crank/DoStepDynamics",           bm_slider_crank }
+};
+
+// =============================================================================
+// Statistics and output
+// =============================================================================
+
+struct Stats {
+  double  mean;
+  double  median;
+  double  stddev;
+  double  cv;
+};
+
+static Stats get_stats(std::vector<double> values)
+{
+  Stats s;
+  size_t n = values.size();
+
+  double sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += values[i];
+  s.mean = sum / n;
+
+  double sq = 0;
+  for (size_t i = 0; i < n; i++)
+    sq += (values[i] - s.mean) * (values[i] - s.mean);
+  s.stddev = (n > 1) ? std::sqrt(sq / (n - 1)) : 0;
+  s.cv = (s.mean > 0) ? s.stddev / s.mean : 0;
+
+  std::sort(values.begin(), values.end());
+  s.median = (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+
+  return s;
+}
+
+static void write_entry(FILE* fp, bool& first, const char* name, const char* run_type, const char* aggregate,
+                        int repetitions, int index, long iterations, double real_time, double cpu_time)
+{
+  fprintf(fp, "%s    {\n", first ? "" : ",\n");
+  first = false;
+
+  if (aggregate)
+    fprintf(fp, "      \"name\": \"%s_%s\",\n", name, aggregate);
+  else
+    fprintf(fp, "      \"name\": \"%s\",\n", name);
+  fprintf(fp, "      \"run_name\": \"%s\",\n", name);
+  fprintf(fp, "      \"run_type\": \"%s\",\n", run_type);
+  fprintf(fp, "      \"repetitions\": %d,\n", repetitions);
+  if (aggregate) {
+    fprintf(fp, "      \"aggregate_name\": \"%s\",\n", aggregate);
+    if (std::strcmp(aggregate, "cv") == 0)
+      fprintf(fp, "      \"aggregate_unit\": \"percentage\",\n");
+  } else {
+    fprintf(fp, "      \"repetition_index\": %d,\n", index);
+  }
+  fprintf(fp, "      \"threads\": 1,\n");
+  fprintf(fp, "      \"iterations\": %ld,\n", iterations);
+  fprintf(fp, "      \"real_time\": %.6e,\n", real_time);
+  fprintf(fp, "      \"cpu_time\": %.6e,\n", cpu_time);
+  fprintf(fp, "      \"time_unit\": \"ns\"\n");
+  fprintf(fp, "    }");
+}
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  std::string out_file = (argc > 1) ? argv[1] : "bench_micro.json";
+  std::string filter = (argc > 2) ? argv[2] : "";
+  int repetitions = (argc > 3) ? std::max(std::atoi(argv[3]), 1) : 10;
+  double min_time = (argc > 4) ? std::atof(argv[4]) : 0.1;
+
+  FILE* fp = fopen(out_file.c_str(), "w");
+  if (!fp) {
+    printf("Cannot open output file %s\n", out_file.c_str());
+    return 1;
+  }
+
+  char date[64];
+  time_t now = time(0);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+  fprintf(fp, "{\n  \"context\": {\n");
+  fprintf(fp, "    \"date\": \"%s\",\n", date);
+  std::string executable(argv[0]);
+  std::replace(executable.begin(), executable.end(), '\\', '/');
+
+  fprintf(fp, "    \"executable\": \"%s\",\n", executable.c_str());
+  fprintf(fp, "    \"num_cpus\": %d,\n", vehicle::ChThread::GetNumHardwareThreads());
+#ifdef NDEBUG
+  fprintf(fp, "    \"library_build_type\": \"release\"\n");
+#else
+  fprintf(fp, "    \"library_build_type\": \"debug\"\n");
+#endif
+  fprintf(fp, "  },\n  \"benchmarks\": [\n");
+
+  printf("%-40s %12s %12s %12s %12s %8s\n", "name", "iterations", "median_ns", "mean_ns", "stddev_ns", "cv_%");
+
+  int num_benchmarks = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+  int num_run = 0;
+  bool first = true;
+
+  for (int k = 0; k < num_benchmarks; k++) {
+    const Benchmark& b = s_benchmarks[k];
+    if (!filter.empty() && std::strstr(b.name, filter.c_str()) == 0)
+      continue;
+    num_run++;
+
+    // The calibration runs also warm up the caches and the allocator.
+    long iterations = calibrate(b.function, min_time);
+
+    std::vector<Run> runs(repetitions);
+    for (int r = 0; r < repetitions; r++) {
+      BenchState state(iterations);
+      b.function(state);
+      runs[r].real_time = 1e9 * state.GetRealTime() / iterations;
+      runs[r].cpu_time = 1e9 * state.GetCpuTime() / iterations;
+      write_entry(fp, first, b.name, "iteration", 0, repetitions, r, iterations, runs[r].real_time,
+                  runs[r].cpu_time);
+    }
+
+    std::vector<double> real_times(repetitions);
+    std::vector<double> cpu_times(repetitions);
+    for (int r = 0; r < repetitions; r++) {
+      real_times[r] = runs[r].real_time;
+      cpu_times[r] = runs[r].cpu_time;
+    }
+    Stats real = get_stats(real_times);
+    Stats cpu = get_stats(cpu_times);
+
+    write_entry(fp, first, b.name, "aggregate", "mean", repetitions, 0, iterations, real.mean, cpu.mean);
+    write_entry(fp, first, b.name, "aggregate", "median", repetitions, 0, iterations, real.median, cpu.median);
+    write_entry(fp, first, b.name, "aggregate", "stddev", repetitions, 0, iterations, real.stddev, cpu.stddev);
+    write_entry(fp, first, b.name, "aggregate", "cv", repetitions, 0, iterations, real.cv, cpu.cv);
+
+    printf("%-40s %12ld %12.1f %12.1f %12.1f %8.2f\n", b.name, iterations, real.median, real.mean, real.stddev,
+           100 * real.cv);
+    fflush(stdout);
+  }
+
+  fprintf(fp, "\n  ]\n}\n");
+  fclose(fp);
+
+  if (num_run == 0) {
+    printf("No benchmark matches %s\n", filter.c_str());
+    return 1;
+  }
+
+  return 0;
+}
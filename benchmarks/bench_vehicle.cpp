@@ -0,0 +1,543 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Benchmark suite of fixed vehicle workloads.
+//
+// Usage: bench_vehicle [output file] [benchmark name] [simulation time] [repetitions]
+//
+// Each benchmark simulates one vehicle configuration for a fixed simulation
+// time (default: 5 s), with the driver inputs read from the same ChDataDriver
+// file, and reports:
+//   - the number of steps per wall-clock second;
+//   - the mean wall-clock time per call of each module (driver, terrain, one
+//     tire, powertrain and vehicle), in nanoseconds;
+//   - the number of heap allocations per step;
+//   - the peak resident set size of the process (which includes all previous
+//     benchmarks; run a single benchmark to measure it in isolation).
+// The results are written as CSV (default: benchmarks.csv) and printed.
+// If a benchmark name is given (other than "all"), only that benchmark is run.
+// With several repetitions (default: 1), each benchmark is run that many
+// times, with one row per run, so that compare_benchmarks.py can test the
+// differences between two result files.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+# include <psapi.h>
+# pragma comment(lib, "psapi.lib")
+#else
+# include <sys/resource.h>
+#endif
+
+#include "physics/ChGlobal.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/vehicle/Vehicle.h"
+#include "subsys/powertrain/SimplePowertrain.h"
+#include "subsys/driver/ChDataDriver.h"
+#include "subsys/tire/RigidTire.h"
+#include "subsys/tire/LugreTire.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/RigidTerrain.h"
+#include "subsys/terrain/FlatTerrain.h"
+#include "subsys/suspensionTest/SuspensionTest.h"
+
+#include "models/ModelDefs.h"
+#include "models/articulated/Articulated_Vehicle.h"
+#include "models/articulated/Articulated_Trailer.h"
+#include "models/articulated/Articulated_SimplePowertrain.h"
+#include "models/articulated/Articulated_RigidTire.h"
+
+using namespace chrono;
+using vehicle::ChProfiler;
+
+// =============================================================================
+
+// Driver inputs, common to all benchmarks
+const std::string driver_file("generic/driver/Sample_Maneuver.txt");
+
+// Integration step size
+const double step_size = 1e-3;
+
+// Initial vehicle position and orientation
+const ChVector<> initLoc(0, 0, 1.0);
+const ChQuaternion<> initRot(1, 0, 0, 0);
+
+// =============================================================================
+// Count all heap allocations made by the process.
+// =============================================================================
+
+static volatile long s_num_allocs = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+  vehicle::ChAtomicIncrement(&s_num_allocs);
+  void* p = std::malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+  return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+  std::free(p);
+}
+
+static long peak_rss_kb()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return -1;
+  return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1;
+# ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+# else
+  return usage.ru_maxrss;
+# endif
+#endif
+}
+
+// =============================================================================
+// Benchmark statistics
+// =============================================================================
+
+enum Module {
+  DRIVER,
+  TERRAIN,
+  TIRES,
+  POWERTRAIN,
+  VEHICLE,
+  NUM_MODULES
+};
+
+struct Result {
+  Result() : num_steps(0), sim_time(0), wall_time(0), num_allocs(0), peak_rss(0)
+  {
+    for (int m = 0; m < NUM_MODULES; m++) {
+      module_time[m] = 0;
+      module_calls[m] = 0;
+    }
+  }
+
+  // Time one call (or the calls to all tires) of the specified module.
+  void Add(Module module, double start, int calls = 1)
+  {
+    module_time[module] += ChProfiler::GetTime() - start;
+    module_calls[module] += calls;
+  }
+
+  std::string  name;
+  int          num_steps;
+  double       sim_time;
+  double       wall_time;
+  long         num_allocs;
+  long         peak_rss;
+  double       module_time[NUM_MODULES];
+  long         module_calls[NUM_MODULES];
+};
+
+// =============================================================================
+// Simulation loop for a vehicle (and optional trailer), with the same sequence
+// of module updates as the demos.
+// =============================================================================
+
+static void run_vehicle(ChVehicle&                         vehicle,
+                        ChPowertrain&                      powertrain,
+                        std::vector<ChSharedPtr<ChTire> >& tires,
+                        ChTerrain&                         terrain,
+                        double                             end_time,
+                        Result&                            res,
+                        Articulated_Trailer*               trailer = 0,
+                        std::vector<ChSharedPtr<ChTire> >* trailer_tires = 0)
+{
+  ChDataDriver driver(vehicle::GetDataFile(driver_file));
+
+  int num_wheels = (int)tires.size();
+  ChTireForces  tire_forces(num_wheels);
+  ChWheelStates wheel_states(num_wheels);
+  ChTireForces  trailer_forces(trailer_tires ? (int)trailer_tires->size() : 0);
+
+  // End of the construction phases
+  vehicle::ChStartupProfiler::Stop();
+
+  long allocs = s_num_allocs;
+  double wall_start = ChProfiler::GetTime();
+  double time = vehicle.GetSystem()->GetChTime();
+
+  while (time < end_time) {
+    // Collect output data from modules (for inter-module communication)
+    double throttle_input = driver.GetThrottle();
+    double steering_input = driver.GetSteering();
+    double braking_input = driver.GetBraking();
+    double powertrain_torque = powertrain.GetOutputTorque();
+    double driveshaft_speed = vehicle.GetDriveshaftSpeed();
+    for (int i = 0; i < num_wheels; i++) {
+      tire_forces[i] = tires[i]->GetTireForce();
+      vehicle.GetWheelState(i, wheel_states[i]);
+    }
+    for (int i = 0; i < (int)trailer_forces.size(); i++)
+      trailer_forces[i] = (*trailer_tires)[i]->GetTireForce();
+
+    // Update modules (process inputs from other modules)
+    double start = ChProfiler::GetTime();
+    driver.Update(time);
+    res.Add(DRIVER, start);
+
+    start = ChProfiler::GetTime();
+    terrain.Update(time);
+    res.Add(TERRAIN, start);
+
+    start = ChProfiler::GetTime();
+    for (int i = 0; i < num_wheels; i++)
+      tires[i]->Update(time, wheel_states[i]);
+    res.Add(TIRES, start, num_wheels);
+
+    start = ChProfiler::GetTime();
+    powertrain.Update(time, throttle_input, driveshaft_speed);
+    res.Add(POWERTRAIN, start);
+
+    start = ChProfiler::GetTime();
+    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
+    if (trailer)
+      trailer->Update(time, braking_input, trailer_forces);
+    res.Add(VEHICLE, start);
+
+    // Advance simulation for one timestep for all modules
+    start = ChProfiler::GetTime();
+    driver.Advance(step_size);
+    res.Add(DRIVER, start);
+
+    start = ChProfiler::GetTime();
+    terrain.Advance(step_size);
+    res.Add(TERRAIN, start);
+
+    start = ChProfiler::GetTime();
+    for (int i = 0; i < num_wheels; i++)
+      tires[i]->Advance(step_size);
+    res.Add(TIRES, start, num_wheels);
+
+    start = ChProfiler::GetTime();
+    powertrain.Advance(step_size);
+    res.Add(POWERTRAIN, start);
+
+    start = ChProfiler::GetTime();
+    vehicle.Advance(step_size);
+    res.Add(VEHICLE, start);
+
+    res.num_steps++;
+    time = vehicle.GetSystem()->GetChTime();
+  }
+
+  res.wall_time = ChProfiler::GetTime() - wall_start;
+  res.num_allocs = s_num_allocs - allocs;
+  res.sim_time = time;
+}
+
+// =============================================================================
+// Benchmarks
+// =============================================================================
+
+enum TireType {
+  RIGID_TIRES,
+  LUGRE_TIRES,
+  PACEJKA_TIRES
+};
+
+// JSON vehicle, on rigid terrain (rigid tires) or flat terrain (other tires).
+static void bench_json_vehicle(const std::string& vehicle_file, TireType tire_type, double end_time, Result& res)
+{
+  Vehicle vehicle(vehicle::GetDataFile(vehicle_file));
+  vehicle.Initialize(ChCoordsys<>(initLoc, initRot));
+
+  SimplePowertrain powertrain(vehicle::GetDataFile("hmmwv/powertrain/HMMWV_SimplePowertrain.json"));
+  powertrain.Initialize();
+
+  RigidTerrain rigid_terrain(vehicle.GetSystem(), 0, 100, 100, 0.8);
+  FlatTerrain flat_terrain(0);
+  ChTerrain& terrain = (tire_type == RIGID_TIRES) ? (ChTerrain&)rigid_terrain : (ChTerrain&)flat_terrain;
+
+  int num_wheels = 2 * vehicle.GetNumberAxles();
+  std::vector<ChSharedPtr<ChTire> > tires(num_wheels);
+  const std::vector<int>& driven_axles = vehicle.GetDriveline()->GetDrivenAxleIndexes();
+
+  for (int i = 0; i < num_wheels; i++) {
+    switch (tire_type) {
+    case RIGID_TIRES:
+    {
+      ChSharedPtr<RigidTire> tire(new RigidTire(vehicle::GetDataFile("hmmwv/tire/HMMWV_RigidTire.json"), terrain));
+      tire->Initialize(vehicle.GetWheelBody(i));
+      tires[i] = tire;
+      break;
+    }
+    case LUGRE_TIRES:
+    {
+      ChSharedPtr<LugreTire> tire(new LugreTire(vehicle::GetDataFile("hmmwv/tire/HMMWV_LugreTire.json"), terrain));
+      tire->Initialize();
+      tires[i] = tire;
+      break;
+    }
+    case PACEJKA_TIRES:
+    {
+      char tire_name[16];
+      sprintf(tire_name, "W%d", i);
+      bool driven = std::find(driven_axles.begin(), driven_axles.end(), i / 2) != driven_axles.end();
+      ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire(tire_name, vehicle::GetDataFile("hmmwv/tire/HMMWV_pacejka.tir"), terrain));
+      tire->Initialize(ChWheelID(i).side(), driven);
+      tires[i] = tire;
+      break;
+    }
+    }
+  }
+
+  run_vehicle(vehicle, powertrain, tires, terrain, end_time, res);
+}
+
+// Articulated vehicle pulling a trailer, rigid tires on rigid terrain.
+static void bench_articulated(double end_time, Result& res)
+{
+  Articulated_Vehicle vehicle(false, MULTI_LINK, NONE);
+  vehicle.Initialize(ChCoordsys<>(initLoc, initRot));
+
+  Articulated_Trailer trailer(vehicle.GetSystem(), false, MULTI_LINK, NONE);
+  trailer.Initialize(ChCoordsys<>(initLoc + ChVector<>(-6, 0, 0), initRot), true, vehicle.GetChassis());
+
+  RigidTerrain terrain(vehicle.GetSystem(), 0, 100, 100, 0.8);
+
+  Articulated_SimplePowertrain powertrain;
+  powertrain.Initialize();
+
+  std::vector<ChSharedPtr<ChTire> > tires(4);
+  std::vector<ChSharedPtr<ChTire> > trailer_tires(4);
+  for (int i = 0; i < 4; i++) {
+    ChSharedPtr<Articulated_RigidTire> tire(new Articulated_RigidTire("V", terrain));
+    tire->Initialize(vehicle.GetWheelBody(i));
+    tires[i] = tire;
+
+    ChSharedPtr<Articulated_RigidTire> trailer_tire(new Articulated_RigidTire("T", terrain));
+    trailer_tire->Initialize(trailer.GetWheelBody(i));
+    trailer_tires[i] = trailer_tire;
+  }
+
+  run_vehicle(vehicle, powertrain, tires, terrain, end_time, res, &trailer, &trailer_tires);
+}
+
+// HMMWV rear suspension on the test rig, with sinusoidal post displacements.
+static void bench_suspension_test(double end_time, Result& res)
+{
+  SuspensionTest tester(vehicle::GetDataFile("hmmwv/suspensionTest/HMMWV_ST_rear.json"));
+  tester.Initialize(ChCoordsys<>(ChVector<>(0, 0, 0.496), initRot));
+
+  FlatTerrain terrain(0);
+
+  std::vector<ChSharedPtr<ChTire> > tires(2);
+  for (int i = 0; i < 2; i++) {
+    ChSharedPtr<RigidTire> tire(new RigidTire(vehicle::GetDataFile("hmmwv/tire/HMMWV_RigidTire.json"), terrain));
+    tire->Initialize(tester.GetWheelBody(i));
+    tires[i] = tire;
+  }
+
+  ChDataDriver driver(vehicle::GetDataFile(driver_file));
+
+  ChTireForces  tire_forces(2);
+  ChWheelStates wheel_states(2);
+
+  // End of the construction phases
+  vehicle::ChStartupProfiler::Stop();
+
+  long allocs = s_num_allocs;
+  double wall_start = ChProfiler::GetTime();
+  double time = tester.GetChTime();
+
+  while (time < end_time) {
+    double steering_input = driver.GetSteering();
+    double post_z_L = 0.1 * std::sin(2 * CH_C_PI * time);
+    double post_z_R = 0.1 * std::sin(2 * CH_C_PI * time + CH_C_PI / 2);
+    for (int i = 0; i < 2; i++) {
+      tire_forces[i] = tires[i]->GetTireForce();
+      wheel_states[i] = tester.GetWheelState(i);
+    }
+
+    double start = ChProfiler::GetTime();
+    driver.Update(time);
+    res.Add(DRIVER, start);
+
+    start = ChProfiler::GetTime();
+    terrain.Update(time);
+    res.Add(TERRAIN, start);
+
+    start = ChProfiler::GetTime();
+    for (int i = 0; i < 2; i++)
+      tires[i]->Update(time, wheel_states[i]);
+    res.Add(TIRES, start, 2);
+
+    start = ChProfiler::GetTime();
+    tester.Update(time, steering_input, post_z_L, post_z_R, tire_forces);
+    res.Add(VEHICLE, start);
+
+    start = ChProfiler::GetTime();
+    driver.Advance(step_size);
+    res.Add(DRIVER, start);
+
+    start = ChProfiler::GetTime();
+    terrain.Advance(step_size);
+    res.Add(TERRAIN, start);
+
+    start = ChProfiler::GetTime();
+    for (int i = 0; i < 2; i++)
+      tires[i]->Advance(step_size);
+    res.Add(TIRES, start, 2);
+
+    start = ChProfiler::GetTime();
+    tester.Advance(step_size);
+    res.Add(VEHICLE, start);
+
+    res.num_steps++;
+    time = tester.GetChTime();
+  }
+
+  res.wall_time = ChProfiler::GetTime() - wall_start;
+  res.num_allocs = s_num_allocs - allocs;
+  res.sim_time = time;
+}
+
+// -----------------------------------------------------------------------------
+
+static const char* s_benchmarks[] = {
+  "hmmwv_full_rigid",
+  "hmmwv_reduced_rigid",
+  "hmmwv_full_lugre",
+  "hmmwv_full_pacejka",
+  "hmmwv_4wd_rigid",
+  "articulated_trailer",
+  "suspension_test"
+};
+
+static void run_benchmark(int index, double end_time, Result& res)
+{
+  res.name = s_benchmarks[index];
+
+  switch (index) {
+  case 0: bench_json_vehicle("hmmwv/vehicle/HMMWV_Vehicle.json", RIGID_TIRES, end_time, res); break;
+  case 1: bench_json_vehicle("hmmwv/vehicle/HMMWV_Vehicle_reduced.json", RIGID_TIRES, end_time, res); break;
+  case 2: bench_json_vehicle("hmmwv/vehicle/HMMWV_Vehicle.json", LUGRE_TIRES, end_time, res); break;
+  case 3: bench_json_vehicle("hmmwv/vehicle/HMMWV_Vehicle.json", PACEJKA_TIRES, end_time, res); break;
+  case 4: bench_json_vehicle("hmmwv/vehicle/HMMWV_Vehicle_4WD.json", RIGID_TIRES, end_time, res); break;
+  case 5: bench_articulated(end_time, res); break;
+  case 6: bench_suspension_test(end_time, res); break;
+  }
+
+  res.peak_rss = peak_rss_kb();
+}
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  std::string out_file = (argc > 1) ? argv[1] : "benchmarks.csv";
+  std::string filter = (argc > 2) ? argv[2] : "";
+  double end_time = (argc > 3) ? std::atof(argv[3]) : 5.0;
+  int repetitions = (argc > 4) ? std::max(std::atoi(argv[4]), 1) : 1;
+
+  if (filter == "all")
+    filter.clear();
+
+  int num_benchmarks = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+  std::vector<Result> results;
+
+  vehicle::ChStartupProfiler::SetAllocationCounter(&s_num_allocs);
+
+  for (int k = 0; k < num_benchmarks; k++) {
+    if (!filter.empty() && filter != s_benchmarks[k])
+      continue;
+    for (int r = 0; r < repetitions; r++) {
+      results.push_back(Result());
+      vehicle::ChStartupProfiler::Start();
+      run_benchmark(k, end_time, results.back());
+    }
+  }
+
+  if (results.empty()) {
+    printf("Unknown benchmark %s\n", filter.c_str());
+    return 1;
+  }
+
+  FILE* fp = fopen(out_file.c_str(), "w");
+  if (!fp) {
+    printf("Cannot open output file %s\n", out_file.c_str());
+    return 1;
+  }
+
+  const char* header = "name,sim_time,steps,wall_time,steps_per_sec,"
+                       "driver_ns,terrain_ns,tire_ns,powertrain_ns,vehicle_ns,"
+                       "allocs_per_step,peak_rss_kb\n";
+  fprintf(fp, "%s", header);
+  printf("%s", header);
+
+  for (size_t j = 0; j < results.size(); j++) {
+    const Result& res = results[j];
+
+    char line[512];
+    int n = sprintf(line, "%s,%g,%d,%.6f,%.1f", res.name.c_str(), res.sim_time, res.num_steps, res.wall_time,
+                    res.wall_time > 0 ? res.num_steps / res.wall_time : 0);
+    for (int m = 0; m < NUM_MODULES; m++)
+      n += sprintf(line + n, ",%.1f", res.module_calls[m] > 0 ? 1e9 * res.module_time[m] / res.module_calls[m] : 0);
+    sprintf(line + n, ",%.2f,%ld\n", res.num_steps > 0 ? (double)res.num_allocs / res.num_steps : 0, res.peak_rss);
+
+    fprintf(fp, "%s", line);
+    printf("%s", line);
+  }
+
+  fclose(fp);
+
+#if PROFILING_ENABLED
+  printf("\nConstruction phases (all benchmarks):\n");
+  vehicle::ChStartupProfiler::PrintSummary();
+#endif
+
+  return 0;
+}
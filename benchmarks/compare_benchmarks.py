@@ -0,0 +1,285 @@
+# -*- coding: utf-8 -*-
+"""
+Compare two sets of benchmark results (baseline and candidate) and report the
+significant regressions and improvements.
+
+Each set is one or more result files, of either suite:
+  bench_vehicle CSV   one row per run (see its repetitions argument); each row
+                      gives, per benchmark, the wall-clock time per step
+                      (step_us), the mean time per call of each module timer
+                      (driver_ns, terrain_ns, tire_ns, powertrain_ns,
+                      vehicle_ns), the heap allocations per step and the peak
+                      resident set size
+  bench_micro JSON    (or any Google Benchmark JSON output) one sample per
+                      repetition of each benchmark: its real time (or CPU
+                      time, with --cpu) per iteration
+Rows and repetitions of the same benchmark in all files of a set are pooled
+as samples. All metrics are costs (lower is better).
+
+For each metric present in both sets, the report gives the medians, the ratio
+of the candidate to the baseline median with its bootstrap confidence
+interval, and the two-sided p-value of the Mann-Whitney U test (exact for
+small samples without ties, normal approximation with tie correction
+otherwise). A difference is flagged as a regression (or an improvement) if it
+is significant (p < alpha) and the ratio exceeds 1 + threshold (or is below
+1 - threshold). The allocation counts are deterministic: any change of their
+median is flagged. With a single sample on either side, no test is possible
+and only the ratio is shown.
+
+Usage: python compare_benchmarks.py -b BASE [BASE ...] -c CAND [CAND ...] [options]
+  --alpha A          significance level (default: 0.05)
+  --threshold T      relative change ignored (default: 0.02)
+  --confidence C     level of the confidence intervals (default: 0.95)
+  --cpu              compare the CPU time of Google Benchmark results
+  --all              also list the unchanged metrics
+  --fail             exit with status 1 if a regression is flagged
+
+For example, with 10 runs of each vehicle benchmark per commit:
+  bench_vehicle base.csv all 5 10      (at the baseline commit)
+  bench_vehicle cand.csv all 5 10      (at the candidate commit)
+  python compare_benchmarks.py -b base.csv -c cand.csv
+
+Requires only the Python standard library.
+
+@author: Radu Serban
+"""
+
+import argparse
+import csv
+import json
+import math
+import random
+import sys
+
+# Module timers of bench_vehicle
+MODULE_TIMERS = ['driver_ns', 'terrain_ns', 'tire_ns', 'powertrain_ns', 'vehicle_ns']
+
+# Metrics compared on their medians only (deterministic counts)
+EXACT_METRICS = ['allocs_per_step']
+
+
+def read_vehicle_csv(filename, samples):
+    '''
+    Add the samples of a bench_vehicle CSV file to a dictionary keyed by
+    (benchmark, metric).
+    '''
+    with open(filename) as f:
+        for row in csv.DictReader(f):
+            name = row['name']
+            steps = float(row['steps'])
+            if steps > 0:
+                samples.setdefault((name, 'step_us'), []).append(1e6 * float(row['wall_time']) / steps)
+            for metric in MODULE_TIMERS + EXACT_METRICS + ['peak_rss_kb']:
+                if metric in row and row[metric] != '':
+                    value = float(row[metric])
+                    # modules a benchmark does not use report zero
+                    if metric in MODULE_TIMERS and value == 0:
+                        continue
+                    samples.setdefault((name, metric), []).append(value)
+
+
+def read_google_json(filename, samples, field):
+    '''
+    Add the samples of a Google Benchmark JSON file (the iteration runs, not
+    the aggregates) to a dictionary keyed by (benchmark, metric), in ns.
+    '''
+    scale = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    with open(filename) as f:
+        results = json.load(f)
+    for b in results.get('benchmarks', []):
+        if b.get('run_type', 'iteration') != 'iteration':
+            continue
+        name = b.get('run_name', b['name'])
+        value = b[field] * scale.get(b.get('time_unit', 'ns'), 1.0)
+        samples.setdefault((name, field + '_ns'), []).append(value)
+
+
+def read_set(filenames, cpu):
+    samples = {}
+    for filename in filenames:
+        if filename.endswith('.json'):
+            read_google_json(filename, samples, 'cpu_time' if cpu else 'real_time')
+        else:
+            read_vehicle_csv(filename, samples)
+    return samples
+
+
+# =============================================================================
+# Statistics
+# =============================================================================
+
+def median(values):
+    v = sorted(values)
+    n = len(v)
+    return v[n // 2] if n % 2 else 0.5 * (v[n // 2 - 1] + v[n // 2])
+
+
+def normal_sf(z):
+    '''
+    Upper tail probability of the standard normal distribution.
+    '''
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def mann_whitney(x, y):
+    '''
+    Two-sided p-value of the Mann-Whitney U test of samples x and y.
+    '''
+    n1, n2 = len(x), len(y)
+
+    # mid-ranks of the pooled samples
+    pooled = sorted([(v, 0) for v in x] + [(v, 1) for v in y])
+    ranks = [0.0] * len(pooled)
+    ties = []
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = 0.5 * (i + j) + 1
+        if j > i:
+            ties.append(j - i + 1)
+        i = j + 1
+
+    r1 = sum(r for r, (v, side) in zip(ranks, pooled) if side == 0)
+    u1 = r1 - n1 * (n1 + 1) / 2.0
+    u = min(u1, n1 * n2 - u1)
+
+    if not ties and n1 * n2 <= 400:
+        # exact distribution of U: number of arrangements with each value
+        counts = u_distribution(n1, n2)
+        total = float(sum(counts))
+        p = 2 * sum(counts[:int(math.floor(u)) + 1]) / total
+        return min(p, 1.0)
+
+    n = n1 + n2
+    tie_term = sum(t ** 3 - t for t in ties) / float(n * (n - 1))
+    var = n1 * n2 / 12.0 * ((n + 1) - tie_term)
+    if var <= 0:
+        return 1.0
+    z = (n1 * n2 / 2.0 - u - 0.5) / math.sqrt(var)
+    return min(2 * normal_sf(max(z, 0.0)), 1.0)
+
+
+def u_distribution(n1, n2):
+    '''
+    Number of orderings of n1 + n2 distinct values giving each value of the U
+    statistic, by the recurrence f(n1, n2, u) = f(n1 - 1, n2, u - n2) + f(n1, n2 - 1, u).
+    '''
+    # table[j][u]: count for the current number of x values and j y values
+    table = [[1] for _ in range(n2 + 1)]
+    for i in range(1, n1 + 1):
+        new = [[1]]
+        for j in range(1, n2 + 1):
+            size = i * j + 1
+            row = [0] * size
+            for u, c in enumerate(table[j]):     # largest value from x: j more pairs
+                if u + j < size:
+                    row[u + j] += c
+            for u, c in enumerate(new[j - 1]):   # largest value from y
+                row[u] += c
+            new.append(row)
+        table = new
+    return table[n2]
+
+
+def ratio_interval(x, y, confidence, resamples=2000, seed=1):
+    '''
+    Bootstrap percentile interval of the ratio of the medians of y and x.
+    '''
+    rng = random.Random(seed)
+    ratios = []
+    for _ in range(resamples):
+        mx = median([rng.choice(x) for _ in x])
+        my = median([rng.choice(y) for _ in y])
+        if mx > 0:
+            ratios.append(my / mx)
+    if not ratios:
+        return float('nan'), float('nan')
+    ratios.sort()
+    tail = 0.5 * (1 - confidence)
+    lo = ratios[int(math.floor(tail * (len(ratios) - 1)))]
+    hi = ratios[int(math.ceil((1 - tail) * (len(ratios) - 1)))]
+    return lo, hi
+
+
+# =============================================================================
+# Report
+# =============================================================================
+
+def compare(base, cand, args):
+    rows = []
+    for key in sorted(set(base) & set(cand)):
+        x, y = base[key], cand[key]
+        mx, my = median(x), median(y)
+        ratio = my / mx if mx > 0 else float('nan')
+
+        if key[1] in EXACT_METRICS:
+            lo = hi = p = None
+            changed = (my != mx)
+            status = ('REGRESSION' if my > mx else 'improved') if changed else ''
+        elif len(x) < 2 or len(y) < 2:
+            lo = hi = p = None
+            status = '(n=1)'
+        else:
+            lo, hi = ratio_interval(x, y, args.confidence)
+            p = mann_whitney(x, y)
+            status = ''
+            if p < args.alpha and ratio > 1 + args.threshold:
+                status = 'REGRESSION'
+            elif p < args.alpha and ratio < 1 - args.threshold:
+                status = 'improved'
+
+        rows.append((key, len(x), len(y), mx, my, ratio, lo, hi, p, status))
+    return rows
+
+
+def print_report(rows, args, out=sys.stdout):
+    shown = [r for r in rows if args.all or r[9]]
+    width = max([len(r[0][0]) for r in rows] + [9])
+    metric_width = max([len(r[0][1]) for r in rows] + [6])
+
+    header = '%-*s  %-*s %5s %12s %12s %7s  %-17s %8s  %s' % (
+        width, 'benchmark', metric_width, 'metric', 'n', 'baseline', 'candidate', 'ratio',
+        '%g%% CI' % (100 * args.confidence), 'p', '')
+    out.write(header + '\n')
+    out.write('-' * len(header) + '\n')
+
+    for (name, metric), n1, n2, mx, my, ratio, lo, hi, p, status in shown:
+        ci = '[%.3f, %.3f]' % (lo, hi) if lo is not None else ''
+        pval = '%.4f' % p if p is not None else ''
+        out.write('%-*s  %-*s %5s %12.4g %12.4g %7.3f  %-17s %8s  %s\n' % (
+            width, name, metric_width, metric, '%d/%d' % (n1, n2), mx, my, ratio, ci, pval, status))
+
+    regressions = [r for r in rows if r[9] == 'REGRESSION']
+    improvements = [r for r in rows if r[9] == 'improved']
+    out.write('\n%d metrics compared: %d regressions, %d improvements (alpha %g, threshold %g%%)\n' % (
+        len(rows), len(regressions), len(improvements), args.alpha, 100 * args.threshold))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two sets of benchmark results.')
+    parser.add_argument('-b', '--baseline', nargs='+', required=True, help='baseline result files')
+    parser.add_argument('-c', '--candidate', nargs='+', required=True, help='candidate result files')
+    parser.add_argument('--alpha', type=float, default=0.05, help='significance level')
+    parser.add_argument('--threshold', type=float, default=0.02, help='relative change ignored')
+    parser.add_argument('--confidence', type=float, default=0.95, help='level of the confidence intervals')
+    parser.add_argument('--cpu', action='store_true', help='compare CPU times of Google Benchmark results')
+    parser.add_argument('--all', action='store_true', help='also list the unchanged metrics')
+    parser.add_argument('--fail', action='store_true', help='exit with status 1 on a regression')
+    args = parser.parse_args()
+
+    base = read_set(args.baseline, args.cpu)
+    cand = read_set(args.candidate, args.cpu)
+    if not set(base) & set(cand):
+        sys.stderr.write('No benchmark in common between the baseline and the candidate\n')
+        return 2
+
+    regressions = print_report(compare(base, cand, args), args)
+    return 1 if regressions and args.fail else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,140 @@
+#=============================================================================
+# Optimization profile for production binaries:
+#
+#   ENABLE_LTO   link-time (interprocedural) optimization of the ChronoVehicle
+#                libraries, the vehicle models and the executables, such that
+#                the calls through the subsystem and tire interfaces can be
+#                devirtualized and inlined across translation units
+#   CH_PGO       profile-guided optimization, in two builds:
+#                  GENERATE  instrumented build; run the 'pgo_train' target
+#                            (the benchmark suite, see ENABLE_BENCHMARKS) to
+#                            record the profiles in CH_PGO_DIR
+#                  USE       optimized build using the recorded profiles
+#
+# A typical PGO sequence, reconfiguring the same build directory (GCC names
+# the profiles after the object files):
+#
+#   cmake -DCH_PGO=GENERATE -DENABLE_BENCHMARKS=ON ...
+#   make pgo_train
+#   cmake -DCH_PGO=USE -DENABLE_LTO=ON ...
+#   make
+#
+# The flags are appended to CH_BUILDFLAGS (used by all targets) and to the
+# linker flags of the shared libraries and executables.  Use with an
+# optimized configuration (e.g. CMAKE_BUILD_TYPE=Release).
+#=============================================================================
+
+OPTION(ENABLE_LTO "Enable link-time optimization of the libraries and executables" OFF)
+
+SET(CH_PGO "OFF" CACHE STRING "Profile-guided optimization: OFF, GENERATE (instrumented build) or USE (recorded profiles)")
+SET_PROPERTY(CACHE CH_PGO PROPERTY STRINGS OFF GENERATE USE)
+SET(CH_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Directory of the PGO profiles")
+
+IF(CH_PGO STREQUAL "OFF")
+  MARK_AS_ADVANCED(FORCE CH_PGO_DIR)
+ELSE()
+  MARK_AS_ADVANCED(CLEAR CH_PGO_DIR)
+ENDIF()
+
+SET(CH_OPT_COMPILE_FLAGS "")
+SET(CH_OPT_LINK_FLAGS "")
+
+IF(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+  SET(CH_PGO_COMPILER "CLANG")
+ELSEIF(CMAKE_COMPILER_IS_GNUCXX)
+  SET(CH_PGO_COMPILER "GCC")
+ELSEIF(MSVC)
+  SET(CH_PGO_COMPILER "MSVC")
+ELSE()
+  SET(CH_PGO_COMPILER "")
+ENDIF()
+
+# ------------------------------------------------------------------------------
+# Link-time optimization
+# ------------------------------------------------------------------------------
+IF(ENABLE_LTO)
+  IF(CH_PGO_COMPILER STREQUAL "GCC" OR CH_PGO_COMPILER STREQUAL "CLANG")
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} -flto")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} -flto")
+  ELSEIF(CH_PGO_COMPILER STREQUAL "MSVC")
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} /GL")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} /LTCG")
+  ELSE()
+    MESSAGE(WARNING "Link-time optimization is not supported for this compiler; ENABLE_LTO is ignored.")
+  ENDIF()
+ENDIF()
+
+# ------------------------------------------------------------------------------
+# Profile-guided optimization
+# ------------------------------------------------------------------------------
+IF(CH_PGO STREQUAL "GENERATE")
+  FILE(MAKE_DIRECTORY "${CH_PGO_DIR}")
+  IF(CH_PGO_COMPILER STREQUAL "GCC")
+    # The counters are also updated from the worker threads (ChThreadPool).
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} -fprofile-generate=${CH_PGO_DIR} -fprofile-update=prefer-atomic")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} -fprofile-generate=${CH_PGO_DIR}")
+  ELSEIF(CH_PGO_COMPILER STREQUAL "CLANG")
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} -fprofile-generate=${CH_PGO_DIR}")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} -fprofile-generate=${CH_PGO_DIR}")
+  ELSEIF(CH_PGO_COMPILER STREQUAL "MSVC")
+    # The MSVC profiles (.pgc/.pgd) are written next to the binaries.
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} /GL")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} /LTCG /GENPROFILE")
+  ELSE()
+    MESSAGE(WARNING "Profile-guided optimization is not supported for this compiler; CH_PGO is ignored.")
+  ENDIF()
+ELSEIF(CH_PGO STREQUAL "USE")
+  IF(CH_PGO_COMPILER STREQUAL "GCC")
+    # Functions never run during training are still compiled (without profile).
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} -fprofile-use=${CH_PGO_DIR} -fprofile-correction -Wno-missing-profile")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} -fprofile-use=${CH_PGO_DIR}")
+  ELSEIF(CH_PGO_COMPILER STREQUAL "CLANG")
+    # The raw profiles must be merged first (done by the 'pgo_train' target).
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} -fprofile-use=${CH_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} -fprofile-use=${CH_PGO_DIR}/default.profdata")
+  ELSEIF(CH_PGO_COMPILER STREQUAL "MSVC")
+    SET(CH_OPT_COMPILE_FLAGS "${CH_OPT_COMPILE_FLAGS} /GL")
+    SET(CH_OPT_LINK_FLAGS "${CH_OPT_LINK_FLAGS} /LTCG /USEPROFILE")
+  ELSE()
+    MESSAGE(WARNING "Profile-guided optimization is not supported for this compiler; CH_PGO is ignored.")
+  ENDIF()
+ELSEIF(NOT CH_PGO STREQUAL "OFF")
+  MESSAGE(WARNING "Unknown CH_PGO value '${CH_PGO}' (expected OFF, GENERATE or USE); profile-guided optimization is disabled.")
+ENDIF()
+
+IF(NOT CH_OPT_COMPILE_FLAGS STREQUAL "")
+  MESSAGE(STATUS "Optimization profile: LTO=${ENABLE_LTO} PGO=${CH_PGO}")
+  SET(CH_BUILDFLAGS "${CH_BUILDFLAGS} ${CH_OPT_COMPILE_FLAGS}")
+  SET(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${CH_OPT_LINK_FLAGS}")
+  SET(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${CH_OPT_LINK_FLAGS}")
+ENDIF()
+
+# ------------------------------------------------------------------------------
+# Add the PGO training target for the specified executable: run it with the
+# given arguments from the executable output directory and, for Clang, merge
+# the raw profiles for the USE build.
+# ------------------------------------------------------------------------------
+FUNCTION(CH_PGO_TRAINING target)
+  IF(NOT CH_PGO STREQUAL "GENERATE" OR CH_PGO_COMPILER STREQUAL "")
+    RETURN()
+  ENDIF()
+
+  SET(merge_command "")
+  IF(CH_PGO_COMPILER STREQUAL "CLANG")
+    FIND_PROGRAM(CH_LLVM_PROFDATA NAMES llvm-profdata)
+    MARK_AS_ADVANCED(CH_LLVM_PROFDATA)
+    IF(CH_LLVM_PROFDATA)
+      SET(merge_command COMMAND ${CH_LLVM_PROFDATA} merge -output=${CH_PGO_DIR}/default.profdata ${CH_PGO_DIR})
+    ELSE()
+      MESSAGE(WARNING "llvm-profdata not found; merge the profiles in ${CH_PGO_DIR} into default.profdata manually.")
+    ENDIF()
+  ENDIF()
+
+  ADD_CUSTOM_TARGET(pgo_train
+    COMMAND ${target} ${ARGN}
+    ${merge_command}
+    WORKING_DIRECTORY ${EXECUTABLE_OUTPUT_PATH}
+    DEPENDS ${target}
+    COMMENT "Recording the PGO profiles with ${target}"
+  )
+ENDFUNCTION()
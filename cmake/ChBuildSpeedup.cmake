@@ -0,0 +1,96 @@
+#=============================================================================
+# Build-time options for the ChronoVehicle libraries and the vehicle models:
+#
+#   ENABLE_UNITY_BUILD          compile the sources of a target in batches of
+#                               UNITY_BUILD_BATCH_SIZE files, each batch as a
+#                               single translation unit
+#   ENABLE_PRECOMPILED_HEADERS  precompile the common Chrono and rapidjson
+#                               headers once per target (requires CMake 3.16)
+#
+# Usage (after the list of sources of a target is complete):
+#
+#   CH_UNITY_SOURCES(<target> <sources variable>)
+#   ADD_LIBRARY(<target> ... ${<sources variable>})
+#   CH_PRECOMPILE_HEADERS(<target>)
+#
+# Sources which cannot share a translation unit with others (e.g. files
+# including the Windows headers) are excluded with
+#
+#   SET_SOURCE_FILES_PROPERTIES(<files> PROPERTIES CH_UNITY_EXCLUDE TRUE)
+#
+# Both options only change how the sources are compiled; the libraries and
+# executables are identical.
+#=============================================================================
+
+OPTION(ENABLE_UNITY_BUILD "Compile the vehicle sources in batches (unity build)" OFF)
+SET(UNITY_BUILD_BATCH_SIZE 16 CACHE STRING "Number of sources per unity batch")
+MARK_AS_ADVANCED(UNITY_BUILD_BATCH_SIZE)
+
+OPTION(ENABLE_PRECOMPILED_HEADERS "Precompile the common headers of the vehicle sources" OFF)
+
+IF(ENABLE_PRECOMPILED_HEADERS AND CMAKE_VERSION VERSION_LESS 3.16)
+  MESSAGE(WARNING "Precompiled headers require CMake 3.16 or newer; ENABLE_PRECOMPILED_HEADERS is ignored.")
+ENDIF()
+
+SET(CH_PCH_HEADER "${CMAKE_CURRENT_LIST_DIR}/../subsys/ChSubsysPch.h")
+
+# ------------------------------------------------------------------------------
+# Append the unity batches of the C++ sources in the specified list to that
+# list, and mark the batched sources as not compiled on their own (they still
+# appear in the IDE projects).  The batch files are only rewritten when their
+# contents change, such that reconfiguring does not trigger a rebuild.
+# ------------------------------------------------------------------------------
+FUNCTION(CH_UNITY_SOURCES target sources_var)
+  IF(NOT ENABLE_UNITY_BUILD)
+    RETURN()
+  ENDIF()
+
+  SET(unity_dir "${CMAKE_CURRENT_BINARY_DIR}/unity")
+  SET(batch_index 0)
+  SET(batch_count 0)
+  SET(batch_text "")
+  SET(unity_files "")
+
+  FOREACH(src ${${sources_var}})
+    GET_FILENAME_COMPONENT(ext "${src}" EXT)
+    GET_SOURCE_FILE_PROPERTY(excluded "${src}" CH_UNITY_EXCLUDE)
+    IF("${ext}" STREQUAL ".cpp" AND NOT excluded)
+      GET_FILENAME_COMPONENT(src_abs "${src}" ABSOLUTE)
+      SET(batch_text "${batch_text}#include \"${src_abs}\"\n")
+      SET_SOURCE_FILES_PROPERTIES("${src}" PROPERTIES HEADER_FILE_ONLY TRUE)
+      MATH(EXPR batch_count "${batch_count} + 1")
+
+      IF(NOT batch_count LESS UNITY_BUILD_BATCH_SIZE)
+        SET(unity_file "${unity_dir}/${target}_${batch_index}.cpp")
+        FILE(WRITE "${unity_file}.tmp" "${batch_text}")
+        CONFIGURE_FILE("${unity_file}.tmp" "${unity_file}" COPYONLY)
+        LIST(APPEND unity_files "${unity_file}")
+        MATH(EXPR batch_index "${batch_index} + 1")
+        SET(batch_count 0)
+        SET(batch_text "")
+      ENDIF()
+    ENDIF()
+  ENDFOREACH()
+
+  IF(batch_count GREATER 0)
+    SET(unity_file "${unity_dir}/${target}_${batch_index}.cpp")
+    FILE(WRITE "${unity_file}.tmp" "${batch_text}")
+    CONFIGURE_FILE("${unity_file}.tmp" "${unity_file}" COPYONLY)
+    LIST(APPEND unity_files "${unity_file}")
+  ENDIF()
+
+  SOURCE_GROUP("unity" FILES ${unity_files})
+  SET(${sources_var} ${${sources_var}} ${unity_files} PARENT_SCOPE)
+ENDFUNCTION()
+
+# ------------------------------------------------------------------------------
+# Precompile the common headers for the specified target.
+# ------------------------------------------------------------------------------
+FUNCTION(CH_PRECOMPILE_HEADERS target)
+  IF(NOT ENABLE_PRECOMPILED_HEADERS OR CMAKE_VERSION VERSION_LESS 3.16)
+    RETURN()
+  ENDIF()
+
+  GET_FILENAME_COMPONENT(pch_abs "${CH_PCH_HEADER}" ABSOLUTE)
+  TARGET_PRECOMPILE_HEADERS(${target} PRIVATE "${pch_abs}")
+ENDFUNCTION()
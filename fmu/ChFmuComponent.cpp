@@ -0,0 +1,294 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Base class for the vehicle modules exported as FMI 2.0 co-simulation FMUs.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "fmu/ChFmuComponent.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Convert a file URI (file:///path, file:/path or file://host/path, with
+// percent-encoded characters) to a path. Other URIs give an empty path.
+// -----------------------------------------------------------------------------
+static std::string UriToPath(const std::string& uri)
+{
+  if (uri.compare(0, 5, "file:") != 0)
+    return "";
+
+  std::string path = uri.substr(5);
+  if (path.compare(0, 3, "///") == 0)
+    path = path.substr(2);
+  else if (path.compare(0, 2, "//") == 0)
+    path = path.substr(path.find('/', 2) == std::string::npos ? path.size() : path.find('/', 2));
+
+  // Drive letter: /C:/dir
+  if (path.size() > 2 && path[0] == '/' && path[2] == ':')
+    path = path.substr(1);
+
+  std::string decoded;
+  for (size_t i = 0; i < path.size(); i++) {
+    if (path[i] == '%' && i + 2 < path.size()) {
+      decoded += (char)std::strtol(path.substr(i + 1, 2).c_str(), 0, 16);
+      i += 2;
+    } else {
+      decoded += path[i];
+    }
+  }
+
+  if (!decoded.empty() && decoded[decoded.size() - 1] == '/')
+    decoded.erase(decoded.size() - 1);
+
+  return decoded;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFmuComponent::ChFmuComponent(const std::string& instance_name,
+                               const std::string& resource_uri)
+: m_step_size(1e-3),
+  m_instance_name(instance_name),
+  m_resource_dir(UriToPath(resource_uri)),
+  m_time(0),
+  m_initialized(false)
+{
+}
+
+std::string ChFmuComponent::GetResourceFile(const std::string& filename) const
+{
+  bool absolute = (!filename.empty() && (filename[0] == '/' || filename[0] == '\\')) ||
+                  (filename.size() > 1 && filename[1] == ':');
+  if (absolute || m_resource_dir.empty())
+    return filename;
+
+  return m_resource_dir + "/" + filename;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+template <typename T>
+void ChFmuComponent::Map(std::vector<Variable<T> >& table, unsigned int vr, T* var, Causality causality)
+{
+  if (vr >= table.size())
+    table.resize(vr + 1);
+
+  table[vr].var = var;
+  table[vr].causality = causality;
+}
+
+void ChFmuComponent::MapReal(unsigned int vr, double* var, Causality causality)
+{
+  Map(m_reals, vr, var, causality);
+}
+
+void ChFmuComponent::MapInteger(unsigned int vr, int* var, Causality causality)
+{
+  Map(m_integers, vr, var, causality);
+}
+
+void ChFmuComponent::MapBoolean(unsigned int vr, bool* var, Causality causality)
+{
+  Map(m_booleans, vr, var, causality);
+}
+
+void ChFmuComponent::MapString(unsigned int vr, std::string* var, Causality causality)
+{
+  Map(m_strings, vr, var, causality);
+}
+
+bool ChFmuComponent::CanSet(Causality causality) const
+{
+  if (causality == OUTPUT) {
+    GetLog() << "ERROR: FMU " << m_instance_name.c_str() << ": cannot set an output\n";
+    return false;
+  }
+  if (causality == PARAMETER && m_initialized) {
+    GetLog() << "ERROR: FMU " << m_instance_name.c_str() << ": cannot set a parameter after initialization\n";
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChFmuComponent::GetReal(unsigned int vr, double& val) const
+{
+  if (vr >= m_reals.size() || !m_reals[vr].var)
+    return false;
+
+  val = *m_reals[vr].var;
+  return true;
+}
+
+bool ChFmuComponent::SetReal(unsigned int vr, double val)
+{
+  if (vr >= m_reals.size() || !m_reals[vr].var || !CanSet(m_reals[vr].causality))
+    return false;
+
+  *m_reals[vr].var = val;
+  return true;
+}
+
+bool ChFmuComponent::GetInteger(unsigned int vr, int& val) const
+{
+  if (vr >= m_integers.size() || !m_integers[vr].var)
+    return false;
+
+  val = *m_integers[vr].var;
+  return true;
+}
+
+bool ChFmuComponent::SetInteger(unsigned int vr, int val)
+{
+  if (vr >= m_integers.size() || !m_integers[vr].var || !CanSet(m_integers[vr].causality))
+    return false;
+
+  *m_integers[vr].var = val;
+  return true;
+}
+
+bool ChFmuComponent::GetBoolean(unsigned int vr, bool& val) const
+{
+  if (vr >= m_booleans.size() || !m_booleans[vr].var)
+    return false;
+
+  val = *m_booleans[vr].var;
+  return true;
+}
+
+bool ChFmuComponent::SetBoolean(unsigned int vr, bool val)
+{
+  if (vr >= m_booleans.size() || !m_booleans[vr].var || !CanSet(m_booleans[vr].causality))
+    return false;
+
+  *m_booleans[vr].var = val;
+  return true;
+}
+
+bool ChFmuComponent::GetString(unsigned int vr, const char*& val) const
+{
+  if (vr >= m_strings.size() || !m_strings[vr].var)
+    return false;
+
+  val = m_strings[vr].var->c_str();
+  return true;
+}
+
+bool ChFmuComponent::SetString(unsigned int vr, const char* val)
+{
+  if (vr >= m_strings.size() || !m_strings[vr].var || !CanSet(m_strings[vr].causality))
+    return false;
+
+  *m_strings[vr].var = val ? val : "";
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChFmuComponent::Initialize()
+{
+  if (m_initialized)
+    return true;
+
+  if (m_step_size <= 0) {
+    GetLog() << "ERROR: FMU " << m_instance_name.c_str() << ": invalid step size\n";
+    return false;
+  }
+
+  if (!Setup())
+    return false;
+
+  UpdateOutputs();
+  m_initialized = true;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// The communication step is split into the smallest number of equal internal
+// steps not larger than the step size parameter (with a relative tolerance, so
+// that a communication step that is a multiple of the step size is not split
+// into one extra step).
+// -----------------------------------------------------------------------------
+bool ChFmuComponent::DoStep(double current_time, double step)
+{
+  if (!m_initialized) {
+    GetLog() << "ERROR: FMU " << m_instance_name.c_str() << ": not initialized\n";
+    return false;
+  }
+
+  if (std::abs(current_time - m_time) > 1e-9 * std::max(1.0, std::abs(m_time))) {
+    GetLog() << "ERROR: FMU " << m_instance_name.c_str() << ": step at " << current_time
+             << " does not start at the current time " << m_time << "\n";
+    return false;
+  }
+
+  if (step <= 0)
+    return step == 0;
+
+  int num_steps = std::max(1, (int)std::ceil(step / m_step_size - 1e-6));
+  double internal_step = step / num_steps;
+
+  for (int i = 0; i < num_steps; i++) {
+    if (!Advance(current_time + i * internal_step, internal_step))
+      return false;
+  }
+
+  m_time = current_time + step;
+  UpdateOutputs();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFmuComponent::SaveState(ChVehicleState& state) const
+{
+  state.BeginBlock(1);
+  state.Write(m_time);
+
+  SaveModules(state);
+}
+
+bool ChFmuComponent::RestoreState(ChVehicleState& state)
+{
+  if (!state.OpenBlock(1, m_instance_name.c_str()))
+    return false;
+  double time = state.Read();
+
+  if (!RestoreModules(state))
+    return false;
+
+  m_time = time;
+  UpdateOutputs();
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,187 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Base class for the vehicle modules exported as FMI 2.0 co-simulation FMUs.
+//
+// A component maps the value references of its FMU variables (as listed in
+// the modelDescription.xml of the FMU) directly onto the members that hold
+// them, i.e. onto the fields of the module input and output structures
+// (ChWheelState, ChTireForce, driver inputs, ...). fmi2GetXXX() and
+// fmi2SetXXX() read and write these fields through the table of pointers, so
+// there is no copy between the FMU variables and the module inputs and
+// outputs. Value references are numbered from 0 for each variable type.
+//
+// The master calls fmi2DoStep() at its communication rate; the component
+// covers each communication step with internal steps of at most the step size
+// parameter, holding the inputs over the communication step.
+//
+// The FMU state (fmi2GetFMUstate() and the serialization functions) is a
+// snapshot of the module states, taken with the ChVehicleState API.
+//
+// =============================================================================
+
+#ifndef CH_FMU_COMPONENT_H
+#define CH_FMU_COMPONENT_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChVehicleState.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Base class for a vehicle module exported as an FMU.
+///
+class ChFmuComponent
+{
+public:
+
+  /// Causality of an FMU variable.
+  enum Causality {
+    PARAMETER,   ///< fixed parameter, set before initialization
+    INPUT,       ///< input, set by the master between steps
+    OUTPUT       ///< output, calculated at each step
+  };
+
+  ChFmuComponent(
+    const std::string& instance_name,   ///< [in] name of the FMU instance
+    const std::string& resource_uri     ///< [in] URI of the resources directory of the FMU
+    );
+
+  virtual ~ChFmuComponent() {}
+
+  /// Get the name of the FMU instance.
+  const std::string& GetInstanceName() const { return m_instance_name; }
+
+  /// Get the path of the resources directory of the FMU (empty if the master
+  /// did not provide a file URI).
+  const std::string& GetResourceDir() const { return m_resource_dir; }
+
+  /// Get and set FMU variables. Outputs cannot be set, and parameters cannot
+  /// be set after initialization.
+  /// These functions return false if the value reference is not valid.
+  bool GetReal(unsigned int vr, double& val) const;
+  bool SetReal(unsigned int vr, double val);
+  bool GetInteger(unsigned int vr, int& val) const;
+  bool SetInteger(unsigned int vr, int val);
+  bool GetBoolean(unsigned int vr, bool& val) const;
+  bool SetBoolean(unsigned int vr, bool val);
+  bool GetString(unsigned int vr, const char*& val) const;
+  bool SetString(unsigned int vr, const char* val);
+
+  /// Set the start time of the simulation (fmi2SetupExperiment()).
+  void SetStartTime(double time) { m_time = time; }
+
+  /// Get the current time of the component.
+  double GetTime() const { return m_time; }
+
+  /// Construct the modules from the parameters and calculate the initial
+  /// outputs (fmi2ExitInitializationMode()).
+  /// Returns false if the modules cannot be constructed.
+  bool Initialize();
+
+  /// Return true if the component was initialized.
+  bool IsInitialized() const { return m_initialized; }
+
+  /// Advance the modules over the communication step starting at the
+  /// specified time, with internal steps of at most the step size parameter.
+  /// Returns false if the component was not initialized, if the step does not
+  /// start at the current time of the component, or if the step fails.
+  bool DoStep(
+    double current_time,    ///< [in] start time of the communication step
+    double step             ///< [in] communication step size
+    );
+
+  /// Append the time and the module states of the component to the
+  /// specified snapshot (fmi2GetFMUstate()).
+  void SaveState(ChVehicleState& state) const;
+
+  /// Restore the time and the module states of the component from the
+  /// specified snapshot (fmi2SetFMUstate()).
+  /// Returns false if the snapshot does not match the component.
+  bool RestoreState(ChVehicleState& state);
+
+protected:
+
+  /// Map the value reference of a variable onto the member holding it.
+  /// The value references of each type must be mapped in increasing order,
+  /// starting at 0.
+  void MapReal(unsigned int vr, double* var, Causality causality);
+  void MapInteger(unsigned int vr, int* var, Causality causality);
+  void MapBoolean(unsigned int vr, bool* var, Causality causality);
+  void MapString(unsigned int vr, std::string* var, Causality causality);
+
+  /// Get the path of a file specified by a string parameter: a relative path
+  /// is relative to the resources directory of the FMU.
+  std::string GetResourceFile(const std::string& filename) const;
+
+  /// Construct the modules from the parameters.
+  virtual bool Setup() = 0;
+
+  /// Perform one internal step of the modules, from the specified time.
+  /// Returns false if the step fails.
+  virtual bool Advance(double time, double step) = 0;
+
+  /// Calculate the outputs from the current state of the modules.
+  virtual void UpdateOutputs() = 0;
+
+  /// Append the module states to the specified snapshot.
+  virtual void SaveModules(ChVehicleState& state) const = 0;
+
+  /// Restore the module states from the specified snapshot.
+  virtual bool RestoreModules(ChVehicleState& state) = 0;
+
+  double m_step_size;    ///< largest internal step (default: 1 ms)
+
+private:
+
+  template <typename T>
+  struct Variable {
+    T*        var;
+    Causality causality;
+  };
+
+  template <typename T>
+  static void Map(std::vector<Variable<T> >& table, unsigned int vr, T* var, Causality causality);
+
+  bool CanSet(Causality causality) const;
+
+  std::string  m_instance_name;
+  std::string  m_resource_dir;
+
+  double       m_time;
+  bool         m_initialized;
+
+  std::vector<Variable<double> >      m_reals;
+  std::vector<Variable<int> >         m_integers;
+  std::vector<Variable<bool> >        m_booleans;
+  std::vector<Variable<std::string> > m_strings;
+};
+
+/// Create the component exported by the FMU library. Each FMU library
+/// implements this function for its component.
+ChFmuComponent* CreateFmuComponent(
+  const std::string& instance_name,   ///< [in] name of the FMU instance
+  const std::string& resource_uri     ///< [in] URI of the resources directory of the FMU
+  );
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,160 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A Pacejka tire exported as an FMI 2.0 co-simulation FMU.
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "fmu/ChFmuTire.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFmuTire::ChFmuTire(const std::string& instance_name,
+                     const std::string& resource_uri)
+: ChFmuComponent(instance_name, resource_uri),
+  m_tire_file("pactest.tir"),
+  m_side(LEFT),
+  m_driven(false),
+  m_height_input(false),
+  m_terrain_height(0)
+{
+  m_wheel_state.pos = ChVector<>(0, 0, 0);
+  m_wheel_state.rot = ChQuaternion<>(1, 0, 0, 0);
+  m_wheel_state.lin_vel = ChVector<>(0, 0, 0);
+  m_wheel_state.ang_vel = ChVector<>(0, 0, 0);
+  m_wheel_state.omega = 0;
+
+  m_tire_force.force = ChVector<>(0, 0, 0);
+  m_tire_force.point = ChVector<>(0, 0, 0);
+  m_tire_force.moment = ChVector<>(0, 0, 0);
+
+  MapReal(0, &m_wheel_state.pos.x, INPUT);
+  MapReal(1, &m_wheel_state.pos.y, INPUT);
+  MapReal(2, &m_wheel_state.pos.z, INPUT);
+  MapReal(3, &m_wheel_state.rot.e0, INPUT);
+  MapReal(4, &m_wheel_state.rot.e1, INPUT);
+  MapReal(5, &m_wheel_state.rot.e2, INPUT);
+  MapReal(6, &m_wheel_state.rot.e3, INPUT);
+  MapReal(7, &m_wheel_state.lin_vel.x, INPUT);
+  MapReal(8, &m_wheel_state.lin_vel.y, INPUT);
+  MapReal(9, &m_wheel_state.lin_vel.z, INPUT);
+  MapReal(10, &m_wheel_state.ang_vel.x, INPUT);
+  MapReal(11, &m_wheel_state.ang_vel.y, INPUT);
+  MapReal(12, &m_wheel_state.ang_vel.z, INPUT);
+  MapReal(13, &m_wheel_state.omega, INPUT);
+  MapReal(14, &m_terrain_height, INPUT);
+  MapReal(15, &m_tire_force.force.x, OUTPUT);
+  MapReal(16, &m_tire_force.force.y, OUTPUT);
+  MapReal(17, &m_tire_force.force.z, OUTPUT);
+  MapReal(18, &m_tire_force.point.x, OUTPUT);
+  MapReal(19, &m_tire_force.point.y, OUTPUT);
+  MapReal(20, &m_tire_force.point.z, OUTPUT);
+  MapReal(21, &m_tire_force.moment.x, OUTPUT);
+  MapReal(22, &m_tire_force.moment.y, OUTPUT);
+  MapReal(23, &m_tire_force.moment.z, OUTPUT);
+  MapReal(24, &m_step_size, PARAMETER);
+
+  MapInteger(0, &m_side, PARAMETER);
+
+  MapBoolean(0, &m_driven, PARAMETER);
+  MapBoolean(1, &m_height_input, PARAMETER);
+
+  MapString(0, &m_tire_file, PARAMETER);
+}
+
+// -----------------------------------------------------------------------------
+// The tire selects its contact test from the terrain at construction, so the
+// terrain is created first.
+// -----------------------------------------------------------------------------
+bool ChFmuTire::Setup()
+{
+  if (m_tire_file.empty()) {
+    GetLog() << "ERROR: FMU " << GetInstanceName().c_str() << ": no Pacejka parameter file\n";
+    return false;
+  }
+  if (m_side != LEFT && m_side != RIGHT) {
+    GetLog() << "ERROR: FMU " << GetInstanceName().c_str() << ": invalid wheel side " << m_side << "\n";
+    return false;
+  }
+
+  if (m_height_input)
+    m_terrain = ChSharedPtr<ChFmuHeightTerrain>(new ChFmuHeightTerrain(m_terrain_height));
+  else
+    m_terrain = ChSharedPtr<FlatTerrain>(new FlatTerrain(m_terrain_height));
+
+  m_tire = ChSharedPtr<ChPacejkaTire>(new ChPacejkaTire(GetInstanceName(), GetResourceFile(m_tire_file), *m_terrain));
+  m_tire->Initialize((ChVehicleSide)m_side, m_driven);
+
+  m_tire->Update(GetTime(), m_wheel_state);
+
+  return true;
+}
+
+bool ChFmuTire::Advance(double time, double step)
+{
+  m_tire->Update(time, m_wheel_state);
+  m_tire->Advance(step);
+
+  return true;
+}
+
+void ChFmuTire::UpdateOutputs()
+{
+  m_tire_force = m_tire->GetTireForce();
+}
+
+// -----------------------------------------------------------------------------
+// The wheel state input is part of the FMU state, since the tire force output
+// is calculated from it.
+// -----------------------------------------------------------------------------
+void ChFmuTire::SaveModules(ChVehicleState& state) const
+{
+  state.BeginBlock(ChVehicleState::WHEEL_STATE_SIZE + 1);
+  state.Write(m_wheel_state);
+  state.Write(m_terrain_height);
+
+  m_tire->SaveState(state);
+}
+
+bool ChFmuTire::RestoreModules(ChVehicleState& state)
+{
+  if (!state.OpenBlock(ChVehicleState::WHEEL_STATE_SIZE + 1, GetInstanceName().c_str()))
+    return false;
+  m_wheel_state = state.ReadWheelState();
+  m_terrain_height = state.Read();
+
+  return m_tire->RestoreState(state);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFmuComponent* CreateFmuComponent(const std::string& instance_name,
+                                   const std::string& resource_uri)
+{
+  return new ChFmuTire(instance_name, resource_uri);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,119 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A Pacejka tire exported as an FMI 2.0 co-simulation FMU.
+//
+// The inputs are the wheel state (in the global frame) and the terrain height.
+// With the "height input" parameter off, the tire runs on a FlatTerrain at the
+// terrain height set before initialization (and uses the flat terrain contact
+// test); with it on, the terrain height input is read at every step. The
+// outputs are the tire force, its application point and the tire moment.
+//
+// Variables (value references, see tire/modelDescription.xml):
+//
+//   Real     0 -  2   wheel position                 input
+//            3 -  6   wheel orientation (e0..e3)     input
+//            7 -  9   wheel linear velocity          input
+//           10 - 12   wheel angular velocity         input
+//           13        wheel angular speed            input
+//           14        terrain height                 input
+//           15 - 17   tire force                     output
+//           18 - 20   force application point        output
+//           21 - 23   tire moment                    output
+//           24        step size                      parameter
+//   Integer  0        wheel side (0: left, 1: right) parameter
+//   Boolean  0        driven wheel                   parameter
+//            1        height input                   parameter
+//   String   0        Pacejka parameter file         parameter
+//
+// =============================================================================
+
+#ifndef CH_FMU_TIRE_H
+#define CH_FMU_TIRE_H
+
+#include <string>
+
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/tire/ChPacejkaTire.h"
+
+#include "fmu/ChFmuComponent.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Horizontal terrain at a height set by an FMU input.
+///
+class ChFmuHeightTerrain : public ChTerrain
+{
+public:
+
+  ChFmuHeightTerrain(const double& height) : m_height(height) {}
+
+  virtual double GetHeight(double x, double y) const { return m_height; }
+  virtual ChVector<> GetNormal(double x, double y) const { return ChVector<>(0, 0, 1); }
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const { return m_height; }
+
+private:
+
+  const double& m_height;   // terrain height input
+};
+
+///
+/// Pacejka tire FMU.
+///
+class ChFmuTire : public ChFmuComponent
+{
+public:
+
+  ChFmuTire(
+    const std::string& instance_name,   ///< [in] name of the FMU instance
+    const std::string& resource_uri     ///< [in] URI of the resources directory of the FMU
+    );
+
+  ~ChFmuTire() {}
+
+protected:
+
+  virtual bool Setup();
+  virtual bool Advance(double time, double step);
+  virtual void UpdateOutputs();
+  virtual void SaveModules(ChVehicleState& state) const;
+  virtual bool RestoreModules(ChVehicleState& state);
+
+private:
+
+  // Parameters
+  std::string  m_tire_file;
+  int          m_side;
+  bool         m_driven;
+  bool         m_height_input;
+
+  // Inputs and outputs
+  ChWheelState m_wheel_state;
+  double       m_terrain_height;
+  ChTireForce  m_tire_force;
+
+  ChSharedPtr<ChTerrain>     m_terrain;
+  ChSharedPtr<ChPacejkaTire> m_tire;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
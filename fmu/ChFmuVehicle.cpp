@@ -0,0 +1,233 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A full vehicle exported as an FMI 2.0 co-simulation FMU.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/powertrain/SimplePowertrain.h"
+#include "subsys/powertrain/MapPowertrain.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "fmu/ChFmuVehicle.h"
+
+#include "rapidjson/document.h"
+
+using namespace rapidjson;
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFmuDriver::Update(double time)
+{
+  SetThrottle(m_throttle);
+  SetSteering(m_steering);
+  SetBraking(m_braking);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFmuVehicle::ChFmuVehicle(const std::string& instance_name,
+                           const std::string& resource_uri)
+: ChFmuComponent(instance_name, resource_uri),
+  m_vehicle_file("hmmwv/vehicle/HMMWV_Vehicle.json"),
+  m_powertrain_file("hmmwv/powertrain/HMMWV_SimplePowertrain.json"),
+  m_tire_file("hmmwv/pactest.tir"),
+  m_init_loc(0, 0, 1),
+  m_terrain_height(0),
+  m_chassis_pos(0, 0, 0),
+  m_chassis_rot(1, 0, 0, 0),
+  m_speed(0),
+  m_engine_speed(0),
+  m_driver(new ChFmuDriver)
+{
+  MapReal(0, m_driver->GetThrottleInput(), INPUT);
+  MapReal(1, m_driver->GetSteeringInput(), INPUT);
+  MapReal(2, m_driver->GetBrakingInput(), INPUT);
+  MapReal(3, &m_chassis_pos.x, OUTPUT);
+  MapReal(4, &m_chassis_pos.y, OUTPUT);
+  MapReal(5, &m_chassis_pos.z, OUTPUT);
+  MapReal(6, &m_chassis_rot.e0, OUTPUT);
+  MapReal(7, &m_chassis_rot.e1, OUTPUT);
+  MapReal(8, &m_chassis_rot.e2, OUTPUT);
+  MapReal(9, &m_chassis_rot.e3, OUTPUT);
+  MapReal(10, &m_speed, OUTPUT);
+  MapReal(11, &m_engine_speed, OUTPUT);
+  MapReal(12, &m_step_size, PARAMETER);
+  MapReal(13, &m_init_loc.x, PARAMETER);
+  MapReal(14, &m_init_loc.y, PARAMETER);
+  MapReal(15, &m_init_loc.z, PARAMETER);
+  MapReal(16, &m_terrain_height, PARAMETER);
+
+  MapString(0, &m_vehicle_file, PARAMETER);
+  MapString(1, &m_powertrain_file, PARAMETER);
+  MapString(2, &m_tire_file, PARAMETER);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChFmuVehicle::Setup()
+{
+  if (m_vehicle_file.empty() || m_powertrain_file.empty()) {
+    GetLog() << "ERROR: FMU " << GetInstanceName().c_str() << ": no vehicle or powertrain file\n";
+    return false;
+  }
+
+  if (!GetResourceDir().empty())
+    SetDataPath(GetResourceDir() + "/");
+
+  m_vehicle = ChSharedPtr<Vehicle>(new Vehicle(GetDataFile(m_vehicle_file)));
+  m_vehicle->Initialize(ChCoordsys<>(m_init_loc, QUNIT));
+  m_vehicle->SetStepsize(m_step_size);
+
+  m_terrain = ChSharedPtr<FlatTerrain>(new FlatTerrain(m_terrain_height));
+
+  CreatePowertrain();
+  if (!CreateTires()) {
+    m_vehicle = ChSharedPtr<Vehicle>();
+    return false;
+  }
+
+  int num_wheels = 2 * m_vehicle->GetNumberAxles();
+  m_wheel_states.resize(num_wheels);
+  m_tire_forces.resize(num_wheels);
+
+  return true;
+}
+
+// SimplePowertrain or MapPowertrain, as specified by the JSON template
+void ChFmuVehicle::CreatePowertrain()
+{
+  std::string filename = GetDataFile(m_powertrain_file);
+  const Document& doc = ChJsonCache::Get(filename);
+
+  if (doc.HasMember("Template") && std::string(doc["Template"].GetString()) == "MapPowertrain") {
+    ChSharedPtr<MapPowertrain> powertrain(new MapPowertrain(filename));
+    powertrain->Initialize();
+    m_powertrain = powertrain;
+  } else {
+    ChSharedPtr<SimplePowertrain> powertrain(new SimplePowertrain(filename));
+    powertrain->Initialize();
+    m_powertrain = powertrain;
+  }
+}
+
+bool ChFmuVehicle::CreateTires()
+{
+  int num_wheels = 2 * m_vehicle->GetNumberAxles();
+  m_tires.resize(num_wheels);
+
+  if (m_tire_file.empty()) {
+    if (!m_vehicle->CreateTires(*m_terrain, m_tires)) {
+      GetLog() << "ERROR: FMU " << GetInstanceName().c_str() << ": cannot create the vehicle tires\n";
+      return false;
+    }
+    return true;
+  }
+
+  const std::vector<int>& driven_axles = m_vehicle->GetDriveline()->GetDrivenAxleIndexes();
+  for (int i = 0; i < num_wheels; i++) {
+    char tire_name[16];
+    sprintf(tire_name, "W%d", i);
+    bool driven = std::find(driven_axles.begin(), driven_axles.end(), i / 2) != driven_axles.end();
+    ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire(tire_name, GetDataFile(m_tire_file), *m_terrain));
+    tire->Initialize(ChWheelID(i).side(), driven);
+    m_tires[i] = tire;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Collect the module outputs, then update and advance the modules.
+// -----------------------------------------------------------------------------
+bool ChFmuVehicle::Advance(double time, double step)
+{
+  double powertrain_torque = m_powertrain->GetOutputTorque();
+  double driveshaft_speed = m_vehicle->GetDriveshaftSpeed();
+  m_vehicle->GetWheelStates(m_wheel_states);
+  for (size_t i = 0; i < m_tires.size(); i++)
+    m_tire_forces[(int)i] = m_tires[i]->GetTireForce();
+
+  m_driver->Update(time);
+  m_terrain->Update(time);
+  for (size_t i = 0; i < m_tires.size(); i++)
+    m_tires[i]->Update(time, m_wheel_states[(int)i]);
+  m_powertrain->Update(time, m_driver->GetThrottle(), driveshaft_speed);
+  m_vehicle->Update(time, m_driver->GetSteering(), m_driver->GetBraking(), powertrain_torque, m_tire_forces);
+
+  m_driver->Advance(step);
+  m_terrain->Advance(step);
+  for (size_t i = 0; i < m_tires.size(); i++)
+    m_tires[i]->Advance(step);
+  m_powertrain->Advance(step);
+  m_vehicle->Advance(step);
+
+  return true;
+}
+
+void ChFmuVehicle::UpdateOutputs()
+{
+  m_chassis_pos = m_vehicle->GetChassisPos();
+  m_chassis_rot = m_vehicle->GetChassisRot();
+  m_speed = m_vehicle->GetVehicleSpeed();
+  m_engine_speed = m_powertrain->GetMotorSpeed();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFmuVehicle::SaveModules(ChVehicleState& state) const
+{
+  m_vehicle->SaveState(state);
+  m_powertrain->SaveState(state);
+  m_driver->SaveState(state);
+  for (size_t i = 0; i < m_tires.size(); i++)
+    m_tires[i]->SaveState(state);
+}
+
+bool ChFmuVehicle::RestoreModules(ChVehicleState& state)
+{
+  bool ok = m_vehicle->RestoreState(state) &&
+            m_powertrain->RestoreState(state) &&
+            m_driver->RestoreState(state);
+  for (size_t i = 0; ok && i < m_tires.size(); i++)
+    ok = m_tires[i]->RestoreState(state);
+
+  return ok;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFmuComponent* CreateFmuComponent(const std::string& instance_name,
+                                   const std::string& resource_uri)
+{
+  return new ChFmuVehicle(instance_name, resource_uri);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,140 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A full vehicle (JSON vehicle, powertrain and tires on a flat terrain)
+// exported as an FMI 2.0 co-simulation FMU.
+//
+// The inputs are the driver inputs, mapped onto the inputs of the driver
+// module; they are clamped to their ranges at each internal step. The outputs
+// are the chassis pose and speed, and the engine speed. The modules are
+// updated and advanced in the same sequence as in ChVehicleSimulation.
+//
+// The file parameters are relative to the resources directory of the FMU,
+// which is also the data directory of the JSON files (see SetDataPath()). If
+// no tire file is specified, the tires listed in the vehicle JSON file are
+// used; otherwise, a Pacejka tire with the specified parameter file is used on
+// each wheel.
+//
+// Variables (value references, see vehicle/modelDescription.xml):
+//
+//   Real     0        throttle [0,1]                 input
+//            1        steering [-1,1]                input
+//            2        braking [0,1]                  input
+//            3 -  5   chassis position               output
+//            6 -  9   chassis orientation (e0..e3)   output
+//           10        vehicle speed                  output
+//           11        engine speed                   output
+//           12        step size                      parameter
+//           13 - 15   initial chassis position       parameter
+//           16        terrain height                 parameter
+//   String   0        vehicle JSON file              parameter
+//            1        powertrain JSON file           parameter
+//            2        Pacejka parameter file         parameter
+//
+// =============================================================================
+
+#ifndef CH_FMU_VEHICLE_H
+#define CH_FMU_VEHICLE_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/vehicle/Vehicle.h"
+
+#include "fmu/ChFmuComponent.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Driver with inputs set through FMU variables.
+///
+class ChFmuDriver : public ChDriver
+{
+public:
+
+  ChFmuDriver() {}
+  ~ChFmuDriver() {}
+
+  /// Get the members holding the driver inputs.
+  double* GetThrottleInput() { return &m_throttle; }
+  double* GetSteeringInput() { return &m_steering; }
+  double* GetBrakingInput()  { return &m_braking; }
+
+  /// Clamp the inputs to their ranges.
+  virtual void Update(double time);
+};
+
+///
+/// Full vehicle FMU.
+///
+class ChFmuVehicle : public ChFmuComponent
+{
+public:
+
+  ChFmuVehicle(
+    const std::string& instance_name,   ///< [in] name of the FMU instance
+    const std::string& resource_uri     ///< [in] URI of the resources directory of the FMU
+    );
+
+  ~ChFmuVehicle() {}
+
+protected:
+
+  virtual bool Setup();
+  virtual bool Advance(double time, double step);
+  virtual void UpdateOutputs();
+  virtual void SaveModules(ChVehicleState& state) const;
+  virtual bool RestoreModules(ChVehicleState& state);
+
+private:
+
+  void CreatePowertrain();
+  bool CreateTires();
+
+  // Parameters
+  std::string     m_vehicle_file;
+  std::string     m_powertrain_file;
+  std::string     m_tire_file;
+  ChVector<>      m_init_loc;
+  double          m_terrain_height;
+
+  // Outputs
+  ChVector<>      m_chassis_pos;
+  ChQuaternion<>  m_chassis_rot;
+  double          m_speed;
+  double          m_engine_speed;
+
+  ChSharedPtr<Vehicle>               m_vehicle;
+  ChSharedPtr<ChPowertrain>          m_powertrain;
+  ChSharedPtr<ChFmuDriver>           m_driver;
+  ChSharedPtr<ChTerrain>             m_terrain;
+  std::vector<ChSharedPtr<ChTire> >  m_tires;
+
+  ChWheelStates   m_wheel_states;
+  ChTireForces    m_tire_forces;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,395 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// FMI 2.0 co-simulation interface of the vehicle module FMUs.
+//
+// The functions of the interface forward to the component created by
+// CreateFmuComponent(), which each FMU library implements. The FMU state is a
+// ChVehicleState snapshot of the component; it is serialized as the array of
+// its values.
+//
+// =============================================================================
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "fmi2Functions.h"
+
+#include "fmu/ChFmuComponent.h"
+
+using namespace chrono::vehicle;
+
+
+namespace {
+
+struct Instance {
+  ChFmuComponent*              component;
+  const fmi2CallbackFunctions* functions;
+  bool                         logging;
+  std::string                  name;
+  std::string                  resource_uri;
+};
+
+fmi2Status Fail(fmi2Component c, const char* message)
+{
+  Instance* instance = (Instance*)c;
+  if (instance->functions && instance->functions->logger)
+    instance->functions->logger(instance->functions->componentEnvironment, instance->name.c_str(), fmi2Error,
+                                "logStatusError", "%s", message);
+
+  return fmi2Error;
+}
+
+fmi2Status Log(fmi2Component c, const char* message)
+{
+  Instance* instance = (Instance*)c;
+  if (instance->logging && instance->functions && instance->functions->logger)
+    instance->functions->logger(instance->functions->componentEnvironment, instance->name.c_str(), fmi2OK,
+                                "logAll", "%s", message);
+
+  return fmi2OK;
+}
+
+ChFmuComponent* Component(fmi2Component c)
+{
+  return ((Instance*)c)->component;
+}
+
+}  // end anonymous namespace
+
+
+extern "C" {
+
+// -----------------------------------------------------------------------------
+// Inquire version numbers and set debug logging
+// -----------------------------------------------------------------------------
+FMI2_Export const char* fmi2GetTypesPlatform()
+{
+  return fmi2TypesPlatform;
+}
+
+FMI2_Export const char* fmi2GetVersion()
+{
+  return fmi2Version;
+}
+
+FMI2_Export fmi2Status fmi2SetDebugLogging(fmi2Component c, fmi2Boolean loggingOn, size_t nCategories,
+                                           const fmi2String categories[])
+{
+  ((Instance*)c)->logging = (loggingOn != fmi2False);
+  return fmi2OK;
+}
+
+// -----------------------------------------------------------------------------
+// Creation and destruction of an FMU instance
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+                                          fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions,
+                                          fmi2Boolean visible, fmi2Boolean loggingOn)
+{
+  if (fmuType != fmi2CoSimulation)
+    return 0;
+
+  Instance* instance = new Instance;
+  instance->name = instanceName ? instanceName : "";
+  instance->functions = functions;
+  instance->resource_uri = fmuResourceLocation ? fmuResourceLocation : "";
+  instance->logging = (loggingOn != fmi2False);
+  instance->component = CreateFmuComponent(instance->name, instance->resource_uri);
+
+  return instance;
+}
+
+FMI2_Export void fmi2FreeInstance(fmi2Component c)
+{
+  if (!c)
+    return;
+
+  delete Component(c);
+  delete (Instance*)c;
+}
+
+// -----------------------------------------------------------------------------
+// Initialization, termination and reset
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean toleranceDefined, fmi2Real tolerance,
+                                           fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime)
+{
+  Component(c)->SetStartTime(startTime);
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c)
+{
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c)
+{
+  if (!Component(c)->Initialize())
+    return Fail(c, "cannot initialize the modules");
+
+  return Log(c, "initialized");
+}
+
+FMI2_Export fmi2Status fmi2Terminate(fmi2Component c)
+{
+  return fmi2OK;
+}
+
+// The modules cannot be reconstructed in place, so the component is replaced
+// by a new one (with the default parameters).
+FMI2_Export fmi2Status fmi2Reset(fmi2Component c)
+{
+  Instance* instance = (Instance*)c;
+  delete instance->component;
+  instance->component = CreateFmuComponent(instance->name, instance->resource_uri);
+
+  return fmi2OK;
+}
+
+// -----------------------------------------------------------------------------
+// Getting and setting variable values
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->GetReal(vr[i], value[i]))
+      return Fail(c, "invalid Real value reference");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                      fmi2Integer value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->GetInteger(vr[i], value[i]))
+      return Fail(c, "invalid Integer value reference");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                      fmi2Boolean value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    bool val;
+    if (!Component(c)->GetBoolean(vr[i], val))
+      return Fail(c, "invalid Boolean value reference");
+    value[i] = val ? fmi2True : fmi2False;
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                     fmi2String value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->GetString(vr[i], value[i]))
+      return Fail(c, "invalid String value reference");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                   const fmi2Real value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->SetReal(vr[i], value[i]))
+      return Fail(c, "cannot set Real variable");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                      const fmi2Integer value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->SetInteger(vr[i], value[i]))
+      return Fail(c, "cannot set Integer variable");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                      const fmi2Boolean value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->SetBoolean(vr[i], value[i] != fmi2False))
+      return Fail(c, "cannot set Boolean variable");
+  }
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                     const fmi2String value[])
+{
+  for (size_t i = 0; i < nvr; i++) {
+    if (!Component(c)->SetString(vr[i], value[i]))
+      return Fail(c, "cannot set String variable");
+  }
+  return fmi2OK;
+}
+
+// -----------------------------------------------------------------------------
+// Getting, setting and serializing the FMU state
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
+{
+  if (!Component(c)->IsInitialized())
+    return Fail(c, "no FMU state before initialization");
+
+  ChVehicleState* state = (ChVehicleState*)*FMUstate;
+  if (!state)
+    state = new ChVehicleState;
+
+  state->Clear();
+  Component(c)->SaveState(*state);
+  *FMUstate = state;
+
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate FMUstate)
+{
+  ChVehicleState* state = (ChVehicleState*)FMUstate;
+  if (!state || !Component(c)->IsInitialized())
+    return Fail(c, "cannot set the FMU state");
+
+  state->Rewind();
+  if (!Component(c)->RestoreState(*state))
+    return Fail(c, "the FMU state does not match the modules");
+
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
+{
+  delete (ChVehicleState*)*FMUstate;
+  *FMUstate = 0;
+
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t* size)
+{
+  *size = ((ChVehicleState*)FMUstate)->GetSize() * sizeof(double);
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[],
+                                             size_t size)
+{
+  const ChVehicleState* state = (const ChVehicleState*)FMUstate;
+  if (size < state->GetSize() * sizeof(double))
+    return Fail(c, "serialized FMU state buffer too small");
+
+  if (state->GetSize() > 0)
+    std::memcpy(serializedState, state->GetData(), state->GetSize() * sizeof(double));
+
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte serializedState[], size_t size,
+                                               fmi2FMUstate* FMUstate)
+{
+  std::vector<double> vals(size / sizeof(double));
+  if (!vals.empty())
+    std::memcpy(&vals[0], serializedState, vals.size() * sizeof(double));
+
+  ChVehicleState* state = (ChVehicleState*)*FMUstate;
+  if (!state)
+    state = new ChVehicleState;
+
+  state->Assign(vals.empty() ? 0 : &vals[0], vals.size());
+  *FMUstate = state;
+
+  return fmi2OK;
+}
+
+// -----------------------------------------------------------------------------
+// Derivatives (not provided)
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Status fmi2GetDirectionalDerivative(fmi2Component c, const fmi2ValueReference vUnknown_ref[],
+                                                    size_t nUnknown, const fmi2ValueReference vKnown_ref[],
+                                                    size_t nKnown, const fmi2Real dvKnown[], fmi2Real dvUnknown[])
+{
+  return Fail(c, "directional derivatives are not provided");
+}
+
+FMI2_Export fmi2Status fmi2SetRealInputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                                   const fmi2Integer order[], const fmi2Real value[])
+{
+  return Fail(c, "input derivatives are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetRealOutputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+                                                    const fmi2Integer order[], fmi2Real value[])
+{
+  return Fail(c, "output derivatives are not provided");
+}
+
+// -----------------------------------------------------------------------------
+// Stepping
+// -----------------------------------------------------------------------------
+FMI2_Export fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint,
+                                  fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint)
+{
+  if (!Component(c)->DoStep(currentCommunicationPoint, communicationStepSize))
+    return Fail(c, "step failed");
+
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2CancelStep(fmi2Component c)
+{
+  return Fail(c, "steps are not asynchronous");
+}
+
+FMI2_Export fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status* value)
+{
+  return Fail(c, "no status of this kind");
+}
+
+FMI2_Export fmi2Status fmi2GetRealStatus(fmi2Component c, const fmi2StatusKind s, fmi2Real* value)
+{
+  if (s != fmi2LastSuccessfulTime)
+    return Fail(c, "no Real status of this kind");
+
+  *value = Component(c)->GetTime();
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetIntegerStatus(fmi2Component c, const fmi2StatusKind s, fmi2Integer* value)
+{
+  return Fail(c, "no Integer status of this kind");
+}
+
+FMI2_Export fmi2Status fmi2GetBooleanStatus(fmi2Component c, const fmi2StatusKind s, fmi2Boolean* value)
+{
+  if (s != fmi2Terminated)
+    return Fail(c, "no Boolean status of this kind");
+
+  *value = fmi2False;
+  return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetStringStatus(fmi2Component c, const fmi2StatusKind s, fmi2String* value)
+{
+  return Fail(c, "no String status of this kind");
+}
+
+}  // end extern "C"
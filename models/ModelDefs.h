@@ -22,7 +22,8 @@
 enum VisualizationType {
   NONE,
   PRIMITIVES,
-  MESH
+  MESH,
+  LOD           // all of the above, selected by distance (see ChIrrVehicleLOD)
 };
 
 enum TireModelType {
@@ -19,6 +19,7 @@
 #include "assets/ChSphereShape.h"
 #include "assets/ChTriangleMeshShape.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 
 #include "utils/ChUtilsInputOutput.h"
@@ -70,7 +71,7 @@ Articulated_Trailer::Articulated_Trailer(ChSystem*         mysystem,
   ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
   sphere->GetSphereGeometry().rad = 0.1;
   sphere->Pos = m_chassisCOM;
-  m_chassis->AddAsset(sphere);
+  vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
 
   mysystem->Add(m_chassis);
 
@@ -89,10 +90,10 @@ Articulated_Trailer::Articulated_Trailer(ChSystem*         mysystem,
   ChSharedPtr<ChSphereShape> sphereB(new ChSphereShape);
   sphereB->GetSphereGeometry().rad = 0.1;
   sphereB->Pos = m_frontaxleCOM;
-  m_frontaxle->AddAsset(sphereB);
+  vehicle::ChDeferredAssets::AddAsset(m_frontaxle, sphereB);
   ChSharedPtr<ChBoxShape> boxB(new ChBoxShape);
   boxB->GetBoxGeometry().SetLengths(ChVector<>(0.1, 1.5, 0.1));
-  m_frontaxle->AddAsset(boxB);
+  vehicle::ChDeferredAssets::AddAsset(m_frontaxle, boxB);
 
   mysystem->Add(m_frontaxle);
 
@@ -189,6 +190,13 @@ void Articulated_Trailer::Initialize(const ChCoordsys<>& chassisPos,
   m_front_right_brake->Initialize(m_suspensions[0]->GetRevolute(RIGHT));
   m_rear_left_brake->Initialize(m_suspensions[1]->GetRevolute(LEFT));
   m_rear_right_brake->Initialize(m_suspensions[1]->GetRevolute(RIGHT));
+
+  // Filter the collision pairs between vehicle bodies
+  ChVehicle::SetCollisionFamily(m_chassis.get_ptr(), ChVehicle::CHASSIS_FAMILY, false, false);
+  for (int i = 0; i < 2; i++) {
+    ChVehicle::SetCollisionFamily(m_suspensions[i]->GetSpindleBody(LEFT), ChVehicle::WHEEL_FAMILY, false, false);
+    ChVehicle::SetCollisionFamily(m_suspensions[i]->GetSpindleBody(RIGHT), ChVehicle::WHEEL_FAMILY, false, false);
+  }
 }
 
 
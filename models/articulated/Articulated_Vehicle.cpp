@@ -21,6 +21,7 @@
 #include "assets/ChSphereShape.h"
 #include "assets/ChTriangleMeshShape.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 
 #include "utils/ChUtilsInputOutput.h"
@@ -66,7 +67,7 @@ Articulated_Vehicle::Articulated_Vehicle(const bool        fixed,
   ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
   sphere->GetSphereGeometry().rad = 0.1;
   sphere->Pos = m_chassisCOM;
-  m_chassis->AddAsset(sphere);
+  vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
 
   m_system->Add(m_chassis);
 
@@ -153,6 +154,9 @@ void Articulated_Vehicle::Initialize(const ChCoordsys<>& chassisPos)
   m_brakes[1]->Initialize(m_suspensions[0]->GetRevolute(RIGHT));
   m_brakes[2]->Initialize(m_suspensions[1]->GetRevolute(LEFT));
   m_brakes[3]->Initialize(m_suspensions[1]->GetRevolute(RIGHT));
+
+  // Filter the collision pairs between vehicle bodies
+  InitializeCollisionFamilies();
 }
 
 
@@ -247,11 +251,8 @@ void Articulated_Vehicle::Update(double              time,
   // Let the steering subsystem process the steering input.
   m_steering->Update(time, 0.5 * steering);
 
-  // Apply tire forces to spindle bodies.
-  m_suspensions[0]->ApplyTireForce(LEFT, tire_forces[FRONT_LEFT.id()]);
-  m_suspensions[0]->ApplyTireForce(RIGHT, tire_forces[FRONT_RIGHT.id()]);
-  m_suspensions[1]->ApplyTireForce(LEFT, tire_forces[REAR_LEFT.id()]);
-  m_suspensions[1]->ApplyTireForce(RIGHT, tire_forces[REAR_RIGHT.id()]);
+  // Apply tire forces to spindle bodies (all wheels in one pass).
+  ApplyTireForces(&tire_forces[0], 4);
 
   // Apply braking
   m_brakes[0]->ApplyBrakeModulation(braking);
@@ -29,9 +29,11 @@
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/driver/ChManeuverDriver.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
@@ -40,7 +42,6 @@
 #include "models/articulated/Articulated_Trailer.h"
 #include "models/articulated/Articulated_SimplePowertrain.h"
 #include "models/articulated/Articulated_RigidTire.h"
-#include "models/articulated/Articulated_FuncDriver.h"
 
 // If Irrlicht support is available...
 #if IRRLICHT_ENABLED
@@ -208,7 +209,8 @@ int main(int argc, char* argv[])
   driver.SetThrottleDelta(render_step_size / throttle_time);
   driver.SetBrakingDelta(render_step_size / braking_time);
 
-  // Set up the assets for rendering
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
   if (do_shadows)
@@ -216,7 +218,7 @@ int main(int argc, char* argv[])
     application.AddShadowAll();
   }
 #else
-  Articulated_FuncDriver driver;
+  ChManeuverDriver driver(vehicle::GetDataFile("generic/driver/Sample_FuncManeuver.json"));
 #endif
 
 
@@ -0,0 +1,85 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Compute the convex decomposition of collision meshes offline and write it
+// next to the OBJ files (see ChHullCache), so that simulations only load it.
+//
+// Usage: demo_BakeHulls [options] OBJ_file [OBJ_file ...]
+//   -clusters N       minimum number of hulls (default: 16)
+//   -decimation N     number of vertices of the decimated mesh (default: 0,
+//                     no decimation)
+//   -concavity C      maximum concavity of a hull (default: 100)
+//
+// The OBJ file names are given relative to the ChronoVehicle data directory.
+// The binary mesh file (see ChMeshCache) is written as well.
+//
+// =============================================================================
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "core/ChLog.h"
+#include "physics/ChGlobal.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChHullCache.h"
+
+using namespace chrono;
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  vehicle::ChHullCache::Params params;
+  int num_files = 0;
+  int num_failed = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-clusters") && i + 1 < argc) {
+      params.num_clusters = std::atoi(argv[++i]);
+      continue;
+    }
+    if (!strcmp(argv[i], "-decimation") && i + 1 < argc) {
+      params.target_decimation = std::atoi(argv[++i]);
+      continue;
+    }
+    if (!strcmp(argv[i], "-concavity") && i + 1 < argc) {
+      params.max_concavity = std::atof(argv[++i]);
+      continue;
+    }
+
+    std::string filename = vehicle::GetDataFile(argv[i]);
+    num_files++;
+
+    if (!vehicle::ChMeshCache::Bake(filename) || !vehicle::ChHullCache::Bake(filename, params)) {
+      num_failed++;
+      continue;
+    }
+
+    GetLog() << filename.c_str() << ": " << (int)vehicle::ChHullCache::GetHulls(filename).size() << " hulls\n";
+  }
+
+  if (num_files == 0) {
+    GetLog() << "Usage: demo_BakeHulls [-clusters N] [-decimation N] [-concavity C] OBJ_file [OBJ_file ...]\n";
+    return 1;
+  }
+
+  return (num_failed == 0) ? 0 : 1;
+}
@@ -15,6 +15,9 @@
 // Main driver function for a generic vehicle, using rigid tire-terrain contact.
 //
 // If using the Irrlicht interface, driver inputs are obtained from the keyboard.
+// With decoupled_render = true, the simulation runs on its own thread and the
+// Irrlicht window renders the latest published snapshot of the body poses, at
+// its own frame rate.
 //
 // The vehicle reference frame has Z up, X towards the front of the vehicle, and
 // Y pointing to the left.
@@ -29,8 +32,10 @@
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/terrain/RigidTerrain.h"
+#include "subsys/driver/ChManeuverDriver.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
@@ -38,13 +43,14 @@
 #include "models/generic/Generic_Vehicle.h"
 #include "models/generic/Generic_SimplePowertrain.h"
 #include "models/generic/Generic_RigidTire.h"
-#include "models/generic/Generic_FuncDriver.h"
 
 // If Irrlicht support is available...
 #if IRRLICHT_ENABLED
   // ...include additional headers
 # include "unit_IRRLICHT/ChIrrApp.h"
 # include "subsys/driver/ChIrrGuiDriver.h"
+# include "subsys/driver/ChRenderProxy.h"
+# include "subsys/driver/ChPhysicsThread.h"
 
   // ...and specify whether the demo should actually use Irrlicht
 # define USE_IRRLICHT
@@ -84,6 +90,10 @@ double output_step_size = 1.0 / 1;    // once a second
 // Point on chassis tracked by the camera (Irrlicht only)
 ChVector<> trackPoint(0.0, 0.0, 1.75);
 
+// Run the simulation on a separate thread, decoupled from the rendering
+// (Irrlicht only)
+bool decoupled_render = false;
+
 // Simulation length (Povray only)
 double tend = 20.0;
 
@@ -133,7 +143,14 @@ int main(int argc, char* argv[])
 
 #ifdef USE_IRRLICHT
 
-  irr::ChIrrApp application(vehicle.GetSystem(),
+  // With decoupled rendering, the application renders proxy bodies in a
+  // separate system, updated from the snapshots published by the simulation.
+  ChSystem render_system;
+  ChRenderProxy* proxy = 0;
+  if (decoupled_render)
+    proxy = new ChRenderProxy(vehicle, powertrain, render_system);
+
+  irr::ChIrrApp application(decoupled_render ? &render_system : vehicle.GetSystem(),
                             L"Generic Vehicle Demo",
                             irr::core::dimension2d<irr::u32>(1000, 800),
                             false,
@@ -183,7 +200,11 @@ int main(int argc, char* argv[])
   driver.SetThrottleDelta(render_step_size / throttle_time);
   driver.SetBrakingDelta(render_step_size / braking_time);
 
-  // Set up the assets for rendering
+  if (proxy)
+    driver.SetRenderProxy(proxy);
+
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
 
@@ -192,7 +213,7 @@ int main(int argc, char* argv[])
 
 #else
 
-  Generic_FuncDriver driver;
+  ChManeuverDriver driver(vehicle::GetDataFile("generic/driver/Sample_FuncManeuver.json"));
 
 #endif
 
@@ -229,6 +250,38 @@ int main(int argc, char* argv[])
 
   ChRealtimeStepTimer realtime_timer;
 
+  if (decoupled_render) {
+    std::vector<ChTire*> tires(4);
+    tires[FRONT_LEFT.id()] = &tire_front_left;
+    tires[FRONT_RIGHT.id()] = &tire_front_right;
+    tires[REAR_LEFT.id()] = &tire_rear_left;
+    tires[REAR_RIGHT.id()] = &tire_rear_right;
+
+    ChPhysicsThread physics(vehicle, powertrain, terrain, tires, *proxy, step_size, render_step_size);
+    physics.Start();
+
+    // Render the latest snapshot at the frame rate of the application; the
+    // camera follows the proxy of the chassis.
+    while (application.GetDevice()->run())
+    {
+      proxy->Update();
+
+      application.GetVideoDriver()->beginScene(true, true, irr::video::SColor(255, 140, 161, 192));
+      driver.DrawAll();
+      application.GetVideoDriver()->endScene();
+
+      driver.Advance(realtime_timer.SuggestSimulationStep(render_step_size));
+    }
+
+    physics.Stop();
+    physics.Join();
+
+    application.GetDevice()->drop();
+    delete proxy;
+
+    return 0;
+  }
+
   while (application.GetDevice()->run())
   {
     // Render scene
@@ -16,6 +16,13 @@
 // contact.
 //
 // If using the Irrlicht interface, driver inputs are obtained from the keyboard.
+// With decoupled_render = true, the simulation runs on its own thread and the
+// Irrlicht window renders the latest published snapshot of the body poses, at
+// its own frame rate.
+//
+// If HEADLESS_PROFILE is defined (demo_HMMWV_headless target), the demo runs
+// without visualization assets, render output or per-frame console output, and
+// reports the achieved throughput and a per-module time breakdown at the end.
 //
 // The vehicle reference frame has Z up, X towards the front of the vehicle, and
 // Y pointing to the left.
@@ -26,13 +33,15 @@
 
 #include "core/ChFileutils.h"
 #include "core/ChStream.h"
-#include "core/ChRealtimeStep.h"
+#include "core/ChTimer.h"
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/driver/ChManeuverDriver.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
@@ -42,13 +51,18 @@
 #include "models/hmmwv/powertrain/HMMWV_SimplePowertrain.h"
 #include "models/hmmwv/tire/HMMWV_RigidTire.h"
 #include "models/hmmwv/tire/HMMWV_LugreTire.h"
-#include "models/hmmwv/HMMWV_FuncDriver.h"
 
-// If Irrlicht support is available...
-#if IRRLICHT_ENABLED
+// If Irrlicht support is available (and this is not the headless profile)...
+#if IRRLICHT_ENABLED && !defined(HEADLESS_PROFILE)
   // ...include additional headers
+# include "core/ChRealtimeStep.h"
 # include "unit_IRRLICHT/ChIrrApp.h"
 # include "subsys/driver/ChIrrGuiDriver.h"
+# include "subsys/driver/ChRenderProxy.h"
+# include "subsys/driver/ChPhysicsThread.h"
+# include "subsys/driver/ChPoseStream.h"
+# include "subsys/driver/ChIrrVehicleLOD.h"
+# include "subsys/driver/ChIrrInstancer.h"
 
   // ...and specify whether the demo should actually use Irrlicht
 # define USE_IRRLICHT
@@ -95,11 +109,39 @@ double output_step_size = 1.0 / 1;    // once a second
 #ifdef USE_IRRLICHT
   // Point on chassis tracked by the camera
   ChVector<> trackPoint(0.0, 0.0, 1.75);
+
+  // Run the simulation on a separate thread, decoupled from the rendering
+  bool decoupled_render = false;
+
+  // With decoupled rendering, also stream the snapshots over UDP to a remote
+  // viewer (see demo_PoseViewer) if a host is specified. The viewer reads the
+  // visualization assets from stream_assets.dat.
+  std::string stream_host = "";
+  int         stream_port = 50000;
+
+  // Switch between mesh, primitives and impostor visualization of the vehicle
+  // based on its distance to the camera
+  bool use_lod = false;
+
+  // Draw bodies with identical assets (wheels, obstacles) as instances of a
+  // single mesh (see ChIrrInstancer)
+  bool use_instancing = false;
+#elif defined(HEADLESS_PROFILE)
+  double tend = 20.0;
 #else
   double tend = 20.0;
 
   const std::string out_dir = "../HMMWV";
   const std::string pov_dir = out_dir + "/POVRAY";
+
+  // Incremental PovRay output: the visualization assets are written once and
+  // only the body poses at each render frame (set incremental = true in
+  // renderZ.pov to render these files).
+  bool povray_incremental = true;
+
+  // With incremental output, also record the body poses of all render frames
+  // in a single binary file (see demo_RenderPoses).
+  bool pose_stream = true;
 #endif
 
 // =============================================================================
@@ -113,10 +155,22 @@ int main(int argc, char* argv[])
   // --------------------------
 
   // Create the HMMWV vehicle
+#ifdef HEADLESS_PROFILE
+  HMMWV_Vehicle vehicle(false,
+                        RWD,
+                        NONE,
+                        NONE);
+#elif defined(USE_IRRLICHT)
+  HMMWV_Vehicle vehicle(false,
+                        RWD,
+                        use_lod ? LOD : PRIMITIVES,
+                        use_lod ? LOD : MESH);
+#else
   HMMWV_Vehicle vehicle(false,
                         RWD,
                         PRIMITIVES,
                         MESH);
+#endif
 
   vehicle.Initialize(ChCoordsys<>(initLoc, initRot));
 
@@ -217,9 +271,26 @@ int main(int argc, char* argv[])
   }
   }
 
+#ifdef HEADLESS_PROFILE
+  // Only rigid tires use Chrono contact; with any other tire model, the
+  // collision shapes of the terrain and obstacles are only seen by the renderer.
+  if (tire_model != RIGID) {
+    std::vector<ChBody*>::iterator ibody = vehicle.GetSystem()->Get_bodylist()->begin();
+    for (; ibody != vehicle.GetSystem()->Get_bodylist()->end(); ++ibody)
+      (*ibody)->SetCollide(false);
+  }
+#endif
+
 
 #ifdef USE_IRRLICHT
-  irr::ChIrrApp application(vehicle.GetSystem(),
+  // With decoupled rendering, the application renders proxy bodies in a
+  // separate system, updated from the snapshots published by the simulation.
+  ChSystem render_system;
+  ChRenderProxy* proxy = 0;
+  if (decoupled_render)
+    proxy = new ChRenderProxy(vehicle, *powertrain.get_ptr(), render_system);
+
+  irr::ChIrrApp application(decoupled_render ? &render_system : vehicle.GetSystem(),
                             L"HMMWV demo",
                             irr::core::dimension2d<irr::u32>(1000, 800),
                             false,
@@ -270,15 +341,29 @@ int main(int argc, char* argv[])
   driver.SetThrottleDelta(render_step_size / throttle_time);
   driver.SetBrakingDelta(render_step_size / braking_time);
 
-  // Set up the assets for rendering
+  if (proxy)
+    driver.SetRenderProxy(proxy);
+
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
   if (do_shadows)
   {
     application.AddShadowAll();
   }
+
+  // Level-of-detail selection (rendering of the simulated system only)
+  ChIrrVehicleLOD lod;
+  if (use_lod && !decoupled_render)
+    lod.AddVehicle(vehicle);
+
+  // Instanced rendering (bodies with level-of-detail groups are skipped)
+  ChIrrInstancer instancer(application);
+  if (use_instancing)
+    instancer.AddBodies(application.GetSystem());
 #else
-  HMMWV_FuncDriver driver;
+  ChManeuverDriver driver(vehicle::GetDataFile("generic/driver/Sample_FuncManeuver.json"));
 #endif
 
 
@@ -314,6 +399,52 @@ int main(int argc, char* argv[])
 
   ChRealtimeStepTimer realtime_timer;
 
+  if (decoupled_render) {
+    std::vector<ChTire*> tires(4);
+    tires[FRONT_LEFT.id()] = tire_front_left.get_ptr();
+    tires[FRONT_RIGHT.id()] = tire_front_right.get_ptr();
+    tires[REAR_LEFT.id()] = tire_rear_left.get_ptr();
+    tires[REAR_RIGHT.id()] = tire_rear_right.get_ptr();
+
+    ChPosePublisher* publisher = 0;
+    if (!stream_host.empty()) {
+      utils::WriteAssetsPovray(vehicle.GetSystem(), "stream_assets.dat");
+      publisher = new ChPosePublisher(stream_host, stream_port);
+      if (publisher->Start())
+        proxy->SetPublisher(publisher);
+    }
+
+    ChPhysicsThread physics(vehicle, *powertrain.get_ptr(), terrain, tires, *proxy, step_size, render_step_size);
+    physics.Start();
+
+    // Render the latest snapshot at the frame rate of the application; the
+    // camera follows the proxy of the chassis.
+    while (application.GetDevice()->run())
+    {
+      proxy->Update();
+      driver.UpdateTimeWarp(proxy->GetSnapshot().time);
+
+      application.GetVideoDriver()->beginScene(true, true, irr::video::SColor(255, 140, 161, 192));
+      driver.DrawAll();
+      application.GetVideoDriver()->endScene();
+
+      driver.Advance(realtime_timer.SuggestSimulationStep(render_step_size));
+    }
+
+    physics.Stop();
+    physics.Join();
+
+    if (publisher) {
+      publisher->Stop();
+      delete publisher;
+    }
+
+    application.GetDevice()->drop();
+    delete proxy;
+
+    return 0;
+  }
+
   while (application.GetDevice()->run())
   {
     // update the position of the shadow mapping so that it follows the car
@@ -328,8 +459,13 @@ int main(int argc, char* argv[])
       mlight->setPosition(mlightpos);
     }
 
+    // In a time warp (key T), skip the rendering, except for a few progress
+    // frames, and the real-time pacing
+    bool warping = driver.UpdateTimeWarp(vehicle.GetSystem()->GetChTime());
+
     // Render scene
-    if (step_number % render_steps == 0) {
+    if (warping ? driver.IsTimeWarpFrame() : step_number % render_steps == 0) {
+      lod.Update(driver.GetCameraPos());
       application.GetVideoDriver()->beginScene(true, true, irr::video::SColor(255, 140, 161, 192));
       driver.DrawAll();
       application.GetVideoDriver()->endScene();
@@ -381,7 +517,7 @@ int main(int argc, char* argv[])
     vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
 
     // Advance simulation for one timestep for all modules
-    double step = realtime_timer.SuggestSimulationStep(step_size);
+    double step = warping ? step_size : realtime_timer.SuggestSimulationStep(step_size);
 
     driver.Advance(step);
 
@@ -404,6 +540,20 @@ int main(int argc, char* argv[])
 
 #else
 
+  // Wall-clock time spent in each module
+  ChTimer<double> timer;
+  double time_driver = 0;
+  double time_terrain = 0;
+  double time_tires = 0;
+  double time_powertrain = 0;
+  double time_vehicle = 0;
+  double time_collision = 0;
+  double time_lcp = 0;
+
+  ChTimer<double> total_timer;
+  total_timer.start();
+
+#ifndef HEADLESS_PROFILE
   int render_frame = 0;
 
   if(ChFileutils::MakeDirectory(out_dir.c_str()) < 0) {
@@ -419,12 +569,28 @@ int main(int argc, char* argv[])
 
   char filename[100];
 
+  utils::Pose_writer pose_writer;
+
+  if (povray_incremental) {
+    utils::WriteAssetsPovray(vehicle.GetSystem(), pov_dir + "/assets.dat");
+    if (pose_stream)
+      pose_writer.open(vehicle.GetSystem(), pov_dir + "/poses.bin");
+  }
+#endif
+
   while (time < tend)
   {
+#ifndef HEADLESS_PROFILE
     if (step_number % render_steps == 0) {
       // Output render data
-      sprintf(filename, "%s/data_%03d.dat", pov_dir.c_str(), render_frame + 1);
-      utils::WriteShapesPovray(vehicle.GetSystem(), filename);
+      if (povray_incremental) {
+        sprintf(filename, "%s/bodies_%03d.dat", pov_dir.c_str(), render_frame + 1);
+        utils::WriteBodiesPovray(vehicle.GetSystem(), filename);
+        pose_writer.write(vehicle.GetSystem());
+      } else {
+        sprintf(filename, "%s/data_%03d.dat", pov_dir.c_str(), render_frame + 1);
+        utils::WriteShapesPovray(vehicle.GetSystem(), filename);
+      }
       std::cout << "Output frame:   " << render_frame << std::endl;
       std::cout << "Sim frame:      " << step_number << std::endl;
       std::cout << "Time:           " << time << std::endl;
@@ -432,6 +598,7 @@ int main(int argc, char* argv[])
       std::cout << std::endl;
       render_frame++;
     }
+#endif
 
 #ifdef DEBUG_LOG
     if (step_number % output_steps == 0) {
@@ -463,37 +630,94 @@ int main(int argc, char* argv[])
     // Update modules (process inputs from other modules)
     time = vehicle.GetSystem()->GetChTime();
 
+    timer.start();
     driver.Update(time);
+    timer.stop();
+    time_driver += timer();
 
+    timer.start();
     terrain.Update(time);
+    timer.stop();
+    time_terrain += timer();
 
+    timer.start();
     tire_front_left->Update(time, wheel_states[FRONT_LEFT.id()]);
     tire_front_right->Update(time, wheel_states[FRONT_RIGHT.id()]);
     tire_rear_left->Update(time, wheel_states[REAR_LEFT.id()]);
     tire_rear_right->Update(time, wheel_states[REAR_RIGHT.id()]);
+    timer.stop();
+    time_tires += timer();
 
+    timer.start();
     powertrain->Update(time, throttle_input, driveshaft_speed);
+    timer.stop();
+    time_powertrain += timer();
 
+    timer.start();
     vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
+    timer.stop();
+    time_vehicle += timer();
 
     // Advance simulation for one timestep for all modules
+    timer.start();
     driver.Advance(step_size);
+    timer.stop();
+    time_driver += timer();
 
+    timer.start();
     terrain.Advance(step_size);
+    timer.stop();
+    time_terrain += timer();
 
+    timer.start();
     tire_front_right->Advance(step_size);
     tire_front_left->Advance(step_size);
     tire_rear_right->Advance(step_size);
     tire_rear_left->Advance(step_size);
+    timer.stop();
+    time_tires += timer();
 
+    timer.start();
     powertrain->Advance(step_size);
+    timer.stop();
+    time_powertrain += timer();
 
+    timer.start();
     vehicle.Advance(step_size);
+    timer.stop();
+    time_vehicle += timer();
+    time_collision += vehicle.GetSystem()->GetTimerCollisionBroad();
+    time_lcp += vehicle.GetSystem()->GetTimerLcp();
 
     // Increment frame number
     step_number++;
   }
 
+  total_timer.stop();
+
+#ifndef HEADLESS_PROFILE
+  pose_writer.close();
+#endif
+
+  // Throughput report
+  double wall_time = total_timer();
+  double other_time = wall_time - time_driver - time_terrain - time_tires - time_powertrain - time_vehicle;
+
+  std::cout << "Simulated time:    " << time << " s" << std::endl;
+  std::cout << "Wall-clock time:   " << wall_time << " s" << std::endl;
+  std::cout << "Real-time factor:  " << (time > 0 ? wall_time / time : 0) << std::endl;
+  std::cout << "Steps per second:  " << (wall_time > 0 ? step_number / wall_time : 0) << std::endl;
+  std::cout << std::endl;
+  std::cout << "Module times [s]" << std::endl;
+  std::cout << "  driver:          " << time_driver << std::endl;
+  std::cout << "  terrain:         " << time_terrain << std::endl;
+  std::cout << "  tires:           " << time_tires << std::endl;
+  std::cout << "  powertrain:      " << time_powertrain << std::endl;
+  std::cout << "  vehicle:         " << time_vehicle << std::endl;
+  std::cout << "    collision:     " << time_collision << std::endl;
+  std::cout << "    LCP solver:    " << time_lcp << std::endl;
+  std::cout << "  other / output:  " << other_time << std::endl;
+
 #endif
 
   return 0;
@@ -38,7 +38,7 @@ class PacTire_vehicle_panda:
         
         for i in range(0, self._num_tires):
             self._filenames.append(filename_list[i])
-            DF_curr = pd.read_csv(filename_list[i], header=0, sep=',')   # index_col=0,
+            DF_curr = tire.read_output(filename_list[i])
             self._DF.append( DF_curr )
             self._tires.append(tire_names[i])
             
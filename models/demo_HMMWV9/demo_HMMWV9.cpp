@@ -30,9 +30,11 @@
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/driver/ChManeuverDriver.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
@@ -42,7 +44,6 @@
 #include "models/hmmwv/powertrain/HMMWV_SimplePowertrain.h"
 #include "models/hmmwv/tire/HMMWV_RigidTire.h"
 #include "models/hmmwv/tire/HMMWV_LugreTire.h"
-#include "models/hmmwv/HMMWV_FuncDriver.h"
 
 // If Irrlicht support is available...
 #if IRRLICHT_ENABLED
@@ -276,7 +277,8 @@ int main(int argc, char* argv[])
   driver.SetThrottleDelta(render_step_size / throttle_time);
   driver.SetBrakingDelta(render_step_size / braking_time);
 
-  // Set up the assets for rendering
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
   if (do_shadows)
@@ -284,7 +286,7 @@ int main(int argc, char* argv[])
     application.AddShadowAll();
   }
 #else
-  HMMWV_FuncDriver driver;
+  ChManeuverDriver driver(vehicle::GetDataFile("generic/driver/Sample_FuncManeuver.json"));
 #endif
 
   // ---------------
@@ -0,0 +1,254 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Live viewer of a vehicle simulation running elsewhere (e.g. on a headless
+// cluster node), which streams its snapshots with a ChPosePublisher.
+//
+// Usage: demo_PoseViewer [asset file] [options]
+//   -port P           UDP port to listen on (default: 50000)
+//   -size W H         window size in pixels (default: 1000 800)
+//   -meshdir DIR      directory with the OBJ files of the meshes, named after
+//                     the mesh names in the asset table (default: .)
+//   -mesh NAME FILE   OBJ file of the named mesh (may be repeated)
+//   -follow ID        identifier of the body followed by the camera (default: 0,
+//                     the chassis of the vehicle models)
+//
+// The asset table is written by the simulation with utils::WriteAssetsPovray
+// (for the same system as the ChRenderProxy, before the simulation starts).
+// The viewer only receives; it never slows down the simulation, and frames
+// lost in transit are skipped.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/ChStream.h"
+#include "physics/ChSystem.h"
+#include "physics/ChBody.h"
+#include "assets/ChColorAsset.h"
+#include "core/ChMathematics.h"
+#include "collision/ChCCollisionModel.h"
+
+#include "unit_IRRLICHT/ChIrrApp.h"
+
+#include "subsys/driver/ChChaseCamera.h"
+#include "subsys/driver/ChIrrHUD.h"
+#include "subsys/driver/ChPoseStream.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+using namespace chrono;
+
+// =============================================================================
+
+// Camera settings (as in the interactive demos)
+ChVector<> trackPoint(0.0, 0.0, 1.75);
+double     chaseDist = 6.0;
+double     chaseHeight = 0.5;
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    GetLog() << "Usage: demo_PoseViewer [asset file] [options]\n";
+    return 1;
+  }
+
+  std::string assets_file = argv[1];
+  int port = 50000;
+  int width = 1000;
+  int height = 800;
+  std::string mesh_dir = ".";
+  std::map<std::string, std::string> meshes;
+  int follow = 0;
+
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    int left = argc - 1 - i;
+
+    if (arg == "-port" && left >= 1) {
+      port = std::atoi(argv[++i]);
+    } else if (arg == "-size" && left >= 2) {
+      width = std::atoi(argv[++i]);
+      height = std::atoi(argv[++i]);
+    } else if (arg == "-meshdir" && left >= 1) {
+      mesh_dir = argv[++i];
+    } else if (arg == "-mesh" && left >= 2) {
+      std::string name = argv[++i];
+      meshes[name] = argv[++i];
+    } else if (arg == "-follow" && left >= 1) {
+      follow = std::atoi(argv[++i]);
+    } else {
+      GetLog() << "Unknown or incomplete option " << arg.c_str() << "\n";
+      return 1;
+    }
+  }
+
+  utils::Pose_reader reader;
+  if (!reader.open_assets(assets_file))
+    return 1;
+
+  ChPoseSubscriber subscriber;
+  if (!subscriber.Open(port))
+    return 1;
+
+  // Create one fixed body per simulated body, with the recorded assets.
+  ChSystem system;
+  std::vector<ChSharedPtr<ChBody> > bodies(reader.get_num_bodies());
+  int followed = 0;
+
+  for (int i = 0; i < reader.get_num_bodies(); i++) {
+    bodies[i] = ChSharedPtr<ChBody>(new ChBody);
+    bodies[i]->SetIdentifier(std::atoi(reader.get_identifier(i).c_str()));
+    bodies[i]->SetBodyFixed(true);
+    bodies[i]->SetCollide(false);
+    system.AddBody(bodies[i]);
+
+    if (bodies[i]->GetIdentifier() == follow)
+      followed = i;
+  }
+
+  std::vector<bool> colored(bodies.size(), false);
+  const std::vector<utils::Pose_reader::Asset>& assets = reader.get_assets();
+
+  for (size_t k = 0; k < assets.size(); k++) {
+    std::string mesh_file;
+    if (assets[k].type == collision::TRIANGLEMESH) {
+      std::map<std::string, std::string>::const_iterator it = meshes.find(assets[k].name);
+      mesh_file = (it != meshes.end()) ? it->second : mesh_dir + "/" + assets[k].name + ".obj";
+    }
+
+    ChSharedPtr<ChVisualization> shape = utils::CreateAssetShape(assets[k], mesh_file);
+    if (shape.IsNull())
+      continue;
+
+    ChBody* body = bodies[assets[k].body].get_ptr();
+    body->AddAsset(shape);
+
+    // WriteAssetsPovray records one color per body.
+    if (!colored[assets[k].body]) {
+      body->AddAsset(ChSharedPtr<ChColorAsset>(new ChColorAsset(assets[k].color)));
+      colored[assets[k].body] = true;
+    }
+  }
+
+  // Create the Irrlicht application.
+  irr::ChIrrApp application(&system,
+                            L"Remote vehicle viewer",
+                            irr::core::dimension2d<irr::u32>(width, height),
+                            false,
+                            false);
+
+  application.AddTypicalLights(irr::core::vector3df(30.f, -30.f, 100.f),
+                               irr::core::vector3df(30.f, 50.f, 100.f),
+                               250, 130);
+
+  irr::scene::ICameraSceneNode* camera = application.GetSceneManager()->addCameraSceneNode(
+    application.GetSceneManager()->getRootSceneNode(),
+    irr::core::vector3df(0, 0, 0), irr::core::vector3df(0, 0, 0));
+  camera->setUpVector(irr::core::vector3df(0, 0, 1));
+
+  application.AssetBindAll();
+  application.AssetUpdateAll();
+
+  ChChaseCamera chase_camera(bodies[followed]);
+  chase_camera.Initialize(trackPoint, ChCoordsys<>(), chaseDist, chaseHeight);
+
+  // HUD (as in ChIrrGuiDriver)
+  ChIrrHUD hud(application, width - 260, 20);
+  int hud_status = hud.AddTextBox("%s", 10);
+  int hud_time = hud.AddTextBox("Time: %s", 30);
+  int hud_speed = hud.AddGauge("Speed: %+.2f", 1.0 / 30, false, 60);
+  int hud_rpm = hud.AddGauge("Eng. RPM: %+.2f", 1.0 / 7000, false, 80);
+  int hud_torque = hud.AddGauge("Eng. Nm: %+.2f", 1.0 / 600, false, 100);
+  int hud_gear = hud.AddTextBox("Gear: %s", 130);
+
+  ChRenderProxy::Snapshot snapshot;
+  int num_received = 0;
+  irr::u32 last_time = application.GetDevice()->getTimer()->getRealTime();
+  irr::u32 last_message = last_time;
+  char text[64];
+
+  while (application.GetDevice()->run())
+  {
+    irr::u32 now = application.GetDevice()->getTimer()->getRealTime();
+    double frame_time = (now - last_time) * 1e-3;
+    last_time = now;
+
+    // Move the bodies to the latest received poses.
+    if (subscriber.Receive(snapshot)) {
+      if (snapshot.poses.size() == bodies.size()) {
+        for (size_t i = 0; i < bodies.size(); i++)
+          bodies[i]->SetCoord(snapshot.poses[i]);
+        num_received++;
+        last_message = now;
+      } else {
+        GetLog() << "Warning: received " << (int)snapshot.poses.size() << " poses for "
+                 << (int)bodies.size() << " bodies\n";
+      }
+    }
+
+    chase_camera.Update(frame_time);
+
+    ChVector<> cam_pos = chase_camera.GetCameraPos();
+    ChVector<> cam_target = chase_camera.GetTargetPos();
+    camera->setPosition(irr::core::vector3df((irr::f32)cam_pos.x, (irr::f32)cam_pos.y, (irr::f32)cam_pos.z));
+    camera->setTarget(irr::core::vector3df((irr::f32)cam_target.x, (irr::f32)cam_target.y, (irr::f32)cam_target.z));
+
+    application.BeginScene(true, true, irr::video::SColor(255, 140, 161, 192));
+    application.DrawAll();
+
+    // Springs and distance links
+    if (num_received > 0) {
+      for (size_t i = 0; i + 1 < snapshot.springs.size(); i += 2)
+        irr::ChIrrTools::drawSpring(application.GetVideoDriver(), 0.05, snapshot.springs[i], snapshot.springs[i + 1],
+                                    irr::video::SColor(255, 150, 20, 20), 80, 15, true);
+      for (size_t i = 0; i + 1 < snapshot.distances.size(); i += 2)
+        irr::ChIrrTools::drawSegment(application.GetVideoDriver(), snapshot.distances[i], snapshot.distances[i + 1],
+                                     irr::video::SColor(255, 0, 20, 0), true);
+      for (size_t i = 0; i + 1 < snapshot.revsphs.size(); i += 2)
+        irr::ChIrrTools::drawSegment(application.GetVideoDriver(), snapshot.revsphs[i], snapshot.revsphs[i + 1],
+                                     irr::video::SColor(255, 180, 0, 0), true);
+    }
+
+    if (num_received == 0)
+      sprintf(text, "Waiting on port %d", port);
+    else if (now - last_message > 1000)
+      sprintf(text, "No data for %.0f s", (now - last_message) * 1e-3);
+    else
+      sprintf(text, "Receiving (%d frames)", num_received);
+    hud.SetText(hud_status, text);
+
+    if (num_received > 0) {
+      sprintf(text, "%.2f", snapshot.time);
+      hud.SetText(hud_time, text);
+      hud.SetValue(hud_speed, snapshot.speed);
+      hud.SetValue(hud_rpm, snapshot.motor_speed * 60 / CH_C_2PI);
+      hud.SetValue(hud_torque, snapshot.motor_torque);
+      sprintf(text, "%d", snapshot.gear);
+      hud.SetText(hud_gear, text);
+    }
+    hud.Draw();
+
+    application.EndScene();
+  }
+
+  return 0;
+}
@@ -0,0 +1,465 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Render a video from a recorded asset table (utils::WriteAssetsPovray) and
+// binary pose file (utils::Pose_writer), with Irrlicht.
+//
+// Usage: demo_RenderPoses [asset file] [pose file] [video file] [options]
+//   -size W H         frame size in pixels (default: 1280 720)
+//   -fps F            video frame rate (default: from the recorded times)
+//   -jobs N           number of render processes (default: number of cores)
+//   -displays D1,D2   X displays assigned in turn to the render processes,
+//                     e.g. :0.0,:0.1 to render on two GPUs (not on Windows)
+//   -meshdir DIR      directory with the OBJ files of the meshes, named after
+//                     the mesh names in the asset table (default: .)
+//   -mesh NAME FILE   OBJ file of the named mesh (may be repeated)
+//   -follow ID        identifier of the body followed by the camera (default:
+//                     the first body that moves)
+//   -soft             use the Irrlicht software renderer
+//   -ffmpeg PATH      ffmpeg executable (default: ffmpeg)
+//
+// The frames are split in contiguous ranges, each rendered by a separate
+// process (this program, started with the internal option -frames FIRST COUNT)
+// into a hidden window and piped, as raw RGB frames, to its own ffmpeg encoder.
+// The video segments are then joined without re-encoding.
+//
+// The camera is a chase camera behind the followed body. Each process starts
+// its camera filter a few seconds before its first frame, such that the camera
+// motion is continuous across segments.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/ChStream.h"
+#include "physics/ChSystem.h"
+#include "physics/ChBody.h"
+#include "assets/ChColorAsset.h"
+#include "collision/ChCCollisionModel.h"
+
+#include "unit_IRRLICHT/ChIrrApp.h"
+
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/driver/ChChaseCamera.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+#ifdef _WIN32
+# define popen _popen
+# define pclose _pclose
+#endif
+
+using namespace chrono;
+
+// =============================================================================
+
+// Camera settings (as in the interactive demos)
+ChVector<> trackPoint(0.0, 0.0, 1.75);
+double     chaseDist = 6.0;
+double     chaseHeight = 0.5;
+
+// Duration over which the camera filter is run before the first frame of a
+// segment [s]
+double     camera_warmup = 5.0;
+
+// =============================================================================
+
+struct Options {
+  Options()
+  : width(1280), height(720), fps(0), jobs(0), mesh_dir("."), follow(-1),
+    soft(false), ffmpeg("ffmpeg"), first(0), count(-1)
+  {}
+
+  std::string                          assets_file;
+  std::string                          poses_file;
+  std::string                          video_file;
+  int                                  width;
+  int                                  height;
+  double                               fps;
+  int                                  jobs;
+  std::vector<std::string>             displays;
+  std::string                          mesh_dir;
+  std::map<std::string, std::string>   meshes;
+  int                                  follow;
+  bool                                 soft;
+  std::string                          ffmpeg;
+  int                                  first;      // render process only
+  int                                  count;
+};
+
+static bool ParseOptions(int argc, char* argv[], Options& opt)
+{
+  if (argc < 4)
+    return false;
+
+  opt.assets_file = argv[1];
+  opt.poses_file = argv[2];
+  opt.video_file = argv[3];
+
+  for (int i = 4; i < argc; i++) {
+    std::string arg = argv[i];
+    int left = argc - 1 - i;
+
+    if (arg == "-size" && left >= 2) {
+      opt.width = std::atoi(argv[++i]);
+      opt.height = std::atoi(argv[++i]);
+    } else if (arg == "-fps" && left >= 1) {
+      opt.fps = std::atof(argv[++i]);
+    } else if (arg == "-jobs" && left >= 1) {
+      opt.jobs = std::atoi(argv[++i]);
+    } else if (arg == "-displays" && left >= 1) {
+      std::stringstream ss(argv[++i]);
+      std::string display;
+      while (std::getline(ss, display, ','))
+        if (!display.empty())
+          opt.displays.push_back(display);
+    } else if (arg == "-meshdir" && left >= 1) {
+      opt.mesh_dir = argv[++i];
+    } else if (arg == "-mesh" && left >= 2) {
+      std::string name = argv[++i];
+      opt.meshes[name] = argv[++i];
+    } else if (arg == "-follow" && left >= 1) {
+      opt.follow = std::atoi(argv[++i]);
+    } else if (arg == "-soft") {
+      opt.soft = true;
+    } else if (arg == "-ffmpeg" && left >= 1) {
+      opt.ffmpeg = argv[++i];
+    } else if (arg == "-frames" && left >= 2) {
+      opt.first = std::atoi(argv[++i]);
+      opt.count = std::atoi(argv[++i]);
+    } else {
+      GetLog() << "Unknown or incomplete option " << arg.c_str() << "\n";
+      return false;
+    }
+  }
+
+  return opt.width > 0 && opt.height > 0;
+}
+
+// Quote a command line argument.
+static std::string Quote(const std::string& arg)
+{
+  return "\"" + arg + "\"";
+}
+
+// =============================================================================
+// Render process: replay the frames [opt.first, opt.first + opt.count) and
+// encode them into opt.video_file.
+// =============================================================================
+
+// Create the visualization asset of a recorded shape (NULL if not supported).
+static ChSharedPtr<ChVisualization> CreateShape(const utils::Pose_reader::Asset& asset,
+                                                const Options&                   opt)
+{
+  std::string mesh_file;
+  if (asset.type == collision::TRIANGLEMESH) {
+    std::map<std::string, std::string>::const_iterator it = opt.meshes.find(asset.name);
+    mesh_file = (it != opt.meshes.end()) ? it->second : opt.mesh_dir + "/" + asset.name + ".obj";
+  }
+
+  return utils::CreateAssetShape(asset, mesh_file);
+}
+
+// Select the body followed by the camera: the specified identifier, or the
+// first body whose location changes over the recording.
+static int FindFollowedBody(const utils::Pose_reader& reader,
+                            const Options&            opt)
+{
+  int last = reader.get_num_frames() - 1;
+
+  for (int i = 0; i < reader.get_num_bodies(); i++) {
+    if (opt.follow >= 0) {
+      if (std::atoi(reader.get_identifier(i).c_str()) == opt.follow)
+        return i;
+    } else if ((reader.get_pos(last, i) - reader.get_pos(0, i)).Length2() > 1e-6) {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+static int RenderFrames(const utils::Pose_reader& reader,
+                        const Options&            opt,
+                        double                    fps)
+{
+  int num_frames = reader.get_num_frames();
+  int first = std::max(0, std::min(opt.first, num_frames));
+  int end = (opt.count < 0) ? num_frames : std::min(num_frames, first + opt.count);
+
+  // Create one fixed body per recorded body, with the recorded assets.
+  ChSystem system;
+  std::vector<ChSharedPtr<ChBody> > bodies(reader.get_num_bodies());
+
+  for (int i = 0; i < reader.get_num_bodies(); i++) {
+    bodies[i] = ChSharedPtr<ChBody>(new ChBody);
+    bodies[i]->SetIdentifier(std::atoi(reader.get_identifier(i).c_str()));
+    bodies[i]->SetBodyFixed(true);
+    bodies[i]->SetCollide(false);
+    system.AddBody(bodies[i]);
+  }
+
+  std::vector<bool> colored(bodies.size(), false);
+  const std::vector<utils::Pose_reader::Asset>& assets = reader.get_assets();
+
+  for (size_t k = 0; k < assets.size(); k++) {
+    ChSharedPtr<ChVisualization> shape = CreateShape(assets[k], opt);
+    if (shape.IsNull())
+      continue;
+
+    ChBody* body = bodies[assets[k].body].get_ptr();
+    body->AddAsset(shape);
+
+    // WriteAssetsPovray records one color per body.
+    if (!colored[assets[k].body]) {
+      body->AddAsset(ChSharedPtr<ChColorAsset>(new ChColorAsset(assets[k].color)));
+      colored[assets[k].body] = true;
+    }
+  }
+
+  // Create the Irrlicht application and hide its window; the frames are
+  // rendered into a texture when supported.
+  irr::ChIrrApp application(&system,
+                            L"Render poses",
+                            irr::core::dimension2d<irr::u32>(opt.width, opt.height),
+                            false,
+                            false,
+                            opt.soft ? irr::video::EDT_BURNINGSVIDEO : irr::video::EDT_OPENGL);
+
+  irr::video::IVideoDriver* driver = application.GetVideoDriver();
+  application.GetDevice()->minimizeWindow();
+
+  application.AddTypicalLights(irr::core::vector3df(30.f, -30.f, 100.f),
+                               irr::core::vector3df(30.f, 50.f, 100.f),
+                               250, 130);
+
+  irr::scene::ICameraSceneNode* camera = application.GetSceneManager()->addCameraSceneNode(
+    application.GetSceneManager()->getRootSceneNode(),
+    irr::core::vector3df(0, 0, 0), irr::core::vector3df(0, 0, 0));
+  camera->setUpVector(irr::core::vector3df(0, 0, 1));
+  camera->setAspectRatio((irr::f32)opt.width / opt.height);
+
+  application.AssetBindAll();
+  application.AssetUpdateAll();
+
+  irr::video::ITexture* target = 0;
+  if (driver->queryFeature(irr::video::EVDF_RENDER_TO_TARGET))
+    target = driver->addRenderTargetTexture(irr::core::dimension2d<irr::u32>(opt.width, opt.height), "frame");
+
+  // Start the encoder, reading raw RGB frames from its standard input.
+  std::stringstream cmd;
+  cmd << Quote(opt.ffmpeg) << " -y -loglevel error -f rawvideo -pix_fmt rgb24"
+      << " -s " << opt.width << "x" << opt.height << " -r " << fps << " -i -"
+      << " -c:v libx264 -preset fast -pix_fmt yuv420p " << Quote(opt.video_file);
+
+#ifdef _WIN32
+  FILE* encoder = popen(cmd.str().c_str(), "wb");
+#else
+  FILE* encoder = popen(cmd.str().c_str(), "w");
+#endif
+  if (!encoder) {
+    GetLog() << "ERROR: cannot start " << opt.ffmpeg.c_str() << "\n";
+    return 1;
+  }
+
+  // Initialize the chase camera on the followed body, a few seconds before the
+  // first frame.
+  int follow = FindFollowedBody(reader, opt);
+  int warmup = std::min(first, (int)(camera_warmup * fps));
+
+  for (size_t i = 0; i < bodies.size(); i++)
+    bodies[i]->SetCoord(ChCoordsys<>(reader.get_pos(first - warmup, (int)i), reader.get_rot(first - warmup, (int)i)));
+
+  ChChaseCamera chase_camera(bodies[follow]);
+  chase_camera.Initialize(trackPoint, ChCoordsys<>(), chaseDist, chaseHeight);
+
+  std::vector<unsigned char> pixels(3 * opt.width * opt.height);
+  int rendered = 0;
+
+  for (int frame = first - warmup; frame < end && application.GetDevice()->run(); frame++) {
+    // Set the recorded body poses (the Irrlicht nodes follow their bodies).
+    for (size_t i = 0; i < bodies.size(); i++)
+      bodies[i]->SetCoord(ChCoordsys<>(reader.get_pos(frame, (int)i), reader.get_rot(frame, (int)i)));
+
+    chase_camera.Update(1 / fps);
+    if (frame < first)
+      continue;
+
+    ChVector<> cam_pos = chase_camera.GetCameraPos();
+    ChVector<> cam_target = chase_camera.GetTargetPos();
+    camera->setPosition(irr::core::vector3df((irr::f32)cam_pos.x, (irr::f32)cam_pos.y, (irr::f32)cam_pos.z));
+    camera->setTarget(irr::core::vector3df((irr::f32)cam_target.x, (irr::f32)cam_target.y, (irr::f32)cam_target.z));
+
+    application.BeginScene(true, true, irr::video::SColor(255, 140, 161, 192));
+    if (target)
+      driver->setRenderTarget(target, true, true, irr::video::SColor(255, 140, 161, 192));
+    application.DrawAll();
+    if (target)
+      driver->setRenderTarget(0, false, false);
+
+    irr::video::IImage* image = target
+      ? driver->createImage(target, irr::core::position2d<irr::s32>(0, 0), target->getSize())
+      : driver->createScreenShot();
+    application.EndScene();
+
+    if (!image) {
+      GetLog() << "ERROR: cannot read back frame " << frame << "\n";
+      break;
+    }
+
+    image->copyToScaling(&pixels[0], opt.width, opt.height, irr::video::ECF_R8G8B8, 3 * opt.width);
+    image->drop();
+
+    if (fwrite(&pixels[0], 1, pixels.size(), encoder) != pixels.size()) {
+      GetLog() << "ERROR: the encoder stopped at frame " << frame << "\n";
+      break;
+    }
+
+    rendered++;
+  }
+
+  int status = pclose(encoder);
+
+  GetLog() << "Rendered frames " << first << " to " << first + rendered - 1
+           << " into " << opt.video_file.c_str() << "\n";
+
+  return (rendered == end - first && status == 0) ? 0 : 1;
+}
+
+// =============================================================================
+// Main process: start the render processes and join their video segments.
+// =============================================================================
+
+class RenderJob : public vehicle::ChThread {
+public:
+  RenderJob(const std::string& cmd) : m_cmd(cmd), m_status(-1) {}
+
+  int GetStatus() const { return m_status; }
+
+private:
+  virtual void Run() { m_status = std::system(m_cmd.c_str()); }
+
+  std::string  m_cmd;
+  int          m_status;
+};
+
+int main(int argc, char* argv[])
+{
+  Options opt;
+  if (!ParseOptions(argc, argv, opt)) {
+    GetLog() << "Usage: demo_RenderPoses [asset file] [pose file] [video file] [options]\n";
+    return 1;
+  }
+
+  utils::Pose_reader reader;
+  if (!reader.open(opt.assets_file, opt.poses_file))
+    return 1;
+
+  int num_frames = reader.get_num_frames();
+  if (num_frames == 0) {
+    GetLog() << "ERROR: no frames in " << opt.poses_file.c_str() << "\n";
+    return 1;
+  }
+
+  // Use the recorded frame rate, unless specified.
+  double fps = opt.fps;
+  if (fps <= 0) {
+    double duration = reader.get_time(num_frames - 1) - reader.get_time(0);
+    fps = (num_frames > 1 && duration > 0) ? (int)((num_frames - 1) / duration + 0.5) : 30;
+  }
+
+  // Render process (or a single job).
+  int jobs = (opt.jobs > 0) ? opt.jobs : vehicle::ChThread::GetNumHardwareThreads();
+  jobs = std::max(1, std::min(jobs, num_frames));
+
+  if (opt.count >= 0 || jobs == 1)
+    return RenderFrames(reader, opt, fps);
+
+  // Split the frames in contiguous ranges, one per render process.
+  std::vector<std::string> segments(jobs);
+  std::vector<RenderJob*> workers(jobs);
+
+  for (int k = 0; k < jobs; k++) {
+    int first = (int)((long long)num_frames * k / jobs);
+    int count = (int)((long long)num_frames * (k + 1) / jobs) - first;
+
+    std::stringstream segment;
+    segment << opt.video_file << ".part" << k << ".mp4";
+    segments[k] = segment.str();
+
+    std::stringstream cmd;
+#ifndef _WIN32
+    if (!opt.displays.empty())
+      cmd << "DISPLAY=" << opt.displays[k % opt.displays.size()] << " ";
+#endif
+    cmd << Quote(argv[0]) << " " << Quote(opt.assets_file) << " " << Quote(opt.poses_file) << " "
+        << Quote(segments[k]) << " -size " << opt.width << " " << opt.height << " -fps " << fps
+        << " -meshdir " << Quote(opt.mesh_dir) << " -ffmpeg " << Quote(opt.ffmpeg)
+        << " -frames " << first << " " << count;
+    for (std::map<std::string, std::string>::const_iterator it = opt.meshes.begin(); it != opt.meshes.end(); ++it)
+      cmd << " -mesh " << Quote(it->first) << " " << Quote(it->second);
+    if (opt.follow >= 0)
+      cmd << " -follow " << opt.follow;
+    if (opt.soft)
+      cmd << " -soft";
+
+    workers[k] = new RenderJob(cmd.str());
+    workers[k]->Start();
+  }
+
+  bool ok = true;
+  for (int k = 0; k < jobs; k++) {
+    workers[k]->Join();
+    if (workers[k]->GetStatus() != 0) {
+      GetLog() << "ERROR: render process " << k << " failed\n";
+      ok = false;
+    }
+    delete workers[k];
+  }
+
+  // Join the segments (same encoder settings, so no re-encoding is needed).
+  if (ok) {
+    std::string list_file = opt.video_file + ".parts.txt";
+    std::ofstream list(list_file.c_str());
+    // The segments are in the directory of the list file.
+    for (int k = 0; k < jobs; k++)
+      list << "file '" << segments[k].substr(segments[k].find_last_of("/\\") + 1) << "'" << std::endl;
+    list.close();
+
+    std::stringstream cmd;
+    cmd << Quote(opt.ffmpeg) << " -y -loglevel error -f concat -safe 0 -i " << Quote(list_file)
+        << " -c copy " << Quote(opt.video_file);
+    if (std::system(cmd.str().c_str()) != 0) {
+      GetLog() << "ERROR: cannot join the video segments\n";
+      ok = false;
+    }
+
+    std::remove(list_file.c_str());
+  }
+
+  for (int k = 0; k < jobs && ok; k++)
+    std::remove(segments[k].c_str());
+
+  if (ok)
+    GetLog() << "Wrote " << num_frames << " frames to " << opt.video_file.c_str() << "\n";
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Main driver function for a road train (a vehicle pulling several trailers)
+// specified through JSON files, on flat terrain, with the driver inputs read
+// from a data file.
+//
+// Usage: demo_RoadTrain [road train file]
+//
+// The tires of all units are listed in their specification files; the tires
+// and all units are stepped with one call to RoadTrain::DoStep().
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "core/ChStream.h"
+#include "physics/ChSystem.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChVehicleModelData.h"
+
+#include "subsys/vehicle/RoadTrain.h"
+#include "subsys/powertrain/SimplePowertrain.h"
+#include "subsys/driver/ChDataDriver.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+using namespace chrono;
+
+// =============================================================================
+
+// JSON file for the road train model
+std::string roadtrain_file("generic/vehicle/RoadTrain_ThreeTrailers.json");
+
+// JSON file for the powertrain (simple)
+std::string simplepowertrain_file("hmmwv/powertrain/HMMWV_SimplePowertrain.json");
+
+// Driver input file
+std::string driver_file("generic/driver/Sample_Maneuver.txt");
+
+// Initial position and orientation of the pulling vehicle
+ChVector<> initLoc(0, 0, 1.0);
+ChQuaternion<> initRot(1, 0, 0, 0);
+
+// Simulation step size and length
+double step_size = 1e-3;
+double tend = 20.0;
+
+// Time interval between two output frames
+double output_step_size = 1.0 / 1;    // once a second
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  if (argc > 1)
+    roadtrain_file = argv[1];
+
+  // --------------------------
+  // Create the various modules
+  // --------------------------
+
+  RoadTrain train(vehicle::GetDataFile(roadtrain_file));
+  train.Initialize(ChCoordsys<>(initLoc, initRot));
+  train.GetVehicle()->SetStepsize(step_size);
+
+  FlatTerrain terrain(0);
+
+  std::vector<ChSharedPtr<ChTire> > tires;
+  if (!train.CreateTires(terrain, tires)) {
+    GetLog() << "The road train specification files do not list all tires\n";
+    return 1;
+  }
+  train.SetTires(tires);
+
+  SimplePowertrain powertrain(vehicle::GetDataFile(simplepowertrain_file));
+  powertrain.Initialize();
+
+  ChDataDriver driver(vehicle::GetDataFile(driver_file));
+
+  GetLog() << "Road train with " << train.GetNumTrailers() << " trailers, "
+           << train.GetNumWheels() << " wheels (" << train.GetNumBatchedTires() << " batched tires)\n";
+
+  // ---------------
+  // Simulation loop
+  // ---------------
+
+  int output_steps = (int)std::ceil(output_step_size / step_size);
+  int step_number = 0;
+  double time = 0;
+
+  while (time < tend)
+  {
+    if (step_number % output_steps == 0) {
+      char text[128];
+      sprintf(text, "t = %6.2f  speed = %6.2f  last trailer at (%8.2f, %8.2f)\n",
+              time, train.GetVehicle()->GetVehicleSpeed(),
+              train.GetTrailer(train.GetNumTrailers() - 1)->GetChassis()->GetPos().x,
+              train.GetTrailer(train.GetNumTrailers() - 1)->GetChassis()->GetPos().y);
+      GetLog() << text;
+    }
+
+    // Collect output data from modules (for inter-module communication)
+    double throttle_input = driver.GetThrottle();
+    double steering_input = driver.GetSteering();
+    double braking_input = driver.GetBraking();
+    double powertrain_torque = powertrain.GetOutputTorque();
+    double driveshaft_speed = train.GetVehicle()->GetDriveshaftSpeed();
+
+    // Update and advance the driver and powertrain, then the tires and all
+    // units of the road train.
+    time = train.GetSystem()->GetChTime();
+    driver.Update(time);
+    powertrain.Update(time, throttle_input, driveshaft_speed);
+
+    train.DoStep(time, step_size, steering_input, braking_input, powertrain_torque);
+
+    driver.Advance(step_size);
+    powertrain.Advance(step_size);
+
+    step_number++;
+  }
+
+  return 0;
+}
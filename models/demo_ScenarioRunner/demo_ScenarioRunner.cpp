@@ -0,0 +1,133 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Run a batch of JSON vehicle scenarios in parallel.
+//
+// Usage: demo_ScenarioRunner [scenario file] [number of threads] [cache directory]
+// The scenario file is given relative to the ChronoVehicle data directory.
+// If a cache directory is given, scenarios with cached results (see
+// ChResultCache) are not simulated again.
+// A parameter sweep file (see ChSweepRunner) or a Monte-Carlo study file (see
+// ChMonteCarloRunner) can be given instead of a list of scenarios; its results
+// tables are written to the output directory.
+//
+// On a cluster, the scenarios of a list can be distributed over several nodes
+// (see ChWorkQueue), with the output directory on shared storage:
+//    demo_ScenarioRunner -coordinator [port] [scenario file]
+//    demo_ScenarioRunner -worker [coordinator host] [port] [number of threads] [cache directory]
+// with one coordinator process and one worker process per node.
+//
+// If ChronoVehicle is configured with ENABLE_PROFILING, the module timings are
+// printed at the end and a Chrome trace is written to the output directory.
+//
+// =============================================================================
+
+#include <cstdlib>
+#include <string>
+
+#include "physics/ChGlobal.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChJsonCache.h"
+
+#include "runner/ChScenarioRunner.h"
+#include "runner/ChSweepRunner.h"
+#include "runner/ChMonteCarloRunner.h"
+#include "runner/ChWorkQueue.h"
+
+using namespace chrono;
+
+// =============================================================================
+
+// JSON file with the list of scenarios
+std::string scenario_file("generic/scenarios/Sample_Scenarios.json");
+
+// Output directory
+const std::string out_dir = "../SCENARIOS";
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  // Cluster modes.
+  if (argc > 2 && std::string(argv[1]) == "-coordinator") {
+    if (argc > 3)
+      scenario_file = argv[3];
+    vehicle::ChWorkQueueCoordinator coordinator(std::atoi(argv[2]));
+    coordinator.SetOutputDirectory(out_dir);
+    if (!coordinator.LoadScenarios(vehicle::GetDataFile(scenario_file)))
+      return 1;
+    return coordinator.Run() ? 0 : 1;
+  }
+
+  if (argc > 3 && std::string(argv[1]) == "-worker") {
+    vehicle::ChWorkQueueWorker worker(argv[2], std::atoi(argv[3]), (argc > 4) ? std::atoi(argv[4]) : 0);
+    worker.SetResultCache((argc > 5) ? argv[5] : "");
+    return worker.Run() ? 0 : 1;
+  }
+
+  if (argc > 1)
+    scenario_file = argv[1];
+
+  int num_threads = (argc > 2) ? std::atoi(argv[2]) : 0;
+
+  // Optional (shared) result cache directory.
+  std::string cache_dir = (argc > 3) ? argv[3] : "";
+
+  // A sweep file has a list of parameters instead of a list of scenarios, and
+  // a Monte-Carlo file also has a list of KPIs.
+  const rapidjson::Document& d = vehicle::ChJsonCache::Get(vehicle::GetDataFile(scenario_file));
+  bool montecarlo = d.IsObject() && d.HasMember("Parameters") && d.HasMember("KPIs");
+  bool sweep = d.IsObject() && d.HasMember("Parameters") && !montecarlo;
+
+  vehicle::ChScenarioRunner runner(num_threads);
+  runner.SetOutputDirectory(out_dir);
+  runner.SetResultCache(cache_dir);
+
+  vehicle::ChSweepRunner sweep_runner(num_threads);
+  sweep_runner.SetOutputDirectory(out_dir);
+  sweep_runner.SetResultCache(cache_dir);
+
+  vehicle::ChMonteCarloRunner mc_runner(num_threads);
+  mc_runner.SetOutputDirectory(out_dir);
+  mc_runner.SetResultCache(cache_dir);
+
+  bool loaded;
+  if (montecarlo)
+    loaded = mc_runner.LoadMonteCarlo(vehicle::GetDataFile(scenario_file));
+  else if (sweep)
+    loaded = sweep_runner.LoadSweep(vehicle::GetDataFile(scenario_file));
+  else
+    loaded = runner.LoadScenarios(vehicle::GetDataFile(scenario_file));
+  if (!loaded)
+    return 1;
+
+#if PROFILING_ENABLED
+  vehicle::ChProfiler::EnableTrace(true);
+#endif
+
+  bool ok = montecarlo ? mc_runner.Run() : (sweep ? sweep_runner.Run() : runner.Run());
+
+#if PROFILING_ENABLED
+  vehicle::ChProfiler::PrintSummary();
+  vehicle::ChProfiler::WriteTrace(out_dir + "/profile.json");
+#endif
+
+  return ok ? 0 : 1;
+}
@@ -13,6 +13,37 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib
 import pylab as py
+
+# unit conversions from the SI values recorded by SuspensionTest::Record()
+# to the units of the SuspensionTest::SaveLog() file
+in2m = 0.0254
+lbf2N = 4.44822162
+rad2deg = 180.0 / 3.14159265358979
+
+_col_scale = {'postDisp_L': 1.0/in2m, 'postDisp_R': 1.0/in2m,
+              'k_len_L': 1.0/in2m, 'k_len_R': 1.0/in2m, 'k_dx_L': 1.0/in2m, 'k_dx_R': 1.0/in2m,
+              'k_F_L': 1.0/lbf2N, 'k_F_R': 1.0/lbf2N,
+              'd_len_L': 1.0/in2m, 'd_len_R': 1.0/in2m, 'd_vel_L': 1.0/in2m, 'd_vel_R': 1.0/in2m,
+              'd_F_L': 1.0/lbf2N, 'd_F_R': 1.0/lbf2N,
+              'KA_L': rad2deg, 'KA_R': rad2deg, 'Koff_L': 1.0/in2m, 'Koff_R': 1.0/in2m,
+              'CA_L': rad2deg, 'CA_R': rad2deg, 'Coff_L': 1.0/in2m, 'Coff_R': 1.0/in2m,
+              'TA_L': rad2deg, 'TA_R': rad2deg}
+
+def read_log(filename):
+    '''
+    Read a SuspensionTest log file, either CSV, in the binary ChOutputChannel
+    format (magic "CHOUT1") or as an Arrow IPC file, into a DataFrame.
+    '''
+    return tire.read_output(filename)
+
+def convert_SI(DF):
+    '''
+    Convert the SI values of a recorded log to the units of the SaveLog() file.
+    '''
+    for col in DF.columns:
+        if col in _col_scale:
+            DF[col] = DF[col] * _col_scale[col]
+    return DF
     
 
 
@@ -21,11 +52,12 @@ class SuspensionTest_panda:
     @class: loads, manages and plots output from any number of output files from 
             ChronoT class SuspensionTest
     '''
-    def __init__(self,filename_list, leg_list):
+    def __init__(self,filename_list, leg_list, si_units = False):
         '''
         Input:
-            filename_list:  .csv path + filename list of all the file names
+            filename_list:  .csv (or binary) path + filename list of all the file names
             leg_list:       legend identifiers for each file
+            si_units:       True if the files were written by WriteRecording() (SI units)
         '''
         # first file is the steady state magic formula output
         if( len(filename_list) != len(leg_list)):
@@ -39,7 +71,9 @@ class SuspensionTest_panda:
         
         for i in range(0, self._nFiles):
             self._filename_list.append(filename_list[i])
-            DF_curr = pd.read_csv(filename_list[i], header=0, sep=',')   # index_col=0,
+            DF_curr = read_log(filename_list[i])
+            if( si_units ):
+                DF_curr = convert_SI(DF_curr)
             self._DF_list.append(DF_curr)
             self._leg_list.append(leg_list[i])
     
@@ -23,6 +23,7 @@
 //
 // =============================================================================
 
+#include <cstdlib>
 #include <vector>
 
 #include "core/ChFileutils.h"
@@ -31,6 +32,7 @@
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
 
 #include "utils/ChUtilsInputOutput.h"
@@ -38,6 +40,7 @@
 // subsystems, all read in fron JSON files
 #include "models/ModelDefs.h"
 #include "subsys/suspensionTest/SuspensionTest.h"
+#include "subsys/suspensionTest/SuspensionSweep.h"
 #include "subsys/tire/RigidTire.h"
 #include "subsys/terrain/FlatTerrain.h"
 #include "subsys/driver/ChDataDriver.h"
@@ -95,15 +98,50 @@ ChQuaternion<> initRot(1, 0, 0, 0);
 
 
 // =============================================================================
+// Quasi-static kinematics sweep over the post displacements and the steering
+// input (run with: demo_SuspensionTest sweep [num_threads]).
+int run_sweep(int num_threads)
+{
+  int num_disp = 21;
+  int num_steer = 5;
+
+  std::vector<double> disp(num_disp);
+  for (int i = 0; i < num_disp; i++)
+    disp[i] = -post_limit + 2 * post_limit * i / (num_disp - 1);
+
+  std::vector<double> steer(num_steer);
+  for (int i = 0; i < num_steer; i++)
+    steer[i] = -steer_limit + 2 * steer_limit * i / (num_steer - 1);
+
+  SuspensionSweep sweep(suspensionTest_file, ChCoordsys<>(initLoc, initRot), num_threads);
+  sweep.SetLeftDisplacements(disp);
+  sweep.SetRightDisplacements(disp);
+  sweep.SetSteeringInputs(steer);
+  sweep.Run();
+
+  if (!sweep.WriteResults("sweep_SuspensionTest.csv"))
+    return 1;
+
+  GetLog() << "Solved " << sweep.GetNumPoints() << " points on " << sweep.GetNumThreads() << " threads\n";
+
+  return 0;
+}
+
+
 int main(int argc, char* argv[])
 {
   SetChronoDataPath(CHRONO_DATA_DIR);
 
+  if (argc > 1 && std::string(argv[1]) == "sweep")
+    return run_sweep((argc > 2) ? std::atoi(argv[2]) : 0);
+
   // Create the testing mechanism, initilize ity
   SuspensionTest tester(suspensionTest_file);
   tester.Initialize(ChCoordsys<>(initLoc, initRot));
   // tester.Save_DebugLog(DBG_SPRINGS | DBG_SHOCKS | DBG_CONSTRAINTS | DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv");
-  tester.Save_DebugLog(DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv");
+  // tester.Save_DebugLog(DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv");
+  // record the rig data at each step (SI units), written to file at the end
+  tester.StartRecording(DBG_SPRINGS | DBG_SHOCKS | DBG_SUSPENSIONTEST, 100000);
 
   // Create and initialize two rigid wheels
   ChSharedPtr<ChTire> tire_front_right;
@@ -171,7 +209,8 @@ int main(int argc, char* argv[])
   driver.SetSteeringDelta(render_step_size / steering_time * steer_limit);
   driver.SetPostDelta(render_step_size / post_time * post_limit);
 
-  // Set up the assets for rendering
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
   if (do_shadows)
@@ -244,10 +283,8 @@ int main(int argc, char* argv[])
       GetLog() << "Time = " << time << "\n\n";
       tester.DebugLog(DBG_SPRINGS | DBG_SUSPENSIONTEST);
     }
-    if (step_number % render_steps == 0) {
-      // write output data
-      tester.SaveLog();
-    }
+    // record output data
+    tester.Record();
 #endif
 
     // Collect output data from modules, here it's the steering and post displacements
@@ -367,5 +404,8 @@ int main(int argc, char* argv[])
 
 #endif
 
+  // write the recorded data
+  tester.WriteRecording("log_test_SuspensionTester.csv");
+
   return 0;
 }
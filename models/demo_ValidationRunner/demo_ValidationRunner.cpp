@@ -0,0 +1,63 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Validate a batch of simulation data files in parallel.
+//
+// Usage: demo_ValidationRunner [manifest file] [report file] [number of threads]
+// Reference files in the manifest are relative to the validation data
+// directory. The report is written as JSON if the report file name ends in
+// ".json" and as CSV otherwise. The exit code is 0 only if all cases passed.
+//
+// =============================================================================
+
+#include <cstdlib>
+#include <string>
+
+#include "utils/ChUtilsValidation.h"
+
+#include "runner/ChValidationRunner.h"
+
+using namespace chrono;
+
+// =============================================================================
+
+// JSON file with the list of validation cases
+std::string manifest_file("validation.json");
+
+// Validation report
+std::string report_file("validation_report.csv");
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+  if (argc > 1)
+    manifest_file = argv[1];
+  if (argc > 2)
+    report_file = argv[2];
+
+  int num_threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+
+  vehicle::ChValidationRunner runner(num_threads);
+
+  if (!runner.LoadManifest(manifest_file))
+    return 1;
+
+  bool passed = runner.Run();
+
+  if (!runner.WriteReport(report_file))
+    return 1;
+
+  return passed ? 0 : 1;
+}
@@ -33,6 +33,8 @@
 
 #include "utils/ChUtilsInputOutput.h"
 
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/ChVehicleModelData.h"
 
 #include "subsys/vehicle/Vehicle.h"
@@ -177,6 +179,13 @@ int main(int argc, char* argv[])
 
   application.SetTimestep(step_size);
 
+  // Reload the vehicle, suspension, brake, and tire parameters when their
+  // specification files are edited during the simulation
+  vehicle::ChHotReload reload;
+  vehicle.AddHotReload(reload);
+  for (int i = 0; i < num_wheels; i++)
+    reload.Add(vehicle::GetDataFile(rigidtire_file), tires[i].get_ptr());
+
   ChIrrGuiDriver driver(application, vehicle, powertrain, trackPoint, 6.0, 0.5, true);
 
   // Set the time response for steering and throttle keyboard inputs.
@@ -188,7 +197,8 @@ int main(int argc, char* argv[])
   driver.SetThrottleDelta(render_step_size / throttle_time);
   driver.SetBrakingDelta(render_step_size / braking_time);
 
-  // Set up the assets for rendering
+  // Set up the assets for rendering (the vehicle assets are created here)
+  vehicle::ChDeferredAssets::Materialize(application.GetSystem());
   application.AssetBindAll();
   application.AssetUpdateAll();
   if (do_shadows)
@@ -232,6 +242,9 @@ int main(int argc, char* argv[])
   {
     // Render scene
     if (step_number % render_steps == 0) {
+      // Apply the edited specification files
+      reload.Poll();
+
       // Update the position of the shadow mapping so that it follows the car
       if (do_shadows) {
         ChVector<> lightaim = vehicle.GetChassisPos();
@@ -255,10 +268,9 @@ int main(int argc, char* argv[])
     braking_input = driver.GetBraking();
     powertrain_torque = powertrain.GetOutputTorque();
     driveshaft_speed = vehicle.GetDriveshaftSpeed();
-    for (int i = 0; i < num_wheels; i++) {
+    for (int i = 0; i < num_wheels; i++)
       tire_forces[i] = tires[i]->GetTireForce();
-      wheel_states[i] = vehicle.GetWheelState(i);
-    }
+    vehicle.GetWheelStates(wheel_states);
 
     // Update modules (process inputs from other modules)
     time = vehicle.GetSystem()->GetChTime();
@@ -321,10 +333,9 @@ int main(int argc, char* argv[])
     braking_input = driver.GetBraking();
     powertrain_torque = powertrain.GetOutputTorque();
     driveshaft_speed = vehicle.GetDriveshaftSpeed();
-    for (int i = 0; i < num_wheels; i++) {
+    for (int i = 0; i < num_wheels; i++)
       tire_forces[i] = tires[i]->GetTireForce();
-      wheel_states[i] = vehicle.GetWheelState(i);
-    }
+    vehicle.GetWheelStates(wheel_states);
 
     // Update modules (process inputs from other modules)
     time = vehicle.GetSystem()->GetChTime();
@@ -22,6 +22,7 @@
 #include "assets/ChCylinderShape.h"
 #include "assets/ChTexture.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChWheel.h"
 #include "subsys/ChVehicleModelData.h"
 
@@ -50,11 +51,11 @@ public:
       cyl->GetCylinderGeometry().rad = radius;
       cyl->GetCylinderGeometry().p1 = chrono::ChVector<>(0, width / 2, 0);
       cyl->GetCylinderGeometry().p2 = chrono::ChVector<>(0, -width / 2, 0);
-      spindle->AddAsset(cyl);
+      vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 
       chrono::ChSharedPtr<chrono::ChTexture> tex(new chrono::ChTexture);
       tex->SetTextureFilename(chrono::GetChronoDataFile("bluwhite.png"));
-      spindle->AddAsset(tex);
+      vehicle::ChDeferredAssets::AddAsset(spindle, tex);
     }
   }
 
@@ -12,31 +12,21 @@
 // Authors: Radu Serban
 // =============================================================================
 //
+// Conversion factors from the US customary units of the HMMWV data to SI.
 //
 // =============================================================================
 
-#ifndef HMMWV_FUNCDRIVER_H
-#define HMMWV_FUNCDRIVER_H
-
-#include "subsys/ChDriver.h"
+#ifndef HMMWV_UNITS_H
+#define HMMWV_UNITS_H
 
 namespace hmmwv {
 
-class HMMWV_FuncDriver : public chrono::ChDriver
-{
-public:
-
-  HMMWV_FuncDriver() {}
-  ~HMMWV_FuncDriver() {}
-
-  virtual void Update(double time);
-
-private:
-
-};
-
+static const double in2m = 0.0254;          ///< inch to meter
+static const double lb2kg = 0.453592;       ///< pound (mass) to kilogram
+static const double lbf2N = 4.44822162;     ///< pound (force) to Newton
+static const double lbfpin2Npm = 175.12677; ///< lbf/in to N/m
 
 } // end namespace hmmwv
 
 
-#endif
\ No newline at end of file
+#endif
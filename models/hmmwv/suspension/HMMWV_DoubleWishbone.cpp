@@ -23,7 +23,10 @@
 //
 // =============================================================================
 
+#include "subsys/suspension/ChSpringForceT.h"
+
 #include "HMMWV_DoubleWishbone.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -33,11 +36,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-static const double lb2kg = 0.453592;
-static const double lbf2N = 4.44822162;
-static const double lbfpin2Npm = 175.12677;
-
 const double     HMMWV_DoubleWishboneFront::m_UCAMass = 5.813; 
 const double     HMMWV_DoubleWishboneFront::m_LCAMass = 23.965;
 const double     HMMWV_DoubleWishboneFront::m_uprightMass = 19.450;
@@ -84,101 +82,81 @@ const double     HMMWV_DoubleWishboneRear::m_springRestLength   = 0.382;
 
 
 // -----------------------------------------------------------------------------
-// HMMWV shock functor class - implements a nonlinear damper
+// HMMWV shock force law - implements a nonlinear damper.
+// The parameter sets of the front and rear shocks are fixed at compile time;
+// the law is evaluated inline through a ChSpringForceT callback.
 // -----------------------------------------------------------------------------
-class HMMWV_ShockForce : public ChSpringForceCallback
-{
-public:
-  HMMWV_ShockForce(double midstroke_compression_slope,
-                   double midstroke_rebound_slope,
-                   double bumpstop_compression_slope,
-                   double bumpstop_rebound_slope,
-                   double metalmetal_slope,
-                   double min_bumpstop_compression_force,
-                   double midstroke_lower_bound,
-                   double midstroke_upper_bound,
-                   double metalmetal_lower_bound,
-                   double metalmetal_upper_bound);
-
-  virtual double operator()(double time,
-                            double rest_length,
-                            double length,
-                            double vel);
-
-private:
-  double m_ms_compr;
-  double m_ms_rebound;
-  double m_bs_compr;
-  double m_bs_rebound;
-  double m_metal_K;
-  double m_F0;
-  double m_ms_min_length;
-  double m_ms_max_length;
-  double m_min_length;
-  double m_max_length;
-};
-
-HMMWV_ShockForce::HMMWV_ShockForce(double midstroke_compression_slope,
-                                   double midstroke_rebound_slope,
-                                   double bumpstop_compression_slope,
-                                   double bumpstop_rebound_slope,
-                                   double metalmetal_slope,
-                                   double min_bumpstop_compression_force,
-                                   double midstroke_lower_bound,
-                                   double midstroke_upper_bound,
-                                   double metalmetal_lower_bound,
-                                   double metalmetal_upper_bound)
-: m_ms_compr(midstroke_compression_slope),
-  m_ms_rebound(midstroke_rebound_slope),
-  m_bs_compr(bumpstop_compression_slope),
-  m_bs_rebound(bumpstop_rebound_slope),
-  m_metal_K(metalmetal_slope),
-  m_F0(min_bumpstop_compression_force),
-  m_ms_min_length(midstroke_lower_bound),
-  m_ms_max_length(midstroke_upper_bound),
-  m_min_length(metalmetal_lower_bound),
-  m_max_length(metalmetal_upper_bound)
+struct HMMWV_ShockLaw
 {
-}
-
-double HMMWV_ShockForce::operator()(double time,
-                                    double rest_length,
-                                    double length,
-                                    double vel)
-{
-  /*
-  // On midstroke curve
-  if (length >= m_min_length && length <= m_max_length)
-    return (vel >= 0) ? -m_ms_rebound * vel : -m_ms_compr * vel;
-
-  // Hydraulic bump engaged
-  return (vel >= 0) ? -m_bs_rebound * vel : -m_bs_compr * vel + m_F0;
-  */
-
-  double force = 0;
-
-  //Calculate Damping Force
-  if(vel >= 0)
+  double operator()(double time,
+                    double rest_length,
+                    double length,
+                    double vel) const
   {
-    force = (length >= m_ms_max_length) ? -m_bs_rebound * vel : -m_ms_rebound * vel;
-  }
-  else
-  {
-    force = (length <= m_ms_min_length) ? -m_bs_compr * vel : -m_ms_compr * vel;
+    double force = 0;
+
+    //Calculate Damping Force
+    if(vel >= 0)
+    {
+      force = (length >= m_ms_max_length) ? -m_bs_rebound * vel : -m_ms_rebound * vel;
+    }
+    else
+    {
+      force = (length <= m_ms_min_length) ? -m_bs_compr * vel : -m_ms_compr * vel;
+    }
+
+    //Add in Shock metal to metal contact force
+    if(length <= m_min_length)
+    {
+      force = m_metal_K*(m_min_length-length);
+    }
+    else if(length >= m_max_length)
+    {
+      force = -m_metal_K*(length-m_max_length);
+    }
+
+    return force;
   }
 
-  //Add in Shock metal to metal contact force
-  if(length <= m_min_length)
-  {
-    force = m_metal_K*(m_min_length-length);
-  }
-  else if(length >= m_max_length)
-  {
-    force = -m_metal_K*(length-m_max_length);
-  }
+  double m_ms_compr;        // midstroke compression slope
+  double m_ms_rebound;      // midstroke rebound slope
+  double m_bs_compr;        // bumpstop compression slope
+  double m_bs_rebound;      // bumpstop rebound slope
+  double m_metal_K;         // metal-metal slope
+  double m_F0;              // min bumpstop compression force (unused)
+  double m_ms_min_length;   // midstroke lower bound
+  double m_ms_max_length;   // midstroke upper bound
+  double m_min_length;      // metal-metal lower bound
+  double m_max_length;      // metal-metal upper bound
+};
 
-  return force;
-}
+typedef ChSpringForceT<HMMWV_ShockLaw> HMMWV_ShockForce;
+
+static const HMMWV_ShockLaw frontShockLaw = {
+  lbfpin2Npm * 71.50,     // midstroke_compression_slope
+  lbfpin2Npm * 128.25,    // midstroke_rebound_slope
+  lbfpin2Npm * 33.67,     // bumpstop_compression_slope
+  lbfpin2Npm * 343.00,    // bumpstop_rebound_slope
+  lbfpin2Npm * 150000,    // metalmetal_slope
+  lbf2N * 3350,           // min_bumpstop_compression_force
+  in2m * 13.76,           // midstroke_lower_bound
+  in2m * 15.85,           // midstroke_upper_bound
+  in2m * 12.76,           // metalmetal_lower_bound
+  in2m * 16.48            // metalmetal_upper_bound
+};
+
+static const HMMWV_ShockLaw rearShockLaw = {
+  lbfpin2Npm * 83.00,     // midstroke_compression_slope
+  lbfpin2Npm * 200.00,    // midstroke_rebound_slope
+  lbfpin2Npm * 48.75,     // bumpstop_compression_slope
+  lbfpin2Npm * 365.00,    // bumpstop_rebound_slope
+  lbfpin2Npm * 150000,    // metalmetal_slope
+  lbf2N * 3350,           // min_bumpstop_compression_force
+  in2m * 13.76,           // midstroke_lower_bound
+  in2m * 15.85,           // midstroke_upper_bound
+  in2m * 12.76,           // metalmetal_lower_bound
+  in2m * 16.48            // metalmetal_upper_bound
+};
 
 
 // -----------------------------------------------------------------------------
@@ -187,36 +165,14 @@ double HMMWV_ShockForce::operator()(double time,
 HMMWV_DoubleWishboneFront::HMMWV_DoubleWishboneFront(const std::string& name)
 : ChDoubleWishbone(name)
 {
-  m_shockForceCB = new HMMWV_ShockForce(
-    lbfpin2Npm * 71.50,     // midstroke_compression_slope
-    lbfpin2Npm * 128.25,    // midstroke_rebound_slope
-    lbfpin2Npm * 33.67,     // bumpstop_compression_slope
-    lbfpin2Npm * 343.00,    // bumpstop_rebound_slope
-    lbfpin2Npm * 150000,    // metalmetal_slope
-    lbf2N * 3350,           // min_bumpstop_compression_force
-    in2m * 13.76,           // midstroke_lower_bound
-    in2m * 15.85,           // midstroke_upper_bound
-    in2m * 12.76,           // metalmetal_lower_bound
-    in2m * 16.48            // metalmetal_upper_boun
-    );
+  m_shockForceCB = new HMMWV_ShockForce(frontShockLaw);
 }
 
 
 HMMWV_DoubleWishboneRear::HMMWV_DoubleWishboneRear(const std::string& name)
 : ChDoubleWishbone(name)
 {
-  m_shockForceCB = new HMMWV_ShockForce(
-    lbfpin2Npm * 83.00,     // midstroke_compression_slope
-    lbfpin2Npm * 200.00,    // midstroke_rebound_slope
-    lbfpin2Npm * 48.75,     // bumpstop_compression_slope
-    lbfpin2Npm * 365.00,    // bumpstop_rebound_slope
-    lbfpin2Npm * 150000,    // metalmetal_slope
-    lbf2N * 3350,           // min_bumpstop_compression_force
-    in2m * 13.76,           // midstroke_lower_bound
-    in2m * 15.85,           // midstroke_upper_bound
-    in2m * 12.76,           // metalmetal_lower_bound
-    in2m * 16.48            // metalmetal_upper_bound
-    );
+  m_shockForceCB = new HMMWV_ShockForce(rearShockLaw);
 }
 
 
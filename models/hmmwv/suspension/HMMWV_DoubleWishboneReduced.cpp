@@ -24,6 +24,7 @@
 // =============================================================================
 
 #include "models/hmmwv/suspension/HMMWV_DoubleWishboneReduced.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -33,11 +34,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-static const double lb2kg = 0.453592;
-static const double lbf2N = 4.44822162;
-static const double lbfpin2Npm = 175.12677;
-
 // entire wheel assembly = 195 lbs, includes upright, spindle and tire.
 // HMMWV tires run ~ 100 lbs, so the spindle and upright should be ~ 95 lbs combined
 const double     HMMWV_DoubleWishboneReducedFront::m_uprightMass = lb2kg * 60.0;
@@ -21,6 +21,7 @@
 #include "assets/ChColorAsset.h"
 
 #include "models/hmmwv/tire/HMMWV_LugreTire.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -30,8 +31,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-
 const double HMMWV_LugreTire::m_radius = 18.15 * in2m;
 const double HMMWV_LugreTire::m_discLocs[] = { -5 * in2m, 0 * in2m, 5 * in2m };
 
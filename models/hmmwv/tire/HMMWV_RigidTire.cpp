@@ -18,6 +18,7 @@
 
 
 #include "models/hmmwv/tire/HMMWV_RigidTire.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -27,8 +28,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-
 const double HMMWV_RigidTire::m_radius = 18.5 * in2m;
 const double HMMWV_RigidTire::m_width = 10 * in2m;
 
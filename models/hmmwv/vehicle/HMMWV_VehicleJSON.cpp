@@ -21,7 +21,9 @@
 #include "assets/ChSphereShape.h"
 #include "assets/ChTriangleMeshShape.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChMeshCache.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
@@ -69,19 +71,21 @@ HMMWV_VehicleJSON::HMMWV_VehicleJSON(const bool        fixed,
     ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
     sphere->GetSphereGeometry().rad = 0.1;
     sphere->Pos = m_chassisCOM;
-    m_chassis->AddAsset(sphere);
+    vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
 
     break;
   }
   case MESH:
   {
-    geometry::ChTriangleMeshConnected trimesh;
-    trimesh.LoadWavefrontMesh(m_chassisMeshFile, false, false);
+    vehicle::ChDeferredAssets::AddMesh(m_chassis, m_chassisMeshFile, m_chassisMeshName);
 
-    ChSharedPtr<ChTriangleMeshShape> trimesh_shape(new ChTriangleMeshShape);
-    trimesh_shape->SetMesh(trimesh);
-    trimesh_shape->SetName(m_chassisMeshName);
-    m_chassis->AddAsset(trimesh_shape);
+    break;
+  }
+  case LOD:
+  {
+    for (int i = 0; i < vehicle::ChMeshCache::NUM_LOD_LEVELS; i++)
+      m_chassis->AddAsset(vehicle::ChMeshCache::GetMeshLodAssets(m_chassisMeshFile, m_chassisMeshName,
+                                                                 vehicle::ChMeshCache::LodLevel(i)));
 
     break;
   }
@@ -162,6 +166,9 @@ void HMMWV_VehicleJSON::Initialize(const ChCoordsys<>& chassisPos)
   m_brakes[1]->Initialize(m_suspensions[0]->GetRevolute(RIGHT));
   m_brakes[2]->Initialize(m_suspensions[1]->GetRevolute(LEFT));
   m_brakes[3]->Initialize(m_suspensions[1]->GetRevolute(RIGHT));
+
+  // Filter the collision pairs between vehicle bodies
+  InitializeCollisionFamilies();
 }
 
 
@@ -214,11 +221,8 @@ void HMMWV_VehicleJSON::Update(double              time,
   // Let the steering subsystem process the steering input.
   m_steering->Update(time, steering);
 
-  // Apply tire forces to spindle bodies.
-  m_suspensions[0]->ApplyTireForce(LEFT, tire_forces[FRONT_LEFT.id()]);
-  m_suspensions[0]->ApplyTireForce(RIGHT, tire_forces[FRONT_RIGHT.id()]);
-  m_suspensions[1]->ApplyTireForce(LEFT, tire_forces[REAR_LEFT.id()]);
-  m_suspensions[1]->ApplyTireForce(RIGHT, tire_forces[REAR_RIGHT.id()]);
+  // Apply tire forces to spindle bodies (all wheels in one pass).
+  ApplyTireForces(&tire_forces[0], 4);
 
   // Apply braking
   m_brakes[0]->ApplyBrakeModulation(braking);
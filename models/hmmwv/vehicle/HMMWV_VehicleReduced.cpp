@@ -19,11 +19,14 @@
 #include "assets/ChSphereShape.h"
 #include "assets/ChTriangleMeshShape.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChMeshCache.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
 #include "models/hmmwv/vehicle/HMMWV_VehicleReduced.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -34,10 +37,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-static const double lb2kg = 0.453592;
-static const double lbf2N = 4.44822162;
-
 const double     HMMWV_VehicleReduced::m_chassisMass = lb2kg * 7740.7;                           // chassis sprung mass
 const ChVector<> HMMWV_VehicleReduced::m_chassisCOM = in2m * ChVector<>(-18.8, -0.585, 33.329);  // COM location
 const ChVector<> HMMWV_VehicleReduced::m_chassisInertia(125.8, 497.4, 531.4);                    // chassis inertia (roll,pitch,yaw)
@@ -74,19 +73,21 @@ HMMWV_VehicleReduced::HMMWV_VehicleReduced(const bool           fixed,
     ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
     sphere->GetSphereGeometry().rad = 0.1;
     sphere->Pos = m_chassisCOM;
-    m_chassis->AddAsset(sphere);
+    vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
 
     break;
   }
   case MESH:
   {
-    geometry::ChTriangleMeshConnected trimesh;
-    trimesh.LoadWavefrontMesh(m_chassisMeshFile, false, false);
+    vehicle::ChDeferredAssets::AddMesh(m_chassis, m_chassisMeshFile, m_chassisMeshName);
 
-    ChSharedPtr<ChTriangleMeshShape> trimesh_shape(new ChTriangleMeshShape);
-    trimesh_shape->SetMesh(trimesh);
-    trimesh_shape->SetName(m_chassisMeshName);
-    m_chassis->AddAsset(trimesh_shape);
+    break;
+  }
+  case LOD:
+  {
+    for (int i = 0; i < vehicle::ChMeshCache::NUM_LOD_LEVELS; i++)
+      m_chassis->AddAsset(vehicle::ChMeshCache::GetMeshLodAssets(m_chassisMeshFile, m_chassisMeshName,
+                                                                 vehicle::ChMeshCache::LodLevel(i)));
 
     break;
   }
@@ -189,6 +190,9 @@ void HMMWV_VehicleReduced::Initialize(const ChCoordsys<>& chassisPos)
   m_brakes[1]->Initialize(m_suspensions[0]->GetRevolute(RIGHT));
   m_brakes[2]->Initialize(m_suspensions[1]->GetRevolute(LEFT));
   m_brakes[3]->Initialize(m_suspensions[1]->GetRevolute(RIGHT));
+
+  // Filter the collision pairs between vehicle bodies
+  InitializeCollisionFamilies();
 }
 
 
@@ -206,11 +210,8 @@ void HMMWV_VehicleReduced::Update(double              time,
   // Let the steering subsystem process the steering input.
   m_steering->Update(time, steering);
 
-  // Apply tire forces to spindle bodies.
-  m_suspensions[0]->ApplyTireForce(LEFT, tire_forces[FRONT_LEFT.id()]);
-  m_suspensions[0]->ApplyTireForce(RIGHT, tire_forces[FRONT_RIGHT.id()]);
-  m_suspensions[1]->ApplyTireForce(LEFT, tire_forces[REAR_LEFT.id()]);
-  m_suspensions[1]->ApplyTireForce(RIGHT, tire_forces[REAR_RIGHT.id()]);
+  // Apply tire forces to spindle bodies (all wheels in one pass).
+  ApplyTireForces(&tire_forces[0], 4);
 
   // Apply braking
   m_brakes[0]->ApplyBrakeModulation(braking);
@@ -21,11 +21,14 @@
 #include "assets/ChTexture.h"
 #include "assets/ChColorAsset.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChMeshCache.h"
 
 #include "utils/ChUtilsInputOutput.h"
 
 #include "models/hmmwv/wheel/HMMWV_Wheel.h"
+#include "models/hmmwv/HMMWV_Units.h"
 
 using namespace chrono;
 
@@ -35,9 +38,6 @@ namespace hmmwv {
 // Static variables
 // -----------------------------------------------------------------------------
 
-static const double in2m = 0.0254;
-static const double lb2kg = 0.453592;
-
 const double      HMMWV_Wheel::m_radius = in2m * 18.15;
 const double      HMMWV_Wheel::m_width = in2m * 10;
 
@@ -84,30 +84,74 @@ void HMMWV_Wheel::Initialize(ChSharedBodyPtr spindle)
     cyl->GetCylinderGeometry().rad = m_radius;
     cyl->GetCylinderGeometry().p1 = ChVector<>(0, m_width / 2, 0);
     cyl->GetCylinderGeometry().p2 = ChVector<>(0, -m_width / 2, 0);
-    spindle->AddAsset(cyl);
+    vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 
     ChSharedPtr<ChTexture> tex(new ChTexture);
     tex->SetTextureFilename(GetChronoDataFile("bluwhite.png"));
-    spindle->AddAsset(tex);
+    vehicle::ChDeferredAssets::AddAsset(spindle, tex);
 
     break;
   }
   case MESH:
   {
-    geometry::ChTriangleMeshConnected trimesh;
-    trimesh.LoadWavefrontMesh(getMeshFile(), false, false);
+    vehicle::ChDeferredAssets::AddMesh(spindle, getMeshFile(), getMeshName());
+
+    ChSharedPtr<ChColorAsset> mcolor(new ChColorAsset(0.3f, 0.3f, 0.3f));
+    vehicle::ChDeferredAssets::AddAsset(spindle, mcolor);
+
+    break;
+  }
+  case LOD:
+  {
+    for (int i = 0; i < vehicle::ChMeshCache::NUM_LOD_LEVELS; i++)
+      spindle->AddAsset(getLodAssets(vehicle::ChMeshCache::LodLevel(i)));
+
+    break;
+  }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The level-of-detail groups are shared by all wheels with the same mesh. The
+// wheels are not drawn at the impostor level (the chassis impostor stands for
+// the complete vehicle).
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChAssetLevel> HMMWV_Wheel::getLodAssets(vehicle::ChMeshCache::LodLevel level) const
+{
+  ChSharedPtr<ChAssetLevel> assets = vehicle::ChMeshCache::GetLodAssets(getMeshFile(), level);
+  if (!assets.IsNull())
+    return assets;
+
+  assets = ChSharedPtr<ChAssetLevel>(new ChAssetLevel);
+
+  switch (level) {
+  case vehicle::ChMeshCache::LOD_MESH:
+  {
+    assets->AddAsset(vehicle::ChMeshCache::GetMeshShape(getMeshFile(), getMeshName()));
 
-    ChSharedPtr<ChTriangleMeshShape> trimesh_shape(new ChTriangleMeshShape);
-    trimesh_shape->SetMesh(trimesh);
-    trimesh_shape->SetName(getMeshName());
-    spindle->AddAsset(trimesh_shape);
+    ChSharedPtr<ChColorAsset> mcolor(new ChColorAsset(0.3f, 0.3f, 0.3f));
+    assets->AddAsset(mcolor);
+
+    break;
+  }
+  case vehicle::ChMeshCache::LOD_PRIMITIVES:
+  {
+    ChSharedPtr<ChCylinderShape> cyl(new ChCylinderShape);
+    cyl->GetCylinderGeometry().rad = m_radius;
+    cyl->GetCylinderGeometry().p1 = ChVector<>(0, m_width / 2, 0);
+    cyl->GetCylinderGeometry().p2 = ChVector<>(0, -m_width / 2, 0);
+    assets->AddAsset(cyl);
 
     ChSharedPtr<ChColorAsset> mcolor(new ChColorAsset(0.3f, 0.3f, 0.3f));
-    spindle->AddAsset(mcolor);
+    assets->AddAsset(mcolor);
 
     break;
   }
+  case vehicle::ChMeshCache::LOD_IMPOSTOR:
+    break;
   }
+
+  return vehicle::ChMeshCache::AddLodAssets(getMeshFile(), level, assets);
 }
 
 
@@ -20,6 +20,7 @@
 #define HMMWV_WHEEL_H
 
 #include "subsys/ChWheel.h"
+#include "subsys/ChMeshCache.h"
 
 #include "models/ModelDefs.h"
 
@@ -43,6 +44,9 @@ public:
 
 private:
 
+  // Get the shared asset group for the specified level of detail.
+  chrono::ChSharedPtr<chrono::ChAssetLevel> getLodAssets(chrono::vehicle::ChMeshCache::LodLevel level) const;
+
   VisualizationType  m_visType;
 
   static const double  m_radius;
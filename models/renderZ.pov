@@ -21,7 +21,20 @@ global_settings { ambient_light rgb<1, 1, 1> }
 //#declare fnum=abs(frame_number); 
 #declare fnum = 1;
 
-#declare datafile = concat("POVRAY/data_", str(fnum,-3,0), ".dat")
+// Incremental output?
+// If true, the asset table is read from assetfile (see WriteAssetsPovray) and
+// the body poses and links of each frame from the bodies_###.dat files (see
+// WriteBodiesPovray). Otherwise, each frame is read from a data_###.dat file
+// (see WriteShapesPovray and ExpandShapesPovray).
+#declare incremental = false;
+
+#declare assetfile = "POVRAY/assets.dat"
+
+#if (incremental)
+  #declare datafile = concat("POVRAY/bodies_", str(fnum,-3,0), ".dat")
+#else
+  #declare datafile = concat("POVRAY/data_", str(fnum,-3,0), ".dat")
+#end
 
 
 // -------------------------------------------------------           
@@ -312,132 +325,254 @@ global_settings { ambient_light rgb<1, 1, 1> }
     Parse_String(concat("#include \"", mesh_name,"\""))
     Parse_String(concat(mesh_name, " position(pos,rot)"))
 #end   
-  
-  
 
-// ============================================================================================
-//
-// READ DATA AND RENDER SCENE
+// --------------------------------------------------------------------------------------------          
+// Compose two RIGHT-HAND-FRAME quaternions <e0,e1,e2,e3> (A followed by B)
 //
-// ============================================================================================
+#macro QMul(A, B)
+  #local Q = <A.x*B.x - A.y*B.y - A.z*B.z - A.t*B.t,
+              A.x*B.y + A.y*B.x + A.z*B.t - A.t*B.z,
+              A.x*B.z - A.y*B.t + A.z*B.x + A.t*B.y,
+              A.x*B.t + A.y*B.z - A.z*B.y + A.t*B.x>;
+  Q
+#end
 
-// Read datafile
-#warning concat("LOADING DATA FILE : ",  datafile, "\n")
-#fopen MyDataFile datafile read 
-                               
-#read (MyDataFile, numBodies, numObjects, numLinks)
+// --------------------------------------------------------------------------------------------          
+// Rotate the vector V by the RIGHT-HAND-FRAME quaternion Q <e0,e1,e2,e3>
+//
+#macro QRotate(Q, V)
+  #local U = <Q.y, Q.z, Q.t>;
+  #local T = 2 * vcross(U, V);
+  #local R = V + Q.x * T + vcross(U, T);
+  R
+#end
 
-        // ---------------------------------------------
-        // RENDER BODY FRAMES
-        // ---------------------------------------------
+// --------------------------------------------------------------------------------------------          
+// Read the geometry of a visual asset of the specified shape type from MyDataFile into the
+// array G (or, for a mesh, into mesh_name)
+//
+#declare G = array[7] {0, 0, 0, 0, 0, 0, 0}
+#declare mesh_name = "";
 
-#for (i, 1, numBodies)
-    #read (MyDataFile, id, active, ax, ay, az, e0, e1, e2, e3)
-    #if (draw_body_frame & (active | render_static))
-       object {
-            XYZframe(body_frame_len, body_frame_radius) 
-            position(<ax,ay,az>,<e0,e1,e2,e3>)  
-       }
+#macro ReadGeometry(shape)
+    #switch (shape)
+        #case (0)
+            #read (MyDataFile, g0)
+            #declare G[0] = g0;
+        #break
+        #case (2)
+        #case (1)
+            #read (MyDataFile, g0, g1, g2)
+            #declare G[0] = g0; #declare G[1] = g1; #declare G[2] = g2;
+        #break
+        #case (3)
+            #read (MyDataFile, g0, g1, g2, g3, g4, g5, g6)
+            #declare G[0] = g0; #declare G[1] = g1; #declare G[2] = g2; #declare G[3] = g3;
+            #declare G[4] = g4; #declare G[5] = g5; #declare G[6] = g6;
+        #break
+        #case (5)
+            #read (MyDataFile, mesh_name)
+        #break
+        #case (7)
+        #case (8)
+            #read (MyDataFile, g0, g1)
+            #declare G[0] = g0; #declare G[1] = g1;
+        #break
+        #case (9)
+            #read (MyDataFile, g0, g1, g2, g3)
+            #declare G[0] = g0; #declare G[1] = g1; #declare G[2] = g2; #declare G[3] = g3;
+        #break
+        #case (10)
+            #read (MyDataFile, g0, g1, g2)
+            #declare G[0] = g0; #declare G[1] = g1; #declare G[2] = g2;
+        #break
     #end
 #end
 
-        // ---------------------------------------------
-        //    RENDER OBJECTS (VISUAL ASSETS)
-        // ---------------------------------------------
-                                           
-#for (i, 1, numObjects)                               
-              
-    #read (MyDataFile, id, active, ax, ay, az, e0, e1, e2, e3, cR, cG, cB, shape)  
-                           
+// --------------------------------------------------------------------------------------------          
+// Render a visual asset of the specified shape type, with the geometry in G (or mesh_name),
+// at the given RIGHT-HAND-FRAME location P and orientation Q, and with color C
+//
+#macro RenderShape(id, shape, P, Q, C)
     #switch (shape)
                        
         // sphere -------------  
         #case (0)
-            # read (MyDataFile, ar)  
-            #if (render_objects & (active | render_static))
-			    sphere {
-				    <0,0,0>, ar
-					position(<ax,ay,az>,<e0,e1,e2,e3>)
-					pigment {color rgbt <cR, cG, cB, 0> }
-					finish {diffuse 1 ambient 0.0 specular .05 } 
-				}  
-            #end                                             
+		    sphere {
+			    <0,0,0>, G[0]
+				position(P, Q)
+				pigment {color rgbt <C.x, C.y, C.z, 0> }
+				finish {diffuse 1 ambient 0.0 specular .05 } 
+			}  
         #break     
               
         // box ----------------
         #case (2)
-            #read (MyDataFile, hx, hy, hz)
-			#if (render_objects & (active | render_static))  
-				box {   
-				    <-hx, -hz, -hy>, 
-					<hx, hz, hy>     
-					position(<ax,ay,az>,<e0,e1,e2,e3>)
-					pigment {color rgbt <cR, cG, cB, 0>}
-					finish {diffuse 1 ambient 0.0 specular .05 } 
-				}   
-			#end
-                                                                      
+			box {   
+			    <-G[0], -G[2], -G[1]>, 
+				<G[0], G[2], G[1]>     
+				position(P, Q)
+				pigment {color rgbt <C.x, C.y, C.z, 0>}
+				finish {diffuse 1 ambient 0.0 specular .05 } 
+			}   
         #break
               
         // cylinder --------------
         #case (3)
-            #read (MyDataFile, ar, p1x, p1y, p1z, p2x, p2y, p2z)   
-            #if (p1x = p2x & p1y = p2y & p1z = p2z) 
+            #if (G[1] = G[4] & G[2] = G[5] & G[3] = G[6]) 
                  #warning concat("DEGENERATE CYLINDER : ",  str(id,-3,0), "\n")
             #end
-			#if (render_objects & (active | render_static))
-				cylinder {
-			        <p1x,p1z,p1y>, <p2x,p2z,p2y>, ar      
-					pigment {color rgbt <cR, cG, cB, 0> transmit 0}
-					position(<ax,ay,az>,<e0,e1,e2,e3>)     
-					finish {diffuse 1 ambient 0.0 specular .05 }
-				}   
-			#end
+			cylinder {
+		        <G[1],G[3],G[2]>, <G[4],G[6],G[5]>, G[0]      
+				pigment {color rgbt <C.x, C.y, C.z, 0> transmit 0}
+				position(P, Q)     
+				finish {diffuse 1 ambient 0.0 specular .05 }
+			}   
         #break
          
         // rounded cylinder --------------
         #case (10)
-            #read (MyDataFile, ar, hl, sr)
-			#if (render_objects & (active | render_static))
-				object {
-			        Round_Cylinder(<0,0,hl + sr>, <0,0,-hl - sr>, ar+sr, sr, 0)     
-					pigment {color rgbt <cR, cG, cB, 0> }
-					position(<ax,ay,az>,<e0,e1,e2,e3>)     
-					finish {diffuse 1 ambient 0.0 specular .05 }
-				}   
-			#end
+			object {
+		        Round_Cylinder(<0,0,G[1] + G[2]>, <0,0,-G[1] - G[2]>, G[0]+G[2], G[2], 0)     
+				pigment {color rgbt <C.x, C.y, C.z, 0> }
+				position(P, Q)     
+				finish {diffuse 1 ambient 0.0 specular .05 }
+			}   
         #break
 
         // capsule ------------
         #case (7)
-            #read (MyDataFile, ar, hl)  
-			#if (render_objects & (active | render_static))
-				sphere_sweep {
-			        linear_spline
-					2
-					<0,0,-hl>,ar,<0,0,hl>,ar
-					pigment {color rgbt <cR, cG, cB, 0> }
-					position(<ax,ay,az>,<e0,e1,e2,e3>)     
-					finish {diffuse 1 ambient 0.0 specular .05 }
-				}
-			#end
+			sphere_sweep {
+		        linear_spline
+				2
+				<0,0,-G[1]>,G[0],<0,0,G[1]>,G[0]
+				pigment {color rgbt <C.x, C.y, C.z, 0> }
+				position(P, Q)     
+				finish {diffuse 1 ambient 0.0 specular .05 }
+			}
         #break  
         
         // mesh ----------------
         #case (5)
-            #read (MyDataFile, mesh_name)
-			#if (render_objects & (active | render_static))
-			    #warning concat("Mesh name: ", mesh_name, "\n")   
-				object {
-			        MyMesh(mesh_name, <ax,ay,az>,<e0,e1,e2,e3>)     
-			    }
-			#end
+		    #warning concat("Mesh name: ", mesh_name, "\n")   
+			object {
+		        MyMesh(mesh_name, P, Q)     
+		    }
         #break  
            
     #end  // switch (shape)     
-     
-       
-#end  // for objects      
+#end
+  
+  
+
+// ============================================================================================
+//
+// READ DATA AND RENDER SCENE
+//
+// ============================================================================================
+
+// Read the asset table (incremental output)
+#if (incremental)
+    #warning concat("LOADING ASSET FILE : ",  assetfile, "\n")
+    #fopen MyDataFile assetfile read
+
+    #read (MyDataFile, numAssetBodies, numObjects)
+
+    #for (i, 1, numAssetBodies)
+        #read (MyDataFile, id)
+    #end
+
+    #if (numObjects > 0)
+        #declare a_body  = array[numObjects]
+        #declare a_pos   = array[numObjects]
+        #declare a_rot   = array[numObjects]
+        #declare a_col   = array[numObjects]
+        #declare a_shape = array[numObjects]
+        #declare a_geom  = array[numObjects][7]
+        #declare a_mesh  = array[numObjects]
+    #end
+
+    #for (i, 0, numObjects - 1)
+        #read (MyDataFile, ib, ax, ay, az, e0, e1, e2, e3, cR, cG, cB, shape)
+        #declare mesh_name = "";
+        ReadGeometry(shape)
+        #declare a_body[i] = ib;
+        #declare a_pos[i] = <ax,ay,az>;
+        #declare a_rot[i] = <e0,e1,e2,e3>;
+        #declare a_col[i] = <cR,cG,cB>;
+        #declare a_shape[i] = shape;
+        #for (k, 0, 6)
+            #declare a_geom[i][k] = G[k];
+        #end
+        #declare a_mesh[i] = mesh_name;
+    #end
+
+    #fclose MyDataFile
+#end
+
+// Read datafile
+#warning concat("LOADING DATA FILE : ",  datafile, "\n")
+#fopen MyDataFile datafile read 
+                               
+#if (incremental)
+    #read (MyDataFile, numBodies, numLinks)
+    #if (numBodies != numAssetBodies)
+        #error concat("DATA FILE DOES NOT MATCH THE ASSET FILE : ",  datafile, "\n")
+    #end
+    #declare b_id     = array[numBodies]
+    #declare b_active = array[numBodies]
+    #declare b_pos    = array[numBodies]
+    #declare b_rot    = array[numBodies]
+#else
+    #read (MyDataFile, numBodies, numObjects, numLinks)
+#end
+
+        // ---------------------------------------------
+        // RENDER BODY FRAMES
+        // ---------------------------------------------
+
+#for (i, 1, numBodies)
+    #read (MyDataFile, id, active, ax, ay, az, e0, e1, e2, e3)
+    #if (incremental)
+        #declare b_id[i-1] = id;
+        #declare b_active[i-1] = active;
+        #declare b_pos[i-1] = <ax,ay,az>;
+        #declare b_rot[i-1] = <e0,e1,e2,e3>;
+    #end
+    #if (draw_body_frame & (active | render_static))
+       object {
+            XYZframe(body_frame_len, body_frame_radius) 
+            position(<ax,ay,az>,<e0,e1,e2,e3>)  
+       }
+    #end
+#end
+
+        // ---------------------------------------------
+        //    RENDER OBJECTS (VISUAL ASSETS)
+        // ---------------------------------------------
+                                           
+#if (incremental)
+    #for (i, 0, numObjects - 1)
+        #local ib = a_body[i];
+        #if (render_objects & (b_active[ib] | render_static))
+            #for (k, 0, 6)
+                #declare G[k] = a_geom[i][k];
+            #end
+            #declare mesh_name = a_mesh[i];
+            #local P = b_pos[ib] + QRotate(b_rot[ib], a_pos[i]);
+            #local Q = QMul(b_rot[ib], a_rot[i]);
+            RenderShape(b_id[ib], a_shape[i], P, Q, a_col[i])
+        #end
+    #end
+#else
+    #for (i, 1, numObjects)                               
+        #read (MyDataFile, id, active, ax, ay, az, e0, e1, e2, e3, cR, cG, cB, shape)  
+        ReadGeometry(shape)
+        #if (render_objects & (active | render_static))
+            RenderShape(id, shape, <ax,ay,az>, <e0,e1,e2,e3>, <cR,cG,cB>)
+        #end
+    #end  // for objects      
+#end
  
         // ---------------------------------------------
         //    RENDER LINKS
@@ -0,0 +1,217 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Vehicle simulation driven through the Python bindings.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "core/ChLog.h"
+#include "physics/ChBodyAuxRef.h"
+
+#include "python/ChPySimulation.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const int TRACE_SIZE = 8;
+
+// -----------------------------------------------------------------------------
+// Simulation loop forwarding its output hook to the Python simulation.
+// -----------------------------------------------------------------------------
+class ChPyLoop : public ChVehicleSimulation
+{
+public:
+  ChPyLoop(ChPySimulation* owner, const ChScenarioModules& modules, double step_size)
+  : ChVehicleSimulation(modules.vehicle, modules.powertrain, modules.driver, modules.terrain, step_size),
+    m_owner(owner)
+  {}
+
+private:
+  virtual void OnOutput(double time) { m_owner->record(time); }
+
+  ChPySimulation* m_owner;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPySimulation::ChPySimulation()
+: m_loop(0),
+  m_log(0),
+  m_trace_rows(0),
+  m_trace_enabled(false)
+{
+  std::fill(m_state, m_state + STATE_SIZE, 0.0);
+}
+
+ChPySimulation* ChPySimulation::Create(const ChScenario& scenario, const std::string& log_file)
+{
+  ChPySimulation* sim = new ChPySimulation;
+
+  if (!log_file.empty()) {
+    sim->m_log = new ChStreamOutAsciiFile(log_file.c_str());
+    sim->m_context.SetLog(sim->m_log);
+  }
+  ChSimulationContext::Scope scope(sim->m_context);
+
+  if (!ChScenarioRunner::CreateModules(scenario, sim->m_modules)) {
+    delete sim;
+    return 0;
+  }
+
+  sim->m_loop = new ChPyLoop(sim, sim->m_modules, scenario.step_size);
+  for (int i = 0; i < sim->GetNumWheels(); i++)
+    sim->m_loop->SetTire(i, sim->m_modules.tires[i]);
+  sim->m_loop->SetKpiMonitor(&sim->m_kpi);
+  sim->update_state();
+
+  return sim;
+}
+
+// The loop is destroyed first, so that the modules are released (under the
+// setup lock) with their last references.
+ChPySimulation::~ChPySimulation()
+{
+  {
+    ChSimulationContext::Scope scope(m_context);
+    delete m_loop;
+    ChScenarioRunner::ReleaseModules(m_modules);
+  }
+  delete m_log;
+}
+
+ChVehicleSimulation& ChPySimulation::GetLoop()
+{
+  return *m_loop;
+}
+
+const ChWheelStates& ChPySimulation::GetWheelStates() const
+{
+  return m_loop->GetWheelStates();
+}
+
+const ChTireForces& ChPySimulation::GetTireForces() const
+{
+  return m_loop->GetTireForces();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPySimulation::Advance(double end_time)
+{
+  ChSimulationContext::Scope scope(m_context);
+
+  while (m_loop->GetTime() < end_time) {
+    m_loop->DoStep();
+    update_state();
+  }
+
+  update_kpi_summary();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const char* ChPySimulation::GetTraceHeader()
+{
+  return "time,x,y,z,speed,throttle,steering,braking";
+}
+
+void ChPySimulation::EnableTrace(double output_step, int max_rows)
+{
+  m_trace.Reset(GetTraceHeader(), (size_t)std::max(max_rows, 0));
+  m_trace_rows = (size_t)std::max(max_rows, 0);
+  m_trace_enabled = true;
+  m_loop->SetOutputStep(output_step);
+}
+
+void ChPySimulation::record(double time)
+{
+  if (!m_trace_enabled || m_trace.GetNumRows() >= m_trace_rows)
+    return;
+
+  ChVector<> pos = m_loop->GetChassisPos();
+  double row[TRACE_SIZE] = { time, pos.x, pos.y, pos.z, m_loop->GetVehicleSpeed(),
+                             m_loop->GetThrottle(), m_loop->GetSteering(), m_loop->GetBraking() };
+  m_trace.Append(row);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPySimulation::update_state()
+{
+  ChVector<> pos = m_loop->GetChassisPos();
+  m_state[STATE_TIME] = m_loop->GetTime();
+  m_state[STATE_STEP] = m_loop->GetStepNumber();
+  m_state[STATE_POS_X] = pos.x;
+  m_state[STATE_POS_Y] = pos.y;
+  m_state[STATE_POS_Z] = pos.z;
+  m_state[STATE_SPEED] = m_loop->GetVehicleSpeed();
+
+  if (!m_loop->IsKinematic()) {
+    ChSharedPtr<ChVehicle> vehicle = m_loop->GetVehicle();
+    const ChQuaternion<>& rot = vehicle->GetChassisRot();
+    ChVector<> vel = vehicle->GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt();
+    ChVector<> angvel = vehicle->GetChassisBody()->GetWvel_par();
+    m_state[STATE_ROT_E0] = rot.e0;
+    m_state[STATE_ROT_E1] = rot.e1;
+    m_state[STATE_ROT_E2] = rot.e2;
+    m_state[STATE_ROT_E3] = rot.e3;
+    m_state[STATE_VEL_X] = vel.x;
+    m_state[STATE_VEL_Y] = vel.y;
+    m_state[STATE_VEL_Z] = vel.z;
+    m_state[STATE_ANGVEL_X] = angvel.x;
+    m_state[STATE_ANGVEL_Y] = angvel.y;
+    m_state[STATE_ANGVEL_Z] = angvel.z;
+    m_state[STATE_ENGINE_SPEED] = m_loop->GetPowertrain()->GetMotorSpeed();
+  }
+
+  m_state[STATE_THROTTLE] = m_loop->GetThrottle();
+  m_state[STATE_STEERING] = m_loop->GetSteering();
+  m_state[STATE_BRAKING] = m_loop->GetBraking();
+  m_state[STATE_POWERTRAIN_TORQUE] = m_loop->GetPowertrainTorque();
+  m_state[STATE_DRIVESHAFT_SPEED] = m_loop->GetDriveshaftSpeed();
+}
+
+void ChPySimulation::ResizeKpiSummary()
+{
+  m_kpi_summary.assign(KPI_SIZE * m_kpi.GetNumKpis(), 0.0);
+  update_kpi_summary();
+}
+
+void ChPySimulation::update_kpi_summary()
+{
+  int num_kpis = std::min(m_kpi.GetNumKpis(), (int)m_kpi_summary.size() / KPI_SIZE);
+
+  for (int k = 0; k < num_kpis; k++) {
+    double* row = &m_kpi_summary[KPI_SIZE * k];
+    row[KPI_COUNT] = m_kpi.GetCount(k);
+    row[KPI_MIN] = m_kpi.GetMin(k);
+    row[KPI_MAX] = m_kpi.GetMax(k);
+    row[KPI_TIME_OF_MIN] = m_kpi.GetTimeOfMin(k);
+    row[KPI_TIME_OF_MAX] = m_kpi.GetTimeOfMax(k);
+    row[KPI_MEAN] = m_kpi.GetMean(k);
+    row[KPI_RMS] = m_kpi.GetRMS(k);
+    row[KPI_INTEGRAL] = m_kpi.GetIntegral(k);
+    row[KPI_UP_CROSSINGS] = m_kpi.GetUpCrossings(k);
+    row[KPI_DOWN_CROSSINGS] = m_kpi.GetDownCrossings(k);
+    row[KPI_TIME_ABOVE] = m_kpi.GetTimeAbove(k);
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
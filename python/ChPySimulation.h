@@ -0,0 +1,166 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Vehicle simulation driven through the Python bindings (see ChPyVehicle.h and
+// chrono_vehicle.py).
+//
+// The modules are those of a scenario (see ChScenarioRunner::CreateModules()),
+// stepped by a ChVehicleSimulation. All data read from Python lives in buffers
+// owned by this object, with addresses that do not change during its lifetime,
+// so that Python wraps them once as NumPy arrays without copying:
+//  - the wheel states and tire forces exchanged by the simulation loop (see
+//    ChVehicleSimulation::GetWheelStates() and GetTireForces()), as they are;
+//  - the vehicle state record (see StateIndex), refreshed after each step;
+//  - the trace columns, one contiguous column per channel (see EnableTrace()),
+//    appended at each output step into storage reserved up front;
+//  - the KPI summary, one row per KPI (see KpiIndex), refreshed at the end of
+//    each Advance(); it is reallocated when a KPI is added.
+//
+// =============================================================================
+
+#ifndef CH_PY_SIMULATION_H
+#define CH_PY_SIMULATION_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChStream.h"
+
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChKpiMonitor.h"
+#include "subsys/ChColumnStore.h"
+#include "subsys/ChSimulationContext.h"
+
+#include "runner/ChScenarioRunner.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChPyLoop;
+
+///
+/// Vehicle simulation with its state exposed in fixed buffers.
+///
+class ChPySimulation
+{
+public:
+
+  /// Entries of the vehicle state record. The chassis pose and velocities are
+  /// those of the chassis reference frame of the vehicle model, in the global
+  /// frame (not updated while the kinematic bicycle model is active, except
+  /// for the position and speed).
+  enum StateIndex {
+    STATE_TIME,
+    STATE_STEP,
+    STATE_POS_X, STATE_POS_Y, STATE_POS_Z,
+    STATE_ROT_E0, STATE_ROT_E1, STATE_ROT_E2, STATE_ROT_E3,
+    STATE_VEL_X, STATE_VEL_Y, STATE_VEL_Z,
+    STATE_ANGVEL_X, STATE_ANGVEL_Y, STATE_ANGVEL_Z,
+    STATE_SPEED,
+    STATE_THROTTLE, STATE_STEERING, STATE_BRAKING,
+    STATE_POWERTRAIN_TORQUE, STATE_DRIVESHAFT_SPEED, STATE_ENGINE_SPEED,
+    STATE_SIZE
+  };
+
+  /// Columns of a row of the KPI summary (see ChKpiMonitor).
+  enum KpiIndex {
+    KPI_COUNT, KPI_MIN, KPI_MAX, KPI_TIME_OF_MIN, KPI_TIME_OF_MAX,
+    KPI_MEAN, KPI_RMS, KPI_INTEGRAL,
+    KPI_UP_CROSSINGS, KPI_DOWN_CROSSINGS, KPI_TIME_ABOVE,
+    KPI_SIZE
+  };
+
+  /// Create the simulation of the specified scenario, with its messages
+  /// written to the specified file (empty: the global log). Returns NULL if
+  /// the modules cannot be created.
+  static ChPySimulation* Create(
+    const ChScenario&  scenario,     ///< [in] vehicle, tires, terrain and driver
+    const std::string& log_file      ///< [in] log file of the simulation (empty: global log)
+    );
+
+  ~ChPySimulation();
+
+  /// Get the simulation loop (e.g. to set module steps).
+  ChVehicleSimulation& GetLoop();
+
+  /// Get the number of wheels.
+  int GetNumWheels() const { return (int)m_modules.tires.size(); }
+
+  /// Advance the simulation until the specified time.
+  void Advance(double end_time);
+
+  /// Record the trace channels (see GetTraceHeader()) every output step, for
+  /// at most the specified number of rows, reserved here, so that the columns
+  /// are not reallocated (later rows are dropped). Discards any previous trace.
+  void EnableTrace(double output_step, int max_rows);
+
+  /// Get the header line of the trace columns.
+  static const char* GetTraceHeader();
+
+  /// Get the trace.
+  const ChColumnStore& GetTrace() const { return m_trace; }
+
+  /// Get the KPI monitor, attached to the loop.
+  ChKpiMonitor& GetKpiMonitor() { return m_kpi; }
+
+  /// Resize the KPI summary after KPIs were added.
+  void ResizeKpiSummary();
+
+  /// Get the vehicle state record (STATE_SIZE values).
+  const double* GetState() const { return m_state; }
+
+  /// Get the KPI summary (KPI_SIZE values per KPI).
+  const double* GetKpiSummary() const { return m_kpi_summary.empty() ? 0 : &m_kpi_summary[0]; }
+
+  /// Get the wheel states and tire forces exchanged by the simulation loop.
+  const ChWheelStates& GetWheelStates() const;
+  const ChTireForces& GetTireForces() const;
+
+private:
+
+  ChPySimulation();
+  ChPySimulation(const ChPySimulation&);
+  ChPySimulation& operator=(const ChPySimulation&);
+
+  friend class ChPyLoop;
+
+  // Append a trace row (called at each output step).
+  void record(double time);
+
+  // Refresh the vehicle state record and the KPI summary.
+  void update_state();
+  void update_kpi_summary();
+
+  ChScenarioModules       m_modules;
+  ChPyLoop*               m_loop;
+
+  ChStreamOutAsciiFile*   m_log;
+  ChSimulationContext     m_context;
+
+  ChKpiMonitor            m_kpi;
+  ChColumnStore           m_trace;
+  size_t                  m_trace_rows;    // capacity of the trace
+  bool                    m_trace_enabled;
+
+  double                  m_state[STATE_SIZE];
+  std::vector<double>     m_kpi_summary;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
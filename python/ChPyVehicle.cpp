@@ -0,0 +1,183 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// C interface of the ChronoVehicle Python bindings.
+//
+// =============================================================================
+
+#include <string>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleModelData.h"
+
+#include "python/ChPyVehicle.h"
+#include "python/ChPySimulation.h"
+
+#include "rapidjson/document.h"
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+
+namespace {
+
+ChPySimulation* Sim(void* sim)
+{
+  return (ChPySimulation*)sim;
+}
+
+// Address of the first of the doubles of a structure array, if the elements
+// are sequences of 'size' doubles.
+template <typename T>
+const double* PackedArray(const ChWheelArray<T>& array, const double* first, const double* last, int size,
+                          int* num_wheels, int* stride)
+{
+  *num_wheels = (int)array.size();
+  *stride = size;
+
+  if (sizeof(T) != size * sizeof(double) || last - first != size - 1)
+    return 0;
+
+  return first;
+}
+
+}  // end namespace
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void chv_set_data_path(const char* path)
+{
+  SetDataPath(path);
+}
+
+void* chv_create(const char* scenario_json, const char* log_file)
+{
+  rapidjson::Document d;
+  d.Parse<0>(scenario_json);
+
+  ChScenario scenario;
+  if (d.HasParseError() || !d.IsObject() || !ChScenarioRunner::LoadScenario(d, scenario)) {
+    GetLog() << "ERROR: invalid scenario\n";
+    return 0;
+  }
+
+  return ChPySimulation::Create(scenario, log_file ? log_file : "");
+}
+
+void chv_destroy(void* sim)
+{
+  delete Sim(sim);
+}
+
+int chv_num_wheels(void* sim)
+{
+  return Sim(sim)->GetNumWheels();
+}
+
+double chv_step_size(void* sim)
+{
+  return Sim(sim)->GetLoop().GetStepSize();
+}
+
+void chv_set_tire_threads(void* sim, int num_threads)
+{
+  Sim(sim)->GetLoop().SetTireThreads(num_threads);
+}
+
+void chv_advance(void* sim, double end_time)
+{
+  Sim(sim)->Advance(end_time);
+}
+
+void chv_override_inputs(void* sim, double steering, double throttle, double braking)
+{
+  Sim(sim)->GetLoop().OverrideInputs(steering, throttle, braking);
+}
+
+void chv_release_inputs(void* sim)
+{
+  Sim(sim)->GetLoop().ReleaseInputs();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const double* chv_state(void* sim, int* size)
+{
+  *size = ChPySimulation::STATE_SIZE;
+  return Sim(sim)->GetState();
+}
+
+const double* chv_wheel_states(void* sim, int* num_wheels, int* stride)
+{
+  const ChWheelStates& states = Sim(sim)->GetWheelStates();
+  return PackedArray(states, &states[0].pos.x, &states[0].omega, 14, num_wheels, stride);
+}
+
+const double* chv_tire_forces(void* sim, int* num_wheels, int* stride)
+{
+  const ChTireForces& forces = Sim(sim)->GetTireForces();
+  return PackedArray(forces, &forces[0].force.x, &forces[0].moment.z, 9, num_wheels, stride);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void chv_enable_trace(void* sim, double output_step, int max_rows)
+{
+  Sim(sim)->EnableTrace(output_step, max_rows);
+}
+
+const char* chv_trace_header()
+{
+  return ChPySimulation::GetTraceHeader();
+}
+
+const double* chv_trace_column(void* sim, int column, int* num_rows)
+{
+  const ChColumnStore& trace = Sim(sim)->GetTrace();
+  *num_rows = 0;
+  if (column < 0 || column >= trace.GetNumColumns())
+    return 0;
+
+  const std::vector<double>& values = trace.GetColumn(column);
+  *num_rows = (int)values.size();
+  return (values.capacity() > 0) ? &values[0] : 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int chv_add_kpi(void* sim, const char* name, int quantity, int wheel)
+{
+  if (quantity < ChKpiMonitor::SPEED || quantity > ChKpiMonitor::STEERING)
+    return -1;
+  if (quantity == ChKpiMonitor::WHEEL_LOAD && (wheel < 0 || wheel >= Sim(sim)->GetNumWheels()))
+    return -1;
+
+  int kpi = Sim(sim)->GetKpiMonitor().AddKpi(name, (ChKpiMonitor::Quantity)quantity, wheel);
+  Sim(sim)->ResizeKpiSummary();
+  return kpi;
+}
+
+void chv_set_kpi_threshold(void* sim, int kpi, double threshold)
+{
+  Sim(sim)->GetKpiMonitor().SetThreshold(kpi, threshold);
+}
+
+const double* chv_kpi_summary(void* sim, int* num_kpis, int* row_size)
+{
+  *num_kpis = Sim(sim)->GetKpiMonitor().GetNumKpis();
+  *row_size = ChPySimulation::KPI_SIZE;
+  return Sim(sim)->GetKpiSummary();
+}
@@ -0,0 +1,104 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// C interface of the ChronoVehicle Python bindings, loaded with ctypes by
+// chrono_vehicle.py (no Python headers or binding generator are needed to
+// build it).
+//
+// A simulation is created from a scenario, given as a JSON object in the
+// format of one element of a scenario list (see ChScenarioRunner::
+// LoadScenario()): JSON vehicle, powertrain, tires, terrain and driver. The
+// buffer functions return the addresses of the buffers of the simulation (see
+// ChPySimulation), which remain valid until the simulation is destroyed
+// (except for the KPI summary, reallocated when a KPI is added); their
+// contents are updated in place as the simulation advances.
+//
+// ctypes releases the GIL for the duration of each call, so that simulations
+// created and advanced by different Python threads run concurrently.
+//
+// =============================================================================
+
+#ifndef CH_PY_VEHICLE_H
+#define CH_PY_VEHICLE_H
+
+#include "core/ChPlatform.h"
+
+#if defined(CH_API_COMPILE_PYTHON)
+#define CH_PY_API extern "C" ChApiEXPORT
+#else
+#define CH_PY_API extern "C" ChApiIMPORT
+#endif
+
+
+/// Set the path to the ChronoVehicle data directory.
+CH_PY_API void chv_set_data_path(const char* path);
+
+/// Create a simulation of the specified scenario (JSON object), logging to
+/// the specified file (NULL or empty: the global log). Returns NULL if the
+/// scenario is invalid.
+CH_PY_API void* chv_create(const char* scenario_json, const char* log_file);
+
+/// Destroy a simulation.
+CH_PY_API void chv_destroy(void* sim);
+
+/// Get the number of wheels.
+CH_PY_API int chv_num_wheels(void* sim);
+
+/// Get the base step size.
+CH_PY_API double chv_step_size(void* sim);
+
+/// Set the number of threads advancing the tires (see
+/// ChVehicleSimulation::SetTireThreads()).
+CH_PY_API void chv_set_tire_threads(void* sim, int num_threads);
+
+/// Advance the simulation until the specified time.
+CH_PY_API void chv_advance(void* sim, double end_time);
+
+/// Replace the driver inputs with the specified values, or use the driver
+/// inputs again (see ChVehicleSimulation::OverrideInputs()).
+CH_PY_API void chv_override_inputs(void* sim, double steering, double throttle, double braking);
+CH_PY_API void chv_release_inputs(void* sim);
+
+/// Get the vehicle state record (see ChPySimulation::StateIndex).
+CH_PY_API const double* chv_state(void* sim, int* size);
+
+/// Get the wheel states (one ChWheelState per wheel: position, orientation,
+/// linear and angular velocity, wheel angular speed) and the tire forces (one
+/// ChTireForce per wheel: force, point, moment), with the number of doubles
+/// between the starts of two consecutive wheels. Returns NULL if the layout of
+/// the structures is not a sequence of doubles.
+CH_PY_API const double* chv_wheel_states(void* sim, int* num_wheels, int* stride);
+CH_PY_API const double* chv_tire_forces(void* sim, int* num_wheels, int* stride);
+
+/// Record the trace channels every output step, for at most max_rows rows.
+CH_PY_API void chv_enable_trace(void* sim, double output_step, int max_rows);
+
+/// Get the header line of the trace columns.
+CH_PY_API const char* chv_trace_header();
+
+/// Get the specified trace column and the number of rows recorded so far.
+CH_PY_API const double* chv_trace_column(void* sim, int column, int* num_rows);
+
+/// Add a KPI on a built-in signal (see ChKpiMonitor::Quantity). Returns the
+/// index of the KPI, or -1 if the quantity or the wheel is invalid.
+CH_PY_API int chv_add_kpi(void* sim, const char* name, int quantity, int wheel);
+
+/// Count the crossings of the specified threshold for the specified KPI.
+CH_PY_API void chv_set_kpi_threshold(void* sim, int kpi, double threshold);
+
+/// Get the KPI summary (see ChPySimulation::KpiIndex), one row per KPI.
+CH_PY_API const double* chv_kpi_summary(void* sim, int* num_kpis, int* row_size);
+
+
+#endif
@@ -0,0 +1,287 @@
+# -*- coding: utf-8 -*-
+"""
+Python bindings of the ChronoVehicle simulation loop.
+
+A Simulation is built from a scenario (a dict, or a JSON string, with the
+members of one element of the "Scenarios" array of a ChScenarioRunner scenario
+list: JSON vehicle, powertrain, tire model, terrain and driver files) and
+stepped from Python. Its state is exposed as NumPy arrays viewing the buffers
+of the library, without copying; the views are updated in place as the
+simulation advances:
+
+  state         vehicle state record (time, chassis pose and velocities,
+                speed, driver inputs, powertrain), see STATE
+  wheel_states  one row per wheel: position (3), orientation (4), linear
+                velocity (3), angular velocity (3), wheel angular speed
+  tire_forces   one row per wheel: force (3), application point (3), moment (3)
+  trace()       columns recorded at each output step (see enable_trace)
+  kpis()        KPI summary rows (see add_kpi and KPI)
+
+The GIL is released while the library runs (ctypes releases it during each
+call), so that independent simulations advance concurrently on Python threads:
+
+  import concurrent.futures
+  import chrono_vehicle as cv
+
+  cv.set_data_path('/path/to/data/')
+
+  def run(mu):
+      scenario = {'Name': 'mu %g' % mu,
+                  'Vehicle': 'hmmwv/vehicle/HMMWV_Vehicle.json',
+                  'Powertrain': 'hmmwv/powertrain/HMMWV_SimplePowertrain.json',
+                  'Driver': 'generic/driver/Sample_LaneChange.json',
+                  'Tire': {'Model': 'Pacejka', 'File': 'hmmwv/pactest.tir'},
+                  'Terrain': {'Model': 'Rigid', 'Friction Coefficient': mu}}
+      with cv.Simulation(scenario) as sim:
+          sim.add_kpi('lat_accel', 'LATERAL_ACCEL')
+          sim.enable_trace(0.01, 1001)
+          sim.advance(10.0)
+          return sim.kpis()['lat_accel']['max'], sim.trace()['speed'].copy()
+
+  with concurrent.futures.ThreadPoolExecutor(4) as pool:
+      results = list(pool.map(run, [0.4, 0.6, 0.8, 1.0]))
+
+The library (ChronoVehicle_Python, built with ENABLE_PYTHON) is looked up in
+the directory of this module, unless CHRONO_VEHICLE_PYTHON_LIB gives its path.
+A view keeps its simulation alive; after close(), the views must not be used.
+
+@author: Radu Serban
+"""
+
+import ctypes
+import json
+import os
+import sys
+
+import numpy as np
+
+# Entries of the vehicle state record (see ChPySimulation::StateIndex)
+STATE = ['time', 'step',
+         'pos_x', 'pos_y', 'pos_z',
+         'rot_e0', 'rot_e1', 'rot_e2', 'rot_e3',
+         'vel_x', 'vel_y', 'vel_z',
+         'angvel_x', 'angvel_y', 'angvel_z',
+         'speed',
+         'throttle', 'steering', 'braking',
+         'powertrain_torque', 'driveshaft_speed', 'engine_speed']
+
+# Columns of the KPI summary (see ChPySimulation::KpiIndex)
+KPI = ['count', 'min', 'max', 'time_of_min', 'time_of_max', 'mean', 'rms', 'integral',
+       'up_crossings', 'down_crossings', 'time_above']
+
+# Built-in KPI signals (see ChKpiMonitor::Quantity)
+QUANTITIES = ['SPEED', 'LONGITUDINAL_ACCEL', 'LATERAL_ACCEL', 'VERTICAL_ACCEL',
+              'ROLL_ANGLE', 'PITCH_ANGLE', 'YAW_RATE', 'WHEEL_LOAD',
+              'ENGINE_SPEED', 'ENGINE_POWER', 'THROTTLE', 'BRAKING', 'STEERING']
+
+
+def _load_library():
+    path = os.environ.get('CHRONO_VEHICLE_PYTHON_LIB')
+    if not path:
+        if sys.platform.startswith('win'):
+            name = 'ChronoVehicle_Python.dll'
+        elif sys.platform == 'darwin':
+            name = 'libChronoVehicle_Python.dylib'
+        else:
+            name = 'libChronoVehicle_Python.so'
+        path = os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+
+    lib = ctypes.CDLL(path)
+
+    c_int_p = ctypes.POINTER(ctypes.c_int)
+    c_double_p = ctypes.POINTER(ctypes.c_double)
+    signatures = {
+        'chv_set_data_path': (None, [ctypes.c_char_p]),
+        'chv_create': (ctypes.c_void_p, [ctypes.c_char_p, ctypes.c_char_p]),
+        'chv_destroy': (None, [ctypes.c_void_p]),
+        'chv_num_wheels': (ctypes.c_int, [ctypes.c_void_p]),
+        'chv_step_size': (ctypes.c_double, [ctypes.c_void_p]),
+        'chv_set_tire_threads': (None, [ctypes.c_void_p, ctypes.c_int]),
+        'chv_advance': (None, [ctypes.c_void_p, ctypes.c_double]),
+        'chv_override_inputs': (None, [ctypes.c_void_p, ctypes.c_double, ctypes.c_double, ctypes.c_double]),
+        'chv_release_inputs': (None, [ctypes.c_void_p]),
+        'chv_state': (c_double_p, [ctypes.c_void_p, c_int_p]),
+        'chv_wheel_states': (c_double_p, [ctypes.c_void_p, c_int_p, c_int_p]),
+        'chv_tire_forces': (c_double_p, [ctypes.c_void_p, c_int_p, c_int_p]),
+        'chv_enable_trace': (None, [ctypes.c_void_p, ctypes.c_double, ctypes.c_int]),
+        'chv_trace_header': (ctypes.c_char_p, []),
+        'chv_trace_column': (c_double_p, [ctypes.c_void_p, ctypes.c_int, c_int_p]),
+        'chv_add_kpi': (ctypes.c_int, [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_int]),
+        'chv_set_kpi_threshold': (None, [ctypes.c_void_p, ctypes.c_int, ctypes.c_double]),
+        'chv_kpi_summary': (c_double_p, [ctypes.c_void_p, c_int_p, c_int_p]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        f = getattr(lib, name)
+        f.restype = restype
+        f.argtypes = argtypes
+    return lib
+
+
+_lib = _load_library()
+
+
+def set_data_path(path):
+    '''
+    Set the path to the ChronoVehicle data directory (with a trailing slash).
+    '''
+    _lib.chv_set_data_path(path.encode())
+
+
+class Simulation:
+    '''
+    Vehicle simulation built from a scenario, with its state exposed as NumPy
+    views over the library buffers.
+    '''
+
+    def __init__(self, scenario, log_file=None):
+        if not isinstance(scenario, str):
+            scenario = json.dumps(scenario)
+        self._sim = _lib.chv_create(scenario.encode(), log_file.encode() if log_file else None)
+        if not self._sim:
+            raise RuntimeError('cannot create the simulation (see the log)')
+
+        self.num_wheels = _lib.chv_num_wheels(self._sim)
+        self.step_size = _lib.chv_step_size(self._sim)
+        self._kpi_names = []
+
+        n = ctypes.c_int()
+        stride = ctypes.c_int()
+        self.state = self._view(_lib.chv_state(self._sim, ctypes.byref(n)), n.value)
+        self.wheel_states = self._wheel_view(_lib.chv_wheel_states(self._sim, ctypes.byref(n), ctypes.byref(stride)),
+                                             n.value, stride.value)
+        self.tire_forces = self._wheel_view(_lib.chv_tire_forces(self._sim, ctypes.byref(n), ctypes.byref(stride)),
+                                            n.value, stride.value)
+
+        # named views into the state record and the wheel arrays
+        i = STATE.index
+        self.chassis_pos = self.state[i('pos_x'):i('pos_z') + 1]
+        self.chassis_rot = self.state[i('rot_e0'):i('rot_e3') + 1]
+        self.chassis_vel = self.state[i('vel_x'):i('vel_z') + 1]
+        self.chassis_angvel = self.state[i('angvel_x'):i('angvel_z') + 1]
+        self.driver_inputs = self.state[i('throttle'):i('braking') + 1]
+        self.wheel_pos = self.wheel_states[:, 0:3]
+        self.wheel_rot = self.wheel_states[:, 3:7]
+        self.wheel_vel = self.wheel_states[:, 7:10]
+        self.wheel_angvel = self.wheel_states[:, 10:13]
+        self.wheel_omega = self.wheel_states[:, 13]
+        self.tire_force = self.tire_forces[:, 0:3]
+        self.tire_point = self.tire_forces[:, 3:6]
+        self.tire_moment = self.tire_forces[:, 6:9]
+
+    def _view(self, ptr, size):
+        # The ctypes array refers to this simulation, and the NumPy array to
+        # the ctypes array, so that the simulation outlives its views.
+        if not ptr or size == 0:
+            return np.zeros(0)
+        buf = (ctypes.c_double * size).from_address(ctypes.addressof(ptr.contents))
+        buf._owner = self
+        view = np.frombuffer(buf, dtype=np.float64)
+        view.flags.writeable = False
+        return view
+
+    def _wheel_view(self, ptr, num_wheels, stride):
+        if not ptr:
+            raise RuntimeError('unexpected layout of the wheel structures')
+        return self._view(ptr, num_wheels * stride).reshape(num_wheels, stride)
+
+    def close(self):
+        '''
+        Destroy the simulation (its views must no longer be used).
+        '''
+        if self._sim:
+            _lib.chv_destroy(self._sim)
+            self._sim = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    @property
+    def time(self):
+        return self.state[0]
+
+    def advance(self, end_time):
+        '''
+        Advance the simulation until the specified time (without the GIL).
+        '''
+        _lib.chv_advance(self._sim, end_time)
+
+    def step(self, num_steps=1):
+        '''
+        Advance the simulation by the specified number of base steps.
+        '''
+        _lib.chv_advance(self._sim, self.time + (num_steps - 0.5) * self.step_size)
+
+    def set_tire_threads(self, num_threads):
+        _lib.chv_set_tire_threads(self._sim, num_threads)
+
+    def override_inputs(self, steering, throttle, braking):
+        '''
+        Replace the driver inputs with the specified values, e.g. for a driver
+        implemented in Python (the scenario driver is still advanced).
+        '''
+        _lib.chv_override_inputs(self._sim, steering, throttle, braking)
+
+    def release_inputs(self):
+        _lib.chv_release_inputs(self._sim)
+
+    def enable_trace(self, output_step, max_rows):
+        '''
+        Record the trace columns every output step, for at most max_rows rows
+        (storage reserved up front; later rows are dropped).
+        '''
+        _lib.chv_enable_trace(self._sim, output_step, max_rows)
+
+    def trace(self):
+        '''
+        Dictionary of the trace columns (views over the rows recorded so far).
+        '''
+        names = _lib.chv_trace_header().decode().split(',')
+        columns = {}
+        for k, name in enumerate(names):
+            n = ctypes.c_int()
+            columns[name] = self._view(_lib.chv_trace_column(self._sim, k, ctypes.byref(n)), n.value)
+        return columns
+
+    def trace_frame(self):
+        '''
+        Trace as a pandas DataFrame, with the columns of a scenario output.csv
+        (pandas copies the columns).
+        '''
+        import pandas as pd
+        return pd.DataFrame(self.trace())
+
+    def add_kpi(self, name, quantity, wheel=0, threshold=None):
+        '''
+        Add a KPI on a built-in signal (one of QUANTITIES), optionally counting
+        the crossings of a threshold. Returns the index of the KPI.
+        '''
+        kpi = _lib.chv_add_kpi(self._sim, name.encode(), QUANTITIES.index(quantity), wheel)
+        if kpi < 0:
+            raise ValueError('invalid KPI %s' % name)
+        if threshold is not None:
+            _lib.chv_set_kpi_threshold(self._sim, kpi, threshold)
+        self._kpi_names.append(name)
+        return kpi
+
+    def kpi_summary(self):
+        '''
+        KPI summary as an array with one row per KPI and the columns of KPI
+        (a view, reallocated when a KPI is added).
+        '''
+        n = ctypes.c_int()
+        size = ctypes.c_int()
+        ptr = _lib.chv_kpi_summary(self._sim, ctypes.byref(n), ctypes.byref(size))
+        return self._view(ptr, n.value * size.value).reshape(n.value, size.value)
+
+    def kpis(self):
+        '''
+        Dictionary of the KPI summaries, by KPI name.
+        '''
+        summary = self.kpi_summary()
+        return dict((name, dict(zip(KPI, summary[k]))) for k, name in enumerate(self._kpi_names))
@@ -0,0 +1,17 @@
+#ifndef CHAPIRUNNER_H
+#define CHAPIRUNNER_H
+
+#include "core/ChPlatform.h"
+
+// When compiling this library, remember to define CH_API_COMPILE_RUNNER
+// (so that the symbols with 'CH_RUNNER_API' in front of them will be marked as
+// exported). Otherwise, just do not define it if you link the library to your
+// code, and the symbols will be imported.
+
+#if defined(CH_API_COMPILE_RUNNER)
+#define CH_RUNNER_API ChApiEXPORT
+#else
+#define CH_RUNNER_API ChApiIMPORT
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Monte-Carlo study of a vehicle scenario, with early stopping.
+//
+// The random inputs of the study (e.g. terrain seeds, friction levels, driver
+// maneuver parameters) are swept parameters of a base scenario, as in a
+// ChSweepRunner, sampled quasi-randomly: a single (scrambled) Sobol sequence,
+// or a Latin hypercube per batch. The runs are launched in batches on a
+// ChScenarioRunner; after each batch, the streaming statistics of the selected
+// KPIs are updated, and no further batch is launched once the confidence
+// interval of every selected KPI is narrower than its target width (or the
+// maximum number of runs is reached).
+//
+// A KPI is estimated either by its mean, or by the probability that it exceeds
+// a threshold (e.g. a rollover criterion on the maximum roll angle). The
+// confidence interval of a mean uses the sample standard deviation, with the
+// Student t quantile; for randomized quasi-random samples this interval is
+// conservative. The confidence interval of a probability is the Agresti-Coull
+// interval, which remains meaningful when no (or every) run exceeded the
+// threshold. Failed runs are excluded from the statistics.
+//
+// The runs of batch B are written to <output directory>/batch_BBB (see
+// ChScenarioRunner); the parameter values and KPIs of all runs are collected
+// in <output directory>/montecarlo.csv, and the estimates in
+// <output directory>/summary.csv.
+//
+// =============================================================================
+
+#ifndef CH_MONTE_CARLO_RUNNER_H
+#define CH_MONTE_CARLO_RUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "runner/ChApiRunner.h"
+#include "runner/ChScenarioRunner.h"
+#include "runner/ChSweepRunner.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// KPI monitored by a Monte-Carlo study, with its stopping criterion.
+///
+struct CH_RUNNER_API ChMonteCarloKpi
+{
+  enum Type {
+    DISTANCE,        ///< ChScenarioResult::distance
+    MAX_SPEED,       ///< ChScenarioResult::max_speed
+    MEAN_SPEED,      ///< ChScenarioResult::mean_speed
+    MAX_ROLL,        ///< ChScenarioResult::max_roll
+    MAX_PITCH,       ///< ChScenarioResult::max_pitch
+    MAX_LAT_ACCEL    ///< ChScenarioResult::max_lat_accel
+  };
+
+  ChMonteCarloKpi() : type(MAX_ROLL), width(0), relative(false), exceedance(false), threshold(0) {}
+
+  Type    type;
+  double  width;        ///< target width of the confidence interval (0: not a stopping criterion)
+  bool    relative;     ///< if true, the width is relative to the magnitude of the estimate
+  bool    exceedance;   ///< if true, estimate the probability that the KPI exceeds the threshold
+  double  threshold;    ///< threshold of the exceedance probability
+
+  /// Get the value of the KPI in the specified result.
+  double GetValue(const ChScenarioResult& res) const;
+
+  /// Get the name of the specified KPI type (as in the ChScenarioRunner report).
+  static const char* GetName(Type type);
+
+  /// Get the KPI type with the specified name. Returns false if the name is
+  /// unknown.
+  static bool GetType(const std::string& name, Type& type);
+};
+
+///
+/// Runner for Monte-Carlo studies with confidence-based early stopping.
+///
+class CH_RUNNER_API ChMonteCarloRunner
+{
+public:
+
+  /// Create a runner with the specified number of worker threads. If zero, use
+  /// the number of hardware threads.
+  ChMonteCarloRunner(int num_threads = 0);
+
+  ~ChMonteCarloRunner() {}
+
+  /// Set the top-level output directory (default: "MONTECARLO").
+  void SetOutputDirectory(const std::string& dir) { m_out_dir = dir; }
+
+  /// Set the directory of the result cache of the runs (see
+  /// ChScenarioRunner::SetResultCache; default: empty, no cache).
+  void SetResultCache(const std::string& dir) { m_cache_dir = dir; }
+
+  /// Set the scenario patched at each run.
+  void SetBaseScenario(const ChScenario& scenario) { m_base = scenario; }
+
+  /// Set the study name (default: "montecarlo").
+  void SetName(const std::string& name) { m_name = name; }
+
+  /// Set the sampling method, LATIN_HYPERCUBE or SOBOL (default), and its seed.
+  void SetSampling(ChSweepRunner::Sampling sampling, unsigned int seed = 1) { m_sampling = sampling; m_seed = seed; }
+
+  /// Set the number of runs per batch (default: 0, the number of worker
+  /// threads). The stopping criteria are evaluated after each batch.
+  void SetBatchSize(int batch_size) { m_batch_size = batch_size; }
+
+  /// Set the minimum and maximum number of runs (default: 8 and 1000).
+  void SetRunLimits(int min_runs, int max_runs) { m_min_runs = min_runs; m_max_runs = max_runs; }
+
+  /// Set the confidence level of the intervals (default: 0.95).
+  void SetConfidence(double level) { m_confidence = level; }
+
+  /// Add a random input of the study.
+  void AddParameter(const ChSweepParameter& parameter) { m_parameters.push_back(parameter); }
+
+  /// Add a monitored KPI.
+  void AddKpi(const ChMonteCarloKpi& kpi) { m_kpis.push_back(kpi); }
+
+  /// Load the base scenario, the sampling settings, the parameters and the KPIs
+  /// from the specified JSON file. Returns false if the file cannot be read or
+  /// is invalid.
+  bool LoadMonteCarlo(const std::string& filename);
+
+  /// Run batches until all stopping criteria are met or the maximum number of
+  /// runs is reached, and write the results tables. Returns false if the
+  /// study is not set up correctly, if any run failed, or if the criteria
+  /// were not met.
+  bool Run();
+
+  /// Return true if the last call to Run() met all stopping criteria.
+  bool IsConverged() const { return m_converged; }
+
+  /// Get the statistics of the runs executed by the last call to Run().
+  const std::vector<ChScenarioResult>& GetResults() const { return m_results; }
+
+  /// Get the number of runs included in the statistics of the last call to
+  /// Run() (the successful runs).
+  int GetNumSamples() const { return m_num_samples; }
+
+  /// Get the estimate of the specified KPI (mean or exceedance probability).
+  double GetEstimate(int kpi) const;
+
+  /// Get the half-width of the confidence interval of the specified KPI.
+  double GetHalfWidth(int kpi) const;
+
+private:
+
+  // Streaming statistics of a KPI (Welford's algorithm).
+  struct Statistics {
+    Statistics() : n(0), mean(0), m2(0) {}
+    void Add(double x);
+    int     n;
+    double  mean;
+    double  m2;
+  };
+
+  // Return true if the confidence interval of the specified KPI is narrow enough.
+  bool is_converged(int kpi) const;
+
+  // Write the results tables.
+  void write_tables(const std::vector<std::vector<double> >& values) const;
+
+  int                              m_num_threads;
+  std::string                      m_out_dir;
+  std::string                      m_cache_dir;
+  std::string                      m_name;
+  ChScenario                       m_base;
+  ChSweepRunner::Sampling          m_sampling;
+  unsigned int                     m_seed;
+  int                              m_batch_size;
+  int                              m_min_runs;
+  int                              m_max_runs;
+  double                           m_confidence;
+  std::vector<ChSweepParameter>    m_parameters;
+  std::vector<ChMonteCarloKpi>     m_kpis;
+
+  std::vector<ChScenarioResult>    m_results;
+  std::vector<Statistics>          m_stats;
+  int                              m_num_samples;
+  bool                             m_converged;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
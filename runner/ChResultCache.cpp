@@ -0,0 +1,227 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// On-disk cache of scenario results.
+//
+// =============================================================================
+
+#include <cstdio>
+
+#include "core/ChLog.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChContentHash.h"
+#include "subsys/ChCompressedFile.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChMappedFile.h"
+
+#include "runner/ChResultCache.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/filewritestream.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// Version of the result files (part of the key).
+static const char* RESULT_FORMAT = "CHRESULT1";
+
+static void AddDataFile(ChContentHash& hash, const std::string& filename)
+{
+  hash.Add(filename);
+  if (!filename.empty())
+    hash.AddFile(GetDataFile(filename));
+}
+
+
+// -----------------------------------------------------------------------------
+// Without a build identifier, the compilation time of the runner library is
+// used instead, so that results are never reused across rebuilds.
+// -----------------------------------------------------------------------------
+std::string ChResultCache::GetKey(const ChScenario& scenario)
+{
+  ChContentHash hash;
+
+  hash.Add(std::string(RESULT_FORMAT));
+  std::string build_id = BUILD_ID;
+  hash.Add(build_id.empty() ? std::string(__DATE__ " " __TIME__) : build_id);
+
+  AddDataFile(hash, scenario.vehicle_file);
+  AddDataFile(hash, scenario.reduced_vehicle_file);
+  AddDataFile(hash, scenario.powertrain_file);
+  AddDataFile(hash, scenario.driver_file);
+  AddDataFile(hash, scenario.tire_file);
+  AddDataFile(hash, scenario.terrain_file);
+  AddDataFile(hash, scenario.friction_file);
+
+  int models[2] = { (int)scenario.tire_model, (int)scenario.terrain_model };
+  hash.Add(models, sizeof(models));
+
+  double values[] = {
+    scenario.terrain_height, scenario.terrain_min, scenario.terrain_max,
+    scenario.terrain_sizeX, scenario.terrain_sizeY, scenario.terrain_mu,
+    (double)scenario.terrain_road_class, (double)scenario.terrain_seed,
+    scenario.terrain_coherence, scenario.terrain_track,
+    scenario.friction_min, scenario.friction_max,
+    scenario.init_loc.x, scenario.init_loc.y, scenario.init_loc.z,
+    scenario.init_rot.e0, scenario.init_rot.e1, scenario.init_rot.e2, scenario.init_rot.e3,
+    scenario.step_size, scenario.end_time, scenario.output_step,
+    scenario.settle_cache.empty() ? 0.0 : 1.0
+  };
+  hash.Add(values, sizeof(values));
+
+  for (size_t i = 0; i < scenario.model_schedule.size(); i++) {
+    hash.Add(scenario.model_schedule[i].time);
+    hash.Add((double)scenario.model_schedule[i].model);
+  }
+
+  for (size_t i = 0; i < scenario.patches.size(); i++) {
+    hash.Add(scenario.patches[i].file);
+    hash.Add(scenario.patches[i].pointer);
+    hash.Add(scenario.patches[i].value);
+  }
+
+  return hash.GetKey();
+}
+
+// -----------------------------------------------------------------------------
+// Result object:
+//   {
+//     "Format": "CHRESULT1",
+//     "Name": ..., "Build": ..., "Output Directory": ...,
+//     "Steps": ..., "Sim Time": ..., "Wall Time": ..., "Model Time": [3],
+//     "Distance": ..., "Max Speed": ..., "Mean Speed": ...,
+//     "Max Roll": ..., "Max Pitch": ..., "Max Lateral Acceleration": ...
+//   }
+// -----------------------------------------------------------------------------
+void ChResultCache::SaveResult(const ChScenarioResult& res, Value& object, Document::AllocatorType& allocator)
+{
+  object.SetObject();
+  object.AddMember("Format", StringRef(RESULT_FORMAT), allocator);
+  object.AddMember("Name", Value().SetString(res.name.c_str(), allocator), allocator);
+  object.AddMember("Build", StringRef(BUILD_ID), allocator);
+  object.AddMember("Output Directory", Value().SetString(res.output_dir.c_str(), allocator), allocator);
+  object.AddMember("Steps", res.num_steps, allocator);
+  object.AddMember("Sim Time", res.sim_time, allocator);
+  object.AddMember("Wall Time", res.wall_time, allocator);
+  Value model_time(kArrayType);
+  for (int i = 0; i < 3; i++)
+    model_time.PushBack(res.model_time[i], allocator);
+  object.AddMember("Model Time", model_time, allocator);
+  object.AddMember("Distance", res.distance, allocator);
+  object.AddMember("Max Speed", res.max_speed, allocator);
+  object.AddMember("Mean Speed", res.mean_speed, allocator);
+  object.AddMember("Max Roll", res.max_roll, allocator);
+  object.AddMember("Max Pitch", res.max_pitch, allocator);
+  object.AddMember("Max Lateral Acceleration", res.max_lat_accel, allocator);
+}
+
+bool ChResultCache::LoadResult(const Value& object, ChScenarioResult& res)
+{
+  static const char* numbers[] = { "Steps", "Sim Time", "Wall Time", "Distance", "Max Speed", "Mean Speed",
+                                   "Max Roll", "Max Pitch", "Max Lateral Acceleration" };
+
+  bool valid = object.IsObject() && object.HasMember("Format") && object["Format"].IsString() &&
+               std::string(object["Format"].GetString()) == RESULT_FORMAT &&
+               object.HasMember("Output Directory") && object["Output Directory"].IsString() &&
+               object.HasMember("Model Time") && object["Model Time"].IsArray() && object["Model Time"].Size() == 3;
+  for (int i = 0; valid && i < 9; i++)
+    valid = object.HasMember(numbers[i]) && object[numbers[i]].IsNumber();
+
+  if (!valid)
+    return false;
+
+  res.ok = true;
+  res.output_dir = object["Output Directory"].GetString();
+  res.num_steps = object["Steps"].GetInt();
+  res.sim_time = object["Sim Time"].GetDouble();
+  res.wall_time = object["Wall Time"].GetDouble();
+  for (SizeType i = 0; i < 3; i++)
+    res.model_time[i] = object["Model Time"][i].GetDouble();
+  res.distance = object["Distance"].GetDouble();
+  res.max_speed = object["Max Speed"].GetDouble();
+  res.mean_speed = object["Mean Speed"].GetDouble();
+  res.max_roll = object["Max Roll"].GetDouble();
+  res.max_pitch = object["Max Pitch"].GetDouble();
+  res.max_lat_accel = object["Max Lateral Acceleration"].GetDouble();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChResultCache::Load(const std::string& key, ChScenarioResult& res) const
+{
+  std::string text;
+  if (!ChCompressedFile::ReadAll(GetFile(key), text))
+    return false;
+
+  Document d;
+  d.Parse<0>(text.c_str());
+
+  if (d.HasParseError() || !LoadResult(d, res)) {
+    GetLog() << "WARNING: ignoring invalid cached result " << GetFile(key).c_str() << "\n";
+    return false;
+  }
+
+  res.cached = true;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// The temporary file name is unique per node, process and thread (host
+// clock, process ID and the address of a local).
+// -----------------------------------------------------------------------------
+bool ChResultCache::Store(const std::string& key, const ChScenarioResult& res) const
+{
+  std::string filename = GetFile(key);
+
+  std::string tmp_filename = filename + ChTempFileSuffix(&filename);
+
+  FILE* fp = fopen(tmp_filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "WARNING: cannot write cached result " << tmp_filename.c_str() << "\n";
+    return false;
+  }
+
+  Document d;
+  SaveResult(res, d, d.GetAllocator());
+
+  char writeBuffer[4096];
+  FileWriteStream os(fp, writeBuffer, sizeof(writeBuffer));
+  PrettyWriter<FileWriteStream> writer(os);
+  d.Accept(writer);
+
+  os.Flush();
+  bool ok = (ferror(fp) == 0);
+  ok = (fclose(fp) == 0) && ok;
+
+  if (!ok) {
+    GetLog() << "WARNING: cannot write cached result " << tmp_filename.c_str() << "\n";
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return ChReplaceFile(tmp_filename, filename);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
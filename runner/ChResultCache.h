@@ -0,0 +1,94 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// On-disk cache of scenario results, keyed by a content hash of all the inputs
+// of a scenario (see ChContentHash): the contents of its vehicle, powertrain,
+// tire, driver, terrain and friction files (including all the JSON files they
+// reference), its numeric settings (seeds, friction, step size, ...), its
+// model schedule and JSON patches, and the build identifier of the library
+// (BUILD_ID, see the CMake configuration). The scenario name is not part of
+// the key, so identical scenarios of different sweeps share their results.
+//
+// Each result is stored as a small JSON file <key>.result with the KPIs and
+// statistics of the run, and the output directory of the run that produced it
+// (the handle of its trace files, which are not copied into the cache).
+//
+// The cache directory can be shared by several processes and nodes at once
+// (e.g. on a network file system): a result is written to a uniquely named
+// temporary file, then renamed, so that readers only see complete results.
+// Concurrent runs of the same scenario both store it, the last one winning.
+//
+// =============================================================================
+
+#ifndef CH_RESULT_CACHE_H
+#define CH_RESULT_CACHE_H
+
+#include <string>
+
+#include "runner/ChApiRunner.h"
+#include "runner/ChScenarioRunner.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of scenario results.
+///
+class CH_RUNNER_API ChResultCache
+{
+public:
+
+  /// Create a cache storing the results in the specified (existing) directory.
+  ChResultCache(const std::string& dir) : m_dir(dir) {}
+
+  ~ChResultCache() {}
+
+  /// Compute the cache key of the specified scenario.
+  static std::string GetKey(const ChScenario& scenario);
+
+  /// Load the result with the specified key. On success, the result is marked
+  /// as cached and its output directory is the one of the original run; its
+  /// index and name are not modified. Returns false if there is no such
+  /// result.
+  bool Load(const std::string& key, ChScenarioResult& res) const;
+
+  /// Store the specified (successful) result under the specified key.
+  /// Returns false if the result cannot be written.
+  bool Store(const std::string& key, const ChScenarioResult& res) const;
+
+  /// Write the specified result to a JSON object (as stored in the cache).
+  static void SaveResult(const ChScenarioResult& res, rapidjson::Value& object, rapidjson::Document::AllocatorType& allocator);
+
+  /// Read a result from a JSON object written by SaveResult(). On success,
+  /// the result is marked as successful; its index, name and cached flag are
+  /// not modified. Returns false if the object is invalid.
+  static bool LoadResult(const rapidjson::Value& object, ChScenarioResult& res);
+
+  /// Get the file holding the result with the specified key.
+  std::string GetFile(const std::string& key) const { return m_dir + "/" + key + ".result"; }
+
+private:
+
+  std::string  m_dir;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,1161 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Runner for batches of independent vehicle simulations (scenarios).
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChFileutils.h"
+#include "core/ChLog.h"
+#include "core/ChTimer.h"
+#include "physics/ChSystem.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+#include "subsys/ChThreadPool.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/vehicle/Vehicle.h"
+#include "subsys/powertrain/SimplePowertrain.h"
+#include "subsys/powertrain/MapPowertrain.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonPatch.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChSettleCache.h"
+#include "subsys/ChCheckpointWriter.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/driver/ChDataDriver.h"
+#include "subsys/driver/ChManeuverDriver.h"
+#include "subsys/tire/RigidTire.h"
+#include "subsys/tire/LugreTire.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/RigidTerrain.h"
+#include "subsys/terrain/FlatTerrain.h"
+#include "subsys/terrain/HeightmapTerrain.h"
+#include "subsys/terrain/RoadProfileTerrain.h"
+
+#include "runner/ChScenarioRunner.h"
+#include "runner/ChResultCache.h"
+
+#include "rapidjson/document.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Construction and destruction of the vehicle subsystems are serialized: the
+// Pacejka parameter registry and cache are shared by all tires, and GetLog()
+// is not thread safe. The simulation loops run concurrently, each scenario
+// logging to its own file (see ChSimulationContext).
+// -----------------------------------------------------------------------------
+static ChMutex s_setup_mutex;
+
+
+// -----------------------------------------------------------------------------
+// Task running one scenario on a worker of the thread pool.
+// -----------------------------------------------------------------------------
+class ChScenarioTask : public ChTask
+{
+public:
+  ChScenarioTask(void (*run)(const ChScenario&, ChScenarioResult&),
+                 const ChScenario* scenario,
+                 ChScenarioResult* result)
+  : m_run(run), m_scenario(scenario), m_result(result) {}
+
+  virtual void Execute(int worker) { m_run(*m_scenario, *m_result); }
+
+private:
+  void (*m_run)(const ChScenario&, ChScenarioResult&);
+  const ChScenario* m_scenario;
+  ChScenarioResult* m_result;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChScenario::ChScenario()
+: name("scenario"),
+  vehicle_file("hmmwv/vehicle/HMMWV_Vehicle.json"),
+  powertrain_file("hmmwv/powertrain/HMMWV_SimplePowertrain.json"),
+  driver_file("generic/driver/Sample_Maneuver.txt"),
+  tire_model(RIGID_TIRE),
+  tire_file("hmmwv/tire/HMMWV_RigidTire.json"),
+  terrain_model(RIGID_TERRAIN),
+  terrain_height(0),
+  terrain_min(0),
+  terrain_max(1),
+  terrain_sizeX(100),
+  terrain_sizeY(100),
+  terrain_mu(0.8),
+  terrain_road_class(0),
+  terrain_seed(1),
+  terrain_coherence(0),
+  terrain_track(2),
+  friction_min(0),
+  friction_max(1),
+  init_loc(0, 0, 1.0),
+  init_rot(1, 0, 0, 0),
+  step_size(1e-3),
+  end_time(10),
+  output_step(0.1),
+  checkpoint_interval(0)
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChScenarioRunner::ChScenarioRunner(int num_threads)
+: m_num_threads(num_threads > 0 ? num_threads : ChThread::GetNumHardwareThreads()),
+  m_numa_placement(false),
+  m_out_dir("SCENARIOS"),
+  m_wall_time(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Scenario list file:
+//   { "Scenarios": [ { "Name": ..., "Vehicle": ..., ... }, ... ] }
+// Only "Name" and "Vehicle" are required; all other members default to the
+// values set by the ChScenario constructor. Patches are listed as
+//   "Patches": [ { "File": ..., "Pointer": ..., "Value": ... }, ... ]
+// -----------------------------------------------------------------------------
+static bool loadVector(const Value& a, ChVector<>& v)
+{
+  if (!a.IsArray() || a.Size() != 3)
+    return false;
+  v = ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
+  return true;
+}
+
+static bool loadQuaternion(const Value& a, ChQuaternion<>& q)
+{
+  if (!a.IsArray() || a.Size() != 4)
+    return false;
+  q = ChQuaternion<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble(), a[3u].GetDouble());
+  return true;
+}
+
+bool ChScenarioRunner::LoadScenario(const Value& s, ChScenario& scenario)
+{
+  if (!s.IsObject() || !s.HasMember("Name") || !s.HasMember("Vehicle"))
+    return false;
+
+  scenario.name = s["Name"].GetString();
+  scenario.vehicle_file = s["Vehicle"].GetString();
+
+  if (s.HasMember("Powertrain"))
+    scenario.powertrain_file = s["Powertrain"].GetString();
+  if (s.HasMember("Driver"))
+    scenario.driver_file = s["Driver"].GetString();
+
+  if (s.HasMember("Tire")) {
+    const Value& tire = s["Tire"];
+    std::string model = tire["Model"].GetString();
+
+    if (model == "Rigid")
+      scenario.tire_model = ChScenario::RIGID_TIRE;
+    else if (model == "Lugre")
+      scenario.tire_model = ChScenario::LUGRE_TIRE;
+    else if (model == "Pacejka")
+      scenario.tire_model = ChScenario::PACEJKA_TIRE;
+    else if (model == "Vehicle")
+      scenario.tire_model = ChScenario::VEHICLE_TIRES;
+    else
+      return false;
+
+    if (tire.HasMember("File"))
+      scenario.tire_file = tire["File"].GetString();
+  }
+
+  if (s.HasMember("Terrain")) {
+    const Value& terrain = s["Terrain"];
+    std::string model = terrain["Model"].GetString();
+
+    if (model == "Rigid")
+      scenario.terrain_model = ChScenario::RIGID_TERRAIN;
+    else if (model == "Flat")
+      scenario.terrain_model = ChScenario::FLAT_TERRAIN;
+    else if (model == "Heightmap")
+      scenario.terrain_model = ChScenario::HEIGHTMAP_TERRAIN;
+    else if (model == "Road Profile")
+      scenario.terrain_model = ChScenario::ROAD_PROFILE_TERRAIN;
+    else
+      return false;
+
+    if (terrain.HasMember("File"))
+      scenario.terrain_file = terrain["File"].GetString();
+    if (terrain.HasMember("Height"))
+      scenario.terrain_height = terrain["Height"].GetDouble();
+    if (terrain.HasMember("Height Range")) {
+      const Value& range = terrain["Height Range"];
+      if (!range.IsArray() || range.Size() != 2)
+        return false;
+      scenario.terrain_min = range[0u].GetDouble();
+      scenario.terrain_max = range[1u].GetDouble();
+    }
+    if (terrain.HasMember("Size")) {
+      const Value& size = terrain["Size"];
+      if (!size.IsArray() || size.Size() != 2)
+        return false;
+      scenario.terrain_sizeX = size[0u].GetDouble();
+      scenario.terrain_sizeY = size[1u].GetDouble();
+    }
+    if (terrain.HasMember("Friction Coefficient"))
+      scenario.terrain_mu = terrain["Friction Coefficient"].GetDouble();
+    if (terrain.HasMember("Road Class")) {
+      std::string road_class = terrain["Road Class"].GetString();
+      if (road_class.size() != 1 || road_class[0] < 'A' || road_class[0] > 'H')
+        return false;
+      scenario.terrain_road_class = road_class[0] - 'A';
+    }
+    if (terrain.HasMember("Seed"))
+      scenario.terrain_seed = terrain["Seed"].GetUint();
+    if (terrain.HasMember("Coherence"))
+      scenario.terrain_coherence = terrain["Coherence"].GetDouble();
+    if (terrain.HasMember("Track Width"))
+      scenario.terrain_track = terrain["Track Width"].GetDouble();
+    if (terrain.HasMember("Friction Map")) {
+      const Value& map = terrain["Friction Map"];
+      scenario.friction_file = map["File"].GetString();
+      if (map.HasMember("Friction Range")) {
+        const Value& range = map["Friction Range"];
+        if (!range.IsArray() || range.Size() != 2)
+          return false;
+        scenario.friction_min = range[0u].GetDouble();
+        scenario.friction_max = range[1u].GetDouble();
+      }
+    }
+  }
+
+  if (s.HasMember("Initial Location") && !loadVector(s["Initial Location"], scenario.init_loc))
+    return false;
+  if (s.HasMember("Initial Orientation") && !loadQuaternion(s["Initial Orientation"], scenario.init_rot))
+    return false;
+
+  if (s.HasMember("Reduced Vehicle"))
+    scenario.reduced_vehicle_file = s["Reduced Vehicle"].GetString();
+
+  if (s.HasMember("Model Schedule")) {
+    const Value& schedule = s["Model Schedule"];
+    if (!schedule.IsArray())
+      return false;
+    scenario.model_schedule.resize(schedule.Size());
+    for (SizeType i = 0; i < schedule.Size(); i++) {
+      ChScenario::ModelSwitch& entry = scenario.model_schedule[i];
+      std::string model = schedule[i]["Model"].GetString();
+
+      entry.time = schedule[i]["Time"].GetDouble();
+      if (model == "Full")
+        entry.model = ChScenario::FULL_MODEL;
+      else if (model == "Reduced")
+        entry.model = ChScenario::REDUCED_MODEL;
+      else if (model == "Kinematic")
+        entry.model = ChScenario::KINEMATIC_MODEL;
+      else
+        return false;
+
+      if (i > 0 && entry.time < scenario.model_schedule[i - 1].time)
+        return false;
+    }
+  }
+
+  if (s.HasMember("Patches")) {
+    const Value& patches = s["Patches"];
+    if (!patches.IsArray())
+      return false;
+    for (SizeType i = 0; i < patches.Size(); i++) {
+      const Value& p = patches[i];
+      if (!p.IsObject() || !p.HasMember("File") || !p.HasMember("Pointer") || !p.HasMember("Value") || !p["Value"].IsNumber())
+        return false;
+      ChScenario::Patch patch;
+      patch.file = p["File"].GetString();
+      patch.pointer = p["Pointer"].GetString();
+      patch.value = p["Value"].GetDouble();
+      scenario.patches.push_back(patch);
+    }
+  }
+
+  if (s.HasMember("Settle Cache"))
+    scenario.settle_cache = s["Settle Cache"].GetString();
+  if (s.HasMember("Checkpoint Interval"))
+    scenario.checkpoint_interval = s["Checkpoint Interval"].GetDouble();
+
+  if (s.HasMember("Step Size"))
+    scenario.step_size = s["Step Size"].GetDouble();
+  if (s.HasMember("End Time"))
+    scenario.end_time = s["End Time"].GetDouble();
+  if (s.HasMember("Output Step"))
+    scenario.output_step = s["Output Step"].GetDouble();
+
+  return scenario.step_size > 0 && scenario.output_step > 0;
+}
+
+// -----------------------------------------------------------------------------
+// All members are written, so that LoadScenario() restores the scenario
+// regardless of the ChScenario defaults.
+// -----------------------------------------------------------------------------
+void ChScenarioRunner::SaveScenario(const ChScenario& scenario, Value& s, Document::AllocatorType& allocator)
+{
+  static const char* tire_models[] = { "Rigid", "Lugre", "Pacejka", "Vehicle" };
+  static const char* terrain_models[] = { "Rigid", "Flat", "Heightmap", "Road Profile" };
+  static const char* vehicle_models[] = { "Full", "Reduced", "Kinematic" };
+
+  s.SetObject();
+  s.AddMember("Name", Value().SetString(scenario.name.c_str(), allocator), allocator);
+  s.AddMember("Vehicle", Value().SetString(scenario.vehicle_file.c_str(), allocator), allocator);
+  s.AddMember("Powertrain", Value().SetString(scenario.powertrain_file.c_str(), allocator), allocator);
+  s.AddMember("Driver", Value().SetString(scenario.driver_file.c_str(), allocator), allocator);
+
+  Value tire(kObjectType);
+  tire.AddMember("Model", StringRef(tire_models[scenario.tire_model]), allocator);
+  tire.AddMember("File", Value().SetString(scenario.tire_file.c_str(), allocator), allocator);
+  s.AddMember("Tire", tire, allocator);
+
+  char road_class[2] = { (char)('A' + scenario.terrain_road_class), 0 };
+
+  Value terrain(kObjectType);
+  terrain.AddMember("Model", StringRef(terrain_models[scenario.terrain_model]), allocator);
+  terrain.AddMember("File", Value().SetString(scenario.terrain_file.c_str(), allocator), allocator);
+  terrain.AddMember("Height", scenario.terrain_height, allocator);
+  terrain.AddMember("Height Range",
+                    Value().SetArray().PushBack(scenario.terrain_min, allocator).PushBack(scenario.terrain_max, allocator),
+                    allocator);
+  terrain.AddMember("Size",
+                    Value().SetArray().PushBack(scenario.terrain_sizeX, allocator).PushBack(scenario.terrain_sizeY, allocator),
+                    allocator);
+  terrain.AddMember("Friction Coefficient", scenario.terrain_mu, allocator);
+  terrain.AddMember("Road Class", Value().SetString(road_class, allocator), allocator);
+  terrain.AddMember("Seed", scenario.terrain_seed, allocator);
+  terrain.AddMember("Coherence", scenario.terrain_coherence, allocator);
+  terrain.AddMember("Track Width", scenario.terrain_track, allocator);
+  if (!scenario.friction_file.empty()) {
+    Value map(kObjectType);
+    map.AddMember("File", Value().SetString(scenario.friction_file.c_str(), allocator), allocator);
+    map.AddMember("Friction Range",
+                  Value().SetArray().PushBack(scenario.friction_min, allocator).PushBack(scenario.friction_max, allocator),
+                  allocator);
+    terrain.AddMember("Friction Map", map, allocator);
+  }
+  s.AddMember("Terrain", terrain, allocator);
+
+  const ChVector<>& loc = scenario.init_loc;
+  const ChQuaternion<>& rot = scenario.init_rot;
+  s.AddMember("Initial Location",
+              Value().SetArray().PushBack(loc.x, allocator).PushBack(loc.y, allocator).PushBack(loc.z, allocator),
+              allocator);
+  s.AddMember("Initial Orientation",
+              Value().SetArray().PushBack(rot.e0, allocator).PushBack(rot.e1, allocator)
+                                .PushBack(rot.e2, allocator).PushBack(rot.e3, allocator),
+              allocator);
+
+  if (!scenario.reduced_vehicle_file.empty())
+    s.AddMember("Reduced Vehicle", Value().SetString(scenario.reduced_vehicle_file.c_str(), allocator), allocator);
+
+  Value schedule(kArrayType);
+  for (size_t i = 0; i < scenario.model_schedule.size(); i++) {
+    Value entry(kObjectType);
+    entry.AddMember("Time", scenario.model_schedule[i].time, allocator);
+    entry.AddMember("Model", StringRef(vehicle_models[scenario.model_schedule[i].model]), allocator);
+    schedule.PushBack(entry, allocator);
+  }
+  s.AddMember("Model Schedule", schedule, allocator);
+
+  Value patches(kArrayType);
+  for (size_t i = 0; i < scenario.patches.size(); i++) {
+    Value p(kObjectType);
+    p.AddMember("File", Value().SetString(scenario.patches[i].file.c_str(), allocator), allocator);
+    p.AddMember("Pointer", Value().SetString(scenario.patches[i].pointer.c_str(), allocator), allocator);
+    p.AddMember("Value", scenario.patches[i].value, allocator);
+    patches.PushBack(p, allocator);
+  }
+  s.AddMember("Patches", patches, allocator);
+
+  s.AddMember("Settle Cache", Value().SetString(scenario.settle_cache.c_str(), allocator), allocator);
+  s.AddMember("Checkpoint Interval", scenario.checkpoint_interval, allocator);
+
+  s.AddMember("Step Size", scenario.step_size, allocator);
+  s.AddMember("End Time", scenario.end_time, allocator);
+  s.AddMember("Output Step", scenario.output_step, allocator);
+}
+
+bool ChScenarioRunner::LoadScenarios(const std::string& filename)
+{
+  const Document& d = ChJsonCache::Get(filename);
+
+  if (d.HasParseError() || !d.IsObject() || !d.HasMember("Scenarios") || !d["Scenarios"].IsArray()) {
+    GetLog() << "ERROR: invalid scenario file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  const Value& list = d["Scenarios"];
+  std::vector<ChScenario> scenarios(list.Size());
+
+  for (SizeType i = 0; i < list.Size(); i++) {
+    if (!LoadScenario(list[i], scenarios[i])) {
+      GetLog() << "ERROR: invalid scenario #" << (int)i << " in " << filename.c_str() << "\n";
+      return false;
+    }
+  }
+
+  m_scenarios.insert(m_scenarios.end(), scenarios.begin(), scenarios.end());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChScenarioRunner::Run()
+{
+  int num_scenarios = (int)m_scenarios.size();
+
+  m_results.assign(num_scenarios, ChScenarioResult());
+  m_wall_time = 0;
+
+  // Create the output directories (serially, before any scenario starts).
+  if (ChFileutils::MakeDirectory(m_out_dir.c_str()) < 0) {
+    GetLog() << "ERROR: cannot create directory " << m_out_dir.c_str() << "\n";
+    return false;
+  }
+
+  for (int i = 0; i < num_scenarios; i++) {
+    const std::string& settle_dir = m_scenarios[i].settle_cache;
+    if (!settle_dir.empty() && ChFileutils::MakeDirectory(settle_dir.c_str()) < 0) {
+      GetLog() << "ERROR: cannot create directory " << settle_dir.c_str() << "\n";
+      return false;
+    }
+  }
+
+  // Look up the cached results (the keys are computed before any scenario
+  // starts, as they hash the scenario input files).
+  ChResultCache cache(m_cache_dir);
+  std::vector<std::string> keys(num_scenarios);
+  int num_cached = 0;
+
+  if (!m_cache_dir.empty()) {
+    if (ChFileutils::MakeDirectory(m_cache_dir.c_str()) < 0) {
+      GetLog() << "ERROR: cannot create directory " << m_cache_dir.c_str() << "\n";
+      return false;
+    }
+    for (int i = 0; i < num_scenarios; i++) {
+      keys[i] = ChResultCache::GetKey(m_scenarios[i]);
+      if (cache.Load(keys[i], m_results[i]))
+        num_cached++;
+    }
+  }
+
+  for (int i = 0; i < num_scenarios; i++) {
+    char dirname[16];
+    sprintf(dirname, "%04d_", i);
+
+    m_results[i].index = i;
+    m_results[i].name = m_scenarios[i].name;
+    if (m_results[i].cached)
+      continue;
+    m_results[i].output_dir = m_out_dir + "/" + dirname + m_scenarios[i].name;
+
+    if (ChFileutils::MakeDirectory(m_results[i].output_dir.c_str()) < 0) {
+      GetLog() << "ERROR: cannot create directory " << m_results[i].output_dir.c_str() << "\n";
+      return false;
+    }
+  }
+
+  // Run all scenarios on the thread pool.
+  ChTimer<double> timer;
+  timer.start();
+
+  {
+    ChThreadPool pool(std::min(m_num_threads, std::max(num_scenarios, 1)), m_numa_placement);
+    std::vector<ChScenarioTask> tasks;
+    tasks.reserve(num_scenarios);
+
+    for (int i = 0; i < num_scenarios; i++) {
+      if (m_results[i].cached)
+        continue;
+      tasks.push_back(ChScenarioTask(&ChScenarioRunner::RunScenario, &m_scenarios[i], &m_results[i]));
+      pool.Submit(&tasks.back());
+    }
+
+    pool.Wait();
+  }
+
+  if (!m_cache_dir.empty()) {
+    for (int i = 0; i < num_scenarios; i++) {
+      if (m_results[i].ok && !m_results[i].cached)
+        cache.Store(keys[i], m_results[i]);
+    }
+  }
+
+  timer.stop();
+  m_wall_time = timer();
+
+  // Report.
+  bool ok = true;
+  double sim_time = 0;
+
+  for (int i = 0; i < num_scenarios; i++) {
+    ok = ok && m_results[i].ok;
+    sim_time += m_results[i].sim_time;
+  }
+
+  GetLog() << "Ran " << num_scenarios << " scenarios on " << m_num_threads << " threads\n";
+  if (num_cached > 0)
+    GetLog() << "   cached results: " << num_cached << "\n";
+  GetLog() << "   simulated time: " << sim_time << " s\n";
+  GetLog() << "   wall time:      " << m_wall_time << " s\n";
+  GetLog() << "   throughput:     " << GetThroughput() << " sim s / wall s / core\n";
+
+  write_report(m_out_dir + "/report.csv");
+
+  return ok;
+}
+
+double ChScenarioRunner::GetThroughput() const
+{
+  if (m_wall_time <= 0)
+    return 0;
+
+  // Cached results were not simulated by this batch.
+  double sim_time = 0;
+  for (size_t i = 0; i < m_results.size(); i++) {
+    if (!m_results[i].cached)
+      sim_time += m_results[i].sim_time;
+  }
+
+  return sim_time / m_wall_time / m_num_threads;
+}
+
+void ChScenarioRunner::write_report(const std::string& filename) const
+{
+  // Each scenario runs on a single core, so its throughput is the ratio of its
+  // simulated and wall-clock times. The last row holds the batch totals.
+  utils::CSV_writer csv(",");
+
+  bool ok = true;
+  int num_steps = 0;
+  double sim_time = 0;
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const ChScenarioResult& res = m_results[i];
+    double throughput = (res.wall_time > 0) ? res.sim_time / res.wall_time : 0;
+    csv << res.index << res.name << res.ok << res.num_steps << res.sim_time << res.wall_time << throughput
+        << res.model_time[0] << res.model_time[1] << res.model_time[2]
+        << res.distance << res.max_speed << res.mean_speed << res.max_roll << res.max_pitch << res.max_lat_accel
+        << res.cached << std::endl;
+
+    ok = ok && res.ok;
+    num_steps += res.num_steps;
+    sim_time += res.sim_time;
+  }
+
+  csv << "total" << "" << ok << num_steps << sim_time << m_wall_time << GetThroughput() << "" << "" << ""
+      << "" << "" << "" << "" << "" << "" << "" << std::endl;
+
+  csv.write_to_file(filename, "index,name,ok,steps,sim_time,wall_time,throughput,full_time,reduced_time,kinematic_time,"
+                              "distance,max_speed,mean_speed,max_roll,max_pitch,max_lat_accel,cached\n");
+}
+
+// -----------------------------------------------------------------------------
+// Simulate one scenario, following the simulation loop of demo_Vehicle.
+// -----------------------------------------------------------------------------
+static bool file_exists(const std::string& filename)
+{
+  FILE* fp = fopen(filename.c_str(), "r");
+  if (!fp)
+    return false;
+  fclose(fp);
+  return true;
+}
+
+// Simulation loop writing the vehicle position and speed and the driver inputs
+// at each output step, and collecting the scenario KPIs.
+class ChScenarioSimulation : public ChVehicleSimulation
+{
+public:
+  ChScenarioSimulation(ChSharedPtr<ChVehicle>    vehicle,
+                       ChSharedPtr<ChPowertrain> powertrain,
+                       ChSharedPtr<ChDriver>     driver,
+                       ChSharedPtr<ChTerrain>    terrain,
+                       double                    step_size)
+  : ChVehicleSimulation(vehicle, powertrain, driver, terrain, step_size), m_csv(","),
+    m_num_frames(0), m_distance(0), m_max_speed(0), m_sum_speed(0), m_max_roll(0), m_max_pitch(0), m_max_lat_accel(0)
+  {}
+
+  bool OpenOutput(const std::string& filename)
+  {
+    return m_csv.open(filename, "time,x,y,z,speed,throttle,steering,braking\n");
+  }
+
+  bool ResumeOutput(const std::string& filename, size_t offset) { return m_csv.resume(filename, offset); }
+
+  void CloseOutput() { m_csv.close(); }
+
+  // Append the KPIs collected so far and the output file length (after
+  // handing the buffered output to the writer thread) to the snapshot.
+  void SaveOutput(ChVehicleState& state)
+  {
+    m_csv.flush();
+
+    state.BeginBlock(11);
+    state.Write((double)m_csv.tell());
+    state.Write(m_num_frames);
+    state.Write(m_last_pos);
+    state.Write(m_distance);
+    state.Write(m_max_speed);
+    state.Write(m_sum_speed);
+    state.Write(m_max_roll);
+    state.Write(m_max_pitch);
+    state.Write(m_max_lat_accel);
+  }
+
+  // Restore the KPIs from the snapshot, and return the output file length.
+  bool RestoreOutput(ChVehicleState& state, size_t& offset)
+  {
+    if (!state.OpenBlock(11, "scenario output"))
+      return false;
+
+    offset = (size_t)state.Read();
+    m_num_frames = (int)state.Read();
+    m_last_pos = state.ReadVector();
+    m_distance = state.Read();
+    m_max_speed = state.Read();
+    m_sum_speed = state.Read();
+    m_max_roll = state.Read();
+    m_max_pitch = state.Read();
+    m_max_lat_accel = state.Read();
+    return true;
+  }
+
+  void GetIndicators(ChScenarioResult& res) const
+  {
+    res.distance = m_distance;
+    res.max_speed = m_max_speed;
+    res.mean_speed = (m_num_frames > 0) ? m_sum_speed / m_num_frames : 0;
+    res.max_roll = m_max_roll;
+    res.max_pitch = m_max_pitch;
+    res.max_lat_accel = m_max_lat_accel;
+  }
+
+private:
+  virtual void OnOutput(double time)
+  {
+    ChVector<> pos = GetChassisPos();
+    double speed = GetVehicleSpeed();
+
+    m_csv << time << pos << speed
+          << GetThrottle() << GetSteering() << GetBraking() << std::endl;
+
+    if (m_num_frames > 0)
+      m_distance += std::sqrt((pos.x - m_last_pos.x) * (pos.x - m_last_pos.x) + (pos.y - m_last_pos.y) * (pos.y - m_last_pos.y));
+    m_last_pos = pos;
+
+    m_num_frames++;
+    m_sum_speed += speed;
+    m_max_speed = std::max(m_max_speed, speed);
+
+    if (!IsKinematic()) {
+      // Pitch and roll from the elevation of the chassis X and Y axes
+      ChSharedPtr<ChBodyAuxRef> chassis = GetVehicle()->GetChassis();
+      const ChQuaternion<>& rot = GetVehicle()->GetChassisRot();
+      double pitch = std::asin(std::min(1.0, std::abs(rot.GetXaxis().z)));
+      double roll = std::asin(std::min(1.0, std::abs(rot.GetYaxis().z)));
+      double lat_accel = std::abs(chassis->GetPos_dtdt() ^ rot.GetYaxis());
+
+      m_max_pitch = std::max(m_max_pitch, pitch);
+      m_max_roll = std::max(m_max_roll, roll);
+      m_max_lat_accel = std::max(m_max_lat_accel, lat_accel);
+    }
+  }
+
+  utils::CSV_writer m_csv;
+
+  int         m_num_frames;
+  ChVector<>  m_last_pos;
+  double      m_distance;
+  double      m_max_speed;
+  double      m_sum_speed;
+  double      m_max_roll;
+  double      m_max_pitch;
+  double      m_max_lat_accel;
+};
+
+// Switch the simulation to the specified vehicle model.
+static void switch_model(ChScenarioSimulation&     sim,
+                         ChScenario::VehicleModel  model,
+                         ChSharedPtr<Vehicle>      vehicle,
+                         ChSharedPtr<Vehicle>      reduced_vehicle)
+{
+  switch (model) {
+  case ChScenario::FULL_MODEL:
+    sim.SetKinematic(false);
+    sim.SetVehicle(vehicle);
+    break;
+  case ChScenario::REDUCED_MODEL:
+    sim.SetKinematic(false);
+    sim.SetVehicle(reduced_vehicle);
+    break;
+  case ChScenario::KINEMATIC_MODEL:
+    sim.SetKinematic(true);
+    break;
+  }
+}
+
+// Checkpoint of a scenario:
+//   runner block: format version, active model, next model switch, wall-clock
+//                 time of each model
+//   output block (see ChScenarioSimulation::SaveOutput())
+//   simulation loop and modules (see ChVehicleSimulation::SaveState())
+//   full vehicle, reduced vehicle (if any)
+// The active vehicle model is saved twice, so that both models are restored
+// regardless of which one is active.
+static const double CHECKPOINT_VERSION = 1;
+
+static void save_checkpoint(ChVehicleState&           state,
+                            ChScenarioSimulation&     sim,
+                            ChScenario::VehicleModel  model,
+                            size_t                    next_switch,
+                            const double*             model_time,
+                            ChSharedPtr<Vehicle>      vehicle,
+                            ChSharedPtr<Vehicle>      reduced_vehicle)
+{
+  state.Clear();
+  state.BeginBlock(6);
+  state.Write(CHECKPOINT_VERSION);
+  state.Write((double)model);
+  state.Write((double)next_switch);
+  state.Write(model_time, 3);
+  sim.SaveOutput(state);
+  sim.SaveState(state);
+  vehicle->SaveState(state);
+  if (!reduced_vehicle.IsNull())
+    reduced_vehicle->SaveState(state);
+}
+
+static bool restore_checkpoint(ChVehicleState&            state,
+                               ChScenarioSimulation&      sim,
+                               ChScenario::VehicleModel&  model,
+                               size_t&                    next_switch,
+                               double*                    model_time,
+                               size_t&                    offset,
+                               ChSharedPtr<Vehicle>       vehicle,
+                               ChSharedPtr<Vehicle>       reduced_vehicle)
+{
+  state.Rewind();
+  if (!state.OpenBlock(6, "scenario checkpoint") || state.Read() != CHECKPOINT_VERSION)
+    return false;
+
+  model = (ChScenario::VehicleModel)(int)state.Read();
+  next_switch = (size_t)state.Read();
+  state.Read(model_time, 3);
+
+  // Activate the model first, as a switch transfers the state of the previous
+  // model.
+  switch_model(sim, model, vehicle, reduced_vehicle);
+
+  bool ok = sim.RestoreOutput(state, offset) && sim.RestoreState(state) && vehicle->RestoreState(state);
+  if (ok && !reduced_vehicle.IsNull())
+    ok = reduced_vehicle->RestoreState(state);
+
+  return ok && state.AtEnd();
+}
+
+// Advance the simulation to the end of the scenario, switching vehicle models
+// as scheduled and timing each model separately. If enabled, a checkpoint is
+// taken at the end of the first step after each checkpoint interval.
+static void run_loop(ChScenarioSimulation&      sim,
+                     const ChScenario&          scenario,
+                     ChScenario::VehicleModel   model,
+                     size_t                     next_switch,
+                     const std::string&         checkpoint_file,
+                     ChSharedPtr<Vehicle>       vehicle,
+                     ChSharedPtr<Vehicle>       reduced_vehicle,
+                     ChScenarioResult&          res)
+{
+  ChCheckpointWriter writer;
+  ChVehicleState checkpoint;
+  bool checkpoints = !checkpoint_file.empty() && writer.Start(checkpoint_file);
+  double next_checkpoint = ChProfiler::GetTime() + scenario.checkpoint_interval;
+
+  while (sim.GetTime() < scenario.end_time) {
+    while (next_switch < scenario.model_schedule.size() &&
+           scenario.model_schedule[next_switch].time <= sim.GetTime()) {
+      model = scenario.model_schedule[next_switch++].model;
+      switch_model(sim, model, vehicle, reduced_vehicle);
+    }
+
+    double end_segment = scenario.end_time;
+    if (next_switch < scenario.model_schedule.size() && scenario.model_schedule[next_switch].time < end_segment)
+      end_segment = scenario.model_schedule[next_switch].time;
+
+    double start = ChProfiler::GetTime();
+
+    while (sim.GetTime() < end_segment) {
+      sim.DoStep();
+
+      if (checkpoints && !sim.IsKinematic()) {
+        double now = ChProfiler::GetTime();
+        if (now >= next_checkpoint) {
+          double model_time[3] = {res.model_time[0], res.model_time[1], res.model_time[2]};
+          model_time[model] += now - start;
+          save_checkpoint(checkpoint, sim, model, next_switch, model_time, vehicle, reduced_vehicle);
+          writer.Submit(checkpoint);
+          next_checkpoint = now + scenario.checkpoint_interval;
+        }
+      }
+    }
+
+    res.model_time[model] += ChProfiler::GetTime() - start;
+  }
+
+  sim.CloseOutput();
+  sim.GetIndicators(res);
+
+  res.ok = true;
+  res.num_steps = sim.GetStepNumber();
+  res.sim_time = sim.GetTime();
+  res.wall_time = res.model_time[0] + res.model_time[1] + res.model_time[2];
+
+  // The checkpoint is not needed once the scenario completed.
+  if (checkpoints) {
+    if (!writer.Stop())
+      GetContextLog() << "WARNING: some checkpoints could not be written\n";
+    GetContextLog() << "Wrote " << writer.GetNumWritten() << " checkpoints\n";
+    std::remove(checkpoint_file.c_str());
+  }
+  else if (!checkpoint_file.empty()) {
+    GetContextLog() << "WARNING: cannot start the checkpoint writer\n";
+  }
+}
+
+// Create the modules of the specified scenario (with its patches applied).
+// Returns false if the scenario is invalid, leaving the modules created so far
+// to the caller.
+static bool create_modules(const ChScenario& scenario, ChScenarioModules& modules)
+{
+  std::string files[] = {scenario.vehicle_file, scenario.powertrain_file, scenario.driver_file, scenario.tire_file};
+  int num_files = (scenario.tire_model == ChScenario::VEHICLE_TIRES) ? 3 : 4;
+  for (int k = 0; k < num_files; k++) {
+    if (!file_exists(GetDataFile(files[k]))) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot open " << files[k].c_str() << "\n";
+      return false;
+    }
+  }
+
+  if (scenario.tire_model == ChScenario::RIGID_TIRE && scenario.terrain_model != ChScenario::RIGID_TERRAIN) {
+    GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": rigid tires require a rigid terrain\n";
+    return false;
+  }
+
+  bool use_reduced = false;
+  for (size_t k = 0; k < scenario.model_schedule.size(); k++)
+    use_reduced = use_reduced || scenario.model_schedule[k].model == ChScenario::REDUCED_MODEL;
+
+  if (use_reduced) {
+    // Rigid tires are attached to the wheel bodies of one vehicle model.
+    if (scenario.tire_model == ChScenario::RIGID_TIRE) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": rigid tires cannot switch vehicle models\n";
+      return false;
+    }
+    if (!file_exists(GetDataFile(scenario.reduced_vehicle_file))) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot open reduced vehicle "
+               << scenario.reduced_vehicle_file.c_str() << "\n";
+      return false;
+    }
+  }
+
+  // Create the vehicle system (with its own ChSystem)
+  ChSharedPtr<Vehicle>& vehicle = modules.vehicle;
+  vehicle = ChSharedPtr<Vehicle>(new Vehicle(GetDataFile(scenario.vehicle_file)));
+  vehicle->Initialize(ChCoordsys<>(scenario.init_loc, scenario.init_rot));
+
+  // Create the reduced model of the vehicle (with its own ChSystem), if needed
+  ChSharedPtr<Vehicle>& reduced_vehicle = modules.reduced_vehicle;
+  if (use_reduced) {
+    reduced_vehicle = ChSharedPtr<Vehicle>(new Vehicle(GetDataFile(scenario.reduced_vehicle_file)));
+    reduced_vehicle->Initialize(ChCoordsys<>(scenario.init_loc, scenario.init_rot));
+    if (reduced_vehicle->GetNumberAxles() != vehicle->GetNumberAxles()) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": reduced vehicle has a different number of axles\n";
+      return false;
+    }
+  }
+
+  // Create the terrain
+  ChSharedPtr<ChTerrain>& terrain = modules.terrain;
+
+  switch (scenario.terrain_model) {
+  case ChScenario::RIGID_TERRAIN:
+    terrain = ChSharedPtr<RigidTerrain>(new RigidTerrain(vehicle->GetSystem(), scenario.terrain_height,
+                                                         scenario.terrain_sizeX, scenario.terrain_sizeY,
+                                                         scenario.terrain_mu));
+    break;
+  case ChScenario::FLAT_TERRAIN:
+    terrain = ChSharedPtr<FlatTerrain>(new FlatTerrain(scenario.terrain_height));
+    break;
+  case ChScenario::HEIGHTMAP_TERRAIN:
+  {
+    ChSharedPtr<HeightmapTerrain> hmap(new HeightmapTerrain(scenario.terrain_sizeX, scenario.terrain_sizeY));
+    if (!hmap->LoadPGM(GetDataFile(scenario.terrain_file), scenario.terrain_min, scenario.terrain_max)) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot load terrain\n";
+      return false;
+    }
+    terrain = hmap;
+    break;
+  }
+  case ChScenario::ROAD_PROFILE_TERRAIN:
+    terrain = ChSharedPtr<RoadProfileTerrain>(new RoadProfileTerrain(
+      (RoadProfileTerrain::RoadClass)scenario.terrain_road_class, scenario.terrain_seed,
+      scenario.terrain_track, scenario.terrain_coherence, 0.05, scenario.terrain_height));
+    break;
+  }
+
+  if (!scenario.friction_file.empty()) {
+    ChSharedPtr<ChFrictionMap> friction(new ChFrictionMap(scenario.terrain_sizeX, scenario.terrain_sizeY));
+    if (!friction->LoadPGM(GetDataFile(scenario.friction_file), scenario.friction_min, scenario.friction_max)) {
+      GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot load friction map\n";
+      return false;
+    }
+    terrain->SetFrictionMap(friction);
+  }
+
+  // Create and initialize the powertrain system (SimplePowertrain or
+  // MapPowertrain, as specified by the JSON template)
+  ChSharedPtr<ChPowertrain>& powertrain = modules.powertrain;
+  const Document& powertrain_doc = ChJsonCache::Get(GetDataFile(scenario.powertrain_file));
+  if (powertrain_doc.HasMember("Template") && std::string(powertrain_doc["Template"].GetString()) == "MapPowertrain") {
+    ChSharedPtr<MapPowertrain> map_powertrain(new MapPowertrain(GetDataFile(scenario.powertrain_file)));
+    map_powertrain->Initialize();
+    powertrain = map_powertrain;
+  }
+  else {
+    ChSharedPtr<SimplePowertrain> simple_powertrain(new SimplePowertrain(GetDataFile(scenario.powertrain_file)));
+    simple_powertrain->Initialize();
+    powertrain = simple_powertrain;
+  }
+
+  // Create and initialize the tires
+  int num_wheels = 2 * vehicle->GetNumberAxles();
+  std::vector<ChSharedPtr<ChTire> >& tires = modules.tires;
+  tires.assign(num_wheels, ChSharedPtr<ChTire>());
+  const std::vector<int>& driven_axles = vehicle->GetDriveline()->GetDrivenAxleIndexes();
+
+  if (scenario.tire_model == ChScenario::VEHICLE_TIRES && !vehicle->CreateTires(*terrain, tires)) {
+    GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot create the vehicle tires\n";
+    return false;
+  }
+
+  for (int i = 0; i < num_wheels; i++) {
+    switch (scenario.tire_model) {
+    case ChScenario::RIGID_TIRE:
+    {
+      ChSharedPtr<RigidTire> tire(new RigidTire(GetDataFile(scenario.tire_file), *terrain));
+      tire->Initialize(vehicle->GetWheelBody(i));
+      tires[i] = tire;
+      break;
+    }
+    case ChScenario::LUGRE_TIRE:
+    {
+      ChSharedPtr<LugreTire> tire(new LugreTire(GetDataFile(scenario.tire_file), *terrain));
+      tire->Initialize();
+      tires[i] = tire;
+      break;
+    }
+    case ChScenario::PACEJKA_TIRE:
+    {
+      char tire_name[16];
+      sprintf(tire_name, "W%d", i);
+      bool driven = std::find(driven_axles.begin(), driven_axles.end(), i / 2) != driven_axles.end();
+      ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire(tire_name, GetDataFile(scenario.tire_file), *terrain));
+      tire->Initialize(ChWheelID(i).side(), driven);
+      tires[i] = tire;
+      break;
+    }
+    case ChScenario::VEHICLE_TIRES:
+      break;
+    }
+  }
+
+  // Create the driver: a maneuver (JSON file) or a data driver (text or trace file)
+  ChSharedPtr<ChDriver>& driver = modules.driver;
+  const std::string& driver_file = scenario.driver_file;
+  if (driver_file.size() > 5 && driver_file.compare(driver_file.size() - 5, 5, ".json") == 0)
+    driver = ChSharedPtr<ChDriver>(new ChManeuverDriver(GetDataFile(driver_file)));
+  else
+    driver = ChSharedPtr<ChDriver>(new ChDataDriver(GetDataFile(driver_file)));
+
+  // The key of the settled state covers the patched values.
+  modules.settle_key.clear();
+  if (!scenario.settle_cache.empty()) {
+    char tire_terrain[64];
+    sprintf(tire_terrain, "tire %d terrain %d height %g ", (int)scenario.tire_model, (int)scenario.terrain_model,
+            scenario.terrain_height);
+    modules.settle_key = ChSettleCache::GetKey(GetDataFile(scenario.vehicle_file),
+                                               tire_terrain + scenario.tire_file + " " + scenario.terrain_file,
+                                               ChCoordsys<>(scenario.init_loc, scenario.init_rot));
+  }
+
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// The patched values are seen by the modules of this scenario only, as their
+// construction is serialized.
+// -----------------------------------------------------------------------------
+bool ChScenarioRunner::CreateModules(const ChScenario& scenario, ChScenarioModules& modules)
+{
+  ChScopedLock lock(s_setup_mutex);
+  CH_STARTUP_SCOPE("ChScenarioRunner::CreateModules");
+
+  ChJsonPatch patch;
+  for (size_t k = 0; k < scenario.patches.size(); k++)
+    patch.Add(GetDataFile(scenario.patches[k].file), scenario.patches[k].pointer, scenario.patches[k].value);
+
+  if (!patch.Apply()) {
+    GetLog() << "ERROR: scenario " << scenario.name.c_str() << ": cannot apply the patches\n";
+    return false;
+  }
+
+  bool ok = create_modules(scenario, modules);
+  patch.Revert();
+
+  if (!ok)
+    modules = ChScenarioModules();
+
+  return ok;
+}
+
+void ChScenarioRunner::ReleaseModules(ChScenarioModules& modules)
+{
+  ChScopedLock lock(s_setup_mutex);
+
+  modules = ChScenarioModules();
+}
+
+// -----------------------------------------------------------------------------
+// Set up and simulate the specified scenario, resuming from its checkpoint if
+// requested. Returns false if a checkpoint was found but could not be resumed
+// (the scenario is then not simulated).
+// -----------------------------------------------------------------------------
+static bool simulate_scenario(const ChScenario& scenario, ChScenarioResult& res, ChStreamOutAscii& log, bool resume)
+{
+  // ------------------
+  // Set up the modules
+  // ------------------
+
+  // The checkpoint file is named after the key of the (unpatched) inputs.
+  std::string checkpoint_file;
+  if (scenario.checkpoint_interval > 0)
+    checkpoint_file = res.output_dir + "/checkpoint_" + ChScenarioRunner::GetScenarioKey(scenario) + ".state";
+
+  ChScenarioModules modules;
+  if (!ChScenarioRunner::CreateModules(scenario, modules))
+    return true;
+
+  ChSharedPtr<Vehicle> vehicle = modules.vehicle;
+  ChSharedPtr<Vehicle> reduced_vehicle = modules.reduced_vehicle;
+  int num_wheels = (int)modules.tires.size();
+
+  // A checkpoint of an interrupted run replaces the settled initial state.
+  ChVehicleState checkpoint;
+  bool has_checkpoint = resume && !checkpoint_file.empty() && checkpoint.ReadFile(checkpoint_file);
+
+  // Start from the settled vehicle, computing it on the first run.
+  if (!scenario.settle_cache.empty() && !has_checkpoint) {
+    ChSettleCache cache(scenario.settle_cache);
+    if (!cache.LoadOrSettle(modules.settle_key, *vehicle, modules.tires))
+      log << "WARNING: starting from an unsettled vehicle\n";
+  }
+
+  // ---------------
+  // Simulation loop
+  // ---------------
+
+  ChScenarioSimulation sim(vehicle, modules.powertrain, modules.driver, modules.terrain, scenario.step_size);
+  for (int i = 0; i < num_wheels; i++)
+    sim.SetTire(i, modules.tires[i]);
+  sim.SetOutputStep(scenario.output_step);
+
+  ChScenario::VehicleModel model = ChScenario::FULL_MODEL;
+  size_t next_switch = 0;
+  bool ok = true;
+
+  // Resume from the checkpoint, continuing its output, or stream the output
+  // from the start, so that long runs do not accumulate it in memory.
+  if (has_checkpoint) {
+    size_t offset = 0;
+    ok = restore_checkpoint(checkpoint, sim, model, next_switch, res.model_time, offset, vehicle, reduced_vehicle) &&
+         sim.ResumeOutput(res.output_dir + "/output.csv", offset);
+    if (ok) {
+      log << "Resuming from the checkpoint at t = " << sim.GetTime() << "\n";
+    }
+    else {
+      log << "WARNING: cannot resume from " << checkpoint_file.c_str() << "; starting over\n";
+      std::remove(checkpoint_file.c_str());
+    }
+  }
+  else if (!sim.OpenOutput(res.output_dir + "/output.csv")) {
+    log << "WARNING: cannot open output file\n";
+  }
+
+  if (ok)
+    run_loop(sim, scenario, model, next_switch, checkpoint_file, vehicle, reduced_vehicle, res);
+
+  // ----------------------
+  // Release the modules
+  // ----------------------
+
+  vehicle = ChSharedPtr<Vehicle>();
+  reduced_vehicle = ChSharedPtr<Vehicle>();
+  ChScenarioRunner::ReleaseModules(modules);
+
+  return ok;
+}
+
+// The key hashes the specification files, which must not be patched (see
+// ChJsonPatch) while it is computed.
+std::string ChScenarioRunner::GetScenarioKey(const ChScenario& scenario)
+{
+  ChScopedLock lock(s_setup_mutex);
+  return ChResultCache::GetKey(scenario);
+}
+
+void ChScenarioRunner::RunScenario(const ChScenario& scenario, ChScenarioResult& res)
+{
+  // The messages of the scenario modules go to the scenario log, so that the
+  // simulation loops do not share the global log.
+  ChStreamOutAsciiFile log((res.output_dir + "/log.txt").c_str());
+  ChSimulationContext context;
+  context.SetLog(&log);
+  ChSimulationContext::Scope scope(context);
+
+  // A checkpoint that cannot be resumed is discarded, and the scenario is
+  // simulated from the start.
+  if (!simulate_scenario(scenario, res, log, true)) {
+    for (int k = 0; k < 3; k++)
+      res.model_time[k] = 0;
+    simulate_scenario(scenario, res, log, false);
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,312 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Runner for batches of independent vehicle simulations (scenarios).
+//
+// Each scenario describes a JSON vehicle with its powertrain, tire model,
+// terrain and driver data file. The scenarios are executed concurrently on a
+// work-stealing thread pool, each in its own ChSystem. The output of scenario
+// number N (counting from 0), and the messages of its modules (log.txt), are
+// written to the directory
+//    <output directory>/NNNN_<scenario name>
+// and a throughput report for the whole batch, with scalar performance
+// indicators (KPIs) of each scenario, is written to
+//    <output directory>/report.csv
+//
+// A scenario can patch numeric values of its JSON specification files (see
+// ChJsonPatch); the patch is applied to in-memory copies of the parsed files,
+// only while the scenario modules are constructed.
+//
+// Optionally, the results are cached on disk (see ChResultCache): a scenario
+// whose inputs match a cached result is not simulated again, and its result
+// refers to the output directory of the original run.
+//
+// A long scenario can also write periodic checkpoints (in wall-clock time) to
+// its output directory, so that a batch job killed before its end (e.g.
+// preempted) continues each unfinished scenario from its last checkpoint when
+// it is restarted. A checkpoint holds the state of the simulation loop and of
+// all its modules (see ChVehicleSimulation::SaveState()), both vehicle models,
+// the KPIs collected so far, and the length of the output file, which is then
+// continued rather than written again. The snapshot is taken in memory at the
+// end of a step and written by a background thread (see ChCheckpointWriter),
+// so that its cost to the simulation is a copy of the state and a flush of
+// the output. No checkpoints are taken while the kinematic bicycle model is
+// active. A checkpoint is only resumed by a scenario with the same inputs (see
+// ChResultCache::GetKey()), and is removed when the scenario completes;
+// together with a result cache, completed scenarios are not run again either.
+//
+// =============================================================================
+
+#ifndef CH_SCENARIO_RUNNER_H
+#define CH_SCENARIO_RUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChDriver.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/vehicle/Vehicle.h"
+
+#include "runner/ChApiRunner.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Description of a single vehicle simulation.
+/// All file names are relative to the ChronoVehicle data directory.
+///
+struct CH_RUNNER_API ChScenario
+{
+  enum TireModel {
+    RIGID_TIRE,       ///< RigidTire (requires a RIGID_TERRAIN)
+    LUGRE_TIRE,       ///< LugreTire
+    PACEJKA_TIRE,     ///< ChPacejkaTire
+    VEHICLE_TIRES     ///< tires listed in the vehicle specification file (see Vehicle::CreateTires)
+  };
+
+  enum TerrainModel {
+    RIGID_TERRAIN,        ///< RigidTerrain (box with collision geometry)
+    FLAT_TERRAIN,         ///< FlatTerrain
+    HEIGHTMAP_TERRAIN,    ///< HeightmapTerrain loaded from a PGM image
+    ROAD_PROFILE_TERRAIN  ///< RoadProfileTerrain (ISO 8608 random road)
+  };
+
+  enum VehicleModel {
+    FULL_MODEL,       ///< vehicle specified by vehicle_file
+    REDUCED_MODEL,    ///< vehicle specified by reduced_vehicle_file
+    KINEMATIC_MODEL   ///< kinematic bicycle model (see ChBicycleModel)
+  };
+
+  /// Switch to the specified vehicle model at the specified time.
+  struct ModelSwitch {
+    double        time;
+    VehicleModel  model;
+  };
+
+  /// Numeric value patched into a JSON specification file (see ChJsonPatch).
+  struct Patch {
+    std::string   file;      ///< JSON file (e.g. a suspension specification file)
+    std::string   pointer;   ///< JSON pointer to the value (e.g. "/Spring/Spring Coefficient")
+    double        value;
+  };
+
+  ChScenario();
+
+  std::string     name;              ///< scenario name (used in output paths)
+
+  std::string     vehicle_file;      ///< JSON vehicle specification file
+  std::string     reduced_vehicle_file;  ///< JSON specification of a reduced model of the same vehicle
+  std::string     powertrain_file;   ///< JSON SimplePowertrain or MapPowertrain specification file
+  std::string     driver_file;       ///< ChManeuver file (.json) or ChDataDriver input file
+
+  TireModel       tire_model;
+  std::string     tire_file;         ///< JSON tire specification or Pacejka parameter file (not used with VEHICLE_TIRES)
+
+  TerrainModel    terrain_model;
+  std::string     terrain_file;      ///< PGM height-map image (HEIGHTMAP_TERRAIN only)
+  double          terrain_height;    ///< terrain height (RIGID_TERRAIN and FLAT_TERRAIN)
+  double          terrain_min;       ///< height of black pixels (HEIGHTMAP_TERRAIN)
+  double          terrain_max;       ///< height of white pixels (HEIGHTMAP_TERRAIN)
+  double          terrain_sizeX;     ///< terrain dimension in the X direction
+  double          terrain_sizeY;     ///< terrain dimension in the Y direction
+  double          terrain_mu;        ///< coefficient of friction (RIGID_TERRAIN)
+  int             terrain_road_class;  ///< ISO 8608 class, 0 (A) to 7 (H) (ROAD_PROFILE_TERRAIN)
+  unsigned int    terrain_seed;      ///< seed of the random profile (ROAD_PROFILE_TERRAIN)
+  double          terrain_coherence; ///< left/right track coherence (ROAD_PROFILE_TERRAIN)
+  double          terrain_track;     ///< track width (ROAD_PROFILE_TERRAIN)
+  std::string     friction_file;     ///< PGM friction map image, with the terrain size (optional)
+  double          friction_min;      ///< coefficient of friction of black pixels
+  double          friction_max;      ///< coefficient of friction of white pixels
+
+  ChVector<>      init_loc;          ///< initial chassis location
+  ChQuaternion<>  init_rot;          ///< initial chassis orientation
+
+  double          step_size;         ///< integration step size
+  double          end_time;          ///< simulation length
+  double          output_step;       ///< time interval between two output frames
+
+  std::vector<ModelSwitch>  model_schedule;  ///< vehicle model switches, by increasing time (start: FULL_MODEL)
+  std::vector<Patch>        patches;         ///< values patched into the specification files
+
+  std::string     settle_cache;      ///< directory of settled initial states, relative to the working directory (see ChSettleCache); empty: no settling
+  double          checkpoint_interval;  ///< wall-clock time between two checkpoints (0: no checkpoints)
+};
+
+///
+/// Statistics of a completed (or failed) scenario.
+///
+struct CH_RUNNER_API ChScenarioResult
+{
+  ChScenarioResult()
+  : index(-1), ok(false), cached(false), num_steps(0), sim_time(0), wall_time(0),
+    distance(0), max_speed(0), mean_speed(0), max_roll(0), max_pitch(0), max_lat_accel(0)
+  {
+    model_time[0] = model_time[1] = model_time[2] = 0;
+  }
+
+  int          index;        ///< index of the scenario in the batch
+  std::string  name;         ///< scenario name
+  bool         ok;           ///< false if the scenario could not be set up
+  bool         cached;       ///< true if loaded from the result cache (output_dir is then the one of the original run)
+  int          num_steps;    ///< number of integration steps taken
+  double       sim_time;     ///< simulated time [s]
+  double       wall_time;    ///< wall-clock time spent in the simulation loop [s]
+  double       model_time[3];  ///< part of wall_time spent with each ChScenario::VehicleModel [s]
+  std::string  output_dir;   ///< output directory of this scenario
+
+  // Scalar performance indicators, sampled at the output frames. The chassis
+  // angles and acceleration are not sampled with the kinematic model.
+  double       distance;       ///< distance traveled by the chassis, in the horizontal plane [m]
+  double       max_speed;      ///< maximum vehicle speed [m/s]
+  double       mean_speed;     ///< average vehicle speed [m/s]
+  double       max_roll;       ///< maximum absolute chassis roll angle [rad]
+  double       max_pitch;      ///< maximum absolute chassis pitch angle [rad]
+  double       max_lat_accel;  ///< maximum absolute lateral acceleration of the chassis COM [m/s^2]
+};
+
+///
+/// Modules of a scenario, created by ChScenarioRunner::CreateModules().
+///
+struct CH_RUNNER_API ChScenarioModules
+{
+  ChSharedPtr<Vehicle>               vehicle;          ///< full vehicle model, initialized
+  ChSharedPtr<Vehicle>               reduced_vehicle;  ///< reduced vehicle model (only if scheduled)
+  ChSharedPtr<ChTerrain>             terrain;
+  ChSharedPtr<ChPowertrain>          powertrain;
+  std::vector<ChSharedPtr<ChTire> >  tires;            ///< one tire per wheel, indexed by wheel ID
+  ChSharedPtr<ChDriver>              driver;
+  std::string                        settle_key;       ///< key of the settled initial state (see ChSettleCache)
+};
+
+///
+/// Runner for batches of independent vehicle scenarios.
+///
+class CH_RUNNER_API ChScenarioRunner
+{
+public:
+
+  /// Create a runner with the specified number of worker threads. If zero, use
+  /// the number of hardware threads.
+  ChScenarioRunner(int num_threads = 0);
+
+  ~ChScenarioRunner() {}
+
+  /// Set the top-level output directory (default: "SCENARIOS").
+  void SetOutputDirectory(const std::string& dir) { m_out_dir = dir; }
+
+  /// Enable or disable the NUMA placement of the scenarios (default: disabled).
+  /// If enabled, the worker threads are pinned to the NUMA nodes of the
+  /// machine, so that the ChSystem and the modules of a scenario, which are
+  /// created by the worker running it, are allocated on the node of that
+  /// worker; the shared tire parameter blocks are replicated on each node.
+  void SetNumaPlacement(bool val) { m_numa_placement = val; }
+
+  /// Set the directory of the result cache, relative to the working directory
+  /// (see ChResultCache; default: empty, no cache). The directory can be
+  /// shared by several runners, also on different nodes.
+  void SetResultCache(const std::string& dir) { m_cache_dir = dir; }
+
+  /// Add the specified scenario to the batch.
+  void AddScenario(const ChScenario& scenario) { m_scenarios.push_back(scenario); }
+
+  /// Add the scenarios listed in the specified JSON file to the batch.
+  /// Returns false if the file cannot be read or contains an invalid scenario.
+  bool LoadScenarios(const std::string& filename);
+
+  /// Load a scenario from the specified JSON object (one element of the
+  /// "Scenarios" array of a scenario list file). Members not present in the
+  /// object keep their current values. Returns false if the object is invalid.
+  static bool LoadScenario(const rapidjson::Value& object, ChScenario& scenario);
+
+  /// Write the specified scenario to a JSON object, in the format read by
+  /// LoadScenario() (with all members present).
+  static void SaveScenario(const ChScenario& scenario, rapidjson::Value& object, rapidjson::Document::AllocatorType& allocator);
+
+  /// Simulate the specified scenario on the calling thread, writing its output
+  /// in res.output_dir (an existing directory); the settle cache directory of
+  /// the scenario, if any, must exist as well. Several scenarios can be run
+  /// concurrently by different threads. This is the task executed by Run()
+  /// for each scenario; it does not use the result cache.
+  static void RunScenario(const ChScenario& scenario, ChScenarioResult& res);
+
+  /// Create the modules of the specified scenario, with its patches applied
+  /// while they are constructed (see RunScenario() for the simulation loop).
+  /// Modules can be created and released by several threads concurrently; the
+  /// construction is serialized. Returns false if the scenario is invalid.
+  static bool CreateModules(const ChScenario& scenario, ChScenarioModules& modules);
+
+  /// Release the modules created by CreateModules(). The modules must not be
+  /// referenced elsewhere (e.g. by a simulation loop) at that point, so that
+  /// they are destroyed by this call.
+  static void ReleaseModules(ChScenarioModules& modules);
+
+  /// Compute the result cache key of the specified scenario (see
+  /// ChResultCache::GetKey()). Unlike the latter, this function can be called
+  /// while other threads run scenarios with RunScenario().
+  static std::string GetScenarioKey(const ChScenario& scenario);
+
+  /// Get the number of scenarios in the batch.
+  int GetNumScenarios() const { return (int)m_scenarios.size(); }
+
+  /// Get the scenarios in the batch.
+  const std::vector<ChScenario>& GetScenarios() const { return m_scenarios; }
+
+  /// Get the number of worker threads.
+  int GetNumThreads() const { return m_num_threads; }
+
+  /// Run all scenarios in the batch and write the throughput report.
+  /// Returns false if the output directories cannot be created or if any of
+  /// the scenarios failed.
+  bool Run();
+
+  /// Get the statistics of the scenarios executed by the last call to Run().
+  const std::vector<ChScenarioResult>& GetResults() const { return m_results; }
+
+  /// Get the wall-clock time of the last call to Run().
+  double GetWallTime() const { return m_wall_time; }
+
+  /// Get the throughput of the last call to Run(), in simulated seconds per
+  /// wall-clock second per worker thread.
+  double GetThroughput() const;
+
+private:
+
+  // Write the report of the last batch to the specified file.
+  void write_report(const std::string& filename) const;
+
+  int                            m_num_threads;
+  bool                           m_numa_placement;
+  std::string                    m_out_dir;
+  std::string                    m_cache_dir;
+  std::vector<ChScenario>        m_scenarios;
+  std::vector<ChScenarioResult>  m_results;
+  double                         m_wall_time;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
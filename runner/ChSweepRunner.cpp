@@ -0,0 +1,403 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parameter sweep over the JSON specification files of a vehicle scenario.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "utils/ChUtilsInputOutput.h"
+#include "utils/ChUtilsSamplers.h"
+
+#include "subsys/ChJsonCache.h"
+
+#include "runner/ChSweepRunner.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Random numbers for the Latin hypercube (as in RoadProfileTerrain)
+// -----------------------------------------------------------------------------
+static unsigned long long SplitMix(unsigned long long& state)
+{
+  unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double Uniform(unsigned long long& state)
+{
+  return (SplitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSweepRunner::ChSweepRunner(int num_threads)
+: m_num_threads(num_threads),
+  m_out_dir("SWEEP"),
+  m_name("sweep"),
+  m_sampling(GRID),
+  m_num_samples(10),
+  m_seed(1)
+{
+}
+
+void ChSweepRunner::SetSampling(Sampling sampling, int num_samples, unsigned int seed)
+{
+  m_sampling = sampling;
+  m_num_samples = num_samples;
+  m_seed = seed;
+}
+
+// -----------------------------------------------------------------------------
+// Sweep file:
+//   {
+//     "Name":       ...,
+//     "Scenario":   { ... },                       (as in a scenario list file)
+//     "Sampling":   "Grid" | "Latin Hypercube" | "Sobol",
+//     "Samples":    ...,                           (Latin hypercube and Sobol only)
+//     "Seed":       ...,                           (Latin hypercube and Sobol only)
+//     "Parameters": [ { "File": ..., "Pointer": ..., "Values": [...] },
+//                     { "File": ..., "Pointer": ..., "Range": [min, max], "Points": ... },
+//                     { "Member": ..., "Range": [min, max] },
+//                     ... ]
+//   }
+// A "Member" parameter is a numeric member of the scenario, named as in
+// ChScenario (e.g. "terrain_seed", "terrain_mu", "friction_min").
+// -----------------------------------------------------------------------------
+bool ChSweepRunner::LoadSweep(const std::string& filename)
+{
+  const Document& d = ChJsonCache::Get(filename);
+
+  if (d.HasParseError() || !d.IsObject() || !d.HasMember("Scenario") || !d.HasMember("Parameters") ||
+      !d["Parameters"].IsArray()) {
+    GetLog() << "ERROR: invalid sweep file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  if (!ChScenarioRunner::LoadScenario(d["Scenario"], m_base)) {
+    GetLog() << "ERROR: invalid scenario in " << filename.c_str() << "\n";
+    return false;
+  }
+
+  if (d.HasMember("Name"))
+    m_name = d["Name"].GetString();
+
+  if (d.HasMember("Sampling")) {
+    std::string sampling = d["Sampling"].GetString();
+    if (sampling == "Grid")
+      m_sampling = GRID;
+    else if (sampling == "Latin Hypercube")
+      m_sampling = LATIN_HYPERCUBE;
+    else if (sampling == "Sobol")
+      m_sampling = SOBOL;
+    else {
+      GetLog() << "ERROR: unknown sampling " << sampling.c_str() << " in " << filename.c_str() << "\n";
+      return false;
+    }
+  }
+  if (d.HasMember("Samples"))
+    m_num_samples = d["Samples"].GetInt();
+  if (d.HasMember("Seed"))
+    m_seed = d["Seed"].GetUint();
+
+  return LoadParameters(d["Parameters"], filename, m_parameters);
+}
+
+bool ChSweepRunner::LoadParameters(const Value&                   list,
+                                   const std::string&             filename,
+                                   std::vector<ChSweepParameter>& parameters)
+{
+  std::vector<ChSweepParameter> loaded(list.Size());
+
+  for (SizeType i = 0; i < list.Size(); i++) {
+    const Value& p = list[i];
+    ChSweepParameter& parameter = loaded[i];
+    bool valid = p.IsObject() && (p.HasMember("Member") || (p.HasMember("File") && p.HasMember("Pointer")));
+
+    if (valid) {
+      if (p.HasMember("Member")) {
+        ChScenario scenario;
+        parameter.member = p["Member"].GetString();
+        valid = ApplyParameter(parameter, 0, scenario);
+      }
+      else {
+        parameter.file = p["File"].GetString();
+        parameter.pointer = p["Pointer"].GetString();
+      }
+    }
+
+    if (valid && p.HasMember("Values") && p["Values"].IsArray()) {
+      const Value& values = p["Values"];
+      for (SizeType k = 0; k < values.Size(); k++)
+        parameter.values.push_back(values[k].GetDouble());
+      valid = !parameter.values.empty();
+    }
+    else if (valid && p.HasMember("Range") && p["Range"].IsArray() && p["Range"].Size() == 2) {
+      parameter.min_value = p["Range"][0u].GetDouble();
+      parameter.max_value = p["Range"][1u].GetDouble();
+      if (p.HasMember("Points"))
+        parameter.num_points = p["Points"].GetInt();
+      valid = parameter.num_points > 0;
+    }
+    else {
+      valid = false;
+    }
+
+    if (!valid) {
+      GetLog() << "ERROR: invalid parameter #" << (int)i << " in " << filename.c_str() << "\n";
+      return false;
+    }
+  }
+
+  parameters.insert(parameters.end(), loaded.begin(), loaded.end());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Numeric scenario members that can be swept.
+// -----------------------------------------------------------------------------
+bool ChSweepRunner::ApplyParameter(const ChSweepParameter& parameter,
+                                   double                  value,
+                                   ChScenario&             scenario)
+{
+  if (parameter.member.empty()) {
+    ChScenario::Patch patch;
+    patch.file = parameter.file;
+    patch.pointer = parameter.pointer;
+    patch.value = value;
+    scenario.patches.push_back(patch);
+    return true;
+  }
+
+  const std::string& m = parameter.member;
+  double rounded = std::floor(value + 0.5);
+
+  if (m == "terrain_height")
+    scenario.terrain_height = value;
+  else if (m == "terrain_min")
+    scenario.terrain_min = value;
+  else if (m == "terrain_max")
+    scenario.terrain_max = value;
+  else if (m == "terrain_mu")
+    scenario.terrain_mu = value;
+  else if (m == "terrain_road_class")
+    scenario.terrain_road_class = (int)rounded;
+  else if (m == "terrain_seed")
+    scenario.terrain_seed = (unsigned int)std::max(rounded, 0.0);
+  else if (m == "terrain_coherence")
+    scenario.terrain_coherence = value;
+  else if (m == "terrain_track")
+    scenario.terrain_track = value;
+  else if (m == "friction_min")
+    scenario.friction_min = value;
+  else if (m == "friction_max")
+    scenario.friction_max = value;
+  else if (m == "step_size")
+    scenario.step_size = value;
+  else if (m == "end_time")
+    scenario.end_time = value;
+  else {
+    GetLog() << "ERROR: unknown scenario member " << m.c_str() << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+std::string ChSweepRunner::GetParameterName(const ChSweepParameter& parameter)
+{
+  return parameter.member.empty() ? parameter.file + "#" + parameter.pointer : parameter.member;
+}
+
+// -----------------------------------------------------------------------------
+// Grid points enumerate the parameter values with the first parameter varying
+// slowest. In a Latin hypercube sample of N points, the range of each
+// parameter is split into N strata and each stratum is sampled exactly once,
+// at a random location, in a random order per parameter. A Sobol sample is
+// the first N points of the sequence. Parameters given by explicit values are
+// sampled from the range of these values.
+// -----------------------------------------------------------------------------
+int ChSweepRunner::GetNumPoints() const
+{
+  if (m_parameters.empty())
+    return 0;
+
+  if (m_sampling != GRID)
+    return std::max(m_num_samples, 0);
+
+  int num_points = 1;
+  for (size_t j = 0; j < m_parameters.size(); j++) {
+    const ChSweepParameter& p = m_parameters[j];
+    num_points *= p.values.empty() ? p.num_points : (int)p.values.size();
+  }
+
+  return num_points;
+}
+
+std::vector<std::vector<double> > ChSweepRunner::GetPoints() const
+{
+  int num_points = GetNumPoints();
+  int num_params = (int)m_parameters.size();
+  std::vector<std::vector<double> > points(num_points, std::vector<double>(num_params, 0.0));
+
+  if (m_sampling == GRID) {
+    for (int i = 0; i < num_points; i++) {
+      int index = i;
+      for (int j = num_params - 1; j >= 0; j--) {
+        const ChSweepParameter& p = m_parameters[j];
+        int n = p.values.empty() ? p.num_points : (int)p.values.size();
+        int k = index % n;
+        index /= n;
+
+        if (!p.values.empty())
+          points[i][j] = p.values[k];
+        else if (n == 1)
+          points[i][j] = 0.5 * (p.min_value + p.max_value);
+        else
+          points[i][j] = p.min_value + k * (p.max_value - p.min_value) / (n - 1);
+      }
+    }
+    return points;
+  }
+
+  std::vector<std::vector<double> > u;
+  GetUnitPoints(m_sampling, num_params, 0, num_points, m_seed, u);
+
+  for (int i = 0; i < num_points; i++) {
+    for (int j = 0; j < num_params; j++)
+      points[i][j] = GetRangeValue(m_parameters[j], u[i][j]);
+  }
+
+  return points;
+}
+
+void ChSweepRunner::GetUnitPoints(Sampling                           sampling,
+                                  int                                dim,
+                                  int                                first,
+                                  int                                count,
+                                  unsigned int                       seed,
+                                  std::vector<std::vector<double> >& points)
+{
+  points.assign(count, std::vector<double>(dim, 0.0));
+
+  if (sampling == SOBOL) {
+    utils::ChSobolSequence sequence(dim, seed);
+    std::vector<double> u(utils::ChSobolSequence::MAX_DIMENSION);
+    for (int i = 0; i < count; i++) {
+      sequence.GetPoint((unsigned int)(first + i), &u[0]);
+      std::copy(u.begin(), u.begin() + sequence.GetDimension(), points[i].begin());
+    }
+    return;
+  }
+
+  unsigned long long state = seed + ((unsigned long long)first << 32);
+  std::vector<int> strata(count);
+
+  for (int j = 0; j < dim; j++) {
+    // Random permutation of the strata (Fisher-Yates)
+    for (int i = 0; i < count; i++)
+      strata[i] = i;
+    for (int i = count - 1; i > 0; i--) {
+      int k = (int)(Uniform(state) * (i + 1));
+      std::swap(strata[i], strata[std::min(k, i)]);
+    }
+
+    for (int i = 0; i < count; i++)
+      points[i][j] = (strata[i] + Uniform(state)) / count;
+  }
+}
+
+double ChSweepRunner::GetRangeValue(const ChSweepParameter& parameter, double u)
+{
+  double lo = parameter.min_value;
+  double hi = parameter.max_value;
+  if (!parameter.values.empty()) {
+    lo = *std::min_element(parameter.values.begin(), parameter.values.end());
+    hi = *std::max_element(parameter.values.begin(), parameter.values.end());
+  }
+
+  return lo + (hi - lo) * u;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChSweepRunner::Run()
+{
+  if (m_sampling == SOBOL && (int)m_parameters.size() > utils::ChSobolSequence::MAX_DIMENSION) {
+    GetLog() << "ERROR: Sobol sampling of more than " << utils::ChSobolSequence::MAX_DIMENSION << " parameters\n";
+    return false;
+  }
+
+  std::vector<std::vector<double> > points = GetPoints();
+  int num_points = (int)points.size();
+
+  ChScenarioRunner runner(m_num_threads);
+  runner.SetOutputDirectory(m_out_dir);
+  runner.SetResultCache(m_cache_dir);
+
+  for (int i = 0; i < num_points; i++) {
+    char suffix[16];
+    sprintf(suffix, "_%04d", i);
+
+    ChScenario scenario = m_base;
+    scenario.name = m_name + suffix;
+    for (size_t j = 0; j < m_parameters.size(); j++)
+      ApplyParameter(m_parameters[j], points[i][j], scenario);
+
+    runner.AddScenario(scenario);
+  }
+
+  GetLog() << "Sweep " << m_name.c_str() << ": " << num_points << " points, "
+           << (int)m_parameters.size() << " parameters\n";
+
+  bool ok = runner.Run();
+  m_results = runner.GetResults();
+
+  // Results table: one row per point, with the parameter values and the KPIs.
+  utils::CSV_writer csv(",");
+  std::string header = "index,name,ok";
+  for (size_t j = 0; j < m_parameters.size(); j++)
+    header += "," + GetParameterName(m_parameters[j]);
+  header += ",sim_time,wall_time,distance,max_speed,mean_speed,max_roll,max_pitch,max_lat_accel\n";
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const ChScenarioResult& res = m_results[i];
+    csv << res.index << res.name << res.ok;
+    for (size_t j = 0; j < m_parameters.size(); j++)
+      csv << points[i][j];
+    csv << res.sim_time << res.wall_time << res.distance << res.max_speed << res.mean_speed
+        << res.max_roll << res.max_pitch << res.max_lat_accel << std::endl;
+  }
+
+  csv.write_to_file(m_out_dir + "/sweep.csv", header);
+
+  return ok;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
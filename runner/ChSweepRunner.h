@@ -0,0 +1,178 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parameter sweep (sensitivity study) over the JSON specification files of a
+// vehicle scenario.
+//
+// A sweep varies numeric values of the specification files of a base scenario,
+// each addressed by a file name and a JSON pointer (see ChJsonPatch), or
+// numeric members of the base scenario itself (e.g. the terrain seed or
+// friction coefficient). The sample points are either the full factorial grid
+// of the parameter values, or a Latin hypercube or (scrambled) Sobol sample of
+// the parameter ranges. Each point is simulated as
+// a patched copy of the base scenario, named
+//    <sweep name>_NNNN
+// by a ChScenarioRunner (no specification file is written), and the parameter
+// values and KPIs of all points are collected in the table
+//    <output directory>/sweep.csv
+//
+// =============================================================================
+
+#ifndef CH_SWEEP_RUNNER_H
+#define CH_SWEEP_RUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "runner/ChApiRunner.h"
+#include "runner/ChScenarioRunner.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Swept parameter: a numeric value of a JSON specification file, or a numeric
+/// member of the scenario.
+///
+struct CH_RUNNER_API ChSweepParameter
+{
+  ChSweepParameter() : min_value(0), max_value(0), num_points(2) {}
+
+  std::string          file;        ///< JSON file, relative to the ChronoVehicle data directory
+  std::string          pointer;     ///< JSON pointer to the value
+  std::string          member;      ///< ChScenario member (e.g. "terrain_seed"), instead of file and pointer
+  std::vector<double>  values;      ///< explicit values (grid sampling); if empty, use the range
+  double               min_value;   ///< lower bound of the range
+  double               max_value;   ///< upper bound of the range
+  int                  num_points;  ///< number of equally spaced grid values in the range
+};
+
+///
+/// Runner for parameter sweeps.
+///
+class CH_RUNNER_API ChSweepRunner
+{
+public:
+
+  enum Sampling {
+    GRID,             ///< full factorial grid of the parameter values
+    LATIN_HYPERCUBE,  ///< Latin hypercube sample of the parameter ranges
+    SOBOL             ///< Sobol sample of the parameter ranges (see utils::ChSobolSequence)
+  };
+
+  /// Create a runner with the specified number of worker threads. If zero, use
+  /// the number of hardware threads.
+  ChSweepRunner(int num_threads = 0);
+
+  ~ChSweepRunner() {}
+
+  /// Set the top-level output directory (default: "SWEEP").
+  void SetOutputDirectory(const std::string& dir) { m_out_dir = dir; }
+
+  /// Set the directory of the result cache of the runs (see
+  /// ChScenarioRunner::SetResultCache; default: empty, no cache).
+  void SetResultCache(const std::string& dir) { m_cache_dir = dir; }
+
+  /// Set the scenario patched at each sample point.
+  void SetBaseScenario(const ChScenario& scenario) { m_base = scenario; }
+
+  /// Set the sweep name (default: "sweep").
+  void SetName(const std::string& name) { m_name = name; }
+
+  /// Set the sampling method. The Latin hypercube and Sobol samples have the
+  /// specified number of points and are reproducible for a given seed (the
+  /// Sobol points are randomized by a digital shift, unless the seed is 0).
+  void SetSampling(Sampling sampling, int num_samples = 10, unsigned int seed = 1);
+
+  /// Add a swept parameter.
+  void AddParameter(const ChSweepParameter& parameter) { m_parameters.push_back(parameter); }
+
+  /// Load the base scenario, the sampling method and the parameters from the
+  /// specified JSON file. Returns false if the file cannot be read or is invalid.
+  bool LoadSweep(const std::string& filename);
+
+  /// Get the number of sample points (scenarios) of the sweep.
+  int GetNumPoints() const;
+
+  /// Get the parameter values of all sample points (one row per point).
+  std::vector<std::vector<double> > GetPoints() const;
+
+  /// Run all sample points and write the results table.
+  /// Returns false if any of the points failed.
+  bool Run();
+
+  /// Get the statistics of the scenarios executed by the last call to Run().
+  const std::vector<ChScenarioResult>& GetResults() const { return m_results; }
+
+  /// Load a list of parameters from the specified JSON array (the
+  /// "Parameters" member of a sweep file). Returns false if a parameter is
+  /// invalid; the file name is only used in the error messages.
+  static bool LoadParameters(
+    const rapidjson::Value&         list,        ///< [in] JSON array of parameters
+    const std::string&              filename,    ///< [in] name of the JSON file
+    std::vector<ChSweepParameter>&  parameters   ///< [out] loaded parameters (appended)
+    );
+
+  /// Get the points [first, first + count) of a random or quasi-random sample
+  /// of the unit hypercube with the specified dimension. A Latin hypercube
+  /// sample is stratified over the requested points only (its seed is offset
+  /// by the first point); a Sobol sample is a segment of a single sequence.
+  static void GetUnitPoints(
+    Sampling                            sampling,   ///< [in] LATIN_HYPERCUBE or SOBOL
+    int                                 dim,        ///< [in] number of dimensions
+    int                                 first,      ///< [in] index of the first point
+    int                                 count,      ///< [in] number of points
+    unsigned int                        seed,       ///< [in] seed of the sample
+    std::vector<std::vector<double> >&  points      ///< [out] points in [0,1)^dim
+    );
+
+  /// Get the value of the specified parameter at the specified coordinate in
+  /// [0,1) of its range (or of the range of its explicit values).
+  static double GetRangeValue(const ChSweepParameter& parameter, double u);
+
+  /// Apply the value of the specified parameter to a scenario: add a patch,
+  /// or set the scenario member (rounded for integer members). Returns false
+  /// if the member is unknown.
+  static bool ApplyParameter(
+    const ChSweepParameter&  parameter,  ///< [in] parameter
+    double                   value,      ///< [in] parameter value
+    ChScenario&              scenario    ///< [in,out] patched scenario
+    );
+
+  /// Get the name of the specified parameter (results table column).
+  static std::string GetParameterName(const ChSweepParameter& parameter);
+
+private:
+
+  int                            m_num_threads;
+  std::string                    m_out_dir;
+  std::string                    m_cache_dir;
+  std::string                    m_name;
+  ChScenario                     m_base;
+  Sampling                       m_sampling;
+  int                            m_num_samples;
+  unsigned int                   m_seed;
+  std::vector<ChSweepParameter>  m_parameters;
+  std::vector<ChScenarioResult>  m_results;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,374 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Runner for batches of regression validations.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "core/ChLog.h"
+#include "core/ChTimer.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+#include "subsys/ChThreadPool.h"
+#include "subsys/ChJsonCache.h"
+
+#include "runner/ChValidationRunner.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/filewritestream.h"
+#include "rapidjson/prettywriter.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Task processing one validation case on a worker of the thread pool.
+// -----------------------------------------------------------------------------
+class ChValidationTask : public ChTask
+{
+public:
+  ChValidationTask(void (*run)(const ChValidationCase&, ChValidationResult&),
+                   const ChValidationCase* vcase,
+                   ChValidationResult* result)
+  : m_run(run), m_case(vcase), m_result(result) {}
+
+  virtual void Execute(int worker) { m_run(*m_case, *m_result); }
+
+private:
+  void (*m_run)(const ChValidationCase&, ChValidationResult&);
+  const ChValidationCase* m_case;
+  ChValidationResult* m_result;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChValidationRunner::ChValidationRunner(int num_threads)
+: m_num_threads(num_threads > 0 ? num_threads : ChThread::GetNumHardwareThreads())
+{
+}
+
+// -----------------------------------------------------------------------------
+// Manifest file:
+//   { "Validations": [ { "Simulation": ..., "Reference": ..., "Norm": ...,
+//                        "Tolerance": ..., "Delimiter": ... }, ... ] }
+// "Simulation" and "Tolerance" are required. Without "Reference", the norms of
+// the simulation data columns are checked. "Norm" is one of "L2", "RMS" (the
+// default) or "INF"; "Delimiter" defaults to a TAB.
+// -----------------------------------------------------------------------------
+static const char* normName(utils::ChNormType norm_type)
+{
+  switch (norm_type) {
+  case utils::L2_NORM:  return "L2";
+  case utils::RMS_NORM: return "RMS";
+  case utils::INF_NORM: return "INF";
+  }
+  return "";
+}
+
+static bool loadCase(const Value& v, ChValidationCase& vcase)
+{
+  if (!v.IsObject() || !v.HasMember("Simulation") || !v.HasMember("Tolerance"))
+    return false;
+
+  vcase.sim_file = v["Simulation"].GetString();
+  vcase.tolerance = v["Tolerance"].GetDouble();
+
+  if (v.HasMember("Reference"))
+    vcase.ref_file = utils::GetValidationDataFile(v["Reference"].GetString());
+
+  if (v.HasMember("Norm")) {
+    std::string norm = v["Norm"].GetString();
+
+    if (norm == "L2")
+      vcase.norm_type = utils::L2_NORM;
+    else if (norm == "RMS")
+      vcase.norm_type = utils::RMS_NORM;
+    else if (norm == "INF")
+      vcase.norm_type = utils::INF_NORM;
+    else
+      return false;
+  }
+
+  if (v.HasMember("Delimiter")) {
+    std::string delim = v["Delimiter"].GetString();
+    if (delim.size() != 1)
+      return false;
+    vcase.delim = delim[0];
+  }
+
+  return vcase.tolerance >= 0;
+}
+
+bool ChValidationRunner::LoadManifest(const std::string& filename)
+{
+  const Document& d = ChJsonCache::Get(filename);
+
+  if (d.HasParseError() || !d.IsObject() || !d.HasMember("Validations") || !d["Validations"].IsArray()) {
+    GetLog() << "ERROR: invalid validation manifest " << filename.c_str() << "\n";
+    return false;
+  }
+
+  const Value& list = d["Validations"];
+  std::vector<ChValidationCase> cases(list.Size());
+
+  for (SizeType i = 0; i < list.Size(); i++) {
+    if (!loadCase(list[i], cases[i])) {
+      GetLog() << "ERROR: invalid validation case #" << (int)i << " in " << filename.c_str() << "\n";
+      return false;
+    }
+  }
+
+  m_cases.insert(m_cases.end(), cases.begin(), cases.end());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChValidationRunner::Run()
+{
+  int num_cases = (int)m_cases.size();
+
+  m_results.assign(num_cases, ChValidationResult());
+  for (int i = 0; i < num_cases; i++)
+    m_results[i].index = i;
+
+  ChTimer<double> timer;
+  timer.start();
+
+  {
+    ChThreadPool pool(std::min(m_num_threads, std::max(num_cases, 1)));
+    std::vector<ChValidationTask> tasks;
+    tasks.reserve(num_cases);
+
+    for (int i = 0; i < num_cases; i++) {
+      tasks.push_back(ChValidationTask(&ChValidationRunner::run_case, &m_cases[i], &m_results[i]));
+      pool.Submit(&tasks.back());
+    }
+
+    pool.Wait();
+  }
+
+  timer.stop();
+
+  int num_passed = GetNumPassed();
+
+  GetLog() << "Validated " << num_cases << " cases on " << m_num_threads << " threads\n";
+  GetLog() << "   passed:    " << num_passed << "\n";
+  GetLog() << "   failed:    " << num_cases - num_passed << "\n";
+  GetLog() << "   wall time: " << timer() << " s\n";
+
+  return num_passed == num_cases;
+}
+
+int ChValidationRunner::GetNumPassed() const
+{
+  int num_passed = 0;
+  for (size_t i = 0; i < m_results.size(); i++) {
+    if (m_results[i].passed)
+      num_passed++;
+  }
+  return num_passed;
+}
+
+// -----------------------------------------------------------------------------
+// Process one case, streaming its data files. Only the norms are kept.
+// -----------------------------------------------------------------------------
+void ChValidationRunner::run_case(const ChValidationCase& vcase, ChValidationResult& res)
+{
+  utils::ChValidation validator;
+  validator.SetStreaming(true);
+
+  if (vcase.ref_file.empty())
+    res.ok = validator.Process(vcase.sim_file, vcase.delim);
+  else
+    res.ok = validator.Process(vcase.sim_file, vcase.ref_file, vcase.delim);
+
+  if (!res.ok || validator.GetNumColumns() == 0)
+    return;
+
+  const utils::Headers& headers = validator.GetHeadersSimData();
+
+  res.num_rows = validator.GetNumRows();
+  res.columns.assign(headers.begin() + 1, headers.end());
+  res.L2_norms.resize(validator.GetL2norms().size());
+  res.RMS_norms.resize(validator.GetRMSnorms().size());
+  res.INF_norms.resize(validator.GetINFnorms().size());
+  res.L2_norms = validator.GetL2norms();
+  res.RMS_norms = validator.GetRMSnorms();
+  res.INF_norms = validator.GetINFnorms();
+
+  const utils::DataVector* norms = &res.RMS_norms;
+  switch (vcase.norm_type) {
+  case utils::L2_NORM:  norms = &res.L2_norms; break;
+  case utils::RMS_NORM: norms = &res.RMS_norms; break;
+  case utils::INF_NORM: norms = &res.INF_norms; break;
+  }
+
+  res.passed = true;
+  for (size_t col = 0; col < norms->size(); col++) {
+    if (!((*norms)[col] <= vcase.tolerance))
+      res.passed = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChValidationRunner::WriteReport(const std::string& filename) const
+{
+  size_t n = filename.size();
+  if (n >= 5 && filename.compare(n - 5, 5, ".json") == 0)
+    return write_json(filename);
+
+  return write_csv(filename);
+}
+
+// One row per column of each case; a case that could not be processed has a
+// single row with status "error" and no column data.
+bool ChValidationRunner::write_csv(const std::string& filename) const
+{
+  utils::CSV_writer csv(",");
+  csv.set_fast_float(true);
+
+  if (!csv.open(filename, "index,simulation,reference,norm,tolerance,column,L2,RMS,INF,status\n")) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const ChValidationCase& vcase = m_cases[i];
+    const ChValidationResult& res = m_results[i];
+
+    if (!res.ok) {
+      csv << res.index << vcase.sim_file << vcase.ref_file << normName(vcase.norm_type) << vcase.tolerance
+          << "" << "" << "" << "" << "error" << std::endl;
+      continue;
+    }
+
+    for (size_t col = 0; col < res.columns.size(); col++) {
+      double norm = res.RMS_norms[col];
+      switch (vcase.norm_type) {
+      case utils::L2_NORM:  norm = res.L2_norms[col]; break;
+      case utils::RMS_NORM: norm = res.RMS_norms[col]; break;
+      case utils::INF_NORM: norm = res.INF_norms[col]; break;
+      }
+
+      csv << res.index << vcase.sim_file << vcase.ref_file << normName(vcase.norm_type) << vcase.tolerance
+          << res.columns[col] << res.L2_norms[col] << res.RMS_norms[col] << res.INF_norms[col]
+          << (norm <= vcase.tolerance ? "pass" : "fail") << std::endl;
+    }
+  }
+
+  csv.close();
+
+  return true;
+}
+
+static void writeNumber(PrettyWriter<FileWriteStream>& writer, double val)
+{
+  // JSON has no representation for infinity and NaN.
+  if (val - val == 0)
+    writer.Double(val);
+  else
+    writer.Null();
+}
+
+bool ChValidationRunner::write_json(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  char writeBuffer[65536];
+  FileWriteStream os(fp, writeBuffer, sizeof(writeBuffer));
+  PrettyWriter<FileWriteStream> writer(os);
+
+  writer.StartObject();
+
+  writer.String("Passed");
+  writer.Int(GetNumPassed());
+  writer.String("Failed");
+  writer.Int((int)m_results.size() - GetNumPassed());
+
+  writer.String("Validations");
+  writer.StartArray();
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const ChValidationCase& vcase = m_cases[i];
+    const ChValidationResult& res = m_results[i];
+
+    writer.StartObject();
+
+    writer.String("Index");
+    writer.Int(res.index);
+    writer.String("Simulation");
+    writer.String(vcase.sim_file.c_str());
+    if (!vcase.ref_file.empty()) {
+      writer.String("Reference");
+      writer.String(vcase.ref_file.c_str());
+    }
+    writer.String("Norm");
+    writer.String(normName(vcase.norm_type));
+    writer.String("Tolerance");
+    writeNumber(writer, vcase.tolerance);
+    writer.String("Status");
+    writer.String(!res.ok ? "error" : (res.passed ? "pass" : "fail"));
+
+    if (res.ok) {
+      writer.String("Rows");
+      writer.Uint((unsigned)res.num_rows);
+
+      writer.String("Columns");
+      writer.StartArray();
+      for (size_t col = 0; col < res.columns.size(); col++) {
+        writer.StartObject();
+        writer.String("Name");
+        writer.String(res.columns[col].c_str());
+        writer.String("L2");
+        writeNumber(writer, res.L2_norms[col]);
+        writer.String("RMS");
+        writeNumber(writer, res.RMS_norms[col]);
+        writer.String("INF");
+        writeNumber(writer, res.INF_norms[col]);
+        writer.EndObject();
+      }
+      writer.EndArray();
+    }
+
+    writer.EndObject();
+  }
+
+  writer.EndArray();
+  writer.EndObject();
+
+  fclose(fp);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
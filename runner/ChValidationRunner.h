@@ -0,0 +1,133 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Runner for batches of regression validations.
+//
+// Each validation case compares a simulation data file against a reference
+// data file (or, without a reference, checks the norms of a constraint
+// violation file) using utils::ChValidation. The cases are processed
+// concurrently on a work-stealing thread pool. Data files are streamed, so the
+// memory use depends on the number of worker threads but not on the sizes of
+// the files. The per-column norms and pass/fail status of all cases are
+// written to a CSV or JSON report.
+//
+// =============================================================================
+
+#ifndef CH_VALIDATION_RUNNER_H
+#define CH_VALIDATION_RUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "utils/ChUtilsValidation.h"
+
+#include "runner/ChApiRunner.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Description of a single validation.
+///
+struct CH_RUNNER_API ChValidationCase
+{
+  ChValidationCase() : norm_type(utils::RMS_NORM), tolerance(0), delim('\t') {}
+
+  std::string        sim_file;     ///< simulation data file
+  std::string        ref_file;     ///< reference data file (empty for a constraint violation file)
+  utils::ChNormType  norm_type;    ///< norm compared against the tolerance
+  double             tolerance;    ///< maximum norm for each column
+  char               delim;        ///< delimiter in the data files (default TAB)
+};
+
+///
+/// Outcome of a validation case.
+///
+struct CH_RUNNER_API ChValidationResult
+{
+  ChValidationResult() : index(-1), ok(false), passed(false), num_rows(0) {}
+
+  int                index;        ///< index of the case in the batch
+  bool               ok;           ///< false if the data files could not be processed
+  bool               passed;       ///< true if all column norms are below the tolerance
+  size_t             num_rows;     ///< number of data points
+  utils::Headers     columns;      ///< column headers (excluding the time column)
+  utils::DataVector  L2_norms;     ///< L2 norms of the columns (excluding time)
+  utils::DataVector  RMS_norms;    ///< RMS norms of the columns (excluding time)
+  utils::DataVector  INF_norms;    ///< infinity norms of the columns (excluding time)
+};
+
+///
+/// Runner for batches of validation cases.
+///
+class CH_RUNNER_API ChValidationRunner
+{
+public:
+
+  /// Create a runner with the specified number of worker threads. If zero, use
+  /// the number of hardware threads.
+  ChValidationRunner(int num_threads = 0);
+
+  ~ChValidationRunner() {}
+
+  /// Add the specified validation case to the batch.
+  void AddCase(const ChValidationCase& vcase) { m_cases.push_back(vcase); }
+
+  /// Add the validation cases listed in the specified JSON manifest file.
+  /// Simulation files are used as given; reference files are relative to the
+  /// validation data directory (see utils::GetValidationDataFile).
+  /// Returns false if the file cannot be read or contains an invalid case.
+  bool LoadManifest(const std::string& filename);
+
+  /// Get the number of validation cases in the batch.
+  int GetNumCases() const { return (int)m_cases.size(); }
+
+  /// Get the number of worker threads.
+  int GetNumThreads() const { return m_num_threads; }
+
+  /// Run all validation cases in the batch.
+  /// Returns true if all cases passed.
+  bool Run();
+
+  /// Get the outcome of the cases processed by the last call to Run().
+  const std::vector<ChValidationResult>& GetResults() const { return m_results; }
+
+  /// Get the number of cases that passed in the last call to Run().
+  int GetNumPassed() const;
+
+  /// Write the report of the last call to Run() to the specified file, as JSON
+  /// if its extension is ".json" and as CSV otherwise.
+  /// Returns false if the file cannot be written.
+  bool WriteReport(const std::string& filename) const;
+
+private:
+
+  // Process the specified case.
+  static void run_case(const ChValidationCase& vcase, ChValidationResult& res);
+
+  bool write_csv(const std::string& filename) const;
+  bool write_json(const std::string& filename) const;
+
+  int                              m_num_threads;
+  std::vector<ChValidationCase>    m_cases;
+  std::vector<ChValidationResult>  m_results;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,904 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Work queue distributing a batch of scenarios over the nodes of a cluster.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+# include <winsock2.h>
+# include <ws2tcpip.h>
+# include <process.h>
+#else
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <sys/select.h>
+# include <sys/time.h>
+# include <netinet/in.h>
+# include <netdb.h>
+# include <unistd.h>
+#endif
+
+#include "core/ChFileutils.h"
+#include "core/ChLog.h"
+
+#include "utils/ChUtilsInputOutput.h"
+
+#include "subsys/ChProfiler.h"
+
+#include "runner/ChWorkQueue.h"
+#include "runner/ChResultCache.h"
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+static const double QUEUE_IO_TIMEOUT = 10;      // timeout of a request or reply [s]
+static const double QUEUE_WAIT_TIME = 1;        // delay of an idle worker before its next fetch [s]
+static const double QUEUE_RETRY_DELAY = 1;      // delay between two connections to a lost coordinator [s]
+static const double QUEUE_POLL_TIME = 0.25;     // polling period of the coordinator and worker loops [s]
+static const double QUEUE_LINGER_TIME = 5;      // time the coordinator still answers after the batch [s]
+static const size_t QUEUE_MAX_MESSAGE = 1 << 26;
+
+
+// -----------------------------------------------------------------------------
+// Socket wrapper (platform specific)
+// -----------------------------------------------------------------------------
+#ifdef _WIN32
+typedef SOCKET socket_t;
+static const socket_t INVALID_SOCKET_T = INVALID_SOCKET;
+static void CloseSocket(socket_t s) { closesocket(s); }
+#else
+typedef int socket_t;
+static const socket_t INVALID_SOCKET_T = -1;
+static void CloseSocket(socket_t s) { close(s); }
+#endif
+
+static bool InitSockets()
+{
+#ifdef _WIN32
+  static bool initialized = false;
+  if (!initialized) {
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+      return false;
+    initialized = true;
+  }
+#endif
+  return true;
+}
+
+static void SetTimeout(socket_t s, double seconds)
+{
+#ifdef _WIN32
+  DWORD ms = (DWORD)(seconds * 1000);
+  setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&ms, sizeof(ms));
+  setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const char*)&ms, sizeof(ms));
+#else
+  timeval tv;
+  tv.tv_sec = (long)seconds;
+  tv.tv_usec = (long)((seconds - tv.tv_sec) * 1e6);
+  setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
+  setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const char*)&tv, sizeof(tv));
+#endif
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&one, sizeof(one));
+#endif
+}
+
+static socket_t ConnectTo(const std::string& host, int port)
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* result = 0;
+  if (getaddrinfo(host.c_str(), 0, &hints, &result) != 0 || !result)
+    return INVALID_SOCKET_T;
+
+  sockaddr_in address;
+  std::memcpy(&address, result->ai_addr, sizeof(sockaddr_in));
+  address.sin_port = htons((unsigned short)port);
+  freeaddrinfo(result);
+
+  socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+  if (s == INVALID_SOCKET_T)
+    return INVALID_SOCKET_T;
+
+  if (connect(s, (const sockaddr*)&address, sizeof(address)) != 0) {
+    CloseSocket(s);
+    return INVALID_SOCKET_T;
+  }
+
+  return s;
+}
+
+// -----------------------------------------------------------------------------
+// Messages (one JSON object per line)
+// -----------------------------------------------------------------------------
+static bool SendMessage(socket_t s, const Document& msg)
+{
+  StringBuffer buffer;
+  Writer<StringBuffer> writer(buffer);
+  msg.Accept(writer);
+
+  std::string text(buffer.GetString(), buffer.GetSize());
+  text += '\n';
+
+#ifdef MSG_NOSIGNAL
+  int flags = MSG_NOSIGNAL;
+#else
+  int flags = 0;
+#endif
+
+  size_t sent = 0;
+  while (sent < text.size()) {
+    int n = send(s, text.c_str() + sent, (int)(text.size() - sent), flags);
+    if (n <= 0)
+      return false;
+    sent += n;
+  }
+
+  return true;
+}
+
+static bool ReceiveMessage(socket_t s, Document& msg)
+{
+  std::string text;
+  char buffer[4096];
+
+  while (text.empty() || text[text.size() - 1] != '\n') {
+    int n = recv(s, buffer, sizeof(buffer), 0);
+    if (n <= 0 || text.size() + n > QUEUE_MAX_MESSAGE)
+      return false;
+    text.append(buffer, n);
+  }
+
+  msg.Parse<0>(text.c_str());
+
+  return !msg.HasParseError() && msg.IsObject() && msg.HasMember("Type") && msg["Type"].IsString();
+}
+
+static void SetType(Document& msg, const char* type)
+{
+  msg.SetObject();
+  msg.AddMember("Type", StringRef(type), msg.GetAllocator());
+}
+
+static bool IsType(const Document& msg, const char* type)
+{
+  return std::strcmp(msg["Type"].GetString(), type) == 0;
+}
+
+static bool IsIntMember(const Value& msg, const char* name)
+{
+  return msg.HasMember(name) && msg[name].IsInt();
+}
+
+
+// =============================================================================
+// ChWorkQueueCoordinator
+// =============================================================================
+ChWorkQueueCoordinator::ChWorkQueueCoordinator(int port)
+: m_port(port),
+  m_out_dir("SCENARIOS"),
+  m_max_attempts(3),
+  m_lease_time(60),
+  m_duplicates(true),
+  m_num_open(0),
+  m_num_retries(0),
+  m_num_copies(0),
+  m_wall_time(0)
+{
+}
+
+bool ChWorkQueueCoordinator::LoadScenarios(const std::string& filename)
+{
+  ChScenarioRunner runner;
+  if (!runner.LoadScenarios(filename))
+    return false;
+
+  m_scenarios.insert(m_scenarios.end(), runner.GetScenarios().begin(), runner.GetScenarios().end());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// The coordinator serves one request at a time; the requests are short, as
+// the workers only exchange scenarios and results with the coordinator.
+// -----------------------------------------------------------------------------
+bool ChWorkQueueCoordinator::Run()
+{
+  int num_jobs = (int)m_scenarios.size();
+
+  m_results.assign(num_jobs, ChScenarioResult());
+  m_jobs.assign(num_jobs, Job());
+  m_queue.clear();
+  m_workers.clear();
+  m_num_open = num_jobs;
+  m_num_retries = 0;
+  m_num_copies = 0;
+  m_wall_time = 0;
+
+  if (ChFileutils::MakeDirectory(m_out_dir.c_str()) < 0) {
+    GetLog() << "ERROR: cannot create directory " << m_out_dir.c_str() << "\n";
+    return false;
+  }
+
+  for (int i = 0; i < num_jobs; i++) {
+    char dirname[16];
+    sprintf(dirname, "%04d_", i);
+
+    m_results[i].index = i;
+    m_results[i].name = m_scenarios[i].name;
+    m_results[i].output_dir = m_out_dir + "/" + dirname + m_scenarios[i].name;
+
+    m_jobs[i].state = PENDING;
+    m_jobs[i].num_attempts = 0;
+    m_jobs[i].num_failures = 0;
+    m_queue.push_back(i);
+  }
+
+  // Open the listening socket.
+  socket_t listener = InitSockets() ? socket(AF_INET, SOCK_STREAM, 0) : INVALID_SOCKET_T;
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons((unsigned short)m_port);
+
+  int reuse = 1;
+  if (listener == INVALID_SOCKET_T ||
+      setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse)) != 0 ||
+      bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(listener, 64) != 0) {
+    GetLog() << "ERROR: cannot listen on TCP port " << m_port << "\n";
+    if (listener != INVALID_SOCKET_T)
+      CloseSocket(listener);
+    return false;
+  }
+
+  GetLog() << "Serving " << num_jobs << " scenarios on port " << m_port << "\n";
+
+  // Serve the workers. After the end of the batch, the coordinator still
+  // answers for a while, so that the idle workers learn about it.
+  double start = ChProfiler::GetTime();
+  double now = start;
+  double end = start;
+  bool finished = (num_jobs == 0);
+
+  while (!finished || now - end < QUEUE_LINGER_TIME) {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(listener, &fds);
+
+    timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = (long)(QUEUE_POLL_TIME * 1e6);
+
+    int ready = select((int)listener + 1, &fds, 0, 0, &tv);
+    now = ChProfiler::GetTime();
+
+    if (ready > 0) {
+      socket_t s = accept(listener, 0, 0);
+      if (s != INVALID_SOCKET_T) {
+        SetTimeout(s, QUEUE_IO_TIMEOUT);
+        Document request;
+        Document reply;
+        if (ReceiveMessage(s, request)) {
+          handle(request, reply, now);
+          SendMessage(s, reply);
+        }
+        CloseSocket(s);
+      }
+    }
+
+    expire_leases(now);
+
+    if (!finished && m_num_open == 0) {
+      finished = true;
+      end = now;
+    }
+  }
+
+  CloseSocket(listener);
+
+  m_wall_time = end - start;
+
+  // Report.
+  bool ok = true;
+  int num_cached = 0;
+  double sim_time = 0;
+
+  for (int i = 0; i < num_jobs; i++) {
+    ok = ok && m_results[i].ok;
+    num_cached += m_results[i].cached ? 1 : 0;
+    sim_time += m_results[i].sim_time;
+  }
+
+  GetLog() << "Ran " << num_jobs << " scenarios on " << (int)m_workers.size() << " workers\n";
+  if (num_cached > 0)
+    GetLog() << "   cached results: " << num_cached << "\n";
+  GetLog() << "   retries:        " << m_num_retries << "\n";
+  GetLog() << "   copies:         " << m_num_copies << "\n";
+  GetLog() << "   simulated time: " << sim_time << " s\n";
+  GetLog() << "   wall time:      " << m_wall_time << " s\n";
+
+  write_report(m_out_dir + "/report.csv");
+
+  return ok;
+}
+
+void ChWorkQueueCoordinator::handle(const Document& request, Document& reply, double now)
+{
+  std::string worker;
+  if (request.HasMember("Worker") && request["Worker"].IsString())
+    worker = request["Worker"].GetString();
+
+  if (m_workers.find(worker) == m_workers.end())
+    m_workers[worker] = 0;
+
+  if (IsType(request, "Fetch")) {
+    fetch(worker, reply, now);
+  } else if (IsType(request, "Heartbeat") && request.HasMember("Jobs") && request["Jobs"].IsArray()) {
+    heartbeat(worker, request["Jobs"], reply, now);
+  } else if (IsType(request, "Result")) {
+    result(worker, request);
+    SetType(reply, "Ok");
+  } else {
+    SetType(reply, "Error");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The pending jobs are handed out in order. Once there are none, an idle
+// worker gets a copy of the job running the longest, if not its own.
+// -----------------------------------------------------------------------------
+void ChWorkQueueCoordinator::fetch(const std::string& worker, Document& reply, double now)
+{
+  Document::AllocatorType& allocator = reply.GetAllocator();
+
+  int id = -1;
+  while (id < 0 && !m_queue.empty()) {
+    id = m_queue.front();
+    m_queue.pop_front();
+    if (m_jobs[id].state != PENDING)
+      id = -1;
+  }
+
+  if (id < 0 && m_duplicates) {
+    id = find_duplicate(worker);
+    if (id >= 0)
+      m_num_copies++;
+  }
+
+  if (id < 0) {
+    if (m_num_open == 0) {
+      SetType(reply, "Done");
+    } else {
+      SetType(reply, "Wait");
+      reply.AddMember("Seconds", QUEUE_WAIT_TIME, allocator);
+    }
+    return;
+  }
+
+  Job& job = m_jobs[id];
+
+  Lease lease;
+  lease.worker = worker;
+  lease.attempt = ++job.num_attempts;
+  lease.start = now;
+  lease.heartbeat = now;
+  job.leases.push_back(lease);
+  job.state = RUNNING;
+
+  // A copy writes to its own directory; a retry continues in the directory of
+  // the previous attempts (from their last checkpoint, if any).
+  std::string dir = m_results[id].output_dir;
+  if (job.leases.size() > 1) {
+    char suffix[16];
+    sprintf(suffix, "_%d", lease.attempt);
+    dir += suffix;
+  }
+
+  SetType(reply, "Job");
+  reply.AddMember("Id", id, allocator);
+  reply.AddMember("Attempt", lease.attempt, allocator);
+  reply.AddMember("Lease", m_lease_time, allocator);
+  reply.AddMember("Output Directory", Value().SetString(dir.c_str(), allocator), allocator);
+  Value scenario;
+  ChScenarioRunner::SaveScenario(m_scenarios[id], scenario, allocator);
+  reply.AddMember("Scenario", scenario, allocator);
+}
+
+int ChWorkQueueCoordinator::find_duplicate(const std::string& worker) const
+{
+  int best = -1;
+
+  for (int i = 0; i < (int)m_jobs.size(); i++) {
+    const Job& job = m_jobs[i];
+    if (job.state != RUNNING || job.leases.size() != 1 || job.leases[0].worker == worker)
+      continue;
+    if (best < 0 || job.leases[0].start < m_jobs[best].leases[0].start)
+      best = i;
+  }
+
+  return best;
+}
+
+// -----------------------------------------------------------------------------
+// A heartbeat renews the leases of the listed jobs, and the reply lists those
+// which ended elsewhere in the meantime.
+// -----------------------------------------------------------------------------
+void ChWorkQueueCoordinator::heartbeat(const std::string& worker, const Value& jobs, Document& reply, double now)
+{
+  Document::AllocatorType& allocator = reply.GetAllocator();
+  Value obsolete(kArrayType);
+
+  for (SizeType i = 0; i < jobs.Size(); i++) {
+    const Value& entry = jobs[i];
+    if (!entry.IsArray() || entry.Size() != 2 || !entry[0u].IsInt() || !entry[1u].IsInt())
+      continue;
+
+    int id = entry[0u].GetInt();
+    int attempt = entry[1u].GetInt();
+    if (id < 0 || id >= (int)m_jobs.size())
+      continue;
+
+    Job& job = m_jobs[id];
+    if (job.state == COMPLETED || job.state == FAILED) {
+      obsolete.PushBack(id, allocator);
+      continue;
+    }
+
+    for (size_t k = 0; k < job.leases.size(); k++) {
+      if (job.leases[k].worker == worker && job.leases[k].attempt == attempt)
+        job.leases[k].heartbeat = now;
+    }
+  }
+
+  SetType(reply, "Ok");
+  reply.AddMember("Obsolete", obsolete, allocator);
+}
+
+// -----------------------------------------------------------------------------
+// The first successful result of a job wins, also from an expired lease.
+// -----------------------------------------------------------------------------
+void ChWorkQueueCoordinator::result(const std::string& worker, const Document& request)
+{
+  if (!IsIntMember(request, "Id") || !IsIntMember(request, "Attempt") ||
+      !request.HasMember("Ok") || !request["Ok"].IsBool())
+    return;
+
+  int id = request["Id"].GetInt();
+  int attempt = request["Attempt"].GetInt();
+  if (id < 0 || id >= (int)m_jobs.size())
+    return;
+
+  Job& job = m_jobs[id];
+
+  size_t k = 0;
+  while (k < job.leases.size() && (job.leases[k].worker != worker || job.leases[k].attempt != attempt))
+    k++;
+
+  if (job.state == COMPLETED || job.state == FAILED) {
+    if (k < job.leases.size())
+      job.leases.erase(job.leases.begin() + k);
+    return;
+  }
+
+  ChScenarioResult res;
+  if (request["Ok"].GetBool() && request.HasMember("Result") && ChResultCache::LoadResult(request["Result"], res)) {
+    res.index = id;
+    res.name = m_results[id].name;
+    res.cached = request.HasMember("Cached") && request["Cached"].IsBool() && request["Cached"].GetBool();
+    m_results[id] = res;
+
+    job.state = COMPLETED;
+    job.worker = worker;
+    job.leases.clear();
+    m_workers[worker]++;
+    m_num_open--;
+    return;
+  }
+
+  GetLog() << "WARNING: scenario " << id << " (" << m_results[id].name.c_str() << ") failed on "
+           << worker.c_str() << "\n";
+
+  if (k < job.leases.size())
+    end_lease(id, k);
+}
+
+void ChWorkQueueCoordinator::end_lease(int id, size_t lease)
+{
+  Job& job = m_jobs[id];
+
+  job.leases.erase(job.leases.begin() + lease);
+  job.num_failures++;
+
+  // Wait for the other copy, if any.
+  if (!job.leases.empty())
+    return;
+
+  if (job.num_failures < m_max_attempts) {
+    job.state = PENDING;
+    m_queue.push_back(id);
+    m_num_retries++;
+  } else {
+    job.state = FAILED;
+    m_num_open--;
+    GetLog() << "ERROR: scenario " << id << " (" << m_results[id].name.c_str() << ") failed after "
+             << job.num_failures << " attempts\n";
+  }
+}
+
+void ChWorkQueueCoordinator::expire_leases(double now)
+{
+  for (int i = 0; i < (int)m_jobs.size(); i++) {
+    Job& job = m_jobs[i];
+    for (size_t k = job.leases.size(); k > 0; k--) {
+      const Lease& lease = job.leases[k - 1];
+      if (now - lease.heartbeat <= m_lease_time)
+        continue;
+      GetLog() << "WARNING: lease of scenario " << i << " (" << m_results[i].name.c_str() << ") on "
+               << lease.worker.c_str() << " expired\n";
+      end_lease(i, k - 1);
+    }
+  }
+}
+
+void ChWorkQueueCoordinator::write_report(const std::string& filename) const
+{
+  // The wall-clock time of each scenario is the one of its winning attempt.
+  // The last row holds the batch totals.
+  utils::CSV_writer csv(",");
+
+  bool ok = true;
+  int num_steps = 0;
+  double sim_time = 0;
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const ChScenarioResult& res = m_results[i];
+    double throughput = (res.wall_time > 0) ? res.sim_time / res.wall_time : 0;
+    csv << res.index << res.name << res.ok << res.num_steps << res.sim_time << res.wall_time << throughput
+        << res.model_time[0] << res.model_time[1] << res.model_time[2]
+        << res.distance << res.max_speed << res.mean_speed << res.max_roll << res.max_pitch << res.max_lat_accel
+        << res.cached << m_jobs[i].num_attempts << m_jobs[i].worker << std::endl;
+
+    ok = ok && res.ok;
+    num_steps += res.num_steps;
+    sim_time += res.sim_time;
+  }
+
+  double throughput = (m_wall_time > 0) ? sim_time / m_wall_time : 0;
+  csv << "total" << "" << ok << num_steps << sim_time << m_wall_time << throughput << "" << "" << ""
+      << "" << "" << "" << "" << "" << "" << "" << m_num_retries + m_num_copies << (int)m_workers.size() << std::endl;
+
+  csv.write_to_file(filename, "index,name,ok,steps,sim_time,wall_time,throughput,full_time,reduced_time,kinematic_time,"
+                              "distance,max_speed,mean_speed,max_roll,max_pitch,max_lat_accel,cached,attempts,worker\n");
+}
+
+
+// =============================================================================
+// ChWorkQueueWorker
+// =============================================================================
+static std::string GetDefaultWorkerName()
+{
+  char host[256] = "worker";
+  if (InitSockets())
+    gethostname(host, sizeof(host) - 1);
+
+#ifdef _WIN32
+  int pid = _getpid();
+#else
+  int pid = (int)getpid();
+#endif
+
+  char name[320];
+  sprintf(name, "%s:%d", host, pid);
+  return name;
+}
+
+ChWorkQueueWorker::ChWorkQueueWorker(const std::string& host, int port, int num_threads)
+: m_host(host),
+  m_port(port),
+  m_num_threads(num_threads > 0 ? num_threads : ChThread::GetNumHardwareThreads()),
+  m_name(GetDefaultWorkerName()),
+  m_retry_time(60),
+  m_lease_time(60),
+  m_done(false),
+  m_lost(false),
+  m_num_active(0),
+  m_num_completed(0),
+  m_num_failed(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// The heartbeats are sent by the calling thread, while the pullers run their
+// scenarios.
+// -----------------------------------------------------------------------------
+bool ChWorkQueueWorker::Run()
+{
+  m_running.clear();
+  m_obsolete.clear();
+  m_done = false;
+  m_lost = false;
+  m_num_active = 0;
+  m_num_completed = 0;
+  m_num_failed = 0;
+
+  if (!InitSockets()) {
+    GetLog() << "ERROR: cannot initialize the sockets\n";
+    return false;
+  }
+
+  if (!m_cache_dir.empty() && ChFileutils::MakeDirectory(m_cache_dir.c_str()) < 0) {
+    GetLog() << "ERROR: cannot create directory " << m_cache_dir.c_str() << "\n";
+    return false;
+  }
+
+  GetLog() << "Worker " << m_name.c_str() << " running " << m_num_threads << " threads for "
+           << m_host.c_str() << ":" << m_port << "\n";
+
+  std::vector<Puller*> pullers;
+  for (int i = 0; i < m_num_threads; i++) {
+    Puller* puller = new Puller(this);
+    m_mutex.Lock();
+    m_num_active++;
+    m_mutex.Unlock();
+    if (puller->Start()) {
+      pullers.push_back(puller);
+    } else {
+      m_mutex.Lock();
+      m_num_active--;
+      m_mutex.Unlock();
+      delete puller;
+    }
+  }
+
+  double last = ChProfiler::GetTime();
+
+  while (true) {
+    ChThread::Sleep(QUEUE_POLL_TIME);
+
+    m_mutex.Lock();
+    bool active = (m_num_active > 0);
+    bool busy = !m_running.empty();
+    double period = m_lease_time / 4;
+    m_mutex.Unlock();
+
+    if (!active)
+      break;
+
+    double now = ChProfiler::GetTime();
+    if (busy && now - last >= period) {
+      send_heartbeat();
+      last = now;
+    }
+  }
+
+  for (size_t i = 0; i < pullers.size(); i++) {
+    pullers[i]->Join();
+    delete pullers[i];
+  }
+
+  GetLog() << "Worker " << m_name.c_str() << " ran " << m_num_completed + m_num_failed << " scenarios ("
+           << m_num_failed << " failed)\n";
+
+  return !m_lost;
+}
+
+void ChWorkQueueWorker::pull_jobs()
+{
+  while (true) {
+    Document request;
+    Document reply;
+    SetType(request, "Fetch");
+    request.AddMember("Worker", Value().SetString(m_name.c_str(), request.GetAllocator()), request.GetAllocator());
+
+    if (!exchange(request, reply, true) || IsType(reply, "Done"))
+      break;
+
+    if (IsType(reply, "Wait")) {
+      bool valid = reply.HasMember("Seconds") && reply["Seconds"].IsNumber();
+      ChThread::Sleep(valid ? reply["Seconds"].GetDouble() : QUEUE_WAIT_TIME);
+      continue;
+    }
+
+    Document message;
+    if (!IsType(reply, "Job") || !run_job(reply, message)) {
+      ChThread::Sleep(QUEUE_WAIT_TIME);
+      continue;
+    }
+
+    // The result of a job which ended elsewhere is discarded.
+    int id = reply["Id"].GetInt();
+    std::pair<int, int> entry(id, reply["Attempt"].GetInt());
+
+    m_mutex.Lock();
+    m_running.erase(std::find(m_running.begin(), m_running.end(), entry));
+    bool obsolete = (m_obsolete.find(id) != m_obsolete.end());
+    m_mutex.Unlock();
+
+    Document ack;
+    if (!obsolete && !exchange(message, ack, true))
+      break;
+  }
+
+  ChScopedLock lock(m_mutex);
+  m_num_active--;
+}
+
+// -----------------------------------------------------------------------------
+// The model data loaded by a scenario (see ChJsonCache, ChMeshCache, ...) stay
+// in memory, so that the following scenarios on this node reuse them.
+// -----------------------------------------------------------------------------
+bool ChWorkQueueWorker::run_job(const Document& job, Document& message)
+{
+  if (!IsIntMember(job, "Id") || !IsIntMember(job, "Attempt") || !job.HasMember("Scenario") ||
+      !job.HasMember("Output Directory") || !job["Output Directory"].IsString())
+    return false;
+
+  int id = job["Id"].GetInt();
+  int attempt = job["Attempt"].GetInt();
+
+  ChScenario scenario;
+  ChScenarioResult res;
+  bool valid = ChScenarioRunner::LoadScenario(job["Scenario"], scenario);
+
+  res.index = id;
+  res.name = scenario.name;
+  res.output_dir = job["Output Directory"].GetString();
+
+  m_mutex.Lock();
+  m_running.push_back(std::make_pair(id, attempt));
+  if (job.HasMember("Lease") && job["Lease"].IsNumber())
+    m_lease_time = job["Lease"].GetDouble();
+  m_mutex.Unlock();
+
+  // Look up the cached result, and create the directories of the scenario.
+  std::string key;
+  if (valid && !m_cache_dir.empty())
+    key = ChScenarioRunner::GetScenarioKey(scenario);
+
+  m_mutex.Lock();
+  if (!valid) {
+    GetLog() << "ERROR: invalid scenario " << id << "\n";
+  } else if (key.empty() || !ChResultCache(m_cache_dir).Load(key, res)) {
+    if (ChFileutils::MakeDirectory(res.output_dir.c_str()) < 0 ||
+        (!scenario.settle_cache.empty() && ChFileutils::MakeDirectory(scenario.settle_cache.c_str()) < 0)) {
+      GetLog() << "ERROR: cannot create the directories of scenario " << id << " (" << res.name.c_str() << ")\n";
+      valid = false;
+    }
+  }
+  m_mutex.Unlock();
+
+  if (valid && !res.cached) {
+    ChScenarioRunner::RunScenario(scenario, res);
+    if (res.ok && !key.empty()) {
+      ChScopedLock lock(m_mutex);
+      ChResultCache(m_cache_dir).Store(key, res);
+    }
+  }
+
+  m_mutex.Lock();
+  if (res.ok) {
+    m_num_completed++;
+  } else {
+    m_num_failed++;
+    GetLog() << "WARNING: scenario " << id << " (" << res.name.c_str() << ") failed\n";
+  }
+  m_mutex.Unlock();
+
+  // The result message.
+  Document::AllocatorType& allocator = message.GetAllocator();
+  SetType(message, "Result");
+  message.AddMember("Worker", Value().SetString(m_name.c_str(), allocator), allocator);
+  message.AddMember("Id", id, allocator);
+  message.AddMember("Attempt", attempt, allocator);
+  message.AddMember("Ok", res.ok, allocator);
+  message.AddMember("Cached", res.cached, allocator);
+  if (res.ok) {
+    Value result;
+    ChResultCache::SaveResult(res, result, allocator);
+    message.AddMember("Result", result, allocator);
+  }
+
+  return true;
+}
+
+void ChWorkQueueWorker::send_heartbeat()
+{
+  Document request;
+  Document reply;
+  Document::AllocatorType& allocator = request.GetAllocator();
+
+  SetType(request, "Heartbeat");
+  request.AddMember("Worker", Value().SetString(m_name.c_str(), allocator), allocator);
+
+  Value jobs(kArrayType);
+  m_mutex.Lock();
+  for (size_t i = 0; i < m_running.size(); i++)
+    jobs.PushBack(Value().SetArray().PushBack(m_running[i].first, allocator).PushBack(m_running[i].second, allocator),
+                  allocator);
+  m_mutex.Unlock();
+  request.AddMember("Jobs", jobs, allocator);
+
+  // A missed heartbeat is not retried; the lease covers several periods.
+  if (!exchange(request, reply, false) || !reply.HasMember("Obsolete") || !reply["Obsolete"].IsArray())
+    return;
+
+  const Value& obsolete = reply["Obsolete"];
+  ChScopedLock lock(m_mutex);
+  for (SizeType i = 0; i < obsolete.Size(); i++) {
+    if (obsolete[i].IsInt())
+      m_obsolete[obsolete[i].GetInt()] = true;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Once the coordinator reported the end of the batch (it may then be gone) or
+// was lost, no more connections are retried.
+// -----------------------------------------------------------------------------
+bool ChWorkQueueWorker::exchange(const Document& request, Document& reply, bool retry)
+{
+  double start = ChProfiler::GetTime();
+
+  while (true) {
+    socket_t s = ConnectTo(m_host, m_port);
+    if (s != INVALID_SOCKET_T) {
+      SetTimeout(s, QUEUE_IO_TIMEOUT);
+      bool ok = SendMessage(s, request) && ReceiveMessage(s, reply);
+      CloseSocket(s);
+      if (ok) {
+        if (IsType(reply, "Done")) {
+          ChScopedLock lock(m_mutex);
+          m_done = true;
+        }
+        return true;
+      }
+    }
+
+    m_mutex.Lock();
+    bool give_up = !retry || m_done || m_lost;
+    if (!give_up && ChProfiler::GetTime() - start > m_retry_time) {
+      GetLog() << "ERROR: lost the coordinator " << m_host.c_str() << ":" << m_port << "\n";
+      m_lost = true;
+      give_up = true;
+    }
+    m_mutex.Unlock();
+
+    if (give_up)
+      return false;
+
+    ChThread::Sleep(QUEUE_RETRY_DELAY);
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
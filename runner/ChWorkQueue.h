@@ -0,0 +1,268 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Work queue distributing a batch of scenarios over the nodes of a cluster.
+//
+// A coordinator process holds the queue of scenarios; one worker process per
+// node pulls them, one at a time, on each thread of its local pool, so that
+// faster or less loaded nodes take more scenarios. Each scenario is run with
+// ChScenarioRunner::RunScenario(), writing its output (traces, log and
+// checkpoints) to
+//    <output directory>/NNNN_<scenario name>
+// where the output directory is on storage shared by all nodes. The worker
+// sends back the statistics and KPIs of the scenario only, and the coordinator
+// writes the report of the batch to
+//    <output directory>/report.csv
+//
+// The processes exchange newline-terminated JSON messages over TCP, one
+// request and one reply per connection:
+//    worker:      { "Type": "Fetch", "Worker": ... }
+//    coordinator: { "Type": "Job", "Id": ..., "Attempt": ..., "Lease": ...,
+//                   "Output Directory": ..., "Scenario": { ... } }
+//                 { "Type": "Wait", "Seconds": ... }  or  { "Type": "Done" }
+//    worker:      { "Type": "Heartbeat", "Worker": ..., "Jobs": [ [id, attempt], ... ] }
+//    coordinator: { "Type": "Ok", "Obsolete": [ id, ... ] }
+//    worker:      { "Type": "Result", "Worker": ..., "Id": ..., "Attempt": ...,
+//                   "Ok": ..., "Cached": ..., "Result": { ... } }
+//    coordinator: { "Type": "Ok" }
+// The scenarios are sent with ChScenarioRunner::SaveScenario() and the results
+// with ChResultCache::SaveResult().
+//
+// A scenario is leased to a worker, which renews the lease with periodic
+// heartbeats while it runs. A scenario whose lease expires (e.g. its node was
+// lost) or which failed to run is queued again, up to a maximum number of
+// attempts; a retried scenario resumes from its last checkpoint, if any (see
+// ChScenario::checkpoint_interval). Once the queue is empty, idle workers get
+// copies of the scenarios running the longest (in a separate directory), so
+// that a slow node does not delay the whole batch; the first result wins and
+// the others are discarded.
+//
+// Each worker process keeps its model data (parsed JSON files, meshes, tire
+// parameter blocks) in memory for all the scenarios it runs, and can use a
+// node-local or shared result cache (see ChResultCache).
+//
+// =============================================================================
+
+#ifndef CH_WORK_QUEUE_H
+#define CH_WORK_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+
+#include "subsys/ChVehicleThreads.h"
+
+#include "runner/ChApiRunner.h"
+#include "runner/ChScenarioRunner.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Coordinator of a batch of scenarios run by ChWorkQueueWorker processes.
+///
+class CH_RUNNER_API ChWorkQueueCoordinator
+{
+public:
+
+  /// Create a coordinator listening on the specified TCP port.
+  ChWorkQueueCoordinator(int port);
+
+  ~ChWorkQueueCoordinator() {}
+
+  /// Set the top-level output directory, on storage shared by the coordinator
+  /// and all the workers, with the same path (default: "SCENARIOS").
+  void SetOutputDirectory(const std::string& dir) { m_out_dir = dir; }
+
+  /// Set the maximum number of attempts of a scenario (default: 3). A
+  /// scenario fails once this number of its attempts failed or expired.
+  void SetMaxAttempts(int num) { m_max_attempts = num; }
+
+  /// Set the lease time of a scenario, i.e. the time without heartbeats after
+  /// which its worker is considered lost (default: 60 s).
+  void SetLeaseTime(double seconds) { m_lease_time = seconds; }
+
+  /// Enable or disable the copies of the longest running scenarios, once the
+  /// queue is empty (default: enabled).
+  void SetDuplicates(bool val) { m_duplicates = val; }
+
+  /// Add the specified scenario to the batch.
+  void AddScenario(const ChScenario& scenario) { m_scenarios.push_back(scenario); }
+
+  /// Add the scenarios listed in the specified JSON file to the batch (see
+  /// ChScenarioRunner::LoadScenarios()).
+  bool LoadScenarios(const std::string& filename);
+
+  /// Get the number of scenarios in the batch.
+  int GetNumScenarios() const { return (int)m_scenarios.size(); }
+
+  /// Serve the batch to the workers until all scenarios completed or failed,
+  /// then write the report. Returns false if the port cannot be opened, the
+  /// output directory cannot be created, or any of the scenarios failed.
+  bool Run();
+
+  /// Get the statistics of the scenarios of the last call to Run().
+  const std::vector<ChScenarioResult>& GetResults() const { return m_results; }
+
+  /// Get the wall-clock time of the last call to Run().
+  double GetWallTime() const { return m_wall_time; }
+
+private:
+
+  enum JobState { PENDING, RUNNING, COMPLETED, FAILED };
+
+  struct Lease {
+    std::string  worker;
+    int          attempt;
+    double       start;
+    double       heartbeat;
+  };
+
+  struct Job {
+    JobState            state;
+    int                 num_attempts;   // number of leases handed out
+    int                 num_failures;   // number of failed or expired leases
+    std::vector<Lease>  leases;         // live leases
+    std::string         worker;         // worker which produced the result
+  };
+
+  ChWorkQueueCoordinator(const ChWorkQueueCoordinator&);
+  ChWorkQueueCoordinator& operator=(const ChWorkQueueCoordinator&);
+
+  // Handle one request, filling in the reply.
+  void handle(const rapidjson::Document& request, rapidjson::Document& reply, double now);
+  void fetch(const std::string& worker, rapidjson::Document& reply, double now);
+  void heartbeat(const std::string& worker, const rapidjson::Value& jobs, rapidjson::Document& reply, double now);
+  void result(const std::string& worker, const rapidjson::Document& request);
+
+  // Handle the end of a lease which did not produce a result.
+  void end_lease(int id, size_t lease);
+
+  // Find a running job to copy for the specified worker (-1 if none).
+  int find_duplicate(const std::string& worker) const;
+
+  // Expire the leases without recent heartbeats.
+  void expire_leases(double now);
+
+  // Write the report of the last batch to the specified file.
+  void write_report(const std::string& filename) const;
+
+  int                            m_port;
+  std::string                    m_out_dir;
+  int                            m_max_attempts;
+  double                         m_lease_time;
+  bool                           m_duplicates;
+  std::vector<ChScenario>        m_scenarios;
+  std::vector<ChScenarioResult>  m_results;
+  std::vector<Job>               m_jobs;
+  std::deque<int>                m_queue;
+  std::map<std::string, int>     m_workers;   // number of results per worker
+  int                            m_num_open;  // number of pending or running jobs
+  int                            m_num_retries;
+  int                            m_num_copies;
+  double                         m_wall_time;
+};
+
+///
+/// Worker process running the scenarios of a ChWorkQueueCoordinator.
+///
+class CH_RUNNER_API ChWorkQueueWorker
+{
+public:
+
+  /// Create a worker connecting to the coordinator on the specified host and
+  /// TCP port, with the specified number of threads. If zero, use the number
+  /// of hardware threads.
+  ChWorkQueueWorker(const std::string& host, int port, int num_threads = 0);
+
+  ~ChWorkQueueWorker() {}
+
+  /// Set the name of the worker, as reported by the coordinator (default:
+  /// host name and process ID).
+  void SetName(const std::string& name) { m_name = name; }
+
+  /// Set the directory of the result cache, relative to the working directory
+  /// (see ChResultCache; default: empty, no cache).
+  void SetResultCache(const std::string& dir) { m_cache_dir = dir; }
+
+  /// Set the time after which an unreachable coordinator is considered lost
+  /// (default: 60 s).
+  void SetRetryTime(double seconds) { m_retry_time = seconds; }
+
+  /// Run scenarios until the coordinator reports the end of the batch.
+  /// Returns false if the coordinator was lost.
+  bool Run();
+
+  /// Get the number of scenarios run by the last call to Run().
+  int GetNumCompleted() const { return m_num_completed; }
+
+  /// Get the number of failed scenarios of the last call to Run().
+  int GetNumFailed() const { return m_num_failed; }
+
+private:
+
+  class Puller : public ChThread {
+  public:
+    Puller(ChWorkQueueWorker* owner) : m_owner(owner) {}
+  protected:
+    virtual void Run() { m_owner->pull_jobs(); }
+  private:
+    ChWorkQueueWorker* m_owner;
+  };
+
+  ChWorkQueueWorker(const ChWorkQueueWorker&);
+  ChWorkQueueWorker& operator=(const ChWorkQueueWorker&);
+
+  // Body of the puller threads.
+  void pull_jobs();
+
+  // Run one job, filling in the result message. Returns false if the job is
+  // invalid.
+  bool run_job(const rapidjson::Document& job, rapidjson::Document& message);
+
+  // Send the heartbeat of the running jobs.
+  void send_heartbeat();
+
+  // Send a request and receive the reply. If requested, retry until the
+  // coordinator is considered lost. Returns false on failure.
+  bool exchange(const rapidjson::Document& request, rapidjson::Document& reply, bool retry);
+
+  std::string          m_host;
+  int                  m_port;
+  int                  m_num_threads;
+  std::string          m_name;
+  std::string          m_cache_dir;
+  double               m_retry_time;
+  std::vector<std::pair<int, int> >  m_running;   // ids and attempts of the running jobs
+  std::map<int, bool>  m_obsolete;   // jobs completed (or failed) elsewhere
+  double               m_lease_time;
+  bool                 m_done;
+  bool                 m_lost;
+  int                  m_num_active;
+  int                  m_num_completed;
+  int                  m_num_failed;
+  ChMutex              m_mutex;      // protects the members above, and GetLog()
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,142 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Change-triggered sampling of rows of output values.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "subsys/ChAdaptiveSampler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChAdaptiveSampler::ChAdaptiveSampler()
+: m_max_gap(0),
+  m_num_last(0),
+  m_has_held(false),
+  m_num_out(0),
+  m_num_offered(0),
+  m_num_emitted(0)
+{
+}
+
+void ChAdaptiveSampler::Initialize(const std::vector<double>& tolerances,
+                                   double                     max_gap)
+{
+  m_tol = tolerances;
+  m_max_gap = max_gap;
+
+  size_t n = m_tol.size();
+  m_prev.resize(n);
+  m_last.resize(n);
+  m_held.resize(n);
+  m_emitted.resize(2 * n);
+
+  Reset();
+}
+
+void ChAdaptiveSampler::Reset()
+{
+  m_num_last = 0;
+  m_has_held = false;
+  m_num_out = 0;
+  m_num_offered = 0;
+  m_num_emitted = 0;
+}
+
+// -----------------------------------------------------------------------------
+// The prediction holds the last emitted value until two rows were emitted.
+// NaN values are always considered deviating.
+// -----------------------------------------------------------------------------
+bool ChAdaptiveSampler::deviates(const double* values) const
+{
+  double dt = (m_num_last > 1) ? m_last[0] - m_prev[0] : 0;
+  double s = (dt > 0) ? (values[0] - m_last[0]) / dt : 0;
+
+  for (size_t k = 1; k < m_tol.size(); k++) {
+    if (m_tol[k] < 0)
+      continue;
+    double predicted = m_last[k] + s * (m_last[k] - m_prev[k]);
+    if (!(std::abs(values[k] - predicted) <= m_tol[k]))
+      return true;
+  }
+
+  return false;
+}
+
+void ChAdaptiveSampler::emit(const double* values)
+{
+  std::copy(values, values + m_tol.size(), m_emitted.begin() + m_num_out * m_tol.size());
+  m_num_out++;
+  m_num_emitted++;
+
+  m_prev.swap(m_last);
+  std::copy(values, values + m_tol.size(), m_last.begin());
+  m_num_last = std::min(m_num_last + 1, 2);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChAdaptiveSampler::Sample(const double* values)
+{
+  m_num_out = 0;
+  m_num_offered++;
+
+  if (m_num_last == 0) {
+    emit(values);
+    return m_num_out;
+  }
+
+  bool trigger = deviates(values) || (m_max_gap > 0 && values[0] - m_last[0] > m_max_gap);
+
+  // Close the current segment with the last row within tolerance, then test
+  // the row against the new extrapolation.
+  if (trigger && m_has_held) {
+    emit(&m_held[0]);
+    m_has_held = false;
+    trigger = deviates(values) || (m_max_gap > 0 && values[0] - m_last[0] > m_max_gap);
+  }
+
+  if (trigger) {
+    emit(values);
+  } else {
+    std::copy(values, values + m_tol.size(), m_held.begin());
+    m_has_held = true;
+  }
+
+  return m_num_out;
+}
+
+int ChAdaptiveSampler::Finish()
+{
+  m_num_out = 0;
+
+  if (m_has_held) {
+    emit(&m_held[0]);
+    m_has_held = false;
+  }
+
+  return m_num_out;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
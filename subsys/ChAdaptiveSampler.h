@@ -0,0 +1,109 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Change-triggered sampling of rows of output values.
+//
+// The first column of each row is the abscissa (time); every row is offered to
+// the sampler, which emits only the rows needed to reconstruct the signals by
+// linear interpolation. A row is held back as long as all its values are
+// within their tolerance of the linear extrapolation of the last two emitted
+// rows. When a row deviates, the last row held back (which was still within
+// tolerance) is emitted, closing the current segment, and the deviating row is
+// tested again against the new extrapolation. Hence, between two emitted rows
+// the values interpolated linearly are within twice the tolerance of the
+// values offered. In addition, a row is emitted if the abscissa gap since the
+// last emitted row would exceed a maximum gap.
+//
+// =============================================================================
+
+#ifndef CH_ADAPTIVE_SAMPLER_H
+#define CH_ADAPTIVE_SAMPLER_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Adaptive sampler of rows of doubles, the first column being the abscissa.
+///
+class CH_SUBSYS_API ChAdaptiveSampler
+{
+public:
+
+  ChAdaptiveSampler();
+
+  /// Set the tolerances, one per column (the tolerance of the first column is
+  /// not used; a negative tolerance excludes a column from the test), and the
+  /// maximum abscissa gap between emitted rows (0: no limit). Resets the
+  /// sampler.
+  void Initialize(
+    const std::vector<double>& tolerances,  ///< [in] absolute tolerance of each column
+    double                     max_gap = 0  ///< [in] maximum gap between emitted rows
+    );
+
+  /// Get the number of columns.
+  int GetNumColumns() const { return (int)m_tol.size(); }
+
+  /// Forget all rows offered so far.
+  void Reset();
+
+  /// Offer a row with GetNumColumns() values. Returns the number of rows
+  /// emitted (0, 1 or 2), available through GetRow() until the next call.
+  int Sample(const double* values);
+
+  /// Emit the last row held back, if any (e.g. before closing the output).
+  /// Returns the number of rows emitted (0 or 1).
+  int Finish();
+
+  /// Get the specified row emitted by the last call to Sample() or Finish().
+  const double* GetRow(int i) const { return &m_emitted[i * m_tol.size()]; }
+
+  /// Get the total number of rows offered and emitted.
+  size_t GetNumOffered() const { return m_num_offered; }
+  size_t GetNumEmitted() const { return m_num_emitted; }
+
+private:
+
+  // Return true if the specified row deviates from the extrapolation.
+  bool deviates(const double* values) const;
+
+  // Emit the specified row.
+  void emit(const double* values);
+
+  std::vector<double>  m_tol;
+  double               m_max_gap;
+
+  std::vector<double>  m_prev;        // second to last emitted row
+  std::vector<double>  m_last;        // last emitted row
+  std::vector<double>  m_held;        // last row held back
+  int                  m_num_last;    // number of emitted rows kept (0, 1 or 2)
+  bool                 m_has_held;
+
+  std::vector<double>  m_emitted;     // rows emitted by the last call
+  int                  m_num_out;
+
+  size_t               m_num_offered;
+  size_t               m_num_emitted;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
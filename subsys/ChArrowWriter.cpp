@@ -0,0 +1,376 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Minimal writer of Apache Arrow IPC files with double columns.
+//
+// The Arrow metadata (schema, record batch headers and file footer) are
+// flatbuffers; the few tables needed here are encoded by a small forward
+// builder, which writes every object before the objects it refers to (such
+// that all offsets point forward, as required by the flatbuffer format).
+//
+// =============================================================================
+
+#include <cstring>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChArrowWriter.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+static const char ARROW_MAGIC[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+typedef unsigned int uint32;
+typedef long long int64;
+
+// Values of the Arrow enumerations and unions used here (see the Arrow
+// format definitions Schema.fbs, Message.fbs and File.fbs).
+enum {
+  ARROW_METADATA_V5 = 4,
+  ARROW_TYPE_FLOATING_POINT = 3,
+  ARROW_PRECISION_DOUBLE = 2,
+  ARROW_HEADER_SCHEMA = 1,
+  ARROW_HEADER_RECORD_BATCH = 3
+};
+
+// -----------------------------------------------------------------------------
+// Forward flatbuffer builder.
+// -----------------------------------------------------------------------------
+class FlatBuilder
+{
+public:
+  // The buffer starts with the offset to the root table (see SetRoot()).
+  FlatBuilder() : m_data(4, 0) {}
+
+  const std::vector<unsigned char>& GetData() const { return m_data; }
+
+  // Store a scalar at the specified position.
+  template <typename T>
+  void Put(size_t pos, T value) { memcpy(&m_data[pos], &value, sizeof(T)); }
+
+  // Point the offset field at the specified position to the object at the
+  // target position (which must come after the field).
+  void Link(size_t pos, size_t target) { Put<uint32>(pos, (uint32)(target - pos)); }
+
+  void SetRoot(size_t table) { Link(0, table); }
+
+  // Add a table with the specified fields, given by their inline size (1, 2, 4
+  // or 8 bytes; 0 if the field is absent). The fields are laid out in order,
+  // each aligned to its size, and their positions are returned in 'fields'.
+  // Returns the position of the table.
+  size_t AddTable(int num_fields, const int* sizes, size_t* fields)
+  {
+    // vtable: vtable size, table size, field offsets within the table
+    size_t vtable = Reserve(4 + 2 * num_fields, 2);
+
+    size_t size = 4;   // offset to the vtable
+    for (int i = 0; i < num_fields; i++) {
+      if (sizes[i] == 0)
+        continue;
+      size = (size + sizes[i] - 1) / sizes[i] * sizes[i];
+      fields[i] = size;
+      size += sizes[i];
+    }
+
+    size_t table = Reserve(size, 8);
+
+    Put<unsigned short>(vtable, (unsigned short)(4 + 2 * num_fields));
+    Put<unsigned short>(vtable + 2, (unsigned short)size);
+    for (int i = 0; i < num_fields; i++) {
+      Put<unsigned short>(vtable + 4 + 2 * i, (unsigned short)(sizes[i] ? fields[i] : 0));
+      if (sizes[i])
+        fields[i] += table;
+    }
+    Put<int>(table, (int)(table - vtable));
+
+    return table;
+  }
+
+  // Add a vector of the specified number of elements. Returns the position of
+  // the first element.
+  size_t AddVector(size_t count, int elem_size, int elem_align)
+  {
+    int align = elem_align > 4 ? elem_align : 4;
+    while ((m_data.size() + 4) % align != 0)
+      m_data.push_back(0);
+    size_t pos = m_data.size();
+    m_data.resize(pos + 4 + count * elem_size, 0);
+    Put<uint32>(pos, (uint32)count);
+    return pos + 4;
+  }
+
+  // Add a string. Returns its position.
+  size_t AddString(const std::string& s)
+  {
+    size_t pos = Reserve(4 + s.size() + 1, 4);
+    Put<uint32>(pos, (uint32)s.size());
+    if (!s.empty())
+      memcpy(&m_data[pos + 4], s.data(), s.size());
+    return pos;
+  }
+
+  // Pad the buffer to a multiple of the specified size.
+  void Pad(size_t align)
+  {
+    while (m_data.size() % align != 0)
+      m_data.push_back(0);
+  }
+
+private:
+  size_t Reserve(size_t size, size_t align)
+  {
+    Pad(align);
+    size_t pos = m_data.size();
+    m_data.resize(pos + size, 0);
+    return pos;
+  }
+
+  std::vector<unsigned char> m_data;
+};
+
+// -----------------------------------------------------------------------------
+// Schema table: one non-nullable double field per column. The field at the
+// specified position is linked to the new table.
+// -----------------------------------------------------------------------------
+static short hostEndianness()
+{
+  const unsigned short one = 1;
+  return (*(const unsigned char*)&one == 1) ? 0 : 1;   // Little, Big
+}
+
+static void addSchema(FlatBuilder& fb, size_t link_pos, const std::vector<std::string>& names)
+{
+  // Schema: endianness, fields
+  int schema_sizes[2] = {2, 4};
+  size_t schema_fields[2];
+  size_t schema = fb.AddTable(2, schema_sizes, schema_fields);
+  fb.Link(link_pos, schema);
+  fb.Put<short>(schema_fields[0], hostEndianness());
+
+  size_t field_vector = fb.AddVector(names.size(), 4, 4);
+  fb.Link(schema_fields[1], field_vector - 4);
+
+  for (size_t k = 0; k < names.size(); k++) {
+    // Field: name, nullable, type_type, type, dictionary, children
+    int sizes[6] = {4, 1, 1, 4, 0, 4};
+    size_t fields[6];
+    size_t field = fb.AddTable(6, sizes, fields);
+    fb.Link(field_vector + 4 * k, field);
+    fb.Put<unsigned char>(fields[1], 0);
+    fb.Put<unsigned char>(fields[2], ARROW_TYPE_FLOATING_POINT);
+
+    fb.Link(fields[0], fb.AddString(names[k]));
+
+    // FloatingPoint: precision
+    int fp_sizes[1] = {2};
+    size_t fp_fields[1];
+    size_t fp = fb.AddTable(1, fp_sizes, fp_fields);
+    fb.Put<short>(fp_fields[0], ARROW_PRECISION_DOUBLE);
+    fb.Link(fields[3], fp);
+
+    size_t children = fb.AddVector(0, 4, 4);
+    fb.Link(fields[5], children - 4);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Message table with the specified header type. Returns the position of the
+// header field, to be linked to the header table.
+// -----------------------------------------------------------------------------
+static size_t addMessage(FlatBuilder& fb, unsigned char header_type, int64 body_length)
+{
+  // Message: version, header_type, header, bodyLength
+  int sizes[4] = {2, 1, 4, 8};
+  size_t fields[4];
+  size_t message = fb.AddTable(4, sizes, fields);
+  fb.SetRoot(message);
+  fb.Put<short>(fields[0], ARROW_METADATA_V5);
+  fb.Put<unsigned char>(fields[1], header_type);
+  fb.Put<int64>(fields[3], body_length);
+
+  return fields[2];
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChArrowWriter::Open(ChCompressedFile*               file,
+                         const std::vector<std::string>& names)
+{
+  m_file = file;
+  m_offset = 0;
+  m_names = names;
+  m_batches.clear();
+
+  if (!write(ARROW_MAGIC, sizeof(ARROW_MAGIC)))
+    return false;
+
+  FlatBuilder fb;
+  size_t header = addMessage(fb, ARROW_HEADER_SCHEMA, 0);
+  addSchema(fb, header, m_names);
+
+  Block block;
+  return writeMessage(fb.GetData(), 0, 0, block);
+}
+
+bool ChArrowWriter::WriteBatch(const double* values,
+                               size_t        num_rows)
+{
+  if (!m_file)
+    return false;
+
+  size_t num_columns = m_names.size();
+  int64 column_size = (int64)(num_rows * sizeof(double));
+
+  FlatBuilder fb;
+  size_t header = addMessage(fb, ARROW_HEADER_RECORD_BATCH, column_size * num_columns);
+
+  // RecordBatch: length, nodes, buffers
+  int sizes[3] = {8, 4, 4};
+  size_t fields[3];
+  size_t batch = fb.AddTable(3, sizes, fields);
+  fb.Link(header, batch);
+  fb.Put<int64>(fields[0], (int64)num_rows);
+
+  // FieldNode structs: length, null count
+  size_t nodes = fb.AddVector(num_columns, 16, 8);
+  fb.Link(fields[1], nodes - 4);
+  for (size_t k = 0; k < num_columns; k++) {
+    fb.Put<int64>(nodes + 16 * k, (int64)num_rows);
+    fb.Put<int64>(nodes + 16 * k + 8, 0);
+  }
+
+  // Buffer structs (offset, length): an empty validity bitmap and the values
+  // of each column. The columns are contiguous in the body.
+  size_t buffers = fb.AddVector(2 * num_columns, 16, 8);
+  fb.Link(fields[2], buffers - 4);
+  for (size_t k = 0; k < num_columns; k++) {
+    fb.Put<int64>(buffers + 32 * k, column_size * k);
+    fb.Put<int64>(buffers + 32 * k + 8, 0);
+    fb.Put<int64>(buffers + 32 * k + 16, column_size * k);
+    fb.Put<int64>(buffers + 32 * k + 24, column_size);
+  }
+
+  Block block;
+  if (!writeMessage(fb.GetData(), values, num_rows * num_columns * sizeof(double), block))
+    return false;
+
+  m_batches.push_back(block);
+  return true;
+}
+
+bool ChArrowWriter::Finish()
+{
+  if (!m_file)
+    return false;
+
+  // End of stream
+  uint32 eos[2] = {0xFFFFFFFF, 0};
+  if (!write(eos, sizeof(eos)))
+    return false;
+
+  // Footer: version, schema, dictionaries, recordBatches
+  FlatBuilder fb;
+  int sizes[4] = {2, 4, 4, 4};
+  size_t fields[4];
+  size_t footer = fb.AddTable(4, sizes, fields);
+  fb.SetRoot(footer);
+  fb.Put<short>(fields[0], ARROW_METADATA_V5);
+
+  addSchema(fb, fields[1], m_names);
+
+  size_t dictionaries = fb.AddVector(0, 24, 8);
+  fb.Link(fields[2], dictionaries - 4);
+
+  // Block structs: offset, metaDataLength (padded to 8 bytes), bodyLength
+  size_t blocks = fb.AddVector(m_batches.size(), 24, 8);
+  fb.Link(fields[3], blocks - 4);
+  for (size_t i = 0; i < m_batches.size(); i++) {
+    fb.Put<int64>(blocks + 24 * i, m_batches[i].offset);
+    fb.Put<int>(blocks + 24 * i + 8, m_batches[i].meta_length);
+    fb.Put<int64>(blocks + 24 * i + 16, m_batches[i].body_length);
+  }
+
+  fb.Pad(8);
+  const std::vector<unsigned char>& data = fb.GetData();
+  int footer_length = (int)data.size();
+
+  bool ok = write(&data[0], data.size()) && write(&footer_length, sizeof(int)) && write(ARROW_MAGIC, 6);
+
+  m_file = 0;
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChArrowWriter::write(const void* data, size_t size)
+{
+  if (size > 0 && !m_file->Write(data, size)) {
+    GetLog() << "ERROR: cannot write the Arrow output file\n";
+    return false;
+  }
+  m_offset += size;
+  return true;
+}
+
+bool ChArrowWriter::writeMessage(const std::vector<unsigned char>& metadata,
+                                 const double*                     body,
+                                 size_t                            body_size,
+                                 Block&                            block)
+{
+  static const unsigned char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  size_t padding = (8 - metadata.size() % 8) % 8;
+  int meta_length = (int)(metadata.size() + padding);
+  uint32 continuation = 0xFFFFFFFF;
+
+  block.offset = m_offset;
+  block.meta_length = 8 + meta_length;
+  block.body_length = (long long)body_size;
+
+  return write(&continuation, sizeof(uint32)) &&
+         write(&meta_length, sizeof(int)) &&
+         write(&metadata[0], metadata.size()) &&
+         write(zeros, padding) &&
+         write(body, body_size);
+}
+
+size_t ChArrowWriter::GetMemoryFootprint() const
+{
+  size_t bytes = ChMemoryReport::VectorBytes(m_names) + ChMemoryReport::VectorBytes(m_batches);
+  for (size_t i = 0; i < m_names.size(); i++)
+    bytes += ChMemoryReport::StringBytes(m_names[i]);
+
+  return bytes;
+}
+
+std::vector<std::string> ChArrowWriter::SplitHeader(const std::string& header)
+{
+  std::vector<std::string> names;
+  size_t start = 0;
+  while (true) {
+    size_t comma = header.find(',', start);
+    names.push_back(header.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+    if (comma == std::string::npos)
+      break;
+    start = comma + 1;
+  }
+  return names;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,102 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Minimal writer of Apache Arrow IPC files (the Feather V2 format) with double
+// columns, without dependency on the Arrow libraries.
+//
+// The file holds the schema (one non-nullable float64 field per column) and
+// one record batch per call to WriteBatch(), each column stored as a
+// contiguous array of doubles. Such files are read directly by pandas
+// (pandas.read_feather) or memory-mapped by pyarrow
+// (pyarrow.ipc.open_file(pyarrow.memory_map(name))) without parsing.
+// The values are stored in the native byte order, as declared in the schema.
+//
+// =============================================================================
+
+#ifndef CH_ARROW_WRITER_H
+#define CH_ARROW_WRITER_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChCompressedFile.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Writer of Arrow IPC files with double columns.
+///
+class CH_SUBSYS_API ChArrowWriter
+{
+public:
+
+  ChArrowWriter() : m_file(0), m_offset(0) {}
+
+  /// Start an Arrow file in the specified (open, binary) file: write the file
+  /// magic and the schema with the specified column names. If the file is
+  /// compressed, it must be decompressed before it can be memory-mapped.
+  /// Returns false if the file cannot be written.
+  bool Open(
+    ChCompressedFile*               file,    ///< [in] output file, positioned at its start
+    const std::vector<std::string>& names    ///< [in] column names
+    );
+
+  /// Write one record batch. The values are given column-major, i.e. all rows
+  /// of the first column, then all rows of the second column, etc.
+  bool WriteBatch(
+    const double* values,   ///< [in] num_rows * (number of columns) values
+    size_t        num_rows  ///< [in] number of rows in this batch
+    );
+
+  /// Write the end-of-stream marker and the file footer. The file itself is
+  /// not closed.
+  bool Finish();
+
+  /// Return the heap memory used by the column names and the index of the
+  /// record batches written so far, in bytes.
+  size_t GetMemoryFootprint() const;
+
+  /// Split a CSV header line into column names.
+  static std::vector<std::string> SplitHeader(const std::string& header);
+
+private:
+
+  struct Block {
+    long long offset;
+    int       meta_length;
+    long long body_length;
+  };
+
+  // Write bytes and keep track of the file offset.
+  bool write(const void* data, size_t size);
+
+  // Write an encapsulated message (continuation marker, length, metadata
+  // padded to 8 bytes), followed by the message body.
+  bool writeMessage(const std::vector<unsigned char>& metadata, const double* body, size_t body_size, Block& block);
+
+  ChCompressedFile*         m_file;
+  long long                 m_offset;
+  std::vector<std::string>  m_names;
+  std::vector<Block>        m_batches;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,163 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Kinematic bicycle model of a vehicle.
+//
+// =============================================================================
+
+#include <cmath>
+
+#include "subsys/ChBicycleModel.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// Below this speed, the wheel and driveshaft speeds are not scaled with the
+// forward speed.
+static const double MIN_SCALING_SPEED = 0.1;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChBicycleModel::ChBicycleModel()
+: m_max_steering(0.5),
+  m_max_accel(3),
+  m_max_decel(8),
+  m_x(0),
+  m_y(0),
+  m_yaw(0),
+  m_v(0),
+  m_yaw_rate(0),
+  m_wheelbase(1),
+  m_v0(0),
+  m_driveshaft0(0)
+{
+}
+
+void ChBicycleModel::Initialize(const ChVehicle& vehicle)
+{
+  int num_axles = vehicle.GetNumberAxles();
+  int num_wheels = 2 * num_axles;
+
+  ChVector<> front = (vehicle.GetWheelPos(0) + vehicle.GetWheelPos(1)) * 0.5;
+  ChVector<> rear = (vehicle.GetWheelPos(num_wheels - 2) + vehicle.GetWheelPos(num_wheels - 1)) * 0.5;
+
+  const ChVector<>& pos = vehicle.GetChassisPos();
+  const ChQuaternion<>& rot = vehicle.GetChassisRot();
+
+  ChVector<> heading = rot.Rotate(VECT_X);
+  m_yaw = std::atan2(heading.y, heading.x);
+  double c = std::cos(m_yaw);
+  double s = std::sin(m_yaw);
+
+  ChVector<> axle = front - rear;
+  m_wheelbase = std::sqrt(axle.x * axle.x + axle.y * axle.y);
+
+  m_x = rear.x;
+  m_y = rear.y;
+  m_offset = ChVector<>(c * (pos.x - rear.x) + s * (pos.y - rear.y),
+                        -s * (pos.x - rear.x) + c * (pos.y - rear.y),
+                        pos.z);
+  m_tilt = Q_from_AngZ(-m_yaw) * rot;
+
+  const ChVector<>& vel = vehicle.GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt();
+  m_v = vel.x * c + vel.y * s;
+  if (m_v < 0)
+    m_v = 0;
+  m_yaw_rate = vehicle.GetChassisBody()->GetWvel_par().z;
+
+  m_v0 = m_v;
+  m_driveshaft0 = vehicle.GetDriveshaftSpeed();
+
+  m_omega0.resize(num_wheels);
+  m_radius.resize(num_wheels);
+  for (int i = 0; i < num_wheels; i++) {
+    m_omega0[i] = vehicle.GetWheelOmega(i);
+    m_radius[i] = vehicle.GetWheel(i)->GetRadius();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChBicycleModel::Advance(double step, double steering, double throttle, double braking)
+{
+  m_v += (m_max_accel * throttle - m_max_decel * braking) * step;
+  if (m_v < 0)
+    m_v = 0;
+
+  m_yaw_rate = m_v * std::tan(steering * m_max_steering) / m_wheelbase;
+
+  m_x += m_v * std::cos(m_yaw) * step;
+  m_y += m_v * std::sin(m_yaw) * step;
+  m_yaw += m_yaw_rate * step;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChCoordsys<> ChBicycleModel::GetChassisPos() const
+{
+  double c = std::cos(m_yaw);
+  double s = std::sin(m_yaw);
+
+  ChVector<> pos(m_x + c * m_offset.x - s * m_offset.y,
+                 m_y + s * m_offset.x + c * m_offset.y,
+                 m_offset.z);
+  ChQuaternion<> rot = Q_from_AngZ(m_yaw) * m_tilt;
+  rot.Normalize();
+
+  return ChCoordsys<>(pos, rot);
+}
+
+ChVector<> ChBicycleModel::GetChassisLinVel() const
+{
+  double c = std::cos(m_yaw);
+  double s = std::sin(m_yaw);
+
+  // Velocity of the rear axle center plus yaw_rate x (offset, in global frame)
+  return ChVector<>(m_v * c - m_yaw_rate * (s * m_offset.x + c * m_offset.y),
+                    m_v * s + m_yaw_rate * (c * m_offset.x - s * m_offset.y),
+                    0);
+}
+
+double ChBicycleModel::speed_ratio() const
+{
+  return (m_v0 > MIN_SCALING_SPEED) ? m_v / m_v0 : 1;
+}
+
+double ChBicycleModel::GetWheelOmega(int wheel) const
+{
+  if (m_radius[wheel] > 0)
+    return m_v / m_radius[wheel];
+  return m_omega0[wheel] * speed_ratio();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChBicycleModel::Apply(ChVehicle& vehicle, double time) const
+{
+  int num_wheels = 2 * vehicle.GetNumberAxles();
+  std::vector<double> wheel_omega(num_wheels);
+  for (int i = 0; i < num_wheels; i++)
+    wheel_omega[i] = GetWheelOmega(i);
+
+  vehicle.GetSystem()->SetChTime(time);
+  vehicle.SetMotion(GetChassisPos(), GetChassisLinVel(), GetChassisAngVel(), wheel_omega);
+  vehicle.GetDriveshaft()->SetPos_dt(m_driveshaft0 * speed_ratio());
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,129 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Kinematic bicycle model of a vehicle, used as the lowest fidelity level of
+// ChVehicleSimulation.
+//
+// The model is initialized from the current state of a vehicle and tracks the
+// center of its rear axle, which moves in the horizontal plane with the
+// heading of the chassis:
+//    x' = v cos(yaw),  y' = v sin(yaw),  yaw' = v tan(delta) / L
+//    v' = a_max * throttle - b_max * braking   (v >= 0)
+// where L is the wheelbase (distance between the first and last axle) and the
+// front wheel angle delta is proportional to the steering input. The height,
+// roll and pitch of the chassis, and the position of the chassis reference
+// frame relative to the rear axle, are frozen at initialization. The state can
+// be transferred back to the vehicle with Apply().
+//
+// =============================================================================
+
+#ifndef CH_BICYCLE_MODEL_H
+#define CH_BICYCLE_MODEL_H
+
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "core/ChCoordsys.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Kinematic bicycle model of a vehicle.
+///
+class CH_SUBSYS_API ChBicycleModel
+{
+public:
+
+  ChBicycleModel();
+
+  /// Set the front wheel angle for a steering input of +1 (default: 0.5 rad).
+  /// A positive angle yaws the vehicle to the left.
+  void SetMaxSteeringAngle(double angle) { m_max_steering = angle; }
+
+  /// Set the longitudinal acceleration at full throttle (default: 3 m/s^2).
+  void SetMaxAcceleration(double accel) { m_max_accel = accel; }
+
+  /// Set the longitudinal deceleration at full braking (default: 8 m/s^2).
+  void SetMaxDeceleration(double decel) { m_max_decel = decel; }
+
+  /// Initialize the model from the current state of the specified vehicle.
+  void Initialize(const ChVehicle& vehicle);
+
+  /// Advance the model by the specified step, with the specified driver inputs.
+  void Advance(
+    double step,        ///< [in] time step
+    double steering,    ///< [in] steering input [-1,+1]
+    double throttle,    ///< [in] throttle input [0,1]
+    double braking      ///< [in] braking input [0,1]
+    );
+
+  /// Set the state of the specified vehicle (the one used to initialize the
+  /// model, or another model of the same vehicle) from the state of this model,
+  /// at the specified time.
+  void Apply(ChVehicle& vehicle, double time) const;
+
+  /// Get the forward speed.
+  double GetSpeed() const { return m_v; }
+
+  /// Get the global position and orientation of the chassis reference frame.
+  ChCoordsys<> GetChassisPos() const;
+
+  /// Get the global velocity of the chassis reference frame origin.
+  ChVector<> GetChassisLinVel() const;
+
+  /// Get the global angular velocity of the chassis.
+  ChVector<> GetChassisAngVel() const { return ChVector<>(0, 0, m_yaw_rate); }
+
+  /// Get the angular speed of the specified wheel.
+  double GetWheelOmega(int wheel) const;
+
+private:
+
+  // Ratio of the current speed to the speed at initialization (1 if the
+  // vehicle was initialized at very low speed).
+  double speed_ratio() const;
+
+  double          m_max_steering;
+  double          m_max_accel;
+  double          m_max_decel;
+
+  // Rear axle center, heading, forward speed and yaw rate
+  double          m_x;
+  double          m_y;
+  double          m_yaw;
+  double          m_v;
+  double          m_yaw_rate;
+
+  // Frozen at initialization
+  double          m_wheelbase;
+  ChVector<>      m_offset;          // chassis reference relative to the rear axle (heading frame, z: height)
+  ChQuaternion<>  m_tilt;            // chassis orientation relative to the heading frame
+  double          m_v0;              // forward speed
+  double          m_driveshaft0;     // driveshaft speed
+  std::vector<double>  m_omega0;     // wheel angular speeds
+  std::vector<double>  m_radius;     // wheel radii (0 if unknown)
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
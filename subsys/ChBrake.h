@@ -25,6 +25,7 @@
 #include "physics/ChLinkLock.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysHeap.h"
 
 namespace chrono {
 
@@ -38,6 +39,10 @@ public:
   ChBrake();
   virtual ~ChBrake() {}
 
+  /// Allocate subsystem objects from the contiguous subsystem heap.
+  static void* operator new(size_t size) { return vehicle::ChSubsysHeap::Allocate(size); }
+  static void operator delete(void* ptr) { vehicle::ChSubsysHeap::Free(ptr); }
+
   /// Initialize the brake by providing the wheel's revolute link.
   virtual void Initialize(ChSharedPtr<ChLinkLockRevolute> hub) = 0;
 
@@ -49,6 +54,10 @@ public:
 
   /// Get the current brake torque.
   virtual double GetBrakeTorque() = 0;
+
+  /// Get the current brake angular speed, relative between disc and caliper.
+  /// The power dissipated by the brake is the product of its torque and speed.
+  virtual double GetBrakeSpeed() = 0;
 };
 
 
@@ -0,0 +1,126 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Background writer of checkpoint files.
+//
+// =============================================================================
+
+#include <cstdio>
+
+#include "subsys/ChCheckpointWriter.h"
+#include "subsys/ChMappedFile.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+ChCheckpointWriter::ChCheckpointWriter()
+: m_has_pending(false),
+  m_stop(false),
+  m_error(false),
+  m_num_written(0),
+  m_num_skipped(0),
+  m_writer(this)
+{
+}
+
+ChCheckpointWriter::~ChCheckpointWriter()
+{
+  Stop();
+}
+
+bool ChCheckpointWriter::Start(const std::string& filename)
+{
+  Stop();
+
+  m_filename = filename;
+  m_has_pending = false;
+  m_stop = false;
+  m_error = false;
+  m_num_written = 0;
+  m_num_skipped = 0;
+
+  return m_writer.Start();
+}
+
+void ChCheckpointWriter::Submit(ChVehicleState& snapshot)
+{
+  ChScopedLock lock(m_mutex);
+
+  if (m_has_pending)
+    m_num_skipped++;
+  m_pending.Swap(snapshot);
+  m_has_pending = true;
+  m_cond.Signal();
+}
+
+bool ChCheckpointWriter::Stop()
+{
+  if (!m_writer.IsRunning())
+    return !m_error;
+
+  m_mutex.Lock();
+  m_stop = true;
+  m_cond.Signal();
+  m_mutex.Unlock();
+
+  m_writer.Join();
+
+  return !m_error;
+}
+
+// -----------------------------------------------------------------------------
+// The pending snapshot is taken by swapping buffers, so that the simulation
+// thread can submit the next one while the current one is written.
+// -----------------------------------------------------------------------------
+void ChCheckpointWriter::write_snapshots()
+{
+  while (true) {
+    m_mutex.Lock();
+    while (!m_has_pending && !m_stop)
+      m_cond.Wait(m_mutex);
+    if (!m_has_pending) {
+      m_mutex.Unlock();
+      break;
+    }
+    m_current.Swap(m_pending);
+    m_has_pending = false;
+    m_mutex.Unlock();
+
+    if (write(m_current))
+      m_num_written++;
+    else
+      m_error = true;
+  }
+}
+
+bool ChCheckpointWriter::write(const ChVehicleState& snapshot) const
+{
+  // The temporary file name is unique per node, process and thread, such that
+  // two writers of the same checkpoint (e.g. a requeued job and the one it
+  // replaces) never write into the same file.
+  std::string tmp_filename = m_filename + ChTempFileSuffix(&snapshot);
+
+  if (!snapshot.WriteFile(tmp_filename)) {
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return ChReplaceFile(tmp_filename, m_filename);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,110 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Background writer of checkpoint files, for resuming long simulations that
+// may be killed (e.g. preempted batch jobs).
+//
+// The simulation thread takes a snapshot of its state in memory (see
+// ChVehicleState) and hands it to the writer thread with Submit(), by swapping
+// buffers; it never waits for the disk. If the previous snapshot is still
+// being written, the pending one is replaced, so that at most two snapshots
+// are held and only the latest one is written. Each snapshot is written to a
+// temporary file, then renamed over the checkpoint file, so that the file
+// always holds a complete snapshot (see ChVehicleState::ReadFile()).
+//
+// =============================================================================
+
+#ifndef CH_CHECKPOINT_WRITER_H
+#define CH_CHECKPOINT_WRITER_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Asynchronous writer of the checkpoints of a simulation.
+///
+class CH_SUBSYS_API ChCheckpointWriter
+{
+public:
+
+  ChCheckpointWriter();
+
+  /// Stop the writer thread, if running (see Stop()).
+  ~ChCheckpointWriter();
+
+  /// Start the writer thread, writing the checkpoints to the specified file.
+  /// Returns false if the thread cannot be started.
+  bool Start(const std::string& filename);
+
+  /// Hand the specified snapshot to the writer thread. The argument receives
+  /// an older snapshot (or is left empty), to be cleared and reused.
+  void Submit(ChVehicleState& snapshot);
+
+  /// Wait until the pending snapshot (if any) is written, then stop the writer
+  /// thread. Returns false if any snapshot could not be written.
+  bool Stop();
+
+  /// Get the number of snapshots written (after Stop()).
+  int GetNumWritten() const { return m_num_written; }
+
+  /// Get the number of snapshots replaced before they were written (after
+  /// Stop()).
+  int GetNumSkipped() const { return m_num_skipped; }
+
+private:
+
+  class Writer : public ChThread {
+  public:
+    Writer(ChCheckpointWriter* owner) : m_owner(owner) {}
+  protected:
+    virtual void Run() { m_owner->write_snapshots(); }
+  private:
+    ChCheckpointWriter* m_owner;
+  };
+
+  ChCheckpointWriter(const ChCheckpointWriter&);
+  ChCheckpointWriter& operator=(const ChCheckpointWriter&);
+
+  // Body of the writer thread.
+  void write_snapshots();
+
+  // Write the snapshot to a temporary file, and rename it.
+  bool write(const ChVehicleState& snapshot) const;
+
+  std::string     m_filename;
+  ChVehicleState  m_pending;   // snapshot to be written (protected by m_mutex)
+  ChVehicleState  m_current;   // snapshot being written (writer thread only)
+  bool            m_has_pending;
+  bool            m_stop;
+  bool            m_error;
+  int             m_num_written;
+  int             m_num_skipped;
+  ChMutex         m_mutex;
+  ChCondition     m_cond;
+  Writer          m_writer;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,70 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory column store for recorded simulation data.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "subsys/ChColumnStore.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChColumnStore::Reset(const std::string& header,
+                          size_t             reserve_rows)
+{
+  m_header = header;
+
+  int num_columns = (int)std::count(header.begin(), header.end(), ',') + 1;
+
+  m_columns.clear();
+  m_columns.resize(num_columns);
+  for (int k = 0; k < num_columns; k++)
+    m_columns[k].reserve(reserve_rows);
+}
+
+// -----------------------------------------------------------------------------
+// The rows are handed to an output channel, which writes them in chunks from
+// its own thread.
+// -----------------------------------------------------------------------------
+bool ChColumnStore::Write(const std::string&      filename,
+                          ChOutputChannel::Format format) const
+{
+  ChOutputChannel channel(4096);
+
+  if (!channel.Open(filename, m_header, format))
+    return false;
+
+  size_t num_rows = GetNumRows();
+  std::vector<double> row(m_columns.size());
+  for (size_t i = 0; i < num_rows; i++) {
+    for (size_t k = 0; k < m_columns.size(); k++)
+      row[k] = m_columns[k][i];
+    channel.Write(&row[0]);
+  }
+
+  channel.Close();
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
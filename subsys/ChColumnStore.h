@@ -0,0 +1,100 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory column store for recorded simulation data.
+//
+// Rows of a fixed set of double columns are appended during the simulation,
+// without any formatting, into columns preallocated for the expected number of
+// rows. The whole store is written once, at the end of the run, in any of the
+// ChOutputChannel file formats.
+//
+// =============================================================================
+
+#ifndef CH_COLUMN_STORE_H
+#define CH_COLUMN_STORE_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChOutputChannel.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Column store of recorded data.
+///
+class CH_SUBSYS_API ChColumnStore
+{
+public:
+
+  ChColumnStore() {}
+
+  /// Discard all data and define new columns, given as a CSV header line
+  /// (column names separated by commas). Storage is reserved for the specified
+  /// number of rows.
+  void Reset(
+    const std::string& header,          ///< [in] CSV header line
+    size_t             reserve_rows = 0 ///< [in] expected number of rows
+    );
+
+  /// Get the CSV header line.
+  const std::string& GetHeader() const { return m_header; }
+
+  /// Get the number of columns.
+  int GetNumColumns() const { return (int)m_columns.size(); }
+
+  /// Get the number of rows recorded so far.
+  size_t GetNumRows() const { return m_columns.empty() ? 0 : m_columns[0].size(); }
+
+  /// Append a row. The array must contain GetNumColumns() values.
+  void Append(const double* values)
+  {
+    for (size_t k = 0; k < m_columns.size(); k++)
+      m_columns[k].push_back(values[k]);
+  }
+
+  /// Get the values of the specified column.
+  const std::vector<double>& GetColumn(int column) const { return m_columns[column]; }
+
+  /// Return the heap memory used by the recorded rows, in bytes.
+  size_t GetMemoryFootprint() const
+  {
+    size_t bytes = m_header.capacity() + 1 + m_columns.capacity() * sizeof(std::vector<double>);
+    for (size_t k = 0; k < m_columns.size(); k++)
+      bytes += m_columns[k].capacity() * sizeof(double);
+    return bytes;
+  }
+
+  /// Write all rows to the specified file. Returns false if the file cannot be
+  /// opened for writing.
+  bool Write(
+    const std::string&      filename,                    ///< [in] name of the output file
+    ChOutputChannel::Format format = ChOutputChannel::CSV///< [in] output file format
+    ) const;
+
+private:
+
+  std::string                        m_header;
+  std::vector<std::vector<double> >  m_columns;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
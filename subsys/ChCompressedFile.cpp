@@ -0,0 +1,544 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Streaming compression of output files.
+//
+// =============================================================================
+
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChCompressedFile.h"
+
+#if LZ4_ENABLED
+#include <lz4frame.h>
+#endif
+#if ZSTD_ENABLED
+#include <zstd.h>
+#endif
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// Frame magic numbers, as stored in the files (little-endian).
+static const unsigned char LZ4_MAGIC[4] = {0x04, 0x22, 0x4D, 0x18};
+static const unsigned char ZSTD_MAGIC[4] = {0x28, 0xB5, 0x2F, 0xFD};
+
+#if LZ4_ENABLED
+// LZ4 contexts and frame preferences.
+struct Lz4Context {
+  LZ4F_cctx*          cctx;
+  LZ4F_dctx*          dctx;
+  LZ4F_preferences_t  prefs;
+};
+#endif
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChCompressedFile::ChCompressedFile()
+: m_file(0),
+  m_codec(NONE),
+  m_writing(false),
+  m_error(false),
+  m_ctx(0),
+  m_buf_size(1 << 16),
+  m_buf_used(0),
+  m_out_pos(0),
+  m_out_end(0)
+{
+}
+
+ChCompressedFile::~ChCompressedFile()
+{
+  Close();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChCompressedFile::Codec ChCompressedFile::GetCodec(const std::string& filename)
+{
+  size_t dot = filename.find_last_of('.');
+  if (dot == std::string::npos)
+    return NONE;
+
+  std::string ext = filename.substr(dot);
+  if (ext == ".lz4")
+    return LZ4;
+  if (ext == ".zst")
+    return ZSTD;
+
+  return NONE;
+}
+
+bool ChCompressedFile::IsAvailable(Codec codec)
+{
+  switch (codec) {
+    case LZ4:
+      return LZ4_ENABLED != 0;
+    case ZSTD:
+      return ZSTD_ENABLED != 0;
+    default:
+      return true;
+  }
+}
+
+ChCompressedFile::Codec ChCompressedFile::DetectCodec(const void* data, size_t size)
+{
+  if (size < 4)
+    return NONE;
+  if (std::memcmp(data, LZ4_MAGIC, 4) == 0)
+    return LZ4;
+  if (std::memcmp(data, ZSTD_MAGIC, 4) == 0)
+    return ZSTD;
+
+  return NONE;
+}
+
+static const char* CodecName(ChCompressedFile::Codec codec)
+{
+  return (codec == ChCompressedFile::LZ4) ? "LZ4" : "Zstandard";
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChCompressedFile::OpenWrite(const std::string& filename,
+                                 Codec              codec,
+                                 int                level,
+                                 bool               text)
+{
+  Close();
+
+  if (codec == AUTO)
+    codec = GetCodec(filename);
+
+  if (!IsAvailable(codec)) {
+    GetLog() << "ERROR: cannot write " << filename.c_str() << ", " << CodecName(codec)
+             << " compression requires ENABLE_" << (codec == LZ4 ? "LZ4" : "ZSTD") << "\n";
+    return false;
+  }
+
+  m_file = fopen(filename.c_str(), (text && codec == NONE) ? "w" : "wb");
+  if (!m_file) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  m_codec = codec;
+  m_writing = true;
+  m_error = false;
+  m_buf.resize(m_buf_size);
+  m_buf_used = 0;
+
+#if !LZ4_ENABLED && !ZSTD_ENABLED
+  (void)level;
+#endif
+
+#if LZ4_ENABLED
+  if (m_codec == LZ4) {
+    Lz4Context* ctx = new Lz4Context;
+    ctx->dctx = 0;
+    std::memset(&ctx->prefs, 0, sizeof(ctx->prefs));
+    ctx->prefs.compressionLevel = level;
+    m_ctx = ctx;
+
+    m_out.resize(LZ4F_compressBound(m_buf_size, &ctx->prefs) + LZ4F_HEADER_SIZE_MAX);
+    if (LZ4F_isError(LZ4F_createCompressionContext(&ctx->cctx, LZ4F_VERSION))) {
+      ctx->cctx = 0;
+      m_error = true;
+    } else {
+      size_t n = LZ4F_compressBegin(ctx->cctx, &m_out[0], m_out.size(), &ctx->prefs);
+      if (LZ4F_isError(n))
+        m_error = true;
+      else
+        write_file(&m_out[0], n);
+    }
+  }
+#endif
+
+#if ZSTD_ENABLED
+  if (m_codec == ZSTD) {
+    ZSTD_CStream* cs = ZSTD_createCStream();
+    m_ctx = cs;
+    m_out.resize(ZSTD_CStreamOutSize());
+    if (!cs || ZSTD_isError(ZSTD_initCStream(cs, level)))
+      m_error = true;
+  }
+#endif
+
+  if (m_error) {
+    GetLog() << "ERROR: cannot initialize the " << CodecName(m_codec) << " compression of " << filename.c_str() << "\n";
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChCompressedFile::OpenRead(const std::string& filename)
+{
+  Close();
+
+  m_file = fopen(filename.c_str(), "rb");
+  if (!m_file) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << "\n";
+    return false;
+  }
+
+  m_writing = false;
+  m_error = false;
+  m_out.resize(m_buf_size);
+  read_file();
+
+  m_codec = DetectCodec(&m_out[0], m_out_end);
+
+  if (!IsAvailable(m_codec)) {
+    GetLog() << "ERROR: cannot read " << filename.c_str() << ", " << CodecName(m_codec)
+             << " decompression requires ENABLE_" << (m_codec == LZ4 ? "LZ4" : "ZSTD") << "\n";
+    fclose(m_file);
+    m_file = 0;
+    return false;
+  }
+
+#if LZ4_ENABLED
+  if (m_codec == LZ4) {
+    Lz4Context* ctx = new Lz4Context;
+    ctx->cctx = 0;
+    m_ctx = ctx;
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx->dctx, LZ4F_VERSION))) {
+      ctx->dctx = 0;
+      m_error = true;
+    }
+  }
+#endif
+
+#if ZSTD_ENABLED
+  if (m_codec == ZSTD) {
+    ZSTD_DStream* ds = ZSTD_createDStream();
+    m_ctx = ds;
+    if (!ds || ZSTD_isError(ZSTD_initDStream(ds)))
+      m_error = true;
+  }
+#endif
+
+  if (m_error) {
+    GetLog() << "ERROR: cannot initialize the " << CodecName(m_codec) << " decompression of " << filename.c_str() << "\n";
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChCompressedFile::Close()
+{
+  if (!m_file)
+    return true;
+
+  if (m_writing && !m_error) {
+    write_buffer(false);
+
+#if LZ4_ENABLED
+    if (m_codec == LZ4 && !m_error) {
+      Lz4Context* ctx = (Lz4Context*)m_ctx;
+      size_t n = LZ4F_compressEnd(ctx->cctx, &m_out[0], m_out.size(), 0);
+      if (LZ4F_isError(n))
+        m_error = true;
+      else
+        write_file(&m_out[0], n);
+    }
+#endif
+
+#if ZSTD_ENABLED
+    if (m_codec == ZSTD && !m_error) {
+      ZSTD_CStream* cs = (ZSTD_CStream*)m_ctx;
+      size_t remaining;
+      do {
+        ZSTD_outBuffer out = {&m_out[0], m_out.size(), 0};
+        remaining = ZSTD_endStream(cs, &out);
+        if (ZSTD_isError(remaining)) {
+          m_error = true;
+          break;
+        }
+        write_file(out.dst, out.pos);
+      } while (remaining != 0 && !m_error);
+    }
+#endif
+  }
+
+#if LZ4_ENABLED
+  if (m_codec == LZ4 && m_ctx) {
+    Lz4Context* ctx = (Lz4Context*)m_ctx;
+    if (ctx->cctx)
+      LZ4F_freeCompressionContext(ctx->cctx);
+    if (ctx->dctx)
+      LZ4F_freeDecompressionContext(ctx->dctx);
+    delete ctx;
+  }
+#endif
+
+#if ZSTD_ENABLED
+  if (m_codec == ZSTD && m_ctx) {
+    if (m_writing)
+      ZSTD_freeCStream((ZSTD_CStream*)m_ctx);
+    else
+      ZSTD_freeDStream((ZSTD_DStream*)m_ctx);
+  }
+#endif
+
+  if (fclose(m_file) != 0 && m_writing)
+    m_error = true;
+
+  if (m_writing && m_error)
+    GetLog() << "ERROR: the output file could not be written completely\n";
+
+  m_file = 0;
+  m_ctx = 0;
+  m_codec = NONE;
+  m_buf.clear();
+  m_out.clear();
+  m_buf_used = 0;
+  m_out_pos = 0;
+  m_out_end = 0;
+
+  return !m_error;
+}
+
+// -----------------------------------------------------------------------------
+// Writing. The data is collected in the buffer and handed to the codec (or to
+// the file, if not compressed) one buffer at a time.
+// -----------------------------------------------------------------------------
+bool ChCompressedFile::Write(const void* data, size_t size)
+{
+  if (!m_file || !m_writing)
+    return false;
+
+  const char* p = (const char*)data;
+  while (size > 0 && !m_error) {
+    size_t n = std::min(size, m_buf_size - m_buf_used);
+    std::memcpy(&m_buf[m_buf_used], p, n);
+    m_buf_used += n;
+    p += n;
+    size -= n;
+    if (m_buf_used == m_buf_size)
+      write_buffer(false);
+  }
+
+  return !m_error;
+}
+
+bool ChCompressedFile::WriteAt(long offset, const void* data, size_t size)
+{
+  if (!m_file || !m_writing || m_codec != NONE)
+    return false;
+
+  if (!write_buffer(false))
+    return false;
+
+  if (fseek(m_file, offset, SEEK_SET) != 0)
+    return false;
+  bool ok = write_file(data, size);
+
+  return fseek(m_file, 0, SEEK_END) == 0 && ok;
+}
+
+bool ChCompressedFile::Flush()
+{
+  if (!m_file || !m_writing)
+    return false;
+
+  return write_buffer(true) && fflush(m_file) == 0;
+}
+
+bool ChCompressedFile::write_buffer(bool flush)
+{
+  if (m_error)
+    return false;
+
+  if (m_codec == NONE) {
+    if (m_buf_used > 0)
+      write_file(&m_buf[0], m_buf_used);
+    m_buf_used = 0;
+    return !m_error;
+  }
+
+#if !LZ4_ENABLED && !ZSTD_ENABLED
+  (void)flush;
+#endif
+
+#if LZ4_ENABLED
+  if (m_codec == LZ4) {
+    Lz4Context* ctx = (Lz4Context*)m_ctx;
+    if (m_buf_used > 0) {
+      size_t n = LZ4F_compressUpdate(ctx->cctx, &m_out[0], m_out.size(), &m_buf[0], m_buf_used, 0);
+      if (LZ4F_isError(n))
+        m_error = true;
+      else
+        write_file(&m_out[0], n);
+    }
+    if (flush && !m_error) {
+      size_t n = LZ4F_flush(ctx->cctx, &m_out[0], m_out.size(), 0);
+      if (LZ4F_isError(n))
+        m_error = true;
+      else
+        write_file(&m_out[0], n);
+    }
+  }
+#endif
+
+#if ZSTD_ENABLED
+  if (m_codec == ZSTD) {
+    ZSTD_CStream* cs = (ZSTD_CStream*)m_ctx;
+    ZSTD_inBuffer in = {m_buf.empty() ? 0 : &m_buf[0], m_buf_used, 0};
+    while (in.pos < in.size && !m_error) {
+      ZSTD_outBuffer out = {&m_out[0], m_out.size(), 0};
+      if (ZSTD_isError(ZSTD_compressStream(cs, &out, &in)))
+        m_error = true;
+      else
+        write_file(out.dst, out.pos);
+    }
+    if (flush) {
+      size_t remaining = 0;
+      do {
+        ZSTD_outBuffer out = {&m_out[0], m_out.size(), 0};
+        remaining = ZSTD_flushStream(cs, &out);
+        if (ZSTD_isError(remaining))
+          m_error = true;
+        else
+          write_file(out.dst, out.pos);
+      } while (remaining != 0 && !m_error);
+    }
+  }
+#endif
+
+  m_buf_used = 0;
+  return !m_error;
+}
+
+bool ChCompressedFile::write_file(const void* data, size_t size)
+{
+  if (size > 0 && fwrite(data, 1, size, m_file) != size)
+    m_error = true;
+  return !m_error;
+}
+
+// -----------------------------------------------------------------------------
+// Reading. The file is read one buffer at a time and decompressed directly in
+// the caller's array.
+// -----------------------------------------------------------------------------
+size_t ChCompressedFile::Read(void* data, size_t size)
+{
+  if (!m_file || m_writing)
+    return 0;
+
+  char* dst = (char*)data;
+  size_t filled = 0;
+
+  while (filled < size && !m_error) {
+    bool eof = false;
+    if (m_out_pos == m_out_end)
+      eof = !read_file();
+
+    size_t avail = m_out_end - m_out_pos;
+    const char* src = m_out.empty() ? 0 : &m_out[0] + m_out_pos;
+    size_t produced = 0;
+
+    if (m_codec == NONE) {
+      produced = std::min(size - filled, avail);
+      std::memcpy(dst + filled, src, produced);
+      m_out_pos += produced;
+    }
+
+#if LZ4_ENABLED
+    if (m_codec == LZ4) {
+      Lz4Context* ctx = (Lz4Context*)m_ctx;
+      size_t dst_size = size - filled;
+      size_t src_size = avail;
+      if (LZ4F_isError(LZ4F_decompress(ctx->dctx, dst + filled, &dst_size, src, &src_size, 0))) {
+        GetLog() << "ERROR: corrupted LZ4 input file\n";
+        m_error = true;
+        break;
+      }
+      m_out_pos += src_size;
+      produced = dst_size;
+    }
+#endif
+
+#if ZSTD_ENABLED
+    if (m_codec == ZSTD) {
+      ZSTD_DStream* ds = (ZSTD_DStream*)m_ctx;
+      ZSTD_inBuffer in = {src, avail, 0};
+      ZSTD_outBuffer out = {dst + filled, size - filled, 0};
+      if (ZSTD_isError(ZSTD_decompressStream(ds, &out, &in))) {
+        GetLog() << "ERROR: corrupted Zstandard input file\n";
+        m_error = true;
+        break;
+      }
+      m_out_pos += in.pos;
+      produced = out.pos;
+    }
+#endif
+
+    filled += produced;
+    if (eof && produced == 0)
+      break;
+  }
+
+  return filled;
+}
+
+bool ChCompressedFile::read_file()
+{
+  m_out_pos = 0;
+  m_out_end = fread(&m_out[0], 1, m_out.size(), m_file);
+  return m_out_end > 0;
+}
+
+bool ChCompressedFile::ReadAll(const std::string& filename, std::string& contents)
+{
+  contents.clear();
+
+  ChCompressedFile file;
+  if (!file.OpenRead(filename))
+    return false;
+
+  const size_t chunk = 1 << 20;
+  while (true) {
+    size_t size = contents.size();
+    contents.resize(size + chunk);
+    size_t n = file.Read(&contents[size], chunk);
+    contents.resize(size + n);
+    if (n < chunk)
+      break;
+  }
+
+  bool ok = !file.m_error;
+  file.Close();
+
+  return ok;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
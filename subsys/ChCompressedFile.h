@@ -0,0 +1,167 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Streaming compression of output files, shared by all output writers
+// (ChOutputChannel, CSV_writer, ChDriver logs).
+//
+// A file is written either uncompressed or as a standard LZ4 frame (fast,
+// for writing from the simulation loop) or a standard Zstandard frame (better
+// ratio, for archiving), so that it can also be decompressed with the lz4 and
+// zstd command line tools. With the AUTO codec (the default of the writers),
+// the codec is selected by the file name extension: ".lz4" or ".zst".
+// When reading, the codec is detected from the frame magic number, so that
+// readers (ChValidation, ChOutputChannel::ReadBinary, the Python tooling)
+// accept compressed and uncompressed files alike.
+//
+// The codecs are only available if the library was built with ENABLE_LZ4 and
+// ENABLE_ZSTD, respectively.
+//
+// =============================================================================
+
+#ifndef CH_COMPRESSED_FILE_H
+#define CH_COMPRESSED_FILE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Output or input file with optional streaming compression.
+///
+class CH_SUBSYS_API ChCompressedFile
+{
+public:
+
+  enum Codec {
+    AUTO,     ///< select from the file name extension (writing only)
+    NONE,     ///< uncompressed
+    LZ4,      ///< LZ4 frame (".lz4")
+    ZSTD      ///< Zstandard frame (".zst")
+  };
+
+  ChCompressedFile();
+
+  /// Close the file (if open).
+  ~ChCompressedFile();
+
+  /// Set the size of the buffer of uncompressed data handed to the codec (or
+  /// to the file) at once (default: 64 KB). Must be called before opening.
+  void SetBufferSize(size_t size) { m_buf_size = size; }
+
+  /// Create the specified file for writing with the specified codec.
+  /// The level is codec specific (0: the codec default; for ZSTD, e.g., 19
+  /// for archiving). Returns false if the file cannot be opened or the codec
+  /// is not available.
+  bool OpenWrite(
+    const std::string& filename,       ///< [in] name of the output file
+    Codec              codec = AUTO,   ///< [in] compression codec
+    int                level = 0,      ///< [in] compression level
+    bool               text = false    ///< [in] text file (only used if not compressed)
+    );
+
+  /// Open the specified file for reading, detecting its codec.
+  /// Returns false if the file cannot be opened or its codec is not available.
+  bool OpenRead(
+    const std::string& filename        ///< [in] name of the input file
+    );
+
+  /// Finish the compressed stream (if writing) and close the file.
+  /// Returns false if the output could not be written completely.
+  bool Close();
+
+  /// Return true if the file is open.
+  bool IsOpen() const { return m_file != 0; }
+
+  /// Get the codec of the open file.
+  Codec GetCodec() const { return m_codec; }
+
+  /// Return the size of the buffers of this file, in bytes (the context of
+  /// the codec is not included).
+  size_t GetMemoryFootprint() const { return m_buf.capacity() + m_out.capacity(); }
+
+  /// Append the specified data. Returns false on error.
+  bool Write(const void* data, size_t size);
+
+  /// Append the specified string. Returns false on error.
+  bool Write(const std::string& str) { return Write(str.data(), str.size()); }
+
+  /// Overwrite data already written at the specified offset. Only supported
+  /// for uncompressed files. Returns false on error.
+  bool WriteAt(long offset, const void* data, size_t size);
+
+  /// Compress and write all data appended so far, such that it can be read
+  /// from the file. Returns false on error.
+  bool Flush();
+
+  /// Read up to the specified number of (uncompressed) bytes.
+  /// Returns the number of bytes read, which is smaller than requested only at
+  /// the end of the file or on error.
+  size_t Read(void* data, size_t size);
+
+  /// Get the codec selected by the extension of the specified file name.
+  static Codec GetCodec(const std::string& filename);
+
+  /// Return true if the specified codec is available in this build.
+  static bool IsAvailable(Codec codec);
+
+  /// Detect the codec of a file from its first bytes (at least 4).
+  static Codec DetectCodec(const void* data, size_t size);
+
+  /// Read the (uncompressed) contents of the specified file.
+  /// Returns false if the file cannot be read.
+  static bool ReadAll(
+    const std::string& filename,   ///< [in] name of the input file
+    std::string&       contents    ///< [out] file contents
+    );
+
+private:
+
+  ChCompressedFile(const ChCompressedFile&);
+  ChCompressedFile& operator=(const ChCompressedFile&);
+
+  // Compress and write the buffered data, optionally flushing the codec.
+  bool write_buffer(bool flush);
+
+  // Write to the file and record any error.
+  bool write_file(const void* data, size_t size);
+
+  // Refill the input buffer from the file; returns false at the end of file.
+  bool read_file();
+
+  FILE*              m_file;
+  Codec              m_codec;
+  bool               m_writing;
+  bool               m_error;
+  void*              m_ctx;       // codec (de)compression context
+
+  size_t             m_buf_size;
+  std::vector<char>  m_buf;       // uncompressed data to write
+  size_t             m_buf_used;
+  std::vector<char>  m_out;       // compressed data to write, or read
+  size_t             m_out_pos;   // next byte of the data read
+  size_t             m_out_end;   // end of the data read
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
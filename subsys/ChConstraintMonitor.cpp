@@ -0,0 +1,252 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Per-step monitoring of the constraint violations of a vehicle.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <map>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChConstraintMonitor.h"
+#include "subsys/ChVehicle.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChConstraintMonitor::ChConstraintMonitor()
+: m_vehicle(0),
+  m_num_system_links(0),
+  m_alert_threshold(1e-3),
+  m_reduction_threshold(0),
+  m_reduction_requested(false)
+{
+  m_summary.time = 0;
+  m_summary.num_updates = 0;
+  m_summary.num_equations = 0;
+  m_summary.max_violation = 0;
+  m_summary.rms_violation = 0;
+  m_summary.worst_group = -1;
+  m_summary.num_reductions = 0;
+}
+
+void ChConstraintMonitor::Initialize(ChVehicle& vehicle)
+{
+  m_vehicle = &vehicle;
+  build();
+}
+
+// -----------------------------------------------------------------------------
+// The links of the system not claimed by a suspension or the steering form
+// the last group.
+// -----------------------------------------------------------------------------
+static ChConstraintGroupSummary MakeConstraintGroup(const std::string& name)
+{
+  ChConstraintGroupSummary group;
+  group.name = name;
+  group.num_links = 0;
+  group.num_equations = 0;
+  group.max_violation = 0;
+  group.rms_violation = 0;
+  group.worst_link = 0;
+  group.peak_violation = 0;
+  group.peak_time = 0;
+  group.num_alerts = 0;
+  group.above = false;
+  return group;
+}
+
+void ChConstraintMonitor::build()
+{
+  std::vector<ChConstraintGroupSummary>& groups = m_summary.groups;
+  groups.clear();
+
+  std::map<ChLink*, int> owners;
+  std::vector<ChLink*> links;
+
+  int num_axles = m_vehicle->GetNumberAxles();
+  for (int i = 0; i < num_axles; i++) {
+    ChSharedPtr<ChSuspension> suspension = m_vehicle->GetSuspension(i);
+    std::string name = suspension->GetName();
+    if (name.empty()) {
+      char buf[32];
+      sprintf(buf, "suspension %d", i);
+      name = buf;
+    }
+    links.clear();
+    suspension->GetConstraints(links);
+    for (size_t j = 0; j < links.size(); j++)
+      owners[links[j]] = (int)groups.size();
+    groups.push_back(MakeConstraintGroup(name));
+  }
+
+  if (!m_vehicle->GetSteering().IsNull()) {
+    links.clear();
+    m_vehicle->GetSteering()->GetConstraints(links);
+    for (size_t j = 0; j < links.size(); j++)
+      owners[links[j]] = (int)groups.size();
+    groups.push_back(MakeConstraintGroup(m_vehicle->GetSteering()->GetName()));
+  }
+
+  int other = (int)groups.size();
+  groups.push_back(MakeConstraintGroup("other"));
+
+  // Sort the links of the system by group, for a sequential pass.
+  std::vector<ChLink*>* system_links = m_vehicle->GetSystem()->Get_linklist();
+  std::vector<std::vector<ChLink*> > members(groups.size());
+  for (std::vector<ChLink*>::iterator ilink = system_links->begin(); ilink != system_links->end(); ++ilink) {
+    std::map<ChLink*, int>::const_iterator it = owners.find(*ilink);
+    members[it == owners.end() ? other : it->second].push_back(*ilink);
+  }
+
+  m_entries.clear();
+  for (size_t g = 0; g < members.size(); g++) {
+    groups[g].num_links = (int)members[g].size();
+    for (size_t j = 0; j < members[g].size(); j++) {
+      Entry entry = { members[g][j], (int)g };
+      m_entries.push_back(entry);
+    }
+  }
+
+  m_num_system_links = system_links->size();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChConstraintMonitor::Update(double time)
+{
+  m_reduction_requested = false;
+  if (!m_vehicle)
+    return;
+
+  if (m_vehicle->GetSystem()->Get_linklist()->size() != m_num_system_links)
+    build();
+
+  std::vector<ChConstraintGroupSummary>& groups = m_summary.groups;
+  for (size_t g = 0; g < groups.size(); g++) {
+    groups[g].num_equations = 0;
+    groups[g].max_violation = 0;
+    groups[g].rms_violation = 0;    // sum of squares during the pass
+    groups[g].worst_link = 0;
+  }
+
+  for (size_t k = 0; k < m_entries.size(); k++) {
+    ChMatrix<>* C = m_entries[k].link->GetC();
+    if (!C)
+      continue;
+
+    ChConstraintGroupSummary& group = groups[m_entries[k].group];
+    int n = C->GetRows();
+    for (int i = 0; i < n; i++) {
+      double v = std::abs(C->GetElement(i, 0));
+      group.rms_violation += v * v;
+      if (v > group.max_violation) {
+        group.max_violation = v;
+        group.worst_link = m_entries[k].link;
+      }
+    }
+    group.num_equations += n;
+  }
+
+  double sum_sq = 0;
+  m_summary.time = time;
+  m_summary.num_updates++;
+  m_summary.num_equations = 0;
+  m_summary.max_violation = 0;
+  m_summary.worst_group = -1;
+
+  for (int g = 0; g < (int)groups.size(); g++) {
+    ChConstraintGroupSummary& group = groups[g];
+
+    sum_sq += group.rms_violation;
+    m_summary.num_equations += group.num_equations;
+    group.rms_violation = group.num_equations > 0 ? std::sqrt(group.rms_violation / group.num_equations) : 0;
+
+    if (group.max_violation > group.peak_violation) {
+      group.peak_violation = group.max_violation;
+      group.peak_time = time;
+    }
+    if (group.max_violation > m_summary.max_violation) {
+      m_summary.max_violation = group.max_violation;
+      m_summary.worst_group = g;
+    }
+
+    // Raise an alert only when the group crosses the threshold.
+    bool above = m_alert_threshold > 0 && group.max_violation > m_alert_threshold;
+    if (above && !group.above) {
+      group.num_alerts++;
+      if (!m_handler.IsNull())
+        m_handler->OnAlert(*this, g);
+      else
+        GetLog() << "WARNING: constraint violation " << group.max_violation << " in " << group.name.c_str()
+                 << " at time " << time << "\n";
+    }
+    group.above = above;
+  }
+
+  m_summary.rms_violation = m_summary.num_equations > 0 ? std::sqrt(sum_sq / m_summary.num_equations) : 0;
+
+  if (m_reduction_threshold > 0 && m_summary.max_violation > m_reduction_threshold) {
+    m_reduction_requested = true;
+    m_summary.num_reductions++;
+  }
+}
+
+void ChConstraintMonitor::Reset()
+{
+  std::vector<ChConstraintGroupSummary>& groups = m_summary.groups;
+  for (size_t g = 0; g < groups.size(); g++) {
+    groups[g].peak_violation = 0;
+    groups[g].peak_time = 0;
+    groups[g].num_alerts = 0;
+    groups[g].above = false;
+  }
+
+  m_summary.num_updates = 0;
+  m_summary.num_reductions = 0;
+  m_reduction_requested = false;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChConstraintMonitor::WriteSummary(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  fprintf(fp, "name,joints,equations,max,rms,peak,time_peak,alerts\n");
+  for (size_t g = 0; g < m_summary.groups.size(); g++) {
+    const ChConstraintGroupSummary& group = m_summary.groups[g];
+    fprintf(fp, "%s,%d,%d,%.10g,%.10g,%.10g,%.10g,%d\n", group.name.c_str(), group.num_links,
+            group.num_equations, group.max_violation, group.rms_violation, group.peak_violation,
+            group.peak_time, group.num_alerts);
+  }
+
+  return fclose(fp) == 0;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,179 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Per-step monitoring of the constraint violations of a vehicle.
+//
+// The joints of the Chrono system are grouped by subsystem (one group per
+// suspension, one for the steering and one for all other links, e.g. those of
+// the brakes, the driveline or the chassis), and each update computes, in one
+// pass over the joints, the largest and the RMS violation of each group and of
+// the whole vehicle into a preallocated summary. Unlike
+// ChVehicle::LogConstraintViolations(), nothing is printed unless a threshold
+// is exceeded, so that the monitor can be left on at every step:
+//  - above the alert threshold, the alert handler (or, without handler, the
+//    log) is notified once per group, when the group first exceeds it;
+//  - above the step reduction threshold, the monitor requests a reduction of
+//    the integration step from an adaptive vehicle (see
+//    ChVehicle::SetAdaptiveStep()); with a fixed step, only alerts are raised.
+//
+// The groups are built when the monitor is attached to a vehicle, after its
+// initialization, and rebuilt when the number of links in the system changes.
+//
+// =============================================================================
+
+#ifndef CH_CONSTRAINT_MONITOR_H
+#define CH_CONSTRAINT_MONITOR_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+class ChLink;
+class ChVehicle;
+
+namespace vehicle {
+
+class ChConstraintMonitor;
+
+///
+/// Violations of the joints of one subsystem, at the last update.
+///
+struct ChConstraintGroupSummary {
+  std::string  name;            ///< name of the subsystem
+  int          num_links;       ///< number of joints in the group
+  int          num_equations;   ///< number of constraint equations
+  double       max_violation;   ///< largest violation (absolute value)
+  double       rms_violation;   ///< RMS of the violations
+  ChLink*      worst_link;      ///< joint with the largest violation (NULL if none)
+  double       peak_violation;  ///< largest violation over all updates
+  double       peak_time;       ///< time of the peak violation
+  int          num_alerts;      ///< number of alerts raised for the group
+  bool         above;           ///< above the alert threshold at the last update
+};
+
+///
+/// Violations of the joints of a vehicle, at the last update.
+///
+struct ChConstraintSummary {
+  double                                 time;           ///< simulation time of the last update
+  int                                    num_updates;    ///< number of updates
+  int                                    num_equations;  ///< number of constraint equations
+  double                                 max_violation;  ///< largest violation over all groups
+  double                                 rms_violation;  ///< RMS of the violations over all groups
+  int                                    worst_group;    ///< group with the largest violation (-1 if none)
+  int                                    num_reductions; ///< number of step reductions requested
+  std::vector<ChConstraintGroupSummary>  groups;         ///< per-subsystem violations
+};
+
+///
+/// Handler of the constraint violation alerts.
+///
+class CH_SUBSYS_API ChConstraintAlertHandler : public ChShared
+{
+public:
+  virtual ~ChConstraintAlertHandler() {}
+
+  /// Called when the largest violation of the specified group exceeds the
+  /// alert threshold, after having been below it at the previous update.
+  virtual void OnAlert(const ChConstraintMonitor& monitor, int group) = 0;
+};
+
+///
+/// Per-subsystem monitor of the constraint violations of a vehicle.
+///
+class CH_SUBSYS_API ChConstraintMonitor
+{
+public:
+
+  ChConstraintMonitor();
+  ~ChConstraintMonitor() {}
+
+  /// Set the violation above which an alert is raised for a group (default:
+  /// 1e-3; zero disables the alerts).
+  void SetAlertThreshold(double threshold) { m_alert_threshold = threshold; }
+
+  /// Set the violation above which a reduction of the integration step is
+  /// requested (default: 0, disabled).
+  void SetStepReductionThreshold(double threshold) { m_reduction_threshold = threshold; }
+
+  /// Set the handler of the alerts. Without handler, an alert is logged.
+  void SetAlertHandler(ChSharedPtr<ChConstraintAlertHandler> handler) { m_handler = handler; }
+
+  /// Group the joints of the specified (initialized) vehicle by subsystem.
+  /// Called by ChVehicle::SetConstraintMonitor().
+  void Initialize(ChVehicle& vehicle);
+
+  /// Compute the violations of all groups for the current state of the
+  /// vehicle, and raise the alerts. Called by the vehicle after each
+  /// integration step.
+  void Update(double time);
+
+  /// Return true if the last update requested a reduction of the integration
+  /// step.
+  bool IsStepReductionRequested() const { return m_reduction_requested; }
+
+  /// Discard the peaks and counts (the groups are kept).
+  void Reset();
+
+  /// Get the summary of the last update.
+  const ChConstraintSummary& GetSummary() const { return m_summary; }
+
+  /// Get the largest violation at the last update.
+  double GetMaxViolation() const { return m_summary.max_violation; }
+
+  /// Get the number of groups.
+  int GetNumGroups() const { return (int)m_summary.groups.size(); }
+
+  /// Write the summary, one CSV row per group (name, joints, equations,
+  /// max, RMS, peak, peak time, alerts). Returns false if the file cannot be
+  /// written.
+  bool WriteSummary(const std::string& filename) const;
+
+private:
+
+  struct Entry {
+    ChLink*  link;
+    int      group;
+  };
+
+  ChConstraintMonitor(const ChConstraintMonitor&);
+  ChConstraintMonitor& operator=(const ChConstraintMonitor&);
+
+  // Build the groups from the joints of the subsystems of the vehicle.
+  void build();
+
+  ChVehicle*                             m_vehicle;
+  std::vector<Entry>                     m_entries;        // sorted by group
+  size_t                                 m_num_system_links;
+
+  double                                 m_alert_threshold;
+  double                                 m_reduction_threshold;
+  ChSharedPtr<ChConstraintAlertHandler>  m_handler;
+  bool                                   m_reduction_requested;
+
+  ChConstraintSummary                    m_summary;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,121 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Content hash of simulation inputs.
+//
+// =============================================================================
+
+#include <cstdio>
+
+#include "subsys/ChContentHash.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChJsonCache.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// 64-bit FNV-1a hash
+// -----------------------------------------------------------------------------
+ChContentHash::ChContentHash()
+: m_hash(0xCBF29CE484222325ULL)
+{
+}
+
+void ChContentHash::Add(const void* data, size_t size)
+{
+  const unsigned char* p = (const unsigned char*)data;
+  for (size_t i = 0; i < size; i++) {
+    m_hash ^= p[i];
+    m_hash *= 0x100000001B3ULL;
+  }
+}
+
+void ChContentHash::Add(const std::string& str)
+{
+  Add(str.c_str(), str.size() + 1);
+}
+
+std::string ChContentHash::GetKey() const
+{
+  char key[32];
+  sprintf(key, "%016llx", m_hash);
+
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChContentHash::AddValue(const Value& v)
+{
+  int type = v.GetType();
+  Add(&type, sizeof(type));
+
+  if (v.IsObject()) {
+    for (Value::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+      std::string name = m->name.GetString();
+      Add(name);
+      AddValue(m->value);
+
+      const std::string suffix = "Input File";
+      if (m->value.IsString() && name.size() >= suffix.size() &&
+          name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        AddFile(GetDataFile(m->value.GetString()));
+    }
+  }
+  else if (v.IsArray()) {
+    for (SizeType i = 0; i < v.Size(); i++)
+      AddValue(v[i]);
+  }
+  else if (v.IsString()) {
+    Add(v.GetString(), v.GetStringLength());
+  }
+  else if (v.IsNumber()) {
+    Add(v.GetDouble());
+  }
+  else if (v.IsBool()) {
+    bool val = v.GetBool();
+    Add(&val, sizeof(val));
+  }
+}
+
+void ChContentHash::AddFile(const std::string& filename)
+{
+  if (!m_visited.insert(filename).second)
+    return;
+
+  Add(filename);
+
+  const Document& d = ChJsonCache::Get(filename);
+  if (!d.HasParseError()) {
+    AddValue(d);
+    return;
+  }
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp)
+    return;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    Add(buffer, n);
+  fclose(fp);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
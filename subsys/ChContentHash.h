@@ -0,0 +1,79 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Content hash of simulation inputs, for the keys of on-disk caches (settled
+// vehicle states, scenario results).
+//
+// The hash (64-bit FNV-1a) accumulates raw data and the contents of input
+// files. JSON files are hashed through ChJsonCache, by their parsed values
+// (honoring in-memory overrides, see ChJsonPatch), together with all the files
+// they reference through "... Input File" members (relative to the data
+// directory); other files are hashed by their bytes. Each file is hashed once.
+//
+// =============================================================================
+
+#ifndef CH_CONTENT_HASH_H
+#define CH_CONTENT_HASH_H
+
+#include <set>
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Incremental content hash.
+///
+class CH_SUBSYS_API ChContentHash
+{
+public:
+
+  ChContentHash();
+
+  /// Add raw data.
+  void Add(const void* data, size_t size);
+
+  /// Add a string (with its terminator).
+  void Add(const std::string& str);
+
+  /// Add a number.
+  void Add(double val) { Add(&val, sizeof(val)); }
+
+  /// Add the name and the contents of the specified file (nothing if it was
+  /// already added; only its name if it cannot be read).
+  void AddFile(const std::string& filename);
+
+  /// Add a JSON value, and the files it references.
+  void AddValue(const rapidjson::Value& v);
+
+  /// Get the current hash, as 16 hexadecimal digits.
+  std::string GetKey() const;
+
+private:
+
+  unsigned long long     m_hash;
+  std::set<std::string>  m_visited;   // files already added
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
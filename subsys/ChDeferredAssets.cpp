@@ -0,0 +1,187 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Deferred creation of the visualization assets of the vehicle subsystems.
+//
+// =============================================================================
+
+#include <map>
+#include <vector>
+
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// Recorded asset: either an asset, or the name of a mesh.
+struct ChDeferredAsset {
+  ChSharedPtr<ChAsset>  asset;
+  std::string           filename;
+  std::string           name;
+};
+
+struct ChDeferredBody {
+  ChSharedPtr<ChBody>           body;
+  std::vector<ChDeferredAsset>  assets;
+};
+
+typedef std::map<ChBody*, ChDeferredBody> ChDeferredMap;
+
+static ChMutex        s_deferred_mutex;
+static ChDeferredMap  s_deferred_bodies;
+static bool           s_deferred_enabled = true;
+
+static void DeferredAttach(ChDeferredBody& entry)
+{
+  for (size_t i = 0; i < entry.assets.size(); i++) {
+    const ChDeferredAsset& item = entry.assets[i];
+    if (item.asset.IsNull())
+      entry.body->AddAsset(ChMeshCache::GetMeshShape(item.filename, item.name));
+    else
+      entry.body->AddAsset(item.asset);
+  }
+}
+
+static void DeferredAdd(ChSharedPtr<ChBody> body, const ChDeferredAsset& item)
+{
+  {
+    ChScopedLock lock(s_deferred_mutex);
+
+    if (s_deferred_enabled) {
+      ChDeferredBody& entry = s_deferred_bodies[body.get_ptr()];
+      entry.body = body;
+      entry.assets.push_back(item);
+      return;
+    }
+  }
+
+  ChDeferredBody entry;
+  entry.body = body;
+  entry.assets.push_back(item);
+  DeferredAttach(entry);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDeferredAssets::SetEnabled(bool val)
+{
+  ChScopedLock lock(s_deferred_mutex);
+
+  s_deferred_enabled = val;
+}
+
+bool ChDeferredAssets::IsEnabled()
+{
+  ChScopedLock lock(s_deferred_mutex);
+
+  return s_deferred_enabled;
+}
+
+void ChDeferredAssets::AddAsset(ChSharedPtr<ChBody>   body,
+                                ChSharedPtr<ChAsset>  asset)
+{
+  ChDeferredAsset item;
+  item.asset = asset;
+  DeferredAdd(body, item);
+}
+
+void ChDeferredAssets::AddMesh(ChSharedPtr<ChBody>   body,
+                               const std::string&    filename,
+                               const std::string&    name)
+{
+  ChDeferredAsset item;
+  item.filename = filename;
+  item.name = name;
+  DeferredAdd(body, item);
+}
+
+// -----------------------------------------------------------------------------
+// The entries are removed from the registry under the lock; the assets are
+// attached (and the meshes loaded) outside of it.
+// -----------------------------------------------------------------------------
+int ChDeferredAssets::Materialize(ChSystem* system)
+{
+  std::vector<ChDeferredBody> entries;
+  {
+    ChScopedLock lock(s_deferred_mutex);
+
+    ChDeferredMap::iterator it = s_deferred_bodies.begin();
+    while (it != s_deferred_bodies.end()) {
+      if (it->first->GetSystem() == system) {
+        entries.push_back(it->second);
+        s_deferred_bodies.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < entries.size(); i++)
+    DeferredAttach(entries[i]);
+
+  return (int)entries.size();
+}
+
+bool ChDeferredAssets::Materialize(ChBody* body)
+{
+  ChDeferredBody entry;
+  {
+    ChScopedLock lock(s_deferred_mutex);
+
+    ChDeferredMap::iterator it = s_deferred_bodies.find(body);
+    if (it == s_deferred_bodies.end())
+      return false;
+    entry = it->second;
+    s_deferred_bodies.erase(it);
+  }
+
+  DeferredAttach(entry);
+
+  return true;
+}
+
+void ChDeferredAssets::Discard(ChSystem* system)
+{
+  ChScopedLock lock(s_deferred_mutex);
+
+  ChDeferredMap::iterator it = s_deferred_bodies.begin();
+  while (it != s_deferred_bodies.end()) {
+    if (it->first->GetSystem() == system)
+      s_deferred_bodies.erase(it++);
+    else
+      ++it;
+  }
+}
+
+void ChDeferredAssets::Clear()
+{
+  ChScopedLock lock(s_deferred_mutex);
+
+  s_deferred_bodies.clear();
+}
+
+int ChDeferredAssets::GetNumPending()
+{
+  ChScopedLock lock(s_deferred_mutex);
+
+  return (int)s_deferred_bodies.size();
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,100 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Deferred creation of the visualization assets of the vehicle subsystems.
+//
+// The subsystems record the visualization of their bodies (primitive shapes,
+// colors, textures, and the meshes of the chassis and wheels) here instead of
+// attaching it at construction. The assets are attached, and the meshes loaded
+// (through ChMeshCache), only when a renderer or an exporter first requests
+// them with Materialize(), typically right before ChIrrApp::AssetBindAll(). A
+// headless run thus never parses the meshes, and its bodies carry no assets
+// to update at each step.
+//
+// The deferred assets of a body are appended, in the order they were recorded,
+// after the assets attached directly. Assets recorded for a system after it
+// was materialized stay pending until the next Materialize() call. With the
+// deferral disabled (see SetEnabled()), the assets are attached right away.
+//
+// The registry holds a reference to the bodies with pending assets; Discard()
+// drops those of a system about to be destroyed.
+//
+// =============================================================================
+
+#ifndef CH_DEFERRED_ASSETS_H
+#define CH_DEFERRED_ASSETS_H
+
+#include <string>
+
+#include "physics/ChBody.h"
+#include "physics/ChSystem.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Registry of the visualization assets not yet attached to their bodies.
+///
+class CH_SUBSYS_API ChDeferredAssets
+{
+public:
+
+  /// Enable or disable the deferral (default: enabled). Disabling it does not
+  /// materialize the assets already recorded.
+  static void SetEnabled(bool val);
+  static bool IsEnabled();
+
+  /// Record the specified asset for the specified body.
+  static void AddAsset(
+    ChSharedPtr<ChBody>   body,    ///< [in] body receiving the asset
+    ChSharedPtr<ChAsset>  asset    ///< [in] asset (not attached until materialized)
+    );
+
+  /// Record the shared mesh asset with the specified name for the mesh in the
+  /// specified OBJ file (see ChMeshCache::GetMeshShape()). The file is not
+  /// read until the asset is materialized.
+  static void AddMesh(
+    ChSharedPtr<ChBody>   body,       ///< [in] body receiving the asset
+    const std::string&    filename,   ///< [in] name of the OBJ file
+    const std::string&    name        ///< [in] name of the visualization asset
+    );
+
+  /// Attach the pending assets of all bodies of the specified system.
+  /// Returns the number of bodies that received assets.
+  static int Materialize(ChSystem* system);
+
+  /// Attach the pending assets of the specified body. Returns false if the
+  /// body had no pending assets.
+  static bool Materialize(ChBody* body);
+
+  /// Drop, without attaching them, the pending assets of the bodies of the
+  /// specified system.
+  static void Discard(ChSystem* system);
+
+  /// Drop all pending assets.
+  static void Clear();
+
+  /// Return the number of bodies with pending assets.
+  static int GetNumPending();
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
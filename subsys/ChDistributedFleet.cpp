@@ -0,0 +1,229 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Lock-step simulation of a fleet of vehicles distributed over MPI ranks.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChDistributedFleet.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static double* BufferData(std::vector<double>& buffer)
+{
+  return buffer.empty() ? 0 : &buffer[0];
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChDistributedFleet::ChDistributedFleet(MPI_Comm                   comm,
+                                       ChSharedPtr<ChTerrain>     terrain,
+                                       double                     step_size,
+                                       double                     x_min,
+                                       double                     x_max,
+                                       ChDistributedFleetFactory* factory,
+                                       int                        num_threads)
+: ChFleetSimulation(terrain, step_size, num_threads),
+  m_comm(comm),
+  m_x_min(x_min),
+  m_halo(50),
+  m_migration_steps(10),
+  m_factory(factory),
+  m_num_sent(0),
+  m_num_received(0)
+{
+  MPI_Comm_rank(comm, &m_rank);
+  MPI_Comm_size(comm, &m_size);
+
+  m_width = (x_max - x_min) / m_size;
+}
+
+int ChDistributedFleet::AddVehicle(int                                      id,
+                                   ChSharedPtr<ChVehicle>                   vehicle,
+                                   ChSharedPtr<ChPowertrain>                powertrain,
+                                   ChSharedPtr<ChDriver>                    driver,
+                                   const std::vector<ChSharedPtr<ChTire> >& tires)
+{
+  int index = ChFleetSimulation::AddVehicle(vehicle, powertrain, driver, tires);
+  if (index >= 0)
+    m_ids.push_back(id);
+
+  return index;
+}
+
+int ChDistributedFleet::GetOwner(double x) const
+{
+  int owner = (int)std::floor((x - m_x_min) / m_width);
+  return std::max(0, std::min(owner, m_size - 1));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDistributedFleet::DoStep()
+{
+  ChFleetSimulation::DoStep();
+
+  {
+    CH_PROFILE_SCOPE("ChDistributedFleet::ExchangeGhosts");
+    ExchangeGhosts();
+  }
+
+  if (GetStepNumber() % m_migration_steps == 0) {
+    CH_PROFILE_SCOPE("ChDistributedFleet::Migrate");
+    Migrate();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Send the sizes of the two buffers first, then the buffers themselves. The
+// first and last ranks exchange with MPI_PROC_NULL on their outer side, which
+// sends nothing and leaves the receive count at zero.
+// -----------------------------------------------------------------------------
+void ChDistributedFleet::Exchange(int tag)
+{
+  int lo = (m_rank > 0) ? m_rank - 1 : MPI_PROC_NULL;
+  int hi = (m_rank < m_size - 1) ? m_rank + 1 : MPI_PROC_NULL;
+
+  int send_count[2] = { (int)m_send[LO].size(), (int)m_send[HI].size() };
+  int recv_count[2] = { 0, 0 };
+
+  MPI_Sendrecv(&send_count[LO], 1, MPI_INT, lo, tag, &recv_count[HI], 1, MPI_INT, hi, tag, m_comm, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(&send_count[HI], 1, MPI_INT, hi, tag, &recv_count[LO], 1, MPI_INT, lo, tag, m_comm, MPI_STATUS_IGNORE);
+
+  m_recv[LO].resize(recv_count[LO]);
+  m_recv[HI].resize(recv_count[HI]);
+
+  MPI_Sendrecv(BufferData(m_send[LO]), send_count[LO], MPI_DOUBLE, lo, tag + 1,
+               BufferData(m_recv[HI]), recv_count[HI], MPI_DOUBLE, hi, tag + 1, m_comm, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(BufferData(m_send[HI]), send_count[HI], MPI_DOUBLE, hi, tag + 1,
+               BufferData(m_recv[LO]), recv_count[LO], MPI_DOUBLE, lo, tag + 1, m_comm, MPI_STATUS_IGNORE);
+}
+
+// -----------------------------------------------------------------------------
+// Ghost records: ID, position (3), orientation (4), velocity (3).
+// -----------------------------------------------------------------------------
+void ChDistributedFleet::ExchangeGhosts()
+{
+  double lo_bound = m_x_min + m_rank * m_width + m_halo;
+  double hi_bound = m_x_min + (m_rank + 1) * m_width - m_halo;
+
+  m_send[LO].clear();
+  m_send[HI].clear();
+
+  for (int k = 0; k < GetNumVehicles(); k++) {
+    ChSharedPtr<ChVehicle> vehicle = GetVehicle(k);
+    const ChVector<>& pos = vehicle->GetChassisPos();
+    const ChQuaternion<>& rot = vehicle->GetChassisRot();
+    const ChVector<>& vel = vehicle->GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt();
+    double record[GHOST_SIZE] = { (double)m_ids[k],
+                                  pos.x, pos.y, pos.z,
+                                  rot.e0, rot.e1, rot.e2, rot.e3,
+                                  vel.x, vel.y, vel.z };
+
+    if (m_rank > 0 && pos.x < lo_bound)
+      m_send[LO].insert(m_send[LO].end(), record, record + GHOST_SIZE);
+    if (m_rank < m_size - 1 && pos.x > hi_bound)
+      m_send[HI].insert(m_send[HI].end(), record, record + GHOST_SIZE);
+  }
+
+  Exchange(100);
+
+  size_t num_lo = m_recv[LO].size() / GHOST_SIZE;
+  size_t num_hi = m_recv[HI].size() / GHOST_SIZE;
+  m_ghosts.resize(num_lo + num_hi);
+
+  for (size_t i = 0; i < num_lo + num_hi; i++) {
+    const double* record = (i < num_lo) ? &m_recv[LO][i * GHOST_SIZE] : &m_recv[HI][(i - num_lo) * GHOST_SIZE];
+    ChFleetGhost& ghost = m_ghosts[i];
+    ghost.id = (int)record[0];
+    ghost.pos = ChVector<>(record[1], record[2], record[3]);
+    ghost.rot = ChQuaternion<>(record[4], record[5], record[6], record[7]);
+    ghost.vel = ChVector<>(record[8], record[9], record[10]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Migration records: ID, snapshot size, snapshot values. A vehicle more than
+// one slab away is sent to the neighbor in the direction of its owner, and
+// forwarded at the next migration.
+// -----------------------------------------------------------------------------
+void ChDistributedFleet::Migrate()
+{
+  m_send[LO].clear();
+  m_send[HI].clear();
+
+  for (int k = GetNumVehicles() - 1; k >= 0; k--) {
+    int owner = GetOwner(GetVehicle(k)->GetChassisPos().x);
+    if (owner == m_rank)
+      continue;
+
+    std::vector<double>& buffer = m_send[owner < m_rank ? LO : HI];
+
+    m_snapshot.Clear();
+    SaveVehicleState(k, m_snapshot);
+    buffer.push_back((double)m_ids[k]);
+    buffer.push_back((double)m_snapshot.GetSize());
+    buffer.insert(buffer.end(), m_snapshot.GetData(), m_snapshot.GetData() + m_snapshot.GetSize());
+
+    RemoveVehicle(k);
+    m_ids.erase(m_ids.begin() + k);
+    m_num_sent++;
+  }
+
+  Exchange(200);
+
+  for (int side = LO; side <= HI; side++) {
+    const std::vector<double>& buffer = m_recv[side];
+    size_t pos = 0;
+    while (pos + 2 <= buffer.size()) {
+      int id = (int)buffer[pos];
+      size_t size = (size_t)buffer[pos + 1];
+      const double* data = &buffer[pos + 2];
+      pos += 2 + size;
+
+      ChSharedPtr<ChVehicle> vehicle;
+      ChSharedPtr<ChPowertrain> powertrain;
+      ChSharedPtr<ChDriver> driver;
+      std::vector<ChSharedPtr<ChTire> > tires;
+      int index = -1;
+      if (m_factory->CreateVehicle(id, vehicle, powertrain, driver, tires))
+        index = AddVehicle(id, vehicle, powertrain, driver, tires);
+      if (index < 0) {
+        GetLog() << "ERROR: cannot create migrating vehicle " << id << " on rank " << m_rank << "\n";
+        continue;
+      }
+
+      m_snapshot.Assign(data, size);
+      if (!RestoreVehicleState(index, m_snapshot)) {
+        GetLog() << "ERROR: cannot restore migrating vehicle " << id << " on rank " << m_rank << "\n";
+        RemoveVehicle(index);
+        m_ids.erase(m_ids.begin() + index);
+        continue;
+      }
+      m_num_received++;
+    }
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,194 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Lock-step simulation of a fleet of vehicles distributed over MPI ranks.
+//
+// The terrain is replicated on all ranks. The x range [x_min, x_max] is split
+// into one slab of equal width per rank (in rank order; vehicles beyond the
+// ends belong to the first and last rank), and each rank simulates the
+// vehicles whose chassis is in its slab, with a local ChFleetSimulation.
+//
+// After every step, each rank sends the chassis poses and velocities of its
+// vehicles within the halo width of a slab boundary to the neighbor rank on
+// the other side (ghosts, e.g. for sensing and collision proximity). Every
+// few steps, vehicles that left the slab migrate to the neighbor rank in the
+// direction of their new owner: their module states are saved with the
+// snapshot API, sent, and restored into a vehicle created on the receiving
+// rank by a user-provided factory, from the global vehicle ID.
+//
+// Both exchanges use one message per neighbor, in flat arrays of doubles that
+// are reused from step to step: once they have grown to the largest exchange,
+// the ghost exchange does not allocate memory. A ghost record is 11 doubles
+// (ID, position, orientation, velocity).
+//
+// The halo width must not exceed the slab width. All ranks must call DoStep()
+// (or Run(), in which case Continue() must return the same value on all
+// ranks) the same number of times.
+//
+// This class is only available if ChronoVehicle is built with ENABLE_MPI.
+//
+// =============================================================================
+
+#ifndef CH_DISTRIBUTED_FLEET_H
+#define CH_DISTRIBUTED_FLEET_H
+
+#include <vector>
+
+#include <mpi.h>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChFleetSimulation.h"
+#include "subsys/ChVehicleState.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Chassis pose and velocity of a vehicle simulated on a neighbor rank.
+///
+struct ChFleetGhost
+{
+  int             id;    ///< global vehicle ID
+  ChVector<>      pos;   ///< global position of the chassis reference frame
+  ChQuaternion<>  rot;   ///< orientation of the chassis reference frame
+  ChVector<>      vel;   ///< global velocity of the chassis reference frame origin
+};
+
+///
+/// Factory of the vehicles migrating to a rank.
+///
+class CH_SUBSYS_API ChDistributedFleetFactory
+{
+public:
+
+  virtual ~ChDistributedFleetFactory() {}
+
+  /// Create the modules of the vehicle with the specified global ID, as they
+  /// were constructed on the rank where the vehicle was added (their states
+  /// are then restored from the migrated snapshot).
+  /// Returns false if the vehicle cannot be created.
+  virtual bool CreateVehicle(
+    int                                id,          ///< [in] global vehicle ID
+    ChSharedPtr<ChVehicle>&            vehicle,     ///< [out] vehicle system
+    ChSharedPtr<ChPowertrain>&         powertrain,  ///< [out] powertrain system
+    ChSharedPtr<ChDriver>&             driver,      ///< [out] driver system
+    std::vector<ChSharedPtr<ChTire> >& tires        ///< [out] tires, in wheel ID order
+    ) = 0;
+};
+
+///
+/// Fleet simulation distributed over MPI ranks by spatial region.
+///
+class CH_SUBSYS_API ChDistributedFleet : public ChFleetSimulation
+{
+public:
+
+  /// Create a distributed fleet simulation on the ranks of the specified
+  /// communicator. Each rank simulates the vehicles in its slab of the range
+  /// [x_min, x_max].
+  ChDistributedFleet(
+    MPI_Comm                   comm,            ///< [in] communicator of the participating ranks
+    ChSharedPtr<ChTerrain>     terrain,         ///< [in] terrain (replicated on all ranks)
+    double                     step_size,       ///< [in] integration step size
+    double                     x_min,           ///< [in] lower end of the partitioned range
+    double                     x_max,           ///< [in] upper end of the partitioned range
+    ChDistributedFleetFactory* factory,         ///< [in] factory of migrating vehicles
+    int                        num_threads = 0  ///< [in] number of worker threads per rank
+    );
+
+  ~ChDistributedFleet() {}
+
+  /// Add a vehicle to the local fleet, with the specified global ID. A vehicle
+  /// outside the slab of this rank migrates to its owner at the next migration.
+  /// Returns the local index of the vehicle, or -1 if the number of tires does
+  /// not match the number of wheels.
+  int AddVehicle(
+    int                                      id,          ///< [in] global vehicle ID
+    ChSharedPtr<ChVehicle>                   vehicle,     ///< [in] vehicle system
+    ChSharedPtr<ChPowertrain>                powertrain,  ///< [in] powertrain system
+    ChSharedPtr<ChDriver>                    driver,      ///< [in] driver system
+    const std::vector<ChSharedPtr<ChTire> >& tires        ///< [in] tires, in wheel ID order
+    );
+
+  /// Set the distance from the slab boundaries within which local vehicles
+  /// are sent to the neighbor ranks as ghosts (default: 50 m).
+  void SetHaloWidth(double width) { m_halo = width; }
+
+  /// Set the number of steps between migrations (default: 10).
+  void SetMigrationStep(int steps) { m_migration_steps = steps > 1 ? steps : 1; }
+
+  /// Get the rank of this process and the number of ranks.
+  int GetRank() const { return m_rank; }
+  int GetNumRanks() const { return m_size; }
+
+  /// Get the rank owning a vehicle with the chassis at the specified x.
+  int GetOwner(double x) const;
+
+  /// Get the global ID of the local vehicle with the specified index.
+  int GetVehicleID(int index) const { return m_ids[index]; }
+
+  /// Get the ghosts received from the neighbor ranks after the last step.
+  const std::vector<ChFleetGhost>& GetGhosts() const { return m_ghosts; }
+
+  /// Get the number of vehicles sent to and received from other ranks so far.
+  int GetNumSent() const { return m_num_sent; }
+  int GetNumReceived() const { return m_num_received; }
+
+  /// Perform one simulation step for the local vehicles, then exchange the
+  /// ghosts and, every migration step, migrate vehicles.
+  virtual void DoStep();
+
+private:
+
+  enum { GHOST_SIZE = 11 };
+  enum { LO = 0, HI = 1 };
+
+  // Pack the ghosts of the local vehicles near the slab boundaries, exchange
+  // them and unpack the received ones.
+  void ExchangeGhosts();
+
+  // Send the vehicles outside the slab to the neighbor ranks, and add the
+  // vehicles received from them.
+  void Migrate();
+
+  // Exchange the send buffers with the lower and upper neighbor ranks.
+  void Exchange(int tag);
+
+  MPI_Comm                   m_comm;
+  int                        m_rank;
+  int                        m_size;
+  double                     m_x_min;
+  double                     m_width;     // slab width
+  double                     m_halo;
+  int                        m_migration_steps;
+  ChDistributedFleetFactory* m_factory;
+
+  std::vector<int>           m_ids;       // global IDs of the local vehicles
+  std::vector<ChFleetGhost>  m_ghosts;
+
+  std::vector<double>        m_send[2];   // to the lower and upper neighbors
+  std::vector<double>        m_recv[2];   // from the lower and upper neighbors
+  ChVehicleState             m_snapshot;  // migrating vehicle
+
+  int                        m_num_sent;
+  int                        m_num_received;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -24,7 +24,9 @@
 #include "physics/ChShaft.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysHeap.h"
 #include "subsys/ChSuspension.h"
+#include "subsys/ChShaftNetwork.h"
 
 namespace chrono {
 
@@ -38,6 +40,10 @@ public:
   ChDriveline();
   virtual ~ChDriveline() {}
 
+  /// Allocate subsystem objects from the contiguous subsystem heap.
+  static void* operator new(size_t size) { return vehicle::ChSubsysHeap::Allocate(size); }
+  static void operator delete(void* ptr) { vehicle::ChSubsysHeap::Free(ptr); }
+
   /// Return the number of driven axles.
   virtual int GetNumDrivenAxles() const = 0;
 
@@ -55,6 +61,12 @@ public:
   /// powertrain system (i.e., right after the transmission box).
   ChSharedPtr<ChShaft> GetDriveshaft() const { return m_driveshaft; }
 
+  /// Get the network of shafts solved outside the Chrono system, if this
+  /// driveline is partitioned (empty otherwise). The driveshaft is then a
+  /// shaft of this network, and a shafts powertrain connected to it is added
+  /// to the network. The vehicle advances the network before each step.
+  ChSharedPtr<vehicle::ChShaftNetwork> GetShaftNetwork() const { return m_network; }
+
   /// Get the angular speed of the driveshaft.
   /// This represents the output from the driveline subsystem that is passed to
   /// the powertrain system. The default implementation returns the driveline's
@@ -76,6 +88,7 @@ public:
 protected:
 
   ChSharedPtr<ChShaft>  m_driveshaft;   ///< handle to the shaft connection to the powertrain
+  ChSharedPtr<vehicle::ChShaftNetwork> m_network;  ///< shafts solved outside the system (partitioned driveline)
 
   std::vector<int>      m_driven_axles; ///< indexes of the driven vehicle axles
 };
@@ -19,57 +19,132 @@
 //
 // =============================================================================
 
-#include <iostream>
-#include <sstream>
-#include <fstream>
+#include <cstdio>
+
+#include "core/ChLog.h"
 
 #include "subsys/ChDriver.h"
+#include "subsys/driver/ChDriverTrace.h"
 
 
 namespace chrono {
 
 
+// Header of a binary driver trace file (see ChDriverTrace): magic, number of
+// entries and a reserved word.
+static const char TRACE_MAGIC[8] = {'C', 'H', 'D', 'R', 'V', '1', 0, 0};
+
+static const size_t LOG_BUFFER_SIZE = 1 << 16;
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ChDriver::ChDriver()
 : m_throttle(0),
   m_steering(0),
   m_braking(0),
-  m_log_filename("")
+  m_log_format(LOG_TEXT),
+  m_log_count(0)
+{
+}
+
+ChDriver::~ChDriver()
 {
+  LogClose();
 }
 
 // -----------------------------------------------------------------------------
 // Initialize output file for recording deriver inputs.
+// The number of entries of a binary trace is written when the file is closed.
 // -----------------------------------------------------------------------------
-bool ChDriver::LogInit(const std::string& filename)
+bool ChDriver::LogInit(const std::string& filename, LogFormat format)
 {
-  m_log_filename = filename;
+  LogClose();
 
-  std::ofstream ofile(filename.c_str(), std::ios::out);
-  if (!ofile)
+  // The entry count of a binary trace is patched in place when closed.
+  if (format == LOG_BINARY && vehicle::ChCompressedFile::GetCodec(filename) != vehicle::ChCompressedFile::NONE) {
+    GetLog() << "ERROR: binary driver traces cannot be compressed: " << filename.c_str() << "\n";
     return false;
+  }
 
-  ofile << "Time\tSteering\tThrottle\tBraking\n";
-  ofile.close();
+  m_log_file.SetBufferSize(LOG_BUFFER_SIZE);
+  if (!m_log_file.OpenWrite(filename, vehicle::ChCompressedFile::AUTO, 0, format == LOG_TEXT))
+    return false;
+
+  bool ok;
+  if (format == LOG_BINARY) {
+    unsigned int header[2] = {0, 0};
+    ok = m_log_file.Write(TRACE_MAGIC, sizeof(TRACE_MAGIC)) && m_log_file.Write(header, sizeof(header));
+  } else {
+    ok = m_log_file.Write(std::string("Time\tSteering\tThrottle\tBraking\n"));
+  }
+
+  if (!ok) {
+    m_log_file.Close();
+    return false;
+  }
+
+  m_log_format = format;
+  m_log_count = 0;
   return true;
 }
 
 
 // -----------------------------------------------------------------------------
-// Record the current driver inputs to the log file.
+// Record the current driver inputs to the log file (buffered). The text format
+// has the same precision as the default stream output.
 // -----------------------------------------------------------------------------
 bool ChDriver::Log(double time)
 {
-  if (m_log_filename.empty())
+  if (!m_log_file.IsOpen())
     return false;
 
-  std::ofstream ofile(m_log_filename.c_str(), std::ios::app);
-  if (!ofile)
+  bool ok;
+  if (m_log_format == LOG_BINARY) {
+    ChDriverEntry entry(time, m_steering, m_throttle, m_braking);
+    ok = m_log_file.Write(&entry, sizeof(ChDriverEntry));
+  } else {
+    char buf[128];
+    int n = sprintf(buf, "%g\t%g\t%g\t%g\n", time, m_steering, m_throttle, m_braking);
+    ok = m_log_file.Write(buf, n);
+  }
+
+  if (ok)
+    m_log_count++;
+  return ok;
+}
+
+void ChDriver::LogClose()
+{
+  if (!m_log_file.IsOpen())
+    return;
+
+  if (m_log_format == LOG_BINARY)
+    m_log_file.WriteAt(sizeof(TRACE_MAGIC), &m_log_count, sizeof(unsigned int));
+
+  m_log_file.Close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Save and restore the current driver inputs.
+// -----------------------------------------------------------------------------
+void ChDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(3);
+  state.Write(m_throttle);
+  state.Write(m_steering);
+  state.Write(m_braking);
+}
+
+bool ChDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(3, "driver"))
     return false;
 
-  ofile << time << "\t" << m_steering << "\t" << m_throttle << "\t" << m_braking << std::endl;
-  ofile.close();
+  m_throttle = state.Read();
+  m_steering = state.Read();
+  m_braking = state.Read();
   return true;
 }
 
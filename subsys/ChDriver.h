@@ -26,6 +26,8 @@
 #include "physics/ChSystem.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChCompressedFile.h"
 
 namespace chrono {
 
@@ -39,8 +41,16 @@ class CH_SUBSYS_API ChDriver : public ChShared
 {
 public:
 
+  /// Format of the file recording the driver inputs.
+  enum LogFormat {
+    LOG_TEXT,     ///< tab-separated text, with a header line
+    LOG_BINARY    ///< binary driver trace, which ChDataDriver loads directly (see ChDriverTrace)
+  };
+
   ChDriver();
-  virtual ~ChDriver() {}
+
+  /// Close the log file (if open).
+  virtual ~ChDriver();
 
   /// Get the driver throttle input (in the range [0,1])
   double GetThrottle() const { return m_throttle; }
@@ -58,11 +68,24 @@ public:
   virtual void Advance(double step) {}
 
   /// Initialize output file for recording driver inputs.
-  bool LogInit(const std::string& filename);
+  /// The file is kept open, with a large buffer, until LogClose() is called
+  /// or the driver is destroyed; a binary trace is only complete once closed.
+  /// A text log is compressed if the file name has a ".lz4" or ".zst"
+  /// extension (see ChCompressedFile); binary traces cannot be compressed.
+  bool LogInit(const std::string& filename, LogFormat format = LOG_TEXT);
 
   /// Record the current driver inputs to the log file.
   bool Log(double time);
 
+  /// Write the buffered inputs and close the log file.
+  void LogClose();
+
+  /// Append the current driver inputs to the specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs from the next block of the specified snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
 protected:
   /// clamp to interval
   double clamp(double val, double min_val, double max_val);
@@ -81,7 +104,12 @@ protected:
   double m_braking;    ///< current value of braking input
 
 private:
-  std::string  m_log_filename;  // name of output file for recording driver inputs
+  ChDriver(const ChDriver&);
+  ChDriver& operator=(const ChDriver&);
+
+  vehicle::ChCompressedFile m_log_file;   // output file for recording driver inputs
+  LogFormat                 m_log_format;
+  unsigned int              m_log_count;  // number of inputs recorded
 
 };
 
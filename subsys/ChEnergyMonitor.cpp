@@ -0,0 +1,203 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Energy accounting of the power flow through the drivetrain.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChEnergyMonitor.h"
+#include "subsys/ChVehicleSimulation.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const char* ENERGY_flow_names[ChEnergyMonitor::NUM_FLOWS] = {
+  "engine",
+  "converter_loss",
+  "transmission_loss",
+  "driveshaft",
+  "driveline_loss",
+  "wheels",
+  "brake_loss",
+  "tire_slip_loss",
+  "traction"
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChEnergyMonitor::ChEnergyMonitor()
+{
+  Reset();
+}
+
+void ChEnergyMonitor::Reset()
+{
+  m_num_updates = 0;
+  m_first_time = 0;
+  m_last_time = 0;
+
+  for (int k = 0; k < NUM_FLOWS; k++) {
+    m_energy[k] = 0;
+    m_peak[k] = 0;
+    m_power[k] = 0;
+  }
+
+  m_brake_energy.resize(0);
+  m_slip_energy.resize(0);
+  m_brake_power.resize(0);
+  m_slip_power.resize(0);
+}
+
+// -----------------------------------------------------------------------------
+// The torque converter output speed is the engine speed times one minus the
+// slippage; without a converter (zero torques), there is no converter loss.
+// The power of a tire force on its wheel is the force times the velocity of
+// its application point, plus the moment times the wheel angular velocity;
+// on a fixed terrain, the tire dissipates the opposite of this power.
+// -----------------------------------------------------------------------------
+void ChEnergyMonitor::Update(const ChVehicleSimulation& sim)
+{
+  const ChVehicle& vehicle = *sim.GetVehicle();
+  const ChPowertrain& powertrain = *sim.GetPowertrain();
+  const ChDriveline& driveline = *vehicle.GetDriveline();
+  const ChWheelStates& states = sim.GetWheelStates();
+  const ChTireForces& forces = sim.GetTireForces();
+  int num_wheels = sim.GetNumWheels();
+
+  double engine_speed = powertrain.GetMotorSpeed();
+  double converter_in = powertrain.GetTorqueConverterInputTorque() * engine_speed;
+  double converter_out = powertrain.GetTorqueConverterOutputTorque() * engine_speed *
+                         (1 - powertrain.GetTorqueConverterSlippage());
+
+  double power[NUM_FLOWS];
+  power[ENGINE] = powertrain.GetMotorTorque() * engine_speed;
+  power[CONVERTER_LOSS] = converter_in - converter_out;
+  power[DRIVESHAFT] = sim.GetPowertrainTorque() * sim.GetDriveshaftSpeed();
+  power[TRANSMISSION_LOSS] = power[ENGINE] - power[CONVERTER_LOSS] - power[DRIVESHAFT];
+  power[WHEELS] = 0;
+  power[BRAKE_LOSS] = 0;
+  power[TIRE_SLIP_LOSS] = 0;
+  power[TRACTION] = 0;
+
+  ChWheelArray<double> brake_power(num_wheels);
+  ChWheelArray<double> slip_power(num_wheels);
+  for (int i = 0; i < num_wheels; i++) {
+    ChWheelID wheel_id(i);
+    const ChWheelState& state = states[i];
+    const ChTireForce& tire = forces[i];
+
+    power[WHEELS] += driveline.GetWheelTorque(wheel_id) * state.omega;
+
+    ChSharedPtr<ChBrake> brake = vehicle.GetBrake(wheel_id);
+    brake_power[i] = brake.IsNull() ? 0 : std::abs(brake->GetBrakeTorque() * brake->GetBrakeSpeed());
+    power[BRAKE_LOSS] += brake_power[i];
+
+    ChVector<> point_vel = state.lin_vel + (state.ang_vel % (tire.point - state.pos));
+    double traction = tire.force ^ state.lin_vel;
+    slip_power[i] = -((tire.force ^ point_vel) + (tire.moment ^ state.ang_vel));
+    power[TIRE_SLIP_LOSS] += slip_power[i];
+    power[TRACTION] += traction;
+  }
+  power[DRIVELINE_LOSS] = power[DRIVESHAFT] - power[WHEELS];
+
+  double time = sim.GetTime();
+  if (m_num_updates == 0) {
+    m_first_time = time;
+    m_brake_energy.resize(num_wheels);
+    m_slip_energy.resize(num_wheels);
+    for (int i = 0; i < num_wheels; i++)
+      m_brake_energy[i] = m_slip_energy[i] = 0;
+    for (int k = 0; k < NUM_FLOWS; k++)
+      m_peak[k] = power[k];
+  } else {
+    double half_dt = 0.5 * (time - m_last_time);
+    for (int k = 0; k < NUM_FLOWS; k++) {
+      m_energy[k] += half_dt * (power[k] + m_power[k]);
+      if (power[k] > m_peak[k])
+        m_peak[k] = power[k];
+    }
+    for (int i = 0; i < num_wheels; i++) {
+      m_brake_energy[i] += half_dt * (brake_power[i] + m_brake_power[i]);
+      m_slip_energy[i] += half_dt * (slip_power[i] + m_slip_power[i]);
+    }
+  }
+
+  for (int k = 0; k < NUM_FLOWS; k++)
+    m_power[k] = power[k];
+  m_brake_power = brake_power;
+  m_slip_power = slip_power;
+  m_last_time = time;
+  m_num_updates++;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChEnergyMonitor::GetMeanPower(Flow flow) const
+{
+  double duration = GetDuration();
+  return (duration > 0) ? m_energy[flow] / duration : 0;
+}
+
+double ChEnergyMonitor::GetWheelStorage() const
+{
+  return m_energy[WHEELS] - m_energy[BRAKE_LOSS] - m_energy[TIRE_SLIP_LOSS] - m_energy[TRACTION];
+}
+
+double ChEnergyMonitor::GetEfficiency() const
+{
+  return (m_energy[ENGINE] > 0) ? m_energy[TRACTION] / m_energy[ENGINE] : 0;
+}
+
+const char* ChEnergyMonitor::GetFlowName(Flow flow)
+{
+  return ENERGY_flow_names[flow];
+}
+
+bool ChEnergyMonitor::WriteReport(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  double engine = m_energy[ENGINE];
+  double inv_engine = (engine != 0) ? 1 / engine : 0;
+
+  fprintf(fp, "flow,energy,mean_power,peak_power,fraction\n");
+  for (int k = 0; k < NUM_FLOWS; k++) {
+    Flow flow = Flow(k);
+    fprintf(fp, "%s,%.10g,%.10g,%.10g,%.10g\n", GetFlowName(flow), m_energy[k], GetMeanPower(flow), m_peak[k],
+            m_energy[k] * inv_engine);
+  }
+  fprintf(fp, "wheel_storage,%.10g,,,%.10g\n", GetWheelStorage(), GetWheelStorage() * inv_engine);
+  for (int i = 0; i < (int)m_brake_energy.size(); i++) {
+    fprintf(fp, "brake_loss_%d,%.10g,,,%.10g\n", i, m_brake_energy[i], m_brake_energy[i] * inv_engine);
+    fprintf(fp, "tire_slip_loss_%d,%.10g,,,%.10g\n", i, m_slip_energy[i], m_slip_energy[i] * inv_engine);
+  }
+
+  return fclose(fp) == 0;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
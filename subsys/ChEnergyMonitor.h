@@ -0,0 +1,146 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Energy accounting of the power flow through the drivetrain of a vehicle
+// simulation, for efficiency studies without writing full traces.
+//
+// At each update, the power at each stage of the drivetrain is evaluated from
+// the current state of the simulation and integrated over time (trapezoidal
+// rule) into a few accumulators:
+//   - engine output: engine torque times engine speed;
+//   - torque converter loss: input power minus output power of the converter,
+//     the converter output speed following from its slippage;
+//   - transmission loss: converter output power minus driveshaft power;
+//   - driveshaft: powertrain output torque times driveshaft speed;
+//   - driveline loss: driveshaft power minus the power at the wheels;
+//   - wheels: driveline torque on each wheel times the wheel speed;
+//   - brake loss: brake torque times the relative speed of each brake;
+//   - tire slip loss: power dissipated by the tire forces (slip and rolling
+//     resistance), i.e. minus their power on the wheel, on a fixed terrain;
+//   - traction: power of the tire forces on the wheel centers, which drives
+//     the vehicle.
+// The remainder of the wheel power (wheel power minus the brake, tire and
+// traction terms) is the energy stored in the spinning wheels. All flows are
+// signed (e.g. the engine output is negative under engine braking).
+//
+// The monitor attached to a ChVehicleSimulation (see
+// ChVehicleSimulation::SetEnergyMonitor()) is updated at the end of each step.
+// An update costs a constant time per wheel and does not allocate. The energy
+// balance of the run is written with WriteReport().
+//
+// =============================================================================
+
+#ifndef CH_ENERGY_MONITOR_H
+#define CH_ENERGY_MONITOR_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChVehicleSimulation;
+
+///
+/// Integration of the power flow through the drivetrain.
+///
+class CH_SUBSYS_API ChEnergyMonitor
+{
+public:
+
+  /// Power flows, in drivetrain order.
+  enum Flow {
+    ENGINE,               ///< engine output
+    CONVERTER_LOSS,       ///< loss in the torque converter
+    TRANSMISSION_LOSS,    ///< loss between torque converter and driveshaft
+    DRIVESHAFT,           ///< powertrain output, on the driveshaft
+    DRIVELINE_LOSS,       ///< loss between driveshaft and wheels
+    WHEELS,               ///< driveline output, on all wheels
+    BRAKE_LOSS,           ///< dissipation in all brakes
+    TIRE_SLIP_LOSS,       ///< dissipation in all tires
+    TRACTION,             ///< tire force power on all wheel centers
+    NUM_FLOWS
+  };
+
+  ChEnergyMonitor();
+  ~ChEnergyMonitor() {}
+
+  /// Discard all accumulated values.
+  void Reset();
+
+  /// Evaluate and integrate all power flows for the current state of the
+  /// simulation.
+  void Update(const ChVehicleSimulation& sim);
+
+  /// Get the number of updates and the time integrated since the first one.
+  int    GetNumUpdates() const { return m_num_updates; }
+  double GetDuration() const { return m_last_time - m_first_time; }
+
+  /// Get the energy of the specified flow (time integral of its power).
+  double GetEnergy(Flow flow) const { return m_energy[flow]; }
+
+  /// Get the largest power of the specified flow.
+  double GetPeakPower(Flow flow) const { return m_peak[flow]; }
+
+  /// Get the mean power of the specified flow.
+  double GetMeanPower(Flow flow) const;
+
+  /// Get the energy dissipated in the brake and in the tire of the specified
+  /// wheel.
+  double GetBrakeEnergy(const ChWheelID& wheel_id) const { return m_brake_energy[wheel_id]; }
+  double GetTireSlipEnergy(const ChWheelID& wheel_id) const { return m_slip_energy[wheel_id]; }
+
+  /// Get the energy stored in the spinning wheels (remainder of the wheel
+  /// energy after the brake, tire and traction terms).
+  double GetWheelStorage() const;
+
+  /// Get the ratio of the traction energy to the engine output (0 if the
+  /// engine output is not positive).
+  double GetEfficiency() const;
+
+  /// Get the name of the specified flow, as written in the report.
+  static const char* GetFlowName(Flow flow);
+
+  /// Write the energy balance, one CSV row per flow (energy, mean and peak
+  /// power, fraction of the engine output), then one row per wheel for the
+  /// brake and tire losses. Returns false if the file cannot be written.
+  bool WriteReport(const std::string& filename) const;
+
+private:
+
+  ChEnergyMonitor(const ChEnergyMonitor&);
+  ChEnergyMonitor& operator=(const ChEnergyMonitor&);
+
+  int                  m_num_updates;
+  double               m_first_time;
+  double               m_last_time;
+
+  double               m_energy[NUM_FLOWS];
+  double               m_peak[NUM_FLOWS];
+  double               m_power[NUM_FLOWS];        // at the last update
+  ChWheelArray<double> m_brake_energy;
+  ChWheelArray<double> m_slip_energy;
+  ChWheelArray<double> m_brake_power;             // at the last update
+  ChWheelArray<double> m_slip_power;              // at the last update
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
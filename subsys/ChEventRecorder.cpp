@@ -0,0 +1,382 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Recorder of periodic keyframes of a simulation.
+//
+// =============================================================================
+
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChEventRecorder.h"
+#include "subsys/ChVehicleSimulation.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const char KEYFRAME_MAGIC[8] = {'C', 'H', 'K', 'E', 'Y', '1', 0, 0};
+static const char INDEX_MAGIC[8] = {'C', 'H', 'K', 'E', 'Y', 'I', 'D', 'X'};
+
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+enum ChunkType {
+  KEYFRAME_CHUNK = 1,
+  INPUTS_CHUNK = 2,
+  INDEX_CHUNK = 3
+};
+
+// Tolerance on the keyframe times (the simulation loop computes the time of a
+// step from the step number, so the recorded times are reproduced exactly).
+static const double TIME_TOLERANCE = 1e-9;
+
+static bool compare_time(const ChDriverEntry& a, const ChDriverEntry& b) { return a.m_time < b.m_time; }
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChEventRecorder::ChEventRecorder()
+: m_file(0),
+  m_mode(IDLE),
+  m_interval(10),
+  m_next_time(0),
+  m_cursor(0),
+  m_current(-1),
+  m_num_mismatches(0)
+{
+}
+
+ChEventRecorder::~ChEventRecorder()
+{
+  Close();
+}
+
+bool ChEventRecorder::write_chunk(unsigned int type, unsigned int count)
+{
+  uint32 header[2] = {type, count};
+  return fwrite(header, sizeof(uint32), 2, m_file) == 2;
+}
+
+bool ChEventRecorder::read_chunk(unsigned int& type, unsigned int& count)
+{
+  uint32 header[2];
+  if (fread(header, sizeof(uint32), 2, m_file) != 2)
+    return false;
+  type = header[0];
+  count = header[1];
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Recording.
+// -----------------------------------------------------------------------------
+bool ChEventRecorder::Create(const std::string& filename)
+{
+  Close();
+
+  m_file = fopen(filename.c_str(), "wb");
+  if (!m_file) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  if (fwrite(KEYFRAME_MAGIC, 1, sizeof(KEYFRAME_MAGIC), m_file) != sizeof(KEYFRAME_MAGIC)) {
+    GetLog() << "ERROR: cannot write " << filename.c_str() << "\n";
+    fclose(m_file);
+    m_file = 0;
+    return false;
+  }
+
+  m_mode = RECORD;
+  m_next_time = -1e300;
+  m_keyframes.clear();
+  m_inputs.clear();
+
+  return true;
+}
+
+bool ChEventRecorder::flush_inputs()
+{
+  bool ok = true;
+  if (!m_inputs.empty()) {
+    ok = write_chunk(INPUTS_CHUNK, (uint32)m_inputs.size()) &&
+         fwrite(&m_inputs[0], sizeof(ChDriverEntry), m_inputs.size(), m_file) == m_inputs.size();
+  }
+  m_inputs.clear();
+
+  return ok;
+}
+
+bool ChEventRecorder::Close()
+{
+  if (m_mode == IDLE)
+    return true;
+
+  bool ok = true;
+  if (m_mode == RECORD) {
+    ok = flush_inputs();
+    uint64 offset = (uint64)ftell(m_file);
+    ok = ok && write_chunk(INDEX_CHUNK, (uint32)m_keyframes.size());
+    if (ok && !m_keyframes.empty())
+      ok = fwrite(&m_keyframes[0], sizeof(Keyframe), m_keyframes.size(), m_file) == m_keyframes.size();
+    ok = ok && fwrite(&offset, sizeof(uint64), 1, m_file) == 1 &&
+         fwrite(INDEX_MAGIC, 1, sizeof(INDEX_MAGIC), m_file) == sizeof(INDEX_MAGIC);
+    if (!ok)
+      GetLog() << "ERROR: cannot write the keyframe index\n";
+  }
+
+  if (fclose(m_file) != 0)
+    ok = false;
+
+  m_file = 0;
+  m_mode = IDLE;
+  m_keyframes.clear();
+  m_inputs.clear();
+  m_current = -1;
+
+  return ok;
+}
+
+// The keyframe is written at the beginning of the step, before the driver
+// inputs of that step are logged, so that the inputs following a keyframe
+// start at its time.
+void ChEventRecorder::OnStep(ChVehicleSimulation& sim)
+{
+  double time = sim.GetTime();
+
+  if (m_mode == PLAYBACK) {
+    int next = m_current + 1;
+    if (next < (int)m_keyframes.size() && time >= m_keyframes[next].time - TIME_TOLERANCE)
+      load_keyframe(next, false);
+    return;
+  }
+
+  if (m_mode != RECORD || sim.IsKinematic() || time < m_next_time - TIME_TOLERANCE)
+    return;
+
+  m_snapshot.Clear();
+  sim.SaveState(m_snapshot);
+
+  Keyframe keyframe;
+  keyframe.time = time;
+  bool ok = flush_inputs();
+  keyframe.offset = (uint64)ftell(m_file);
+  ok = ok && write_chunk(KEYFRAME_CHUNK, (uint32)m_snapshot.GetSize()) &&
+       fwrite(&time, sizeof(double), 1, m_file) == 1 &&
+       fwrite(m_snapshot.GetData(), sizeof(double), m_snapshot.GetSize(), m_file) == m_snapshot.GetSize() &&
+       fflush(m_file) == 0;
+
+  if (!ok) {
+    GetLog() << "ERROR: cannot write keyframe at time " << time << "; recording stopped\n";
+    fclose(m_file);
+    m_file = 0;
+    m_mode = IDLE;
+    return;
+  }
+
+  m_keyframes.push_back(keyframe);
+  m_next_time = time + m_interval;
+}
+
+void ChEventRecorder::Apply(double time, double& steering, double& throttle, double& braking)
+{
+  if (m_mode == RECORD) {
+    m_inputs.push_back(ChDriverEntry(time, steering, throttle, braking));
+    return;
+  }
+
+  if (m_mode != PLAYBACK)
+    return;
+
+  size_t n = m_inputs.size();
+  if (m_cursor >= n || m_inputs[m_cursor].m_time != time) {
+    m_cursor = std::lower_bound(m_inputs.begin(), m_inputs.end(), ChDriverEntry(time, 0, 0, 0), compare_time) -
+               m_inputs.begin();
+    if (m_cursor >= n || m_inputs[m_cursor].m_time != time) {
+      m_num_mismatches++;
+      return;
+    }
+  }
+
+  const ChDriverEntry& e = m_inputs[m_cursor++];
+  steering = e.m_steering;
+  throttle = e.m_throttle;
+  braking = e.m_braking;
+}
+
+// -----------------------------------------------------------------------------
+// Playback.
+// -----------------------------------------------------------------------------
+bool ChEventRecorder::Open(const std::string& filename)
+{
+  Close();
+
+  m_file = fopen(filename.c_str(), "rb");
+  if (!m_file) {
+    GetLog() << "ERROR: cannot open recording " << filename.c_str() << "\n";
+    return false;
+  }
+
+  char magic[8];
+  bool ok = fread(magic, 1, sizeof(magic), m_file) == sizeof(magic) &&
+            std::memcmp(magic, KEYFRAME_MAGIC, sizeof(magic)) == 0;
+
+  // Read the index, if the recording was closed.
+  bool indexed = false;
+  uint64 offset = 0;
+  unsigned int type = 0;
+  unsigned int count = 0;
+  if (ok && fseek(m_file, -(long)(sizeof(uint64) + sizeof(INDEX_MAGIC)), SEEK_END) == 0 &&
+      fread(&offset, sizeof(uint64), 1, m_file) == 1 && fread(magic, 1, sizeof(magic), m_file) == sizeof(magic) &&
+      std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0 && fseek(m_file, (long)offset, SEEK_SET) == 0 &&
+      read_chunk(type, count) && type == INDEX_CHUNK) {
+    m_keyframes.resize(count);
+    indexed = (count == 0) || fread(&m_keyframes[0], sizeof(Keyframe), count, m_file) == count;
+  }
+
+  if (ok && !indexed) {
+    GetLog() << "WARNING: recording " << filename.c_str() << " has no index; scanning it\n";
+    ok = scan();
+  }
+
+  if (!ok || m_keyframes.empty()) {
+    GetLog() << "ERROR: invalid recording " << filename.c_str() << "\n";
+    fclose(m_file);
+    m_file = 0;
+    m_keyframes.clear();
+    return false;
+  }
+
+  m_mode = PLAYBACK;
+  m_inputs.clear();
+  m_cursor = 0;
+  m_current = -1;
+  m_num_mismatches = 0;
+
+  return true;
+}
+
+// The scan stops at the first incomplete chunk.
+bool ChEventRecorder::scan()
+{
+  m_keyframes.clear();
+
+  if (fseek(m_file, 0, SEEK_END) != 0)
+    return false;
+  uint64 size = (uint64)ftell(m_file);
+  uint64 pos = sizeof(KEYFRAME_MAGIC);
+
+  while (fseek(m_file, (long)pos, SEEK_SET) == 0) {
+    unsigned int type, count;
+    if (!read_chunk(type, count))
+      break;
+
+    uint64 payload;
+    switch (type) {
+    case KEYFRAME_CHUNK: payload = sizeof(double) * (1 + (uint64)count); break;
+    case INPUTS_CHUNK: payload = sizeof(ChDriverEntry) * (uint64)count; break;
+    case INDEX_CHUNK: payload = sizeof(Keyframe) * (uint64)count; break;
+    default: payload = size; break;
+    }
+    uint64 end = pos + 2 * sizeof(uint32) + payload;
+    if (end > size)
+      break;
+
+    if (type == KEYFRAME_CHUNK) {
+      Keyframe keyframe;
+      keyframe.offset = pos;
+      if (fread(&keyframe.time, sizeof(double), 1, m_file) != 1)
+        break;
+      m_keyframes.push_back(keyframe);
+    }
+
+    pos = end;
+  }
+
+  return true;
+}
+
+bool ChEventRecorder::load_keyframe(int keyframe, bool snapshot)
+{
+  unsigned int type, count;
+  double time;
+  bool ok = fseek(m_file, (long)m_keyframes[keyframe].offset, SEEK_SET) == 0 &&
+            read_chunk(type, count) && type == KEYFRAME_CHUNK &&
+            fread(&time, sizeof(double), 1, m_file) == 1;
+
+  if (ok && snapshot) {
+    std::vector<double> values(count);
+    ok = (count == 0) || fread(&values[0], sizeof(double), count, m_file) == count;
+    if (ok)
+      m_snapshot.Assign(values.empty() ? 0 : &values[0], values.size());
+  } else if (ok) {
+    ok = fseek(m_file, (long)(sizeof(double) * count), SEEK_CUR) == 0;
+  }
+
+  // The inputs logged after the keyframe (none if the run ended there).
+  m_inputs.clear();
+  m_cursor = 0;
+  if (ok && read_chunk(type, count) && type == INPUTS_CHUNK && count > 0) {
+    m_inputs.resize(count);
+    if (fread(&m_inputs[0], sizeof(ChDriverEntry), count, m_file) != count)
+      m_inputs.clear();
+  }
+
+  m_current = keyframe;
+
+  if (!ok)
+    GetLog() << "ERROR: cannot read keyframe " << keyframe << "\n";
+
+  return ok;
+}
+
+bool ChEventRecorder::Seek(ChVehicleSimulation& sim, double time)
+{
+  if (m_mode != PLAYBACK) {
+    GetLog() << "ERROR: ChEventRecorder::Seek: no recording open for playback\n";
+    return false;
+  }
+
+  // Last keyframe at or before the requested time.
+  int keyframe = -1;
+  for (int k = 0; k < (int)m_keyframes.size() && m_keyframes[k].time <= time + TIME_TOLERANCE; k++)
+    keyframe = k;
+
+  if (keyframe < 0) {
+    GetLog() << "ERROR: ChEventRecorder::Seek: no keyframe before time " << time << "\n";
+    return false;
+  }
+
+  if (!load_keyframe(keyframe, true))
+    return false;
+
+  if (!sim.RestoreState(m_snapshot)) {
+    GetLog() << "ERROR: ChEventRecorder::Seek: cannot restore keyframe " << keyframe << "\n";
+    return false;
+  }
+
+  sim.SetEventRecorder(this);
+  while (sim.GetTime() < time - TIME_TOLERANCE)
+    sim.DoStep();
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,174 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Recorder of periodic keyframes of a simulation, for seeking into long runs.
+//
+// While recording, the recorder attached to a ChVehicleSimulation (see
+// ChVehicleSimulation::SetEventRecorder()) writes a snapshot of the whole
+// simulation (see ChVehicleSimulation::SaveState()) at the first step of each
+// keyframe interval, and logs the driver inputs of all steps in between. To
+// inspect the run at some time, Seek() restores the last keyframe before that
+// time and re-simulates the gap (at most one interval), substituting the
+// logged driver inputs (as ChReplayLog does). The playback then continues
+// through the following keyframe intervals, with the inputs of each interval
+// loaded as the simulation reaches it. The keyframe interval trades the file
+// size (one snapshot per interval) for the seek latency.
+//
+// The recording is a binary file, in the native byte order:
+//   magic "CHKEY1\0\0"          (8 bytes)
+//   chunks, each one holding the chunk type and the number of values (uint32)
+//   followed by
+//     KEYFRAME: the time (double) and the snapshot values (double)
+//     INPUTS:   the driver inputs logged after the previous keyframe
+//               (time, steering, throttle, braking: double)
+//     INDEX:    the time (double) and file offset (uint64) of each keyframe
+//   offset of the INDEX chunk (uint64) and magic "CHKEYIDX" (8 bytes)
+// The chunks are flushed as they are written. The index and the trailer are
+// written by Close(); a recording without them (e.g. of a run that crashed) is
+// indexed by scanning its chunks, up to the last complete one.
+//
+// A seek reproduces the recorded run only under the conditions of a replay
+// (see ChReplayLog). Keyframes are not taken while the kinematic bicycle model
+// is active.
+//
+// =============================================================================
+
+#ifndef CH_EVENT_RECORDER_H
+#define CH_EVENT_RECORDER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/driver/ChDriverTrace.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChVehicleSimulation;
+
+///
+/// Keyframe recorder and seeker of a vehicle simulation.
+///
+class CH_SUBSYS_API ChEventRecorder
+{
+public:
+
+  enum Mode {
+    IDLE,      ///< no recording open
+    RECORD,    ///< write keyframes and driver inputs
+    PLAYBACK   ///< substitute the recorded driver inputs
+  };
+
+  ChEventRecorder();
+
+  /// Close the recording, if any.
+  ~ChEventRecorder();
+
+  /// Set the time interval between two keyframes (default: 10 s).
+  /// Must be called before Create().
+  void SetKeyframeInterval(double interval) { m_interval = interval; }
+
+  /// Get the time interval between two keyframes.
+  double GetKeyframeInterval() const { return m_interval; }
+
+  /// Get the current mode.
+  Mode GetMode() const { return m_mode; }
+
+  /// Create the specified recording file (replacing any existing one) and
+  /// start recording. Returns false if the file cannot be created.
+  bool Create(const std::string& filename);
+
+  /// Open the specified recording for playback, and read (or rebuild) its
+  /// keyframe index. Returns false if the file cannot be read or has no
+  /// keyframe.
+  bool Open(const std::string& filename);
+
+  /// Close the recording. While recording, the last driver inputs and the
+  /// keyframe index are written first. Returns false if they cannot be written.
+  bool Close();
+
+  /// Get the number of keyframes.
+  int GetNumKeyframes() const { return (int)m_keyframes.size(); }
+
+  /// Get the time of the specified keyframe.
+  double GetKeyframeTime(int keyframe) const { return m_keyframes[keyframe].time; }
+
+  /// Bring the specified simulation (identical to the recorded one) to the
+  /// first step at or after the specified time: restore the last keyframe at
+  /// or before that time, then take steps with the recorded driver inputs.
+  /// The recorder is attached to the simulation. Returns false if there is no
+  /// such keyframe or the snapshot cannot be read or restored.
+  bool Seek(ChVehicleSimulation& sim, double time);
+
+  /// Get the number of steps, since the recording was opened, for which no
+  /// driver inputs were recorded (while playing back).
+  int GetNumMismatches() const { return m_num_mismatches; }
+
+  /// Called by the simulation loop at the beginning of each step: while
+  /// recording, write a keyframe if it is due; while playing back, load the
+  /// driver inputs of the next keyframe interval when it is reached.
+  void OnStep(ChVehicleSimulation& sim);
+
+  /// Called by the simulation loop with the driver inputs of each step: while
+  /// recording, log them; while playing back, replace them with the recorded
+  /// ones.
+  void Apply(double time, double& steering, double& throttle, double& braking);
+
+private:
+
+  struct Keyframe {
+    double              time;
+    unsigned long long  offset;
+  };
+
+  ChEventRecorder(const ChEventRecorder&);
+  ChEventRecorder& operator=(const ChEventRecorder&);
+
+  // Write or read the header of a chunk.
+  bool write_chunk(unsigned int type, unsigned int count);
+  bool read_chunk(unsigned int& type, unsigned int& count);
+
+  // Write the inputs logged since the last keyframe.
+  bool flush_inputs();
+
+  // Rebuild the keyframe index by scanning the chunks.
+  bool scan();
+
+  // Read the snapshot of the specified keyframe and the inputs that follow it.
+  bool load_keyframe(int keyframe, bool snapshot);
+
+  FILE*                        m_file;
+  Mode                         m_mode;
+  double                       m_interval;
+  double                       m_next_time;       // time of the next keyframe (recording)
+
+  std::vector<Keyframe>        m_keyframes;
+  std::vector<ChDriverEntry>   m_inputs;          // inputs of the current interval
+  size_t                       m_cursor;          // next input to replay
+  int                          m_current;         // keyframe interval being played back
+  int                          m_num_mismatches;
+
+  ChVehicleState               m_snapshot;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
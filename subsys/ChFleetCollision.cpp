@@ -0,0 +1,262 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Penalty contact between the chassis of the vehicles of a fleet.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChFleetCollision.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// Sliding speed below which the friction force is reduced linearly.
+static const double FLEET_SLIP_SPEED = 0.1;
+
+// Return true if the point is inside the box.
+static bool fleet_box_contains(const ChVector<>& center, const ChVector<>* axes, const ChVector<>& half,
+                               const ChVector<>& point)
+{
+  ChVector<> d = point - center;
+  return std::abs(d ^ axes[0]) <= half.x && std::abs(d ^ axes[1]) <= half.y && std::abs(d ^ axes[2]) <= half.z;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFleetCollision::ChFleetCollision()
+: m_margin(0.5),
+  m_stiffness(2e6),
+  m_damping(2e4),
+  m_friction(0.3),
+  m_num_candidates(0),
+  m_num_contacts(0),
+  m_max_depth(0)
+{
+}
+
+void ChFleetCollision::SetNumVehicles(int num_vehicles)
+{
+  Box none;
+  none.radius = 0;
+
+  m_boxes.resize(num_vehicles, none);
+  m_force.resize(num_vehicles, ChVector<>(0, 0, 0));
+  m_torque.resize(num_vehicles, ChVector<>(0, 0, 0));
+}
+
+void ChFleetCollision::RemoveVehicle(int index)
+{
+  if (index < 0 || index >= (int)m_boxes.size())
+    return;
+
+  m_boxes.erase(m_boxes.begin() + index);
+  m_force.erase(m_force.begin() + index);
+  m_torque.erase(m_torque.begin() + index);
+}
+
+void ChFleetCollision::SetBox(int index, const ChVector<>& half_dims, const ChVector<>& center)
+{
+  Box& box = m_boxes[index];
+  box.half = ChVector<>(std::abs(half_dims.x), std::abs(half_dims.y), std::abs(half_dims.z));
+  box.center = center;
+
+  // The bounding sphere about the frame origin also bounds the planar extent
+  // of the box for any roll and pitch.
+  bool valid = box.half.x > 0 && box.half.y > 0 && box.half.z > 0;
+  box.radius = valid ? center.Length() + box.half.Length() : 0;
+}
+
+void ChFleetCollision::SetContactParameters(double stiffness, double damping, double friction)
+{
+  m_stiffness = stiffness;
+  m_damping = damping;
+  m_friction = friction;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFleetCollision::Compute(const ChTrafficIndex& index, const std::vector<ChBodyAuxRef*>& chassis)
+{
+  int num_vehicles = (int)m_boxes.size();
+
+  m_num_candidates = 0;
+  m_num_contacts = 0;
+  m_max_depth = 0;
+
+  double max_radius = 0;
+  for (int a = 0; a < num_vehicles; a++) {
+    m_force[a] = ChVector<>(0, 0, 0);
+    m_torque[a] = ChVector<>(0, 0, 0);
+    max_radius = std::max(max_radius, m_boxes[a].radius);
+  }
+
+  if (index.GetNumVehicles() != num_vehicles)
+    return;
+
+  // Each pair is tested once, by the vehicle with the lower index.
+  for (int a = 0; a < num_vehicles; a++) {
+    if (m_boxes[a].radius <= 0)
+      continue;
+
+    index.FindNearest(a, num_vehicles, m_boxes[a].radius + max_radius + m_margin, m_neighbors);
+    for (size_t k = 0; k < m_neighbors.size(); k++) {
+      int b = m_neighbors[k].index;
+      if (b > a && m_boxes[b].radius > 0 &&
+          m_neighbors[k].distance <= m_boxes[a].radius + m_boxes[b].radius + m_margin)
+        collide(a, b, chassis);
+    }
+  }
+}
+
+ChFleetCollision::WorldBox ChFleetCollision::world_box(const Box& box, const ChBodyAuxRef* chassis)
+{
+  const ChFrame<>& frame = chassis->GetFrame_REF_to_abs();
+  const ChQuaternion<>& rot = frame.GetRot();
+
+  WorldBox wb;
+  wb.center = frame.GetPos() + rot.Rotate(box.center);
+  wb.axes[0] = rot.GetXaxis();
+  wb.axes[1] = rot.GetYaxis();
+  wb.axes[2] = rot.GetZaxis();
+  wb.half = box.half;
+
+  return wb;
+}
+
+// -----------------------------------------------------------------------------
+// Separating axis test of the two boxes, on their face normals and on the
+// cross products of their edges.
+// -----------------------------------------------------------------------------
+void ChFleetCollision::collide(int a, int b, const std::vector<ChBodyAuxRef*>& chassis)
+{
+  WorldBox A = world_box(m_boxes[a], chassis[a]);
+  WorldBox B = world_box(m_boxes[b], chassis[b]);
+  const double hA[3] = { A.half.x, A.half.y, A.half.z };
+  const double hB[3] = { B.half.x, B.half.y, B.half.z };
+
+  ChVector<> T = B.center - A.center;
+
+  ChVector<> axes[15];
+  int num_axes = 0;
+  for (int i = 0; i < 3; i++) {
+    axes[num_axes++] = A.axes[i];
+    axes[num_axes++] = B.axes[i];
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      ChVector<> L = Vcross(A.axes[i], B.axes[j]);
+      double len = L.Length();
+      if (len > 1e-6)
+        axes[num_axes++] = L * (1 / len);
+    }
+  }
+
+  double depth = 0;
+  ChVector<> normal;
+  for (int k = 0; k < num_axes; k++) {
+    const ChVector<>& L = axes[k];
+    double rA = 0, rB = 0;
+    for (int i = 0; i < 3; i++) {
+      rA += hA[i] * std::abs(A.axes[i] ^ L);
+      rB += hB[i] * std::abs(B.axes[i] ^ L);
+    }
+    double dist = T ^ L;
+    double overlap = rA + rB - std::abs(dist);
+    if (overlap < -m_margin)
+      return;
+    if (k == 0 || overlap < depth) {
+      depth = overlap;
+      normal = (dist < 0) ? -L : L;
+    }
+  }
+
+  m_num_candidates++;
+  if (depth <= 0)
+    return;
+
+  m_num_contacts++;
+  m_max_depth = std::max(m_max_depth, depth);
+
+  // Contact point: mean of the vertices of each box inside the other box (the
+  // midpoint of the centers for an edge-edge contact).
+  ChVector<> point(0, 0, 0);
+  int num_points = 0;
+  for (int v = 0; v < 8; v++) {
+    double sx = (v & 1) ? 1 : -1;
+    double sy = (v & 2) ? 1 : -1;
+    double sz = (v & 4) ? 1 : -1;
+    ChVector<> pA = A.center + A.axes[0] * (sx * hA[0]) + A.axes[1] * (sy * hA[1]) + A.axes[2] * (sz * hA[2]);
+    ChVector<> pB = B.center + B.axes[0] * (sx * hB[0]) + B.axes[1] * (sy * hB[1]) + B.axes[2] * (sz * hB[2]);
+    if (fleet_box_contains(B.center, B.axes, B.half, pA)) {
+      point += pA;
+      num_points++;
+    }
+    if (fleet_box_contains(A.center, A.axes, A.half, pB)) {
+      point += pB;
+      num_points++;
+    }
+  }
+  point = (num_points > 0) ? point * (1.0 / num_points) : (A.center + B.center) * 0.5;
+
+  // Relative velocity of B with respect to A at the contact point.
+  const ChBodyAuxRef* ca = chassis[a];
+  const ChBodyAuxRef* cb = chassis[b];
+  ChVector<> va = ca->GetPos_dt() + Vcross(ca->GetWvel_par(), point - ca->GetPos());
+  ChVector<> vb = cb->GetPos_dt() + Vcross(cb->GetWvel_par(), point - cb->GetPos());
+  ChVector<> vrel = vb - va;
+
+  double vn = vrel ^ normal;
+  double Fn = std::max(m_stiffness * depth - m_damping * vn, 0.0);
+  ChVector<> force = normal * Fn;
+
+  ChVector<> vt = vrel - normal * vn;
+  double slip = vt.Length();
+  if (slip > 0)
+    force -= vt * (m_friction * Fn / std::max(slip, FLEET_SLIP_SPEED));
+
+  // The force acts on B, its opposite on A.
+  m_force[b] += force;
+  m_torque[b] += Vcross(point - cb->GetPos(), force);
+  m_force[a] -= force;
+  m_torque[a] -= Vcross(point - ca->GetPos(), force);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFleetCollision::Apply(int index, ChBodyAuxRef* chassis) const
+{
+  if (m_boxes[index].radius <= 0)
+    return;
+
+  chassis->Empty_forces_accumulators();
+  chassis->Accumulate_force(m_force[index], chassis->GetPos(), false);
+  chassis->Accumulate_torque(m_torque[index], false);
+}
+
+void ChFleetCollision::AddMemoryFootprint(ChMemoryReport& report) const
+{
+  report.Add("simulation/fleet collision", ChMemoryReport::VectorBytes(m_boxes) +
+                                           ChMemoryReport::VectorBytes(m_force) +
+                                           ChMemoryReport::VectorBytes(m_torque) +
+                                           ChMemoryReport::VectorBytes(m_neighbors));
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
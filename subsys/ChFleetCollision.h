@@ -0,0 +1,161 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Penalty contact between the chassis of the vehicles of a fleet, without a
+// shared Chrono system.
+//
+// Each vehicle may be given an oriented box, fixed to its chassis reference
+// frame. Each step, the candidate pairs are found with the traffic index: the
+// vehicles whose box bounding circles, enlarged by the margin, overlap in the
+// x-y plane. The boxes of each candidate pair are then tested with the
+// separating axis theorem (15 axes); the pairs separated by less than the
+// margin are counted, and the overlapping ones are in contact, with the normal
+// along the axis of least overlap and the contact point at the mean of the box
+// vertices inside the other box.
+//
+// Each contact produces a penalty force: a normal force (spring and damper on
+// the penetration depth, never attractive) and a regularized Coulomb friction
+// force. The forces and their moments about the chassis centers of mass are
+// summed per vehicle, then applied through the force accumulators of the
+// chassis bodies for the next step of each vehicle. Since the vehicles are not
+// coupled in a single system, the contact is explicit: the stiffness should be
+// chosen so that it is stable with the step size and the chassis masses.
+//
+// =============================================================================
+
+#ifndef CH_FLEET_COLLISION_H
+#define CH_FLEET_COLLISION_H
+
+#include <vector>
+
+#include "physics/ChBodyAuxRef.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTrafficIndex.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Penalty contact between the oriented chassis boxes of the vehicles of a
+/// fleet, with candidate pairs from a traffic index.
+///
+class CH_SUBSYS_API ChFleetCollision
+{
+public:
+
+  ChFleetCollision();
+  ~ChFleetCollision() {}
+
+  /// Set the number of vehicles. New vehicles have no box (no contact).
+  void SetNumVehicles(int num_vehicles);
+
+  /// Remove the specified vehicle. The indices of the following vehicles
+  /// decrease by one.
+  void RemoveVehicle(int index);
+
+  /// Get the number of vehicles.
+  int GetNumVehicles() const { return (int)m_boxes.size(); }
+
+  /// Set the box of the specified vehicle, aligned with its chassis reference
+  /// frame. A box with a zero half dimension disables the contact of the
+  /// vehicle.
+  void SetBox(
+    int                index,       ///< [in] index of the vehicle
+    const ChVector<>&  half_dims,   ///< [in] half dimensions of the box
+    const ChVector<>&  center       ///< [in] box center, in the chassis reference frame
+    );
+
+  /// Set the separation below which a pair of boxes is tested (default: 0.5 m).
+  void SetMargin(double margin) { m_margin = margin; }
+
+  /// Set the contact parameters (defaults: 2e6 N/m, 2e4 Ns/m, 0.3).
+  void SetContactParameters(
+    double stiffness,   ///< [in] normal stiffness
+    double damping,     ///< [in] normal damping
+    double friction     ///< [in] coefficient of friction
+    );
+
+  /// Find the contacts between the vehicle boxes and compute the contact
+  /// forces, from the current chassis states. The index must hold the current
+  /// vehicle positions; the chassis bodies are in vehicle order.
+  void Compute(const ChTrafficIndex& index, const std::vector<ChBodyAuxRef*>& chassis);
+
+  /// Apply the contact forces of the specified vehicle to its chassis body,
+  /// replacing the content of its force accumulators.
+  void Apply(int index, ChBodyAuxRef* chassis) const;
+
+  /// Get the total contact force on the specified vehicle (global frame).
+  const ChVector<>& GetForce(int index) const { return m_force[index]; }
+
+  /// Get the moment of the contact forces on the specified vehicle, about its
+  /// chassis center of mass (global frame).
+  const ChVector<>& GetTorque(int index) const { return m_torque[index]; }
+
+  /// Get the number of vehicle pairs within the margin at the last step.
+  int GetNumCandidates() const { return m_num_candidates; }
+
+  /// Get the number of vehicle pairs in contact at the last step.
+  int GetNumContacts() const { return m_num_contacts; }
+
+  /// Get the largest penetration depth at the last step.
+  double GetMaxPenetration() const { return m_max_depth; }
+
+  /// Add the boxes and the contact forces to the specified report.
+  void AddMemoryFootprint(ChMemoryReport& report) const;
+
+private:
+
+  struct Box {
+    ChVector<>  half;
+    ChVector<>  center;
+    double      radius;   // radius of the bounding circle in the x-y plane, about the frame origin
+  };
+
+  // Box of a vehicle in the global frame.
+  struct WorldBox {
+    ChVector<>  center;
+    ChVector<>  axes[3];
+    ChVector<>  half;
+  };
+
+  // Test the boxes of two vehicles and add their contact forces.
+  void collide(int a, int b, const std::vector<ChBodyAuxRef*>& chassis);
+
+  static WorldBox world_box(const Box& box, const ChBodyAuxRef* chassis);
+
+  std::vector<Box>         m_boxes;
+  std::vector<ChVector<> > m_force;
+  std::vector<ChVector<> > m_torque;
+
+  double  m_margin;
+  double  m_stiffness;
+  double  m_damping;
+  double  m_friction;
+
+  int     m_num_candidates;
+  int     m_num_contacts;
+  double  m_max_depth;
+
+  std::vector<ChTrafficIndex::Neighbor>  m_neighbors;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,594 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Lock-step simulation of a fleet of vehicles on a shared terrain.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChFleetSimulation.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Task performing the first or last phase of a step for one vehicle.
+// -----------------------------------------------------------------------------
+class ChFleetTask : public ChTask
+{
+public:
+  ChFleetTask(ChFleetSimulation* sim, int index) : m_sim(sim), m_index(index), m_advance(false) {}
+
+  void SetAdvance(bool advance) { m_advance = advance; }
+
+  virtual void Execute(int worker)
+  {
+    double start = ChProfiler::GetTime();
+    if (m_advance)
+      m_sim->AdvanceMember(m_index);
+    else
+      m_sim->UpdateMember(m_index);
+    m_sim->m_members[m_index].step_time += ChProfiler::GetTime() - start;
+  }
+
+private:
+  ChFleetSimulation* m_sim;
+  int                m_index;
+  bool               m_advance;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFleetSimulation::ChFleetSimulation(ChSharedPtr<ChTerrain> terrain,
+                                     double                 step_size,
+                                     int                    num_threads,
+                                     bool                   numa_placement)
+: m_terrain(terrain),
+  m_batching(true),
+  m_tire_device(-1),
+  m_initialized(false),
+  m_driver_batching(true),
+  m_drivers_initialized(false),
+  m_replay(0),
+  m_traffic_enabled(false),
+  m_traffic_valid(false),
+  m_collisions_enabled(false),
+  m_pool(0),
+  m_balancing(true),
+  m_balance_interval(50),
+  m_imbalance(0),
+  m_step_size(step_size),
+  m_output_steps(1),
+  m_step_number(0),
+  m_start_time(0),
+  m_time(0)
+{
+  if (num_threads != 1)
+    m_pool = new ChThreadPool(num_threads, numa_placement);
+}
+
+ChFleetSimulation::~ChFleetSimulation()
+{
+  delete m_pool;
+
+  for (size_t i = 0; i < m_tasks.size(); i++)
+    delete m_tasks[i];
+}
+
+int ChFleetSimulation::AddVehicle(ChSharedPtr<ChVehicle>                   vehicle,
+                                  ChSharedPtr<ChPowertrain>                powertrain,
+                                  ChSharedPtr<ChDriver>                    driver,
+                                  const std::vector<ChSharedPtr<ChTire> >& tires)
+{
+  int num_wheels = 2 * vehicle->GetNumberAxles();
+  if ((int)tires.size() != num_wheels)
+    return -1;
+
+  Member member;
+  member.vehicle = vehicle;
+  member.powertrain = powertrain;
+  member.driver = driver;
+  member.tires = tires;
+  member.batched.resize(num_wheels, 0);
+  member.batched_driver = false;
+  member.throttle = 0;
+  member.steering = 0;
+  member.braking = 0;
+  member.powertrain_torque = 0;
+  member.driveshaft_speed = 0;
+  member.wheel_states.resize(num_wheels);
+  member.tire_forces.resize(num_wheels);
+  member.worker = GetVehicleWorker((int)m_members.size());
+  member.step_time = 0;
+  member.cost = 0;
+
+  if (m_members.empty() && m_step_number == 0) {
+    m_start_time = vehicle->GetSystem()->GetChTime();
+    m_time = m_start_time;
+  }
+
+  m_members.push_back(member);
+  m_tasks.push_back(new ChFleetTask(this, (int)m_members.size() - 1));
+  m_order.push_back((int)m_members.size() - 1);
+  m_collision.SetNumVehicles((int)m_members.size());
+
+  // rebuild the tire and driver batches at the next step
+  m_initialized = false;
+  m_drivers_initialized = false;
+  m_traffic_valid = false;
+
+  return (int)m_members.size() - 1;
+}
+
+// The tasks are bound to vehicle indices, so the last one is discarded.
+bool ChFleetSimulation::RemoveVehicle(int index)
+{
+  if (index < 0 || index >= (int)m_members.size())
+    return false;
+
+  m_members.erase(m_members.begin() + index);
+  m_collision.RemoveVehicle(index);
+  delete m_tasks.back();
+  m_tasks.pop_back();
+  m_order.erase(std::find(m_order.begin(), m_order.end(), index));
+  for (size_t k = 0; k < m_order.size(); k++) {
+    if (m_order[k] > index)
+      m_order[k]--;
+  }
+
+  m_initialized = false;
+  m_drivers_initialized = false;
+  m_traffic_valid = false;
+
+  return true;
+}
+
+// The new driver takes over with its own state (its inputs are used from the
+// next step on).
+bool ChFleetSimulation::SetDriver(int index, ChSharedPtr<ChDriver> driver)
+{
+  if (index < 0 || index >= (int)m_members.size())
+    return false;
+
+  m_members[index].driver = driver;
+  m_members[index].batched_driver = false;
+  m_drivers_initialized = false;
+
+  return true;
+}
+
+bool ChFleetSimulation::SetSensors(int index, ChSharedPtr<ChVehicleSensors> sensors)
+{
+  if (index < 0 || index >= (int)m_members.size())
+    return false;
+
+  m_members[index].sensors = sensors;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Snapshot of one vehicle. The inter-module data is collected again from the
+// modules at the beginning of the next step.
+// -----------------------------------------------------------------------------
+void ChFleetSimulation::SaveVehicleState(int index, ChVehicleState& state) const
+{
+  const Member& member = m_members[index];
+
+  member.vehicle->SaveState(state);
+  member.powertrain->SaveState(state);
+  member.driver->SaveState(state);
+  for (size_t i = 0; i < member.tires.size(); i++)
+    member.tires[i]->SaveState(state);
+}
+
+bool ChFleetSimulation::RestoreVehicleState(int index, ChVehicleState& state)
+{
+  Member& member = m_members[index];
+
+  bool ok = member.vehicle->RestoreState(state) &&
+            member.powertrain->RestoreState(state) &&
+            member.driver->RestoreState(state);
+  for (size_t i = 0; ok && i < member.tires.size(); i++)
+    ok = member.tires[i]->RestoreState(state);
+
+  return ok;
+}
+
+void ChFleetSimulation::AddMemoryFootprint(ChMemoryReport& report) const
+{
+  report.Add("simulation/loops", sizeof(*this) + ChMemoryReport::VectorBytes(m_members));
+
+  for (size_t k = 0; k < m_members.size(); k++) {
+    const Member& member = m_members[k];
+    member.vehicle->AddMemoryFootprint(report);
+    for (size_t i = 0; i < member.tires.size(); i++)
+      member.tires[i]->AddMemoryFootprint(report);
+  }
+  m_terrain->AddMemoryFootprint(report);
+  m_collision.AddMemoryFootprint(report);
+
+  ChMeshCache::AddMemoryFootprint(report);
+}
+
+// In deterministic mode, the vehicles go back to their initial workers.
+void ChFleetSimulation::SetDeterministic(bool val)
+{
+  if (m_pool)
+    m_pool->SetStealing(!val);
+
+  if (val) {
+    for (size_t k = 0; k < m_members.size(); k++) {
+      m_members[k].worker = (int)k % GetNumThreads();
+      m_order[k] = (int)k;
+    }
+  }
+}
+
+void ChFleetSimulation::SetLoadBalancing(bool val, int interval)
+{
+  m_balancing = val;
+  m_balance_interval = std::max(interval, 1);
+}
+
+int ChFleetSimulation::GetVehicleWorker(int index) const
+{
+  return (index < (int)m_members.size()) ? m_members[index].worker : index % GetNumThreads();
+}
+
+void ChFleetSimulation::SetTrafficIndexing(bool val, double cell_size)
+{
+  m_traffic = ChTrafficIndex(cell_size);
+  m_traffic_enabled = val;
+  m_traffic_valid = false;
+}
+
+void ChFleetSimulation::SetVehicleCollisions(bool val)
+{
+  m_collisions_enabled = val;
+  m_traffic_valid = false;
+}
+
+void ChFleetSimulation::SetOutputStep(double output_step)
+{
+  int steps = (int)std::ceil(output_step / m_step_size);
+  m_output_steps = steps > 1 ? steps : 1;
+}
+
+int ChFleetSimulation::GetNumBatchedTires() const
+{
+  int num = 0;
+  if (!m_pacejka_batch.IsNull())
+    num += m_pacejka_batch->GetNumTires();
+  if (!m_lugre_batch.IsNull())
+    num += m_lugre_batch->GetNumTires();
+  if (!m_surrogate_batch.IsNull())
+    num += m_surrogate_batch->GetNumTires();
+  return num;
+}
+
+// -----------------------------------------------------------------------------
+// Put the Pacejka, LuGre and surrogate tires of the whole fleet in three
+// batches (again, after vehicles were added or removed).
+// -----------------------------------------------------------------------------
+void ChFleetSimulation::Initialize()
+{
+  m_initialized = true;
+
+  if (!m_batching)
+    return;
+
+  m_pacejka_batch = ChSharedPtr<ChPacejkaTireBatch>(new ChPacejkaTireBatch);
+  m_lugre_batch = ChSharedPtr<ChLugreTireBatch>(new ChLugreTireBatch);
+  m_surrogate_batch = ChSharedPtr<ChSurrogateTireBatch>(new ChSurrogateTireBatch);
+
+  for (size_t k = 0; k < m_members.size(); k++) {
+    Member& member = m_members[k];
+    for (size_t i = 0; i < member.tires.size(); i++) {
+      member.batched[i] = 0;
+      if (ChSharedPtr<ChPacejkaTire> tire = member.tires[i].DynamicCastTo<ChPacejkaTire>()) {
+        member.batched[i] = (m_pacejka_batch->AddTire(tire) >= 0);
+      }
+      else if (ChSharedPtr<ChLugreTire> tire = member.tires[i].DynamicCastTo<ChLugreTire>()) {
+        m_lugre_batch->AddTire(tire);
+        member.batched[i] = 1;
+      }
+      else if (ChSharedPtr<ChSurrogateTire> tire = member.tires[i].DynamicCastTo<ChSurrogateTire>()) {
+        member.batched[i] = (m_surrogate_batch->AddTire(tire) >= 0);
+      }
+    }
+  }
+
+  if (m_tire_device >= 0 && m_pacejka_batch->GetNumTires() > 0)
+    m_pacejka_batch->EnableDevice(m_tire_device);
+}
+
+// The drivers are batched in vehicle order, so the batch evaluates them in the
+// same order as the single-threaded loop.
+void ChFleetSimulation::InitializeDrivers()
+{
+  m_drivers_initialized = true;
+  m_driver_batch = ChSharedPtr<ChPathFollowerBatch>();
+
+  for (size_t k = 0; k < m_members.size(); k++)
+    m_members[k].batched_driver = false;
+
+  if (!m_driver_batching)
+    return;
+
+  m_driver_batch = ChSharedPtr<ChPathFollowerBatch>(new ChPathFollowerBatch);
+
+  for (size_t k = 0; k < m_members.size(); k++) {
+    Member& member = m_members[k];
+    if (ChSharedPtr<ChPathFollowerDriver> driver = member.driver.DynamicCastTo<ChPathFollowerDriver>()) {
+      m_driver_batch->AddDriver(driver);
+      member.batched_driver = true;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Per-vehicle work.
+// -----------------------------------------------------------------------------
+void ChFleetSimulation::UpdateMember(int index)
+{
+  Member& member = m_members[index];
+  int num_wheels = (int)member.tires.size();
+
+  // Collect output data from modules (for inter-module communication)
+  member.throttle = member.driver->GetThrottle();
+  member.steering = member.driver->GetSteering();
+  member.braking = member.driver->GetBraking();
+  if (m_replay)
+    m_replay->Apply(index, m_time, member.steering, member.throttle, member.braking);
+  member.powertrain_torque = member.powertrain->GetOutputTorque();
+  member.driveshaft_speed = member.vehicle->GetDriveshaftSpeed();
+  for (int i = 0; i < num_wheels; i++) {
+    member.tire_forces[i] = member.tires[i]->GetTireForce();
+    member.vehicle->GetWheelState(i, member.wheel_states[i]);
+  }
+
+  // Update modules (process inputs from other modules). Batched drivers are
+  // updated and advanced after this phase.
+  if (!member.batched_driver) {
+    CH_PROFILE_SCOPE("ChDriver::Update");
+    member.driver->Update(m_time);
+  }
+  for (int i = 0; i < num_wheels; i++) {
+    CH_PROFILE_SCOPE("ChTire::Update");
+    member.tires[i]->Update(m_time, member.wheel_states[i]);
+  }
+  {
+    CH_PROFILE_SCOPE("ChPowertrain::Update");
+    member.powertrain->Update(m_time, member.throttle, member.driveshaft_speed);
+  }
+  {
+    CH_PROFILE_SCOPE("ChVehicle::Update");
+    member.vehicle->Update(m_time, member.steering, member.braking, member.powertrain_torque, member.tire_forces);
+  }
+
+  if (!member.batched_driver) {
+    CH_PROFILE_SCOPE("ChDriver::Advance");
+    member.driver->Advance(m_step_size);
+  }
+}
+
+void ChFleetSimulation::AdvanceMember(int index)
+{
+  Member& member = m_members[index];
+
+  for (size_t i = 0; i < member.tires.size(); i++) {
+    if (!member.batched[i]) {
+      CH_PROFILE_SCOPE("ChTire::Advance");
+      member.tires[i]->Advance(m_step_size);
+    }
+  }
+  {
+    CH_PROFILE_SCOPE("ChPowertrain::Advance");
+    member.powertrain->Advance(m_step_size);
+  }
+  if (m_collisions_enabled)
+    m_collision.Apply(index, member.vehicle->GetChassisBody());
+  member.vehicle->Advance(m_step_size);
+
+  if (!member.sensors.IsNull()) {
+    CH_PROFILE_SCOPE("ChVehicleSensors::Update");
+    member.sensors->Update(m_time + m_step_size, *member.vehicle);
+  }
+
+  if (m_traffic_enabled || m_collisions_enabled)
+    m_traffic.SetVehicle(index, *member.vehicle);
+}
+
+void ChFleetSimulation::RunPhase(bool advance)
+{
+  if (!m_pool) {
+    for (int k = 0; k < (int)m_members.size(); k++) {
+      if (advance)
+        AdvanceMember(k);
+      else
+        UpdateMember(k);
+    }
+    return;
+  }
+
+  for (size_t k = 0; k < m_order.size(); k++) {
+    int index = m_order[k];
+    m_tasks[index]->SetAdvance(advance);
+    m_pool->Submit(m_tasks[index], m_members[index].worker);
+  }
+  m_pool->Wait();
+}
+
+// -----------------------------------------------------------------------------
+// Longest processing time first: the vehicles are assigned by decreasing cost
+// to the least loaded worker of the NUMA node they run on, so that they keep
+// the memory they first touched; on ties, a vehicle stays on its worker. The
+// cost of a vehicle is the time of its own work in both phases, on whichever
+// worker ran it.
+// -----------------------------------------------------------------------------
+static const double FLEET_COST_SMOOTHING = 0.1;
+
+static bool FLEET_costlier(const std::pair<double, int>& a, const std::pair<double, int>& b)
+{
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+void ChFleetSimulation::BalanceLoad()
+{
+  for (size_t k = 0; k < m_members.size(); k++) {
+    Member& member = m_members[k];
+    if (member.cost <= 0)
+      member.cost = member.step_time;
+    else
+      member.cost += FLEET_COST_SMOOTHING * (member.step_time - member.cost);
+    member.step_time = 0;
+  }
+
+  if (!m_pool || !m_balancing || !m_pool->IsStealing() || (m_step_number + 1) % m_balance_interval != 0)
+    return;
+
+  int num_workers = m_pool->GetNumThreads();
+  std::vector<std::pair<double, int> > vehicles(m_members.size());
+  for (size_t k = 0; k < m_members.size(); k++)
+    vehicles[k] = std::make_pair(m_members[k].cost, (int)k);
+  std::sort(vehicles.begin(), vehicles.end(), FLEET_costlier);
+
+  std::vector<double> load(num_workers, 0.0);
+  for (size_t k = 0; k < vehicles.size(); k++) {
+    Member& member = m_members[vehicles[k].second];
+    int node = m_pool->GetWorkerNode(member.worker);
+    int best = member.worker;
+    for (int w = 0; w < num_workers; w++) {
+      if (m_pool->GetWorkerNode(w) == node && load[w] < load[best])
+        best = w;
+    }
+    member.worker = best;
+    load[best] += member.cost;
+  }
+
+  // cheapest first: each worker runs its last queued (costliest) vehicle first
+  for (size_t k = 0; k < vehicles.size(); k++)
+    m_order[k] = vehicles[vehicles.size() - 1 - k].second;
+
+  double total = 0;
+  double largest = 0;
+  for (int w = 0; w < num_workers; w++) {
+    total += load[w];
+    largest = std::max(largest, load[w]);
+  }
+  m_imbalance = (total > 0) ? largest * num_workers / total : 1;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFleetSimulation::DoStep()
+{
+  if (!m_initialized)
+    Initialize();
+  if (!m_drivers_initialized)
+    InitializeDrivers();
+
+  if (m_replay)
+    m_replay->SetNumVehicles((int)m_members.size());
+
+  m_time = m_start_time + m_step_number * m_step_size;
+
+  // The vehicle states are otherwise collected at the end of the previous step.
+  if ((m_traffic_enabled || m_collisions_enabled) && !m_traffic_valid) {
+    m_traffic.SetNumVehicles((int)m_members.size());
+    for (size_t k = 0; k < m_members.size(); k++)
+      m_traffic.SetVehicle((int)k, *m_members[k].vehicle);
+    m_traffic.Build();
+    m_traffic_valid = true;
+  }
+
+  // The terrain is updated before the tires query it.
+  {
+    CH_PROFILE_SCOPE("ChTerrain::Update");
+    m_terrain->Update(m_time);
+  }
+
+  RunPhase(false);
+
+  // The vehicle states are not modified by the updates, so the batched
+  // drivers see the same states as in the first phase.
+  if (!m_driver_batch.IsNull() && m_driver_batch->GetNumDrivers() > 0) {
+    CH_PROFILE_SCOPE("ChPathFollowerBatch::Update");
+    m_driver_batch->Update(m_time);
+    m_driver_batch->Advance(m_step_size);
+  }
+
+  // The chassis states are those indexed at the beginning of the step.
+  if (m_collisions_enabled) {
+    CH_PROFILE_SCOPE("ChFleetCollision::Compute");
+    m_chassis.resize(m_members.size());
+    for (size_t k = 0; k < m_members.size(); k++)
+      m_chassis[k] = m_members[k].vehicle->GetChassisBody();
+    m_collision.Compute(m_traffic, m_chassis);
+  }
+
+  if (m_step_number % m_output_steps == 0)
+    OnOutput(m_time);
+
+  {
+    CH_PROFILE_SCOPE("ChTerrain::Advance");
+    m_terrain->Advance(m_step_size);
+  }
+  if (!m_pacejka_batch.IsNull() && m_pacejka_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChPacejkaTireBatch::Advance");
+    m_pacejka_batch->BeginAdvance(m_step_size);
+  }
+  if (!m_lugre_batch.IsNull() && m_lugre_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChLugreTireBatch::Advance");
+    m_lugre_batch->Advance(m_step_size);
+  }
+  if (!m_surrogate_batch.IsNull() && m_surrogate_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChSurrogateTireBatch::Advance");
+    m_surrogate_batch->Advance(m_step_size);
+  }
+
+  RunPhase(true);
+
+  BalanceLoad();
+
+  if (m_traffic_enabled || m_collisions_enabled) {
+    CH_PROFILE_SCOPE("ChTrafficIndex::Build");
+    m_traffic.Build();
+  }
+
+  if (!m_pacejka_batch.IsNull() && m_pacejka_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChPacejkaTireBatch::EndAdvance");
+    m_pacejka_batch->EndAdvance();
+  }
+
+  m_step_number++;
+  m_time = m_start_time + m_step_number * m_step_size;
+}
+
+void ChFleetSimulation::Run(double end_time)
+{
+  while (m_time < end_time && Continue())
+    DoStep();
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
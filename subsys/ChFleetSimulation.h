@@ -0,0 +1,369 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Lock-step simulation of a fleet of vehicles on a shared terrain.
+//
+// Each vehicle of the fleet has its own Chrono system, powertrain, driver and
+// tires; all vehicles share a single terrain object, which is only queried by
+// the tires (and updated and advanced once per step). All vehicles are
+// advanced with the same step, in lock-step.
+//
+// Each step is performed in three phases, with the per-vehicle work of the
+// first and last phase distributed over a thread pool:
+//   1. for each vehicle, collect the module outputs, then update all modules
+//      and advance the driver;
+//   2. update and advance the batched drivers, then advance the terrain and
+//      all batched tires: the path-following drivers of the whole fleet are
+//      evaluated by one ChPathFollowerBatch, and the Pacejka, LuGre and
+//      surrogate tires of the whole fleet are advanced by one
+//      ChPacejkaTireBatch, one ChLugreTireBatch and one ChSurrogateTireBatch,
+//      so that the batched kernels operate on wide batches;
+//   3. for each vehicle, advance the other tires, the powertrain and the
+//      vehicle (multibody) system, then sample its sensors (if any).
+// With vehicle collisions enabled, the contact forces between the chassis
+// boxes are computed between the first and the last phase (see
+// ChFleetCollision).
+// If the Pacejka batch is evaluated on a CUDA device (see SetTireDevice()),
+// its evaluation is only queued in the second phase and completed after the
+// third one, so that the transfers and the kernel overlap the multibody step;
+// the tire forces are not used before the next step.
+// This is the same sequence of module updates as in the single vehicle loop
+// (see ChVehicleSimulation).
+//
+// The vehicles of a fleet may differ widely in step cost (e.g. Pacejka tires,
+// shafts powertrain and full suspensions against rigid tires and a simple
+// powertrain). The step time of each vehicle is measured, and the vehicles
+// are periodically reassigned to the workers from these costs, so that the
+// workers reach the end of each phase together (see SetLoadBalancing()).
+//
+// Since the vehicles do not share a Chrono system, the terrain cannot provide
+// contact geometry: tires that rely on Chrono contact (RigidTire) are not
+// supported. The terrain height and normal queries must be thread-safe (as
+// they are for all terrain models in ChronoVehicle).
+//
+// =============================================================================
+
+#ifndef CH_FLEET_SIMULATION_H
+#define CH_FLEET_SIMULATION_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChThreadPool.h"
+#include "subsys/ChReplayLog.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChTrafficIndex.h"
+#include "subsys/ChFleetCollision.h"
+#include "subsys/ChVehicleSensors.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/tire/ChLugreTireBatch.h"
+#include "subsys/tire/ChSurrogateTireBatch.h"
+#include "subsys/driver/ChPathFollowerBatch.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChFleetTask;
+
+///
+/// Lock-step simulation of a fleet of vehicles sharing one terrain.
+///
+class CH_SUBSYS_API ChFleetSimulation
+{
+public:
+
+  /// Create a fleet simulation on the specified terrain, using the specified
+  /// number of worker threads for the per-vehicle work (if zero, use the number
+  /// of hardware threads; if one, the calling thread does all the work).
+  /// The work of a vehicle is always queued to the same worker; with NUMA
+  /// placement, the workers are pinned to the NUMA nodes of the machine (see
+  /// ChThreadPool), so that a vehicle is stepped on a single node. Its state
+  /// is local to that node if the vehicle is created on its worker (see
+  /// GetVehicleWorker()), or once the kernel migrated its pages there.
+  ChFleetSimulation(
+    ChSharedPtr<ChTerrain> terrain,                ///< [in] shared terrain
+    double                 step_size,              ///< [in] integration step size
+    int                    num_threads = 0,        ///< [in] number of worker threads
+    bool                   numa_placement = false  ///< [in] pin the workers to the NUMA nodes
+    );
+
+  virtual ~ChFleetSimulation();
+
+  /// Add a vehicle to the fleet, with one tire for each of its wheels (in
+  /// wheel ID order). Vehicles added after the first step must be at the
+  /// current simulation time (e.g. restored from a snapshot, see
+  /// RestoreVehicleState()); the tire batches are then rebuilt at the next step.
+  /// Returns the index of the vehicle in the fleet, or -1 if the number of
+  /// tires does not match the number of wheels.
+  int AddVehicle(
+    ChSharedPtr<ChVehicle>                   vehicle,     ///< [in] vehicle system (with its own Chrono system)
+    ChSharedPtr<ChPowertrain>                powertrain,  ///< [in] powertrain system
+    ChSharedPtr<ChDriver>                    driver,      ///< [in] driver system
+    const std::vector<ChSharedPtr<ChTire> >& tires        ///< [in] tires, in wheel ID order
+    );
+
+  /// Remove the vehicle with the specified index from the fleet. The indices
+  /// of the following vehicles decrease by one.
+  /// Returns false if there is no vehicle with this index.
+  bool RemoveVehicle(int index);
+
+  /// Replace the driver of the specified vehicle (e.g. to hand a vehicle of the
+  /// fleet over to an interactive or data driver). The driver batch is rebuilt
+  /// at the next step. Returns false if there is no vehicle with this index.
+  bool SetDriver(int index, ChSharedPtr<ChDriver> driver);
+
+  /// Attach the specified sensors to the specified vehicle (NULL to remove
+  /// them). The sensors are sampled by the worker of the vehicle at the end of
+  /// each step. Returns false if there is no vehicle with this index.
+  bool SetSensors(int index, ChSharedPtr<ChVehicleSensors> sensors);
+
+  /// Append the states of the modules of the specified vehicle (vehicle,
+  /// powertrain, driver and tires) to the specified snapshot.
+  void SaveVehicleState(int index, ChVehicleState& state) const;
+
+  /// Restore the states of the modules of the specified vehicle from the next
+  /// blocks of the specified snapshot.
+  /// Returns false if the snapshot does not match the vehicle.
+  bool RestoreVehicleState(int index, ChVehicleState& state);
+
+  /// Add the memory footprint of the fleet to the specified report: the
+  /// vehicles and tires of all members, the shared terrain (once) and the
+  /// cached meshes.
+  void AddMemoryFootprint(ChMemoryReport& report) const;
+
+  /// Enable or disable the batched advance of the Pacejka, LuGre and surrogate
+  /// tires of the fleet (default: enabled). Must be called before the first step.
+  void SetTireBatching(bool val) { m_batching = val; }
+
+  /// Enable or disable the batched evaluation of the path-following drivers
+  /// of the fleet (default: enabled).
+  void SetDriverBatching(bool val) { m_driver_batching = val; m_drivers_initialized = false; }
+
+  /// Evaluate the Magic Formula of the batched Pacejka tires on the specified
+  /// CUDA device (default: -1, on the host). Requires a library built with
+  /// ENABLE_TIRE_CUDA; if the device cannot be used, the batch is evaluated
+  /// on the host. Must be called before the first step.
+  void SetTireDevice(int device) { m_tire_device = device; }
+
+  /// Enable or disable the deterministic mode (default: disabled). In
+  /// deterministic mode, the work of each vehicle always runs on its worker
+  /// (no work stealing and no load balancing), so that the schedule of a step
+  /// only depends on the number of vehicles and threads. Must not be called
+  /// during a step.
+  void SetDeterministic(bool val);
+
+  /// Enable or disable the load balancing (default: enabled, every 50 steps).
+  /// The step time of each vehicle is measured at every step (moving
+  /// average); every 'interval' steps, the vehicles are reassigned to the
+  /// workers so as to even out their measured load (largest cost first, to
+  /// the least loaded worker of the same NUMA node). Within a phase, the
+  /// vehicles of a worker are queued cheapest first, so that the worker starts
+  /// with its most expensive vehicle and the idle workers steal the cheap ones
+  /// at the end of the phase. Ignored in deterministic mode.
+  void SetLoadBalancing(bool val, int interval = 50);
+
+  /// Get the measured step time of the specified vehicle (moving average, in
+  /// seconds; 0 before the first step or with a single thread).
+  double GetVehicleCost(int index) const { return m_members[index].cost; }
+
+  /// Get the ratio of the largest to the average worker load, at the last
+  /// load balancing (1 if perfectly balanced, 0 if never balanced).
+  double GetLoadImbalance() const { return m_imbalance; }
+
+  /// Record the driver inputs of all vehicles in the specified log or, if the
+  /// log was loaded from a file, replace them with the recorded ones (see
+  /// ChReplayLog). The log is not owned and must outlive the simulation; NULL
+  /// disables the recording.
+  void SetReplayLog(ChReplayLog* log) { m_replay = log; }
+
+  /// Enable or disable the traffic index (default: disabled), with the
+  /// specified grid cell size. When enabled, the index holds the vehicle
+  /// states at the beginning of each step, and can be queried (concurrently)
+  /// by the drivers during their update. The states are collected by the
+  /// workers at the end of each step.
+  void SetTrafficIndexing(bool val, double cell_size = 20);
+
+  /// Get the traffic index (see SetTrafficIndexing()). The vehicle indices
+  /// are the indices in the fleet.
+  const ChTrafficIndex& GetTrafficIndex() const { return m_traffic; }
+
+  /// Enable or disable the contact between the chassis boxes of the vehicles
+  /// (default: disabled; see ChFleetCollision). When enabled, the contact
+  /// forces are computed from the traffic index after the first phase of each
+  /// step, and applied through the chassis force accumulators before the
+  /// vehicles are advanced; the vehicle states are then collected for the
+  /// traffic index even if the traffic indexing is disabled.
+  void SetVehicleCollisions(bool val);
+
+  /// Get the vehicle collision layer, e.g. to set the boxes of the vehicles
+  /// (see SetVehicleCollisions()). The vehicle indices are the indices in the
+  /// fleet.
+  ChFleetCollision& GetVehicleCollision() { return m_collision; }
+  const ChFleetCollision& GetVehicleCollision() const { return m_collision; }
+
+  /// Set the time interval between two calls to OnOutput() (default: every step).
+  void SetOutputStep(double output_step);
+
+  /// Get the number of vehicles in the fleet.
+  int GetNumVehicles() const { return (int)m_members.size(); }
+
+  /// Get the number of tires advanced by the tire batches.
+  int GetNumBatchedTires() const;
+
+  /// Get the number of drivers evaluated by the driver batch.
+  int GetNumBatchedDrivers() const { return m_driver_batch.IsNull() ? 0 : m_driver_batch->GetNumDrivers(); }
+
+  /// Get the number of worker threads.
+  int GetNumThreads() const { return m_pool ? m_pool->GetNumThreads() : 1; }
+
+  /// Get the worker thread stepping the vehicle with the specified index. For
+  /// the index of the next vehicle to be added, this is the worker it will be
+  /// first assigned to; the load balancing may move a vehicle to another
+  /// worker of the same NUMA node.
+  int GetVehicleWorker(int index) const;
+
+  /// Get the thread pool of the fleet (NULL with a single thread), e.g. to
+  /// create a vehicle on the worker that will step it.
+  ChThreadPool* GetThreadPool() const { return m_pool; }
+
+  /// Get the number of steps taken so far.
+  int GetStepNumber() const { return m_step_number; }
+
+  /// Get the current simulation time.
+  double GetTime() const { return m_time; }
+
+  /// Perform one simulation step for all vehicles of the fleet.
+  virtual void DoStep();
+
+  /// Perform simulation steps until the specified end time is reached or
+  /// Continue() returns false.
+  void Run(double end_time);
+
+  /// Get handles to the modules of the specified vehicle.
+  ChSharedPtr<ChVehicle>    GetVehicle(int index) const { return m_members[index].vehicle; }
+  ChSharedPtr<ChPowertrain> GetPowertrain(int index) const { return m_members[index].powertrain; }
+  ChSharedPtr<ChDriver>     GetDriver(int index) const { return m_members[index].driver; }
+  ChSharedPtr<ChVehicleSensors> GetSensors(int index) const { return m_members[index].sensors; }
+  ChSharedPtr<ChTerrain>    GetTerrain() const { return m_terrain; }
+
+  /// Get the wheel states and tire forces of the specified vehicle, collected
+  /// at the current step.
+  const ChWheelStates& GetWheelStates(int index) const { return m_members[index].wheel_states; }
+  const ChTireForces&  GetTireForces(int index) const { return m_members[index].tire_forces; }
+
+protected:
+
+  /// Output hook, called every output step with the data collected at the
+  /// current step.
+  virtual void OnOutput(double time) {}
+
+  /// Called by Run() before each step; return false to stop the simulation.
+  virtual bool Continue() { return true; }
+
+private:
+
+  friend class ChFleetTask;
+
+  // Modules and inter-module communication data of one vehicle.
+  struct Member {
+    ChSharedPtr<ChVehicle>             vehicle;
+    ChSharedPtr<ChPowertrain>          powertrain;
+    ChSharedPtr<ChDriver>              driver;
+    std::vector<ChSharedPtr<ChTire> >  tires;
+    std::vector<char>                  batched;   // non-zero if the tire is advanced by a batch
+    bool                               batched_driver;
+    ChSharedPtr<ChVehicleSensors>      sensors;
+
+    int             worker;      // worker stepping the vehicle
+    double          step_time;   // measured time of the current step
+    double          cost;        // moving average of the step times
+
+    double          throttle;
+    double          steering;
+    double          braking;
+    double          powertrain_torque;
+    double          driveshaft_speed;
+    ChWheelStates   wheel_states;
+    ChTireForces    tire_forces;
+  };
+
+  ChFleetSimulation(const ChFleetSimulation&);
+  ChFleetSimulation& operator=(const ChFleetSimulation&);
+
+  // Put the Pacejka, LuGre and surrogate tires of all vehicles in the batches.
+  void Initialize();
+
+  // Put the path-following drivers of all vehicles in the driver batch.
+  void InitializeDrivers();
+
+  // Per-vehicle work of the first and last phase of a step.
+  void UpdateMember(int index);
+  void AdvanceMember(int index);
+
+  // Execute the first or last phase for all vehicles.
+  void RunPhase(bool advance);
+
+  // Update the vehicle costs with the times of the last step and, if due,
+  // reassign the vehicles to the workers.
+  void BalanceLoad();
+
+  ChSharedPtr<ChTerrain>           m_terrain;
+  std::vector<Member>              m_members;
+
+  ChSharedPtr<ChPacejkaTireBatch>  m_pacejka_batch;
+  ChSharedPtr<ChLugreTireBatch>    m_lugre_batch;
+  ChSharedPtr<ChSurrogateTireBatch> m_surrogate_batch;
+  ChSharedPtr<ChPathFollowerBatch> m_driver_batch;
+  bool                             m_batching;
+  int                              m_tire_device;
+  bool                             m_initialized;
+  bool                             m_driver_batching;
+  bool                             m_drivers_initialized;
+  ChReplayLog*                     m_replay;
+
+  ChTrafficIndex                   m_traffic;
+  bool                             m_traffic_enabled;
+  bool                             m_traffic_valid;    // false if the vehicles changed
+
+  ChFleetCollision                 m_collision;
+  bool                             m_collisions_enabled;
+  std::vector<ChBodyAuxRef*>       m_chassis;          // chassis bodies, for the collision layer
+
+  ChThreadPool*                    m_pool;
+  std::vector<ChFleetTask*>        m_tasks;    // one per vehicle
+  std::vector<int>                 m_order;    // order in which the vehicles are queued
+  bool                             m_balancing;
+  int                              m_balance_interval;
+  double                           m_imbalance;
+
+  double          m_step_size;
+  int             m_output_steps;
+  int             m_step_number;
+  double          m_start_time;
+  double          m_time;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
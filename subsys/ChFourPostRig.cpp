@@ -0,0 +1,119 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Shaker post rig for a full vehicle.
+//
+// =============================================================================
+
+#include "subsys/ChFourPostRig.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFourPostRig::ChFourPostRig(ChSharedPtr<ChVehicle> vehicle)
+: m_vehicle(vehicle),
+  m_post_height(0.1),
+  m_initialized(false)
+{
+  m_posts.resize(2 * vehicle->GetNumberAxles());
+  for (size_t i = 0; i < m_posts.size(); i++)
+    m_posts[i].constant = ChSharedPtr<ChFunction_Const>(new ChFunction_Const(0));
+}
+
+void ChFourPostRig::SetActuatorFunction(int post, ChSharedPtr<ChFunction> func)
+{
+  Post& p = m_posts[post];
+  p.func = func;
+  if (m_initialized)
+    p.actuator->Set_dist_funct(func.IsNull() ? p.constant.StaticCastTo<ChFunction>() : func);
+}
+
+void ChFourPostRig::SetDriveFile(ChSharedPtr<ChRigDriveFile> file, int first_channel, double scale)
+{
+  for (int i = 0; i < (int)m_posts.size(); i++)
+    SetActuatorFunction(i, ChSharedPtr<ChFunction>(new ChFunction_DriveChannel(file, first_channel + i, scale)));
+}
+
+// -----------------------------------------------------------------------------
+// The links are those of the SuspensionTest posts: a prismatic joint (along
+// the z axis) and a linear actuator between the ground and the post, and a
+// point-plane constraint between the spindle and the post.
+// -----------------------------------------------------------------------------
+void ChFourPostRig::Initialize()
+{
+  ChSystem* system = m_vehicle->GetSystem();
+
+  m_ground = ChSharedPtr<ChBody>(new ChBody);
+  m_ground->SetName("rig_ground");
+  m_ground->SetBodyFixed(true);
+  system->Add(m_ground);
+
+  for (int i = 0; i < (int)m_posts.size(); i++) {
+    Post& p = m_posts[i];
+    ChWheelID wheel_id(i);
+
+    ChSharedPtr<ChBody> spindle = m_vehicle->GetWheelBody(wheel_id);
+    ChVector<> spindle_pos = m_vehicle->GetWheelPos(wheel_id);
+    ChVector<> post_pos = spindle_pos;
+    post_pos.z -= m_vehicle->GetWheel(wheel_id)->GetRadius() + m_post_height / 2;
+
+    p.body = ChSharedPtr<ChBody>(new ChBody);
+    p.body->SetPos(post_pos);
+    system->Add(p.body);
+
+    p.prismatic = ChSharedPtr<ChLinkLockPrismatic>(new ChLinkLockPrismatic);
+    p.prismatic->Initialize(m_ground, p.body, ChCoordsys<>(post_pos, QUNIT));
+    system->AddLink(p.prismatic);
+
+    // The first actuator marker is 1 m below the post.
+    ChVector<> m1 = post_pos;
+    m1.z -= 1.0;
+    p.actuator = ChSharedPtr<ChLinkLinActuator>(new ChLinkLinActuator);
+    p.actuator->Initialize(m_ground, p.body, false, ChCoordsys<>(m1, QUNIT), ChCoordsys<>(post_pos, QUNIT));
+    p.actuator->Set_lin_offset(post_pos.z - m1.z);
+    p.actuator->Set_dist_funct(p.func.IsNull() ? p.constant.StaticCastTo<ChFunction>() : p.func);
+    system->AddLink(p.actuator);
+
+    p.plane = ChSharedPtr<ChLinkLockPointPlane>(new ChLinkLockPointPlane);
+    p.plane->Initialize(spindle, p.body, ChCoordsys<>(spindle_pos, QUNIT));
+    system->AddLink(p.plane);
+  }
+
+  m_initialized = true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChFourPostRig::SetDisplacement(int post, double disp)
+{
+  m_posts[post].constant->Set_yconst(disp);
+}
+
+double ChFourPostRig::GetDisplacement(int post) const
+{
+  const Post& p = m_posts[post];
+  double time = m_vehicle->GetSystem()->GetChTime();
+  return p.func.IsNull() ? p.constant->Get_y(time) : p.func->Get_y(time);
+}
+
+double ChFourPostRig::GetActuatorForce(int post) const
+{
+  return m_posts[post].actuator->Get_react_force().x;
+}
+
+
+}  // end namespace chrono
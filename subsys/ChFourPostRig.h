@@ -0,0 +1,127 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Shaker post rig for a full vehicle (four posts for a two-axle vehicle).
+//
+// As for the posts of SuspensionTest, each post is a body under a wheel,
+// constrained to translate vertically with respect to a fixed ground body and
+// driven by a linear actuator; a point of the spindle is kept on the (moving)
+// horizontal plane of the post. The chassis is free, so the vehicle rests on
+// the posts; its horizontal motion is not restrained, since the posts apply
+// no horizontal forces.
+//
+// Each post follows a displacement function of the system time: constant by
+// default (set with SetDisplacement()), or e.g. a channel of a drive file (see
+// ChRigDriveFile and ChFunction_DriveChannel), in which case the rig step does
+// no work besides the evaluation of the function by the actuator.
+//
+// The rig bodies and links are added to the system of the vehicle. The
+// vehicle is updated and advanced as usual, with zero tire forces.
+//
+// =============================================================================
+
+#ifndef CH_FOUR_POST_RIG_H
+#define CH_FOUR_POST_RIG_H
+
+#include <vector>
+
+#include "physics/ChBody.h"
+#include "physics/ChLinkLock.h"
+#include "physics/ChLinkLinActuator.h"
+#include "motion_functions/ChFunction.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/driver/ChRigDriveFile.h"
+
+namespace chrono {
+
+///
+/// Shaker post rig under the wheels of a vehicle.
+///
+class CH_SUBSYS_API ChFourPostRig
+{
+public:
+
+  /// Create a rig for the specified vehicle, with one post per wheel (in
+  /// wheel ID order).
+  ChFourPostRig(ChSharedPtr<ChVehicle> vehicle);
+
+  ~ChFourPostRig() {}
+
+  /// Set the height of the posts (default: 0.1 m). Must be called before
+  /// Initialize().
+  void SetPostHeight(double height) { m_post_height = height; }
+
+  /// Set the displacement function of the specified post, evaluated at the
+  /// system time (NULL: a constant displacement, see SetDisplacement()).
+  void SetActuatorFunction(int post, ChSharedPtr<ChFunction> func);
+
+  /// Drive all posts with consecutive channels of the specified drive file:
+  /// the post with index i follows the channel first_channel + i.
+  void SetDriveFile(
+    ChSharedPtr<ChRigDriveFile>  file,            ///< [in] drive file
+    int                          first_channel,   ///< [in] channel of the first post
+    double                       scale = 1        ///< [in] scaling of the channel values
+    );
+
+  /// Create the posts under the wheels of the (initialized) vehicle, at their
+  /// current locations, and add them to the system of the vehicle.
+  void Initialize();
+
+  /// Get the number of posts.
+  int GetNumPosts() const { return (int)m_posts.size(); }
+
+  /// Set the constant displacement of the specified post, for the posts
+  /// without displacement function.
+  void SetDisplacement(int post, double disp);
+
+  /// Get the current displacement of the specified post.
+  double GetDisplacement(int post) const;
+
+  /// Get the force of the actuator of the specified post.
+  double GetActuatorForce(int post) const;
+
+  /// Get the body of the specified post.
+  ChSharedPtr<ChBody> GetPost(int post) const { return m_posts[post].body; }
+
+  /// Get the ground body of the rig.
+  ChSharedPtr<ChBody> GetGround() const { return m_ground; }
+
+private:
+
+  struct Post {
+    ChSharedPtr<ChBody>                body;
+    ChSharedPtr<ChLinkLockPrismatic>   prismatic;
+    ChSharedPtr<ChLinkLinActuator>     actuator;
+    ChSharedPtr<ChLinkLockPointPlane>  plane;
+    ChSharedPtr<ChFunction_Const>      constant;   // default displacement function
+    ChSharedPtr<ChFunction>            func;       // displacement function (NULL: constant)
+  };
+
+  ChFourPostRig(const ChFourPostRig&);
+  ChFourPostRig& operator=(const ChFourPostRig&);
+
+  ChSharedPtr<ChVehicle>  m_vehicle;
+  ChSharedPtr<ChBody>     m_ground;
+  std::vector<Post>       m_posts;
+  double                  m_post_height;
+  bool                    m_initialized;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,116 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Map of the terrain coefficient of friction over a rectangular x-y patch.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChFrictionMap.h"
+#include "subsys/terrain/HeightmapTerrain.h"
+
+
+namespace chrono {
+
+// Alignment of the tiles (cache line size).
+static const size_t TILE_ALIGNMENT = 64;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFrictionMap::ChFrictionMap(double sizeX,
+                             double sizeY)
+: m_sizeX(sizeX),
+  m_sizeY(sizeY),
+  m_nx(0),
+  m_ny(0),
+  m_ntx(0),
+  m_xmin(-sizeX / 2),
+  m_ymin(-sizeY / 2),
+  m_inv_dx(0),
+  m_inv_dy(0),
+  m_mu_min(0),
+  m_mu_step(0),
+  m_nodes(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Quantize the node values and store them in tiles.
+// -----------------------------------------------------------------------------
+bool ChFrictionMap::SetValues(int                       nx,
+                              int                       ny,
+                              const std::vector<float>& mu)
+{
+  if (nx < 2 || ny < 2 || mu.size() < (size_t)nx * ny) {
+    GetLog() << "ERROR: invalid friction map grid (" << nx << " x " << ny << ")\n";
+    return false;
+  }
+
+  m_nx = nx;
+  m_ny = ny;
+  m_inv_dx = (nx - 1) / m_sizeX;
+  m_inv_dy = (ny - 1) / m_sizeY;
+
+  size_t num_values = (size_t)nx * ny;
+  float mu_min = *std::min_element(mu.begin(), mu.begin() + num_values);
+  float mu_max = *std::max_element(mu.begin(), mu.begin() + num_values);
+  m_mu_min = mu_min;
+  m_mu_step = ((double)mu_max - mu_min) / 255;
+
+  // Allocate storage for a whole number of tiles in each direction.
+  m_ntx = (nx + TILE_SIZE - 1) / TILE_SIZE;
+  int nty = (ny + TILE_SIZE - 1) / TILE_SIZE;
+  size_t num_nodes = (size_t)m_ntx * nty * TILE_SIZE * TILE_SIZE;
+
+  m_buffer.assign(num_nodes + TILE_ALIGNMENT, 0);
+  size_t address = (size_t)&m_buffer[0];
+  unsigned char* nodes = &m_buffer[(TILE_ALIGNMENT - address % TILE_ALIGNMENT) % TILE_ALIGNMENT];
+
+  for (int j = 0; j < ny; j++) {
+    // raster rows run from maximum to minimum y
+    const float* row = &mu[(size_t)(ny - 1 - j) * nx];
+
+    for (int i = 0; i < nx; i++) {
+      size_t tile = (size_t)(j / TILE_SIZE) * m_ntx + i / TILE_SIZE;
+      int q = (m_mu_step > 0) ? (int)std::floor((row[i] - m_mu_min) / m_mu_step + 0.5) : 0;
+      nodes[tile * TILE_SIZE * TILE_SIZE + (j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE] =
+        (unsigned char)std::min(std::max(q, 0), 255);
+    }
+  }
+
+  m_nodes = nodes;
+
+  return true;
+}
+
+bool ChFrictionMap::LoadPGM(const std::string& filename,
+                            double             muMin,
+                            double             muMax)
+{
+  int nx, ny;
+  std::vector<float> mu;
+
+  if (!HeightmapTerrain::ReadPGM(filename, muMin, muMax, nx, ny, mu))
+    return false;
+
+  return SetValues(nx, ny, mu);
+}
+
+
+} // end namespace chrono
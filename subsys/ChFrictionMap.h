@@ -0,0 +1,147 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Map of the terrain coefficient of friction over a rectangular x-y patch.
+//
+// The coefficients are specified at the nodes of a regular grid, centered at
+// the origin of the x-y plane (as for HeightmapTerrain). The value at a query
+// point is that of the nearest node, such that split-mu lines and patch
+// boundaries stay sharp; outside the grid, the boundary nodes are extended.
+//
+// Each node is quantized to 8 bits over the range of the specified values (a
+// map with at most 256 distinct values, e.g. split-mu or ice patches, is thus
+// represented exactly). Nodes are grouped in square tiles of TILE_SIZE x
+// TILE_SIZE nodes (the tile size of HeightmapTerrain), i.e. one 64-byte cache
+// line per tile, stored in a cache-line aligned buffer. A map with the same
+// resolution as a height map therefore covers each height-map tile with a
+// single cache line.
+//
+// Queries take constant time and do not allocate memory. A map is read-only
+// once set, and may be shared by any number of terrains and threads.
+//
+// =============================================================================
+
+#ifndef CH_FRICTION_MAP_H
+#define CH_FRICTION_MAP_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Tiled, 8-bit quantized map of the terrain coefficient of friction.
+///
+class CH_SUBSYS_API ChFrictionMap : public ChShared
+{
+public:
+
+  ChFrictionMap(
+    double sizeX,   ///< [in] map dimension in the X direction
+    double sizeY    ///< [in] map dimension in the Y direction
+    );
+
+  ~ChFrictionMap() {}
+
+  /// Set the node values directly.
+  /// The values are given row by row, with nx values per row; the first row
+  /// corresponds to the maximum y and the first value in a row to the minimum x
+  /// (as for HeightmapTerrain::SetHeights()).
+  /// Returns false if the grid has fewer than 2 x 2 nodes.
+  bool SetValues(
+    int                        nx,        ///< [in] number of grid nodes in the X direction
+    int                        ny,        ///< [in] number of grid nodes in the Y direction
+    const std::vector<float>&  mu         ///< [in] node coefficients of friction (nx * ny values)
+    );
+
+  /// Load the node values from a binary (P5) PGM image. Each pixel is a grid
+  /// node, with the pixel values mapped linearly from [0, maxval] to
+  /// [muMin, muMax].
+  /// Returns false if the file cannot be read.
+  bool LoadPGM(
+    const std::string&  filename,   ///< [in] name of the PGM image file
+    double              muMin,      ///< [in] coefficient of friction of black pixels
+    double              muMax       ///< [in] coefficient of friction of white pixels
+    );
+
+  /// Return true if no values were specified.
+  bool IsEmpty() const { return m_buffer.empty(); }
+
+  /// Return the size of this map and of its node values, in bytes.
+  size_t GetMemoryFootprint() const { return sizeof(*this) + m_buffer.capacity(); }
+
+  /// Get the coefficient of friction at the specified (x,y) location.
+  /// Returns 0 if no values were specified.
+  double GetCoefficientFriction(double x, double y) const
+  {
+    if (!m_nodes)
+      return 0;
+
+    double u = (x - m_xmin) * m_inv_dx + 0.5;
+    double v = (y - m_ymin) * m_inv_dy + 0.5;
+
+    int i = (u <= 0) ? 0 : (u >= m_nx - 1) ? m_nx - 1 : (int)u;
+    int j = (v <= 0) ? 0 : (v >= m_ny - 1) ? m_ny - 1 : (int)v;
+
+    size_t tile = (size_t)(j / TILE_SIZE) * m_ntx + i / TILE_SIZE;
+    unsigned char q = m_nodes[tile * TILE_SIZE * TILE_SIZE + (j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE];
+
+    return m_mu_min + q * m_mu_step;
+  }
+
+  /// Get the range of the node coefficients of friction.
+  double GetMinCoefficientFriction() const { return m_mu_min; }
+  double GetMaxCoefficientFriction() const { return m_mu_min + 255 * m_mu_step; }
+
+  /// Get the number of grid nodes in the X and Y directions.
+  int GetNumNodesX() const { return m_nx; }
+  int GetNumNodesY() const { return m_ny; }
+
+  /// Number of nodes along each side of a tile (one cache line per tile).
+  static const int TILE_SIZE = 8;
+
+private:
+
+  ChFrictionMap(const ChFrictionMap&);
+  ChFrictionMap& operator=(const ChFrictionMap&);
+
+  double                      m_sizeX;
+  double                      m_sizeY;
+
+  int                         m_nx;         // number of nodes in each direction
+  int                         m_ny;
+  int                         m_ntx;        // number of tiles in the X direction
+
+  double                      m_xmin;
+  double                      m_ymin;
+  double                      m_inv_dx;     // inverse of the node spacings
+  double                      m_inv_dy;
+
+  double                      m_mu_min;     // quantization: mu = m_mu_min + q * m_mu_step
+  double                      m_mu_step;
+
+  std::vector<unsigned char>  m_buffer;     // storage for the tiles
+  const unsigned char*        m_nodes;      // first (aligned) tile in m_buffer
+};
+
+
+} // end namespace chrono
+
+
+#endif
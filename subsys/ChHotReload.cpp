@@ -0,0 +1,142 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hot reload of JSON specification files during an interactive simulation.
+//
+// =============================================================================
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChHotReload.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChVehicleModelData.h"
+
+using namespace rapidjson;
+
+
+namespace chrono {
+namespace vehicle {
+
+static void RELOAD_stat(const std::string& filename, long long& mtime, long long& size)
+{
+  struct stat info;
+  if (stat(filename.c_str(), &info) == 0) {
+    mtime = (long long)info.st_mtime;
+    size = (long long)info.st_size;
+  } else {
+    mtime = -1;
+    size = -1;
+  }
+}
+
+// Force curve files referenced by the specified value ("Curve" members, names
+// relative to the data directory).
+static void RELOAD_curves(const Value& v, std::vector<std::string>& files)
+{
+  if (v.IsObject()) {
+    for (Value::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+      if (m->value.IsString() && std::string(m->name.GetString()) == "Curve")
+        files.push_back(GetDataFile(m->value.GetString()));
+      else
+        RELOAD_curves(m->value, files);
+    }
+  }
+  else if (v.IsArray()) {
+    for (SizeType i = 0; i < v.Size(); i++)
+      RELOAD_curves(v[i], files);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChHotReload::Add(const std::string& filename, ChReloadable* object)
+{
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    if (m_entries[i].object == object && m_entries[i].filename == filename)
+      return;
+  }
+
+  Entry entry;
+  entry.filename = filename;
+  entry.object = object;
+  watch(entry);
+
+  m_entries.push_back(entry);
+}
+
+void ChHotReload::watch(Entry& entry)
+{
+  std::vector<std::string> files(1, entry.filename);
+  const Document& d = ChJsonCache::Get(entry.filename);
+  if (d.IsObject())
+    RELOAD_curves(d, files);
+
+  entry.stamps.resize(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    entry.stamps[i].filename = files[i];
+    RELOAD_stat(files[i], entry.stamps[i].mtime, entry.stamps[i].size);
+  }
+}
+
+bool ChHotReload::changed(const Entry& entry)
+{
+  for (size_t i = 0; i < entry.stamps.size(); i++) {
+    long long mtime;
+    long long size;
+    RELOAD_stat(entry.stamps[i].filename, mtime, size);
+    if (mtime != entry.stamps[i].mtime || size != entry.stamps[i].size)
+      return true;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// A file that cannot be parsed (e.g. while it is being saved) is reported by
+// the cache and retried when it changes again.
+// -----------------------------------------------------------------------------
+int ChHotReload::Poll()
+{
+  int num_reloaded = 0;
+
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    Entry& entry = m_entries[i];
+    if (!changed(entry))
+      continue;
+
+    watch(entry);
+
+    const Document& d = ChJsonCache::Get(entry.filename);
+    if (d.HasParseError() || !d.IsObject())
+      continue;
+
+    if (entry.object->Reload(d)) {
+      GetLog() << "Reloaded " << entry.filename.c_str() << "\n";
+      num_reloaded++;
+    } else {
+      GetLog() << "WARNING: changes to " << entry.filename.c_str() << " require a rebuild, ignored\n";
+    }
+  }
+
+  m_num_reloads += num_reloaded;
+
+  return num_reloaded;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
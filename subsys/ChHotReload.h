@@ -0,0 +1,120 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hot reload of JSON specification files during an interactive simulation.
+//
+// Subsystems constructed from a JSON file that can apply new parameter values
+// in place implement ChReloadable. A ChHotReload watches the files of the
+// registered subsystems (and the force curve files they reference, through
+// "Curve" members) and, when Poll() finds that a file changed, passes the
+// re-parsed document (from ChJsonCache) to its subsystems. A subsystem applies
+// the parameters that do not change its topology (masses and inertias, spring
+// and shock laws, tire contact parameters, brake torque), keeping the current
+// state of the simulation; if the topology changed (e.g. a hardpoint moved or a
+// tabulated spring became linear), it changes nothing and the change is
+// reported, as it requires rebuilding the vehicle.
+//
+// Poll() is cheap (a stat() per watched file) and must be called between
+// steps, from the thread advancing the simulation (e.g. once per render frame).
+//
+// =============================================================================
+
+#ifndef CH_HOT_RELOAD_H
+#define CH_HOT_RELOAD_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Interface of the subsystems that can reload their parameters in place.
+///
+class CH_SUBSYS_API ChReloadable
+{
+public:
+
+  virtual ~ChReloadable() {}
+
+  /// Apply the parameters of the specified (re-parsed) specification document
+  /// that can change without rebuilding the subsystem. Returns false, with no
+  /// change, if the document changes the topology of the subsystem.
+  virtual bool Reload(const rapidjson::Document& d) = 0;
+};
+
+///
+/// Watcher of the specification files of reloadable subsystems.
+///
+class CH_SUBSYS_API ChHotReload
+{
+public:
+
+  ChHotReload() : m_num_reloads(0) {}
+
+  /// Watch the specified file for the specified subsystem. The subsystem must
+  /// stay valid as long as it is watched.
+  void Add(
+    const std::string& filename,   ///< [in] specification file of the subsystem
+    ChReloadable*      object      ///< [in] subsystem constructed from the file
+    );
+
+  /// Stop watching all files.
+  void Clear() { m_entries.clear(); }
+
+  /// Get the number of watched subsystems.
+  int GetNumEntries() const { return (int)m_entries.size(); }
+
+  /// Check the watched files and reload the subsystems whose files changed.
+  /// Returns the number of subsystems reloaded.
+  int Poll();
+
+  /// Get the total number of subsystems reloaded.
+  int GetNumReloads() const { return m_num_reloads; }
+
+private:
+
+  struct Stamp {
+    std::string  filename;
+    long long    mtime;
+    long long    size;
+  };
+
+  struct Entry {
+    std::string          filename;
+    ChReloadable*        object;
+    std::vector<Stamp>   stamps;     // the file, then the curve files it references
+  };
+
+  // Record the watched files of the entry, with their current stamps.
+  static void watch(Entry& entry);
+
+  // Return true if a watched file of the entry changed since watch().
+  static bool changed(const Entry& entry);
+
+  std::vector<Entry>  m_entries;
+  int                 m_num_reloads;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
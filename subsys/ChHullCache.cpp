@@ -0,0 +1,254 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of convex decompositions of triangular meshes.
+//
+// Binary hull file layout (native byte order):
+//   magic "CHHULL1\0" (8 bytes)
+//   uint32 number of hulls
+//   uint32 number of vertices of each hull
+//   vertices of all hulls (3 doubles each)
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "core/ChLog.h"
+#include "collision/ChCConvexDecomposition.h"
+
+#include "subsys/ChHullCache.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+typedef std::map<std::string, ChHullCache::Hulls> ChHullMap;
+
+static ChMutex             s_hull_mutex;
+static ChHullMap           s_hull_entries;
+static int                 s_num_computed = 0;
+static ChHullCache::Hulls  s_empty_hulls;
+
+static const char s_hull_magic[8] = { 'C', 'H', 'H', 'U', 'L', 'L', '1', 0 };
+
+
+// -----------------------------------------------------------------------------
+// Binary hull I/O
+// -----------------------------------------------------------------------------
+static std::string GetBakedFile(const std::string& filename)
+{
+  return filename + ".chhull";
+}
+
+static bool WriteBaked(const std::string& filename, const ChHullCache::Hulls& hulls)
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  unsigned int num_hulls = (unsigned int)hulls.size();
+  fwrite(s_hull_magic, 1, sizeof(s_hull_magic), fp);
+  fwrite(&num_hulls, sizeof(unsigned int), 1, fp);
+  for (size_t i = 0; i < hulls.size(); i++) {
+    unsigned int count = (unsigned int)hulls[i].size();
+    fwrite(&count, sizeof(unsigned int), 1, fp);
+  }
+  for (size_t i = 0; i < hulls.size(); i++) {
+    for (size_t j = 0; j < hulls[i].size(); j++) {
+      double data[3] = { hulls[i][j].x, hulls[i][j].y, hulls[i][j].z };
+      fwrite(data, sizeof(double), 3, fp);
+    }
+  }
+
+  bool ok = !ferror(fp);
+  fclose(fp);
+
+  return ok;
+}
+
+static bool ReadBaked(const std::string& filename, ChHullCache::Hulls& hulls)
+{
+  ChMappedFile file;
+  if (!file.Open(filename))
+    return false;
+
+  size_t header_size = sizeof(s_hull_magic) + sizeof(unsigned int);
+  if (file.GetSize() < header_size || memcmp(file.GetData(), s_hull_magic, sizeof(s_hull_magic)) != 0)
+    return false;
+
+  unsigned int num_hulls;
+  memcpy(&num_hulls, file.GetData() + sizeof(s_hull_magic), sizeof(unsigned int));
+  if (file.GetSize() < header_size + num_hulls * sizeof(unsigned int))
+    return false;
+
+  std::vector<unsigned int> counts(num_hulls);
+  if (num_hulls > 0)
+    memcpy(&counts[0], file.GetData() + header_size, num_hulls * sizeof(unsigned int));
+
+  size_t size = header_size + num_hulls * sizeof(unsigned int);
+  for (unsigned int i = 0; i < num_hulls; i++)
+    size += 3 * sizeof(double) * (size_t)counts[i];
+  if (file.GetSize() != size)
+    return false;
+
+  const char* src = file.GetData() + header_size + num_hulls * sizeof(unsigned int);
+  hulls.resize(num_hulls);
+  for (unsigned int i = 0; i < num_hulls; i++) {
+    hulls[i].resize(counts[i]);
+    for (unsigned int j = 0; j < counts[i]; j++) {
+      double data[3];
+      memcpy(data, src, sizeof(data));
+      hulls[i][j] = ChVector<>(data[0], data[1], data[2]);
+      src += sizeof(data);
+    }
+  }
+
+  return true;
+}
+
+// Compute the convex decomposition of the specified mesh.
+static void Decompose(const geometry::ChTriangleMeshConnected& mesh,
+                      const ChHullCache::Params&               params,
+                      ChHullCache::Hulls&                      hulls)
+{
+  collision::ChConvexDecompositionHACD decomposition;
+  decomposition.Reset();
+  decomposition.AddTriangleMesh(mesh);
+  decomposition.ComputeConvexDecomposition(params.num_clusters, params.target_decimation, params.max_concavity);
+
+  hulls.resize(decomposition.GetHullCount());
+  for (unsigned int i = 0; i < decomposition.GetHullCount(); i++)
+    decomposition.GetConvexHullResult(i, hulls[i]);
+}
+
+// -----------------------------------------------------------------------------
+// Load the hulls from the pre-baked file, if it is up to date, or else compute
+// them and write the pre-baked file. Must be called with the cache mutex
+// locked.
+// -----------------------------------------------------------------------------
+static ChHullCache::Hulls* FindEntry(const std::string& filename)
+{
+  ChHullMap::iterator it = s_hull_entries.find(filename);
+  if (it != s_hull_entries.end())
+    return &it->second;
+
+  struct stat obj_info;
+  if (stat(filename.c_str(), &obj_info) != 0) {
+    GetLog() << "ERROR: cannot open mesh file " << filename.c_str() << "\n";
+    return 0;
+  }
+
+  ChHullCache::Hulls& hulls = s_hull_entries[filename];
+
+  std::string baked = GetBakedFile(filename);
+  struct stat baked_info;
+  if (stat(baked.c_str(), &baked_info) == 0 && baked_info.st_mtime >= obj_info.st_mtime) {
+    if (ReadBaked(baked, hulls))
+      return &hulls;
+    GetLog() << "WARNING: ignoring invalid hull file " << baked.c_str() << "\n";
+  }
+
+  Decompose(ChMeshCache::GetMesh(filename), ChHullCache::Params(), hulls);
+  s_num_computed++;
+
+  if (!WriteBaked(baked, hulls))
+    GetLog() << "WARNING: cannot write hull file " << baked.c_str() << "\n";
+
+  return &hulls;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const ChHullCache::Hulls& ChHullCache::GetHulls(const std::string& filename)
+{
+  ChScopedLock lock(s_hull_mutex);
+
+  Hulls* hulls = FindEntry(filename);
+
+  return hulls ? *hulls : s_empty_hulls;
+}
+
+int ChHullCache::AddHullGeometry(ChBody*               body,
+                                 const std::string&    filename,
+                                 const ChVector<>&     pos,
+                                 const ChQuaternion<>& rot)
+{
+  const Hulls& hulls = GetHulls(filename);
+  ChMatrix33<> A(rot);
+
+  for (size_t i = 0; i < hulls.size(); i++) {
+    std::vector<ChVector<> > points(hulls[i]);
+    body->GetCollisionModel()->AddConvexHull(points, pos, A);
+  }
+
+  return (int)hulls.size();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChHullCache::Bake(const std::string& filename, const Params& params)
+{
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) {
+    GetLog() << "ERROR: cannot open mesh file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  Hulls hulls;
+  Decompose(ChMeshCache::GetMesh(filename), params, hulls);
+
+  std::string baked = GetBakedFile(filename);
+  if (!WriteBaked(baked, hulls)) {
+    GetLog() << "ERROR: cannot write hull file " << baked.c_str() << "\n";
+    return false;
+  }
+
+  ChScopedLock lock(s_hull_mutex);
+  s_hull_entries[filename] = hulls;
+  s_num_computed++;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChHullCache::Clear()
+{
+  ChScopedLock lock(s_hull_mutex);
+  s_hull_entries.clear();
+}
+
+int ChHullCache::GetNumMeshes()
+{
+  ChScopedLock lock(s_hull_mutex);
+  return (int)s_hull_entries.size();
+}
+
+int ChHullCache::GetNumComputed()
+{
+  ChScopedLock lock(s_hull_mutex);
+  return s_num_computed;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,108 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of convex decompositions of triangular meshes, used as
+// compound convex collision shapes (e.g. for lugged wheels on granular
+// terrain, where a triangle mesh shape means mesh-sphere contact tests on
+// every lug).
+//
+// The decomposition (HACD) of a Wavefront OBJ file is computed once and stored
+// in a binary file with the name of the OBJ file and the extension ".chhull"
+// appended (see Bake()). At run time, the hulls are read from that file if it
+// exists and is not older than the OBJ file; otherwise they are computed with
+// the default parameters and the binary file is written. The hulls of a mesh
+// are kept in memory and shared by all bodies that use them.
+//
+// =============================================================================
+
+#ifndef CH_HULL_CACHE_H
+#define CH_HULL_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "physics/ChBody.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of convex decompositions of triangular meshes.
+///
+class CH_SUBSYS_API ChHullCache
+{
+public:
+
+  /// Vertices of the convex hulls of a decomposition.
+  typedef std::vector<std::vector<ChVector<> > > Hulls;
+
+  /// Parameters of the convex decomposition.
+  struct Params {
+    Params() : num_clusters(16), target_decimation(0), max_concavity(100) {}
+
+    int     num_clusters;        ///< minimum number of clusters (hulls)
+    int     target_decimation;   ///< number of vertices of the decimated mesh (0: no decimation)
+    double  max_concavity;       ///< maximum concavity of a cluster
+  };
+
+  /// Get the convex hulls of the mesh in the specified OBJ file. If the mesh
+  /// file cannot be read, an error is reported and no hulls are returned. The
+  /// hulls remain valid until Clear() is called.
+  static const Hulls& GetHulls(const std::string& filename);
+
+  /// Add the convex hulls of the mesh in the specified OBJ file to the
+  /// collision model of the specified body, at the specified position and
+  /// orientation relative to the body frame. The collision model must be
+  /// open (between ClearModel() and BuildModel()).
+  /// Returns the number of hulls added.
+  static int AddHullGeometry(
+    ChBody*               body,                                   ///< [in] body
+    const std::string&    filename,                               ///< [in] name of the OBJ file
+    const ChVector<>&     pos = ChVector<>(0, 0, 0),              ///< [in] position relative to the body
+    const ChQuaternion<>& rot = ChQuaternion<>(1, 0, 0, 0)        ///< [in] orientation relative to the body
+    );
+
+  /// Compute the convex decomposition of the mesh in the specified OBJ file
+  /// with the specified parameters and write it to the file with the name of
+  /// the OBJ file and the extension ".chhull" appended. A decomposition of the
+  /// same file already in the cache is replaced.
+  /// Returns false if the OBJ file cannot be read or the output file cannot be
+  /// written.
+  static bool Bake(
+    const std::string& filename,           ///< [in] name of the OBJ file
+    const Params&      params = Params()   ///< [in] decomposition parameters
+    );
+
+  /// Release all cached decompositions.
+  static void Clear();
+
+  /// Return the number of cached decompositions.
+  static int GetNumMeshes();
+
+  /// Return the number of decompositions computed (as opposed to read from a
+  /// binary file).
+  static int GetNumComputed();
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,176 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of parsed JSON specification files.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// A document parsed in situ: its strings point into the file contents, which
+// must therefore live as long as the document. The document nodes are taken
+// from a pool sized after the file, such that a specification file is
+// typically parsed with a single pool allocation.
+struct ChJsonDocument {
+  ChJsonDocument(size_t pool_size) : pool(pool_size), doc(&pool) {}
+
+  rapidjson::MemoryPoolAllocator<>  pool;
+  rapidjson::Document               doc;
+  std::vector<char>                 text;
+};
+
+struct ChJsonEntry {
+  ChJsonDocument*  doc;
+  long long        mtime;
+  long long        size;
+};
+
+typedef std::map<std::string, ChJsonEntry> ChJsonMap;
+typedef std::map<std::string, const rapidjson::Document*> ChJsonOverrideMap;
+
+static ChMutex                           s_mutex;
+static ChJsonMap                         s_entries;
+static std::vector<ChJsonDocument*>      s_retired;    // replaced documents, possibly still in use
+static ChJsonOverrideMap                 s_overrides;
+static int                               s_num_parsed = 0;
+static rapidjson::Document               s_empty;
+
+static const size_t                      MIN_POOL_SIZE = 4096;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const rapidjson::Document& ChJsonCache::Get(const std::string& filename)
+{
+  ChScopedLock lock(s_mutex);
+
+  if (!s_overrides.empty()) {
+    ChJsonOverrideMap::const_iterator over = s_overrides.find(filename);
+    if (over != s_overrides.end())
+      return *over->second;
+  }
+
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) {
+    GetLog() << "ERROR: cannot open JSON file " << filename.c_str() << "\n";
+    return s_empty;
+  }
+
+  ChJsonMap::iterator it = s_entries.find(filename);
+  if (it != s_entries.end()) {
+    if (it->second.mtime == (long long)info.st_mtime && it->second.size == (long long)info.st_size)
+      return it->second.doc->doc;
+
+    // The file changed; keep the old document alive, as it may still be used.
+    s_retired.push_back(it->second.doc);
+    s_entries.erase(it);
+  }
+
+  CH_STARTUP_SCOPE("ChJsonCache::Parse");
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open JSON file " << filename.c_str() << "\n";
+    return s_empty;
+  }
+
+  // Read the whole file in one call and parse it in situ (no copies of the
+  // strings). The nodes of a document take about as many bytes as its text.
+  size_t size = (size_t)info.st_size;
+
+  ChJsonEntry entry;
+  entry.doc = new ChJsonDocument(size > MIN_POOL_SIZE ? size : MIN_POOL_SIZE);
+
+  std::vector<char>& text = entry.doc->text;
+  text.resize(size + 1);
+  size_t n = (size > 0) ? fread(&text[0], 1, size, fp) : 0;
+  fclose(fp);
+
+  if (n != size) {
+    GetLog() << "ERROR: cannot read JSON file " << filename.c_str() << "\n";
+    delete entry.doc;
+    return s_empty;
+  }
+  text[size] = 0;
+
+  entry.doc->doc.ParseInsitu<0>(&text[0]);
+  entry.mtime = (long long)info.st_mtime;
+  entry.size = (long long)info.st_size;
+  s_num_parsed++;
+
+  if (entry.doc->doc.HasParseError())
+    GetLog() << "ERROR: cannot parse JSON file " << filename.c_str() << "\n";
+
+  s_entries[filename] = entry;
+
+  return entry.doc->doc;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChJsonCache::SetOverride(const std::string& filename, const rapidjson::Document* doc)
+{
+  ChScopedLock lock(s_mutex);
+
+  if (doc)
+    s_overrides[filename] = doc;
+  else
+    s_overrides.erase(filename);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChJsonCache::Clear()
+{
+  ChScopedLock lock(s_mutex);
+
+  for (ChJsonMap::iterator it = s_entries.begin(); it != s_entries.end(); ++it)
+    delete it->second.doc;
+  for (size_t i = 0; i < s_retired.size(); i++)
+    delete s_retired[i];
+
+  s_entries.clear();
+  s_retired.clear();
+}
+
+int ChJsonCache::GetNumDocuments()
+{
+  ChScopedLock lock(s_mutex);
+  return (int)s_entries.size();
+}
+
+int ChJsonCache::GetNumParsed()
+{
+  ChScopedLock lock(s_mutex);
+  return s_num_parsed;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,82 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of parsed JSON specification files.
+//
+// The vehicle and subsystem templates that are constructed from a JSON file
+// obtain the parsed document from this cache. A file is read and parsed only
+// the first time it is requested, or again after its modification time or size
+// changed. Documents are read-only and stay valid until Clear() is called, so
+// the cache can be used from multiple threads.
+//
+// Files are read in a single call and parsed in situ: the document strings
+// point into the file contents, kept with the document, so that parsing
+// allocates only the document nodes, from a memory pool sized after the file.
+// There is no limit on the file size.
+//
+// A document can be overridden in memory by another document (e.g. a patched
+// copy, see ChJsonPatch), which is then returned for that file name instead of
+// the file contents, by all threads, until the override is removed.
+//
+// =============================================================================
+
+#ifndef CH_JSON_CACHE_H
+#define CH_JSON_CACHE_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of parsed JSON files, keyed by path and modification time.
+///
+class CH_SUBSYS_API ChJsonCache
+{
+public:
+
+  /// Get the parsed contents of the specified JSON file.
+  /// If the file cannot be read, an error is reported and an empty (null)
+  /// document is returned; if it cannot be parsed, the returned document has a
+  /// parse error.
+  static const rapidjson::Document& Get(const std::string& filename);
+
+  /// Return the specified document for the specified JSON file, instead of the
+  /// file contents, until the override is removed (with a null document). The
+  /// document must stay valid as long as the override is in place and the
+  /// overridden document is in use.
+  static void SetOverride(const std::string& filename, const rapidjson::Document* doc);
+
+  /// Delete all cached documents. No document obtained from the cache may be
+  /// in use (by any thread) when this function is called.
+  static void Clear();
+
+  /// Return the number of cached documents.
+  static int GetNumDocuments();
+
+  /// Return the number of times a file was read and parsed.
+  static int GetNumParsed();
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,158 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory patch of JSON specification files.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdlib>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChJsonPatch.h"
+#include "subsys/ChJsonCache.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChJsonPatch::~ChJsonPatch()
+{
+  Revert();
+}
+
+void ChJsonPatch::Add(const std::string& filename, const std::string& pointer, double value)
+{
+  Entry entry;
+  entry.filename = filename;
+  entry.pointer = pointer;
+  entry.value = value;
+  m_entries.push_back(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Reference tokens are separated by '/'; "~1" stands for '/' and "~0" for '~'.
+// Array elements are addressed by their index.
+// -----------------------------------------------------------------------------
+rapidjson::Value* ChJsonPatch::Resolve(rapidjson::Value& root, const std::string& pointer)
+{
+  rapidjson::Value* value = &root;
+  size_t pos = 0;
+
+  while (pos < pointer.size()) {
+    if (pointer[pos] != '/')
+      return 0;
+
+    size_t end = pointer.find('/', pos + 1);
+    if (end == std::string::npos)
+      end = pointer.size();
+
+    std::string token;
+    for (size_t i = pos + 1; i < end; i++) {
+      if (pointer[i] == '~' && i + 1 < end && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+        token += (pointer[i + 1] == '0') ? '~' : '/';
+        i++;
+      } else {
+        token += pointer[i];
+      }
+    }
+    pos = end;
+
+    if (value->IsObject()) {
+      rapidjson::Value::MemberIterator member = value->FindMember(token.c_str());
+      if (member == value->MemberEnd())
+        return 0;
+      value = &member->value;
+    }
+    else if (value->IsArray()) {
+      char* last;
+      long index = std::strtol(token.c_str(), &last, 10);
+      if (token.empty() || *last != 0 || index < 0 || index >= (long)value->Size())
+        return 0;
+      value = &(*value)[(rapidjson::SizeType)index];
+    }
+    else {
+      return 0;
+    }
+  }
+
+  return value;
+}
+
+// -----------------------------------------------------------------------------
+// Integer values stay integers if the new value is integral, as the templates
+// may read them with GetInt().
+// -----------------------------------------------------------------------------
+bool ChJsonPatch::Apply()
+{
+  Revert();
+
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    const Entry& entry = m_entries[i];
+
+    size_t k = 0;
+    while (k < m_files.size() && m_files[k] != entry.filename)
+      k++;
+
+    if (k == m_files.size()) {
+      const rapidjson::Document& source = ChJsonCache::Get(entry.filename);
+      if (source.HasParseError() || !source.IsObject()) {
+        GetLog() << "ERROR: cannot patch JSON file " << entry.filename.c_str() << "\n";
+        Revert();
+        return false;
+      }
+
+      rapidjson::Document* doc = new rapidjson::Document;
+      doc->CopyFrom(source, doc->GetAllocator());
+      m_files.push_back(entry.filename);
+      m_docs.push_back(doc);
+    }
+
+    rapidjson::Value* value = Resolve(*m_docs[k], entry.pointer);
+    if (!value || !value->IsNumber()) {
+      GetLog() << "ERROR: " << entry.pointer.c_str() << " is not a number in " << entry.filename.c_str() << "\n";
+      Revert();
+      return false;
+    }
+
+    if (value->IsInt() && entry.value == std::floor(entry.value) && std::abs(entry.value) < 2147483647.0)
+      value->SetInt((int)entry.value);
+    else
+      value->SetDouble(entry.value);
+  }
+
+  for (size_t k = 0; k < m_files.size(); k++)
+    ChJsonCache::SetOverride(m_files[k], m_docs[k]);
+
+  return true;
+}
+
+void ChJsonPatch::Revert()
+{
+  for (size_t k = 0; k < m_files.size(); k++) {
+    ChJsonCache::SetOverride(m_files[k], 0);
+    delete m_docs[k];
+  }
+
+  m_files.clear();
+  m_docs.clear();
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,100 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory patch of JSON specification files.
+//
+// A patch is a set of numeric values, each addressed by a file name and a JSON
+// pointer (RFC 6901, e.g. "/Axles/0/Suspension Location/2" or
+// "/Spring/Spring Coefficient"). Applying the patch makes a copy of the cached
+// document of each patched file (see ChJsonCache), sets the values in the copy
+// and installs the copy as an override of the file, such that the templates
+// constructed from that file while the patch is applied see the patched
+// values. No file is written.
+//
+// The overrides are seen by all threads; patches of the same files must not be
+// applied concurrently (the scenario runner applies the patch of a scenario
+// within its serialized setup).
+//
+// =============================================================================
+
+#ifndef CH_JSON_PATCH_H
+#define CH_JSON_PATCH_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Set of numeric values patched into JSON specification files.
+///
+class CH_SUBSYS_API ChJsonPatch
+{
+public:
+
+  ChJsonPatch() {}
+
+  /// The destructor reverts the patch, if applied.
+  ~ChJsonPatch();
+
+  /// Add the specified value to the patch. The file name must be the one used
+  /// to obtain the document from the cache (e.g. as returned by GetDataFile()).
+  void Add(
+    const std::string& filename,   ///< [in] patched JSON file
+    const std::string& pointer,    ///< [in] JSON pointer to a numeric value in the file
+    double             value       ///< [in] new value
+    );
+
+  /// Get the number of values in the patch.
+  int GetNumValues() const { return (int)m_entries.size(); }
+
+  /// Apply the patch. Returns false (and leaves no override in place) if a
+  /// file cannot be parsed or a pointer does not address a numeric value.
+  bool Apply();
+
+  /// Remove the overrides installed by Apply().
+  void Revert();
+
+  /// Return the value addressed by the specified JSON pointer, or null if
+  /// there is none.
+  static rapidjson::Value* Resolve(rapidjson::Value& root, const std::string& pointer);
+
+private:
+
+  struct Entry {
+    std::string  filename;
+    std::string  pointer;
+    double       value;
+  };
+
+  ChJsonPatch(const ChJsonPatch&);
+  ChJsonPatch& operator=(const ChJsonPatch&);
+
+  std::vector<Entry>                 m_entries;
+  std::vector<std::string>           m_files;   // patched files ...
+  std::vector<rapidjson::Document*>  m_docs;    // ... and their patched copies (while applied)
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,81 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Utility functions for reading the JSON specification files of the vehicle
+// and subsystem templates.
+//
+// =============================================================================
+
+#ifndef CH_JSON_UTILS_H
+#define CH_JSON_UTILS_H
+
+#include <cassert>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+
+#include "rapidjson/document.h"
+
+#include "subsys/ChSolverProfile.h"
+
+
+namespace chrono {
+
+/// Return a ChVector from the specified JSON array (of 3 numbers).
+inline ChVector<> loadVector(const rapidjson::Value& a)
+{
+  assert(a.IsArray());
+  assert(a.Size() == 3);
+  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
+}
+
+/// Return a ChQuaternion from the specified JSON array (of 4 numbers).
+inline ChQuaternion<> loadQuaternion(const rapidjson::Value& a)
+{
+  assert(a.IsArray());
+  assert(a.Size() == 4);
+  return ChQuaternion<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble(), a[3u].GetDouble());
+}
+
+// Load solver settings, given either as the name of a predefined profile or as
+// an object with the "Profile" name and optional overrides. Returns false if a
+// profile or solver type name is not recognized.
+inline bool loadSolverProfile(const rapidjson::Value& a, ChSolverProfile& profile)
+{
+  if (a.IsString())
+    return ChSolverProfile::Get(a.GetString(), profile);
+
+  assert(a.IsObject());
+  if (a.HasMember("Profile") && !ChSolverProfile::Get(a["Profile"].GetString(), profile))
+    return false;
+  if (a.HasMember("Solver Type") && !profile.SetSolverType(a["Solver Type"].GetString()))
+    return false;
+  if (a.HasMember("Max Iterations Speed"))
+    profile.max_iters_speed = a["Max Iterations Speed"].GetInt();
+  if (a.HasMember("Max Iterations Stabilization"))
+    profile.max_iters_stab = a["Max Iterations Stabilization"].GetInt();
+  if (a.HasMember("Tolerance"))
+    profile.tolerance = a["Tolerance"].GetDouble();
+  if (a.HasMember("Max Recovery Speed"))
+    profile.max_recovery_speed = a["Max Recovery Speed"].GetDouble();
+  if (a.HasMember("Warm Start"))
+    profile.warm_start = a["Warm Start"].GetBool();
+
+  return true;
+}
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,321 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Online computation of key performance indicators of a vehicle simulation.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChKpiMonitor.h"
+#include "subsys/ChVehicleSimulation.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChKpiMonitor::add(const std::string& name)
+{
+  Kpi kpi;
+  kpi.name = name;
+  kpi.quantity = SPEED;
+  kpi.wheel = 0;
+  kpi.has_threshold = false;
+  kpi.threshold = 0;
+  kpi.hist_lo = 0;
+  kpi.hist_hi = 0;
+  reset(kpi);
+
+  m_kpis.push_back(kpi);
+
+  return (int)m_kpis.size() - 1;
+}
+
+int ChKpiMonitor::AddKpi(const std::string& name, Quantity quantity, int wheel)
+{
+  int index = add(name);
+  m_kpis[index].quantity = quantity;
+  m_kpis[index].wheel = wheel;
+
+  return index;
+}
+
+int ChKpiMonitor::AddKpi(const std::string& name, ChSharedPtr<ChKpiSource> source)
+{
+  int index = add(name);
+  m_kpis[index].source = source;
+
+  return index;
+}
+
+int ChKpiMonitor::AddKpi(const std::string& name)
+{
+  return add(name);
+}
+
+void ChKpiMonitor::SetThreshold(int kpi, double threshold)
+{
+  m_kpis[kpi].has_threshold = true;
+  m_kpis[kpi].threshold = threshold;
+}
+
+void ChKpiMonitor::SetHistogram(int kpi, double lo, double hi, int num_bins)
+{
+  m_kpis[kpi].hist_lo = lo;
+  m_kpis[kpi].hist_hi = hi;
+  m_kpis[kpi].bins.assign(std::max(num_bins, 1), 0);
+}
+
+int ChKpiMonitor::GetIndex(const std::string& name) const
+{
+  for (size_t k = 0; k < m_kpis.size(); k++) {
+    if (m_kpis[k].name == name)
+      return (int)k;
+  }
+  return -1;
+}
+
+bool ChKpiMonitor::OpenTrace(const std::string& filename, int decimation, ChOutputChannel::Format format)
+{
+  std::string header = "time";
+  for (size_t k = 0; k < m_kpis.size(); k++)
+    header += "," + m_kpis[k].name;
+
+  m_decimation = std::max(decimation, 1);
+  m_row.resize(1 + m_kpis.size());
+
+  return m_trace.Open(filename, header, format);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChKpiMonitor::reset(Kpi& kpi)
+{
+  kpi.count = 0;
+  kpi.min = 0;
+  kpi.max = 0;
+  kpi.time_min = 0;
+  kpi.time_max = 0;
+  kpi.sum = 0;
+  kpi.sum_sq = 0;
+  kpi.integral = 0;
+  kpi.up_crossings = 0;
+  kpi.down_crossings = 0;
+  kpi.time_above = 0;
+  kpi.last_value = 0;
+  kpi.last_time = 0;
+  std::fill(kpi.bins.begin(), kpi.bins.end(), 0);
+}
+
+void ChKpiMonitor::Reset()
+{
+  for (size_t k = 0; k < m_kpis.size(); k++)
+    reset(m_kpis[k]);
+  m_num_updates = 0;
+}
+
+double ChKpiMonitor::evaluate(Quantity quantity, int wheel, const ChVehicleSimulation& sim)
+{
+  const ChVehicle& vehicle = *sim.GetVehicle();
+  const ChPowertrain& powertrain = *sim.GetPowertrain();
+  ChBodyAuxRef* chassis = vehicle.GetChassisBody();
+
+  switch (quantity) {
+  case SPEED:
+    return chassis->GetFrame_REF_to_abs().GetPos_dt() ^ vehicle.GetChassisRot().GetXaxis();
+  case LONGITUDINAL_ACCEL:
+    return chassis->GetRot().RotateBack(chassis->GetPos_dtdt()).x;
+  case LATERAL_ACCEL:
+    return chassis->GetRot().RotateBack(chassis->GetPos_dtdt()).y;
+  case VERTICAL_ACCEL:
+    return chassis->GetRot().RotateBack(chassis->GetPos_dtdt()).z;
+  case ROLL_ANGLE: {
+    const ChQuaternion<>& q = chassis->GetRot();
+    return std::atan2(q.GetYaxis().z, q.GetZaxis().z);
+  }
+  case PITCH_ANGLE:
+    return -std::asin(std::min(std::max(chassis->GetRot().GetXaxis().z, -1.0), 1.0));
+  case YAW_RATE:
+    return chassis->GetWvel_loc().z;
+  case WHEEL_LOAD:
+    return sim.GetTireForces()[wheel].force.z;
+  case ENGINE_SPEED:
+    return powertrain.GetMotorSpeed();
+  case ENGINE_POWER:
+    return powertrain.GetMotorTorque() * powertrain.GetMotorSpeed();
+  case THROTTLE:
+    return sim.GetThrottle();
+  case BRAKING:
+    return sim.GetBraking();
+  case STEERING:
+    return sim.GetSteering();
+  }
+
+  return 0;
+}
+
+// The time above the threshold and the integral over a step are computed from
+// the linear interpolation of the signal between the two samples.
+void ChKpiMonitor::accumulate(Kpi& kpi, double time, double value)
+{
+  if (kpi.count == 0) {
+    kpi.min = kpi.max = value;
+    kpi.time_min = kpi.time_max = time;
+  } else {
+    double dt = time - kpi.last_time;
+    kpi.integral += 0.5 * (value + kpi.last_value) * dt;
+
+    if (kpi.has_threshold) {
+      double a = kpi.last_value - kpi.threshold;
+      double b = value - kpi.threshold;
+      if (a > 0 && b > 0)
+        kpi.time_above += dt;
+      else if (a > 0 || b > 0)
+        kpi.time_above += dt * std::max(a, b) / std::abs(b - a);
+      if (a <= 0 && b > 0)
+        kpi.up_crossings++;
+      else if (a > 0 && b <= 0)
+        kpi.down_crossings++;
+    }
+
+    if (value < kpi.min) {
+      kpi.min = value;
+      kpi.time_min = time;
+    }
+    if (value > kpi.max) {
+      kpi.max = value;
+      kpi.time_max = time;
+    }
+  }
+
+  kpi.count++;
+  kpi.sum += value;
+  kpi.sum_sq += value * value;
+  kpi.last_value = value;
+  kpi.last_time = time;
+
+  int num_bins = (int)kpi.bins.size();
+  if (num_bins > 0) {
+    int bin = (int)std::floor((value - kpi.hist_lo) / (kpi.hist_hi - kpi.hist_lo) * num_bins);
+    kpi.bins[std::min(std::max(bin, 0), num_bins - 1)]++;
+  }
+}
+
+void ChKpiMonitor::Update(const ChVehicleSimulation& sim)
+{
+  double time = sim.GetTime();
+  bool trace = m_trace.IsOpen() && (m_num_updates % m_decimation == 0);
+
+  for (size_t k = 0; k < m_kpis.size(); k++) {
+    Kpi& kpi = m_kpis[k];
+    double value = kpi.source.IsNull() ? evaluate(kpi.quantity, kpi.wheel, sim) : kpi.source->Evaluate(sim);
+    accumulate(kpi, time, value);
+    if (trace)
+      m_row[1 + k] = value;
+  }
+
+  if (trace) {
+    m_row[0] = time;
+    m_trace.Write(&m_row[0]);
+  }
+
+  m_num_updates++;
+}
+
+void ChKpiMonitor::Update(double time, const double* values)
+{
+  bool trace = m_trace.IsOpen() && (m_num_updates % m_decimation == 0);
+
+  for (size_t k = 0; k < m_kpis.size(); k++) {
+    accumulate(m_kpis[k], time, values[k]);
+    if (trace)
+      m_row[1 + k] = values[k];
+  }
+
+  if (trace) {
+    m_row[0] = time;
+    m_trace.Write(&m_row[0]);
+  }
+
+  m_num_updates++;
+}
+
+double ChKpiMonitor::GetMean(int kpi) const
+{
+  const Kpi& k = m_kpis[kpi];
+  return (k.count > 0) ? k.sum / k.count : 0;
+}
+
+double ChKpiMonitor::GetRMS(int kpi) const
+{
+  const Kpi& k = m_kpis[kpi];
+  return (k.count > 0) ? std::sqrt(k.sum_sq / k.count) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChKpiMonitor::WriteSummary(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  fprintf(fp, "name,count,min,time_min,max,time_max,mean,rms,integral,threshold,up_crossings,down_crossings,"
+              "time_above\n");
+  for (int k = 0; k < (int)m_kpis.size(); k++) {
+    const Kpi& kpi = m_kpis[k];
+    fprintf(fp, "%s,%d,%.10g,%.10g,%.10g,%.10g,%.10g,%.10g,%.10g,", kpi.name.c_str(), kpi.count, kpi.min,
+            kpi.time_min, kpi.max, kpi.time_max, GetMean(k), GetRMS(k), kpi.integral);
+    if (kpi.has_threshold)
+      fprintf(fp, "%.10g,%d,%d,%.10g\n", kpi.threshold, kpi.up_crossings, kpi.down_crossings, kpi.time_above);
+    else
+      fprintf(fp, ",,,\n");
+  }
+
+  return fclose(fp) == 0;
+}
+
+bool ChKpiMonitor::WriteHistograms(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  fprintf(fp, "name,lo,hi,count\n");
+  for (size_t k = 0; k < m_kpis.size(); k++) {
+    const Kpi& kpi = m_kpis[k];
+    int num_bins = (int)kpi.bins.size();
+    double width = (kpi.hist_hi - kpi.hist_lo) / std::max(num_bins, 1);
+    for (int i = 0; i < num_bins; i++)
+      fprintf(fp, "%s,%.10g,%.10g,%d\n", kpi.name.c_str(), kpi.hist_lo + i * width, kpi.hist_lo + (i + 1) * width,
+              kpi.bins[i]);
+  }
+
+  return fclose(fp) == 0;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,223 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Online computation of key performance indicators (KPIs) of a vehicle
+// simulation, e.g. the peak lateral acceleration, the largest roll angle, the
+// wheel lift-offs or the energy used, without writing full traces.
+//
+// Each KPI is a signal, either one of the built-in vehicle, tire, powertrain
+// and driver quantities or a user-defined source (see ChKpiSource), fed into
+// a streaming accumulator at each update: sample count, minimum and maximum
+// (with their times), mean, RMS and time integral (trapezoidal, e.g. the
+// energy for a power signal). Optionally, a KPI also counts the crossings of
+// a threshold and the time spent above it (e.g. a wheel load below a small
+// threshold is a lift-off), and bins the samples in a histogram. An update
+// costs a constant time per KPI and does not allocate.
+//
+// The monitor attached to a ChVehicleSimulation (see
+// ChVehicleSimulation::SetKpiMonitor()) is updated at the end of each step.
+// Only the summary (one CSV row per KPI) and the histograms are written, and
+// optionally a decimated trace of all KPI signals (see ChOutputChannel). The
+// same accumulators can be fed with the signals of a reduced model (see
+// ChRideModel), so that its KPIs compare directly with the full model.
+//
+// =============================================================================
+
+#ifndef CH_KPI_MONITOR_H
+#define CH_KPI_MONITOR_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChOutputChannel.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChVehicleSimulation;
+
+///
+/// Source of a user-defined KPI signal.
+///
+class CH_SUBSYS_API ChKpiSource : public ChShared
+{
+public:
+  virtual ~ChKpiSource() {}
+
+  /// Evaluate the signal for the current state of the simulation.
+  virtual double Evaluate(const ChVehicleSimulation& sim) const = 0;
+};
+
+///
+/// Streaming accumulators of KPI signals.
+///
+class CH_SUBSYS_API ChKpiMonitor
+{
+public:
+
+  /// Built-in signals. The accelerations and angles are those of the chassis
+  /// (center of mass), in the chassis frame; the wheel load is the vertical
+  /// component of the tire force exchanged at the last step.
+  enum Quantity {
+    SPEED,                ///< forward speed
+    LONGITUDINAL_ACCEL,   ///< longitudinal acceleration
+    LATERAL_ACCEL,        ///< lateral acceleration
+    VERTICAL_ACCEL,       ///< vertical acceleration (without gravity)
+    ROLL_ANGLE,           ///< roll angle
+    PITCH_ANGLE,          ///< pitch angle
+    YAW_RATE,             ///< yaw rate
+    WHEEL_LOAD,           ///< vertical tire force on the specified wheel
+    ENGINE_SPEED,         ///< engine speed
+    ENGINE_POWER,         ///< engine torque times engine speed
+    THROTTLE,             ///< throttle input
+    BRAKING,              ///< braking input
+    STEERING              ///< steering input
+  };
+
+  ChKpiMonitor() : m_num_updates(0), m_decimation(1) {}
+  ~ChKpiMonitor() {}
+
+  /// Add a KPI on a built-in signal. Returns the index of the KPI.
+  int AddKpi(
+    const std::string& name,      ///< [in] name of the KPI
+    Quantity           quantity,  ///< [in] monitored signal
+    int                wheel = 0  ///< [in] wheel ID (WHEEL_LOAD only)
+    );
+
+  /// Add a KPI on a user-defined signal. Returns the index of the KPI.
+  int AddKpi(const std::string& name, ChSharedPtr<ChKpiSource> source);
+
+  /// Add a KPI on a signal sampled by the caller, for a model other than a
+  /// ChVehicleSimulation (e.g. a ChRideModel, see Update(double, const
+  /// double*)). Returns the index of the KPI.
+  int AddKpi(const std::string& name);
+
+  /// Count the crossings of the specified threshold, and the time spent above
+  /// it, for the specified KPI.
+  void SetThreshold(int kpi, double threshold);
+
+  /// Bin the samples of the specified KPI in a histogram with the specified
+  /// number of bins over [lo, hi]; samples outside the range are counted in
+  /// the first or last bin.
+  void SetHistogram(int kpi, double lo, double hi, int num_bins);
+
+  /// Write the signals of all KPIs at every 'decimation'-th update to the
+  /// specified file (one column per KPI, after the time). Must be called
+  /// after all KPIs were added. Returns false if the file cannot be opened.
+  bool OpenTrace(
+    const std::string&      filename,                       ///< [in] name of the trace file
+    int                     decimation,                     ///< [in] updates per trace row
+    ChOutputChannel::Format format = ChOutputChannel::CSV   ///< [in] file format
+    );
+
+  /// Discard all accumulated values (the KPI definitions are kept).
+  void Reset();
+
+  /// Sample all KPI signals for the current state of the simulation.
+  void Update(const ChVehicleSimulation& sim);
+
+  /// Add the specified samples, one per KPI (in KPI order), at the specified
+  /// time. The KPI sources are not evaluated.
+  void Update(double time, const double* values);
+
+  /// Get the number of KPIs.
+  int GetNumKpis() const { return (int)m_kpis.size(); }
+
+  /// Get the index of the KPI with the specified name (-1 if none).
+  int GetIndex(const std::string& name) const;
+
+  /// Accumulated values of the specified KPI.
+  const std::string& GetName(int kpi) const { return m_kpis[kpi].name; }
+  int    GetCount(int kpi) const { return m_kpis[kpi].count; }
+  double GetMin(int kpi) const { return m_kpis[kpi].min; }
+  double GetMax(int kpi) const { return m_kpis[kpi].max; }
+  double GetTimeOfMin(int kpi) const { return m_kpis[kpi].time_min; }
+  double GetTimeOfMax(int kpi) const { return m_kpis[kpi].time_max; }
+  double GetMean(int kpi) const;
+  double GetRMS(int kpi) const;
+  double GetIntegral(int kpi) const { return m_kpis[kpi].integral; }
+  int    GetUpCrossings(int kpi) const { return m_kpis[kpi].up_crossings; }
+  int    GetDownCrossings(int kpi) const { return m_kpis[kpi].down_crossings; }
+  double GetTimeAbove(int kpi) const { return m_kpis[kpi].time_above; }
+  const std::vector<int>& GetHistogram(int kpi) const { return m_kpis[kpi].bins; }
+
+  /// Write the summary, one CSV row per KPI. Returns false if the file cannot
+  /// be written.
+  bool WriteSummary(const std::string& filename) const;
+
+  /// Write the histograms, one CSV row per bin (KPI name, bin range, count).
+  /// Returns false if the file cannot be written.
+  bool WriteHistograms(const std::string& filename) const;
+
+private:
+
+  struct Kpi {
+    std::string               name;
+    Quantity                  quantity;
+    int                       wheel;
+    ChSharedPtr<ChKpiSource>  source;
+
+    bool                      has_threshold;
+    double                    threshold;
+    double                    hist_lo;
+    double                    hist_hi;
+    std::vector<int>          bins;
+
+    int                       count;
+    double                    min;
+    double                    max;
+    double                    time_min;
+    double                    time_max;
+    double                    sum;
+    double                    sum_sq;
+    double                    integral;
+    int                       up_crossings;
+    int                       down_crossings;
+    double                    time_above;
+    double                    last_value;
+    double                    last_time;
+  };
+
+  ChKpiMonitor(const ChKpiMonitor&);
+  ChKpiMonitor& operator=(const ChKpiMonitor&);
+
+  // Evaluate a built-in signal.
+  static double evaluate(Quantity quantity, int wheel, const ChVehicleSimulation& sim);
+
+  // Add a sample to the accumulators of a KPI.
+  static void accumulate(Kpi& kpi, double time, double value);
+
+  // Reset the accumulators of a KPI.
+  static void reset(Kpi& kpi);
+
+  int add(const std::string& name);
+
+  std::vector<Kpi>     m_kpis;
+  int                  m_num_updates;
+
+  ChOutputChannel      m_trace;
+  int                  m_decimation;
+  std::vector<double>  m_row;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,282 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Finite-difference linearization of the vehicle dynamics.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChLinearizer.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// Ranges of the driver inputs.
+static const double INPUT_MIN[] = { -1, 0, 0 };
+static const double INPUT_MAX[] = { 1, 1, 1 };
+
+class ChLinearizerTask : public ChTask
+{
+public:
+  ChLinearizerTask(ChLinearizer* owner, int index) : m_owner(owner), m_index(index) {}
+
+  virtual void Execute(int worker) { m_owner->evaluate(worker, m_index); }
+
+private:
+  ChLinearizer* m_owner;
+  int           m_index;
+};
+
+// Rotation vector (axis times angle) of the specified unit quaternion.
+static ChVector<> RotationVector(const ChQuaternion<>& q)
+{
+  double sign = (q.e0 < 0) ? -1 : 1;
+  ChVector<> v(sign * q.e1, sign * q.e2, sign * q.e3);
+  double s = v.Length();
+  if (s == 0)
+    return VNULL;
+  return v * (2 * std::atan2(s, sign * q.e0) / s);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChLinearizer::ChLinearizer()
+: m_pool(0),
+  m_horizon(0),
+  m_input_eps(1e-3),
+  m_central(true),
+  m_num_steps(0),
+  m_A(NUM_STATES * NUM_STATES, 0.0),
+  m_B(NUM_STATES * NUM_INPUTS, 0.0),
+  m_horizon_used(0),
+  m_wall_time(0)
+{
+  std::fill(m_state_eps, m_state_eps + 4, 1e-4);
+  std::fill(m_x0, m_x0 + NUM_STATES, 0.0);
+  std::fill(m_x1, m_x1 + NUM_STATES, 0.0);
+  std::fill(m_u0, m_u0 + NUM_INPUTS, 0.0);
+}
+
+ChLinearizer::~ChLinearizer()
+{
+  delete m_pool;
+  for (size_t i = 0; i < m_tasks.size(); i++)
+    delete m_tasks[i];
+}
+
+void ChLinearizer::SetStatePerturbations(double pos, double rot, double vel, double omega)
+{
+  m_state_eps[0] = pos;
+  m_state_eps[1] = rot;
+  m_state_eps[2] = vel;
+  m_state_eps[3] = omega;
+}
+
+// -----------------------------------------------------------------------------
+// The operating point (the chassis orientation, the initial state and the
+// driver inputs at the first step) is taken with the first clone, in the
+// calling thread; all evaluations, including the nominal one, then run with
+// the inputs held at u0.
+// -----------------------------------------------------------------------------
+bool ChLinearizer::Linearize(const ChVehicleState& snapshot)
+{
+  double start = ChProfiler::GetTime();
+
+  if (m_sims.empty()) {
+    GetLog() << "ERROR: ChLinearizer: no simulation\n";
+    return false;
+  }
+
+  for (size_t i = 0; i < m_sims.size(); i++) {
+    if (m_sims[i]->IsKinematic()) {
+      GetLog() << "ERROR: ChLinearizer: the kinematic model cannot be linearized\n";
+      return false;
+    }
+    m_sims[i]->ReleaseInputs();
+  }
+
+  m_snapshots.assign(m_sims.size(), snapshot);
+
+  ChVehicleSimulation* sim = m_sims[0];
+  m_snapshots[0].Rewind();
+  if (!sim->RestoreState(m_snapshots[0])) {
+    GetLog() << "ERROR: ChLinearizer: the snapshot cannot be restored\n";
+    return false;
+  }
+
+  m_rot0 = sim->GetVehicle()->GetChassisBody()->GetRot();
+  measure(sim, m_x0);
+
+  sim->DoStep();
+  m_u0[0] = sim->GetSteering();
+  m_u0[1] = sim->GetThrottle();
+  m_u0[2] = sim->GetBraking();
+
+  double step = sim->GetStepSize();
+  double horizon = (m_horizon > 0) ? m_horizon : sim->GetModuleStep(ChVehicleSimulation::DRIVER);
+  m_num_steps = std::max((int)(horizon / step + 0.5), 1);
+  m_horizon_used = m_num_steps * step;
+
+  // List the evaluations: the nominal one, then the perturbations of each
+  // state and input.
+  m_evals.clear();
+  Evaluation eval = { -1, -1, 0 };
+  m_evals.push_back(eval);
+
+  for (int j = 0; j < NUM_STATES; j++) {
+    eval.state = j;
+    eval.delta = m_state_eps[j / 3];
+    m_evals.push_back(eval);
+    if (m_central) {
+      eval.delta = -eval.delta;
+      m_evals.push_back(eval);
+    }
+  }
+
+  eval.state = -1;
+  for (int j = 0; j < NUM_INPUTS; j++) {
+    bool plus = (m_u0[j] + m_input_eps <= INPUT_MAX[j]);
+    bool minus = (m_u0[j] - m_input_eps >= INPUT_MIN[j]);
+    eval.input = j;
+    eval.delta = plus ? m_input_eps : -m_input_eps;
+    m_evals.push_back(eval);
+    if (m_central && plus && minus) {
+      eval.delta = -m_input_eps;
+      m_evals.push_back(eval);
+    }
+  }
+
+  // Run the evaluations.
+  int num_evals = (int)m_evals.size();
+  m_outputs.assign(num_evals * NUM_STATES, 0.0);
+  m_status.assign(num_evals, 0);
+
+  if (!m_pool || m_pool->GetNumThreads() != (int)m_sims.size()) {
+    delete m_pool;
+    m_pool = new ChThreadPool((int)m_sims.size());
+  }
+  for (int i = (int)m_tasks.size(); i < num_evals; i++)
+    m_tasks.push_back(new ChLinearizerTask(this, i));
+
+  for (int i = 0; i < num_evals; i++)
+    m_pool->Submit(m_tasks[i]);
+  m_pool->Wait();
+
+  for (size_t i = 0; i < m_sims.size(); i++)
+    m_sims[i]->ReleaseInputs();
+
+  for (int i = 0; i < num_evals; i++) {
+    if (!m_status[i]) {
+      GetLog() << "ERROR: ChLinearizer: the snapshot cannot be restored\n";
+      return false;
+    }
+  }
+
+  // Assemble the columns: a central difference of two perturbations, or a
+  // one-sided difference from the nominal evaluation.
+  const double* y0 = &m_outputs[0];
+  std::copy(y0, y0 + NUM_STATES, m_x1);
+
+  for (int col = 0; col < NUM_STATES + NUM_INPUTS; col++) {
+    int first = -1;
+    int second = -1;
+    for (int i = 1; i < num_evals; i++) {
+      int c = (m_evals[i].state >= 0) ? m_evals[i].state : NUM_STATES + m_evals[i].input;
+      if (c != col)
+        continue;
+      if (first < 0)
+        first = i;
+      else
+        second = i;
+    }
+
+    const double* ya = &m_outputs[first * NUM_STATES];
+    const double* yb = (second >= 0) ? &m_outputs[second * NUM_STATES] : y0;
+    double dx = m_evals[first].delta - ((second >= 0) ? m_evals[second].delta : 0);
+
+    for (int row = 0; row < NUM_STATES; row++) {
+      double d = (ya[row] - yb[row]) / dx;
+      if (col < NUM_STATES)
+        m_A[row * NUM_STATES + col] = d;
+      else
+        m_B[row * NUM_INPUTS + col - NUM_STATES] = d;
+    }
+  }
+
+  m_wall_time = ChProfiler::GetTime() - start;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChLinearizer::evaluate(int worker, int index)
+{
+  ChVehicleSimulation* sim = m_sims[worker];
+  ChVehicleState& snapshot = m_snapshots[worker];
+
+  snapshot.Rewind();
+  if (!sim->RestoreState(snapshot))
+    return;
+
+  const Evaluation& eval = m_evals[index];
+
+  double u[NUM_INPUTS];
+  std::copy(m_u0, m_u0 + NUM_INPUTS, u);
+  if (eval.input >= 0)
+    u[eval.input] += eval.delta;
+  sim->OverrideInputs(u[0], u[1], u[2]);
+
+  if (eval.state >= 0) {
+    ChVector<> d[4];
+    int k = eval.state % 3;
+    d[eval.state / 3] = ChVector<>(k == 0 ? eval.delta : 0, k == 1 ? eval.delta : 0, k == 2 ? eval.delta : 0);
+    sim->GetVehicle()->Perturb(d[0], d[1], d[2], d[3]);
+  }
+
+  for (int i = 0; i < m_num_steps; i++)
+    sim->DoStep();
+
+  measure(sim, &m_outputs[index * NUM_STATES]);
+  m_status[index] = 1;
+}
+
+void ChLinearizer::measure(ChVehicleSimulation* sim, double* x) const
+{
+  ChBodyAuxRef* chassis = sim->GetVehicle()->GetChassisBody();
+
+  ChVector<> pos = chassis->GetPos();
+  ChVector<> rot = RotationVector(chassis->GetRot() * m_rot0.GetConjugate());
+  ChVector<> vel = chassis->GetPos_dt();
+  ChVector<> omega = chassis->GetWvel_par();
+
+  ChVector<> v[4] = { pos, rot, vel, omega };
+  for (int i = 0; i < 4; i++) {
+    x[3 * i + 0] = v[i].x;
+    x[3 * i + 1] = v[i].y;
+    x[3 * i + 2] = v[i].z;
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
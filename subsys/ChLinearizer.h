@@ -0,0 +1,191 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Finite-difference linearization of the vehicle dynamics about an operating
+// point, given by a snapshot of a vehicle simulation (see
+// ChVehicleSimulation::SaveState()).
+//
+// The state of the linear model is the rigid-body state of the chassis, in the
+// global frame:
+//    x = [ COM position (3), rotation vector (3), COM velocity (3),
+//          angular velocity (3) ]
+// (the rotation vector is relative to the chassis orientation at the operating
+// point) and its inputs are the driver inputs
+//    u = [ steering, throttle, braking ]
+// The model is the discrete-time map over a horizon h (a number of base steps)
+//    x(t+h) - x0(t+h) = A (x(t) - x0(t)) + B (u - u0)
+// where x0 is the trajectory from the snapshot. A continuous-time model can be
+// approximated with (A - I) / h and B / h.
+//
+// Each column of A and B is obtained by restoring the snapshot, perturbing one
+// state or input, and simulating over the horizon; with central differences,
+// each column takes two such evaluations (a one-sided difference is used for
+// an input at a bound of its range). A state is perturbed by superposing a
+// rigid-body motion on all the bodies of the vehicle (see ChVehicle::Perturb()),
+// so that the joints remain consistent and the internal states (suspension
+// travel, wheel spin, powertrain, tires, driver) are held at the operating
+// point. The model is open-loop: in all evaluations, the driver inputs are
+// held at (or perturbed from) u0, their values at the first step from the
+// snapshot (see ChVehicleSimulation::OverrideInputs()), so that the driver
+// does not react to the state perturbations.
+//
+// The evaluations run concurrently, each worker thread using its own clone of
+// the simulation, constructed identically (same models and step sizes) to the
+// one the snapshot was taken from: the systems are only restored from the
+// snapshot, never rebuilt. The clones must not use the kinematic bicycle model
+// and must not share a replay log or an event recorder. Since the solver warm
+// start is not part of the snapshot, the differences are most accurate with a
+// converged solver (or a direct one).
+//
+// The snapshot should be taken at a step at which all modules are due (e.g.
+// at a multiple of the largest module step), so that the perturbed inputs are
+// sampled at the first step of the horizon.
+//
+// =============================================================================
+
+#ifndef CH_LINEARIZER_H
+#define CH_LINEARIZER_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChThreadPool.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChLinearizerTask;
+
+///
+/// Finite-difference linearization of a vehicle simulation.
+///
+class CH_SUBSYS_API ChLinearizer
+{
+public:
+
+  enum {
+    NUM_STATES = 12,   ///< chassis position, rotation, velocity and angular velocity
+    NUM_INPUTS = 3     ///< steering, throttle and braking
+  };
+
+  ChLinearizer();
+
+  ~ChLinearizer();
+
+  /// Add a clone of the simulation. Each clone is used by one worker thread;
+  /// the clones are not owned and must outlive the linearizer.
+  void AddSimulation(ChVehicleSimulation* sim) { m_sims.push_back(sim); }
+
+  /// Get the number of clones (and worker threads).
+  int GetNumSimulations() const { return (int)m_sims.size(); }
+
+  /// Set the horizon of the linear model, rounded to a multiple of the base
+  /// step (default: zero, i.e. the driver step of the clones).
+  void SetHorizon(double horizon) { m_horizon = horizon; }
+
+  /// Set the perturbations of the positions (m), rotations (rad), velocities
+  /// (m/s) and angular velocities (rad/s) (default: 1e-4 for all).
+  void SetStatePerturbations(double pos, double rot, double vel, double omega);
+
+  /// Set the perturbation of the driver inputs (default: 1e-3).
+  void SetInputPerturbation(double du) { m_input_eps = du; }
+
+  /// Enable or disable central differences (default: enabled). With forward
+  /// differences, each column takes a single evaluation.
+  void SetCentralDifferences(bool val) { m_central = val; }
+
+  /// Linearize the dynamics about the operating point given by the specified
+  /// snapshot. Returns false if there are no clones, a clone uses the
+  /// kinematic model, or the snapshot cannot be restored into a clone.
+  bool Linearize(const ChVehicleState& snapshot);
+
+  /// Get the elements of the (discrete-time) state and input matrices of the
+  /// last linearization.
+  double GetA(int i, int j) const { return m_A[i * NUM_STATES + j]; }
+  double GetB(int i, int j) const { return m_B[i * NUM_INPUTS + j]; }
+
+  /// Get the state and input matrices of the last linearization, row-major.
+  const std::vector<double>& GetA() const { return m_A; }
+  const std::vector<double>& GetB() const { return m_B; }
+
+  /// Get the operating point of the last linearization: the state at the
+  /// snapshot and at the end of the horizon, and the driver inputs.
+  double GetState(int i) const { return m_x0[i]; }
+  double GetNextState(int i) const { return m_x1[i]; }
+  double GetInput(int i) const { return m_u0[i]; }
+
+  /// Get the horizon of the last linearization.
+  double GetHorizonUsed() const { return m_horizon_used; }
+
+  /// Get the number of simulation evaluations of the last linearization.
+  int GetNumEvaluations() const { return (int)m_evals.size(); }
+
+  /// Get the wall clock time of the last linearization.
+  double GetWallTime() const { return m_wall_time; }
+
+private:
+
+  // One evaluation: a perturbation of a state or input (-1: none).
+  struct Evaluation {
+    int     state;
+    int     input;
+    double  delta;
+  };
+
+  ChLinearizer(const ChLinearizer&);
+  ChLinearizer& operator=(const ChLinearizer&);
+
+  // Run the specified evaluation on the clone of the specified worker.
+  void evaluate(int worker, int index);
+
+  // Measure the state of the specified clone, relative to the chassis
+  // orientation at the operating point.
+  void measure(ChVehicleSimulation* sim, double* x) const;
+
+  friend class ChLinearizerTask;
+
+  std::vector<ChVehicleSimulation*>  m_sims;
+  std::vector<ChVehicleState>        m_snapshots;   // one copy per clone
+  std::vector<int>                   m_status;      // per evaluation (0: snapshot not restored)
+  ChThreadPool*                      m_pool;
+  std::vector<ChLinearizerTask*>     m_tasks;
+
+  double               m_horizon;
+  double               m_state_eps[4];
+  double               m_input_eps;
+  bool                 m_central;
+
+  int                  m_num_steps;
+  ChQuaternion<>       m_rot0;       // chassis orientation at the operating point
+  std::vector<Evaluation>  m_evals;
+  std::vector<double>  m_outputs;    // state at the end of the horizon, per evaluation
+
+  std::vector<double>  m_A;
+  std::vector<double>  m_B;
+  double               m_x0[NUM_STATES];
+  double               m_x1[NUM_STATES];
+  double               m_u0[NUM_INPUTS];
+  double               m_horizon_used;
+  double               m_wall_time;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
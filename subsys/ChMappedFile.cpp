@@ -0,0 +1,214 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only memory mapping of a file (mmap or MapViewOfFile), and the helpers
+// used to publish a file written under a temporary name.
+//
+// =============================================================================
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+struct ChMappedFileImpl {
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#else
+  int    fd;
+#endif
+  void*  data;
+  size_t size;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChMappedFile::ChMappedFile()
+: m_impl(0),
+  m_data(0),
+  m_size(0)
+{
+}
+
+ChMappedFile::~ChMappedFile()
+{
+  Close();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChMappedFile::Open(const std::string& filename)
+{
+  Close();
+
+  ChMappedFileImpl* mf = new ChMappedFileImpl;
+  mf->data = 0;
+  mf->size = 0;
+
+#ifdef _WIN32
+  mf->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  LARGE_INTEGER size;
+  if (mf->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(mf->file, &size) || size.QuadPart == 0) {
+    if (mf->file != INVALID_HANDLE_VALUE)
+      CloseHandle(mf->file);
+    delete mf;
+    return false;
+  }
+  mf->mapping = CreateFileMappingA(mf->file, 0, PAGE_READONLY, 0, 0, 0);
+  if (mf->mapping)
+    mf->data = MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!mf->data) {
+    if (mf->mapping)
+      CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+    delete mf;
+    return false;
+  }
+  mf->size = (size_t)size.QuadPart;
+#else
+  mf->fd = open(filename.c_str(), O_RDONLY);
+  struct stat st;
+  if (mf->fd < 0 || fstat(mf->fd, &st) != 0 || st.st_size == 0) {
+    if (mf->fd >= 0)
+      close(mf->fd);
+    delete mf;
+    return false;
+  }
+  mf->size = (size_t)st.st_size;
+  mf->data = mmap(0, mf->size, PROT_READ, MAP_SHARED, mf->fd, 0);
+  if (mf->data == MAP_FAILED) {
+    close(mf->fd);
+    delete mf;
+    return false;
+  }
+#endif
+
+  m_impl = mf;
+  m_data = static_cast<const char*>(mf->data);
+  m_size = mf->size;
+
+  return true;
+}
+
+void ChMappedFile::Close()
+{
+  ChMappedFileImpl* mf = static_cast<ChMappedFileImpl*>(m_impl);
+  if (!mf)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(mf->data);
+  CloseHandle(mf->mapping);
+  CloseHandle(mf->file);
+#else
+  munmap(mf->data, mf->size);
+  close(mf->fd);
+#endif
+
+  delete mf;
+  m_impl = 0;
+  m_data = 0;
+  m_size = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMappedFile::ReleasePages(size_t offset, size_t bytes) const
+{
+#ifndef _WIN32
+  ChMappedFileImpl* mf = static_cast<ChMappedFileImpl*>(m_impl);
+  if (!mf)
+    return;
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t start = (offset + page - 1) / page * page;
+  size_t end = (offset + bytes) / page * page;
+  if (end > start)
+    madvise(static_cast<char*>(mf->data) + start, end - start, MADV_DONTNEED);
+#endif
+}
+
+void ChMappedFile::PrefetchPages(size_t offset, size_t bytes) const
+{
+#ifndef _WIN32
+  ChMappedFileImpl* mf = static_cast<ChMappedFileImpl*>(m_impl);
+  if (!mf || offset >= mf->size)
+    return;
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t start = offset / page * page;
+  size_t end = std::min(offset + bytes, mf->size);
+  if (end > start)
+    madvise(static_cast<char*>(mf->data) + start, end - start, MADV_WILLNEED);
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+std::string ChTempFileSuffix(const void* local)
+{
+#ifdef _WIN32
+  int pid = (int)GetCurrentProcessId();
+#else
+  int pid = (int)getpid();
+#endif
+
+  char suffix[64];
+  sprintf(suffix, ".%d.%p.%.0f", pid, local, ChProfiler::GetTime() * 1e9);
+
+  return suffix;
+}
+
+// -----------------------------------------------------------------------------
+// On POSIX systems, rename() replaces an existing file atomically. On Windows
+// it fails if the destination exists, and MoveFileEx() is used instead.
+// -----------------------------------------------------------------------------
+bool ChReplaceFile(const std::string& source, const std::string& dest)
+{
+#ifdef _WIN32
+  bool ok = MoveFileExA(source.c_str(), dest.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  bool ok = std::rename(source.c_str(), dest.c_str()) == 0;
+#endif
+
+  if (!ok)
+    std::remove(source.c_str());
+
+  return ok;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,96 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only memory mapping of a file (mmap or MapViewOfFile), and the helpers
+// used to publish a file written under a temporary name.
+//
+// =============================================================================
+
+#ifndef CH_MAPPED_FILE_H
+#define CH_MAPPED_FILE_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Read-only memory-mapped file.
+///
+class CH_SUBSYS_API ChMappedFile
+{
+public:
+
+  ChMappedFile();
+
+  /// Unmap the file (if mapped).
+  ~ChMappedFile();
+
+  /// Map the specified file. Returns false if the file cannot be opened or
+  /// mapped (empty files cannot be mapped).
+  bool Open(const std::string& filename);
+
+  /// Unmap the file.
+  void Close();
+
+  /// Return true if a file is mapped.
+  bool IsOpen() const { return m_data != 0; }
+
+  /// Get the start of the mapped file contents (NULL if no file is mapped).
+  const char* GetData() const { return m_data; }
+
+  /// Get the size of the mapped file, in bytes.
+  size_t GetSize() const { return m_size; }
+
+  /// Let the operating system drop the pages of the specified range of the
+  /// mapping (on Windows, unused pages of a read-only view are trimmed by the
+  /// OS and this function does nothing).
+  void ReleasePages(size_t offset, size_t bytes) const;
+
+  /// Ask the operating system to read the pages of the specified range of the
+  /// mapping ahead of their use, without waiting for the reads (on Windows,
+  /// this function does nothing).
+  void PrefetchPages(size_t offset, size_t bytes) const;
+
+private:
+
+  ChMappedFile(const ChMappedFile&);
+  ChMappedFile& operator=(const ChMappedFile&);
+
+  void*        m_impl;
+  const char*  m_data;
+  size_t       m_size;
+};
+
+/// Get a suffix for the name of a temporary file, unique per node, process and
+/// thread: the host clock, the process ID and the specified address of a local
+/// variable of the caller.
+CH_SUBSYS_API std::string ChTempFileSuffix(const void* local);
+
+/// Replace the destination file with the source file (typically written under
+/// a temporary name next to it). The destination is kept until the source is in
+/// place, so that it is never missing, even if the process is stopped during
+/// the replacement. If the replacement fails, the source file is removed and
+/// false is returned.
+CH_SUBSYS_API bool ChReplaceFile(const std::string& source, const std::string& dest);
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,164 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Breakdown of the memory used by the modules of a simulation.
+//
+// =============================================================================
+
+#include <cstdio>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMemoryReport::Add(const std::string& category, size_t bytes, size_t count)
+{
+  Entry& entry = m_entries[category];
+  entry.bytes += bytes;
+  entry.count += count;
+}
+
+void ChMemoryReport::AddShared(const std::string& category, const void* object, size_t bytes)
+{
+  if (!object || m_shared.find(object) != m_shared.end())
+    return;
+
+  SharedEntry& entry = m_shared[object];
+  entry.category = category;
+  entry.bytes = bytes;
+}
+
+void ChMemoryReport::Merge(const ChMemoryReport& other)
+{
+  for (EntryMap::const_iterator it = other.m_entries.begin(); it != other.m_entries.end(); ++it)
+    Add(it->first, it->second.bytes, it->second.count);
+
+  for (SharedMap::const_iterator it = other.m_shared.begin(); it != other.m_shared.end(); ++it)
+    AddShared(it->second.category, it->first, it->second.bytes);
+}
+
+void ChMemoryReport::Clear()
+{
+  m_entries.clear();
+  m_shared.clear();
+}
+
+void ChMemoryReport::collect(EntryMap& entries) const
+{
+  entries = m_entries;
+  for (SharedMap::const_iterator it = m_shared.begin(); it != m_shared.end(); ++it) {
+    Entry& entry = entries[it->second.category];
+    entry.bytes += it->second.bytes;
+    entry.count++;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+size_t ChMemoryReport::GetBytes(const std::string& category) const
+{
+  EntryMap entries;
+  collect(entries);
+
+  std::string group = category + "/";
+  size_t bytes = 0;
+  for (EntryMap::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+    if (it->first == category || it->first.compare(0, group.size(), group) == 0)
+      bytes += it->second.bytes;
+  }
+
+  return bytes;
+}
+
+size_t ChMemoryReport::GetTotal() const
+{
+  size_t bytes = 0;
+  for (EntryMap::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    bytes += it->second.bytes;
+  for (SharedMap::const_iterator it = m_shared.begin(); it != m_shared.end(); ++it)
+    bytes += it->second.bytes;
+
+  return bytes;
+}
+
+// -----------------------------------------------------------------------------
+// The categories are sorted by name, so that those of a group are adjacent.
+// -----------------------------------------------------------------------------
+void ChMemoryReport::Print() const
+{
+  EntryMap entries;
+  collect(entries);
+
+  double total = (double)GetTotal();
+
+  char line[256];
+  sprintf(line, "%-40s %10s %14s %8s\n", "category", "count", "size [KB]", "%");
+  GetLog() << line;
+
+  std::string group;
+  for (EntryMap::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+    std::string name = it->first;
+    size_t slash = name.find('/');
+
+    if (slash != std::string::npos) {
+      if (name.compare(0, slash, group) != 0 || group.empty()) {
+        group = name.substr(0, slash);
+        size_t bytes = GetBytes(group);
+        sprintf(line, "%-40s %10s %14.1f %8.1f\n", group.c_str(), "", bytes / 1024.0,
+                total > 0 ? 100 * bytes / total : 0.0);
+        GetLog() << line;
+      }
+      name = "  " + name.substr(slash + 1);
+    } else {
+      group.clear();
+    }
+
+    sprintf(line, "%-40s %10lu %14.1f %8.1f\n", name.c_str(), (unsigned long)it->second.count,
+            it->second.bytes / 1024.0, total > 0 ? 100 * it->second.bytes / total : 0.0);
+    GetLog() << line;
+  }
+
+  sprintf(line, "%-40s %10s %14.1f\n", "(total)", "", total / 1024.0);
+  GetLog() << line;
+}
+
+bool ChMemoryReport::WriteCSV(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp)
+    return false;
+
+  EntryMap entries;
+  collect(entries);
+
+  fprintf(fp, "category,count,bytes\n");
+  for (EntryMap::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    fprintf(fp, "\"%s\",%lu,%lu\n", it->first.c_str(), (unsigned long)it->second.count,
+            (unsigned long)it->second.bytes);
+
+  fclose(fp);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,125 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Breakdown of the memory used by the modules of a simulation.
+//
+// The modules (vehicles, tires, terrains, output writers, caches) add an
+// estimate of their memory footprint to a report, by category ("tire/contact
+// buffers", "shared/meshes", ...; the part before the first '/' is the group
+// of the category). The estimates are the sizes of the objects and of the
+// heap blocks they own (vector capacities, not sizes); the bookkeeping of the
+// heap allocator is not included. Data shared by several modules (meshes,
+// tire parameter blocks) is added with AddShared() and counted once per
+// report, whatever the number of modules using it.
+//
+// A report can accumulate all vehicles of a fleet, or be merged from the
+// reports of several simulations, to size the runs of a node.
+//
+// =============================================================================
+
+#ifndef CH_MEMORY_REPORT_H
+#define CH_MEMORY_REPORT_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Memory footprint of a set of modules, by category.
+///
+class CH_SUBSYS_API ChMemoryReport
+{
+public:
+
+  ChMemoryReport() {}
+
+  /// Add objects of the specified category.
+  void Add(
+    const std::string&  category,   ///< [in] category ("group/name")
+    size_t              bytes,      ///< [in] total size of the objects
+    size_t              count = 1   ///< [in] number of objects
+    );
+
+  /// Add an object shared by several modules; an object already in this
+  /// report is ignored.
+  void AddShared(
+    const std::string&  category,   ///< [in] category ("group/name")
+    const void*         object,     ///< [in] identity of the shared object
+    size_t              bytes       ///< [in] size of the object
+    );
+
+  /// Add the entries of another report (shared objects in both reports are
+  /// counted once).
+  void Merge(const ChMemoryReport& other);
+
+  /// Remove all entries.
+  void Clear();
+
+  /// Return the total size of the specified category, or of all categories
+  /// of the specified group.
+  size_t GetBytes(const std::string& category) const;
+
+  /// Return the total size of all categories.
+  size_t GetTotal() const;
+
+  /// Print the categories, by group, with their sizes and object counts.
+  void Print() const;
+
+  /// Write the categories as CSV (category, count, bytes). Returns false if
+  /// the file cannot be opened.
+  bool WriteCSV(const std::string& filename) const;
+
+  /// Heap memory owned by a vector.
+  template <typename T>
+  static size_t VectorBytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+
+  /// Heap memory owned by a string.
+  static size_t StringBytes(const std::string& s) { return s.capacity() + 1; }
+
+private:
+
+  struct Entry {
+    Entry() : bytes(0), count(0) {}
+    size_t  bytes;
+    size_t  count;
+  };
+
+  struct SharedEntry {
+    std::string  category;
+    size_t       bytes;
+  };
+
+  typedef std::map<std::string, Entry>        EntryMap;
+  typedef std::map<const void*, SharedEntry>  SharedMap;
+
+  // All entries, with the shared objects added to their categories.
+  void collect(EntryMap& entries) const;
+
+  EntryMap   m_entries;
+  SharedMap  m_shared;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
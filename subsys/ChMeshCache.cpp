@@ -0,0 +1,427 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of triangular mesh visualization assets.
+//
+// Binary mesh file layout (native byte order):
+//   magic "CHMESH1\0" (8 bytes)
+//   uint32 counts: vertices, normals, UVs, vertex/normal/UV index triplets
+//   vertices, normals, UVs (3 doubles each)
+//   vertex, normal, UV index triplets (3 int32 each)
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "core/ChLog.h"
+#include "assets/ChBoxShape.h"
+
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChSharedModelData.h"
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+typedef std::map<std::string, ChSharedPtr<ChTriangleMeshShape> > ChMeshShapeMap;
+
+struct ChMeshEntry {
+  geometry::ChTriangleMeshConnected*  mesh;
+  ChMeshShapeMap                      shapes;
+};
+
+typedef std::map<std::string, ChMeshEntry> ChMeshMap;
+
+struct ChLodEntry {
+  ChSharedPtr<ChAssetLevel>  levels[ChMeshCache::NUM_LOD_LEVELS];
+};
+
+typedef std::map<std::string, ChLodEntry> ChLodMap;
+
+static ChMutex                            s_mesh_mutex;
+static ChMeshMap                          s_mesh_entries;
+static ChLodMap                           s_lod_entries;
+static int                                s_num_loaded = 0;
+static geometry::ChTriangleMeshConnected  s_empty_mesh;
+
+static const char s_mesh_magic[8] = { 'C', 'H', 'M', 'E', 'S', 'H', '1', 0 };
+
+
+// -----------------------------------------------------------------------------
+// Binary mesh I/O
+// -----------------------------------------------------------------------------
+static std::string GetBakedFile(const std::string& filename)
+{
+  return filename + ".chmesh";
+}
+
+template <class T>
+static char* WriteArray(char* dst, const std::vector<ChVector<T> >& v)
+{
+  for (size_t i = 0; i < v.size(); i++) {
+    T data[3] = { v[i].x, v[i].y, v[i].z };
+    memcpy(dst, data, sizeof(data));
+    dst += sizeof(data);
+  }
+  return dst;
+}
+
+template <class T>
+static const char* ReadArray(const char* src, unsigned int n, std::vector<ChVector<T> >& v)
+{
+  v.resize(n);
+  for (unsigned int i = 0; i < n; i++) {
+    T data[3];
+    memcpy(data, src, sizeof(data));
+    v[i] = ChVector<T>(data[0], data[1], data[2]);
+    src += sizeof(data);
+  }
+  return src;
+}
+
+// Build the contents of the binary mesh file.
+static void BakeImage(const geometry::ChTriangleMeshConnected&  mesh,
+                      std::vector<char>&                        image)
+{
+  unsigned int counts[6] = { (unsigned int)mesh.m_vertices.size(),
+                             (unsigned int)mesh.m_normals.size(),
+                             (unsigned int)mesh.m_UV.size(),
+                             (unsigned int)mesh.m_face_v_indices.size(),
+                             (unsigned int)mesh.m_face_n_indices.size(),
+                             (unsigned int)mesh.m_face_u_indices.size() };
+
+  image.resize(sizeof(s_mesh_magic) + sizeof(counts)
+               + 3 * sizeof(double) * ((size_t)counts[0] + counts[1] + counts[2])
+               + 3 * sizeof(int) * ((size_t)counts[3] + counts[4] + counts[5]));
+
+  char* dst = &image[0];
+  memcpy(dst, s_mesh_magic, sizeof(s_mesh_magic));
+  dst += sizeof(s_mesh_magic);
+  memcpy(dst, counts, sizeof(counts));
+  dst += sizeof(counts);
+  dst = WriteArray(dst, mesh.m_vertices);
+  dst = WriteArray(dst, mesh.m_normals);
+  dst = WriteArray(dst, mesh.m_UV);
+  dst = WriteArray(dst, mesh.m_face_v_indices);
+  dst = WriteArray(dst, mesh.m_face_n_indices);
+  dst = WriteArray(dst, mesh.m_face_u_indices);
+}
+
+// Extract the mesh from the contents of a binary mesh file.
+static bool ParseBaked(const char*                         data,
+                       size_t                              bytes,
+                       geometry::ChTriangleMeshConnected&  mesh)
+{
+  size_t header_size = sizeof(s_mesh_magic) + 6 * sizeof(unsigned int);
+  if (bytes < header_size || memcmp(data, s_mesh_magic, sizeof(s_mesh_magic)) != 0)
+    return false;
+
+  unsigned int counts[6];
+  memcpy(counts, data + sizeof(s_mesh_magic), sizeof(counts));
+
+  size_t size = header_size
+              + 3 * sizeof(double) * ((size_t)counts[0] + counts[1] + counts[2])
+              + 3 * sizeof(int) * ((size_t)counts[3] + counts[4] + counts[5]);
+  if (bytes != size)
+    return false;
+
+  const char* src = data + header_size;
+  src = ReadArray(src, counts[0], mesh.m_vertices);
+  src = ReadArray(src, counts[1], mesh.m_normals);
+  src = ReadArray(src, counts[2], mesh.m_UV);
+  src = ReadArray(src, counts[3], mesh.m_face_v_indices);
+  src = ReadArray(src, counts[4], mesh.m_face_n_indices);
+  src = ReadArray(src, counts[5], mesh.m_face_u_indices);
+
+  return true;
+}
+
+static bool WriteBaked(const std::string&                        filename,
+                       const geometry::ChTriangleMeshConnected&  mesh)
+{
+  std::vector<char> image;
+  BakeImage(mesh, image);
+
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  bool ok = fwrite(&image[0], 1, image.size(), fp) == image.size();
+  if (fclose(fp) != 0)
+    ok = false;
+
+  return ok;
+}
+
+static bool ReadBaked(const std::string&                  filename,
+                      geometry::ChTriangleMeshConnected&  mesh)
+{
+  ChMappedFile file;
+  if (!file.Open(filename))
+    return false;
+
+  return ParseBaked(file.GetData(), file.GetSize(), mesh);
+}
+
+// -----------------------------------------------------------------------------
+// Load the mesh from the pre-baked file, if it is up to date, or else from the
+// OBJ file. Must be called with the cache mutex locked.
+// -----------------------------------------------------------------------------
+static ChMeshEntry* FindEntry(const std::string& filename)
+{
+  ChMeshMap::iterator it = s_mesh_entries.find(filename);
+  if (it != s_mesh_entries.end())
+    return &it->second;
+
+  CH_STARTUP_SCOPE("ChMeshCache::Load");
+
+  struct stat obj_info;
+  if (stat(filename.c_str(), &obj_info) != 0) {
+    GetLog() << "ERROR: cannot open mesh file " << filename.c_str() << "\n";
+    return 0;
+  }
+
+  geometry::ChTriangleMeshConnected* mesh = new geometry::ChTriangleMeshConnected;
+
+  // a mesh parsed by another process of the node (the key identifies the
+  // version of the OBJ file)
+  char stamp[64];
+  sprintf(stamp, "/%lld/%lld", (long long)obj_info.st_mtime, (long long)obj_info.st_size);
+  std::string key = "mesh/" + filename + stamp;
+  size_t image_size = 0;
+  const char* image = static_cast<const char*>(ChSharedModelData::Find(key, image_size));
+  bool shared = image && ParseBaked(image, image_size, *mesh);
+
+  std::string baked = GetBakedFile(filename);
+  struct stat baked_info;
+  bool loaded = shared;
+  if (!loaded && stat(baked.c_str(), &baked_info) == 0 && baked_info.st_mtime >= obj_info.st_mtime) {
+    loaded = ReadBaked(baked, *mesh);
+    if (!loaded) {
+      GetLog() << "WARNING: ignoring invalid mesh file " << baked.c_str() << "\n";
+      delete mesh;
+      mesh = new geometry::ChTriangleMeshConnected;
+    }
+  }
+
+  if (!loaded)
+    mesh->LoadWavefrontMesh(filename, false, false);
+
+  if (!shared && ChSharedModelData::GetRole() == ChSharedModelData::BUILDER) {
+    std::vector<char> baked_image;
+    BakeImage(*mesh, baked_image);
+    ChSharedModelData::Add(key, &baked_image[0], baked_image.size());
+  }
+
+  s_num_loaded++;
+
+  ChMeshEntry& entry = s_mesh_entries[filename];
+  entry.mesh = mesh;
+
+  return &entry;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const geometry::ChTriangleMeshConnected& ChMeshCache::GetMesh(const std::string& filename)
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  ChMeshEntry* entry = FindEntry(filename);
+
+  return entry ? *entry->mesh : s_empty_mesh;
+}
+
+ChSharedPtr<ChTriangleMeshShape> ChMeshCache::GetMeshShape(const std::string& filename,
+                                                           const std::string& name)
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  ChMeshEntry* entry = FindEntry(filename);
+  if (!entry)
+    return ChSharedPtr<ChTriangleMeshShape>(new ChTriangleMeshShape);
+
+  ChMeshShapeMap::iterator it = entry->shapes.find(name);
+  if (it != entry->shapes.end())
+    return it->second;
+
+  ChSharedPtr<ChTriangleMeshShape> shape(new ChTriangleMeshShape);
+  shape->SetMesh(*entry->mesh);
+  shape->SetName(name);
+  entry->shapes[name] = shape;
+
+  return shape;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChMeshCache::GetMeshBounds(const std::string& filename,
+                                ChVector<>&        min,
+                                ChVector<>&        max)
+{
+  const geometry::ChTriangleMeshConnected& mesh = GetMesh(filename);
+
+  if (mesh.m_vertices.empty())
+    return false;
+
+  min = mesh.m_vertices[0];
+  max = mesh.m_vertices[0];
+  for (size_t i = 1; i < mesh.m_vertices.size(); i++) {
+    const ChVector<>& v = mesh.m_vertices[i];
+    min = ChVector<>(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
+    max = ChVector<>(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+  }
+
+  return true;
+}
+
+ChSharedPtr<ChAssetLevel> ChMeshCache::GetLodAssets(const std::string& key,
+                                                    LodLevel           level)
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  ChLodMap::iterator it = s_lod_entries.find(key);
+  if (it == s_lod_entries.end())
+    return ChSharedPtr<ChAssetLevel>();
+
+  return it->second.levels[level];
+}
+
+ChSharedPtr<ChAssetLevel> ChMeshCache::AddLodAssets(const std::string&         key,
+                                                    LodLevel                   level,
+                                                    ChSharedPtr<ChAssetLevel>  assets)
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  ChSharedPtr<ChAssetLevel>& entry = s_lod_entries[key].levels[level];
+  if (entry.IsNull())
+    entry = assets;
+
+  return entry;
+}
+
+ChSharedPtr<ChAssetLevel> ChMeshCache::GetMeshLodAssets(const std::string& filename,
+                                                        const std::string& name,
+                                                        LodLevel           level)
+{
+  std::string key = filename + ":" + name;
+
+  ChSharedPtr<ChAssetLevel> assets = GetLodAssets(key, level);
+  if (!assets.IsNull())
+    return assets;
+
+  assets = ChSharedPtr<ChAssetLevel>(new ChAssetLevel);
+
+  if (level == LOD_MESH) {
+    assets->AddAsset(GetMeshShape(filename, name));
+  } else {
+    ChVector<> min, max;
+    if (GetMeshBounds(filename, min, max)) {
+      ChSharedPtr<ChBoxShape> box(new ChBoxShape);
+      box->GetBoxGeometry().SetLengths(max - min);
+      box->Pos = 0.5 * (min + max);
+      assets->AddAsset(box);
+    }
+  }
+
+  return AddLodAssets(key, level, assets);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChMeshCache::Bake(const std::string& filename)
+{
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) {
+    GetLog() << "ERROR: cannot open mesh file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  geometry::ChTriangleMeshConnected mesh;
+  mesh.LoadWavefrontMesh(filename, false, false);
+
+  std::string baked = GetBakedFile(filename);
+  if (!WriteBaked(baked, mesh)) {
+    GetLog() << "ERROR: cannot write mesh file " << baked.c_str() << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMeshCache::Clear()
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  for (ChMeshMap::iterator it = s_mesh_entries.begin(); it != s_mesh_entries.end(); ++it)
+    delete it->second.mesh;
+
+  s_mesh_entries.clear();
+  s_lod_entries.clear();
+}
+
+int ChMeshCache::GetNumMeshes()
+{
+  ChScopedLock lock(s_mesh_mutex);
+  return (int)s_mesh_entries.size();
+}
+
+int ChMeshCache::GetNumLoaded()
+{
+  ChScopedLock lock(s_mesh_mutex);
+  return s_num_loaded;
+}
+
+// -----------------------------------------------------------------------------
+// Each named shape holds a copy of its mesh.
+// -----------------------------------------------------------------------------
+static size_t MeshBytes(const geometry::ChTriangleMeshConnected& mesh)
+{
+  return ChMemoryReport::VectorBytes(mesh.m_vertices) +
+         ChMemoryReport::VectorBytes(mesh.m_normals) +
+         ChMemoryReport::VectorBytes(mesh.m_UV) +
+         ChMemoryReport::VectorBytes(mesh.m_face_v_indices) +
+         ChMemoryReport::VectorBytes(mesh.m_face_n_indices) +
+         ChMemoryReport::VectorBytes(mesh.m_face_u_indices);
+}
+
+void ChMeshCache::AddMemoryFootprint(ChMemoryReport& report)
+{
+  ChScopedLock lock(s_mesh_mutex);
+
+  for (ChMeshMap::const_iterator it = s_mesh_entries.begin(); it != s_mesh_entries.end(); ++it) {
+    const geometry::ChTriangleMeshConnected* mesh = it->second.mesh;
+    size_t bytes = MeshBytes(*mesh);
+    report.AddShared("shared/meshes", mesh, sizeof(*mesh) + bytes);
+
+    const ChMeshShapeMap& shapes = it->second.shapes;
+    for (ChMeshShapeMap::const_iterator is = shapes.begin(); is != shapes.end(); ++is)
+      report.AddShared("shared/mesh shapes", is->second.get_ptr(), sizeof(ChTriangleMeshShape) + bytes);
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,146 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of triangular mesh visualization assets.
+//
+// A Wavefront OBJ file is parsed only the first time it is requested. If a
+// pre-baked binary version of the mesh (the OBJ file name with the extension
+// ".chmesh" appended, see Bake()) exists and is not older than the OBJ file,
+// it is read instead of parsing the OBJ file. If the shared model data
+// segment of the node is open (see ChSharedModelData), a mesh already loaded
+// by another process is copied from the segment instead, and the builder of
+// the segment adds the meshes it loads.
+//
+// For each (mesh file, asset name) pair, the cache creates a single
+// ChTriangleMeshShape asset, which is then shared by all bodies that use it
+// (e.g. all wheels of all vehicles). Since the asset is positioned relative to
+// the body it is attached to, the shared asset must not be modified.
+//
+// The cache also holds the shared level-of-detail variants of a visualization
+// (e.g. mesh, primitives and impostor of a vehicle chassis), each grouped in a
+// ChAssetLevel. A body using them carries all variants, as its last asset
+// groups and in LodLevel order; the renderer toggles their visibility (see
+// ChIrrVehicleLOD) without re-creating any asset.
+//
+// =============================================================================
+
+#ifndef CH_MESH_CACHE_H
+#define CH_MESH_CACHE_H
+
+#include <string>
+
+#include "core/ChSmartpointers.h"
+#include "assets/ChTriangleMeshShape.h"
+#include "assets/ChAssetLevel.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of triangular meshes and mesh visualization assets.
+///
+class CH_SUBSYS_API ChMeshCache
+{
+public:
+
+  /// Get the mesh loaded from the specified OBJ file (or from its pre-baked
+  /// binary version). If the file cannot be read, an error is reported and an
+  /// empty mesh is returned. The mesh remains valid until Clear() is called.
+  static const geometry::ChTriangleMeshConnected& GetMesh(const std::string& filename);
+
+  /// Get the shared visualization asset with the specified name for the mesh
+  /// loaded from the specified OBJ file. The returned asset must not be
+  /// modified.
+  static ChSharedPtr<ChTriangleMeshShape> GetMeshShape(
+    const std::string& filename,   ///< [in] name of the OBJ file
+    const std::string& name        ///< [in] name of the visualization asset
+    );
+
+  /// Levels of detail of a visualization, from the finest to the coarsest.
+  enum LodLevel {
+    LOD_MESH,          ///< full triangular mesh
+    LOD_PRIMITIVES,    ///< primitive shapes (boxes, cylinders)
+    LOD_IMPOSTOR       ///< a single shape for a complete vehicle (or nothing)
+  };
+
+  /// Number of levels of detail.
+  static const int NUM_LOD_LEVELS = 3;
+
+  /// Get the bounding box of the mesh loaded from the specified OBJ file.
+  /// Returns false if the mesh is empty.
+  static bool GetMeshBounds(
+    const std::string& filename,   ///< [in] name of the OBJ file
+    ChVector<>&        min,        ///< [out] minimum vertex coordinates
+    ChVector<>&        max         ///< [out] maximum vertex coordinates
+    );
+
+  /// Get the shared asset group registered with the specified key and level
+  /// of detail. Returns an empty pointer if no group was registered.
+  static ChSharedPtr<ChAssetLevel> GetLodAssets(
+    const std::string& key,        ///< [in] name of the visualization (e.g. the mesh file)
+    LodLevel           level       ///< [in] level of detail
+    );
+
+  /// Register the shared asset group for the specified key and level of
+  /// detail, and return it. If a group was already registered (e.g. by another
+  /// thread), that group is returned instead and the specified one is dropped.
+  static ChSharedPtr<ChAssetLevel> AddLodAssets(
+    const std::string&         key,      ///< [in] name of the visualization (e.g. the mesh file)
+    LodLevel                   level,    ///< [in] level of detail
+    ChSharedPtr<ChAssetLevel>  assets    ///< [in] asset group for this level
+    );
+
+  /// Get the shared asset group for the specified level of detail of the mesh
+  /// visualization with the specified name: the mesh asset (LOD_MESH) or the
+  /// bounding box of the mesh (LOD_PRIMITIVES and LOD_IMPOSTOR). The groups
+  /// are registered under the key "filename:name".
+  static ChSharedPtr<ChAssetLevel> GetMeshLodAssets(
+    const std::string& filename,   ///< [in] name of the OBJ file
+    const std::string& name,       ///< [in] name of the mesh visualization asset
+    LodLevel           level       ///< [in] level of detail
+    );
+
+  /// Parse the specified OBJ file and write the mesh in binary form to the
+  /// file with the name of the OBJ file and the extension ".chmesh" appended.
+  /// Returns false if the OBJ file cannot be read or the output file cannot be
+  /// written.
+  static bool Bake(const std::string& filename);
+
+  /// Release all cached meshes, assets and level-of-detail groups. Assets already attached to bodies
+  /// remain valid.
+  static void Clear();
+
+  /// Return the number of cached meshes.
+  static int GetNumMeshes();
+
+  /// Return the number of times a mesh file (OBJ or binary) was read.
+  static int GetNumLoaded();
+
+  /// Add the cached meshes (vertex, normal, texture coordinate and index
+  /// arrays) and mesh shapes, each holding a copy of its mesh, to the
+  /// specified report, as shared objects ("shared/meshes", "shared/mesh
+  /// shapes").
+  static void AddMemoryFootprint(ChMemoryReport& report);
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,398 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Buffered output channel for rows of a fixed set of double columns.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChOutputChannel.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+static const char OUTPUT_MAGIC[8] = {'C', 'H', 'O', 'U', 'T', '1', 0, 0};
+
+typedef unsigned int uint32;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChOutputChannel::ChOutputChannel(int buffer_rows)
+: m_format(CSV),
+  m_num_columns(0),
+  m_capacity(buffer_rows > 2 ? buffer_rows : 2),
+  m_chunk(m_capacity / 2),
+  m_head(0),
+  m_tail(0),
+  m_max_gap(0),
+  m_writer(this),
+  m_flush(false),
+  m_stop(false)
+{
+}
+
+ChOutputChannel::~ChOutputChannel()
+{
+  Close();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChOutputChannel::Open(const std::string&      filename,
+                           const std::string&      header,
+                           Format                  format,
+                           ChCompressedFile::Codec codec,
+                           int                     level)
+{
+  Close();
+
+  int count = 1;
+  for (size_t k = 0; k < header.size(); k++) {
+    if (header[k] == ',')
+      count++;
+  }
+
+  if (!m_tolerances.empty() && (int)m_tolerances.size() != count) {
+    GetLog() << "ERROR: " << (int)m_tolerances.size() << " sampling tolerances for "
+             << count << " columns in " << filename.c_str() << "\n";
+    return false;
+  }
+
+  if (!m_file.OpenWrite(filename, codec, level, format == CSV))
+    return false;
+
+  m_format = format;
+  m_num_columns = count;
+  if (!m_tolerances.empty())
+    m_sampler.Initialize(m_tolerances, m_max_gap);
+
+  if (m_format == BINARY) {
+    uint32 num_columns = m_num_columns;
+    uint32 header_length = (uint32)header.size();
+    m_file.Write(OUTPUT_MAGIC, sizeof(OUTPUT_MAGIC));
+    m_file.Write(&num_columns, sizeof(uint32));
+    m_file.Write(&header_length, sizeof(uint32));
+    m_file.Write(header);
+    m_block.resize(m_chunk * m_num_columns);
+  }
+  else if (m_format == ARROW) {
+    if (!m_arrow.Open(&m_file, ChArrowWriter::SplitHeader(header))) {
+      m_file.Close();
+      return false;
+    }
+    m_block.resize(m_chunk * m_num_columns);
+  }
+  else {
+    m_file.Write(header + "\n");
+  }
+
+  m_ring.resize(m_capacity * m_num_columns);
+  m_head = 0;
+  m_tail = 0;
+  m_flush = false;
+  m_stop = false;
+
+  if (!m_writer.Start()) {
+    GetLog() << "ERROR: cannot start the writer thread for " << filename.c_str() << "\n";
+    m_file.Close();
+    return false;
+  }
+
+  return true;
+}
+
+void ChOutputChannel::SetAdaptiveSampling(const std::vector<double>& tolerances,
+                                          double                     max_gap)
+{
+  m_tolerances = tolerances;
+  m_max_gap = max_gap;
+}
+
+void ChOutputChannel::Close()
+{
+  if (!m_file.IsOpen())
+    return;
+
+  if (!m_tolerances.empty() && m_sampler.Finish() > 0)
+    append(m_sampler.GetRow(0));
+
+  m_mutex.Lock();
+  m_stop = true;
+  m_data_cond.Signal();
+  m_mutex.Unlock();
+
+  m_writer.Join();
+
+  if (m_format == ARROW)
+    m_arrow.Finish();
+
+  m_file.Close();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChOutputChannel::Write(const double* values)
+{
+  if (!m_file.IsOpen())
+    return;
+
+  if (m_tolerances.empty()) {
+    append(values);
+    return;
+  }
+
+  int num_rows = m_sampler.Sample(values);
+  for (int i = 0; i < num_rows; i++)
+    append(m_sampler.GetRow(i));
+}
+
+void ChOutputChannel::append(const double* values)
+{
+  m_mutex.Lock();
+  while (m_head - m_tail == m_capacity)
+    m_space_cond.Wait(m_mutex);
+  size_t slot = m_head % m_capacity;
+  m_mutex.Unlock();
+
+  // The free slot belongs to this thread until m_head is incremented.
+  memcpy(&m_ring[slot * m_num_columns], values, m_num_columns * sizeof(double));
+
+  m_mutex.Lock();
+  m_head++;
+  if (m_head - m_tail >= m_chunk)
+    m_data_cond.Signal();
+  m_mutex.Unlock();
+}
+
+void ChOutputChannel::Flush()
+{
+  if (!m_file.IsOpen())
+    return;
+
+  m_mutex.Lock();
+  m_flush = true;
+  m_data_cond.Signal();
+  while (m_flush)
+    m_space_cond.Wait(m_mutex);
+  m_mutex.Unlock();
+}
+
+// -----------------------------------------------------------------------------
+// The buffers are sized when the channel is opened.
+// -----------------------------------------------------------------------------
+size_t ChOutputChannel::GetMemoryFootprint() const
+{
+  return ChMemoryReport::VectorBytes(m_ring) + ChMemoryReport::VectorBytes(m_block) +
+         ChMemoryReport::VectorBytes(m_tolerances) + m_file.GetMemoryFootprint() + m_arrow.GetMemoryFootprint();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChOutputChannel::write_rows()
+{
+  while (true) {
+    m_mutex.Lock();
+    while (!m_stop && !m_flush && m_head - m_tail < m_chunk)
+      m_data_cond.Wait(m_mutex);
+    size_t first = m_tail;
+    size_t count = m_head - m_tail;
+    bool flush = m_flush;
+    bool stop = m_stop;
+    m_mutex.Unlock();
+
+    // Write the available rows, in at most two pieces if the ring wraps around.
+    while (count > 0) {
+      size_t slot = first % m_capacity;
+      size_t n = count;
+      if (n > m_capacity - slot)
+        n = m_capacity - slot;
+      if (n > m_chunk)
+        n = m_chunk;
+
+      write_chunk(slot, n);
+
+      m_mutex.Lock();
+      m_tail += n;
+      m_space_cond.Signal();
+      m_mutex.Unlock();
+
+      first += n;
+      count -= n;
+    }
+
+    if (flush || stop)
+      m_file.Flush();
+
+    if (flush) {
+      m_mutex.Lock();
+      m_flush = false;
+      m_space_cond.Broadcast();
+      m_mutex.Unlock();
+    }
+
+    if (stop)
+      break;
+  }
+}
+
+void ChOutputChannel::write_chunk(size_t first, size_t count)
+{
+  const double* rows = &m_ring[first * m_num_columns];
+
+  if (m_format == BINARY || m_format == ARROW) {
+    // Transpose the rows into a column-major block.
+    for (size_t i = 0; i < count; i++) {
+      for (int j = 0; j < m_num_columns; j++)
+        m_block[j * count + i] = rows[i * m_num_columns + j];
+    }
+
+    if (m_format == ARROW) {
+      m_arrow.WriteBatch(&m_block[0], count);
+      return;
+    }
+
+    uint32 num_rows = (uint32)count;
+    m_file.Write(&num_rows, sizeof(uint32));
+    m_file.Write(&m_block[0], sizeof(double) * count * m_num_columns);
+    return;
+  }
+
+  // Same formatting as the default for std::ostream (6 significant digits).
+  char buf[32];
+  for (size_t i = 0; i < count; i++) {
+    const double* row = rows + i * m_num_columns;
+    for (int j = 0; j < m_num_columns; j++) {
+      int n = sprintf(buf, j == 0 ? "%g" : ",%g", row[j]);
+      m_file.Write(buf, n);
+    }
+    m_file.Write("\n", 1);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChOutputChannel::ConvertToCSV(const std::string& bin_filename,
+                                   const std::string& csv_filename)
+{
+  ChCompressedFile in;
+  if (!in.OpenRead(bin_filename))
+    return false;
+
+  char magic[8];
+  uint32 num_columns = 0;
+  uint32 header_length = 0;
+
+  if (in.Read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, OUTPUT_MAGIC, sizeof(magic)) != 0 ||
+      in.Read(&num_columns, sizeof(uint32)) != sizeof(uint32) ||
+      in.Read(&header_length, sizeof(uint32)) != sizeof(uint32) || num_columns == 0) {
+    GetLog() << "ERROR: " << bin_filename.c_str() << " is not a binary output file\n";
+    return false;
+  }
+
+  std::string header(header_length, ' ');
+  if (header_length > 0 && in.Read(&header[0], header_length) != header_length) {
+    GetLog() << "ERROR: truncated output file " << bin_filename.c_str() << "\n";
+    return false;
+  }
+
+  ChCompressedFile out;
+  if (!out.OpenWrite(csv_filename, ChCompressedFile::AUTO, 0, true))
+    return false;
+
+  out.Write(header + "\n");
+
+  bool ok = true;
+  uint32 num_rows;
+  std::vector<double> block;
+  char buf[32];
+
+  while (in.Read(&num_rows, sizeof(uint32)) == sizeof(uint32)) {
+    block.resize((size_t)num_rows * num_columns);
+    if (in.Read(&block[0], sizeof(double) * block.size()) != sizeof(double) * block.size()) {
+      GetLog() << "ERROR: truncated output file " << bin_filename.c_str() << "\n";
+      ok = false;
+      break;
+    }
+
+    for (uint32 i = 0; i < num_rows; i++) {
+      for (uint32 j = 0; j < num_columns; j++) {
+        int n = sprintf(buf, j == 0 ? "%g" : ",%g", block[(size_t)j * num_rows + i]);
+        out.Write(buf, n);
+      }
+      out.Write("\n", 1);
+    }
+  }
+
+  ok = out.Close() && ok;
+
+  return ok;
+}
+
+bool ChOutputChannel::ReadBinary(const std::string&                 bin_filename,
+                                 std::string&                       header,
+                                 std::vector<std::vector<double> >& columns)
+{
+  ChCompressedFile in;
+  if (!in.OpenRead(bin_filename))
+    return false;
+
+  char magic[8];
+  uint32 num_columns = 0;
+  uint32 header_length = 0;
+
+  if (in.Read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, OUTPUT_MAGIC, sizeof(magic)) != 0 ||
+      in.Read(&num_columns, sizeof(uint32)) != sizeof(uint32) ||
+      in.Read(&header_length, sizeof(uint32)) != sizeof(uint32) || num_columns == 0) {
+    GetLog() << "ERROR: " << bin_filename.c_str() << " is not a binary output file\n";
+    return false;
+  }
+
+  header.assign(header_length, ' ');
+  if (header_length > 0 && in.Read(&header[0], header_length) != header_length) {
+    GetLog() << "ERROR: truncated output file " << bin_filename.c_str() << "\n";
+    return false;
+  }
+
+  columns.assign(num_columns, std::vector<double>());
+
+  bool ok = true;
+  uint32 num_rows;
+
+  while (in.Read(&num_rows, sizeof(uint32)) == sizeof(uint32)) {
+    for (uint32 j = 0; j < num_columns && ok; j++) {
+      std::vector<double>& column = columns[j];
+      size_t start = column.size();
+      column.resize(start + num_rows);
+      if (num_rows > 0 && in.Read(&column[start], sizeof(double) * num_rows) != sizeof(double) * num_rows) {
+        GetLog() << "ERROR: truncated output file " << bin_filename.c_str() << "\n";
+        ok = false;
+      }
+    }
+    if (!ok)
+      break;
+  }
+
+  return ok;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,195 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Buffered output channel for rows of a fixed set of double columns.
+//
+// The simulation thread appends rows to a ring buffer; a writer thread formats
+// and writes them to disk in chunks. The file is written either as CSV or in a
+// compact binary format:
+//   magic "CHOUT1\0\0" (8 bytes)
+//   number of columns   (uint32)
+//   header length       (uint32, in bytes)
+//   CSV header line     (column names separated by commas, no terminator)
+//   blocks, each one holding:
+//     number of rows    (uint32)
+//     for each column, the values of all rows in the block (double)
+// All integers and doubles are stored in the native byte order.
+// The file can also be written as an Apache Arrow IPC file (see ChArrowWriter),
+// with one record batch per chunk.
+//
+// In all formats, the file can be compressed (LZ4 or Zstandard, e.g. selected
+// with a ".lz4" or ".zst" file name extension, see ChCompressedFile). The
+// compression runs on the writer thread, and ConvertToCSV() and ReadBinary()
+// accept compressed files.
+//
+// Optionally, the rows are decimated by a change-triggered sampler (see
+// ChAdaptiveSampler) before they are buffered, so that steady phases produce
+// few rows while transients are recorded at the full output rate.
+//
+// =============================================================================
+
+#ifndef CH_OUTPUT_CHANNEL_H
+#define CH_OUTPUT_CHANNEL_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChArrowWriter.h"
+#include "subsys/ChCompressedFile.h"
+#include "subsys/ChAdaptiveSampler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Buffered, asynchronous output channel.
+///
+class CH_SUBSYS_API ChOutputChannel
+{
+public:
+
+  enum Format {
+    CSV,      ///< comma-separated values, as written by operator<<
+    BINARY,   ///< binary columnar blocks (see ChOutputChannel.h)
+    ARROW     ///< Arrow IPC file, e.g. for pandas.read_feather (see ChArrowWriter.h)
+  };
+
+  /// Create a closed output channel buffering up to the specified number of
+  /// rows. Rows are handed to the writer thread in chunks of half this size.
+  ChOutputChannel(int buffer_rows = 1024);
+
+  /// Close the channel (if open), writing all buffered rows.
+  ~ChOutputChannel();
+
+  /// Open the specified file and start the writer thread.
+  /// The columns are given as a CSV header line (column names separated by
+  /// commas). By default, the compression codec is selected by the file name
+  /// extension (see ChCompressedFile). Returns false if the file cannot be
+  /// opened for writing.
+  bool Open(
+    const std::string&       filename,                         ///< [in] name of the output file
+    const std::string&       header,                           ///< [in] CSV header line
+    Format                   format = CSV,                     ///< [in] output file format
+    ChCompressedFile::Codec  codec = ChCompressedFile::AUTO,   ///< [in] compression codec
+    int                      level = 0                         ///< [in] compression level (0: codec default)
+    );
+
+  /// Enable change-triggered sampling of the rows written (see
+  /// ChAdaptiveSampler), with one tolerance per column, the first column
+  /// being the time. An empty array disables the sampling (default). Must be
+  /// called before Open(); Open() fails if the number of tolerances does not
+  /// match the number of columns.
+  void SetAdaptiveSampling(
+    const std::vector<double>& tolerances,  ///< [in] absolute tolerance of each column
+    double                     max_gap = 0  ///< [in] maximum time between rows (0: no limit)
+    );
+
+  /// Get the sampler of the channel (e.g. for its statistics).
+  const ChAdaptiveSampler& GetSampler() const { return m_sampler; }
+
+  /// Write all buffered rows, stop the writer thread and close the file.
+  void Close();
+
+  /// Return true if the channel is open.
+  bool IsOpen() const { return m_file.IsOpen(); }
+
+  /// Get the number of columns of the open channel.
+  int GetNumColumns() const { return m_num_columns; }
+
+  /// Append a row. The array must contain GetNumColumns() values.
+  /// Blocks only if the ring buffer is full. With adaptive sampling, the row
+  /// may be dropped or held back until the next rows.
+  void Write(const double* values);
+
+  /// Wait until all rows appended so far are written to the file.
+  void Flush();
+
+  /// Return the heap memory used by the buffers of this channel (ring buffer,
+  /// output blocks and file buffers), in bytes.
+  size_t GetMemoryFootprint() const;
+
+  /// Convert a binary output file to CSV (compressed according to the
+  /// extension of the CSV file name). Returns false if the input is not a valid binary output file or if the
+  /// output cannot be written.
+  static bool ConvertToCSV(
+    const std::string& bin_filename,   ///< [in] binary output file
+    const std::string& csv_filename    ///< [in] name of the CSV file to write
+    );
+
+  /// Read a binary output file into memory, one array of values per column.
+  /// Returns false if the file cannot be read or is not a valid binary output
+  /// file.
+  static bool ReadBinary(
+    const std::string&                 bin_filename,  ///< [in] binary output file
+    std::string&                       header,        ///< [out] CSV header line
+    std::vector<std::vector<double> >& columns        ///< [out] column values
+    );
+
+private:
+
+  class Writer : public ChThread {
+  public:
+    Writer(ChOutputChannel* channel) : m_channel(channel) {}
+  protected:
+    virtual void Run() { m_channel->write_rows(); }
+  private:
+    ChOutputChannel* m_channel;
+  };
+
+  // Append a row to the ring buffer.
+  void append(const double* values);
+
+  // Body of the writer thread.
+  void write_rows();
+
+  // Write the rows [first, first + count) of the ring buffer, which must not
+  // wrap around.
+  void write_chunk(size_t first, size_t count);
+
+  ChCompressedFile     m_file;
+  Format               m_format;
+  int                  m_num_columns;
+
+  // Ring buffer (the counters are protected by m_mutex; the rows between
+  // m_tail and m_head belong to the writer thread, all others to the
+  // simulation thread)
+  std::vector<double>  m_ring;
+  size_t               m_capacity;      // in rows
+  size_t               m_chunk;         // rows handed to the writer at once
+  size_t               m_head;          // total number of rows appended
+  size_t               m_tail;          // total number of rows written
+  std::vector<double>  m_block;         // transposed block (BINARY, ARROW)
+  ChArrowWriter        m_arrow;
+
+  std::vector<double>  m_tolerances;    // adaptive sampling tolerances (empty if disabled)
+  double               m_max_gap;
+  ChAdaptiveSampler    m_sampler;
+
+  Writer               m_writer;
+  ChMutex              m_mutex;
+  ChCondition          m_data_cond;     // signaled when rows are available
+  ChCondition          m_space_cond;    // signaled when rows were written
+  bool                 m_flush;
+  bool                 m_stop;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
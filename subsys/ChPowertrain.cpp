@@ -28,4 +28,22 @@ ChPowertrain::ChPowertrain()
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPowertrain::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(1);
+  state.Write((double)m_drive_mode);
+}
+
+bool ChPowertrain::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(1, "powertrain"))
+    return false;
+
+  SetDriveMode((DriveMode)(int)state.Read());
+  return true;
+}
+
+
 }  // end namespace chrono
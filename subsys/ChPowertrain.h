@@ -24,6 +24,7 @@
 #include "physics/ChBody.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleState.h"
 
 namespace chrono {
 
@@ -73,6 +74,21 @@ public:
   /// Set the mode of the transmission.
   virtual void SetDriveMode(DriveMode mmode) = 0;
 
+  /// Find the throttle input at which the powertrain delivers the specified
+  /// torque to the driveshaft, in steady state, at the specified driveshaft
+  /// speed and in the current gear (e.g. for the feed-forward of a speed
+  /// controller). The throttle is clamped to [0,1]; the requested torque minus
+  /// the torque delivered at that throttle is returned in residual (negative
+  /// if the brakes must supply the difference).
+  /// Returns false if the powertrain does not provide this inversion (default)
+  /// or is in neutral.
+  virtual bool GetThrottleForTorque(
+    double  torque,        ///< [in] requested driveshaft torque
+    double  shaft_speed,   ///< [in] angular speed of the driveshaft
+    double& throttle,      ///< [out] throttle input [0,1]
+    double& residual       ///< [out] torque not delivered at this throttle
+    ) const { return false; }
+
   /// Update the state of this powertrain system at the current time.
   /// The powertrain system is provided the current driver throttle input, a
   /// value in the range [0,1], and the current angular speed of the transmission
@@ -86,6 +102,15 @@ public:
   /// Advance the state of this powertrain system by the specified time step.
   virtual void Advance(double step) = 0;
 
+  /// Append the internal state of this powertrain to the specified snapshot.
+  /// The base class implementation saves the drive mode only. Note that the
+  /// state of powertrain shafts is saved with the vehicle state.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the internal state of this powertrain from the next block of the
+  /// specified snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
 protected:
   DriveMode m_drive_mode;
 };
@@ -0,0 +1,320 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Low-overhead profiling of the vehicle modules.
+//
+// =============================================================================
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChProfiler.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+struct ChProfileStats {
+  ChProfileStats() : count(0), total(0), min(0), max(0) {}
+
+  long    count;
+  double  total;
+  double  min;
+  double  max;
+};
+
+struct ChProfileEvent {
+  int     section;
+  bool    counter;
+  double  time;       // start time
+  double  value;      // duration, or counter value
+};
+
+// Accumulators of one thread, only written by that thread.
+struct ChProfileThread {
+  ChProfileThread() : num_events(0) {}
+
+  void AddEvent(int section, bool counter, double time, double value);
+
+  int                          index;
+  std::vector<ChProfileStats>  stats;       // indexed by section
+  std::vector<ChProfileEvent>  events;      // ring buffer
+  long                         num_events;  // number of events added since the last reset
+};
+
+static ChMutex                        s_profile_mutex;
+static std::vector<std::string>       s_sections;
+static std::vector<ChProfileThread*>  s_threads;
+static bool                           s_trace = false;
+static int                            s_max_events = 0;
+
+static CH_THREAD_LOCAL ChProfileThread* s_thread = 0;
+
+
+// The ring buffer is (re)allocated at the first event after the trace is
+// enabled; when full, the oldest event is overwritten.
+void ChProfileThread::AddEvent(int section, bool counter, double time, double value)
+{
+  if ((int)events.size() != s_max_events) {
+    events.resize(s_max_events);
+    num_events = 0;
+  }
+  if (events.empty())
+    return;
+
+  ChProfileEvent& event = events[num_events % (long)events.size()];
+  event.section = section;
+  event.counter = counter;
+  event.time = time;
+  event.value = value;
+  num_events++;
+}
+
+
+static ChProfileThread* current_thread()
+{
+  if (!s_thread) {
+    ChProfileThread* thread = new ChProfileThread;
+    ChScopedLock lock(s_profile_mutex);
+    thread->index = (int)s_threads.size();
+    s_threads.push_back(thread);
+    s_thread = thread;
+  }
+  return s_thread;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChProfiler::RegisterSection(const char* name)
+{
+  ChScopedLock lock(s_profile_mutex);
+
+  for (size_t i = 0; i < s_sections.size(); i++) {
+    if (s_sections[i] == name)
+      return (int)i;
+  }
+
+  s_sections.push_back(name);
+  return (int)s_sections.size() - 1;
+}
+
+double ChProfiler::GetTime()
+{
+#ifdef _WIN32
+  static LARGE_INTEGER freq = {0};
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  LARGE_INTEGER count;
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+void ChProfiler::Record(int section, double start, double duration)
+{
+  ChProfileThread* thread = current_thread();
+
+  if (section >= (int)thread->stats.size())
+    thread->stats.resize(section + 1);
+
+  ChProfileStats& stats = thread->stats[section];
+  if (stats.count == 0 || duration < stats.min)
+    stats.min = duration;
+  if (stats.count == 0 || duration > stats.max)
+    stats.max = duration;
+  stats.total += duration;
+  stats.count++;
+
+  if (s_trace && start >= 0)
+    thread->AddEvent(section, false, start, duration);
+}
+
+void ChProfiler::Counter(int section, double value)
+{
+  if (s_trace)
+    current_thread()->AddEvent(section, true, GetTime(), value);
+}
+
+bool ChProfiler::GetThreadStats(int section, long& count, double& total)
+{
+  count = 0;
+  total = 0;
+
+  if (!s_thread || section < 0 || section >= (int)s_thread->stats.size())
+    return false;
+
+  const ChProfileStats& stats = s_thread->stats[section];
+  count = stats.count;
+  total = stats.total;
+
+  return count > 0;
+}
+
+void ChProfiler::EnableTrace(bool val, int max_events)
+{
+  s_max_events = max_events > 0 ? max_events : 0;
+  s_trace = val;
+}
+
+bool ChProfiler::IsTraceEnabled()
+{
+  return s_trace;
+}
+
+void ChProfiler::Reset()
+{
+  ChScopedLock lock(s_profile_mutex);
+
+  for (size_t k = 0; k < s_threads.size(); k++) {
+    s_threads[k]->stats.clear();
+    s_threads[k]->num_events = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+struct ChProfileEntry {
+  int             section;
+  int             num_threads;
+  ChProfileStats  stats;
+
+  bool operator<(const ChProfileEntry& other) const { return stats.total > other.stats.total; }
+};
+
+void ChProfiler::PrintSummary()
+{
+  ChScopedLock lock(s_profile_mutex);
+
+  // Merge the per-thread statistics
+  std::vector<ChProfileEntry> entries;
+
+  for (size_t i = 0; i < s_sections.size(); i++) {
+    ChProfileEntry entry;
+    entry.section = (int)i;
+    entry.num_threads = 0;
+
+    for (size_t k = 0; k < s_threads.size(); k++) {
+      if (i >= s_threads[k]->stats.size() || s_threads[k]->stats[i].count == 0)
+        continue;
+      const ChProfileStats& stats = s_threads[k]->stats[i];
+      if (entry.num_threads == 0 || stats.min < entry.stats.min)
+        entry.stats.min = stats.min;
+      if (entry.num_threads == 0 || stats.max > entry.stats.max)
+        entry.stats.max = stats.max;
+      entry.stats.total += stats.total;
+      entry.stats.count += stats.count;
+      entry.num_threads++;
+    }
+
+    if (entry.num_threads > 0)
+      entries.push_back(entry);
+  }
+
+  std::sort(entries.begin(), entries.end());
+
+  char line[256];
+  sprintf(line, "%-40s %8s %12s %12s %12s %12s %8s\n",
+          "section", "calls", "total [ms]", "mean [us]", "min [us]", "max [us]", "threads");
+  GetLog() << line;
+
+  for (size_t j = 0; j < entries.size(); j++) {
+    const ChProfileEntry& entry = entries[j];
+    sprintf(line, "%-40s %8ld %12.3f %12.3f %12.3f %12.3f %8d\n",
+            s_sections[entry.section].c_str(),
+            entry.stats.count,
+            1e3 * entry.stats.total,
+            1e6 * entry.stats.total / entry.stats.count,
+            1e6 * entry.stats.min,
+            1e6 * entry.stats.max,
+            entry.num_threads);
+    GetLog() << line;
+  }
+}
+
+bool ChProfiler::WriteTrace(const std::string& filename)
+{
+  ChScopedLock lock(s_profile_mutex);
+
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp)
+    return false;
+
+  // Time origin: the earliest recorded event.
+  double origin = 0;
+  bool found = false;
+  for (size_t k = 0; k < s_threads.size(); k++) {
+    const ChProfileThread& thread = *s_threads[k];
+    long size = (long)thread.events.size();
+    long first = thread.num_events > size ? thread.num_events - size : 0;
+    for (long n = first; n < thread.num_events; n++) {
+      double time = thread.events[n % size].time;
+      if (!found || time < origin)
+        origin = time;
+      found = true;
+    }
+  }
+
+  // Chrome trace format: complete events ("X") for the timed sections and
+  // counter events ("C"), times in microseconds; one track per thread.
+  fprintf(fp, "{\"traceEvents\":[\n");
+
+  for (size_t k = 0; k < s_threads.size(); k++) {
+    const ChProfileThread& thread = *s_threads[k];
+    fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            k == 0 ? "" : ",\n", thread.index, thread.index);
+  }
+
+  for (size_t k = 0; k < s_threads.size(); k++) {
+    const ChProfileThread& thread = *s_threads[k];
+    long size = (long)thread.events.size();
+    long first = thread.num_events > size ? thread.num_events - size : 0;
+    for (long n = first; n < thread.num_events; n++) {
+      const ChProfileEvent& event = thread.events[n % size];
+      const char* name = s_sections[event.section].c_str();
+      if (event.counter)
+        fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                name, thread.index, 1e6 * (event.time - origin), event.value);
+      else
+        fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                name, thread.index, 1e6 * (event.time - origin), 1e6 * event.value);
+    }
+  }
+
+  fprintf(fp, "\n]}\n");
+  fclose(fp);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,155 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Low-overhead profiling of the vehicle modules.
+//
+// Code sections are instrumented with the CH_PROFILE_SCOPE macro, which times
+// the enclosing scope, or with CH_PROFILE_RECORD, which records a duration
+// measured elsewhere (e.g. by the ChSystem timers). Quantities that explain the
+// cost of a section (number of contacts, integration sub-steps, ...) are
+// recorded with CH_PROFILE_COUNTER. All macros compile to nothing (and do not
+// evaluate their arguments) unless ChronoVehicle is configured with
+// ENABLE_PROFILING.
+//
+// The statistics (number of calls, total, minimum and maximum time) are
+// accumulated per thread, without locking, and merged by PrintSummary(). If
+// tracing is enabled, each timed scope and each counter value is also recorded
+// as an event in a ring buffer owned by the calling thread, which keeps the
+// most recent events; the events can be written in the Chrome trace format,
+// which is read by chrome://tracing and by Perfetto (ui.perfetto.dev).
+//
+// PrintSummary(), WriteTrace() and Reset() must not be called while
+// instrumented code runs in other threads.
+//
+// =============================================================================
+
+#ifndef CH_PROFILER_H
+#define CH_PROFILER_H
+
+#include <string>
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Registry and per-thread accumulators of profiled code sections.
+///
+class CH_SUBSYS_API ChProfiler
+{
+public:
+
+  /// Return the identifier of the section with the specified name, creating
+  /// the section if needed.
+  static int RegisterSection(const char* name);
+
+  /// Return the current time, in seconds from an arbitrary origin.
+  static double GetTime();
+
+  /// Record one execution of the specified section, which started at the
+  /// specified time (as returned by GetTime()) and lasted the specified duration.
+  /// The start time is only used for tracing; it may be negative if unknown.
+  static void Record(int section, double start, double duration);
+
+  /// Record the current value of the specified counter (trace only).
+  static void Counter(int section, double value);
+
+  /// Enable or disable the recording of trace events (default: disabled).
+  /// The most recent max_events events are kept per thread.
+  static void EnableTrace(bool val, int max_events = 1000000);
+
+  /// Return true if trace events are recorded.
+  static bool IsTraceEnabled();
+
+  /// Discard all statistics and trace events.
+  static void Reset();
+
+  /// Get the number of executions and the total time of the specified section
+  /// recorded so far by the calling thread (e.g. for a live display; this
+  /// function does not lock). Returns false if the section was not executed.
+  static bool GetThreadStats(int section, long& count, double& total);
+
+  /// Print a table with the statistics of all sections, merged over threads.
+  static void PrintSummary();
+
+  /// Write the recorded trace events to the specified file, in the Chrome
+  /// trace JSON format. Returns false if the file cannot be opened.
+  static bool WriteTrace(const std::string& filename);
+};
+
+///
+/// Time the lifetime of this object as one execution of a profiled section.
+///
+class ChProfileScope
+{
+public:
+  explicit ChProfileScope(int section) : m_section(section), m_start(ChProfiler::GetTime()) {}
+  ~ChProfileScope() { ChProfiler::Record(m_section, m_start, ChProfiler::GetTime() - m_start); }
+
+private:
+  ChProfileScope(const ChProfileScope&);
+  ChProfileScope& operator=(const ChProfileScope&);
+
+  int     m_section;
+  double  m_start;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#define CH_PROFILE_CONCAT_(a, b) a##b
+#define CH_PROFILE_CONCAT(a, b) CH_PROFILE_CONCAT_(a, b)
+
+#if PROFILING_ENABLED
+
+/// Time the rest of the enclosing scope as one execution of the named section.
+# define CH_PROFILE_SCOPE(name) \
+    static const int CH_PROFILE_CONCAT(ch_profile_section_, __LINE__) = \
+      chrono::vehicle::ChProfiler::RegisterSection(name); \
+    chrono::vehicle::ChProfileScope CH_PROFILE_CONCAT(ch_profile_scope_, __LINE__)( \
+      CH_PROFILE_CONCAT(ch_profile_section_, __LINE__))
+
+/// Record one execution of the named section with the specified duration [s].
+# define CH_PROFILE_RECORD(name, duration) \
+    do { \
+      static const int ch_profile_section = chrono::vehicle::ChProfiler::RegisterSection(name); \
+      chrono::vehicle::ChProfiler::Record(ch_profile_section, -1, duration); \
+    } while (0)
+
+/// Record the current value of the named counter. The value is not evaluated
+/// unless tracing is enabled.
+# define CH_PROFILE_COUNTER(name, value) \
+    do { \
+      if (chrono::vehicle::ChProfiler::IsTraceEnabled()) { \
+        static const int ch_profile_section = chrono::vehicle::ChProfiler::RegisterSection(name); \
+        chrono::vehicle::ChProfiler::Counter(ch_profile_section, (double)(value)); \
+      } \
+    } while (0)
+
+#else
+
+# define CH_PROFILE_SCOPE(name)
+# define CH_PROFILE_RECORD(name, duration) do {} while (0)
+# define CH_PROFILE_COUNTER(name, value) do {} while (0)
+
+#endif
+
+
+#endif
@@ -0,0 +1,152 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batch of ray casts against a terrain.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChRayBatch.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Task casting one chunk of rays.
+// -----------------------------------------------------------------------------
+class ChRayTask : public ChTask
+{
+public:
+  ChRayTask() : m_batch(NULL), m_terrain(NULL), m_first(0), m_count(0), m_hits(0) {}
+
+  void Set(ChRayBatch* batch, const ChTerrain* terrain, int first, int count)
+  {
+    m_batch = batch;
+    m_terrain = terrain;
+    m_first = first;
+    m_count = count;
+  }
+
+  int GetNumHits() const { return m_hits; }
+
+  virtual void Execute(int worker)
+  {
+    m_hits = m_terrain->CastRays(m_count,
+                                 &m_batch->m_origins[m_first],
+                                 &m_batch->m_dirs[m_first],
+                                 &m_batch->m_max_dist[m_first],
+                                 &m_batch->m_dist[m_first]);
+  }
+
+private:
+  ChRayBatch*       m_batch;
+  const ChTerrain*  m_terrain;
+  int               m_first;
+  int               m_count;
+  int               m_hits;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRayBatch::~ChRayBatch()
+{
+  for (size_t i = 0; i < m_tasks.size(); i++)
+    delete m_tasks[i];
+}
+
+void ChRayBatch::Clear()
+{
+  m_origins.clear();
+  m_dirs.clear();
+  m_max_dist.clear();
+  m_dist.clear();
+  m_num_hits = 0;
+}
+
+int ChRayBatch::AddRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist)
+{
+  m_origins.push_back(origin);
+  m_dirs.push_back(dir);
+  m_max_dist.push_back(max_dist);
+  m_dist.push_back(-1);
+
+  return (int)m_origins.size() - 1;
+}
+
+int ChRayBatch::AddFan(const ChVector<>&     origin,
+                       const ChQuaternion<>& rot,
+                       double                azimuth,
+                       int                   num_beams,
+                       double                min_elevation,
+                       double                max_elevation,
+                       double                max_dist)
+{
+  int first = (int)m_origins.size();
+  double ca = std::cos(azimuth);
+  double sa = std::sin(azimuth);
+  double step = (num_beams > 1) ? (max_elevation - min_elevation) / (num_beams - 1) : 0;
+
+  for (int k = 0; k < num_beams; k++) {
+    double elevation = min_elevation + k * step;
+    double ce = std::cos(elevation);
+    AddRay(origin, rot.Rotate(ChVector<>(ce * ca, ce * sa, std::sin(elevation))), max_dist);
+  }
+
+  return first;
+}
+
+ChVector<> ChRayBatch::GetPoint(int ray) const
+{
+  double dist = (m_dist[ray] < 0) ? m_max_dist[ray] : m_dist[ray];
+
+  return m_origins[ray] + m_dirs[ray] * dist;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChRayBatch::Cast(const ChTerrain& terrain, ChThreadPool* pool)
+{
+  int n = (int)m_origins.size();
+  int num_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  if (!pool || num_chunks <= 1) {
+    m_num_hits = (n > 0) ? terrain.CastRays(n, &m_origins[0], &m_dirs[0], &m_max_dist[0], &m_dist[0]) : 0;
+    return m_num_hits;
+  }
+
+  while ((int)m_tasks.size() < num_chunks)
+    m_tasks.push_back(new ChRayTask);
+
+  for (int k = 0; k < num_chunks; k++) {
+    int first = k * CHUNK_SIZE;
+    m_tasks[k]->Set(this, &terrain, first, std::min(CHUNK_SIZE, n - first));
+    pool->Submit(m_tasks[k]);
+  }
+  pool->Wait();
+
+  m_num_hits = 0;
+  for (int k = 0; k < num_chunks; k++)
+    m_num_hits += m_tasks[k]->GetNumHits();
+
+  return m_num_hits;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
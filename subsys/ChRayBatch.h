@@ -0,0 +1,121 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batch of ray casts against a terrain, for perception sensors (e.g. the lidar
+// sensors of all vehicles of a fleet).
+//
+// The rays are collected in arrays (origins, directions, maximum distances)
+// and cast in chunks of CHUNK_SIZE rays, each chunk by one call to
+// ChTerrain::CastRays(); with a thread pool (e.g. the pool of a fleet, see
+// ChFleetSimulation::GetThreadPool()), the chunks are distributed over the
+// workers. The arrays and tasks are reused from one batch to the next, so a
+// batch of the same size allocates no memory.
+//
+// =============================================================================
+
+#ifndef CH_RAY_BATCH_H
+#define CH_RAY_BATCH_H
+
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChThreadPool.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChRayTask;
+
+///
+/// Batch of terrain ray casts, optionally distributed over a thread pool.
+///
+class CH_SUBSYS_API ChRayBatch
+{
+public:
+
+  /// Number of rays cast by one task.
+  static const int CHUNK_SIZE = 256;
+
+  ChRayBatch() : m_num_hits(0) {}
+  ~ChRayBatch();
+
+  /// Remove all rays (the storage is kept).
+  void Clear();
+
+  /// Add a ray. Returns the index of the ray in the batch.
+  int AddRay(
+    const ChVector<>&  origin,     ///< [in] ray origin
+    const ChVector<>&  dir,        ///< [in] ray direction (unit vector)
+    double             max_dist    ///< [in] maximum distance along the ray
+    );
+
+  /// Add a vertical fan of beams, as fired by a spinning multi-beam lidar at
+  /// one azimuth: the beams are at evenly spaced elevation angles (from the
+  /// minimum to the maximum), in the frame of the sensor (X forward, Z up).
+  /// Returns the index of the first beam in the batch.
+  int AddFan(
+    const ChVector<>&      origin,         ///< [in] sensor position
+    const ChQuaternion<>&  rot,            ///< [in] sensor orientation
+    double                 azimuth,        ///< [in] azimuth of the fan, from the sensor X axis
+    int                    num_beams,      ///< [in] number of beams
+    double                 min_elevation,  ///< [in] elevation of the lowest beam
+    double                 max_elevation,  ///< [in] elevation of the highest beam
+    double                 max_dist        ///< [in] range of the beams
+    );
+
+  /// Cast all rays against the specified terrain, using the specified thread
+  /// pool (if not NULL). Returns the number of rays that hit the terrain.
+  int Cast(const ChTerrain& terrain, ChThreadPool* pool = NULL);
+
+  /// Get the number of rays.
+  int GetNumRays() const { return (int)m_origins.size(); }
+
+  /// Get the number of rays that hit the terrain at the last cast.
+  int GetNumHits() const { return m_num_hits; }
+
+  /// Get the distance to the intersection of the specified ray (-1 if the ray
+  /// did not hit the terrain).
+  double GetDistance(int ray) const { return m_dist[ray]; }
+
+  /// Get the intersection point of the specified ray (the end point of the
+  /// ray if it did not hit the terrain).
+  ChVector<> GetPoint(int ray) const;
+
+private:
+
+  friend class ChRayTask;
+
+  ChRayBatch(const ChRayBatch&);
+  ChRayBatch& operator=(const ChRayBatch&);
+
+  std::vector<ChVector<> >   m_origins;
+  std::vector<ChVector<> >   m_dirs;
+  std::vector<double>        m_max_dist;
+  std::vector<double>        m_dist;
+  int                        m_num_hits;
+
+  std::vector<ChRayTask*>    m_tasks;     // one per chunk
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,239 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hard real-time execution of a vehicle simulation loop.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <limits>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChRealtimeScheduler.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Degradations
+// -----------------------------------------------------------------------------
+void ChDropRendering::Apply(ChVehicleSimulation& sim)
+{
+  m_prev_step = sim.GetRenderStep();
+  sim.SetRenderStep(m_render_step);
+}
+
+void ChDropRendering::Revert(ChVehicleSimulation& sim)
+{
+  sim.SetRenderStep(m_prev_step);
+}
+
+void ChSwapTires::swap(ChVehicleSimulation& sim)
+{
+  int num_wheels = std::min(sim.GetNumWheels(), (int)m_tires.size());
+
+  for (int i = 0; i < num_wheels; i++) {
+    ChSharedPtr<ChTire> active = sim.GetTire(ChWheelID(i));
+
+    ChVehicleState state;
+    active->SaveState(state);
+    state.Rewind();
+    if (!m_tires[i]->RestoreState(state))
+      GetLog() << "WARNING: ChSwapTires: cannot transfer the state of tire " << i << "\n";
+
+    sim.SetTire(ChWheelID(i), m_tires[i]);
+    m_tires[i] = active;
+  }
+}
+
+void ChSwapVehicle::swap(ChVehicleSimulation& sim)
+{
+  ChSharedPtr<ChVehicle> active = sim.GetVehicle();
+
+  if (sim.SetVehicle(m_vehicle))
+    m_vehicle = active;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRealtimeScheduler::ChRealtimeScheduler(ChVehicleSimulation& sim)
+: m_sim(sim),
+  m_cpu(-1),
+  m_priority(0),
+  m_spin_time(2e-4),
+  m_end_time(std::numeric_limits<double>::max()),
+  m_escalation(3),
+  m_recovery(0),
+  m_utilization(0.5),
+  m_num_steps(0),
+  m_num_misses(0),
+  m_num_slips(0),
+  m_max_step_time(0),
+  m_max_lateness(0),
+  m_pinned(false),
+  m_realtime(false),
+  m_stop(0)
+{
+  std::fill(m_budget, m_budget + NUM_SECTIONS, 0.0);
+  std::fill(m_overruns, m_overruns + NUM_SECTIONS, 0);
+}
+
+void ChRealtimeScheduler::AddDegradation(ChSharedPtr<ChRealtimeDegradation> degradation, int section)
+{
+  Degradation d;
+  d.degradation = degradation;
+  d.section = section;
+  d.applied = false;
+  m_degradations.push_back(d);
+}
+
+// -----------------------------------------------------------------------------
+// Sleep until the spin time before the release, then spin.
+// -----------------------------------------------------------------------------
+void ChRealtimeScheduler::wait_until(double time) const
+{
+  double remaining = time - ChProfiler::GetTime();
+  if (remaining > m_spin_time)
+    ChThread::Sleep(remaining - m_spin_time);
+
+  while (ChProfiler::GetTime() < time) {
+  }
+}
+
+void ChRealtimeScheduler::escalate(int overrun_mask)
+{
+  int next = -1;
+  for (size_t i = 0; i < m_degradations.size(); i++) {
+    const Degradation& d = m_degradations[i];
+    if (d.applied)
+      continue;
+    if (d.section != ANY_SECTION && (overrun_mask & (1 << d.section))) {
+      next = (int)i;
+      break;
+    }
+    if (next < 0)
+      next = (int)i;
+  }
+
+  if (next < 0)
+    return;
+
+  Degradation& d = m_degradations[next];
+  GetLog() << "WARNING: ChRealtimeScheduler: deadlines missed at t = " << m_sim.GetTime()
+           << ", applying degradation: " << d.degradation->GetName() << "\n";
+  d.degradation->Apply(m_sim);
+  d.applied = true;
+  m_applied.push_back(next);
+}
+
+void ChRealtimeScheduler::recover()
+{
+  Degradation& d = m_degradations[m_applied.back()];
+  GetLog() << "ChRealtimeScheduler: reverting degradation at t = " << m_sim.GetTime()
+           << ": " << d.degradation->GetName() << "\n";
+  d.degradation->Revert(m_sim);
+  d.applied = false;
+  m_applied.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Each step is released at its due time and its deadline is the next release.
+// The overruns of the section budgets are accumulated over the consecutive
+// missed deadlines, to select the degradation.
+// -----------------------------------------------------------------------------
+void ChRealtimeScheduler::Run()
+{
+  if (m_cpu >= 0) {
+    m_pinned = ChThread::PinToCpu(m_cpu);
+    if (!m_pinned)
+      GetLog() << "WARNING: ChRealtimeScheduler: cannot pin the thread to processor " << m_cpu << "\n";
+  }
+  if (m_priority > 0) {
+    m_realtime = ChThread::SetRealtimePriority(m_priority);
+    if (!m_realtime)
+      GetLog() << "WARNING: ChRealtimeScheduler: cannot set the real-time priority\n";
+  }
+
+  m_sim.EnableModuleTiming(true);
+
+  double period = m_sim.GetStepSize();
+  double release = ChProfiler::GetTime();
+
+  int num_consecutive = 0;   // consecutive missed deadlines
+  int num_calm = 0;          // consecutive steps with enough slack
+  int overrun_mask = 0;      // sections overrun during the consecutive misses
+
+  while (!ChAtomicLoad(&m_stop) && m_sim.GetTime() < m_end_time - 0.5 * period) {
+    wait_until(release);
+
+    double start = ChProfiler::GetTime();
+    m_sim.DoStep();
+    double end = ChProfiler::GetTime();
+
+    double step_time = end - start;
+    double lateness = start - release;
+    m_max_step_time = std::max(m_max_step_time, step_time);
+    m_max_lateness = std::max(m_max_lateness, lateness);
+    m_num_steps++;
+
+    CH_PROFILE_RECORD("ChRealtimeScheduler::Step", step_time);
+    CH_PROFILE_COUNTER("ChRealtimeScheduler::Lateness", lateness);
+
+    for (int s = 0; s < NUM_SECTIONS; s++) {
+      double time = (s == HOOKS) ? m_sim.GetHookTime() : m_sim.GetModuleTime(ChVehicleSimulation::Module(s));
+      if (m_budget[s] > 0 && time > m_budget[s]) {
+        m_overruns[s]++;
+        overrun_mask |= 1 << s;
+      }
+    }
+
+    if (end > release + period) {
+      m_num_misses++;
+      num_consecutive++;
+      num_calm = 0;
+      if (num_consecutive >= m_escalation) {
+        escalate(overrun_mask);
+        num_consecutive = 0;
+        overrun_mask = 0;
+      }
+    } else {
+      num_consecutive = 0;
+      overrun_mask = 0;
+      num_calm = (step_time <= m_utilization * period) ? num_calm + 1 : 0;
+      if (m_recovery > 0 && num_calm >= m_recovery && !m_applied.empty()) {
+        recover();
+        num_calm = 0;
+      }
+    }
+
+    // Next release; re-anchor the schedule if more than one period behind.
+    release += period;
+    if (end > release + period) {
+      release = end;
+      m_num_slips++;
+    }
+  }
+
+  m_sim.EnableModuleTiming(false);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,271 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hard real-time execution of a vehicle simulation loop, e.g. for
+// hardware-in-the-loop runs.
+//
+// The scheduler thread (optionally pinned to a processor and running with
+// real-time priority) performs one base step of a ChVehicleSimulation per
+// period, equal to the base step size, which is never changed. Each step is
+// released at its due time (the thread sleeps, then spins for the last part
+// of the wait) and must complete before the next release. The wall clock time
+// of each module and of the output/rendering hooks is measured by the
+// simulation loop (see ChVehicleSimulation::EnableModuleTiming()) and checked
+// against optional per-section budgets, so that a missed deadline can be
+// traced to the module that overran.
+//
+// Instead of varying the step, sustained misses trigger a degradation policy:
+// an ordered list of degradations (e.g. drop the rendering, switch the tires
+// to tabulated Magic Formula instances, switch to a vehicle model with reduced
+// suspensions). After a number of consecutive misses, the first pending
+// degradation addressing a section that overran its budget is applied (or
+// else the first pending one). Optionally, the last applied degradation is
+// reverted after a number of steps with enough slack.
+//
+// If the loop falls more than one period behind, its schedule is re-anchored
+// to the current time (a slip) rather than running the missed steps back to
+// back.
+//
+// =============================================================================
+
+#ifndef CH_REALTIME_SCHEDULER_H
+#define CH_REALTIME_SCHEDULER_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChVehicleSimulation.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Base class for a degradation of a simulation applied by a real-time
+/// scheduler. Apply() and Revert() are called by the scheduler thread, between
+/// two steps.
+///
+class CH_SUBSYS_API ChRealtimeDegradation : public ChShared
+{
+public:
+  virtual ~ChRealtimeDegradation() {}
+
+  /// Get the name of the degradation (for the log).
+  virtual const char* GetName() const = 0;
+
+  /// Apply the degradation to the specified simulation.
+  virtual void Apply(ChVehicleSimulation& sim) = 0;
+
+  /// Revert the degradation.
+  virtual void Revert(ChVehicleSimulation& sim) = 0;
+};
+
+///
+/// Degradation reducing the rendering rate.
+///
+class CH_SUBSYS_API ChDropRendering : public ChRealtimeDegradation
+{
+public:
+  ChDropRendering(
+    double render_step = 1000   ///< [in] degraded render step (default: rendering practically off)
+    ) : m_render_step(render_step), m_prev_step(0) {}
+
+  virtual const char* GetName() const { return "drop rendering"; }
+  virtual void Apply(ChVehicleSimulation& sim);
+  virtual void Revert(ChVehicleSimulation& sim);
+
+private:
+  double m_render_step;
+  double m_prev_step;
+};
+
+///
+/// Degradation replacing the tires with cheaper instances (e.g. ChPacejkaTire
+/// objects with tabulated Magic Formula curves, for the same parameter file).
+/// The replacement tires must be initialized; the state of each tire is
+/// transferred to its replacement (see ChTire::SaveState()), which requires
+/// tires of the same type.
+///
+class CH_SUBSYS_API ChSwapTires : public ChRealtimeDegradation
+{
+public:
+  ChSwapTires(
+    const std::vector<ChSharedPtr<ChTire> >& tires   ///< [in] replacement tires, indexed by wheel ID
+    ) : m_tires(tires) {}
+
+  virtual const char* GetName() const { return "swap tires"; }
+  virtual void Apply(ChVehicleSimulation& sim) { swap(sim); }
+  virtual void Revert(ChVehicleSimulation& sim) { swap(sim); }
+
+private:
+  void swap(ChVehicleSimulation& sim);
+
+  std::vector<ChSharedPtr<ChTire> > m_tires;   // inactive tires
+};
+
+///
+/// Degradation switching to another model of the vehicle (e.g. one with
+/// reduced suspensions), see ChVehicleSimulation::SetVehicle().
+///
+class CH_SUBSYS_API ChSwapVehicle : public ChRealtimeDegradation
+{
+public:
+  ChSwapVehicle(
+    ChSharedPtr<ChVehicle> vehicle   ///< [in] replacement vehicle model
+    ) : m_vehicle(vehicle) {}
+
+  virtual const char* GetName() const { return "swap vehicle model"; }
+  virtual void Apply(ChVehicleSimulation& sim) { swap(sim); }
+  virtual void Revert(ChVehicleSimulation& sim) { swap(sim); }
+
+private:
+  void swap(ChVehicleSimulation& sim);
+
+  ChSharedPtr<ChVehicle> m_vehicle;   // inactive vehicle model
+};
+
+///
+/// Fixed-period execution of a vehicle simulation loop, on its own thread.
+///
+class CH_SUBSYS_API ChRealtimeScheduler : public ChThread
+{
+public:
+
+  /// Timed section for the output and rendering hooks (the other sections
+  /// are the modules, see ChVehicleSimulation::Module).
+  static const int HOOKS = ChVehicleSimulation::NUM_MODULES;
+  static const int NUM_SECTIONS = ChVehicleSimulation::NUM_MODULES + 1;
+
+  /// Any section (see AddDegradation()).
+  static const int ANY_SECTION = -1;
+
+  ChRealtimeScheduler(
+    ChVehicleSimulation& sim   ///< [in] simulation loop (all tires attached)
+    );
+
+  ~ChRealtimeScheduler() {}
+
+  /// Set the processor the scheduler thread is pinned to (default: -1, not
+  /// pinned). Must be called before Start().
+  void SetCpu(int cpu) { m_cpu = cpu; }
+
+  /// Set the real-time priority of the scheduler thread (default: 0, normal
+  /// priority). See ChThread::SetRealtimePriority(). Must be called before
+  /// Start().
+  void SetPriority(int priority) { m_priority = priority; }
+
+  /// Set the final part of each wait spent spinning instead of sleeping, to
+  /// release the steps on time despite the sleep granularity (default: 0.2 ms).
+  void SetSpinTime(double spin_time) { m_spin_time = spin_time; }
+
+  /// Set the wall clock budget of the specified section (a module or HOOKS)
+  /// per step (default: 0, no budget).
+  void SetBudget(int section, double budget) { m_budget[section] = budget; }
+
+  /// Append a degradation to the policy, optionally addressing the overruns
+  /// of the specified section. Must be called before Start().
+  void AddDegradation(
+    ChSharedPtr<ChRealtimeDegradation> degradation,          ///< [in] degradation
+    int                                section = ANY_SECTION ///< [in] section whose overruns it addresses
+    );
+
+  /// Set the number of consecutive missed deadlines that triggers the next
+  /// degradation (default: 3).
+  void SetEscalation(int num_misses) { m_escalation = num_misses; }
+
+  /// Revert the last applied degradation after the specified number of
+  /// consecutive steps using at most the specified fraction of the period
+  /// (default: 0 steps, i.e. degradations are never reverted).
+  void SetRecovery(int num_steps, double utilization) { m_recovery = num_steps; m_utilization = utilization; }
+
+  /// Set the simulation time at which the loop returns (default: run until
+  /// Stop() is called).
+  void SetEndTime(double end_time) { m_end_time = end_time; }
+
+  /// Request the loop to return (after the current step).
+  void Stop() { ChAtomicStore(&m_stop, 1); }
+
+  /// Statistics of the run (only valid once joined).
+  int GetNumSteps() const { return m_num_steps; }
+  int GetNumMisses() const { return m_num_misses; }
+  int GetNumOverruns(int section) const { return m_overruns[section]; }
+  int GetNumSlips() const { return m_num_slips; }
+  double GetMaxStepTime() const { return m_max_step_time; }
+  double GetMaxLateness() const { return m_max_lateness; }
+
+  /// Get the number of degradations applied (only valid once joined).
+  int GetLevel() const { return (int)m_applied.size(); }
+
+  /// Return true if the thread was pinned, and if it ran with real-time
+  /// priority, as requested (only valid once joined).
+  bool IsPinned() const { return m_pinned; }
+  bool IsRealtime() const { return m_realtime; }
+
+protected:
+
+  virtual void Run();
+
+private:
+
+  struct Degradation {
+    ChSharedPtr<ChRealtimeDegradation>  degradation;
+    int                                 section;
+    bool                                applied;
+  };
+
+  // Wait until the specified wall clock time.
+  void wait_until(double time) const;
+
+  // Apply the next degradation, preferably one addressing a section in the
+  // specified mask of overrun sections.
+  void escalate(int overrun_mask);
+
+  // Revert the last applied degradation.
+  void recover();
+
+  ChVehicleSimulation&      m_sim;
+
+  int                       m_cpu;
+  int                       m_priority;
+  double                    m_spin_time;
+  double                    m_budget[NUM_SECTIONS];
+  double                    m_end_time;
+
+  std::vector<Degradation>  m_degradations;
+  std::vector<int>          m_applied;       // indices of the applied degradations, in order
+  int                       m_escalation;
+  int                       m_recovery;
+  double                    m_utilization;
+
+  int                       m_num_steps;
+  int                       m_num_misses;
+  int                       m_overruns[NUM_SECTIONS];
+  int                       m_num_slips;
+  double                    m_max_step_time;
+  double                    m_max_lateness;
+  bool                      m_pinned;
+  bool                      m_realtime;
+
+  volatile size_t           m_stop;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
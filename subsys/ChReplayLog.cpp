@@ -0,0 +1,204 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Log of driver inputs and random seeds, for the bitwise replay of a run.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChReplayLog.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const char REPLAY_MAGIC[8] = {'C', 'H', 'R', 'P', 'L', '1', 0, 0};
+
+typedef unsigned int uint32;
+
+static bool compare_time(const ChDriverEntry& a, const ChDriverEntry& b) { return a.m_time < b.m_time; }
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChReplayLog::ChReplayLog()
+: m_mode(RECORD)
+{
+}
+
+void ChReplayLog::Clear()
+{
+  m_mode = RECORD;
+  m_seeds.clear();
+  m_vehicles.clear();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+unsigned int ChReplayLog::GetSeed(const std::string& name, unsigned int seed)
+{
+  for (size_t i = 0; i < m_seeds.size(); i++) {
+    if (m_seeds[i].name == name)
+      return m_seeds[i].value;
+  }
+
+  if (m_mode == REPLAY) {
+    GetLog() << "WARNING: no seed " << name.c_str() << " in the replay log\n";
+    return seed;
+  }
+
+  Seed s;
+  s.name = name;
+  s.value = seed;
+  m_seeds.push_back(s);
+
+  return seed;
+}
+
+void ChReplayLog::SetNumVehicles(int num_vehicles)
+{
+  if (num_vehicles > (int)m_vehicles.size())
+    m_vehicles.resize(num_vehicles);
+}
+
+// -----------------------------------------------------------------------------
+// The inputs are replayed in order, so the recorded entry is normally the one
+// at the cursor; otherwise (e.g. after a state was restored) it is searched
+// for by time. Times are compared exactly: the simulation loops compute the
+// time of a step from the step number.
+// -----------------------------------------------------------------------------
+void ChReplayLog::Apply(int vehicle, double time, double& steering, double& throttle, double& braking)
+{
+  Vehicle& v = m_vehicles[vehicle];
+
+  if (m_mode == RECORD) {
+    v.entries.push_back(ChDriverEntry(time, steering, throttle, braking));
+    return;
+  }
+
+  size_t n = v.entries.size();
+  if (v.cursor >= n || v.entries[v.cursor].m_time != time) {
+    v.cursor = std::lower_bound(v.entries.begin(), v.entries.end(), ChDriverEntry(time, 0, 0, 0), compare_time) -
+               v.entries.begin();
+    if (v.cursor >= n || v.entries[v.cursor].m_time != time) {
+      v.num_mismatches++;
+      return;
+    }
+  }
+
+  const ChDriverEntry& e = v.entries[v.cursor++];
+  steering = e.m_steering;
+  throttle = e.m_throttle;
+  braking = e.m_braking;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChReplayLog::Write(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  uint32 header[2] = {(uint32)m_seeds.size(), (uint32)m_vehicles.size()};
+  bool ok = fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), fp) == sizeof(REPLAY_MAGIC) &&
+            fwrite(header, sizeof(uint32), 2, fp) == 2;
+
+  for (size_t i = 0; ok && i < m_seeds.size(); i++) {
+    uint32 len = (uint32)m_seeds[i].name.size();
+    uint32 value = (uint32)m_seeds[i].value;
+    ok = fwrite(&len, sizeof(uint32), 1, fp) == 1 &&
+         fwrite(m_seeds[i].name.data(), 1, len, fp) == len &&
+         fwrite(&value, sizeof(uint32), 1, fp) == 1;
+  }
+
+  for (size_t i = 0; ok && i < m_vehicles.size(); i++) {
+    const std::vector<ChDriverEntry>& entries = m_vehicles[i].entries;
+    uint32 count = (uint32)entries.size();
+    ok = fwrite(&count, sizeof(uint32), 1, fp) == 1;
+    if (ok && count > 0)
+      ok = fwrite(&entries[0], sizeof(ChDriverEntry), count, fp) == count;
+  }
+
+  if (fclose(fp) != 0)
+    ok = false;
+
+  if (!ok)
+    GetLog() << "ERROR: cannot write " << filename.c_str() << "\n";
+
+  return ok;
+}
+
+bool ChReplayLog::Load(const std::string& filename)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open replay log " << filename.c_str() << "\n";
+    return false;
+  }
+
+  char magic[8];
+  uint32 header[2];
+  bool ok = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+            std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) == 0 &&
+            fread(header, sizeof(uint32), 2, fp) == 2;
+
+  std::vector<Seed> seeds(ok ? header[0] : 0);
+  std::vector<Vehicle> vehicles(ok ? header[1] : 0);
+
+  for (size_t i = 0; ok && i < seeds.size(); i++) {
+    uint32 len = 0;
+    ok = fread(&len, sizeof(uint32), 1, fp) == 1 && len < 4096;
+    if (ok) {
+      std::vector<char> name(len + 1, 0);
+      ok = fread(&name[0], 1, len, fp) == len &&
+           fread(&seeds[i].value, sizeof(uint32), 1, fp) == 1;
+      seeds[i].name = &name[0];
+    }
+  }
+
+  for (size_t i = 0; ok && i < vehicles.size(); i++) {
+    uint32 count = 0;
+    ok = fread(&count, sizeof(uint32), 1, fp) == 1;
+    if (ok && count > 0) {
+      vehicles[i].entries.resize(count);
+      ok = fread(&vehicles[i].entries[0], sizeof(ChDriverEntry), count, fp) == count;
+    }
+  }
+
+  fclose(fp);
+
+  if (!ok) {
+    GetLog() << "ERROR: invalid replay log " << filename.c_str() << "\n";
+    return false;
+  }
+
+  m_mode = REPLAY;
+  m_seeds.swap(seeds);
+  m_vehicles.swap(vehicles);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
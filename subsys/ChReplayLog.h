@@ -0,0 +1,141 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Log of the non-reproducible inputs of a simulation (driver inputs, e.g. from
+// a GUI or a stream, and random seeds), from which a run can be replayed
+// bitwise.
+//
+// While recording, the simulation loop (ChVehicleSimulation or
+// ChFleetSimulation) passes the driver inputs of each vehicle, at each step,
+// through Apply(), which stores them; while replaying, Apply() overwrites them
+// with the recorded values for the same vehicle and time. Random seeds are
+// obtained through GetSeed(), which stores the proposed seed while recording
+// and returns the recorded one while replaying.
+//
+// The log is written as a binary file, in the native byte order:
+//   magic "CHRPL1\0\0"      (8 bytes)
+//   number of seeds         (uint32)
+//   number of vehicles      (uint32)
+//   seeds, each one holding the name length (uint32), the name characters
+//   and the seed (uint32)
+//   vehicles, each one holding the number of entries (uint32) and the
+//   entries (time, steering, throttle, braking: double)
+//
+// A replay reproduces the recorded run bitwise only if the model and the
+// simulation settings are the same, and the parallel engines run in
+// deterministic mode (see ChFleetSimulation::SetDeterministic()).
+//
+// =============================================================================
+
+#ifndef CH_REPLAY_LOG_H
+#define CH_REPLAY_LOG_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/driver/ChDriverTrace.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Log of driver inputs and random seeds, for the bitwise replay of a run.
+///
+class CH_SUBSYS_API ChReplayLog
+{
+public:
+
+  enum Mode {
+    RECORD,   ///< store the inputs passed to Apply() and the seeds passed to GetSeed()
+    REPLAY    ///< substitute the recorded inputs and seeds
+  };
+
+  /// Create an empty log, in RECORD mode.
+  ChReplayLog();
+
+  ~ChReplayLog() {}
+
+  /// Get the current mode.
+  Mode GetMode() const { return m_mode; }
+
+  /// Discard all recorded data and start recording.
+  void Clear();
+
+  /// Load a log written by Write() and switch to REPLAY mode.
+  /// Returns false (and leaves the log unchanged) if the file cannot be read.
+  bool Load(const std::string& filename);
+
+  /// Write the recorded data to the specified file.
+  /// Returns false if the file cannot be written.
+  bool Write(const std::string& filename) const;
+
+  /// Get the seed with the specified name. While recording, the proposed seed
+  /// is stored and returned; while replaying, the recorded seed is returned
+  /// (or the proposed one, with a warning, if there is none).
+  unsigned int GetSeed(const std::string& name, unsigned int seed);
+
+  /// Make room for the inputs of the specified number of vehicles. Must be
+  /// called (by a single thread) before Apply() is used for these vehicles;
+  /// Apply() may then be called concurrently for different vehicles.
+  void SetNumVehicles(int num_vehicles);
+
+  /// Get the number of vehicles in the log.
+  int GetNumVehicles() const { return (int)m_vehicles.size(); }
+
+  /// Record the driver inputs of the specified vehicle at the specified time
+  /// or, while replaying, replace them with the recorded ones. If no inputs
+  /// were recorded at that time, the inputs are left unchanged and the
+  /// mismatch is counted.
+  void Apply(
+    int     vehicle,    ///< [in] index of the vehicle
+    double  time,       ///< [in] current time
+    double& steering,   ///< [in,out] steering input
+    double& throttle,   ///< [in,out] throttle input
+    double& braking     ///< [in,out] braking input
+    );
+
+  /// Get the inputs recorded for the specified vehicle.
+  const std::vector<ChDriverEntry>& GetInputs(int vehicle) const { return m_vehicles[vehicle].entries; }
+
+  /// Get the number of Apply() calls of the specified vehicle that found no
+  /// recorded inputs (while replaying).
+  int GetNumMismatches(int vehicle) const { return m_vehicles[vehicle].num_mismatches; }
+
+private:
+
+  struct Seed {
+    std::string   name;
+    unsigned int  value;
+  };
+
+  struct Vehicle {
+    Vehicle() : cursor(0), num_mismatches(0) {}
+    std::vector<ChDriverEntry>  entries;
+    size_t                      cursor;           // next entry to replay
+    int                         num_mismatches;
+  };
+
+  Mode                  m_mode;
+  std::vector<Seed>     m_seeds;
+  std::vector<Vehicle>  m_vehicles;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
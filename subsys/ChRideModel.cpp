@@ -0,0 +1,455 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quarter-car and half-car ride models derived from a vehicle JSON
+// specification file.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChRideModel.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+#include "subsys/ChVehicleModelData.h"
+
+using namespace rapidjson;
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const double RIDE_GRAVITY = 9.81;
+
+// Wheel radius if the wheel file does not specify one; it only sets the ride
+// height, not the dynamics.
+static const double RIDE_WHEEL_RADIUS = 0.4;
+
+// Static equilibrium: relaxation step, damping (1/s), longest relaxation and
+// velocity tolerance.
+static const double RIDE_SETTLE_STEP = 1e-3;
+static const double RIDE_SETTLE_DAMPING = 20;
+static const double RIDE_SETTLE_TIME = 20;
+static const double RIDE_SETTLE_TOL = 1e-6;
+
+// Installation ratio (change of element length per unit of wheel travel) of an
+// element between C (chassis) and A (arm), with the arm rotating about the
+// axis through 'pivot' along 'axis' and the wheel following the point W.
+static bool RIDE_armRatio(const ChVector<>& C, const ChVector<>& A, const ChVector<>& pivot, const ChVector<>& axis,
+                          const ChVector<>& W, double& ratio)
+{
+  ChVector<> dir = A - C;
+  ChVector<> vA = Vcross(axis, A - pivot);
+  ChVector<> vW = Vcross(axis, W - pivot);
+  if (dir.Length() == 0 || std::abs(vW.z) < 1e-9 * (W - pivot).Length())
+    return false;
+
+  ratio = (vA ^ dir) / (dir.Length() * vW.z);
+  return true;
+}
+
+// Installation ratio of an element between C (chassis) and A, with A moving
+// with the wheel.
+static bool RIDE_axleRatio(const ChVector<>& C, const ChVector<>& A, double& ratio)
+{
+  ChVector<> dir = A - C;
+  if (dir.Length() == 0)
+    return false;
+
+  ratio = dir.z / dir.Length();
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRideModel::ChRideModel()
+: m_tire_stiffness(300e3),
+  m_tire_damping(500),
+  m_sprung_mass(0),
+  m_pitch_inertia(0),
+  m_terrain(0),
+  m_time(0),
+  m_x(0),
+  m_y(0),
+  m_speed(0),
+  m_z(0),
+  m_vz(0),
+  m_z_acc(0),
+  m_z_rest(0),
+  m_pitch(0),
+  m_pitch_rate(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// The arms and links are split evenly between the sprung and unsprung masses;
+// the masses in the suspension files are those of one side.
+// -----------------------------------------------------------------------------
+bool ChRideModel::load_corner(const std::string& susp_file, const std::string& wheel_file, Corner& corner,
+                              double& sprung)
+{
+  const Document& d = ChJsonCache::Get(susp_file);
+  if (!d.IsObject() || !d.HasMember("Template") || !d.HasMember("Spring") || !d.HasMember("Shock")) {
+    GetLog() << "ERROR: cannot load suspension " << susp_file.c_str() << "\n";
+    return false;
+  }
+  std::string templ = d["Template"].GetString();
+
+  corner.unsprung_mass = 0;
+  sprung = 0;
+  for (Value::ConstMemberIterator it = d.MemberBegin(); it != d.MemberEnd(); ++it) {
+    if (!it->value.IsObject() || !it->value.HasMember("Mass"))
+      continue;
+    const char* name = it->name.GetString();
+    double mass = it->value["Mass"].GetDouble();
+    if (!strcmp(name, "Spindle") || !strcmp(name, "Upright") || !strcmp(name, "Knuckle")) {
+      corner.unsprung_mass += mass;
+    } else if (!strcmp(name, "Axle Tube")) {
+      corner.unsprung_mass += mass / 2;
+    } else {
+      corner.unsprung_mass += mass / 2;
+      sprung += mass / 2;
+    }
+  }
+
+  const Value& spring = d["Spring"];
+  const Value& shock = d["Shock"];
+  ChVector<> spring_C = loadVector(spring["Location Chassis"]);
+  ChVector<> shock_C = loadVector(shock["Location Chassis"]);
+  ChVector<> spring_A;
+  ChVector<> shock_A;
+  bool ok = false;
+
+  if (templ == "DoubleWishbone") {
+    spring_A = loadVector(spring["Location Arm"]);
+    shock_A = loadVector(shock["Location Arm"]);
+    const Value& lca = d["Lower Control Arm"];
+    ChVector<> front = loadVector(lca["Location Chassis Front"]);
+    ChVector<> axis = loadVector(lca["Location Chassis Back"]) - front;
+    axis.Normalize();
+    ChVector<> W = loadVector(lca["Location Upright"]);
+    ok = RIDE_armRatio(spring_C, spring_A, front, axis, W, corner.spring_ratio) &&
+         RIDE_armRatio(shock_C, shock_A, front, axis, W, corner.shock_ratio);
+  } else if (templ == "MultiLink") {
+    spring_A = loadVector(spring["Location Link"]);
+    shock_A = loadVector(shock["Location Link"]);
+    const Value& link = d["Trailing Link"];
+    ChVector<> pivot = loadVector(link["Location Chassis"]);
+    ChVector<> W = loadVector(link["Location Upright"]);
+    ChVector<> axis = Vcross(W - pivot, VECT_Z);
+    axis.Normalize();
+    ok = RIDE_armRatio(spring_C, spring_A, pivot, axis, W, corner.spring_ratio) &&
+         RIDE_armRatio(shock_C, shock_A, pivot, axis, W, corner.shock_ratio);
+  } else if (templ == "SolidAxle") {
+    spring_A = loadVector(spring["Location Axle"]);
+    shock_A = loadVector(shock["Location Axle"]);
+    ok = RIDE_axleRatio(spring_C, spring_A, corner.spring_ratio) && RIDE_axleRatio(shock_C, shock_A, corner.shock_ratio);
+  } else if (templ == "DoubleWishboneReduced") {
+    // the spring and the shock are one element, on the upright
+    spring_C = shock_C;
+    spring_A = shock_A = loadVector(shock["Location Arm"]);
+    ok = RIDE_axleRatio(shock_C, shock_A, corner.shock_ratio);
+    corner.spring_ratio = corner.shock_ratio;
+  } else {
+    GetLog() << "ERROR: suspension template " << templ.c_str() << " not supported by the ride model\n";
+    return false;
+  }
+
+  if (!ok) {
+    GetLog() << "ERROR: degenerate spring or shock geometry in " << susp_file.c_str() << "\n";
+    return false;
+  }
+
+  corner.spring_length = (spring_A - spring_C).Length();
+  corner.shock_length = (shock_A - shock_C).Length();
+  corner.spring_coefficient = 0;
+  corner.damping_coefficient = 0;
+  corner.spring_free_length = spring.HasMember("Free Length") ? spring["Free Length"].GetDouble() : 0;
+  if (spring.HasMember("Curve"))
+    corner.spring_curve = ChForceCurve::Load(GetDataFile(spring["Curve"].GetString()));
+  else
+    corner.spring_coefficient = spring["Spring Coefficient"].GetDouble();
+  if (shock.HasMember("Curve"))
+    corner.shock_curve = ChForceCurve::Load(GetDataFile(shock["Curve"].GetString()));
+  else
+    corner.damping_coefficient = shock["Damping Coefficient"].GetDouble();
+  if ((spring.HasMember("Curve") && corner.spring_curve.IsNull()) ||
+      (shock.HasMember("Curve") && corner.shock_curve.IsNull()))
+    return false;
+
+  corner.wheel_radius = RIDE_WHEEL_RADIUS;
+  const Document& w = ChJsonCache::Get(wheel_file);
+  if (w.IsObject()) {
+    if (w.HasMember("Mass"))
+      corner.unsprung_mass += w["Mass"].GetDouble();
+    if (w.HasMember("Visualization") && w["Visualization"].HasMember("Radius"))
+      corner.wheel_radius = w["Visualization"]["Radius"].GetDouble();
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// The sprung mass carried by each axle at rest is that of a rigid body on the
+// wheel rates in series with the tires (the lever rule for two axles).
+// -----------------------------------------------------------------------------
+bool ChRideModel::Load(const std::string& filename, Type type, int axle)
+{
+  m_corners.clear();
+  m_sprung_mass = 0;
+  m_pitch_inertia = 0;
+
+  const Document& d = ChJsonCache::Get(filename);
+  if (!d.IsObject() || !d.HasMember("Chassis") || !d.HasMember("Axles") || !d["Axles"].IsArray()) {
+    GetLog() << "ERROR: cannot load vehicle " << filename.c_str() << "\n";
+    return false;
+  }
+
+  ChVector<> com = loadVector(d["Chassis"]["COM"]);
+  double chassis_mass = d["Chassis"]["Mass"].GetDouble();
+  double sprung = chassis_mass / 2;
+
+  const Value& axles = d["Axles"];
+  int num_axles = (int)axles.Size();
+  if (type == QUARTER_CAR && (axle < 0 || axle >= num_axles)) {
+    GetLog() << "ERROR: vehicle " << filename.c_str() << " has no axle " << axle << "\n";
+    return false;
+  }
+
+  std::vector<Corner> corners(num_axles);
+  for (int i = 0; i < num_axles; i++) {
+    Corner& corner = corners[i];
+    double arms;
+    if (!load_corner(GetDataFile(axles[i]["Suspension Input File"].GetString()),
+                     GetDataFile(axles[i]["Left Wheel Input File"].GetString()), corner, arms))
+      return false;
+    sprung += arms;
+
+    const Document& s = ChJsonCache::Get(GetDataFile(axles[i]["Suspension Input File"].GetString()));
+    ChVector<> wheel = loadVector(axles[i]["Suspension Location"]) + loadVector(s["Spindle"]["COM"]);
+    corner.offset = wheel.x - com.x;
+    corner.wheel_height = wheel.z - com.z;
+  }
+
+  if (type == HALF_CAR) {
+    m_corners = corners;
+    m_sprung_mass = sprung;
+    m_pitch_inertia = loadVector(d["Chassis"]["Inertia"]).y / 2;
+  } else {
+    double share = 1;
+    if (num_axles > 1) {
+      double A = 0, B = 0, C = 0;
+      std::vector<double> k(num_axles);
+      for (int i = 0; i < num_axles; i++) {
+        double kw = wheel_rate(corners[i]);
+        k[i] = kw * m_tire_stiffness / (kw + m_tire_stiffness);
+        A += k[i];
+        B += k[i] * corners[i].offset;
+        C += k[i] * corners[i].offset * corners[i].offset;
+      }
+      // deflection u - offset * phi under a unit load
+      double det = B * B - A * C;
+      double u = -C / det;
+      double phi = -B / det;
+      share = k[axle] * (u - corners[axle].offset * phi);
+    }
+    m_corners.assign(1, corners[axle]);
+    m_corners[0].offset = 0;
+    m_sprung_mass = share * sprung;
+  }
+
+  m_wheel_acc.resize(m_corners.size());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChRideModel::wheel_rate(const Corner& c)
+{
+  double rate = c.spring_coefficient;
+  if (!c.spring_curve.IsNull()) {
+    double dl = 1e-3;
+    rate = -(c.spring_curve->Evaluate(c.spring_length + dl, 0) - c.spring_curve->Evaluate(c.spring_length - dl, 0)) /
+           (2 * dl);
+  }
+
+  return rate * c.spring_ratio * c.spring_ratio;
+}
+
+double ChRideModel::wheel_damping(const Corner& c)
+{
+  double rate = c.damping_coefficient;
+  if (!c.shock_curve.IsNull()) {
+    double dv = 1e-3;
+    rate = -(c.shock_curve->Evaluate(c.shock_length, dv) - c.shock_curve->Evaluate(c.shock_length, -dv)) / (2 * dv);
+  }
+
+  return rate * c.shock_ratio * c.shock_ratio;
+}
+
+// The element forces are positive when pushing the ends apart (see
+// ChLinearSpringLaw); through the installation ratios, they push the wheel
+// down in jounce.
+double ChRideModel::suspension_force(const Corner& c, double travel, double travel_vel)
+{
+  double spring_len = c.spring_length + c.spring_ratio * travel;
+  double spring_vel = c.spring_ratio * travel_vel;
+  double spring = c.spring_curve.IsNull() ? -c.spring_coefficient * (spring_len - c.spring_free_length)
+                                          : c.spring_curve->Evaluate(spring_len, spring_vel);
+
+  double shock_len = c.shock_length + c.shock_ratio * travel;
+  double shock_vel = c.shock_ratio * travel_vel;
+  double shock = c.shock_curve.IsNull() ? -c.damping_coefficient * shock_vel
+                                        : c.shock_curve->Evaluate(shock_len, shock_vel);
+
+  return spring * c.spring_ratio + shock * c.shock_ratio;
+}
+
+// -----------------------------------------------------------------------------
+// The wheels start at the design position relative to the sprung mass, high
+// enough that no tire penetrates the terrain, and the model is relaxed to rest
+// (with additional damping) before the time starts.
+// -----------------------------------------------------------------------------
+void ChRideModel::Initialize(const ChTerrain& terrain, double x, double y, double speed)
+{
+  m_terrain = &terrain;
+  m_time = 0;
+  m_x = x;
+  m_y = y;
+  m_speed = 0;
+
+  m_z = -1e30;
+  for (size_t i = 0; i < m_corners.size(); i++) {
+    Corner& c = m_corners[i];
+    c.height = terrain.GetHeight(m_x + c.offset, m_y);
+    c.height_vel = 0;
+    m_z = std::max(m_z, c.height + c.wheel_radius - c.wheel_height);
+  }
+  m_vz = 0;
+  m_pitch = 0;
+  m_pitch_rate = 0;
+  for (size_t i = 0; i < m_corners.size(); i++) {
+    Corner& c = m_corners[i];
+    c.z = m_z + c.wheel_height;
+    c.vz = 0;
+  }
+
+  for (double t = 0; t < RIDE_SETTLE_TIME; t += RIDE_SETTLE_STEP) {
+    step(RIDE_SETTLE_STEP, RIDE_SETTLE_DAMPING);
+    double vel = std::abs(m_vz) + std::abs(m_pitch_rate);
+    for (size_t i = 0; i < m_corners.size(); i++)
+      vel += std::abs(m_corners[i].vz);
+    if (vel < RIDE_SETTLE_TOL)
+      break;
+  }
+
+  m_z_rest = m_z;
+  m_speed = speed;
+
+  double acc_pitch;
+  evaluate(0, m_z_acc, acc_pitch);
+}
+
+void ChRideModel::Advance(double step_size)
+{
+  step(step_size, 0);
+  m_time += step_size;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRideModel::evaluate(double damping, double& acc_z, double& acc_pitch)
+{
+  double force = 0;
+  double moment = 0;
+
+  for (size_t i = 0; i < m_corners.size(); i++) {
+    Corner& c = m_corners[i];
+    double chassis_z = m_z - c.offset * m_pitch;
+    double chassis_vz = m_vz - c.offset * m_pitch_rate;
+    c.travel = c.z - (chassis_z + c.wheel_height);
+    double susp = suspension_force(c, c.travel, c.vz - chassis_vz);
+
+    double deflection = c.height + c.wheel_radius - c.z;
+    c.tire_force = 0;
+    if (deflection > 0)
+      c.tire_force = std::max(0.0, m_tire_stiffness * deflection + m_tire_damping * (c.height_vel - c.vz));
+
+    m_wheel_acc[i] = (susp + c.tire_force) / c.unsprung_mass - RIDE_GRAVITY - damping * c.vz;
+    force -= susp;
+    moment += susp * c.offset;
+  }
+
+  acc_z = force / m_sprung_mass - RIDE_GRAVITY - damping * m_vz;
+  acc_pitch = (m_pitch_inertia > 0) ? moment / m_pitch_inertia - damping * m_pitch_rate : 0;
+}
+
+void ChRideModel::step(double h, double damping)
+{
+  double acc_pitch;
+  evaluate(damping, m_z_acc, acc_pitch);
+
+  m_vz += h * m_z_acc;
+  m_z += h * m_vz;
+  m_pitch_rate += h * acc_pitch;
+  m_pitch += h * m_pitch_rate;
+
+  m_x += h * m_speed;
+
+  for (size_t i = 0; i < m_corners.size(); i++) {
+    Corner& c = m_corners[i];
+    c.vz += h * m_wheel_acc[i];
+    c.z += h * c.vz;
+
+    double height = m_terrain->GetHeight(m_x + c.offset, m_y);
+    c.height_vel = (height - c.height) / h;
+    c.height = height;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+std::string ChRideModel::GetSignalName(int signal) const
+{
+  if (signal == 0)
+    return "heave_accel";
+  if (signal == 1)
+    return "pitch";
+
+  char name[32];
+  sprintf(name, "%s_%d", (signal % 2 == 0) ? "travel" : "tire_force", (signal - 2) / 2);
+  return name;
+}
+
+void ChRideModel::GetSignals(double* values) const
+{
+  values[0] = m_z_acc;
+  values[1] = m_pitch;
+  for (size_t i = 0; i < m_corners.size(); i++) {
+    values[2 + 2 * i] = m_corners[i].travel;
+    values[3 + 2 * i] = m_corners[i].tire_force;
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
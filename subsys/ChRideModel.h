@@ -0,0 +1,216 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quarter-car and half-car ride models derived from a vehicle JSON
+// specification file, for ride studies over long road profiles.
+//
+// The model is derived from the same files as the full vehicle (Vehicle):
+//   - the sprung mass is the chassis, plus half of the suspension arms and
+//     links; the unsprung mass of a corner is the wheel, the spindle, the
+//     upright (or knuckle), half of the axle tube and half of the arms;
+//   - the spring and shock of each corner act on the suspension travel
+//     through their installation ratio (change of element length per unit of
+//     wheel travel), computed at the design position: the arm carrying the
+//     element rotates about its chassis axis (DoubleWishbone, MultiLink) and
+//     the upright moves with the lower ball joint, or the element is attached
+//     to a translating axle or upright (SolidAxle, DoubleWishboneReduced);
+//   - spring and shock curves (see ChForceCurve) are evaluated at the element
+//     length and velocity, so the model keeps their nonlinearity.
+// The tire is a point follower: a vertical spring-damper (no tension) below
+// the wheel center, on the terrain height under it.
+//
+// A half car is the pitch-plane model: one side of the vehicle, with all
+// axles, and the sprung mass in heave and pitch (small angles). A quarter car
+// is one corner of the specified axle, with the part of the sprung mass it
+// carries at rest. The model travels along the x axis at constant speed.
+//
+// The equations are integrated with a fixed-step semi-implicit Euler scheme
+// over a few scalar states, with no allocation in Advance(). The outputs (see
+// GetSignals()) can be fed to a ChKpiMonitor, with the KPIs of the full model:
+//
+//   for (int i = 0; i < model.GetNumSignals(); i++)
+//     monitor.AddKpi(model.GetSignalName(i));
+//   ...
+//   model.Advance(step);
+//   model.GetSignals(values);
+//   monitor.Update(model.GetTime(), values);
+//
+// =============================================================================
+
+#ifndef CH_RIDE_MODEL_H
+#define CH_RIDE_MODEL_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/suspension/ChForceCurve.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Quarter-car or half-car ride model of a vehicle.
+///
+class CH_SUBSYS_API ChRideModel
+{
+public:
+
+  enum Type {
+    QUARTER_CAR,   ///< one corner of one axle
+    HALF_CAR       ///< one side of the vehicle, with heave and pitch
+  };
+
+  ChRideModel();
+
+  /// Derive the model from the specified vehicle JSON file (and the files of
+  /// its suspensions and wheels).
+  /// Returns false (with an error) if a file cannot be loaded or a suspension
+  /// template is not supported.
+  bool Load(
+    const std::string& filename,    ///< [in] vehicle JSON specification file
+    Type               type,        ///< [in] quarter car or half car
+    int                axle = 0     ///< [in] axle of the quarter car
+    );
+
+  /// Set the vertical stiffness and damping of the tires (default: 300 kN/m
+  /// and 500 N s/m).
+  void SetTireStiffness(double stiffness) { m_tire_stiffness = stiffness; }
+  void SetTireDamping(double damping) { m_tire_damping = damping; }
+
+  /// Place the model on the specified terrain, with the sprung mass center at
+  /// the specified location, moving along the x axis at the specified speed,
+  /// and bring it to rest on the terrain (static equilibrium).
+  /// The terrain must stay valid while the model is used.
+  void Initialize(
+    const ChTerrain& terrain,   ///< [in] terrain under the model
+    double           x,         ///< [in] initial x location of the sprung mass center
+    double           y,         ///< [in] y location of the tire path
+    double           speed      ///< [in] forward speed
+    );
+
+  /// Advance the model by the specified step.
+  void Advance(double step);
+
+  /// Get the current time (0 at initialization).
+  double GetTime() const { return m_time; }
+
+  /// Get the x location of the sprung mass center.
+  double GetPosition() const { return m_x; }
+
+  /// Get the number of axles of the model (1 for a quarter car).
+  int GetNumAxles() const { return (int)m_corners.size(); }
+
+  /// Parameters of the derived model.
+  double GetSprungMass() const { return m_sprung_mass; }
+  double GetPitchInertia() const { return m_pitch_inertia; }
+  double GetUnsprungMass(int axle) const { return m_corners[axle].unsprung_mass; }
+  double GetSpringRatio(int axle) const { return m_corners[axle].spring_ratio; }
+  double GetShockRatio(int axle) const { return m_corners[axle].shock_ratio; }
+
+  /// Get the wheel rate and the wheel damping rate of the specified axle at
+  /// the design position (element rate times the square of its installation
+  /// ratio).
+  double GetWheelRate(int axle) const { return wheel_rate(m_corners[axle]); }
+  double GetWheelDamping(int axle) const { return wheel_damping(m_corners[axle]); }
+
+  /// Get the vertical displacement and acceleration of the sprung mass center
+  /// from the position at rest, and the pitch angle (positive nose down).
+  double GetHeave() const { return m_z - m_z_rest; }
+  double GetHeaveAccel() const { return m_z_acc; }
+  double GetPitch() const { return m_pitch; }
+
+  /// Get the suspension travel of the specified axle (positive in jounce),
+  /// from the design position, and the vertical tire force.
+  double GetTravel(int axle) const { return m_corners[axle].travel; }
+  double GetTireForce(int axle) const { return m_corners[axle].tire_force; }
+
+  /// Output signals: heave acceleration, pitch angle, then the travel and the
+  /// tire force of each axle.
+  int GetNumSignals() const { return 2 + 2 * (int)m_corners.size(); }
+  std::string GetSignalName(int signal) const;
+  void GetSignals(double* values) const;
+
+private:
+
+  struct Corner {
+    double  offset;            // x offset from the sprung mass center
+    double  unsprung_mass;
+    double  wheel_radius;
+    double  wheel_height;      // design height of the wheel center above the sprung mass center
+
+    ChSharedPtr<ChForceCurve>  spring_curve;
+    double  spring_coefficient;
+    double  spring_free_length;
+    double  spring_length;     // at design position
+    double  spring_ratio;
+
+    ChSharedPtr<ChForceCurve>  shock_curve;
+    double  damping_coefficient;
+    double  shock_length;      // at design position
+    double  shock_ratio;
+
+    double  z;                 // wheel center height
+    double  vz;
+    double  height;            // terrain height under the wheel center
+    double  height_vel;        // rate of change of the terrain height (from the last step)
+    double  travel;
+    double  tire_force;
+  };
+
+  // Load the specified corner from its suspension and wheel files.
+  bool load_corner(const std::string& susp_file, const std::string& wheel_file, Corner& corner, double& sprung);
+
+  // Linearized wheel rate and wheel damping rate at the design position.
+  static double wheel_rate(const Corner& corner);
+  static double wheel_damping(const Corner& corner);
+
+  // Suspension force on the wheel (positive up) at the specified travel.
+  static double suspension_force(const Corner& corner, double travel, double travel_vel);
+
+  // Accelerations of the sprung mass (heave, pitch) and of the wheels, with
+  // the specified additional damping of all states.
+  void evaluate(double damping, double& acc_z, double& acc_pitch);
+
+  void step(double h, double damping);
+
+  double               m_tire_stiffness;
+  double               m_tire_damping;
+
+  double               m_sprung_mass;
+  double               m_pitch_inertia;    // 0 for a quarter car
+  std::vector<Corner>  m_corners;
+  std::vector<double>  m_wheel_acc;
+
+  const ChTerrain*     m_terrain;
+  double               m_time;
+  double               m_x;
+  double               m_y;
+  double               m_speed;
+  double               m_z;                // sprung mass center height
+  double               m_vz;
+  double               m_z_acc;
+  double               m_z_rest;
+  double               m_pitch;
+  double               m_pitch_rate;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,161 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Cache of settled (static equilibrium) initial states of vehicles.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/ChSettleCache.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChContentHash.h"
+#include "subsys/ChMappedFile.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSettleCache::ChSettleCache(const std::string& dir)
+: m_dir(dir),
+  m_max_time(3),
+  m_speed_tol(1e-3),
+  m_damping(0.01)
+{
+}
+
+void ChSettleCache::SetSettleParameters(double max_time, double speed_tol, double damping)
+{
+  m_max_time = max_time;
+  m_speed_tol = speed_tol;
+  m_damping = damping;
+}
+
+std::string ChSettleCache::GetKey(const std::string& vehicle_file,
+                                  const std::string& tire_terrain,
+                                  const ChCoordsys<>& init_pos)
+{
+  ChContentHash hash;
+
+  hash.AddFile(vehicle_file);
+  hash.Add(tire_terrain);
+
+  double pos[7] = {init_pos.pos.x, init_pos.pos.y, init_pos.pos.z,
+                   init_pos.rot.e0, init_pos.rot.e1, init_pos.rot.e2, init_pos.rot.e3};
+  hash.Add(pos, sizeof(pos));
+
+  return hash.GetKey();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChSettleCache::Load(const std::string& key, ChVehicle& vehicle) const
+{
+  ChVehicleState state;
+  if (!state.ReadFile(GetFile(key)))
+    return false;
+
+  // Restore the state at the current time of the vehicle.
+  double time = vehicle.GetSystem()->GetChTime();
+  bool ok = vehicle.RestoreState(state) && state.AtEnd();
+  vehicle.GetSystem()->SetChTime(time);
+
+  return ok;
+}
+
+bool ChSettleCache::LoadOrSettle(const std::string& key, ChVehicle& vehicle, std::vector<ChSharedPtr<ChTire> >& tires) const
+{
+  return Load(key, vehicle) || Settle(key, vehicle, tires);
+}
+
+// -----------------------------------------------------------------------------
+// Damped fast-forward, following the simulation loop of the demos. The state
+// is written to a temporary file first, so that concurrent runs settling the
+// same configuration never read a partial file.
+// -----------------------------------------------------------------------------
+bool ChSettleCache::Settle(const std::string& key, ChVehicle& vehicle, std::vector<ChSharedPtr<ChTire> >& tires) const
+{
+  ChSystem* system = vehicle.GetSystem();
+  int num_wheels = (int)tires.size();
+  double step = vehicle.GetStepsize();
+  double start_time = system->GetChTime();
+  double time = start_time;
+  bool settled = false;
+
+  ChWheelStates wheel_states;
+  ChTireForces tire_forces;
+  wheel_states.resize(num_wheels);
+  tire_forces.resize(num_wheels);
+
+  while (!settled && time - start_time < m_max_time) {
+    vehicle.GetWheelStates(wheel_states);
+    for (int i = 0; i < num_wheels; i++) {
+      tires[i]->Update(time, wheel_states[i]);
+      tire_forces[i] = tires[i]->GetTireForce();
+    }
+
+    vehicle.Update(time, 0, 1, 0, tire_forces);
+
+    for (int i = 0; i < num_wheels; i++)
+      tires[i]->Advance(step);
+    vehicle.Advance(step);
+    time += step;
+
+    double max_speed = 0;
+    std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+    for (; ibody != system->Get_bodylist()->end(); ++ibody) {
+      if ((*ibody)->GetBodyFixed())
+        continue;
+      ChVector<> vel = (*ibody)->GetPos_dt() * (1 - m_damping);
+      (*ibody)->SetPos_dt(vel);
+      (*ibody)->SetWvel_par((*ibody)->GetWvel_par() * (1 - m_damping));
+      max_speed = std::max(max_speed, vel.Length());
+    }
+
+    settled = max_speed < m_speed_tol;
+  }
+
+  system->SetChTime(start_time);
+
+  if (!settled) {
+    GetContextLog() << "WARNING: vehicle did not settle in " << m_max_time << " s\n";
+    return false;
+  }
+
+  ChVehicleState state;
+  vehicle.SaveState(state);
+
+  // The temporary file name is unique per node, process and thread.
+  std::string filename = GetFile(key);
+  std::string tmp_filename = filename + ChTempFileSuffix(&state);
+
+  if (!state.WriteFile(tmp_filename)) {
+    GetContextLog() << "WARNING: cannot write settled state " << tmp_filename.c_str() << "\n";
+    return true;
+  }
+
+  ChReplaceFile(tmp_filename, filename);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
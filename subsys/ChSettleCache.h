@@ -0,0 +1,108 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Cache of settled (static equilibrium) initial states of vehicles.
+//
+// A vehicle initialized above the ground first drops onto its tires and
+// oscillates on its suspensions until it comes to rest. Settle() computes this
+// rest state once, by a damped fast-forward of the vehicle and its tires (no
+// steering, full braking, no powertrain torque), with the body velocities
+// scaled down after each step so that the oscillations die out quickly. The
+// settled vehicle state is stored as a ChVehicleState file in the cache
+// directory, named after a key computed from the vehicle specification (the
+// contents of the vehicle JSON file and of all the files it references, as
+// seen through ChJsonCache), a description of the tire and terrain models, and
+// the initial chassis position. Later runs with the same key restore the
+// settled state directly.
+//
+// The key does not capture tire or terrain parameters beyond their
+// description; include them (e.g. the tire file name) in that description.
+//
+// =============================================================================
+
+#ifndef CH_SETTLE_CACHE_H
+#define CH_SETTLE_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChCoordsys.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChTire.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of settled vehicle states.
+///
+class CH_SUBSYS_API ChSettleCache
+{
+public:
+
+  /// Create a cache storing the settled states in the specified (existing)
+  /// directory.
+  ChSettleCache(const std::string& dir);
+
+  ~ChSettleCache() {}
+
+  /// Set the parameters of the damped fast-forward.
+  void SetSettleParameters(
+    double max_time,    ///< [in] maximum settling time (default: 3 s)
+    double speed_tol,   ///< [in] settled when no body moves faster (default: 1e-3 m/s)
+    double damping      ///< [in] fraction of the velocities removed at each step (default: 0.01)
+    );
+
+  /// Compute the cache key of a vehicle configuration.
+  static std::string GetKey(
+    const std::string&   vehicle_file,   ///< [in] JSON vehicle specification file
+    const std::string&   tire_terrain,   ///< [in] description of the tire and terrain models
+    const ChCoordsys<>&  init_pos        ///< [in] initial chassis position
+    );
+
+  /// Restore the settled state with the specified key into the vehicle.
+  /// Returns false if there is no such state, or if it does not match the
+  /// vehicle system.
+  bool Load(const std::string& key, ChVehicle& vehicle) const;
+
+  /// Settle the vehicle on its tires (in place) and store its state under the
+  /// specified key. The vehicle time is reset to its value before settling.
+  /// Returns false if the vehicle did not settle within the maximum time (its
+  /// state is then not stored).
+  bool Settle(const std::string& key, ChVehicle& vehicle, std::vector<ChSharedPtr<ChTire> >& tires) const;
+
+  /// Restore the settled state with the specified key or, if there is none,
+  /// compute and store it.
+  bool LoadOrSettle(const std::string& key, ChVehicle& vehicle, std::vector<ChSharedPtr<ChTire> >& tires) const;
+
+  /// Get the file holding the state with the specified key.
+  std::string GetFile(const std::string& key) const { return m_dir + "/" + key + ".state"; }
+
+private:
+
+  std::string  m_dir;
+  double       m_max_time;
+  double       m_speed_tol;
+  double       m_damping;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,528 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Network of powertrain and driveline shafts solved outside the Chrono system.
+//
+// =============================================================================
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChShaftNetwork.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShaftNetwork::ChShaftNetwork()
+: m_num_substeps(10),
+  m_num_unknowns(0),
+  m_size(0),
+  m_step(0),
+  m_scale(1),
+  m_dirty(true),
+  m_singular(false)
+{
+}
+
+void ChShaftNetwork::SetNumSubsteps(int num_substeps)
+{
+  m_num_substeps = std::max(num_substeps, 1);
+  m_dirty = true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChShaftNetwork::AddShaft(ChSharedPtr<ChShaft> shaft)
+{
+  Shaft s;
+  s.shaft = shaft;
+  s.boundary = false;
+  s.inertia = shaft->GetInertia();
+  s.unknown = m_num_unknowns++;
+  s.speed = 0;
+  s.accel = 0;
+  s.lumped = 0;
+  s.torque = 0;
+  m_shafts.push_back(s);
+  m_dirty = true;
+
+  return (int)m_shafts.size() - 1;
+}
+
+int ChShaftNetwork::AddBoundaryShaft(ChSharedPtr<ChShaft> shaft)
+{
+  Shaft s;
+  s.shaft = shaft;
+  s.boundary = true;
+  s.inertia = shaft->GetInertia();
+  s.unknown = -1;
+  s.speed = 0;
+  s.accel = 0;
+  s.lumped = 0;
+  s.torque = 0;
+  m_shafts.push_back(s);
+  m_dirty = true;
+
+  return (int)m_shafts.size() - 1;
+}
+
+int ChShaftNetwork::GetShaftIndex(ChSharedPtr<ChShaft> shaft) const
+{
+  for (size_t k = 0; k < m_shafts.size(); k++) {
+    if (m_shafts[k].shaft.get_ptr() == shaft.get_ptr())
+      return (int)k;
+  }
+  return -1;
+}
+
+int ChShaftNetwork::AddGear(int input, int output, double ratio)
+{
+  assert(input >= 0 && input < (int)m_shafts.size());
+  assert(output >= 0 && output < (int)m_shafts.size());
+
+  Constraint c;
+  c.shafts[0] = input;
+  c.shafts[1] = output;
+  c.coefs[0] = ratio;
+  c.coefs[1] = -1;
+  c.num_shafts = 2;
+  c.active = true;
+  m_constraints.push_back(c);
+  m_dirty = true;
+
+  return (int)m_constraints.size() - 1;
+}
+
+// Same convention as ChShaftsPlanetary: (1-t0) wc + t0 w1 - w2 = 0.
+int ChShaftNetwork::AddPlanetary(int carrier, int shaft1, int shaft2, double t0)
+{
+  assert(carrier >= 0 && carrier < (int)m_shafts.size());
+  assert(shaft1 >= 0 && shaft1 < (int)m_shafts.size());
+  assert(shaft2 >= 0 && shaft2 < (int)m_shafts.size());
+
+  Constraint c;
+  c.shafts[0] = carrier;
+  c.shafts[1] = shaft1;
+  c.shafts[2] = shaft2;
+  c.coefs[0] = 1 - t0;
+  c.coefs[1] = t0;
+  c.coefs[2] = -1;
+  c.num_shafts = 3;
+  c.active = true;
+  m_constraints.push_back(c);
+  m_dirty = true;
+
+  return (int)m_constraints.size() - 1;
+}
+
+void ChShaftNetwork::SetGearRatio(int constraint, double ratio)
+{
+  assert(m_constraints[constraint].num_shafts == 2);
+  if (m_constraints[constraint].coefs[0] == ratio)
+    return;
+  m_constraints[constraint].coefs[0] = ratio;
+  m_dirty = true;
+}
+
+void ChShaftNetwork::SetConstraintActive(int constraint, bool val)
+{
+  if (m_constraints[constraint].active == val)
+    return;
+  m_constraints[constraint].active = val;
+  m_dirty = true;
+}
+
+int ChShaftNetwork::AddEngine(int shaft, ChSharedPtr<ChFunction> torque_map)
+{
+  assert(shaft >= 0 && shaft < (int)m_shafts.size());
+
+  Engine e;
+  e.shaft = shaft;
+  e.map = torque_map;
+  e.throttle = 1;
+  e.torque = 0;
+  m_engines.push_back(e);
+
+  return (int)m_engines.size() - 1;
+}
+
+int ChShaftNetwork::AddTorqueConverter(int                      input,
+                                       int                      output,
+                                       ChSharedPtr<ChFunction>  capacity_factor,
+                                       ChSharedPtr<ChFunction>  torque_ratio)
+{
+  assert(input >= 0 && input < (int)m_shafts.size());
+  assert(output >= 0 && output < (int)m_shafts.size());
+
+  Converter c;
+  c.input = input;
+  c.output = output;
+  c.capacity_factor = capacity_factor;
+  c.torque_ratio = torque_ratio;
+  c.torque_in = 0;
+  c.torque_out = 0;
+  c.slippage = 0;
+  m_converters.push_back(c);
+
+  return (int)m_converters.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Substep equations, for the speeds w of the network shafts at the end of the
+// substep and the constraint torques L:
+//    J (w - w0) / h - C^T L = T
+//    C w = -Cb wb
+// where wb are the prescribed speeds of the boundary shafts. The constraint
+// torque on a shaft is the sum of its coefficients times the torques of its
+// constraints. The solution vector holds the constraint torques divided by
+// the row scaling.
+// -----------------------------------------------------------------------------
+bool ChShaftNetwork::factorize(double h)
+{
+  int n = m_num_unknowns;
+
+  m_row.assign(m_constraints.size(), -1);
+  m_size = n;
+  for (size_t c = 0; c < m_constraints.size(); c++) {
+    if (m_constraints[c].active)
+      m_row[c] = m_size++;
+  }
+
+  int size = m_size;
+  m_lu.assign(size * size, 0.0);
+  m_pivots.resize(size);
+
+  // The constraint rows are scaled by the largest diagonal entry, for
+  // pivots of comparable magnitudes.
+  m_scale = 0;
+  for (size_t s = 0; s < m_shafts.size(); s++) {
+    int u = m_shafts[s].unknown;
+    if (u >= 0) {
+      m_lu[u * size + u] = m_shafts[s].inertia / h;
+      m_scale = std::max(m_scale, m_shafts[s].inertia / h);
+    }
+  }
+  if (m_scale == 0)
+    m_scale = 1;
+  for (size_t c = 0; c < m_constraints.size(); c++) {
+    int r = m_row[c];
+    if (r < 0)
+      continue;
+    const Constraint& con = m_constraints[c];
+    for (int k = 0; k < con.num_shafts; k++) {
+      int u = m_shafts[con.shafts[k]].unknown;
+      if (u < 0)
+        continue;
+      m_lu[r * size + u] += m_scale * con.coefs[k];
+      m_lu[u * size + r] -= m_scale * con.coefs[k];
+    }
+  }
+
+  double amax = 0;
+  for (size_t k = 0; k < m_lu.size(); k++)
+    amax = std::max(amax, std::abs(m_lu[k]));
+
+  // LU factorization with partial pivoting.
+  m_step = h;
+  m_dirty = false;
+  m_singular = false;
+  for (int k = 0; k < size; k++) {
+    int p = k;
+    for (int i = k + 1; i < size; i++) {
+      if (std::abs(m_lu[i * size + k]) > std::abs(m_lu[p * size + k]))
+        p = i;
+    }
+    if (std::abs(m_lu[p * size + k]) <= 1e-12 * amax) {
+      GetContextLog() << "ERROR: singular shaft network (redundant constraint or shaft without inertia)\n";
+      m_singular = true;
+      return false;
+    }
+    m_pivots[k] = p;
+    if (p != k) {
+      for (int j = 0; j < size; j++)
+        std::swap(m_lu[k * size + j], m_lu[p * size + j]);
+    }
+    double pivot = m_lu[k * size + k];
+    for (int i = k + 1; i < size; i++) {
+      double f = (m_lu[i * size + k] /= pivot);
+      if (f == 0)
+        continue;
+      for (int j = k + 1; j < size; j++)
+        m_lu[i * size + j] -= f * m_lu[k * size + j];
+    }
+  }
+
+  // Inertia rigidly attached to the boundary shafts: the constraint torques
+  // for a unit acceleration of one boundary shaft, from rest, give a column of
+  // the boundary inertia matrix; each boundary shaft receives the sum of the
+  // absolute values of its row.
+  for (size_t s = 0; s < m_shafts.size(); s++)
+    m_shafts[s].lumped = 0;
+
+  std::vector<double> x(size);
+  std::vector<double> torques(m_shafts.size());
+  for (size_t b = 0; b < m_shafts.size(); b++) {
+    if (!m_shafts[b].boundary)
+      continue;
+    std::fill(x.begin(), x.end(), 0.0);
+    for (size_t c = 0; c < m_constraints.size(); c++) {
+      const Constraint& con = m_constraints[c];
+      for (int k = 0; m_row[c] >= 0 && k < con.num_shafts; k++) {
+        if (con.shafts[k] == (int)b)
+          x[m_row[c]] -= m_scale * con.coefs[k] * h;
+      }
+    }
+    solve(x);
+
+    std::fill(torques.begin(), torques.end(), 0.0);
+    add_constraint_torques(x, torques);
+    for (size_t s = 0; s < m_shafts.size(); s++) {
+      if (m_shafts[s].boundary)
+        m_shafts[s].lumped += std::abs(torques[s]);
+    }
+  }
+
+  return true;
+}
+
+void ChShaftNetwork::solve(std::vector<double>& x) const
+{
+  int size = m_size;
+
+  for (int k = 0; k < size; k++) {
+    if (m_pivots[k] != k)
+      std::swap(x[k], x[m_pivots[k]]);
+  }
+  for (int i = 1; i < size; i++) {
+    double sum = x[i];
+    for (int j = 0; j < i; j++)
+      sum -= m_lu[i * size + j] * x[j];
+    x[i] = sum;
+  }
+  for (int i = size - 1; i >= 0; i--) {
+    double sum = x[i];
+    for (int j = i + 1; j < size; j++)
+      sum -= m_lu[i * size + j] * x[j];
+    x[i] = sum / m_lu[i * size + i];
+  }
+}
+
+void ChShaftNetwork::load_rhs(double h, const std::vector<double>& torques, std::vector<double>& x) const
+{
+  x.assign(m_size, 0.0);
+
+  for (size_t s = 0; s < m_shafts.size(); s++) {
+    const Shaft& shaft = m_shafts[s];
+    if (shaft.unknown >= 0)
+      x[shaft.unknown] = shaft.inertia * shaft.shaft->GetPos_dt() / h + torques[s];
+  }
+
+  for (size_t c = 0; c < m_constraints.size(); c++) {
+    int r = m_row[c];
+    if (r < 0)
+      continue;
+    const Constraint& con = m_constraints[c];
+    for (int k = 0; k < con.num_shafts; k++) {
+      const Shaft& shaft = m_shafts[con.shafts[k]];
+      if (shaft.boundary)
+        x[r] -= m_scale * con.coefs[k] * shaft.speed;
+    }
+  }
+}
+
+void ChShaftNetwork::add_constraint_torques(const std::vector<double>& x, std::vector<double>& torques) const
+{
+  for (size_t c = 0; c < m_constraints.size(); c++) {
+    int r = m_row[c];
+    if (r < 0)
+      continue;
+    const Constraint& con = m_constraints[c];
+    for (int k = 0; k < con.num_shafts; k++)
+      torques[con.shafts[k]] += m_scale * con.coefs[k] * x[r];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShaftNetwork::Advance(double step)
+{
+  CH_PROFILE_SCOPE("ChShaftNetwork::Advance");
+
+  if (m_shafts.empty() || step <= 0)
+    return;
+
+  double h = step / m_num_substeps;
+  if (m_dirty || h != m_step)
+    factorize(h);
+
+  size_t num_shafts = m_shafts.size();
+  std::vector<double> speed0(num_shafts);
+  for (size_t s = 0; s < num_shafts; s++) {
+    Shaft& shaft = m_shafts[s];
+    shaft.torque = 0;
+    if (shaft.boundary) {
+      speed0[s] = shaft.shaft->GetPos_dt();
+      shaft.accel = shaft.shaft->GetPos_dtdt();
+    }
+  }
+  for (size_t e = 0; e < m_engines.size(); e++)
+    m_engines[e].torque = 0;
+  for (size_t c = 0; c < m_converters.size(); c++) {
+    m_converters[c].torque_in = 0;
+    m_converters[c].torque_out = 0;
+  }
+
+  if (m_singular) {
+    for (size_t s = 0; s < num_shafts; s++) {
+      if (m_shafts[s].boundary)
+        m_shafts[s].shaft->SetAppliedTorque(0);
+    }
+    return;
+  }
+
+  double weight = 1.0 / m_num_substeps;
+  std::vector<double> torques(num_shafts, 0.0);
+  std::vector<double> x;
+
+  // Project the speeds of the network shafts on the constraints at the
+  // current boundary speeds. The jump from the extrapolated speeds is not
+  // transmitted: the boundary shafts already integrate the lumped inertia.
+  for (size_t s = 0; s < num_shafts; s++) {
+    if (m_shafts[s].boundary)
+      m_shafts[s].speed = speed0[s];
+  }
+  load_rhs(h, torques, x);
+  solve(x);
+  for (size_t s = 0; s < num_shafts; s++) {
+    if (!m_shafts[s].boundary)
+      m_shafts[s].shaft->SetPos_dt(x[m_shafts[s].unknown]);
+  }
+
+  for (int step_index = 1; step_index <= m_num_substeps; step_index++) {
+    // Prescribed boundary speeds at the end of the substep.
+    for (size_t s = 0; s < num_shafts; s++) {
+      Shaft& shaft = m_shafts[s];
+      if (shaft.boundary)
+        shaft.speed = speed0[s] + shaft.accel * step_index * h;
+    }
+
+    // Torques at the start of the substep.
+    for (size_t s = 0; s < num_shafts; s++)
+      torques[s] = m_shafts[s].boundary ? 0 : m_shafts[s].shaft->GetAppliedTorque();
+
+    for (size_t e = 0; e < m_engines.size(); e++) {
+      Engine& engine = m_engines[e];
+      double torque = engine.throttle * engine.map->Get_y(m_shafts[engine.shaft].shaft->GetPos_dt());
+      torques[engine.shaft] += torque;
+      engine.torque += weight * torque;
+    }
+
+    for (size_t c = 0; c < m_converters.size(); c++) {
+      Converter& conv = m_converters[c];
+      double w_in = m_shafts[conv.input].shaft->GetPos_dt();
+      double w_out = m_shafts[conv.output].shaft->GetPos_dt();
+      double ratio = (std::abs(w_in) < 1e-9) ? 0 : w_out / w_in;
+      double K = conv.capacity_factor->Get_y(ratio);
+      double torque_in = (K > 0) ? w_in * std::abs(w_in) / (K * K) : 0;
+      double torque_out = conv.torque_ratio->Get_y(ratio) * torque_in;
+      torques[conv.input] -= torque_in;
+      torques[conv.output] += torque_out;
+      conv.torque_in += weight * torque_in;
+      conv.torque_out += weight * torque_out;
+      conv.slippage = 1 - ratio;
+    }
+
+    load_rhs(h, torques, x);
+    solve(x);
+
+    for (size_t s = 0; s < num_shafts; s++) {
+      Shaft& shaft = m_shafts[s];
+      if (shaft.boundary)
+        continue;
+      double w0 = shaft.shaft->GetPos_dt();
+      double w = x[shaft.unknown];
+      shaft.shaft->SetPos_dtdt((w - w0) / h);
+      shaft.shaft->SetPos_dt(w);
+      shaft.shaft->SetPos(shaft.shaft->GetPos() + h * w);
+    }
+
+    std::fill(torques.begin(), torques.end(), 0.0);
+    add_constraint_torques(x, torques);
+    for (size_t s = 0; s < num_shafts; s++)
+      m_shafts[s].torque += weight * torques[s];
+  }
+
+  // The lumped inertia is integrated by the Chrono system; its torque at the
+  // last acceleration is included in the network torque and added back.
+  for (size_t s = 0; s < num_shafts; s++) {
+    const Shaft& shaft = m_shafts[s];
+    if (!shaft.boundary)
+      continue;
+    shaft.shaft->SetInertia(shaft.inertia + shaft.lumped);
+    shaft.shaft->SetAppliedTorque(shaft.torque + shaft.lumped * shaft.accel);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShaftNetwork::SaveState(ChVehicleState& state) const
+{
+  state.BeginBlock(3 * m_num_unknowns);
+  for (size_t s = 0; s < m_shafts.size(); s++) {
+    if (m_shafts[s].boundary)
+      continue;
+    state.Write(m_shafts[s].shaft->GetPos());
+    state.Write(m_shafts[s].shaft->GetPos_dt());
+    state.Write(m_shafts[s].shaft->GetPos_dtdt());
+  }
+}
+
+bool ChShaftNetwork::RestoreState(ChVehicleState& state)
+{
+  if (!state.OpenBlock(3 * m_num_unknowns, "shaft network"))
+    return false;
+
+  for (size_t s = 0; s < m_shafts.size(); s++) {
+    if (m_shafts[s].boundary)
+      continue;
+    m_shafts[s].shaft->SetPos(state.Read());
+    m_shafts[s].shaft->SetPos_dt(state.Read());
+    m_shafts[s].shaft->SetPos_dtdt(state.Read());
+  }
+
+  return true;
+}
+
+void ChShaftNetwork::AddMemoryFootprint(ChMemoryReport& report) const
+{
+  report.Add("vehicle/shaft networks", sizeof(*this) + ChMemoryReport::VectorBytes(m_shafts) +
+                                       ChMemoryReport::VectorBytes(m_constraints) +
+                                       ChMemoryReport::VectorBytes(m_engines) +
+                                       ChMemoryReport::VectorBytes(m_converters) +
+                                       ChMemoryReport::VectorBytes(m_row) +
+                                       ChMemoryReport::VectorBytes(m_lu) +
+                                       ChMemoryReport::VectorBytes(m_pivots));
+  report.Add("vehicle/shafts", m_num_unknowns * sizeof(ChShaft), m_num_unknowns);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,244 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Network of powertrain and driveline shafts solved outside the Chrono system.
+//
+// The shafts of the network are ChShaft objects that are not added to the
+// Chrono system; the network integrates them with its own, smaller step, while
+// the boundary shafts (typically the suspension axles) remain in the Chrono
+// system. The network is coupled to the Chrono system only through the speeds
+// and the torques of the boundary shafts:
+//  - at each step of the Chrono system, the network shafts are projected on
+//    the constraints at the current boundary speeds; these speeds are then
+//    extrapolated with their last accelerations over the step, and the network
+//    takes several substeps with the extrapolated speeds;
+//  - each substep solves, with a dense LU factorization, the implicit Euler
+//    equations of the network shafts together with the linear speed
+//    constraints (gears and planetary gears); the engine and torque converter
+//    torques are evaluated at the start of the substep;
+//  - the inertia of the network rigidly attached to the boundary shafts is
+//    added (lumped by rows) to the inertia of these shafts, so that it is
+//    integrated implicitly by the Chrono system; the boundary shafts receive
+//    the average constraint torque of the network over the substeps, plus the
+//    lumped inertia times their last acceleration.
+//
+// The factorization and the lumped inertias only change with the gear ratios
+// and the step. The reaction torques on the chassis (motor block roll, gearbox
+// and differential casings) are not transmitted.
+//
+// =============================================================================
+
+#ifndef CH_SHAFT_NETWORK_H
+#define CH_SHAFT_NETWORK_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "physics/ChShaft.h"
+#include "motion_functions/ChFunction.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Network of 1-D shafts (gears, planetary gears, engines and torque
+/// converters) solved outside the Chrono system, and coupled to it through the
+/// speeds and torques of its boundary shafts.
+///
+class CH_SUBSYS_API ChShaftNetwork : public ChShared
+{
+public:
+
+  ChShaftNetwork();
+  ~ChShaftNetwork() {}
+
+  /// Set the number of substeps per step of the Chrono system (default: 10).
+  void SetNumSubsteps(int num_substeps);
+
+  /// Get the number of substeps per step of the Chrono system.
+  int GetNumSubsteps() const { return m_num_substeps; }
+
+  /// Add a shaft integrated by the network. The shaft must not be added to the
+  /// Chrono system; its inertia, state and applied torque are used by the
+  /// network. Returns the index of the shaft.
+  int AddShaft(ChSharedPtr<ChShaft> shaft);
+
+  /// Add a boundary shaft, i.e. a shaft of the Chrono system whose speed is
+  /// imposed on the network. Returns the index of the shaft.
+  int AddBoundaryShaft(ChSharedPtr<ChShaft> shaft);
+
+  /// Get the index of the specified shaft (-1 if not in the network).
+  int GetShaftIndex(ChSharedPtr<ChShaft> shaft) const;
+
+  /// Add a gear between two shafts, with speed of the output shaft equal to
+  /// the ratio times the speed of the input shaft. Returns the index of the
+  /// constraint.
+  int AddGear(
+    int    input,   ///< [in] index of the input shaft
+    int    output,  ///< [in] index of the output shaft
+    double ratio    ///< [in] transmission ratio
+    );
+
+  /// Add a planetary gear with the specified ordinary transmission ratio
+  /// (Willis formula, see ChShaftsPlanetary; -1 for a differential). Returns
+  /// the index of the constraint.
+  int AddPlanetary(
+    int    carrier, ///< [in] index of the carrier shaft
+    int    shaft1,  ///< [in] index of the first shaft
+    int    shaft2,  ///< [in] index of the second shaft
+    double t0       ///< [in] ordinary transmission ratio
+    );
+
+  /// Set the transmission ratio of the specified gear.
+  void SetGearRatio(int constraint, double ratio);
+
+  /// Enable or disable the specified constraint (e.g. a gearbox in neutral).
+  void SetConstraintActive(int constraint, bool val);
+
+  /// Add an engine applying throttle times the torque map, evaluated at the
+  /// shaft speed, to the specified shaft (and the opposite torque to the
+  /// chassis). The throttle is initially 1. Returns the index of the engine.
+  int AddEngine(int shaft, ChSharedPtr<ChFunction> torque_map);
+
+  /// Set the throttle of the specified engine.
+  void SetThrottle(int engine, double throttle) { m_engines[engine].throttle = throttle; }
+
+  /// Add a torque converter between two shafts, with the capacity factor and
+  /// torque ratio maps of ChShaftsTorqueConverter (the stator is the chassis).
+  /// Returns the index of the converter.
+  int AddTorqueConverter(
+    int                      input,            ///< [in] index of the input (pump) shaft
+    int                      output,           ///< [in] index of the output (turbine) shaft
+    ChSharedPtr<ChFunction>  capacity_factor,  ///< [in] capacity factor vs. speed ratio
+    ChSharedPtr<ChFunction>  torque_ratio      ///< [in] torque ratio vs. speed ratio
+    );
+
+  /// Advance the network over the specified step of the Chrono system, and
+  /// set the inertias and applied torques of the boundary shafts for that step.
+  /// Must be called before the Chrono system takes the step.
+  void Advance(double step);
+
+  /// Get the average torque applied by the constraints of the network to the
+  /// specified shaft over the last step.
+  double GetShaftTorque(int shaft) const { return m_shafts[shaft].torque; }
+
+  /// Get the inertia of the network lumped on the specified boundary shaft.
+  double GetLumpedInertia(int shaft) const { return m_shafts[shaft].lumped; }
+
+  /// Get the average torque of the specified engine over the last step.
+  double GetEngineTorque(int engine) const { return m_engines[engine].torque; }
+
+  /// Get the average input torque of the specified torque converter over the
+  /// last step.
+  double GetConverterInputTorque(int converter) const { return m_converters[converter].torque_in; }
+
+  /// Get the average output torque of the specified torque converter over the
+  /// last step.
+  double GetConverterOutputTorque(int converter) const { return m_converters[converter].torque_out; }
+
+  /// Get the slippage of the specified torque converter at the last substep.
+  double GetConverterSlippage(int converter) const { return m_converters[converter].slippage; }
+
+  /// Append the states of the network shafts to the specified snapshot.
+  void SaveState(ChVehicleState& state) const;
+
+  /// Restore the states of the network shafts from the next block of the
+  /// specified snapshot.
+  bool RestoreState(ChVehicleState& state);
+
+  /// Add the network to the specified report.
+  void AddMemoryFootprint(ChMemoryReport& report) const;
+
+private:
+
+  struct Shaft {
+    ChSharedPtr<ChShaft>  shaft;
+    bool                  boundary;
+    double                inertia;   // network shafts: inertia; boundary shafts: own inertia
+    int                   unknown;   // index in the solution vector (-1 for boundary shafts)
+    double                speed;     // prescribed speed over the current substep (boundary shafts)
+    double                accel;     // extrapolation of the speed over the step (boundary shafts)
+    double                lumped;    // network inertia lumped on the shaft (boundary shafts)
+    double                torque;    // average constraint torque over the last step
+  };
+
+  struct Constraint {
+    int     shafts[3];
+    double  coefs[3];   // sum of coefs times shaft speeds is zero
+    int     num_shafts;
+    bool    active;
+  };
+
+  struct Engine {
+    int                      shaft;
+    ChSharedPtr<ChFunction>  map;
+    double                   throttle;
+    double                   torque;
+  };
+
+  struct Converter {
+    int                      input;
+    int                      output;
+    ChSharedPtr<ChFunction>  capacity_factor;
+    ChSharedPtr<ChFunction>  torque_ratio;
+    double                   torque_in;
+    double                   torque_out;
+    double                   slippage;
+  };
+
+  ChShaftNetwork(const ChShaftNetwork&);
+  ChShaftNetwork& operator=(const ChShaftNetwork&);
+
+  // Assemble and factorize the substep matrix, and compute the lumped inertias.
+  bool factorize(double h);
+
+  // Solve with the current factorization (in place).
+  void solve(std::vector<double>& x) const;
+
+  // Load the right-hand side of the substep equations, with the specified
+  // torques on the network shafts.
+  void load_rhs(double h, const std::vector<double>& torques, std::vector<double>& x) const;
+
+  // Accumulate the constraint torques of the solution on the shafts.
+  void add_constraint_torques(const std::vector<double>& x, std::vector<double>& torques) const;
+
+  std::vector<Shaft>       m_shafts;
+  std::vector<Constraint>  m_constraints;
+  std::vector<Engine>      m_engines;
+  std::vector<Converter>   m_converters;
+
+  int                      m_num_substeps;
+  int                      m_num_unknowns;   // network shafts
+  int                      m_size;           // network shafts and active constraints
+  double                   m_step;           // substep of the current factorization
+  double                   m_scale;          // scaling of the constraint rows
+  bool                     m_dirty;          // the factorization must be rebuilt
+  bool                     m_singular;       // the last factorization failed
+
+  std::vector<int>         m_row;            // constraint rows (-1 if inactive)
+  std::vector<double>      m_lu;             // row-major LU factors
+  std::vector<int>         m_pivots;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,143 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of primitive collision shapes.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "subsys/ChShapeCache.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+typedef std::map<std::string, ChSharedPtr<ChBody> > ChShapeMap;
+
+static ChMutex     s_shape_mutex;
+static ChShapeMap  s_shape_entries;
+static int         s_shape_uses = 0;
+
+enum ChShapeType { SHAPE_BOX, SHAPE_CYLINDER, SHAPE_SPHERE };
+
+// Key of a shape: its type and parameters, with all digits (shapes that
+// differ in the last bit are not shared).
+static std::string ShapeKey(ChShapeType           type,
+                            const ChVector<>&     size,
+                            const ChVector<>&     pos,
+                            const ChQuaternion<>& rot)
+{
+  char key[256];
+  sprintf(key, "%d %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g",
+          (int)type, size.x, size.y, size.z, pos.x, pos.y, pos.z, rot.e0, rot.e1, rot.e2, rot.e3);
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// The template body of a shape is created (with the default collision
+// envelope and margin) the first time the shape is requested. The collision
+// model of the body is built outside the cache lock.
+// -----------------------------------------------------------------------------
+static void SetShape(ChBody*               body,
+                     ChShapeType           type,
+                     const ChVector<>&     size,
+                     const ChVector<>&     pos,
+                     const ChQuaternion<>& rot)
+{
+  ChSharedPtr<ChBody> shape;
+  {
+    ChScopedLock lock(s_shape_mutex);
+
+    std::string key = ShapeKey(type, size, pos, rot);
+    ChShapeMap::iterator it = s_shape_entries.find(key);
+    if (it == s_shape_entries.end()) {
+      ChSharedPtr<ChBody> templ(new ChBody);
+      ChMatrix33<> A(rot);
+      templ->GetCollisionModel()->ClearModel();
+      switch (type) {
+      case SHAPE_BOX:
+        templ->GetCollisionModel()->AddBox(size.x, size.y, size.z, pos, A);
+        break;
+      case SHAPE_CYLINDER:
+        templ->GetCollisionModel()->AddCylinder(size.x, size.x, size.y, pos, A);
+        break;
+      case SHAPE_SPHERE:
+        templ->GetCollisionModel()->AddSphere(size.x, pos);
+        break;
+      }
+      templ->GetCollisionModel()->BuildModel();
+      it = s_shape_entries.insert(std::make_pair(key, templ)).first;
+    }
+    shape = it->second;
+    s_shape_uses++;
+  }
+
+  body->GetCollisionModel()->ClearModel();
+  body->GetCollisionModel()->AddCopyOfAnotherModel(shape->GetCollisionModel());
+  body->GetCollisionModel()->BuildModel();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShapeCache::SetBox(ChBody*               body,
+                          const ChVector<>&     hdims,
+                          const ChVector<>&     pos,
+                          const ChQuaternion<>& rot)
+{
+  SetShape(body, SHAPE_BOX, hdims, pos, rot);
+}
+
+void ChShapeCache::SetCylinder(ChBody*               body,
+                               double                radius,
+                               double                hlen,
+                               const ChVector<>&     pos,
+                               const ChQuaternion<>& rot)
+{
+  SetShape(body, SHAPE_CYLINDER, ChVector<>(radius, hlen, 0), pos, rot);
+}
+
+void ChShapeCache::SetSphere(ChBody*           body,
+                             double            radius,
+                             const ChVector<>& pos)
+{
+  SetShape(body, SHAPE_SPHERE, ChVector<>(radius, 0, 0), pos, ChQuaternion<>(1, 0, 0, 0));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShapeCache::Clear()
+{
+  ChScopedLock lock(s_shape_mutex);
+  s_shape_entries.clear();
+}
+
+int ChShapeCache::GetNumShapes()
+{
+  ChScopedLock lock(s_shape_mutex);
+  return (int)s_shape_entries.size();
+}
+
+int ChShapeCache::GetNumUses()
+{
+  ChScopedLock lock(s_shape_mutex);
+  return s_shape_uses;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,95 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide cache of primitive collision shapes, shared by the bodies with
+// identical collision geometry (e.g. all wheels of a rigid tire model, or the
+// repeated obstacles of a terrain).
+//
+// For each set of shape parameters (type, dimensions, position and orientation
+// relative to the body), the cache builds a single collision model, held by a
+// template body that is never added to a system. The collision model of a body
+// then references the shape of the template (AddCopyOfAnotherModel() shares
+// the collision shapes, it does not copy them), so the shape and the data the
+// collision engine derives from it exist once, whatever the number of bodies.
+// Each body keeps its own collision object, family and contact material.
+//
+// The shared shapes must not be modified. Since a body references the template
+// shapes, Clear() does not invalidate the collision models already set.
+//
+// =============================================================================
+
+#ifndef CH_SHAPE_CACHE_H
+#define CH_SHAPE_CACHE_H
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "physics/ChBody.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Cache of shared primitive collision shapes.
+///
+class CH_SUBSYS_API ChShapeCache
+{
+public:
+
+  /// Replace the collision shapes of the specified body with the shared box
+  /// with the specified half-dimensions, at the specified position and
+  /// orientation relative to the body frame. The collision model is rebuilt.
+  static void SetBox(
+    ChBody*               body,                                   ///< [in] body
+    const ChVector<>&     hdims,                                  ///< [in] half-dimensions of the box
+    const ChVector<>&     pos = ChVector<>(0, 0, 0),              ///< [in] position relative to the body
+    const ChQuaternion<>& rot = ChQuaternion<>(1, 0, 0, 0)        ///< [in] orientation relative to the body
+    );
+
+  /// Replace the collision shapes of the specified body with the shared
+  /// cylinder (axis along y) with the specified radius and half-length.
+  static void SetCylinder(
+    ChBody*               body,                                   ///< [in] body
+    double                radius,                                 ///< [in] cylinder radius
+    double                hlen,                                   ///< [in] half-length of the cylinder
+    const ChVector<>&     pos = ChVector<>(0, 0, 0),              ///< [in] position relative to the body
+    const ChQuaternion<>& rot = ChQuaternion<>(1, 0, 0, 0)        ///< [in] orientation relative to the body
+    );
+
+  /// Replace the collision shapes of the specified body with the shared
+  /// sphere with the specified radius.
+  static void SetSphere(
+    ChBody*               body,                                   ///< [in] body
+    double                radius,                                 ///< [in] sphere radius
+    const ChVector<>&     pos = ChVector<>(0, 0, 0)               ///< [in] position relative to the body
+    );
+
+  /// Release all cached shapes. Collision models already set remain valid.
+  static void Clear();
+
+  /// Return the number of cached shapes.
+  static int GetNumShapes();
+
+  /// Return the number of collision models set from a cached shape.
+  static int GetNumUses();
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,353 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Node-wide segment of immutable, parsed model data (shm_open or
+// CreateFileMapping).
+//
+// =============================================================================
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChSharedModelData.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const size_t MODEL_MAGIC = 0x43484d31;   // "CHM1"
+static const size_t MODEL_SEALED = 1;
+static const size_t MODEL_ALIGN = 64;
+
+// Start of the segment. The magic number is written once the header is
+// initialized, the state once the builder sealed the segment.
+struct ChModelHeader {
+  volatile size_t magic;
+  volatile size_t state;
+  size_t          capacity;
+  size_t          used;          // end of the last blob, from the segment start
+  size_t          num_blobs;
+  char            pad[MODEL_ALIGN - 5 * sizeof(size_t)];
+};
+
+// Blob record, followed by the key characters; the blob data starts at the
+// next cache line. The next record follows the data, at the next cache line.
+struct ChModelBlob {
+  size_t  key_length;
+  size_t  data_offset;   // from the segment start
+  size_t  bytes;
+};
+
+static ChMutex              s_model_mutex;
+static ChSharedModelData::Role s_model_role = ChSharedModelData::NONE;
+static ChModelHeader*       s_model_header = 0;
+static size_t               s_model_size = 0;
+#ifdef _WIN32
+static HANDLE               s_model_mapping = 0;
+#else
+static int                  s_model_fd = -1;
+#endif
+
+static size_t ModelAlign(size_t offset)
+{
+  return (offset + MODEL_ALIGN - 1) & ~(MODEL_ALIGN - 1);
+}
+
+static std::string ModelSegmentName(const std::string& name)
+{
+#ifdef _WIN32
+  return name;
+#else
+  return (!name.empty() && name[0] == '/') ? name : "/" + name;
+#endif
+}
+
+static void ModelUnmap()
+{
+  if (!s_model_header)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(s_model_header);
+  CloseHandle(s_model_mapping);
+  s_model_mapping = 0;
+#else
+  munmap(s_model_header, s_model_size);
+  close(s_model_fd);
+  s_model_fd = -1;
+#endif
+
+  s_model_header = 0;
+  s_model_size = 0;
+  s_model_role = ChSharedModelData::NONE;
+}
+
+// Locate the blob with the specified key. Must be called with the mutex locked.
+static const ChModelBlob* ModelLookup(const std::string& key)
+{
+  const char* base = reinterpret_cast<const char*>(s_model_header);
+  size_t offset = sizeof(ChModelHeader);
+
+  for (size_t i = 0; i < s_model_header->num_blobs; i++) {
+    const ChModelBlob* blob = reinterpret_cast<const ChModelBlob*>(base + offset);
+    if (blob->key_length == key.size() && memcmp(blob + 1, key.data(), key.size()) == 0)
+      return blob;
+    offset = ModelAlign(blob->data_offset + blob->bytes);
+  }
+
+  return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// The builder creates the segment exclusively and initializes the header; the
+// other processes wait for the builder to initialize and then seal it.
+// -----------------------------------------------------------------------------
+bool ChSharedModelData::Open(const std::string& name, size_t capacity, double timeout)
+{
+  ChScopedLock lock(s_model_mutex);
+
+  ModelUnmap();
+
+  std::string seg_name = ModelSegmentName(name);
+  size_t bytes = ModelAlign(sizeof(ChModelHeader) + capacity);
+  bool create = false;
+  void* data = 0;
+
+#ifdef _WIN32
+  s_model_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE | SEC_RESERVE,
+                                       (DWORD)((unsigned long long)bytes >> 32), (DWORD)bytes, seg_name.c_str());
+  create = (s_model_mapping != 0 && GetLastError() != ERROR_ALREADY_EXISTS);
+  if (s_model_mapping)
+    data = MapViewOfFile(s_model_mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+  if (create && data && !VirtualAlloc(data, bytes, MEM_COMMIT, PAGE_READWRITE)) {
+    UnmapViewOfFile(data);
+    data = 0;
+  }
+  if (!data) {
+    if (s_model_mapping)
+      CloseHandle(s_model_mapping);
+    s_model_mapping = 0;
+    GetLog() << "ERROR: cannot map shared model data segment " << name.c_str() << "\n";
+    return false;
+  }
+  if (!create) {
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(data, &info, sizeof(info));
+    bytes = info.RegionSize;
+  }
+#else
+  s_model_fd = shm_open(seg_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  create = (s_model_fd >= 0);
+  if (create && ftruncate(s_model_fd, (off_t)bytes) != 0) {
+    close(s_model_fd);
+    shm_unlink(seg_name.c_str());
+    s_model_fd = -1;
+  }
+  if (!create) {
+    s_model_fd = shm_open(seg_name.c_str(), O_RDONLY, 0600);
+
+    // wait for the builder to size the segment
+    struct stat st;
+    for (double waited = 0; s_model_fd >= 0; waited += 0.001) {
+      if (fstat(s_model_fd, &st) != 0 || waited > timeout) {
+        close(s_model_fd);
+        s_model_fd = -1;
+      } else if (st.st_size >= (off_t)sizeof(ChModelHeader)) {
+        break;
+      } else {
+        ChThread::Sleep(0.001);
+      }
+    }
+    bytes = (s_model_fd >= 0) ? (size_t)st.st_size : 0;
+  }
+  if (s_model_fd >= 0) {
+    data = mmap(0, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, s_model_fd, 0);
+    if (data == MAP_FAILED) {
+      close(s_model_fd);
+      if (create)
+        shm_unlink(seg_name.c_str());
+      s_model_fd = -1;
+      data = 0;
+    }
+  }
+  if (!data) {
+    GetLog() << "ERROR: cannot map shared model data segment " << name.c_str() << "\n";
+    return false;
+  }
+#endif
+
+  s_model_header = static_cast<ChModelHeader*>(data);
+  s_model_size = bytes;
+
+  if (create) {
+    s_model_header->state = 0;
+    s_model_header->capacity = bytes;
+    s_model_header->used = sizeof(ChModelHeader);
+    s_model_header->num_blobs = 0;
+    ChAtomicStore(&s_model_header->magic, MODEL_MAGIC);
+    s_model_role = BUILDER;
+    return true;
+  }
+
+  for (double waited = 0; ; waited += 0.001) {
+    if (ChAtomicLoad(&s_model_header->magic) == MODEL_MAGIC &&
+        ChAtomicLoad(&s_model_header->state) == MODEL_SEALED)
+      break;
+    if (waited > timeout) {
+      GetLog() << "WARNING: shared model data segment " << name.c_str() << " was not sealed, loading locally\n";
+      ModelUnmap();
+      return false;
+    }
+    ChThread::Sleep(0.001);
+  }
+
+  s_model_role = READER;
+  return true;
+}
+
+void ChSharedModelData::Seal()
+{
+  ChScopedLock lock(s_model_mutex);
+
+  if (s_model_role != BUILDER || s_model_header->state == MODEL_SEALED)
+    return;
+
+  ChAtomicStore(&s_model_header->state, MODEL_SEALED);
+
+  // the blobs are immutable from now on, in this process too
+#ifdef _WIN32
+  DWORD old;
+  VirtualProtect(s_model_header, s_model_size, PAGE_READONLY, &old);
+#else
+  mprotect(s_model_header, s_model_size, PROT_READ);
+#endif
+}
+
+void ChSharedModelData::Close()
+{
+  ChScopedLock lock(s_model_mutex);
+
+  ModelUnmap();
+}
+
+void ChSharedModelData::Remove(const std::string& name)
+{
+#ifndef _WIN32
+  shm_unlink(ModelSegmentName(name).c_str());
+#endif
+}
+
+ChSharedModelData::Role ChSharedModelData::GetRole()
+{
+  ChScopedLock lock(s_model_mutex);
+
+  return s_model_role;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const void* ChSharedModelData::Find(const std::string& key, size_t& bytes)
+{
+  ChScopedLock lock(s_model_mutex);
+
+  if (!s_model_header)
+    return 0;
+
+  const ChModelBlob* blob = ModelLookup(key);
+  if (!blob)
+    return 0;
+
+  bytes = blob->bytes;
+  return reinterpret_cast<const char*>(s_model_header) + blob->data_offset;
+}
+
+void* ChSharedModelData::Allocate(const std::string& key, size_t bytes)
+{
+  ChScopedLock lock(s_model_mutex);
+
+  if (s_model_role != BUILDER || s_model_header->state == MODEL_SEALED || ModelLookup(key))
+    return 0;
+
+  size_t record = s_model_header->used;
+  size_t data_offset = ModelAlign(record + sizeof(ChModelBlob) + key.size());
+  if (data_offset + bytes > s_model_header->capacity) {
+    GetLog() << "WARNING: shared model data segment full, " << key.c_str() << " not shared\n";
+    return 0;
+  }
+
+  char* base = reinterpret_cast<char*>(s_model_header);
+  ChModelBlob* blob = reinterpret_cast<ChModelBlob*>(base + record);
+  blob->key_length = key.size();
+  blob->data_offset = data_offset;
+  blob->bytes = bytes;
+  memcpy(blob + 1, key.data(), key.size());
+
+  s_model_header->used = ModelAlign(data_offset + bytes);
+  s_model_header->num_blobs++;
+
+  return base + data_offset;
+}
+
+const void* ChSharedModelData::Add(const std::string& key, const void* data, size_t bytes)
+{
+  void* blob = Allocate(key, bytes);
+  if (blob && bytes > 0)
+    memcpy(blob, data, bytes);
+
+  return blob;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChSharedModelData::GetNumBlobs()
+{
+  ChScopedLock lock(s_model_mutex);
+
+  return s_model_header ? (int)s_model_header->num_blobs : 0;
+}
+
+size_t ChSharedModelData::GetUsedBytes()
+{
+  ChScopedLock lock(s_model_mutex);
+
+  return s_model_header ? s_model_header->used : 0;
+}
+
+void ChSharedModelData::AddMemoryFootprint(ChMemoryReport& report)
+{
+  ChScopedLock lock(s_model_mutex);
+
+  if (s_model_header)
+    report.AddShared("shared/model data", s_model_header, s_model_header->used);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,129 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Node-wide segment of immutable, parsed model data, shared read-only by all
+// processes of a node (e.g. one simulation process per core).
+//
+// The segment is a named shared-memory segment holding a list of blobs, each
+// identified by a key that includes the checksum (or modification time) of
+// its source, so that a stale segment never yields stale data. A blob holds
+// flat data only and is located by offsets relative to the segment start, so
+// the segment can be mapped at any address.
+//
+// The first process to open the segment creates it and is its builder: the
+// model data it loads (e.g. Pac2002 parameter blocks and tabulated curves,
+// mesh buffers) are added to the segment as they are loaded. When its models
+// are set up, the builder seals the segment, which then becomes read-only.
+// Every other process waits, in Open(), until the segment is sealed and maps
+// it read-only; the consumers then find their data in the segment instead of
+// loading it. If the builder did not seal the segment before the timeout
+// (e.g. it died), Open() fails and the process loads its data as usual.
+//
+// The capacity is reserved but not committed: on Linux, only the pages
+// actually written use memory. The segment outlives its processes, until it
+// is removed (see Remove()), e.g. at the end of the job.
+//
+// The consumers use the segment only if Open() was called. Tabulated Pacejka
+// curves are used in place; the other data is copied out of the segment,
+// which saves the parsing but not the memory.
+//
+// =============================================================================
+
+#ifndef CH_SHARED_MODEL_DATA_H
+#define CH_SHARED_MODEL_DATA_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMemoryReport.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Process-wide access to the node-wide segment of parsed model data.
+///
+class CH_SUBSYS_API ChSharedModelData
+{
+public:
+
+  /// Role of this process for the segment.
+  enum Role {
+    NONE,      ///< no segment open
+    BUILDER,   ///< this process created the segment and adds the model data
+    READER     ///< the segment is mapped read-only
+  };
+
+  /// Open the named segment: create it, as its builder, or else wait until it
+  /// is sealed and map it read-only.
+  /// Returns false if the segment cannot be created or mapped, or was not
+  /// sealed before the timeout.
+  static bool Open(
+    const std::string& name,             ///< [in] segment name
+    size_t             capacity,         ///< [in] capacity of the segment, in bytes (builder only)
+    double             timeout = 60      ///< [in] longest wait for the builder, in seconds
+    );
+
+  /// Seal the segment (builder only); no data can be added afterwards, and
+  /// the waiting processes map the segment.
+  static void Seal();
+
+  /// Unmap the segment. The segment itself is not removed.
+  static void Close();
+
+  /// Remove the named segment. Processes that mapped it keep their mapping.
+  static void Remove(const std::string& name);
+
+  /// Get the role of this process.
+  static Role GetRole();
+
+  /// Find the blob with the specified key.
+  /// Returns NULL if no segment is open or if the key is not found.
+  static const void* Find(
+    const std::string& key,      ///< [in] key of the blob
+    size_t&            bytes     ///< [out] size of the blob, in bytes
+    );
+
+  /// Allocate a blob with the specified key (builder only, before Seal()).
+  /// The returned storage is aligned on a cache line and must be filled in
+  /// before the segment is sealed.
+  /// Returns NULL if this process is not the builder of an unsealed segment,
+  /// if the key exists already or if the segment is full.
+  static void* Allocate(
+    const std::string& key,      ///< [in] key of the blob
+    size_t             bytes     ///< [in] size of the blob, in bytes
+    );
+
+  /// Add a copy of the specified data to the segment (see Allocate()).
+  /// Returns the copy, or NULL if the data cannot be added.
+  static const void* Add(const std::string& key, const void* data, size_t bytes);
+
+  /// Get the number of blobs in the segment.
+  static int GetNumBlobs();
+
+  /// Get the number of bytes used in the segment.
+  static size_t GetUsedBytes();
+
+  /// Add the used part of the segment to the specified report, as a shared
+  /// object ("shared/model data").
+  static void AddMemoryFootprint(ChMemoryReport& report);
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,411 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Message channel between two processes over a named shared-memory segment
+// (shm_open or CreateFileMapping).
+//
+// =============================================================================
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+#include "core/ChLog.h"
+
+#include "subsys/ChShmChannel.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static const size_t SHM_MAGIC = 0x43485331;   // "CHS1"
+static const size_t SHM_CACHE_LINE = 64;
+
+// One direction of the channel. The producer writes the head, the consumer
+// the tail; the sequence number is bumped at every push and pop, and is the
+// futex word the other side sleeps on.
+struct ChShmRing {
+  volatile size_t head;
+  char            pad0[SHM_CACHE_LINE - sizeof(size_t)];
+  volatile size_t tail;
+  char            pad1[SHM_CACHE_LINE - sizeof(size_t)];
+  volatile int    seq;
+  volatile int    waiting;
+  char            pad2[SHM_CACHE_LINE - 2 * sizeof(int)];
+};
+
+// Start of the segment, followed by the slots of the two rings. A slot holds
+// the message type and size, then the message values. The magic number is
+// written last by the server, so that a client does not use a segment that
+// is not initialized yet.
+struct ChShmHeader {
+  volatile size_t magic;
+  size_t          max_size;
+  size_t          num_slots;
+  char            pad[SHM_CACHE_LINE - 3 * sizeof(size_t)];
+  ChShmRing       ring[2];
+};
+
+struct ChShmChannelImpl {
+#ifdef _WIN32
+  HANDLE      mapping;
+#else
+  int         fd;
+  std::string name;      // name to unlink (server side only)
+#endif
+  size_t      size;
+};
+
+
+// -----------------------------------------------------------------------------
+// 32-bit atomics on the futex words
+// -----------------------------------------------------------------------------
+static int AtomicLoad(const volatile int* word)
+{
+#if defined(_MSC_VER)
+  int val = *word;
+  _ReadWriteBarrier();
+  return val;
+#else
+  return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static int AtomicExchange(volatile int* word, int val)
+{
+#if defined(_MSC_VER)
+  return (int)_InterlockedExchange((volatile long*)word, (long)val);
+#else
+  return __atomic_exchange_n(word, val, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static void AtomicIncrement(volatile int* word)
+{
+#if defined(_MSC_VER)
+  _InterlockedIncrement((volatile long*)word);
+#else
+  __atomic_add_fetch(word, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static void CpuPause()
+{
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+  _mm_pause();
+#endif
+}
+
+// Sleep until the word no longer holds the specified value, it is woken, or
+// the timeout expires (only the first is guaranteed on platforms without
+// futexes, where this just yields).
+static void SleepOn(volatile int* word, int val, double timeout)
+{
+#if defined(__linux__)
+  timespec ts;
+  ts.tv_sec = (time_t)timeout;
+  ts.tv_nsec = (long)((timeout - (double)ts.tv_sec) * 1e9);
+  syscall(SYS_futex, (int*)word, FUTEX_WAIT, val, &ts, 0, 0);
+#elif defined(_WIN32)
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+static void WakeAll(volatile int* word)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, (int*)word, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShmChannel::ChShmChannel()
+: m_impl(0),
+  m_header(0),
+  m_slots(0),
+  m_max_size(0),
+  m_num_slots(0),
+  m_send(0),
+  m_recv(1),
+  m_timeout(1.0),
+  m_spin_count(ChThread::GetNumHardwareThreads() > 1 ? 4000 : 0)
+{
+}
+
+ChShmChannel::~ChShmChannel()
+{
+  Close();
+}
+
+// -----------------------------------------------------------------------------
+// POSIX segment names start with a slash; Windows mapping names must not
+// contain a backslash, so the name is used as given.
+// -----------------------------------------------------------------------------
+bool ChShmChannel::Map(const std::string& name, size_t bytes, bool create)
+{
+  ChShmChannelImpl* impl = new ChShmChannelImpl;
+  void* data = 0;
+
+#ifdef _WIN32
+  if (create)
+    impl->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE,
+                                       (DWORD)((unsigned long long)bytes >> 32), (DWORD)bytes, name.c_str());
+  else
+    impl->mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+  if (impl->mapping)
+    data = MapViewOfFile(impl->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+  if (!data) {
+    if (impl->mapping)
+      CloseHandle(impl->mapping);
+    delete impl;
+    return false;
+  }
+  impl->size = bytes;
+#else
+  std::string shm_name = (!name.empty() && name[0] == '/') ? name : "/" + name;
+  if (create) {
+    shm_unlink(shm_name.c_str());
+    impl->fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (impl->fd >= 0 && ftruncate(impl->fd, (off_t)bytes) != 0) {
+      close(impl->fd);
+      shm_unlink(shm_name.c_str());
+      impl->fd = -1;
+    }
+    impl->name = shm_name;
+  } else {
+    impl->fd = shm_open(shm_name.c_str(), O_RDWR, 0600);
+    struct stat st;
+    if (impl->fd >= 0 && (fstat(impl->fd, &st) != 0 || st.st_size < (off_t)sizeof(ChShmHeader))) {
+      close(impl->fd);
+      impl->fd = -1;
+    }
+    bytes = (impl->fd >= 0) ? (size_t)st.st_size : 0;
+  }
+  if (impl->fd < 0) {
+    delete impl;
+    return false;
+  }
+  data = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, impl->fd, 0);
+  if (data == MAP_FAILED) {
+    close(impl->fd);
+    if (create)
+      shm_unlink(shm_name.c_str());
+    delete impl;
+    return false;
+  }
+  impl->size = bytes;
+#endif
+
+  m_impl = impl;
+  m_header = static_cast<ChShmHeader*>(data);
+  m_slots = reinterpret_cast<double*>(m_header + 1);
+
+  return true;
+}
+
+bool ChShmChannel::Create(const std::string& name, size_t max_size, int num_slots)
+{
+  Close();
+
+  size_t slots = (size_t)(num_slots > 1 ? num_slots : 1);
+  size_t bytes = sizeof(ChShmHeader) + 2 * slots * (max_size + 2) * sizeof(double);
+  if (!Map(name, bytes, true)) {
+    GetLog() << "ERROR: cannot create shared-memory segment " << name.c_str() << "\n";
+    return false;
+  }
+
+  ChShmHeader* header = m_header;
+  header->max_size = max_size;
+  header->num_slots = slots;
+  for (int r = 0; r < 2; r++) {
+    header->ring[r].head = 0;
+    header->ring[r].tail = 0;
+    header->ring[r].seq = 0;
+    header->ring[r].waiting = 0;
+  }
+  ChAtomicStore(&header->magic, SHM_MAGIC);
+
+  m_max_size = max_size;
+  m_num_slots = slots;
+  m_send = 1;
+  m_recv = 0;
+
+  return true;
+}
+
+bool ChShmChannel::Open(const std::string& name)
+{
+  Close();
+
+  if (!Map(name, 0, false)) {
+    GetLog() << "ERROR: cannot open shared-memory segment " << name.c_str() << "\n";
+    return false;
+  }
+
+  if (ChAtomicLoad(&m_header->magic) != SHM_MAGIC) {
+    GetLog() << "ERROR: shared-memory segment " << name.c_str() << " is not initialized\n";
+    Close();
+    return false;
+  }
+
+  m_max_size = m_header->max_size;
+  m_num_slots = m_header->num_slots;
+  m_send = 0;
+  m_recv = 1;
+
+  return true;
+}
+
+void ChShmChannel::Close()
+{
+  ChShmChannelImpl* impl = static_cast<ChShmChannelImpl*>(m_impl);
+  if (!impl)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_header);
+  CloseHandle(impl->mapping);
+#else
+  munmap(m_header, impl->size);
+  close(impl->fd);
+  if (!impl->name.empty())
+    shm_unlink(impl->name.c_str());
+#endif
+
+  delete impl;
+  m_impl = 0;
+  m_header = 0;
+  m_slots = 0;
+  m_max_size = 0;
+  m_num_slots = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double* ChShmChannel::Slot(int ring, size_t index) const
+{
+  return m_slots + ((size_t)ring * m_num_slots + index % m_num_slots) * (m_max_size + 2);
+}
+
+// The sequence number is read before the ring is checked: if the other side
+// pushes or pops in between, the sequence number changes and the futex wait
+// returns at once, so a wake-up cannot be lost even if the other side did not
+// see the waiting flag.
+bool ChShmChannel::Wait(int ring, bool data)
+{
+  ChShmRing& r = m_header->ring[ring];
+
+  for (int i = 0; ; i++) {
+    if (data ? (ChAtomicLoad(&r.head) != r.tail) : (r.head - ChAtomicLoad(&r.tail) < m_num_slots))
+      return true;
+    if (i == m_spin_count)
+      break;
+    CpuPause();
+  }
+
+  double start = ChProfiler::GetTime();
+  for (;;) {
+    int seq = AtomicLoad(&r.seq);
+    AtomicExchange(&r.waiting, 1);
+    if (data ? (ChAtomicLoad(&r.head) != r.tail) : (r.head - ChAtomicLoad(&r.tail) < m_num_slots))
+      return true;
+
+    double remaining = m_timeout - (ChProfiler::GetTime() - start);
+    if (remaining <= 0)
+      return false;
+    SleepOn(&r.seq, seq, remaining);
+  }
+}
+
+void ChShmChannel::Notify(int ring)
+{
+  ChShmRing& r = m_header->ring[ring];
+
+  AtomicIncrement(&r.seq);
+  if (AtomicExchange(&r.waiting, 0))
+    WakeAll(&r.seq);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double* ChShmChannel::BeginSend()
+{
+  if (!Wait(m_send, false))
+    return 0;
+
+  return Slot(m_send, m_header->ring[m_send].head) + 2;
+}
+
+void ChShmChannel::EndSend(int type, size_t size)
+{
+  ChShmRing& r = m_header->ring[m_send];
+  double* slot = Slot(m_send, r.head);
+  slot[0] = (double)type;
+  slot[1] = (double)size;
+
+  ChAtomicStore(&r.head, r.head + 1);
+  Notify(m_send);
+}
+
+bool ChShmChannel::Receive(int& type, size_t& size, const double*& data)
+{
+  if (!Wait(m_recv, true))
+    return false;
+
+  const double* slot = Slot(m_recv, m_header->ring[m_recv].tail);
+  type = (int)slot[0];
+  size = (size_t)slot[1];
+  data = slot + 2;
+
+  return true;
+}
+
+void ChShmChannel::EndReceive()
+{
+  ChShmRing& r = m_header->ring[m_recv];
+
+  ChAtomicStore(&r.tail, r.tail + 1);
+  Notify(m_recv);
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
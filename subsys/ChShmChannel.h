@@ -0,0 +1,139 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Message channel between two processes over a named shared-memory segment.
+//
+// The server process creates the segment and the client process (the
+// simulation) opens it by name. The segment holds two rings of message slots,
+// one for each direction; each ring is a single-producer, single-consumer
+// queue with its head and tail counters on separate cache lines (as in
+// ChSpscQueue). A message is an array of doubles, with an integer type, and is
+// written and read in place, in its slot.
+//
+// A side waiting for a message (or for a free slot) first spins for a short
+// while, which is all it takes when the other process answers within a few
+// microseconds, and then sleeps. On Linux, the sleeping side waits on a futex
+// in the segment, which the other side wakes when it pushes or pops a message
+// (only if a waiter announced itself, so the fast path makes no system call).
+// On other platforms, the sleeping side yields its time slice between checks.
+// Waits give up after a timeout (default: 1 s), e.g. if the other process
+// died.
+//
+// Each side may only be used by one thread at a time.
+//
+// =============================================================================
+
+#ifndef CH_SHM_CHANNEL_H
+#define CH_SHM_CHANNEL_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+struct ChShmHeader;
+
+///
+/// Shared-memory message channel between a server and a client process.
+///
+class CH_SUBSYS_API ChShmChannel
+{
+public:
+
+  ChShmChannel();
+
+  /// Close the channel (if open).
+  ~ChShmChannel();
+
+  /// Create the named segment, as the server side of the channel.
+  /// Returns false if the segment cannot be created.
+  bool Create(
+    const std::string& name,          ///< [in] segment name
+    size_t             max_size,      ///< [in] largest message, in doubles
+    int                num_slots = 4  ///< [in] number of message slots in each direction
+    );
+
+  /// Open the named segment, as the client side of the channel.
+  /// Returns false if the segment does not exist or was not initialized.
+  bool Open(const std::string& name);
+
+  /// Close the channel. The server side removes the segment name.
+  void Close();
+
+  /// Return true if the channel is open.
+  bool IsOpen() const { return m_header != 0; }
+
+  /// Get the largest message, in doubles.
+  size_t GetMaxSize() const { return m_max_size; }
+
+  /// Set the longest wait for a message or a free slot, in seconds.
+  void SetTimeout(double timeout) { m_timeout = timeout; }
+
+  /// Set the number of checks made before a waiting side sleeps (default:
+  /// 4000, a few microseconds, or 0 on a single processor, where spinning
+  /// only delays the other process).
+  void SetSpinCount(int count) { m_spin_count = count; }
+
+  /// Get the slot of the next message to send, waiting for a free slot.
+  /// Returns NULL if no slot was freed before the timeout.
+  double* BeginSend();
+
+  /// Send the message written in the slot returned by BeginSend().
+  void EndSend(
+    int    type,     ///< [in] message type
+    size_t size      ///< [in] message size, in doubles (at most GetMaxSize())
+    );
+
+  /// Wait for the next received message. The message stays in its slot until
+  /// EndReceive() is called.
+  /// Returns false if no message arrived before the timeout.
+  bool Receive(
+    int&           type,   ///< [out] message type
+    size_t&        size,   ///< [out] message size, in doubles
+    const double*& data    ///< [out] message values
+    );
+
+  /// Release the slot of the message returned by Receive().
+  void EndReceive();
+
+private:
+
+  ChShmChannel(const ChShmChannel&);
+  ChShmChannel& operator=(const ChShmChannel&);
+
+  bool Map(const std::string& name, size_t bytes, bool create);
+  double* Slot(int ring, size_t index) const;
+  bool Wait(int ring, bool data);
+  void Notify(int ring);
+
+  void*        m_impl;        // platform handles
+  ChShmHeader* m_header;      // start of the mapped segment
+  double*      m_slots;
+  size_t       m_max_size;
+  size_t       m_num_slots;
+  int          m_send;        // ring used to send (0: client to server, 1: server to client)
+  int          m_recv;        // ring used to receive
+  double       m_timeout;
+  int          m_spin_count;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
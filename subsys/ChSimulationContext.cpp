@@ -0,0 +1,68 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Per-simulation context: data paths and log sink of one simulation.
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static CH_THREAD_LOCAL ChSimulationContext* s_current = 0;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChStreamOutAscii& ChSimulationContext::GetLog() const
+{
+  if (m_log)
+    return *m_log;
+  return chrono::GetLog();
+}
+
+ChSimulationContext* ChSimulationContext::GetCurrent()
+{
+  return s_current;
+}
+
+ChSimulationContext::Scope::Scope(ChSimulationContext& context)
+: m_previous(s_current)
+{
+  s_current = &context;
+}
+
+ChSimulationContext::Scope::~Scope()
+{
+  s_current = m_previous;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChStreamOutAscii& GetContextLog()
+{
+  if (s_current)
+    return s_current->GetLog();
+  return chrono::GetLog();
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,111 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Per-simulation context: data paths and log sink of one simulation.
+//
+// The data directories (see GetDataFile() and utils::GetValidationDataFile())
+// and the messages of the vehicle subsystems (see GetContextLog()) are looked
+// up in the context made current on the calling thread with a
+// ChSimulationContext::Scope. Without a current context, or for the settings
+// not made in that context, the process-wide settings (SetDataPath(),
+// utils::SetValidationDataPath(), chrono::GetLog()) are used, as before.
+//
+// A context is not shared between threads: independent simulations running
+// on separate threads, each with its own context and log sink, neither share
+// mutable state nor wait on each other. The instrumentation (ChProfiler)
+// already accumulates per thread and needs no context.
+//
+// =============================================================================
+
+#ifndef CH_SIMULATION_CONTEXT_H
+#define CH_SIMULATION_CONTEXT_H
+
+#include <string>
+
+#include "core/ChStream.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Data paths and log sink of one simulation.
+///
+class CH_SUBSYS_API ChSimulationContext
+{
+public:
+
+  /// Create a context using the process-wide data paths and chrono::GetLog().
+  ChSimulationContext() : m_log(0) {}
+
+  ~ChSimulationContext() {}
+
+  /// Set the path to the ChronoVehicle data directory. If empty (default),
+  /// use the process-wide path.
+  void SetDataPath(const std::string& path) { m_data_path = path; }
+  const std::string& GetDataPath() const { return m_data_path; }
+
+  /// Set the path to the reference validation data directory. If empty
+  /// (default), use the process-wide path.
+  void SetValidationDataPath(const std::string& path) { m_validation_path = path; }
+  const std::string& GetValidationDataPath() const { return m_validation_path; }
+
+  /// Set the stream receiving the messages of this simulation (not owned by
+  /// the context). If null, use chrono::GetLog(), which is shared by all
+  /// threads.
+  void SetLog(ChStreamOutAscii* log) { m_log = log; }
+
+  /// Get the stream receiving the messages of this simulation.
+  ChStreamOutAscii& GetLog() const;
+
+  /// Get the context current on the calling thread (null if none).
+  static ChSimulationContext* GetCurrent();
+
+  ///
+  /// Make a context current on the calling thread, for the lifetime of the
+  /// scope object. Scopes can be nested; the previous context is restored.
+  ///
+  class CH_SUBSYS_API Scope
+  {
+  public:
+    explicit Scope(ChSimulationContext& context);
+    ~Scope();
+
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+
+    ChSimulationContext* m_previous;
+  };
+
+private:
+
+  std::string        m_data_path;
+  std::string        m_validation_path;
+  ChStreamOutAscii*  m_log;
+};
+
+
+/// Get the stream receiving the messages of the current simulation: the log of
+/// the context current on the calling thread, or chrono::GetLog().
+CH_SUBSYS_API ChStreamOutAscii& GetContextLog();
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,169 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Named settings of the Chrono LCP solver and per-step solver statistics.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "lcp/ChLcpIterativeSolver.h"
+
+#include "subsys/ChSolverProfile.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSolverProfile::ChSolverProfile()
+{
+  Get("batch", *this);
+}
+
+bool ChSolverProfile::Get(const std::string& name, ChSolverProfile& profile)
+{
+  if (name == "realtime") {
+    profile.solver_type = ChSystem::LCP_ITERATIVE_SOR;
+    profile.max_iters_speed = 40;
+    profile.max_iters_stab = 20;
+    profile.tolerance = 1e-3;
+    profile.max_recovery_speed = 4.0;
+    profile.warm_start = true;
+  } else if (name == "batch") {
+    profile.solver_type = ChSystem::LCP_ITERATIVE_SOR;
+    profile.max_iters_speed = 150;
+    profile.max_iters_stab = 150;
+    profile.tolerance = 2e-4;
+    profile.max_recovery_speed = 4.0;
+    profile.warm_start = true;
+  } else if (name == "accurate") {
+    profile.solver_type = ChSystem::LCP_ITERATIVE_APGD;
+    profile.max_iters_speed = 1000;
+    profile.max_iters_stab = 500;
+    profile.tolerance = 1e-6;
+    profile.max_recovery_speed = 1.0;
+    profile.warm_start = true;
+  } else if (name == "direct") {
+    profile.solver_type = ChSystem::LCP_SIMPLEX;
+    profile.max_iters_speed = 1;
+    profile.max_iters_stab = 1;
+    profile.tolerance = 0;
+    profile.max_recovery_speed = 4.0;
+    profile.warm_start = false;
+  } else {
+    return false;
+  }
+
+  profile.name = name;
+  return true;
+}
+
+bool ChSolverProfile::SetSolverType(const std::string& type_name)
+{
+  if (type_name == "SOR")
+    solver_type = ChSystem::LCP_ITERATIVE_SOR;
+  else if (type_name == "BARZILAIBORWEIN")
+    solver_type = ChSystem::LCP_ITERATIVE_BARZILAIBORWEIN;
+  else if (type_name == "APGD")
+    solver_type = ChSystem::LCP_ITERATIVE_APGD;
+  else if (type_name == "SIMPLEX")
+    solver_type = ChSystem::LCP_SIMPLEX;
+  else
+    return false;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Setting the solver type replaces the solvers of the system, so the solver
+// tolerances and the violation recording are set last.
+// -----------------------------------------------------------------------------
+void ChSolverProfile::Apply(ChSystem* system) const
+{
+  system->SetLcpSolverType(solver_type);
+  system->SetIterLCPmaxItersSpeed(max_iters_speed);
+  system->SetIterLCPmaxItersStab(max_iters_stab);
+  system->SetIterLCPwarmStarting(warm_start);
+  system->SetMaxPenetrationRecoverySpeed(max_recovery_speed);
+  system->SetTol(tolerance);
+
+  if (ChLcpIterativeSolver* speed_solver = dynamic_cast<ChLcpIterativeSolver*>(system->GetLcpSolverSpeed())) {
+    speed_solver->SetTolerance(tolerance);
+    speed_solver->SetRecordViolation(true);
+  }
+  if (ChLcpIterativeSolver* stab_solver = dynamic_cast<ChLcpIterativeSolver*>(system->GetLcpSolverStab()))
+    stab_solver->SetTolerance(tolerance);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSolverStats::Reset()
+{
+  m_num_steps = 0;
+  m_iterations = 0;
+  m_residual = 0;
+  m_sum_iterations = 0;
+  m_max_iterations = 0;
+  m_max_residual = 0;
+  m_num_warm = 0;
+  m_sum_iterations_warm = 0;
+}
+
+// The violation history of the speed solver holds one entry per iteration of
+// the last solve (it is only recorded once a profile was applied).
+void ChSolverStats::Record(ChSystem* system)
+{
+  ChLcpIterativeSolver* speed_solver = dynamic_cast<ChLcpIterativeSolver*>(system->GetLcpSolverSpeed());
+  if (!speed_solver)
+    return;
+
+  const std::vector<double>& history = speed_solver->GetViolationHistory();
+  Record((int)history.size(), history.empty() ? 0 : history.back(), system->GetIterLCPwarmStarting());
+}
+
+void ChSolverStats::Record(int iterations, double residual, bool warm_started)
+{
+  m_num_steps++;
+  m_iterations = iterations;
+  m_residual = residual;
+  m_sum_iterations += iterations;
+  m_max_iterations = std::max(m_max_iterations, iterations);
+  m_max_residual = std::max(m_max_residual, residual);
+
+  if (warm_started) {
+    m_num_warm++;
+    m_sum_iterations_warm += iterations;
+  }
+}
+
+double ChSolverStats::GetMeanIterationsCold() const
+{
+  int num_cold = m_num_steps - m_num_warm;
+  return num_cold > 0 ? (double)(m_sum_iterations - m_sum_iterations_warm) / num_cold : 0;
+}
+
+double ChSolverStats::GetWarmStartReduction() const
+{
+  double cold = GetMeanIterationsCold();
+  if (m_num_warm == 0 || cold <= 0)
+    return 0;
+
+  return 1 - GetMeanIterationsWarm() / cold;
+}
+
+
+}  // end namespace chrono
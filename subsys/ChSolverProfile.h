@@ -0,0 +1,159 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Named settings of the Chrono LCP solver and per-step solver statistics.
+//
+// A profile sets the solver type, the iteration caps for the speed and the
+// stabilization problems, and the tolerance on the constraint violation at
+// which the iterative solvers exit early. The predefined profiles are:
+//
+//   realtime   SOR,   40 /  20 iterations, tolerance 1e-3, warm start
+//   batch      SOR,  150 / 150 iterations, tolerance 2e-4, warm start
+//   accurate   APGD, 1000 / 500 iterations, tolerance 1e-6, warm start
+//   direct     simplex (direct) solver
+//
+// The direct profile is meant for systems without frictional contacts, i.e.
+// with bilateral joints, shafts and springs only (e.g. vehicles with Pacejka or
+// LuGre tires on a terrain that is not a collision body): the simplex solver
+// then enforces the joints exactly at every step (see
+// ChVehicle::EnableDirectSolver()).
+//
+// Applying a profile also enables the recording of the violation history in
+// the iterative speed solver, from which ChSolverStats obtains the number of
+// iterations used and the final residual of each step.
+//
+// With warm starting, the iterative solvers start from the multipliers of the
+// previous step (kept in the constraints of the system) instead of zero. For a
+// vehicle on smooth ground, the reactions in the suspension joints and the
+// driveline change little from one step to the next, so the solvers reach the
+// tolerance in fewer iterations. ChSolverStats keeps separate means for the
+// steps with and without warm starting, from which the achieved reduction in
+// iterations is obtained.
+//
+// =============================================================================
+
+#ifndef CH_SOLVER_PROFILE_H
+#define CH_SOLVER_PROFILE_H
+
+#include <string>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Settings of the Chrono LCP solver.
+///
+struct CH_SUBSYS_API ChSolverProfile
+{
+  std::string             name;                ///< profile name
+  ChSystem::eCh_lcpSolver solver_type;         ///< LCP solver type
+  int                     max_iters_speed;     ///< iteration cap, speed problem
+  int                     max_iters_stab;      ///< iteration cap, stabilization problem
+  double                  tolerance;           ///< max. constraint violation for early exit
+  double                  max_recovery_speed;  ///< max. penetration recovery speed
+  bool                    warm_start;          ///< warm start the iterative solvers
+
+  /// Construct the "batch" profile.
+  ChSolverProfile();
+
+  /// Set the specified profile to one of the predefined profiles ("realtime",
+  /// "batch", "accurate" or "direct").
+  /// Returns false if there is no profile with the specified name.
+  static bool Get(
+    const std::string& name,      ///< [in] profile name
+    ChSolverProfile&   profile    ///< [out] profile settings
+    );
+
+  /// Set the solver type from its name ("SOR", "BARZILAIBORWEIN", "APGD" or
+  /// "SIMPLEX").
+  /// Returns false if the name is not recognized.
+  bool SetSolverType(const std::string& type_name);
+
+  /// Apply these settings to the specified Chrono system.
+  void Apply(ChSystem* system) const;
+};
+
+///
+/// Iterations used and final residual of the LCP speed solver, over a sequence
+/// of steps.
+///
+class CH_SUBSYS_API ChSolverStats
+{
+public:
+
+  ChSolverStats() { Reset(); }
+
+  /// Reset the statistics.
+  void Reset();
+
+  /// Record the iterations used and the residual of the last step of the
+  /// specified system. Nothing is recorded for a direct solver.
+  void Record(ChSystem* system);
+
+  /// Record the iterations used and the residual of a step.
+  void Record(
+    int    iterations,     ///< [in] iterations used by the speed solver
+    double residual,       ///< [in] final max. constraint violation
+    bool   warm_started    ///< [in] the solver was warm started
+    );
+
+  /// Get the number of recorded steps.
+  int GetNumSteps() const { return m_num_steps; }
+
+  /// Get the iterations used at the last recorded step.
+  int GetIterations() const { return m_iterations; }
+
+  /// Get the residual (max. constraint violation) at the last recorded step.
+  double GetResidual() const { return m_residual; }
+
+  /// Get the mean number of iterations over the recorded steps.
+  double GetMeanIterations() const { return m_num_steps > 0 ? (double)m_sum_iterations / m_num_steps : 0; }
+
+  /// Get the largest number of iterations over the recorded steps.
+  int GetMaxIterations() const { return m_max_iterations; }
+
+  /// Get the largest residual over the recorded steps.
+  double GetMaxResidual() const { return m_max_residual; }
+
+  /// Get the mean number of iterations over the warm started steps.
+  double GetMeanIterationsWarm() const { return m_num_warm > 0 ? (double)m_sum_iterations_warm / m_num_warm : 0; }
+
+  /// Get the mean number of iterations over the steps without warm starting.
+  double GetMeanIterationsCold() const;
+
+  /// Get the relative reduction of the mean number of iterations achieved by
+  /// warm starting (0 if either kind of step was not recorded).
+  double GetWarmStartReduction() const;
+
+private:
+
+  int    m_num_steps;
+  int    m_iterations;
+  double m_residual;
+  long   m_sum_iterations;
+  int    m_max_iterations;
+  double m_max_residual;
+  int    m_num_warm;
+  long   m_sum_iterations_warm;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,121 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Bounded lock-free queue for a single producer thread and a single consumer
+// thread.
+//
+// The producer only writes the head counter and the consumer only writes the
+// tail counter; each reads the other's counter with acquire semantics, so
+// neither side ever blocks. The counters are kept on separate cache lines.
+//
+// =============================================================================
+
+#ifndef CH_SPSC_QUEUE_H
+#define CH_SPSC_QUEUE_H
+
+#include <vector>
+
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Single-producer, single-consumer bounded queue.
+/// Push() may only be called from one (producer) thread and Pop() and Peek()
+/// from one (consumer) thread.
+///
+template <typename T>
+class ChSpscQueue
+{
+public:
+
+  /// Create a queue holding up to the specified number of elements (rounded up
+  /// to a power of two).
+  ChSpscQueue(size_t capacity = 1024)
+  : m_head(0),
+    m_tail(0)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+    m_buffer.resize(size);
+    m_mask = size - 1;
+  }
+
+  /// Get the capacity of the queue.
+  size_t GetCapacity() const { return m_buffer.size(); }
+
+  /// Get the number of queued elements (exact only when called from the
+  /// producer or the consumer thread while the other one is idle).
+  size_t GetSize() const { return ChAtomicLoad(&m_head) - ChAtomicLoad(&m_tail); }
+
+  /// Append an element (producer thread). Returns false if the queue is full.
+  bool Push(const T& val)
+  {
+    size_t head = m_head;
+    if (head - ChAtomicLoad(&m_tail) == m_buffer.size())
+      return false;
+    m_buffer[head & m_mask] = val;
+    ChAtomicStore(&m_head, head + 1);
+    return true;
+  }
+
+  /// Get a copy of the oldest element without removing it (consumer thread).
+  /// Returns false if the queue is empty.
+  bool Peek(T& val) const
+  {
+    size_t tail = m_tail;
+    if (ChAtomicLoad(&m_head) == tail)
+      return false;
+    val = m_buffer[tail & m_mask];
+    return true;
+  }
+
+  /// Remove the oldest element (consumer thread).
+  /// Returns false if the queue is empty.
+  bool Pop(T& val)
+  {
+    size_t tail = m_tail;
+    if (ChAtomicLoad(&m_head) == tail)
+      return false;
+    val = m_buffer[tail & m_mask];
+    ChAtomicStore(&m_tail, tail + 1);
+    return true;
+  }
+
+private:
+
+  ChSpscQueue(const ChSpscQueue&);
+  ChSpscQueue& operator=(const ChSpscQueue&);
+
+  enum { CACHE_LINE = 64 };
+
+  std::vector<T>   m_buffer;
+  size_t           m_mask;
+
+  char             m_pad0[CACHE_LINE];
+  volatile size_t  m_head;    // number of elements pushed (written by the producer)
+  char             m_pad1[CACHE_LINE - sizeof(size_t)];
+  volatile size_t  m_tail;    // number of elements popped (written by the consumer)
+  char             m_pad2[CACHE_LINE - sizeof(size_t)];
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
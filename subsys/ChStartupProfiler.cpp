@@ -0,0 +1,289 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hierarchical profiling of the construction of the vehicle modules.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+struct ChStartupNode {
+  ChStartupNode(int phase_, int parent_) : phase(phase_), parent(parent_), count(0), total(0), allocs(0) {}
+
+  int               phase;
+  int               parent;     // -1 for a top-level phase
+  std::vector<int>  children;
+  long              count;
+  double            total;      // inclusive time
+  long              allocs;     // inclusive allocations
+};
+
+static ChMutex                     s_startup_mutex;
+static std::vector<std::string>    s_phases;
+static std::vector<ChStartupNode>  s_nodes;
+static std::vector<int>            s_roots;
+static const volatile long*        s_alloc_counter = 0;
+static double                      s_window_start = 0;
+static double                      s_window_total = 0;   // recorded time of the closed windows
+
+// Node of the innermost open phase of the calling thread (-1: none).
+static CH_THREAD_LOCAL int         s_current_node = -1;
+
+bool ChStartupProfiler::s_recording = false;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChStartupProfiler::RegisterPhase(const char* name)
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  for (size_t i = 0; i < s_phases.size(); i++) {
+    if (s_phases[i] == name)
+      return (int)i;
+  }
+
+  s_phases.push_back(name);
+  return (int)s_phases.size() - 1;
+}
+
+void ChStartupProfiler::Start()
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  if (s_recording)
+    return;
+  s_window_start = ChProfiler::GetTime();
+  s_recording = true;
+}
+
+void ChStartupProfiler::Stop()
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  if (!s_recording)
+    return;
+  s_window_total += ChProfiler::GetTime() - s_window_start;
+  s_recording = false;
+}
+
+void ChStartupProfiler::SetAllocationCounter(const volatile long* counter)
+{
+  s_alloc_counter = counter;
+}
+
+void ChStartupProfiler::Reset()
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  s_nodes.clear();
+  s_roots.clear();
+  s_window_total = 0;
+  s_window_start = ChProfiler::GetTime();
+}
+
+long ChStartupProfiler::GetAllocations()
+{
+  return s_alloc_counter ? *s_alloc_counter : 0;
+}
+
+// -----------------------------------------------------------------------------
+// A phase entered again under the same parent reuses its node.
+// -----------------------------------------------------------------------------
+int ChStartupProfiler::Enter(int phase)
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  int parent = s_current_node;
+  if (parent >= (int)s_nodes.size())   // nodes discarded by Reset()
+    parent = -1;
+
+  std::vector<int>& siblings = (parent < 0) ? s_roots : s_nodes[parent].children;
+  int node = -1;
+  for (size_t i = 0; i < siblings.size() && node < 0; i++) {
+    if (s_nodes[siblings[i]].phase == phase)
+      node = siblings[i];
+  }
+
+  if (node < 0) {
+    node = (int)s_nodes.size();
+    s_nodes.push_back(ChStartupNode(phase, parent));
+    // the vector may have been reallocated
+    ((parent < 0) ? s_roots : s_nodes[parent].children).push_back(node);
+  }
+
+  s_current_node = node;
+  return node;
+}
+
+void ChStartupProfiler::Leave(int node, double start, long allocs)
+{
+  double duration = ChProfiler::GetTime() - start;
+  long num_allocs = GetAllocations() - allocs;
+
+  ChScopedLock lock(s_startup_mutex);
+
+  if (node >= (int)s_nodes.size()) {
+    s_current_node = -1;
+    return;
+  }
+
+  ChStartupNode& entry = s_nodes[node];
+  entry.count++;
+  entry.total += duration;
+  entry.allocs += num_allocs;
+
+  s_current_node = entry.parent;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChStartupScope::ChStartupScope(int phase)
+: m_node(-1), m_start(0), m_allocs(0)
+{
+  if (!ChStartupProfiler::IsRecording())
+    return;
+
+  m_node = ChStartupProfiler::Enter(phase);
+  m_allocs = ChStartupProfiler::GetAllocations();
+  m_start = ChProfiler::GetTime();
+}
+
+ChStartupScope::~ChStartupScope()
+{
+  if (m_node >= 0)
+    ChStartupProfiler::Leave(m_node, m_start, m_allocs);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+struct ChStartupOrder {
+  bool operator()(int a, int b) const { return s_nodes[a].total > s_nodes[b].total; }
+};
+
+// Depth-first list of the nodes below the specified ones, with their depths.
+static void list_nodes(std::vector<int> nodes, int depth, std::vector<int>& order, std::vector<int>& depths)
+{
+  std::sort(nodes.begin(), nodes.end(), ChStartupOrder());
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    order.push_back(nodes[i]);
+    depths.push_back(depth);
+    list_nodes(s_nodes[nodes[i]].children, depth + 1, order, depths);
+  }
+}
+
+static void self_cost(const ChStartupNode& node, double& time, long& allocs)
+{
+  time = node.total;
+  allocs = node.allocs;
+  for (size_t i = 0; i < node.children.size(); i++) {
+    time -= s_nodes[node.children[i]].total;
+    allocs -= s_nodes[node.children[i]].allocs;
+  }
+}
+
+static double recorded_time()
+{
+  double total = s_window_total;
+  if (ChStartupProfiler::IsRecording())
+    total += ChProfiler::GetTime() - s_window_start;
+  return total;
+}
+
+void ChStartupProfiler::PrintSummary()
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  std::vector<int> order;
+  std::vector<int> depths;
+  list_nodes(s_roots, 0, order, depths);
+
+  double window = recorded_time();
+  double outside = window;
+  for (size_t i = 0; i < s_roots.size(); i++)
+    outside -= s_nodes[s_roots[i]].total;
+
+  char line[256];
+  sprintf(line, "%-48s %8s %12s %12s %8s %10s %11s\n",
+          "phase", "calls", "total [ms]", "self [ms]", "%", "allocs", "self allocs");
+  GetLog() << line;
+
+  for (size_t j = 0; j < order.size(); j++) {
+    const ChStartupNode& node = s_nodes[order[j]];
+    double self_time;
+    long self_allocs;
+    self_cost(node, self_time, self_allocs);
+
+    std::string name = std::string(2 * depths[j], ' ') + s_phases[node.phase];
+    sprintf(line, "%-48s %8ld %12.3f %12.3f %8.1f %10ld %11ld\n",
+            name.c_str(), node.count, 1e3 * node.total, 1e3 * self_time,
+            window > 0 ? 100 * node.total / window : 0.0, node.allocs, self_allocs);
+    GetLog() << line;
+  }
+
+  sprintf(line, "%-48s %8s %12.3f %12.3f %8.1f\n", "(outside all phases)", "", 1e3 * outside, 1e3 * outside,
+          window > 0 ? 100 * outside / window : 0.0);
+  GetLog() << line;
+  sprintf(line, "%-48s %8s %12.3f\n", "(recorded time)", "", 1e3 * window);
+  GetLog() << line;
+}
+
+bool ChStartupProfiler::WriteCSV(const std::string& filename)
+{
+  ChScopedLock lock(s_startup_mutex);
+
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp)
+    return false;
+
+  std::vector<int> order;
+  std::vector<int> depths;
+  list_nodes(s_roots, 0, order, depths);
+
+  fprintf(fp, "path,depth,calls,total_ms,self_ms,allocs,self_allocs\n");
+
+  for (size_t j = 0; j < order.size(); j++) {
+    const ChStartupNode& node = s_nodes[order[j]];
+    double self_time;
+    long self_allocs;
+    self_cost(node, self_time, self_allocs);
+
+    std::string path = s_phases[node.phase];
+    for (int p = node.parent; p >= 0; p = s_nodes[p].parent)
+      path = s_phases[s_nodes[p].phase] + "/" + path;
+
+    fprintf(fp, "\"%s\",%d,%ld,%.6f,%.6f,%ld,%ld\n", path.c_str(), depths[j], node.count, 1e3 * node.total,
+            1e3 * self_time, node.allocs, self_allocs);
+  }
+
+  fclose(fp);
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
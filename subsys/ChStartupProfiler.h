@@ -0,0 +1,145 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hierarchical profiling of the construction of the vehicle modules.
+//
+// The phases of the construction pipeline (JSON parsing, mesh loading, tire
+// parameter files, creation of the bodies and joints of each subsystem, ...)
+// are instrumented with the CH_STARTUP_SCOPE macro, which times the enclosing
+// scope as a child of the phase that encloses it, so that the phases form a
+// tree (a phase called from several parents appears under each of them). Each
+// node accumulates its number of calls, its total time and, if an allocation
+// counter is set, the number of heap allocations made during the phase.
+// Phases are only recorded between Start() and Stop(); PrintSummary() then
+// gives the inclusive and exclusive ("self") cost of each node and the part
+// of the recorded time spent outside all phases.
+//
+// The library cannot count allocations by itself: an application counting
+// them (e.g. with a replacement of the global operator new, as bench_vehicle)
+// passes its counter to SetAllocationCounter(). The counter is global, so
+// phases that run concurrently in several threads are charged with each
+// other's allocations.
+//
+// A phase is also a section of ChProfiler, so that it appears in its Chrome
+// trace. The macro compiles to nothing unless ChronoVehicle is configured with
+// ENABLE_PROFILING.
+//
+// =============================================================================
+
+#ifndef CH_STARTUP_PROFILER_H
+#define CH_STARTUP_PROFILER_H
+
+#include <string>
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Tree of the construction phases, with their times and allocation counts.
+///
+class CH_SUBSYS_API ChStartupProfiler
+{
+public:
+
+  /// Return the identifier of the phase with the specified name, creating the
+  /// phase if needed.
+  static int RegisterPhase(const char* name);
+
+  /// Start recording the phases (e.g. before the construction of the modules).
+  static void Start();
+
+  /// Stop recording the phases.
+  static void Stop();
+
+  /// Return true if the phases are recorded.
+  static bool IsRecording() { return s_recording; }
+
+  /// Set the counter of heap allocations, incremented by the application at
+  /// each allocation (NULL: allocations are not counted).
+  static void SetAllocationCounter(const volatile long* counter);
+
+  /// Discard all recorded phases.
+  static void Reset();
+
+  /// Print the tree of the recorded phases, with the children of a node
+  /// sorted by decreasing total time.
+  static void PrintSummary();
+
+  /// Write the recorded phases as CSV, one line per node, identified by the
+  /// path of its phase names ("parent/child"). Returns false if the file
+  /// cannot be opened.
+  static bool WriteCSV(const std::string& filename);
+
+private:
+
+  friend class ChStartupScope;
+
+  // Enter the specified phase (as a child of the current phase of the calling
+  // thread) and return its node; leave it, recording one call.
+  static int Enter(int phase);
+  static void Leave(int node, double start, long allocs);
+
+  static long GetAllocations();
+
+  static bool s_recording;
+};
+
+///
+/// Time the lifetime of this object as one call of a construction phase.
+///
+class CH_SUBSYS_API ChStartupScope
+{
+public:
+  explicit ChStartupScope(int phase);
+  ~ChStartupScope();
+
+private:
+  ChStartupScope(const ChStartupScope&);
+  ChStartupScope& operator=(const ChStartupScope&);
+
+  int     m_node;     // -1 if not recording
+  double  m_start;
+  long    m_allocs;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#if PROFILING_ENABLED
+
+/// Time the rest of the enclosing scope as one call of the named construction
+/// phase (also a ChProfiler section).
+# define CH_STARTUP_SCOPE(name) \
+    CH_PROFILE_SCOPE(name); \
+    static const int CH_PROFILE_CONCAT(ch_startup_phase_, __LINE__) = \
+      chrono::vehicle::ChStartupProfiler::RegisterPhase(name); \
+    chrono::vehicle::ChStartupScope CH_PROFILE_CONCAT(ch_startup_scope_, __LINE__)( \
+      CH_PROFILE_CONCAT(ch_startup_phase_, __LINE__))
+
+#else
+
+# define CH_STARTUP_SCOPE(name)
+
+#endif
+
+
+#endif
@@ -16,6 +16,8 @@
 //
 // =============================================================================
 
+#include <algorithm>
+#include <cassert>
 
 #include "subsys/ChSteering.h"
 
@@ -24,9 +26,93 @@ namespace chrono {
 
 
 ChSteering::ChSteering(const std::string& name)
-: m_name(name)
+: m_name(name),
+  m_kinematic(false),
+  m_num_points(101)
 {
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSteering::SetKinematicMode(bool val, int num_points)
+{
+  assert(num_points >= 2);
+
+  m_kinematic = val;
+  m_num_points = num_points;
+}
+
+
+// -----------------------------------------------------------------------------
+// The table holds, for each steering input, the displacement and the RXYZ
+// angles of the steering link relative to its initial frame; these are the
+// relative motions imposed by the lock (marker on the link relative to marker
+// on the chassis, both at the initial link frame).
+// -----------------------------------------------------------------------------
+void ChSteering::InitializeKinematicMode(ChSharedPtr<ChBodyAuxRef> chassis)
+{
+  m_table.resize(6 * m_num_points);
+
+  for (int i = 0; i < m_num_points; i++) {
+    double steering = -1 + 2.0 * i / (m_num_points - 1);
+    ChCoordsys<> motion = GetSteeringLinkMotion(steering);
+    ChVector<> angles = Quat_to_Angle(ANGLESET_RXYZ, &motion.rot);
+
+    double* row = &m_table[6 * i];
+    row[0] = motion.pos.x;
+    row[1] = motion.pos.y;
+    row[2] = motion.pos.z;
+    row[3] = angles.x;
+    row[4] = angles.y;
+    row[5] = angles.z;
+  }
+
+  for (int j = 0; j < 6; j++)
+    m_motion[j] = ChSharedPtr<ChFunction_Const>(new ChFunction_Const(0));
+
+  m_lock = ChSharedPtr<ChLinkLockLock>(new ChLinkLockLock);
+  m_lock->SetNameString(m_name + "_lock");
+  m_lock->Set_angleset(ANGLESET_RXYZ);
+  m_lock->SetMotion_X(m_motion[0]);
+  m_lock->SetMotion_Y(m_motion[1]);
+  m_lock->SetMotion_Z(m_motion[2]);
+  m_lock->SetMotion_ang(m_motion[3]);
+  m_lock->SetMotion_ang2(m_motion[4]);
+  m_lock->SetMotion_ang3(m_motion[5]);
+  m_lock->Initialize(m_link, chassis, m_link->GetCoord());
+  chassis->GetSystem()->AddLink(m_lock);
+
+  UpdateKinematicMode(0);
+}
+
+void ChSteering::UpdateKinematicMode(double steering)
+{
+  double x = 0.5 * (std::min(std::max(steering, -1.0), 1.0) + 1) * (m_num_points - 1);
+  int i = std::min((int)x, m_num_points - 2);
+  double t = x - i;
+
+  const double* row0 = &m_table[6 * i];
+  const double* row1 = row0 + 6;
+
+  for (int j = 0; j < 6; j++)
+    m_motion[j]->Set_yconst(row0[j] + t * (row1[j] - row0[j]));
+}
+
+void ChSteering::GetConstraints(std::vector<ChLink*>& links) const
+{
+  if (m_kinematic && !m_lock.IsNull())
+    links.push_back(m_lock.get_ptr());
+}
+
+void ChSteering::LogKinematicModeViolations()
+{
+  ChMatrix<>* C = m_lock->GetC();
+  GetLog() << "Lock                ";
+  for (int j = 0; j < 6; j++)
+    GetLog() << "  " << C->GetElement(j, 0) << "  ";
+  GetLog() << "\n";
+}
+
+
 }  // end namespace chrono
@@ -14,18 +14,30 @@
 //
 // Base class for a steering subsystem.
 //
+// A steering subsystem can be used in kinematic mode, in which the steering
+// linkage is not modeled. At initialization, the pose of the steering link
+// relative to the chassis is tabulated over the full steering range (using the
+// linkage kinematics provided by the derived class) and the linkage bodies and
+// joints are not created. During the simulation, the steering link is locked
+// to the chassis with a relative pose interpolated from this table, so that
+// the tierods of a steerable suspension remain attached to the steering link.
+//
 // =============================================================================
 
 #ifndef CH_STEERING_H
 #define CH_STEERING_H
 
 #include <string>
+#include <vector>
 
 #include "core/ChShared.h"
 #include "physics/ChSystem.h"
 #include "physics/ChBodyAuxRef.h"
+#include "physics/ChLinkLock.h"
+#include "motion_functions/ChFunction_Const.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysHeap.h"
 
 namespace chrono {
 
@@ -42,6 +54,10 @@ public:
 
   virtual ~ChSteering() {}
 
+  /// Allocate subsystem objects from the contiguous subsystem heap.
+  static void* operator new(size_t size) { return vehicle::ChSubsysHeap::Allocate(size); }
+  static void operator delete(void* ptr) { vehicle::ChSubsysHeap::Free(ptr); }
+
   /// Get the name identifier for this steering subsystem.
   const std::string& GetName() const { return m_name; }
 
@@ -53,6 +69,14 @@ public:
   /// suspension subsystem are attached.
   ChSharedPtr<ChBody>  GetSteeringLink() const { return m_link; }
 
+  /// Enable or disable the kinematic steering mode (default: disabled), with
+  /// the specified number of table points over the steering range [-1,+1].
+  /// Must be called before Initialize().
+  void SetKinematicMode(bool val, int num_points = 101);
+
+  /// Return true if the steering subsystem is in kinematic mode.
+  bool IsKinematicMode() const { return m_kinematic; }
+
   /// Initialize this steering subsystem.
   /// The steering subsystem is initialized by attaching it to the specified 
   /// chassis body at the specified location (with respect to and expressed in
@@ -76,11 +100,42 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations() {}
 
+  /// Append the joints of this steering subsystem to the specified list, e.g.
+  /// to monitor their violations (see ChConstraintMonitor). The default
+  /// implementation adds the steering link lock in kinematic mode.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
 protected:
 
+  /// Return the pose of the steering link for the specified steering input,
+  /// relative to (and expressed in) the frame of the steering link at zero
+  /// steering input. Only used in kinematic mode; the default implementation
+  /// returns the identity (no motion).
+  virtual ChCoordsys<> GetSteeringLinkMotion(double steering) { return ChCoordsys<>(); }
+
+  /// Tabulate the steering link motion and lock the steering link, already in
+  /// its initial pose, to the chassis (kinematic mode).
+  void InitializeKinematicMode(ChSharedPtr<ChBodyAuxRef> chassis);
+
+  /// Impose the steering link motion for the specified steering input
+  /// (kinematic mode).
+  void UpdateKinematicMode(double steering);
+
+  /// Log the constraint violations of the steering link lock (kinematic mode).
+  void LogKinematicModeViolations();
+
   std::string  m_name;          ///< name of the subsystem
 
   ChSharedPtr<ChBody>  m_link;  ///< handle to the main steering link
+
+  bool                 m_kinematic;   ///< true if in kinematic mode
+
+private:
+
+  int                                m_num_points;
+  std::vector<double>                m_table;        // per point: displacement, RXYZ angles
+  ChSharedPtr<ChLinkLockLock>        m_lock;
+  ChSharedPtr<ChFunction_Const>      m_motion[6];
 };
 
 
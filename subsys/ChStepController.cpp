@@ -0,0 +1,164 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Event-aware selection of the integration step of a vehicle.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChStepController.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChStepController::ChStepController()
+: m_min_step(1e-4),
+  m_max_step(4e-3),
+  m_shrink(0.5),
+  m_growth(1.25),
+  m_smooth_steps(10),
+  m_accel_threshold(500),
+  m_violation_tol(1e-4),
+  m_violation_growth(2)
+{
+  SetHistogramBins(20);
+  Reset(1e-3);
+}
+
+void ChStepController::SetStepRange(double min_step, double max_step)
+{
+  m_min_step = min_step;
+  m_max_step = std::max(max_step, min_step);
+  m_step = std::min(std::max(m_step, m_min_step), m_max_step);
+  SetHistogramBins(GetNumBins());
+}
+
+void ChStepController::SetFactors(double shrink, double growth)
+{
+  m_shrink = shrink;
+  m_growth = growth;
+}
+
+void ChStepController::SetViolationThreshold(double tolerance, double growth)
+{
+  m_violation_tol = tolerance;
+  m_violation_growth = growth;
+}
+
+void ChStepController::SetHistogramBins(int num_bins)
+{
+  m_counts.assign(std::max(num_bins, 1), 0);
+  m_times.assign(std::max(num_bins, 1), 0.0);
+}
+
+void ChStepController::Reset(double step)
+{
+  m_step = std::min(std::max(step, m_min_step), m_max_step);
+  m_num_smooth = 0;
+  m_has_prev = false;
+
+  m_num_steps = 0;
+  m_num_events = 0;
+  m_min_taken = 0;
+  m_max_taken = 0;
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+  std::fill(m_times.begin(), m_times.end(), 0.0);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChStepController::Update(double        h,
+                              int           num_contacts,
+                              const double* wheel_omega,
+                              int           num_wheels,
+                              double        violation,
+                              bool          event)
+{
+  // Detect the events, relative to the state after the previous step.
+  if (!event && m_has_prev && (int)m_prev_omega.size() == num_wheels) {
+    if (num_contacts > m_prev_contacts)
+      event = true;
+    for (int i = 0; !event && m_accel_threshold > 0 && i < num_wheels; i++) {
+      if (std::abs(wheel_omega[i] - m_prev_omega[i]) > m_accel_threshold * h)
+        event = true;
+    }
+    if (m_violation_tol > 0 && violation > m_violation_tol && violation > m_violation_growth * m_prev_violation)
+      event = true;
+  }
+
+  m_has_prev = true;
+  m_prev_contacts = num_contacts;
+  m_prev_violation = violation;
+  m_prev_omega.assign(wheel_omega, wheel_omega + num_wheels);
+
+  // Select the next step.
+  if (event) {
+    m_step = std::max(m_step * m_shrink, m_min_step);
+    m_num_smooth = 0;
+    m_num_events++;
+  } else if (++m_num_smooth >= m_smooth_steps) {
+    m_step = std::min(m_step * m_growth, m_max_step);
+    m_num_smooth = 0;
+  }
+
+  // Statistics of the step taken (the bins are logarithmically spaced over
+  // the step range; shorter steps, e.g. the last one of a vehicle step, are
+  // counted in the first bin).
+  if (m_num_steps == 0 || h < m_min_taken)
+    m_min_taken = h;
+  if (m_num_steps == 0 || h > m_max_taken)
+    m_max_taken = h;
+  m_num_steps++;
+
+  int num_bins = GetNumBins();
+  int bin = 0;
+  if (m_max_step > m_min_step && h > m_min_step)
+    bin = (int)std::floor(std::log(h / m_min_step) / std::log(m_max_step / m_min_step) * num_bins);
+  bin = std::min(std::max(bin, 0), num_bins - 1);
+  m_counts[bin]++;
+  m_times[bin] += h;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChStepController::GetBinLow(int bin) const
+{
+  return m_min_step * std::pow(m_max_step / m_min_step, (double)bin / GetNumBins());
+}
+
+bool ChStepController::WriteHistogram(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  fprintf(fp, "lo,hi,count,time\n");
+  for (int i = 0; i < GetNumBins(); i++)
+    fprintf(fp, "%.10g,%.10g,%d,%.10g\n", GetBinLow(i), GetBinHigh(i), m_counts[i], m_times[i]);
+
+  return fclose(fp) == 0;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,158 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Event-aware selection of the integration step of a vehicle.
+//
+// A fixed integration step must be sized for the worst moments of a run (e.g.
+// hitting an obstacle or a wheel lifting off), although most of the run is
+// smooth driving. The step controller shrinks the step when, after a step, it
+// detects one of the following events:
+//   - contact onset: the number of contacts in the system increased;
+//   - large tire slip rate: the angular acceleration of a wheel exceeds a
+//     threshold (e.g. a wheel locking, spinning up or lifting off);
+//   - constraint violation growth: the largest violation of the bilateral
+//     constraints exceeds a tolerance and grew by more than a factor since the
+//     previous step.
+// After a number of consecutive steps without event, the step is enlarged
+// again, up to the largest step. Steps cannot be rejected, i.e. the step at
+// which an event is detected is kept, and the following ones are reduced.
+//
+// The controller is owned by the vehicle (see ChVehicle::SetAdaptiveStep()).
+// Within ChVehicle::Advance(), the last integration step is cut to reach the
+// end of the vehicle step exactly, so the exchanges with the tires and the
+// other modules (and the tire sub-stepping) happen at the same times as with a
+// fixed step. The counts and the simulated time of the steps taken are binned
+// in a histogram of logarithmically spaced step sizes.
+//
+// =============================================================================
+
+#ifndef CH_STEP_CONTROLLER_H
+#define CH_STEP_CONTROLLER_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Adaptive integration step controller.
+///
+class CH_SUBSYS_API ChStepController
+{
+public:
+
+  ChStepController();
+
+  /// Set the range of the integration step (default: [1e-4, 4e-3]).
+  void SetStepRange(double min_step, double max_step);
+
+  /// Set the factors by which the step is reduced after an event (default: 0.5)
+  /// and enlarged after a series of smooth steps (default: 1.25).
+  void SetFactors(double shrink, double growth);
+
+  /// Set the number of consecutive steps without event after which the step is
+  /// enlarged (default: 10).
+  void SetSmoothSteps(int num_steps) { m_smooth_steps = num_steps; }
+
+  /// Set the wheel angular acceleration above which a step is an event
+  /// (default: 500 rad/s^2; 0 disables the test).
+  void SetWheelAccelThreshold(double accel) { m_accel_threshold = accel; }
+
+  /// Set the constraint violation above which its growth by more than the
+  /// specified factor over one step is an event (default: 1e-4 and 2; a zero
+  /// tolerance disables the test).
+  void SetViolationThreshold(double tolerance, double growth = 2);
+
+  /// Return true if the constraint violation is used (see
+  /// SetViolationThreshold()), i.e. must be passed to Update().
+  bool UsesViolation() const { return m_violation_tol > 0; }
+
+  /// Set the number of bins of the step size histogram (default: 20).
+  /// This resets the histogram.
+  void SetHistogramBins(int num_bins);
+
+  /// Set the current step (clamped to the step range), forget the state of
+  /// the previous step and clear the statistics.
+  void Reset(double step);
+
+  /// Get the step to take next.
+  double GetStep() const { return m_step; }
+
+  /// Process the outcome of a step of size h and select the next step.
+  void Update(
+    double        h,              ///< [in] size of the step taken
+    int           num_contacts,   ///< [in] number of contacts after the step
+    const double* wheel_omega,    ///< [in] wheel angular speeds after the step
+    int           num_wheels,     ///< [in] number of wheels
+    double        violation,      ///< [in] largest constraint violation after the step (if used)
+    bool          event = false   ///< [in] event detected by the caller (e.g. a constraint monitor)
+    );
+
+  /// Get the number of steps taken and the number of events detected.
+  int GetNumSteps() const { return m_num_steps; }
+  int GetNumEvents() const { return m_num_events; }
+
+  /// Get the smallest and largest steps taken.
+  double GetMinStepTaken() const { return m_min_taken; }
+  double GetMaxStepTaken() const { return m_max_taken; }
+
+  /// Get the number of bins of the step size histogram.
+  int GetNumBins() const { return (int)m_counts.size(); }
+
+  /// Get the range of step sizes of the specified bin.
+  double GetBinLow(int bin) const;
+  double GetBinHigh(int bin) const { return GetBinLow(bin + 1); }
+
+  /// Get the number of steps, and the simulated time, in the specified bin.
+  int    GetBinCount(int bin) const { return m_counts[bin]; }
+  double GetBinTime(int bin) const { return m_times[bin]; }
+
+  /// Write the step size histogram, one CSV row per bin (range, number of
+  /// steps, simulated time). Returns false if the file cannot be written.
+  bool WriteHistogram(const std::string& filename) const;
+
+private:
+
+  double               m_min_step;
+  double               m_max_step;
+  double               m_shrink;
+  double               m_growth;
+  int                  m_smooth_steps;
+  double               m_accel_threshold;
+  double               m_violation_tol;
+  double               m_violation_growth;
+
+  double               m_step;
+  int                  m_num_smooth;       // steps without event since the last change
+  bool                 m_has_prev;         // the previous state is set
+  int                  m_prev_contacts;
+  double               m_prev_violation;
+  std::vector<double>  m_prev_omega;
+
+  int                  m_num_steps;
+  int                  m_num_events;
+  double               m_min_taken;
+  double               m_max_taken;
+  std::vector<int>     m_counts;
+  std::vector<double>  m_times;
+};
+
+
+} // end namespace chrono
+
+
+#endif
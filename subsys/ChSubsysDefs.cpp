@@ -12,35 +12,32 @@
 // Authors: Radu Serban
 // =============================================================================
 //
+// Various utility classes for vehicle subsystems.
 //
 // =============================================================================
 
-#include "models/hmmwv/HMMWV_FuncDriver.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChSimulationContext.h"
 
-using namespace chrono;
 
-namespace hmmwv {
+namespace chrono {
+
 
 // -----------------------------------------------------------------------------
+// The check is made in release builds too: writing past the inline storage of
+// a ChWheelArray (e.g. for a road train with more than CH_MAX_WHEELS / 2
+// axles) would silently corrupt the memory that follows it.
 // -----------------------------------------------------------------------------
-void HMMWV_FuncDriver::Update(double time)
+int ChCheckWheelArraySize(int size)
 {
-  if (time < 0.5)
-    m_throttle = 0;
-  else if (time < 1.5)
-    m_throttle = 0.4 * (time - 0.5);
-  else
-    m_throttle = 0.4;
-
-  if (time < 4)
-    m_steering = 0;
-  else if (time < 6)
-    m_steering = 0.25 * (time - 4);
-  else if (time < 10)
-    m_steering = -0.25 * (time - 6) + 0.5;
-  else
-    m_steering = -0.5;
+  if (size >= 0 && size <= CH_MAX_WHEELS)
+    return size;
+
+  vehicle::GetContextLog() << "ERROR: " << size << " wheels requested, at most " << CH_MAX_WHEELS
+                           << " are supported (see CH_MAX_WHEELS)\n";
+
+  return size < 0 ? 0 : CH_MAX_WHEELS;
 }
 
 
-} // end namespace hmmwv
+} // end namespace chrono
@@ -20,6 +20,7 @@
 #define CH_SUBSYS_DEFS_H
 
 #include <vector>
+#include <cassert>
 
 #include "core/ChVector.h"
 #include "core/ChQuaternion.h"
@@ -70,6 +71,56 @@ static const ChWheelID  FRONT_RIGHT(0, RIGHT);
 static const ChWheelID  REAR_LEFT(1, LEFT);
 static const ChWheelID  REAR_RIGHT(1, RIGHT);
 
+///
+/// Fixed-capacity array of per-wheel data, indexed by wheel ID.
+/// The elements are stored inline (up to CH_MAX_WHEELS, i.e. 8 axles), so the
+/// arrays used to exchange wheel states and tire forces never allocate and
+/// keep the data of consecutive wheels contiguous.
+///
+static const int CH_MAX_WHEELS = 16;
+
+/// Check the size of a ChWheelArray. A size beyond CH_MAX_WHEELS (or negative)
+/// is reported as an error and clamped to the valid range.
+CH_SUBSYS_API int ChCheckWheelArraySize(int size);
+
+template <typename T>
+class ChWheelArray
+{
+public:
+
+  /// Create an array with the specified number of elements (at most
+  /// CH_MAX_WHEELS), value-initialized.
+  explicit ChWheelArray(int size = 0) : m_size(0) { resize(size); }
+
+  /// Create an array with one element for each wheel of a vehicle with the
+  /// specified number of axles.
+  static ChWheelArray ForAxles(int num_axles) { return ChWheelArray(2 * num_axles); }
+
+  /// Return the number of elements.
+  size_t size() const { return (size_t)m_size; }
+
+  /// Set the number of elements (at most CH_MAX_WHEELS). As with std::vector,
+  /// the added elements are value-initialized.
+  void resize(int size)
+  {
+    size = ChCheckWheelArraySize(size);
+    for (int i = m_size; i < size; i++)
+      m_data[i] = T();
+    m_size = size;
+  }
+
+  T&       operator[](int id)       { return m_data[id]; }
+  const T& operator[](int id) const { return m_data[id]; }
+
+  T&       operator[](const ChWheelID& wheel_id)       { return m_data[wheel_id.id()]; }
+  const T& operator[](const ChWheelID& wheel_id) const { return m_data[wheel_id.id()]; }
+
+private:
+
+  T    m_data[CH_MAX_WHEELS];
+  int  m_size;
+};
+
 ///
 /// Structure to communicate a full body state.
 ///
@@ -96,8 +147,8 @@ struct ChWheelState {
   double         omega;    ///< wheel angular speed about its rotation axis
 };
 
-/// Vector of wheel state structures
-typedef std::vector<ChWheelState> ChWheelStates;
+/// Array of wheel state structures, indexed by wheel ID.
+typedef ChWheelArray<ChWheelState> ChWheelStates;
 
 ///
 /// Structure to communicate a set of generalized tire forces.
@@ -108,8 +159,28 @@ struct ChTireForce {
   ChVector<> moment;       ///< moment vector, expressed in the global frame
 };
 
-/// Vector of tire force structures.
-typedef std::vector<ChTireForce> ChTireForces;
+/// Array of tire force structures, indexed by wheel ID.
+typedef ChWheelArray<ChTireForce> ChTireForces;
+
+///
+/// Structure to communicate the linearization of a tire force about a wheel
+/// state: the derivatives of the force vector (in the global frame) with
+/// respect to the components of the global position and velocity of the wheel
+/// center, and to the wheel angular speed. The application point and the
+/// moment are held.
+///
+struct ChTireForceJacobian {
+  ChVector<> dF_dpx;       ///< derivative with respect to the x position of the wheel center
+  ChVector<> dF_dpy;       ///< derivative with respect to the y position of the wheel center
+  ChVector<> dF_dpz;       ///< derivative with respect to the z position of the wheel center
+  ChVector<> dF_dvx;       ///< derivative with respect to the x velocity of the wheel center
+  ChVector<> dF_dvy;       ///< derivative with respect to the y velocity of the wheel center
+  ChVector<> dF_dvz;       ///< derivative with respect to the z velocity of the wheel center
+  ChVector<> dF_domega;    ///< derivative with respect to the wheel angular speed
+};
+
+/// Array of tire force linearizations, indexed by wheel ID.
+typedef ChWheelArray<ChTireForceJacobian> ChTireForceJacobians;
 
 
 } // end namespace chrono
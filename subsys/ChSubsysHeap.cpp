@@ -0,0 +1,143 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide contiguous storage of the vehicle subsystem objects.
+//
+// =============================================================================
+
+#include <new>
+
+#include "subsys/ChSubsysHeap.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// A chunk starts with this header; its blocks follow, each preceded by a
+// pointer to the chunk (padded to keep the alignment).
+struct ChSubsysChunk {
+  size_t  capacity;    // total size of the chunk, header included
+  size_t  used;        // offset of the next free block
+  int     live;        // number of allocated blocks
+};
+
+static const size_t         SUBSYS_HEAP_ALIGN = 16;
+static const size_t         SUBSYS_HEAP_CHUNK_SIZE = 64 * 1024;
+static const size_t         SUBSYS_HEAP_CHUNK_HEADER = (sizeof(ChSubsysChunk) + SUBSYS_HEAP_ALIGN - 1) & ~(SUBSYS_HEAP_ALIGN - 1);
+static const size_t         SUBSYS_HEAP_BLOCK_HEADER = SUBSYS_HEAP_ALIGN;
+
+static ChMutex              s_subsys_heap_mutex;
+static ChSubsysChunk*       s_subsys_heap_current = 0;    // chunk blocks are taken from
+static int                  s_subsys_heap_chunks = 0;
+static int                  s_subsys_heap_blocks = 0;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+static ChSubsysChunk* NewSubsysChunk(size_t capacity)
+{
+  ChSubsysChunk* chunk = static_cast<ChSubsysChunk*>(::operator new(capacity));
+  chunk->capacity = capacity;
+  chunk->used = SUBSYS_HEAP_CHUNK_HEADER;
+  chunk->live = 0;
+  s_subsys_heap_chunks++;
+
+  return chunk;
+}
+
+static void DeleteSubsysChunk(ChSubsysChunk* chunk)
+{
+  ::operator delete(chunk);
+  s_subsys_heap_chunks--;
+}
+
+
+// -----------------------------------------------------------------------------
+// Blocks are taken in sequence from the current chunk. When it is full, a new
+// chunk becomes current (the previous one is kept until its last block is
+// freed). A block too large for a regular chunk gets a chunk of its own, which
+// does not replace the current one.
+// -----------------------------------------------------------------------------
+void* ChSubsysHeap::Allocate(size_t size)
+{
+  size_t need = SUBSYS_HEAP_BLOCK_HEADER + ((size + SUBSYS_HEAP_ALIGN - 1) & ~(SUBSYS_HEAP_ALIGN - 1));
+
+  ChScopedLock lock(s_subsys_heap_mutex);
+
+  ChSubsysChunk* chunk = s_subsys_heap_current;
+
+  if (SUBSYS_HEAP_CHUNK_HEADER + need > SUBSYS_HEAP_CHUNK_SIZE) {
+    chunk = NewSubsysChunk(SUBSYS_HEAP_CHUNK_HEADER + need);
+  } else if (!chunk || chunk->used + need > chunk->capacity) {
+    chunk = NewSubsysChunk(SUBSYS_HEAP_CHUNK_SIZE);
+    s_subsys_heap_current = chunk;
+  }
+
+  char* block = reinterpret_cast<char*>(chunk) + chunk->used;
+  chunk->used += need;
+  chunk->live++;
+  s_subsys_heap_blocks++;
+
+  *reinterpret_cast<ChSubsysChunk**>(block) = chunk;
+
+  return block + SUBSYS_HEAP_BLOCK_HEADER;
+}
+
+
+// -----------------------------------------------------------------------------
+// The current chunk is rewound (rather than returned) when it becomes empty.
+// -----------------------------------------------------------------------------
+void ChSubsysHeap::Free(void* block)
+{
+  if (!block)
+    return;
+
+  ChSubsysChunk* chunk = *reinterpret_cast<ChSubsysChunk**>(static_cast<char*>(block) - SUBSYS_HEAP_BLOCK_HEADER);
+
+  ChScopedLock lock(s_subsys_heap_mutex);
+
+  s_subsys_heap_blocks--;
+  if (--chunk->live > 0)
+    return;
+
+  if (chunk == s_subsys_heap_current)
+    chunk->used = SUBSYS_HEAP_CHUNK_HEADER;
+  else
+    DeleteSubsysChunk(chunk);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChSubsysHeap::GetNumChunks()
+{
+  ChScopedLock lock(s_subsys_heap_mutex);
+  return s_subsys_heap_chunks;
+}
+
+int ChSubsysHeap::GetNumBlocks()
+{
+  ChScopedLock lock(s_subsys_heap_mutex);
+  return s_subsys_heap_blocks;
+}
+
+size_t ChSubsysHeap::GetChunkSize()
+{
+  return SUBSYS_HEAP_CHUNK_SIZE;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,70 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Process-wide contiguous storage of the vehicle subsystem objects.
+//
+// The subsystem base classes (suspension, steering, driveline, wheel, brake)
+// allocate their objects from this heap instead of the general-purpose heap.
+// Blocks are taken in sequence from large chunks, so that the subsystems of a
+// vehicle, constructed one after the other, end up next to each other in
+// memory, together with the hardpoint and parameter arrays they hold. A chunk
+// is returned when its last block is freed.
+//
+// =============================================================================
+
+#ifndef CH_SUBSYS_HEAP_H
+#define CH_SUBSYS_HEAP_H
+
+#include <cstddef>
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Contiguous heap of vehicle subsystem objects.
+///
+class CH_SUBSYS_API ChSubsysHeap
+{
+public:
+
+  /// Allocate a block of the specified size, aligned on 16 bytes.
+  /// Throws std::bad_alloc if the memory cannot be obtained.
+  static void* Allocate(size_t size);
+
+  /// Free a block returned by Allocate(). A NULL pointer is ignored.
+  static void Free(void* block);
+
+  /// Get the number of chunks currently held by the heap.
+  static int GetNumChunks();
+
+  /// Get the number of blocks currently allocated.
+  static int GetNumBlocks();
+
+  /// Get the size of a regular chunk. Larger blocks get a chunk of their own.
+  static size_t GetChunkSize();
+
+private:
+
+  ChSubsysHeap();
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
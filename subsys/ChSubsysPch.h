@@ -0,0 +1,49 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Precompiled header of the ChronoVehicle libraries and of the vehicle models
+// (used only with ENABLE_PRECOMPILED_HEADERS, see cmake/ChBuildSpeedup.cmake).
+//
+// Only the headers shared by most sources and external to this project (the
+// standard library, Chrono and rapidjson) belong here: the vehicle headers
+// change too often, and their export macros depend on the target.
+//
+// =============================================================================
+
+#ifndef CH_SUBSYS_PCH_H
+#define CH_SUBSYS_PCH_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/ChLog.h"
+#include "core/ChShared.h"
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "core/ChCoordsys.h"
+#include "physics/ChSystem.h"
+#include "physics/ChBody.h"
+#include "assets/ChColorAsset.h"
+#include "assets/ChCylinderShape.h"
+
+#include "rapidjson/document.h"
+
+
+#endif
@@ -29,10 +29,13 @@
 #include "physics/ChShaftsBody.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysHeap.h"
 #include "subsys/ChSubsysDefs.h"
 
 namespace chrono {
 
+class ChSpringForceBank;
+
 ///
 /// Base class for a suspension subsystem.
 ///
@@ -46,6 +49,10 @@ public:
 
   virtual ~ChSuspension() {}
 
+  /// Allocate subsystem objects from the contiguous subsystem heap.
+  static void* operator new(size_t size) { return vehicle::ChSubsysHeap::Allocate(size); }
+  static void operator delete(void* ptr) { vehicle::ChSubsysHeap::Free(ptr); }
+
   /// Specify whether or not this suspension can be steered.
   virtual bool IsSteerable() const = 0;
 
@@ -58,6 +65,11 @@ public:
   /// Get a handle to the spindle body on the specified side.
   ChSharedPtr<ChBody>  GetSpindle(ChVehicleSide side) const { return m_spindle[side]; }
 
+  /// Get a (non-owning) pointer to the spindle body on the specified side.
+  /// Unlike GetSpindle(), this does not touch the reference count and is
+  /// meant for the per-step paths.
+  ChBody* GetSpindleBody(ChVehicleSide side) const { return m_spindle[side].get_ptr(); }
+
   /// Get a handle to the axle shaft on the specified side.
   ChSharedPtr<ChShaft> GetAxle(ChVehicleSide side) const { return m_axle[side]; }
 
@@ -120,6 +132,27 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side) {}
 
+  /// Append the joints of this suspension (both sides) to the specified list,
+  /// e.g. to monitor their violations (see ChConstraintMonitor). The default
+  /// implementation adds the spindle revolute joints.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const
+  {
+    links.push_back(m_revolute[LEFT].get_ptr());
+    links.push_back(m_revolute[RIGHT].get_ptr());
+  }
+
+  /// Add the tabulated spring and shock elements of this suspension to the
+  /// specified bank, for batched force evaluation. This must be called after
+  /// Initialize. The default implementation adds nothing.
+  virtual void AddSpringForceElements(ChSpringForceBank& bank) {}
+
+  /// Apply the current values of the parameters that do not change the
+  /// topology of the suspension (masses, inertias, spring and shock laws) to
+  /// its bodies and force elements, keeping their state (e.g. after the values
+  /// were reloaded, see ChHotReload). This must be called after Initialize.
+  /// The default implementation does nothing.
+  virtual void UpdateParameters() {}
+
 protected:
 
   std::string                      m_name;               ///< name of the subsystem
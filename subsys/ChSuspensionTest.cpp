@@ -35,10 +35,28 @@ ChSuspensionTest::ChSuspensionTest()
   Set_G_acc(ChVector<>(0, 0, -9.81));
 
   // Integration and Solver settings
-  SetLcpSolverType(ChSystem::LCP_ITERATIVE_SOR);
-  SetIterLCPmaxItersSpeed(150);
-  SetIterLCPmaxItersStab(150);
-  SetMaxPenetrationRecoverySpeed(4.0);
+  SetSolverProfile("batch");
+}
+
+
+// -----------------------------------------------------------------------------
+// Solver settings and statistics
+// -----------------------------------------------------------------------------
+void ChSuspensionTest::SetSolverProfile(const ChSolverProfile& profile)
+{
+  m_solver_profile = profile;
+  m_solver_profile.Apply(this);
+  m_solver_stats.Reset();
+}
+
+bool ChSuspensionTest::SetSolverProfile(const std::string& name)
+{
+  ChSolverProfile profile;
+  if (!ChSolverProfile::Get(name, profile))
+    return false;
+
+  SetSolverProfile(profile);
+  return true;
 }
 
 
@@ -52,6 +70,7 @@ void ChSuspensionTest::Advance(double step)
   while (t < step) {
     double h = std::min<>(m_stepsize, step - t);
     DoStepDynamics(h);
+    m_solver_stats.Record(this);
     t += h;
   }
 }
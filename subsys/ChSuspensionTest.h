@@ -35,6 +35,7 @@
 #include "subsys/ChSuspension.h"
 #include "subsys/ChSteering.h"
 #include "subsys/ChWheel.h"
+#include "subsys/ChSolverProfile.h"
 #include "models/ModelDefs.h"
 
 namespace chrono {
@@ -101,11 +102,15 @@ public:
     const ChCoordsys<>& chassisPos  ///< [in] initial global position and orientation
     ) {}
 
-  /// set the actuator function on the left wheel
+  /// Set the displacement function of the left post (e.g. a channel of a
+  /// drive file, see ChFunction_DriveChannel), evaluated at the system time.
+  /// Must be called before Initialize(); without function, the post follows
+  /// the displacement passed to Update().
   virtual void SetActuator_func_L(const ChSharedPtr<ChFunction>& funcL) {
     m_actuator_L = funcL;
   }
 
+  /// Set the displacement function of the right post (see SetActuator_func_L()).
   virtual void SetActuator_func_R(const ChSharedPtr<ChFunction>& funcR) {
     m_actuator_R = funcR;
   }
@@ -139,6 +144,24 @@ public:
 
   bool Has_steering() const { return m_has_steering; }
 
+  /// Apply the specified solver settings, and start recording the solver
+  /// statistics (the "batch" profile is applied at construction).
+  void SetSolverProfile(const ChSolverProfile& profile);
+
+  /// Apply the predefined solver profile with the specified name ("realtime",
+  /// "batch" or "accurate").
+  /// Returns false if there is no profile with the specified name.
+  bool SetSolverProfile(const std::string& name);
+
+  /// Get the solver settings last applied.
+  const ChSolverProfile& GetSolverProfile() const { return m_solver_profile; }
+
+  /// Get the iterations used and the residual of the LCP speed solver.
+  const ChSolverStats& GetSolverStats() const { return m_solver_stats; }
+
+  /// Reset the solver statistics.
+  void ResetSolverStats() { m_solver_stats.Reset(); }
+
   /// Log current constraint violations.
   void LogConstraintViolations();
 
@@ -162,6 +185,9 @@ protected:
   double                     m_stepsize;   ///< integration step-size for the vehicle system
   ChSharedPtr<ChFunction>    m_actuator_L;  ///< actuator function applied to left wheel
   ChSharedPtr<ChFunction>    m_actuator_R;  ///< actuator function applied to right wheel
+
+  ChSolverProfile            m_solver_profile;  ///< solver settings applied to the system
+  ChSolverStats              m_solver_stats;    ///< per-step solver statistics
 };
 
 
@@ -0,0 +1,248 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Locality-aware ordering of the bodies and links of a shared ChSystem.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "subsys/ChSystemOrdering.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// Sort key of a body or a link: group, then key within the group, then
+// position in the original list (for a stable order).
+struct ChOrderingKey {
+  int                 group;
+  unsigned long long  key;
+  size_t              index;
+
+  bool operator<(const ChOrderingKey& other) const
+  {
+    if (group != other.group)
+      return group < other.group;
+    if (key != other.key)
+      return key < other.key;
+    return index < other.index;
+  }
+};
+
+// Spread the lower 21 bits of the value over every third bit.
+static unsigned long long ORDERING_spread(unsigned long long v)
+{
+  v &= 0x1fffff;
+  v = (v | (v << 32)) & 0x1f00000000ffffULL;
+  v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+  v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+  v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+  v = (v | (v << 2)) & 0x1249249249249249ULL;
+  return v;
+}
+
+static ChBody* ORDERING_body(ChBodyFrame* frame)
+{
+  return frame ? dynamic_cast<ChBody*>(frame) : 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSystemOrdering::ChSystemOrdering()
+: m_cell_size(10)
+{
+}
+
+void ChSystemOrdering::AddUnit(ChBody* chassis)
+{
+  Unit unit;
+  unit.chassis = chassis;
+  m_units.push_back(unit);
+}
+
+void ChSystemOrdering::AddSubsystem(const std::vector<ChLink*>& links)
+{
+  if (!m_units.empty())
+    m_units.back().subsystems.push_back(links);
+}
+
+void ChSystemOrdering::AddVehicle(const ChVehicle& vehicle)
+{
+  AddUnit(vehicle.GetChassisBody());
+
+  std::vector<ChLink*> links;
+  for (int i = 0; i < vehicle.GetNumberAxles(); i++) {
+    links.clear();
+    vehicle.GetSuspension(i)->GetConstraints(links);
+    AddSubsystem(links);
+  }
+
+  if (!vehicle.GetSteering().IsNull()) {
+    links.clear();
+    vehicle.GetSteering()->GetConstraints(links);
+    AddSubsystem(links);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The cell coordinates are offset so that the keys of cells with negative
+// coordinates sort on the same curve.
+// -----------------------------------------------------------------------------
+unsigned long long ChSystemOrdering::spatial_key(const ChBody* body) const
+{
+  const ChVector<>& pos = body->GetPos();
+  double inv_cell = (m_cell_size > 0) ? 1 / m_cell_size : 0;
+  long long ix = (long long)std::floor(pos.x * inv_cell) + (1 << 20);
+  long long iy = (long long)std::floor(pos.y * inv_cell) + (1 << 20);
+  ix = std::max(0LL, std::min(ix, (1LL << 21) - 1));
+  iy = std::max(0LL, std::min(iy, (1LL << 21) - 1));
+
+  return ORDERING_spread((unsigned long long)ix) | (ORDERING_spread((unsigned long long)iy) << 1);
+}
+
+// -----------------------------------------------------------------------------
+// Group 0 holds the fixed bodies; each unit has a group for its chassis, one
+// per subsystem and one for its other bodies; the last group holds the free
+// bodies. The bodies of the subsystems are claimed first, so that the search
+// for the other bodies of a unit stops at the bodies of the other units (e.g.
+// at the hitch of a trailer).
+// -----------------------------------------------------------------------------
+void ChSystemOrdering::Apply(ChSystem* system) const
+{
+  std::vector<ChBody*>& bodies = *system->Get_bodylist();
+  std::vector<ChLink*>& links = *system->Get_linklist();
+
+  std::vector<int> first_group(m_units.size());
+  int num_groups = 1;
+  for (size_t u = 0; u < m_units.size(); u++) {
+    first_group[u] = num_groups;
+    num_groups += 2 + (int)m_units[u].subsystems.size();
+  }
+  int free_group = num_groups;
+
+  std::map<const ChBody*, int> body_group;
+  std::map<const ChLink*, int> link_group;
+  for (size_t u = 0; u < m_units.size(); u++) {
+    const Unit& unit = m_units[u];
+    if (unit.chassis)
+      body_group.insert(std::make_pair(unit.chassis, first_group[u]));
+
+    for (size_t s = 0; s < unit.subsystems.size(); s++) {
+      int group = first_group[u] + 1 + (int)s;
+      for (size_t k = 0; k < unit.subsystems[s].size(); k++) {
+        ChLink* link = unit.subsystems[s][k];
+        link_group.insert(std::make_pair(link, group));
+        ChBody* b[2] = { ORDERING_body(link->GetBody1()), ORDERING_body(link->GetBody2()) };
+        for (int i = 0; i < 2; i++) {
+          if (b[i] && !b[i]->GetBodyFixed())
+            body_group.insert(std::make_pair(b[i], group));
+        }
+      }
+    }
+  }
+
+  // Bodies connected to a unit through links.
+  std::multimap<const ChBody*, ChBody*> neighbors;
+  for (size_t k = 0; k < links.size(); k++) {
+    ChBody* b1 = ORDERING_body(links[k]->GetBody1());
+    ChBody* b2 = ORDERING_body(links[k]->GetBody2());
+    if (b1 && b2) {
+      neighbors.insert(std::make_pair(b1, b2));
+      neighbors.insert(std::make_pair(b2, b1));
+    }
+  }
+
+  for (size_t u = 0; u < m_units.size(); u++) {
+    int rest = first_group[u] + 1 + (int)m_units[u].subsystems.size();
+
+    std::vector<const ChBody*> stack;
+    for (std::map<const ChBody*, int>::const_iterator it = body_group.begin(); it != body_group.end(); ++it) {
+      if (it->second >= first_group[u] && it->second <= rest)
+        stack.push_back(it->first);
+    }
+
+    while (!stack.empty()) {
+      const ChBody* body = stack.back();
+      stack.pop_back();
+      typedef std::multimap<const ChBody*, ChBody*>::const_iterator NeighborIter;
+      std::pair<NeighborIter, NeighborIter> range = neighbors.equal_range(body);
+      for (NeighborIter it = range.first; it != range.second; ++it) {
+        ChBody* other = it->second;
+        if (!other->GetBodyFixed() && body_group.insert(std::make_pair(other, rest)).second)
+          stack.push_back(other);
+      }
+    }
+  }
+
+  // New body order.
+  std::vector<ChOrderingKey> body_keys(bodies.size());
+  for (size_t i = 0; i < bodies.size(); i++) {
+    ChOrderingKey& key = body_keys[i];
+    std::map<const ChBody*, int>::const_iterator it = body_group.find(bodies[i]);
+    if (bodies[i]->GetBodyFixed())
+      key.group = 0;
+    else
+      key.group = (it != body_group.end()) ? it->second : free_group;
+    key.key = (key.group == 0 || key.group == free_group) ? spatial_key(bodies[i]) : 0;
+    key.index = i;
+  }
+  std::sort(body_keys.begin(), body_keys.end());
+
+  std::vector<ChBody*> sorted_bodies(bodies.size());
+  std::map<const ChBody*, size_t> position;
+  for (size_t i = 0; i < body_keys.size(); i++) {
+    sorted_bodies[i] = bodies[body_keys[i].index];
+    position[sorted_bodies[i]] = i;
+  }
+
+  // New link order.
+  std::vector<ChOrderingKey> link_keys(links.size());
+  for (size_t k = 0; k < links.size(); k++) {
+    ChOrderingKey& key = link_keys[k];
+    key.group = -1;
+    key.key = (unsigned long long)bodies.size();
+    key.index = k;
+
+    ChBody* b[2] = { ORDERING_body(links[k]->GetBody1()), ORDERING_body(links[k]->GetBody2()) };
+    for (int i = 0; i < 2; i++) {
+      std::map<const ChBody*, size_t>::const_iterator it = b[i] ? position.find(b[i]) : position.end();
+      if (it != position.end() && it->second < key.key) {
+        key.key = it->second;
+        key.group = body_keys[it->second].group;
+      }
+    }
+
+    std::map<const ChLink*, int>::const_iterator it = link_group.find(links[k]);
+    if (it != link_group.end())
+      key.group = it->second;
+  }
+  std::sort(link_keys.begin(), link_keys.end());
+
+  std::vector<ChLink*> sorted_links(links.size());
+  for (size_t k = 0; k < link_keys.size(); k++)
+    sorted_links[k] = links[link_keys[k].index];
+
+  bodies.swap(sorted_bodies);
+  links.swap(sorted_links);
+
+  system->Setup();
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
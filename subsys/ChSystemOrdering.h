@@ -0,0 +1,103 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Locality-aware ordering of the bodies and links of a ChSystem shared by
+// several vehicles (e.g. a fleet, or the units of a road train, on a shared
+// rigid terrain).
+//
+// Bodies and links are appended to the system in construction order, so the
+// objects of different vehicles and the terrain obstacles end up interleaved,
+// and the solver sweeps (which follow the order of the system lists) jump
+// between vehicles. Apply() reorders the lists, once all vehicles are
+// initialized:
+//   - fixed bodies (ground, fixed obstacles) first, in spatial order;
+//   - then, vehicle by vehicle: the chassis, the bodies of each subsystem (in
+//     the order the subsystems were added), then the other bodies connected
+//     to the vehicle through its links;
+//   - then the other (free) bodies, e.g. moving obstacles, in spatial order.
+// The spatial order follows a Morton curve over square cells of the x-y
+// plane. Within a group, bodies keep their construction order. Each link is
+// placed in the group of its subsystem, or else of its first body in the new
+// order, and the links of a group are sorted by the position of their bodies,
+// so that the constraint updates walk the bodies sequentially.
+//
+// Only the order of the lists changes; the body and link objects stay where
+// they were allocated (the objects of a subsystem are allocated together, so
+// the reordered sweeps also touch memory more sequentially).
+//
+// =============================================================================
+
+#ifndef CH_SYSTEM_ORDERING_H
+#define CH_SYSTEM_ORDERING_H
+
+#include <vector>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Reordering of the body and link lists of a shared system.
+///
+class CH_SUBSYS_API ChSystemOrdering
+{
+public:
+
+  ChSystemOrdering();
+
+  /// Start a new unit (a vehicle, a trailer) with the specified chassis.
+  void AddUnit(ChBody* chassis);
+
+  /// Add a subsystem of the last unit, given by its links (e.g. as returned by
+  /// ChSuspension::GetConstraints()).
+  void AddSubsystem(const std::vector<ChLink*>& links);
+
+  /// Add a unit for the specified (initialized) vehicle, with its suspensions
+  /// and its steering as subsystems.
+  void AddVehicle(const ChVehicle& vehicle);
+
+  /// Set the size of the cells of the spatial order, for the bodies that do
+  /// not belong to a unit (default: 10 m).
+  void SetCellSize(double size) { m_cell_size = size; }
+
+  /// Get the number of units.
+  int GetNumUnits() const { return (int)m_units.size(); }
+
+  /// Reorder the body and link lists of the specified system.
+  void Apply(ChSystem* system) const;
+
+private:
+
+  struct Unit {
+    ChBody*                             chassis;
+    std::vector<std::vector<ChLink*> >  subsystems;
+  };
+
+  // Spatial key of a body, on the Morton curve.
+  unsigned long long spatial_key(const ChBody* body) const;
+
+  std::vector<Unit>  m_units;
+  double             m_cell_size;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
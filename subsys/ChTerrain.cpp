@@ -16,11 +16,135 @@
 //
 // =============================================================================
 
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
 #include "subsys/ChTerrain.h"
 
 
 namespace chrono {
 
 
+// -----------------------------------------------------------------------------
+// Default implementation of the batched terrain query, using the scalar
+// height and normal functions.
+// -----------------------------------------------------------------------------
+void ChTerrain::GetHeightAndNormal(int           n,
+                                   const double* x,
+                                   const double* y,
+                                   double*       height,
+                                   ChVector<>*   normal) const
+{
+  for (int i = 0; i < n; i++)
+    height[i] = GetHeight(x[i], y[i]);
+
+  if (!normal)
+    return;
+
+  for (int i = 0; i < n; i++)
+    normal[i] = GetNormal(x[i], y[i]);
+}
+
+double ChTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  return std::numeric_limits<double>::max();
+}
+
+// -----------------------------------------------------------------------------
+// Default ray cast: march along the ray in segments of RAY_SEGMENT_STEPS steps;
+// a segment is skipped if its lowest point is above the height bound of its
+// x-y extent, otherwise it is marched step by step.
+// -----------------------------------------------------------------------------
+const double ChTerrain::RAY_MARCH_STEP = 0.1;
+
+static const int RAY_SEGMENT_STEPS = 16;
+static const int RAY_BISECTIONS = 30;
+
+bool ChTerrain::CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const
+{
+  double t = 0;
+  double f = origin.z - GetHeight(origin.x, origin.y);
+
+  if (f <= 0) {
+    dist = 0;
+    return true;
+  }
+
+  while (t < max_dist) {
+    double t1 = std::min(t + RAY_SEGMENT_STEPS * RAY_MARCH_STEP, max_dist);
+    ChVector<> p0 = origin + dir * t;
+    ChVector<> p1 = origin + dir * t1;
+    if (std::min(p0.z, p1.z) > GetMaxHeight(std::min(p0.x, p1.x), std::min(p0.y, p1.y),
+                                            std::max(p0.x, p1.x), std::max(p0.y, p1.y))) {
+      t = t1;
+      continue;
+    }
+
+    while (t < t1) {
+      double tn = std::min(t + RAY_MARCH_STEP, t1);
+      ChVector<> p = origin + dir * tn;
+      double fn = p.z - GetHeight(p.x, p.y);
+      if (fn <= 0) {
+        // The first sign change is in (t, tn].
+        double a = t;
+        double b = tn;
+        for (int i = 0; i < RAY_BISECTIONS; i++) {
+          double m = 0.5 * (a + b);
+          ChVector<> q = origin + dir * m;
+          if (q.z - GetHeight(q.x, q.y) <= 0)
+            b = m;
+          else
+            a = m;
+        }
+        dist = b;
+        return true;
+      }
+      t = tn;
+    }
+  }
+
+  return false;
+}
+
+int ChTerrain::CastRays(int               n,
+                        const ChVector<>* origins,
+                        const ChVector<>* dirs,
+                        const double*     max_dist,
+                        double*           dist) const
+{
+  int hits = 0;
+
+  for (int i = 0; i < n; i++) {
+    if (CastRay(origins[i], dirs[i], max_dist[i], dist[i]))
+      hits++;
+    else
+      dist[i] = -1;
+  }
+
+  return hits;
+}
+
+double ChTerrain::GetCoefficientFriction(double x, double y) const
+{
+  if (HasFrictionMap())
+    return m_friction_map->GetCoefficientFriction(x, y);
+
+  return m_friction;
+}
+
+void ChTerrain::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  if (!m_friction_map.IsNull())
+    report.AddShared("terrain/friction maps", m_friction_map.get_ptr(), m_friction_map->GetMemoryFootprint());
+}
+
+size_t ChTerrain::GetMemoryFootprint() const
+{
+  vehicle::ChMemoryReport report;
+  AddMemoryFootprint(report);
+  return report.GetTotal();
+}
+
 
 }  // end namespace chrono
@@ -20,9 +20,12 @@
 #define CH_TERRAIN_H
 
 #include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
 #include "core/ChVector.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChFrictionMap.h"
+#include "subsys/ChMemoryReport.h"
 
 
 namespace chrono {
@@ -34,7 +37,7 @@ class CH_SUBSYS_API ChTerrain : public ChShared
 {
 public:
 
-  ChTerrain() {}
+  ChTerrain() : m_friction(0.8) {}
   virtual ~ChTerrain() {}
 
   virtual void Update(double time) {}
@@ -45,6 +48,101 @@ public:
 
   /// Get the terrain normal at the specified (x,y) location.
   virtual ChVector<> GetNormal(double x, double y) const = 0;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations.
+  /// Concrete terrains should override this function to share the work of the
+  /// height and normal queries; the default implementation calls GetHeight()
+  /// and GetNormal() for each location. If the normal array is NULL, only the
+  /// heights are calculated.
+  virtual void GetHeightAndNormal(
+    int           n,        ///< [in] number of query locations
+    const double* x,        ///< [in] x coordinates of the query locations
+    const double* y,        ///< [in] y coordinates of the query locations
+    double*       height,   ///< [out] terrain heights
+    ChVector<>*   normal    ///< [out] terrain normals (may be NULL)
+    ) const;
+
+  /// Get an upper bound of the terrain height over the specified rectangle of
+  /// the x-y plane. This is used to reject contact tests of objects that are
+  /// clearly above the terrain with a single query; concrete terrains should
+  /// override it with a cheap, but tight, bound. The default implementation
+  /// returns the largest double value (no bound).
+  virtual double GetMaxHeight(
+    double xmin,            ///< [in] minimum x of the rectangle
+    double ymin,            ///< [in] minimum y of the rectangle
+    double xmax,            ///< [in] maximum x of the rectangle
+    double ymax             ///< [in] maximum y of the rectangle
+    ) const;
+
+  /// Cast a ray from the specified origin along the specified unit direction
+  /// and find the distance to the first intersection with the terrain surface
+  /// (zero if the origin is below the surface). Used by perception sensors.
+  /// The default implementation marches along the ray with steps of
+  /// RAY_MARCH_STEP, skipping the parts of the ray above the GetMaxHeight()
+  /// bound, and refines the first sign change of the height above the surface
+  /// by bisection (so it may miss features thinner than a step).
+  /// Returns false if there is no intersection within the specified distance.
+  virtual bool CastRay(
+    const ChVector<>&  origin,     ///< [in] ray origin
+    const ChVector<>&  dir,        ///< [in] ray direction (unit vector)
+    double             max_dist,   ///< [in] maximum distance along the ray
+    double&            dist        ///< [out] distance to the intersection
+    ) const;
+
+  /// Cast the specified rays (see CastRay()). The distance of the rays that
+  /// do not hit the terrain is set to -1. The default implementation calls
+  /// CastRay() for each ray. Returns the number of rays that hit the terrain.
+  virtual int CastRays(
+    int                n,          ///< [in] number of rays
+    const ChVector<>*  origins,    ///< [in] ray origins
+    const ChVector<>*  dirs,       ///< [in] ray directions (unit vectors)
+    const double*      max_dist,   ///< [in] maximum distances along the rays
+    double*            dist        ///< [out] distances to the intersections (-1 if none)
+    ) const;
+
+  /// Step of the default ray marching (see CastRay()).
+  static const double RAY_MARCH_STEP;
+
+  /// Return true if the terrain is a fixed horizontal plane, and set its
+  /// height. Tire models query this once, at construction, to select a contact
+  /// test that does not go through the terrain interface. The default
+  /// implementation returns false.
+  virtual bool IsFlat(
+    double& height          ///< [out] height of the plane (set only if flat)
+    ) const { return false; }
+
+  /// Set the coefficient of friction of the terrain surface, used where no
+  /// friction map is specified (default: 0.8).
+  void SetCoefficientFriction(double mu) { m_friction = mu; }
+
+  /// Set a map of the coefficient of friction of the terrain surface. The
+  /// map may be shared with other terrains.
+  void SetFrictionMap(ChSharedPtr<ChFrictionMap> map) { m_friction_map = map; }
+
+  /// Return true if a (non-empty) friction map was specified.
+  bool HasFrictionMap() const { return !m_friction_map.IsNull() && !m_friction_map->IsEmpty(); }
+
+  /// Get the coefficient of friction of the terrain surface at the specified
+  /// (x,y) location. The default implementation returns the value of the
+  /// friction map, if one was specified, and the constant coefficient of
+  /// friction otherwise. Tire models use the ratio of this value to their
+  /// reference coefficient of friction (see ChTire::SetReferenceFriction()) to
+  /// scale their friction forces.
+  virtual double GetCoefficientFriction(double x, double y) const;
+
+  /// Add an estimate of the memory used by this terrain to the specified
+  /// report (see vehicle::ChMemoryReport). Derived classes add their object
+  /// and the data they own, then call the base class implementation, which
+  /// adds the friction map (as a shared object).
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Return an estimate of the memory used by this terrain, in bytes.
+  size_t GetMemoryFootprint() const;
+
+protected:
+
+  double                      m_friction;       ///< constant coefficient of friction
+  ChSharedPtr<ChFrictionMap>  m_friction_map;   ///< optional map of the coefficient of friction
 };
 
 
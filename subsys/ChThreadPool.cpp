@@ -0,0 +1,192 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Work-stealing thread pool for independent tasks.
+//
+// =============================================================================
+
+#include "subsys/ChThreadPool.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChThreadPool::ChThreadPool(int num_threads, bool numa_placement)
+: m_next(0),
+  m_num_queued(0),
+  m_num_pending(0),
+  m_stealing(true),
+  m_stop(false)
+{
+  if (num_threads <= 0)
+    num_threads = ChThread::GetNumHardwareThreads();
+
+  // Consecutive workers share a node, so that the tasks submitted in order to
+  // neighboring workers stay on the same node.
+  int num_nodes = numa_placement ? ChThread::GetNumNumaNodes() : 1;
+
+  for (int i = 0; i < num_threads; i++) {
+    int node = (num_nodes > 1) ? (int)((long long)i * num_nodes / num_threads) : -1;
+    m_workers.push_back(new Worker(this, i, node));
+  }
+
+  for (int i = 0; i < num_threads; i++)
+    m_workers[i]->Start();
+}
+
+ChThreadPool::~ChThreadPool()
+{
+  Wait();
+
+  m_mutex.Lock();
+  m_stop = true;
+  m_work_cond.Broadcast();
+  m_mutex.Unlock();
+
+  for (size_t i = 0; i < m_workers.size(); i++) {
+    m_workers[i]->Join();
+    delete m_workers[i];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChThreadPool::Submit(ChTask* task)
+{
+  // Distribute the tasks round-robin over the worker queues.
+  m_mutex.Lock();
+  int worker = m_next;
+  m_next = (m_next + 1) % (int)m_workers.size();
+  m_mutex.Unlock();
+
+  Submit(task, worker);
+}
+
+void ChThreadPool::Submit(ChTask* task, int worker)
+{
+  Worker* w = m_workers[worker % (int)m_workers.size()];
+  w->m_mutex.Lock();
+  w->m_queue.push_back(task);
+  w->m_mutex.Unlock();
+
+  // Without stealing, only the worker owning the queue can run the task, so
+  // all workers are woken.
+  m_mutex.Lock();
+  m_num_queued++;
+  m_num_pending++;
+  if (m_stealing) {
+    m_work_cond.Signal();
+  } else {
+    w->m_num_queued++;
+    m_work_cond.Broadcast();
+  }
+  m_mutex.Unlock();
+}
+
+void ChThreadPool::SetStealing(bool val)
+{
+  m_mutex.Lock();
+  m_stealing = val;
+  m_next = 0;
+  for (size_t i = 0; i < m_workers.size(); i++)
+    m_workers[i]->m_num_queued = 0;
+  m_mutex.Unlock();
+}
+
+void ChThreadPool::Wait()
+{
+  m_mutex.Lock();
+  while (m_num_pending > 0)
+    m_done_cond.Wait(m_mutex);
+  m_mutex.Unlock();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChTask* ChThreadPool::take(int id)
+{
+  int num_workers = (int)m_workers.size();
+  ChTask* task = 0;
+
+  // Own queue, most recently queued task first.
+  Worker* own = m_workers[id];
+  own->m_mutex.Lock();
+  if (!own->m_queue.empty()) {
+    task = own->m_queue.back();
+    own->m_queue.pop_back();
+  }
+  own->m_mutex.Unlock();
+
+  // Steal the oldest task from another queue, on the same node first.
+  for (int k = 1; !task && m_stealing && k < 2 * num_workers; k++) {
+    Worker* victim = m_workers[(id + k) % num_workers];
+    if ((victim->m_node == own->m_node) != (k < num_workers) || victim == own)
+      continue;
+    victim->m_mutex.Lock();
+    if (!victim->m_queue.empty()) {
+      task = victim->m_queue.front();
+      victim->m_queue.pop_front();
+    }
+    victim->m_mutex.Unlock();
+  }
+
+  return task;
+}
+
+void ChThreadPool::Worker::Run()
+{
+  // If the affinity cannot be set, the worker runs unpinned.
+  if (m_node >= 0)
+    ChThread::PinToNumaNode(m_node);
+
+  m_pool->work(m_id);
+}
+
+void ChThreadPool::work(int id)
+{
+  while (true) {
+    // Wait until a task is queued (or the pool is stopped) and reserve it.
+    m_mutex.Lock();
+    while (!m_stop && !has_work(id))
+      m_work_cond.Wait(m_mutex);
+    if (!has_work(id)) {
+      m_mutex.Unlock();
+      break;
+    }
+    m_num_queued--;
+    if (!m_stealing)
+      m_workers[id]->m_num_queued--;
+    m_mutex.Unlock();
+
+    // Tasks are counted only after being queued, so a reserved task is always
+    // found in one of the queues.
+    ChTask* task = 0;
+    while (!task)
+      task = take(id);
+
+    task->Execute(id);
+
+    m_mutex.Lock();
+    if (--m_num_pending == 0)
+      m_done_cond.Broadcast();
+    m_mutex.Unlock();
+  }
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,145 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Work-stealing thread pool for independent tasks.
+//
+// Each worker thread owns a task queue. Submitted tasks are distributed over
+// the worker queues; a worker runs the tasks in its own queue (most recently
+// queued first) and, when its queue is empty, steals the oldest task from the
+// queue of another worker.
+//
+// With NUMA placement, the workers are spread over the NUMA nodes of the
+// machine in contiguous blocks, and each worker pins itself to the
+// processors of its node before running any task; an idle worker then steals
+// from the workers of its own node first. A task submitted to a specific
+// worker (see Submit()) allocates the memory it first touches on the node of
+// that worker, and keeps running there unless another node runs out of work.
+//
+// Stealing can be disabled, so that every task runs on the worker it was
+// queued to: the assignment of tasks to workers then only depends on the
+// order of the Submit() calls, which makes it reproducible from run to run
+// (at the cost of idle workers if the tasks are unbalanced).
+//
+// =============================================================================
+
+#ifndef CH_THREADPOOL_H
+#define CH_THREADPOOL_H
+
+#include <deque>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Base class for a task executed by a ChThreadPool.
+///
+class CH_SUBSYS_API ChTask
+{
+public:
+  virtual ~ChTask() {}
+
+  /// Execute the task on the specified worker thread.
+  virtual void Execute(int worker) = 0;
+};
+
+///
+/// Work-stealing thread pool.
+/// Tasks are not owned by the pool; they must stay alive until they are
+/// executed (e.g. until Wait() returns).
+///
+class CH_SUBSYS_API ChThreadPool
+{
+public:
+
+  /// Create a pool with the specified number of worker threads. If zero, use
+  /// the number of hardware threads. With NUMA placement, the workers are
+  /// pinned to the NUMA nodes of the machine (ignored on a single node).
+  ChThreadPool(int num_threads = 0, bool numa_placement = false);
+
+  /// Wait for all submitted tasks, then stop the worker threads.
+  ~ChThreadPool();
+
+  /// Get the number of worker threads.
+  int GetNumThreads() const { return (int)m_workers.size(); }
+
+  /// Enable or disable work stealing (default: enabled). Must be called while
+  /// no tasks are pending.
+  void SetStealing(bool val);
+
+  /// Return true if idle workers steal the tasks of other workers.
+  bool IsStealing() const { return m_stealing; }
+
+  /// Get the NUMA node of the specified worker, or -1 if it is not pinned.
+  int GetWorkerNode(int worker) const { return m_workers[worker]->m_node; }
+
+  /// Queue the specified task for execution.
+  void Submit(ChTask* task);
+
+  /// Queue the specified task in the queue of the specified worker, which
+  /// runs it unless it is stolen by an idle worker.
+  void Submit(ChTask* task, int worker);
+
+  /// Wait until all submitted tasks have been executed.
+  void Wait();
+
+private:
+
+  class Worker : public ChThread {
+  public:
+    Worker(ChThreadPool* pool, int id, int node) : m_node(node), m_num_queued(0), m_pool(pool), m_id(id) {}
+    std::deque<ChTask*> m_queue;        // protected by m_mutex
+    ChMutex             m_mutex;
+    int                 m_node;         // NUMA node (-1: not pinned)
+    int                 m_num_queued;   // tasks in the queue, without stealing (protected by the pool mutex)
+  protected:
+    virtual void Run();
+  private:
+    ChThreadPool* m_pool;
+    int           m_id;
+  };
+
+  // Body of the worker threads.
+  void work(int id);
+
+  // Take a task from the queue of the specified worker (own queue) or, with
+  // stealing, from another worker's queue. Returns NULL if the queues are empty.
+  ChTask* take(int id);
+
+  // Return true if a task can be reserved by the specified worker (with the
+  // pool mutex locked).
+  bool has_work(int id) const { return m_stealing ? m_num_queued > 0 : m_workers[id]->m_num_queued > 0; }
+
+  std::vector<Worker*> m_workers;
+  int                  m_next;         // worker queue receiving the next task
+
+  ChMutex              m_mutex;        // protects the counters and m_stop
+  ChCondition          m_work_cond;    // signaled when tasks are queued
+  ChCondition          m_done_cond;    // signaled when all tasks are done
+  int                  m_num_queued;   // tasks waiting in the queues
+  int                  m_num_pending;  // tasks queued or executing
+  bool                 m_stealing;
+  bool                 m_stop;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -19,6 +19,8 @@
 //
 // =============================================================================
 
+#include <algorithm>
+
 #include "physics/ChSystem.h"
 
 #include "subsys/ChTire.h"
@@ -27,10 +29,83 @@
 namespace chrono {
 
 
+// -----------------------------------------------------------------------------
+// Terrain query policies for the contact tests. The generic policy goes through
+// the (virtual) ChTerrain interface; the flat policy is used for terrains that
+// are a horizontal plane, such that its queries are inlined and the contact
+// tests reduce to plane tests.
+// -----------------------------------------------------------------------------
+namespace {
+
+class GenericTerrainQuery {
+public:
+  GenericTerrainQuery(const ChTerrain& terrain) : m_terrain(terrain) {}
+
+  double GetHeight(double x, double y) const { return m_terrain.GetHeight(x, y); }
+
+  double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const {
+    return m_terrain.GetMaxHeight(xmin, ymin, xmax, ymax);
+  }
+
+  void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const {
+    m_terrain.GetHeightAndNormal(n, x, y, height, normal);
+  }
+
+private:
+  const ChTerrain& m_terrain;
+};
+
+class FlatTerrainQuery {
+public:
+  FlatTerrainQuery(double height) : m_height(height) {}
+
+  double GetHeight(double x, double y) const { return m_height; }
+
+  double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const { return m_height; }
+
+  void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const {
+    for (int i = 0; i < n; i++)
+      height[i] = m_height;
+    if (normal) {
+      for (int i = 0; i < n; i++)
+        normal[i] = ChVector<>(0, 0, 1);
+    }
+  }
+
+private:
+  double m_height;
+};
+
+}  // end anonymous namespace
+
+
 ChTire::ChTire(const std::string& name, const ChTerrain& terrain)
 : m_name(name),
-  m_terrain(terrain)
+  m_terrain(terrain),
+  m_mu_ref(0.8),
+  m_flat_height(0)
 {
+  // select the contact tests once, from the terrain type
+  m_flat_terrain = terrain.IsFlat(m_flat_height);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChTire::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  typedef vehicle::ChMemoryReport R;
+
+  size_t bytes = R::VectorBytes(m_query_x) + R::VectorBytes(m_query_y) + R::VectorBytes(m_query_h) +
+                 R::VectorBytes(m_query_n) + R::VectorBytes(m_miss_index) + R::VectorBytes(m_miss_center) +
+                 R::VectorBytes(m_miss_flag) + R::VectorBytes(m_miss_contact) + R::VectorBytes(m_miss_depth);
+  report.Add("tire/contact buffers", bytes);
+}
+
+size_t ChTire::GetMemoryFootprint() const
+{
+  vehicle::ChMemoryReport report;
+  AddMemoryFootprint(report);
+  return report.GetTotal();
 }
 
 
@@ -48,47 +123,418 @@ bool ChTire::disc_terrain_contact(const ChVector<>& disc_center,
                                   ChCoordsys<>&     contact,
                                   double&           depth)
 {
-  // Find terrain height below disc center. There is no contact if the disc
-  // center is below the terrain or farther away by more than its radius.
-  double hc = m_terrain.GetHeight(disc_center.x, disc_center.y);
-  if (disc_center.z <= hc || disc_center.z >= hc + disc_radius)
-    return false;
+  char in_contact;
+  disc_terrain_contact(1, &disc_center, disc_normal, disc_radius, &in_contact, &contact, &depth);
+
+  return in_contact != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Batched version of the disc-terrain contact test. The terrain is queried at
+// the disc centers and at the lowest points of the discs (which do not depend
+// on the terrain) in a single call; the contact tests are then the same as for
+// a single disc.
+// -----------------------------------------------------------------------------
+void ChTire::disc_terrain_contact(int               num_discs,
+                                  const ChVector<>* disc_centers,
+                                  const ChVector<>& disc_normal,
+                                  double            disc_radius,
+                                  char*             in_contact,
+                                  ChCoordsys<>*     contacts,
+                                  double*           depths,
+                                  ChVector<>*       center_normals)
+{
+  if (m_flat_terrain)
+    disc_contact(FlatTerrainQuery(m_flat_height), num_discs, disc_centers, disc_normal, disc_radius,
+                 in_contact, contacts, depths, center_normals);
+  else
+    disc_contact(GenericTerrainQuery(m_terrain), num_discs, disc_centers, disc_normal, disc_radius,
+                 in_contact, contacts, depths, center_normals);
+}
 
-  // Find the lowest point on the disc. There is no contact if the disc is
-  // (almost) horizontal.
+template <class TERRAIN>
+void ChTire::disc_contact(const TERRAIN&    terrain,
+                          int               num_discs,
+                          const ChVector<>* disc_centers,
+                          const ChVector<>& disc_normal,
+                          double            disc_radius,
+                          char*             in_contact,
+                          ChCoordsys<>*     contacts,
+                          double*           depths,
+                          ChVector<>*       center_normals)
+{
+  // Find the direction to the lowest point on the discs. There is no contact
+  // if the discs are (almost) horizontal.
   ChVector<> dir1 = Vcross(disc_normal, ChVector<>(0, 0, 1));
   double sinTilt2 = dir1.Length2();
+  bool horizontal = (sinTilt2 < 1e-3);
+
+  ChVector<> down = horizontal ? ChVector<>(0, 0, 0) : disc_radius * Vcross(disc_normal, dir1 / sqrt(sinTilt2));
+
+  size_t num_queries = 2 * num_discs;
+  if (m_query_x.size() < num_queries) {
+    m_query_x.resize(num_queries);
+    m_query_y.resize(num_queries);
+    m_query_h.resize(num_queries);
+    m_query_n.resize(num_queries);
+  }
+
+  // Broadphase: no disc is in contact if all the lowest points on the discs
+  // are above the maximum terrain height over their bounding box. In that
+  // case, the terrain is only queried for the normals below the disc centers
+  // (if requested).
+  bool culled = horizontal;
+  if (!culled) {
+    ChVector<> ptD = disc_centers[0] + down;
+    double xmin = ptD.x, xmax = ptD.x;
+    double ymin = ptD.y, ymax = ptD.y;
+    double zmin = ptD.z;
+    for (int id = 1; id < num_discs; id++) {
+      ptD = disc_centers[id] + down;
+      xmin = std::min(xmin, ptD.x);
+      xmax = std::max(xmax, ptD.x);
+      ymin = std::min(ymin, ptD.y);
+      ymax = std::max(ymax, ptD.y);
+      zmin = std::min(zmin, ptD.z);
+    }
+    culled = (zmin > terrain.GetMaxHeight(xmin, ymin, xmax, ymax));
+  }
+
+  if (culled) {
+    for (int id = 0; id < num_discs; id++)
+      in_contact[id] = 0;
+
+    if (center_normals) {
+      for (int id = 0; id < num_discs; id++) {
+        m_query_x[id] = disc_centers[id].x;
+        m_query_y[id] = disc_centers[id].y;
+      }
+      terrain.GetHeightAndNormal(num_discs, &m_query_x[0], &m_query_y[0], &m_query_h[0], center_normals);
+    }
+
+    return;
+  }
+
+  // Query the terrain below the disc centers (entries 0 ... n-1) and below the
+  // lowest points on the discs (entries n ... 2n-1).
+
+  for (int id = 0; id < num_discs; id++) {
+    ChVector<> ptD = disc_centers[id] + down;
+    m_query_x[id] = disc_centers[id].x;
+    m_query_y[id] = disc_centers[id].y;
+    m_query_x[num_discs + id] = ptD.x;
+    m_query_y[num_discs + id] = ptD.y;
+  }
+
+  terrain.GetHeightAndNormal((int)num_queries, &m_query_x[0], &m_query_y[0], &m_query_h[0], &m_query_n[0]);
+
+  for (int id = 0; id < num_discs; id++) {
+    if (center_normals)
+      center_normals[id] = m_query_n[id];
+
+    in_contact[id] = 0;
+
+    // There is no contact if the disc center is below the terrain or farther
+    // away by more than its radius.
+    double hc = m_query_h[id];
+    if (disc_centers[id].z <= hc || disc_centers[id].z >= hc + disc_radius)
+      continue;
+
+    if (horizontal)
+      continue;
+
+    // Contact point (lowest point on disc). No contact if lowest point is above
+    // the terrain.
+    ChVector<> ptD = disc_centers[id] + down;
+    double hp = m_query_h[num_discs + id];
+
+    if (ptD.z > hp)
+      continue;
+
+    // Approximate the terrain with a plane. Define the projection of the lowest
+    // point onto this plane as the contact point on the terrain.
+    const ChVector<>& normal = m_query_n[num_discs + id];
+    ChVector<> longitudinal = Vcross(disc_normal, normal);
+    longitudinal.Normalize();
+    ChVector<> lateral = Vcross(normal, longitudinal);
+    ChMatrix33<> rot;
+    rot.Set_A_axis(longitudinal, lateral, normal);
+
+    contacts[id].pos = ptD;
+    contacts[id].rot = rot.Get_A_quaternion();
+
+    depths[id] = Vdot(ChVector<>(0, 0, hp - ptD.z), normal);
+    assert(depths[id] > 0);
 
-  if (sinTilt2 < 1e-3)
+    in_contact[id] = 1;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Incremental version of the batched disc-terrain contact test. A disc whose
+// lowest point moved (horizontally) by less than the tolerance since the last
+// full test reuses the cached terrain normal there, such that the terrain is
+// only queried for the height at the new lowest point. The terrain is locally
+// approximated with the plane through this point, also for the height below
+// the disc center. All other discs go through the batched test, which also
+// refreshes their cache entries.
+// -----------------------------------------------------------------------------
+int ChTire::disc_terrain_contact(int               num_discs,
+                                 const ChVector<>* disc_centers,
+                                 const ChVector<>& disc_normal,
+                                 double            disc_radius,
+                                 double            tolerance,
+                                 DiscContactCache* cache,
+                                 char*             in_contact,
+                                 ChCoordsys<>*     contacts,
+                                 double*           depths)
+{
+  if (m_flat_terrain)
+    return disc_contact_cached(FlatTerrainQuery(m_flat_height), num_discs, disc_centers, disc_normal, disc_radius,
+                               tolerance, cache, in_contact, contacts, depths);
+  return disc_contact_cached(GenericTerrainQuery(m_terrain), num_discs, disc_centers, disc_normal, disc_radius,
+                             tolerance, cache, in_contact, contacts, depths);
+}
+
+template <class TERRAIN>
+int ChTire::disc_contact_cached(const TERRAIN&    terrain,
+                                int               num_discs,
+                                const ChVector<>* disc_centers,
+                                const ChVector<>& disc_normal,
+                                double            disc_radius,
+                                double            tolerance,
+                                DiscContactCache* cache,
+                                char*             in_contact,
+                                ChCoordsys<>*     contacts,
+                                double*           depths)
+{
+  ChVector<> dir1 = Vcross(disc_normal, ChVector<>(0, 0, 1));
+  double sinTilt2 = dir1.Length2();
+
+  if (sinTilt2 < 1e-3) {
+    for (int id = 0; id < num_discs; id++) {
+      cache[id].valid = false;
+      in_contact[id] = 0;
+    }
+    return 0;
+  }
+
+  ChVector<> down = disc_radius * Vcross(disc_normal, dir1 / sqrt(sinTilt2));
+  double tol2 = tolerance * tolerance;
+
+  if (m_miss_index.size() < (size_t)num_discs) {
+    m_miss_index.resize(num_discs);
+    m_miss_center.resize(num_discs);
+    m_miss_flag.resize(num_discs);
+    m_miss_contact.resize(num_discs);
+    m_miss_depth.resize(num_discs);
+  }
+
+  int num_hits = 0;
+  int num_misses = 0;
+
+  for (int id = 0; id < num_discs; id++) {
+    ChVector<> ptD = disc_centers[id] + down;
+    DiscContactCache& entry = cache[id];
+
+    double dx = ptD.x - entry.x;
+    double dy = ptD.y - entry.y;
+    if (!entry.valid || dx * dx + dy * dy > tol2) {
+      m_miss_index[num_misses] = id;
+      m_miss_center[num_misses] = disc_centers[id];
+      num_misses++;
+      continue;
+    }
+
+    num_hits++;
+    in_contact[id] = 0;
+
+    // Height below the disc center, from the plane through the lowest point.
+    const ChVector<>& normal = entry.normal;
+    double hp = terrain.GetHeight(ptD.x, ptD.y);
+    double hc = hp - (normal.x * (disc_centers[id].x - ptD.x) + normal.y * (disc_centers[id].y - ptD.y)) / normal.z;
+
+    // Out of contact; invalidate the entry so that the disc goes through the
+    // full test (and the broadphase) until it is back in contact.
+    if (disc_centers[id].z <= hc || disc_centers[id].z >= hc + disc_radius || ptD.z > hp) {
+      entry.valid = false;
+      continue;
+    }
+
+    ChVector<> longitudinal = Vcross(disc_normal, normal);
+    longitudinal.Normalize();
+    ChVector<> lateral = Vcross(normal, longitudinal);
+    ChMatrix33<> rot;
+    rot.Set_A_axis(longitudinal, lateral, normal);
+
+    contacts[id].pos = ptD;
+    contacts[id].rot = rot.Get_A_quaternion();
+    depths[id] = Vdot(ChVector<>(0, 0, hp - ptD.z), normal);
+
+    in_contact[id] = 1;
+  }
+
+  if (num_misses == 0)
+    return num_hits;
+
+  disc_contact(terrain, num_misses, &m_miss_center[0], disc_normal, disc_radius,
+               &m_miss_flag[0], &m_miss_contact[0], &m_miss_depth[0], 0);
+
+  // Scatter the results and cache the terrain normal below the lowest point of
+  // the discs in contact (the Z axis of the contact frame).
+  for (int im = 0; im < num_misses; im++) {
+    int id = m_miss_index[im];
+    DiscContactCache& entry = cache[id];
+
+    in_contact[id] = m_miss_flag[im];
+    entry.valid = (m_miss_flag[im] != 0);
+
+    if (!entry.valid)
+      continue;
+
+    contacts[id] = m_miss_contact[im];
+    depths[id] = m_miss_depth[im];
+
+    entry.x = contacts[id].pos.x;
+    entry.y = contacts[id].pos.y;
+    entry.normal = contacts[id].rot.GetZaxis();
+  }
+
+  return num_hits;
+}
+
+
+// -----------------------------------------------------------------------------
+// Enveloping version of the disc-terrain contact test. The footprint grid is
+// symmetric about its center, so the least squares plane h = a + b*u + c*v
+// decouples: a is the mean sample height and b, c are the slopes along the
+// (horizontal) longitudinal and lateral footprint directions.
+// -----------------------------------------------------------------------------
+bool ChTire::envelope_terrain_contact(const ChVector<>& disc_center,
+                                      const ChVector<>& disc_normal,
+                                      double            disc_radius,
+                                      int               num_long,
+                                      int               num_lat,
+                                      double            length,
+                                      double            width,
+                                      ChCoordsys<>&     contact,
+                                      double&           depth,
+                                      ChVector<>&       plane_normal)
+{
+  if (m_flat_terrain)
+    return envelope_contact(FlatTerrainQuery(m_flat_height), disc_center, disc_normal, disc_radius,
+                            num_long, num_lat, length, width, contact, depth, plane_normal);
+  return envelope_contact(GenericTerrainQuery(m_terrain), disc_center, disc_normal, disc_radius,
+                          num_long, num_lat, length, width, contact, depth, plane_normal);
+}
+
+template <class TERRAIN>
+bool ChTire::envelope_contact(const TERRAIN&    terrain,
+                              const ChVector<>& disc_center,
+                              const ChVector<>& disc_normal,
+                              double            disc_radius,
+                              int               num_long,
+                              int               num_lat,
+                              double            length,
+                              double            width,
+                              ChCoordsys<>&     contact,
+                              double&           depth,
+                              ChVector<>&       plane_normal)
+{
+  if (num_long < 1) num_long = 1;
+  if (num_lat < 1) num_lat = 1;
+
+  // Horizontal footprint directions and center (below the lowest point of the
+  // disc on flat ground).
+  ChVector<> Z_dir(0, 0, 1);
+  ChVector<> lon = Vcross(disc_normal, Z_dir);
+  double sinTilt2 = lon.Length2();
+  bool horizontal = (sinTilt2 < 1e-3);
+
+  lon = horizontal ? ChVector<>(1, 0, 0) : lon / sqrt(sinTilt2);
+  ChVector<> lat = Vcross(Z_dir, lon);
+  ChVector<> base = horizontal ? disc_center : disc_center + disc_radius * Vcross(disc_normal, lon);
+
+  // Sample the terrain on the footprint grid.
+  size_t num_queries = num_long * num_lat;
+  if (m_query_x.size() < num_queries) {
+    m_query_x.resize(num_queries);
+    m_query_y.resize(num_queries);
+    m_query_h.resize(num_queries);
+    m_query_n.resize(num_queries);
+  }
+
+  double du = (num_long > 1) ? length / (num_long - 1) : 0;
+  double dv = (num_lat > 1) ? width / (num_lat - 1) : 0;
+
+  for (int i = 0; i < num_long; i++) {
+    double u = (i - 0.5 * (num_long - 1)) * du;
+    for (int j = 0; j < num_lat; j++) {
+      double v = (j - 0.5 * (num_lat - 1)) * dv;
+      m_query_x[i * num_lat + j] = base.x + u * lon.x + v * lat.x;
+      m_query_y[i * num_lat + j] = base.y + u * lon.y + v * lat.y;
+    }
+  }
+
+  terrain.GetHeightAndNormal((int)num_queries, &m_query_x[0], &m_query_y[0], &m_query_h[0], 0);
+
+  // Fit the effective road plane.
+  double sum_h = 0;
+  double sum_uh = 0;
+  double sum_vh = 0;
+  double sum_uu = 0;
+  double sum_vv = 0;
+  for (int i = 0; i < num_long; i++) {
+    double u = (i - 0.5 * (num_long - 1)) * du;
+    for (int j = 0; j < num_lat; j++) {
+      double v = (j - 0.5 * (num_lat - 1)) * dv;
+      double h = m_query_h[i * num_lat + j];
+      sum_h += h;
+      sum_uh += u * h;
+      sum_vh += v * h;
+      sum_uu += u * u;
+      sum_vv += v * v;
+    }
+  }
+
+  double a = sum_h / num_queries;
+  double b = (sum_uu > 0) ? sum_uh / sum_uu : 0;
+  double c = (sum_vv > 0) ? sum_vh / sum_vv : 0;
+
+  ChVector<> plane_pt(base.x, base.y, a);
+  plane_normal = Z_dir - b * lon - c * lat;
+  plane_normal.Normalize();
+
+  // There is no contact if the disc center is below the plane or farther away
+  // by more than its radius.
+  double dist = Vdot(disc_center - plane_pt, plane_normal);
+  if (dist <= 0 || dist >= disc_radius)
     return false;
 
-  // Contact point (lowest point on disc).
-  ChVector<> ptD = disc_center + disc_radius * Vcross(disc_normal, dir1 / sqrt(sinTilt2));
+  // Lowest point on the disc, relative to the plane. No contact if the disc
+  // is (almost) parallel to the plane or if this point is above the plane.
+  ChVector<> down = Vdot(plane_normal, disc_normal) * disc_normal - plane_normal;
+  double down_len2 = down.Length2();
+  if (down_len2 < 1e-3)
+    return false;
 
-  // Find terrain height at lowest point. No contact if lowest point is above
-  // the terrain.
-  double hp = m_terrain.GetHeight(ptD.x, ptD.y);
+  ChVector<> ptD = disc_center + (disc_radius / sqrt(down_len2)) * down;
+  depth = Vdot(plane_pt - ptD, plane_normal);
 
-  if (ptD.z > hp)
+  if (depth <= 0)
     return false;
 
-  // Approximate the terrain with a plane. Define the projection of the lowest
-  // point onto this plane as the contact point on the terrain.
-  ChVector<> normal = m_terrain.GetNormal(ptD.x, ptD.y);
-  ChVector<> longitudinal = Vcross(disc_normal, normal);
+  ChVector<> longitudinal = Vcross(disc_normal, plane_normal);
   longitudinal.Normalize();
-  ChVector<> lateral = Vcross(normal, longitudinal);
+  ChVector<> lateral = Vcross(plane_normal, longitudinal);
   ChMatrix33<> rot;
-  rot.Set_A_axis(longitudinal, lateral, normal);
+  rot.Set_A_axis(longitudinal, lateral, plane_normal);
 
   contact.pos = ptD;
   contact.rot = rot.Get_A_quaternion();
 
-  depth = Vdot(ChVector<>(0, 0, hp - ptD.z), normal);
-  assert(depth > 0);
-
   return true;
 }
 
-
 }  // end namespace chrono
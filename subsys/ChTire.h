@@ -22,6 +22,8 @@
 #ifndef CH_TIRE_H
 #define CH_TIRE_H
 
+#include <vector>
+
 #include "core/ChShared.h"
 #include "core/ChVector.h"
 #include "core/ChQuaternion.h"
@@ -30,6 +32,8 @@
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChSubsysDefs.h"
 #include "subsys/ChTerrain.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChMemoryReport.h"
 
 namespace chrono {
 
@@ -72,8 +76,56 @@ public:
   /// force one the wheel body.
   virtual ChTireForce GetTireForce() const = 0;
 
+  /// Get the linearization of the tire force returned by GetTireForce() about
+  /// the wheel state passed to the last Update(), e.g. from the slip and
+  /// vertical stiffnesses of the tire. This lets the vehicle re-evaluate the
+  /// tire force with the current wheel kinematics between two tire updates
+  /// (see ChVehicle::SetTireForceLinearization()). Returns false if the tire
+  /// does not provide a linearization (the default); the force is then held.
+  virtual bool GetForceJacobian(ChTireForceJacobian& jacobian) const { return false; }
+
+  /// Return an estimate of the cost of one Update() and Advance() of this
+  /// tire, relative to that of a rigid tire. The base class returns 1.
+  /// This is used to decide whether the tires of a vehicle are worth updating
+  /// concurrently (see vehicle::ChVehicleSimulation).
+  virtual double GetUpdateCost() const { return 1; }
+
+  /// Append the internal state of this tire to the specified snapshot.
+  /// The base class implementation saves an empty block (no internal state).
+  virtual void SaveState(vehicle::ChVehicleState& state) const { state.BeginBlock(0); }
+
+  /// Restore the internal state of this tire from the next block of the
+  /// specified snapshot. Returns false if the block does not match this tire.
+  virtual bool RestoreState(vehicle::ChVehicleState& state) { return state.OpenBlock(0, m_name.c_str()); }
+
+  /// Add an estimate of the memory used by this tire to the specified report
+  /// (see vehicle::ChMemoryReport). Derived classes add their object and the
+  /// data they own, then call the base class implementation, which adds the
+  /// contact query buffers.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Return an estimate of the memory used by this tire, in bytes.
+  size_t GetMemoryFootprint() const;
+
+  /// Set the coefficient of friction of the road surface for which the tire
+  /// parameters were specified (default: 0.8, the default terrain value). The
+  /// tire friction forces are scaled by the ratio of the terrain coefficient
+  /// of friction at the contact point (see ChTerrain::GetCoefficientFriction())
+  /// to this value.
+  void SetReferenceFriction(double mu) { m_mu_ref = mu; }
+
+  /// Get the reference coefficient of friction.
+  double GetReferenceFriction() const { return m_mu_ref; }
+
 protected:
 
+  /// Return the scaling factor of the tire friction forces at the specified
+  /// contact point (see SetReferenceFriction()).
+  double friction_scale(const ChVector<>& point) const
+  {
+    return m_terrain.GetCoefficientFriction(point.x, point.y) / m_mu_ref;
+  }
+
   /// Perform disc-terrain collision detection.
   /// This utility function checks for contact between a disc of specified 
   /// radius with given position and orientation (specified as the location of
@@ -91,8 +143,110 @@ protected:
     double&           depth           ///< [out] penetration depth (positive if contact occurred)
     );
 
+  /// Perform disc-terrain collision detection for a set of parallel discs.
+  /// This is equivalent to calling the single-disc version for each disc, but
+  /// all terrain heights and normals are obtained with a single batched query
+  /// (see ChTerrain::GetHeightAndNormal()). Optionally, it also returns the
+  /// terrain normals below the disc centers.
+  void  disc_terrain_contact(
+    int               num_discs,      ///< [in] number of discs
+    const ChVector<>* disc_centers,   ///< [in] global locations of the disc centers
+    const ChVector<>& disc_normal,    ///< [in] disc normal, expressed in the global frame
+    double            disc_radius,    ///< [in] disc radius
+    char*             in_contact,     ///< [out] flags, non-zero if the disc contacts the terrain
+    ChCoordsys<>*     contacts,       ///< [out] contact coordinate systems (set only for discs in contact)
+    double*           depths,         ///< [out] penetration depths (set only for discs in contact)
+    ChVector<>*       center_normals = 0  ///< [out] terrain normals below the disc centers (optional)
+    );
+
+  /// Cached terrain data below the lowest point of a disc in contact (see the
+  /// incremental version of disc_terrain_contact()).
+  struct DiscContactCache {
+    DiscContactCache() : valid(false), x(0), y(0), normal(0, 0, 1) {}
+    bool        valid;    ///< true if the entry holds the data of a disc in contact
+    double      x;        ///< location of the lowest disc point
+    double      y;
+    ChVector<>  normal;   ///< terrain normal at that location
+  };
+
+  /// Perform incremental disc-terrain collision detection for a set of
+  /// parallel discs. A disc in contact whose lowest point moved by less than
+  /// the specified tolerance (in the x-y plane) since its cache entry was set
+  /// reuses the cached terrain normal and only queries the terrain height at
+  /// its lowest point; the terrain is approximated with the plane through that
+  /// point. All other discs are tested with the batched version, which also
+  /// updates their cache entries. The tolerance should be small relative to
+  /// the terrain resolution. Returns the number of discs found in the cache.
+  int   disc_terrain_contact(
+    int               num_discs,      ///< [in] number of discs
+    const ChVector<>* disc_centers,   ///< [in] global locations of the disc centers
+    const ChVector<>& disc_normal,    ///< [in] disc normal, expressed in the global frame
+    double            disc_radius,    ///< [in] disc radius
+    double            tolerance,      ///< [in] maximum displacement for reusing a cache entry
+    DiscContactCache* cache,          ///< [in,out] cache entries (one per disc)
+    char*             in_contact,     ///< [out] flags, non-zero if the disc contacts the terrain
+    ChCoordsys<>*     contacts,       ///< [out] contact coordinate systems (set only for discs in contact)
+    double*           depths          ///< [out] penetration depths (set only for discs in contact)
+    );
+
+  /// Perform disc-terrain collision detection against an effective road plane.
+  /// The terrain is sampled, with a single batched query, on a grid of
+  /// num_long x num_lat points covering a footprint of the specified length
+  /// (along the rolling direction) and width, centered below the disc center.
+  /// The samples are fitted (least squares) with a plane, which is then used
+  /// in place of the terrain for the disc contact test; this envelops terrain
+  /// features shorter than the footprint. The outputs are as for the single
+  /// disc version; in addition, plane_normal is set to the normal of the
+  /// effective plane (also if there is no contact).
+  bool  envelope_terrain_contact(
+    const ChVector<>& disc_center,    ///< [in] global location of the disc center
+    const ChVector<>& disc_normal,    ///< [in] disc normal, expressed in the global frame
+    double            disc_radius,    ///< [in] disc radius
+    int               num_long,       ///< [in] number of samples along the rolling direction
+    int               num_lat,        ///< [in] number of samples across the footprint
+    double            length,         ///< [in] footprint length
+    double            width,          ///< [in] footprint width
+    ChCoordsys<>&     contact,        ///< [out] contact coordinate system (relative to the global frame)
+    double&           depth,          ///< [out] penetration depth (positive if contact occurred)
+    ChVector<>&       plane_normal    ///< [out] normal of the effective road plane
+    );
+
   std::string       m_name;      ///< name of this tire subsystem
   const ChTerrain&  m_terrain;   ///< reference to the terrain system
+  double            m_mu_ref;    ///< reference coefficient of friction
+
+private:
+
+  // Implementations of the contact tests, for the terrain accessed through
+  // the TERRAIN query policy (see ChTire.cpp).
+  template <class TERRAIN>
+  void disc_contact(const TERRAIN& terrain, int num_discs, const ChVector<>* disc_centers,
+                    const ChVector<>& disc_normal, double disc_radius, char* in_contact,
+                    ChCoordsys<>* contacts, double* depths, ChVector<>* center_normals);
+  template <class TERRAIN>
+  int disc_contact_cached(const TERRAIN& terrain, int num_discs, const ChVector<>* disc_centers,
+                          const ChVector<>& disc_normal, double disc_radius, double tolerance,
+                          DiscContactCache* cache, char* in_contact, ChCoordsys<>* contacts, double* depths);
+  template <class TERRAIN>
+  bool envelope_contact(const TERRAIN& terrain, const ChVector<>& disc_center, const ChVector<>& disc_normal,
+                        double disc_radius, int num_long, int num_lat, double length, double width,
+                        ChCoordsys<>& contact, double& depth, ChVector<>& plane_normal);
+
+  bool   m_flat_terrain;   // the terrain is a horizontal plane (see ChTerrain::IsFlat)
+  double m_flat_height;    // height of the flat terrain
+
+  // Buffers for the batched terrain queries (reused between calls).
+  std::vector<double>      m_query_x;
+  std::vector<double>      m_query_y;
+  std::vector<double>      m_query_h;
+  std::vector<ChVector<> > m_query_n;
+
+  // Buffers for the discs missing the cache (reused between calls).
+  std::vector<int>           m_miss_index;
+  std::vector<ChVector<> >   m_miss_center;
+  std::vector<char>          m_miss_flag;
+  std::vector<ChCoordsys<> > m_miss_contact;
+  std::vector<double>        m_miss_depth;
 };
 
 
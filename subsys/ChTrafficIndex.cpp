@@ -0,0 +1,232 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Spatial index of the vehicles of a fleet.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChTrafficIndex.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+static bool compare_distance(const ChTrafficIndex::Neighbor& a, const ChTrafficIndex::Neighbor& b)
+{
+  return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+}
+
+// Insert a candidate in the sorted list of the (at most) k nearest vehicles.
+static void insert_nearest(std::vector<ChTrafficIndex::Neighbor>& list, int k, const ChTrafficIndex::Neighbor& nb)
+{
+  if ((int)list.size() == k) {
+    if (!compare_distance(nb, list.back()))
+      return;
+    list.pop_back();
+  }
+  list.insert(std::upper_bound(list.begin(), list.end(), nb, compare_distance), nb);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChTrafficIndex::ChTrafficIndex(double cell_size)
+: m_cell(cell_size > 0 ? cell_size : 20)
+{
+}
+
+void ChTrafficIndex::SetNumVehicles(int num_vehicles)
+{
+  m_x.resize(num_vehicles, 0);
+  m_y.resize(num_vehicles, 0);
+  m_cos.resize(num_vehicles, 1);
+  m_sin.resize(num_vehicles, 0);
+  m_speed.resize(num_vehicles, 0);
+
+  // The previous order only helps if the same vehicles are indexed.
+  m_grid.clear();
+}
+
+void ChTrafficIndex::SetVehicle(int index, const ChVehicle& vehicle)
+{
+  const ChVector<>& pos = vehicle.GetChassisPos();
+  ChVector<> xaxis = vehicle.GetChassisRot().GetXaxis();
+  double speed = vehicle.GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt() ^ xaxis;
+
+  SetVehicle(index, pos.x, pos.y, std::atan2(xaxis.y, xaxis.x), speed);
+}
+
+void ChTrafficIndex::SetVehicle(int index, double x, double y, double heading, double speed)
+{
+  m_x[index] = x;
+  m_y[index] = y;
+  m_cos[index] = std::cos(heading);
+  m_sin[index] = std::sin(heading);
+  m_speed[index] = speed;
+}
+
+long long ChTrafficIndex::point_key(double x, double y) const
+{
+  return cell_key((long long)std::floor(x / m_cell), (long long)std::floor(y / m_cell));
+}
+
+// -----------------------------------------------------------------------------
+// The grid is sorted again by insertion, from the order of the previous step.
+// -----------------------------------------------------------------------------
+void ChTrafficIndex::Build()
+{
+  int n = (int)m_x.size();
+
+  if ((int)m_grid.size() != n) {
+    m_grid.resize(n);
+    for (int i = 0; i < n; i++)
+      m_grid[i].second = i;
+  }
+
+  for (int i = 0; i < n; i++)
+    m_grid[i].first = point_key(m_x[m_grid[i].second], m_y[m_grid[i].second]);
+
+  for (int i = 1; i < n; i++) {
+    std::pair<long long, int> entry = m_grid[i];
+    int j = i - 1;
+    while (j >= 0 && entry < m_grid[j]) {
+      m_grid[j + 1] = m_grid[j];
+      j--;
+    }
+    m_grid[j + 1] = entry;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Queries. After the rings 0..r around the cell of the query point have been
+// visited, the other vehicles are farther than r cells from the point.
+// -----------------------------------------------------------------------------
+int ChTrafficIndex::FindNearest(int index, int k, double radius, std::vector<Neighbor>& result) const
+{
+  return FindNearest(m_x[index], m_y[index], index, k, radius, result);
+}
+
+int ChTrafficIndex::FindNearest(double x, double y, int exclude, int k, double radius,
+                                std::vector<Neighbor>& result) const
+{
+  result.clear();
+  if (k <= 0 || m_grid.empty())
+    return 0;
+
+  long long ci = (long long)std::floor(x / m_cell);
+  long long cj = (long long)std::floor(y / m_cell);
+  int max_rings = (int)std::ceil(radius / m_cell);
+
+  for (int r = 0; r <= max_rings; r++) {
+    for (long long j = cj - r; j <= cj + r; j++) {
+      long long step = (j == cj - r || j == cj + r) ? 1 : 2 * r;
+      for (long long i = ci - r; i <= ci + r; i += step) {
+        long long key = cell_key(i, j);
+        std::vector<std::pair<long long, int> >::const_iterator it =
+            std::lower_bound(m_grid.begin(), m_grid.end(), std::make_pair(key, -1));
+        for (; it != m_grid.end() && it->first == key; ++it) {
+          int v = it->second;
+          if (v == exclude)
+            continue;
+          double dist = std::sqrt((m_x[v] - x) * (m_x[v] - x) + (m_y[v] - y) * (m_y[v] - y));
+          if (dist > radius)
+            continue;
+          Neighbor nb;
+          nb.index = v;
+          nb.distance = dist;
+          nb.speed = m_speed[v];
+          insert_nearest(result, k, nb);
+        }
+      }
+    }
+
+    if ((int)result.size() == k && result.back().distance <= r * m_cell)
+      break;
+  }
+
+  return (int)result.size();
+}
+
+bool ChTrafficIndex::FindAhead(int index, double max_distance, double half_width, Neighbor& result) const
+{
+  if (m_grid.empty())
+    return false;
+
+  double x = m_x[index];
+  double y = m_y[index];
+  double c = m_cos[index];
+  double s = m_sin[index];
+
+  long long ci = (long long)std::floor(x / m_cell);
+  long long cj = (long long)std::floor(y / m_cell);
+  int max_rings = (int)std::ceil(std::sqrt(max_distance * max_distance + half_width * half_width) / m_cell);
+
+  // Cells are skipped if they are entirely behind or beside the lane: the
+  // lateral and longitudinal extent of a cell around its center is
+  // (|cos| + |sin|) cell / 2.
+  double extent = 0.5 * m_cell * (std::abs(c) + std::abs(s));
+
+  bool found = false;
+  result.index = -1;
+  result.distance = max_distance;
+  result.speed = 0;
+
+  for (int r = 0; r <= max_rings; r++) {
+    for (long long j = cj - r; j <= cj + r; j++) {
+      long long step = (j == cj - r || j == cj + r) ? 1 : 2 * r;
+      for (long long i = ci - r; i <= ci + r; i += step) {
+        double cx = (i + 0.5) * m_cell - x;
+        double cy = (j + 0.5) * m_cell - y;
+        if (cx * c + cy * s < -extent || std::abs(cy * c - cx * s) > half_width + extent)
+          continue;
+        long long key = cell_key(i, j);
+        std::vector<std::pair<long long, int> >::const_iterator it =
+            std::lower_bound(m_grid.begin(), m_grid.end(), std::make_pair(key, -1));
+        for (; it != m_grid.end() && it->first == key; ++it) {
+          int v = it->second;
+          if (v == index)
+            continue;
+          double dx = m_x[v] - x;
+          double dy = m_y[v] - y;
+          double along = dx * c + dy * s;
+          double lateral = dy * c - dx * s;
+          if (along <= 0 || along > result.distance || std::abs(lateral) > half_width)
+            continue;
+          if (found && along == result.distance && v > result.index)
+            continue;
+          found = true;
+          result.index = v;
+          result.distance = along;
+          result.speed = m_speed[v];
+        }
+      }
+    }
+
+    // The vehicles not visited yet are farther than r cells from the query
+    // point and, if in the lane, farther than sqrt((r cell)^2 - w^2) along
+    // the heading.
+    if (found && result.distance * result.distance + half_width * half_width <= (r * m_cell) * (r * m_cell))
+      break;
+  }
+
+  return found;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
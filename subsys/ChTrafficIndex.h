@@ -0,0 +1,135 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Spatial index of the vehicles of a fleet, for proximity queries between
+// vehicles (e.g. by adaptive cruise control or collision avoidance drivers).
+//
+// The index keeps the planar position, heading and forward speed of each
+// vehicle, and a uniform grid of the vehicles: the list of (cell, vehicle)
+// pairs sorted by cell. Each step, the vehicle states are set (concurrently,
+// one vehicle per thread) and the list is sorted again by insertion from its
+// previous order; since few vehicles change cell over a step, this costs
+// linear time in the number of vehicles.
+//
+// Queries search the grid ring by ring around the query point, and stop as
+// soon as the vehicles not yet visited are farther than the best results. The
+// queries do not modify the index, so they can be made concurrently (but not
+// while the index is being updated).
+//
+// =============================================================================
+
+#ifndef CH_TRAFFIC_INDEX_H
+#define CH_TRAFFIC_INDEX_H
+
+#include <utility>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Uniform-grid index of vehicle positions for traffic-level proximity queries.
+///
+class CH_SUBSYS_API ChTrafficIndex
+{
+public:
+
+  /// Result of a proximity query.
+  struct Neighbor {
+    int     index;      ///< index of the vehicle
+    double  distance;   ///< distance (for FindAhead: along the heading of the query)
+    double  speed;      ///< forward speed of the vehicle
+  };
+
+  /// Create an empty index with the specified size of the grid cells.
+  ChTrafficIndex(double cell_size = 20);
+
+  ~ChTrafficIndex() {}
+
+  /// Set the number of vehicles (the states of new vehicles must be set
+  /// before the next call to Build()).
+  void SetNumVehicles(int num_vehicles);
+
+  /// Get the number of vehicles.
+  int GetNumVehicles() const { return (int)m_x.size(); }
+
+  /// Set the state of the specified vehicle from its chassis reference frame.
+  /// Can be called concurrently for different vehicles.
+  void SetVehicle(int index, const ChVehicle& vehicle);
+
+  /// Set the state of the specified vehicle.
+  /// Can be called concurrently for different vehicles.
+  void SetVehicle(
+    int     index,      ///< [in] index of the vehicle
+    double  x,          ///< [in] x coordinate
+    double  y,          ///< [in] y coordinate
+    double  heading,    ///< [in] heading angle (from the x axis)
+    double  speed       ///< [in] forward speed
+    );
+
+  /// Update the grid from the current vehicle states.
+  void Build();
+
+  /// Find the (at most) k vehicles nearest to the specified vehicle, within
+  /// the specified radius, sorted by increasing distance.
+  /// Returns the number of vehicles found.
+  int FindNearest(
+    int                     index,    ///< [in] index of the query vehicle (excluded)
+    int                     k,        ///< [in] maximum number of vehicles
+    double                  radius,   ///< [in] search radius
+    std::vector<Neighbor>&  result    ///< [out] nearest vehicles
+    ) const;
+
+  /// Find the (at most) k vehicles nearest to the specified point, within the
+  /// specified radius, excluding the specified vehicle (-1 for none).
+  int FindNearest(double x, double y, int exclude, int k, double radius, std::vector<Neighbor>& result) const;
+
+  /// Find the nearest vehicle ahead of the specified vehicle, in its lane: in
+  /// the band of the specified half width around its heading direction, and
+  /// within the specified distance along it.
+  /// Returns false if there is no such vehicle.
+  bool FindAhead(
+    int        index,         ///< [in] index of the query vehicle
+    double     max_distance,  ///< [in] maximum distance along the heading
+    double     half_width,    ///< [in] lane half width
+    Neighbor&  result         ///< [out] nearest vehicle ahead
+    ) const;
+
+private:
+
+  // Key of the grid cell with the specified integer coordinates.
+  static long long cell_key(long long i, long long j) { return (i << 32) ^ (j & 0xffffffffLL); }
+  long long point_key(double x, double y) const;
+
+  double                                   m_cell;
+
+  std::vector<double>                      m_x;
+  std::vector<double>                      m_y;
+  std::vector<double>                      m_cos;     // heading direction
+  std::vector<double>                      m_sin;
+  std::vector<double>                      m_speed;
+
+  std::vector<std::pair<long long, int> >  m_grid;    // (cell key, vehicle), sorted by key
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,112 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Lock-free triple buffer, passing the latest value of some data from a single
+// producer thread to a single consumer thread.
+//
+// The producer writes into its own buffer and publishes it by exchanging it
+// with the middle buffer; the consumer acquires the latest published value by
+// exchanging the middle buffer with its own. Neither side ever blocks or waits
+// for the other: the producer may publish at any rate (intermediate values are
+// simply dropped) and the consumer keeps reading its buffer until a newer value
+// is available.
+//
+// =============================================================================
+
+#ifndef CH_TRIPLE_BUFFER_H
+#define CH_TRIPLE_BUFFER_H
+
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Single-producer, single-consumer triple buffer.
+/// GetWriteBuffer() and Publish() may only be called from one (producer)
+/// thread and Acquire() and GetReadBuffer() from one (consumer) thread.
+///
+template <typename T>
+class ChTripleBuffer
+{
+public:
+
+  ChTripleBuffer()
+  : m_write(0),
+    m_middle(1),
+    m_read(2)
+  {}
+
+  /// Set all three buffers to the specified value (e.g. to size them once).
+  /// May only be called while neither thread uses the buffer.
+  void Reset(const T& val)
+  {
+    for (int i = 0; i < 3; i++)
+      m_buffers[i] = val;
+    m_write = 0;
+    m_middle = 1;
+    m_read = 2;
+  }
+
+  /// Get the buffer to be filled by the producer. Its contents are those of
+  /// an older published value (or the initial value).
+  T& GetWriteBuffer() { return m_buffers[m_write]; }
+
+  /// Publish the contents of the write buffer (producer thread).
+  void Publish()
+  {
+    m_write = ChAtomicExchange(&m_middle, m_write | FRESH) & INDEX;
+  }
+
+  /// Make the latest published value the read buffer (consumer thread).
+  /// Returns false (and keeps the current read buffer) if no value was
+  /// published since the last call.
+  bool Acquire()
+  {
+    if (!(ChAtomicLoad(&m_middle) & FRESH))
+      return false;
+    m_read = ChAtomicExchange(&m_middle, m_read) & INDEX;
+    return true;
+  }
+
+  /// Get the buffer read by the consumer.
+  const T& GetReadBuffer() const { return m_buffers[m_read]; }
+
+private:
+
+  ChTripleBuffer(const ChTripleBuffer&);
+  ChTripleBuffer& operator=(const ChTripleBuffer&);
+
+  enum {
+    INDEX = 3,     // buffer index bits of m_middle
+    FRESH = 4,     // set in m_middle when it holds an unread value
+    CACHE_LINE = 64
+  };
+
+  T                m_buffers[3];
+
+  size_t           m_write;      // index of the producer buffer
+  char             m_pad0[CACHE_LINE];
+  volatile size_t  m_middle;     // index of the middle buffer (and FRESH flag)
+  char             m_pad1[CACHE_LINE - sizeof(size_t)];
+  size_t           m_read;       // index of the consumer buffer
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
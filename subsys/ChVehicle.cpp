@@ -17,9 +17,21 @@
 // =============================================================================
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "physics/ChShaft.h"
+#include "physics/ChLinkLock.h"
+#include "physics/ChLinkSpring.h"
+#include "physics/ChLinkSpringCB.h"
+#include "physics/ChLinkDistance.h"
 
 #include "subsys/ChVehicle.h"
 #include "subsys/ChDriveline.h"
+#include "subsys/ChConstraintMonitor.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChProfiler.h"
 
 
 namespace chrono {
@@ -31,17 +43,24 @@ namespace chrono {
 // -----------------------------------------------------------------------------
 ChVehicle::ChVehicle()
 : m_ownsSystem(true),
-  m_stepsize(1e-3)
+  m_stepsize(1e-3),
+  m_record_solver(false),
+  m_direct_solver(false),
+  m_direct_active(false),
+  m_contact_free(false),
+  m_checked_bodies(-1),
+  m_adaptive_step(false),
+  m_constraint_monitor(0),
+  m_tire_linearized(false),
+  m_wheel_pairs(false),
+  m_chassis_pairs(false)
 {
   m_system = new ChSystem;
 
   m_system->Set_G_acc(ChVector<>(0, 0, -9.81));
 
   // Integration and Solver settings
-  m_system->SetLcpSolverType(ChSystem::LCP_ITERATIVE_SOR);
-  m_system->SetIterLCPmaxItersSpeed(150);
-  m_system->SetIterLCPmaxItersStab(150);
-  m_system->SetMaxPenetrationRecoverySpeed(4.0);
+  SetSolverProfile("batch");
 }
 
 
@@ -51,7 +70,17 @@ ChVehicle::ChVehicle()
 ChVehicle::ChVehicle(ChSystem* system)
 : m_system(system),
   m_ownsSystem(false),
-  m_stepsize(1e-3)
+  m_stepsize(1e-3),
+  m_record_solver(false),
+  m_direct_solver(false),
+  m_direct_active(false),
+  m_contact_free(false),
+  m_checked_bodies(-1),
+  m_adaptive_step(false),
+  m_constraint_monitor(0),
+  m_tire_linearized(false),
+  m_wheel_pairs(false),
+  m_chassis_pairs(false)
 {
 }
 
@@ -61,8 +90,10 @@ ChVehicle::ChVehicle(ChSystem* system)
 // -----------------------------------------------------------------------------
 ChVehicle::~ChVehicle()
 {
-  if (m_ownsSystem)
+  if (m_ownsSystem) {
+    vehicle::ChDeferredAssets::Discard(m_system);
     delete m_system;
+  }
 }
 
 
@@ -72,12 +103,250 @@ ChVehicle::~ChVehicle()
 // ---------------------------------------------------------------------------- -
 void ChVehicle::Advance(double step)
 {
+  CH_PROFILE_SCOPE("ChVehicle::Advance");
+
   double t = 0;
   while (t < step) {
-    double h = std::min<>(m_stepsize, step - t);
+    double h = std::min<>(m_adaptive_step ? m_step_control.GetStep() : m_stepsize, step - t);
+    if (m_direct_solver)
+      update_solver_mode();
+    if (m_tire_linearized)
+      apply_linearized_tire_forces();
+    if (!m_driveline.IsNull() && !m_driveline->GetShaftNetwork().IsNull())
+      m_driveline->GetShaftNetwork()->Advance(h);
+#if PROFILING_ENABLED
+    double start = vehicle::ChProfiler::GetTime();
+#endif
     m_system->DoStepDynamics(h);
+    if (m_record_solver) {
+      m_solver_stats.Record(m_system);
+      CH_PROFILE_COUNTER("ChVehicle::solver_iterations", m_solver_stats.GetIterations());
+    }
+#if PROFILING_ENABLED
+    // Split the step time using the timers of the Chrono system.
+    double collision = m_system->GetTimerCollisionBroad();
+    double solver = m_system->GetTimerLcp();
+    CH_PROFILE_RECORD("ChVehicle::Advance/collision", collision);
+    CH_PROFILE_RECORD("ChVehicle::Advance/solver", solver);
+    CH_PROFILE_RECORD("ChVehicle::Advance/other", vehicle::ChProfiler::GetTime() - start - collision - solver);
+    CH_PROFILE_COUNTER("ChVehicle::contacts", m_system->GetNcontacts());
+#endif
+    if (m_constraint_monitor)
+      m_constraint_monitor->Update(m_system->GetChTime());
+    if (m_adaptive_step)
+      update_step_control(h);
     t += h;
   }
+
+  m_tire_linearized = false;
+}
+
+// -----------------------------------------------------------------------------
+// Adaptive integration step
+// -----------------------------------------------------------------------------
+void ChVehicle::SetAdaptiveStep(bool enable)
+{
+  m_adaptive_step = enable;
+  if (enable)
+    m_step_control.Reset(m_stepsize);
+}
+
+void ChVehicle::update_step_control(double h)
+{
+  int num_wheels = 2 * GetNumberAxles();
+  ChWheelStates states(num_wheels);
+  double omega[CH_MAX_WHEELS];
+  if (num_wheels > 0)
+    GetWheelStates(&states[0], num_wheels);
+  for (int i = 0; i < num_wheels; i++)
+    omega[i] = states[i].omega;
+
+  // The monitor already computed the violation at this step.
+  double violation = 0;
+  bool event = false;
+  if (m_constraint_monitor) {
+    violation = m_constraint_monitor->GetMaxViolation();
+    event = m_constraint_monitor->IsStepReductionRequested();
+  } else if (m_step_control.UsesViolation()) {
+    violation = GetConstraintViolation();
+  }
+
+  m_step_control.Update(h, m_system->GetNcontacts(), omega, num_wheels, violation, event);
+  CH_PROFILE_COUNTER("ChVehicle::step_size", h);
+}
+
+double ChVehicle::GetConstraintViolation() const
+{
+  double violation = 0;
+
+  std::vector<ChLink*>::iterator ilink = m_system->Get_linklist()->begin();
+  for (; ilink != m_system->Get_linklist()->end(); ++ilink) {
+    ChMatrix<>* C = (*ilink)->GetC();
+    if (!C)
+      continue;
+    for (int i = 0; i < C->GetRows(); i++)
+      violation = std::max(violation, std::abs(C->GetElement(i, 0)));
+  }
+
+  return violation;
+}
+
+void ChVehicle::SetConstraintMonitor(vehicle::ChConstraintMonitor* monitor)
+{
+  m_constraint_monitor = monitor;
+  if (monitor)
+    monitor->Initialize(*this);
+}
+
+// -----------------------------------------------------------------------------
+// Linearized tire forces
+// -----------------------------------------------------------------------------
+void ChVehicle::SetTireForceLinearization(const ChTireForces&         tire_forces,
+                                          const ChWheelStates&        wheel_states,
+                                          const ChTireForceJacobians& jacobians)
+{
+  assert(tire_forces.size() == wheel_states.size() && jacobians.size() == wheel_states.size());
+
+  m_lin_forces = tire_forces;
+  m_lin_states = wheel_states;
+  m_lin_jacobians = jacobians;
+  m_tire_linearized = true;
+}
+
+void ChVehicle::apply_linearized_tire_forces()
+{
+  int num_wheels = (int)m_lin_states.size();
+  if (num_wheels == 0)
+    return;
+
+  ChWheelStates states(num_wheels);
+  ChTireForces forces = m_lin_forces;
+  GetWheelStates(&states[0], num_wheels);
+
+  for (int i = 0; i < num_wheels; i++) {
+    const ChTireForceJacobian& J = m_lin_jacobians[i];
+    ChVector<> dp = states[i].pos - m_lin_states[i].pos;
+    ChVector<> dv = states[i].lin_vel - m_lin_states[i].lin_vel;
+    double domega = states[i].omega - m_lin_states[i].omega;
+    forces[i].force += J.dF_dpx * dp.x + J.dF_dpy * dp.y + J.dF_dpz * dp.z +
+                       J.dF_dvx * dv.x + J.dF_dvy * dv.y + J.dF_dvz * dv.z + J.dF_domega * domega;
+  }
+
+  ApplyTireForces(&forces[0], num_wheels);
+}
+
+
+// -----------------------------------------------------------------------------
+// Collision families. The chassis and the wheels of all vehicles share two
+// families, such that the vehicle-internal pairs (and the pairs between
+// vehicles) are culled by the broadphase unless enabled.
+// -----------------------------------------------------------------------------
+void ChVehicle::SetCollisionFamily(ChBody* body, int family, bool wheel_pairs, bool chassis_pairs)
+{
+  collision::ChCollisionModel* model = body->GetCollisionModel();
+  bool wheel = (family == WHEEL_FAMILY);
+
+  model->SetFamily(family);
+
+  if (wheel_pairs)
+    model->SetFamilyMaskDoCollisionWithFamily(WHEEL_FAMILY);
+  else
+    model->SetFamilyMaskNoCollisionWithFamily(WHEEL_FAMILY);
+
+  if (wheel ? wheel_pairs : chassis_pairs)
+    model->SetFamilyMaskDoCollisionWithFamily(CHASSIS_FAMILY);
+  else
+    model->SetFamilyMaskNoCollisionWithFamily(CHASSIS_FAMILY);
+}
+
+void ChVehicle::SetCollisionPairs(bool wheel_pairs, bool chassis_pairs)
+{
+  m_wheel_pairs = wheel_pairs;
+  m_chassis_pairs = chassis_pairs;
+
+  if (!m_chassis.IsNull())
+    InitializeCollisionFamilies();
+}
+
+void ChVehicle::InitializeCollisionFamilies()
+{
+  SetCollisionFamily(m_chassis.get_ptr(), CHASSIS_FAMILY, m_wheel_pairs, m_chassis_pairs);
+
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    SetCollisionFamily(m_suspensions[i]->GetSpindleBody(LEFT), WHEEL_FAMILY, m_wheel_pairs, m_chassis_pairs);
+    SetCollisionFamily(m_suspensions[i]->GetSpindleBody(RIGHT), WHEEL_FAMILY, m_wheel_pairs, m_chassis_pairs);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Solver settings and statistics
+// -----------------------------------------------------------------------------
+void ChVehicle::SetSolverProfile(const ChSolverProfile& profile)
+{
+  m_solver_profile = profile;
+  m_solver_profile.Apply(m_system);
+  m_record_solver = true;
+  m_direct_active = false;
+  m_solver_stats.Reset();
+}
+
+void ChVehicle::SetWarmStart(bool enable)
+{
+  m_solver_profile.warm_start = enable;
+  m_system->SetIterLCPwarmStarting(enable);
+}
+
+void ChVehicle::EnableDirectSolver(bool enable)
+{
+  m_direct_solver = enable;
+  m_checked_bodies = -1;
+
+  if (!enable && m_direct_active) {
+    m_solver_profile.Apply(m_system);
+    m_direct_active = false;
+  }
+}
+
+// The solvers are only replaced when switching between the direct solver and
+// the solver profile, e.g. when a collision body is added or a contact occurs.
+void ChVehicle::update_solver_mode()
+{
+  int num_bodies = (int)m_system->Get_bodylist()->size();
+  if (num_bodies != m_checked_bodies) {
+    m_contact_free = true;
+    std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+    for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+      if ((*ibody)->GetCollide()) {
+        m_contact_free = false;
+        break;
+      }
+    }
+    m_checked_bodies = num_bodies;
+  }
+
+  bool use_direct = m_contact_free && m_system->GetNcontacts() == 0;
+  if (use_direct == m_direct_active)
+    return;
+
+  if (use_direct) {
+    ChSolverProfile direct;
+    ChSolverProfile::Get("direct", direct);
+    direct.Apply(m_system);
+  } else {
+    m_solver_profile.Apply(m_system);
+  }
+  m_direct_active = use_direct;
+}
+
+bool ChVehicle::SetSolverProfile(const std::string& name)
+{
+  ChSolverProfile profile;
+  if (!ChSolverProfile::Get(name, profile))
+    return false;
+
+  SetSolverProfile(profile);
+  return true;
 }
 
 
@@ -88,6 +357,11 @@ ChSharedPtr<ChBody> ChVehicle::GetWheelBody(const ChWheelID& wheel_id) const
   return m_suspensions[wheel_id.axle()]->GetSpindle(wheel_id.side());
 }
 
+ChBody* ChVehicle::GetWheelBodyPtr(const ChWheelID& wheel_id) const
+{
+  return m_suspensions[wheel_id.axle()]->GetSpindleBody(wheel_id.side());
+}
+
 const ChVector<>& ChVehicle::GetWheelPos(const ChWheelID& wheel_id) const
 {
   return m_suspensions[wheel_id.axle()]->GetSpindlePos(wheel_id.side());
@@ -121,7 +395,13 @@ double ChVehicle::GetWheelOmega(const ChWheelID& wheel_id) const
 ChWheelState ChVehicle::GetWheelState(const ChWheelID& wheel_id) const
 {
   ChWheelState state;
+  GetWheelState(wheel_id, state);
+
+  return state;
+}
 
+void ChVehicle::GetWheelState(const ChWheelID& wheel_id, ChWheelState& state) const
+{
   state.pos = GetWheelPos(wheel_id);
   state.rot = GetWheelRot(wheel_id);
   state.lin_vel = GetWheelLinVel(wheel_id);
@@ -129,8 +409,49 @@ ChWheelState ChVehicle::GetWheelState(const ChWheelID& wheel_id) const
 
   ChVector<> ang_vel_loc = state.rot.RotateBack(state.ang_vel);
   state.omega = ang_vel_loc.y;
+}
 
-  return state;
+void ChVehicle::GetWheelStates(ChWheelStates& states) const
+{
+  int num_wheels = 2 * GetNumberAxles();
+  states.resize(num_wheels);
+  if (num_wheels > 0)
+    GetWheelStates(&states[0], num_wheels);
+}
+
+void ChVehicle::GetWheelStates(ChWheelState* states, int num_wheels) const
+{
+  if (!m_wheel_bank.IsNull()) {
+    assert(num_wheels == m_wheel_bank->GetNumWheels());
+    m_wheel_bank->GetWheelStates(states);
+    return;
+  }
+
+  for (int i = 0; i < num_wheels; i++) {
+    const ChBody* spindle = m_suspensions[i / 2]->GetSpindleBody(ChVehicleSide(i % 2));
+    ChWheelState& state = states[i];
+
+    state.pos = spindle->GetPos();
+    state.rot = spindle->GetRot();
+    state.lin_vel = spindle->GetPos_dt();
+    state.ang_vel = spindle->GetWvel_par();
+    state.omega = state.rot.RotateBack(state.ang_vel).y;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Apply the tire forces of all wheels.
+// -----------------------------------------------------------------------------
+void ChVehicle::ApplyTireForces(const ChTireForce* tire_forces, int num_wheels)
+{
+  if (!m_wheel_bank.IsNull()) {
+    assert(num_wheels == m_wheel_bank->GetNumWheels());
+    m_wheel_bank->ApplyTireForces(tire_forces);
+    return;
+  }
+
+  for (int i = 0; i < num_wheels; i++)
+    m_suspensions[i / 2]->ApplyTireForce(ChVehicleSide(i % 2), tire_forces[i]);
 }
 
 // -----------------------------------------------------------------------------
@@ -173,4 +494,261 @@ void ChVehicle::LogConstraintViolations()
 }
 
 
+// -----------------------------------------------------------------------------
+// Save and restore the state of the bodies and shafts in the Chrono system.
+// The block holds the time, the numbers of bodies and shafts, followed by
+// (pos, rot, pos_dt, rot_dt, pos_dtdt, rot_dtdt) for each body and
+// (pos, pos_dt, pos_dtdt) for each shaft, in system order.
+// -----------------------------------------------------------------------------
+static const size_t BODY_STATE_SIZE = 21;
+static const size_t SHAFT_STATE_SIZE = 3;
+
+static int CountShafts(ChSystem* system)
+{
+  int num_shafts = 0;
+  std::vector<ChPhysicsItem*>::iterator iitem = system->Get_otherphysicslist()->begin();
+  for (; iitem != system->Get_otherphysicslist()->end(); ++iitem) {
+    if (dynamic_cast<ChShaft*>(*iitem))
+      num_shafts++;
+  }
+  return num_shafts;
+}
+
+void ChVehicle::SaveState(vehicle::ChVehicleState& state) const
+{
+  int num_bodies = (int)m_system->Get_bodylist()->size();
+  int num_shafts = CountShafts(m_system);
+
+  state.BeginBlock(3 + num_bodies * BODY_STATE_SIZE + num_shafts * SHAFT_STATE_SIZE);
+  state.Write(m_system->GetChTime());
+  state.Write(num_bodies);
+  state.Write(num_shafts);
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    state.Write((*ibody)->GetPos());
+    state.Write((*ibody)->GetRot());
+    state.Write((*ibody)->GetPos_dt());
+    state.Write((*ibody)->GetRot_dt());
+    state.Write((*ibody)->GetPos_dtdt());
+    state.Write((*ibody)->GetRot_dtdt());
+  }
+
+  std::vector<ChPhysicsItem*>::iterator iitem = m_system->Get_otherphysicslist()->begin();
+  for (; iitem != m_system->Get_otherphysicslist()->end(); ++iitem) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(*iitem)) {
+      state.Write(shaft->GetPos());
+      state.Write(shaft->GetPos_dt());
+      state.Write(shaft->GetPos_dtdt());
+    }
+  }
+
+  // Shafts of a partitioned driveline, not in the system.
+  if (!m_driveline.IsNull() && !m_driveline->GetShaftNetwork().IsNull())
+    m_driveline->GetShaftNetwork()->SaveState(state);
+}
+
+bool ChVehicle::RestoreState(vehicle::ChVehicleState& state)
+{
+  int num_bodies = (int)m_system->Get_bodylist()->size();
+  int num_shafts = CountShafts(m_system);
+
+  if (!state.OpenBlock(3 + num_bodies * BODY_STATE_SIZE + num_shafts * SHAFT_STATE_SIZE, "vehicle"))
+    return false;
+
+  double time = state.Read();
+  if ((int)state.Read() != num_bodies || (int)state.Read() != num_shafts) {
+    GetLog() << "ERROR: saved vehicle state does not match the system\n";
+    return false;
+  }
+
+  m_system->SetChTime(time);
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    (*ibody)->SetPos(state.ReadVector());
+    (*ibody)->SetRot(state.ReadQuaternion());
+    (*ibody)->SetPos_dt(state.ReadVector());
+    (*ibody)->SetRot_dt(state.ReadQuaternion());
+    (*ibody)->SetPos_dtdt(state.ReadVector());
+    (*ibody)->SetRot_dtdt(state.ReadQuaternion());
+    // Refresh the auxiliary frames and markers attached to the body.
+    (*ibody)->Update(time);
+  }
+
+  std::vector<ChPhysicsItem*>::iterator iitem = m_system->Get_otherphysicslist()->begin();
+  for (; iitem != m_system->Get_otherphysicslist()->end(); ++iitem) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(*iitem)) {
+      shaft->SetPos(state.Read());
+      shaft->SetPos_dt(state.Read());
+      shaft->SetPos_dtdt(state.Read());
+    }
+  }
+
+  if (!m_driveline.IsNull() && !m_driveline->GetShaftNetwork().IsNull())
+    return m_driveline->GetShaftNetwork()->RestoreState(state);
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Rigid motion of the whole vehicle, used to switch between vehicle models.
+// -----------------------------------------------------------------------------
+void ChVehicle::SetMotion(const ChCoordsys<>&        chassisPos,
+                          const ChVector<>&          lin_vel,
+                          const ChVector<>&          ang_vel,
+                          const std::vector<double>& wheel_omega)
+{
+  double time = m_system->GetChTime();
+
+  ChVector<> pos0 = GetChassisPos();
+  ChQuaternion<> drot = chassisPos.rot * GetChassisRot().GetConjugate();
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    if ((*ibody)->GetBodyFixed())
+      continue;
+    ChVector<> r = drot.Rotate((*ibody)->GetPos() - pos0);
+    ChQuaternion<> rot = drot * (*ibody)->GetRot();
+    rot.Normalize();
+    (*ibody)->SetPos(chassisPos.pos + r);
+    (*ibody)->SetRot(rot);
+    (*ibody)->SetPos_dt(lin_vel + Vcross(ang_vel, r));
+    (*ibody)->SetWvel_par(ang_vel);
+    (*ibody)->SetPos_dtdt(VNULL);
+    (*ibody)->SetRot_dtdt(QNULL);
+  }
+
+  // Add the spin of the wheels (about the spindle y axis) and set the speeds
+  // of the axle shafts.
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    for (int side = LEFT; side <= RIGHT; side++) {
+      double omega = wheel_omega[2 * i + side];
+      ChBody* spindle = m_suspensions[i]->GetSpindleBody(ChVehicleSide(side));
+      ChVector<> axis = spindle->GetRot().Rotate(VECT_Y);
+      spindle->SetWvel_par(ang_vel + axis * (omega - Vdot(ang_vel, axis)));
+      m_suspensions[i]->GetAxle(ChVehicleSide(side))->SetPos_dt(omega);
+    }
+  }
+
+  // Refresh the auxiliary frames and markers attached to the bodies.
+  for (ibody = m_system->Get_bodylist()->begin(); ibody != m_system->Get_bodylist()->end(); ++ibody)
+    (*ibody)->Update(time);
+}
+
+// -----------------------------------------------------------------------------
+// With the rotation R and the position r of a body relative to the chassis COM
+// after the rotation, the perturbed velocities are
+//    v' = R v + dvel + domega x r,   w' = R w + domega
+// -----------------------------------------------------------------------------
+void ChVehicle::Perturb(const ChVector<>& dpos,
+                        const ChVector<>& drot,
+                        const ChVector<>& dvel,
+                        const ChVector<>& domega)
+{
+  double time = m_system->GetChTime();
+
+  ChVector<> com = GetChassisPosCOM();
+  double angle = drot.Length();
+  ChQuaternion<> rot = (angle > 0) ? Q_from_AngAxis(angle, drot / angle) : QUNIT;
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    if ((*ibody)->GetBodyFixed())
+      continue;
+    ChVector<> r = rot.Rotate((*ibody)->GetPos() - com);
+    ChVector<> vel = rot.Rotate((*ibody)->GetPos_dt());
+    ChVector<> omega = rot.Rotate((*ibody)->GetWvel_par());
+    ChQuaternion<> brot = rot * (*ibody)->GetRot();
+    brot.Normalize();
+    (*ibody)->SetPos(com + dpos + r);
+    (*ibody)->SetRot(brot);
+    (*ibody)->SetPos_dt(vel + dvel + Vcross(domega, r));
+    (*ibody)->SetWvel_par(omega + domega);
+  }
+
+  for (ibody = m_system->Get_bodylist()->begin(); ibody != m_system->Get_bodylist()->end(); ++ibody)
+    (*ibody)->Update(time);
+}
+
+void ChVehicle::TransferState(const ChVehicle& source)
+{
+  m_system->SetChTime(source.m_system->GetChTime());
+
+  int num_wheels = 2 * source.GetNumberAxles();
+  std::vector<double> wheel_omega(num_wheels);
+  for (int i = 0; i < num_wheels; i++)
+    wheel_omega[i] = source.GetWheelOmega(i);
+
+  SetMotion(ChCoordsys<>(source.GetChassisPos(), source.GetChassisRot()),
+            source.m_chassis->GetFrame_REF_to_abs().GetPos_dt(),
+            source.m_chassis->GetWvel_par(),
+            wheel_omega);
+
+  GetDriveshaft()->SetPos_dt(source.GetDriveshaftSpeed());
+}
+
+
+// -----------------------------------------------------------------------------
+// Memory footprint of the items in the Chrono system.
+// -----------------------------------------------------------------------------
+static size_t LinkBytes(ChLink* link)
+{
+  if (dynamic_cast<ChLinkSpringCB*>(link))
+    return sizeof(ChLinkSpringCB);
+  if (dynamic_cast<ChLinkSpring*>(link))
+    return sizeof(ChLinkSpring);
+  if (dynamic_cast<ChLinkLock*>(link))
+    return sizeof(ChLinkLock);
+  if (dynamic_cast<ChLinkDistance*>(link))
+    return sizeof(ChLinkDistance);
+  return sizeof(ChLink);
+}
+
+void ChVehicle::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  if (m_ownsSystem)
+    report.Add("vehicle/systems", sizeof(ChSystem));
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    size_t bytes = dynamic_cast<ChBodyAuxRef*>(*ibody) ? sizeof(ChBodyAuxRef) : sizeof(ChBody);
+    report.Add("vehicle/bodies", bytes);
+
+    std::vector<ChSharedPtr<ChAsset> >& assets = (*ibody)->GetAssets();
+    if (!assets.empty())
+      report.Add("vehicle/asset handles", vehicle::ChMemoryReport::VectorBytes(assets), assets.size());
+  }
+
+  std::vector<ChLink*>::iterator ilink = m_system->Get_linklist()->begin();
+  for (; ilink != m_system->Get_linklist()->end(); ++ilink)
+    report.Add("vehicle/links", LinkBytes(*ilink));
+
+  std::vector<ChPhysicsItem*>::iterator iitem = m_system->Get_otherphysicslist()->begin();
+  for (; iitem != m_system->Get_otherphysicslist()->end(); ++iitem) {
+    if (dynamic_cast<ChShaft*>(*iitem))
+      report.Add("vehicle/shafts", sizeof(ChShaft));
+    else
+      report.Add("vehicle/other items", sizeof(ChPhysicsItem));
+  }
+
+  if (!m_brake_bank.IsNull())
+    m_brake_bank->AddMemoryFootprint(report);
+  if (!m_spring_bank.IsNull())
+    m_spring_bank->AddMemoryFootprint(report);
+  if (!m_wheel_bank.IsNull())
+    report.Add("vehicle/banks", sizeof(ChWheelBank));
+  if (!m_driveline.IsNull() && !m_driveline->GetShaftNetwork().IsNull())
+    m_driveline->GetShaftNetwork()->AddMemoryFootprint(report);
+}
+
+size_t ChVehicle::GetMemoryFootprint() const
+{
+  vehicle::ChMemoryReport report;
+  AddMemoryFootprint(report);
+  return report.GetTotal();
+}
+
+
 }  // end namespace chrono
@@ -35,9 +35,20 @@
 #include "subsys/ChSteering.h"
 #include "subsys/ChWheel.h"
 #include "subsys/ChBrake.h"
+#include "subsys/brake/ChBrakeBank.h"
+#include "subsys/wheel/ChWheelBank.h"
+#include "subsys/suspension/ChSpringForceBank.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChSolverProfile.h"
+#include "subsys/ChStepController.h"
+#include "subsys/ChMemoryReport.h"
 
 namespace chrono {
 
+namespace vehicle {
+class ChConstraintMonitor;
+}
+
 ///
 /// Base class for chrono vehicle systems.
 /// This class provides the interface between the vehicle system and other
@@ -62,15 +73,39 @@ public:
   /// Get a handle to the vehicle's chassis body.
   ChSharedPtr<ChBodyAuxRef> GetChassis() const { return m_chassis; }
 
+  /// Get a (non-owning) pointer to the vehicle's chassis body.
+  /// Unlike GetChassis(), this does not touch the reference count and is meant
+  /// for the per-step paths; the vehicle keeps the body alive.
+  ChBodyAuxRef* GetChassisBody() const { return m_chassis.get_ptr(); }
+
+  /// Get a handle to the suspension subsystem of the specified axle.
+  const ChSharedPtr<ChSuspension> GetSuspension(int axle) const { return m_suspensions[axle]; }
+
   /// Get a handle to the vehicle's steering subsystem.
   const ChSharedPtr<ChSteering> GetSteering() const { return m_steering; }
 
   /// Get a handle to the specified vehicle wheel.
   const ChSharedPtr<ChWheel> GetWheel(const ChWheelID& wheel_id) const { return m_wheels[wheel_id.id()]; }
 
+  /// Get a handle to the brake of the specified vehicle wheel.
+  const ChSharedPtr<ChBrake> GetBrake(const ChWheelID& wheel_id) const { return m_brakes[wheel_id.id()]; }
+
   /// Get a handle to the vehicle's driveline subsystem.
   const ChSharedPtr<ChDriveline> GetDriveline() const { return m_driveline; }
 
+  /// Get a handle to the vehicle's brake bank.
+  /// This is an empty handle if the vehicle has no batched brakes.
+  const ChSharedPtr<ChBrakeBank> GetBrakeBank() const { return m_brake_bank; }
+
+  /// Get a handle to the vehicle's wheel bank.
+  /// This is an empty handle if the vehicle does not batch its wheels.
+  const ChSharedPtr<ChWheelBank> GetWheelBank() const { return m_wheel_bank; }
+
+  /// Get a handle to the vehicle's spring force bank.
+  /// This is an empty handle if the vehicle has no tabulated spring or shock
+  /// elements.
+  const ChSharedPtr<ChSpringForceBank> GetSpringForceBank() const { return m_spring_bank; }
+
   /// Get a handle to the vehicle's driveshaft body.
   const ChSharedPtr<ChShaft> GetDriveshaft() const { return m_driveline->GetDriveshaft(); }
 
@@ -104,6 +139,11 @@ public:
   /// Get a handle to the specified wheel body.
   ChSharedPtr<ChBody> GetWheelBody(const ChWheelID& wheelID) const;
 
+  /// Get a (non-owning) pointer to the specified wheel body.
+  /// Unlike GetWheelBody(), this does not touch the reference count and is
+  /// meant for the per-step paths.
+  ChBody* GetWheelBodyPtr(const ChWheelID& wheel_id) const;
+
   /// Get the global location of the specified wheel.
   const ChVector<>& GetWheelPos(const ChWheelID& wheel_id) const;
 
@@ -132,6 +172,35 @@ public:
   /// speed about its rotation axis.
   ChWheelState GetWheelState(const ChWheelID& wheel_id) const;
 
+  /// Get the complete state for the specified wheel, in place.
+  void GetWheelState(
+    const ChWheelID& wheel_id,   ///< [in] wheel ID
+    ChWheelState&    state       ///< [out] wheel state
+    ) const;
+
+  /// Get the complete states of all wheels, in wheel ID order.
+  /// If the vehicle has a wheel bank, the states are collected in a single
+  /// pass over its contiguous arrays.
+  void GetWheelStates(
+    ChWheelStates& states        ///< [out] wheel states, one per wheel
+    ) const;
+
+  /// Get the complete states of all wheels, in wheel ID order, directly into
+  /// the specified buffer (e.g. the wheel state inputs of a batch of tires).
+  /// The states are collected in a single pass over the spindle bodies.
+  void GetWheelStates(
+    ChWheelState* states,        ///< [out] buffer of wheel states
+    int           num_wheels     ///< [in] number of wheels (2 per axle)
+    ) const;
+
+  /// Apply the tire forces in the specified buffer, in wheel ID order, to the
+  /// spindle bodies, in a single pass (see ChSuspension::ApplyTireForce()).
+  /// Intended for the Update() of derived vehicles.
+  void ApplyTireForces(
+    const ChTireForce* tire_forces,  ///< [in] buffer of tire forces
+    int                num_wheels    ///< [in] number of wheels (2 per axle)
+    );
+
   /// Get the angular speed of the driveshaft.
   /// This function provides the interface between a vehicle system and a
   /// powertrain system.
@@ -144,6 +213,32 @@ public:
   /// Get the global location of the driver.
   ChVector<> GetDriverPos() const;
 
+  /// Collision families of the chassis and wheel bodies (see
+  /// SetCollisionPairs()). RigidTerrain::HEIGHTFIELD_FAMILY is 15; all other
+  /// bodies, e.g. the terrain and its obstacles, are in the default family 0.
+  static const int CHASSIS_FAMILY = 13;
+  static const int WHEEL_FAMILY = 14;
+
+  /// Enable or disable the collision pairs between vehicle bodies (default:
+  /// both disabled). The chassis and wheels always collide with the terrain
+  /// and the obstacles. Collision families do not distinguish the bodies of
+  /// different vehicles, so 'wheel_pairs' enables the wheel-wheel and
+  /// wheel-chassis pairs both within a vehicle and between vehicles, while
+  /// 'chassis_pairs' enables the chassis-chassis pairs (i.e. between
+  /// vehicles). The families are assigned at the end of Initialize(); a call
+  /// after Initialize() applies the change immediately.
+  void SetCollisionPairs(bool wheel_pairs, bool chassis_pairs);
+
+  /// Place the specified body in the specified collision family (see
+  /// CHASSIS_FAMILY and WHEEL_FAMILY) and set its family mask according to
+  /// the enabled collision pairs between vehicle bodies.
+  static void SetCollisionFamily(
+    ChBody* body,            ///< [in] chassis or wheel body
+    int     family,          ///< [in] CHASSIS_FAMILY or WHEEL_FAMILY
+    bool    wheel_pairs,     ///< [in] enable wheel-wheel and wheel-chassis pairs
+    bool    chassis_pairs    ///< [in] enable chassis-chassis pairs
+    );
+
   /// Initialize this vehicle at the specified global location and orientation.
   virtual void Initialize(
     const ChCoordsys<>& chassisPos  ///< [in] initial global position and orientation
@@ -165,15 +260,152 @@ public:
   /// Advance the state of this vehicle by the specified time step.
   virtual void Advance(double step);
 
+  /// Re-evaluate the tire forces at each integration step of the next call to
+  /// Advance(), from their linearization (see ChTire::GetForceJacobian()) about
+  /// the specified wheel states, with the current wheel kinematics, instead of
+  /// holding the forces applied by Update() over the whole step. This reduces
+  /// the coupling error of a vehicle step spanning several integration steps.
+  /// The forces are re-applied as by ApplyTireForces(); a zero Jacobian holds
+  /// the force of that wheel.
+  void SetTireForceLinearization(
+    const ChTireForces&         tire_forces,   ///< [in] tire forces at the reference wheel states
+    const ChWheelStates&        wheel_states,  ///< [in] reference wheel states
+    const ChTireForceJacobians& jacobians      ///< [in] tire force linearizations
+    );
+
   /// Set the integration step size for the vehicle system.
   void SetStepsize(double val) { m_stepsize = val; }
 
   /// Get the current value of the integration step size for the vehicle system.
   double GetStepsize() const { return m_stepsize; }
 
-  /// Log current constraint violations.
+  /// Enable or disable the adaptive selection of the integration step by the
+  /// step controller (see GetStepController()). When enabled, the controller
+  /// is reset to the current step size (see SetStepsize()), which is then used
+  /// as the initial step.
+  void SetAdaptiveStep(bool enable);
+
+  /// Return true if the integration step is selected adaptively.
+  bool IsAdaptiveStep() const { return m_adaptive_step; }
+
+  /// Get the step controller, e.g. to set its parameters or to read its step
+  /// size histogram.
+  ChStepController& GetStepController() { return m_step_control; }
+  const ChStepController& GetStepController() const { return m_step_control; }
+
+  /// Get the largest violation of the bilateral constraints in the system.
+  double GetConstraintViolation() const;
+
+  /// Attach the specified constraint monitor (see ChConstraintMonitor), which
+  /// groups the joints of this (initialized) vehicle by subsystem and is then
+  /// updated after each integration step. With the adaptive step, the monitor
+  /// also provides the violation to the step controller, and its step
+  /// reduction requests are events of the controller. The monitor is not owned
+  /// and must outlive the vehicle; NULL detaches it.
+  void SetConstraintMonitor(vehicle::ChConstraintMonitor* monitor);
+
+  /// Apply the specified solver settings to the Chrono system, and start
+  /// recording the solver statistics (see GetSolverStats()).
+  /// A vehicle constructed with a default ChSystem uses the "batch" profile.
+  void SetSolverProfile(const ChSolverProfile& profile);
+
+  /// Apply the predefined solver profile with the specified name ("realtime",
+  /// "batch" or "accurate").
+  /// Returns false if there is no profile with the specified name.
+  bool SetSolverProfile(const std::string& name);
+
+  /// Get the solver settings last applied to the Chrono system.
+  const ChSolverProfile& GetSolverProfile() const { return m_solver_profile; }
+
+  /// Get the iterations used and the residual of the LCP speed solver, for
+  /// the last step and over all steps since the profile was applied (or since
+  /// the last call to ResetSolverStats()).
+  const ChSolverStats& GetSolverStats() const { return m_solver_stats; }
+
+  /// Reset the solver statistics.
+  void ResetSolverStats() { m_solver_stats.Reset(); }
+
+  /// Enable or disable warm starting of the LCP solvers from the multipliers
+  /// of the previous step (enabled in the predefined solver profiles). The
+  /// achieved reduction in iterations is reported by the solver statistics
+  /// (see ChSolverStats::GetWarmStartReduction()).
+  void SetWarmStart(bool enable);
+
+  /// Return true if the LCP solvers are warm started.
+  bool IsWarmStart() const { return m_solver_profile.warm_start; }
+
+  /// Enable or disable the use of the direct (simplex) LCP solver while the
+  /// system is free of contacts, i.e. has no collision bodies (e.g. with
+  /// Pacejka or LuGre tires on a terrain that is not a collision body) and had
+  /// no contacts at the previous step. The joints are then enforced exactly;
+  /// otherwise, the current solver profile is used. The check of collision
+  /// bodies is only repeated when bodies are added or removed.
+  void EnableDirectSolver(bool enable);
+
+  /// Return true if the direct solver is used for the next step.
+  bool IsDirectSolverActive() const { return m_direct_active; }
+
+  /// Log current constraint violations, joint by joint. For a per-step check,
+  /// use a constraint monitor (see SetConstraintMonitor()).
   void LogConstraintViolations();
 
+  /// Append the current state of the vehicle to the specified snapshot.
+  /// This includes the simulation time and the positions, velocities and
+  /// accelerations of all bodies and shafts in the Chrono system, i.e. the
+  /// chassis, suspension, steering and driveline subsystems, as well as the
+  /// shafts of a powertrain attached to the same system. Constraint reactions
+  /// and contacts are not saved; they are recomputed at the next step.
+  void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the vehicle state from the next block of the specified snapshot.
+  /// Returns false if the snapshot was saved from a system with a different
+  /// number of bodies or shafts.
+  bool RestoreState(vehicle::ChVehicleState& state);
+
+  /// Move the vehicle rigidly so that the chassis reference frame is at the
+  /// specified global position and orientation, and set the velocities of all
+  /// (non-fixed) bodies to the rigid-body motion of the chassis, with the
+  /// wheels spinning at the specified angular speeds about their axles. The
+  /// relative configuration of the subsystems (e.g. suspension deflections) is
+  /// preserved; accelerations are reset.
+  void SetMotion(
+    const ChCoordsys<>&        chassisPos,    ///< [in] global position and orientation of the chassis reference frame
+    const ChVector<>&          lin_vel,       ///< [in] global velocity of the chassis reference frame origin
+    const ChVector<>&          ang_vel,       ///< [in] global angular velocity of the chassis
+    const std::vector<double>& wheel_omega    ///< [in] wheel angular speeds, in wheel ID order
+    );
+
+  /// Superpose a small rigid-body motion on the current state of the vehicle:
+  /// all (non-fixed) bodies are translated and rotated about the chassis COM,
+  /// and the velocity field of a rigid-body motion is added to their
+  /// velocities, which are rotated with them. Unlike SetMotion(), the relative
+  /// motion of the subsystems (e.g. suspension travel rates, wheel spin) is
+  /// preserved. Used e.g. by ChLinearizer.
+  void Perturb(
+    const ChVector<>& dpos,     ///< [in] global translation of the bodies
+    const ChVector<>& drot,     ///< [in] global rotation vector (axis times angle), about the chassis COM
+    const ChVector<>& dvel,     ///< [in] velocity added at the chassis COM
+    const ChVector<>& domega    ///< [in] angular velocity added to all bodies
+    );
+
+  /// Set the state of this vehicle from that of another vehicle with the same
+  /// number of axles, e.g. a model of the same vehicle with a different
+  /// fidelity. The simulation time, the chassis position and velocity, the
+  /// wheel angular speeds and the driveshaft speed of the source vehicle are
+  /// transferred (see SetMotion()).
+  void TransferState(const ChVehicle& source);
+
+  /// Add the memory footprint of the vehicle to the specified report: the
+  /// bodies, joints, force elements and shafts of the Chrono system (i.e. also
+  /// those of a powertrain attached to it), their visualization assets and the
+  /// batched banks. Joints and force elements are counted by the size of their
+  /// class for the common Chrono links, and of ChLink otherwise. Meshes are
+  /// reported by ChMeshCache::AddMemoryFootprint().
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Return the estimated memory footprint of the vehicle, in bytes.
+  size_t GetMemoryFootprint() const;
+
 protected:
 
   ChSystem*                  m_system;       ///< pointer to the Chrono system
@@ -185,8 +417,47 @@ protected:
   ChSharedPtr<ChSteering>    m_steering;     ///< handle to the steering subsystem
   ChWheelList                m_wheels;       ///< list of handles to wheel subsystems
   ChBrakeList                m_brakes;       ///< list of handles to brake subsystems
+  ChSharedPtr<ChBrakeBank>   m_brake_bank;   ///< batched brakes (empty if there are none)
+  ChSharedPtr<ChWheelBank>   m_wheel_bank;   ///< batched wheel states and tire forces (empty if not used)
+  ChSharedPtr<ChSpringForceBank> m_spring_bank; ///< batched tabulated spring and shock elements (empty if there are none)
 
   double                     m_stepsize;   ///< integration step-size for the vehicle system
+
+  ChSolverProfile            m_solver_profile;  ///< solver settings applied to the system
+  bool                       m_record_solver;   ///< true if a solver profile was applied
+  ChSolverStats              m_solver_stats;    ///< per-step solver statistics
+  bool                       m_direct_solver;   ///< use the direct solver if contact free
+  bool                       m_direct_active;   ///< the direct solver is applied to the system
+  bool                       m_contact_free;    ///< no collision bodies in the system
+  int                        m_checked_bodies;  ///< number of bodies at the last collision check
+
+  bool                       m_adaptive_step;   ///< integration step selected by the step controller
+  ChStepController           m_step_control;    ///< adaptive integration step controller
+
+  vehicle::ChConstraintMonitor* m_constraint_monitor; ///< per-step constraint monitor (not owned)
+
+  bool                       m_tire_linearized; ///< tire forces re-evaluated during the next Advance()
+  ChTireForces               m_lin_forces;      ///< tire forces at the reference wheel states
+  ChWheelStates              m_lin_states;      ///< reference wheel states
+  ChTireForceJacobians       m_lin_jacobians;   ///< tire force linearizations
+
+  bool                       m_wheel_pairs;     ///< wheel-wheel and wheel-chassis pairs enabled
+  bool                       m_chassis_pairs;   ///< chassis-chassis pairs enabled
+
+  /// Assign the collision families of the chassis and wheel (spindle) bodies.
+  /// Called by derived classes at the end of Initialize().
+  void InitializeCollisionFamilies();
+
+private:
+
+  // select the direct solver or the solver profile for the next step
+  void update_solver_mode();
+
+  // apply the linearized tire forces for the current wheel states
+  void apply_linearized_tire_forces();
+
+  // pass the outcome of the last integration step to the step controller
+  void update_step_control(double h);
 };
 
 
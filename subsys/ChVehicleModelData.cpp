@@ -16,7 +16,8 @@
 //
 // =============================================================================
 
-#include "subsys/ChVehicleModelData.h" 
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChSimulationContext.h"
 
 
 namespace chrono {
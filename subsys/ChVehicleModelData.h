@@ -14,6 +14,9 @@
 //
 // Global functions for accessing the ChronoVehicle model data.
 //
+// The path set in the simulation context current on the calling thread (see
+// ChSimulationContext), if any, takes precedence over the process-wide path.
+//
 // =============================================================================
 
 #ifndef CH_VEHICLE_MODELDATA_H
@@ -32,7 +35,8 @@ namespace vehicle {
 /// Set the path to the ChronoVehicle model data directory (ATTENTION: not thread safe)
 CH_SUBSYS_API void SetDataPath(const std::string& path);
 
-/// Obtain the current path to the ChronoVehicle model data directory (thread safe)
+/// Obtain the current path to the ChronoVehicle model data directory, from the
+/// current simulation context if it sets one (thread safe)
 CH_SUBSYS_API const std::string& GetDataPath();
 
 /// Obtain the complete path to the specified filename, given relative to the
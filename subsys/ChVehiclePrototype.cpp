@@ -0,0 +1,172 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Prototype state of a vehicle, used to spawn identical vehicles.
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+#include "physics/ChShaft.h"
+
+#include "subsys/ChVehiclePrototype.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Each body record holds the position and velocities in the chassis frame and
+// the orientation and its derivatives premultiplied by the conjugate of the
+// chassis orientation. A rigid rotation q of the vehicle maps the derivatives
+// of a body orientation to q * rot_dt and q * rot_dtdt.
+// -----------------------------------------------------------------------------
+static const size_t BODY_SIZE = 21;
+
+static void WriteVector(double*& p, const ChVector<>& v)
+{
+  *p++ = v.x; *p++ = v.y; *p++ = v.z;
+}
+
+static void WriteQuaternion(double*& p, const ChQuaternion<>& q)
+{
+  *p++ = q.e0; *p++ = q.e1; *p++ = q.e2; *p++ = q.e3;
+}
+
+static ChVector<> ReadVector(const double*& p)
+{
+  ChVector<> v(p[0], p[1], p[2]);
+  p += 3;
+  return v;
+}
+
+static ChQuaternion<> ReadQuaternion(const double*& p)
+{
+  ChQuaternion<> q(p[0], p[1], p[2], p[3]);
+  p += 4;
+  return q;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehiclePrototype::Capture(ChVehicle& prototype)
+{
+  ChSystem* system = prototype.GetSystem();
+  ChCoordsys<> ref(prototype.GetChassisPos(), prototype.GetChassisRot());
+  ChQuaternion<> ref_conj = ref.rot.GetConjugate();
+
+  m_num_bodies = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody) {
+    if (!(*ibody)->GetBodyFixed())
+      m_num_bodies++;
+  }
+
+  m_bodies.resize(m_num_bodies * BODY_SIZE);
+  double* p = m_num_bodies ? &m_bodies[0] : 0;
+
+  for (ibody = system->Get_bodylist()->begin(); ibody != system->Get_bodylist()->end(); ++ibody) {
+    ChBody* body = *ibody;
+    if (body->GetBodyFixed())
+      continue;
+    WriteVector(p, ref.TransformParentToLocal(body->GetPos()));
+    WriteQuaternion(p, ref_conj * body->GetRot());
+    WriteVector(p, ref.rot.RotateBack(body->GetPos_dt()));
+    WriteQuaternion(p, ref_conj * body->GetRot_dt());
+    WriteVector(p, ref.rot.RotateBack(body->GetPos_dtdt()));
+    WriteQuaternion(p, ref_conj * body->GetRot_dtdt());
+  }
+
+  m_shafts.clear();
+  std::vector<ChPhysicsItem*>::iterator iitem = system->Get_otherphysicslist()->begin();
+  for (; iitem != system->Get_otherphysicslist()->end(); ++iitem) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(*iitem)) {
+      m_shafts.push_back(shaft->GetPos());
+      m_shafts.push_back(shaft->GetPos_dt());
+      m_shafts.push_back(shaft->GetPos_dtdt());
+    }
+  }
+  m_num_shafts = (int)m_shafts.size() / 3;
+}
+
+// -----------------------------------------------------------------------------
+// The counts are checked before any body is moved, so a mismatched vehicle is
+// left unchanged.
+// -----------------------------------------------------------------------------
+bool ChVehiclePrototype::Place(ChVehicle& vehicle, const ChCoordsys<>& chassisPos) const
+{
+  ChSystem* system = vehicle.GetSystem();
+  double time = system->GetChTime();
+
+  int num_bodies = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody) {
+    if (!(*ibody)->GetBodyFixed())
+      num_bodies++;
+  }
+
+  std::vector<ChShaft*> shafts;
+  std::vector<ChPhysicsItem*>::iterator iitem = system->Get_otherphysicslist()->begin();
+  for (; iitem != system->Get_otherphysicslist()->end(); ++iitem) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(*iitem))
+      shafts.push_back(shaft);
+  }
+
+  if (num_bodies != m_num_bodies || (int)shafts.size() != m_num_shafts) {
+    GetLog() << "ERROR: vehicle does not match the prototype ("
+             << num_bodies << " bodies and " << (int)shafts.size() << " shafts, expected "
+             << m_num_bodies << " and " << m_num_shafts << ")\n";
+    return false;
+  }
+
+  const double* p = m_num_bodies ? &m_bodies[0] : 0;
+
+  for (ibody = system->Get_bodylist()->begin(); ibody != system->Get_bodylist()->end(); ++ibody) {
+    ChBody* body = *ibody;
+    if (body->GetBodyFixed())
+      continue;
+
+    ChVector<> pos = ReadVector(p);
+    ChQuaternion<> rot = ReadQuaternion(p);
+    ChVector<> pos_dt = ReadVector(p);
+    ChQuaternion<> rot_dt = ReadQuaternion(p);
+    ChVector<> pos_dtdt = ReadVector(p);
+    ChQuaternion<> rot_dtdt = ReadQuaternion(p);
+
+    rot = chassisPos.rot * rot;
+    rot.Normalize();
+
+    body->SetPos(chassisPos.TransformLocalToParent(pos));
+    body->SetRot(rot);
+    body->SetPos_dt(chassisPos.rot.Rotate(pos_dt));
+    body->SetRot_dt(chassisPos.rot * rot_dt);
+    body->SetPos_dtdt(chassisPos.rot.Rotate(pos_dtdt));
+    body->SetRot_dtdt(chassisPos.rot * rot_dtdt);
+
+    // Refresh the auxiliary frames and markers attached to the body.
+    body->Update(time);
+  }
+
+  for (size_t i = 0; i < shafts.size(); i++) {
+    shafts[i]->SetPos(m_shafts[3 * i]);
+    shafts[i]->SetPos_dt(m_shafts[3 * i + 1]);
+    shafts[i]->SetPos_dtdt(m_shafts[3 * i + 2]);
+  }
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,89 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Prototype state of a vehicle, used to spawn identical vehicles at different
+// locations without repeating their initialization and settling.
+//
+// The state of an initialized (and typically settled, i.e. simulated to static
+// equilibrium) prototype vehicle is captured relative to its chassis reference
+// frame: the positions, velocities and accelerations of all non-fixed bodies
+// and all shafts of its system, in system order, in one flat array. A vehicle
+// constructed identically (e.g. from the same JSON specification files, which
+// are parsed only once, see ChJsonCache) and initialized anywhere is then
+// placed at any chassis position with one pass over this array, all bodies
+// moved rigidly with the chassis frame.
+//
+// The prototype and each instance must have their own Chrono system (as in
+// ChFleetSimulation), such that the non-fixed bodies and the shafts of the
+// system are those of the vehicle and its powertrain; fixed bodies (e.g. a
+// terrain ground) are not moved.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_PROTOTYPE_H
+#define CH_VEHICLE_PROTOTYPE_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Captured state of a prototype vehicle, relative to its chassis frame.
+///
+class CH_SUBSYS_API ChVehiclePrototype
+{
+public:
+
+  ChVehiclePrototype() : m_num_bodies(0), m_num_shafts(0) {}
+
+  /// Capture the current state of the specified vehicle.
+  void Capture(ChVehicle& prototype);
+
+  /// Return true if no state was captured.
+  bool IsEmpty() const { return m_num_bodies == 0; }
+
+  /// Get the number of captured (non-fixed) bodies and shafts.
+  int GetNumBodies() const { return m_num_bodies; }
+  int GetNumShafts() const { return m_num_shafts; }
+
+  /// Set the state of the specified vehicle to the captured state, with the
+  /// chassis reference frame at the specified global position and
+  /// orientation (velocities and accelerations are rotated accordingly). The
+  /// simulation time of the vehicle system is not changed.
+  /// Returns false if the vehicle system has a different number of non-fixed
+  /// bodies or shafts.
+  bool Place(
+    ChVehicle&           vehicle,      ///< [in] vehicle constructed as the prototype
+    const ChCoordsys<>&  chassisPos    ///< [in] global position and orientation of the chassis reference frame
+    ) const;
+
+private:
+
+  int                  m_num_bodies;
+  int                  m_num_shafts;
+  std::vector<double>  m_bodies;   // relative body states (pos, rot, pos_dt, rot_dt, pos_dtdt, rot_dtdt)
+  std::vector<double>  m_shafts;   // shaft states (pos, pos_dt, pos_dtdt)
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,341 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Emulation of the onboard sensors of a vehicle, sampled at fixed rates.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChLog.h"
+#include "core/ChMathematics.h"
+#include "physics/ChSystem.h"
+
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChVehicleSensors.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+namespace vehicle {
+
+
+// Tolerance on the sample times, relative to the sampling period, so that a
+// step ending at a sample time up to round-off takes that sample.
+static const double TIME_TOLERANCE = 1e-9;
+
+// -----------------------------------------------------------------------------
+// The noise is drawn from a generator of its own (SplitMix64) rather than
+// ChRandom(), whose global state is shared by all simulations of the process
+// (and threads of a fleet).
+// -----------------------------------------------------------------------------
+static unsigned long long SplitMix(unsigned long long& state)
+{
+  unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double Uniform(unsigned long long& state)
+{
+  return (SplitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double ChVehicleSensors::Gaussian()
+{
+  if (m_has_spare) {
+    m_has_spare = false;
+    return m_spare;
+  }
+
+  // Box-Muller transform (1 - u is in (0, 1]).
+  double r = std::sqrt(-2 * std::log(1 - Uniform(m_state)));
+  double phi = 2 * CH_C_PI * Uniform(m_state);
+  m_spare = r * std::sin(phi);
+  m_has_spare = true;
+  return r * std::cos(phi);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleSensors::ChVehicleSensors(unsigned int seed)
+: m_started(false),
+  m_state(seed),
+  m_spare(0),
+  m_has_spare(false)
+{
+}
+
+// Set the values of the specified member (one number for all channels, or an
+// array of one number per channel).
+static bool get_channels(const Value& spec, const char* name, int num_channels, double* values)
+{
+  if (!spec.HasMember(name))
+    return true;
+  const Value& v = spec[name];
+  if (v.IsNumber()) {
+    for (int i = 0; i < num_channels; i++)
+      values[i] = v.GetDouble();
+    return true;
+  }
+  if (!v.IsArray() || (int)v.Size() != num_channels)
+    return false;
+  for (SizeType i = 0; i < v.Size(); i++)
+    values[i] = v[i].GetDouble();
+  return true;
+}
+
+static double get_double(const Value& spec, const char* name, double def)
+{
+  return (spec.HasMember(name) && spec[name].IsNumber()) ? spec[name].GetDouble() : def;
+}
+
+ChVehicleSensors::ChVehicleSensors(const std::string& filename)
+: m_started(false),
+  m_state(1),
+  m_spare(0),
+  m_has_spare(false)
+{
+  const Document& d = ChJsonCache::Get(filename);
+
+  if (!d.IsObject()) {
+    GetLog() << "ERROR: cannot read sensor file " << filename.c_str() << "\n";
+    return;
+  }
+
+  if (d.HasMember("Seed"))
+    m_state = d["Seed"].GetUint();
+
+  if (!d.HasMember("Sensors") || !d["Sensors"].IsArray())
+    return;
+
+  const Value& sensors = d["Sensors"];
+  for (SizeType j = 0; j < sensors.Size(); j++) {
+    const Value& spec = sensors[j];
+    std::string type = (spec.HasMember("Type") && spec["Type"].IsString()) ? spec["Type"].GetString() : "";
+
+    int index = -1;
+    double rate = get_double(spec, "Rate", 0);
+    double latency = get_double(spec, "Latency", 0);
+    int buffer_size = (int)get_double(spec, "Buffer Size", 16);
+    if (type == "IMU")
+      index = AddSensor(IMU, rate, latency, 0, 0, buffer_size);
+    else if (type == "GPS")
+      index = AddSensor(GPS, rate, latency, 0, 0, buffer_size);
+    else if (type == "Wheel Speed")
+      index = AddSensor(WHEEL_SPEED, rate, latency, 0, 0, buffer_size, (int)get_double(spec, "Number Axles", 2));
+
+    if (index < 0) {
+      GetLog() << "ERROR: invalid sensor " << (int)j << " in " << filename.c_str() << "\n";
+      continue;
+    }
+
+    Sensor& sensor = m_sensors[index];
+    if (!get_channels(spec, "Noise", sensor.num_channels, sensor.noise) ||
+        !get_channels(spec, "Bias", sensor.num_channels, sensor.bias))
+      GetLog() << "ERROR: invalid noise of sensor " << (int)j << " in " << filename.c_str() << "\n";
+    sensor.resolution = get_double(spec, "Resolution", 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChVehicleSensors::AddSensor(Type   type,
+                                double rate,
+                                double latency,
+                                double noise,
+                                double bias,
+                                int    buffer_size,
+                                int    num_axles)
+{
+  int num_channels = (type == WHEEL_SPEED) ? 2 * num_axles : 6;
+  if (rate <= 0 || latency < 0 || num_channels <= 0 || num_channels > MAX_CHANNELS)
+    return -1;
+
+  Sensor sensor;
+  sensor.type = type;
+  sensor.num_channels = num_channels;
+  sensor.period = 1 / rate;
+  sensor.latency = latency;
+  sensor.resolution = 0;
+  for (int i = 0; i < MAX_CHANNELS; i++) {
+    sensor.noise[i] = noise;
+    sensor.bias[i] = bias;
+  }
+  sensor.start_time = 0;
+  sensor.next_sample = 0;
+  sensor.num_samples = 0;
+  sensor.head = 0;
+
+  // The samples taken during the latency are not available yet: keep them,
+  // and the latest available one.
+  int in_flight = (int)std::ceil(latency * rate - TIME_TOLERANCE);
+  sensor.capacity = std::max(buffer_size, in_flight + 2);
+  sensor.buffer.assign(sensor.capacity * (1 + num_channels), 0.0);
+
+  m_sensors.push_back(sensor);
+  m_started = false;
+
+  return (int)m_sensors.size() - 1;
+}
+
+void ChVehicleSensors::SetNoise(int sensor, int channel, double noise, double bias)
+{
+  m_sensors[sensor].noise[channel] = noise;
+  m_sensors[sensor].bias[channel] = bias;
+}
+
+void ChVehicleSensors::SetResolution(int sensor, double resolution)
+{
+  m_sensors[sensor].resolution = resolution;
+}
+
+void ChVehicleSensors::Reset(double time)
+{
+  for (size_t k = 0; k < m_sensors.size(); k++) {
+    m_sensors[k].start_time = time;
+    m_sensors[k].next_sample = 0;
+    m_sensors[k].num_samples = 0;
+    m_sensors[k].head = 0;
+  }
+  m_started = true;
+}
+
+// -----------------------------------------------------------------------------
+// Sampling.
+// -----------------------------------------------------------------------------
+void ChVehicleSensors::Measure(Type type, int num_channels, const ChVehicle& vehicle, double* values)
+{
+  switch (type) {
+  case IMU: {
+    ChBodyAuxRef* chassis = vehicle.GetChassisBody();
+    ChVector<> force = chassis->GetRot().RotateBack(chassis->GetPos_dtdt() - chassis->GetSystem()->Get_G_acc());
+    ChVector<> omega = chassis->GetWvel_loc();
+    values[0] = force.x;
+    values[1] = force.y;
+    values[2] = force.z;
+    values[3] = omega.x;
+    values[4] = omega.y;
+    values[5] = omega.z;
+    break;
+  }
+  case GPS: {
+    const ChFrameMoving<>& frame = vehicle.GetChassisBody()->GetFrame_REF_to_abs();
+    const ChVector<>& pos = frame.GetPos();
+    const ChVector<>& vel = frame.GetPos_dt();
+    values[0] = pos.x;
+    values[1] = pos.y;
+    values[2] = pos.z;
+    values[3] = vel.x;
+    values[4] = vel.y;
+    values[5] = vel.z;
+    break;
+  }
+  case WHEEL_SPEED:
+    for (int i = 0; i < num_channels; i++)
+      values[i] = vehicle.GetWheelOmega(ChWheelID(i));
+    break;
+  }
+}
+
+void ChVehicleSensors::Update(double time, const ChVehicle& vehicle)
+{
+  if (!m_started)
+    Reset(time);
+
+  for (size_t k = 0; k < m_sensors.size(); k++) {
+    Sensor& sensor = m_sensors[k];
+    double tol = TIME_TOLERANCE * sensor.period;
+    if (time < sensor.start_time + sensor.next_sample * sensor.period - tol)
+      continue;
+
+    double* rec = &sensor.buffer[sensor.head * (1 + sensor.num_channels)];
+    rec[0] = time;
+    Measure(sensor.type, sensor.num_channels, vehicle, rec + 1);
+    for (int i = 0; i < sensor.num_channels; i++) {
+      double v = rec[1 + i] + sensor.bias[i];
+      if (sensor.noise[i] > 0)
+        v += sensor.noise[i] * Gaussian();
+      if (sensor.resolution > 0)
+        v = sensor.resolution * std::floor(v / sensor.resolution + 0.5);
+      rec[1 + i] = v;
+    }
+
+    sensor.head = (sensor.head + 1) % sensor.capacity;
+    sensor.num_samples++;
+
+    // Skip the sample times missed with steps larger than the period.
+    do {
+      sensor.next_sample++;
+    } while (sensor.start_time + sensor.next_sample * sensor.period <= time + tol);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Buffer access.
+// -----------------------------------------------------------------------------
+int ChVehicleSensors::record(const Sensor& sensor, int k)
+{
+  return (sensor.head - 1 - k + 2 * sensor.capacity) % sensor.capacity;
+}
+
+bool ChVehicleSensors::GetLatest(int sensor, double time, double& sample_time, double* values) const
+{
+  const Sensor& s = m_sensors[sensor];
+  int n = std::min(s.num_samples, s.capacity);
+  double tol = TIME_TOLERANCE * s.period;
+
+  for (int k = 0; k < n; k++) {
+    const double* rec = &s.buffer[record(s, k) * (1 + s.num_channels)];
+    if (rec[0] + s.latency <= time + tol) {
+      sample_time = rec[0];
+      for (int i = 0; i < s.num_channels; i++)
+        values[i] = rec[1 + i];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int ChVehicleSensors::GetSamples(int sensor, double after, double time, double* records) const
+{
+  const Sensor& s = m_sensors[sensor];
+  int n = std::min(s.num_samples, s.capacity);
+  int width = 1 + s.num_channels;
+  double tol = TIME_TOLERANCE * s.period;
+
+  // Range [first, last) of the available samples taken after the specified
+  // time, counted back from the latest one.
+  int last = 0;
+  while (last < n && s.buffer[record(s, last) * width] + s.latency > time + tol)
+    last++;
+  int first = last;
+  while (first < n && s.buffer[record(s, first) * width] > after)
+    first++;
+
+  for (int k = first - 1; k >= last; k--) {
+    const double* rec = &s.buffer[record(s, k) * width];
+    std::copy(rec, rec + width, records);
+    records += width;
+  }
+
+  return first - last;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
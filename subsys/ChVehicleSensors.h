@@ -0,0 +1,192 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Emulation of the onboard sensors of a vehicle (IMU, GPS, wheel speeds),
+// sampled at fixed rates.
+//
+// Each sensor takes a sample when the simulation time reaches its next sample
+// time (the samples are taken on the physics steps, so the sampling period is
+// rounded to a multiple of the step size), with:
+//   - a constant bias and white Gaussian noise per channel;
+//   - an optional quantization of the measured values;
+//   - a latency: a sample taken at time t is available from time t + latency.
+// The channels of the sensors are:
+//   IMU          specific force (acceleration minus gravity) and angular
+//                velocity of the chassis, in the chassis frame (6 channels)
+//   GPS          position and velocity of the chassis reference frame, in the
+//                absolute frame (6 channels)
+//   WHEEL_SPEED  angular speed of each wheel, in wheel ID order (2 channels
+//                per axle)
+//
+// The samples are written into a ring buffer per sensor, allocated when the
+// sensor is added (large enough for the samples in flight during the latency).
+// Sensors are plain records processed in a loop, so that Update(), called at
+// every physics step, costs one time comparison per sensor between samples and
+// performs no allocation nor virtual call.
+//
+// A sensor configuration can be read from a JSON file, for example:
+//   {
+//     "Type": "Sensors",
+//     "Seed": 1,
+//     "Sensors": [
+//       { "Type": "IMU", "Rate": 100, "Latency": 0.002,
+//         "Noise": [0.05, 0.05, 0.05, 0.002, 0.002, 0.002] },
+//       { "Type": "GPS", "Rate": 10, "Latency": 0.1, "Noise": 0.5 },
+//       { "Type": "Wheel Speed", "Rate": 50, "Resolution": 0.1 }
+//     ]
+//   }
+// where "Noise" and "Bias" are either one value for all channels or one
+// value per channel, and "Latency", "Noise", "Bias", "Resolution" and
+// "Buffer Size" are optional.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_SENSORS_H
+#define CH_VEHICLE_SENSORS_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Fixed-rate IMU, GPS and wheel speed sensors of one vehicle.
+///
+class CH_SUBSYS_API ChVehicleSensors : public ChShared
+{
+public:
+
+  /// Sensor types.
+  enum Type {
+    IMU,
+    GPS,
+    WHEEL_SPEED
+  };
+
+  /// Create an empty sensor set; the noise of its sensors is drawn from a
+  /// generator with the specified seed.
+  ChVehicleSensors(unsigned int seed = 1);
+
+  /// Create the sensors described in the specified JSON file.
+  ChVehicleSensors(const std::string& filename);
+
+  ~ChVehicleSensors() {}
+
+  /// Add a sensor. The buffer holds at least the samples taken during the
+  /// latency, plus one.
+  /// Returns the index of the sensor, or -1 if the rate is not positive.
+  int AddSensor(
+    Type    type,               ///< [in] sensor type
+    double  rate,               ///< [in] sampling rate (Hz)
+    double  latency = 0,        ///< [in] delay before a sample is available (s)
+    double  noise = 0,          ///< [in] standard deviation of the noise (all channels)
+    double  bias = 0,           ///< [in] bias (all channels)
+    int     buffer_size = 16,   ///< [in] minimum number of samples kept
+    int     num_axles = 2       ///< [in] number of axles (wheel speed sensors)
+    );
+
+  /// Set the noise and bias of one channel of the specified sensor.
+  void SetNoise(int sensor, int channel, double noise, double bias);
+
+  /// Set the quantization step of the values of the specified sensor (zero
+  /// for none).
+  void SetResolution(int sensor, double resolution);
+
+  /// Start sampling at the specified time (the sample times are multiples of
+  /// the sampling periods after this time). Clears the buffers.
+  void Reset(double time);
+
+  /// Take the samples due at the specified time, from the current state of
+  /// the specified vehicle. To be called after each physics step.
+  void Update(double time, const ChVehicle& vehicle);
+
+  /// Get the number of sensors.
+  int GetNumSensors() const { return (int)m_sensors.size(); }
+
+  /// Get the type and number of channels of the specified sensor.
+  Type GetType(int sensor) const { return m_sensors[sensor].type; }
+  int GetNumChannels(int sensor) const { return m_sensors[sensor].num_channels; }
+
+  /// Get the total number of samples taken by the specified sensor.
+  int GetNumSamples(int sensor) const { return m_sensors[sensor].num_samples; }
+
+  /// Get the latest sample of the specified sensor available at the specified
+  /// time (i.e. taken at least one latency before). The values are copied in
+  /// the specified array, which must hold GetNumChannels() values.
+  /// Returns false if no sample is available.
+  bool GetLatest(
+    int      sensor,         ///< [in] sensor index
+    double   time,           ///< [in] current time
+    double&  sample_time,    ///< [out] time at which the sample was taken
+    double*  values          ///< [out] sampled values
+    ) const;
+
+  /// Get the samples of the specified sensor taken after the specified time
+  /// and available at the current time, oldest first, as (time, values...)
+  /// records of 1 + GetNumChannels() values, copied in the specified array
+  /// (which must be large enough for the whole buffer).
+  /// Returns the number of samples copied.
+  int GetSamples(int sensor, double after, double time, double* records) const;
+
+private:
+
+  enum { MAX_CHANNELS = 16 };
+
+  // A sensor and its ring buffer of (time, values...) records.
+  struct Sensor {
+    Type                 type;
+    int                  num_channels;
+    double               period;
+    double               latency;
+    double               resolution;
+    double               noise[MAX_CHANNELS];
+    double               bias[MAX_CHANNELS];
+
+    double               start_time;
+    int                  next_sample;     // index of the next sample since the start time
+    int                  num_samples;     // samples taken since the start
+    int                  head;            // next record to write
+    int                  capacity;        // number of records
+    std::vector<double>  buffer;
+  };
+
+  // Measure the exact values of the channels of a sensor.
+  static void Measure(Type type, int num_channels, const ChVehicle& vehicle, double* values);
+
+  // Standard normal deviate.
+  double Gaussian();
+
+  // Index in the buffer of the k-th most recent record (k = 0: latest).
+  static int record(const Sensor& sensor, int k);
+
+  std::vector<Sensor>   m_sensors;
+  bool                  m_started;     // false until the first Reset() or Update()
+  unsigned long long    m_state;       // noise generator state
+  double                m_spare;       // second deviate of the Box-Muller pair
+  bool                  m_has_spare;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
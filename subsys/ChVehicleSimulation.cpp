@@ -0,0 +1,735 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Simulation loop for a vehicle and its driver, powertrain, terrain and tire
+// modules.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChEventRecorder.h"
+#include "subsys/ChKpiMonitor.h"
+#include "subsys/ChEnergyMonitor.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// Accumulate the wall clock time of a scope into a module time (if not NULL).
+// -----------------------------------------------------------------------------
+class ChModuleTimer
+{
+public:
+  ChModuleTimer(double* time) : m_time(time), m_start(time ? ChProfiler::GetTime() : 0) {}
+  ~ChModuleTimer()
+  {
+    if (m_time)
+      *m_time += ChProfiler::GetTime() - m_start;
+  }
+
+private:
+  double* m_time;
+  double  m_start;
+};
+
+// -----------------------------------------------------------------------------
+// Task updating or advancing the tire attached to one wheel.
+// -----------------------------------------------------------------------------
+class ChTireTask : public ChTask
+{
+public:
+  ChTireTask(ChVehicleSimulation* sim, int wheel) : m_sim(sim), m_wheel(wheel), m_advance(false) {}
+
+  void SetAdvance(bool advance) { m_advance = advance; }
+
+  virtual void Execute(int worker)
+  {
+    if (m_advance) {
+      CH_PROFILE_SCOPE("ChTire::Advance");
+      m_sim->m_tires[m_wheel]->Advance(m_sim->GetModuleStep(ChVehicleSimulation::TIRES));
+    } else {
+      CH_PROFILE_SCOPE("ChTire::Update");
+      m_sim->m_tires[m_wheel]->Update(m_sim->m_time, m_sim->m_wheel_states[m_wheel]);
+    }
+  }
+
+private:
+  ChVehicleSimulation* m_sim;
+  int                  m_wheel;
+  bool                 m_advance;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleSimulation::ChVehicleSimulation(ChSharedPtr<ChVehicle>    vehicle,
+                                         ChSharedPtr<ChPowertrain> powertrain,
+                                         ChSharedPtr<ChDriver>     driver,
+                                         ChSharedPtr<ChTerrain>    terrain,
+                                         double                    step_size)
+: m_vehicle(vehicle),
+  m_powertrain(powertrain),
+  m_driver(driver),
+  m_terrain(terrain),
+  m_step_size(step_size),
+  m_output_steps(1),
+  m_render_steps(1),
+  m_exchange(HOLD),
+  m_step_number(0),
+  m_start_time(0),
+  m_time(0),
+  m_kinematic(false),
+  m_tire_pool(0),
+  m_min_tire_cost(16),
+  m_concurrent_tires(false),
+  m_deterministic(false),
+  m_replay(0),
+  m_replay_vehicle(0),
+  m_recorder(0),
+  m_kpi(0),
+  m_energy(0),
+  m_override(false),
+  m_wheel_time(0),
+  m_tire_count(0),
+  m_throttle(0),
+  m_steering(0),
+  m_braking(0),
+  m_powertrain_torque(0),
+  m_driveshaft_speed(0),
+  m_linearize_tires(false),
+  m_timing(false),
+  m_hook_time(0)
+{
+  std::fill(m_module_time, m_module_time + NUM_MODULES, 0.0);
+  std::fill(m_input_override, m_input_override + 3, 0.0);
+
+  int num_wheels = 2 * vehicle->GetNumberAxles();
+
+  m_tires.resize(num_wheels);
+  m_wheel_out.resize(num_wheels);
+  m_tire_out.resize(num_wheels);
+  m_tire_sum.resize(num_wheels);
+  m_wheel_states.resize(num_wheels);
+  m_tire_forces.resize(num_wheels);
+  m_tire_ref.resize(num_wheels);
+  m_tire_jac.resize(num_wheels);
+
+  for (int m = 0; m < NUM_MODULES; m++)
+    m_multiple[m] = 1;
+
+  m_start_time = vehicle->GetSystem()->GetChTime();
+  m_time = m_start_time;
+}
+
+ChVehicleSimulation::~ChVehicleSimulation()
+{
+  SetTireThreads(1);
+}
+
+void ChVehicleSimulation::SetTireThreads(int num_threads)
+{
+  delete m_tire_pool;
+  m_tire_pool = 0;
+
+  for (size_t i = 0; i < m_tire_tasks.size(); i++)
+    delete m_tire_tasks[i];
+  m_tire_tasks.clear();
+
+  if (num_threads <= 1)
+    return;
+
+  m_tire_pool = new ChThreadPool(num_threads);
+  m_tire_pool->SetStealing(!m_deterministic);
+  for (int i = 0; i < (int)m_tires.size(); i++)
+    m_tire_tasks.push_back(new ChTireTask(this, i));
+}
+
+void ChVehicleSimulation::OverrideInputs(double steering, double throttle, double braking)
+{
+  m_override = true;
+  m_input_override[0] = steering;
+  m_input_override[1] = throttle;
+  m_input_override[2] = braking;
+}
+
+void ChVehicleSimulation::SetDeterministic(bool val)
+{
+  m_deterministic = val;
+  if (m_tire_pool)
+    m_tire_pool->SetStealing(!val);
+}
+
+void ChVehicleSimulation::SetReplayLog(ChReplayLog* log, int vehicle)
+{
+  m_replay = log;
+  m_replay_vehicle = vehicle;
+  if (log)
+    log->SetNumVehicles(vehicle + 1);
+}
+
+bool ChVehicleSimulation::SetVehicle(ChSharedPtr<ChVehicle> vehicle)
+{
+  if (vehicle->GetNumberAxles() != m_vehicle->GetNumberAxles()) {
+    GetLog() << "ERROR: ChVehicleSimulation: the vehicle models have different numbers of axles\n";
+    return false;
+  }
+
+  // In kinematic mode, the state is transferred when leaving it.
+  if (!m_kinematic)
+    vehicle->TransferState(*m_vehicle);
+
+  m_vehicle = vehicle;
+  m_driveshaft_out = Signal();
+
+  return true;
+}
+
+void ChVehicleSimulation::SetKinematic(bool val)
+{
+  if (val == m_kinematic)
+    return;
+
+  if (val) {
+    m_bicycle.Initialize(*m_vehicle);
+  } else {
+    m_bicycle.Apply(*m_vehicle, m_time);
+    m_driveshaft_out = Signal();
+  }
+
+  m_kinematic = val;
+}
+
+ChVector<> ChVehicleSimulation::GetChassisPos() const
+{
+  if (m_kinematic)
+    return m_bicycle.GetChassisPos().pos;
+  return m_vehicle->GetChassisPos();
+}
+
+double ChVehicleSimulation::GetVehicleSpeed() const
+{
+  if (m_kinematic)
+    return m_bicycle.GetSpeed();
+  return m_vehicle->GetVehicleSpeed();
+}
+
+void ChVehicleSimulation::SetModuleStep(Module module, double step)
+{
+  int multiple = (int)std::floor(step / m_step_size + 0.5);
+  m_multiple[module] = multiple > 1 ? multiple : 1;
+}
+
+int ChVehicleSimulation::ComputeSteps(double interval) const
+{
+  int steps = (int)std::ceil(interval / m_step_size);
+  return steps > 1 ? steps : 1;
+}
+
+bool ChVehicleSimulation::HasAllTires() const
+{
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    if (m_tires[i].IsNull())
+      return false;
+  }
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Exchange of module outputs.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::Signal::Sample(double t, double v)
+{
+  prev = samples ? value : v;
+  prev_time = samples ? time : t;
+  value = v;
+  time = t;
+  sum += v;
+  count++;
+  samples++;
+}
+
+double ChVehicleSimulation::Signal::Get(double t, int producer, int consumer, ExchangeMode mode)
+{
+  double v = value;
+
+  if (mode == SMOOTH) {
+    if (producer > consumer && time > prev_time)
+      v = value + (t - time) * (value - prev) / (time - prev_time);
+    else if (producer < consumer && count > 0)
+      v = sum / count;
+  }
+
+  sum = 0;
+  count = 0;
+
+  return v;
+}
+
+void ChVehicleSimulation::SampleDriver()
+{
+  double throttle = m_driver->GetThrottle();
+  double steering = m_driver->GetSteering();
+  double braking = m_driver->GetBraking();
+  if (m_replay)
+    m_replay->Apply(m_replay_vehicle, m_time, steering, throttle, braking);
+  if (m_recorder)
+    m_recorder->Apply(m_time, steering, throttle, braking);
+  if (m_override) {
+    steering = m_input_override[0];
+    throttle = m_input_override[1];
+    braking = m_input_override[2];
+  }
+
+  m_throttle_out.Sample(m_time, throttle);
+  m_steering_out.Sample(m_time, steering);
+  m_braking_out.Sample(m_time, braking);
+}
+
+void ChVehicleSimulation::CollectOutputs()
+{
+  if (IsDue(DRIVER))
+    SampleDriver();
+
+  if (IsDue(POWERTRAIN))
+    m_torque_out.Sample(m_time, m_powertrain->GetOutputTorque());
+
+  if (IsDue(VEHICLE)) {
+    m_driveshaft_out.Sample(m_time, m_vehicle->GetDriveshaftSpeed());
+    if (m_tires.size())
+      m_vehicle->GetWheelStates(&m_wheel_out[0], (int)m_tires.size());
+    m_wheel_time = m_time;
+  }
+
+  if (IsDue(TIRES)) {
+    for (size_t i = 0; i < m_tires.size(); i++) {
+      m_tire_out[i] = m_tires[i]->GetTireForce();
+      m_tire_sum[i].force += m_tire_out[i].force;
+      m_tire_sum[i].point += m_tire_out[i].point;
+      m_tire_sum[i].moment += m_tire_out[i].moment;
+    }
+    m_tire_count++;
+
+    // The linearizations refer to the wheel states of the last tire update,
+    // which are replaced in SetInputs().
+    for (size_t i = 0; m_linearize_tires && i < m_tires.size(); i++) {
+      m_tire_ref[i] = m_wheel_states[i];
+      if (!m_tires[i]->GetForceJacobian(m_tire_jac[i]))
+        m_tire_jac[i] = ChTireForceJacobian();
+    }
+  }
+}
+
+void ChVehicleSimulation::SetInputs()
+{
+  if (IsDue(POWERTRAIN)) {
+    m_throttle = m_throttle_out.Get(m_time, m_multiple[DRIVER], m_multiple[POWERTRAIN], m_exchange);
+    m_throttle = std::min(std::max(m_throttle, 0.0), 1.0);
+    m_driveshaft_speed = m_driveshaft_out.Get(m_time, m_multiple[VEHICLE], m_multiple[POWERTRAIN], m_exchange);
+  }
+
+  if (IsDue(VEHICLE)) {
+    m_steering = m_steering_out.Get(m_time, m_multiple[DRIVER], m_multiple[VEHICLE], m_exchange);
+    m_steering = std::min(std::max(m_steering, -1.0), 1.0);
+    m_braking = m_braking_out.Get(m_time, m_multiple[DRIVER], m_multiple[VEHICLE], m_exchange);
+    m_braking = std::min(std::max(m_braking, 0.0), 1.0);
+    m_powertrain_torque = m_torque_out.Get(m_time, m_multiple[POWERTRAIN], m_multiple[VEHICLE], m_exchange);
+
+    bool average = (m_exchange == SMOOTH && m_multiple[TIRES] < m_multiple[VEHICLE] && m_tire_count > 0);
+    for (size_t i = 0; i < m_tires.size(); i++) {
+      if (average) {
+        m_tire_forces[i].force = m_tire_sum[i].force / m_tire_count;
+        m_tire_forces[i].point = m_tire_sum[i].point / m_tire_count;
+        m_tire_forces[i].moment = m_tire_sum[i].moment / m_tire_count;
+      } else {
+        m_tire_forces[i] = m_tire_out[i];
+      }
+      m_tire_sum[i].force = ChVector<>(0, 0, 0);
+      m_tire_sum[i].point = ChVector<>(0, 0, 0);
+      m_tire_sum[i].moment = ChVector<>(0, 0, 0);
+    }
+    m_tire_count = 0;
+  }
+
+  if (IsDue(TIRES)) {
+    // Extrapolate the wheel states from their velocities (the wheel angular
+    // speed is held).
+    double dt = m_time - m_wheel_time;
+    bool extrapolate = (m_exchange == SMOOTH && m_multiple[VEHICLE] > m_multiple[TIRES] && dt > 0);
+    for (size_t i = 0; i < m_tires.size(); i++) {
+      m_wheel_states[i] = m_wheel_out[i];
+      if (!extrapolate)
+        continue;
+      const ChVector<>& w = m_wheel_out[i].ang_vel;
+      double angle = w.Length() * dt;
+      m_wheel_states[i].pos += m_wheel_out[i].lin_vel * dt;
+      if (angle > 0) {
+        m_wheel_states[i].rot = Q_from_AngAxis(angle, w * (1 / w.Length())) * m_wheel_out[i].rot;
+        m_wheel_states[i].rot.Normalize();
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The tire tasks are submitted in wheel order and the pool is drained before
+// returning, so the tires see the same inputs as in a serial update.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::UpdateTires()
+{
+  m_concurrent_tires = false;
+
+  if (m_tire_pool) {
+    double cost = 0;
+    for (size_t i = 0; i < m_tires.size(); i++)
+      cost += m_tires[i]->GetUpdateCost();
+    m_concurrent_tires = (cost >= m_min_tire_cost);
+  }
+
+  if (!m_concurrent_tires) {
+    for (size_t i = 0; i < m_tires.size(); i++) {
+      CH_PROFILE_SCOPE("ChTire::Update");
+      m_tires[i]->Update(m_time, m_wheel_states[i]);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < m_tire_tasks.size(); i++) {
+    m_tire_tasks[i]->SetAdvance(false);
+    m_tire_pool->Submit(m_tire_tasks[i], (int)i);
+  }
+  m_tire_pool->Wait();
+}
+
+void ChVehicleSimulation::AdvanceTires()
+{
+  if (!m_concurrent_tires) {
+    for (size_t i = 0; i < m_tires.size(); i++) {
+      CH_PROFILE_SCOPE("ChTire::Advance");
+      m_tires[i]->Advance(GetModuleStep(TIRES));
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < m_tire_tasks.size(); i++) {
+    m_tire_tasks[i]->SetAdvance(true);
+    m_tire_pool->Submit(m_tire_tasks[i], (int)i);
+  }
+  m_tire_pool->Wait();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::DoKinematicStep()
+{
+  // The bicycle model uses the last driver outputs.
+  if (IsDue(DRIVER))
+    SampleDriver();
+  m_throttle = m_throttle_out.value;
+  m_steering = m_steering_out.value;
+  m_braking = m_braking_out.value;
+
+  if (m_step_number % m_output_steps == 0)
+    OnOutput(m_time);
+  if (m_step_number % m_render_steps == 0)
+    OnRender(m_time);
+
+  if (IsDue(DRIVER)) {
+    CH_PROFILE_SCOPE("ChDriver::Update");
+    m_driver->Update(m_time);
+  }
+  if (IsDue(TERRAIN)) {
+    CH_PROFILE_SCOPE("ChTerrain::Update");
+    m_terrain->Update(m_time);
+  }
+
+  if (IsDue(DRIVER)) {
+    CH_PROFILE_SCOPE("ChDriver::Advance");
+    m_driver->Advance(GetModuleStep(DRIVER));
+  }
+  if (IsDue(TERRAIN)) {
+    CH_PROFILE_SCOPE("ChTerrain::Advance");
+    m_terrain->Advance(GetModuleStep(TERRAIN));
+  }
+  m_bicycle.Advance(m_step_size, m_steering, m_throttle, m_braking);
+}
+
+void ChVehicleSimulation::DoStep()
+{
+  m_time = m_start_time + m_step_number * m_step_size;
+
+  if (m_timing) {
+    std::fill(m_module_time, m_module_time + NUM_MODULES, 0.0);
+    m_hook_time = 0;
+  }
+
+  if (m_recorder)
+    m_recorder->OnStep(*this);
+
+  if (m_kinematic) {
+    DoKinematicStep();
+    m_step_number++;
+    m_time = m_start_time + m_step_number * m_step_size;
+    return;
+  }
+
+  // Exchange data between the modules due at this step
+  CollectOutputs();
+  SetInputs();
+
+  // Output and rendering
+  {
+    ChModuleTimer timer(m_timing ? &m_hook_time : 0);
+    if (m_step_number % m_output_steps == 0)
+      OnOutput(m_time);
+    if (m_step_number % m_render_steps == 0)
+      OnRender(m_time);
+  }
+
+  // Update modules (process inputs from other modules)
+  if (IsDue(DRIVER)) {
+    ChModuleTimer timer(module_timer(DRIVER));
+    CH_PROFILE_SCOPE("ChDriver::Update");
+    m_driver->Update(m_time);
+  }
+  if (IsDue(TERRAIN)) {
+    ChModuleTimer timer(module_timer(TERRAIN));
+    CH_PROFILE_SCOPE("ChTerrain::Update");
+    m_terrain->Update(m_time);
+  }
+  if (IsDue(TIRES)) {
+    ChModuleTimer timer(module_timer(TIRES));
+    UpdateTires();
+  }
+  if (IsDue(POWERTRAIN)) {
+    ChModuleTimer timer(module_timer(POWERTRAIN));
+    CH_PROFILE_SCOPE("ChPowertrain::Update");
+    m_powertrain->Update(m_time, m_throttle, m_driveshaft_speed);
+  }
+  if (IsDue(VEHICLE)) {
+    ChModuleTimer timer(module_timer(VEHICLE));
+    CH_PROFILE_SCOPE("ChVehicle::Update");
+    m_vehicle->Update(m_time, m_steering, m_braking, m_powertrain_torque, m_tire_forces);
+  }
+
+  // Advance the modules due at this step by their own step
+  if (IsDue(DRIVER)) {
+    ChModuleTimer timer(module_timer(DRIVER));
+    CH_PROFILE_SCOPE("ChDriver::Advance");
+    m_driver->Advance(GetModuleStep(DRIVER));
+  }
+  if (IsDue(TERRAIN)) {
+    ChModuleTimer timer(module_timer(TERRAIN));
+    CH_PROFILE_SCOPE("ChTerrain::Advance");
+    m_terrain->Advance(GetModuleStep(TERRAIN));
+  }
+  if (IsDue(TIRES)) {
+    ChModuleTimer timer(module_timer(TIRES));
+    AdvanceTires();
+  }
+  if (IsDue(POWERTRAIN)) {
+    ChModuleTimer timer(module_timer(POWERTRAIN));
+    CH_PROFILE_SCOPE("ChPowertrain::Advance");
+    m_powertrain->Advance(GetModuleStep(POWERTRAIN));
+  }
+  if (IsDue(VEHICLE)) {
+    ChModuleTimer timer(module_timer(VEHICLE));
+    if (m_linearize_tires)
+      m_vehicle->SetTireForceLinearization(m_tire_forces, m_tire_ref, m_tire_jac);
+    m_vehicle->Advance(GetModuleStep(VEHICLE));
+    if (!m_sensors.IsNull()) {
+      CH_PROFILE_SCOPE("ChVehicleSensors::Update");
+      m_sensors->Update(m_time + GetModuleStep(VEHICLE), *m_vehicle);
+    }
+  }
+
+  m_step_number++;
+  m_time = m_start_time + m_step_number * m_step_size;
+
+  if (m_kpi) {
+    CH_PROFILE_SCOPE("ChKpiMonitor::Update");
+    m_kpi->Update(*this);
+  }
+  if (m_energy) {
+    CH_PROFILE_SCOPE("ChEnergyMonitor::Update");
+    m_energy->Update(*this);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Snapshot of the loop. The signals are saved in full, so that a restored run
+// continues exactly as the original one, whatever the module rates.
+// -----------------------------------------------------------------------------
+static const size_t SIGNAL_SIZE = 7;
+
+void ChVehicleSimulation::SaveState(ChVehicleState& state) const
+{
+  const Signal* signals[5] = {&m_throttle_out, &m_steering_out, &m_braking_out, &m_torque_out, &m_driveshaft_out};
+  size_t num_wheels = m_tires.size();
+
+  state.BeginBlock(8 + 5 * SIGNAL_SIZE +
+                   num_wheels * (2 * ChVehicleState::WHEEL_STATE_SIZE + 3 * ChVehicleState::TIRE_FORCE_SIZE));
+  state.Write(m_step_number);
+  state.Write(m_wheel_time);
+  state.Write(m_tire_count);
+  state.Write(m_throttle);
+  state.Write(m_steering);
+  state.Write(m_braking);
+  state.Write(m_powertrain_torque);
+  state.Write(m_driveshaft_speed);
+  for (int k = 0; k < 5; k++) {
+    state.Write(signals[k]->value);
+    state.Write(signals[k]->prev);
+    state.Write(signals[k]->time);
+    state.Write(signals[k]->prev_time);
+    state.Write(signals[k]->sum);
+    state.Write(signals[k]->count);
+    state.Write(signals[k]->samples);
+  }
+  for (size_t i = 0; i < num_wheels; i++) {
+    state.Write(m_wheel_out[i]);
+    state.Write(m_wheel_states[i]);
+    state.Write(m_tire_out[i]);
+    state.Write(m_tire_sum[i]);
+    state.Write(m_tire_forces[i]);
+  }
+
+  // The linearization data is only saved if enabled (7 vectors per wheel).
+  if (m_linearize_tires) {
+    state.BeginBlock(num_wheels * (ChVehicleState::WHEEL_STATE_SIZE + 21));
+    for (size_t i = 0; i < num_wheels; i++) {
+      const ChTireForceJacobian& J = m_tire_jac[i];
+      state.Write(m_tire_ref[i]);
+      state.Write(J.dF_dpx);
+      state.Write(J.dF_dpy);
+      state.Write(J.dF_dpz);
+      state.Write(J.dF_dvx);
+      state.Write(J.dF_dvy);
+      state.Write(J.dF_dvz);
+      state.Write(J.dF_domega);
+    }
+  }
+
+  m_vehicle->SaveState(state);
+  m_powertrain->SaveState(state);
+  m_driver->SaveState(state);
+  for (size_t i = 0; i < num_wheels; i++)
+    m_tires[i]->SaveState(state);
+}
+
+bool ChVehicleSimulation::RestoreState(ChVehicleState& state)
+{
+  Signal* signals[5] = {&m_throttle_out, &m_steering_out, &m_braking_out, &m_torque_out, &m_driveshaft_out};
+  size_t num_wheels = m_tires.size();
+
+  if (!state.OpenBlock(8 + 5 * SIGNAL_SIZE +
+                       num_wheels * (2 * ChVehicleState::WHEEL_STATE_SIZE + 3 * ChVehicleState::TIRE_FORCE_SIZE),
+                       "simulation loop"))
+    return false;
+
+  m_step_number = (int)state.Read();
+  m_wheel_time = state.Read();
+  m_tire_count = (int)state.Read();
+  m_throttle = state.Read();
+  m_steering = state.Read();
+  m_braking = state.Read();
+  m_powertrain_torque = state.Read();
+  m_driveshaft_speed = state.Read();
+  for (int k = 0; k < 5; k++) {
+    signals[k]->value = state.Read();
+    signals[k]->prev = state.Read();
+    signals[k]->time = state.Read();
+    signals[k]->prev_time = state.Read();
+    signals[k]->sum = state.Read();
+    signals[k]->count = (int)state.Read();
+    signals[k]->samples = (int)state.Read();
+  }
+  for (size_t i = 0; i < num_wheels; i++) {
+    m_wheel_out[i] = state.ReadWheelState();
+    m_wheel_states[i] = state.ReadWheelState();
+    m_tire_out[i] = state.ReadTireForce();
+    m_tire_sum[i] = state.ReadTireForce();
+    m_tire_forces[i] = state.ReadTireForce();
+  }
+  m_time = m_start_time + m_step_number * m_step_size;
+
+  if (m_linearize_tires) {
+    if (!state.OpenBlock(num_wheels * (ChVehicleState::WHEEL_STATE_SIZE + 21), "tire force linearization"))
+      return false;
+    for (size_t i = 0; i < num_wheels; i++) {
+      ChTireForceJacobian& J = m_tire_jac[i];
+      m_tire_ref[i] = state.ReadWheelState();
+      J.dF_dpx = state.ReadVector();
+      J.dF_dpy = state.ReadVector();
+      J.dF_dpz = state.ReadVector();
+      J.dF_dvx = state.ReadVector();
+      J.dF_dvy = state.ReadVector();
+      J.dF_dvz = state.ReadVector();
+      J.dF_domega = state.ReadVector();
+    }
+  }
+
+  bool ok = m_vehicle->RestoreState(state) &&
+            m_powertrain->RestoreState(state) &&
+            m_driver->RestoreState(state);
+  for (size_t i = 0; ok && i < num_wheels; i++)
+    ok = m_tires[i]->RestoreState(state);
+
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::AddMemoryFootprint(ChMemoryReport& report) const
+{
+  report.Add("simulation/loops", sizeof(*this) +
+                                 ChMemoryReport::VectorBytes(m_tires) +
+                                 ChMemoryReport::VectorBytes(m_tire_tasks));
+
+  m_vehicle->AddMemoryFootprint(report);
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    if (!m_tires[i].IsNull())
+      m_tires[i]->AddMemoryFootprint(report);
+  }
+  m_terrain->AddMemoryFootprint(report);
+
+  ChMeshCache::AddMemoryFootprint(report);
+}
+
+
+bool ChVehicleSimulation::Run(double end_time)
+{
+  if (!HasAllTires()) {
+    GetLog() << "ERROR: ChVehicleSimulation: a tire was not attached to each wheel\n";
+    return false;
+  }
+
+  while (m_time < end_time && Continue())
+    DoStep();
+
+  return true;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
@@ -0,0 +1,453 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Simulation loop for a vehicle and its driver, powertrain, terrain and tire
+// modules.
+//
+// At each step, the outputs of all modules (driver inputs, powertrain torque,
+// driveshaft speed, wheel states and tire forces) are collected in buffers
+// allocated once, at construction, and then all modules are updated and
+// advanced in the same sequence used by the vehicle demos. The wheel states and
+// tire forces are stored contiguously, indexed by wheel ID (i.e. two entries
+// per axle, counted from the front).
+//
+// Output and rendering are performed by overriding OnOutput() and OnRender(),
+// which are called at the specified time intervals before the modules are
+// updated.
+//
+// Each module can run at its own rate, an integer multiple of the base step:
+// a module is updated and advanced (by its own step) only at the base steps
+// that are multiples of its step, with the inputs collected from the other
+// modules at that time. For each exchanged quantity, the consumer either uses
+// the last output of the producer (HOLD) or, with SMOOTH exchange, a linear
+// extrapolation from the last two outputs of a slower producer (wheel states
+// are extrapolated kinematically from their own velocities) or the average of
+// the outputs of a faster producer since the consumer's previous update. Note
+// that subsystems integrated by the Chrono system (e.g. a shafts powertrain or
+// rigid tires) always run at the vehicle rate.
+//
+// The vehicle model can be switched at runtime, e.g. between a full and a
+// reduced model of the same vehicle (SetVehicle()), or replaced by a kinematic
+// bicycle model (SetKinematic()); the state is transferred at each switch (see
+// ChVehicle::TransferState() and ChBicycleModel). While the bicycle model is
+// active, only the driver and the terrain are updated. Tires that rely on
+// Chrono contact with the wheel bodies of a particular vehicle (RigidTire)
+// cannot be kept across a switch of vehicle model. With multi-rate scheduling,
+// switches should be made at steps where all modules are due.
+//
+// Optionally, the tires are updated and advanced concurrently on a small
+// thread pool, with a barrier before the powertrain and vehicle are updated
+// (and advanced). Each tire only reads its own wheel state and queries the
+// terrain, so the terrain height and normal queries must be thread-safe (as
+// they are for all terrain models in ChronoVehicle). Dispatching the tires
+// costs a few microseconds per step, so it is only done if the total tire cost
+// (see ChTire::GetUpdateCost()) reaches a threshold; cheap rigid tires stay
+// serial.
+//
+// The state of the loop (step number and exchanged data) and of its modules
+// can be saved and restored with SaveState() and RestoreState(), e.g. by an
+// event recorder (see ChEventRecorder) writing periodic keyframes.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_SIMULATION_H
+#define CH_VEHICLE_SIMULATION_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChThreadPool.h"
+#include "subsys/ChVehicleState.h"
+#include "subsys/ChReplayLog.h"
+#include "subsys/ChBicycleModel.h"
+#include "subsys/ChVehicleSensors.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+class ChTireTask;
+class ChEventRecorder;
+class ChKpiMonitor;
+class ChEnergyMonitor;
+
+///
+/// Simulation loop for a vehicle system and its modules.
+///
+class CH_SUBSYS_API ChVehicleSimulation
+{
+public:
+
+  /// Modules scheduled by the simulation loop.
+  enum Module {
+    DRIVER,
+    TERRAIN,
+    TIRES,
+    POWERTRAIN,
+    VEHICLE,
+    NUM_MODULES
+  };
+
+  /// Treatment of the quantities exchanged between modules running at
+  /// different rates.
+  enum ExchangeMode {
+    HOLD,     ///< use the last output of the producer
+    SMOOTH    ///< extrapolate the outputs of slower producers, average those of faster producers
+  };
+
+  /// Create the simulation loop for the specified modules. The tires must be
+  /// provided with SetTire() before the first step.
+  ChVehicleSimulation(
+    ChSharedPtr<ChVehicle>    vehicle,      ///< [in] vehicle system
+    ChSharedPtr<ChPowertrain> powertrain,   ///< [in] powertrain system
+    ChSharedPtr<ChDriver>     driver,       ///< [in] driver system
+    ChSharedPtr<ChTerrain>    terrain,      ///< [in] terrain system
+    double                    step_size     ///< [in] base integration step size
+    );
+
+  virtual ~ChVehicleSimulation();
+
+  /// Set the tire attached to the specified wheel.
+  void SetTire(const ChWheelID& wheel_id, ChSharedPtr<ChTire> tire) { m_tires[wheel_id.id()] = tire; }
+
+  /// Attach the specified sensors to the vehicle (NULL to remove them). The
+  /// sensors are sampled after each advance of the vehicle system.
+  void SetSensors(ChSharedPtr<ChVehicleSensors> sensors) { m_sensors = sensors; }
+
+  /// Set the base step size. Module steps set with SetModuleStep() are
+  /// multiples of the base step, so the base step should be set first.
+  void SetStepSize(double step_size) { m_step_size = step_size; }
+
+  /// Get the base step size.
+  double GetStepSize() const { return m_step_size; }
+
+  /// Set the step of the specified module, rounded to a multiple of the base
+  /// step (default: the base step).
+  void SetModuleStep(Module module, double step);
+
+  /// Get the step of the specified module.
+  double GetModuleStep(Module module) const { return m_multiple[module] * m_step_size; }
+
+  /// Set the treatment of the quantities exchanged between modules running at
+  /// different rates (default: HOLD).
+  void SetExchangeMode(ExchangeMode mode) { m_exchange = mode; }
+
+  /// Enable or disable the re-evaluation of the tire forces at each integration
+  /// step of the vehicle (default: disabled). The tires that provide one (see
+  /// ChTire::GetForceJacobian()) pass the linearization of their forces about
+  /// the wheel states of their last update, which the vehicle re-applies with
+  /// the current wheel kinematics (see ChVehicle::SetTireForceLinearization()),
+  /// instead of holding the forces until the next exchange. This allows a
+  /// larger tire step (or vehicle step relative to its integration step) at
+  /// the same accuracy.
+  void SetTireForceLinearization(bool val) { m_linearize_tires = val; }
+
+  /// Set the time interval between two calls to OnOutput() (default: every step).
+  void SetOutputStep(double output_step) { m_output_steps = ComputeSteps(output_step); }
+
+  /// Set the time interval between two calls to OnRender() (default: every step).
+  void SetRenderStep(double render_step) { m_render_steps = ComputeSteps(render_step); }
+
+  /// Get the time interval between two calls to OnRender().
+  double GetRenderStep() const { return m_render_steps * m_step_size; }
+
+  /// Set the number of threads used to update and advance the tires (default:
+  /// 1, i.e. the tires are processed serially by the calling thread).
+  void SetTireThreads(int num_threads);
+
+  /// Set the smallest total tire cost for which the tires are processed
+  /// concurrently (default: 16, i.e. four LuGre tires with four discs or two
+  /// Pacejka tires).
+  void SetTireCostThreshold(double min_cost) { m_min_tire_cost = min_cost; }
+
+  /// Return true if the tires were processed concurrently at the last step.
+  bool IsTireUpdateConcurrent() const { return m_concurrent_tires; }
+
+  /// Enable or disable the deterministic mode of the concurrent tire
+  /// processing (default: disabled), in which each tire always runs on the
+  /// same thread (see ChThreadPool::SetStealing()).
+  void SetDeterministic(bool val);
+
+  /// Record the driver inputs in the specified log or, if the log was loaded
+  /// from a file, replace them with the recorded ones (see ChReplayLog). The
+  /// log is not owned and must outlive the simulation; NULL disables the
+  /// recording.
+  void SetReplayLog(
+    ChReplayLog* log,          ///< [in] replay log (NULL: none)
+    int          vehicle = 0   ///< [in] index of this vehicle in the log
+    );
+
+  /// Attach the specified event recorder (see ChEventRecorder), which is
+  /// called at the beginning of each step and sees the driver inputs. The
+  /// recorder is not owned and must outlive the simulation; NULL detaches it.
+  void SetEventRecorder(ChEventRecorder* recorder) { m_recorder = recorder; }
+
+  /// Attach the specified KPI monitor (see ChKpiMonitor), which is updated at
+  /// the end of each step (except with the kinematic bicycle model). The
+  /// monitor is not owned and must outlive the simulation; NULL detaches it.
+  void SetKpiMonitor(ChKpiMonitor* monitor) { m_kpi = monitor; }
+
+  /// Attach the specified energy monitor (see ChEnergyMonitor), which is
+  /// updated at the end of each step (except with the kinematic bicycle
+  /// model). The monitor is not owned and must outlive the simulation; NULL
+  /// detaches it.
+  void SetEnergyMonitor(ChEnergyMonitor* monitor) { m_energy = monitor; }
+
+  /// Replace the driver inputs with the specified values at each driver step,
+  /// after the replay log and the event recorder, e.g. to hold or perturb them
+  /// in a linearization (see ChLinearizer). The driver is still advanced. The
+  /// inputs are clamped to their ranges.
+  void OverrideInputs(double steering, double throttle, double braking);
+
+  /// Use the driver inputs again.
+  void ReleaseInputs() { m_override = false; }
+
+  /// Append the state of the simulation loop (the step number and the data
+  /// exchanged between the modules), followed by the states of the vehicle,
+  /// powertrain, driver and tires, to the specified snapshot. The kinematic
+  /// bicycle model, the terrain and the sensors are not saved.
+  void SaveState(ChVehicleState& state) const;
+
+  /// Restore the state of the simulation loop and of its modules from the
+  /// snapshot, taken from this simulation (or one constructed identically).
+  bool RestoreState(ChVehicleState& state);
+
+  /// Add the memory footprint of the modules to the specified report: the
+  /// vehicle (including a powertrain attached to its Chrono system), the tires,
+  /// the terrain and the cached meshes. Reports of several simulations sharing
+  /// a terrain or tire parameters can be merged (see ChMemoryReport).
+  void AddMemoryFootprint(ChMemoryReport& report) const;
+
+  /// Switch to another model of the vehicle (with the same number of axles),
+  /// transferring the current state. Returns false if the number of axles
+  /// differs.
+  bool SetVehicle(ChSharedPtr<ChVehicle> vehicle);
+
+  /// Switch between the vehicle model and the kinematic bicycle model,
+  /// transferring the current state.
+  void SetKinematic(bool val);
+
+  /// Return true if the kinematic bicycle model is active.
+  bool IsKinematic() const { return m_kinematic; }
+
+  /// Get the kinematic bicycle model (e.g. to set its parameters).
+  ChBicycleModel& GetBicycleModel() { return m_bicycle; }
+
+  /// Get the chassis position and forward speed, from the active model.
+  ChVector<> GetChassisPos() const;
+  double GetVehicleSpeed() const;
+
+  /// Get the number of wheels.
+  int GetNumWheels() const { return (int)m_tires.size(); }
+
+  /// Enable or disable the measurement of the wall clock time spent in each
+  /// module (update and advance) and in the output and rendering hooks at each
+  /// step (default: disabled), e.g. for deadline monitoring (see
+  /// ChRealtimeScheduler). Unlike the profiling sections, this does not
+  /// require ENABLE_PROFILING; it costs two clock reads per module.
+  void EnableModuleTiming(bool val) { m_timing = val; }
+
+  /// Get the wall clock time spent in the specified module at the last step
+  /// (zero if the module was not due or the timing is disabled).
+  double GetModuleTime(Module module) const { return m_module_time[module]; }
+
+  /// Get the wall clock time spent in OnOutput() and OnRender() at the last
+  /// step (zero if the timing is disabled).
+  double GetHookTime() const { return m_hook_time; }
+
+  /// Get the number of steps taken so far.
+  int GetStepNumber() const { return m_step_number; }
+
+  /// Get the current simulation time.
+  double GetTime() const { return m_time; }
+
+  /// Return true if a tire was attached to each wheel.
+  bool HasAllTires() const;
+
+  /// Perform one base step: collect the outputs of the modules due at this
+  /// step, call the output and rendering hooks (if due), then update and
+  /// advance the modules due at this step.
+  void DoStep();
+
+  /// Perform simulation steps until the specified end time is reached or
+  /// Continue() returns false. Returns false if a tire is missing.
+  bool Run(double end_time);
+
+  /// Get the driver inputs passed to the powertrain and vehicle at the last
+  /// step they were updated.
+  double GetThrottle() const { return m_throttle; }
+  double GetSteering() const { return m_steering; }
+  double GetBraking() const { return m_braking; }
+
+  /// Get the powertrain torque and driveshaft speed exchanged at the last step
+  /// the vehicle and the powertrain were updated.
+  double GetPowertrainTorque() const { return m_powertrain_torque; }
+  double GetDriveshaftSpeed() const { return m_driveshaft_speed; }
+
+  /// Get the wheel states and tire forces exchanged at the last step the tires
+  /// and the vehicle were updated.
+  const ChWheelStates& GetWheelStates() const { return m_wheel_states; }
+  const ChTireForces&  GetTireForces() const { return m_tire_forces; }
+
+  /// Get handles to the modules.
+  ChSharedPtr<ChVehicle>    GetVehicle() const { return m_vehicle; }
+  ChSharedPtr<ChPowertrain> GetPowertrain() const { return m_powertrain; }
+  ChSharedPtr<ChDriver>     GetDriver() const { return m_driver; }
+  ChSharedPtr<ChTerrain>    GetTerrain() const { return m_terrain; }
+  ChSharedPtr<ChTire>       GetTire(const ChWheelID& wheel_id) const { return m_tires[wheel_id.id()]; }
+  ChSharedPtr<ChVehicleSensors> GetSensors() const { return m_sensors; }
+
+protected:
+
+  /// Output hook, called every output step with the data collected at the
+  /// current step.
+  virtual void OnOutput(double time) {}
+
+  /// Rendering hook, called every render step with the data collected at the
+  /// current step.
+  virtual void OnRender(double time) {}
+
+  /// Called by Run() before each step; return false to stop the simulation
+  /// (e.g. when the visualization window was closed).
+  virtual bool Continue() { return true; }
+
+private:
+
+  friend class ChTireTask;
+
+  // Output of a module consumed by another module: the last two samples, the
+  // times at which they were taken and the sum and number of the samples taken
+  // since the consumer last used the signal.
+  struct Signal {
+    Signal() : value(0), prev(0), time(0), prev_time(0), sum(0), count(0), samples(0) {}
+    void   Sample(double t, double v);
+    double Get(double t, int producer, int consumer, ExchangeMode mode);
+
+    double  value;
+    double  prev;
+    double  time;
+    double  prev_time;
+    double  sum;
+    int     count;
+    int     samples;
+  };
+
+  ChVehicleSimulation(const ChVehicleSimulation&);
+  ChVehicleSimulation& operator=(const ChVehicleSimulation&);
+
+  // Number of steps in the specified time interval (at least 1).
+  int ComputeSteps(double interval) const;
+
+  // Accumulator of the time of the specified module (NULL if not timed).
+  double* module_timer(Module module) { return m_timing ? &m_module_time[module] : 0; }
+
+  // Return true if the specified module is updated at the current step.
+  bool IsDue(Module module) const { return m_step_number % m_multiple[module] == 0; }
+
+  // Collect the outputs of the modules due at the current step and set the
+  // inputs of these modules.
+  void CollectOutputs();
+  void SetInputs();
+
+  // Perform one base step with the kinematic bicycle model.
+  void DoKinematicStep();
+
+  // Sample the driver outputs (replaced by the replay log, if any).
+  void SampleDriver();
+
+  // Update (or advance) all tires, concurrently if worth it.
+  void UpdateTires();
+  void AdvanceTires();
+
+  ChSharedPtr<ChVehicle>             m_vehicle;
+  ChSharedPtr<ChPowertrain>          m_powertrain;
+  ChSharedPtr<ChDriver>              m_driver;
+  ChSharedPtr<ChTerrain>             m_terrain;
+  std::vector<ChSharedPtr<ChTire> >  m_tires;
+  ChSharedPtr<ChVehicleSensors>      m_sensors;
+
+  double          m_step_size;
+  int             m_output_steps;
+  int             m_render_steps;
+  int             m_multiple[NUM_MODULES];   // module steps, in base steps
+  ExchangeMode    m_exchange;
+
+  int             m_step_number;
+  double          m_start_time;
+  double          m_time;
+
+  // Kinematic mode
+  ChBicycleModel  m_bicycle;
+  bool            m_kinematic;
+
+  // Concurrent tire processing
+  ChThreadPool*               m_tire_pool;
+  std::vector<ChTireTask*>    m_tire_tasks;     // one per wheel
+  double                      m_min_tire_cost;
+  bool                        m_concurrent_tires;
+  bool                        m_deterministic;
+
+  // Replay
+  ChReplayLog*    m_replay;
+  int             m_replay_vehicle;
+  ChEventRecorder* m_recorder;
+  ChKpiMonitor*   m_kpi;
+  ChEnergyMonitor* m_energy;
+  bool            m_override;
+  double          m_input_override[3]; // steering, throttle, braking
+
+  // Module outputs
+  Signal          m_throttle_out;
+  Signal          m_steering_out;
+  Signal          m_braking_out;
+  Signal          m_torque_out;
+  Signal          m_driveshaft_out;
+  ChWheelStates   m_wheel_out;         // last wheel states from the vehicle
+  double          m_wheel_time;        // time of the last wheel states
+  ChTireForces    m_tire_out;          // last tire forces
+  ChTireForces    m_tire_sum;          // sum of the tire forces since the last vehicle update
+  int             m_tire_count;
+
+  // Module inputs
+  double          m_throttle;
+  double          m_steering;
+  double          m_braking;
+  double          m_powertrain_torque;
+  double          m_driveshaft_speed;
+  ChWheelStates   m_wheel_states;
+  ChTireForces    m_tire_forces;
+
+  // Tire force linearization
+  bool                  m_linearize_tires;
+  ChWheelStates         m_tire_ref;          // wheel states of the last tire update
+  ChTireForceJacobians  m_tire_jac;          // tire force linearizations about these states
+
+  // Module timing
+  bool            m_timing;
+  double          m_module_time[NUM_MODULES];
+  double          m_hook_time;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
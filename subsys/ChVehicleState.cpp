@@ -0,0 +1,193 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory snapshot of the state of a vehicle simulation.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleState.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChVehicleState::OpenBlock(size_t length, const char* name)
+{
+  if (m_pos >= m_data.size()) {
+    GetLog() << "ERROR: no saved state for " << name << "\n";
+    return false;
+  }
+
+  size_t saved_length = (size_t)m_data[m_pos];
+  if (saved_length != length || m_pos + 1 + length > m_data.size()) {
+    GetLog() << "ERROR: saved state for " << name << " has " << (int)saved_length
+             << " values (expected " << (int)length << ")\n";
+    return false;
+  }
+
+  m_pos++;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleState::Write(const ChVector<>& v)
+{
+  m_data.push_back(v.x);
+  m_data.push_back(v.y);
+  m_data.push_back(v.z);
+}
+
+void ChVehicleState::Write(const ChQuaternion<>& q)
+{
+  m_data.push_back(q.e0);
+  m_data.push_back(q.e1);
+  m_data.push_back(q.e2);
+  m_data.push_back(q.e3);
+}
+
+void ChVehicleState::Write(const ChCoordsys<>& csys)
+{
+  Write(csys.pos);
+  Write(csys.rot);
+}
+
+void ChVehicleState::Write(const ChWheelState& state)
+{
+  Write(state.pos);
+  Write(state.rot);
+  Write(state.lin_vel);
+  Write(state.ang_vel);
+  m_data.push_back(state.omega);
+}
+
+void ChVehicleState::Write(const ChTireForce& force)
+{
+  Write(force.force);
+  Write(force.point);
+  Write(force.moment);
+}
+
+// -----------------------------------------------------------------------------
+// File format: magic "CHSTATE1" (8 bytes), number of values (uint64), values.
+// -----------------------------------------------------------------------------
+static const char s_state_magic[8] = {'C', 'H', 'S', 'T', 'A', 'T', 'E', '1'};
+
+bool ChVehicleState::WriteFile(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  unsigned long long size = m_data.size();
+  bool ok = fwrite(s_state_magic, 1, 8, fp) == 8 && fwrite(&size, sizeof(size), 1, fp) == 1;
+  if (ok && size > 0)
+    ok = fwrite(&m_data[0], sizeof(double), m_data.size(), fp) == m_data.size();
+
+  return (fclose(fp) == 0) && ok;
+}
+
+bool ChVehicleState::ReadFile(const std::string& filename)
+{
+  Clear();
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  char magic[8];
+  unsigned long long size = 0;
+  bool ok = fread(magic, 1, 8, fp) == 8 && std::memcmp(magic, s_state_magic, 8) == 0 &&
+            fread(&size, sizeof(size), 1, fp) == 1 && size < (1ULL << 32);
+  if (ok && size > 0) {
+    m_data.resize((size_t)size);
+    ok = fread(&m_data[0], sizeof(double), m_data.size(), fp) == m_data.size();
+  }
+
+  fclose(fp);
+
+  if (!ok)
+    Clear();
+
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleState::Read(double* vals, size_t n)
+{
+  assert(m_pos + n <= m_data.size());
+  for (size_t i = 0; i < n; i++)
+    vals[i] = m_data[m_pos + i];
+  m_pos += n;
+}
+
+ChVector<> ChVehicleState::ReadVector()
+{
+  ChVector<> v;
+  v.x = Read();
+  v.y = Read();
+  v.z = Read();
+  return v;
+}
+
+ChQuaternion<> ChVehicleState::ReadQuaternion()
+{
+  ChQuaternion<> q;
+  q.e0 = Read();
+  q.e1 = Read();
+  q.e2 = Read();
+  q.e3 = Read();
+  return q;
+}
+
+ChCoordsys<> ChVehicleState::ReadCoordsys()
+{
+  ChCoordsys<> csys;
+  csys.pos = ReadVector();
+  csys.rot = ReadQuaternion();
+  return csys;
+}
+
+ChWheelState ChVehicleState::ReadWheelState()
+{
+  ChWheelState state;
+  state.pos = ReadVector();
+  state.rot = ReadQuaternion();
+  state.lin_vel = ReadVector();
+  state.ang_vel = ReadVector();
+  state.omega = Read();
+  return state;
+}
+
+ChTireForce ChVehicleState::ReadTireForce()
+{
+  ChTireForce force;
+  force.force = ReadVector();
+  force.point = ReadVector();
+  force.moment = ReadVector();
+  return force;
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
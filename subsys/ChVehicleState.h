@@ -0,0 +1,148 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory snapshot of the state of a vehicle simulation.
+//
+// The vehicle, powertrain, driver and tire subsystems append their states to
+// a ChVehicleState (SaveState) and read them back, in the same order, when
+// the snapshot is restored (RestoreState). Each subsystem writes one block of
+// doubles, preceded by its length. A typical use is
+//
+//    vehicle::ChVehicleState snapshot;
+//    vehicle.SaveState(snapshot);
+//    powertrain.SaveState(snapshot);
+//    driver.SaveState(snapshot);
+//    for (int i = 0; i < num_wheels; i++)
+//      tires[i]->SaveState(snapshot);
+//    ...
+//    snapshot.Rewind();
+//    bool ok = vehicle.RestoreState(snapshot) &&
+//              powertrain.RestoreState(snapshot) &&
+//              driver.RestoreState(snapshot);
+//    for (int i = 0; ok && i < num_wheels; i++)
+//      ok = tires[i]->RestoreState(snapshot);
+//
+// A snapshot can be restored any number of times, but only into the same
+// simulation (or one constructed identically). It can also be written to a
+// binary file (the values in native byte order, after a magic string and the
+// number of values) and read back in a later run.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_STATE_H
+#define CH_VEHICLE_STATE_H
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+#include "core/ChCoordsys.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Flat array of subsystem states with a read cursor.
+///
+class CH_SUBSYS_API ChVehicleState
+{
+public:
+
+  ChVehicleState() : m_pos(0) {}
+
+  /// Discard all saved states.
+  void Clear() { m_data.clear(); m_pos = 0; }
+
+  /// Move the read cursor to the beginning of the snapshot.
+  void Rewind() { m_pos = 0; }
+
+  /// Get the number of values in the snapshot.
+  size_t GetSize() const { return m_data.size(); }
+
+  /// Return true if all saved blocks were read.
+  bool AtEnd() const { return m_pos == m_data.size(); }
+
+  /// Get a pointer to the values of the snapshot (e.g. to send it to another
+  /// process).
+  const double* GetData() const { return m_data.empty() ? 0 : &m_data[0]; }
+
+  /// Replace the snapshot with the specified values, and rewind it.
+  void Assign(const double* vals, size_t n) { m_data.assign(vals, vals + n); m_pos = 0; }
+
+  /// Exchange the contents (and read cursors) of two snapshots.
+  void Swap(ChVehicleState& other) { m_data.swap(other.m_data); std::swap(m_pos, other.m_pos); }
+
+  /// Write the snapshot to the specified binary file.
+  /// Returns false if the file cannot be written.
+  bool WriteFile(const std::string& filename) const;
+
+  /// Replace the snapshot with the contents of the specified binary file, and
+  /// rewind it. Returns false (leaving the snapshot empty) if the file cannot
+  /// be read or is not a snapshot file.
+  bool ReadFile(const std::string& filename);
+
+  /// Start a new block of the specified length (number of doubles).
+  /// The caller must then write exactly this many values.
+  void BeginBlock(size_t length) { m_data.push_back((double)length); }
+
+  /// Start reading the next block, which must have the specified length.
+  /// Returns false (and reports an error for the named subsystem) if the
+  /// snapshot is exhausted or the next block has a different length.
+  bool OpenBlock(size_t length, const char* name);
+
+  void Write(double val) { m_data.push_back(val); }
+  void Write(const double* vals, size_t n) { m_data.insert(m_data.end(), vals, vals + n); }
+  void Write(const ChVector<>& v);
+  void Write(const ChQuaternion<>& q);
+  void Write(const ChCoordsys<>& csys);
+  void Write(const ChWheelState& state);
+  void Write(const ChTireForce& force);
+
+  /// Read values from a block opened with OpenBlock().
+  double Read() { assert(m_pos < m_data.size()); return m_data[m_pos++]; }
+  void Read(double* vals, size_t n);
+  ChVector<> ReadVector();
+  ChQuaternion<> ReadQuaternion();
+  ChCoordsys<> ReadCoordsys();
+  ChWheelState ReadWheelState();
+  ChTireForce ReadTireForce();
+
+  /// Number of doubles written for each of the structure types.
+  enum {
+    VECTOR_SIZE = 3,
+    QUATERNION_SIZE = 4,
+    COORDSYS_SIZE = 7,
+    WHEEL_STATE_SIZE = 14,
+    TIRE_FORCE_SIZE = 9
+  };
+
+private:
+
+  std::vector<double>  m_data;
+  size_t               m_pos;   // read cursor
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,384 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Minimal portable threading primitives (POSIX threads or Win32) used by the
+// ChronoVehicle subsystems that perform work in the background.
+//
+// =============================================================================
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <cstdio>
+#include <sched.h>
+#endif
+
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+namespace vehicle {
+
+// Invoke ChThread::Run() from the platform-specific thread entry points.
+struct ChThreadEntry {
+  static void Call(void* arg) { static_cast<ChThread*>(arg)->Run(); }
+};
+
+
+#ifdef _WIN32
+
+// -----------------------------------------------------------------------------
+// Win32 implementation (requires Windows Vista or later)
+// -----------------------------------------------------------------------------
+ChMutex::ChMutex()
+{
+  CRITICAL_SECTION* cs = new CRITICAL_SECTION;
+  InitializeCriticalSection(cs);
+  m_impl = cs;
+}
+
+ChMutex::~ChMutex()
+{
+  CRITICAL_SECTION* cs = static_cast<CRITICAL_SECTION*>(m_impl);
+  DeleteCriticalSection(cs);
+  delete cs;
+}
+
+void ChMutex::Lock()
+{
+  EnterCriticalSection(static_cast<CRITICAL_SECTION*>(m_impl));
+}
+
+void ChMutex::Unlock()
+{
+  LeaveCriticalSection(static_cast<CRITICAL_SECTION*>(m_impl));
+}
+
+ChCondition::ChCondition()
+{
+  CONDITION_VARIABLE* cv = new CONDITION_VARIABLE;
+  InitializeConditionVariable(cv);
+  m_impl = cv;
+}
+
+ChCondition::~ChCondition()
+{
+  delete static_cast<CONDITION_VARIABLE*>(m_impl);
+}
+
+void ChCondition::Wait(ChMutex& mutex)
+{
+  SleepConditionVariableCS(static_cast<CONDITION_VARIABLE*>(m_impl),
+                           static_cast<CRITICAL_SECTION*>(mutex.m_impl),
+                           INFINITE);
+}
+
+void ChCondition::Signal()
+{
+  WakeConditionVariable(static_cast<CONDITION_VARIABLE*>(m_impl));
+}
+
+void ChCondition::Broadcast()
+{
+  WakeAllConditionVariable(static_cast<CONDITION_VARIABLE*>(m_impl));
+}
+
+static unsigned __stdcall win32_entry(void* arg)
+{
+  ChThreadEntry::Call(arg);
+  return 0;
+}
+
+#else
+
+// -----------------------------------------------------------------------------
+// POSIX threads implementation
+// -----------------------------------------------------------------------------
+ChMutex::ChMutex()
+{
+  pthread_mutex_t* mutex = new pthread_mutex_t;
+  pthread_mutex_init(mutex, 0);
+  m_impl = mutex;
+}
+
+ChMutex::~ChMutex()
+{
+  pthread_mutex_t* mutex = static_cast<pthread_mutex_t*>(m_impl);
+  pthread_mutex_destroy(mutex);
+  delete mutex;
+}
+
+void ChMutex::Lock()
+{
+  pthread_mutex_lock(static_cast<pthread_mutex_t*>(m_impl));
+}
+
+void ChMutex::Unlock()
+{
+  pthread_mutex_unlock(static_cast<pthread_mutex_t*>(m_impl));
+}
+
+ChCondition::ChCondition()
+{
+  pthread_cond_t* cond = new pthread_cond_t;
+  pthread_cond_init(cond, 0);
+  m_impl = cond;
+}
+
+ChCondition::~ChCondition()
+{
+  pthread_cond_t* cond = static_cast<pthread_cond_t*>(m_impl);
+  pthread_cond_destroy(cond);
+  delete cond;
+}
+
+void ChCondition::Wait(ChMutex& mutex)
+{
+  pthread_cond_wait(static_cast<pthread_cond_t*>(m_impl),
+                    static_cast<pthread_mutex_t*>(mutex.m_impl));
+}
+
+void ChCondition::Signal()
+{
+  pthread_cond_signal(static_cast<pthread_cond_t*>(m_impl));
+}
+
+void ChCondition::Broadcast()
+{
+  pthread_cond_broadcast(static_cast<pthread_cond_t*>(m_impl));
+}
+
+static void* posix_entry(void* arg)
+{
+  ChThreadEntry::Call(arg);
+  return 0;
+}
+
+#endif
+
+
+// -----------------------------------------------------------------------------
+// ChThread
+// -----------------------------------------------------------------------------
+ChThread::ChThread()
+: m_impl(0),
+  m_running(false)
+{
+}
+
+ChThread::~ChThread()
+{
+}
+
+bool ChThread::Start()
+{
+  if (m_running)
+    return false;
+
+#ifdef _WIN32
+  uintptr_t handle = _beginthreadex(0, 0, win32_entry, this, 0, 0);
+  if (handle == 0)
+    return false;
+  m_impl = reinterpret_cast<void*>(handle);
+#else
+  pthread_t* thread = new pthread_t;
+  if (pthread_create(thread, 0, posix_entry, this) != 0) {
+    delete thread;
+    return false;
+  }
+  m_impl = thread;
+#endif
+
+  m_running = true;
+  return true;
+}
+
+void ChThread::Join()
+{
+  if (!m_running)
+    return;
+
+#ifdef _WIN32
+  HANDLE handle = reinterpret_cast<HANDLE>(m_impl);
+  WaitForSingleObject(handle, INFINITE);
+  CloseHandle(handle);
+#else
+  pthread_t* thread = static_cast<pthread_t*>(m_impl);
+  pthread_join(*thread, 0);
+  delete thread;
+#endif
+
+  m_impl = 0;
+  m_running = false;
+}
+
+int ChThread::GetNumHardwareThreads()
+{
+  int num = 1;
+
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  num = (int)info.dwNumberOfProcessors;
+#else
+  num = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+  return (num > 0) ? num : 1;
+}
+
+void ChThread::Sleep(double seconds)
+{
+  if (seconds <= 0)
+    return;
+
+#ifdef _WIN32
+  ::Sleep((DWORD)(seconds * 1000));
+#else
+  usleep((useconds_t)(seconds * 1e6));
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// NUMA placement
+// -----------------------------------------------------------------------------
+static CH_THREAD_LOCAL int s_numa_node = -1;
+
+#ifdef __linux__
+
+// Read the list of processors of the specified node (e.g. "0-7,16-23") into
+// the specified set. Returns false if the node does not exist.
+static bool ReadNodeCpus(int node, cpu_set_t& cpus)
+{
+  char path[64];
+  std::sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+  FILE* file = std::fopen(path, "r");
+  if (!file)
+    return false;
+
+  CPU_ZERO(&cpus);
+  int count = 0;
+  int first, last;
+  while (std::fscanf(file, "%d", &first) == 1) {
+    last = first;
+    int c = std::fgetc(file);
+    if (c == '-') {
+      if (std::fscanf(file, "%d", &last) != 1)
+        break;
+      c = std::fgetc(file);
+    }
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++, count++)
+      CPU_SET(cpu, &cpus);
+    if (c != ',')
+      break;
+  }
+
+  std::fclose(file);
+  return count > 0;
+}
+
+#endif
+
+int ChThread::GetNumNumaNodes()
+{
+  int num = 1;
+
+#if defined(_WIN32)
+  ULONG highest = 0;
+  if (GetNumaHighestNodeNumber(&highest))
+    num = (int)highest + 1;
+#elif defined(__linux__)
+  // Nodes without processors (memory only) end the count.
+  cpu_set_t cpus;
+  num = 0;
+  while (ReadNodeCpus(num, cpus))
+    num++;
+#endif
+
+  return (num > 0) ? num : 1;
+}
+
+bool ChThread::PinToNumaNode(int node)
+{
+  bool ok = false;
+
+#if defined(_WIN32)
+  GROUP_AFFINITY affinity;
+  ZeroMemory(&affinity, sizeof(affinity));
+  if (node >= 0 && GetNumaNodeProcessorMaskEx((USHORT)node, &affinity) && affinity.Mask != 0)
+    ok = SetThreadGroupAffinity(GetCurrentThread(), &affinity, 0) != 0;
+#elif defined(__linux__)
+  cpu_set_t cpus;
+  if (node >= 0 && ReadNodeCpus(node, cpus))
+    ok = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#endif
+
+  if (ok)
+    s_numa_node = node;
+
+  return ok;
+}
+
+int ChThread::GetCurrentNumaNode()
+{
+  return s_numa_node;
+}
+
+bool ChThread::PinToCpu(int cpu)
+{
+  if (cpu < 0)
+    return false;
+
+#if defined(_WIN32)
+  if (cpu >= (int)(8 * sizeof(DWORD_PTR)))
+    return false;
+  return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+  if (cpu >= CPU_SETSIZE)
+    return false;
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+  return false;
+#endif
+}
+
+bool ChThread::SetRealtimePriority(int priority)
+{
+#if defined(_WIN32)
+  return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+  int lo = sched_get_priority_min(SCHED_FIFO);
+  int hi = sched_get_priority_max(SCHED_FIFO);
+  sched_param param;
+  param.sched_priority = (priority < lo) ? lo : (priority > hi) ? hi : priority;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+}
+
+
+} // end namespace vehicle
+} // end namespace chrono
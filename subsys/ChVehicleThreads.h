@@ -0,0 +1,240 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Minimal portable threading primitives (POSIX threads or Win32) used by the
+// ChronoVehicle subsystems that perform work in the background.
+//
+// The atomic counter accesses use the GCC/Clang __atomic builtins; with MSVC
+// (x86 and x64 targets), volatile accesses already have acquire and release
+// semantics and only compiler reordering must be prevented.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_THREADS_H
+#define CH_VEHICLE_THREADS_H
+
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "subsys/ChApiSubsys.h"
+
+// Storage class of thread-local variables (of POD types only)
+#if defined(_MSC_VER)
+#define CH_THREAD_LOCAL __declspec(thread)
+#else
+#define CH_THREAD_LOCAL __thread
+#endif
+
+
+namespace chrono {
+namespace vehicle {
+
+///
+/// Read a counter written by another thread (acquire semantics: memory
+/// accesses that follow cannot be moved before the load).
+///
+inline size_t ChAtomicLoad(const volatile size_t* counter)
+{
+#if defined(_MSC_VER)
+  size_t val = *counter;
+  _ReadWriteBarrier();
+  return val;
+#else
+  return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+#endif
+}
+
+///
+/// Write a counter read by another thread (release semantics: memory accesses
+/// that precede cannot be moved after the store).
+///
+inline void ChAtomicStore(volatile size_t* counter, size_t val)
+{
+#if defined(_MSC_VER)
+  _ReadWriteBarrier();
+  *counter = val;
+#else
+  __atomic_store_n(counter, val, __ATOMIC_RELEASE);
+#endif
+}
+
+///
+/// Replace the value of a counter shared with another thread and return its
+/// previous value (acquire and release semantics).
+///
+inline size_t ChAtomicExchange(volatile size_t* counter, size_t val)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+  return (size_t)_InterlockedExchange64((volatile __int64*)counter, (__int64)val);
+#elif defined(_MSC_VER)
+  return (size_t)_InterlockedExchange((volatile long*)counter, (long)val);
+#else
+  return __atomic_exchange_n(counter, val, __ATOMIC_ACQ_REL);
+#endif
+}
+
+///
+/// Increment a counter that may be incremented concurrently by other threads.
+///
+inline void ChAtomicIncrement(volatile long* counter)
+{
+#if defined(_MSC_VER)
+  _InterlockedIncrement(counter);
+#else
+  __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+///
+/// Non-recursive mutex.
+///
+class CH_SUBSYS_API ChMutex
+{
+public:
+  ChMutex();
+  ~ChMutex();
+
+  void Lock();
+  void Unlock();
+
+private:
+  ChMutex(const ChMutex&);
+  ChMutex& operator=(const ChMutex&);
+
+  void* m_impl;
+
+  friend class ChCondition;
+};
+
+///
+/// Lock a mutex for the lifetime of this object.
+///
+class CH_SUBSYS_API ChScopedLock
+{
+public:
+  explicit ChScopedLock(ChMutex& mutex) : m_mutex(mutex) { m_mutex.Lock(); }
+  ~ChScopedLock() { m_mutex.Unlock(); }
+
+private:
+  ChScopedLock(const ChScopedLock&);
+  ChScopedLock& operator=(const ChScopedLock&);
+
+  ChMutex& m_mutex;
+};
+
+///
+/// Condition variable, used in conjunction with a ChMutex.
+///
+class CH_SUBSYS_API ChCondition
+{
+public:
+  ChCondition();
+  ~ChCondition();
+
+  /// Atomically release the (locked) mutex and wait until signaled. The mutex
+  /// is locked again on return. As with any condition variable, spurious
+  /// wake-ups are possible and the caller must re-check its predicate.
+  void Wait(ChMutex& mutex);
+
+  /// Wake up one waiting thread.
+  void Signal();
+
+  /// Wake up all waiting threads.
+  void Broadcast();
+
+private:
+  ChCondition(const ChCondition&);
+  ChCondition& operator=(const ChCondition&);
+
+  void* m_impl;
+};
+
+///
+/// Base class for a thread of execution.
+/// A derived class implements Run(), which is executed in a new thread when
+/// Start() is called.
+///
+class CH_SUBSYS_API ChThread
+{
+public:
+  ChThread();
+
+  /// The destructor does not stop the thread; derived classes must ensure that
+  /// Run() returned and Join() was called before destruction.
+  virtual ~ChThread();
+
+  /// Start executing Run() in a new thread.
+  /// Returns false if the thread could not be created.
+  bool Start();
+
+  /// Wait for Run() to return.
+  void Join();
+
+  /// Return true if the thread was started and not yet joined.
+  bool IsRunning() const { return m_running; }
+
+  /// Return the number of hardware threads available (at least 1).
+  static int GetNumHardwareThreads();
+
+  /// Suspend the calling thread for (at least) the specified time, in seconds.
+  static void Sleep(double seconds);
+
+  /// Return the number of NUMA nodes of the machine (at least 1). Nodes are
+  /// read from /sys/devices/system/node on Linux and from the system on
+  /// Windows; other platforms report a single node.
+  static int GetNumNumaNodes();
+
+  /// Restrict the calling thread to the processors of the specified NUMA
+  /// node. Memory first touched by the thread afterwards is then allocated on
+  /// that node (the default policy of Linux and Windows).
+  /// Returns false if the node does not exist or the affinity cannot be set.
+  static bool PinToNumaNode(int node);
+
+  /// Return the NUMA node the calling thread was pinned to with
+  /// PinToNumaNode(), or -1 if it was not pinned.
+  static int GetCurrentNumaNode();
+
+  /// Restrict the calling thread to the specified processor (Linux and
+  /// Windows). Returns false if the affinity cannot be set.
+  static bool PinToCpu(int cpu);
+
+  /// Run the calling thread with real-time priority: the specified SCHED_FIFO
+  /// priority on POSIX systems (which requires the corresponding privilege,
+  /// e.g. CAP_SYS_NICE on Linux), or the time-critical priority on Windows.
+  /// Returns false if the priority cannot be set.
+  static bool SetRealtimePriority(int priority);
+
+protected:
+  /// Function executed in the new thread.
+  virtual void Run() = 0;
+
+private:
+  ChThread(const ChThread&);
+  ChThread& operator=(const ChThread&);
+
+  void* m_impl;
+  bool  m_running;
+
+  friend struct ChThreadEntry;
+};
+
+
+} // end namespace vehicle
+} // end namespace chrono
+
+
+#endif
@@ -30,6 +30,7 @@
 #include "physics/ChBody.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysHeap.h"
 
 namespace chrono {
 
@@ -48,6 +49,10 @@ public:
   ChWheel() {}
   virtual ~ChWheel() {}
 
+  /// Allocate subsystem objects from the contiguous subsystem heap.
+  static void* operator new(size_t size) { return vehicle::ChSubsysHeap::Allocate(size); }
+  static void operator delete(void* ptr) { vehicle::ChSubsysHeap::Free(ptr); }
+
   /// Get the wheel mass.
   virtual double GetMass() const = 0;
 
@@ -17,8 +17,7 @@
 // =============================================================================
 
 #include "subsys/brake/BrakeSimple.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
 
 using namespace rapidjson;
 
@@ -29,15 +28,7 @@ namespace chrono {
 // -----------------------------------------------------------------------------
 BrakeSimple::BrakeSimple(const std::string& filename)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
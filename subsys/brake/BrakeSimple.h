@@ -20,6 +20,7 @@
 #define BRAKE_SIMPLE_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/brake/ChBrakeSimple.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API BrakeSimple : public ChBrakeSimple
+class CH_SUBSYS_API BrakeSimple : public ChBrakeSimple, public vehicle::ChReloadable
 {
 public:
 
@@ -37,6 +38,10 @@ public:
 
   virtual double GetMaxBrakingTorque() { return m_maxtorque; }
 
+  /// Apply the maximum braking torque of the specified document (see
+  /// ChHotReload). Always applies in place.
+  virtual bool Reload(const rapidjson::Document& d) { Create(d); return true; }
+
 private:
 
   void Create(const rapidjson::Document& d);
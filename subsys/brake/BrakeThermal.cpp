@@ -0,0 +1,74 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thermal brake model template using data from file (JSON format).
+//
+// =============================================================================
+
+#include "subsys/brake/BrakeThermal.h"
+#include "subsys/ChJsonCache.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+BrakeThermal::BrakeThermal(const std::string& filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  Create(d);
+}
+
+BrakeThermal::BrakeThermal(const rapidjson::Document& d)
+{
+  Create(d);
+}
+
+void BrakeThermal::Create(const rapidjson::Document& d)
+{
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  // Read maximum braking torque (at ambient temperature)
+  m_maxtorque = d["Maximum Torque"].GetDouble();
+
+  // Read thermal data
+  m_heat_capacity = d["Heat Capacity"].GetDouble();
+  m_cooling = d["Cooling Coefficient"].GetDouble();
+
+  // Read the pad friction map, as (temperature, friction coefficient) pairs
+  assert(d.HasMember("Pad Friction Map"));
+  const Value& map = d["Pad Friction Map"];
+  assert(map.IsArray() && map.Size() > 0);
+
+  for (SizeType i = 0; i < map.Size(); i++)
+    m_pad_friction.push_back(std::make_pair(map[i][0u].GetDouble(), map[i][1u].GetDouble()));
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void BrakeThermal::SetPadFrictionMap(ChSharedPtr<ChFunction_Recorder>& map)
+{
+  for (size_t i = 0; i < m_pad_friction.size(); i++)
+    map->AddPoint(m_pad_friction[i].first, m_pad_friction[i].second);
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,62 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thermal brake model template using data from file (JSON format).
+//
+// =============================================================================
+
+#ifndef BRAKE_THERMAL_H
+#define BRAKE_THERMAL_H
+
+#include <utility>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/brake/ChBrakeThermal.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+
+class CH_SUBSYS_API BrakeThermal : public ChBrakeThermal
+{
+public:
+
+  BrakeThermal(const std::string& filename);
+  BrakeThermal(const rapidjson::Document& d);
+  ~BrakeThermal() {}
+
+  virtual double GetMaxBrakingTorque() { return m_maxtorque; }
+  virtual double GetHeatCapacity() { return m_heat_capacity; }
+  virtual double GetCoolingCoefficient() { return m_cooling; }
+
+  virtual void SetPadFrictionMap(ChSharedPtr<ChFunction_Recorder>& map);
+
+private:
+
+  void Create(const rapidjson::Document& d);
+
+  double      m_maxtorque;
+  double      m_heat_capacity;
+  double      m_cooling;
+
+  std::vector<std::pair<double, double> > m_pad_friction;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,148 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched wheel brakes with thermal fade.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/brake/ChBrakeBank.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChBrakeBank::ChBrakeBank()
+: m_ambient(20),
+  m_last_time(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// The spindle is the first body and the carrier the second body of the wheel
+// revolute joint (see the suspension templates).
+// -----------------------------------------------------------------------------
+int ChBrakeBank::AddBrake(ChSharedPtr<ChLinkLockRevolute> hub,
+                          double                          max_torque,
+                          ChFunction*                     pad_friction,
+                          double                          heat_capacity,
+                          double                          cooling)
+{
+  assert(pad_friction);
+  assert(heat_capacity > 0);
+
+  double friction = pad_friction->Get_y(m_ambient);
+  assert(friction > 0);
+
+  if (m_hubs.empty())
+    m_last_time = hub->GetSystem()->GetChTime();
+
+  m_hubs.push_back(hub.get_ptr());
+  m_spindles.push_back(dynamic_cast<ChBody*>(hub->GetBody1()));
+  m_carriers.push_back(dynamic_cast<ChBody*>(hub->GetBody2()));
+
+  ChVector<> axis = hub->GetMarker2()->GetAbsCoord().rot.GetZaxis();
+  m_axes.push_back(m_spindles.back()->TransformDirectionParentToLocal(axis));
+  m_pad_friction.push_back(pad_friction);
+
+  m_max_torque.push_back(max_torque / friction);
+  m_heat_capacity.push_back(heat_capacity);
+  m_cooling.push_back(cooling);
+
+  m_modulation.push_back(0);
+  m_temperature.push_back(m_ambient);
+  m_friction.push_back(friction);
+  m_speed.push_back(0);
+  m_torque.push_back(0);
+
+  return (int)m_hubs.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// The carrier force accumulators are emptied in a first pass, since a carrier
+// may be shared by the two brakes of an axle (e.g. a solid axle).
+// The torque limit uses the spindle inertia about the joint axis (which
+// includes the wheel inertia) and the last step size; no torque is applied at
+// the first update.
+// -----------------------------------------------------------------------------
+void ChBrakeBank::Update(double time)
+{
+  double step = std::max(time - m_last_time, 0.0);
+  m_last_time = time;
+
+  int n = (int)m_hubs.size();
+
+  for (int i = 0; i < n; i++)
+    m_carriers[i]->Empty_forces_accumulators();
+
+  for (int i = 0; i < n; i++) {
+    // Relative angular speed of the spindle about the joint axis.
+    double speed = m_hubs[i]->GetRelWvel().z;
+    ChVector<> axis = m_hubs[i]->GetMarker2()->GetAbsCoord().rot.GetZaxis();
+
+    double friction = m_pad_friction[i]->Get_y(m_temperature[i]);
+    double torque = m_modulation[i] * m_max_torque[i] * friction;
+
+    double limit = 0;
+    if (step > 0) {
+      const ChVector<>& a = m_axes[i];
+      double inertia = Vdot(a, m_spindles[i]->GetInertia().Matr_x_Vect(a));
+      limit = inertia * std::abs(speed) / step;
+    }
+    double applied = (speed > 0) ? -std::min(torque, limit) : std::min(torque, limit);
+
+    m_spindles[i]->Accumulate_torque(applied * axis, false);
+    m_carriers[i]->Accumulate_torque(-applied * axis, false);
+
+    // Advance the temperature, with implicit cooling.
+    double power = -applied * speed;
+    double c = m_heat_capacity[i];
+    double h = m_cooling[i];
+    m_temperature[i] = (c * m_temperature[i] + step * (power + h * m_ambient)) / (c + step * h);
+
+    m_speed[i] = speed;
+    m_friction[i] = friction;
+    m_torque[i] = std::abs(applied);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChBrakeBank::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  size_t bytes = sizeof(*this) +
+                 vehicle::ChMemoryReport::VectorBytes(m_hubs) +
+                 vehicle::ChMemoryReport::VectorBytes(m_spindles) +
+                 vehicle::ChMemoryReport::VectorBytes(m_carriers) +
+                 vehicle::ChMemoryReport::VectorBytes(m_axes) +
+                 vehicle::ChMemoryReport::VectorBytes(m_pad_friction) +
+                 vehicle::ChMemoryReport::VectorBytes(m_max_torque) +
+                 vehicle::ChMemoryReport::VectorBytes(m_heat_capacity) +
+                 vehicle::ChMemoryReport::VectorBytes(m_cooling) +
+                 vehicle::ChMemoryReport::VectorBytes(m_modulation) +
+                 vehicle::ChMemoryReport::VectorBytes(m_temperature) +
+                 vehicle::ChMemoryReport::VectorBytes(m_friction) +
+                 vehicle::ChMemoryReport::VectorBytes(m_speed) +
+                 vehicle::ChMemoryReport::VectorBytes(m_torque);
+  report.Add("vehicle/banks", bytes);
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,135 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched wheel brakes with thermal fade.
+//
+// A brake bank holds the state of all wheel brakes of a vehicle in contiguous
+// arrays and updates them in a single call, once per step, after the tire
+// forces were applied to the spindles. No links are added to the system: the
+// brake torque is applied directly to the spindle body and its reaction to the
+// carrier body (upright or axle tube) of the wheel revolute joint.
+//
+// For each brake, the torque opposes the relative rotation of the spindle and
+// has the magnitude
+//
+//   modulation * max_torque * mu(T) / mu(T_ambient)
+//
+// where mu(T) is the pad friction coefficient at the brake temperature T
+// (so that max_torque is the maximum torque of a cold brake). Since the torque
+// is applied explicitly, it is limited to the torque that stops the relative
+// rotation of the spindle over one step; a braked wheel at rest thus only
+// creeps under an applied drive torque. The temperature obeys
+//
+//   C dT/dt = P - h (T - T_ambient)
+//
+// with P the dissipated power, C the heat capacity and h the cooling
+// coefficient of the brake; it is integrated with an implicit cooling term.
+//
+// =============================================================================
+
+#ifndef CH_BRAKEBANK_H
+#define CH_BRAKEBANK_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "motion_functions/ChFunction.h"
+#include "physics/ChLinkLock.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMemoryReport.h"
+
+namespace chrono {
+
+///
+/// Batched wheel brakes of one vehicle.
+///
+class CH_SUBSYS_API ChBrakeBank : public ChShared
+{
+public:
+
+  ChBrakeBank();
+  ~ChBrakeBank() {}
+
+  /// Set the ambient temperature (default: 20). This is also the initial
+  /// temperature of the brakes added afterwards.
+  void SetAmbientTemperature(double temperature) { m_ambient = temperature; }
+  double GetAmbientTemperature() const { return m_ambient; }
+
+  /// Add a brake acting on the specified wheel revolute joint and return its
+  /// index in the bank. The pad friction function must outlive the bank.
+  int AddBrake(
+    ChSharedPtr<ChLinkLockRevolute> hub,             ///< [in] wheel revolute joint (spindle, carrier)
+    double                          max_torque,      ///< [in] maximum torque at ambient temperature
+    ChFunction*                     pad_friction,    ///< [in] pad friction as function of temperature
+    double                          heat_capacity,   ///< [in] heat capacity of the brake
+    double                          cooling          ///< [in] cooling coefficient
+    );
+
+  /// Return the number of brakes in this bank.
+  int GetNumBrakes() const { return (int)m_hubs.size(); }
+
+  /// Set the modulation [0,1] of the specified brake.
+  void SetModulation(int index, double modulation) { m_modulation[index] = modulation; }
+
+  /// Update all brakes at the specified time: compute the brake torques, apply
+  /// them to the spindle and carrier bodies and advance the temperatures over
+  /// the time elapsed since the previous update.
+  /// This must be called after the tire forces were applied to the spindles.
+  void Update(double time);
+
+  /// Return the current torque magnitude of the specified brake.
+  double GetBrakeTorque(int index) const { return m_torque[index]; }
+
+  /// Return the current temperature of the specified brake.
+  double GetTemperature(int index) const { return m_temperature[index]; }
+
+  /// Return the current pad friction coefficient of the specified brake.
+  double GetPadFriction(int index) const { return m_friction[index]; }
+
+  /// Return the current angular speed of the specified brake, relative between
+  /// disc and caliper.
+  double GetBrakeSpeed(int index) const { return m_speed[index]; }
+
+  /// Add the memory footprint of the bank to the specified report (the pad
+  /// friction functions are not included).
+  void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+private:
+
+  double                            m_ambient;
+  double                            m_last_time;
+
+  std::vector<ChLinkLockRevolute*>  m_hubs;
+  std::vector<ChBody*>              m_spindles;
+  std::vector<ChBody*>              m_carriers;
+  std::vector<ChVector<> >          m_axes;            // joint axis, in spindle frame
+  std::vector<ChFunction*>          m_pad_friction;
+
+  std::vector<double>               m_max_torque;      // already divided by mu(T_ambient)
+  std::vector<double>               m_heat_capacity;
+  std::vector<double>               m_cooling;
+
+  std::vector<double>               m_modulation;
+  std::vector<double>               m_temperature;
+  std::vector<double>               m_friction;
+  std::vector<double>               m_speed;
+  std::vector<double>               m_torque;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -49,7 +49,7 @@ public:
   virtual double GetBrakeTorque() { return m_modulation * GetMaxBrakingTorque(); }
 
   /// Get the current brake angular speed, relative between disc and caliper [rad/s]
-  double GetBrakeSpeed() { return m_brake->GetRelWvel().Length(); }
+  virtual double GetBrakeSpeed() { return m_brake->GetRelWvel().Length(); }
 
 protected:
 
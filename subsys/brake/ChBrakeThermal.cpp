@@ -0,0 +1,52 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Wheel brake with thermal fade, evaluated in a brake bank.
+//
+// =============================================================================
+
+#include <cassert>
+
+#include "subsys/brake/ChBrakeThermal.h"
+
+
+namespace chrono {
+
+
+ChBrakeThermal::ChBrakeThermal()
+: m_index(-1)
+{
+}
+
+// -----------------------------------------------------------------------------
+// The pad friction map is tabulated on a uniform grid, so that its evaluation
+// in the bank update does not depend on the number of map points.
+// -----------------------------------------------------------------------------
+void ChBrakeThermal::Initialize(ChSharedPtr<ChLinkLockRevolute> hub)
+{
+  assert(!m_bank.IsNull());
+
+  ChSharedPtr<ChFunction_Recorder> map(new ChFunction_Recorder);
+  SetPadFrictionMap(map);
+  m_pad_friction = ChSharedPtr<ChFunction_Tabulated>(new ChFunction_Tabulated(*map, 200));
+
+  m_index = m_bank->AddBrake(hub,
+                             GetMaxBrakingTorque(),
+                             m_pad_friction.get_ptr(),
+                             GetHeatCapacity(),
+                             GetCoolingCoefficient());
+}
+
+
+}  // end namespace chrono
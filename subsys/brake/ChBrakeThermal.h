@@ -0,0 +1,90 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Wheel brake with thermal fade, evaluated in a brake bank.
+//
+// This brake does not add a ChLinkBrake to the system. It registers itself with
+// the brake bank of the vehicle (see ChBrakeBank), which holds its state and
+// computes and applies its torque, together with those of the other brakes of
+// the vehicle, in ChBrakeBank::Update(). The brake modulation is only stored
+// by ApplyBrakeModulation(); it takes effect at the next bank update.
+//
+// =============================================================================
+
+#ifndef CH_BRAKETHERMAL_H
+#define CH_BRAKETHERMAL_H
+
+#include "motion_functions/ChFunction_Recorder.h"
+
+#include "subsys/ChBrake.h"
+#include "subsys/brake/ChBrakeBank.h"
+#include "subsys/powertrain/ChFunction_Tabulated.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API ChBrakeThermal : public ChBrake {
+public:
+
+  ChBrakeThermal();
+  virtual ~ChBrakeThermal() {}
+
+  /// Set the brake bank in which this brake is evaluated.
+  /// Must be called before Initialize().
+  void SetBrakeBank(ChSharedPtr<ChBrakeBank> bank) { m_bank = bank; }
+  ChSharedPtr<ChBrakeBank> GetBrakeBank() const { return m_bank; }
+
+  /// Initialize the brake by providing the wheel's revolute link.
+  /// This adds the brake to its brake bank.
+  virtual void Initialize(ChSharedPtr<ChLinkLockRevolute> hub);
+
+  /// Set the brake modulation, in 0..1 range.
+  virtual void ApplyBrakeModulation(double modulation) { m_bank->SetModulation(m_index, modulation); }
+
+  /// Get the current brake torque, as computed at the last bank update.
+  virtual double GetBrakeTorque() { return m_bank->GetBrakeTorque(m_index); }
+
+  /// Get the current brake temperature.
+  double GetTemperature() const { return m_bank->GetTemperature(m_index); }
+
+  /// Get the current brake angular speed, relative between disc and caliper [rad/s]
+  virtual double GetBrakeSpeed() { return m_bank->GetBrakeSpeed(m_index); }
+
+protected:
+
+  /// Get the max braking torque (for modulation = 1), at ambient temperature.
+  virtual double GetMaxBrakingTorque() = 0;
+
+  /// Pad friction coefficient as function of the brake temperature.
+  virtual void SetPadFrictionMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
+
+  /// Get the heat capacity of the brake (disc and pads).
+  virtual double GetHeatCapacity() = 0;
+
+  /// Get the cooling coefficient, i.e. the heat flow to the ambient per degree
+  /// of temperature difference.
+  virtual double GetCoolingCoefficient() = 0;
+
+  ChSharedPtr<ChBrakeBank>           m_bank;
+  int                                m_index;
+
+private:
+
+  ChSharedPtr<ChFunction_Tabulated>  m_pad_friction;
+};
+
+
+} // end namespace chrono
+
+
+#endif
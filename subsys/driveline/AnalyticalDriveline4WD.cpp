@@ -0,0 +1,105 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Analytical 4WD driveline model template using data from file (JSON format).
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+
+#include "subsys/driveline/AnalyticalDriveline4WD.h"
+#include "subsys/ChJsonCache.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+AnalyticalDriveline4WD::AnalyticalDriveline4WD(const std::string& filename)
+: ChAnalyticalDriveline4WD(),
+  m_torque_lag(0)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  Create(d);
+}
+
+AnalyticalDriveline4WD::AnalyticalDriveline4WD(const rapidjson::Document& d)
+: ChAnalyticalDriveline4WD(),
+  m_torque_lag(0)
+{
+  Create(d);
+}
+
+void AnalyticalDriveline4WD::Create(const rapidjson::Document& d)
+{
+  // Read top-level data.
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  m_front_torque_frac = d["Front Torque Fraction"].GetDouble();
+
+  // Read conical gear ratios.
+  assert(d.HasMember("Gear Ratio"));
+
+  m_front_conicalgear_ratio = d["Gear Ratio"]["Front Conical Gear"].GetDouble();
+  m_rear_conicalgear_ratio = d["Gear Ratio"]["Rear Conical Gear"].GetDouble();
+
+  // Read differential data.
+  m_central_differential = readDifferential(d["Central Differential"]);
+  m_front_differential = readDifferential(d["Front Differential"]);
+  m_rear_differential = readDifferential(d["Rear Differential"]);
+
+  if (d.HasMember("Torque Lag Time Constant"))
+    m_torque_lag = d["Torque Lag Time Constant"].GetDouble();
+}
+
+// -----------------------------------------------------------------------------
+// A differential is specified by its "Type" (one of "Open", "Locked", or
+// "LimitedSlip"), its "Locking Coefficient" (not needed for an open
+// differential) and its "Max Bias" (only needed for a limited-slip
+// differential).
+// -----------------------------------------------------------------------------
+ChAnalyticalDriveline4WD::Differential AnalyticalDriveline4WD::readDifferential(const rapidjson::Value& v)
+{
+  assert(v.IsObject());
+  assert(v.HasMember("Type"));
+
+  Differential diff;
+  std::string type = v["Type"].GetString();
+
+  if (type.compare("Open") == 0) {
+    diff.type = OPEN;
+  } else if (type.compare("Locked") == 0) {
+    diff.type = LOCKED;
+  } else if (type.compare("LimitedSlip") == 0) {
+    diff.type = LIMITED_SLIP;
+  } else {
+    GetLog() << "ERROR: unknown differential type '" << type.c_str() << "'; using an open differential\n";
+    diff.type = OPEN;
+  }
+
+  if (diff.type != OPEN)
+    diff.locking_coefficient = v["Locking Coefficient"].GetDouble();
+  if (diff.type == LIMITED_SLIP)
+    diff.max_bias = v["Max Bias"].GetDouble();
+
+  return diff;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,70 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Analytical 4WD driveline model template using data from file (JSON format).
+//
+// =============================================================================
+
+#ifndef ANALYTICAL_DRIVELINE_4WD_H
+#define ANALYTICAL_DRIVELINE_4WD_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/driveline/ChAnalyticalDriveline4WD.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+
+class CH_SUBSYS_API AnalyticalDriveline4WD : public ChAnalyticalDriveline4WD
+{
+public:
+
+  AnalyticalDriveline4WD(const std::string& filename);
+  AnalyticalDriveline4WD(const rapidjson::Document& d);
+  ~AnalyticalDriveline4WD() {}
+
+  virtual double GetFrontTorqueFraction() const   { return m_front_torque_frac; }
+
+  virtual double GetFrontConicalGearRatio() const { return m_front_conicalgear_ratio; }
+  virtual double GetRearConicalGearRatio() const  { return m_rear_conicalgear_ratio; }
+
+  virtual Differential GetCentralDifferential() const { return m_central_differential; }
+  virtual Differential GetFrontDifferential() const   { return m_front_differential; }
+  virtual Differential GetRearDifferential() const    { return m_rear_differential; }
+
+  virtual double GetTorqueLagTimeConstant() const { return m_torque_lag; }
+
+private:
+  void Create(const rapidjson::Document& d);
+
+  static Differential readDifferential(const rapidjson::Value& v);
+
+  double        m_front_torque_frac;
+
+  double        m_front_conicalgear_ratio;
+  double        m_rear_conicalgear_ratio;
+
+  Differential  m_central_differential;
+  Differential  m_front_differential;
+  Differential  m_rear_differential;
+
+  double        m_torque_lag;
+};
+
+
+} // end namespace chrono
+
+
+#endif
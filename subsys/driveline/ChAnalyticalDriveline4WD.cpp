@@ -0,0 +1,190 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Analytical 4WD driveline model template, with open, locked, or limited-slip
+// central, front and rear differentials.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/driveline/ChAnalyticalDriveline4WD.h"
+#include "subsys/ChStartupProfiler.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChAnalyticalDriveline4WD::ChAnalyticalDriveline4WD()
+: ChDriveline(),
+  m_system(0),
+  m_front_fraction(0.5),
+  m_front_ratio(1),
+  m_rear_ratio(1),
+  m_lag(0),
+  m_last_time(0)
+{
+  for (int i = 0; i < 4; i++)
+    m_torques[i] = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Initialize the driveline subsystem.
+// This function connects this driveline subsystem to the axles of the specified
+// suspension subsystems. The model parameters are cached here, so that no
+// virtual calls are made during the simulation.
+// -----------------------------------------------------------------------------
+void ChAnalyticalDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
+                                          const ChSuspensionList& suspensions,
+                                          const std::vector<int>& driven_axles)
+{
+  CH_STARTUP_SCOPE("ChAnalyticalDriveline4WD::Initialize");
+
+  assert(suspensions.size() >= 2);
+  assert(driven_axles.size() == 2);
+
+  m_driven_axles = driven_axles;
+  m_system = chassis->GetSystem();
+
+  // Grab handles to the suspension wheel shafts.
+  m_axles[0] = suspensions[m_driven_axles[0]]->GetAxle(LEFT);
+  m_axles[1] = suspensions[m_driven_axles[0]]->GetAxle(RIGHT);
+  m_axles[2] = suspensions[m_driven_axles[1]]->GetAxle(LEFT);
+  m_axles[3] = suspensions[m_driven_axles[1]]->GetAxle(RIGHT);
+
+  m_front_fraction = GetFrontTorqueFraction();
+  m_front_ratio = GetFrontConicalGearRatio();
+  m_rear_ratio = GetRearConicalGearRatio();
+  m_central = GetCentralDifferential();
+  m_front = GetFrontDifferential();
+  m_rear = GetRearDifferential();
+  m_lag = GetTorqueLagTimeConstant();
+
+  assert(m_front_fraction >= 0 && m_front_fraction <= 1);
+  assert(m_front_ratio != 0 && m_rear_ratio != 0);
+
+  for (int i = 0; i < 4; i++)
+    m_torques[i] = 0;
+  m_last_time = m_system->GetChTime();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChAnalyticalDriveline4WD::GetDriveshaftSpeed() const
+{
+  double speed_front = 0.5 * (m_axles[0]->GetPos_dt() + m_axles[1]->GetPos_dt());
+  double speed_rear  = 0.5 * (m_axles[2]->GetPos_dt() + m_axles[3]->GetPos_dt());
+
+  return m_front_fraction * speed_front / m_front_ratio +
+         (1 - m_front_fraction) * speed_rear / m_rear_ratio;
+}
+
+// -----------------------------------------------------------------------------
+// Split the specified torque between two outputs. The open differential gives
+// 'fraction' of the torque to the first output. The locking torque is
+// subtracted from the faster output (speeds and torques are measured in the
+// same convention) and, for a limited-slip differential, is limited such that
+// the ratio of the output torques does not exceed max_bias.
+// -----------------------------------------------------------------------------
+void ChAnalyticalDriveline4WD::differentialSplit(const Differential& diff,
+                                                 double              torque,
+                                                 double              fraction,
+                                                 double              speed_1,
+                                                 double              speed_2,
+                                                 double&             torque_1,
+                                                 double&             torque_2)
+{
+  torque_1 = fraction * torque;
+
+  if (diff.type != OPEN) {
+    double locking = diff.locking_coefficient * (speed_1 - speed_2);
+
+    if (diff.type == LIMITED_SLIP) {
+      double max_locking = std::min(fraction, 1 - fraction) * std::abs(torque) *
+                           (diff.max_bias - 1) / (diff.max_bias + 1);
+      locking = std::min(std::max(locking, -max_locking), max_locking);
+    }
+
+    torque_1 -= locking;
+  }
+
+  torque_2 = torque - torque_1;
+}
+
+// -----------------------------------------------------------------------------
+// The central differential acts on the front and rear axle torques, i.e. on the
+// driveshaft torque amplified by the conical gears.
+// -----------------------------------------------------------------------------
+void ChAnalyticalDriveline4WD::ApplyDriveshaftTorque(double torque)
+{
+  double speeds[4];
+  for (int i = 0; i < 4; i++)
+    speeds[i] = m_axles[i]->GetPos_dt();
+
+  double front = m_front_fraction / m_front_ratio;
+  double rear = (1 - m_front_fraction) / m_rear_ratio;
+  double fraction = (front + rear != 0) ? front / (front + rear) : 0.5;
+
+  double torque_front;
+  double torque_rear;
+  differentialSplit(m_central, torque * (front + rear), fraction,
+                    0.5 * (speeds[0] + speeds[1]), 0.5 * (speeds[2] + speeds[3]),
+                    torque_front, torque_rear);
+
+  double target[4];
+  differentialSplit(m_front, torque_front, 0.5, speeds[0], speeds[1], target[0], target[1]);
+  differentialSplit(m_rear, torque_rear, 0.5, speeds[2], speeds[3], target[2], target[3]);
+
+  // First-order lag, integrated with implicit Euler over the time elapsed since
+  // the last call (unconditionally stable for any step).
+  double time = m_system->GetChTime();
+  double step = time - m_last_time;
+  m_last_time = time;
+
+  double alpha = 1;
+  if (m_lag > 0)
+    alpha = (step > 0) ? step / (m_lag + step) : 0;
+
+  for (int i = 0; i < 4; i++) {
+    m_torques[i] += alpha * (target[i] - m_torques[i]);
+    m_axles[i]->SetAppliedTorque(m_torques[i]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChAnalyticalDriveline4WD::GetWheelTorque(const ChWheelID& wheel_id) const
+{
+  if (wheel_id.axle() == m_driven_axles[0]) {
+    switch (wheel_id.side()) {
+    case LEFT:  return -m_torques[0];
+    case RIGHT: return -m_torques[1];
+    }
+  } else if (wheel_id.axle() == m_driven_axles[1]) {
+    switch (wheel_id.side()) {
+    case LEFT:  return -m_torques[2];
+    case RIGHT: return -m_torques[3];
+    }
+  }
+
+  return 0;
+}
+
+
+} // end namespace chrono
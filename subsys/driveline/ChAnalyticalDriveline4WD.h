@@ -0,0 +1,147 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Analytical 4WD driveline model template.
+//
+// Unlike ChShaftsDriveline4WD, this template does not add any shafts or
+// constraints to the system. The driveshaft torque is distributed to the axle
+// shafts of the two driven suspensions by algebraic laws for the central, front
+// and rear differentials, each of which can be open, locked, or limited-slip:
+//
+//   OPEN          the torque is split in a fixed ratio (the front torque
+//                 fraction for the central differential, 1:1 for the axle
+//                 differentials), regardless of the output speeds.
+//   LOCKED        a locking torque, proportional to the difference of the
+//                 output speeds, is transferred from the faster to the slower
+//                 output.
+//   LIMITED_SLIP  as LOCKED, but the locking torque is limited such that the
+//                 ratio of the output torques does not exceed the torque bias
+//                 ratio (Torsen differential).
+//
+// The speed differences of the central differential are measured at the wheels
+// (average speeds of the front and rear axle shafts).
+//
+// The resulting axle torques can optionally be passed through a first-order
+// lag, to approximate the compliance of the driveline shafts.
+//
+// =============================================================================
+
+#ifndef CH_ANALYTICAL_DRIVELINE_4WD_H
+#define CH_ANALYTICAL_DRIVELINE_4WD_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriveline.h"
+
+namespace chrono {
+
+///
+/// Analytical 4WD driveline model template, with no shafts.
+///
+class CH_SUBSYS_API ChAnalyticalDriveline4WD : public ChDriveline
+{
+public:
+
+  enum DifferentialType {
+    OPEN,
+    LOCKED,
+    LIMITED_SLIP
+  };
+
+  /// Parameters of one differential.
+  struct Differential {
+    Differential(DifferentialType t = OPEN, double k = 0, double bias = 1)
+      : type(t), locking_coefficient(k), max_bias(bias) {}
+
+    DifferentialType type;
+    double locking_coefficient;   ///< locking torque per unit speed difference (LOCKED, LIMITED_SLIP)
+    double max_bias;              ///< torque bias ratio (LIMITED_SLIP)
+  };
+
+  ChAnalyticalDriveline4WD();
+  ~ChAnalyticalDriveline4WD() {}
+
+  /// Return the number of driven axles.
+  virtual int GetNumDrivenAxles() const { return 2; }
+
+  /// Initialize the driveline subsystem.
+  /// This function connects this driveline subsystem to the axles of the
+  /// specified suspension subsystems.
+  virtual void Initialize(
+    ChSharedPtr<ChBody>     chassis,     ///< handle to the chassis body
+    const ChSuspensionList& suspensions, ///< list of all vehicle suspension subsystems
+    const std::vector<int>& driven_axles ///< indexes of the driven vehicle axles
+    );
+
+  /// Get the angular speed of the driveshaft.
+  /// This is the front/rear weighted average of the axle speeds, reduced to the
+  /// driveshaft through the conical gear ratios.
+  virtual double GetDriveshaftSpeed() const;
+
+  /// Apply the specified motor torque.
+  /// This distributes the torque to the axle shafts of the driven suspensions.
+  virtual void ApplyDriveshaftTorque(double torque);
+
+  /// Get the motor torque to be applied to the specified wheel.
+  virtual double GetWheelTorque(const ChWheelID& wheel_id) const;
+
+protected:
+
+  /// Return the front torque fraction [0,1] of the central differential.
+  virtual double GetFrontTorqueFraction() const = 0;
+
+  /// Return the transmission ratios of the front and rear conical gears, i.e.
+  /// the ratios between the differential box speed and the driveshaft speed.
+  virtual double GetFrontConicalGearRatio() const = 0;
+  virtual double GetRearConicalGearRatio() const = 0;
+
+  /// Return the parameters of the central, front and rear differentials.
+  virtual Differential GetCentralDifferential() const = 0;
+  virtual Differential GetFrontDifferential() const = 0;
+  virtual Differential GetRearDifferential() const = 0;
+
+  /// Return the time constant of the first-order lag of the axle torques.
+  /// A value of zero (default) disables the lag.
+  virtual double GetTorqueLagTimeConstant() const { return 0; }
+
+private:
+
+  static void differentialSplit(const Differential& diff,
+                                double              torque,
+                                double              fraction,
+                                double              speed_1,
+                                double              speed_2,
+                                double&             torque_1,
+                                double&             torque_2);
+
+  ChSystem*              m_system;
+
+  ChSharedPtr<ChShaft>   m_axles[4];     // front left, front right, rear left, rear right
+  double                 m_torques[4];   // torques applied to the axle shafts
+
+  double                 m_front_fraction;
+  double                 m_front_ratio;
+  double                 m_rear_ratio;
+  Differential           m_central;
+  Differential           m_front;
+  Differential           m_rear;
+  double                 m_lag;
+
+  double                 m_last_time;
+};
+
+
+} // end namespace chrono
+
+
+#endif
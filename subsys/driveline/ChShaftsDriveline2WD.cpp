@@ -20,6 +20,7 @@
 #include "physics/ChSystem.h"
 
 #include "subsys/driveline/ChShaftsDriveline2WD.h"
+#include "subsys/ChStartupProfiler.h"
 
 namespace chrono {
 
@@ -35,10 +36,18 @@ namespace chrono {
 ChShaftsDriveline2WD::ChShaftsDriveline2WD()
 : ChDriveline(),
   m_dir_motor_block(ChVector<>(1, 0, 0)),
-  m_dir_axle(ChVector<>(0, 1, 0))
+  m_dir_axle(ChVector<>(0, 1, 0)),
+  m_partitioned(false),
+  m_num_substeps(10)
 {
 }
 
+void ChShaftsDriveline2WD::SetPartitioned(bool val, int num_substeps)
+{
+  m_partitioned = val;
+  m_num_substeps = num_substeps;
+}
+
 // -----------------------------------------------------------------------------
 // Initialize the driveline subsystem.
 // This function connects this driveline subsystem to the axles of the specified
@@ -48,6 +57,8 @@ void ChShaftsDriveline2WD::Initialize(ChSharedPtr<ChBody>     chassis,
                                       const ChSuspensionList& suspensions,
                                       const std::vector<int>& driven_axles)
 {
+  CH_STARTUP_SCOPE("ChShaftsDriveline2WD::Initialize");
+
   assert(suspensions.size() >= 1);
   assert(driven_axles.size() == 1);
 
@@ -60,12 +71,27 @@ void ChShaftsDriveline2WD::Initialize(ChSharedPtr<ChBody>     chassis,
   // represents the connection of the driveline to the transmission box.
   m_driveshaft = ChSharedPtr<ChShaft>(new ChShaft);
   m_driveshaft->SetInertia(GetDriveshaftInertia());
-  my_system->Add(m_driveshaft);
 
   // Create a 1 d.o.f. object: a 'shaft' with rotational inertia.
   // This represents the inertia of the rotating box of the differential.
   m_differentialbox = ChSharedPtr<ChShaft>(new ChShaft);
   m_differentialbox->SetInertia(GetDifferentialBoxInertia());
+
+  // In a partitioned driveline, the conical gear and the differential are
+  // solved by the shaft network, coupled to the axles of the suspension.
+  if (m_partitioned) {
+    m_network = ChSharedPtr<vehicle::ChShaftNetwork>(new vehicle::ChShaftNetwork);
+    m_network->SetNumSubsteps(m_num_substeps);
+    int driveshaft = m_network->AddShaft(m_driveshaft);
+    int box = m_network->AddShaft(m_differentialbox);
+    m_net_axles[LEFT] = m_network->AddBoundaryShaft(suspensions[m_driven_axles[0]]->GetAxle(LEFT));
+    m_net_axles[RIGHT] = m_network->AddBoundaryShaft(suspensions[m_driven_axles[0]]->GetAxle(RIGHT));
+    m_network->AddGear(driveshaft, box, GetConicalGearRatio());
+    m_network->AddPlanetary(box, m_net_axles[LEFT], m_net_axles[RIGHT], GetDifferentialRatio());
+    return;
+  }
+
+  my_system->Add(m_driveshaft);
   my_system->Add(m_differentialbox);
 
   // Create an angled gearbox, i.e a transmission ratio constraint between two
@@ -101,6 +127,8 @@ void ChShaftsDriveline2WD::Initialize(ChSharedPtr<ChBody>     chassis,
 double ChShaftsDriveline2WD::GetWheelTorque(const ChWheelID& wheel_id) const
 {
   if (wheel_id.axle() == m_driven_axles[0]) {
+    if (!m_network.IsNull())
+      return m_network->GetShaftTorque(m_net_axles[wheel_id.side()]);
     switch (wheel_id.side()) {
     case LEFT:  return -m_differential->GetTorqueReactionOn2();
     case RIGHT: return -m_differential->GetTorqueReactionOn3();
@@ -56,6 +56,12 @@ public:
   /// system, this is typically [0, 1, 0]).
   void SetAxleDirection(const ChVector<>& dir) { m_dir_axle = dir; }
 
+  /// Solve the driveline shafts with a shaft network, outside the Chrono
+  /// system, with the specified number of substeps per step (default:
+  /// disabled). The reaction torques on the chassis are then neglected.
+  /// Must be called before Initialize().
+  void SetPartitioned(bool val, int num_substeps = 10);
+
   /// Return the number of driven axles.
   /// A ChShaftsDriveline2WD driveline connects to a single axle.
   virtual int GetNumDrivenAxles() const { return 1; }
@@ -93,6 +99,10 @@ private:
 
   ChVector<> m_dir_motor_block;
   ChVector<> m_dir_axle;
+
+  bool m_partitioned;
+  int  m_num_substeps;
+  int  m_net_axles[2];   // network indexes of the axles (partitioned)
 };
 
 
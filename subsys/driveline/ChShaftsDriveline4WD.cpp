@@ -19,6 +19,7 @@
 #include "physics/ChSystem.h"
 
 #include "subsys/driveline/ChShaftsDriveline4WD.h"
+#include "subsys/ChStartupProfiler.h"
 
 namespace chrono {
 
@@ -34,10 +35,18 @@ namespace chrono {
 ChShaftsDriveline4WD::ChShaftsDriveline4WD()
 : ChDriveline(),
   m_dir_motor_block(ChVector<>(1, 0, 0)),
-  m_dir_axle(ChVector<>(0, 1, 0))
+  m_dir_axle(ChVector<>(0, 1, 0)),
+  m_partitioned(false),
+  m_num_substeps(10)
 {
 }
 
+void ChShaftsDriveline4WD::SetPartitioned(bool val, int num_substeps)
+{
+  m_partitioned = val;
+  m_num_substeps = num_substeps;
+}
+
 
 // -----------------------------------------------------------------------------
 // Initialize the driveline subsystem.
@@ -48,6 +57,8 @@ void ChShaftsDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
                                       const ChSuspensionList& suspensions,
                                       const std::vector<int>& driven_axles)
 {
+  CH_STARTUP_SCOPE("ChShaftsDriveline4WD::Initialize");
+
   assert(suspensions.size() >= 2);
   assert(driven_axles.size() == 2);
 
@@ -60,21 +71,53 @@ void ChShaftsDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
   // represents the connection of the driveline to the transmission box.
   m_driveshaft = ChSharedPtr<ChShaft>(new ChShaft);
   m_driveshaft->SetInertia(GetDriveshaftInertia());
-  my_system->Add(m_driveshaft);
 
   // Create a 1 d.o.f. object: a 'shaft' with rotational inertia.
   // This represents the shaft that connecting central differential to front
   // differential.
   m_front_shaft = ChSharedPtr<ChShaft>(new ChShaft);
   m_front_shaft->SetInertia(GetToFrontDiffShaftInertia());
-  my_system->Add(m_front_shaft);
 
   // Create a 1 d.o.f. object: a 'shaft' with rotational inertia.
   // This represents the shaft that connecting central differential to rear
   // differential.
   m_rear_shaft = ChSharedPtr<ChShaft>(new ChShaft);
   m_rear_shaft->SetInertia(GetToRearDiffShaftInertia());
+
+  // Create 1 d.o.f. objects: 'shafts' with rotational inertia.
+  // These represent the inertias of the rotating boxes of the differentials.
+  m_rear_differentialbox = ChSharedPtr<ChShaft>(new ChShaft);
+  m_rear_differentialbox->SetInertia(GetRearDifferentialBoxInertia());
+  m_front_differentialbox = ChSharedPtr<ChShaft>(new ChShaft);
+  m_front_differentialbox->SetInertia(GetRearDifferentialBoxInertia());
+
+  // In a partitioned driveline, the differentials and the conical gears are
+  // solved by the shaft network, coupled to the axles of the suspensions.
+  if (m_partitioned) {
+    m_network = ChSharedPtr<vehicle::ChShaftNetwork>(new vehicle::ChShaftNetwork);
+    m_network->SetNumSubsteps(m_num_substeps);
+    int driveshaft = m_network->AddShaft(m_driveshaft);
+    int front_shaft = m_network->AddShaft(m_front_shaft);
+    int rear_shaft = m_network->AddShaft(m_rear_shaft);
+    int front_box = m_network->AddShaft(m_front_differentialbox);
+    int rear_box = m_network->AddShaft(m_rear_differentialbox);
+    for (int i = 0; i < 2; i++) {
+      m_net_axles[2 * i + LEFT] = m_network->AddBoundaryShaft(suspensions[m_driven_axles[i]]->GetAxle(LEFT));
+      m_net_axles[2 * i + RIGHT] = m_network->AddBoundaryShaft(suspensions[m_driven_axles[i]]->GetAxle(RIGHT));
+    }
+    m_network->AddPlanetary(driveshaft, rear_shaft, front_shaft, GetCentralDifferentialRatio());
+    m_network->AddGear(rear_shaft, rear_box, GetRearConicalGearRatio());
+    m_network->AddPlanetary(rear_box, m_net_axles[2 + LEFT], m_net_axles[2 + RIGHT], GetRearDifferentialRatio());
+    m_network->AddGear(front_shaft, front_box, GetFrontConicalGearRatio());
+    m_network->AddPlanetary(front_box, m_net_axles[LEFT], m_net_axles[RIGHT], GetFrontDifferentialRatio());
+    return;
+  }
+
+  my_system->Add(m_driveshaft);
+  my_system->Add(m_front_shaft);
   my_system->Add(m_rear_shaft);
+  my_system->Add(m_rear_differentialbox);
+  my_system->Add(m_front_differentialbox);
 
   // Create the central differential, i.e. an epicycloidal mechanism that
   // connects three rotating members. This class of mechanisms can be simulated
@@ -90,12 +133,6 @@ void ChShaftsDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
 
   // ---Rear differential and axles:
 
-  // Create a 1 d.o.f. object: a 'shaft' with rotational inertia.
-  // This represents the inertia of the rotating box of the differential.
-  m_rear_differentialbox = ChSharedPtr<ChShaft>(new ChShaft);
-  m_rear_differentialbox->SetInertia(GetRearDifferentialBoxInertia());
-  my_system->Add(m_rear_differentialbox);
-
   // Create an angled gearbox, i.e a transmission ratio constraint between two
   // non parallel shafts. This is the case of the 90 bevel gears in the
   // differential. Note that, differently from the basic ChShaftsGear, this also
@@ -124,12 +161,6 @@ void ChShaftsDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
 
   // ---Front differential and axles:
 
-  // Create a 1 d.o.f. object: a 'shaft' with rotational inertia.
-  // This represents the inertia of the rotating box of the differential.
-  m_front_differentialbox = ChSharedPtr<ChShaft>(new ChShaft);
-  m_front_differentialbox->SetInertia(GetRearDifferentialBoxInertia());
-  my_system->Add(m_front_differentialbox);
-
   // Create an angled gearbox, i.e a transmission ratio constraint between two
   // non parallel shafts. This is the case of the 90 bevel gears in the
   // differential. Note that, differently from the basic ChShaftsGear, this also
@@ -162,6 +193,14 @@ void ChShaftsDriveline4WD::Initialize(ChSharedPtr<ChBody>     chassis,
 // -----------------------------------------------------------------------------
 double ChShaftsDriveline4WD::GetWheelTorque(const ChWheelID& wheel_id) const
 {
+  if (!m_network.IsNull()) {
+    for (int i = 0; i < 2; i++) {
+      if (wheel_id.axle() == m_driven_axles[i])
+        return m_network->GetShaftTorque(m_net_axles[2 * i + wheel_id.side()]);
+    }
+    return 0;
+  }
+
   if (wheel_id.axle() == m_driven_axles[0]) {
     switch (wheel_id.side()) {
     case LEFT:  return -m_front_differential->GetTorqueReactionOn2();
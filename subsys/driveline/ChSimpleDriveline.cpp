@@ -21,6 +21,7 @@
 
 #include <cmath>
 #include "subsys/driveline/ChSimpleDriveline.h"
+#include "subsys/ChStartupProfiler.h"
 
 namespace chrono {
 
@@ -42,6 +43,8 @@ void ChSimpleDriveline::Initialize(ChSharedPtr<ChBody>     chassis,
                                    const ChSuspensionList& suspensions,
                                    const std::vector<int>& driven_axles)
 {
+  CH_STARTUP_SCOPE("ChSimpleDriveline::Initialize");
+
   assert(suspensions.size() >= 2);
 
   m_driven_axles = driven_axles;
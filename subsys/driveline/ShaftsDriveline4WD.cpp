@@ -18,39 +18,20 @@
 // =============================================================================
 
 #include "subsys/driveline/ShaftsDriveline4WD.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ShaftsDriveline4WD::ShaftsDriveline4WD(const std::string& filename)
 : ChShaftsDriveline4WD()
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
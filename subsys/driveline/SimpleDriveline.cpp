@@ -17,8 +17,7 @@
 // =============================================================================
 
 #include "subsys/driveline/SimpleDriveline.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
 
 using namespace rapidjson;
 
@@ -30,15 +29,7 @@ namespace chrono {
 SimpleDriveline::SimpleDriveline(const std::string& filename)
 : ChSimpleDriveline()
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
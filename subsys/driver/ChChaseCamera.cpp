@@ -19,12 +19,17 @@
 // - Track:  camera is fixed and tracks the body;
 // - Inside: camera is fixed at a given point on the body.
 //
+// The camera location follows its desired location with a critically damped
+// spring, advanced in closed form.
+//
 // TODO: 
 // - relax current assumption that the body forward direction is in the positive
 //   X direction.
 //
 // =============================================================================
 
+#include <cmath>
+
 #include "subsys/driver/ChChaseCamera.h"
 
 namespace chrono {
@@ -66,6 +71,7 @@ void ChChaseCamera::Initialize(const ChVector<>&   ptOnChassis,
 
   ChVector<> localOffset(-chaseDist, 0, chaseHeight);
   m_loc = m_chassis->GetFrame_REF_to_abs().TransformPointLocalToParent(ptOnChassis + localOffset);
+  m_vel = ChVector<>(0, 0, 0);
   m_lastLoc = m_loc;
 }
 
@@ -152,8 +158,13 @@ void ChChaseCamera::SetMultLimits(double minMult, double maxMult)
 // -----------------------------------------------------------------------------
 void ChChaseCamera::Update(double step)
 {
-  // Perform a simple Euler integration step (derivative controller).
-  m_loc += step * calcDeriv(m_loc);
+  // Advance the camera location towards its desired location (held fixed
+  // over the step).
+  ChVector<> desCamLoc = calcDesiredLoc();
+
+  criticallyDamped(m_loc.x, m_vel.x, desCamLoc.x, m_horizGain, step);
+  criticallyDamped(m_loc.y, m_vel.y, desCamLoc.y, m_horizGain, step);
+  criticallyDamped(m_loc.z, m_vel.z, desCamLoc.z, m_vertGain, step);
 
   if (m_state != Track)
     return;
@@ -165,8 +176,25 @@ void ChChaseCamera::Update(double step)
 }
 
 // -----------------------------------------------------------------------------
+// Closed-form solution of the critically damped spring
+//   x'' + 2 w x' + w^2 (x - target) = 0
+// over a step h, for a constant target:
+//   x(h) = target + (e + a h) exp(-w h),   v(h) = (v - w a h) exp(-w h)
+// with e = x - target and a = v + w e.
 // -----------------------------------------------------------------------------
-ChVector<> ChChaseCamera::calcDeriv(const ChVector<>& loc)
+void ChChaseCamera::criticallyDamped(double& x, double& v, double target, double omega, double h)
+{
+  double e = x - target;
+  double a = v + omega * e;
+  double decay = std::exp(-omega * h);
+
+  x = target + (e + a * h) * decay;
+  v = (v - omega * a * h) * decay;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVector<> ChChaseCamera::calcDesiredLoc() const
 {
   // Calculate the desired camera location, based on the current state of the
   // chassis.
@@ -187,14 +215,7 @@ ChVector<> ChChaseCamera::calcDeriv(const ChVector<>& loc)
   desCamLoc = targetLoc - m_mult * m_dist * uC2T;
   desCamLoc.z = targetLoc.z + m_mult * m_height;
 
-  // Calculate the derivative vector (RHS of filter ODEs).
-  ChVector<> deriv;
-
-  deriv.x = m_horizGain * (desCamLoc.x - m_loc.x);
-  deriv.y = m_horizGain * (desCamLoc.y - m_loc.y);
-  deriv.z = m_vertGain  * (desCamLoc.z - m_loc.z);
-
-  return deriv;
+  return desCamLoc;
 }
 
 
@@ -19,6 +19,13 @@
 // - Track:  camera is fixed and tracks the body;
 // - Inside: camera is fixed at a given point on the body.
 //
+// The camera location is attached to its desired location (behind the body)
+// by a critically damped spring, with natural frequencies given by the
+// horizontal and vertical gains. Update() advances the spring in closed form
+// (the desired location being held fixed over the step), which is exact for
+// any step, such that the camera can be updated once per render frame, with
+// irregular frame times.
+//
 // TODO: 
 // - relax current assumption that the body forward direction is in the positive
 //   X direction.
@@ -55,6 +62,7 @@ public:
     double              chaseDist,
     double              chaseHeight);
 
+  /// Advance the camera location by the specified time step.
   void Update(double step);
 
   void Zoom(int val);
@@ -67,14 +75,21 @@ public:
   ChVector<> GetCameraPos() const;
   ChVector<> GetTargetPos() const;
 
+  /// Set the natural frequencies [rad/s] of the horizontal and vertical
+  /// camera motion (default: 4 and 2).
   void SetHorizGain(double g)             { m_horizGain = g; }
   void SetVertGain(double g)              { m_vertGain = g; }
 
   void SetMultLimits(double minMult, double maxMult);
 
+  /// Follow a different body (e.g. a render proxy of the chassis).
+  void SetChassis(ChSharedBodyPtr chassis) { m_chassis = chassis; }
+
 private:
 
-  ChVector<> calcDeriv(const ChVector<>& loc);
+  ChVector<> calcDesiredLoc() const;
+
+  static void criticallyDamped(double& x, double& v, double target, double omega, double h);
 
   State m_state;
 
@@ -87,6 +102,7 @@ private:
   double m_angle;
 
   ChVector<> m_loc;
+  ChVector<> m_vel;
   ChVector<> m_lastLoc;
 
   double m_horizGain;
@@ -12,59 +12,51 @@
 // Authors: Radu Serban
 // =============================================================================
 //
-// A driver model based on user inputs provided as time series. If provided as a
-// text file, each line in the file must contain 4 values:
-//   time steering throttle braking
-// It is assumed that the time values are unique.
-// If the time values are not sorted, this must be specified at construction.
-// Driver inputs at intermediate times are obtained through linear interpolation.
+// A driver model based on user inputs provided as time series.
 //
 // =============================================================================
 
-#include <iostream>
-#include <sstream>
-#include <fstream>
-#include <vector>
 #include <algorithm>
 
 #include "subsys/driver/ChDataDriver.h"
 
 namespace chrono {
 
+// Number of entries tried after the cursor before resorting to binary search.
+static const size_t MAX_CURSOR_STEPS = 8;
+
+static bool compare(const ChDataDriver::Entry& a, const ChDataDriver::Entry& b) { return a.m_time < b.m_time; }
+
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ChDataDriver::ChDataDriver(const std::string& filename,
                            bool               sorted)
+: m_trace(ChDriverTraceRegistry::Acquire(filename)),
+  m_shared(true),
+  m_cursor(1)
 {
-  std::ifstream ifile(filename.c_str());
-  std::string line;
-
-  while (std::getline(ifile, line)) {
-    std::istringstream iss(line);
-
-    double time, steering, throttle, braking;
-
-    iss >> time >> steering >> throttle >> braking;
-
-    if (iss.fail())
-      break;
-
-    m_data.push_back(Entry(time, steering, throttle, braking));
+  // Keep a valid (empty) trace if the file could not be loaded.
+  if (!m_trace) {
+    m_trace = new ChDriverTrace(std::vector<Entry>());
+    m_shared = false;
   }
-
-  ifile.close();
-
-  if (!sorted)
-    std::sort(m_data.begin(), m_data.end(), ChDataDriver::compare);
 }
 
 ChDataDriver::ChDataDriver(const std::vector<Entry>& data,
                            bool                      sorted)
-: m_data(data)
+: m_trace(new ChDriverTrace(data, sorted)),
+  m_shared(false),
+  m_cursor(1)
+{
+}
+
+ChDataDriver::~ChDataDriver()
 {
-  if (!sorted)
-    std::sort(m_data.begin(), m_data.end(), ChDataDriver::compare);
+  if (m_shared)
+    ChDriverTraceRegistry::Release(m_trace);
+  else
+    delete m_trace;
 }
 
 
@@ -72,32 +64,77 @@ ChDataDriver::ChDataDriver(const std::vector<Entry>& data,
 // -----------------------------------------------------------------------------
 void ChDataDriver::Update(double time)
 {
-  if (time <= m_data[0].m_time)
+  const Entry* data = m_trace->GetEntries();
+  size_t n = m_trace->GetNumEntries();
+
+  if (n == 0)
+    return;
+
+  if (time <= data[0].m_time)
   {
-    m_steering = m_data[0].m_steering;
-    m_throttle = m_data[0].m_throttle;
-    m_braking = m_data[0].m_braking;
+    m_steering = data[0].m_steering;
+    m_throttle = data[0].m_throttle;
+    m_braking = data[0].m_braking;
     return;
   }
-  else if (time >= m_data.back().m_time) {
-    m_steering = m_data.back().m_steering;
-    m_throttle = m_data.back().m_throttle;
-    m_braking = m_data.back().m_braking;
+  else if (time >= data[n - 1].m_time) {
+    m_steering = data[n - 1].m_steering;
+    m_throttle = data[n - 1].m_throttle;
+    m_braking = data[n - 1].m_braking;
     return;
   }
 
-  std::vector<Entry>::iterator right = std::lower_bound(m_data.begin(),
-                                                        m_data.end(),
-                                                        Entry(time, 0, 0, 0),
-                                                        ChDataDriver::compare);
+  // Find the entry 'right' with data[right-1].m_time < time <= data[right].m_time,
+  // starting from the one found in the last query.
+  size_t right = m_cursor;
+
+  if (right >= n || !(data[right - 1].m_time < time)) {
+    right = std::lower_bound(data, data + n, Entry(time, 0, 0, 0), compare) - data;
+  } else {
+    size_t steps = 0;
+    while (data[right].m_time < time && steps < MAX_CURSOR_STEPS) {
+      right++;
+      steps++;
+    }
+    if (data[right].m_time < time)
+      right = std::lower_bound(data + right, data + n, Entry(time, 0, 0, 0), compare) - data;
+  }
+
+  m_cursor = right;
+
+  const Entry& l = data[right - 1];
+  const Entry& r = data[right];
+
+  double tbar = (time - l.m_time) / (r.m_time - l.m_time);
+
+  m_steering = l.m_steering + tbar * (r.m_steering - l.m_steering);
+  m_throttle = l.m_throttle + tbar * (r.m_throttle - l.m_throttle);
+  m_braking  = l.m_braking  + tbar * (r.m_braking  - l.m_braking);
+}
+
+// -----------------------------------------------------------------------------
+// The cursor only speeds up the next query, but is saved so that a restored
+// driver does not fall back to a binary search.
+// -----------------------------------------------------------------------------
+void ChDataDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChDriver::SaveState(state);
+
+  state.BeginBlock(1);
+  state.Write((double)m_cursor);
+}
+
+bool ChDataDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChDriver::RestoreState(state))
+    return false;
 
-  std::vector<Entry>::iterator left = right - 1;
+  if (!state.OpenBlock(1, "data driver"))
+    return false;
 
-  double tbar = (time - left->m_time) / (right->m_time - left->m_time);
+  m_cursor = std::max((size_t)1, (size_t)state.Read());
 
-  m_steering = left->m_steering + tbar * (right->m_steering - left->m_steering);
-  m_throttle = left->m_throttle + tbar * (right->m_throttle - left->m_throttle);
-  m_braking  = left->m_braking  + tbar * (right->m_braking  - left->m_braking);
+  return true;
 }
 
 
@@ -15,9 +15,15 @@
 // A driver model based on user inputs provided as time series. If provided as a
 // text file, each line in the file must contain 4 values:
 //   time steering throttle braking
+// Alternatively, the inputs can be provided as a binary trace file (see
+// ChDriverTrace), which is memory-mapped. All drivers using the same file share
+// a single copy of its data.
 // It is assumed that the time values are unique.
-// If the time values are not sorted, this must be specified at construction.
+// If the time values are not sorted, this must be specified at construction
+// (data loaded from a file is always sorted if necessary).
 // Driver inputs at intermediate times are obtained through linear interpolation.
+// Queries at increasing times are resolved in amortized constant time; others
+// fall back to a binary search.
 //
 // =============================================================================
 
@@ -29,36 +35,38 @@
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChDriver.h"
+#include "subsys/driver/ChDriverTrace.h"
 
 namespace chrono {
 
 class CH_SUBSYS_API ChDataDriver : public ChDriver
 {
 public:
-  struct Entry {
-    Entry() {}
-    Entry(double time, double steering, double throttle, double braking)
-      : m_time(time), m_steering(steering), m_throttle(throttle), m_braking(braking)
-    {}
-    double m_time;
-    double m_steering;
-    double m_throttle;
-    double m_braking;
-  };
+  typedef ChDriverEntry Entry;
 
   ChDataDriver(const std::string& filename,
                bool               sorted = true);
   ChDataDriver(const std::vector<Entry>& data,
                bool                      sorted = true);
-  ~ChDataDriver() {}
+  ~ChDataDriver();
 
   virtual void Update(double time);
 
+  /// Append the driver inputs and the cursor in the input data to the
+  /// specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs and the cursor from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
 private:
 
-  static bool compare(const Entry& a, const Entry& b) { return a.m_time < b.m_time; }
+  ChDataDriver(const ChDataDriver&);
+  ChDataDriver& operator=(const ChDataDriver&);
 
-  std::vector<Entry> m_data;
+  const ChDriverTrace* m_trace;
+  bool                 m_shared;   // true if m_trace is registered
+  size_t               m_cursor;   // index of the right bracketing entry of the last query
 };
 
 
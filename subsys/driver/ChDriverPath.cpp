@@ -0,0 +1,309 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only reference path for path-following drivers.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/driver/ChDriverPath.h"
+
+namespace chrono {
+
+// Number of grid rings searched around a point before resorting to a search
+// over all segments.
+static const int MAX_SEARCH_RINGS = 16;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChDriverPath::ChDriverPath(const std::vector<ChVector<> >& points,
+                           const std::vector<double>&      speeds,
+                           double                          cell_size)
+: m_reacquire(10),
+  m_cell(1),
+  m_num_searches(0)
+{
+  bool with_speeds = !speeds.empty() && speeds.size() == points.size();
+
+  for (size_t i = 0; i < points.size(); i++) {
+    if (!m_x.empty() && points[i].x == m_x.back() && points[i].y == m_y.back())
+      continue;
+    double s = m_s.empty() ? 0 : m_s.back() + std::sqrt((points[i].x - m_x.back()) * (points[i].x - m_x.back()) +
+                                                        (points[i].y - m_y.back()) * (points[i].y - m_y.back()));
+    m_x.push_back(points[i].x);
+    m_y.push_back(points[i].y);
+    m_s.push_back(s);
+    if (with_speeds)
+      m_speed.push_back(speeds[i]);
+  }
+
+  // A single point is kept as a degenerate segment.
+  if (m_x.size() == 1) {
+    m_x.push_back(m_x[0]);
+    m_y.push_back(m_y[0]);
+    m_s.push_back(0);
+    if (with_speeds)
+      m_speed.push_back(m_speed[0]);
+  }
+
+  if (!m_x.empty())
+    build_grid(cell_size);
+}
+
+// -----------------------------------------------------------------------------
+// As for text driver traces, the file is read in one piece and parsed in place.
+// -----------------------------------------------------------------------------
+ChDriverPath* ChDriverPath::Load(const std::string& filename)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open driver path file " << filename.c_str() << "\n";
+    return 0;
+  }
+
+  std::vector<char> buf;
+  char chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    buf.insert(buf.end(), chunk, chunk + n);
+  fclose(fp);
+  buf.push_back(0);
+
+  std::vector<ChVector<> > points;
+  std::vector<double> speeds;
+  bool with_speeds = true;
+
+  char* p = &buf[0];
+  char* end = p + buf.size() - 1;
+
+  while (p < end) {
+    char* eol = (char*)memchr(p, '\n', end - p);
+    if (eol)
+      *eol = 0;
+
+    double vals[3];
+    int count = 0;
+    char* q = p;
+    while (count < 3) {
+      char* next;
+      vals[count] = strtod(q, &next);
+      if (next == q)
+        break;
+      count++;
+      q = next;
+    }
+
+    if (count < 2)
+      break;
+
+    points.push_back(ChVector<>(vals[0], vals[1], 0));
+    speeds.push_back(vals[2]);
+    with_speeds = with_speeds && (count == 3);
+
+    if (!eol)
+      break;
+    p = eol + 1;
+  }
+
+  if (points.size() < 2) {
+    GetLog() << "ERROR: driver path file " << filename.c_str() << " has fewer than 2 points\n";
+    return 0;
+  }
+
+  if (!with_speeds)
+    speeds.clear();
+
+  return new ChDriverPath(points, speeds);
+}
+
+// -----------------------------------------------------------------------------
+// Each segment is sampled at intervals of at most one cell, and registered in
+// the 3x3 cells around each sample, which cover all the cells it crosses.
+// -----------------------------------------------------------------------------
+void ChDriverPath::build_grid(double cell_size)
+{
+  int num_segments = (int)m_x.size() - 1;
+
+  m_cell = cell_size;
+  if (m_cell <= 0)
+    m_cell = std::max(4 * m_s.back() / num_segments, 1.0);
+
+  m_grid.clear();
+  for (int k = 0; k < num_segments; k++) {
+    double len = m_s[k + 1] - m_s[k];
+    int num_samples = (int)std::ceil(len / m_cell) + 1;
+    for (int n = 0; n < num_samples; n++) {
+      double t = (num_samples > 1) ? (double)n / (num_samples - 1) : 0;
+      long long ci = (long long)std::floor((m_x[k] + t * (m_x[k + 1] - m_x[k])) / m_cell);
+      long long cj = (long long)std::floor((m_y[k] + t * (m_y[k + 1] - m_y[k])) / m_cell);
+      for (long long j = cj - 1; j <= cj + 1; j++)
+        for (long long i = ci - 1; i <= ci + 1; i++)
+          m_grid.push_back(std::make_pair(cell_key(i, j), k));
+    }
+  }
+
+  std::sort(m_grid.begin(), m_grid.end());
+  m_grid.erase(std::unique(m_grid.begin(), m_grid.end()), m_grid.end());
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChDriverPath::segment_distance(int seg, double x, double y, double& t) const
+{
+  double dx = m_x[seg + 1] - m_x[seg];
+  double dy = m_y[seg + 1] - m_y[seg];
+  double len2 = dx * dx + dy * dy;
+
+  double px = x - m_x[seg];
+  double py = y - m_y[seg];
+
+  t = (len2 > 0) ? (px * dx + py * dy) / len2 : 0;
+  if (t < 0)
+    t = 0;
+  else if (t > 1)
+    t = 1;
+
+  double ex = px - t * dx;
+  double ey = py - t * dy;
+  return ex * ex + ey * ey;
+}
+
+// The grid is searched ring by ring around the cell of the point. A segment
+// not registered in the rings searched so far lies entirely outside of them,
+// i.e. farther than the ring radius from the point.
+int ChDriverPath::search(double x, double y) const
+{
+  vehicle::ChAtomicIncrement(&m_num_searches);
+
+  int num_segments = (int)m_x.size() - 1;
+  long long ci = (long long)std::floor(x / m_cell);
+  long long cj = (long long)std::floor(y / m_cell);
+
+  int best = -1;
+  double best_d2 = 0;
+  double t;
+
+  for (int r = 0; r <= MAX_SEARCH_RINGS; r++) {
+    for (long long j = cj - r; j <= cj + r; j++) {
+      long long step = (j == cj - r || j == cj + r) ? 1 : 2 * r;
+      for (long long i = ci - r; i <= ci + r; i += step) {
+        std::vector<std::pair<long long, int> >::const_iterator it =
+            std::lower_bound(m_grid.begin(), m_grid.end(), std::make_pair(cell_key(i, j), -1));
+        for (; it != m_grid.end() && it->first == cell_key(i, j); ++it) {
+          double d2 = segment_distance(it->second, x, y, t);
+          if (best < 0 || d2 < best_d2 || (d2 == best_d2 && it->second < best)) {
+            best = it->second;
+            best_d2 = d2;
+          }
+        }
+      }
+    }
+    if (best >= 0 && best_d2 <= (r * m_cell) * (r * m_cell))
+      return best;
+  }
+
+  // Point far from the path: check all segments.
+  for (int k = 0; k < num_segments; k++) {
+    double d2 = segment_distance(k, x, y, t);
+    if (best < 0 || d2 < best_d2) {
+      best = k;
+      best_d2 = d2;
+    }
+  }
+
+  return best;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDriverPath::Project(double x, double y, int& cursor, Projection& proj) const
+{
+  int num_segments = (int)m_x.size() - 1;
+  double t = 0;
+
+  if (cursor < 0 || cursor >= num_segments) {
+    cursor = search(x, y);
+    segment_distance(cursor, x, y, t);
+  } else {
+    double d2 = segment_distance(cursor, x, y, t);
+    while (cursor + 1 < num_segments) {
+      double t1;
+      double d2_next = segment_distance(cursor + 1, x, y, t1);
+      if (d2_next > d2)
+        break;
+      cursor++;
+      d2 = d2_next;
+      t = t1;
+    }
+    if (d2 > m_reacquire * m_reacquire) {
+      cursor = search(x, y);
+      segment_distance(cursor, x, y, t);
+    }
+  }
+
+  int k = cursor;
+  double dx = m_x[k + 1] - m_x[k];
+  double dy = m_y[k + 1] - m_y[k];
+  double len = m_s[k + 1] - m_s[k];
+
+  proj.segment = k;
+  proj.s = m_s[k] + t * len;
+  proj.heading = std::atan2(dy, dx);
+  proj.lateral = (len > 0) ? (dx * (y - m_y[k]) - dy * (x - m_x[k])) / len : 0;
+}
+
+ChVector<> ChDriverPath::GetPoint(double s, int& cursor) const
+{
+  int num_segments = (int)m_x.size() - 1;
+  s = std::max(0.0, std::min(s, m_s.back()));
+
+  if (cursor < 0 || cursor >= num_segments || m_s[cursor] > s) {
+    cursor = (int)(std::upper_bound(m_s.begin(), m_s.end(), s) - m_s.begin()) - 1;
+    cursor = std::max(0, std::min(cursor, num_segments - 1));
+  } else {
+    while (cursor + 1 < num_segments && m_s[cursor + 1] <= s)
+      cursor++;
+  }
+
+  int k = cursor;
+  double len = m_s[k + 1] - m_s[k];
+  double t = (len > 0) ? (s - m_s[k]) / len : 0;
+
+  return ChVector<>(m_x[k] + t * (m_x[k + 1] - m_x[k]), m_y[k] + t * (m_y[k + 1] - m_y[k]), 0);
+}
+
+double ChDriverPath::GetSpeed(double s, int segment) const
+{
+  if (m_speed.empty())
+    return 0;
+
+  int k = segment;
+  double len = m_s[k + 1] - m_s[k];
+  double t = (len > 0) ? (s - m_s[k]) / len : 0;
+  t = std::max(0.0, std::min(t, 1.0));
+
+  return m_speed[k] + t * (m_speed[k + 1] - m_speed[k]);
+}
+
+
+} // end namespace chrono
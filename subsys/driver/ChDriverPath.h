@@ -0,0 +1,146 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only reference path for path-following drivers: a polyline in the x-y
+// plane, with an optional reference speed at each point.
+//
+// A path can be loaded from a text file with one point per line:
+//   x y [speed]
+// (parsing stops at the first line with fewer than 2 values).
+//
+// Closest-point queries are resolved from a cursor (a segment index) owned by
+// the caller: the cursor advances along the path for as long as the distance
+// to the next segment does not increase, so that a vehicle driving along the
+// path is tracked in amortized constant time, and a path passing near itself
+// is not confused with its other branch. If the point is farther than the
+// reacquisition distance from the segment found this way (e.g. at the first
+// query), the closest segment is found through a sparse grid of the segments
+// instead. A path is immutable, so it can be shared by any number of drivers
+// (and threads).
+//
+// =============================================================================
+
+#ifndef CH_DRIVER_PATH_H
+#define CH_DRIVER_PATH_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChVector.h"
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Reference path of a path-following driver.
+///
+class CH_SUBSYS_API ChDriverPath : public ChShared
+{
+public:
+
+  /// Projection of a point on the path.
+  struct Projection {
+    int     segment;    ///< index of the closest segment
+    double  s;          ///< arc length at the closest point
+    double  lateral;    ///< signed distance from the path (positive to the left of the path direction)
+    double  heading;    ///< direction of the closest segment (angle from the x axis)
+  };
+
+  /// Create a path through the specified points (the z coordinates are
+  /// ignored). Consecutive duplicate points are dropped. If speeds are given,
+  /// there must be one per point.
+  ChDriverPath(
+    const std::vector<ChVector<> >& points,                           ///< [in] path points
+    const std::vector<double>&      speeds = std::vector<double>(),   ///< [in] reference speeds (optional)
+    double                          cell_size = 0                     ///< [in] size of the grid cells (0: from the segment lengths)
+    );
+
+  ~ChDriverPath() {}
+
+  /// Load a path from the specified text file.
+  /// Returns NULL if the file cannot be read or has fewer than 2 points.
+  static ChDriverPath* Load(const std::string& filename);
+
+  /// Get the number of points of the path.
+  int GetNumPoints() const { return (int)m_x.size(); }
+
+  /// Get the length of the path.
+  double GetLength() const { return m_s.back(); }
+
+  /// Return true if the path has reference speeds.
+  bool HasSpeeds() const { return !m_speed.empty(); }
+
+  /// Set the distance beyond which the closest segment is searched over the
+  /// whole path rather than from the cursor (default: 10). Must be set
+  /// before the path is shared.
+  void SetReacquireDistance(double dist) { m_reacquire = dist; }
+
+  /// Project the specified point on the path, starting the search from the
+  /// specified cursor, which is updated. A negative cursor (e.g. for the first
+  /// query) forces a search over the whole path.
+  void Project(
+    double      x,        ///< [in] x coordinate of the point
+    double      y,        ///< [in] y coordinate of the point
+    int&        cursor,   ///< [in,out] segment index of the last query
+    Projection& proj      ///< [out] projection of the point
+    ) const;
+
+  /// Get the point at the specified arc length (clamped to the path), starting
+  /// from the specified cursor, which is updated.
+  ChVector<> GetPoint(double s, int& cursor) const;
+
+  /// Get the reference speed at the specified arc length, on the segment
+  /// found by Project() or GetPoint(). Returns 0 if the path has no speeds.
+  double GetSpeed(double s, int segment) const;
+
+  /// Get the number of whole-path searches performed so far.
+  int GetNumSearches() const { return (int)m_num_searches; }
+
+private:
+
+  // Squared distance from the point to the specified segment, and parameter
+  // (in [0,1]) of the closest point.
+  double segment_distance(int seg, double x, double y, double& t) const;
+
+  // Find the closest segment through the grid (or over all segments).
+  int search(double x, double y) const;
+
+  // Key of the grid cell with the specified integer coordinates.
+  static long long cell_key(long long i, long long j) { return (i << 32) ^ (j & 0xffffffffLL); }
+
+  void build_grid(double cell_size);
+
+  std::vector<double>  m_x;
+  std::vector<double>  m_y;
+  std::vector<double>  m_s;        // arc length at each point
+  std::vector<double>  m_speed;    // reference speed at each point (optional)
+
+  double               m_reacquire;
+
+  // Sparse grid: for each cell overlapped by a segment (inflated by half a
+  // cell), one (cell key, segment) pair, sorted by key.
+  double                                     m_cell;
+  std::vector<std::pair<long long, int> >    m_grid;
+
+  mutable volatile long                      m_num_searches;   // incremented by concurrent queries
+};
+
+
+} // end namespace chrono
+
+
+#endif
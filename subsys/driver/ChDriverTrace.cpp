@@ -0,0 +1,237 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only tables of driver inputs (traces) and a process-wide registry of
+// traces loaded from files.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/driver/ChDriverTrace.h"
+
+namespace chrono {
+
+static const char TRACE_MAGIC[8] = {'C', 'H', 'D', 'R', 'V', '1', 0, 0};
+static const size_t TRACE_HEADER_SIZE = 16;
+
+typedef unsigned int uint32;
+
+static bool compare_time(const ChDriverEntry& a, const ChDriverEntry& b) { return a.m_time < b.m_time; }
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChDriverTrace::ChDriverTrace(const std::vector<ChDriverEntry>& data, bool sorted)
+: num_users(0),
+  m_data(data),
+  m_entries(m_data.empty() ? 0 : &m_data[0]),
+  m_num_entries(m_data.size())
+{
+  if (!sorted)
+    std::sort(m_data.begin(), m_data.end(), compare_time);
+}
+
+void ChDriverTrace::sort()
+{
+  bool sorted = true;
+  for (size_t i = 1; i < m_num_entries && sorted; i++)
+    sorted = !(m_entries[i].m_time < m_entries[i - 1].m_time);
+
+  if (sorted)
+    return;
+
+  if (m_file.IsOpen()) {
+    m_data.assign(m_entries, m_entries + m_num_entries);
+    m_file.Close();
+  }
+
+  std::sort(m_data.begin(), m_data.end(), compare_time);
+  m_entries = &m_data[0];
+}
+
+// -----------------------------------------------------------------------------
+// Text trace files are read in one piece and parsed in place with strtod. As
+// with the original stream-based reader, parsing stops at the first line that
+// does not contain 4 values.
+// -----------------------------------------------------------------------------
+ChDriverTrace* ChDriverTrace::Load(const std::string& filename)
+{
+  ChDriverTrace* trace = new ChDriverTrace();
+  trace->filename = filename;
+
+  // Binary trace files are mapped in memory.
+  if (trace->m_file.Open(filename) && trace->m_file.GetSize() >= TRACE_HEADER_SIZE &&
+      memcmp(trace->m_file.GetData(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+    uint32 num_entries;
+    memcpy(&num_entries, trace->m_file.GetData() + sizeof(TRACE_MAGIC), sizeof(uint32));
+
+    if (trace->m_file.GetSize() < TRACE_HEADER_SIZE + num_entries * sizeof(ChDriverEntry)) {
+      GetLog() << "ERROR: truncated driver trace file " << filename.c_str() << "\n";
+      delete trace;
+      return 0;
+    }
+
+    trace->m_entries = reinterpret_cast<const ChDriverEntry*>(trace->m_file.GetData() + TRACE_HEADER_SIZE);
+    trace->m_num_entries = num_entries;
+    trace->sort();
+
+    return trace;
+  }
+
+  trace->m_file.Close();
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open driver trace file " << filename.c_str() << "\n";
+    delete trace;
+    return 0;
+  }
+
+  std::vector<char> buf;
+  char chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    buf.insert(buf.end(), chunk, chunk + n);
+  fclose(fp);
+  buf.push_back(0);
+
+  char* p = &buf[0];
+  char* end = p + buf.size() - 1;
+
+  while (p < end) {
+    char* eol = (char*)memchr(p, '\n', end - p);
+    if (eol)
+      *eol = 0;
+
+    double vals[4];
+    bool ok = true;
+    char* q = p;
+    for (int i = 0; i < 4 && ok; i++) {
+      char* next;
+      vals[i] = strtod(q, &next);
+      ok = (next != q);
+      q = next;
+    }
+
+    if (!ok)
+      break;
+
+    trace->m_data.push_back(ChDriverEntry(vals[0], vals[1], vals[2], vals[3]));
+
+    if (!eol)
+      break;
+    p = eol + 1;
+  }
+
+  trace->m_entries = trace->m_data.empty() ? 0 : &trace->m_data[0];
+  trace->m_num_entries = trace->m_data.size();
+  trace->sort();
+
+  return trace;
+}
+
+bool ChDriverTrace::WriteBinary(const std::string& filename, const std::vector<ChDriverEntry>& data)
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  uint32 header[2] = {(uint32)data.size(), 0};
+
+  bool ok = fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), fp) == sizeof(TRACE_MAGIC) &&
+            fwrite(header, sizeof(uint32), 2, fp) == 2;
+  if (ok && !data.empty())
+    ok = fwrite(&data[0], sizeof(ChDriverEntry), data.size(), fp) == data.size();
+
+  if (fclose(fp) != 0)
+    ok = false;
+
+  if (!ok)
+    GetLog() << "ERROR: cannot write " << filename.c_str() << "\n";
+
+  return ok;
+}
+
+
+// -----------------------------------------------------------------------------
+// A simulation uses only a handful of distinct trace files, so a linear search
+// through the registered traces is sufficient.
+// -----------------------------------------------------------------------------
+std::vector<ChDriverTrace*> ChDriverTraceRegistry::m_traces;
+
+static vehicle::ChMutex s_registry_mutex;
+
+const ChDriverTrace* ChDriverTraceRegistry::Acquire(const std::string& filename)
+{
+  s_registry_mutex.Lock();
+
+  ChDriverTrace* match = 0;
+  for (size_t i = 0; i < m_traces.size(); i++) {
+    if (m_traces[i]->filename == filename) {
+      match = m_traces[i];
+      break;
+    }
+  }
+
+  if (!match) {
+    match = ChDriverTrace::Load(filename);
+    if (match)
+      m_traces.push_back(match);
+  }
+
+  if (match)
+    match->num_users++;
+
+  s_registry_mutex.Unlock();
+
+  return match;
+}
+
+void ChDriverTraceRegistry::Release(const ChDriverTrace* trace)
+{
+  s_registry_mutex.Lock();
+
+  for (size_t i = 0; i < m_traces.size(); i++) {
+    if (m_traces[i] != trace)
+      continue;
+    if (--m_traces[i]->num_users == 0) {
+      delete m_traces[i];
+      m_traces.erase(m_traces.begin() + i);
+    }
+    break;
+  }
+
+  s_registry_mutex.Unlock();
+}
+
+int ChDriverTraceRegistry::GetNumTraces()
+{
+  s_registry_mutex.Lock();
+  int count = (int)m_traces.size();
+  s_registry_mutex.Unlock();
+
+  return count;
+}
+
+
+}  // end namespace chrono
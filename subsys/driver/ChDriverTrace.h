@@ -0,0 +1,130 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Read-only tables of driver inputs (traces) and a process-wide registry of
+// traces loaded from files.
+//
+// A trace file is either a text file with one entry per line:
+//   time steering throttle braking
+// or a binary file (see ChDriverTrace::WriteBinary), which is memory-mapped:
+//   magic "CHDRV1\0\0"  (8 bytes)
+//   number of entries   (uint32)
+//   reserved            (uint32)
+//   entries, each one holding time, steering, throttle, braking (double)
+// All integers and doubles are stored in the native byte order.
+//
+// All ChDataDriver objects using the same trace file share a single copy of
+// its entries. A trace is reference counted and deleted when the last driver
+// using it releases it. The registry can be used from multiple threads.
+//
+// =============================================================================
+
+#ifndef CH_DRIVER_TRACE_H
+#define CH_DRIVER_TRACE_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMappedFile.h"
+
+namespace chrono {
+
+///
+/// Driver inputs at one time.
+///
+struct ChDriverEntry {
+  ChDriverEntry() {}
+  ChDriverEntry(double time, double steering, double throttle, double braking)
+    : m_time(time), m_steering(steering), m_throttle(throttle), m_braking(braking)
+  {}
+  double m_time;
+  double m_steering;
+  double m_throttle;
+  double m_braking;
+};
+
+///
+/// Read-only table of driver inputs, sorted by time.
+///
+class CH_SUBSYS_API ChDriverTrace
+{
+public:
+
+  /// Create a trace with a copy of the specified entries.
+  /// If 'sorted' is false, the entries are sorted by time.
+  ChDriverTrace(const std::vector<ChDriverEntry>& data, bool sorted = true);
+
+  ~ChDriverTrace() {}
+
+  /// Load a trace from the specified text or binary file.
+  /// Returns NULL if the file cannot be opened.
+  static ChDriverTrace* Load(const std::string& filename);
+
+  /// Write the specified entries to a binary trace file.
+  /// Returns false if the file cannot be written.
+  static bool WriteBinary(const std::string& filename, const std::vector<ChDriverEntry>& data);
+
+  /// Get the entries of the trace.
+  const ChDriverEntry* GetEntries() const { return m_entries; }
+
+  /// Get the number of entries in the trace.
+  size_t GetNumEntries() const { return m_num_entries; }
+
+  /// Return true if the entries are mapped from a binary trace file.
+  bool IsMapped() const { return m_file.IsOpen(); }
+
+  std::string  filename;    ///< source file (empty if not loaded from a file)
+  int          num_users;   ///< number of drivers using this trace
+
+private:
+
+  ChDriverTrace() : num_users(0), m_entries(0), m_num_entries(0) {}
+
+  // Sort the entries by time, if necessary (copying mapped entries first).
+  void sort();
+
+  std::vector<ChDriverEntry>  m_data;         // entries read from a text file
+  vehicle::ChMappedFile       m_file;         // mapped binary trace file
+  const ChDriverEntry*        m_entries;
+  size_t                      m_num_entries;
+};
+
+///
+/// Registry of driver traces loaded from files.
+///
+class CH_SUBSYS_API ChDriverTraceRegistry
+{
+public:
+
+  /// Get the trace for the specified file, loading it if it is not already
+  /// registered, and increment its use count. Returns NULL if the file cannot
+  /// be opened.
+  static const ChDriverTrace* Acquire(const std::string& filename);
+
+  /// Release a trace. The trace is deleted when its use count reaches zero.
+  static void Release(const ChDriverTrace* trace);
+
+  /// Return the number of traces currently registered.
+  static int GetNumTraces();
+
+private:
+  static std::vector<ChDriverTrace*> m_traces;
+};
+
+
+} // end namespace chrono
+
+
+#endif
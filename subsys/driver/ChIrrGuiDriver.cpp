@@ -23,15 +23,23 @@
 //  - provides support for rendering links, force elements, displaying stats,
 //    etc.  In order to render these elements, call the its DrawAll() method
 //    instead of ChIrrAppInterface::DrawAll().
+//  - optionally splits the screen in several views, each with its own chase
+//    camera (e.g. following the vehicles of a convoy).
+//
+// The rendered links are found by type once, and again only when the number
+// of links in the system changes. Their lines (segments and spring helices)
+// are collected in a single vertex buffer and drawn with one call per frame.
 //
 // =============================================================================
 
 #include <algorithm>
+#include <cmath>
 
 #include "subsys/driver/ChIrrGuiDriver.h"
 #include "subsys/driveline/ChShaftsDriveline2WD.h"
 #include "subsys/driveline/ChShaftsDriveline4WD.h"
 #include "subsys/powertrain/ChShaftsPowertrain.h"
+#include "subsys/ChProfiler.h"
 
 using namespace irr;
 
@@ -53,13 +61,24 @@ ChIrrGuiDriver::ChIrrGuiDriver(ChIrrApp&           app,
   m_powertrain(powertrain),
   m_HUD_x(HUD_x),
   m_HUD_y(HUD_y),
+  m_hud(app, HUD_x, HUD_y),
+  m_timer_frames(0),
   m_terrainHeight(0),
   m_throttleDelta(1.0/50),
   m_steeringDelta(1.0/50),
   m_brakingDelta(1.0/50),
   m_camera(car.GetChassis()),
-  m_stepsize(1e-3),
-  m_sound(enable_sound)
+  m_sound(enable_sound),
+  m_warping(false),
+  m_warp_target(0),
+  m_warp_duration(30),
+  m_warp_time(0),
+  m_warp_frame(0),
+  m_warp_condition(0),
+  m_proxy(0),
+  m_drive_mode(powertrain.GetDriveMode()),
+  m_num_links(0),
+  m_sound_player(0)
 {
   app.SetUserEventReceiver(this);
 
@@ -69,33 +88,43 @@ ChIrrGuiDriver::ChIrrGuiDriver(ChIrrApp&           app,
   ChVector<> cam_target = m_camera.GetTargetPos();
 
   // Create and initialize the Irrlicht camera
-  scene::ICameraSceneNode *camera = m_app.GetSceneManager()->addCameraSceneNode(
+  m_camera_node = m_app.GetSceneManager()->addCameraSceneNode(
     m_app.GetSceneManager()->getRootSceneNode(),
     core::vector3df(0, 0, 0), core::vector3df(0, 0, 0));
 
-  camera->setUpVector(core::vector3df(0, 0, 1));
-  camera->setPosition(core::vector3df((f32)cam_pos.x, (f32)cam_pos.y, (f32)cam_pos.z));
-  camera->setTarget(core::vector3df((f32)cam_target.x, (f32)cam_target.y, (f32)cam_target.z));
+  m_camera_node->setUpVector(core::vector3df(0, 0, 1));
+  m_camera_node->setPosition(core::vector3df((f32)cam_pos.x, (f32)cam_pos.y, (f32)cam_pos.z));
+  m_camera_node->setTarget(core::vector3df((f32)cam_target.x, (f32)cam_target.y, (f32)cam_target.z));
 
-#if IRRKLANG_ENABLED
-  m_sound_engine = 0;   // Sound player
-  m_car_sound = 0;      // Sound
+  createHUD();
 
+  // The sound player samples the posted engine state at its own (low) rate.
   if (m_sound) {
-    // Start the sound engine with default parameters
-    m_sound_engine = irrklang::createIrrKlangDevice();
-
-    // To play a sound, call play2D(). The second parameter tells the engine to
-    // play it looped.
-    if (m_sound_engine) {
-      m_car_sound = m_sound_engine->play2D(GetChronoDataFile("carsound.ogg").c_str(), true, false, true);
-      m_car_sound->setIsPaused(true);
-    } else
-      GetLog() << "Cannot start sound engine Irrklang \n";
+    m_sound_player = new ChVehicleSound(GetChronoDataFile("carsound.ogg"));
+    if (!m_sound_player->Start()) {
+      delete m_sound_player;
+      m_sound_player = 0;
+    }
   }
-#endif
 }
 
+ChIrrGuiDriver::~ChIrrGuiDriver()
+{
+  if (m_sound_player) {
+    m_sound_player->Stop();
+    delete m_sound_player;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChIrrGuiDriver::SetRenderProxy(ChRenderProxy* proxy)
+{
+  m_proxy = proxy;
+  m_drive_mode = proxy->GetSnapshot().drive_mode;
+  m_camera.SetChassis(proxy->GetChassis());
+}
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -105,9 +134,20 @@ bool ChIrrGuiDriver::OnEvent(const SEvent& event)
   if (event.EventType != EET_KEY_INPUT_EVENT)
     return false;
 
-  if (event.KeyInput.PressedDown) {
+  if (!processKey(event.KeyInput))
+    return false;
+
+  // Forward the inputs right away, rather than with the next frame.
+  sendInputs();
+
+  return true;
+}
+
+bool ChIrrGuiDriver::processKey(const SEvent::SKeyInput& key)
+{
+  if (key.PressedDown) {
 
-    switch (event.KeyInput.Key) {
+    switch (key.Key) {
     case KEY_KEY_A:
       SetSteering(m_steering - m_steeringDelta);
       return true;
@@ -141,7 +181,7 @@ bool ChIrrGuiDriver::OnEvent(const SEvent& event)
 
   } else {
 
-    switch (event.KeyInput.Key) {
+    switch (key.Key) {
     case KEY_KEY_1:
       m_camera.SetState(ChChaseCamera::Chase);
       return true;
@@ -156,16 +196,26 @@ bool ChIrrGuiDriver::OnEvent(const SEvent& event)
       return true;
 
     case KEY_KEY_Z:
-      m_powertrain.SetDriveMode(ChPowertrain::FORWARD);
+      setDriveMode(ChPowertrain::FORWARD);
       return true;
     case KEY_KEY_X:
-      m_powertrain.SetDriveMode(ChPowertrain::NEUTRAL);
+      setDriveMode(ChPowertrain::NEUTRAL);
       return true;
     case KEY_KEY_C:
-      m_powertrain.SetDriveMode(ChPowertrain::REVERSE);
+      setDriveMode(ChPowertrain::REVERSE);
+      return true;
+
+    case KEY_KEY_T:
+      if (m_warping)
+        StopTimeWarp();
+      else
+        StartTimeWarp((m_proxy ? m_proxy->GetSnapshot().time : m_car.GetSystem()->GetChTime()) + m_warp_duration);
       return true;
 
     case KEY_KEY_V:
+      // The vehicle cannot be accessed while it is simulated on another thread.
+      if (m_proxy)
+        return false;
       m_car.LogConstraintViolations();
       return true;
     }
@@ -176,45 +226,75 @@ bool ChIrrGuiDriver::OnEvent(const SEvent& event)
 }
 
 
+void ChIrrGuiDriver::setDriveMode(ChPowertrain::DriveMode mode)
+{
+  if (m_proxy)
+    m_drive_mode = mode;
+  else
+    m_powertrain.SetDriveMode(mode);
+}
+
+
+// -----------------------------------------------------------------------------
+// The warp target is sent to the physics thread with the driver inputs.
+// -----------------------------------------------------------------------------
+void ChIrrGuiDriver::StartTimeWarp(double target_time)
+{
+  m_warping = true;
+  m_warp_target = target_time;
+  m_warp_frame = vehicle::ChProfiler::GetTime();
+  sendInputs();
+}
+
+void ChIrrGuiDriver::StopTimeWarp()
+{
+  if (!m_warping)
+    return;
+
+  m_warping = false;
+  sendInputs();
+}
+
+bool ChIrrGuiDriver::UpdateTimeWarp(double time)
+{
+  m_warp_time = time;
+
+  if (m_warping && (time >= m_warp_target || (m_warp_condition && (*m_warp_condition)(time))))
+    StopTimeWarp();
+
+  return m_warping;
+}
+
+bool ChIrrGuiDriver::IsTimeWarpFrame()
+{
+  double now = vehicle::ChProfiler::GetTime();
+  if (!m_warping || now - m_warp_frame < 0.5)
+    return false;
+
+  m_warp_frame = now;
+  return true;
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChIrrGuiDriver::Advance(double step)
 {
-  // Update the ChChaseCamera: take as many integration steps as needed to
-  // exactly reach the value 'step'
-  double t = 0;
-  while (t < step) {
-    double h = std::min<>(m_stepsize, step - t);
-    m_camera.Update(step);
-    t += h;
+  // Update the chase cameras (exact for any step, so a single update per
+  // frame) and the Irrlicht cameras
+  m_camera.Update(step);
+  updateCameraNode(m_camera_node, m_camera);
+
+  for (size_t i = 0; i < m_views.size(); i++) {
+    m_views[i].camera.Update(step);
+    updateCameraNode(m_views[i].node, m_views[i].camera);
   }
 
-  // Update the Irrlicht camera
-  ChVector<> cam_pos = m_camera.GetCameraPos();
-  ChVector<> cam_target = m_camera.GetTargetPos();
-
-  scene::ICameraSceneNode *camera = m_app.GetSceneManager()->getActiveCamera();
-
-  camera->setPosition(core::vector3df((f32)cam_pos.x, (f32)cam_pos.y, (f32)cam_pos.z));
-  camera->setTarget(core::vector3df((f32)cam_target.x, (f32)cam_target.y, (f32)cam_target.z));
-
-#if IRRKLANG_ENABLED
-  static int stepsbetweensound = 0;
-
-  // Update sound pitch
-  if (m_car_sound) {
-    stepsbetweensound++;
-    double engine_rpm = m_powertrain.GetMotorSpeed() * 60 / chrono::CH_C_2PI;
-    double soundspeed = engine_rpm / (8000.); // denominator: to guess
-    if (soundspeed < 0.1) soundspeed = 0.1;
-    if (stepsbetweensound > 20) {
-      stepsbetweensound = 0;
-      if (m_car_sound->getIsPaused())
-        m_car_sound->setIsPaused(false);
-      m_car_sound->setPlaybackSpeed((irrklang::ik_f32)soundspeed);
-    }
+  // Post the engine state to the sound player (never blocks)
+  if (m_sound_player) {
+    double motor_speed = m_proxy ? m_proxy->GetSnapshot().motor_speed : m_powertrain.GetMotorSpeed();
+    m_sound_player->Post(motor_speed, m_throttle);
   }
-#endif
 
 }
 
@@ -223,50 +303,240 @@ void ChIrrGuiDriver::Advance(double step)
 // -----------------------------------------------------------------------------
 void ChIrrGuiDriver::DrawAll()
 {
-  renderGrid();
+  CH_PROFILE_SCOPE("ChIrrGuiDriver::DrawAll");
 
-  m_app.DrawAll();
+  updateLinkLists();
+  m_line_vertices.clear();
+  m_line_indices.clear();
 
   renderSprings();
   renderLinks();
+
+  // Draw the additional views first, then the main view (with the HUD).
+  video::IVideoDriver* driver = m_app.GetVideoDriver();
+  scene::ISceneManager* smgr = m_app.GetSceneManager();
+
+  for (size_t i = 0; i < m_views.size(); i++) {
+    core::rect<s32> rect = getViewRect((int)i + 1);
+    driver->setViewPort(rect);
+    m_views[i].node->setAspectRatio((f32)rect.getWidth() / rect.getHeight());
+    smgr->setActiveCamera(m_views[i].node);
+    smgr->drawAll();
+    renderGrid();
+    renderLines();
+  }
+
+  if (!m_views.empty()) {
+    core::rect<s32> rect = getViewRect(0);
+    driver->setViewPort(rect);
+    m_camera_node->setAspectRatio((f32)rect.getWidth() / rect.getHeight());
+    smgr->setActiveCamera(m_camera_node);
+  }
+
+  renderGrid();
+
+  m_app.DrawAll();
+
+  renderLines();
   renderStats();
+
+  if (!m_views.empty()) {
+    const core::dimension2d<u32>& size = driver->getScreenSize();
+    driver->setViewPort(core::rect<s32>(0, 0, size.Width, size.Height));
+  }
+
+  // Retry inputs that could not be queued (no-op if already sent).
+  sendInputs();
+}
+
+void ChIrrGuiDriver::sendInputs()
+{
+  if (!m_proxy)
+    return;
+
+  ChRenderProxy::Inputs inputs;
+  inputs.steering = m_steering;
+  inputs.throttle = m_throttle;
+  inputs.braking = m_braking;
+  inputs.drive_mode = m_drive_mode;
+  inputs.warp_time = m_warping ? m_warp_target : 0;
+  m_proxy->SendInputs(inputs);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChIrrGuiDriver::AddView(ChSharedBodyPtr      chassis,
+                            const ChVector<>&    ptOnChassis,
+                            const ChCoordsys<>&  driverCsys,
+                            double               chaseDist,
+                            double               chaseHeight)
+{
+  ChChaseCamera camera(chassis);
+  camera.Initialize(ptOnChassis, driverCsys, chaseDist, chaseHeight);
+
+  scene::ICameraSceneNode* node = m_app.GetSceneManager()->addCameraSceneNode(
+    m_app.GetSceneManager()->getRootSceneNode(),
+    core::vector3df(0, 0, 0), core::vector3df(0, 0, 0), -1, false);
+  node->setUpVector(core::vector3df(0, 0, 1));
+  updateCameraNode(node, camera);
+
+  m_views.push_back(View(camera, node));
+
+  return (int)m_views.size();
+}
+
+// The views are arranged in a grid, row by row, with as many columns as rows
+// (or one more).
+core::rect<s32> ChIrrGuiDriver::getViewRect(int view) const
+{
+  const core::dimension2d<u32>& size = m_app.GetVideoDriver()->getScreenSize();
+
+  int num_views = GetNumViews();
+  int cols = (int)std::ceil(std::sqrt((double)num_views));
+  int rows = (num_views + cols - 1) / cols;
+
+  int w = size.Width / cols;
+  int h = size.Height / rows;
+  int x = (view % cols) * w;
+  int y = (view / cols) * h;
+
+  return core::rect<s32>(x, y, x + w, y + h);
+}
+
+void ChIrrGuiDriver::updateCameraNode(scene::ICameraSceneNode* node, const ChChaseCamera& camera)
+{
+  ChVector<> cam_pos = camera.GetCameraPos();
+  ChVector<> cam_target = camera.GetTargetPos();
+
+  node->setPosition(core::vector3df((f32)cam_pos.x, (f32)cam_pos.y, (f32)cam_pos.z));
+  node->setTarget(core::vector3df((f32)cam_target.x, (f32)cam_target.y, (f32)cam_target.z));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChIrrGuiDriver::updateLinkLists()
+{
+  std::vector<ChLink*>* links = m_app.GetSystem()->Get_linklist();
+  if (links->size() == m_num_links)
+    return;
+
+  m_num_links = links->size();
+  m_springs.clear();
+  m_springsCB.clear();
+  m_distances.clear();
+  m_revsphs.clear();
+
+  std::vector<ChLink*>::iterator ilink = links->begin();
+  for (; ilink != links->end(); ++ilink) {
+    if (ChLinkSpring* link = dynamic_cast<ChLinkSpring*>(*ilink))
+      m_springs.push_back(link);
+    else if (ChLinkSpringCB* link = dynamic_cast<ChLinkSpringCB*>(*ilink))
+      m_springsCB.push_back(link);
+    else if (ChLinkDistance* link = dynamic_cast<ChLinkDistance*>(*ilink))
+      m_distances.push_back(link);
+    else if (ChLinkRevoluteSpherical* link = dynamic_cast<ChLinkRevoluteSpherical*>(*ilink))
+      m_revsphs.push_back(link);
+  }
 }
 
 void ChIrrGuiDriver::renderSprings()
 {
-  std::vector<chrono::ChLink*>::iterator ilink = m_app.GetSystem()->Get_linklist()->begin();
-  for (; ilink != m_app.GetSystem()->Get_linklist()->end(); ++ilink) {
-    if (ChLinkSpring* link = dynamic_cast<ChLinkSpring*>(*ilink)) {
-      ChIrrTools::drawSpring(m_app.GetVideoDriver(), 0.05,
-        link->GetEndPoint1Abs(),
-        link->GetEndPoint2Abs(),
-        video::SColor(255, 150, 20, 20), 80, 15, true);
-    }
-    else if (ChLinkSpringCB* link = dynamic_cast<ChLinkSpringCB*>(*ilink)) {
-      ChIrrTools::drawSpring(m_app.GetVideoDriver(), 0.05,
-        link->GetEndPoint1Abs(),
-        link->GetEndPoint2Abs(),
-        video::SColor(255, 150, 20, 20), 80, 15, true);
-    }
+  video::SColor color(255, 150, 20, 20);
+
+  if (m_proxy) {
+    const std::vector<ChVector<> >& springs = m_proxy->GetSnapshot().springs;
+    for (size_t i = 0; i < springs.size(); i += 2)
+      addSpring(springs[i], springs[i + 1], color);
+    return;
   }
+
+  for (size_t i = 0; i < m_springs.size(); i++)
+    addSpring(m_springs[i]->GetEndPoint1Abs(), m_springs[i]->GetEndPoint2Abs(), color);
+
+  for (size_t i = 0; i < m_springsCB.size(); i++)
+    addSpring(m_springsCB[i]->GetEndPoint1Abs(), m_springsCB[i]->GetEndPoint2Abs(), color);
 }
 
 void ChIrrGuiDriver::renderLinks()
 {
-  std::vector<chrono::ChLink*>::iterator ilink = m_app.GetSystem()->Get_linklist()->begin();
-  for (; ilink != m_app.GetSystem()->Get_linklist()->end(); ++ilink) {
-    if (ChLinkDistance* link = dynamic_cast<ChLinkDistance*>(*ilink)) {
-      ChIrrTools::drawSegment(m_app.GetVideoDriver(),
-                              link->GetEndPoint1Abs(),
-                              link->GetEndPoint2Abs(),
-                              video::SColor(255, 0, 20, 0), true);
-    }
-    else if (ChLinkRevoluteSpherical* link = dynamic_cast<ChLinkRevoluteSpherical*>(*ilink)) {
-      ChIrrTools::drawSegment(m_app.GetVideoDriver(),
-                              link->GetPoint1Abs(),
-                              link->GetPoint2Abs(),
-                              video::SColor(255, 180, 0, 0), true);
-    }
+  if (m_proxy) {
+    const ChRenderProxy::Snapshot& snapshot = m_proxy->GetSnapshot();
+    for (size_t i = 0; i < snapshot.distances.size(); i += 2)
+      addSegment(snapshot.distances[i], snapshot.distances[i + 1], video::SColor(255, 0, 20, 0));
+    for (size_t i = 0; i < snapshot.revsphs.size(); i += 2)
+      addSegment(snapshot.revsphs[i], snapshot.revsphs[i + 1], video::SColor(255, 180, 0, 0));
+    return;
+  }
+
+  for (size_t i = 0; i < m_distances.size(); i++)
+    addSegment(m_distances[i]->GetEndPoint1Abs(), m_distances[i]->GetEndPoint2Abs(),
+               video::SColor(255, 0, 20, 0));
+
+  for (size_t i = 0; i < m_revsphs.size(); i++)
+    addSegment(m_revsphs[i]->GetPoint1Abs(), m_revsphs[i]->GetPoint2Abs(),
+               video::SColor(255, 180, 0, 0));
+}
+
+void ChIrrGuiDriver::renderLines()
+{
+  if (m_line_indices.empty())
+    return;
+
+  video::IVideoDriver* driver = m_app.GetVideoDriver();
+
+  driver->setTransform(video::ETS_WORLD, core::matrix4());
+  video::SMaterial material;
+  material.ZBuffer = true;
+  material.Lighting = false;
+  driver->setMaterial(material);
+
+  driver->drawVertexPrimitiveList(&m_line_vertices[0], (u32)m_line_vertices.size(),
+                                  &m_line_indices[0], (u32)m_line_indices.size() / 2,
+                                  video::EVT_STANDARD, scene::EPT_LINES, video::EIT_32BIT);
+}
+
+void ChIrrGuiDriver::addSegment(const ChVector<>& start, const ChVector<>& end, video::SColor color)
+{
+  u32 index = (u32)m_line_vertices.size();
+
+  m_line_vertices.push_back(video::S3DVertex((f32)start.x, (f32)start.y, (f32)start.z, 0, 0, 1, color, 0, 0));
+  m_line_vertices.push_back(video::S3DVertex((f32)end.x, (f32)end.y, (f32)end.z, 0, 0, 1, color, 0, 0));
+  m_line_indices.push_back(index);
+  m_line_indices.push_back(index + 1);
+}
+
+// Helix of radius 0.05 with 15 turns, approximated with 80 segments (as drawn
+// by ChIrrTools::drawSpring).
+void ChIrrGuiDriver::addSpring(const ChVector<>& start, const ChVector<>& end, video::SColor color)
+{
+  static const double radius = 0.05;
+  static const double turns = 15;
+  static const int    resolution = 80;
+
+  ChVector<> axis = end - start;
+  double length = axis.Length();
+  if (length < 1e-9)
+    return;
+  axis /= length;
+
+  // Two unit vectors perpendicular to the spring axis.
+  ChVector<> ref = (std::abs(axis.y) < 0.9) ? ChVector<>(0, 1, 0) : ChVector<>(0, 0, 1);
+  ChVector<> v = Vcross(axis, ref);
+  v.Normalize();
+  ChVector<> u = Vcross(v, axis);
+
+  u32 index = (u32)m_line_vertices.size();
+
+  for (int iu = 0; iu <= resolution; iu++) {
+    double t = (double)iu / resolution;
+    double phase = turns * CH_C_2PI * t;
+    ChVector<> pt = start + (length * t) * axis + (radius * std::cos(phase)) * u + (radius * std::sin(phase)) * v;
+    m_line_vertices.push_back(video::S3DVertex((f32)pt.x, (f32)pt.y, (f32)pt.z, 0, 0, 1, color, 0, 0));
+  }
+
+  for (int iu = 0; iu < resolution; iu++) {
+    m_line_indices.push_back(index + iu);
+    m_line_indices.push_back(index + iu + 1);
   }
 }
 
@@ -282,90 +552,100 @@ void ChIrrGuiDriver::renderGrid()
                        true);
 }
 
-void ChIrrGuiDriver::renderLinGauge(const std::string& msg,
-                                    double factor, bool sym,
-                                    int xpos, int ypos,
-                                    int length, int height)
+// -----------------------------------------------------------------------------
+// The HUD layout is defined once; renderStats() only sets the item values.
+// -----------------------------------------------------------------------------
+void ChIrrGuiDriver::createHUD()
 {
-  irr::core::rect<s32> mclip(xpos,ypos, xpos+length, ypos+height);
-  m_app.GetVideoDriver()->draw2DRectangle(
-            irr::video::SColor(90,60,60,60),
-            irr::core::rect<s32>(xpos,ypos, xpos+length, ypos+height),
-            &mclip);
-
-  int left  = sym ? (int)((length/2 - 2) * std::min<>(factor,0.0) + length/2) : 2;
-  int right = sym ? (int)((length/2 - 2) * std::max<>(factor,0.0) + length/2) : (int)((length - 4)*factor + 2);
-
-  m_app.GetVideoDriver()->draw2DRectangle(
-            irr::video::SColor(255,250,200,00),
-            irr::core::rect<s32>(xpos+left, ypos+2, xpos+right, ypos+height-2),
-            &mclip);
-
-  irr::gui::IGUIFont* font = m_app.GetIGUIEnvironment()->getBuiltInFont();
-  font->draw(msg.c_str(),
-             irr::core::rect<s32>(xpos+3,ypos+3, xpos+length, ypos+height),
-             irr::video::SColor(255,20,20,20));
-}
+  m_hud_camera = m_hud.AddTextBox("Camera mode: %s", 10);
+  m_hud_warp = m_hud.AddTextBox("Time warp: %s", 25);
+  m_hud.SetVisible(m_hud_warp, false);
+
+  m_hud_steering = m_hud.AddGauge("Steering: %+.2f", 1, true, 40);
+  m_hud_throttle = m_hud.AddGauge("Throttle: %+.2f", 0.01, false, 60);
+  m_hud_braking = m_hud.AddGauge("Braking: %+.2f", 0.01, false, 80);
+  m_hud_speed = m_hud.AddGauge("Speed: %+.2f", 1.0 / 30, false, 100);
+
+  m_hud_rpm = m_hud.AddGauge("Eng. RPM: %+.2f", 1.0 / 7000, false, 120);
+  m_hud_motor_torque = m_hud.AddGauge("Eng. Nm: %+.2f", 1.0 / 600, false, 140);
+  m_hud_tc_slip = m_hud.AddGauge("T.conv. slip: %+.2f", 1, false, 160);
+  m_hud_tc_torque_in = m_hud.AddGauge("T.conv. in  Nm: %+.2f", 1.0 / 600, false, 180);
+  m_hud_tc_torque_out = m_hud.AddGauge("T.conv. out Nm: %+.2f", 1.0 / 600, false, 200);
+  m_hud_gear = m_hud.AddGauge("", 1.0 / 4, false, 220);
+
+  if (m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline2WD>()) {
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel L: %+.2f", 1.0 / 5000, false, 260));
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel R: %+.2f", 1.0 / 5000, false, 280));
+  } else if (m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline4WD>()) {
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel FL: %+.2f", 1.0 / 5000, false, 260));
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel FR: %+.2f", 1.0 / 5000, false, 280));
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel RL: %+.2f", 1.0 / 5000, false, 300));
+    m_hud_wheel_torques.push_back(m_hud.AddGauge("Torque wheel RR: %+.2f", 1.0 / 5000, false, 320));
+  }
 
-void ChIrrGuiDriver::renderTextBox(const std::string& msg,
-                                   int xpos, int ypos,
-                                   int length, int height)
-{
-  irr::core::rect<s32> mclip(xpos, ypos, xpos + length, ypos + height);
-  m_app.GetVideoDriver()->draw2DRectangle(
-    irr::video::SColor(90, 60, 60, 60),
-    irr::core::rect<s32>(xpos, ypos, xpos + length, ypos + height),
-    &mclip);
-
-  irr::gui::IGUIFont* font = m_app.GetIGUIEnvironment()->getBuiltInFont();
-  font->draw(msg.c_str(),
-    irr::core::rect<s32>(xpos + 3, ypos + 3, xpos + length, ypos + height),
-    irr::video::SColor(255, 20, 20, 20));
+#if PROFILING_ENABLED
+  // Time per frame of the main modules, as recorded by this thread.
+  static const char* sections[] = {
+    "ChVehicle::Advance",
+    "ChTire::Advance",
+    "ChPowertrain::Advance",
+    "ChTerrain::Advance",
+    "ChIrrGuiDriver::DrawAll"
+  };
+  static const char* labels[] = {
+    "Vehicle ms: %.3f",
+    "Tires ms: %.3f",
+    "Powertrain ms: %.3f",
+    "Terrain ms: %.3f",
+    "Render ms: %.3f"
+  };
+  int num_sections = (int)(sizeof(sections) / sizeof(sections[0]));
+
+  int ypos = 260 + 20 * (int)m_hud_wheel_torques.size() + 20;
+  for (int i = 0; i < num_sections; i++) {
+    m_timer_sections.push_back(vehicle::ChProfiler::RegisterSection(sections[i]));
+    m_hud_timers.push_back(m_hud.AddGauge(labels[i], 1.0 / 20, false, ypos + 20 * i));
+  }
+  m_timer_totals.resize(num_sections, 0.0);
+  for (int i = 0; i < num_sections; i++) {
+    long count;
+    vehicle::ChProfiler::GetThreadStats(m_timer_sections[i], count, m_timer_totals[i]);
+  }
+#endif
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
 void ChIrrGuiDriver::renderStats()
 {
-  char msg[100];
+  const ChRenderProxy::Snapshot* snapshot = m_proxy ? &m_proxy->GetSnapshot() : 0;
 
-  sprintf(msg, "Camera mode: %s", m_camera.GetStateName().c_str());
-  renderTextBox(std::string(msg), m_HUD_x, m_HUD_y + 10, 120, 15);
+  m_hud.SetText(m_hud_camera, m_camera.GetStateName().c_str());
 
-  sprintf(msg, "Steering: %+.2f", m_steering);
-  renderLinGauge(std::string(msg), m_steering, true, m_HUD_x, m_HUD_y + 40, 120, 15);
-
-  sprintf(msg, "Throttle: %+.2f", m_throttle*100.);
-  renderLinGauge(std::string(msg), m_throttle, false, m_HUD_x, m_HUD_y + 60, 120, 15);
-
-  sprintf(msg, "Braking: %+.2f", m_braking*100.);
-  renderLinGauge(std::string(msg), m_braking, false, m_HUD_x, m_HUD_y + 80, 120, 15);
-
-  double speed = m_car.GetVehicleSpeed();
-  sprintf(msg, "Speed: %+.2f", speed);
-  renderLinGauge(std::string(msg), speed/30, false, m_HUD_x, m_HUD_y + 100, 120, 15);
-
-
-  double engine_rpm = m_powertrain.GetMotorSpeed() * 60 / chrono::CH_C_2PI;
-  sprintf(msg, "Eng. RPM: %+.2f", engine_rpm);
-  renderLinGauge(std::string(msg), engine_rpm / 7000, false, m_HUD_x, m_HUD_y + 120, 120, 15);
+  m_hud.SetVisible(m_hud_warp, m_warping);
+  if (m_warping) {
+    char msg[ChIrrHUD::MAX_TEXT];
+    sprintf(msg, "%.1f / %.1f s", m_warp_time, m_warp_target);
+    m_hud.SetText(m_hud_warp, msg);
+  }
 
-  double engine_torque = m_powertrain.GetMotorTorque();
-  sprintf(msg, "Eng. Nm: %+.2f", engine_torque);
-  renderLinGauge(std::string(msg), engine_torque / 600, false, m_HUD_x, m_HUD_y + 140, 120, 15);
+  m_hud.SetValue(m_hud_steering, m_steering);
+  m_hud.SetValue(m_hud_throttle, m_throttle * 100);
+  m_hud.SetValue(m_hud_braking, m_braking * 100);
 
-  double tc_slip = m_powertrain.GetTorqueConverterSlippage();
-  sprintf(msg, "T.conv. slip: %+.2f", tc_slip);
-  renderLinGauge(std::string(msg), tc_slip / 1, false, m_HUD_x, m_HUD_y + 160, 120, 15);
+  m_hud.SetValue(m_hud_speed, snapshot ? snapshot->speed : m_car.GetVehicleSpeed());
 
-  double tc_torquein = m_powertrain.GetTorqueConverterInputTorque();
-  sprintf(msg, "T.conv. in  Nm: %+.2f", tc_torquein);
-  renderLinGauge(std::string(msg), tc_torquein / 600, false, m_HUD_x, m_HUD_y + 180, 120, 15);
+  double motor_speed = snapshot ? snapshot->motor_speed : m_powertrain.GetMotorSpeed();
+  m_hud.SetValue(m_hud_rpm, motor_speed * 60 / chrono::CH_C_2PI);
 
-  double tc_torqueout = m_powertrain.GetTorqueConverterOutputTorque();
-  sprintf(msg, "T.conv. out Nm: %+.2f", tc_torqueout);
-  renderLinGauge(std::string(msg), tc_torqueout / 600, false, m_HUD_x, m_HUD_y + 200, 120, 15);
+  m_hud.SetValue(m_hud_motor_torque, snapshot ? snapshot->motor_torque : m_powertrain.GetMotorTorque());
+  m_hud.SetValue(m_hud_tc_slip, snapshot ? snapshot->tc_slip : m_powertrain.GetTorqueConverterSlippage());
+  m_hud.SetValue(m_hud_tc_torque_in, snapshot ? snapshot->tc_torque_in : m_powertrain.GetTorqueConverterInputTorque());
+  m_hud.SetValue(m_hud_tc_torque_out, snapshot ? snapshot->tc_torque_out : m_powertrain.GetTorqueConverterOutputTorque());
 
-  int ngear = m_powertrain.GetCurrentTransmissionGear();
-  ChPowertrain::DriveMode drivemode = m_powertrain.GetDriveMode();
+  int ngear = snapshot ? snapshot->gear : m_powertrain.GetCurrentTransmissionGear();
+  ChPowertrain::DriveMode drivemode = snapshot ? snapshot->drive_mode : m_powertrain.GetDriveMode();
+  char msg[ChIrrHUD::MAX_TEXT];
   switch (drivemode)
   {
   case ChPowertrain::FORWARD:
@@ -381,44 +661,59 @@ void ChIrrGuiDriver::renderStats()
     sprintf(msg, "Gear:");
     break;
   }
-  renderLinGauge(std::string(msg), (double)ngear / 4.0, false, m_HUD_x, m_HUD_y + 220, 120, 15);
-
+  m_hud.SetGauge(m_hud_gear, msg, ngear);
 
-  if (ChSharedPtr<ChShaftsDriveline2WD> driveline = m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline2WD>())
-  {
-    double torque;
-    int axle = driveline->GetDrivenAxleIndexes()[0];
+  // The driveline is not part of the snapshots.
+  for (size_t i = 0; i < m_hud_wheel_torques.size(); i++)
+    m_hud.SetVisible(m_hud_wheel_torques[i], m_proxy == 0);
 
-    torque = driveline->GetWheelTorque(ChWheelID(axle, LEFT));
-    sprintf(msg, "Torque wheel L: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 260, 120, 15);
+  if (!m_proxy) {
+    if (ChSharedPtr<ChShaftsDriveline2WD> driveline = m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline2WD>())
+    {
+      int axle = driveline->GetDrivenAxleIndexes()[0];
 
-    torque = driveline->GetWheelTorque(ChWheelID(axle, RIGHT));
-    sprintf(msg, "Torque wheel R: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 280, 120, 15);
+      m_hud.SetValue(m_hud_wheel_torques[0], driveline->GetWheelTorque(ChWheelID(axle, LEFT)));
+      m_hud.SetValue(m_hud_wheel_torques[1], driveline->GetWheelTorque(ChWheelID(axle, RIGHT)));
+    }
+    else if (ChSharedPtr<ChShaftsDriveline4WD> driveline = m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline4WD>())
+    {
+      std::vector<int> axles = driveline->GetDrivenAxleIndexes();
+
+      m_hud.SetValue(m_hud_wheel_torques[0], driveline->GetWheelTorque(ChWheelID(axles[0], LEFT)));
+      m_hud.SetValue(m_hud_wheel_torques[1], driveline->GetWheelTorque(ChWheelID(axles[0], RIGHT)));
+      m_hud.SetValue(m_hud_wheel_torques[2], driveline->GetWheelTorque(ChWheelID(axles[1], LEFT)));
+      m_hud.SetValue(m_hud_wheel_torques[3], driveline->GetWheelTorque(ChWheelID(axles[1], RIGHT)));
+    }
   }
-  else if (ChSharedPtr<ChShaftsDriveline4WD> driveline = m_car.GetDriveline().DynamicCastTo<ChShaftsDriveline4WD>())
-  {
-    double torque;
-    std::vector<int> axles = driveline->GetDrivenAxleIndexes();
 
-    torque = driveline->GetWheelTorque(ChWheelID(axles[0], LEFT));
-    sprintf(msg, "Torque wheel FL: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 260, 120, 15);
+  renderTimers();
+
+  m_hud.Draw();
+}
+
+// -----------------------------------------------------------------------------
+// The timers are updated every few frames, with the mean time per frame over
+// these frames, such that their text is not laid out again at every frame.
+// -----------------------------------------------------------------------------
+void ChIrrGuiDriver::renderTimers()
+{
+  static const int update_frames = 10;
+
+  if (m_hud_timers.empty() || ++m_timer_frames < update_frames)
+    return;
 
-    torque = driveline->GetWheelTorque(ChWheelID(axles[0], RIGHT));
-    sprintf(msg, "Torque wheel FR: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 280, 120, 15);
+  for (size_t i = 0; i < m_hud_timers.size(); i++) {
+    long count;
+    double total;
+    vehicle::ChProfiler::GetThreadStats(m_timer_sections[i], count, total);
 
-    torque = driveline->GetWheelTorque(ChWheelID(axles[1], LEFT));
-    sprintf(msg, "Torque wheel RL: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 300, 120, 15);
+    double ms = 1e3 * (total - m_timer_totals[i]) / m_timer_frames;
+    m_timer_totals[i] = total;
 
-    torque = driveline->GetWheelTorque(ChWheelID(axles[1], RIGHT));
-    sprintf(msg, "Torque wheel FR: %+.2f", torque);
-    renderLinGauge(std::string(msg), torque / 5000, false, m_HUD_x, m_HUD_y + 320, 120, 15);
+    m_hud.SetValue(m_hud_timers[i], ms);
   }
 
+  m_timer_frames = 0;
 }
 
 
@@ -23,6 +23,12 @@
 //  - provides support for rendering links, force elements, displaying stats,
 //    etc.  In order to render these elements, call the its DrawAll() method
 //    instead of ChIrrAppInterface::DrawAll().
+//  - optionally splits the screen in several views, each with its own chase
+//    camera (e.g. following the vehicles of a convoy).
+//  - a time warp mode (key T), in which the simulation runs as fast as it can,
+//    with no rendering and no real-time pacing, up to a target time or until a
+//    condition is met, and then resumes interactively. The simulation loop
+//    must query UpdateTimeWarp() every step (see demo_HMMWV).
 //
 // =============================================================================
 
@@ -36,15 +42,14 @@
 #include "ChronoVehicle_config.h"
 
 #include "subsys/driver/ChChaseCamera.h"
+#include "subsys/driver/ChIrrHUD.h"
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChDriver.h"
 #include "subsys/ChVehicle.h"
 #include "subsys/ChPowertrain.h"
-
-#if IRRKLANG_ENABLED
-#include <irrKlang.h>
-#endif
+#include "subsys/driver/ChRenderProxy.h"
+#include "subsys/driver/ChVehicleSound.h"
 
 
 
@@ -54,6 +59,17 @@ class CH_SUBSYS_API ChIrrGuiDriver : public ChDriver, public irr::IEventReceiver
 {
 public:
 
+  /// Condition ending a time warp before its target time (e.g. the vehicle
+  /// reaching a point of the maneuver).
+  class TimeWarpCondition
+  {
+  public:
+    virtual ~TimeWarpCondition() {}
+
+    /// Return true to end the time warp at the specified simulation time.
+    virtual bool operator()(double time) = 0;
+  };
+
   ChIrrGuiDriver(
     irr::ChIrrApp&      app,
     ChVehicle&          car,
@@ -66,7 +82,7 @@ public:
     int                 HUD_y = 20
     );
 
-  ~ChIrrGuiDriver() {}
+  ~ChIrrGuiDriver();
 
   virtual bool OnEvent(const irr::SEvent& event);
 
@@ -80,30 +96,112 @@ public:
   void SetSteeringDelta(double delta)  { m_steeringDelta = delta; }
   void SetBrakingDelta (double delta)  { m_brakingDelta = delta; }
 
-  void SetStepsize(double val) { m_stepsize = val; }
-  double GetStepsize() const { return m_stepsize; }
+  /// Get the current position of the chase camera.
+  ChVector<> GetCameraPos() const { return m_camera.GetCameraPos(); }
+
+  /// Add a split-screen view, with its own chase camera following the
+  /// specified body (e.g. the chassis, or its render proxy, of another vehicle
+  /// in a convoy). The screen is divided in a grid of equal views; the first
+  /// one (top left) follows this driver's vehicle and shows the HUD.
+  /// Returns the index of the new view.
+  int AddView(
+    ChSharedBodyPtr      chassis,       ///< [in] followed body
+    const ChVector<>&    ptOnChassis,   ///< [in] tracked point, in the body frame
+    const ChCoordsys<>&  driverCsys,    ///< [in] driver position, in the body frame
+    double               chaseDist,     ///< [in] chase distance
+    double               chaseHeight    ///< [in] chase height
+    );
+
+  /// Get the number of views (including the main view).
+  int GetNumViews() const { return 1 + (int)m_views.size(); }
+
+  /// Set the simulation time skipped by a time warp started with the T key
+  /// (default: 30 s). Pressing T again during the warp ends it.
+  void SetTimeWarpDuration(double duration) { m_warp_duration = duration; }
+
+  /// Set a condition ending the time warps early (NULL for none). The
+  /// condition is evaluated by UpdateTimeWarp(); it must stay valid while set.
+  void SetTimeWarpCondition(TimeWarpCondition* condition) { m_warp_condition = condition; }
+
+  /// Start a time warp up to the specified simulation time.
+  void StartTimeWarp(double target_time);
+
+  /// End the current time warp (no-op if none).
+  void StopTimeWarp();
+
+  /// Return true during a time warp.
+  bool IsTimeWarping() const { return m_warping; }
+
+  /// Update the time warp at the specified simulation time (the time of the
+  /// vehicle system, or of the proxy snapshot with a render proxy): end it if
+  /// the target time is reached or the condition is met. Returns true during
+  /// the time warp, in which case the simulation loop should skip rendering
+  /// (except at the frames selected by IsTimeWarpFrame()) and the real-time
+  /// pacing. With a render proxy, the physics thread stops pacing itself
+  /// during the warp, and the rendering can go on.
+  bool UpdateTimeWarp(double time);
+
+  /// Return true, during a time warp, if a progress frame is due (at most two
+  /// per second of wall clock time), so that the window stays responsive.
+  bool IsTimeWarpFrame();
+
+  /// Render the vehicle from the snapshots of the specified proxy, with the
+  /// simulation running on a separate thread. The application must then be
+  /// attached to the render system of the proxy; the driver inputs (including
+  /// drive mode changes) are sent to the proxy, as timestamped events, as soon
+  /// as a key event changes them (see ChRenderProxy::SendInputs()).
+  void SetRenderProxy(ChRenderProxy* proxy);
 
 private:
 
+  // Process a key event; returns true if the event was handled.
+  bool processKey(const irr::SEvent::SKeyInput& key);
+
+  // Send the current inputs to the proxy (if any).
+  void sendInputs();
+
+  // Change the powertrain drive mode (directly or through the proxy).
+  void setDriveMode(ChPowertrain::DriveMode mode);
+
+  // Rebuild the lists of rendered links if the number of links changed.
+  void updateLinkLists();
+
+  // Append the geometry of the springs and of the rendered links to the line
+  // buffer, drawn at once by renderLines().
   void renderSprings();
   void renderLinks();
+  void renderLines();
+
+  void addSegment(const ChVector<>& start, const ChVector<>& end, irr::video::SColor color);
+  void addSpring(const ChVector<>& start, const ChVector<>& end, irr::video::SColor color);
+
   void renderGrid();
+
+  // Screen rectangle of the specified view.
+  irr::core::rect<irr::s32> getViewRect(int view) const;
+
+  // Set the Irrlicht camera from a chase camera.
+  static void updateCameraNode(irr::scene::ICameraSceneNode* node, const ChChaseCamera& camera);
+
+  // Define the HUD layout (once) and update the HUD values (every frame).
+  void createHUD();
   void renderStats();
-  void renderLinGauge(const std::string& msg,
-                      double factor, bool sym,
-                      int xpos, int ypos,
-                      int length = 120, int height = 15);
-  void renderTextBox(const std::string& msg,
-                     int xpos, int ypos,
-                     int length = 120, int height = 15);
+  void renderTimers();
 
   irr::ChIrrAppInterface&   m_app;
   ChVehicle&                m_car;
   ChPowertrain&             m_powertrain;
 
   ChChaseCamera             m_camera;
+  irr::scene::ICameraSceneNode*  m_camera_node;
 
-  double m_stepsize;
+  // Additional split-screen views
+  struct View {
+    View(const ChChaseCamera& cam, irr::scene::ICameraSceneNode* cam_node) : camera(cam), node(cam_node) {}
+    ChChaseCamera                  camera;
+    irr::scene::ICameraSceneNode*  node;
+  };
+  std::vector<View>         m_views;
 
   double m_terrainHeight;
   double m_throttleDelta;
@@ -113,12 +211,53 @@ private:
   int  m_HUD_x;
   int  m_HUD_y;
 
+  // HUD items
+  ChIrrHUD  m_hud;
+  int       m_hud_camera;
+  int       m_hud_steering;
+  int       m_hud_throttle;
+  int       m_hud_braking;
+  int       m_hud_speed;
+  int       m_hud_rpm;
+  int       m_hud_motor_torque;
+  int       m_hud_tc_slip;
+  int       m_hud_tc_torque_in;
+  int       m_hud_tc_torque_out;
+  int       m_hud_gear;
+  std::vector<int>   m_hud_wheel_torques;    // one per driven wheel
+
+  // Per-module timers (PROFILING_ENABLED only), averaged over a few frames
+  std::vector<int>     m_hud_timers;
+  std::vector<int>     m_timer_sections;
+  std::vector<double>  m_timer_totals;       // section totals at the last update
+  int                  m_timer_frames;       // frames since the last update
+
   bool m_sound;
 
-#if IRRKLANG_ENABLED
-  irrklang::ISoundEngine* m_sound_engine;   // Sound player
-  irrklang::ISound*       m_car_sound;      // Sound
-#endif
+  // Time warp
+  bool                 m_warping;
+  double               m_warp_target;        // simulation time ending the warp
+  double               m_warp_duration;      // time skipped by the T key
+  double               m_warp_time;          // simulation time at the last update
+  double               m_warp_frame;         // wall clock time of the last progress frame
+  TimeWarpCondition*   m_warp_condition;
+  int                  m_hud_warp;
+
+  ChRenderProxy*            m_proxy;        // if set, all vehicle data comes from its snapshots
+  ChPowertrain::DriveMode   m_drive_mode;   // drive mode requested through the proxy
+
+  // Rendered links, cached by type (see updateLinkLists())
+  size_t                                  m_num_links;
+  std::vector<ChLinkSpring*>              m_springs;
+  std::vector<ChLinkSpringCB*>            m_springsCB;
+  std::vector<ChLinkDistance*>            m_distances;
+  std::vector<ChLinkRevoluteSpherical*>   m_revsphs;
+
+  // Line buffer (pairs of vertices), refilled every frame
+  std::vector<irr::video::S3DVertex>      m_line_vertices;
+  std::vector<irr::u32>                   m_line_indices;
+
+  ChVehicleSound*           m_sound_player; // engine sound, updated on its own thread
 
 };
 
@@ -44,7 +44,6 @@ ChIrrGuiST::ChIrrGuiST(ChIrrApp&          app,
   m_terrainHeight(0),
   m_steeringDelta(steer_limit/50.0),
   m_postDelta(shaker_limit/50.0),
-  m_stepsize(1e-3),
   m_post_L_disp(0),
   m_post_R_disp(0),
   m_steer_lim(steer_limit),
@@ -143,14 +142,8 @@ bool ChIrrGuiST::OnEvent(const SEvent& event)
 // -----------------------------------------------------------------------------
 void ChIrrGuiST::Advance(double step)
 {
-  // Update the ChChaseCamera: take as many integration steps as needed to
-  // exactly reach the value 'step'
-  double t = 0;
-  while (t < step) {
-    double h = std::min<>(m_stepsize, step - t);
-    m_camera.Update(step);
-    t += h;
-  }
+  // Update the ChChaseCamera (exact for any step)
+  m_camera.Update(step);
 
   // Update the Irrlicht camera
   ChVector<> cam_pos = m_camera.GetCameraPos();
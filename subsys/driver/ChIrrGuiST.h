@@ -64,12 +64,10 @@ public:
   void SetSteeringDelta(double delta) {m_steeringDelta = delta; }
   void SetPostDelta(double delta) {m_postDelta = delta; }
   void SetTerrainHeight(double height) { m_terrainHeight = height; }
-  void SetStepsize(double val) { m_stepsize = val; }
 
 
   // Accessors
  
-  double GetStepsize() const { return m_stepsize; }
   /// Get the left post z displacement
   double Get_post_z_L() const { return m_post_L_disp; }
 
@@ -99,8 +97,6 @@ private:
 
   ChChaseCamera             m_camera;
 
-  double m_stepsize;
-
   double m_terrainHeight;
   double m_steeringDelta;
   double m_postDelta;
@@ -0,0 +1,202 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Head-up display of text boxes and linear gauges for an Irrlicht application.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "subsys/driver/ChIrrHUD.h"
+
+using namespace irr;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChIrrHUD::ChIrrHUD(ChIrrAppInterface& app, int x, int y)
+: m_app(app),
+  m_x(x),
+  m_y(y),
+  m_num_layouts(0)
+{
+}
+
+int ChIrrHUD::AddTextBox(const std::string& format, int ypos, int length, int height)
+{
+  Item item;
+  item.gauge = false;
+  item.sym = false;
+  item.visible = true;
+  item.ypos = ypos;
+  item.length = length;
+  item.height = height;
+  item.scale = 0;
+  item.fill = 0;
+  item.format = format;
+  item.text[0] = 0;
+  item.dirty = true;
+  item.texture = 0;
+
+  m_items.push_back(item);
+  return (int)m_items.size() - 1;
+}
+
+int ChIrrHUD::AddGauge(const std::string& format, double scale, bool sym, int ypos, int length, int height)
+{
+  int index = AddTextBox(format, ypos, length, height);
+
+  Item& item = m_items[index];
+  item.gauge = true;
+  item.sym = sym;
+  item.scale = scale;
+
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// The text is formatted on the stack (truncated to MAX_TEXT - 1 characters)
+// and compared with the cached text; the glyphs are laid out again (at the
+// next Draw()) only if it changed.
+// -----------------------------------------------------------------------------
+void ChIrrHUD::setText(Item& item, const char* text)
+{
+  if (strncmp(item.text, text, MAX_TEXT - 1) == 0)
+    return;
+
+  strncpy(item.text, text, MAX_TEXT - 1);
+  item.text[MAX_TEXT - 1] = 0;
+  item.dirty = true;
+}
+
+void ChIrrHUD::SetText(int item, const char* text)
+{
+  char buf[256];
+  sprintf(buf, m_items[item].format.c_str(), text);
+  setText(m_items[item], buf);
+}
+
+void ChIrrHUD::SetValue(int item, double value)
+{
+  SetValue(item, value, value);
+}
+
+void ChIrrHUD::SetValue(int item, double value, double fill_value)
+{
+  char buf[256];
+  sprintf(buf, m_items[item].format.c_str(), value);
+  setText(m_items[item], buf);
+  m_items[item].fill = fill_value * m_items[item].scale;
+}
+
+void ChIrrHUD::SetGauge(int item, const char* text, double fill_value)
+{
+  setText(m_items[item], text);
+  m_items[item].fill = fill_value * m_items[item].scale;
+}
+
+// -----------------------------------------------------------------------------
+// Lay out the glyphs of the text of an item (as CGUIFont::draw does): each
+// character is a rectangle of the font texture, advanced by its width and the
+// kerning of the font.
+// -----------------------------------------------------------------------------
+void ChIrrHUD::layout(Item& item, const core::rect<s32>& box)
+{
+  item.dirty = false;
+  item.wtext = item.text;
+  item.positions.set_used(0);
+  item.rects.set_used(0);
+  item.texture = 0;
+  m_num_layouts++;
+
+  gui::IGUIFont* font = m_app.GetIGUIEnvironment()->getBuiltInFont();
+  if (font->getType() != gui::EGFT_BITMAP)
+    return;
+
+  gui::IGUIFontBitmap* bitmap_font = static_cast<gui::IGUIFontBitmap*>(font);
+  gui::IGUISpriteBank* bank = bitmap_font->getSpriteBank();
+
+  core::position2d<s32> pos(box.UpperLeftCorner.X + 3, box.UpperLeftCorner.Y + 3);
+  const wchar_t* previous = 0;
+
+  for (u32 i = 0; i < item.wtext.size(); i++) {
+    const wchar_t* c = &item.wtext[i];
+    pos.X += font->getKerningWidth(c, previous);
+    previous = c;
+
+    u32 n = bitmap_font->getSpriteNoFromChar(c);
+    if (n >= bank->getSprites().size())
+      continue;
+
+    const gui::SGUISprite& sprite = bank->getSprites()[n];
+    if (sprite.Frames.empty())
+      continue;
+
+    const core::rect<s32>& rect = bank->getPositions()[sprite.Frames[0].rectNumber];
+    item.texture = bank->getTexture(sprite.Frames[0].textureNumber);
+    item.positions.push_back(pos);
+    item.rects.push_back(rect);
+
+    pos.X += rect.getWidth();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChIrrHUD::Draw()
+{
+  video::IVideoDriver* driver = m_app.GetVideoDriver();
+  video::SColor text_color(255, 20, 20, 20);
+
+  for (size_t i = 0; i < m_items.size(); i++) {
+    Item& item = m_items[i];
+    if (!item.visible)
+      continue;
+
+    int xpos = m_x;
+    int ypos = m_y + item.ypos;
+    core::rect<s32> box(xpos, ypos, xpos + item.length, ypos + item.height);
+
+    driver->draw2DRectangle(video::SColor(90, 60, 60, 60), box, &box);
+
+    if (item.gauge) {
+      double factor = std::max(-1.0, std::min(1.0, item.fill));
+      int length = item.length;
+      int left  = item.sym ? (int)((length/2 - 2) * std::min<>(factor,0.0) + length/2) : 2;
+      int right = item.sym ? (int)((length/2 - 2) * std::max<>(factor,0.0) + length/2) : (int)((length - 4)*std::max<>(factor,0.0) + 2);
+
+      driver->draw2DRectangle(video::SColor(255, 250, 200, 00),
+                              core::rect<s32>(xpos + left, ypos + 2, xpos + right, ypos + item.height - 2),
+                              &box);
+    }
+
+    if (item.dirty)
+      layout(item, box);
+
+    if (item.texture)
+      driver->draw2DImageBatch(item.texture, item.positions, item.rects, &box, text_color, true);
+    else if (!item.wtext.empty())
+      m_app.GetIGUIEnvironment()->getBuiltInFont()->draw(
+        item.wtext,
+        core::rect<s32>(xpos + 3, ypos + 3, xpos + item.length, ypos + item.height),
+        text_color, false, false, &box);
+  }
+}
+
+
+} // end namespace chrono
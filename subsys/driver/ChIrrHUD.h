@@ -0,0 +1,135 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Head-up display of text boxes and linear gauges for an Irrlicht application.
+//
+// The layout is defined once, by adding the items; each frame, the caller only
+// sets the item values and draws the display. The text of an item is formatted
+// into a fixed-size buffer and its glyphs are laid out (as quads into the font
+// texture) only when the text changes; unchanged items are drawn from their
+// cached glyph quads, with a single batched draw call per item. No memory is
+// allocated once all items were drawn with their longest text.
+//
+// With a non-bitmap font, the cached text is drawn with the font itself.
+//
+// =============================================================================
+
+#ifndef CH_IRR_HUD_H
+#define CH_IRR_HUD_H
+
+#include <string>
+#include <vector>
+
+#include "unit_IRRLICHT/ChIrrAppInterface.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Head-up display with a fixed layout.
+///
+class CH_SUBSYS_API ChIrrHUD
+{
+public:
+
+  /// Size of the text buffer of an item (longer texts are truncated).
+  static const int MAX_TEXT = 64;
+
+  ChIrrHUD(
+    irr::ChIrrAppInterface& app,   ///< [in] application drawing the display
+    int                     x,     ///< [in] X position of the display (pixels)
+    int                     y      ///< [in] Y position of the display (pixels)
+    );
+
+  ~ChIrrHUD() {}
+
+  /// Add a text box at the specified offset and return its index.
+  int AddTextBox(
+    const std::string& format,       ///< [in] printf format, with one %s conversion
+    int                ypos,         ///< [in] vertical offset in the display
+    int                length = 120, ///< [in] box width
+    int                height = 15   ///< [in] box height
+    );
+
+  /// Add a linear gauge at the specified offset and return its index. The
+  /// gauge displays the value multiplied by the scale, over [0,1] or, if
+  /// symmetric, over [-1,1].
+  int AddGauge(
+    const std::string& format,       ///< [in] printf format, with one floating point conversion
+    double             scale,        ///< [in] scale of the gauge fill
+    bool               sym,          ///< [in] symmetric gauge
+    int                ypos,         ///< [in] vertical offset in the display
+    int                length = 120, ///< [in] gauge width
+    int                height = 15   ///< [in] gauge height
+    );
+
+  /// Set the text of a text box (formatted with its format).
+  void SetText(int item, const char* text);
+
+  /// Set the value of a gauge; its text is formatted with its format. The
+  /// gauge fill uses fill_value * scale (fill_value defaults to value).
+  void SetValue(int item, double value);
+  void SetValue(int item, double value, double fill_value);
+
+  /// Set the text and fill value of a gauge directly.
+  void SetGauge(int item, const char* text, double fill_value);
+
+  /// Show or hide an item (all items are visible by default).
+  void SetVisible(int item, bool val) { m_items[item].visible = val; }
+
+  /// Draw all visible items.
+  void Draw();
+
+  /// Return the number of times the glyphs of an item were laid out.
+  int GetNumLayouts() const { return m_num_layouts; }
+
+private:
+
+  struct Item {
+    bool                                          gauge;
+    bool                                          sym;
+    bool                                          visible;
+    int                                           ypos;
+    int                                           length;
+    int                                           height;
+    double                                        scale;
+    double                                        fill;
+    std::string                                   format;
+
+    char                                          text[MAX_TEXT];
+    bool                                          dirty;          // glyphs must be laid out
+    irr::core::stringw                            wtext;          // for non-bitmap fonts
+    irr::video::ITexture*                         texture;        // font texture of the glyphs
+    irr::core::array<irr::core::position2d<irr::s32> >  positions;  // glyph positions
+    irr::core::array<irr::core::rect<irr::s32> >        rects;      // glyph rectangles in the texture
+  };
+
+  void setText(Item& item, const char* text);
+  void layout(Item& item, const irr::core::rect<irr::s32>& box);
+
+  irr::ChIrrAppInterface&   m_app;
+  int                       m_x;
+  int                       m_y;
+
+  std::vector<Item>         m_items;
+  int                       m_num_layouts;
+};
+
+
+} // end namespace chrono
+
+
+#endif
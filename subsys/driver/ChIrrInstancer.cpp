@@ -0,0 +1,404 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Instanced Irrlicht rendering of bodies with identical visualization assets.
+//
+// =============================================================================
+
+#include <cmath>
+
+#include "assets/ChBoxShape.h"
+#include "assets/ChCylinderShape.h"
+#include "assets/ChColorAsset.h"
+#include "assets/ChTexture.h"
+#include "unit_IRRLICHT/ChIrrNodeAsset.h"
+
+#include "subsys/driver/ChIrrInstancer.h"
+
+using namespace irr;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Irrlicht matrix of the transform with the specified rotation, translation
+// and scaling (along the rotated axes). Irrlicht stores the images of the
+// axes in consecutive rows (see ChIrrTools::alignIrrlichtNodeToChronoCsys).
+// -----------------------------------------------------------------------------
+static core::matrix4 MakeMatrix(const ChMatrix33<>& A, const ChVector<>& p, const ChVector<>& s)
+{
+  core::matrix4 m;
+  for (int i = 0; i < 3; i++) {
+    m[i] = (f32)(A(i, 0) * s.x);
+    m[4 + i] = (f32)(A(i, 1) * s.y);
+    m[8 + i] = (f32)(A(i, 2) * s.z);
+  }
+  m[12] = (f32)p.x;
+  m[13] = (f32)p.y;
+  m[14] = (f32)p.z;
+  m[3] = m[7] = m[11] = 0;
+  m[15] = 1;
+
+  return m;
+}
+
+// -----------------------------------------------------------------------------
+// A batch is a scene node which draws the same mesh, with the same material,
+// at the frames of all its instances.
+// -----------------------------------------------------------------------------
+class ChIrrInstancer::Batch : public scene::ISceneNode
+{
+public:
+
+  Batch(scene::ISceneManager* mgr, scene::IMesh* mesh, const video::SMaterial& material)
+  : scene::ISceneNode(mgr->getRootSceneNode(), mgr),
+    m_mesh(mesh),
+    m_material(material),
+    m_num_drawn(0)
+  {
+    m_mesh->grab();
+    setAutomaticCulling(scene::EAC_OFF);   // instances are culled individually
+  }
+
+  ~Batch() { m_mesh->drop(); }
+
+  void AddInstance(ChBody* body, const core::matrix4& local)
+  {
+    Instance inst = { body, local };
+    m_instances.push_back(inst);
+    m_world.push_back(local);
+    m_boxes.push_back(m_mesh->getBoundingBox());
+  }
+
+  scene::IMesh*                 GetMesh() const     { return m_mesh; }
+  int                           GetNumInstances() const { return (int)m_instances.size(); }
+  int                           GetNumDrawn() const { return m_num_drawn; }
+
+  // Collect the instance transforms from the current body frames.
+  virtual void OnRegisterSceneNode()
+  {
+    if (!IsVisible || m_instances.empty())
+      return;
+
+    const core::aabbox3d<f32>& mesh_box = m_mesh->getBoundingBox();
+
+    for (size_t i = 0; i < m_instances.size(); i++) {
+      const ChFrame<>& frame = m_instances[i].body->GetFrame_REF_to_abs();
+      core::matrix4 body_m = MakeMatrix(frame.GetA(), frame.GetPos(), ChVector<>(1, 1, 1));
+      m_world[i] = body_m * m_instances[i].local;
+
+      m_boxes[i] = mesh_box;
+      m_world[i].transformBoxEx(m_boxes[i]);
+      if (i == 0)
+        m_box = m_boxes[i];
+      else
+        m_box.addInternalBox(m_boxes[i]);
+    }
+
+    SceneManager->registerNodeForRendering(this);
+    ISceneNode::OnRegisterSceneNode();
+  }
+
+  // Draw the visible instances, with the material set once.
+  virtual void render()
+  {
+    video::IVideoDriver* driver = SceneManager->getVideoDriver();
+    scene::ICameraSceneNode* camera = SceneManager->getActiveCamera();
+    core::aabbox3d<f32> view_box = camera ? camera->getViewFrustum()->getBoundingBox() : m_box;
+
+    driver->setMaterial(m_material);
+    m_num_drawn = 0;
+
+    for (size_t i = 0; i < m_world.size(); i++) {
+      if (!view_box.intersectsWithBox(m_boxes[i]))
+        continue;
+
+      driver->setTransform(video::ETS_WORLD, m_world[i]);
+      for (u32 b = 0; b < m_mesh->getMeshBufferCount(); b++)
+        driver->drawMeshBuffer(m_mesh->getMeshBuffer(b));
+      m_num_drawn++;
+    }
+  }
+
+  virtual const core::aabbox3d<f32>& getBoundingBox() const { return m_box; }
+  virtual u32 getMaterialCount() const                     { return 1; }
+  virtual video::SMaterial& getMaterial(u32 i)             { return m_material; }
+
+private:
+
+  struct Instance {
+    ChBody*        body;
+    core::matrix4  local;   // shape frame (and scaling) relative to the body
+  };
+
+  scene::IMesh*                      m_mesh;
+  video::SMaterial                   m_material;
+  std::vector<Instance>              m_instances;
+  std::vector<core::matrix4>         m_world;      // instance transforms of the current frame
+  std::vector<core::aabbox3d<f32> >  m_boxes;      // instance bounding boxes of the current frame
+  core::aabbox3d<f32>                m_box;
+  int                                m_num_drawn;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChIrrInstancer::ChIrrInstancer(ChIrrAppInterface& app)
+: m_app(app)
+{
+  const scene::IGeometryCreator* creator = app.GetSceneManager()->getGeometryCreator();
+  m_cube = creator->createCubeMesh(core::vector3df(1, 1, 1));
+  m_cylinder = creator->createCylinderMesh(1, 1, 32);
+}
+
+ChIrrInstancer::~ChIrrInstancer()
+{
+  Clear();
+
+  m_cube->drop();
+  m_cylinder->drop();
+}
+
+void ChIrrInstancer::Clear()
+{
+  for (size_t i = 0; i < m_batches.size(); i++)
+    m_batches[i]->remove();
+  m_batches.clear();
+
+  for (size_t i = 0; i < m_meshes.size(); i++)
+    m_meshes[i]->drop();
+  m_meshes.clear();
+  m_mesh_keys.clear();
+
+  for (size_t i = 0; i < m_hidden.size(); i++) {
+    m_hidden[i]->setVisible(true);
+    m_hidden[i]->drop();
+  }
+  m_hidden.clear();
+}
+
+int ChIrrInstancer::GetNumInstances() const
+{
+  int num = 0;
+  for (size_t i = 0; i < m_batches.size(); i++)
+    num += m_batches[i]->GetNumInstances();
+
+  return num;
+}
+
+int ChIrrInstancer::GetNumDrawn() const
+{
+  int num = 0;
+  for (size_t i = 0; i < m_batches.size(); i++)
+    num += m_batches[i]->GetNumDrawn();
+
+  return num;
+}
+
+// -----------------------------------------------------------------------------
+// Batches are matched on the mesh and the material colors and texture; a
+// linear search suffices for the few distinct shapes of a scene.
+// -----------------------------------------------------------------------------
+ChIrrInstancer::Batch* ChIrrInstancer::getBatch(scene::IMesh* mesh, const video::SMaterial& material)
+{
+  for (size_t i = 0; i < m_batches.size(); i++) {
+    const video::SMaterial& m = m_batches[i]->getMaterial(0);
+    if (m_batches[i]->GetMesh() == mesh &&
+        m.DiffuseColor == material.DiffuseColor &&
+        m.getTexture(0) == material.getTexture(0))
+      return m_batches[i];
+  }
+
+  Batch* batch = new Batch(m_app.GetSceneManager(), mesh, material);
+  batch->drop();   // owned by the scene manager
+  m_batches.push_back(batch);
+
+  return batch;
+}
+
+// -----------------------------------------------------------------------------
+// The material of all shapes of a body is given by its last color and texture
+// assets (as for the Irrlicht asset converter).
+// -----------------------------------------------------------------------------
+bool ChIrrInstancer::AddBody(ChSharedPtr<ChBody> body)
+{
+  return addBody(body.get_ptr());
+}
+
+int ChIrrInstancer::AddBodies(ChSystem* system)
+{
+  int num = 0;
+
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody) {
+    if (addBody(*ibody))
+      num++;
+  }
+
+  return num;
+}
+
+bool ChIrrInstancer::addBody(ChBody* body)
+{
+  std::vector<ChSharedPtr<ChAsset> >& assets = body->GetAssets();
+
+  ChColor color(1, 1, 1);
+  video::ITexture* texture = 0;
+  scene::ISceneNode* node = 0;
+  std::vector<ChSharedPtr<ChVisualization> > shapes;
+
+  for (size_t i = 0; i < assets.size(); i++) {
+    if (ChSharedPtr<ChColorAsset> color_asset = assets[i].DynamicCastTo<ChColorAsset>())
+      color = color_asset->GetColor();
+    else if (ChSharedPtr<ChTexture> texture_asset = assets[i].DynamicCastTo<ChTexture>())
+      texture = m_app.GetVideoDriver()->getTexture(texture_asset->GetTextureFilename().c_str());
+    else if (ChSharedPtr<scene::ChIrrNodeAsset> irr_asset = assets[i].DynamicCastTo<scene::ChIrrNodeAsset>())
+      node = irr_asset->GetIrrlichtNode();
+    else if (assets[i].IsType<ChTriangleMeshShape>() ||
+             assets[i].IsType<ChBoxShape>() ||
+             assets[i].IsType<ChCylinderShape>())
+      shapes.push_back(assets[i].DynamicCastTo<ChVisualization>());
+    else
+      return false;
+  }
+
+  if (shapes.empty())
+    return false;
+
+  video::SMaterial material;
+  video::SColor scolor(255, (u32)(color.R * 255), (u32)(color.G * 255), (u32)(color.B * 255));
+  material.DiffuseColor = scolor;
+  material.AmbientColor = scolor;
+  material.BackfaceCulling = false;
+  material.NormalizeNormals = true;   // instances are scaled
+  material.ColorMaterial = video::ECM_NONE;
+  if (texture)
+    material.setTexture(0, texture);
+
+  for (size_t i = 0; i < shapes.size(); i++) {
+    const ChVector<>& pos = shapes[i]->Pos;
+    const ChMatrix33<>& rot = shapes[i]->Rot;
+
+    if (ChSharedPtr<ChTriangleMeshShape> trimesh = shapes[i].DynamicCastTo<ChTriangleMeshShape>()) {
+      // One Irrlicht mesh per mesh asset (shared through ChMeshCache).
+      scene::IMesh* mesh = 0;
+      for (size_t k = 0; k < m_mesh_keys.size(); k++) {
+        if (m_mesh_keys[k] == trimesh.get_ptr())
+          mesh = m_meshes[k];
+      }
+      if (!mesh) {
+        mesh = createMesh(trimesh->GetMesh());
+        m_mesh_keys.push_back(trimesh.get_ptr());
+        m_meshes.push_back(mesh);
+      }
+
+      getBatch(mesh, material)->AddInstance(body, MakeMatrix(rot, pos, ChVector<>(1, 1, 1)));
+    }
+    else if (ChSharedPtr<ChBoxShape> box = shapes[i].DynamicCastTo<ChBoxShape>()) {
+      const ChVector<>& size = box->GetBoxGeometry().Size;   // half lengths
+      getBatch(m_cube, material)->AddInstance(body, MakeMatrix(rot, pos, size * 2));
+    }
+    else if (ChSharedPtr<ChCylinderShape> cyl = shapes[i].DynamicCastTo<ChCylinderShape>()) {
+      // Map the unit cylinder (along Y, from the origin) onto the segment p1-p2.
+      const geometry::ChCylinder& geom = cyl->GetCylinderGeometry();
+      ChVector<> axis = geom.p2 - geom.p1;
+      double length = axis.Length();
+      if (length == 0)
+        continue;
+      axis *= 1 / length;
+
+      ChVector<> u = (std::abs(axis.x) < 0.9) ? ChVector<>(1, 0, 0) : ChVector<>(0, 0, 1);
+      u = Vcross(axis, u);
+      u.Normalize();
+      ChVector<> w = Vcross(u, axis);
+
+      ChMatrix33<> A;
+      A.Set_A_axis(u, axis, w);
+
+      ChMatrix33<> shape_rot;
+      shape_rot.MatrMultiply(rot, A);
+      ChVector<> shape_pos = pos + rot.Matr_x_Vect(geom.p1);
+      getBatch(m_cylinder, material)->AddInstance(body,
+        MakeMatrix(shape_rot, shape_pos, ChVector<>(geom.rad, length, geom.rad)));
+    }
+  }
+
+  if (node) {
+    node->setVisible(false);
+    node->grab();
+    m_hidden.push_back(node);
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Triangles are split over mesh buffers of at most 65535 vertices (16-bit
+// indices); each triangle has its own three vertices, with the mesh normals if
+// specified, and its face normal otherwise.
+// -----------------------------------------------------------------------------
+scene::IMesh* ChIrrInstancer::createMesh(const geometry::ChTriangleMeshConnected& trimesh)
+{
+  const int max_triangles = 65535 / 3;
+
+  const std::vector<ChVector<> >& vertices = trimesh.m_vertices;
+  const std::vector<ChVector<> >& normals = trimesh.m_normals;
+  const std::vector<ChVector<int> >& faces = trimesh.m_face_v_indices;
+  const std::vector<ChVector<int> >& face_normals = trimesh.m_face_n_indices;
+  bool has_normals = !normals.empty() && face_normals.size() == faces.size();
+
+  scene::SMesh* mesh = new scene::SMesh;
+  scene::SMeshBuffer* buffer = 0;
+
+  for (size_t f = 0; f < faces.size(); f++) {
+    if (f % max_triangles == 0) {
+      buffer = new scene::SMeshBuffer;
+      mesh->addMeshBuffer(buffer);
+      buffer->drop();
+    }
+
+    const ChVector<int>& face = faces[f];
+    ChVector<> v[3] = { vertices[face.x], vertices[face.y], vertices[face.z] };
+    ChVector<> n[3];
+
+    if (has_normals) {
+      n[0] = normals[face_normals[f].x];
+      n[1] = normals[face_normals[f].y];
+      n[2] = normals[face_normals[f].z];
+    } else {
+      n[0] = Vcross(v[1] - v[0], v[2] - v[0]);
+      double len = n[0].Length();
+      if (len > 0)
+        n[0] *= 1 / len;
+      n[1] = n[2] = n[0];
+    }
+
+    for (int k = 0; k < 3; k++) {
+      buffer->Indices.push_back((u16)buffer->Vertices.size());
+      buffer->Vertices.push_back(video::S3DVertex((f32)v[k].x, (f32)v[k].y, (f32)v[k].z,
+                                                  (f32)n[k].x, (f32)n[k].y, (f32)n[k].z,
+                                                  video::SColor(255, 255, 255, 255), 0, 0));
+    }
+  }
+
+  for (u32 b = 0; b < mesh->getMeshBufferCount(); b++)
+    mesh->getMeshBuffer(b)->recalculateBoundingBox();
+  mesh->recalculateBoundingBox();
+  mesh->setHardwareMappingHint(scene::EHM_STATIC);
+
+  return mesh;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,121 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Instanced Irrlicht rendering of bodies with identical visualization assets
+// (e.g. the wheels of a fleet of vehicles, or the terrain obstacles).
+//
+// Instead of one scene node per body and per asset (as created by the Irrlicht
+// asset converter), the instancer creates a single scene node per batch, i.e.
+// per distinct shape and material:
+//   - triangle meshes are batched by asset, such that all bodies sharing a
+//     ChMeshCache asset are drawn from a single Irrlicht mesh;
+//   - boxes and cylinders are batched by material and drawn from a unit mesh,
+//     scaled per instance.
+// Each frame, the instance transforms are collected from the current body
+// frames (in decoupled rendering, the proxy bodies updated from the latest
+// snapshot, see ChRenderProxy), the instances outside of the view are culled,
+// and the material of a batch is set once for all its instances.
+//
+// Irrlicht does not expose hardware instancing, so each instance is still a
+// separate draw of the shared mesh buffers; the savings are the scene graph
+// traversal, the per-node material changes and the per-body mesh copies.
+// The converted scene nodes of the instanced bodies are hidden, not removed.
+// Instanced bodies do not cast shadows.
+//
+// =============================================================================
+
+#ifndef CH_IRR_INSTANCER_H
+#define CH_IRR_INSTANCER_H
+
+#include <vector>
+
+#include "physics/ChSystem.h"
+#include "assets/ChTriangleMeshShape.h"
+#include "unit_IRRLICHT/ChIrrApp.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Instanced rendering of the bodies of an Irrlicht application.
+///
+class CH_SUBSYS_API ChIrrInstancer
+{
+public:
+
+  ChIrrInstancer(
+    irr::ChIrrAppInterface& app   ///< [in] application drawing the bodies
+    );
+
+  /// The destructor removes the batch scene nodes.
+  ~ChIrrInstancer();
+
+  /// Render the specified body instanced. Must be called after the Irrlicht
+  /// assets of the body were created (e.g. with ChIrrApp::AssetBindAll()
+  /// and AssetUpdateAll()); the converted scene nodes of the body are hidden.
+  /// Returns false (and leaves the body unchanged) if the body has assets
+  /// other than triangle meshes, boxes, cylinders, colors and textures (e.g.
+  /// level-of-detail groups, see ChIrrVehicleLOD).
+  bool AddBody(ChSharedPtr<ChBody> body);
+
+  /// Render instanced all bodies of the specified system which can be.
+  /// Returns the number of instanced bodies.
+  int AddBodies(ChSystem* system);
+
+  /// Remove all batches, and show again the scene nodes of the instanced bodies.
+  void Clear();
+
+  /// Get the number of batches (scene nodes).
+  int GetNumBatches() const { return (int)m_batches.size(); }
+
+  /// Get the total number of instances (shapes) in all batches.
+  int GetNumInstances() const;
+
+  /// Get the number of instances drawn in the last frame (all batches).
+  int GetNumDrawn() const;
+
+private:
+
+  class Batch;
+
+  ChIrrInstancer(const ChIrrInstancer&);
+  ChIrrInstancer& operator=(const ChIrrInstancer&);
+
+  bool addBody(ChBody* body);
+
+  // Find or create the batch for the specified mesh and material.
+  Batch* getBatch(irr::scene::IMesh* mesh, const irr::video::SMaterial& material);
+
+  // Convert a triangle mesh into an Irrlicht mesh (flat shaded, unless the
+  // mesh has normals).
+  static irr::scene::IMesh* createMesh(const geometry::ChTriangleMeshConnected& trimesh);
+
+  irr::ChIrrAppInterface&                   m_app;
+
+  std::vector<Batch*>                       m_batches;
+  std::vector<irr::scene::ISceneNode*>      m_hidden;       // converted nodes of the instanced bodies
+
+  std::vector<const ChTriangleMeshShape*>   m_mesh_keys;    // triangle mesh assets ...
+  std::vector<irr::scene::IMesh*>           m_meshes;       // ... and their Irrlicht meshes
+  irr::scene::IMesh*                        m_cube;         // unit box, centered at the origin
+  irr::scene::IMesh*                        m_cylinder;     // unit cylinder along Y, base at the origin
+};
+
+
+} // end namespace chrono
+
+
+#endif
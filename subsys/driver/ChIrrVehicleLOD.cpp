@@ -0,0 +1,151 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Distance-based level-of-detail switching for the Irrlicht visualization of
+// vehicles.
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+#include "unit_IRRLICHT/ChIrrNodeAsset.h"
+
+#include "subsys/driver/ChIrrVehicleLOD.h"
+
+using namespace irr;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChIrrVehicleLOD::ChIrrVehicleLOD(double mesh_distance,
+                                 double primitive_distance)
+: m_hysteresis(0.05),
+  m_num_switches(0)
+{
+  SetDistances(mesh_distance, primitive_distance);
+}
+
+void ChIrrVehicleLOD::SetDistances(double mesh_distance, double primitive_distance)
+{
+  m_distances[vehicle::ChMeshCache::LOD_MESH] = mesh_distance;
+  m_distances[vehicle::ChMeshCache::LOD_PRIMITIVES] = primitive_distance;
+}
+
+// -----------------------------------------------------------------------------
+// The Irrlicht node of a body holds a proxy node, whose children are the scene
+// nodes created from the body assets; each asset group is converted into an
+// empty scene node. The level-of-detail groups are the last NUM_LOD_LEVELS
+// groups of the body.
+// -----------------------------------------------------------------------------
+bool ChIrrVehicleLOD::collectNodes(ChSharedPtr<ChBody> body, VehicleLOD& lod)
+{
+  std::vector<ChSharedPtr<ChAsset> >& assets = body->GetAssets();
+
+  int num_groups = 0;
+  scene::ISceneNode* node = 0;
+  for (size_t i = 0; i < assets.size(); i++) {
+    if (assets[i].IsType<ChAssetLevel>())
+      num_groups++;
+    else if (ChSharedPtr<scene::ChIrrNodeAsset> irr_asset = assets[i].DynamicCastTo<scene::ChIrrNodeAsset>())
+      node = irr_asset->GetIrrlichtNode();
+  }
+
+  if (!node || num_groups < vehicle::ChMeshCache::NUM_LOD_LEVELS)
+    return false;
+
+  NodeList groups;
+  const core::list<scene::ISceneNode*>& proxies = node->getChildren();
+  for (core::list<scene::ISceneNode*>::ConstIterator ip = proxies.begin(); ip != proxies.end(); ++ip) {
+    const core::list<scene::ISceneNode*>& children = (*ip)->getChildren();
+    for (core::list<scene::ISceneNode*>::ConstIterator ic = children.begin(); ic != children.end(); ++ic) {
+      if ((*ic)->getType() == scene::ESNT_EMPTY)
+        groups.push_back(*ic);
+    }
+  }
+
+  if (groups.size() != (size_t)num_groups) {
+    GetLog() << "WARNING: ignoring the level-of-detail groups of body " << body->GetName() << "\n";
+    return false;
+  }
+
+  size_t first = groups.size() - vehicle::ChMeshCache::NUM_LOD_LEVELS;
+  for (int level = 0; level < vehicle::ChMeshCache::NUM_LOD_LEVELS; level++)
+    lod.nodes[level].push_back(groups[first + level]);
+
+  return true;
+}
+
+bool ChIrrVehicleLOD::AddVehicle(ChVehicle& car)
+{
+  VehicleLOD lod;
+  lod.car = &car;
+  lod.level = vehicle::ChMeshCache::LOD_MESH;
+
+  bool found = collectNodes(car.GetChassis(), lod);
+  for (int i = 0; i < 2 * car.GetNumberAxles(); i++)
+    found |= collectNodes(car.GetWheelBody(ChWheelID(i)), lod);
+
+  if (!found)
+    return false;
+
+  // Replace a previous registration of the same vehicle.
+  for (size_t i = 0; i < m_vehicles.size(); i++) {
+    if (m_vehicles[i].car == &car) {
+      m_vehicles.erase(m_vehicles.begin() + i);
+      break;
+    }
+  }
+
+  setLevel(lod, lod.level);
+  m_vehicles.push_back(lod);
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChIrrVehicleLOD::Update(const ChVector<>& camera_pos)
+{
+  for (size_t i = 0; i < m_vehicles.size(); i++) {
+    VehicleLOD& lod = m_vehicles[i];
+
+    double dist = (lod.car->GetChassisPos() - camera_pos).Length();
+
+    // Coarsen or refine by one level at a time, past the hysteresis band.
+    int level = lod.level;
+    while (level < vehicle::ChMeshCache::NUM_LOD_LEVELS - 1 && dist > m_distances[level] * (1 + m_hysteresis))
+      level++;
+    while (level > 0 && dist < m_distances[level - 1] * (1 - m_hysteresis))
+      level--;
+
+    if (level != lod.level) {
+      setLevel(lod, vehicle::ChMeshCache::LodLevel(level));
+      m_num_switches++;
+    }
+  }
+}
+
+void ChIrrVehicleLOD::setLevel(VehicleLOD& lod, vehicle::ChMeshCache::LodLevel level)
+{
+  for (int l = 0; l < vehicle::ChMeshCache::NUM_LOD_LEVELS; l++) {
+    for (size_t i = 0; i < lod.nodes[l].size(); i++)
+      lod.nodes[l][i]->setVisible(l == level);
+  }
+
+  lod.level = level;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,110 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Distance-based level-of-detail switching for the Irrlicht visualization of
+// vehicles created with the LOD visualization type.
+//
+// The chassis and wheel bodies of such vehicles carry one asset group per level
+// of detail (see ChMeshCache::LodLevel); the Irrlicht asset converter creates
+// one empty scene node for each group. The level of a vehicle is selected from
+// the distance between the camera (e.g. ChChaseCamera::GetCameraPos()) and its
+// chassis, and only the scene nodes of that level are made visible; no asset or
+// scene node is re-created when switching. A small hysteresis band around each
+// switch distance prevents flickering.
+//
+// =============================================================================
+
+#ifndef CH_IRR_VEHICLE_LOD_H
+#define CH_IRR_VEHICLE_LOD_H
+
+#include <vector>
+
+#include "unit_IRRLICHT/ChIrrApp.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChMeshCache.h"
+
+
+namespace chrono {
+
+///
+/// Level-of-detail selection for the vehicles rendered by an Irrlicht
+/// application.
+///
+class CH_SUBSYS_API ChIrrVehicleLOD
+{
+public:
+
+  ChIrrVehicleLOD(
+    double mesh_distance = 30,        ///< [in] maximum distance for the mesh level
+    double primitive_distance = 120   ///< [in] maximum distance for the primitives level
+    );
+
+  ~ChIrrVehicleLOD() {}
+
+  /// Set the maximum camera distances of the mesh and primitives levels;
+  /// beyond the latter, impostors are rendered.
+  void SetDistances(double mesh_distance, double primitive_distance);
+
+  /// Set the relative width of the hysteresis band around each switch distance
+  /// (default: 0.05).
+  void SetHysteresis(double val) { m_hysteresis = val; }
+
+  /// Register a vehicle. Must be called after the Irrlicht assets of its
+  /// bodies were created (e.g. with ChIrrApp::AssetBindAll() and
+  /// AssetUpdateAll()), and again after they are re-created. Bodies without
+  /// level-of-detail groups are ignored.
+  /// Returns false if no body of the vehicle has level-of-detail groups.
+  bool AddVehicle(ChVehicle& car);
+
+  /// Select the level of detail of each registered vehicle.
+  void Update(const ChVector<>& camera_pos);
+
+  /// Get the number of registered vehicles.
+  int GetNumVehicles() const { return (int)m_vehicles.size(); }
+
+  /// Get the current level of detail of the specified vehicle.
+  vehicle::ChMeshCache::LodLevel GetLevel(int i) const { return m_vehicles[i].level; }
+
+  /// Get the number of level switches so far (all vehicles).
+  int GetNumSwitches() const { return m_num_switches; }
+
+private:
+
+  typedef std::vector<irr::scene::ISceneNode*> NodeList;
+
+  struct VehicleLOD {
+    ChVehicle*                      car;
+    vehicle::ChMeshCache::LodLevel  level;
+    NodeList                        nodes[vehicle::ChMeshCache::NUM_LOD_LEVELS];
+  };
+
+  // Collect the scene nodes of the level-of-detail groups of the specified body.
+  static bool collectNodes(ChSharedPtr<ChBody> body, VehicleLOD& lod);
+
+  static void setLevel(VehicleLOD& lod, vehicle::ChMeshCache::LodLevel level);
+
+  double                   m_distances[vehicle::ChMeshCache::NUM_LOD_LEVELS - 1];
+  double                   m_hysteresis;
+  int                      m_num_switches;
+
+  std::vector<VehicleLOD>  m_vehicles;
+};
+
+
+} // end namespace chrono
+
+
+#endif
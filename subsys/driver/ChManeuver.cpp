@@ -0,0 +1,291 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Open-loop driver maneuver compiled into piecewise-cubic tables.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChLog.h"
+#include "core/ChMathematics.h"
+
+#include "subsys/ChJsonCache.h"
+#include "subsys/driver/ChManeuver.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+// Number of cubic pieces per period of the sine functions.
+static const int PIECES_PER_PERIOD = 32;
+
+static const char* s_input_names[ChManeuver::NUM_INPUTS] = {"Steering", "Throttle", "Braking"};
+
+
+// -----------------------------------------------------------------------------
+// Table construction.
+// -----------------------------------------------------------------------------
+bool ChManeuver::Table::Start(double t, double v)
+{
+  if (m_t.empty()) {
+    m_t.push_back(t);
+  } else if (t > m_t.back()) {
+    m_t.push_back(t);
+    m_c.push_back(m_end);
+    m_c.push_back(0);
+    m_c.push_back(0);
+    m_c.push_back(0);
+  } else if (t < m_t.back()) {
+    return false;
+  }
+
+  m_end = v;
+  return true;
+}
+
+void ChManeuver::Table::AddLinear(double t1, double v1)
+{
+  double h = t1 - m_t.back();
+
+  m_c.push_back(m_end);
+  m_c.push_back((v1 - m_end) / h);
+  m_c.push_back(0);
+  m_c.push_back(0);
+  m_t.push_back(t1);
+  m_end = v1;
+}
+
+void ChManeuver::Table::AddHermite(double t1, double d0, double v1, double d1)
+{
+  double h = t1 - m_t.back();
+  double slope = (v1 - m_end) / h;
+
+  m_c.push_back(m_end);
+  m_c.push_back(d0);
+  m_c.push_back((3 * slope - 2 * d0 - d1) / h);
+  m_c.push_back((d0 + d1 - 2 * slope) / (h * h));
+  m_t.push_back(t1);
+  m_end = v1;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChManeuver::ChManeuver(const std::string& filename)
+: m_valid(false)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  if (!d.IsObject()) {
+    GetLog() << "ERROR: cannot read maneuver file " << filename.c_str() << "\n";
+    for (int i = 0; i < NUM_INPUTS; i++)
+      m_tables[i].Start(0, 0);
+    return;
+  }
+
+  Create(d);
+}
+
+ChManeuver::ChManeuver(const rapidjson::Document& d)
+: m_valid(false)
+{
+  Create(d);
+}
+
+void ChManeuver::Create(const rapidjson::Document& d)
+{
+  m_valid = true;
+
+  for (int i = 0; i < NUM_INPUTS; i++) {
+    Table& table = m_tables[i];
+    if (d.HasMember(s_input_names[i])) {
+      const Value& spec = d[s_input_names[i]];
+      bool ok = true;
+      if (spec.IsArray()) {
+        for (SizeType j = 0; ok && j < spec.Size(); j++)
+          ok = Compile(spec[j], table);
+      } else {
+        ok = Compile(spec, table);
+      }
+      if (!ok) {
+        GetLog() << "ERROR: invalid " << s_input_names[i] << " description in maneuver\n";
+        m_valid = false;
+      }
+    }
+  }
+
+  // An invalid maneuver has zero inputs; an input without description is zero.
+  for (int i = 0; i < NUM_INPUTS; i++) {
+    if (!m_valid)
+      m_tables[i] = Table();
+    if (m_tables[i].m_t.empty())
+      m_tables[i].Start(0, 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Compile one function and append it to the specified table.
+// -----------------------------------------------------------------------------
+static double get_double(const Value& spec, const char* name, double def)
+{
+  return (spec.HasMember(name) && spec[name].IsNumber()) ? spec[name].GetDouble() : def;
+}
+
+bool ChManeuver::Compile(const rapidjson::Value& spec, Table& table)
+{
+  if (!spec.IsObject() || !spec.HasMember("Type") || !spec["Type"].IsString())
+    return false;
+
+  std::string type = spec["Type"].GetString();
+  double t0 = get_double(spec, "Start Time", 0);
+
+  if (type == "Constant") {
+    if (!spec.HasMember("Value"))
+      return false;
+    return table.Start(t0, spec["Value"].GetDouble());
+  }
+
+  if (type == "Schedule") {
+    if (!spec.HasMember("Points") || !spec["Points"].IsArray() || spec["Points"].Size() == 0)
+      return false;
+    const Value& points = spec["Points"];
+    for (SizeType j = 0; j < points.Size(); j++) {
+      if (!points[j].IsArray() || points[j].Size() != 2)
+        return false;
+      double t = points[j][0u].GetDouble();
+      double v = points[j][1u].GetDouble();
+      if (j == 0 || t == table.m_t.back()) {
+        if (!table.Start(t, v))
+          return false;
+      } else if (t > table.m_t.back()) {
+        table.AddLinear(t, v);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (type == "Step" || type == "Constant Radius") {
+    double value;
+    double ramp;
+    if (type == "Step") {
+      if (!spec.HasMember("Value"))
+        return false;
+      value = spec["Value"].GetDouble();
+      ramp = get_double(spec, "Ramp Time", 0);
+    } else {
+      double radius = get_double(spec, "Radius", 0);
+      double wheelbase = get_double(spec, "Wheelbase", 0);
+      double max_angle = get_double(spec, "Max Steering Angle", 0);
+      if (radius == 0 || wheelbase <= 0 || max_angle <= 0)
+        return false;
+      value = std::atan(wheelbase / radius) / max_angle;
+      ramp = get_double(spec, "Ramp Time", 1);
+    }
+    if (!table.Start(t0, table.m_t.empty() ? 0 : table.m_end))
+      return false;
+    if (ramp > 0)
+      table.AddLinear(t0 + ramp, value);
+    else
+      table.Start(t0, value);
+    return true;
+  }
+
+  if (type == "Lane Change") {
+    double A = get_double(spec, "Amplitude", 0);
+    double D = get_double(spec, "Duration", 0);
+    double H = get_double(spec, "Hold Time", 0);
+    if (D <= 0 || H < 0)
+      return false;
+    double w = 2 * CH_C_PI / D;
+    double h = D / PIECES_PER_PERIOD;
+    for (int pass = 0; pass < 2; pass++) {
+      double start = t0 + pass * (D + H);
+      double a = (pass == 0) ? A : -A;
+      if (!table.Start(start, 0))
+        return false;
+      for (int k = 1; k <= PIECES_PER_PERIOD; k++) {
+        double u0 = (k - 1) * h;
+        double u1 = (k == PIECES_PER_PERIOD) ? D : k * h;
+        table.AddHermite(start + u1, a * w * std::cos(w * u0), a * std::sin(w * u1), a * w * std::cos(w * u1));
+      }
+      // hold exactly zero (sin(w D) is only zero to round-off)
+      table.m_end = 0;
+    }
+    return true;
+  }
+
+  if (type == "Sine Sweep") {
+    double A = get_double(spec, "Amplitude", 0);
+    double f0 = get_double(spec, "Start Frequency", 0);
+    double f1 = get_double(spec, "End Frequency", 0);
+    double D = get_double(spec, "Duration", 0);
+    if (D <= 0 || f0 < 0 || f1 < 0 || (f0 == 0 && f1 == 0))
+      return false;
+    int n = (int)std::ceil(PIECES_PER_PERIOD * D * std::max(f0, f1));
+    double h = D / n;
+    if (!table.Start(t0, 0))
+      return false;
+    for (int k = 1; k <= n; k++) {
+      double u0 = (k - 1) * h;
+      double u1 = (k == n) ? D : k * h;
+      double phi0 = 2 * CH_C_PI * (f0 * u0 + 0.5 * (f1 - f0) * u0 * u0 / D);
+      double phi1 = 2 * CH_C_PI * (f0 * u1 + 0.5 * (f1 - f0) * u1 * u1 / D);
+      double w0 = 2 * CH_C_PI * (f0 + (f1 - f0) * u0 / D);
+      double w1 = 2 * CH_C_PI * (f0 + (f1 - f0) * u1 / D);
+      table.AddHermite(t0 + u1, A * w0 * std::cos(phi0), A * std::sin(phi1), A * w1 * std::cos(phi1));
+    }
+    return true;
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChManeuver::GetEndTime() const
+{
+  double t = 0;
+  for (int i = 0; i < NUM_INPUTS; i++)
+    t = std::max(t, m_tables[i].m_t.back());
+  return t;
+}
+
+double ChManeuver::Evaluate(Input input, double time, int& cursor) const
+{
+  const Table& table = m_tables[input];
+  int n = (int)table.m_t.size() - 1;
+
+  if (n == 0 || time >= table.m_t[n])
+    return table.m_end;
+  if (time < table.m_t[0])
+    return table.m_c[0];
+
+  if (cursor < 0 || cursor >= n || time < table.m_t[cursor]) {
+    cursor = (int)(std::upper_bound(table.m_t.begin(), table.m_t.end(), time) - table.m_t.begin()) - 1;
+  } else {
+    while (time >= table.m_t[cursor + 1])
+      cursor++;
+  }
+
+  const double* c = &table.m_c[4 * cursor];
+  double u = time - table.m_t[cursor];
+
+  return c[0] + u * (c[1] + u * (c[2] + u * c[3]));
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,134 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Open-loop driver maneuver, described in a JSON file and compiled at load
+// time into one piecewise-cubic table per driver input.
+//
+// The steering, throttle and braking inputs are each described by an optional
+// object (an input without description is zero) with one of the types:
+//   "Constant"         "Value"
+//   "Schedule"         "Points": [[t, value], ...], interpolated linearly
+//   "Step"             "Start Time", "Value", "Ramp Time" (default 0)
+//   "Lane Change"      "Start Time", "Amplitude", "Duration", "Hold Time":
+//                      one period of a sine (move over to the next lane), a
+//                      hold, and one period of the opposite sine (move back),
+//                      as in the ISO 3888 double lane change
+//   "Sine Sweep"       "Start Time", "Amplitude", "Start Frequency",
+//                      "End Frequency", "Duration": a linear chirp
+//   "Constant Radius"  "Radius", "Wheelbase", "Max Steering Angle",
+//                      "Start Time" (default 0), "Ramp Time" (default 1): the
+//                      steering input of a kinematic bicycle on a circle of the
+//                      specified radius (positive to the left)
+// For example:
+//   {
+//     "Name": "Lane change",
+//     "Type": "Maneuver",
+//     "Throttle": { "Type": "Schedule", "Points": [[0, 0], [1, 0.4]] },
+//     "Steering": { "Type": "Lane Change", "Start Time": 4, "Amplitude": 0.2,
+//                   "Duration": 2.5, "Hold Time": 1 }
+//   }
+// Before their first breakpoint and after their last breakpoint, the inputs
+// keep their first and last values. Sine functions are compiled into cubic
+// Hermite pieces, 32 per period, which approximate them to within 4e-6 of
+// their amplitude.
+//
+// Evaluation uses a cursor (a piece index) owned by the caller, which advances
+// monotonically with the time, so that it costs constant amortized time per
+// step. A maneuver is immutable, so it can be shared by any number of drivers
+// (and threads).
+//
+// =============================================================================
+
+#ifndef CH_MANEUVER_H
+#define CH_MANEUVER_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Open-loop maneuver, compiled into piecewise-cubic tables of the driver inputs.
+///
+class CH_SUBSYS_API ChManeuver : public ChShared
+{
+public:
+
+  /// Driver inputs.
+  enum Input {
+    STEERING,
+    THROTTLE,
+    BRAKING,
+    NUM_INPUTS
+  };
+
+  /// Compile the maneuver described in the specified JSON file.
+  ChManeuver(const std::string& filename);
+
+  /// Compile the maneuver described in the specified JSON document.
+  ChManeuver(const rapidjson::Document& d);
+
+  ~ChManeuver() {}
+
+  /// Return false if the description could not be compiled (the maneuver
+  /// then has zero inputs).
+  bool IsValid() const { return m_valid; }
+
+  /// Get the number of pieces of the specified input.
+  int GetNumPieces(Input input) const { return (int)m_tables[input].m_t.size() - 1; }
+
+  /// Get the time of the last breakpoint over all inputs.
+  double GetEndTime() const;
+
+  /// Evaluate the specified input at the specified time, starting from the
+  /// specified cursor, which is updated (initialize it to 0).
+  double Evaluate(Input input, double time, int& cursor) const;
+
+private:
+
+  // Piecewise cubic: on piece k, v(t) = c0 + c1 u + c2 u^2 + c3 u^3, with
+  // u = t - m_t[k]. Consecutive pieces need not be continuous.
+  struct Table {
+    Table() : m_end(0) {}
+
+    std::vector<double>  m_t;      // breakpoints
+    std::vector<double>  m_c;      // 4 coefficients per piece
+    double               m_end;    // value at the last breakpoint
+
+    // Start a new function at the specified time and value, holding the
+    // last value until then. Returns false if the time is before the end.
+    bool Start(double t, double v);
+    // Append a linear or a cubic Hermite piece ending at the specified time.
+    void AddLinear(double t1, double v1);
+    void AddHermite(double t1, double d0, double v1, double d1);
+  };
+
+  void Create(const rapidjson::Document& d);
+  bool Compile(const rapidjson::Value& spec, Table& table);
+
+  Table  m_tables[NUM_INPUTS];
+  bool   m_valid;
+};
+
+
+} // end namespace chrono
+
+
+#endif
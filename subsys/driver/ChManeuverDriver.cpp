@@ -0,0 +1,75 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model playing an open-loop maneuver.
+//
+// =============================================================================
+
+#include "subsys/driver/ChManeuverDriver.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChManeuverDriver::ChManeuverDriver(const std::string& filename)
+: m_maneuver(new ChManeuver(filename))
+{
+  for (int i = 0; i < ChManeuver::NUM_INPUTS; i++)
+    m_cursors[i] = 0;
+}
+
+ChManeuverDriver::ChManeuverDriver(ChSharedPtr<ChManeuver> maneuver)
+: m_maneuver(maneuver)
+{
+  for (int i = 0; i < ChManeuver::NUM_INPUTS; i++)
+    m_cursors[i] = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChManeuverDriver::Update(double time)
+{
+  SetSteering(m_maneuver->Evaluate(ChManeuver::STEERING, time, m_cursors[ChManeuver::STEERING]));
+  SetThrottle(m_maneuver->Evaluate(ChManeuver::THROTTLE, time, m_cursors[ChManeuver::THROTTLE]));
+  SetBraking(m_maneuver->Evaluate(ChManeuver::BRAKING, time, m_cursors[ChManeuver::BRAKING]));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChManeuverDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChDriver::SaveState(state);
+
+  state.BeginBlock(ChManeuver::NUM_INPUTS);
+  for (int i = 0; i < ChManeuver::NUM_INPUTS; i++)
+    state.Write((double)m_cursors[i]);
+}
+
+bool ChManeuverDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChDriver::RestoreState(state))
+    return false;
+
+  if (!state.OpenBlock(ChManeuver::NUM_INPUTS, "maneuver driver"))
+    return false;
+
+  for (int i = 0; i < ChManeuver::NUM_INPUTS; i++)
+    m_cursors[i] = (int)state.Read();
+
+  return true;
+}
+
+
+} // end namespace chrono
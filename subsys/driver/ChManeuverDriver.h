@@ -0,0 +1,67 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model playing an open-loop maneuver (see ChManeuver), e.g. a lane
+// change, a step steer or a sine sweep described in a JSON file. The compiled
+// maneuver can be shared by any number of drivers; each driver only keeps its
+// cursors in the maneuver tables.
+//
+// =============================================================================
+
+#ifndef CH_MANEUVER_DRIVER_H
+#define CH_MANEUVER_DRIVER_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriver.h"
+#include "subsys/driver/ChManeuver.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API ChManeuverDriver : public ChDriver
+{
+public:
+
+  /// Create a driver playing the maneuver described in the specified JSON file.
+  ChManeuverDriver(const std::string& filename);
+
+  /// Create a driver playing the specified (compiled) maneuver.
+  ChManeuverDriver(ChSharedPtr<ChManeuver> maneuver);
+
+  ~ChManeuverDriver() {}
+
+  /// Get the maneuver played by this driver.
+  ChSharedPtr<ChManeuver> GetManeuver() const { return m_maneuver; }
+
+  virtual void Update(double time);
+
+  /// Append the driver inputs and the cursors in the maneuver tables to the
+  /// specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs and the cursors from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+private:
+
+  ChSharedPtr<ChManeuver>  m_maneuver;
+  int                      m_cursors[ChManeuver::NUM_INPUTS];
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,206 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched evaluation of the control laws of path-following drivers.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/driver/ChPathFollowerBatch.h"
+
+// Tell the compiler that the controller arrays do not alias, so that the
+// kernel loops can be vectorized without run-time overlap checks.
+#if defined(_MSC_VER)
+#define CH_DRIVERBATCH_IVDEP __pragma(loop(ivdep))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define CH_DRIVERBATCH_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define CH_DRIVERBATCH_IVDEP _Pragma("clang loop vectorize(enable)")
+#else
+#define CH_DRIVERBATCH_IVDEP
+#endif
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPathFollowerBatch::ChPathFollowerBatch()
+{
+}
+
+int ChPathFollowerBatch::AddDriver(ChSharedPtr<ChPathFollowerDriver> driver)
+{
+  m_drivers.push_back(driver);
+
+  size_t n = m_drivers.size();
+  m_stanley.resize(n);
+  m_angle.resize(n);
+  m_dist.resize(n);
+  m_speed.resize(n);
+  m_wheelbase.resize(n);
+  m_k.resize(n);
+  m_soft_speed.resize(n);
+  m_max_angle.resize(n);
+  m_steering.resize(n);
+  m_ref_speed.resize(n);
+  m_Kp.resize(n);
+  m_Ki.resize(n);
+  m_Kd.resize(n);
+  m_err.resize(n);
+  m_err_prev.resize(n);
+  m_err_int.resize(n);
+  m_prev_time.resize(n);
+  m_throttle.resize(n);
+  m_braking.resize(n);
+
+  return (int)n - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Update all drivers in the batch. This replaces the individual calls to
+// ChPathFollowerDriver::Update() and produces the same driver inputs.
+// -----------------------------------------------------------------------------
+void ChPathFollowerBatch::Update(double time)
+{
+  int n = (int)m_drivers.size();
+  if (n == 0)
+    return;
+
+  for (int i = 0; i < n; i++) {
+    ChPathFollowerDriver* driver = m_drivers[i].get_ptr();
+    driver->track(m_angle[i], m_dist[i], m_speed[i]);
+    m_stanley[i] = (driver->m_mode == ChPathFollowerDriver::STANLEY);
+    m_wheelbase[i] = driver->m_front - driver->m_rear;
+    m_k[i] = driver->m_stanley_k;
+    m_soft_speed[i] = driver->m_stanley_soft;
+    m_max_angle[i] = driver->m_max_angle;
+    m_ref_speed[i] = driver->m_ref_speed;
+    m_Kp[i] = driver->m_Kp;
+    m_Ki[i] = driver->m_Ki;
+    m_Kd[i] = driver->m_Kd;
+    m_err[i] = driver->m_speed_err;
+    m_err_int[i] = driver->m_speed_err_int;
+    m_prev_time[i] = driver->m_prev_time;
+  }
+
+  SteeringLaw(n, &m_stanley[0], &m_angle[0], &m_dist[0], &m_speed[0], &m_wheelbase[0], &m_k[0], &m_soft_speed[0],
+              &m_max_angle[0], &m_steering[0]);
+  SpeedLaw(n, time, &m_ref_speed[0], &m_speed[0], &m_Kp[0], &m_Ki[0], &m_Kd[0], &m_err[0], &m_err_prev[0],
+           &m_err_int[0], &m_prev_time[0], &m_throttle[0], &m_braking[0]);
+
+  for (int i = 0; i < n; i++) {
+    ChPathFollowerDriver* driver = m_drivers[i].get_ptr();
+    driver->m_steering = m_steering[i];
+    driver->m_throttle = m_throttle[i];
+    driver->m_braking = m_braking[i];
+    driver->m_speed_err = m_err[i];
+    driver->m_speed_err_prev = m_err_prev[i];
+    driver->m_prev_time = m_prev_time[i];
+  }
+}
+
+void ChPathFollowerBatch::Advance(double step)
+{
+  int n = (int)m_drivers.size();
+  if (n == 0)
+    return;
+
+  for (int i = 0; i < n; i++) {
+    const ChPathFollowerDriver* driver = m_drivers[i].get_ptr();
+    m_Ki[i] = driver->m_Ki;
+    m_err[i] = driver->m_speed_err;
+    m_err_int[i] = driver->m_speed_err_int;
+  }
+
+  IntegrateErrors(n, step, &m_Ki[0], &m_err[0], &m_err_int[0]);
+
+  for (int i = 0; i < n; i++)
+    m_drivers[i]->m_speed_err_int = m_err_int[i];
+}
+
+// -----------------------------------------------------------------------------
+// Kernels. Both steering laws are evaluated for all drivers and the result is
+// selected, so that the loops are branch-free.
+// -----------------------------------------------------------------------------
+void ChPathFollowerBatch::SteeringLaw(int           n,
+                                      const char*   stanley,
+                                      const double* angle,
+                                      const double* dist,
+                                      const double* speed,
+                                      const double* wheelbase,
+                                      const double* k,
+                                      const double* soft_speed,
+                                      const double* max_angle,
+                                      double*       steering)
+{
+  CH_DRIVERBATCH_IVDEP
+  for (int i = 0; i < n; i++) {
+    double safe_dist = (dist[i] != 0) ? dist[i] : 1;
+    double delta_pp = (dist[i] != 0) ? std::atan(2 * wheelbase[i] * std::sin(angle[i]) / safe_dist) : 0;
+    double delta_st = angle[i] - std::atan(k[i] * dist[i] / (soft_speed[i] + std::abs(speed[i])));
+    double s = (stanley[i] ? delta_st : delta_pp) / max_angle[i];
+    steering[i] = std::min(std::max(s, -1.0), 1.0);
+  }
+}
+
+void ChPathFollowerBatch::SpeedLaw(int           n,
+                                   double        time,
+                                   const double* ref_speed,
+                                   const double* speed,
+                                   const double* Kp,
+                                   const double* Ki,
+                                   const double* Kd,
+                                   double*       err,
+                                   double*       err_prev,
+                                   const double* err_int,
+                                   double*       prev_time,
+                                   double*       throttle,
+                                   double*       braking)
+{
+  CH_DRIVERBATCH_IVDEP
+  for (int i = 0; i < n; i++) {
+    double e = ref_speed[i] - speed[i];
+    bool valid = (prev_time[i] >= 0 && time > prev_time[i]);
+    double dt = valid ? time - prev_time[i] : 1;
+    double deriv = valid ? (e - err[i]) / dt : 0;
+    double out = Kp[i] * e + Ki[i] * err_int[i] + Kd[i] * deriv;
+
+    err_prev[i] = err[i];
+    err[i] = e;
+    prev_time[i] = time;
+    throttle[i] = std::min(std::max(out, 0.0), 1.0);
+    braking[i] = std::min(std::max(-out, 0.0), 1.0);
+  }
+}
+
+void ChPathFollowerBatch::IntegrateErrors(int           n,
+                                          double        h,
+                                          const double* Ki,
+                                          const double* err,
+                                          double*       err_int)
+{
+  CH_DRIVERBATCH_IVDEP
+  for (int i = 0; i < n; i++) {
+    double max_int = (Ki[i] > 0) ? 1 / Ki[i] : 0;
+    double v = err_int[i] + err[i] * h;
+    v = std::max(-max_int, std::min(v, max_int));
+    err_int[i] = (Ki[i] > 0) ? v : err_int[i] + err[i] * h;
+  }
+}
+
+
+} // end namespace chrono
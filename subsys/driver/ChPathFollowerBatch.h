@@ -0,0 +1,145 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched evaluation of the control laws for a collection of
+// ChPathFollowerDriver objects (e.g. all path-following drivers of a fleet).
+//
+// At each update, the batch projects each vehicle on its path (which needs the
+// vehicle state and the driver cursors), then gathers the inputs, parameters
+// and states of the steering and speed controllers of all drivers in
+// contiguous arrays and evaluates both control laws for all drivers in
+// branch-free loops. The controller states and the driver inputs are then
+// copied back into each driver, which remains the owner of its state (for
+// snapshots, and so that a driver can leave the batch at any time).
+//
+// ChPathFollowerDriver::Update() and Advance() use the same kernels, so the
+// batch produces the same driver inputs as the individual calls.
+//
+// =============================================================================
+
+#ifndef CH_PATH_FOLLOWER_BATCH_H
+#define CH_PATH_FOLLOWER_BATCH_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/driver/ChPathFollowerDriver.h"
+
+namespace chrono {
+
+///
+/// Batched path-following driver evaluator.
+/// At each step, the user calls Update() and Advance() on the batch, instead
+/// of Update() and Advance() on each driver.
+///
+class CH_SUBSYS_API ChPathFollowerBatch : public ChShared
+{
+public:
+
+  ChPathFollowerBatch();
+
+  ~ChPathFollowerBatch() {}
+
+  /// Add a path-following driver to this batch.
+  /// Returns the index of the driver in the batch.
+  int AddDriver(ChSharedPtr<ChPathFollowerDriver> driver);
+
+  /// Get the number of drivers in this batch.
+  int GetNumDrivers() const { return (int)m_drivers.size(); }
+
+  /// Update the inputs of all drivers in the batch.
+  void Update(double time);
+
+  /// Integrate the speed errors of all drivers in the batch.
+  void Advance(double step);
+
+  /// Steering law: compute the steering inputs of n drivers from the front
+  /// wheel angles given by pure pursuit or by the Stanley controller.
+  static void SteeringLaw(
+    int           n,            ///< [in] number of drivers
+    const char*   stanley,      ///< [in] non-zero for the Stanley controller
+    const double* angle,        ///< [in] look-ahead angle (pure pursuit) or heading error (Stanley)
+    const double* dist,         ///< [in] look-ahead distance (pure pursuit) or lateral error (Stanley)
+    const double* speed,        ///< [in] forward speeds
+    const double* wheelbase,    ///< [in] wheelbases
+    const double* k,            ///< [in] Stanley gains
+    const double* soft_speed,   ///< [in] Stanley softening speeds
+    const double* max_angle,    ///< [in] wheel angles for a steering input of 1
+    double*       steering      ///< [out] steering inputs, in [-1,1]
+    );
+
+  /// Speed law: compute the throttle and braking inputs of n drivers from a
+  /// PID controller on the forward speed, and update the speed errors.
+  static void SpeedLaw(
+    int           n,            ///< [in] number of drivers
+    double        time,         ///< [in] current time
+    const double* ref_speed,    ///< [in] reference speeds
+    const double* speed,        ///< [in] forward speeds
+    const double* Kp,           ///< [in] proportional gains
+    const double* Ki,           ///< [in] integral gains
+    const double* Kd,           ///< [in] derivative gains
+    double*       err,          ///< [in,out] speed errors (at the last update)
+    double*       err_prev,     ///< [out] speed errors at the previous update
+    const double* err_int,      ///< [in] integrals of the speed errors
+    double*       prev_time,    ///< [in,out] time of the last update (negative if none)
+    double*       throttle,     ///< [out] throttle inputs, in [0,1]
+    double*       braking       ///< [out] braking inputs, in [0,1]
+    );
+
+  /// Integrate the speed errors of n drivers over the step h, limiting the
+  /// integral term to the range of the inputs (anti-windup).
+  static void IntegrateErrors(
+    int           n,            ///< [in] number of drivers
+    double        h,            ///< [in] step size
+    const double* Ki,           ///< [in] integral gains
+    const double* err,          ///< [in] speed errors
+    double*       err_int       ///< [in,out] integrals of the speed errors
+    );
+
+private:
+
+  std::vector<ChSharedPtr<ChPathFollowerDriver> > m_drivers;
+
+  // steering law
+  std::vector<char>    m_stanley;
+  std::vector<double>  m_angle;
+  std::vector<double>  m_dist;
+  std::vector<double>  m_speed;
+  std::vector<double>  m_wheelbase;
+  std::vector<double>  m_k;
+  std::vector<double>  m_soft_speed;
+  std::vector<double>  m_max_angle;
+  std::vector<double>  m_steering;
+
+  // speed law
+  std::vector<double>  m_ref_speed;
+  std::vector<double>  m_Kp;
+  std::vector<double>  m_Ki;
+  std::vector<double>  m_Kd;
+  std::vector<double>  m_err;
+  std::vector<double>  m_err_prev;
+  std::vector<double>  m_err_int;
+  std::vector<double>  m_prev_time;
+  std::vector<double>  m_throttle;
+  std::vector<double>  m_braking;
+};
+
+
+} // end namespace chrono
+
+
+#endif
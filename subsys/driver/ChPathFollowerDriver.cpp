@@ -0,0 +1,199 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A closed-loop driver model tracking a reference path.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/driver/ChPathFollowerDriver.h"
+#include "subsys/driver/ChPathFollowerBatch.h"
+
+namespace chrono {
+
+// Distance from the end of the path at which the path is considered completed.
+static const double END_TOLERANCE = 0.1;
+
+// Half width of the lane in which the vehicle ahead is searched.
+static const double LANE_HALF_WIDTH = 1.75;
+
+static double wrap_angle(double a)
+{
+  while (a > CH_C_PI)
+    a -= 2 * CH_C_PI;
+  while (a < -CH_C_PI)
+    a += 2 * CH_C_PI;
+  return a;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPathFollowerDriver::ChPathFollowerDriver(const ChVehicle&          vehicle,
+                                           ChSharedPtr<ChDriverPath> path,
+                                           double                    target_speed)
+: m_vehicle(vehicle),
+  m_path(path),
+  m_mode(PURE_PURSUIT),
+  m_front(0),
+  m_rear(-3.4),
+  m_max_angle(0.5),
+  m_lookahead_min(5),
+  m_lookahead_time(1),
+  m_stanley_k(1),
+  m_stanley_soft(1),
+  m_Kp(0.4),
+  m_Ki(0.1),
+  m_Kd(0),
+  m_target_speed(target_speed),
+  m_traffic(0),
+  m_traffic_index(-1),
+  m_time_gap(1.5),
+  m_min_gap(10),
+  m_cursor(-1),
+  m_target_cursor(-1),
+  m_path_s(0),
+  m_lateral(0),
+  m_ref_speed(0),
+  m_completed(false),
+  m_speed_err(0),
+  m_speed_err_prev(0),
+  m_speed_err_int(0),
+  m_prev_time(-1)
+{
+}
+
+void ChPathFollowerDriver::SetTraffic(const vehicle::ChTrafficIndex* traffic,
+                                      int                            index,
+                                      double                         time_gap,
+                                      double                         min_gap)
+{
+  m_traffic = traffic;
+  m_traffic_index = index;
+  m_time_gap = time_gap;
+  m_min_gap = min_gap;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPathFollowerDriver::track(double& angle, double& dist, double& speed)
+{
+  const ChVector<>& pos = m_vehicle.GetChassisPos();
+  ChVector<> xaxis = m_vehicle.GetChassisRot().GetXaxis();
+  double yaw = std::atan2(xaxis.y, xaxis.x);
+  speed = m_vehicle.GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt() ^ xaxis;
+
+  // Project the steered axle center on the path.
+  double offset = (m_mode == PURE_PURSUIT) ? m_rear : m_front;
+  double px = pos.x + offset * std::cos(yaw);
+  double py = pos.y + offset * std::sin(yaw);
+
+  ChDriverPath::Projection proj;
+  m_path->Project(px, py, m_cursor, proj);
+
+  m_path_s = proj.s;
+  m_lateral = proj.lateral;
+
+  if (m_mode == PURE_PURSUIT) {
+    double Ld = std::max(m_lookahead_min, m_lookahead_time * std::abs(speed));
+    ChVector<> target = m_path->GetPoint(proj.s + Ld, m_target_cursor);
+    double dx = target.x - px;
+    double dy = target.y - py;
+    dist = std::sqrt(dx * dx + dy * dy);
+    angle = wrap_angle(std::atan2(dy, dx) - yaw);
+  } else {
+    dist = proj.lateral;
+    angle = wrap_angle(proj.heading - yaw);
+  }
+
+  // Reference speed.
+  m_completed = m_completed || (proj.s >= m_path->GetLength() - END_TOLERANCE);
+
+  if (m_completed)
+    m_ref_speed = 0;
+  else if (m_path->HasSpeeds())
+    m_ref_speed = m_path->GetSpeed(proj.s, proj.segment);
+  else
+    m_ref_speed = m_target_speed;
+
+  // Adaptive cruise control: constant time gap to the vehicle ahead.
+  if (m_traffic && m_time_gap > 0) {
+    double desired = m_min_gap + m_time_gap * std::max(speed, 0.0);
+    double range = 3 * (m_min_gap + m_time_gap * std::max(m_ref_speed, std::abs(speed)));
+    vehicle::ChTrafficIndex::Neighbor lead;
+    if (m_traffic->FindAhead(m_traffic_index, range, LANE_HALF_WIDTH, lead)) {
+      double v_acc = lead.speed + (lead.distance - desired) / m_time_gap;
+      m_ref_speed = std::min(m_ref_speed, std::max(v_acc, 0.0));
+    }
+  }
+}
+
+void ChPathFollowerDriver::Update(double time)
+{
+  double angle, dist, speed;
+  track(angle, dist, speed);
+
+  char stanley = (m_mode == STANLEY);
+  double wheelbase = m_front - m_rear;
+
+  ChPathFollowerBatch::SteeringLaw(1, &stanley, &angle, &dist, &speed, &wheelbase, &m_stanley_k, &m_stanley_soft,
+                                   &m_max_angle, &m_steering);
+  ChPathFollowerBatch::SpeedLaw(1, time, &m_ref_speed, &speed, &m_Kp, &m_Ki, &m_Kd, &m_speed_err, &m_speed_err_prev,
+                                &m_speed_err_int, &m_prev_time, &m_throttle, &m_braking);
+}
+
+void ChPathFollowerDriver::Advance(double step)
+{
+  ChPathFollowerBatch::IntegrateErrors(1, step, &m_Ki, &m_speed_err, &m_speed_err_int);
+}
+
+// -----------------------------------------------------------------------------
+// The path cursors are not saved: they are reacquired at the next update.
+// -----------------------------------------------------------------------------
+void ChPathFollowerDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChDriver::SaveState(state);
+
+  state.BeginBlock(5);
+  state.Write(m_speed_err);
+  state.Write(m_speed_err_prev);
+  state.Write(m_speed_err_int);
+  state.Write(m_prev_time);
+  state.Write(m_completed ? 1 : 0);
+}
+
+bool ChPathFollowerDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChDriver::RestoreState(state))
+    return false;
+
+  if (!state.OpenBlock(5, "path follower driver"))
+    return false;
+
+  m_speed_err = state.Read();
+  m_speed_err_prev = state.Read();
+  m_speed_err_int = state.Read();
+  m_prev_time = state.Read();
+  m_completed = state.Read() != 0;
+
+  m_cursor = -1;
+  m_target_cursor = -1;
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,183 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A closed-loop driver model tracking a reference path (see ChDriverPath).
+//
+// The steering input is obtained from the front wheel angle delta of either
+//  - pure pursuit: the rear axle center is steered towards the point of the
+//    path at the look-ahead distance Ld = max(Ld_min, k_v * v) ahead of its
+//    projection, delta = atan(2 L sin(alpha) / d), where alpha is the angle
+//    of that point in the chassis frame and d its distance; or
+//  - Stanley: delta = psi - atan(k e / (v_soft + |v|)), where psi is the
+//    heading error and e the lateral error of the front axle center
+//    (positive to the left of the path);
+// and scaled by the maximum wheel angle (the convention of ChBicycleModel:
+// a positive input turns to the left, about the z axis).
+//
+// The throttle and braking inputs come from a PID controller on the forward
+// speed, tracking the reference speed of the path (or a constant target
+// speed), which drops to zero at the end of the path. With a traffic index
+// (see ChTrafficIndex), the reference speed is also limited so as to keep a
+// constant time gap to the vehicle ahead in the lane (adaptive cruise control):
+//   v_ref <= v_lead + (gap - (gap_min + t_gap * v)) / t_gap
+//
+// Each driver keeps its own cursors on the path, so the path lookup costs
+// amortized constant time per step and the path can be shared by a fleet.
+// The control laws are evaluated by the kernels of ChPathFollowerBatch, which
+// can also evaluate them for the path-following drivers of a whole fleet.
+//
+// =============================================================================
+
+#ifndef CH_PATH_FOLLOWER_DRIVER_H
+#define CH_PATH_FOLLOWER_DRIVER_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChTrafficIndex.h"
+#include "subsys/driver/ChDriverPath.h"
+
+namespace chrono {
+
+///
+/// Path-following driver (pure pursuit or Stanley steering, PID speed control).
+///
+class CH_SUBSYS_API ChPathFollowerDriver : public ChDriver
+{
+public:
+
+  /// Steering controllers.
+  enum SteeringMode {
+    PURE_PURSUIT,   ///< steer the rear axle towards a look-ahead point
+    STANLEY         ///< correct the heading and lateral errors of the front axle
+  };
+
+  ChPathFollowerDriver(
+    const ChVehicle&           vehicle,        ///< [in] controlled vehicle
+    ChSharedPtr<ChDriverPath>  path,           ///< [in] reference path (may be shared)
+    double                     target_speed    ///< [in] target speed, if the path has no reference speeds
+    );
+
+  ~ChPathFollowerDriver() {}
+
+  /// Set the steering controller (default: PURE_PURSUIT).
+  void SetSteeringMode(SteeringMode mode) { m_mode = mode; }
+
+  /// Set the positions of the front and rear axle centers along the chassis
+  /// x axis, relative to the chassis reference frame (default: 0 and -3.4).
+  void SetAxleOffsets(double front, double rear) { m_front = front; m_rear = rear; }
+
+  /// Set the front wheel angle for a steering input of 1 (default: 0.5 rad).
+  void SetMaxSteeringAngle(double angle) { m_max_angle = angle; }
+
+  /// Set the pure pursuit look-ahead distance: Ld = max(min_dist, time * v)
+  /// (default: 5 m and 1 s).
+  void SetLookAhead(double min_dist, double time) { m_lookahead_min = min_dist; m_lookahead_time = time; }
+
+  /// Set the Stanley gain and softening speed (default: 1 and 1 m/s).
+  void SetStanleyGains(double k, double soft_speed) { m_stanley_k = k; m_stanley_soft = soft_speed; }
+
+  /// Set the gains of the speed controller (default: 0.4, 0.1, 0).
+  void SetSpeedGains(double Kp, double Ki, double Kd) { m_Kp = Kp; m_Ki = Ki; m_Kd = Kd; }
+
+  /// Set the target speed, used if the path has no reference speeds.
+  void SetTargetSpeed(double speed) { m_target_speed = speed; }
+
+  /// Follow the vehicle ahead in the specified traffic index, e.g. the index
+  /// of a fleet (see ChFleetSimulation::GetTrafficIndex()), in which this
+  /// driver's vehicle has the specified index. The gaps are measured between
+  /// the chassis reference frames. NULL disables the following.
+  void SetTraffic(
+    const vehicle::ChTrafficIndex* traffic,       ///< [in] traffic index (not owned)
+    int                            index,         ///< [in] index of the vehicle in the traffic index
+    double                         time_gap = 1.5,  ///< [in] time gap to the vehicle ahead
+    double                         min_gap = 10     ///< [in] gap at rest
+    );
+
+  /// Get the reference path.
+  ChSharedPtr<ChDriverPath> GetPath() const { return m_path; }
+
+  /// Get the arc length of the vehicle projection on the path, at the last update.
+  double GetPathDistance() const { return m_path_s; }
+
+  /// Get the lateral error (positive to the left of the path), at the last update.
+  double GetLateralError() const { return m_lateral; }
+
+  /// Get the reference speed at the last update.
+  double GetReferenceSpeed() const { return m_ref_speed; }
+
+  /// Return true once the vehicle reached the end of the path.
+  bool IsPathCompleted() const { return m_completed; }
+
+  /// Compute the driver inputs from the current vehicle state.
+  virtual void Update(double time);
+
+  /// Integrate the speed error over the specified step.
+  virtual void Advance(double step);
+
+  /// Append the driver inputs and the controller states to the specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs and the controller states from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+private:
+
+  friend class ChPathFollowerBatch;
+
+  // Project the vehicle on the path and update the path data. Returns the
+  // inputs of the steering law (the look-ahead angle and distance for pure
+  // pursuit, the heading and lateral errors for Stanley) and the forward speed.
+  void track(double& angle, double& dist, double& speed);
+
+  const ChVehicle&           m_vehicle;
+  ChSharedPtr<ChDriverPath>  m_path;
+
+  SteeringMode  m_mode;
+  double        m_front;
+  double        m_rear;
+  double        m_max_angle;
+  double        m_lookahead_min;
+  double        m_lookahead_time;
+  double        m_stanley_k;
+  double        m_stanley_soft;
+  double        m_Kp;
+  double        m_Ki;
+  double        m_Kd;
+  double        m_target_speed;
+
+  const vehicle::ChTrafficIndex* m_traffic;
+  int           m_traffic_index;
+  double        m_time_gap;
+  double        m_min_gap;
+
+  int           m_cursor;            // path segment of the steered point
+  int           m_target_cursor;     // path segment of the look-ahead point
+
+  double        m_path_s;
+  double        m_lateral;
+  double        m_ref_speed;
+  bool          m_completed;
+
+  double        m_speed_err;         // speed error at the last update
+  double        m_speed_err_prev;    // speed error at the previous update
+  double        m_speed_err_int;     // integral of the speed error
+  double        m_prev_time;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,125 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thread running the vehicle simulation loop, decoupled from the rendering.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "subsys/driver/ChPhysicsThread.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPhysicsThread::ChPhysicsThread(ChVehicle&                                car,
+                                 ChPowertrain&                             powertrain,
+                                 ChTerrain&                                terrain,
+                                 const std::vector<ChTire*>&               tires,
+                                 ChRenderProxy&                            proxy,
+                                 double                                    step_size,
+                                 double                                    render_step_size)
+: m_car(car),
+  m_powertrain(powertrain),
+  m_terrain(terrain),
+  m_tires(tires),
+  m_proxy(proxy),
+  m_step_size(step_size),
+  m_num_steps(0),
+  m_stop(0)
+{
+  m_render_steps = std::max<int>(1, (int)std::ceil(render_step_size / step_size));
+}
+
+// -----------------------------------------------------------------------------
+// Same sequence of module updates and advances as the demo programs; only the
+// driver is replaced by the inputs received from the rendering thread. The
+// wall clock time of a step (for the input events) is that at which the step
+// is due, i.e. the start time plus the elapsed simulation time.
+// -----------------------------------------------------------------------------
+void ChPhysicsThread::Run()
+{
+  int num_wheels = (int)m_tires.size();
+
+  ChTireForces tire_forces(num_wheels);
+  std::vector<ChWheelState> wheel_states(num_wheels);
+
+  double start_wall = vehicle::ChProfiler::GetTime();
+  double start_time = m_car.GetSystem()->GetChTime();
+
+  while (!vehicle::ChAtomicLoad(&m_stop)) {
+    // Collect output data from modules (for inter-module communication)
+    double step_wall = start_wall + (m_car.GetSystem()->GetChTime() - start_time);
+    const ChRenderProxy::Inputs& inputs = m_proxy.ReceiveInputs(step_wall);
+
+    double powertrain_torque = m_powertrain.GetOutputTorque();
+
+    for (int i = 0; i < num_wheels; i++) {
+      tire_forces[i] = m_tires[i]->GetTireForce();
+      m_car.GetWheelState(ChWheelID(i), wheel_states[i]);
+    }
+
+    double driveshaft_speed = m_car.GetDriveshaftSpeed();
+
+    // Update modules (process inputs from other modules)
+    double time = m_car.GetSystem()->GetChTime();
+
+    m_terrain.Update(time);
+
+    for (int i = 0; i < num_wheels; i++)
+      m_tires[i]->Update(time, wheel_states[i]);
+
+    m_powertrain.Update(time, inputs.throttle, driveshaft_speed);
+
+    m_car.Update(time, inputs.steering, inputs.braking, powertrain_torque, tire_forces);
+
+    // Advance simulation for one timestep for all modules
+    m_terrain.Advance(m_step_size);
+
+    for (int i = 0; i < num_wheels; i++)
+      m_tires[i]->Advance(m_step_size);
+
+    m_powertrain.Advance(m_step_size);
+
+    m_car.Advance(m_step_size);
+
+    m_num_steps++;
+
+    if (m_num_steps % m_render_steps == 0) {
+      m_proxy.Publish();
+
+      // Do not run ahead of the wall clock (except in a time warp). If the
+      // simulation falls behind, or runs ahead in a time warp, re-anchor the
+      // wall clock time of the steps to the current time, such that input
+      // events are neither held back by the accumulated lag nor applied early.
+      double ahead = (m_car.GetSystem()->GetChTime() - start_time) - (vehicle::ChProfiler::GetTime() - start_wall);
+      if (ahead > 0 && inputs.warp_time > time + m_step_size)
+        start_wall -= ahead;
+      else if (ahead > 0)
+        vehicle::ChThread::Sleep(ahead);
+      else
+        start_wall += ahead;
+    }
+  }
+
+  m_proxy.Publish();
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,92 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thread running the vehicle simulation loop (terrain, tires, powertrain and
+// vehicle; the driver inputs are received through a ChRenderProxy), decoupled
+// from the rendering. A snapshot is published to the proxy every render step.
+//
+// The simulation advances with a fixed step size and is paced to the wall
+// clock: the thread sleeps whenever the simulation time gets ahead of the
+// elapsed time. It never waits for the rendering thread. The driver input
+// events are applied at the steps corresponding to their timestamps (see
+// ChRenderProxy::ReceiveInputs()). While the inputs request a time warp (up
+// to a later simulation time), the simulation runs as fast as it can, and the
+// pacing resumes from the time reached.
+//
+// =============================================================================
+
+#ifndef CH_PHYSICS_THREAD_H
+#define CH_PHYSICS_THREAD_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/driver/ChRenderProxy.h"
+
+namespace chrono {
+
+///
+/// Simulation loop of a vehicle, executed on its own thread.
+///
+class CH_SUBSYS_API ChPhysicsThread : public vehicle::ChThread
+{
+public:
+
+  ChPhysicsThread(
+    ChVehicle&                                car,               ///< [in] simulated vehicle
+    ChPowertrain&                             powertrain,        ///< [in] powertrain of the vehicle
+    ChTerrain&                                terrain,           ///< [in] terrain
+    const std::vector<ChTire*>&               tires,             ///< [in] tires, indexed by wheel ID
+    ChRenderProxy&                            proxy,             ///< [in] proxy receiving the snapshots
+    double                                    step_size,         ///< [in] simulation step size
+    double                                    render_step_size   ///< [in] time interval between two snapshots
+    );
+
+  ~ChPhysicsThread() {}
+
+  /// Request the simulation loop to return (after the current step).
+  void Stop() { vehicle::ChAtomicStore(&m_stop, 1); }
+
+  /// Get the number of simulation steps taken (only valid once joined).
+  int GetNumSteps() const { return m_num_steps; }
+
+protected:
+
+  virtual void Run();
+
+private:
+
+  ChVehicle&                         m_car;
+  ChPowertrain&                      m_powertrain;
+  ChTerrain&                         m_terrain;
+  std::vector<ChTire*>               m_tires;
+  ChRenderProxy&                     m_proxy;
+
+  double                             m_step_size;
+  int                                m_render_steps;   // simulation steps between two snapshots
+  int                                m_num_steps;
+
+  volatile size_t                    m_stop;
+};
+
+
+} // end namespace chrono
+
+
+#endif
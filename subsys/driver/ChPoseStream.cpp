@@ -0,0 +1,541 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Streaming of vehicle snapshots (see ChRenderProxy) over UDP, for remote
+// visualization.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+# include <winsock2.h>
+# include <ws2tcpip.h>
+#else
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <netdb.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include "core/ChLog.h"
+
+#include "subsys/driver/ChPoseStream.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Socket wrapper (platform specific)
+// -----------------------------------------------------------------------------
+#ifdef _WIN32
+typedef SOCKET socket_t;
+static const socket_t INVALID_SOCKET_T = INVALID_SOCKET;
+static void CloseSocket(socket_t s) { closesocket(s); }
+#else
+typedef int socket_t;
+static const socket_t INVALID_SOCKET_T = -1;
+static void CloseSocket(socket_t s) { close(s); }
+#endif
+
+struct PoseSocket {
+  socket_t     s;
+  sockaddr_in  address;
+};
+
+static bool InitSockets()
+{
+#ifdef _WIN32
+  static bool initialized = false;
+  if (!initialized) {
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+      return false;
+    initialized = true;
+  }
+#endif
+  return true;
+}
+
+static bool SetNonBlocking(socket_t s)
+{
+#ifdef _WIN32
+  u_long mode = 1;
+  return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+  int flags = fcntl(s, F_GETFL, 0);
+  return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Little-endian serialization
+// -----------------------------------------------------------------------------
+static const char   POSE_MAGIC[4] = { 'C', 'H', 'P', '1' };
+static const size_t HEADER_SIZE = 4 + 4 + 4 + 8 + 3 * 4 + 2 + 4 * 2;
+static const double POS_SCALE = 1000;     // 1 mm
+static const double ROT_SCALE = 32767;
+
+static void PutU16(char*& p, unsigned int v)
+{
+  *p++ = (char)(v & 0xff);
+  *p++ = (char)((v >> 8) & 0xff);
+}
+
+static void PutU32(char*& p, unsigned int v)
+{
+  for (int i = 0; i < 4; i++)
+    *p++ = (char)((v >> (8 * i)) & 0xff);
+}
+
+static void PutF32(char*& p, float v)
+{
+  unsigned int u;
+  std::memcpy(&u, &v, 4);
+  PutU32(p, u);
+}
+
+static bool IsLittleEndian()
+{
+  unsigned int one = 1;
+  return *(const unsigned char*)&one == 1;
+}
+
+static void PutF64(char*& p, double v)
+{
+  unsigned int u[2];
+  std::memcpy(u, &v, 8);
+  int low = IsLittleEndian() ? 0 : 1;
+  PutU32(p, u[low]);
+  PutU32(p, u[1 - low]);
+}
+
+static unsigned int GetU16(const char*& p)
+{
+  const unsigned char* q = (const unsigned char*)p;
+  p += 2;
+  return q[0] | (q[1] << 8);
+}
+
+static unsigned int GetU32(const char*& p)
+{
+  const unsigned char* q = (const unsigned char*)p;
+  p += 4;
+  return q[0] | (q[1] << 8) | (q[2] << 16) | ((unsigned int)q[3] << 24);
+}
+
+static int GetI16(const char*& p)
+{
+  int v = (int)GetU16(p);
+  return (v >= 0x8000) ? v - 0x10000 : v;
+}
+
+static float GetF32(const char*& p)
+{
+  unsigned int u = GetU32(p);
+  float v;
+  std::memcpy(&v, &u, 4);
+  return v;
+}
+
+static double GetF64(const char*& p)
+{
+  unsigned int u[2];
+  int low = IsLittleEndian() ? 0 : 1;
+  u[low] = GetU32(p);
+  u[1 - low] = GetU32(p);
+  double v;
+  std::memcpy(&v, u, 8);
+  return v;
+}
+
+static int Quantize(double v, double scale)
+{
+  return (int)std::floor(v * scale + 0.5);
+}
+
+// Collect the link end points of a snapshot in message order.
+static void GetPoints(const ChRenderProxy::Snapshot& s, std::vector<const ChVector<>*>& points)
+{
+  points.clear();
+  for (size_t i = 0; i < s.springs.size(); i++)
+    points.push_back(&s.springs[i]);
+  for (size_t i = 0; i < s.distances.size(); i++)
+    points.push_back(&s.distances[i]);
+  for (size_t i = 0; i < s.revsphs.size(); i++)
+    points.push_back(&s.revsphs[i]);
+}
+
+
+// -----------------------------------------------------------------------------
+// ChPoseEncoder
+// -----------------------------------------------------------------------------
+ChPoseEncoder::ChPoseEncoder(int keyframe_interval)
+: m_keyframe_interval(keyframe_interval > 0 ? keyframe_interval : 1),
+  m_sequence(0),
+  m_key(0)
+{
+}
+
+void ChPoseEncoder::Encode(const ChRenderProxy::Snapshot& s, std::vector<char>& msg)
+{
+  std::vector<const ChVector<>*> points;
+  GetPoints(s, points);
+
+  size_t num_bodies = s.poses.size();
+  size_t num_values = 3 * (num_bodies + points.size());
+
+  // Quantize all locations; send a keyframe at the fixed interval, if the
+  // layout changed, or if a difference with the keyframe is too large.
+  std::vector<int> values(num_values);
+  size_t k = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    values[k++] = Quantize(s.poses[i].pos.x, POS_SCALE);
+    values[k++] = Quantize(s.poses[i].pos.y, POS_SCALE);
+    values[k++] = Quantize(s.poses[i].pos.z, POS_SCALE);
+  }
+  for (size_t i = 0; i < points.size(); i++) {
+    values[k++] = Quantize(points[i]->x, POS_SCALE);
+    values[k++] = Quantize(points[i]->y, POS_SCALE);
+    values[k++] = Quantize(points[i]->z, POS_SCALE);
+  }
+
+  bool keyframe = (m_sequence % m_keyframe_interval == 0) || m_key_values.size() != num_values;
+  for (size_t j = 0; j < num_values && !keyframe; j++) {
+    int delta = values[j] - m_key_values[j];
+    if (delta < -32768 || delta > 32767)
+      keyframe = true;
+  }
+
+  if (keyframe) {
+    m_key = m_sequence;
+    m_key_values.swap(values);
+  }
+
+  // Write the message.
+  size_t loc_size = keyframe ? 4 : 2;
+  msg.resize(HEADER_SIZE + num_bodies * 4 * 2 + num_values * loc_size);
+
+  char* p = &msg[0];
+  std::memcpy(p, POSE_MAGIC, 4);
+  p += 4;
+  PutU32(p, m_sequence);
+  PutU32(p, m_key);
+  PutF64(p, s.time);
+  PutF32(p, (float)s.speed);
+  PutF32(p, (float)s.motor_speed);
+  PutF32(p, (float)s.motor_torque);
+  PutU16(p, (unsigned int)(s.gear & 0xffff));
+  PutU16(p, (unsigned int)num_bodies);
+  PutU16(p, (unsigned int)s.springs.size());
+  PutU16(p, (unsigned int)s.distances.size());
+  PutU16(p, (unsigned int)s.revsphs.size());
+
+  const std::vector<int>& cur = keyframe ? m_key_values : values;
+  k = 0;
+  for (size_t i = 0; i < num_bodies + points.size(); i++) {
+    for (int j = 0; j < 3; j++, k++) {
+      if (keyframe)
+        PutU32(p, (unsigned int)cur[k]);
+      else
+        PutU16(p, (unsigned int)((cur[k] - m_key_values[k]) & 0xffff));
+    }
+    if (i < num_bodies) {
+      const ChQuaternion<>& q = s.poses[i].rot;
+      PutU16(p, (unsigned int)(Quantize(q.e0, ROT_SCALE) & 0xffff));
+      PutU16(p, (unsigned int)(Quantize(q.e1, ROT_SCALE) & 0xffff));
+      PutU16(p, (unsigned int)(Quantize(q.e2, ROT_SCALE) & 0xffff));
+      PutU16(p, (unsigned int)(Quantize(q.e3, ROT_SCALE) & 0xffff));
+    }
+  }
+
+  m_sequence++;
+}
+
+
+// -----------------------------------------------------------------------------
+// ChPoseDecoder
+// -----------------------------------------------------------------------------
+bool ChPoseDecoder::Decode(const char* msg, size_t size, ChRenderProxy::Snapshot& s)
+{
+  if (size < HEADER_SIZE || std::memcmp(msg, POSE_MAGIC, 4) != 0)
+    return false;
+
+  const char* p = msg + 4;
+  unsigned int sequence = GetU32(p);
+  unsigned int key = GetU32(p);
+  double time = GetF64(p);
+  float speed = GetF32(p);
+  float motor_speed = GetF32(p);
+  float motor_torque = GetF32(p);
+  int gear = GetI16(p);
+  size_t num_bodies = GetU16(p);
+  size_t num_springs = GetU16(p);
+  size_t num_distances = GetU16(p);
+  size_t num_revsphs = GetU16(p);
+
+  size_t num_points = num_springs + num_distances + num_revsphs;
+  size_t num_values = 3 * (num_bodies + num_points);
+  bool keyframe = (key == sequence);
+  size_t loc_size = keyframe ? 4 : 2;
+
+  if (size != HEADER_SIZE + num_bodies * 4 * 2 + num_values * loc_size)
+    return false;
+
+  // Drop out-of-order messages and deltas without their keyframe.
+  if (m_has_key && sequence <= m_sequence && sequence != 0)
+    return false;
+  if (!keyframe && (!m_has_key || key != m_key || m_key_values.size() != num_values))
+    return false;
+
+  s.time = time;
+  s.speed = speed;
+  s.motor_speed = motor_speed;
+  s.motor_torque = motor_torque;
+  s.gear = gear;
+  s.poses.resize(num_bodies);
+  s.springs.resize(num_springs);
+  s.distances.resize(num_distances);
+  s.revsphs.resize(num_revsphs);
+
+  if (keyframe)
+    m_key_values.resize(num_values);
+
+  size_t k = 0;
+  for (size_t i = 0; i < num_bodies + num_points; i++) {
+    int v[3];
+    for (int j = 0; j < 3; j++, k++) {
+      if (keyframe) {
+        m_key_values[k] = (int)GetU32(p);
+        v[j] = m_key_values[k];
+      } else {
+        v[j] = m_key_values[k] + GetI16(p);
+      }
+    }
+
+    ChVector<> loc(v[0] / POS_SCALE, v[1] / POS_SCALE, v[2] / POS_SCALE);
+
+    if (i < num_bodies) {
+      ChQuaternion<> q;
+      q.e0 = GetI16(p) / ROT_SCALE;
+      q.e1 = GetI16(p) / ROT_SCALE;
+      q.e2 = GetI16(p) / ROT_SCALE;
+      q.e3 = GetI16(p) / ROT_SCALE;
+      q.Normalize();
+      s.poses[i] = ChCoordsys<>(loc, q);
+    } else {
+      size_t j = i - num_bodies;
+      if (j < num_springs)
+        s.springs[j] = loc;
+      else if (j < num_springs + num_distances)
+        s.distances[j - num_springs] = loc;
+      else
+        s.revsphs[j - num_springs - num_distances] = loc;
+    }
+  }
+
+  if (keyframe) {
+    m_key = key;
+    m_has_key = true;
+  }
+  m_sequence = sequence;
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// ChPosePublisher
+// -----------------------------------------------------------------------------
+ChPosePublisher::ChPosePublisher(const std::string& host,
+                                 int                port,
+                                 double             rate,
+                                 int                keyframe_interval)
+: m_host(host),
+  m_port(port),
+  m_period(1 / rate),
+  m_encoder(keyframe_interval),
+  m_socket(0),
+  m_stop(0),
+  m_num_messages(0)
+{
+}
+
+ChPosePublisher::~ChPosePublisher()
+{
+  Stop();
+}
+
+bool ChPosePublisher::Start()
+{
+  if (IsRunning())
+    return true;
+
+  if (!InitSockets()) {
+    GetLog() << "ERROR: cannot initialize the network\n";
+    return false;
+  }
+
+  // Resolve the receiver address.
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  addrinfo* result = 0;
+  if (getaddrinfo(m_host.c_str(), 0, &hints, &result) != 0 || !result) {
+    GetLog() << "ERROR: unknown host " << m_host.c_str() << "\n";
+    return false;
+  }
+
+  PoseSocket* sock = new PoseSocket;
+  std::memcpy(&sock->address, result->ai_addr, sizeof(sockaddr_in));
+  sock->address.sin_port = htons((unsigned short)m_port);
+  freeaddrinfo(result);
+
+  sock->s = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock->s == INVALID_SOCKET_T) {
+    GetLog() << "ERROR: cannot open a UDP socket\n";
+    delete sock;
+    return false;
+  }
+
+  m_socket = sock;
+  m_num_messages = 0;
+  vehicle::ChAtomicStore(&m_stop, 0);
+
+  if (!ChThread::Start()) {
+    CloseSocket(sock->s);
+    delete sock;
+    m_socket = 0;
+    return false;
+  }
+
+  return true;
+}
+
+void ChPosePublisher::Stop()
+{
+  if (IsRunning()) {
+    vehicle::ChAtomicStore(&m_stop, 1);
+    Join();
+  }
+
+  if (m_socket) {
+    PoseSocket* sock = (PoseSocket*)m_socket;
+    CloseSocket(sock->s);
+    delete sock;
+    m_socket = 0;
+  }
+}
+
+void ChPosePublisher::Post(const ChRenderProxy::Snapshot& snapshot)
+{
+  m_snapshots.GetWriteBuffer() = snapshot;
+  m_snapshots.Publish();
+}
+
+void ChPosePublisher::Run()
+{
+  PoseSocket* sock = (PoseSocket*)m_socket;
+  std::vector<char> msg;
+
+  while (!vehicle::ChAtomicLoad(&m_stop)) {
+    if (m_snapshots.Acquire()) {
+      m_encoder.Encode(m_snapshots.GetReadBuffer(), msg);
+
+      // Datagrams are sent without waiting for (or checking) delivery.
+      sendto(sock->s, &msg[0], (int)msg.size(), 0, (const sockaddr*)&sock->address, sizeof(sock->address));
+      m_num_messages++;
+    }
+
+    vehicle::ChThread::Sleep(m_period);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// ChPoseSubscriber
+// -----------------------------------------------------------------------------
+bool ChPoseSubscriber::Open(int port)
+{
+  Close();
+
+  if (!InitSockets()) {
+    GetLog() << "ERROR: cannot initialize the network\n";
+    return false;
+  }
+
+  PoseSocket* sock = new PoseSocket;
+  sock->s = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock->s == INVALID_SOCKET_T) {
+    GetLog() << "ERROR: cannot open a UDP socket\n";
+    delete sock;
+    return false;
+  }
+
+  std::memset(&sock->address, 0, sizeof(sock->address));
+  sock->address.sin_family = AF_INET;
+  sock->address.sin_addr.s_addr = htonl(INADDR_ANY);
+  sock->address.sin_port = htons((unsigned short)port);
+
+  if (bind(sock->s, (const sockaddr*)&sock->address, sizeof(sock->address)) != 0 || !SetNonBlocking(sock->s)) {
+    GetLog() << "ERROR: cannot bind to UDP port " << port << "\n";
+    CloseSocket(sock->s);
+    delete sock;
+    return false;
+  }
+
+  m_socket = sock;
+  m_buffer.resize(65536);
+
+  return true;
+}
+
+void ChPoseSubscriber::Close()
+{
+  if (!m_socket)
+    return;
+
+  PoseSocket* sock = (PoseSocket*)m_socket;
+  CloseSocket(sock->s);
+  delete sock;
+  m_socket = 0;
+}
+
+bool ChPoseSubscriber::Receive(ChRenderProxy::Snapshot& snapshot)
+{
+  if (!m_socket)
+    return false;
+
+  PoseSocket* sock = (PoseSocket*)m_socket;
+  bool received = false;
+
+  while (true) {
+    int size = (int)recv(sock->s, &m_buffer[0], (int)m_buffer.size(), 0);
+    if (size <= 0)
+      break;
+    if (m_decoder.Decode(&m_buffer[0], (size_t)size, snapshot))
+      received = true;
+  }
+
+  return received;
+}
+
+
+} // end namespace chrono
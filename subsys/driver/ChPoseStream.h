@@ -0,0 +1,183 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Streaming of vehicle snapshots (see ChRenderProxy) over UDP, for remote
+// visualization.
+//
+// A ChPosePublisher is attached to a ChRenderProxy, which hands it a copy of
+// each published snapshot through a triple buffer; the publisher thread
+// encodes the latest snapshot at a fixed rate and sends it as one datagram.
+// The simulation thread never waits for the encoding or the network.
+// A ChPoseSubscriber receives the datagrams (without blocking) and decodes
+// the latest one.
+//
+// Message format (all values little-endian):
+//   magic            "CHP1" (4 bytes)
+//   sequence         uint32   message number
+//   key              uint32   sequence of the reference keyframe
+//   time             float64
+//   speed            float32  vehicle and powertrain outputs
+//   motor_speed      float32
+//   motor_torque     float32
+//   gear             int16
+//   num_bodies       uint16
+//   num_springs      uint16   number of spring end points
+//   num_distances    uint16   number of distance link end points
+//   num_revsphs      uint16   number of revolute-spherical end points
+//   bodies           location (3 x Q) and orientation (4 x int16, scaled by
+//                    32767), for each body
+//   points           location (3 x Q), for each link end point
+// Locations are quantized to 1 mm. In a keyframe (key == sequence), Q is an
+// int32 absolute value; otherwise Q is an int16 difference with the keyframe.
+// A keyframe is sent at a fixed interval, or whenever a difference does not
+// fit in 16 bits, so a lost datagram delays the viewer by at most one
+// keyframe interval.
+//
+// =============================================================================
+
+#ifndef CH_POSE_STREAM_H
+#define CH_POSE_STREAM_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChTripleBuffer.h"
+#include "subsys/driver/ChRenderProxy.h"
+
+namespace chrono {
+
+///
+/// Encoder of snapshots into delta-encoded messages.
+///
+class CH_SUBSYS_API ChPoseEncoder
+{
+public:
+
+  ChPoseEncoder(int keyframe_interval = 30);
+
+  /// Encode the snapshot into the specified message (resized as needed).
+  void Encode(const ChRenderProxy::Snapshot& snapshot, std::vector<char>& msg);
+
+private:
+
+  int                  m_keyframe_interval;
+  unsigned int         m_sequence;
+  unsigned int         m_key;
+  std::vector<int>     m_key_values;    // quantized locations of the keyframe
+};
+
+///
+/// Decoder of the messages produced by ChPoseEncoder.
+///
+class CH_SUBSYS_API ChPoseDecoder
+{
+public:
+
+  ChPoseDecoder() : m_key(0), m_has_key(false), m_sequence(0) {}
+
+  /// Decode a message into the specified snapshot (resized as needed).
+  /// Returns false if the message is invalid, older than the last decoded
+  /// message, or refers to a keyframe which was not received.
+  bool Decode(const char* msg, size_t size, ChRenderProxy::Snapshot& snapshot);
+
+private:
+
+  unsigned int         m_key;
+  bool                 m_has_key;
+  unsigned int         m_sequence;
+  std::vector<int>     m_key_values;
+};
+
+///
+/// Publisher of snapshots over UDP, running on its own thread.
+///
+class CH_SUBSYS_API ChPosePublisher : public vehicle::ChThread
+{
+public:
+
+  ChPosePublisher(
+    const std::string&  host,                ///< [in] address of the receiver (IPv4 or host name)
+    int                 port,                ///< [in] UDP port of the receiver
+    double              rate = 30,           ///< [in] message rate [Hz]
+    int                 keyframe_interval = 30  ///< [in] number of messages between keyframes
+    );
+
+  /// The destructor stops the publisher thread.
+  ~ChPosePublisher();
+
+  /// Open the socket and start the publisher thread.
+  /// Returns false if the socket cannot be opened or the host is unknown.
+  bool Start();
+
+  /// Stop the publisher thread.
+  void Stop();
+
+  /// Post a snapshot (called by ChRenderProxy::Publish(); never blocks). The
+  /// snapshot buffers are allocated by the first posts only.
+  void Post(const ChRenderProxy::Snapshot& snapshot);
+
+  /// Get the number of messages sent (only valid once stopped).
+  int GetNumMessages() const { return m_num_messages; }
+
+protected:
+
+  virtual void Run();
+
+private:
+
+  std::string                                        m_host;
+  int                                                m_port;
+  double                                             m_period;
+
+  ChPoseEncoder                                      m_encoder;
+  vehicle::ChTripleBuffer<ChRenderProxy::Snapshot>   m_snapshots;
+
+  void*                                              m_socket;   // socket and receiver address
+  volatile size_t                                    m_stop;
+  int                                                m_num_messages;
+};
+
+///
+/// Receiver of the snapshots sent by a ChPosePublisher.
+///
+class CH_SUBSYS_API ChPoseSubscriber
+{
+public:
+
+  ChPoseSubscriber() : m_socket(0) {}
+  ~ChPoseSubscriber() { Close(); }
+
+  /// Bind to the specified UDP port. Returns false on failure.
+  bool Open(int port);
+  void Close();
+
+  /// Receive all pending messages (without blocking) and decode the latest
+  /// valid one into the specified snapshot. Returns false if no new snapshot
+  /// was received.
+  bool Receive(ChRenderProxy::Snapshot& snapshot);
+
+private:
+
+  void*                m_socket;
+  ChPoseDecoder        m_decoder;
+  std::vector<char>    m_buffer;
+};
+
+
+} // end namespace chrono
+
+
+#endif
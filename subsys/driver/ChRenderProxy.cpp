@@ -0,0 +1,202 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Exchange of data between a physics thread and a rendering thread.
+//
+// =============================================================================
+
+#include "subsys/driver/ChRenderProxy.h"
+#include "subsys/driver/ChPoseStream.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// The proxy bodies are fixed and do not collide; they only carry the assets of
+// the simulated bodies (shared, as the assets are not modified during the
+// simulation) and the poses of their reference frames.
+// -----------------------------------------------------------------------------
+ChRenderProxy::ChRenderProxy(ChVehicle&     car,
+                             ChPowertrain&  powertrain,
+                             ChSystem&      render_system)
+: m_car(car),
+  m_powertrain(powertrain),
+  m_publisher(0)
+{
+  ChSystem* system = car.GetSystem();
+
+  // The proxies share the assets of the simulated bodies.
+  vehicle::ChDeferredAssets::Materialize(system);
+
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody) {
+    ChSharedPtr<ChBody> proxy(new ChBody);
+    proxy->SetIdentifier((*ibody)->GetIdentifier());
+    proxy->SetNameString((*ibody)->GetNameString());
+    proxy->SetBodyFixed(true);
+    proxy->SetCollide(false);
+    proxy->SetCoord((*ibody)->GetFrame_REF_to_abs().GetCoord());
+
+    std::vector<ChSharedPtr<ChAsset> >& assets = (*ibody)->GetAssets();
+    for (size_t i = 0; i < assets.size(); i++)
+      proxy->AddAsset(assets[i]);
+
+    render_system.AddBody(proxy);
+
+    if (*ibody == car.GetChassis().get_ptr())
+      m_chassis = proxy;
+
+    m_bodies.push_back(*ibody);
+    m_proxies.push_back(proxy);
+  }
+
+  std::vector<ChLink*>::iterator ilink = system->Get_linklist()->begin();
+  for (; ilink != system->Get_linklist()->end(); ++ilink) {
+    if (ChLinkSpring* link = dynamic_cast<ChLinkSpring*>(*ilink))
+      m_springs.push_back(link);
+    else if (ChLinkSpringCB* link = dynamic_cast<ChLinkSpringCB*>(*ilink))
+      m_springsCB.push_back(link);
+    else if (ChLinkDistance* link = dynamic_cast<ChLinkDistance*>(*ilink))
+      m_distances.push_back(link);
+    else if (ChLinkRevoluteSpherical* link = dynamic_cast<ChLinkRevoluteSpherical*>(*ilink))
+      m_revsphs.push_back(link);
+  }
+
+  // Size all snapshot buffers once, so that publishing never allocates.
+  Snapshot snapshot;
+  snapshot.poses.resize(m_bodies.size());
+  snapshot.springs.resize(2 * (m_springs.size() + m_springsCB.size()));
+  snapshot.distances.resize(2 * m_distances.size());
+  snapshot.revsphs.resize(2 * m_revsphs.size());
+  m_snapshots.Reset(snapshot);
+
+  m_inputs.steering = 0;
+  m_inputs.throttle = 0;
+  m_inputs.braking = 0;
+  m_inputs.drive_mode = powertrain.GetDriveMode();
+  m_inputs.warp_time = 0;
+  m_sent = m_inputs;
+  m_sent_valid = true;
+  m_max_latency = 0;
+
+  Publish();
+  Update();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRenderProxy::Publish()
+{
+  Snapshot& s = m_snapshots.GetWriteBuffer();
+
+  s.time = m_car.GetSystem()->GetChTime();
+
+  for (size_t i = 0; i < m_bodies.size(); i++)
+    s.poses[i] = m_bodies[i]->GetFrame_REF_to_abs().GetCoord();
+
+  size_t k = 0;
+  for (size_t i = 0; i < m_springs.size(); i++) {
+    s.springs[k++] = m_springs[i]->GetEndPoint1Abs();
+    s.springs[k++] = m_springs[i]->GetEndPoint2Abs();
+  }
+  for (size_t i = 0; i < m_springsCB.size(); i++) {
+    s.springs[k++] = m_springsCB[i]->GetEndPoint1Abs();
+    s.springs[k++] = m_springsCB[i]->GetEndPoint2Abs();
+  }
+  for (size_t i = 0; i < m_distances.size(); i++) {
+    s.distances[2 * i] = m_distances[i]->GetEndPoint1Abs();
+    s.distances[2 * i + 1] = m_distances[i]->GetEndPoint2Abs();
+  }
+  for (size_t i = 0; i < m_revsphs.size(); i++) {
+    s.revsphs[2 * i] = m_revsphs[i]->GetPoint1Abs();
+    s.revsphs[2 * i + 1] = m_revsphs[i]->GetPoint2Abs();
+  }
+
+  s.speed = m_car.GetVehicleSpeed();
+  s.motor_speed = m_powertrain.GetMotorSpeed();
+  s.motor_torque = m_powertrain.GetMotorTorque();
+  s.tc_slip = m_powertrain.GetTorqueConverterSlippage();
+  s.tc_torque_in = m_powertrain.GetTorqueConverterInputTorque();
+  s.tc_torque_out = m_powertrain.GetTorqueConverterOutputTorque();
+  s.gear = m_powertrain.GetCurrentTransmissionGear();
+  s.drive_mode = m_powertrain.GetDriveMode();
+
+  if (m_publisher)
+    m_publisher->Post(s);
+
+  m_snapshots.Publish();
+}
+
+// -----------------------------------------------------------------------------
+// Events posted after the time of the current step stay queued for a later
+// step; an event which is already late (the simulation lags behind) is applied
+// right away.
+// -----------------------------------------------------------------------------
+const ChRenderProxy::Inputs& ChRenderProxy::ReceiveInputs(double time)
+{
+  InputEvent event;
+  while (m_input_events.Peek(event) && event.time <= time) {
+    m_input_events.Pop(event);
+    m_inputs = event.inputs;
+
+    double latency = vehicle::ChProfiler::GetTime() - event.time;
+    if (latency > m_max_latency)
+      m_max_latency = latency;
+  }
+
+  if (m_inputs.drive_mode != m_powertrain.GetDriveMode())
+    m_powertrain.SetDriveMode(m_inputs.drive_mode);
+
+  return m_inputs;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChRenderProxy::Update()
+{
+  if (!m_snapshots.Acquire())
+    return false;
+
+  const Snapshot& s = m_snapshots.GetReadBuffer();
+  for (size_t i = 0; i < m_proxies.size(); i++)
+    m_proxies[i]->SetCoord(s.poses[i]);
+
+  return true;
+}
+
+bool ChRenderProxy::SendInputs(const Inputs& inputs)
+{
+  if (m_sent_valid &&
+      inputs.steering == m_sent.steering &&
+      inputs.throttle == m_sent.throttle &&
+      inputs.braking == m_sent.braking &&
+      inputs.drive_mode == m_sent.drive_mode &&
+      inputs.warp_time == m_sent.warp_time)
+    return true;
+
+  InputEvent event;
+  event.time = vehicle::ChProfiler::GetTime();
+  event.inputs = inputs;
+
+  m_sent_valid = m_input_events.Push(event);
+  m_sent = inputs;
+
+  return m_sent_valid;
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,183 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Exchange of data between a physics thread and a rendering thread, such that
+// the simulation does not wait for the rendering (and vice versa).
+//
+// At construction, a proxy body is created in a separate (render) system for
+// each body of the simulated system, sharing its visualization assets; the
+// renderer (e.g. a ChIrrApp) is attached to the render system only. The
+// physics thread publishes a snapshot of the body poses, the link geometry and
+// the vehicle and powertrain outputs after each step (or any other interval),
+// through a lock-free triple buffer. The rendering thread acquires the latest
+// snapshot at its own frame rate and moves the proxy bodies accordingly.
+//
+// The driver inputs travel the other way, as timestamped events (the wall
+// clock time of each change, see ChProfiler::GetTime()) in a lock-free queue.
+// The physics thread applies each event at the step whose simulation time
+// corresponds to its timestamp, rather than at the next snapshot, so the
+// input-to-force latency does not depend on the rendering frame rate; it is
+// bounded by the interval the simulation may run ahead of the wall clock
+// (one render step, see ChPhysicsThread). Events are produced by a single
+// thread: the rendering thread (ChIrrGuiDriver::OnEvent) or an input thread
+// sampling another device.
+//
+// The bodies and links of the simulated system are collected at construction;
+// bodies and links added later are not rendered.
+//
+// Each published snapshot can also be handed to a ChPosePublisher, which
+// streams it to remote viewers.
+//
+// =============================================================================
+
+#ifndef CH_RENDER_PROXY_H
+#define CH_RENDER_PROXY_H
+
+#include <vector>
+
+#include "physics/ChSystem.h"
+#include "physics/ChLinkSpring.h"
+#include "physics/ChLinkSpringCB.h"
+#include "physics/ChLinkDistance.h"
+#include "physics/ChLinkRevoluteSpherical.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChTripleBuffer.h"
+#include "subsys/ChSpscQueue.h"
+
+namespace chrono {
+
+class ChPosePublisher;
+
+///
+/// Render-side mirror of a vehicle system, updated from snapshots published by
+/// the physics thread.
+///
+class CH_SUBSYS_API ChRenderProxy
+{
+public:
+
+  /// Data published by the physics thread.
+  struct Snapshot {
+    double                     time;
+    std::vector<ChCoordsys<> > poses;         ///< reference frames of the bodies
+    std::vector<ChVector<> >   springs;       ///< end points of the springs (pairs)
+    std::vector<ChVector<> >   distances;     ///< end points of the distance links (pairs)
+    std::vector<ChVector<> >   revsphs;       ///< end points of the revolute-spherical links (pairs)
+
+    double                     speed;         ///< vehicle speed
+    double                     motor_speed;   ///< powertrain outputs
+    double                     motor_torque;
+    double                     tc_slip;
+    double                     tc_torque_in;
+    double                     tc_torque_out;
+    int                        gear;
+    ChPowertrain::DriveMode    drive_mode;
+  };
+
+  /// Driver inputs published by the rendering thread.
+  struct Inputs {
+    double                     steering;
+    double                     throttle;
+    double                     braking;
+    ChPowertrain::DriveMode    drive_mode;    ///< requested powertrain drive mode
+    double                     warp_time;     ///< run unpaced up to this simulation time (time warp)
+  };
+
+  /// Create the proxy bodies in the render system and publish an initial
+  /// snapshot. Must be called before the physics thread is started.
+  ChRenderProxy(
+    ChVehicle&     car,             ///< [in] simulated vehicle (its system is mirrored)
+    ChPowertrain&  powertrain,      ///< [in] powertrain of the vehicle
+    ChSystem&      render_system    ///< [in] system receiving the proxy bodies
+    );
+
+  ~ChRenderProxy() {}
+
+  /// Capture and publish a snapshot of the simulated system (physics thread).
+  void Publish();
+
+  /// Apply all input events with a timestamp up to the specified wall clock
+  /// time (that of the current simulation step), including a requested change
+  /// of the powertrain drive mode, and return the resulting driver inputs
+  /// (physics thread).
+  const Inputs& ReceiveInputs(double time);
+
+  /// Get the largest delay between the timestamp of an input event and its
+  /// application by ReceiveInputs() (only valid once the physics thread is
+  /// joined).
+  double GetMaxInputLatency() const { return m_max_latency; }
+
+  /// Acquire the latest snapshot and move the proxy bodies (rendering thread).
+  /// Returns false if no new snapshot was published since the last call.
+  bool Update();
+
+  /// Get the snapshot acquired by the last Update() (rendering thread).
+  const Snapshot& GetSnapshot() const { return m_snapshots.GetReadBuffer(); }
+
+  /// Post the driver inputs, timestamped with the current wall clock time, if
+  /// they differ from the last posted ones (input producer thread). Returns
+  /// false if the event queue is full; the inputs are then posted again with
+  /// the next call.
+  bool SendInputs(const Inputs& inputs);
+
+  /// Get the proxy of the vehicle chassis, e.g. for a chase camera.
+  ChSharedPtr<ChBody> GetChassis() const { return m_chassis; }
+
+  /// Get the number of proxy bodies.
+  int GetNumBodies() const { return (int)m_bodies.size(); }
+
+  /// Also post each published snapshot to the specified publisher (NULL to
+  /// detach it). Must not be called while the physics thread is running.
+  void SetPublisher(ChPosePublisher* publisher) { m_publisher = publisher; }
+
+private:
+
+  ChRenderProxy(const ChRenderProxy&);
+  ChRenderProxy& operator=(const ChRenderProxy&);
+
+  ChVehicle&                              m_car;
+  ChPowertrain&                           m_powertrain;
+
+  std::vector<ChBody*>                    m_bodies;      // simulated bodies
+  std::vector<ChSharedPtr<ChBody> >       m_proxies;     // proxy bodies (same order)
+  ChSharedPtr<ChBody>                     m_chassis;     // proxy of the chassis
+
+  std::vector<ChLinkSpring*>              m_springs;
+  std::vector<ChLinkSpringCB*>            m_springsCB;
+  std::vector<ChLinkDistance*>            m_distances;
+  std::vector<ChLinkRevoluteSpherical*>   m_revsphs;
+
+  vehicle::ChTripleBuffer<Snapshot>       m_snapshots;   // physics -> rendering
+  struct InputEvent {
+    double                    time;          // wall clock time of the change
+    Inputs                    inputs;
+  };
+
+  vehicle::ChSpscQueue<InputEvent>        m_input_events;   // rendering -> physics
+  Inputs                                  m_sent;           // last posted inputs (producer)
+  bool                                    m_sent_valid;
+  Inputs                                  m_inputs;         // current inputs (physics)
+  double                                  m_max_latency;
+
+  ChPosePublisher*                        m_publisher;   // optional network stream
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,347 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Drive files of test rigs.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/driver/ChRigDriveFile.h"
+
+namespace chrono {
+
+static const char DRIVE_MAGIC[8] = {'C', 'H', 'R', 'I', 'G', '1', 0, 0};
+static const size_t DRIVE_HEADER_SIZE = 24;
+
+// Number of records tried after the cursor before resorting to binary search.
+static const size_t DRIVE_CURSOR_STEPS = 8;
+
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRigDriveFile::ChRigDriveFile()
+: m_offset(0),
+  m_records(0),
+  m_num_records(0),
+  m_num_channels(0),
+  m_stride(1),
+  m_cursor(1),
+  m_window(65536),
+  m_window_index(0),
+  m_released(0)
+{
+}
+
+void ChRigDriveFile::SetWindow(size_t num_records)
+{
+  m_window = std::max(num_records, (size_t)2);
+  m_window_index = m_cursor / m_window;
+  m_released = 0;
+}
+
+bool ChRigDriveFile::set_records(const double* records, size_t num_records, int num_channels)
+{
+  m_records = records;
+  m_num_records = num_records;
+  m_num_channels = num_channels;
+  m_stride = num_channels + 1;
+  m_cursor = 1;
+  m_window_index = 0;
+  m_released = 0;
+
+  for (size_t i = 1; i < num_records; i++) {
+    if (records[i * m_stride] < records[(i - 1) * m_stride])
+      return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Text drive files are read in one piece and parsed in place with strtod.
+// Parsing stops at the first record with fewer values than the first one.
+// -----------------------------------------------------------------------------
+bool ChRigDriveFile::Load(const std::string& filename)
+{
+  m_file.Close();
+  m_data.clear();
+  set_records(0, 0, 0);
+
+  // Binary drive files are mapped in memory.
+  if (m_file.Open(filename) && m_file.GetSize() >= DRIVE_HEADER_SIZE &&
+      memcmp(m_file.GetData(), DRIVE_MAGIC, sizeof(DRIVE_MAGIC)) == 0) {
+    uint32 num_channels;
+    uint64 num_records;
+    memcpy(&num_channels, m_file.GetData() + sizeof(DRIVE_MAGIC), sizeof(uint32));
+    memcpy(&num_records, m_file.GetData() + 16, sizeof(uint64));
+
+    m_offset = DRIVE_HEADER_SIZE;
+    if (m_file.GetSize() < m_offset + num_records * (num_channels + 1) * sizeof(double)) {
+      GetLog() << "ERROR: truncated drive file " << filename.c_str() << "\n";
+      m_file.Close();
+      return false;
+    }
+
+    // The sort check reads the whole file once; the pages are then released.
+    const double* records = reinterpret_cast<const double*>(m_file.GetData() + m_offset);
+    bool sorted = set_records(records, (size_t)num_records, (int)num_channels);
+    m_file.ReleasePages(0, m_file.GetSize());
+    if (!sorted) {
+      GetLog() << "ERROR: unsorted record times in drive file " << filename.c_str() << "\n";
+      m_file.Close();
+      set_records(0, 0, 0);
+      return false;
+    }
+
+    m_file.PrefetchPages(m_offset, 2 * m_window * m_stride * sizeof(double));
+    return true;
+  }
+
+  m_file.Close();
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open drive file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  std::vector<char> buf;
+  char chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    buf.insert(buf.end(), chunk, chunk + n);
+  fclose(fp);
+  buf.push_back(0);
+
+  char* p = &buf[0];
+  char* end = p + buf.size() - 1;
+  int num_values = -1;
+
+  while (p < end) {
+    char* eol = (char*)memchr(p, '\n', end - p);
+    if (eol)
+      *eol = 0;
+
+    char* q = p;
+    while (*q == ' ' || *q == '\t' || *q == '\r')
+      q++;
+
+    if (*q != '#' && *q != 0) {
+      int count = 0;
+      size_t start = m_data.size();
+      while (num_values < 0 || count < num_values) {
+        char* next;
+        double val = strtod(q, &next);
+        if (next == q)
+          break;
+        m_data.push_back(val);
+        count++;
+        q = next;
+      }
+
+      if (num_values < 0)
+        num_values = count;
+      if (count == 0 || count < num_values) {
+        m_data.resize(start);
+        break;
+      }
+    }
+
+    if (!eol)
+      break;
+    p = eol + 1;
+  }
+
+  if (num_values < 1) {
+    GetLog() << "ERROR: no records in drive file " << filename.c_str() << "\n";
+    m_data.clear();
+    return false;
+  }
+
+  if (!set_records(m_data.empty() ? 0 : &m_data[0], m_data.size() / num_values, num_values - 1)) {
+    GetLog() << "ERROR: unsorted record times in drive file " << filename.c_str() << "\n";
+    m_data.clear();
+    set_records(0, 0, 0);
+    return false;
+  }
+
+  return true;
+}
+
+bool ChRigDriveFile::WriteBinary(const std::string&         filename,
+                                 int                        num_channels,
+                                 const std::vector<double>& records)
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  uint32 header[2] = {(uint32)num_channels, 0};
+  uint64 num_records = records.size() / (num_channels + 1);
+
+  bool ok = fwrite(DRIVE_MAGIC, 1, sizeof(DRIVE_MAGIC), fp) == sizeof(DRIVE_MAGIC) &&
+            fwrite(header, sizeof(uint32), 2, fp) == 2 &&
+            fwrite(&num_records, sizeof(uint64), 1, fp) == 1;
+  size_t num_values = (size_t)num_records * (num_channels + 1);
+  if (ok && num_values > 0)
+    ok = fwrite(&records[0], sizeof(double), num_values, fp) == num_values;
+
+  if (fclose(fp) != 0)
+    ok = false;
+
+  if (!ok)
+    GetLog() << "ERROR: cannot write " << filename.c_str() << "\n";
+
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+size_t ChRigDriveFile::locate(double time) const
+{
+  const double* t = m_records;
+  size_t s = m_stride;
+  size_t n = m_num_records;
+
+  // Start from the record found by the last query. Since time is before the
+  // last record time, the cursor cannot move past the last record.
+  size_t right = m_cursor;
+  size_t lo = 1;
+
+  if (right < n && t[(right - 1) * s] < time) {
+    for (size_t steps = 0; steps < DRIVE_CURSOR_STEPS && t[right * s] < time; steps++)
+      right++;
+    lo = right;
+  }
+
+  if (lo == 1 || t[lo * s] < time) {
+    size_t hi = n - 1;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (t[mid * s] < time)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    right = lo;
+  }
+
+  m_cursor = right;
+  if (m_file.IsOpen())
+    page(right);
+
+  return right;
+}
+
+// The previous window stays resident, since the interpolation of the first
+// records of a window also reads the last record of the previous one.
+void ChRigDriveFile::page(size_t record) const
+{
+  size_t window = record / m_window;
+  if (window == m_window_index)
+    return;
+
+  size_t bytes = m_stride * sizeof(double);
+  size_t keep = (window > 0 ? window - 1 : 0) * m_window;
+
+  if (window > m_window_index) {
+    if (keep > m_released) {
+      m_file.ReleasePages(m_offset + m_released * bytes, (keep - m_released) * bytes);
+      m_released = keep;
+    }
+  } else {
+    m_released = std::min(m_released, keep);
+  }
+
+  m_window_index = window;
+
+  size_t next = (window + 1) * m_window;
+  if (next < m_num_records)
+    m_file.PrefetchPages(m_offset + next * bytes, std::min(m_window, m_num_records - next) * bytes);
+}
+
+double ChRigDriveFile::GetValue(int channel, double time) const
+{
+  size_t n = m_num_records;
+  if (n == 0)
+    return 0;
+
+  const double* first = m_records;
+  const double* last = m_records + (n - 1) * m_stride;
+  if (time <= first[0])
+    return first[1 + channel];
+  if (time >= last[0])
+    return last[1 + channel];
+
+  size_t right = locate(time);
+  const double* l = m_records + (right - 1) * m_stride;
+  const double* r = l + m_stride;
+
+  double tbar = (time - l[0]) / (r[0] - l[0]);
+  return l[1 + channel] + tbar * (r[1 + channel] - l[1 + channel]);
+}
+
+double ChRigDriveFile::GetRate(int channel, double time) const
+{
+  size_t n = m_num_records;
+  if (n < 2 || time <= m_records[0] || time >= m_records[(n - 1) * m_stride])
+    return 0;
+
+  size_t right = locate(time);
+  const double* l = m_records + (right - 1) * m_stride;
+  const double* r = l + m_stride;
+
+  return (r[1 + channel] - l[1 + channel]) / (r[0] - l[0]);
+}
+
+void ChRigDriveFile::GetValues(double time, double* values) const
+{
+  size_t n = m_num_records;
+  if (n == 0) {
+    for (int k = 0; k < m_num_channels; k++)
+      values[k] = 0;
+    return;
+  }
+
+  const double* first = m_records;
+  const double* last = m_records + (n - 1) * m_stride;
+  if (time <= first[0] || time >= last[0]) {
+    const double* rec = (time <= first[0]) ? first : last;
+    for (int k = 0; k < m_num_channels; k++)
+      values[k] = rec[1 + k];
+    return;
+  }
+
+  size_t right = locate(time);
+  const double* l = m_records + (right - 1) * m_stride;
+  const double* r = l + m_stride;
+
+  double tbar = (time - l[0]) / (r[0] - l[0]);
+  for (int k = 0; k < m_num_channels; k++)
+    values[k] = l[1 + k] + tbar * (r[1 + k] - l[1 + k]);
+}
+
+
+}  // end namespace chrono
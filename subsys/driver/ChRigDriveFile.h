@@ -0,0 +1,179 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Drive files of test rigs: time series of post displacements and steering
+// inputs, e.g. measured road displacements replayed on a shaker rig.
+//
+// A drive file is either a text file with one record per line (lines starting
+// with '#' are skipped; the number of channels is set by the first record):
+//   time value_1 ... value_n
+// or a binary file (see ChRigDriveFile::WriteBinary), which is memory-mapped:
+//   magic "CHRIG1\0\0"    (8 bytes)
+//   number of channels   (uint32)
+//   reserved             (uint32)
+//   number of records    (uint64)
+//   records, each one holding the time and the channel values (double)
+// All integers and doubles are stored in the native byte order. The record
+// times must be non-decreasing.
+//
+// The channels are interpolated linearly in time. Each query starts from the
+// record found by the last one, so that a replay (with non-decreasing query
+// times) finds its records in constant time; other queries fall back to a
+// binary search. A mapped file is paged in windows of records: when the
+// replay enters a window, the next window is prefetched and the records
+// before the previous window are released, so that replaying a drive file of
+// several hours keeps a bounded resident set and, once the disk keeps up with
+// the prefetch, neither reads the file nor allocates memory during the steps.
+// A drive file must therefore not be queried concurrently.
+//
+// =============================================================================
+
+#ifndef CH_RIG_DRIVE_FILE_H
+#define CH_RIG_DRIVE_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+#include "motion_functions/ChFunction.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMappedFile.h"
+
+namespace chrono {
+
+///
+/// Read-only time series of test rig inputs, with a monotone cursor.
+///
+class CH_SUBSYS_API ChRigDriveFile : public ChShared
+{
+public:
+
+  ChRigDriveFile();
+  ~ChRigDriveFile() {}
+
+  /// Load the specified text or binary drive file.
+  /// Returns false if the file cannot be read or its times are not sorted.
+  bool Load(const std::string& filename);
+
+  /// Write the specified records (the time followed by the channel values, for
+  /// each record) to a binary drive file.
+  /// Returns false if the file cannot be written.
+  static bool WriteBinary(
+    const std::string&          filename,       ///< [in] name of the output file
+    int                         num_channels,   ///< [in] number of channels
+    const std::vector<double>&  records         ///< [in] records, (1 + num_channels) values each
+    );
+
+  /// Get the number of channels.
+  int GetNumChannels() const { return m_num_channels; }
+
+  /// Get the number of records.
+  size_t GetNumRecords() const { return m_num_records; }
+
+  /// Get the times of the first and last records.
+  double GetStartTime() const { return m_num_records ? m_records[0] : 0; }
+  double GetEndTime() const { return m_num_records ? m_records[(m_num_records - 1) * m_stride] : 0; }
+
+  /// Return true if the records are mapped from a binary drive file.
+  bool IsMapped() const { return m_file.IsOpen(); }
+
+  /// Set the number of records of a paging window of a mapped file (default:
+  /// 65536).
+  void SetWindow(size_t num_records);
+
+  /// Get the value of the specified channel at the specified time. The values
+  /// are constant before the first and after the last record.
+  double GetValue(int channel, double time) const;
+
+  /// Get the time derivative of the specified channel at the specified time.
+  double GetRate(int channel, double time) const;
+
+  /// Get the values of all channels at the specified time.
+  void GetValues(double time, double* values) const;
+
+private:
+
+  ChRigDriveFile(const ChRigDriveFile&);
+  ChRigDriveFile& operator=(const ChRigDriveFile&);
+
+  // Find the record 'right' with time(right-1) < time <= time(right), for a
+  // time strictly within the records, and page the mapped file.
+  size_t locate(double time) const;
+
+  // Prefetch and release the windows around the specified record.
+  void page(size_t record) const;
+
+  // Set the records, and check that the times are sorted.
+  bool set_records(const double* records, size_t num_records, int num_channels);
+
+  std::vector<double>     m_data;          // records read from a text file
+  vehicle::ChMappedFile   m_file;          // mapped binary drive file
+  size_t                  m_offset;        // offset of the records in the mapped file
+  const double*           m_records;
+  size_t                  m_num_records;
+  int                     m_num_channels;
+  size_t                  m_stride;        // values per record
+
+  mutable size_t          m_cursor;        // record found by the last query
+  size_t                  m_window;        // records per paging window
+  mutable size_t          m_window_index;  // window of the cursor
+  mutable size_t          m_released;      // records released before this one
+};
+
+///
+/// Function of time given by a channel of a drive file, e.g. the displacement
+/// function of a post actuator. The function shares the drive file.
+///
+class CH_SUBSYS_API ChFunction_DriveChannel : public ChFunction
+{
+public:
+
+  ChFunction_DriveChannel(
+    ChSharedPtr<ChRigDriveFile>  file,     ///< [in] drive file
+    int                          channel,  ///< [in] channel of the drive file
+    double                       scale = 1 ///< [in] scaling of the channel values
+    )
+  : m_file(file), m_channel(channel), m_scale(scale) {}
+
+  ~ChFunction_DriveChannel() {}
+
+  virtual ChFunction* new_Duplicate() { return new ChFunction_DriveChannel(*this); }
+
+  virtual double Get_y(double x) { return m_scale * m_file->GetValue(m_channel, x); }
+  virtual double Get_y_dx(double x) { return m_scale * m_file->GetRate(m_channel, x); }
+  virtual double Get_y_dxdx(double x) { return 0; }
+
+  virtual void Estimate_x_range(double& xmin, double& xmax)
+  {
+    xmin = m_file->GetStartTime();
+    xmax = m_file->GetEndTime();
+  }
+
+  /// Get the channel of the drive file.
+  int GetChannel() const { return m_channel; }
+
+private:
+
+  ChSharedPtr<ChRigDriveFile>  m_file;
+  int                          m_channel;
+  double                       m_scale;
+};
+
+
+} // end namespace chrono
+
+
+#endif
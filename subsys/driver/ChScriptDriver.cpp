@@ -0,0 +1,182 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model running a scenario script.
+//
+// =============================================================================
+
+#include "subsys/driver/ChScriptDriver.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChScenarioScript::Resume(ChScriptDriver& driver, double time)
+{
+  if (IsDone())
+    return;
+
+  m_time = time;
+  Run(driver);
+}
+
+void ChScenarioScript::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(2);
+  state.Write((double)m_resume);
+  state.Write(m_wait_end);
+}
+
+bool ChScenarioScript::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(2, "scenario script"))
+    return false;
+
+  m_resume = (int)state.Read();
+  m_wait_end = state.Read();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChScriptDriver::ChScriptDriver(const ChVehicle&               vehicle,
+                               const ChPowertrain&            powertrain,
+                               ChSharedPtr<ChScenarioScript>  script)
+: m_vehicle(vehicle),
+  m_script(script),
+  m_speed_control(vehicle, powertrain, 0),
+  m_hold_speed(false),
+  m_maneuver(-1),
+  m_maneuver_start(0),
+  m_cursor(0),
+  m_time(0)
+{
+}
+
+int ChScriptDriver::AddManeuver(ChSharedPtr<ChManeuver> maneuver)
+{
+  m_maneuvers.push_back(maneuver);
+  return (int)m_maneuvers.size() - 1;
+}
+
+double ChScriptDriver::GetSpeed() const
+{
+  ChVector<> xaxis = m_vehicle.GetChassisRot().GetXaxis();
+  return m_vehicle.GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt() ^ xaxis;
+}
+
+// -----------------------------------------------------------------------------
+// Actions of the script
+// -----------------------------------------------------------------------------
+void ChScriptDriver::SetSteeringInput(double steering)
+{
+  m_maneuver = -1;
+  SetSteering(steering);
+}
+
+void ChScriptDriver::SetPedals(double throttle, double braking)
+{
+  m_hold_speed = false;
+  SetThrottle(throttle);
+  SetBraking(braking);
+}
+
+void ChScriptDriver::HoldSpeed(double speed)
+{
+  m_hold_speed = true;
+  m_speed_control.SetTargetSpeed(speed);
+}
+
+void ChScriptDriver::PlayManeuver(int maneuver)
+{
+  if (maneuver < 0 || maneuver >= (int)m_maneuvers.size())
+    return;
+
+  m_maneuver = maneuver;
+  m_maneuver_start = m_time;
+  m_cursor = 0;
+}
+
+bool ChScriptDriver::IsManeuverActive() const
+{
+  return m_maneuver >= 0 && m_time - m_maneuver_start < m_maneuvers[m_maneuver]->GetEndTime();
+}
+
+// -----------------------------------------------------------------------------
+// The script runs first, so that the input sources it selects apply at once.
+// -----------------------------------------------------------------------------
+void ChScriptDriver::Update(double time)
+{
+  m_time = time;
+  m_script->Resume(*this, time);
+
+  if (m_maneuver >= 0)
+    SetSteering(m_maneuvers[m_maneuver]->Evaluate(ChManeuver::STEERING, time - m_maneuver_start, m_cursor));
+
+  if (m_hold_speed) {
+    m_speed_control.Update(time);
+    SetThrottle(m_speed_control.GetThrottle());
+    SetBraking(m_speed_control.GetBraking());
+  }
+}
+
+void ChScriptDriver::Advance(double step)
+{
+  if (m_hold_speed)
+    m_speed_control.Advance(step);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChScriptDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChDriver::SaveState(state);
+
+  state.BeginBlock(6);
+  state.Write(m_time);
+  state.Write(m_hold_speed ? 1.0 : 0.0);
+  state.Write(m_speed_control.GetTargetSpeed());
+  state.Write((double)m_maneuver);
+  state.Write(m_maneuver_start);
+  state.Write((double)m_cursor);
+
+  m_speed_control.SaveState(state);
+  m_script->SaveState(state);
+}
+
+bool ChScriptDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChDriver::RestoreState(state))
+    return false;
+
+  if (!state.OpenBlock(6, "script driver"))
+    return false;
+
+  m_time = state.Read();
+  m_hold_speed = state.Read() != 0;
+  m_speed_control.SetTargetSpeed(state.Read());
+  m_maneuver = (int)state.Read();
+  m_maneuver_start = state.Read();
+  m_cursor = (int)state.Read();
+
+  if (m_maneuver >= (int)m_maneuvers.size())
+    m_maneuver = -1;
+
+  return m_speed_control.RestoreState(state) && m_script->RestoreState(state);
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,227 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model running a scenario script: the logic of a test ("accelerate
+// to 20 m/s, wait until the speed is steady, change lanes, brake once past
+// x = 300 m") written as straight-line code waiting on conditions, instead of
+// time switches in a driver or in the main loop.
+//
+// A script (ChScenarioScript) is a stackless coroutine. Its body, Run(), is
+// written between CH_SCRIPT_BEGIN and CH_SCRIPT_END and suspends at each
+// CH_SCRIPT_UNTIL(condition) or CH_SCRIPT_DELAY(duration). The driver resumes
+// it once per step, from its Update(), at the wait where it last suspended: a
+// switch on the line number of that wait (as in Duff's device) jumps back
+// into the body, which returns again until the condition holds. For example:
+//
+//   class LaneChangeScript : public ChScenarioScript
+//   {
+//   public:
+//     LaneChangeScript(int lane_change) : m_lane_change(lane_change) {}
+//
+//   private:
+//     virtual void Run(ChScriptDriver& driver)
+//     {
+//       CH_SCRIPT_BEGIN;
+//       driver.HoldSpeed(20);
+//       CH_SCRIPT_UNTIL(std::abs(driver.GetSpeed() - 20) < 0.2);
+//       CH_SCRIPT_DELAY(2);
+//       driver.PlayManeuver(m_lane_change);
+//       CH_SCRIPT_UNTIL(driver.GetPos().x > 300);
+//       driver.SetPedals(0, 0.8);
+//       CH_SCRIPT_END;
+//     }
+//
+//     int m_lane_change;   // index of the maneuver in the driver
+//   };
+//
+// A suspended script costs its resume point, the end time of a delay and its
+// own members: there is no stack to keep and no thread to switch to, so that
+// each vehicle of a fleet can run its own script. Since the body is re-entered
+// at each step, its local variables do not survive a wait (use members), a
+// source line holds at most one wait, and waits cannot appear inside a switch
+// statement of the body.
+//
+// The driver provides the script with the vehicle state and with the actions
+// that set its inputs: fixed values, a target speed held by a speed control
+// driver (see ChSpeedControlDriver) or the steering of an open-loop maneuver
+// (see ChManeuver), added to the driver before the simulation and referred to
+// by index, so that the driver state (and the script resume point) can be
+// saved in a snapshot.
+//
+// =============================================================================
+
+#ifndef CH_SCRIPT_DRIVER_H
+#define CH_SCRIPT_DRIVER_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/driver/ChManeuver.h"
+#include "subsys/driver/ChSpeedControlDriver.h"
+
+/// Start the body of ChScenarioScript::Run().
+#define CH_SCRIPT_BEGIN \
+  switch (m_resume) { case 0:
+
+/// Suspend the script until the specified condition holds (evaluated at once,
+/// then at each resume).
+#define CH_SCRIPT_UNTIL(condition) \
+  do { m_resume = __LINE__; case __LINE__: if (!(condition)) return; } while (0)
+
+/// Suspend the script for the specified duration.
+#define CH_SCRIPT_DELAY(duration) \
+  do { m_wait_end = GetTime() + (duration); CH_SCRIPT_UNTIL(GetTime() >= m_wait_end - 1e-9); } while (0)
+
+/// End the body of ChScenarioScript::Run(); the script is then done.
+#define CH_SCRIPT_END \
+  default: ; } m_resume = -1
+
+namespace chrono {
+
+class ChScriptDriver;
+
+///
+/// Scenario script, resumed once per step by a ChScriptDriver.
+///
+class CH_SUBSYS_API ChScenarioScript : public ChShared
+{
+public:
+
+  ChScenarioScript() : m_resume(0), m_wait_end(0), m_time(0) {}
+
+  virtual ~ChScenarioScript() {}
+
+  /// Return true once the script has reached CH_SCRIPT_END.
+  bool IsDone() const { return m_resume < 0; }
+
+  /// Get the time of the current resume.
+  double GetTime() const { return m_time; }
+
+  /// Resume the script at the specified time (nothing if it is done).
+  void Resume(ChScriptDriver& driver, double time);
+
+  /// Append the resume point and the end of the current delay to the specified
+  /// snapshot. A script with members that change as it runs must extend this.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the resume point and the end of the current delay.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+protected:
+
+  /// Body of the script, between CH_SCRIPT_BEGIN and CH_SCRIPT_END.
+  virtual void Run(ChScriptDriver& driver) = 0;
+
+  int     m_resume;     ///< line of the wait to resume at (0: start, -1: done)
+  double  m_wait_end;   ///< end time of the current delay
+
+private:
+
+  ChScenarioScript(const ChScenarioScript&);
+  ChScenarioScript& operator=(const ChScenarioScript&);
+
+  double  m_time;
+};
+
+///
+/// Driver running a scenario script.
+///
+class CH_SUBSYS_API ChScriptDriver : public ChDriver
+{
+public:
+
+  ChScriptDriver(
+    const ChVehicle&                   vehicle,      ///< [in] controlled vehicle
+    const ChPowertrain&                powertrain,   ///< [in] powertrain of the vehicle (speed control)
+    ChSharedPtr<ChScenarioScript>      script        ///< [in] script run by this driver
+    );
+
+  ~ChScriptDriver() {}
+
+  /// Get the script run by this driver.
+  ChSharedPtr<ChScenarioScript> GetScript() const { return m_script; }
+
+  /// Add a maneuver that the script can play, and return its index.
+  int AddManeuver(ChSharedPtr<ChManeuver> maneuver);
+
+  /// Get the speed control driver used by HoldSpeed() (e.g. to tune it).
+  ChSpeedControlDriver& GetSpeedControl() { return m_speed_control; }
+
+  /// Get the controlled vehicle.
+  const ChVehicle& GetVehicle() const { return m_vehicle; }
+
+  /// Get the time of the current update.
+  double GetTime() const { return m_time; }
+
+  /// Get the forward speed of the vehicle.
+  double GetSpeed() const;
+
+  /// Get the position of the chassis reference frame.
+  const ChVector<>& GetPos() const { return m_vehicle.GetChassisPos(); }
+
+  /// Set a fixed steering input (stops a maneuver).
+  void SetSteeringInput(double steering);
+
+  /// Set fixed throttle and braking inputs (stops the speed control).
+  void SetPedals(double throttle, double braking);
+
+  /// Set the throttle and braking inputs to hold the specified forward speed.
+  void HoldSpeed(double speed);
+
+  /// Set the steering input from the specified maneuver, played from the
+  /// current time (the steering is held at the end of the maneuver).
+  void PlayManeuver(int maneuver);
+
+  /// Return true if a maneuver is played and has not reached its end.
+  bool IsManeuverActive() const;
+
+  /// Resume the script, then compute the inputs it selected.
+  virtual void Update(double time);
+
+  /// Advance the speed control (if active).
+  virtual void Advance(double step);
+
+  /// Append the driver inputs, the input sources and the script state to the
+  /// specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs, the input sources and the script state.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+private:
+
+  const ChVehicle&                       m_vehicle;
+  ChSharedPtr<ChScenarioScript>          m_script;
+  std::vector<ChSharedPtr<ChManeuver> >  m_maneuvers;
+
+  ChSpeedControlDriver  m_speed_control;
+  bool                  m_hold_speed;
+
+  int                   m_maneuver;         // played maneuver (-1: none)
+  double                m_maneuver_start;   // start time of the played maneuver
+  int                   m_cursor;           // cursor in its steering table
+
+  double                m_time;
+};
+
+
+} // end namespace chrono
+
+
+#endif
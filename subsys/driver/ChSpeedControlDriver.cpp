@@ -0,0 +1,128 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A closed-loop driver model holding a target forward speed.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/driver/ChSpeedControlDriver.h"
+
+namespace chrono {
+
+// Speed above which the driveline ratio is measured.
+static const double MIN_RATIO_SPEED = 1;
+
+// Gravitational acceleration, for the default road load and braking force.
+static const double GRAVITY = 9.81;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSpeedControlDriver::ChSpeedControlDriver(const ChVehicle&    vehicle,
+                                           const ChPowertrain& powertrain,
+                                           double              target_speed)
+: m_vehicle(vehicle),
+  m_powertrain(powertrain),
+  m_target_speed(target_speed),
+  m_tau(2),
+  m_max_accel(2),
+  m_max_decel(4),
+  m_mass(0),
+  m_f0(-1),
+  m_f2(0.4),
+  m_max_brake_force(0),
+  m_Kp(0.1),
+  m_Ki(0.05),
+  m_ratio(0),
+  m_force(0),
+  m_speed_err(0),
+  m_speed_err_int(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSpeedControlDriver::Update(double time)
+{
+  ChVector<> xaxis = m_vehicle.GetChassisRot().GetXaxis();
+  double speed = m_vehicle.GetChassisBody()->GetFrame_REF_to_abs().GetPos_dt() ^ xaxis;
+  double shaft_speed = m_vehicle.GetDriveshaftSpeed();
+
+  if (speed > MIN_RATIO_SPEED && shaft_speed > 0)
+    m_ratio = shaft_speed / speed;
+
+  // Requested driving force.
+  double mass = (m_mass > 0) ? m_mass : m_vehicle.GetChassisBody()->GetMass();
+  double f0 = (m_f0 >= 0) ? m_f0 : 0.015 * mass * GRAVITY;
+  double max_brake_force = (m_max_brake_force > 0) ? m_max_brake_force : 0.8 * mass * GRAVITY;
+
+  m_speed_err = m_target_speed - speed;
+  double accel = std::min(std::max(m_speed_err / m_tau, -m_max_decel), m_max_accel);
+  double sign = (speed > 0) ? 1 : (speed < 0) ? -1 : 0;
+  m_force = mass * accel + sign * f0 + m_f2 * speed * std::abs(speed);
+
+  // Feed-forward command (throttle minus braking).
+  double throttle = 0;
+  double residual = m_force;
+  double ff = 0;
+  if (m_ratio > 0 && m_powertrain.GetThrottleForTorque(m_force / m_ratio, shaft_speed, throttle, residual))
+    ff = throttle + std::min(residual * m_ratio, 0.0) / max_brake_force;
+  else
+    ff = std::min(m_force, 0.0) / max_brake_force;
+
+  double out = ff + m_Kp * m_speed_err + m_Ki * m_speed_err_int;
+
+  m_throttle = std::min(std::max(out, 0.0), 1.0);
+  m_braking = std::min(std::max(-out, 0.0), 1.0);
+}
+
+// The integral is bounded so that the correction does not exceed a full input.
+void ChSpeedControlDriver::Advance(double step)
+{
+  double max_int = (m_Ki > 0) ? 1 / m_Ki : 0;
+  m_speed_err_int = std::max(-max_int, std::min(m_speed_err_int + m_speed_err * step, max_int));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSpeedControlDriver::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChDriver::SaveState(state);
+
+  state.BeginBlock(3);
+  state.Write(m_speed_err);
+  state.Write(m_speed_err_int);
+  state.Write(m_ratio);
+}
+
+bool ChSpeedControlDriver::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChDriver::RestoreState(state))
+    return false;
+
+  if (!state.OpenBlock(3, "speed control driver"))
+    return false;
+
+  m_speed_err = state.Read();
+  m_speed_err_int = state.Read();
+  m_ratio = state.Read();
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,145 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A closed-loop driver model holding a target forward speed, with a feed-
+// forward of the throttle and braking inputs computed from the powertrain maps.
+//
+// The controller first asks for the acceleration that closes the speed error
+// over a response time tau, limited to the maximum acceleration and
+// deceleration:
+//   a = clamp((v_target - v) / tau, -a_dec, a_acc)
+// and for the driving force that produces it against the road load:
+//   F = m a + f0 + f2 v |v|
+// The driving force is converted to a driveshaft torque T = F / G, with the
+// driveline ratio G (driveshaft angle per distance traveled) measured on line
+// as omega_ds / v while the vehicle moves, and the throttle delivering T in
+// steady state is obtained from the powertrain (see
+// ChPowertrain::GetThrottleForTorque()). If T is below the torque delivered at
+// zero throttle, the difference is supplied by the brakes, in proportion to
+// the maximum braking force. A PI correction on the speed error is added to
+// the combined feed-forward command (throttle minus braking), so that it only
+// absorbs the errors of the maps and of the road load.
+//
+// Since the feed-forward does not depend on the step size, the controller
+// holds the target speed without the limit cycles of a pure PID controller at
+// large steps. Without the powertrain inversion (or before the driveline ratio
+// is known), only the PI correction and the braking feed-forward are active.
+// The controller assumes forward driving.
+//
+// =============================================================================
+
+#ifndef CH_SPEED_CONTROL_DRIVER_H
+#define CH_SPEED_CONTROL_DRIVER_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChVehicle.h"
+
+namespace chrono {
+
+///
+/// Speed-holding driver with a powertrain map feed-forward and PI correction.
+///
+class CH_SUBSYS_API ChSpeedControlDriver : public ChDriver
+{
+public:
+
+  ChSpeedControlDriver(
+    const ChVehicle&     vehicle,        ///< [in] controlled vehicle
+    const ChPowertrain&  powertrain,     ///< [in] powertrain of the vehicle
+    double               target_speed    ///< [in] target forward speed
+    );
+
+  ~ChSpeedControlDriver() {}
+
+  /// Set the target forward speed.
+  void SetTargetSpeed(double speed) { m_target_speed = speed; }
+
+  /// Get the target forward speed.
+  double GetTargetSpeed() const { return m_target_speed; }
+
+  /// Set the constant steering input (default: 0).
+  void SetSteeringInput(double steering) { SetSteering(steering); }
+
+  /// Set the response time of the speed controller (default: 2 s).
+  void SetResponseTime(double tau) { m_tau = tau; }
+
+  /// Set the maximum acceleration and deceleration requested by the
+  /// controller (default: 2 and 4 m/s^2).
+  void SetAccelerationLimits(double max_accel, double max_decel) { m_max_accel = max_accel; m_max_decel = max_decel; }
+
+  /// Set the vehicle mass used in the feed-forward (default: the chassis mass).
+  void SetVehicleMass(double mass) { m_mass = mass; }
+
+  /// Set the road load, F = f0 + f2 v |v| (default: 1.5% of the vehicle
+  /// weight and 0.4 N s^2/m^2).
+  void SetRoadLoad(double f0, double f2) { m_f0 = f0; m_f2 = f2; }
+
+  /// Set the total braking force at a braking input of 1 (default: 80% of the
+  /// vehicle weight).
+  void SetMaxBrakeForce(double force) { m_max_brake_force = force; }
+
+  /// Set the driveline ratio, i.e. the driveshaft angle per distance traveled,
+  /// used until it is measured (default: unknown).
+  void SetDrivelineRatio(double ratio) { m_ratio = ratio; }
+
+  /// Set the gains of the PI correction (default: 0.1 and 0.05).
+  void SetGains(double Kp, double Ki) { m_Kp = Kp; m_Ki = Ki; }
+
+  /// Get the driving force requested at the last update.
+  double GetDrivingForce() const { return m_force; }
+
+  /// Get the driveline ratio at the last update (0 if unknown).
+  double GetDrivelineRatio() const { return m_ratio; }
+
+  /// Compute the driver inputs from the current vehicle state.
+  virtual void Update(double time);
+
+  /// Integrate the speed error over the specified step.
+  virtual void Advance(double step);
+
+  /// Append the driver inputs and the controller states to the specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the driver inputs and the controller states from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+private:
+
+  const ChVehicle&     m_vehicle;
+  const ChPowertrain&  m_powertrain;
+
+  double  m_target_speed;
+  double  m_tau;
+  double  m_max_accel;
+  double  m_max_decel;
+  double  m_mass;                // vehicle mass (<= 0: chassis mass)
+  double  m_f0;                  // constant road load (< 0: default)
+  double  m_f2;
+  double  m_max_brake_force;     // (<= 0: default)
+  double  m_Kp;
+  double  m_Ki;
+
+  double  m_ratio;               // driveline ratio (0: unknown)
+  double  m_force;               // requested driving force
+  double  m_speed_err;           // speed error at the last update
+  double  m_speed_err_int;       // integral of the speed error
+};
+
+
+} // end namespace chrono
+
+
+#endif
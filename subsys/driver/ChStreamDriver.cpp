@@ -0,0 +1,134 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model fed with samples by an external producer thread.
+//
+// =============================================================================
+
+#include "subsys/driver/ChStreamDriver.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChStreamDriver::ChStreamDriver(int            capacity,
+                               UnderrunPolicy policy)
+: m_queue(capacity > 2 ? capacity : 2),
+  m_policy(policy),
+  m_horizon(0.1),
+  m_underrun_braking(1),
+  m_underrun(false),
+  m_num_underruns(0),
+  m_num_dropped(0)
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChStreamDriver::fetch(double time)
+{
+  ChDriverEntry sample;
+
+  while ((m_window.empty() || m_window.back().m_time < time) && m_queue.Pop(sample)) {
+    if (!m_window.empty() && !(sample.m_time > m_window.back().m_time)) {
+      m_num_dropped++;
+      continue;
+    }
+    m_window.push_back(sample);
+  }
+
+  // Keep the two samples preceding the current time (needed for
+  // extrapolation) and all following ones.
+  while (m_window.size() > 2 && m_window[2].m_time <= time)
+    m_window.pop_front();
+}
+
+void ChStreamDriver::Update(double time)
+{
+  fetch(time);
+
+  m_underrun = false;
+
+  // No samples received yet.
+  if (m_window.empty())
+    return;
+
+  const ChDriverEntry& last = m_window.back();
+
+  // Before the first sample.
+  if (time <= m_window.front().m_time) {
+    SetSteering(m_window.front().m_steering);
+    SetThrottle(m_window.front().m_throttle);
+    SetBraking(m_window.front().m_braking);
+    return;
+  }
+
+  // Interpolate between the bracketing samples.
+  if (time <= last.m_time) {
+    size_t right = 1;
+    while (m_window[right].m_time < time)
+      right++;
+
+    const ChDriverEntry& l = m_window[right - 1];
+    const ChDriverEntry& r = m_window[right];
+
+    double tbar = (time - l.m_time) / (r.m_time - l.m_time);
+
+    SetSteering(l.m_steering + tbar * (r.m_steering - l.m_steering));
+    SetThrottle(l.m_throttle + tbar * (r.m_throttle - l.m_throttle));
+    SetBraking(l.m_braking + tbar * (r.m_braking - l.m_braking));
+    return;
+  }
+
+  // Underrun: no sample at or after the current time.
+  m_underrun = true;
+  m_num_underruns++;
+
+  switch (m_policy) {
+  case HOLD_LAST:
+    SetSteering(last.m_steering);
+    SetThrottle(last.m_throttle);
+    SetBraking(last.m_braking);
+    break;
+
+  case EXTRAPOLATE:
+    if (m_window.size() >= 2) {
+      const ChDriverEntry& prev = m_window[m_window.size() - 2];
+      double dt = time - last.m_time;
+      if (dt > m_horizon)
+        dt = m_horizon;
+      double tbar = dt / (last.m_time - prev.m_time);
+
+      SetSteering(last.m_steering + tbar * (last.m_steering - prev.m_steering));
+      SetThrottle(last.m_throttle + tbar * (last.m_throttle - prev.m_throttle));
+      SetBraking(last.m_braking + tbar * (last.m_braking - prev.m_braking));
+    } else {
+      SetSteering(last.m_steering);
+      SetThrottle(last.m_throttle);
+      SetBraking(last.m_braking);
+    }
+    break;
+
+  case BRAKE:
+    SetSteering(last.m_steering);
+    SetThrottle(0);
+    SetBraking(m_underrun_braking);
+    break;
+  }
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,105 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A driver model fed with (time, steering, throttle, braking) samples by an
+// external producer (e.g. a network or shared-memory client thread), for
+// hardware-in-the-loop and co-simulation.
+//
+// The producer thread calls PushSample() with samples at increasing times; it
+// may run ahead of the simulation, in which case the samples wait in a
+// lock-free queue. Update() never blocks: it takes the samples it needs from
+// the queue, interpolates linearly between the samples bracketing the current
+// time and, if no sample at or after the current time has arrived yet
+// (underrun), applies the selected underrun policy.
+//
+// =============================================================================
+
+#ifndef CH_STREAMDRIVER_H
+#define CH_STREAMDRIVER_H
+
+#include <deque>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChSpscQueue.h"
+#include "subsys/driver/ChDriverTrace.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API ChStreamDriver : public ChDriver
+{
+public:
+
+  /// Driver inputs used when the samples lag behind the simulation.
+  enum UnderrunPolicy {
+    HOLD_LAST,    ///< keep the inputs of the last sample
+    EXTRAPOLATE,  ///< extrapolate linearly from the last two samples (up to a time horizon)
+    BRAKE         ///< release the throttle and apply the underrun braking input
+  };
+
+  /// Create a stream driver queuing up to the specified number of samples.
+  ChStreamDriver(int capacity = 1024, UnderrunPolicy policy = HOLD_LAST);
+
+  ~ChStreamDriver() {}
+
+  /// Set the underrun policy.
+  void SetUnderrunPolicy(UnderrunPolicy policy) { m_policy = policy; }
+
+  /// Set the longest time interval over which the EXTRAPOLATE policy
+  /// extrapolates (default 0.1 s). Beyond it, the inputs are held.
+  void SetExtrapolationHorizon(double horizon) { m_horizon = horizon; }
+
+  /// Set the braking input used by the BRAKE policy (default 1).
+  void SetUnderrunBraking(double braking) { m_underrun_braking = braking; }
+
+  /// Append a sample (producer thread only).
+  /// Returns false, and drops the sample, if the queue is full.
+  bool PushSample(const ChDriverEntry& sample) { return m_queue.Push(sample); }
+
+  /// Update the driver inputs at the specified time (simulation thread only).
+  virtual void Update(double time);
+
+  /// Return true if the last call to Update() was an underrun.
+  bool IsUnderrun() const { return m_underrun; }
+
+  /// Get the number of calls to Update() that were underruns.
+  int GetNumUnderruns() const { return m_num_underruns; }
+
+  /// Get the number of samples dropped because they were not received in
+  /// increasing time order.
+  int GetNumDropped() const { return m_num_dropped; }
+
+private:
+
+  // Move samples from the queue to the window until the window contains a
+  // sample at or after the specified time (or the queue is empty).
+  void fetch(double time);
+
+  vehicle::ChSpscQueue<ChDriverEntry>  m_queue;
+  std::deque<ChDriverEntry>            m_window;   // received samples around the current time
+
+  UnderrunPolicy  m_policy;
+  double          m_horizon;
+  double          m_underrun_braking;
+
+  bool            m_underrun;
+  int             m_num_underruns;
+  int             m_num_dropped;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,127 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Engine sound of a vehicle, played with IrrKlang on its own thread.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "core/ChLog.h"
+#include "core/ChMathematics.h"
+
+#include "subsys/driver/ChVehicleSound.h"
+
+#if IRRKLANG_ENABLED
+#include <irrKlang.h>
+#endif
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleSound::ChVehicleSound(const std::string& sound_file,
+                               double             rate)
+: m_sound_file(sound_file),
+  m_period(1 / rate),
+  m_ref_rpm(8000),
+  m_stop(0)
+{
+  State state;
+  state.motor_speed = 0;
+  state.throttle = 0;
+  m_mailbox.Reset(state);
+}
+
+ChVehicleSound::~ChVehicleSound()
+{
+  Stop();
+}
+
+bool ChVehicleSound::Start()
+{
+#if IRRKLANG_ENABLED
+  if (IsRunning())
+    return true;
+
+  vehicle::ChAtomicStore(&m_stop, 0);
+  return ChThread::Start();
+#else
+  return false;
+#endif
+}
+
+void ChVehicleSound::Stop()
+{
+  if (!IsRunning())
+    return;
+
+  vehicle::ChAtomicStore(&m_stop, 1);
+  Join();
+}
+
+void ChVehicleSound::Post(double motor_speed, double throttle)
+{
+  State& state = m_mailbox.GetWriteBuffer();
+  state.motor_speed = motor_speed;
+  state.throttle = throttle;
+  m_mailbox.Publish();
+}
+
+// -----------------------------------------------------------------------------
+// The sound engine is created, used and released on the audio thread only.
+// -----------------------------------------------------------------------------
+void ChVehicleSound::Run()
+{
+#if IRRKLANG_ENABLED
+  irrklang::ISoundEngine* engine = irrklang::createIrrKlangDevice();
+  if (!engine) {
+    GetLog() << "Cannot start sound engine Irrklang \n";
+    return;
+  }
+
+  irrklang::ISound* sound = engine->play2D(m_sound_file.c_str(), true, true, true);
+  if (!sound) {
+    GetLog() << "Cannot play sound file " << m_sound_file.c_str() << "\n";
+    engine->drop();
+    return;
+  }
+
+  while (!vehicle::ChAtomicLoad(&m_stop)) {
+    if (m_mailbox.Acquire()) {
+      const State& state = m_mailbox.GetReadBuffer();
+
+      double engine_rpm = state.motor_speed * 60 / CH_C_2PI;
+      double pitch = std::max(0.1, engine_rpm / m_ref_rpm);
+      double volume = 0.6 + 0.4 * std::max(0.0, std::min(1.0, state.throttle));
+
+      sound->setPlaybackSpeed((irrklang::ik_f32)pitch);
+      sound->setVolume((irrklang::ik_f32)volume);
+      if (sound->getIsPaused())
+        sound->setIsPaused(false);
+    }
+
+    vehicle::ChThread::Sleep(m_period);
+  }
+
+  sound->stop();
+  sound->drop();
+  engine->drop();
+#endif
+}
+
+
+}  // end namespace chrono
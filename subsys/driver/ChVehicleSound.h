@@ -0,0 +1,94 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Engine sound of a vehicle, played with IrrKlang on its own thread.
+//
+// The simulation (or GUI) thread posts the motor speed and the throttle input
+// into a lock-free mailbox (a triple buffer), at any rate; posting never
+// blocks. The audio thread owns the sound engine and samples the mailbox at a
+// fixed low rate, setting the playback speed from the engine RPM and the volume
+// from the throttle.
+//
+// Without IrrKlang support (ENABLE_IRRKLANG), Start() returns false and the
+// posted values are ignored.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_SOUND_H
+#define CH_VEHICLE_SOUND_H
+
+#include <string>
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChTripleBuffer.h"
+
+
+namespace chrono {
+
+///
+/// Engine sound player with a decoupled update rate.
+///
+class CH_SUBSYS_API ChVehicleSound : public vehicle::ChThread
+{
+public:
+
+  ChVehicleSound(
+    const std::string& sound_file,   ///< [in] looped engine sound
+    double             rate = 60     ///< [in] update rate of the sound parameters [Hz]
+    );
+
+  /// The destructor stops the audio thread.
+  ~ChVehicleSound();
+
+  /// Start the audio thread (the sound engine is created on that thread).
+  /// Returns false if sound is not supported or the thread cannot be created.
+  bool Start();
+
+  /// Stop the audio thread (and the sound).
+  void Stop();
+
+  /// Post the current motor speed [rad/s] and throttle input [0,1]. May be
+  /// called at any rate, from a single thread; never blocks.
+  void Post(double motor_speed, double throttle);
+
+  /// Set the engine speed [RPM] played at the recorded pitch (default: 8000).
+  void SetReferenceRPM(double val) { m_ref_rpm = val; }
+
+protected:
+
+  virtual void Run();
+
+private:
+
+  struct State {
+    double motor_speed;
+    double throttle;
+  };
+
+  std::string                      m_sound_file;
+  double                           m_period;
+  double                           m_ref_rpm;
+
+  vehicle::ChTripleBuffer<State>   m_mailbox;
+  volatile size_t                  m_stop;
+};
+
+
+} // end namespace chrono
+
+
+#endif
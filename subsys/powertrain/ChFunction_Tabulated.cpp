@@ -0,0 +1,136 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Function of one variable tabulated on a uniform grid.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "subsys/powertrain/ChFunction_Tabulated.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFunction_Tabulated::ChFunction_Tabulated(ChFunction&   source,
+                                           int           num_intervals,
+                                           Interpolation interpolation)
+: m_interpolation(interpolation),
+  m_num_intervals(std::max(num_intervals, 1)),
+  m_max_error(0)
+{
+  source.Estimate_x_range(m_xmin, m_xmax);
+
+  int n = m_num_intervals;
+
+  // A degenerate range is tabulated as a constant.
+  if (m_xmax > m_xmin) {
+    m_dx = (m_xmax - m_xmin) / n;
+    m_inv_dx = 1 / m_dx;
+  }
+  else {
+    m_xmax = m_xmin;
+    m_dx = 0;
+    m_inv_dx = 0;
+  }
+
+  m_y.resize(n + 1);
+  for (int i = 0; i <= n; i++)
+    m_y[i] = source.Get_y(m_xmin + i * m_dx);
+
+  // Fritsch-Carlson slopes: the interpolant is monotone on every cell where
+  // the samples are monotone, and flat at local extrema of the samples.
+  if (m_interpolation == MONOTONE_CUBIC) {
+    m_slope.resize(n + 1);
+    m_slope[0] = m_y[1] - m_y[0];
+    m_slope[n] = m_y[n] - m_y[n - 1];
+    for (int i = 1; i < n; i++) {
+      double d0 = m_y[i] - m_y[i - 1];
+      double d1 = m_y[i + 1] - m_y[i];
+      m_slope[i] = (d0 * d1 > 0) ? 0.5 * (d0 + d1) : 0;
+    }
+    for (int i = 0; i < n; i++) {
+      double d = m_y[i + 1] - m_y[i];
+      if (d == 0) {
+        m_slope[i] = 0;
+        m_slope[i + 1] = 0;
+        continue;
+      }
+      double a = m_slope[i] / d;
+      double b = m_slope[i + 1] / d;
+      double r = a * a + b * b;
+      if (r > 9) {
+        double tau = 3 / std::sqrt(r);
+        m_slope[i] = tau * a * d;
+        m_slope[i + 1] = tau * b * d;
+      }
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    double x = m_xmin + (i + 0.5) * m_dx;
+    m_max_error = std::max(m_max_error, std::abs(Get_y(x) - source.Get_y(x)));
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// The clamping of the abscissa (constant extrapolation) and of the cell index
+// (the upper end of the range belongs to the last cell) compile to
+// conditional moves.
+// -----------------------------------------------------------------------------
+int ChFunction_Tabulated::locate(double x, double& t) const
+{
+  double s = (x - m_xmin) * m_inv_dx;
+  s = std::min(std::max(s, 0.0), (double)m_num_intervals);
+  int i = std::min((int)s, m_num_intervals - 1);
+  t = s - i;
+  return i;
+}
+
+double ChFunction_Tabulated::Get_y(double x)
+{
+  double t;
+  int i = locate(x, t);
+
+  if (m_interpolation == LINEAR)
+    return m_y[i] + t * (m_y[i + 1] - m_y[i]);
+
+  double t2 = t * t;
+  double t3 = t2 * t;
+  return (2 * t3 - 3 * t2 + 1) * m_y[i] + (t3 - 2 * t2 + t) * m_slope[i] +
+         (-2 * t3 + 3 * t2) * m_y[i + 1] + (t3 - t2) * m_slope[i + 1];
+}
+
+double ChFunction_Tabulated::Get_y_dx(double x)
+{
+  if (x < m_xmin || x > m_xmax || m_inv_dx == 0)
+    return 0;
+
+  double t;
+  int i = locate(x, t);
+
+  if (m_interpolation == LINEAR)
+    return (m_y[i + 1] - m_y[i]) * m_inv_dx;
+
+  double t2 = t * t;
+  return ((6 * t2 - 6 * t) * (m_y[i] - m_y[i + 1]) + (3 * t2 - 4 * t + 1) * m_slope[i] +
+          (3 * t2 - 2 * t) * m_slope[i + 1]) * m_inv_dx;
+}
+
+
+} // end namespace chrono
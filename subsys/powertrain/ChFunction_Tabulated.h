@@ -0,0 +1,102 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Function of one variable tabulated on a uniform grid.
+//
+// The table is sampled from a source function (typically a ChFunction_Recorder
+// map) over the range of its definition points. Evaluation computes the cell
+// index directly from the abscissa, without searching, and interpolates
+// linearly or with a monotone (Fritsch-Carlson) cubic Hermite spline. As for
+// ChFunction_Recorder, the function is constant outside the tabulated range.
+//
+// The tabulated abscissae do not in general coincide with the definition
+// points of the source function, so the table is exact only for smooth parts
+// of the source; GetMaxError() returns the deviation measured at the cell
+// midpoints.
+//
+// =============================================================================
+
+#ifndef CH_FUNCTION_TABULATED_H
+#define CH_FUNCTION_TABULATED_H
+
+#include <vector>
+
+#include "motion_functions/ChFunction.h"
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Read-only function tabulated on a uniform grid. Since evaluation does not
+/// modify the table, one object can be shared by several shaft elements.
+///
+class CH_SUBSYS_API ChFunction_Tabulated : public ChFunction
+{
+public:
+
+  enum Interpolation {
+    LINEAR,          ///< linear interpolation
+    MONOTONE_CUBIC   ///< monotone cubic Hermite interpolation
+  };
+
+  /// Sample the source function at num_intervals+1 equidistant abscissae
+  /// over the range reported by its Estimate_x_range().
+  ChFunction_Tabulated(
+    ChFunction&    source,                 ///< [in] source function
+    int            num_intervals = 1000,   ///< [in] number of grid cells
+    Interpolation  interpolation = LINEAR  ///< [in] interpolation type
+    );
+
+  ~ChFunction_Tabulated() {}
+
+  virtual ChFunction* new_Duplicate() { return new ChFunction_Tabulated(*this); }
+
+  virtual double Get_y(double x);
+  virtual double Get_y_dx(double x);
+
+  virtual void Estimate_x_range(double& xmin, double& xmax) { xmin = m_xmin; xmax = m_xmax; }
+
+  /// Return the number of grid cells.
+  int GetNumIntervals() const { return m_num_intervals; }
+
+  /// Return the interpolation type.
+  Interpolation GetInterpolation() const { return m_interpolation; }
+
+  /// Return the maximum deviation from the source function at the cell
+  /// midpoints.
+  double GetMaxError() const { return m_max_error; }
+
+private:
+
+  // cell index and local coordinate in [0,1] for the specified abscissa
+  int locate(double x, double& t) const;
+
+  Interpolation        m_interpolation;
+  int                  m_num_intervals;
+  double               m_xmin;
+  double               m_xmax;
+  double               m_dx;
+  double               m_inv_dx;
+  double               m_max_error;
+
+  std::vector<double>  m_y;       // values at the grid points
+  std::vector<double>  m_slope;   // derivatives at the grid points, times the cell size (cubic only)
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,419 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static powertrain model template based on engine and torque converter
+// maps.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <map>
+
+#include "core/ChLog.h"
+#include "core/ChMathematics.h"
+
+#include "subsys/powertrain/ChMapPowertrain.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChProfiler.h"
+
+namespace chrono {
+
+
+// Number of bisection steps for the engine speed equilibrium.
+static const int NUM_BISECTIONS = 50;
+
+// Equilibrium tables, shared by all powertrains with the same maps key and
+// table resolution.
+typedef std::map<std::string, ChSharedPtr<ChMapPowertrain::Table> > ChMapPowertrainTables;
+
+static ChMapPowertrainTables s_tables;
+static vehicle::ChMutex      s_tables_mutex;
+
+
+// -----------------------------------------------------------------------------
+// Quasi-static equilibrium of the engine and torque converter.
+// -----------------------------------------------------------------------------
+namespace {
+
+struct EngineMaps {
+  ChSharedPtr<ChFunction_Recorder> torque;
+  ChSharedPtr<ChFunction_Recorder> losses;
+  ChSharedPtr<ChFunction_Recorder> capacity_factor;
+  ChSharedPtr<ChFunction_Recorder> torque_ratio;
+
+  double EngineTorque(double throttle, double speed) const
+  {
+    return throttle * torque->Get_y(speed) + losses->Get_y(speed);
+  }
+
+  double InputTorque(double engine_speed, double turbine_speed) const
+  {
+    if (engine_speed <= 0)
+      return 0;
+    double K = capacity_factor->Get_y(turbine_speed / engine_speed);
+    return (engine_speed / K) * (engine_speed / K);
+  }
+
+  // Engine speed in [lo, hi] at which the model residual changes sign.
+  template <typename Residual>
+  static double Solve(const Residual& f, double lo, double hi)
+  {
+    if (f(lo) <= 0)
+      return lo;
+    if (f(hi) >= 0)
+      return hi;
+    for (int k = 0; k < NUM_BISECTIONS; k++) {
+      double mid = 0.5 * (lo + hi);
+      if (f(mid) > 0)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return 0.5 * (lo + hi);
+  }
+};
+
+// Engine torque minus converter input torque, at fixed throttle and turbine speed.
+struct LoadedResidual {
+  LoadedResidual(const EngineMaps& m, double t, double w) : maps(m), throttle(t), turbine_speed(w) {}
+  double operator()(double speed) const { return maps.EngineTorque(throttle, speed) - maps.InputTorque(speed, turbine_speed); }
+
+  const EngineMaps& maps;
+  double            throttle;
+  double            turbine_speed;
+};
+
+// Engine torque, at fixed throttle (unloaded converter).
+struct FreeResidual {
+  FreeResidual(const EngineMaps& m, double t) : maps(m), throttle(t) {}
+  double operator()(double speed) const { return maps.EngineTorque(throttle, speed); }
+
+  const EngineMaps& maps;
+  double            throttle;
+};
+
+ChSharedPtr<ChMapPowertrain::Table> build_table(const EngineMaps& maps, int num_throttle, int num_speed)
+{
+  ChSharedPtr<ChMapPowertrain::Table> table(new ChMapPowertrain::Table);
+
+  double min_speed;
+  maps.torque->Estimate_x_range(min_speed, table->max_speed);
+  assert(table->max_speed > 0);
+
+  table->num_throttle = num_throttle;
+  table->num_speed = num_speed;
+  table->engine_speed.resize(num_throttle * num_speed);
+  table->input_torque.resize(num_throttle * num_speed);
+  table->output_torque.resize(num_throttle * num_speed);
+  table->free_speed.resize(num_throttle);
+
+  for (int i = 0; i < num_throttle; i++) {
+    double throttle = (double)i / (num_throttle - 1);
+
+    table->free_speed[i] = EngineMaps::Solve(FreeResidual(maps, throttle), 0, table->max_speed);
+
+    for (int j = 0; j < num_speed; j++) {
+      double turbine_speed = table->max_speed * j / (num_speed - 1);
+      double speed = EngineMaps::Solve(LoadedResidual(maps, throttle, turbine_speed), turbine_speed, table->max_speed);
+
+      int k = i * num_speed + j;
+      table->engine_speed[k] = speed;
+      if (speed > turbine_speed) {
+        table->input_torque[k] = maps.InputTorque(speed, turbine_speed);
+        table->output_torque[k] = table->input_torque[k] * maps.torque_ratio->Get_y(turbine_speed / speed);
+      }
+      else {
+        // Rigid coupling: the converter transmits the engine torque.
+        table->input_torque[k] = maps.EngineTorque(throttle, speed);
+        table->output_torque[k] = table->input_torque[k];
+      }
+    }
+  }
+
+  return table;
+}
+
+} // end anonymous namespace
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChMapPowertrain::Table> ChMapPowertrain::GetTable(const std::string&               key,
+                                                              ChSharedPtr<ChFunction_Recorder> torque,
+                                                              ChSharedPtr<ChFunction_Recorder> losses,
+                                                              ChSharedPtr<ChFunction_Recorder> capacity_factor,
+                                                              ChSharedPtr<ChFunction_Recorder> torque_ratio,
+                                                              int                              num_throttle,
+                                                              int                              num_speed)
+{
+  EngineMaps maps;
+  maps.torque = torque;
+  maps.losses = losses;
+  maps.capacity_factor = capacity_factor;
+  maps.torque_ratio = torque_ratio;
+
+  if (key.empty())
+    return build_table(maps, num_throttle, num_speed);
+
+  char resolution[32];
+  sprintf(resolution, "/%d/%d", num_throttle, num_speed);
+  std::string table_key = key + resolution;
+
+  vehicle::ChScopedLock lock(s_tables_mutex);
+
+  ChMapPowertrainTables::iterator it = s_tables.find(table_key);
+  if (it != s_tables.end())
+    return it->second;
+
+  ChSharedPtr<Table> table = build_table(maps, num_throttle, num_speed);
+  s_tables.insert(std::make_pair(table_key, table));
+
+  return table;
+}
+
+// The output torque increases with the throttle at a given turbine speed, so
+// the rows of the table are searched for the pair bracketing the torque.
+double ChMapPowertrain::GetTableThrottle(const Table& table,
+                                         double       output_torque,
+                                         double       turbine_speed,
+                                         double&      throttle)
+{
+  double speed = std::min(std::max(turbine_speed, 0.0), table.max_speed);
+  double r = speed * (table.num_speed - 1) / table.max_speed;
+  int j = std::min((int)r, table.num_speed - 2);
+  double v = r - j;
+
+  const double* T = &table.output_torque[j];
+  double T0 = (1 - v) * T[0] + v * T[1];
+  if (output_torque <= T0) {
+    throttle = 0;
+    return output_torque - T0;
+  }
+
+  for (int i = 1; i < table.num_throttle; i++) {
+    T += table.num_speed;
+    double T1 = (1 - v) * T[0] + v * T[1];
+    if (output_torque <= T1) {
+      throttle = (i - 1 + (output_torque - T0) / (T1 - T0)) / (table.num_throttle - 1);
+      return 0;
+    }
+    T0 = T1;
+  }
+
+  throttle = 1;
+  return output_torque - T0;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChMapPowertrain::ChMapPowertrain()
+: ChPowertrain(),
+  m_num_throttle(21),
+  m_num_speed(201),
+  m_current_gear(1),
+  m_current_gear_ratio(1e20),
+  m_last_time_gearshift(0),
+  m_gear_shift_latency(0.5),
+  m_motorSpeed(0),
+  m_motorTorque(0),
+  m_slippage(0),
+  m_tcOutputTorque(0),
+  m_shaftTorque(0)
+{
+  m_shift_scheduler.SetShiftMap(ChSharedPtr<ChShiftMap>(new ChShiftMap(1500 * CH_C_2PI / 60.0, 2500 * CH_C_2PI / 60.0)));
+}
+
+void ChMapPowertrain::SetTableResolution(int num_throttle, int num_speed)
+{
+  m_num_throttle = std::max(num_throttle, 2);
+  m_num_speed = std::max(num_speed, 2);
+}
+
+
+
+// -----------------------------------------------------------------------------
+// The maps are always defined by the derived class, even if a shared table
+// already exists, so that they remain the only description of the powertrain.
+// -----------------------------------------------------------------------------
+void ChMapPowertrain::Initialize()
+{
+  m_gear_ratios.clear();
+  SetGearRatios(m_gear_ratios);
+  assert(m_gear_ratios.size() > 1);
+
+  ChSharedPtr<ChFunction_Recorder> torque(new ChFunction_Recorder);
+  ChSharedPtr<ChFunction_Recorder> losses(new ChFunction_Recorder);
+  ChSharedPtr<ChFunction_Recorder> capacity_factor(new ChFunction_Recorder);
+  ChSharedPtr<ChFunction_Recorder> torque_ratio(new ChFunction_Recorder);
+  SetEngineTorqueMap(torque);
+  SetEngineLossesMap(losses);
+  SetTorqueConverterCapacityFactorMap(capacity_factor);
+  SetTorqeConverterTorqueRatioMap(torque_ratio);
+
+  m_table = GetTable(GetMapsKey(), torque, losses, capacity_factor, torque_ratio, m_num_throttle, m_num_speed);
+
+  SetDriveMode(m_drive_mode);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapPowertrain::SetSelectedGear(int igear)
+{
+  assert(igear >= 0);
+  assert(igear < (int)m_gear_ratios.size());
+
+  m_current_gear = igear;
+  m_current_gear_ratio = m_gear_ratios[igear];
+}
+
+void ChMapPowertrain::SetDriveMode(ChPowertrain::DriveMode mode)
+{
+  m_drive_mode = mode;
+
+  if (m_gear_ratios.empty())
+    return;
+
+  switch (mode) {
+  case FORWARD: SetSelectedGear(1); break;
+  case NEUTRAL: m_current_gear_ratio = 1e20; break;
+  case REVERSE: SetSelectedGear(0); break;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapPowertrain::Update(double time,
+                             double throttle,
+                             double shaft_speed)
+{
+  const Table& table = *m_table;
+
+  // Throttle interpolation weights
+  double s = std::min(std::max(throttle, 0.0), 1.0) * (table.num_throttle - 1);
+  int i = std::min((int)s, table.num_throttle - 2);
+  double u = s - i;
+
+  if (m_drive_mode == NEUTRAL) {
+    // Unloaded torque converter
+    m_motorSpeed = (1 - u) * table.free_speed[i] + u * table.free_speed[i + 1];
+    m_motorTorque = 0;
+    m_slippage = 0;
+    m_tcOutputTorque = 0;
+    m_shaftTorque = 0;
+    return;
+  }
+
+  // Turbine speed interpolation weights
+  double turbine_speed = std::min(std::max(shaft_speed / m_current_gear_ratio, 0.0), table.max_speed);
+  double r = turbine_speed * (table.num_speed - 1) / table.max_speed;
+  int j = std::min((int)r, table.num_speed - 2);
+  double v = r - j;
+
+  int k0 = i * table.num_speed + j;
+  int k1 = k0 + table.num_speed;
+  double w00 = (1 - u) * (1 - v);
+  double w01 = (1 - u) * v;
+  double w10 = u * (1 - v);
+  double w11 = u * v;
+
+  m_motorSpeed = w00 * table.engine_speed[k0] + w01 * table.engine_speed[k0 + 1] +
+                 w10 * table.engine_speed[k1] + w11 * table.engine_speed[k1 + 1];
+  m_motorTorque = w00 * table.input_torque[k0] + w01 * table.input_torque[k0 + 1] +
+                  w10 * table.input_torque[k1] + w11 * table.input_torque[k1 + 1];
+  m_tcOutputTorque = w00 * table.output_torque[k0] + w01 * table.output_torque[k0 + 1] +
+                     w10 * table.output_torque[k1] + w11 * table.output_torque[k1 + 1];
+  m_slippage = (m_motorSpeed > turbine_speed) ? 1 - turbine_speed / m_motorSpeed : 0;
+  m_shaftTorque = m_tcOutputTorque / m_current_gear_ratio;
+
+  // Automatic transmission, with the same fixed latency as ChShaftsPowertrain.
+  if (m_drive_mode != FORWARD || time - m_last_time_gearshift < m_gear_shift_latency)
+    return;
+
+  int num_gears = (int)m_gear_ratios.size() - 1;
+  int gear = m_shift_scheduler.GetGear(m_current_gear, num_gears, throttle, turbine_speed);
+
+  if (gear != m_current_gear) {
+    SetSelectedGear(gear);
+    m_last_time_gearshift = time;
+    CH_PROFILE_COUNTER("ChMapPowertrain::gear", gear);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChMapPowertrain::GetThrottleForTorque(double  torque,
+                                           double  shaft_speed,
+                                           double& throttle,
+                                           double& residual) const
+{
+  if (!m_table || m_drive_mode == NEUTRAL)
+    return false;
+
+  residual = GetTableThrottle(*m_table, torque * m_current_gear_ratio, shaft_speed / m_current_gear_ratio, throttle) /
+             m_current_gear_ratio;
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapPowertrain::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChPowertrain::SaveState(state);
+
+  state.BeginBlock(7);
+  state.Write(m_current_gear);
+  state.Write(m_last_time_gearshift);
+  state.Write(m_motorSpeed);
+  state.Write(m_motorTorque);
+  state.Write(m_slippage);
+  state.Write(m_tcOutputTorque);
+  state.Write(m_shaftTorque);
+}
+
+bool ChMapPowertrain::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChPowertrain::RestoreState(state) || !state.OpenBlock(7, "MapPowertrain"))
+    return false;
+
+  int gear = (int)state.Read();
+  m_last_time_gearshift = state.Read();
+  m_motorSpeed = state.Read();
+  m_motorTorque = state.Read();
+  m_slippage = state.Read();
+  m_tcOutputTorque = state.Read();
+  m_shaftTorque = state.Read();
+
+  if (gear < 0 || gear >= (int)m_gear_ratios.size()) {
+    GetLog() << "ERROR: invalid saved transmission gear " << gear << "\n";
+    return false;
+  }
+
+  if (m_drive_mode == NEUTRAL)
+    m_current_gear = gear;
+  else
+    SetSelectedGear(gear);
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,216 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static powertrain model template based on engine and torque converter
+// maps.
+//
+// The powertrain is described by the same maps as ChShaftsPowertrain (engine
+// torque and losses as functions of the engine speed, torque converter capacity
+// factor and torque ratio as functions of the speed ratio) and an automatic
+// transmission with a set of gear ratios. Unlike ChShaftsPowertrain, no shafts
+// are added to the system: the engine inertia is neglected and the engine speed
+// is the one at which the engine torque balances the torque converter input
+// torque, for the current throttle and turbine speed. These equilibria are
+// precomputed in Initialize() on a (throttle, turbine speed) grid, so that
+// Update() only performs a bilinear interpolation and does not allocate.
+// The tables are shared by all powertrains with the same maps key (see
+// GetMapsKey()) and table resolution.
+//
+// If the engine cannot drive the turbine (e.g. when coasting), the torque
+// converter is assumed to act as a rigid coupling and transmits the engine
+// (braking) torque unchanged.
+//
+// =============================================================================
+
+#ifndef CH_MAP_POWERTRAIN_H
+#define CH_MAP_POWERTRAIN_H
+
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "motion_functions/ChFunction_Recorder.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/powertrain/ChShiftMap.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API ChMapPowertrain : public ChPowertrain
+{
+public:
+
+  ChMapPowertrain();
+
+  ~ChMapPowertrain() {}
+
+  /// Initialize the powertrain system.
+  /// This builds the equilibrium tables, unless tables built from the same maps
+  /// already exist.
+  void Initialize();
+
+  /// Set the number of grid points along the throttle and turbine speed axes
+  /// of the equilibrium tables (default: 21 x 201).
+  /// Must be called before Initialize().
+  void SetTableResolution(int num_throttle, int num_speed);
+
+  /// Return the current engine speed.
+  virtual double GetMotorSpeed() const { return m_motorSpeed; }
+
+  /// Return the current engine torque, net of the engine losses.
+  virtual double GetMotorTorque() const { return m_motorTorque; }
+
+  /// Return the value of slippage in the torque converter.
+  virtual double GetTorqueConverterSlippage() const { return m_slippage; }
+
+  /// Return the input torque to the torque converter.
+  virtual double GetTorqueConverterInputTorque() const { return m_motorTorque; }
+
+  /// Return the output torque from the torque converter.
+  virtual double GetTorqueConverterOutputTorque() const { return m_tcOutputTorque; }
+
+  /// Return the current transmission gear
+  virtual int GetCurrentTransmissionGear() const { return m_current_gear; }
+
+  /// Return the ouput torque from the powertrain.
+  /// This is the torque that is passed to a vehicle system, thus providing the
+  /// interface between the powertrain and vehcicle cosimulation modules.
+  virtual double GetOutputTorque() const { return m_shaftTorque; }
+
+  /// Use this function to set the mode of automatic transmission.
+  virtual void SetDriveMode(ChPowertrain::DriveMode mmode);
+
+  /// Use this function to shift from one gear to another.
+  /// Note, index starts from 0.
+  void SetSelectedGear(int igear);
+
+  /// Use this to define the gear shift latency, in seconds.
+  void SetGearShiftLatency(double ml) { m_gear_shift_latency = ml; }
+
+  /// Set the shift map of the automatic transmission, evaluated at the turbine
+  /// speed. The default map shifts up above 2500 RPM and down below 1500 RPM,
+  /// in all gears, for any throttle.
+  void SetShiftMap(ChSharedPtr<ChShiftMap> map) { m_shift_scheduler.SetShiftMap(map); }
+
+  /// Find the throttle input at which the powertrain delivers the specified
+  /// torque to the driveshaft, at the specified driveshaft speed and in the
+  /// current gear, by inverting the equilibrium table.
+  virtual bool GetThrottleForTorque(double torque, double shaft_speed, double& throttle, double& residual) const;
+
+  /// Update the state of this powertrain system at the current time.
+  /// The powertrain system is provided the current driver throttle input, a
+  /// value in the range [0,1], and the current angular speed of the transmission
+  /// shaft (from the driveline).
+  virtual void Update(
+    double time,       ///< [in] current time
+    double throttle,   ///< [in] current throttle input [0,1]
+    double shaft_speed ///< [in] current angular speed of the transmission shaft
+    );
+
+  /// Advance the state of this powertrain system by the specified time step.
+  /// This function does nothing for this quasi-static powertrain model.
+  virtual void Advance(double step) {}
+
+  /// Append the drive mode, the gear selection and the engine state to the
+  /// specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the drive mode, the gear selection and the engine state from the
+  /// snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+protected:
+
+  /// Set up the gears, i.e. the transmission ratios of the various gears.
+  /// A derived class must populate the vector gear_ratios, using the 0 index
+  /// for reverse and 1,2,3,etc. for the forward gears.
+  virtual void SetGearRatios(std::vector<double>& gear_ratios) = 0;
+
+  /// Engine speed-torque map, at full throttle.
+  virtual void SetEngineTorqueMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
+
+  /// Engine speed-torque braking effect because of losses.
+  virtual void SetEngineLossesMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
+
+  /// Torque converter maps:
+  /// capacity factor and torque ratio as functions of the speed ratio.
+  virtual void SetTorqueConverterCapacityFactorMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
+  virtual void SetTorqeConverterTorqueRatioMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
+
+  /// Return the key under which the equilibrium tables are shared. By default,
+  /// the tables are shared by all powertrains of the same (most derived) type.
+  /// A derived class whose maps depend on per-instance data must return a key
+  /// identifying these data, or an empty string to disable sharing.
+  virtual std::string GetMapsKey() const { return typeid(*this).name(); }
+
+public:
+
+  /// Equilibrium tables, indexed by (throttle, turbine speed).
+  struct Table : public ChShared {
+    int                  num_throttle;
+    int                  num_speed;
+    double               max_speed;       ///< largest tabulated turbine speed
+    std::vector<double>  engine_speed;    ///< engine speed
+    std::vector<double>  input_torque;    ///< torque converter input (net engine) torque
+    std::vector<double>  output_torque;   ///< torque converter output torque
+    std::vector<double>  free_speed;      ///< engine speed with unloaded converter, by throttle
+  };
+
+  /// Get the equilibrium table of the specified maps, on a grid with the
+  /// specified resolution. If the key is not empty, the table is shared with
+  /// all callers using the same key and resolution (and built only once).
+  static ChSharedPtr<Table> GetTable(
+    const std::string&                key,              ///< [in] maps key (empty: no sharing)
+    ChSharedPtr<ChFunction_Recorder>  torque,           ///< [in] engine torque map, at full throttle
+    ChSharedPtr<ChFunction_Recorder>  losses,           ///< [in] engine losses map
+    ChSharedPtr<ChFunction_Recorder>  capacity_factor,  ///< [in] converter capacity factor map
+    ChSharedPtr<ChFunction_Recorder>  torque_ratio,     ///< [in] converter torque ratio map
+    int                               num_throttle,     ///< [in] number of throttle grid points
+    int                               num_speed         ///< [in] number of turbine speed grid points
+    );
+
+  /// Find the throttle at which the torque converter output torque of the
+  /// table, at the specified turbine speed, equals the specified torque. The
+  /// throttle is clamped to [0,1]; the function returns the requested torque
+  /// minus the torque delivered at the returned throttle (zero if the torque
+  /// is within reach).
+  static double GetTableThrottle(const Table& table, double output_torque, double turbine_speed, double& throttle);
+
+private:
+
+  ChSharedPtr<Table>   m_table;
+  int                  m_num_throttle;
+  int                  m_num_speed;
+
+  std::vector<double>  m_gear_ratios;
+  int                  m_current_gear;
+  double               m_current_gear_ratio;
+  double               m_last_time_gearshift;
+  double               m_gear_shift_latency;
+  ChShiftScheduler     m_shift_scheduler;
+
+  double               m_motorSpeed;
+  double               m_motorTorque;
+  double               m_slippage;
+  double               m_tcOutputTorque;
+  double               m_shaftTorque;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -16,13 +16,33 @@
 //
 // =============================================================================
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
 #include "physics/ChSystem.h"
 
 #include "subsys/powertrain/ChShaftsPowertrain.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChSimulationContext.h"
 
 namespace chrono {
 
 
+// Tabulated maps, shared by all powertrains with the same maps key and table
+// settings.
+typedef std::map<std::string, ChSharedPtr<ChFunction_Tabulated> > ChTabulatedMaps;
+
+static ChTabulatedMaps  s_tabulated_maps;
+static vehicle::ChMutex s_tabulated_maps_mutex;
+
+// Relative perturbation of the speeds for the derivatives of the sub-stepped
+// engine model.
+static const double SHAFTS_speed_delta = 1e-4;
+
+
 // -----------------------------------------------------------------------------
 // dir_motor_block specifies the direction of the motor block, i.e. the
 // direction of the crankshaft, in chassis local coords. This is needed because
@@ -32,8 +52,84 @@ ChShaftsPowertrain::ChShaftsPowertrain(const ChVector<>&  dir_motor_block)
 : ChPowertrain(),
   m_dir_motor_block(dir_motor_block),
   m_last_time_gearshift(0),
-  m_gear_shift_latency(0.5)
+  m_gear_shift_latency(0.5),
+  m_tabulated(false),
+  m_num_intervals(1000),
+  m_interpolation(ChFunction_Tabulated::LINEAR),
+  m_equilibrium(false),
+  m_num_throttle(21),
+  m_num_speed(201),
+  m_net_engine(-1),
+  m_net_converter(-1),
+  m_net_gears(-1),
+  m_substep(false),
+  m_substep_size(1e-4),
+  m_crankshaft_inertia(0),
+  m_ingear_inertia(0),
+  m_throttle(0),
+  m_motor_speed(0),
+  m_turbine_speed(0),
+  m_motor_torque(0),
+  m_tc_input_torque(0),
+  m_tc_output_torque(0),
+  m_slippage(0),
+  m_output_torque(0)
 {
+  m_shift_scheduler.SetShiftMap(ChSharedPtr<ChShiftMap>(new ChShiftMap(1500 * CH_C_2PI / 60.0, 2500 * CH_C_2PI / 60.0)));
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShaftsPowertrain::SetTabulatedMaps(bool                                val,
+                                          int                                 num_intervals,
+                                          ChFunction_Tabulated::Interpolation interpolation)
+{
+  m_tabulated = val;
+  m_num_intervals = num_intervals;
+  m_interpolation = interpolation;
+}
+
+void ChShaftsPowertrain::SetSubstepping(bool val, double substep)
+{
+  m_substep = val;
+  m_substep_size = substep;
+}
+
+void ChShaftsPowertrain::SetEquilibriumTable(bool val, int num_throttle, int num_speed)
+{
+  m_equilibrium = val;
+  m_num_throttle = std::max(num_throttle, 2);
+  m_num_speed = std::max(num_speed, 2);
+}
+
+// The map is always defined by the derived class, even if a shared table
+// already exists, so that the maps remain the only description of the engine
+// and torque converter.
+ChSharedPtr<ChFunction> ChShaftsPowertrain::get_map(const char*                      name,
+                                                    ChSharedPtr<ChFunction_Recorder> map) const
+{
+  if (!m_tabulated)
+    return map;
+
+  std::string key = GetMapsKey();
+  if (key.empty())
+    return ChSharedPtr<ChFunction_Tabulated>(new ChFunction_Tabulated(*map, m_num_intervals, m_interpolation));
+
+  char settings[64];
+  sprintf(settings, "/%s/%d/%d", name, m_num_intervals, (int)m_interpolation);
+  key += settings;
+
+  vehicle::ChScopedLock lock(s_tabulated_maps_mutex);
+
+  ChTabulatedMaps::iterator it = s_tabulated_maps.find(key);
+  if (it != s_tabulated_maps.end())
+    return it->second;
+
+  ChSharedPtr<ChFunction_Tabulated> table(new ChFunction_Tabulated(*map, m_num_intervals, m_interpolation));
+  s_tabulated_maps.insert(std::make_pair(key, table));
+
+  return table;
 }
 
 
@@ -46,6 +142,11 @@ void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>  chassis,
   assert(driveshaft);
   assert(chassis->GetSystem());
 
+  if (m_substep) {
+    init_substep();
+    return;
+  }
+
   ChSystem* my_system = chassis->GetSystem();
 
 
@@ -91,7 +192,7 @@ void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>  chassis,
     // The thermal engine requires a torque curve: 
   ChSharedPtr<ChFunction_Recorder> mTw(new ChFunction_Recorder);
   SetEngineTorqueMap(mTw);
-  m_engine->SetTorqueCurve(mTw);
+  m_engine->SetTorqueCurve(get_map("torque", mTw));
 
   // CREATE  an engine brake model that represents the losses of the engine because
   // of inner frictions/turbolences/etc. Without this, the engine at 0% throttle
@@ -103,7 +204,7 @@ void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>  chassis,
     // The engine brake model requires a torque curve: 
   ChSharedPtr<ChFunction_Recorder> mTw_losses(new ChFunction_Recorder);
   SetEngineLossesMap(mTw_losses);
-  m_engine_losses->SetTorqueCurve(mTw_losses);
+  m_engine_losses->SetTorqueCurve(get_map("losses", mTw_losses));
 
 
   // CREATE  a 1 d.o.f. object: a 'shaft' with rotational inertia.
@@ -124,11 +225,14 @@ void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>  chassis,
    // To complete the setup of the torque converter, a capacity factor curve is needed:
   ChSharedPtr<ChFunction_Recorder> mK(new ChFunction_Recorder);
   SetTorqueConverterCapacityFactorMap(mK);
-  m_torqueconverter->SetCurveCapacityFactor(mK);
+  m_torqueconverter->SetCurveCapacityFactor(get_map("capacity_factor", mK));
    // To complete the setup of the torque converter, a torque ratio curve is needed:	
   ChSharedPtr<ChFunction_Recorder> mT(new ChFunction_Recorder);
   SetTorqeConverterTorqueRatioMap(mT);
-  m_torqueconverter->SetCurveTorqueRatio(mT);
+  m_torqueconverter->SetCurveTorqueRatio(get_map("torque_ratio", mT));
+
+  if (m_equilibrium)
+    m_table = ChMapPowertrain::GetTable(GetMapsKey(), mTw, mTw_losses, mK, mT, m_num_throttle, m_num_speed);
 
 
   // CREATE a gearbox, i.e a transmission ratio constraint between two
@@ -150,6 +254,103 @@ void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>  chassis,
 }
 
 
+// -----------------------------------------------------------------------------
+// With a partitioned driveline, the powertrain shafts are added to its shaft
+// network instead of the Chrono system. The motor block is then fixed to the
+// chassis, whose roll under the engine torque is neglected.
+// -----------------------------------------------------------------------------
+void ChShaftsPowertrain::Initialize(ChSharedPtr<ChBody>      chassis,
+                                    ChSharedPtr<ChDriveline> driveline)
+{
+  if (m_substep) {
+    init_substep();
+    return;
+  }
+
+  m_network = driveline->GetShaftNetwork();
+  if (m_network.IsNull()) {
+    Initialize(chassis, driveline->GetDriveshaft());
+    return;
+  }
+
+  int driveshaft = m_network->GetShaftIndex(driveline->GetDriveshaft());
+  assert(driveshaft >= 0);
+
+  SetGearRatios(m_gear_ratios);
+  assert(m_gear_ratios.size() > 1);
+  m_current_gear = 1;
+
+  m_crankshaft = ChSharedPtr<ChShaft>(new ChShaft);
+  m_crankshaft->SetInertia(GetCrankshaftInertia());
+  int crankshaft = m_network->AddShaft(m_crankshaft);
+
+  ChSharedPtr<ChFunction_Recorder> mTw(new ChFunction_Recorder);
+  SetEngineTorqueMap(mTw);
+  m_net_engine = m_network->AddEngine(crankshaft, get_map("torque", mTw));
+
+  ChSharedPtr<ChFunction_Recorder> mTw_losses(new ChFunction_Recorder);
+  SetEngineLossesMap(mTw_losses);
+  m_network->AddEngine(crankshaft, get_map("losses", mTw_losses));
+
+  m_shaft_ingear = ChSharedPtr<ChShaft>(new ChShaft);
+  m_shaft_ingear->SetInertia(GetIngearShaftInertia());
+  int ingear = m_network->AddShaft(m_shaft_ingear);
+
+  ChSharedPtr<ChFunction_Recorder> mK(new ChFunction_Recorder);
+  SetTorqueConverterCapacityFactorMap(mK);
+  ChSharedPtr<ChFunction_Recorder> mT(new ChFunction_Recorder);
+  SetTorqeConverterTorqueRatioMap(mT);
+  m_net_converter = m_network->AddTorqueConverter(crankshaft, ingear, get_map("capacity_factor", mK),
+                                                  get_map("torque_ratio", mT));
+
+  if (m_equilibrium)
+    m_table = ChMapPowertrain::GetTable(GetMapsKey(), mTw, mTw_losses, mK, mT, m_num_throttle, m_num_speed);
+
+  m_net_gears = m_network->AddGear(ingear, driveshaft, m_gear_ratios[m_current_gear]);
+
+  SetSelectedGear(1);
+}
+
+
+// -----------------------------------------------------------------------------
+// The sub-stepped engine model uses the same maps as the shaft elements; the
+// engine and the turbine start at rest, as the shafts.
+// -----------------------------------------------------------------------------
+void ChShaftsPowertrain::init_substep()
+{
+  SetGearRatios(m_gear_ratios);
+  assert(m_gear_ratios.size() > 1);
+  m_current_gear = 1;
+
+  m_crankshaft_inertia = GetCrankshaftInertia();
+  m_ingear_inertia = GetIngearShaftInertia();
+
+  ChSharedPtr<ChFunction_Recorder> mTw(new ChFunction_Recorder);
+  SetEngineTorqueMap(mTw);
+  m_torque_map = get_map("torque", mTw);
+
+  ChSharedPtr<ChFunction_Recorder> mTw_losses(new ChFunction_Recorder);
+  SetEngineLossesMap(mTw_losses);
+  m_losses_map = get_map("losses", mTw_losses);
+
+  ChSharedPtr<ChFunction_Recorder> mK(new ChFunction_Recorder);
+  SetTorqueConverterCapacityFactorMap(mK);
+  m_capacity_map = get_map("capacity_factor", mK);
+
+  ChSharedPtr<ChFunction_Recorder> mT(new ChFunction_Recorder);
+  SetTorqeConverterTorqueRatioMap(mT);
+  m_ratio_map = get_map("torque_ratio", mT);
+
+  if (m_equilibrium)
+    m_table = ChMapPowertrain::GetTable(GetMapsKey(), mTw, mTw_losses, mK, mT, m_num_throttle, m_num_speed);
+
+  m_motor_speed = 0;
+  m_turbine_speed = 0;
+
+  SetSelectedGear(1);
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChShaftsPowertrain::SetSelectedGear(int igear)
@@ -160,6 +361,10 @@ void ChShaftsPowertrain::SetSelectedGear(int igear)
   m_current_gear = igear;
   if (m_gears)
     m_gears->SetTransmissionRatio(m_gear_ratios[igear]);
+  if (m_net_gears >= 0) {
+    m_network->SetGearRatio(m_net_gears, m_gear_ratios[igear]);
+    m_network->SetConstraintActive(m_net_gears, true);
+  }
 }
 
 
@@ -171,11 +376,16 @@ void ChShaftsPowertrain::SetDriveMode(ChPowertrain::DriveMode mmode)
 
   m_drive_mode = mmode;
 
-  if (!m_gears) return;
+  if (!m_substep && !m_gears && m_net_gears < 0) return;
 
   switch (m_drive_mode) {
   case FORWARD: SetSelectedGear(1); break;
-  case NEUTRAL: m_gears->SetTransmissionRatio(1e20); break;
+  case NEUTRAL:
+    if (m_gears)
+      m_gears->SetTransmissionRatio(1e20);
+    else if (m_net_gears >= 0)
+      m_network->SetConstraintActive(m_net_gears, false);
+    break;
   case REVERSE: SetSelectedGear(0); break;
   }
 }
@@ -187,38 +397,194 @@ void ChShaftsPowertrain::Update(double time,
                                 double throttle,
                                 double shaft_speed)
 {
-  // Just update the throttle level in the thermal engine
-  m_engine->SetThrottle(throttle);
+  // Just update the throttle level in the thermal engine. In drive, the
+  // turbine of the sub-stepped model turns with the driveshaft.
+  if (m_substep) {
+    m_throttle = throttle;
+    if (m_drive_mode != NEUTRAL)
+      m_turbine_speed = shaft_speed / m_gear_ratios[m_current_gear];
+  } else if (m_net_engine >= 0) {
+    m_network->SetThrottle(m_net_engine, throttle);
+  } else {
+    m_engine->SetThrottle(throttle);
+  }
 
   // To avoid bursts of gear shifts, do nothing if the last shift was too recent
   if (time - m_last_time_gearshift < m_gear_shift_latency)
     return;
 
-  // Shift the gear if needed, automatically shifting up or down with 
-  // a very simple logic, for instance as in the following fixed latency 
-  // state machine:
+  // Shift the gear if needed, as specified by the shift map.
   if (m_drive_mode != FORWARD)
     return;
 
-  double gearshaft_speed = m_shaft_ingear->GetPos_dt();
+  int num_gears = (int)m_gear_ratios.size() - 1;
+  double ingear_speed = m_substep ? m_turbine_speed : m_shaft_ingear->GetPos_dt();
+  int gear = m_shift_scheduler.GetGear(m_current_gear, num_gears, throttle, ingear_speed);
+
+  if (gear != m_current_gear) {
+    SetSelectedGear(gear);
+    m_last_time_gearshift = time;
+    CH_PROFILE_COUNTER("ChShaftsPowertrain::gear", gear);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Sub-stepped engine model. The converter torques are those of the shaft
+// elements (see ChShaftNetwork): the input torque is the square of the input
+// speed over the capacity factor, the output torque the input torque times the
+// torque ratio, both functions of the speed ratio.
+// -----------------------------------------------------------------------------
+double ChShaftsPowertrain::engine_torque(double speed) const
+{
+  return m_throttle * m_torque_map->Get_y(speed) + m_losses_map->Get_y(speed);
+}
+
+double ChShaftsPowertrain::converter_torque(double w_in, double w_out, double& torque_out) const
+{
+  double ratio = (std::abs(w_in) < 1e-9) ? 0 : w_out / w_in;
+  double K = m_capacity_map->Get_y(ratio);
+  double torque_in = (K > 0) ? w_in * std::abs(w_in) / (K * K) : 0;
+  torque_out = m_ratio_map->Get_y(ratio) * torque_in;
+
+  return torque_in;
+}
+
+// Each speed w is advanced with a linearly implicit Euler step,
+//   w+ = w + h f(w) / (1 - h f'(w)),
+// where f is its acceleration, and f' is evaluated by central differences. The
+// step is exact for a linear f, is stable for the stiff engine-converter
+// coupling (f' < 0) at any sub-step size, and falls back to the explicit step
+// where f' > 0. In neutral, the turbine is then advanced under the converter
+// output torque at the new engine speed.
+void ChShaftsPowertrain::substep(double h)
+{
+  double w_t = m_turbine_speed;
+  double w = m_motor_speed;
+  double dw = SHAFTS_speed_delta * std::max(std::abs(w), 1.0);
+  double out;
+
+  double f = (engine_torque(w) - converter_torque(w, w_t, out)) / m_crankshaft_inertia;
+  double f_plus = (engine_torque(w + dw) - converter_torque(w + dw, w_t, out)) / m_crankshaft_inertia;
+  double f_minus = (engine_torque(w - dw) - converter_torque(w - dw, w_t, out)) / m_crankshaft_inertia;
+  double jac = (f_plus - f_minus) / (2 * dw);
+  m_motor_speed = w + h * f / (1 - h * std::min(jac, 0.0));
+
+  if (m_drive_mode == NEUTRAL) {
+    w = m_motor_speed;
+    dw = SHAFTS_speed_delta * std::max(std::abs(w_t), 1.0);
+    double g, g_plus, g_minus;
+    converter_torque(w, w_t, g);
+    converter_torque(w, w_t + dw, g_plus);
+    converter_torque(w, w_t - dw, g_minus);
+    jac = (g_plus - g_minus) / (2 * dw * m_ingear_inertia);
+    m_turbine_speed = w_t + h * (g / m_ingear_inertia) / (1 - h * std::min(jac, 0.0));
+  }
+}
+
+// The torques reported for the step are averaged over its sub-steps, at the
+// end of each sub-step, so that the driveshaft receives a smooth torque.
+void ChShaftsPowertrain::Advance(double step)
+{
+  if (!m_substep || step <= 0)
+    return;
+
+  int num_substeps = std::max((int)std::ceil(step / m_substep_size - 1e-9), 1);
+  double h = step / num_substeps;
+
+  double engine = 0;
+  double torque_in = 0;
+  double torque_out = 0;
+  for (int k = 0; k < num_substeps; k++) {
+    substep(h);
+    double out;
+    engine += engine_torque(m_motor_speed);
+    torque_in += converter_torque(m_motor_speed, m_turbine_speed, out);
+    torque_out += out;
+  }
+
+  m_motor_torque = engine / num_substeps;
+  m_tc_input_torque = torque_in / num_substeps;
+  m_tc_output_torque = torque_out / num_substeps;
+  m_slippage = (std::abs(m_motor_speed) < 1e-9) ? 1 : 1 - m_turbine_speed / m_motor_speed;
+  m_output_torque = (m_drive_mode == NEUTRAL) ? 0 : m_tc_output_torque / m_gear_ratios[m_current_gear];
+}
+
 
-  if (gearshaft_speed > 2500 * CH_C_2PI / 60.0) {
-    // upshift if possible
-    if (m_current_gear + 1 < m_gear_ratios.size()) {
-      GetLog() << "SHIFT UP " << m_current_gear << " -> " << m_current_gear + 1 << "\n";
-      SetSelectedGear(m_current_gear + 1);
-      m_last_time_gearshift = time;
-    }
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChShaftsPowertrain::GetThrottleForTorque(double  torque,
+                                              double  shaft_speed,
+                                              double& throttle,
+                                              double& residual) const
+{
+  if (!m_table || m_drive_mode == NEUTRAL)
+    return false;
+
+  double ratio = m_gear_ratios[m_current_gear];
+  residual = ChMapPowertrain::GetTableThrottle(*m_table, torque * ratio, shaft_speed / ratio, throttle) / ratio;
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// The shaft states are saved with the vehicle; only the gear selection (and
+// the state of the sub-stepped engine) is saved here.
+// -----------------------------------------------------------------------------
+void ChShaftsPowertrain::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChPowertrain::SaveState(state);
+
+  state.BeginBlock(2);
+  state.Write(m_current_gear);
+  state.Write(m_last_time_gearshift);
+
+  if (m_substep) {
+    state.BeginBlock(8);
+    state.Write(m_throttle);
+    state.Write(m_motor_speed);
+    state.Write(m_turbine_speed);
+    state.Write(m_motor_torque);
+    state.Write(m_tc_input_torque);
+    state.Write(m_tc_output_torque);
+    state.Write(m_slippage);
+    state.Write(m_output_torque);
+  }
+}
+
+bool ChShaftsPowertrain::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChPowertrain::RestoreState(state) || !state.OpenBlock(2, "ShaftsPowertrain"))
+    return false;
+
+  int gear = (int)state.Read();
+  m_last_time_gearshift = state.Read();
+
+  if (m_substep) {
+    if (!state.OpenBlock(8, "ShaftsPowertrain engine"))
+      return false;
+    m_throttle = state.Read();
+    m_motor_speed = state.Read();
+    m_turbine_speed = state.Read();
+    m_motor_torque = state.Read();
+    m_tc_input_torque = state.Read();
+    m_tc_output_torque = state.Read();
+    m_slippage = state.Read();
+    m_output_torque = state.Read();
   }
-  else if (gearshaft_speed < 1500 * CH_C_2PI / 60.0) {
-    // downshift if possible
-    if (m_current_gear - 1 > 0) {
-      GetLog() << "SHIFT DOWN " << m_current_gear << " -> " << m_current_gear - 1 << "\n";
-      SetSelectedGear(m_current_gear - 1);
-      m_last_time_gearshift = time;
-    }
+
+  if (gear < 0 || gear >= (int)m_gear_ratios.size()) {
+    vehicle::GetContextLog() << "ERROR: invalid saved transmission gear " << gear << "\n";
+    return false;
   }
 
+  if (m_drive_mode == NEUTRAL)
+    m_current_gear = gear;
+  else
+    SetSelectedGear(gear);
+
+  return true;
 }
 
 
@@ -14,13 +14,33 @@
 //
 // Powertrain model template based on ChShaft objects.
 //
+// Optionally (see SetSubstepping()), the engine and the torque converter are
+// not added to the system as shafts: the engine speed is integrated in
+// Advance(), with a linearly implicit (Rosenbrock-Euler) scheme in sub-steps
+// of a fixed size, from the same engine and converter maps. The stiff
+// coupling through the converter is then resolved at the sub-step rate and no
+// longer limits the step of the vehicle. In drive, the turbine turns with the
+// driveshaft (through the current gear ratio) and the converter output torque,
+// averaged over the step, is applied to the driveshaft as the powertrain
+// output torque (see GetOutputTorque()). The inertias of the motor block and
+// of the ingear shaft are then neglected, except for the ingear shaft in
+// neutral, where the turbine is integrated along with the engine.
+//
 // =============================================================================
 
 #ifndef CH_SHAFTS_POWERTRAIN_H
 #define CH_SHAFTS_POWERTRAIN_H
 
+#include <string>
+#include <typeinfo>
+
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChPowertrain.h"
+#include "subsys/ChDriveline.h"
+#include "subsys/ChShaftNetwork.h"
+#include "subsys/powertrain/ChFunction_Tabulated.h"
+#include "subsys/powertrain/ChMapPowertrain.h"
+#include "subsys/powertrain/ChShiftMap.h"
 
 #include "physics/ChShaftsGear.h" 
 #include "physics/ChShaftsGearbox.h"
@@ -50,23 +70,48 @@ public:
 
   /// To be called after creation, to create all the wrapped ChShaft objects 
   /// and their constraints, torques etc. 
+  /// The driveshaft must be in the Chrono system; for a partitioned driveline,
+  /// use the overload taking the driveline.
   void Initialize(ChSharedPtr<ChBody>  chassis,
                   ChSharedPtr<ChShaft> driveshaft);
 
+  /// Initialize this powertrain connected to the driveshaft of the specified
+  /// driveline. If the driveline is partitioned (see
+  /// ChDriveline::GetShaftNetwork()), the powertrain shafts are added to its
+  /// shaft network, with the motor block fixed to the chassis.
+  void Initialize(ChSharedPtr<ChBody>      chassis,
+                  ChSharedPtr<ChDriveline> driveline);
+
   /// Return the current engine speed.
-  virtual double GetMotorSpeed() const { return  m_crankshaft->GetPos_dt(); }
+  virtual double GetMotorSpeed() const { return m_substep ? m_motor_speed : m_crankshaft->GetPos_dt(); }
 
   /// Return the current engine torque.
-  virtual double GetMotorTorque() const { return  m_engine->GetTorqueReactionOn1(); }
+  virtual double GetMotorTorque() const {
+    if (m_substep)
+      return m_motor_torque;
+    return m_network.IsNull() ? m_engine->GetTorqueReactionOn1() : m_network->GetEngineTorque(m_net_engine);
+  }
 
   /// Return the value of slippage in the torque converter.
-  virtual double GetTorqueConverterSlippage() const { return m_torqueconverter->GetSlippage(); }
+  virtual double GetTorqueConverterSlippage() const {
+    if (m_substep)
+      return m_slippage;
+    return m_network.IsNull() ? m_torqueconverter->GetSlippage() : m_network->GetConverterSlippage(m_net_converter);
+  }
 
   /// Return the input torque to the torque converter.
-  virtual double GetTorqueConverterInputTorque() const { return -m_torqueconverter->GetTorqueReactionOnInput(); }
+  virtual double GetTorqueConverterInputTorque() const {
+    if (m_substep)
+      return m_tc_input_torque;
+    return m_network.IsNull() ? -m_torqueconverter->GetTorqueReactionOnInput() : m_network->GetConverterInputTorque(m_net_converter);
+  }
 
   /// Return the output torque from the torque converter.
-  virtual double GetTorqueConverterOutputTorque() const { return m_torqueconverter->GetTorqueReactionOnOutput(); }
+  virtual double GetTorqueConverterOutputTorque() const {
+    if (m_substep)
+      return m_tc_output_torque;
+    return m_network.IsNull() ? m_torqueconverter->GetTorqueReactionOnOutput() : m_network->GetConverterOutputTorque(m_net_converter);
+  }
 
   /// Return the current transmission gear
   virtual int GetCurrentTransmissionGear() const { return m_current_gear; }
@@ -75,8 +120,10 @@ public:
   /// This is the torque that is passed to a vehicle system, thus providing the
   /// interface between the powertrain and vehcicle cosimulation modules.
   /// Since a ShaftsPowertrain is directly connected to the vehicle's driveline,
-  /// this function returns 0.
-  virtual double GetOutputTorque() const { return 0; }
+  /// this function returns 0, unless the engine is integrated in sub-steps
+  /// (see SetSubstepping()): it then returns the torque converter output
+  /// torque, averaged over the last step, at the driveshaft.
+  virtual double GetOutputTorque() const { return m_substep ? m_output_torque : 0; }
 
   /// Use this function to set the mode of automatic transmission.
   virtual void SetDriveMode(ChPowertrain::DriveMode mmode);
@@ -92,6 +139,51 @@ public:
   /// Use this to get the gear shift latency, in seconds.
   double GetGearShiftLatency(double ml) {return m_gear_shift_latency;}
 
+  /// Set the shift map of the automatic transmission, evaluated at the speed
+  /// of the transmission input shaft. The default map shifts up above
+  /// 2500 RPM and down below 1500 RPM, in all gears, for any throttle.
+  void SetShiftMap(ChSharedPtr<ChShiftMap> map) { m_shift_scheduler.SetShiftMap(map); }
+
+  /// Enable the tabulation of the engine and torque converter maps (default:
+  /// disabled). If enabled, the maps defined by the derived class are sampled
+  /// in Initialize() on uniform grids with the specified number of cells, and
+  /// the shaft elements evaluate the tables instead. Tables are shared with
+  /// all powertrains using the same maps key and settings (see GetMapsKey()).
+  /// Must be called before Initialize().
+  void SetTabulatedMaps(
+    bool                                val,                   ///< [in] enable tabulation
+    int                                 num_intervals = 1000,  ///< [in] number of grid cells
+    ChFunction_Tabulated::Interpolation interpolation = ChFunction_Tabulated::LINEAR  ///< [in] interpolation type
+    );
+
+  /// Integrate the engine and the torque converter in Advance(), in sub-steps
+  /// of the specified size (default: disabled, the powertrain shafts are
+  /// integrated with the system). If enabled, Initialize() does not add any
+  /// shafts and the powertrain is coupled to the driveline through its output
+  /// torque, as the other powertrain models. The step of Advance() is divided
+  /// in equal sub-steps, none larger than the specified size.
+  /// Must be called before Initialize().
+  void SetSubstepping(bool val, double substep = 1e-4);
+
+  /// Return true if the engine is integrated in sub-steps (see SetSubstepping()).
+  bool IsSubstepping() const { return m_substep; }
+
+  /// Enable the quasi-static equilibrium table of the maps (default: disabled),
+  /// as built by ChMapPowertrain, on a grid with the specified resolution. The
+  /// table is only used by GetThrottleForTorque(). Tables are shared with all
+  /// powertrains using the same maps key and resolution.
+  /// Must be called before Initialize().
+  void SetEquilibriumTable(
+    bool val,                ///< [in] enable the table
+    int  num_throttle = 21,  ///< [in] number of throttle grid points
+    int  num_speed = 201     ///< [in] number of turbine speed grid points
+    );
+
+  /// Find the throttle input at which the powertrain delivers the specified
+  /// torque to the driveshaft, in steady state, using the equilibrium table.
+  /// Returns false if the table is not enabled (see SetEquilibriumTable()).
+  virtual bool GetThrottleForTorque(double torque, double shaft_speed, double& throttle, double& residual) const;
+
   /// Update the state of this powertrain system at the current time.
   /// The powertrain system is provided the current driver throttle input, a
   /// value in the range [0,1], and the current angular speed of the transmission
@@ -104,8 +196,18 @@ public:
 
   /// Advance the state of this powertrain system by the specified time step.
   /// Since the state of a ShaftsPowertrain is advanced as part of the vehicle
-  /// state, this function does nothing.
-  virtual void Advance(double step) {}
+  /// state, this function does nothing, unless the engine is integrated in
+  /// sub-steps (see SetSubstepping()).
+  virtual void Advance(double step);
+
+  /// Append the drive mode and the gear selection to the specified snapshot.
+  /// The states of the powertrain shafts are saved with the vehicle state;
+  /// the engine state is saved here if it is integrated in sub-steps.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the drive mode and the gear selection (and the sub-stepped
+  /// engine state) from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
 
 protected:
 
@@ -129,8 +231,31 @@ protected:
   virtual void SetTorqueConverterCapacityFactorMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
   virtual void SetTorqeConverterTorqueRatioMap(ChSharedPtr<ChFunction_Recorder>& map) = 0;
 
+  /// Return the key under which the tabulated maps are shared. By default, the
+  /// maps are shared by all powertrains of the same (most derived) type. A
+  /// derived class whose maps depend on per-instance data must return a key
+  /// identifying these data, or an empty string to disable sharing.
+  virtual std::string GetMapsKey() const { return typeid(*this).name(); }
+
 private:
 
+  // Return the specified map, or its tabulated version if enabled.
+  ChSharedPtr<ChFunction> get_map(const char* name, ChSharedPtr<ChFunction_Recorder> map) const;
+
+  // Set up the sub-stepped engine model (maps and inertias, no shafts).
+  void init_substep();
+
+  // Engine torque, net of the losses, at the specified speed.
+  double engine_torque(double speed) const;
+
+  // Torque converter input torque at the specified input and output speeds;
+  // the output torque is returned in torque_out.
+  double converter_torque(double w_in, double w_out, double& torque_out) const;
+
+  // Advance the sub-stepped engine (and, in neutral, the turbine) by one
+  // sub-step.
+  void substep(double h);
+
   ChSharedPtr<ChShaftsBody>             m_motorblock_to_body;
   ChSharedPtr<ChShaft>                  m_motorblock;
   ChSharedPtr<ChShaftsThermalEngine>    m_engine;
@@ -147,6 +272,38 @@ private:
 
   double m_last_time_gearshift;
   double m_gear_shift_latency;
+  ChShiftScheduler m_shift_scheduler;
+
+  bool m_tabulated;
+  int  m_num_intervals;
+  ChFunction_Tabulated::Interpolation m_interpolation;
+
+  bool m_equilibrium;
+  int  m_num_throttle;
+  int  m_num_speed;
+  ChSharedPtr<ChMapPowertrain::Table> m_table;
+
+  ChSharedPtr<vehicle::ChShaftNetwork> m_network;   // shaft network of a partitioned driveline
+  int m_net_engine;
+  int m_net_converter;
+  int m_net_gears;
+
+  bool   m_substep;                     // engine integrated in Advance()
+  double m_substep_size;
+  ChSharedPtr<ChFunction> m_torque_map;
+  ChSharedPtr<ChFunction> m_losses_map;
+  ChSharedPtr<ChFunction> m_capacity_map;
+  ChSharedPtr<ChFunction> m_ratio_map;
+  double m_crankshaft_inertia;
+  double m_ingear_inertia;
+  double m_throttle;
+  double m_motor_speed;
+  double m_turbine_speed;
+  double m_motor_torque;                // averaged over the last step
+  double m_tc_input_torque;             // averaged over the last step
+  double m_tc_output_torque;            // averaged over the last step
+  double m_slippage;
+  double m_output_torque;               // at the driveshaft, averaged over the last step
 };
 
 
@@ -0,0 +1,174 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Shift maps and gear shift scheduling for automatic transmissions.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "core/ChMathematics.h"
+
+#include "subsys/powertrain/ChShiftMap.h"
+#include "subsys/ChJsonCache.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+static const double s_rpm_to_radsec = CH_C_2PI / 60.;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShiftMap::ChShiftMap(double downshift_speed, double upshift_speed)
+: m_threshold(0.05)
+{
+  AddUpshiftPoint(1, 0, upshift_speed);
+  AddDownshiftPoint(1, 0, downshift_speed);
+}
+
+ChShiftMap::ChShiftMap(const std::string& filename)
+: m_threshold(0.05)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  Create(d);
+}
+
+ChShiftMap::ChShiftMap(const rapidjson::Value& v)
+: m_threshold(0.05)
+{
+  Create(v);
+}
+
+void ChShiftMap::Create(const rapidjson::Value& v)
+{
+  if (v.HasMember("Throttle Threshold"))
+    m_threshold = v["Throttle Threshold"].GetDouble();
+
+  assert(v.HasMember("Gears"));
+  const Value& gears = v["Gears"];
+  assert(gears.IsArray() && gears.Size() > 0);
+
+  for (SizeType i = 0; i < gears.Size(); i++) {
+    const Value& up = gears[i]["Upshift"];
+    const Value& down = gears[i]["Downshift"];
+    assert(up.IsArray() && down.IsArray());
+    for (SizeType j = 0; j < up.Size(); j++)
+      AddUpshiftPoint(i + 1, up[j][0u].GetDouble(), up[j][1u].GetDouble() * s_rpm_to_radsec);
+    for (SizeType j = 0; j < down.Size(); j++)
+      AddDownshiftPoint(i + 1, down[j][0u].GetDouble(), down[j][1u].GetDouble() * s_rpm_to_radsec);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShiftMap::Gear& ChShiftMap::gear_curves(int gear)
+{
+  assert(gear >= 1);
+  if (gear > (int)m_gears.size())
+    m_gears.resize(gear);
+  return m_gears[gear - 1];
+}
+
+void ChShiftMap::AddUpshiftPoint(int gear, double throttle, double speed)
+{
+  std::vector<Point>& curve = gear_curves(gear).up;
+  assert(curve.empty() || throttle > curve.back().throttle);
+  curve.push_back(Point(throttle, speed));
+}
+
+void ChShiftMap::AddDownshiftPoint(int gear, double throttle, double speed)
+{
+  std::vector<Point>& curve = gear_curves(gear).down;
+  assert(curve.empty() || throttle > curve.back().throttle);
+  curve.push_back(Point(throttle, speed));
+}
+
+
+// -----------------------------------------------------------------------------
+// A gear without an upshift (downshift) curve never shifts up (down).
+// -----------------------------------------------------------------------------
+double ChShiftMap::interpolate(const std::vector<Point>& curve, double throttle)
+{
+  if (throttle <= curve.front().throttle)
+    return curve.front().speed;
+  if (throttle >= curve.back().throttle)
+    return curve.back().speed;
+
+  size_t i = 1;
+  while (curve[i].throttle < throttle)
+    i++;
+
+  const Point& p0 = curve[i - 1];
+  const Point& p1 = curve[i];
+  return p0.speed + (throttle - p0.throttle) * (p1.speed - p0.speed) / (p1.throttle - p0.throttle);
+}
+
+void ChShiftMap::GetShiftSpeeds(int     gear,
+                                double  throttle,
+                                double& downshift_speed,
+                                double& upshift_speed) const
+{
+  assert(gear >= 1 && !m_gears.empty());
+
+  const Gear& curves = m_gears[std::min(gear, (int)m_gears.size()) - 1];
+
+  downshift_speed = curves.down.empty() ? -HUGE_VAL : interpolate(curves.down, throttle);
+  upshift_speed = curves.up.empty() ? HUGE_VAL : interpolate(curves.up, throttle);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShiftScheduler::ChShiftScheduler()
+: m_gear(-1),
+  m_throttle(0),
+  m_downshift_speed(0),
+  m_upshift_speed(0),
+  m_num_evaluations(0)
+{
+}
+
+void ChShiftScheduler::SetShiftMap(ChSharedPtr<ChShiftMap> map)
+{
+  m_map = map;
+  m_gear = -1;
+}
+
+int ChShiftScheduler::GetGear(int gear, int num_gears, double throttle, double speed)
+{
+  assert(m_map);
+
+  if (gear != m_gear || std::abs(throttle - m_throttle) > m_map->GetThrottleThreshold()) {
+    m_map->GetShiftSpeeds(gear, throttle, m_downshift_speed, m_upshift_speed);
+    m_gear = gear;
+    m_throttle = throttle;
+    m_num_evaluations++;
+  }
+
+  if (speed > m_upshift_speed && gear < num_gears)
+    return gear + 1;
+  if (speed < m_downshift_speed && gear > 1)
+    return gear - 1;
+  return gear;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,154 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Shift maps and gear shift scheduling for automatic transmissions.
+//
+// A shift map specifies, for each forward gear, the transmission input speeds
+// above which the transmission shifts up and below which it shifts down, as
+// piecewise linear functions of the throttle. A shift map is read-only and can
+// be shared by several powertrains; each powertrain owns a ChShiftScheduler,
+// which caches the shift speeds for the current gear and throttle and only
+// re-evaluates them after a gear change or a throttle change larger than a
+// threshold.
+//
+// A shift map is specified in JSON as follows (speeds in RPM; gears listed in
+// order, starting with the 1st gear; gears not listed use the last entry):
+//
+//   {
+//     "Throttle Threshold": 0.05,
+//     "Gears":
+//     [
+//       { "Upshift": [[0, 1800], [1, 2500]], "Downshift": [[0, 1000], [1, 1500]] },
+//       ...
+//     ]
+//   }
+//
+// =============================================================================
+
+#ifndef CH_SHIFTMAP_H
+#define CH_SHIFTMAP_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Throttle dependent shift speeds of the forward gears.
+///
+class CH_SUBSYS_API ChShiftMap : public ChShared
+{
+public:
+
+  /// Create a shift map with the same (throttle independent) shift speeds,
+  /// in rad/s, for all gears.
+  ChShiftMap(double downshift_speed, double upshift_speed);
+
+  /// Create a shift map from the specified JSON file.
+  ChShiftMap(const std::string& filename);
+
+  /// Create a shift map from the specified JSON object.
+  ChShiftMap(const rapidjson::Value& v);
+
+  ~ChShiftMap() {}
+
+  /// Add a point (throttle, speed) to the upshift curve of the specified
+  /// forward gear (1, 2, ...). Points must be added in increasing throttle order.
+  void AddUpshiftPoint(int gear, double throttle, double speed);
+
+  /// Add a point (throttle, speed) to the downshift curve of the specified
+  /// forward gear (1, 2, ...). Points must be added in increasing throttle order.
+  void AddDownshiftPoint(int gear, double throttle, double speed);
+
+  /// Set the minimum throttle change that triggers a re-evaluation of the
+  /// shift speeds (default: 0.05).
+  void SetThrottleThreshold(double threshold) { m_threshold = threshold; }
+  double GetThrottleThreshold() const { return m_threshold; }
+
+  /// Evaluate the shift speeds of the specified forward gear at the specified
+  /// throttle.
+  void GetShiftSpeeds(
+    int     gear,             ///< [in] forward gear (1, 2, ...)
+    double  throttle,         ///< [in] throttle [0,1]
+    double& downshift_speed,  ///< [out] speed below which to shift down
+    double& upshift_speed     ///< [out] speed above which to shift up
+    ) const;
+
+private:
+
+  struct Point {
+    Point(double t, double s) : throttle(t), speed(s) {}
+    double throttle;
+    double speed;
+  };
+
+  struct Gear {
+    std::vector<Point> up;
+    std::vector<Point> down;
+  };
+
+  void Create(const rapidjson::Value& v);
+
+  Gear& gear_curves(int gear);
+
+  static double interpolate(const std::vector<Point>& curve, double throttle);
+
+  double             m_threshold;
+  std::vector<Gear>  m_gears;       // indexed by forward gear - 1
+};
+
+///
+/// Gear shift decisions of one transmission, based on a shared shift map.
+///
+class CH_SUBSYS_API ChShiftScheduler
+{
+public:
+
+  ChShiftScheduler();
+
+  /// Set the shift map.
+  void SetShiftMap(ChSharedPtr<ChShiftMap> map);
+  ChSharedPtr<ChShiftMap> GetShiftMap() const { return m_map; }
+
+  /// Return the forward gear to select, given the current forward gear, the
+  /// number of forward gears, the throttle and the transmission input speed.
+  /// The shift speeds are only re-evaluated if the gear changed or the
+  /// throttle changed by more than the threshold of the shift map.
+  int GetGear(int gear, int num_gears, double throttle, double speed);
+
+  /// Return the number of evaluations of the shift map so far.
+  long GetNumEvaluations() const { return m_num_evaluations; }
+
+private:
+
+  ChSharedPtr<ChShiftMap>  m_map;
+
+  int     m_gear;            // gear and throttle at the last evaluation
+  double  m_throttle;
+  double  m_downshift_speed;
+  double  m_upshift_speed;
+  long    m_num_evaluations;
+};
+
+
+} // end namespace chrono
+
+
+#endif
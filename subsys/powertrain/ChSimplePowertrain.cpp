@@ -72,5 +72,28 @@ void ChSimplePowertrain::Update(double time,
   m_shaftTorque = m_motorTorque / m_current_gear_ratio;
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSimplePowertrain::SaveState(vehicle::ChVehicleState& state) const
+{
+  ChPowertrain::SaveState(state);
+
+  state.BeginBlock(3);
+  state.Write(m_motorSpeed);
+  state.Write(m_motorTorque);
+  state.Write(m_shaftTorque);
+}
+
+bool ChSimplePowertrain::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!ChPowertrain::RestoreState(state) || !state.OpenBlock(3, "SimplePowertrain"))
+    return false;
+
+  m_motorSpeed = state.Read();
+  m_motorTorque = state.Read();
+  m_shaftTorque = state.Read();
+  return true;
+}
+
 
 } // end namespace chrono
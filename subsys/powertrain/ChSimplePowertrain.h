@@ -86,6 +86,13 @@ public:
   /// This function does nothing for this simplified powertrain model.
   virtual void Advance(double step) {}
 
+  /// Append the drive mode and the current motor speed and torques to the
+  /// specified snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the drive mode and the motor speed and torques from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
 protected:
 
   /// Return the forward gear ratio (single gear transmission)
@@ -0,0 +1,113 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static map-based powertrain model, specified through a JSON file.
+//
+// =============================================================================
+
+#include "physics/ChGlobal.h"
+
+#include "subsys/powertrain/MapPowertrain.h"
+#include "subsys/ChJsonCache.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+static const double rpm_to_radsec = CH_C_2PI / 60.;
+
+
+MapPowertrain::MapPowertrain(const std::string& filename)
+: m_key("MapPowertrain:" + filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  Create(d);
+}
+
+// Without a file name, the tables are not shared.
+MapPowertrain::MapPowertrain(const rapidjson::Document& d)
+{
+  Create(d);
+}
+
+void MapPowertrain::Create(const rapidjson::Document& d)
+{
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  // Read transmission data
+  assert(d.HasMember("Gear Ratios"));
+  m_gear_ratios.push_back(d["Gear Ratios"]["Reverse"].GetDouble());
+  const Value& fwd = d["Gear Ratios"]["Forward"];
+  assert(fwd.IsArray());
+  for (SizeType i = 0; i < fwd.Size(); i++)
+    m_gear_ratios.push_back(fwd[i].GetDouble());
+
+  if (d.HasMember("Shift Map"))
+    SetShiftMap(ChSharedPtr<ChShiftMap>(new ChShiftMap(d["Shift Map"])));
+
+  // Read maps
+  ReadMap(d["Engine Torque Map"], rpm_to_radsec, m_engine_torque);
+  ReadMap(d["Engine Losses Map"], rpm_to_radsec, m_engine_losses);
+  ReadMap(d["Capacity Factor Map"], 1, m_capacity_factor);
+  ReadMap(d["Torque Ratio Map"], 1, m_torque_ratio);
+}
+
+void MapPowertrain::ReadMap(const rapidjson::Value& a, double x_scale, std::vector<MapPoint>& map)
+{
+  assert(a.IsArray());
+  for (SizeType i = 0; i < a.Size(); i++) {
+    assert(a[i].IsArray() && a[i].Size() == 2);
+    map.push_back(MapPoint(x_scale * a[i][0u].GetDouble(), a[i][1u].GetDouble()));
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void MapPowertrain::SetGearRatios(std::vector<double>& gear_ratios)
+{
+  gear_ratios = m_gear_ratios;
+}
+
+void MapPowertrain::SetEngineTorqueMap(ChSharedPtr<ChFunction_Recorder>& map)
+{
+  for (size_t i = 0; i < m_engine_torque.size(); i++)
+    map->AddPoint(m_engine_torque[i].x, m_engine_torque[i].y);
+}
+
+void MapPowertrain::SetEngineLossesMap(ChSharedPtr<ChFunction_Recorder>& map)
+{
+  for (size_t i = 0; i < m_engine_losses.size(); i++)
+    map->AddPoint(m_engine_losses[i].x, m_engine_losses[i].y);
+}
+
+void MapPowertrain::SetTorqueConverterCapacityFactorMap(ChSharedPtr<ChFunction_Recorder>& map)
+{
+  for (size_t i = 0; i < m_capacity_factor.size(); i++)
+    map->AddPoint(m_capacity_factor[i].x, m_capacity_factor[i].y);
+}
+
+void MapPowertrain::SetTorqeConverterTorqueRatioMap(ChSharedPtr<ChFunction_Recorder>& map)
+{
+  for (size_t i = 0; i < m_torque_ratio.size(); i++)
+    map->AddPoint(m_torque_ratio[i].x, m_torque_ratio[i].y);
+}
+
+
+}  // end namespace chrono
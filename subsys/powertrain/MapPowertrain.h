@@ -0,0 +1,77 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static map-based powertrain model, specified through a JSON file.
+// Engine speeds in the JSON file are given in RPM. The optional "Shift Map"
+// object is read by ChShiftMap.
+//
+// =============================================================================
+
+#ifndef MAP_POWERTRAIN_H
+#define MAP_POWERTRAIN_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/powertrain/ChMapPowertrain.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+
+class CH_SUBSYS_API MapPowertrain : public ChMapPowertrain
+{
+public:
+
+  MapPowertrain(const std::string& filename);
+  MapPowertrain(const rapidjson::Document& d);
+  ~MapPowertrain() {}
+
+  virtual void SetGearRatios(std::vector<double>& gear_ratios);
+
+  virtual void SetEngineTorqueMap(ChSharedPtr<ChFunction_Recorder>& map);
+  virtual void SetEngineLossesMap(ChSharedPtr<ChFunction_Recorder>& map);
+  virtual void SetTorqueConverterCapacityFactorMap(ChSharedPtr<ChFunction_Recorder>& map);
+  virtual void SetTorqeConverterTorqueRatioMap(ChSharedPtr<ChFunction_Recorder>& map);
+
+  /// The maps depend on the JSON specification; tables are shared by all
+  /// powertrains created from the same file.
+  virtual std::string GetMapsKey() const { return m_key; }
+
+private:
+
+  struct MapPoint {
+    MapPoint(double x_, double y_) : x(x_), y(y_) {}
+    double x;
+    double y;
+  };
+
+  void Create(const rapidjson::Document& d);
+
+  static void ReadMap(const rapidjson::Value& a, double x_scale, std::vector<MapPoint>& map);
+
+  std::string            m_key;
+
+  std::vector<double>    m_gear_ratios;         // reverse, then forward gears
+
+  std::vector<MapPoint>  m_engine_torque;       // (speed, torque)
+  std::vector<MapPoint>  m_engine_losses;       // (speed, torque)
+  std::vector<MapPoint>  m_capacity_factor;     // (speed ratio, capacity factor)
+  std::vector<MapPoint>  m_torque_ratio;        // (speed ratio, torque ratio)
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -19,8 +19,7 @@
 #include "physics/ChGlobal.h"
 
 #include "subsys/powertrain/SimplePowertrain.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
 
 using namespace rapidjson;
 
@@ -31,15 +30,7 @@ namespace chrono {
 // -----------------------------------------------------------------------------
 SimplePowertrain::SimplePowertrain(const std::string& filename)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -17,12 +17,16 @@
 //
 // =============================================================================
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "assets/ChCylinderShape.h"
 #include "assets/ChColorAsset.h"
 
 #include "subsys/steering/ChPitmanArm.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -64,6 +68,8 @@ void ChPitmanArm::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
                              const ChVector<>&         location,
                              const ChQuaternion<>&     rotation)
 {
+  CH_STARTUP_SCOPE("ChPitmanArm::Initialize");
+
   // Express the steering reference frame in the absolute coordinate system.
   ChFrame<> steering_to_abs(location, rotation);
   steering_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
@@ -96,6 +102,13 @@ void ChPitmanArm::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
   AddVisualizationSteeringLink(m_link, points[UNIV], points[REVSPH_S], points[TIEROD_PA], points[TIEROD_IA], getSteeringLinkRadius());
   chassis->GetSystem()->AddBody(m_link);
 
+  // In kinematic mode, lock the steering link to the chassis and skip the
+  // Pitman arm and the linkage joints.
+  if (m_kinematic) {
+    InitializeKinematicMode(chassis);
+    return;
+  }
+
   // Initialize the Pitman arm body
   m_arm->SetPos(points[PITMANARM]);
   m_arm->SetRot(steering_to_abs.GetRot());
@@ -147,11 +160,91 @@ void ChPitmanArm::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
 // -----------------------------------------------------------------------------
 void ChPitmanArm::Update(double time, double steering)
 {
+  if (m_kinematic) {
+    UpdateKinematicMode(steering);
+    return;
+  }
+
   if (ChSharedPtr<ChFunction_Const> fun = m_revolute->Get_rot_funct().DynamicCastTo<ChFunction_Const>())
     fun->Set_yconst(getMaxAngle() * steering);
 }
 
 
+// -----------------------------------------------------------------------------
+// Kinematics of the linkage, in the steering frame. For the Pitman arm rotation
+// corresponding to the steering input, the idler arm angle is found (Newton
+// iterations from the design configuration) such that the distance between the
+// universal joint and the spherical joint of the idler arm is preserved. The
+// twist of the steering link about the line through these two points is then
+// found from the universal joint condition (orthogonal cross axes), taking the
+// solution closest to the design configuration.
+// -----------------------------------------------------------------------------
+ChCoordsys<> ChPitmanArm::GetSteeringLinkMotion(double steering)
+{
+  ChVector<> pt_rev = getLocation(REV);
+  ChVector<> pt_univ = getLocation(UNIV);
+  ChVector<> pt_revsph_r = getLocation(REVSPH_R);
+  ChVector<> pt_revsph_s = getLocation(REVSPH_S);
+  ChVector<> pt_link = getLocation(STEERINGLINK);
+
+  // Pitman arm rotation, universal joint location and arm-side cross axis.
+  ChQuaternion<> arm_rot = Q_from_AngAxis(steering * getMaxAngle(), getDirection(REV_AXIS));
+  ChVector<> univ = pt_rev + arm_rot.Rotate(pt_univ - pt_rev);
+  ChVector<> arm_axis = arm_rot.Rotate(getDirection(UNIV_AXIS_ARM));
+
+  // Idler arm angle and location of its spherical joint.
+  ChVector<> idler_axis = getDirection(REVSPH_AXIS);
+  double length = (pt_revsph_s - pt_univ).Length();
+  double phi = 0;
+  ChVector<> revsph = pt_revsph_s;
+
+  for (int iter = 0; iter < 20; iter++) {
+    revsph = pt_revsph_r + Q_from_AngAxis(phi, idler_axis).Rotate(pt_revsph_s - pt_revsph_r);
+    ChVector<> d = revsph - univ;
+    double f = d.Length() - length;
+    double df = Vdot(d, Vcross(idler_axis, revsph - pt_revsph_r)) / d.Length();
+    if (std::abs(f) < 1e-12 || df == 0)
+      break;
+    phi -= f / df;
+  }
+
+  // Smallest rotation taking the design direction univ->revsph to the current one.
+  ChVector<> e0 = pt_revsph_s - pt_univ;
+  ChVector<> e1 = revsph - univ;
+  e0.Normalize();
+  e1.Normalize();
+  ChVector<> n = Vcross(e0, e1);
+  double sin_a = n.Length();
+  ChQuaternion<> rot = QUNIT;
+  if (sin_a > 1e-12)
+    rot = Q_from_AngAxis(std::atan2(sin_a, Vdot(e0, e1)), n * (1 / sin_a));
+
+  // Twist psi about e1 such that the link-side cross axis stays orthogonal to
+  // the arm-side cross axis: A + B cos(psi) + C sin(psi) = 0.
+  ChVector<> y = rot.Rotate(getDirection(UNIV_AXIS_LINK));
+  ChVector<> y_perp = y - e1 * Vdot(e1, y);
+  double A = Vdot(arm_axis, e1) * Vdot(e1, y);
+  double B = Vdot(arm_axis, y_perp);
+  double C = Vdot(arm_axis, Vcross(e1, y_perp));
+  double R = std::sqrt(B * B + C * C);
+
+  double psi = 0;
+  if (R > 0) {
+    double delta = std::atan2(C, B);
+    double alpha = std::acos(std::min(std::max(-A / R, -1.0), 1.0));
+    double psi1 = std::atan2(std::sin(delta + alpha), std::cos(delta + alpha));
+    double psi2 = std::atan2(std::sin(delta - alpha), std::cos(delta - alpha));
+    psi = (std::abs(psi1) < std::abs(psi2)) ? psi1 : psi2;
+  }
+  rot = Q_from_AngAxis(psi, e1) * rot;
+
+  // The steering link rotates rigidly about the universal joint.
+  ChVector<> pos = univ + rot.Rotate(pt_link - pt_univ) - pt_link;
+
+  return ChCoordsys<>(pos, rot);
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChPitmanArm::AddVisualizationPitmanArm(ChSharedPtr<ChBody> arm,
@@ -167,11 +260,11 @@ void ChPitmanArm::AddVisualizationPitmanArm(ChSharedPtr<ChBody> arm,
   cyl->GetCylinderGeometry().p1 = p_C;
   cyl->GetCylinderGeometry().p2 = p_L;
   cyl->GetCylinderGeometry().rad = radius;
-  arm->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(arm, cyl);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.7f, 0.7f, 0.2f));
-  arm->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(arm, col);
 }
 
 void ChPitmanArm::AddVisualizationSteeringLink(ChSharedPtr<ChBody> link,
@@ -191,30 +284,50 @@ void ChPitmanArm::AddVisualizationSteeringLink(ChSharedPtr<ChBody> link,
   cyl->GetCylinderGeometry().p1 = p_P;
   cyl->GetCylinderGeometry().p2 = p_I;
   cyl->GetCylinderGeometry().rad = radius;
-  link->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(link, cyl);
 
   ChSharedPtr<ChCylinderShape> cyl_P(new ChCylinderShape);
   cyl_P->GetCylinderGeometry().p1 = p_P;
   cyl_P->GetCylinderGeometry().p2 = p_TP;
   cyl_P->GetCylinderGeometry().rad = radius;
-  link->AddAsset(cyl_P);
+  vehicle::ChDeferredAssets::AddAsset(link, cyl_P);
 
   ChSharedPtr<ChCylinderShape> cyl_I(new ChCylinderShape);
   cyl_I->GetCylinderGeometry().p1 = p_I;
   cyl_I->GetCylinderGeometry().p2 = p_TI;
   cyl_I->GetCylinderGeometry().rad = radius;
-  link->AddAsset(cyl_I);
+  vehicle::ChDeferredAssets::AddAsset(link, cyl_I);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.7f, 0.7f));
-  link->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(link, col);
 }
 
 
+// -----------------------------------------------------------------------------
+// In kinematic mode, only the lock of the steering link is in the system.
+// -----------------------------------------------------------------------------
+void ChPitmanArm::GetConstraints(std::vector<ChLink*>& links) const
+{
+  if (m_kinematic) {
+    ChSteering::GetConstraints(links);
+    return;
+  }
+
+  links.push_back(m_revolute.get_ptr());
+  links.push_back(m_revsph.get_ptr());
+  links.push_back(m_universal.get_ptr());
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChPitmanArm::LogConstraintViolations()
 {
+  if (m_kinematic) {
+    LogKinematicModeViolations();
+    return;
+  }
+
   // Revolute joint
   {
     ChMatrix<>* C = m_revolute->GetC();
@@ -21,6 +21,10 @@
 // When attached to a chassis, both an offset and a rotation (as a quaternion)
 // are provided.
 //
+// In kinematic mode, the Pitman arm body and the linkage joints are not created
+// and the steering link is locked to the chassis with the pose given by the
+// linkage kinematics for the current steering input.
+//
 // =============================================================================
 
 #ifndef CH_PITMANARM_H
@@ -74,6 +78,9 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations();
 
+  /// Append the joints of this steering subsystem to the specified list.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
 protected:
 
   /// Identifiers for the various hardpoints.
@@ -123,6 +130,10 @@ protected:
   /// Return the maximum rotation angle of the revolute joint.
   virtual double getMaxAngle() const = 0;
 
+  /// Return the pose of the steering link for the specified steering input,
+  /// from the kinematics of the linkage (kinematic mode).
+  virtual ChCoordsys<> GetSteeringLinkMotion(double steering);
+
   ChSharedPtr<ChBody>                  m_arm;        ///< handle to the Pitman arm body
 
   ChSharedPtr<ChLinkEngine>            m_revolute;   ///< handle to the chassis-arm revolute joint
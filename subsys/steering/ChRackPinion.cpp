@@ -30,6 +30,8 @@
 #include "assets/ChTexture.h"
 
 #include "subsys/steering/ChRackPinion.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -60,6 +62,8 @@ void ChRackPinion::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
                               const ChVector<>&         location,
                               const ChQuaternion<>&     rotation)
 {
+  CH_STARTUP_SCOPE("ChRackPinion::Initialize");
+
   // Express the steering reference frame in the absolute coordinate system.
   ChFrame<> steering_to_abs(location, rotation);
   steering_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
@@ -74,6 +78,12 @@ void ChRackPinion::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
   AddVisualizationSteeringLink();
   chassis->GetSystem()->AddBody(m_link);
 
+  // In kinematic mode, lock the rack to the chassis.
+  if (m_kinematic) {
+    InitializeKinematicMode(chassis);
+    return;
+  }
+
   // Initialize the prismatic joint between chassis and link.
   m_prismatic->Initialize(chassis, m_link, ChCoordsys<>(link_abs, steering_to_abs.GetRot() * Q_from_AngX(CH_C_PI_2)));
   chassis->GetSystem()->AddLink(m_prismatic);
@@ -96,6 +106,11 @@ void ChRackPinion::Initialize(ChSharedPtr<ChBodyAuxRef> chassis,
 // -----------------------------------------------------------------------------
 void ChRackPinion::Update(double time, double steering)
 {
+  if (m_kinematic) {
+    UpdateKinematicMode(steering);
+    return;
+  }
+
   // Convert the steering input into an angle of the pinion and then into a
   // displacement of the rack.
   double angle = steering * GetMaxAngle();
@@ -106,6 +121,17 @@ void ChRackPinion::Update(double time, double steering)
 }
 
 
+// -----------------------------------------------------------------------------
+// The rack translates along the Y axis of its initial frame.
+// -----------------------------------------------------------------------------
+ChCoordsys<> ChRackPinion::GetSteeringLinkMotion(double steering)
+{
+  double displ = steering * GetMaxAngle() * GetPinionRadius();
+
+  return ChCoordsys<>(ChVector<>(0, displ, 0), QUNIT);
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChRackPinion::AddVisualizationSteeringLink()
@@ -116,17 +142,36 @@ void ChRackPinion::AddVisualizationSteeringLink()
   cyl->GetCylinderGeometry().p1 = ChVector<>(0, length / 2, 0);
   cyl->GetCylinderGeometry().p2 = ChVector<>(0, -length / 2, 0);
   cyl->GetCylinderGeometry().rad = GetSteeringLinkRadius();
-  m_link->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(m_link, cyl);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.8f, 0.8f, 0.2f));
-  m_link->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(m_link, col);
+}
+
+// -----------------------------------------------------------------------------
+// In kinematic mode, only the lock of the steering link is in the system.
+// -----------------------------------------------------------------------------
+void ChRackPinion::GetConstraints(std::vector<ChLink*>& links) const
+{
+  if (m_kinematic) {
+    ChSteering::GetConstraints(links);
+    return;
+  }
+
+  links.push_back(m_prismatic.get_ptr());
+  links.push_back(m_actuator.get_ptr());
 }
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChRackPinion::LogConstraintViolations()
 {
+  if (m_kinematic) {
+    LogKinematicModeViolations();
+    return;
+  }
+
   // Translational joint
   {
     ChMatrix<>* C = m_prismatic->GetC();
@@ -21,6 +21,9 @@
 // pinion but instead use the implied rack-pinion constraint to calculate the
 // rack displacement from a given pinion rotation angle.
 //
+// In kinematic mode, the prismatic joint and the actuator are not created and
+// the rack is locked to the chassis with the imposed displacement.
+//
 // =============================================================================
 
 #ifndef CH_RACKPINION_H
@@ -73,6 +76,9 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations();
 
+  /// Append the joints of this steering subsystem to the specified list.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
 protected:
 
   /// Return the mass of the steering link.
@@ -96,6 +102,10 @@ protected:
   /// Return the maximum rotation angle of the pinion (in either direction).
   virtual double GetMaxAngle() const = 0;
 
+  /// Return the rack displacement for the specified steering input (kinematic
+  /// mode).
+  virtual ChCoordsys<> GetSteeringLinkMotion(double steering);
+
   ChSharedPtr<ChLinkLockPrismatic> m_prismatic;  ///< handle to the prismatic joint chassis-link
   ChSharedPtr<ChLinkLinActuator> m_actuator;     ///< handle to the linear actuator on steering link
 
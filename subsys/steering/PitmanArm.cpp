@@ -17,39 +17,20 @@
 // =============================================================================
 
 #include "subsys/steering/PitmanArm.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 PitmanArm::PitmanArm(const std::string& filename)
 : ChPitmanArm("")
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -99,6 +80,10 @@ void PitmanArm::Create(const rapidjson::Document& d)
   // Read data for tireod connection points
   m_points[TIEROD_PA] = loadVector(d["Tierod Locations"]["Pitman Side"]);
   m_points[TIEROD_IA] = loadVector(d["Tierod Locations"]["Idler Side"]);
+
+  // Optional kinematic mode (no steering linkage)
+  if (d.HasMember("Kinematic Mode"))
+    SetKinematicMode(d["Kinematic Mode"].GetBool());
 }
 
 
@@ -17,39 +17,20 @@
 // =============================================================================
 
 #include "subsys/steering/RackPinion.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 RackPinion::RackPinion(const std::string& filename)
 : ChRackPinion("")
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -79,6 +60,10 @@ void RackPinion::Create(const rapidjson::Document& d)
   // Pinion radius
   m_pinionRadius = d["Pinion"]["Radius"].GetDouble();
   m_maxAngle = d["Pinion"]["Maximum Angle"].GetDouble();
+
+  // Optional kinematic mode (no steering linkage)
+  if (d.HasMember("Kinematic Mode"))
+    SetKinematicMode(d["Kinematic Mode"].GetBool());
 }
 
 
@@ -29,6 +29,10 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/suspension/ChDoubleWishbone.h"
+#include "subsys/suspension/ChSpringForceT.h"
+#include "subsys/suspension/ChSpringForceBank.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -57,44 +61,6 @@ const std::string ChDoubleWishbone::m_pointNames[] = {
 };
 
 
-// -----------------------------------------------------------------------------
-// Default shock and spring functors (used for linear elements)
-// -----------------------------------------------------------------------------
-class LinearSpringForce : public ChSpringForceCallback
-{
-public:
-  LinearSpringForce(double k) : m_k(k) {}
-
-  virtual double operator()(double time,         // current time
-                            double rest_length,  // undeformed length
-                            double length,       // current length
-                            double vel)          // current velocity (positive when extending)
-  {
-    return -m_k * (length - rest_length);
-  }
-
-private:
-  double  m_k;
-};
-
-class LinearShockForce : public ChSpringForceCallback
-{
-public:
-  LinearShockForce(double c) : m_c(c) {}
-
-  virtual double operator()(double time,         // current time
-                            double rest_length,  // undeformed length
-                            double length,       // current length
-                            double vel)          // current velocity (positive when extending)
-  {
-    return -m_c * vel;
-  }
-
-private:
-  double  m_c;
-};
-
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ChDoubleWishbone::ChDoubleWishbone(const std::string& name)
@@ -176,37 +142,55 @@ void ChDoubleWishbone::Initialize(ChSharedPtr<ChBodyAuxRef>  chassis,
                                   const ChVector<>&          location,
                                   ChSharedPtr<ChBody>        tierod_body)
 {
+  CH_STARTUP_SCOPE("ChDoubleWishbone::Initialize");
+
   // Set the shock and spring force callbacks (use the user-provided functor if
-  // a nonlinear element was specified; otherwise, use the default functor).
+  // a nonlinear element was specified; otherwise, use the tabulated curve, if
+  // one was provided, or the default linear functor).
   m_nonlinearShock = useNonlinearShock();
   m_nonlinearSpring = useNonlinearSpring();
-  m_shockCB = m_nonlinearShock ? getShockForceCallback() : new LinearShockForce(getDampingCoefficient());
-  m_springCB = m_nonlinearSpring ? getSpringForceCallback() : new LinearSpringForce(getSpringCoefficient());
+  m_shockCurve = m_nonlinearShock ? ChSharedPtr<ChForceCurve>() : getShockForceCurve();
+  m_springCurve = m_nonlinearSpring ? ChSharedPtr<ChForceCurve>() : getSpringForceCurve();
+
+  if (m_nonlinearShock)
+    m_shockCB = getShockForceCallback();
+  else if (!m_shockCurve.IsNull())
+    m_shockCB = new ChSpringForceT<ChForceCurveLaw>(ChForceCurveLaw(m_shockCurve));
+  else
+    m_shockCB = new ChSpringForceT<ChLinearShockLaw>(ChLinearShockLaw(getDampingCoefficient()));
+
+  if (m_nonlinearSpring)
+    m_springCB = getSpringForceCallback();
+  else if (!m_springCurve.IsNull())
+    m_springCB = new ChSpringForceT<ChForceCurveLaw>(ChForceCurveLaw(m_springCurve));
+  else
+    m_springCB = new ChSpringForceT<ChLinearSpringLaw>(ChLinearSpringLaw(getSpringCoefficient()));
 
   // Express the suspension reference frame in the absolute coordinate system.
   ChFrame<> suspension_to_abs(location);
   suspension_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
 
   // Transform all points to absolute frame and initialize left side.
-  std::vector<ChVector<> > points(NUM_POINTS);
-
-  for (int i = 0; i < NUM_POINTS; i++) {
-    ChVector<> rel_pos = getLocation(static_cast<PointId>(i));
-    points[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
-  }
+  ChSharedPtr<ChHardpointTable> table = getHardpointTable();
+  std::vector<ChVector<> > points;
 
+  table->Transform(suspension_to_abs, LEFT, points);
   InitializeSide(LEFT, chassis, tierod_body, points);
 
   // Transform all points to absolute frame and initialize right side.
-  for (int i = 0; i < NUM_POINTS; i++) {
-    ChVector<> rel_pos = getLocation(static_cast<PointId>(i));
-    rel_pos.y = -rel_pos.y;
-    points[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
-  }
-
+  table->Transform(suspension_to_abs, RIGHT, points);
   InitializeSide(RIGHT, chassis, tierod_body, points);
 }
 
+ChSharedPtr<ChHardpointTable> ChDoubleWishbone::getHardpointTable()
+{
+  ChSharedPtr<ChHardpointTable> table(new ChHardpointTable(NUM_POINTS));
+  for (int i = 0; i < NUM_POINTS; i++)
+    table->SetPoint(i, getLocation(static_cast<PointId>(i)));
+
+  return table;
+}
+
 void ChDoubleWishbone::InitializeSide(ChVehicleSide                   side,
                                       ChSharedPtr<ChBodyAuxRef>       chassis,
                                       ChSharedPtr<ChBody>             tierod_body,
@@ -352,6 +336,21 @@ void ChDoubleWishbone::LogHardpointLocations(const ChVector<>& ref,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishbone::GetConstraints(std::vector<ChLink*>& links) const
+{
+  ChSuspension::GetConstraints(links);
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    links.push_back(m_revoluteLCA[side].get_ptr());
+    links.push_back(m_revoluteUCA[side].get_ptr());
+    links.push_back(m_sphericalLCA[side].get_ptr());
+    links.push_back(m_sphericalUCA[side].get_ptr());
+    links.push_back(m_distTierod[side].get_ptr());
+  }
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChDoubleWishbone::LogConstraintViolations(ChVehicleSide side)
@@ -407,6 +406,43 @@ void ChDoubleWishbone::LogConstraintViolations(ChVehicleSide side)
 
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishbone::AddSpringForceElements(ChSpringForceBank& bank)
+{
+  for (int side = LEFT; side <= RIGHT; side++) {
+    if (!m_shockCurve.IsNull())
+      bank.AddElement(m_shock[side], m_shockCurve);
+    if (!m_springCurve.IsNull())
+      bank.AddElement(m_spring[side], m_springCurve);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Tabulated curves are shared with the concrete suspension and updated in
+// place; the parameters of the linear laws are replaced in their callbacks.
+// -----------------------------------------------------------------------------
+void ChDoubleWishbone::UpdateParameters()
+{
+  for (int side = LEFT; side <= RIGHT; side++) {
+    m_spindle[side]->SetMass(getSpindleMass());
+    m_spindle[side]->SetInertiaXX(getSpindleInertia());
+    m_upright[side]->SetMass(getUprightMass());
+    m_upright[side]->SetInertiaXX(getUprightInertia());
+    m_UCA[side]->SetMass(getUCAMass());
+    m_UCA[side]->SetInertiaXX(getUCAInertia());
+    m_LCA[side]->SetMass(getLCAMass());
+    m_LCA[side]->SetInertiaXX(getLCAInertia());
+    m_axle[side]->SetInertia(getAxleInertia());
+    m_spring[side]->Set_SpringRestLength(getSpringRestLength());
+  }
+
+  if (!m_nonlinearShock && m_shockCurve.IsNull())
+    static_cast<ChSpringForceT<ChLinearShockLaw>*>(m_shockCB)->SetLaw(ChLinearShockLaw(getDampingCoefficient()));
+  if (!m_nonlinearSpring && m_springCurve.IsNull())
+    static_cast<ChSpringForceT<ChLinearSpringLaw>*>(m_springCB)->SetLaw(ChLinearSpringLaw(getSpringCoefficient()));
+}
+
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -425,17 +461,17 @@ void ChDoubleWishbone::AddVisualizationControlArm(ChSharedBodyPtr   arm,
   cyl_F->GetCylinderGeometry().p1 = p_F;
   cyl_F->GetCylinderGeometry().p2 = p_U;
   cyl_F->GetCylinderGeometry().rad = radius;
-  arm->AddAsset(cyl_F);
+  vehicle::ChDeferredAssets::AddAsset(arm, cyl_F);
 
   ChSharedPtr<ChCylinderShape> cyl_B(new ChCylinderShape);
   cyl_B->GetCylinderGeometry().p1 = p_B;
   cyl_B->GetCylinderGeometry().p2 = p_U;
   cyl_B->GetCylinderGeometry().rad = radius;
-  arm->AddAsset(cyl_B);
+  vehicle::ChDeferredAssets::AddAsset(arm, cyl_B);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.7f, 0.7f, 0.7f));
-  arm->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(arm, col);
 }
 
 
@@ -459,7 +495,7 @@ void ChDoubleWishbone::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_L->GetCylinderGeometry().p1 = p_L;
     cyl_L->GetCylinderGeometry().p2 = p_C;
     cyl_L->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_L);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_L);
   }
 
   if ((p_U - p_C).Length2() > threshold2) {
@@ -467,7 +503,7 @@ void ChDoubleWishbone::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_U->GetCylinderGeometry().p1 = p_U;
     cyl_U->GetCylinderGeometry().p2 = p_C;
     cyl_U->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_U);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_U);
   }
 
   if ((p_T - p_C).Length2() > threshold2) {
@@ -475,12 +511,12 @@ void ChDoubleWishbone::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_T->GetCylinderGeometry().p1 = p_T;
     cyl_T->GetCylinderGeometry().p2 = p_C;
     cyl_T->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_T);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_T);
   }
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.2f, 0.6f));
-  upright->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(upright, col);
 }
 
 void ChDoubleWishbone::AddVisualizationSpindle(ChSharedBodyPtr spindle,
@@ -491,7 +527,7 @@ void ChDoubleWishbone::AddVisualizationSpindle(ChSharedBodyPtr spindle,
   cyl->GetCylinderGeometry().p1 = ChVector<>(0, width / 2, 0);
   cyl->GetCylinderGeometry().p2 = ChVector<>(0, -width / 2, 0);
   cyl->GetCylinderGeometry().rad = radius;
-  spindle->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 }
 
 
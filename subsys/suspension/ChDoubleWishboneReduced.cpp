@@ -29,6 +29,8 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/suspension/ChDoubleWishboneReduced.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -90,6 +92,8 @@ void ChDoubleWishboneReduced::Initialize(ChSharedPtr<ChBodyAuxRef>  chassis,
                                          const ChVector<>&          location,
                                          ChSharedPtr<ChBody>        tierod_body)
 {
+  CH_STARTUP_SCOPE("ChDoubleWishboneReduced::Initialize");
+
   // Express the suspension reference frame in the absolute coordinate system.
   ChFrame<> suspension_to_abs(location);
   suspension_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
@@ -197,7 +201,7 @@ void ChDoubleWishboneReduced::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_L->GetCylinderGeometry().p1 = p_L;
     cyl_L->GetCylinderGeometry().p2 = p_C;
     cyl_L->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_L);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_L);
   }
 
   if ((p_U - p_C).Length2() > threshold2) {
@@ -205,7 +209,7 @@ void ChDoubleWishboneReduced::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_U->GetCylinderGeometry().p1 = p_U;
     cyl_U->GetCylinderGeometry().p2 = p_C;
     cyl_U->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_U);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_U);
   }
 
   if ((p_T - p_C).Length2() > threshold2) {
@@ -213,12 +217,12 @@ void ChDoubleWishboneReduced::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_T->GetCylinderGeometry().p1 = p_T;
     cyl_T->GetCylinderGeometry().p2 = p_C;
     cyl_T->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_T);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_T);
   }
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.2f, 0.6f));
-  upright->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(upright, col);
 }
 
 void ChDoubleWishboneReduced::AddVisualizationSpindle(ChSharedBodyPtr spindle,
@@ -229,10 +233,42 @@ void ChDoubleWishboneReduced::AddVisualizationSpindle(ChSharedBodyPtr spindle,
   cyl->GetCylinderGeometry().p1 = ChVector<>(0, width / 2, 0);
   cyl->GetCylinderGeometry().p2 = ChVector<>(0, -width / 2, 0);
   cyl->GetCylinderGeometry().rad = radius;
-  spindle->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishboneReduced::GetConstraints(std::vector<ChLink*>& links) const
+{
+  ChSuspension::GetConstraints(links);
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    links.push_back(m_distUCA_F[side].get_ptr());
+    links.push_back(m_distUCA_B[side].get_ptr());
+    links.push_back(m_distLCA_F[side].get_ptr());
+    links.push_back(m_distLCA_B[side].get_ptr());
+    links.push_back(m_distTierod[side].get_ptr());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishboneReduced::UpdateParameters()
+{
+  for (int side = LEFT; side <= RIGHT; side++) {
+    m_spindle[side]->SetMass(getSpindleMass());
+    m_spindle[side]->SetInertiaXX(getSpindleInertia());
+    m_upright[side]->SetMass(getUprightMass());
+    m_upright[side]->SetInertiaXX(getUprightInertia());
+    m_axle[side]->SetInertia(getAxleInertia());
+
+    m_shock[side]->Set_SpringK(getSpringCoefficient());
+    m_shock[side]->Set_SpringR(getDampingCoefficient());
+    m_shock[side]->Set_SpringRestLength(getSpringRestLength());
+  }
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChDoubleWishboneReduced::LogConstraintViolations(ChVehicleSide side)
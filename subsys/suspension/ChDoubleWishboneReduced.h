@@ -79,6 +79,12 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side);
 
+  /// Append the joints of this suspension (both sides) to the specified list.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
+  /// Apply the current masses, inertias and spring and shock coefficients.
+  virtual void UpdateParameters();
+
 protected:
 
   /// Identifiers for the various hardpoints.
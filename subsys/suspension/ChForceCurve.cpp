@@ -0,0 +1,223 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tabulated force curve for nonlinear spring and shock elements.
+//
+// =============================================================================
+
+#include <cassert>
+#include <map>
+
+#include "core/ChLog.h"
+
+#include "subsys/suspension/ChForceCurve.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChVehicleThreads.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Cache of the curves loaded from file. A curve is keyed by the file name and
+// is valid as long as the JSON cache returns the same document for that file.
+// -----------------------------------------------------------------------------
+struct ChForceCurveEntry {
+  const Document*            doc;
+  ChSharedPtr<ChForceCurve>  curve;
+};
+
+typedef std::map<std::string, ChForceCurveEntry> ChForceCurveMap;
+
+static vehicle::ChMutex  s_curves_mutex;
+static ChForceCurveMap   s_curves;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChForceCurve::ChForceCurve(double length_min,
+                           double length_max,
+                           int    num_lengths,
+                           double vel_min,
+                           double vel_max,
+                           int    num_vels)
+: m_lmin(length_min),
+  m_lscale(0),
+  m_vmin(vel_min),
+  m_vscale(0),
+  m_nl(num_lengths),
+  m_nv(num_vels)
+{
+  assert(m_nl >= 1 && m_nv >= 1);
+
+  if (m_nl > 1) {
+    assert(length_max > length_min);
+    m_lscale = (m_nl - 1) / (length_max - length_min);
+  }
+  if (m_nv > 1) {
+    assert(vel_max > vel_min);
+    m_vscale = (m_nv - 1) / (vel_max - vel_min);
+  }
+
+  m_imax = (m_nl > 1) ? m_nl - 2 : 0;
+  m_jmax = (m_nv > 1) ? m_nv - 2 : 0;
+  m_di = (m_nl > 1) ? m_nv : 0;
+  m_dj = (m_nv > 1) ? 1 : 0;
+
+  m_values.resize(m_nl * m_nv, 0.0);
+}
+
+void ChForceCurve::Assign(const ChForceCurve& other)
+{
+  m_lmin = other.m_lmin;
+  m_lscale = other.m_lscale;
+  m_vmin = other.m_vmin;
+  m_vscale = other.m_vscale;
+  m_nl = other.m_nl;
+  m_nv = other.m_nv;
+  m_imax = other.m_imax;
+  m_jmax = other.m_jmax;
+  m_di = other.m_di;
+  m_dj = other.m_dj;
+  m_values = other.m_values;
+}
+
+// -----------------------------------------------------------------------------
+// Batch evaluation. The loop has no dependencies between iterations, which lets
+// the compiler vectorize the interpolation.
+// -----------------------------------------------------------------------------
+void ChForceCurve::Evaluate(int n, const double* length, const double* vel, double* force) const
+{
+  for (int k = 0; k < n; k++)
+    force[k] = Evaluate(length[k], vel[k]);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+static bool loadRange(const Value& a, double& min, double& max)
+{
+  if (!a.IsArray() || a.Size() != 2)
+    return false;
+
+  min = a[0u].GetDouble();
+  max = a[1u].GetDouble();
+
+  return max > min;
+}
+
+ChSharedPtr<ChForceCurve> ChForceCurve::Create(const Value& d)
+{
+  if (!d.IsObject() || !d.HasMember("Force") || !d["Force"].IsArray() || d["Force"].Size() == 0) {
+    GetLog() << "ERROR: force curve without force values\n";
+    return ChSharedPtr<ChForceCurve>();
+  }
+
+  const Value& force = d["Force"];
+  bool has_length = d.HasMember("Length");
+  bool has_vel = d.HasMember("Velocity");
+
+  double lmin = 0, lmax = 0;
+  double vmin = 0, vmax = 0;
+  if ((has_length && !loadRange(d["Length"], lmin, lmax)) ||
+      (has_vel && !loadRange(d["Velocity"], vmin, vmax))) {
+    GetLog() << "ERROR: invalid force curve range\n";
+    return ChSharedPtr<ChForceCurve>();
+  }
+
+  // Grid size. A two-dimensional curve is given as an array of rows (one per
+  // length); a one-dimensional curve as a flat array.
+  int nl = 1;
+  int nv = 1;
+  if (has_length && has_vel) {
+    nl = (int)force.Size();
+    nv = force[0u].IsArray() ? (int)force[0u].Size() : 0;
+  }
+  else if (has_length)
+    nl = (int)force.Size();
+  else
+    nv = (int)force.Size();
+
+  if (nl == 0 || nv == 0 || (has_length && nl < 2) || (has_vel && nv < 2)) {
+    GetLog() << "ERROR: invalid force curve size\n";
+    return ChSharedPtr<ChForceCurve>();
+  }
+
+  ChSharedPtr<ChForceCurve> curve(new ChForceCurve(lmin, lmax, nl, vmin, vmax, nv));
+
+  for (int i = 0; i < nl; i++) {
+    for (int j = 0; j < nv; j++) {
+      const Value* v;
+      if (has_length && has_vel) {
+        const Value& row = force[(SizeType)i];
+        if (!row.IsArray() || (int)row.Size() != nv) {
+          GetLog() << "ERROR: force curve rows have different sizes\n";
+          return ChSharedPtr<ChForceCurve>();
+        }
+        v = &row[(SizeType)j];
+      }
+      else
+        v = &force[(SizeType)(i + j)];
+
+      if (!v->IsNumber()) {
+        GetLog() << "ERROR: invalid force curve value\n";
+        return ChSharedPtr<ChForceCurve>();
+      }
+      curve->SetValue(i, j, v->GetDouble());
+    }
+  }
+
+  return curve;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChForceCurve> ChForceCurve::Load(const std::string& filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  if (d.IsNull() || d.HasParseError()) {
+    GetLog() << "ERROR: cannot load force curve " << filename.c_str() << "\n";
+    return ChSharedPtr<ChForceCurve>();
+  }
+
+  vehicle::ChScopedLock lock(s_curves_mutex);
+
+  ChForceCurveMap::iterator it = s_curves.find(filename);
+  if (it != s_curves.end() && it->second.doc == &d)
+    return it->second.curve;
+
+  ChSharedPtr<ChForceCurve> curve = Create(d);
+
+  if (curve.IsNull()) {
+    GetLog() << "ERROR: invalid force curve " << filename.c_str() << "\n";
+    return curve;
+  }
+
+  ChForceCurveEntry entry;
+  entry.doc = &d;
+  entry.curve = curve;
+  s_curves[filename] = entry;
+
+  return curve;
+}
+
+void ChForceCurve::ClearCache()
+{
+  vehicle::ChScopedLock lock(s_curves_mutex);
+  s_curves.clear();
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,168 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tabulated force curve for nonlinear spring and shock elements.
+//
+// The force is tabulated on a uniform grid in the element length and velocity
+// (positive when extending) and bilinearly interpolated; outside the grid, the
+// values at the closest grid boundary are used. Either axis may be omitted, in
+// which case the force does not depend on that variable (e.g. a damper curve
+// given as a function of velocity only).
+//
+// A curve is specified in a JSON file of the form
+//
+//   {
+//     "Name":     "...",
+//     "Type":     "ForceCurve",
+//     "Template": "Tabulated",
+//     "Length":   [min, max],           (optional)
+//     "Velocity": [min, max],           (optional)
+//     "Force":    [[f_00, f_01, ...],   (one row per length, one column per
+//                  [f_10, f_11, ...],    velocity; a flat array if only one of
+//                  ...]                  the two axes is given)
+//   }
+//
+// Curves loaded from file are cached, so that all elements using the same file
+// share a single table.
+//
+// =============================================================================
+
+#ifndef CH_FORCECURVE_H
+#define CH_FORCECURVE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Force tabulated on a uniform grid in length and velocity.
+///
+class CH_SUBSYS_API ChForceCurve : public ChShared
+{
+public:
+
+  /// Construct a curve with all values set to zero.
+  /// An axis with a single point is ignored (its range is irrelevant).
+  ChForceCurve(
+    double  length_min,     ///< [in] lower bound of the length range
+    double  length_max,     ///< [in] upper bound of the length range
+    int     num_lengths,    ///< [in] number of grid points in length (>= 1)
+    double  vel_min,        ///< [in] lower bound of the velocity range
+    double  vel_max,        ///< [in] upper bound of the velocity range
+    int     num_vels        ///< [in] number of grid points in velocity (>= 1)
+    );
+
+  ~ChForceCurve() {}
+
+  /// Create a curve from the specified JSON object.
+  /// An error is reported and an empty handle returned if the data is invalid.
+  static ChSharedPtr<ChForceCurve> Create(const rapidjson::Value& d);
+
+  /// Load the curve from the specified JSON file, reusing a previously loaded
+  /// table if the file did not change. An error is reported and an empty handle
+  /// returned if the file cannot be loaded.
+  static ChSharedPtr<ChForceCurve> Load(const std::string& filename);
+
+  /// Delete all cached curves. Curves still referenced elsewhere stay alive.
+  static void ClearCache();
+
+  /// Replace the grid and the values of this curve with those of the
+  /// specified curve, so that all elements using this curve see the new
+  /// values.
+  void Assign(const ChForceCurve& other);
+
+  int GetNumLengths() const { return m_nl; }
+  int GetNumVelocities() const { return m_nv; }
+
+  /// Set the force at the specified grid point.
+  void SetValue(int i_length, int i_vel, double force) { m_values[i_length * m_nv + i_vel] = force; }
+
+  /// Get the force at the specified grid point.
+  double GetValue(int i_length, int i_vel) const { return m_values[i_length * m_nv + i_vel]; }
+
+  /// Evaluate the force at the specified length and velocity.
+  double Evaluate(double length, double vel) const
+  {
+    double x = (length - m_lmin) * m_lscale;
+    double y = (vel - m_vmin) * m_vscale;
+    if (x < 0) x = 0; else if (x > m_nl - 1) x = m_nl - 1;
+    if (y < 0) y = 0; else if (y > m_nv - 1) y = m_nv - 1;
+
+    int i = (int)x;
+    int j = (int)y;
+    if (i > m_imax) i = m_imax;
+    if (j > m_jmax) j = m_jmax;
+    double fx = x - i;
+    double fy = y - j;
+
+    const double* v = &m_values[i * m_nv + j];
+    double f0 = v[0] + fy * (v[m_dj] - v[0]);
+    double f1 = v[m_di] + fy * (v[m_di + m_dj] - v[m_di]);
+
+    return f0 + fx * (f1 - f0);
+  }
+
+  /// Evaluate the force at n points, given as arrays of lengths and velocities.
+  void Evaluate(int n, const double* length, const double* vel, double* force) const;
+
+  /// Return the memory used by the curve, in bytes.
+  size_t GetMemoryFootprint() const { return sizeof(*this) + m_values.capacity() * sizeof(double); }
+
+private:
+
+  double               m_lmin;
+  double               m_lscale;    // grid intervals per unit length (0 if a single point)
+  double               m_vmin;
+  double               m_vscale;    // grid intervals per unit velocity (0 if a single point)
+  int                  m_nl;
+  int                  m_nv;
+  int                  m_imax;      // largest lower cell index
+  int                  m_jmax;
+  int                  m_di;        // offsets to the next grid point (0 for a single point)
+  int                  m_dj;
+  std::vector<double>  m_values;    // row-major, m_nl x m_nv
+};
+
+///
+/// Force law evaluating a tabulated force curve (see ChSpringForceT).
+/// The rest length is ignored: the curve is tabulated in the element length.
+///
+struct ChForceCurveLaw
+{
+  explicit ChForceCurveLaw(ChSharedPtr<ChForceCurve> curve) : m_curve(curve) {}
+
+  double operator()(double time,         ///< current time
+                    double rest_length,  ///< undeformed length
+                    double length,       ///< current length
+                    double vel           ///< current velocity (positive when extending)
+                    ) const
+  {
+    return m_curve->Evaluate(length, vel);
+  }
+
+  ChSharedPtr<ChForceCurve>  m_curve;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,138 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Resolved hardpoint and mass-property table of a suspension specification.
+//
+// =============================================================================
+
+#include <map>
+
+#include "core/ChLog.h"
+
+#include "subsys/suspension/ChHardpointTable.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChVehicleThreads.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Cache of the tables created from file. A table is keyed by the file name and
+// is valid as long as the JSON cache returns the same document for that file.
+// -----------------------------------------------------------------------------
+struct ChHardpointEntry {
+  const Document*                doc;
+  ChSharedPtr<ChHardpointTable>  table;
+};
+
+typedef std::map<std::string, ChHardpointEntry> ChHardpointMap;
+
+static vehicle::ChMutex  s_hardpoints_mutex;
+static ChHardpointMap    s_hardpoints;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChHardpointTable::ChHardpointTable(int num_points, int num_dirs)
+: m_num_points(num_points),
+  m_num_dirs(num_dirs),
+  m_points(2 * num_points, ChVector<>(0, 0, 0)),
+  m_dirs(2 * num_dirs, ChVector<>(0, 0, 0)),
+  m_mass(num_points, 0.0),
+  m_inertia(num_points, ChVector<>(0, 0, 0))
+{
+}
+
+void ChHardpointTable::SetPoint(int point, const ChVector<>& pos)
+{
+  m_points[point] = pos;
+  m_points[m_num_points + point] = ChVector<>(pos.x, -pos.y, pos.z);
+}
+
+void ChHardpointTable::SetDirection(int dir, const ChVector<>& dir_vec)
+{
+  m_dirs[dir] = dir_vec;
+  m_dirs[m_num_dirs + dir] = ChVector<>(dir_vec.x, -dir_vec.y, dir_vec.z);
+}
+
+void ChHardpointTable::SetMassProperties(int point, double mass, const ChVector<>& inertia)
+{
+  m_mass[point] = mass;
+  m_inertia[point] = inertia;
+}
+
+bool ChHardpointTable::SameGeometry(const ChHardpointTable& other) const
+{
+  return m_points == other.m_points && m_dirs == other.m_dirs;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChHardpointTable::Transform(const ChFrame<>&          frame,
+                                 ChVehicleSide             side,
+                                 std::vector<ChVector<> >& points) const
+{
+  points.resize(m_num_points);
+
+  const ChVector<>* local = &m_points[side * m_num_points];
+  for (int i = 0; i < m_num_points; i++)
+    points[i] = frame.TransformLocalToParent(local[i]);
+}
+
+void ChHardpointTable::TransformDirections(const ChFrame<>&          frame,
+                                           ChVehicleSide             side,
+                                           std::vector<ChVector<> >& dirs) const
+{
+  dirs.resize(m_num_dirs);
+
+  const ChVector<>* local = m_num_dirs > 0 ? &m_dirs[side * m_num_dirs] : 0;
+  for (int i = 0; i < m_num_dirs; i++)
+    dirs[i] = frame.TransformDirectionLocalToParent(local[i]);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChHardpointTable> ChHardpointTable::Load(const std::string& filename, CreateFunction create)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  if (d.IsNull() || d.HasParseError()) {
+    GetLog() << "ERROR: cannot load suspension hardpoints " << filename.c_str() << "\n";
+    return ChSharedPtr<ChHardpointTable>();
+  }
+
+  vehicle::ChScopedLock lock(s_hardpoints_mutex);
+
+  ChHardpointMap::iterator it = s_hardpoints.find(filename);
+  if (it != s_hardpoints.end() && it->second.doc == &d)
+    return it->second.table;
+
+  ChHardpointEntry entry;
+  entry.doc = &d;
+  entry.table = create(d);
+  s_hardpoints[filename] = entry;
+
+  return entry.table;
+}
+
+void ChHardpointTable::ClearCache()
+{
+  vehicle::ChScopedLock lock(s_hardpoints_mutex);
+  s_hardpoints.clear();
+}
+
+
+} // end namespace chrono
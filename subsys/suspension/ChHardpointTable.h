@@ -0,0 +1,135 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Resolved hardpoint and mass-property table of a suspension specification.
+//
+// The table holds the hardpoints and directions of both sides, expressed in
+// the suspension reference frame (the right side mirrors the left one about
+// the x-z plane), and the mass and moments of inertia of the bodies, indexed
+// by the hardpoint of their center of mass. A suspension instance places its
+// hardpoints with a single pass over the table (see Transform()).
+//
+// Tables built from JSON specification files are cached, so that all
+// suspensions constructed from the same file share a single table and the
+// file is walked once. A table is keyed by the file name and is valid as long
+// as the JSON cache returns the same document for that file. Shared tables
+// must not be modified; a suspension that reloads its parameters replaces its
+// table instead.
+//
+// =============================================================================
+
+#ifndef CH_HARDPOINT_TABLE_H
+#define CH_HARDPOINT_TABLE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChFrame.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Hardpoints, directions and mass properties of a suspension, for both sides.
+///
+class CH_SUBSYS_API ChHardpointTable : public ChShared
+{
+public:
+
+  /// Function creating a table from a JSON specification document.
+  typedef ChSharedPtr<ChHardpointTable> (*CreateFunction)(const rapidjson::Document& d);
+
+  /// Construct a table with all entries set to zero.
+  ChHardpointTable(
+    int num_points,        ///< [in] number of hardpoints
+    int num_dirs = 0       ///< [in] number of directions
+    );
+
+  ~ChHardpointTable() {}
+
+  /// Load the table of the specified JSON file, reusing a previously created
+  /// table if the file did not change. Otherwise, the table is created with
+  /// the specified function, from the parsed file. An empty handle is returned
+  /// if the file cannot be loaded.
+  static ChSharedPtr<ChHardpointTable> Load(const std::string& filename, CreateFunction create);
+
+  /// Delete all cached tables. Tables still referenced elsewhere stay alive.
+  static void ClearCache();
+
+  int GetNumPoints() const { return m_num_points; }
+  int GetNumDirections() const { return m_num_dirs; }
+
+  /// Set the location of the specified hardpoint of the left side, in the
+  /// suspension reference frame. The right side is set to its mirror image.
+  void SetPoint(int point, const ChVector<>& pos);
+
+  /// Set the specified direction of the left side, in the suspension
+  /// reference frame. The right side is set to its mirror image.
+  void SetDirection(int dir, const ChVector<>& dir_vec);
+
+  /// Set the mass and the moments of inertia of the body with its center of
+  /// mass at the specified hardpoint.
+  void SetMassProperties(int point, double mass, const ChVector<>& inertia);
+
+  /// Get the location of the specified hardpoint, in the suspension reference
+  /// frame.
+  const ChVector<>& GetPoint(int point, ChVehicleSide side = LEFT) const { return m_points[side * m_num_points + point]; }
+
+  /// Get the specified direction, in the suspension reference frame.
+  const ChVector<>& GetDirection(int dir, ChVehicleSide side = LEFT) const { return m_dirs[side * m_num_dirs + dir]; }
+
+  /// Get the mass properties of the body with its center of mass at the
+  /// specified hardpoint.
+  double GetMass(int point) const { return m_mass[point]; }
+  const ChVector<>& GetInertia(int point) const { return m_inertia[point]; }
+
+  /// Return true if the hardpoints and directions of both tables are equal.
+  bool SameGeometry(const ChHardpointTable& other) const;
+
+  /// Express all hardpoints of the specified side in the parent frame of the
+  /// specified suspension frame, in a single pass.
+  void Transform(
+    const ChFrame<>&          frame,    ///< [in] suspension frame, in the parent frame
+    ChVehicleSide             side,     ///< [in] vehicle side
+    std::vector<ChVector<> >& points    ///< [out] hardpoints, in the parent frame
+    ) const;
+
+  /// Express all directions of the specified side in the parent frame of the
+  /// specified suspension frame, in a single pass.
+  void TransformDirections(
+    const ChFrame<>&          frame,    ///< [in] suspension frame, in the parent frame
+    ChVehicleSide             side,     ///< [in] vehicle side
+    std::vector<ChVector<> >& dirs      ///< [out] directions, in the parent frame
+    ) const;
+
+private:
+
+  int                       m_num_points;
+  int                       m_num_dirs;
+  std::vector<ChVector<> >  m_points;     // left side, then right side
+  std::vector<ChVector<> >  m_dirs;       // left side, then right side
+  std::vector<double>       m_mass;
+  std::vector<ChVector<> >  m_inertia;
+};
+
+
+} // end namespace chrono
+
+
+#endif
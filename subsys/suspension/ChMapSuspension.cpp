@@ -0,0 +1,383 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Base class for an independent suspension modeled in joint space, with a
+// tabulated kinematic map of the upright as a function of the wheel travel.
+//
+// The suspension subsystem is modeled with respect to a right-handed frame,
+// with X pointing towards the front, Y to the left, and Z up (ISO standard).
+// The suspension reference frame is assumed to be always aligned with that of
+// the vehicle.  When attached to a chassis, only an offset is provided.
+//
+// All point locations and the map are assumed to be given for the left half
+// of the supspension and will be mirrored (reflecting the y coordinates) to
+// construct the right side.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cassert>
+
+#include "assets/ChCylinderShape.h"
+#include "assets/ChColorAsset.h"
+#include "motion_functions/ChFunction.h"
+
+#include "subsys/suspension/ChMapSuspension.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Motion imposed on one locked coordinate of the prismatic joint: the map at
+// the current travel, and its velocity from the map Jacobian. The motion does
+// not depend explicitly on time.
+// -----------------------------------------------------------------------------
+class ChMapSuspensionMotion : public ChFunction
+{
+public:
+  ChMapSuspensionMotion(const ChMapSuspension*         suspension,
+                        ChVehicleSide                  side,
+                        ChMapSuspension::MapCoordinate coord)
+  : m_suspension(suspension),
+    m_side(side),
+    m_coord(coord)
+  {
+    // Mirroring the left side reverses the lateral displacement and the
+    // rotations about the X and Z axes.
+    bool odd = (coord == ChMapSuspension::MAP_Y || coord == ChMapSuspension::MAP_CAMBER ||
+                coord == ChMapSuspension::MAP_TOE);
+    m_sign = (side == RIGHT && odd) ? -1 : 1;
+  }
+
+  virtual ChFunction* new_Duplicate() { return new ChMapSuspensionMotion(*this); }
+
+  virtual double Get_y(double x)
+  {
+    return m_sign * m_suspension->GetMapValue(m_coord, m_suspension->GetTravel(m_side));
+  }
+
+  virtual double Get_y_dx(double x)
+  {
+    double travel = m_suspension->GetTravel(m_side);
+    return m_sign * m_suspension->GetMapJacobian(m_coord, travel) * m_suspension->GetTravelRate(m_side);
+  }
+
+  virtual double Get_y_dxdx(double x) { return 0; }
+
+private:
+  const ChMapSuspension*          m_suspension;
+  ChVehicleSide                   m_side;
+  ChMapSuspension::MapCoordinate  m_coord;
+  double                          m_sign;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChMapSuspension::ChMapSuspension(const std::string& name)
+: ChSuspension(name),
+  m_num_points(51),
+  m_min_travel(0),
+  m_inv_dtravel(0),
+  m_chassis(NULL)
+{
+  CreateSide(LEFT, "_L");
+  CreateSide(RIGHT, "_R");
+}
+
+void ChMapSuspension::SetMapResolution(int num_points)
+{
+  assert(num_points >= 2);
+
+  m_num_points = num_points;
+}
+
+void ChMapSuspension::CreateSide(ChVehicleSide      side,
+                                 const std::string& suffix)
+{
+  // Create the spindle and upright bodies
+  m_spindle[side] = ChSharedBodyPtr(new ChBody);
+  m_spindle[side]->SetNameString(m_name + "_spindle" + suffix);
+  m_upright[side] = ChSharedBodyPtr(new ChBody);
+  m_upright[side]->SetNameString(m_name + "_upright" + suffix);
+
+  // Revolute joint between spindle and upright
+  m_revolute[side] = ChSharedPtr<ChLinkLockRevolute>(new ChLinkLockRevolute);
+  m_revolute[side]->SetNameString(m_name + "_revolute" + suffix);
+
+  // Prismatic joint between upright and chassis, with the map imposed on its
+  // locked coordinates.
+  m_prismatic[side] = ChSharedPtr<ChLinkLockPrismatic>(new ChLinkLockPrismatic);
+  m_prismatic[side]->SetNameString(m_name + "_prismatic" + suffix);
+  m_prismatic[side]->Set_angleset(ANGLESET_RXYZ);
+  m_prismatic[side]->SetMotion_X(ChSharedPtr<ChFunction>(new ChMapSuspensionMotion(this, side, MAP_X)));
+  m_prismatic[side]->SetMotion_Y(ChSharedPtr<ChFunction>(new ChMapSuspensionMotion(this, side, MAP_Y)));
+  m_prismatic[side]->SetMotion_ang(ChSharedPtr<ChFunction>(new ChMapSuspensionMotion(this, side, MAP_CAMBER)));
+  m_prismatic[side]->SetMotion_ang2(ChSharedPtr<ChFunction>(new ChMapSuspensionMotion(this, side, MAP_CASTER)));
+  m_prismatic[side]->SetMotion_ang3(ChSharedPtr<ChFunction>(new ChMapSuspensionMotion(this, side, MAP_TOE)));
+
+  // Spring-damper
+  m_shock[side] = ChSharedPtr<ChLinkSpring>(new ChLinkSpring);
+  m_shock[side]->SetNameString(m_name + "_shock" + suffix);
+
+  // Create the axle shaft and its connection to the spindle.
+  m_axle[side] = ChSharedPtr<ChShaft>(new ChShaft);
+  m_axle[side]->SetNameString(m_name + "_axle" + suffix);
+  m_axle_to_spindle[side] = ChSharedPtr<ChShaftsBody>(new ChShaftsBody);
+  m_axle_to_spindle[side]->SetNameString(m_name + "_axle_to_spindle" + suffix);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapSuspension::Initialize(ChSharedPtr<ChBodyAuxRef>  chassis,
+                                 const ChVector<>&          location,
+                                 ChSharedPtr<ChBody>        tierod_body)
+{
+  CH_STARTUP_SCOPE("ChMapSuspension::Initialize");
+
+  TabulateMap();
+
+  // The travel is measured along the vertical of the suspension (chassis)
+  // reference frame, expressed in the chassis COG frame.
+  m_chassis = chassis.get_ptr();
+  ChQuaternion<> chassisRot = chassis->GetFrame_REF_to_abs().GetRot();
+  m_axis = chassis->TransformDirectionParentToLocal(chassisRot.GetZaxis());
+
+  // Express the suspension reference frame in the absolute coordinate system.
+  ChFrame<> suspension_to_abs(location);
+  suspension_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
+
+  // Transform all points to absolute frame and initialize left side.
+  std::vector<ChVector<> > points(NUM_POINTS);
+
+  for (int i = 0; i < NUM_POINTS; i++) {
+    ChVector<> rel_pos = getLocation(static_cast<PointId>(i));
+    points[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
+  }
+
+  InitializeSide(LEFT, chassis, points);
+
+  // Transform all points to absolute frame and initialize right side.
+  for (int i = 0; i < NUM_POINTS; i++) {
+    ChVector<> rel_pos = getLocation(static_cast<PointId>(i));
+    rel_pos.y = -rel_pos.y;
+    points[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
+  }
+
+  InitializeSide(RIGHT, chassis, points);
+}
+
+
+void ChMapSuspension::InitializeSide(ChVehicleSide                   side,
+                                     ChSharedPtr<ChBodyAuxRef>       chassis,
+                                     const std::vector<ChVector<> >& points)
+{
+  // Chassis orientation (expressed in absolute frame)
+  // Recall that the suspension reference frame is aligned with the chassis.
+  ChQuaternion<> chassisRot = chassis->GetFrame_REF_to_abs().GetRot();
+
+  // Initialize spindle body (same orientation as the chassis)
+  m_spindle[side]->SetPos(points[SPINDLE]);
+  m_spindle[side]->SetRot(chassisRot);
+  m_spindle[side]->SetMass(getSpindleMass());
+  m_spindle[side]->SetInertiaXX(getSpindleInertia());
+  AddVisualizationSpindle(m_spindle[side], getSpindleRadius(), getSpindleWidth());
+  chassis->GetSystem()->AddBody(m_spindle[side]);
+
+  // Initialize upright body (at the spindle, same orientation as the chassis)
+  m_upright[side]->SetPos(points[SPINDLE]);
+  m_upright[side]->SetRot(chassisRot);
+  m_upright[side]->SetMass(getUprightMass());
+  m_upright[side]->SetInertiaXX(getUprightInertia());
+  chassis->GetSystem()->AddBody(m_upright[side]);
+
+  m_ref_pos[side] = chassis->TransformPointParentToLocal(points[SPINDLE]);
+
+  // Initialize joints. The prismatic joint translates along its Z axis, i.e.
+  // the chassis vertical; its relative coordinates are those of the upright
+  // with respect to the chassis.
+  ChCoordsys<> rev_csys(points[SPINDLE], chassisRot * Q_from_AngAxis(CH_C_PI / 2.0, VECT_X));
+  m_revolute[side]->Initialize(m_spindle[side], m_upright[side], rev_csys);
+  chassis->GetSystem()->AddLink(m_revolute[side]);
+
+  m_prismatic[side]->Initialize(m_upright[side], chassis, ChCoordsys<>(points[SPINDLE], chassisRot));
+  chassis->GetSystem()->AddLink(m_prismatic[side]);
+
+  // Initialize the spring/damper
+  m_shock[side]->Initialize(chassis, m_upright[side], false, points[SHOCK_C], points[SHOCK_U]);
+  m_shock[side]->Set_SpringK(getSpringCoefficient());
+  m_shock[side]->Set_SpringR(getDampingCoefficient());
+  m_shock[side]->Set_SpringRestLength(getSpringRestLength());
+  chassis->GetSystem()->AddLink(m_shock[side]);
+
+  // Initialize the axle shaft and its connection to the spindle. Note that the
+  // spindle rotates about the Y axis.
+  m_axle[side]->SetInertia(getAxleInertia());
+  chassis->GetSystem()->Add(m_axle[side]);
+
+  m_axle_to_spindle[side]->Initialize(m_axle[side], m_spindle[side], ChVector<>(0, -1, 0));
+  chassis->GetSystem()->Add(m_axle_to_spindle[side]);
+}
+
+
+// -----------------------------------------------------------------------------
+// The map is sampled on a uniform grid over the travel range, so that the cell
+// of a travel value is found without searching. The Jacobian of the piecewise
+// linear map is constant over each cell.
+// -----------------------------------------------------------------------------
+void ChMapSuspension::TabulateMap()
+{
+  int n = m_num_points - 1;
+  double dtravel = (getMaxTravel() - getMinTravel()) / n;
+
+  m_min_travel = getMinTravel();
+  m_inv_dtravel = 1 / dtravel;
+  m_map.resize(NUM_MAP_COORDINATES * m_num_points);
+  m_jacobian.resize(NUM_MAP_COORDINATES * n);
+
+  for (int i = 0; i <= n; i++) {
+    ChCoordsys<> motion = getUprightMotion(m_min_travel + i * dtravel);
+    ChVector<> angles = Quat_to_Angle(ANGLESET_RXYZ, &motion.rot);
+
+    double* row = &m_map[NUM_MAP_COORDINATES * i];
+    row[MAP_X] = motion.pos.x;
+    row[MAP_Y] = motion.pos.y;
+    row[MAP_CAMBER] = angles.x;
+    row[MAP_CASTER] = angles.y;
+    row[MAP_TOE] = angles.z;
+  }
+
+  for (int i = 0; i < n; i++) {
+    const double* row0 = &m_map[NUM_MAP_COORDINATES * i];
+    const double* row1 = row0 + NUM_MAP_COORDINATES;
+    for (int j = 0; j < NUM_MAP_COORDINATES; j++)
+      m_jacobian[NUM_MAP_COORDINATES * i + j] = (row1[j] - row0[j]) * m_inv_dtravel;
+  }
+}
+
+int ChMapSuspension::locate(double travel, double& t) const
+{
+  double s = (travel - m_min_travel) * m_inv_dtravel;
+  s = std::min(std::max(s, 0.0), (double)(m_num_points - 1));
+  int i = std::min((int)s, m_num_points - 2);
+  t = s - i;
+
+  return i;
+}
+
+double ChMapSuspension::GetMapValue(MapCoordinate coord, double travel) const
+{
+  double t;
+  int i = locate(travel, t);
+  const double* row0 = &m_map[NUM_MAP_COORDINATES * i];
+
+  return row0[coord] + t * (row0[NUM_MAP_COORDINATES + coord] - row0[coord]);
+}
+
+double ChMapSuspension::GetMapJacobian(MapCoordinate coord, double travel) const
+{
+  double s = (travel - m_min_travel) * m_inv_dtravel;
+  if (s < 0 || s > m_num_points - 1)
+    return 0;
+
+  double t;
+  int i = locate(travel, t);
+
+  return m_jacobian[NUM_MAP_COORDINATES * i + coord];
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChMapSuspension::GetTravel(ChVehicleSide side) const
+{
+  ChVector<> pos = m_chassis->TransformPointParentToLocal(m_upright[side]->GetPos());
+
+  return (pos - m_ref_pos[side]) ^ m_axis;
+}
+
+double ChMapSuspension::GetTravelRate(ChVehicleSide side) const
+{
+  ChVector<> pos = m_chassis->TransformPointParentToLocal(m_upright[side]->GetPos());
+  ChVector<> vel = m_upright[side]->GetPos_dt() - m_chassis->PointSpeedLocalToParent(pos);
+
+  return m_chassis->TransformDirectionParentToLocal(vel) ^ m_axis;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapSuspension::AddVisualizationSpindle(ChSharedBodyPtr spindle,
+                                              double          radius,
+                                              double          width)
+{
+  ChSharedPtr<ChCylinderShape> cyl(new ChCylinderShape);
+  cyl->GetCylinderGeometry().p1 = ChVector<>(0, width / 2, 0);
+  cyl->GetCylinderGeometry().p2 = ChVector<>(0, -width / 2, 0);
+  cyl->GetCylinderGeometry().rad = radius;
+  vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
+
+  ChSharedPtr<ChColorAsset> col(new ChColorAsset);
+  col->SetColor(ChColor(0.2f, 0.2f, 0.6f));
+  vehicle::ChDeferredAssets::AddAsset(spindle, col);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapSuspension::GetConstraints(std::vector<ChLink*>& links) const
+{
+  ChSuspension::GetConstraints(links);
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    links.push_back(m_prismatic[side].get_ptr());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMapSuspension::LogConstraintViolations(ChVehicleSide side)
+{
+  // Revolute joint
+  {
+    ChMatrix<>* C = m_revolute[side]->GetC();
+    GetLog() << "Spindle revolute      ";
+    GetLog() << "  " << C->GetElement(0, 0) << "  ";
+    GetLog() << "  " << C->GetElement(1, 0) << "  ";
+    GetLog() << "  " << C->GetElement(2, 0) << "  ";
+    GetLog() << "  " << C->GetElement(3, 0) << "  ";
+    GetLog() << "  " << C->GetElement(4, 0) << "\n";
+  }
+
+  // Prismatic joint (deviation from the map)
+  {
+    ChMatrix<>* C = m_prismatic[side]->GetC();
+    GetLog() << "Upright prismatic     ";
+    GetLog() << "  " << C->GetElement(0, 0) << "  ";
+    GetLog() << "  " << C->GetElement(1, 0) << "  ";
+    GetLog() << "  " << C->GetElement(2, 0) << "  ";
+    GetLog() << "  " << C->GetElement(3, 0) << "  ";
+    GetLog() << "  " << C->GetElement(4, 0) << "\n";
+  }
+
+  GetLog() << "Travel                ";
+  GetLog() << "  " << GetTravel(side) << "\n";
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,224 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Base class for an independent suspension modeled in joint space, i.e. with a
+// single generalized coordinate (the wheel travel) per side.
+// Derived from ChSuspension, but still an abstract base class.
+//
+// Instead of the control arms, tierods and their joints, each side has only an
+// upright body, connected to the chassis through a prismatic joint along the
+// chassis vertical, and the spindle body, connected to the upright through the
+// usual revolute joint. The wheel travel is the free coordinate of the
+// prismatic joint; its five locked coordinates (longitudinal and lateral
+// displacement, camber, caster and toe angles of the upright) are not zero but
+// follow the kinematic map of the suspension, i.e. functions of the travel
+// tabulated at initialization on a uniform grid from getUprightMotion(). The
+// derivatives of the map with respect to the travel (the Jacobian) are also
+// tabulated and provide the velocities of the imposed motions. This replaces
+// the 20-30 constraint equations and 3-4 bodies of link based templates (e.g.
+// ChDoubleWishbone) by 10 constraint equations and 2 bodies per side.
+//
+// The map is typically obtained from a quasi-static sweep of the link based
+// suspension (see SuspensionSweep). Since the map depends on the travel only,
+// the suspension cannot be steered and has no roll coupling between the two
+// sides. The imposed motions are evaluated at the travel of the previous
+// update, and the reactions along the map (e.g. the jacking effect of the
+// lateral tire force) are not transmitted to the travel.
+//
+// The suspension subsystem is modeled with respect to a right-handed frame,
+// with X pointing towards the front, Y to the left, and Z up (ISO standard).
+// The suspension reference frame is assumed to be always aligned with that of
+// the vehicle.  When attached to a chassis, only an offset is provided.
+//
+// All point locations and the map are assumed to be given for the left half
+// of the supspension and will be mirrored (reflecting the y coordinates) to
+// construct the right side.
+//
+// =============================================================================
+
+#ifndef CH_MAPSUSPENSION_H
+#define CH_MAPSUSPENSION_H
+
+#include <vector>
+
+#include "physics/ChLinkLock.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSuspension.h"
+
+namespace chrono {
+
+///
+/// Base class for an independent suspension modeled in joint space, with a
+/// tabulated kinematic map of the upright as a function of the wheel travel.
+/// Derived from ChSuspension, but still an abstract base class.
+///
+/// The suspension subsystem is modeled with respect to a right-handed frame,
+/// with X pointing towards the front, Y to the left, and Z up (ISO standard).
+/// The suspension reference frame is assumed to be always aligned with that of
+/// the vehicle.  When attached to a chassis, only an offset is provided.
+///
+/// All point locations and the map are assumed to be given for the left half
+/// of the supspension and will be mirrored (reflecting the y coordinates) to
+/// construct the right side.
+///
+class CH_SUBSYS_API ChMapSuspension : public ChSuspension
+{
+public:
+
+  /// Coordinates of the kinematic map (relative motion of the upright with
+  /// respect to its design configuration, expressed in the chassis frame).
+  enum MapCoordinate {
+    MAP_X,        ///< longitudinal displacement
+    MAP_Y,        ///< lateral displacement
+    MAP_CAMBER,   ///< rotation about the X axis
+    MAP_CASTER,   ///< rotation about the Y axis
+    MAP_TOE,      ///< rotation about the Z axis
+    NUM_MAP_COORDINATES
+  };
+
+  ChMapSuspension(
+    const std::string& name               ///< [in] name of the subsystem
+    );
+
+  virtual ~ChMapSuspension() {}
+
+  /// Specify whether or not this suspension can be steered.
+  virtual bool IsSteerable() const { return false; }
+
+  /// Set the number of points of the tabulated map over the travel range
+  /// (default: 51). Must be called before Initialize().
+  void SetMapResolution(int num_points);
+
+  /// Initialize this suspension subsystem.
+  /// The suspension subsystem is initialized by attaching it to the specified
+  /// chassis body at the specified location (with respect to and expressed in
+  /// the reference frame of the chassis). It is assumed that the suspension
+  /// reference frame is always aligned with the chassis reference frame.
+  /// The tierod body is not used (the suspension cannot be steered).
+  virtual void Initialize(
+    ChSharedPtr<ChBodyAuxRef>  chassis,     ///< [in] handle to the chassis body
+    const ChVector<>&          location,    ///< [in] location relative to the chassis frame
+    ChSharedPtr<ChBody>        tierod_body  ///< [in] body to which tireods are connected
+    );
+
+  /// Get the current wheel travel on the specified side (positive up, i.e.
+  /// towards the chassis).
+  double GetTravel(ChVehicleSide side) const;
+
+  /// Get the current rate of the wheel travel on the specified side.
+  double GetTravelRate(ChVehicleSide side) const;
+
+  /// Evaluate the tabulated map for the specified coordinate (left side) at
+  /// the specified travel. The map is constant outside the travel range.
+  double GetMapValue(MapCoordinate coord, double travel) const;
+
+  /// Evaluate the derivative of the tabulated map for the specified coordinate
+  /// (left side) with respect to the travel. Zero outside the travel range.
+  double GetMapJacobian(MapCoordinate coord, double travel) const;
+
+  /// Log current constraint violations.
+  virtual void LogConstraintViolations(ChVehicleSide side);
+
+  /// Append the joints of this suspension (both sides) to the specified list.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
+protected:
+
+  /// Identifiers for the various hardpoints.
+  enum PointId {
+    SPINDLE,    ///< spindle location (also the upright and prismatic joint location)
+    SHOCK_C,    ///< shock, chassis
+    SHOCK_U,    ///< shock, upright
+    NUM_POINTS
+  };
+
+  /// Return the location of the specified hardpoint.
+  /// The returned location must be expressed in the suspension reference frame.
+  virtual const ChVector<> getLocation(PointId which) = 0;
+
+  /// Return the pose of the upright at the specified travel, relative to (and
+  /// expressed in the frame of) the upright in its design configuration. The
+  /// vertical component of the displacement is the travel itself and is
+  /// ignored; the motion must be the identity at zero travel.
+  virtual ChCoordsys<> getUprightMotion(double travel) const = 0;
+
+  /// Return the lower and upper limits of the tabulated travel range.
+  virtual double getMinTravel() const = 0;
+  virtual double getMaxTravel() const = 0;
+
+  /// Return the mass of the spindle body.
+  virtual double getSpindleMass() const = 0;
+  /// Return the mass of the upright body (all unsprung parts but the spindle).
+  virtual double getUprightMass() const = 0;
+
+  /// Return the moments of inertia of the spindle body.
+  virtual const ChVector<>& getSpindleInertia() const = 0;
+  /// Return the moments of inertia of the upright body.
+  virtual const ChVector<>& getUprightInertia() const = 0;
+
+  /// Return the inertia of the axle shaft.
+  virtual double getAxleInertia() const = 0;
+
+  /// Return the radius of the spindle body (visualization only).
+  virtual double getSpindleRadius() const = 0;
+  /// Return the width of the spindle body (visualization only).
+  virtual double getSpindleWidth() const = 0;
+
+  /// Return the spring coefficient (for linear spring elements).
+  virtual double getSpringCoefficient() const = 0;
+  /// Return the damping coefficient (for linear shock elements).
+  virtual double getDampingCoefficient() const = 0;
+  /// Return the free (rest) length of the spring element.
+  virtual double getSpringRestLength() const = 0;
+
+  ChSharedBodyPtr                   m_upright[2];      ///< handles to the upright bodies (left/right)
+
+  ChSharedPtr<ChLinkLockPrismatic>  m_prismatic[2];    ///< handles to the chassis-upright joints (left/right)
+
+  ChSharedPtr<ChLinkSpring>         m_shock[2];        ///< handles to the spring-damper force elements (left/right)
+
+private:
+
+  void CreateSide(ChVehicleSide      side,
+                  const std::string& suffix);
+  void InitializeSide(ChVehicleSide                   side,
+                      ChSharedPtr<ChBodyAuxRef>       chassis,
+                      const std::vector<ChVector<> >& points);
+
+  void TabulateMap();
+
+  // cell index and local coordinate in [0,1] for the specified travel
+  int locate(double travel, double& t) const;
+
+  static void AddVisualizationSpindle(ChSharedBodyPtr spindle,
+                                      double          radius,
+                                      double          width);
+
+  int                  m_num_points;
+  double               m_min_travel;
+  double               m_inv_dtravel;
+  std::vector<double>  m_map;        // per point: map coordinates (left side)
+  std::vector<double>  m_jacobian;   // per cell: map derivatives (left side)
+
+  ChBody*              m_chassis;        // chassis body (not owned)
+  ChVector<>           m_ref_pos[2];     // design upright location, in the chassis COG frame
+  ChVector<>           m_axis;           // travel direction, in the chassis COG frame
+};
+
+
+} // end namespace chrono
+
+
+#endif
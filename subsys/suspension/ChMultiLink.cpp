@@ -29,6 +29,10 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/suspension/ChMultiLink.h"
+#include "subsys/suspension/ChSpringForceT.h"
+#include "subsys/suspension/ChSpringForceBank.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -59,44 +63,6 @@ const std::string ChMultiLink::m_pointNames[] = {
 };
 
 
-// -----------------------------------------------------------------------------
-// Default shock and spring functors (used for linear elements)
-// -----------------------------------------------------------------------------
-class LinearSpringForce : public ChSpringForceCallback
-{
-public:
-  LinearSpringForce(double k) : m_k(k) {}
-
-  virtual double operator()(double time,         // current time
-                            double rest_length,  // undeformed length
-                            double length,       // current length
-                            double vel)          // current velocity (positive when extending)
-  {
-    return -m_k * (length - rest_length);
-  }
-
-private:
-  double  m_k;
-};
-
-class LinearShockForce : public ChSpringForceCallback
-{
-public:
-  LinearShockForce(double c) : m_c(c) {}
-
-  virtual double operator()(double time,         // current time
-                            double rest_length,  // undeformed length
-                            double length,       // current length
-                            double vel)          // current velocity (positive when extending)
-  {
-    return -m_c * vel;
-  }
-
-private:
-  double  m_c;
-};
-
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ChMultiLink::ChMultiLink(const std::string& name)
@@ -186,42 +152,62 @@ void ChMultiLink::Initialize(ChSharedPtr<ChBodyAuxRef>  chassis,
                              const ChVector<>&          location,
                              ChSharedPtr<ChBody>        tierod_body)
 {
+  CH_STARTUP_SCOPE("ChMultiLink::Initialize");
+
   // Set the shock and spring force callbacks (use the user-provided functor if
-  // a nonlinear element was specified; otherwise, use the default functor).
+  // a nonlinear element was specified; otherwise, use the tabulated curve, if
+  // one was provided, or the default linear functor).
   m_nonlinearShock = useNonlinearShock();
   m_nonlinearSpring = useNonlinearSpring();
-  m_shockCB = m_nonlinearShock ? getShockForceCallback() : new LinearShockForce(getDampingCoefficient());
-  m_springCB = m_nonlinearSpring ? getSpringForceCallback() : new LinearSpringForce(getSpringCoefficient());
+  m_shockCurve = m_nonlinearShock ? ChSharedPtr<ChForceCurve>() : getShockForceCurve();
+  m_springCurve = m_nonlinearSpring ? ChSharedPtr<ChForceCurve>() : getSpringForceCurve();
+
+  if (m_nonlinearShock)
+    m_shockCB = getShockForceCallback();
+  else if (!m_shockCurve.IsNull())
+    m_shockCB = new ChSpringForceT<ChForceCurveLaw>(ChForceCurveLaw(m_shockCurve));
+  else
+    m_shockCB = new ChSpringForceT<ChLinearShockLaw>(ChLinearShockLaw(getDampingCoefficient()));
+
+  if (m_nonlinearSpring)
+    m_springCB = getSpringForceCallback();
+  else if (!m_springCurve.IsNull())
+    m_springCB = new ChSpringForceT<ChForceCurveLaw>(ChForceCurveLaw(m_springCurve));
+  else
+    m_springCB = new ChSpringForceT<ChLinearSpringLaw>(ChLinearSpringLaw(getSpringCoefficient()));
 
   // Express the suspension reference frame in the absolute coordinate system.
   ChFrame<> suspension_to_abs(location);
   suspension_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
 
-  // Transform all points to absolute frame and initialize left side.
-  std::vector<ChVector<> > points_R(NUM_POINTS);
-  std::vector<ChVector<> > points_L(NUM_POINTS);
-  std::vector<ChVector<> > dirs_R(NUM_DIRS);
-  std::vector<ChVector<> > dirs_L(NUM_DIRS);
+  // Transform all points and directions to absolute frame.
+  ChSharedPtr<ChHardpointTable> table = getHardpointTable();
+  std::vector<ChVector<> > points_R;
+  std::vector<ChVector<> > points_L;
+  std::vector<ChVector<> > dirs_R;
+  std::vector<ChVector<> > dirs_L;
 
-  for (int i = 0; i < NUM_POINTS; i++) {
-    ChVector<> rel_pos = getLocation(static_cast<PointId>(i));
-    points_L[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
-    rel_pos.y = -rel_pos.y;
-    points_R[i] = suspension_to_abs.TransformLocalToParent(rel_pos);
-  }
-
-  for (int i = 0; i < NUM_DIRS; i++) {
-    ChVector<> rel_dir = getDirection(static_cast<DirectionId>(i));
-    dirs_L[i] = suspension_to_abs.TransformDirectionLocalToParent(rel_dir);
-    rel_dir.y = -rel_dir.y;
-    dirs_R[i] = suspension_to_abs.TransformDirectionLocalToParent(rel_dir);
-  }
+  table->Transform(suspension_to_abs, LEFT, points_L);
+  table->Transform(suspension_to_abs, RIGHT, points_R);
+  table->TransformDirections(suspension_to_abs, LEFT, dirs_L);
+  table->TransformDirections(suspension_to_abs, RIGHT, dirs_R);
 
   // Initialize left and right sides.
   InitializeSide(LEFT, chassis, tierod_body, points_L, dirs_L);
   InitializeSide(RIGHT, chassis, tierod_body, points_R, dirs_R);
 }
 
+ChSharedPtr<ChHardpointTable> ChMultiLink::getHardpointTable()
+{
+  ChSharedPtr<ChHardpointTable> table(new ChHardpointTable(NUM_POINTS, NUM_DIRS));
+  for (int i = 0; i < NUM_POINTS; i++)
+    table->SetPoint(i, getLocation(static_cast<PointId>(i)));
+  for (int i = 0; i < NUM_DIRS; i++)
+    table->SetDirection(i, getDirection(static_cast<DirectionId>(i)));
+
+  return table;
+}
+
 void ChMultiLink::InitializeSide(ChVehicleSide                   side,
                                  ChSharedPtr<ChBodyAuxRef>       chassis,
                                  ChSharedPtr<ChBody>             tierod_body,
@@ -390,6 +376,23 @@ void ChMultiLink::LogHardpointLocations(const ChVector<>& ref,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMultiLink::GetConstraints(std::vector<ChLink*>& links) const
+{
+  ChSuspension::GetConstraints(links);
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    links.push_back(m_revoluteUA[side].get_ptr());
+    links.push_back(m_sphericalUA[side].get_ptr());
+    links.push_back(m_universalLateralChassis[side].get_ptr());
+    links.push_back(m_sphericalLateralUpright[side].get_ptr());
+    links.push_back(m_universalTLChassis[side].get_ptr());
+    links.push_back(m_sphericalTLUpright[side].get_ptr());
+    links.push_back(m_distTierod[side].get_ptr());
+  }
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChMultiLink::LogConstraintViolations(ChVehicleSide side)
@@ -461,6 +464,45 @@ void ChMultiLink::LogConstraintViolations(ChVehicleSide side)
 
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMultiLink::AddSpringForceElements(ChSpringForceBank& bank)
+{
+  for (int side = LEFT; side <= RIGHT; side++) {
+    if (!m_shockCurve.IsNull())
+      bank.AddElement(m_shock[side], m_shockCurve);
+    if (!m_springCurve.IsNull())
+      bank.AddElement(m_spring[side], m_springCurve);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Tabulated curves are shared with the concrete suspension and updated in
+// place; the parameters of the linear laws are replaced in their callbacks.
+// -----------------------------------------------------------------------------
+void ChMultiLink::UpdateParameters()
+{
+  for (int side = LEFT; side <= RIGHT; side++) {
+    m_spindle[side]->SetMass(getSpindleMass());
+    m_spindle[side]->SetInertiaXX(getSpindleInertia());
+    m_upright[side]->SetMass(getUprightMass());
+    m_upright[side]->SetInertiaXX(getUprightInertia());
+    m_upperArm[side]->SetMass(getUpperArmMass());
+    m_upperArm[side]->SetInertiaXX(getUpperArmInertia());
+    m_lateral[side]->SetMass(getLateralMass());
+    m_lateral[side]->SetInertiaXX(getLateralInertia());
+    m_trailingLink[side]->SetMass(getTrailingLinkMass());
+    m_trailingLink[side]->SetInertiaXX(getTrailingLinkInertia());
+    m_axle[side]->SetInertia(getAxleInertia());
+    m_spring[side]->Set_SpringRestLength(getSpringRestLength());
+  }
+
+  if (!m_nonlinearShock && m_shockCurve.IsNull())
+    static_cast<ChSpringForceT<ChLinearShockLaw>*>(m_shockCB)->SetLaw(ChLinearShockLaw(getDampingCoefficient()));
+  if (!m_nonlinearSpring && m_springCurve.IsNull())
+    static_cast<ChSpringForceT<ChLinearSpringLaw>*>(m_springCB)->SetLaw(ChLinearSpringLaw(getSpringCoefficient()));
+}
+
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -479,17 +521,17 @@ void ChMultiLink::AddVisualizationUpperArm(ChSharedBodyPtr   arm,
   cyl_F->GetCylinderGeometry().p1 = p_F;
   cyl_F->GetCylinderGeometry().p2 = p_U;
   cyl_F->GetCylinderGeometry().rad = radius;
-  arm->AddAsset(cyl_F);
+  vehicle::ChDeferredAssets::AddAsset(arm, cyl_F);
 
   ChSharedPtr<ChCylinderShape> cyl_B(new ChCylinderShape);
   cyl_B->GetCylinderGeometry().p1 = p_B;
   cyl_B->GetCylinderGeometry().p2 = p_U;
   cyl_B->GetCylinderGeometry().rad = radius;
-  arm->AddAsset(cyl_B);
+  vehicle::ChDeferredAssets::AddAsset(arm, cyl_B);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.6f, 0.2f, 0.6f));
-  arm->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(arm, col);
 }
 
 void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
@@ -514,7 +556,7 @@ void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_UA->GetCylinderGeometry().p1 = p_UA;
     cyl_UA->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_UA->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_UA);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_UA);
   }
 
   if (p_TR.Length2() > threshold2) {
@@ -522,7 +564,7 @@ void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_TR->GetCylinderGeometry().p1 = p_TR;
     cyl_TR->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_TR->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_TR);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_TR);
   }
 
   if (p_TL.Length2() > threshold2) {
@@ -530,7 +572,7 @@ void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_TL->GetCylinderGeometry().p1 = p_TL;
     cyl_TL->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_TL->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_TL);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_TL);
   }
 
   if (p_T.Length2() > threshold2) {
@@ -538,7 +580,7 @@ void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_T->GetCylinderGeometry().p1 = p_T;
     cyl_T->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_T->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_T);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_T);
   }
 
   if (p_U.Length2() > threshold2) {
@@ -546,12 +588,12 @@ void ChMultiLink::AddVisualizationUpright(ChSharedBodyPtr   upright,
     cyl_U->GetCylinderGeometry().p1 = p_U;
     cyl_U->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_U->GetCylinderGeometry().rad = radius;
-    upright->AddAsset(cyl_U);
+    vehicle::ChDeferredAssets::AddAsset(upright, cyl_U);
   }
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.2f, 0.6f));
-  upright->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(upright, col);
 }
 
 void ChMultiLink::AddVisualizationLateral(ChSharedBodyPtr   rod,
@@ -567,11 +609,11 @@ void ChMultiLink::AddVisualizationLateral(ChSharedBodyPtr   rod,
   cyl->GetCylinderGeometry().p1 = p_C;
   cyl->GetCylinderGeometry().p2 = p_U;
   cyl->GetCylinderGeometry().rad = radius;
-  rod->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(rod, cyl);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.6f, 0.2f));
-  rod->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(rod, col);
 }
 
 void ChMultiLink::AddVisualizationTrailingLink(ChSharedBodyPtr   link,
@@ -589,17 +631,17 @@ void ChMultiLink::AddVisualizationTrailingLink(ChSharedBodyPtr   link,
   cyl1->GetCylinderGeometry().p1 = p_C;
   cyl1->GetCylinderGeometry().p2 = p_S;
   cyl1->GetCylinderGeometry().rad = radius;
-  link->AddAsset(cyl1);
+  vehicle::ChDeferredAssets::AddAsset(link, cyl1);
 
   ChSharedPtr<ChCylinderShape> cyl2(new ChCylinderShape);
   cyl2->GetCylinderGeometry().p1 = p_S;
   cyl2->GetCylinderGeometry().p2 = p_U;
   cyl2->GetCylinderGeometry().rad = radius;
-  link->AddAsset(cyl2);
+  vehicle::ChDeferredAssets::AddAsset(link, cyl2);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.6f, 0.6f));
-  link->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(link, col);
 }
 
 
@@ -611,7 +653,7 @@ void ChMultiLink::AddVisualizationSpindle(ChSharedBodyPtr spindle,
   cyl->GetCylinderGeometry().p1 = ChVector<>(0, width / 2, 0);
   cyl->GetCylinderGeometry().p2 = ChVector<>(0, -width / 2, 0);
   cyl->GetCylinderGeometry().rad = radius;
-  spindle->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 }
 
 
@@ -33,6 +33,8 @@
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChSuspension.h"
+#include "subsys/suspension/ChForceCurve.h"
+#include "subsys/suspension/ChHardpointTable.h"
 
 namespace chrono {
 
@@ -97,6 +99,15 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side);
 
+  /// Append the joints of this suspension (both sides) to the specified list.
+  virtual void GetConstraints(std::vector<ChLink*>& links) const;
+
+  /// Add the tabulated spring and shock elements to the specified bank.
+  virtual void AddSpringForceElements(ChSpringForceBank& bank);
+
+  /// Apply the current masses, inertias and spring and shock laws.
+  virtual void UpdateParameters();
+
   /// Log the locations of all hardpoints.
   /// The reported locations are expressed in the suspension reference frame.
   /// By default, these values are reported in SI units (meters), but can be
@@ -145,6 +156,12 @@ protected:
   /// Return the vector of the specified direction.
   virtual const ChVector<> getDirection(DirectionId which) = 0;
 
+  /// Return the table of the hardpoints and directions of both sides (see
+  /// ChHardpointTable). The default implementation builds the table from
+  /// getLocation() and getDirection(); a derived class can return a table
+  /// shared with other instances.
+  virtual ChSharedPtr<ChHardpointTable> getHardpointTable();
+
   /// Return the mass of the spindle body.
   virtual double getSpindleMass() const = 0;
   /// Return the mass of the upper arm body.
@@ -205,6 +222,13 @@ protected:
   /// Return the callback function for shock force (for nonlinear shock).
   virtual ChSpringForceCallback* getShockForceCallback()  const { return NULL; }
 
+  /// Return the tabulated force curve of the spring. If the spring is not a
+  /// nonlinear element and a curve is provided, it replaces the linear spring.
+  virtual ChSharedPtr<ChForceCurve> getSpringForceCurve() const { return ChSharedPtr<ChForceCurve>(); }
+  /// Return the tabulated force curve of the shock. If the shock is not a
+  /// nonlinear element and a curve is provided, it replaces the linear shock.
+  virtual ChSharedPtr<ChForceCurve> getShockForceCurve() const  { return ChSharedPtr<ChForceCurve>(); }
+
   ChSharedBodyPtr                   m_upright[2];      ///< handles to the upright bodies (left/right)
   ChSharedBodyPtr                   m_upperArm[2];     ///< handles to the upper arm bodies (left/right)
   ChSharedBodyPtr                   m_lateral[2];      ///< handles to the lateral bodies (left/right)
@@ -224,6 +248,9 @@ protected:
   ChSpringForceCallback*            m_shockCB;         ///< callback function for calculating shock forces
   ChSpringForceCallback*            m_springCB;        ///< callback function for calculating spring forces
 
+  ChSharedPtr<ChForceCurve>         m_shockCurve;      ///< tabulated shock force curve (empty if not used)
+  ChSharedPtr<ChForceCurve>         m_springCurve;     ///< tabulated spring force curve (empty if not used)
+
   ChSharedPtr<ChLinkSpringCB>       m_shock[2];        ///< handles to the spring links (left/right)
   ChSharedPtr<ChLinkSpringCB>       m_spring[2];       ///< handles to the shock links (left/right)
 
@@ -29,6 +29,8 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/suspension/ChSolidAxle.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChStartupProfiler.h"
 
 
 namespace chrono {
@@ -137,6 +139,8 @@ void ChSolidAxle::Initialize(ChSharedPtr<ChBodyAuxRef>  chassis,
                              const ChVector<>&          location,
                              ChSharedPtr<ChBody>        tierod_body)
 {
+  CH_STARTUP_SCOPE("ChSolidAxle::Initialize");
+
   // Express the suspension reference frame in the absolute coordinate system.
   ChFrame<> suspension_to_abs(location);
   suspension_to_abs.ConcatenatePreTransformation(chassis->GetFrame_REF_to_abs());
@@ -337,6 +341,47 @@ void ChSolidAxle::LogHardpointLocations(const ChVector<>& ref,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSolidAxle::GetConstraints(std::vector<ChLink*>& links) const
+{
+  ChSuspension::GetConstraints(links);
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    links.push_back(m_revoluteKingpin[side].get_ptr());
+    links.push_back(m_sphericalUpperLink[side].get_ptr());
+    links.push_back(m_sphericalLowerLink[side].get_ptr());
+    links.push_back(m_universalUpperLink[side].get_ptr());
+    links.push_back(m_universalLowerLink[side].get_ptr());
+    links.push_back(m_distTierod[side].get_ptr());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSolidAxle::UpdateParameters()
+{
+  m_axleTube->SetMass(getAxleTubeMass());
+  m_axleTube->SetInertiaXX(getAxleTubeInertia());
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    m_knuckle[side]->SetMass(getKnuckleMass());
+    m_knuckle[side]->SetInertiaXX(getKnuckleInertia());
+    m_spindle[side]->SetMass(getSpindleMass());
+    m_spindle[side]->SetInertiaXX(getSpindleInertia());
+    m_upperLink[side]->SetMass(getULMass());
+    m_upperLink[side]->SetInertiaXX(getULInertia());
+    m_lowerLink[side]->SetMass(getLLMass());
+    m_lowerLink[side]->SetInertiaXX(getLLInertia());
+    m_axle[side]->SetInertia(getAxleInertia());
+
+    m_shock[side]->Set_SpringR(getDampingCoefficient());
+    m_shock[side]->Set_SpringRestLength(getSpringRestLength());
+    m_spring[side]->Set_SpringK(getSpringCoefficient());
+    m_spring[side]->Set_SpringRestLength(getSpringRestLength());
+  }
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChSolidAxle::LogConstraintViolations(ChVehicleSide side)
@@ -408,11 +453,11 @@ void ChSolidAxle::AddVisualizationLink(ChSharedBodyPtr   body,
   cyl->GetCylinderGeometry().p1 = p_1;
   cyl->GetCylinderGeometry().p2 = p_2;
   cyl->GetCylinderGeometry().rad = radius;
-  body->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(body, cyl);
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(color);
-  body->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(body, col);
 }
 
 void ChSolidAxle::AddVisualizationSpindle(ChSharedBodyPtr spindle,
@@ -423,7 +468,7 @@ void ChSolidAxle::AddVisualizationSpindle(ChSharedBodyPtr spindle,
   cyl->GetCylinderGeometry().p1 = ChVector<>(0, width / 2, 0);
   cyl->GetCylinderGeometry().p2 = ChVector<>(0, -width / 2, 0);
   cyl->GetCylinderGeometry().rad = radius;
-  spindle->AddAsset(cyl);
+  vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 }
 
 void ChSolidAxle::AddVisualizationKnuckle(ChSharedBodyPtr   knuckle,
@@ -444,7 +489,7 @@ void ChSolidAxle::AddVisualizationKnuckle(ChSharedBodyPtr   knuckle,
     cyl_L->GetCylinderGeometry().p1 = p_L;
     cyl_L->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_L->GetCylinderGeometry().rad = radius;
-    knuckle->AddAsset(cyl_L);
+    vehicle::ChDeferredAssets::AddAsset(knuckle, cyl_L);
   }
 
   if (p_U.Length2() > threshold2) {
@@ -452,7 +497,7 @@ void ChSolidAxle::AddVisualizationKnuckle(ChSharedBodyPtr   knuckle,
     cyl_U->GetCylinderGeometry().p1 = p_U;
     cyl_U->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_U->GetCylinderGeometry().rad = radius;
-    knuckle->AddAsset(cyl_U);
+    vehicle::ChDeferredAssets::AddAsset(knuckle, cyl_U);
   }
 
   if (p_T.Length2() > threshold2) {
@@ -460,12 +505,12 @@ void ChSolidAxle::AddVisualizationKnuckle(ChSharedBodyPtr   knuckle,
     cyl_T->GetCylinderGeometry().p1 = p_T;
     cyl_T->GetCylinderGeometry().p2 = ChVector<>(0, 0, 0);
     cyl_T->GetCylinderGeometry().rad = radius;
-    knuckle->AddAsset(cyl_T);
+    vehicle::ChDeferredAssets::AddAsset(knuckle, cyl_T);
   }
 
   ChSharedPtr<ChColorAsset> col(new ChColorAsset);
   col->SetColor(ChColor(0.2f, 0.2f, 0.6f));
-  knuckle->AddAsset(col);
+  vehicle::ChDeferredAssets::AddAsset(knuckle, col);
 }
 
 
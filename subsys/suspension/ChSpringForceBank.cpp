@@ -0,0 +1,121 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched evaluation of tabulated spring and shock elements.
+//
+// =============================================================================
+
+#include "subsys/suspension/ChSpringForceBank.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Force callback of one element of the bank.
+// -----------------------------------------------------------------------------
+class ChSpringForceBank::Callback : public ChSpringForceCallback
+{
+public:
+  Callback(ChSpringForceBank* bank, int index) : m_bank(bank), m_index(index) {}
+
+  virtual double operator()(double time,         // current time
+                            double rest_length,  // undeformed length
+                            double length,       // current length
+                            double vel)          // current velocity (positive when extending)
+  {
+    if (length == m_bank->m_length[m_index] && vel == m_bank->m_vel[m_index])
+      return m_bank->m_force[m_index];
+
+    return m_bank->m_curves[m_index]->Evaluate(length, vel);
+  }
+
+private:
+  ChSpringForceBank* m_bank;
+  int                m_index;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSpringForceBank::~ChSpringForceBank()
+{
+  for (size_t i = 0; i < m_callbacks.size(); i++)
+    delete m_callbacks[i];
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChSpringForceBank::AddElement(ChSharedPtr<ChLinkSpringCB> link,
+                                  ChSharedPtr<ChForceCurve>   curve)
+{
+  int index = (int)m_links.size();
+
+  m_links.push_back(link.get_ptr());
+  m_curves.push_back(curve);
+  m_callbacks.push_back(new Callback(this, index));
+
+  // Start from the current state of the element.
+  m_length.push_back(link->Get_SpringLength());
+  m_vel.push_back(link->Get_SpringVelocity());
+  m_force.push_back(curve->Evaluate(m_length.back(), m_vel.back()));
+
+  link->Set_SpringCallback(m_callbacks.back());
+
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Gather the element states, then evaluate all forces. Consecutive elements
+// sharing a curve are evaluated in a single batch.
+// -----------------------------------------------------------------------------
+void ChSpringForceBank::Update()
+{
+  int n = (int)m_links.size();
+
+  for (int i = 0; i < n; i++) {
+    m_length[i] = m_links[i]->Get_SpringLength();
+    m_vel[i] = m_links[i]->Get_SpringVelocity();
+  }
+
+  int start = 0;
+  while (start < n) {
+    int end = start + 1;
+    while (end < n && m_curves[end].get_ptr() == m_curves[start].get_ptr())
+      end++;
+
+    m_curves[start]->Evaluate(end - start, &m_length[start], &m_vel[start], &m_force[start]);
+    start = end;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSpringForceBank::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  size_t bytes = sizeof(*this) +
+                 vehicle::ChMemoryReport::VectorBytes(m_links) +
+                 vehicle::ChMemoryReport::VectorBytes(m_curves) +
+                 vehicle::ChMemoryReport::VectorBytes(m_callbacks) +
+                 m_callbacks.size() * sizeof(Callback) +
+                 vehicle::ChMemoryReport::VectorBytes(m_length) +
+                 vehicle::ChMemoryReport::VectorBytes(m_vel) +
+                 vehicle::ChMemoryReport::VectorBytes(m_force);
+  report.Add("vehicle/banks", bytes);
+
+  for (size_t i = 0; i < m_curves.size(); i++)
+    report.AddShared("shared/force curves", m_curves[i].get_ptr(), m_curves[i]->GetMemoryFootprint());
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,91 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched evaluation of tabulated spring and shock elements.
+//
+// A spring force bank collects the ChLinkSpringCB elements of a vehicle whose
+// force is given by a tabulated curve (see ChForceCurve). Update() gathers the
+// current lengths and velocities of all elements into contiguous arrays and
+// evaluates all forces in one pass, once per step and ahead of the solver. The
+// callback installed on each element returns the precomputed force when it is
+// called with the state used in the batch evaluation and evaluates the curve
+// directly otherwise, so the element forces are always consistent with the
+// current state.
+//
+// =============================================================================
+
+#ifndef CH_SPRINGFORCEBANK_H
+#define CH_SPRINGFORCEBANK_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "physics/ChLinkSpringCB.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChMemoryReport.h"
+#include "subsys/suspension/ChForceCurve.h"
+
+namespace chrono {
+
+///
+/// Batched tabulated spring and shock elements of one vehicle.
+///
+class CH_SUBSYS_API ChSpringForceBank : public ChShared
+{
+public:
+
+  ChSpringForceBank() {}
+  ~ChSpringForceBank();
+
+  /// Add an element with the specified force curve and return its index in the
+  /// bank. This replaces the force callback of the element; the bank must
+  /// outlive the element.
+  int AddElement(
+    ChSharedPtr<ChLinkSpringCB>  link,    ///< [in] spring or shock element
+    ChSharedPtr<ChForceCurve>    curve    ///< [in] force as function of length and velocity
+    );
+
+  /// Return the number of elements in this bank.
+  int GetNumElements() const { return (int)m_links.size(); }
+
+  /// Evaluate the forces of all elements at their current state.
+  void Update();
+
+  /// Return the force of the specified element, as of the last update.
+  double GetForce(int index) const { return m_force[index]; }
+
+  /// Add the memory footprint of the bank to the specified report (the force
+  /// curves as shared objects).
+  void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+private:
+
+  class Callback;
+  friend class Callback;
+
+  std::vector<ChLinkSpringCB*>             m_links;
+  std::vector<ChSharedPtr<ChForceCurve> >  m_curves;
+  std::vector<Callback*>                   m_callbacks;
+
+  std::vector<double>                      m_length;
+  std::vector<double>                      m_vel;
+  std::vector<double>                      m_force;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,108 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Spring and shock force laws for the suspension templates.
+//
+// A force law is a small class with a non-virtual, inline call operator
+//
+//   double operator()(double time, double rest_length, double length, double vel) const
+//
+// and its parameters as data members. ChSpringForceT<LAW> adapts a force law to
+// the ChSpringForceCallback interface required by ChLinkSpringCB: the only
+// virtual call per spring and step is the one made by the link, and the law
+// itself is inlined in the callback. A concrete suspension with a nonlinear
+// element can bake its parameter set into a law (see HMMWV_ShockLaw) instead of
+// deriving its own callback class.
+//
+// =============================================================================
+
+#ifndef CH_SPRINGFORCET_H
+#define CH_SPRINGFORCET_H
+
+#include "physics/ChLinkSpringCB.h"
+
+namespace chrono {
+
+///
+/// Linear spring force law.
+///
+struct ChLinearSpringLaw
+{
+  explicit ChLinearSpringLaw(double k) : m_k(k) {}
+
+  double operator()(double time,         ///< current time
+                    double rest_length,  ///< undeformed length
+                    double length,       ///< current length
+                    double vel           ///< current velocity (positive when extending)
+                    ) const
+  {
+    return -m_k * (length - rest_length);
+  }
+
+  double  m_k;   ///< spring coefficient
+};
+
+///
+/// Linear shock (damper) force law.
+///
+struct ChLinearShockLaw
+{
+  explicit ChLinearShockLaw(double c) : m_c(c) {}
+
+  double operator()(double time,         ///< current time
+                    double rest_length,  ///< undeformed length
+                    double length,       ///< current length
+                    double vel           ///< current velocity (positive when extending)
+                    ) const
+  {
+    return -m_c * vel;
+  }
+
+  double  m_c;   ///< damping coefficient
+};
+
+///
+/// Spring force callback evaluating the force law LAW.
+///
+template <class LAW>
+class ChSpringForceT : public ChSpringForceCallback
+{
+public:
+
+  explicit ChSpringForceT(const LAW& law) : m_law(law) {}
+
+  virtual double operator()(double time,
+                            double rest_length,
+                            double length,
+                            double vel)
+  {
+    return m_law(time, rest_length, length, vel);
+  }
+
+  /// Get the force law evaluated by this callback.
+  const LAW& GetLaw() const { return m_law; }
+
+  /// Replace the parameters of the force law.
+  void SetLaw(const LAW& law) { m_law = law; }
+
+private:
+
+  LAW  m_law;
+};
+
+
+} // end namespace chrono
+
+
+#endif
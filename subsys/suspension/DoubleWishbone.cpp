@@ -19,126 +19,132 @@
 #include <cstdio>
 
 #include "subsys/suspension/DoubleWishbone.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+#include "subsys/ChVehicleModelData.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // Construct a double wishbone suspension using data from the specified JSON
-// file.
+// file. The hardpoint table is shared by all suspensions constructed from the
+// same file.
 // -----------------------------------------------------------------------------
 DoubleWishbone::DoubleWishbone(const std::string& filename)
-: ChDoubleWishbone("")
+: ChDoubleWishbone(""),
+  m_springCoefficient(0),
+  m_dampingCoefficient(0)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
+  m_table = ChHardpointTable::Load(filename, &DoubleWishbone::CreateTable);
   Create(d);
 }
 
 DoubleWishbone::DoubleWishbone(const rapidjson::Document& d)
-: ChDoubleWishbone("")
+: ChDoubleWishbone(""),
+  m_springCoefficient(0),
+  m_dampingCoefficient(0)
 {
   Create(d);
 }
 
-void DoubleWishbone::Create(const rapidjson::Document& d)
+ChSharedPtr<ChHardpointTable> DoubleWishbone::CreateTable(const rapidjson::Document& d)
 {
-  // Read top-level data
-  assert(d.HasMember("Type"));
-  assert(d.HasMember("Template"));
-  assert(d.HasMember("Name"));
-
-  SetName(d["Name"].GetString());
+  ChSharedPtr<ChHardpointTable> table(new ChHardpointTable(NUM_POINTS));
 
   // Read Spindle data
   assert(d.HasMember("Spindle"));
   assert(d["Spindle"].IsObject());
 
-  m_spindleMass = d["Spindle"]["Mass"].GetDouble();
-  m_points[SPINDLE] = loadVector(d["Spindle"]["COM"]);
-  m_spindleInertia = loadVector(d["Spindle"]["Inertia"]);
-  m_spindleRadius = d["Spindle"]["Radius"].GetDouble();
-  m_spindleWidth = d["Spindle"]["Width"].GetDouble();
+  table->SetPoint(SPINDLE, loadVector(d["Spindle"]["COM"]));
+  table->SetMassProperties(SPINDLE, d["Spindle"]["Mass"].GetDouble(), loadVector(d["Spindle"]["Inertia"]));
 
   // Read Upright data
   assert(d.HasMember("Upright"));
   assert(d["Upright"].IsObject());
 
-  m_uprightMass = d["Upright"]["Mass"].GetDouble();
-  m_points[UPRIGHT] = loadVector(d["Upright"]["COM"]);
-  m_uprightInertia = loadVector(d["Upright"]["Inertia"]);
-  m_uprightRadius = d["Upright"]["Radius"].GetDouble();
+  table->SetPoint(UPRIGHT, loadVector(d["Upright"]["COM"]));
+  table->SetMassProperties(UPRIGHT, d["Upright"]["Mass"].GetDouble(), loadVector(d["Upright"]["Inertia"]));
 
   // Read UCA data
   assert(d.HasMember("Upper Control Arm"));
   assert(d["Upper Control Arm"].IsObject());
 
-  m_UCAMass = d["Upper Control Arm"]["Mass"].GetDouble();
-  m_points[UCA_CM] = loadVector(d["Upper Control Arm"]["COM"]);
-  m_UCAInertia = loadVector(d["Upper Control Arm"]["Inertia"]);
-  m_UCARadius = d["Upper Control Arm"]["Radius"].GetDouble();
-  m_points[UCA_F] = loadVector(d["Upper Control Arm"]["Location Chassis Front"]);
-  m_points[UCA_B] = loadVector(d["Upper Control Arm"]["Location Chassis Back"]);
-  m_points[UCA_U] = loadVector(d["Upper Control Arm"]["Location Upright"]);
+  const Value& uca = d["Upper Control Arm"];
+  table->SetPoint(UCA_CM, loadVector(uca["COM"]));
+  table->SetMassProperties(UCA_CM, uca["Mass"].GetDouble(), loadVector(uca["Inertia"]));
+  table->SetPoint(UCA_F, loadVector(uca["Location Chassis Front"]));
+  table->SetPoint(UCA_B, loadVector(uca["Location Chassis Back"]));
+  table->SetPoint(UCA_U, loadVector(uca["Location Upright"]));
 
   // Read LCA data
   assert(d.HasMember("Lower Control Arm"));
   assert(d["Lower Control Arm"].IsObject());
 
-  m_LCAMass = d["Lower Control Arm"]["Mass"].GetDouble();
-  m_points[LCA_CM] = loadVector(d["Lower Control Arm"]["COM"]);
-  m_LCAInertia = loadVector(d["Lower Control Arm"]["Inertia"]);
-  m_LCARadius = d["Lower Control Arm"]["Radius"].GetDouble();
-  m_points[LCA_F] = loadVector(d["Lower Control Arm"]["Location Chassis Front"]);
-  m_points[LCA_B] = loadVector(d["Lower Control Arm"]["Location Chassis Back"]);
-  m_points[LCA_U] = loadVector(d["Lower Control Arm"]["Location Upright"]);
+  const Value& lca = d["Lower Control Arm"];
+  table->SetPoint(LCA_CM, loadVector(lca["COM"]));
+  table->SetMassProperties(LCA_CM, lca["Mass"].GetDouble(), loadVector(lca["Inertia"]));
+  table->SetPoint(LCA_F, loadVector(lca["Location Chassis Front"]));
+  table->SetPoint(LCA_B, loadVector(lca["Location Chassis Back"]));
+  table->SetPoint(LCA_U, loadVector(lca["Location Upright"]));
 
   // Read Tierod data
   assert(d.HasMember("Tierod"));
   assert(d["Tierod"].IsObject());
 
-  m_points[TIEROD_C] = loadVector(d["Tierod"]["Location Chassis"]);
-  m_points[TIEROD_U] = loadVector(d["Tierod"]["Location Upright"]);
+  table->SetPoint(TIEROD_C, loadVector(d["Tierod"]["Location Chassis"]));
+  table->SetPoint(TIEROD_U, loadVector(d["Tierod"]["Location Upright"]));
 
-  // Read spring data
+  // Read spring and shock locations
   assert(d.HasMember("Spring"));
   assert(d["Spring"].IsObject());
+  assert(d.HasMember("Shock"));
+  assert(d["Shock"].IsObject());
+
+  table->SetPoint(SPRING_C, loadVector(d["Spring"]["Location Chassis"]));
+  table->SetPoint(SPRING_A, loadVector(d["Spring"]["Location Arm"]));
+  table->SetPoint(SHOCK_C, loadVector(d["Shock"]["Location Chassis"]));
+  table->SetPoint(SHOCK_A, loadVector(d["Shock"]["Location Arm"]));
+
+  return table;
+}
+
+void DoubleWishbone::Create(const rapidjson::Document& d)
+{
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  SetName(d["Name"].GetString());
+
+  // Read the hardpoints and mass properties, unless shared.
+  if (m_table.IsNull())
+    m_table = CreateTable(d);
 
-  m_points[SPRING_C] = loadVector(d["Spring"]["Location Chassis"]);
-  m_points[SPRING_A] = loadVector(d["Spring"]["Location Arm"]);
-  m_springCoefficient = d["Spring"]["Spring Coefficient"].GetDouble();
+  // Read visualization sizes
+  m_spindleRadius = d["Spindle"]["Radius"].GetDouble();
+  m_spindleWidth = d["Spindle"]["Width"].GetDouble();
+  m_uprightRadius = d["Upright"]["Radius"].GetDouble();
+  m_UCARadius = d["Upper Control Arm"]["Radius"].GetDouble();
+  m_LCARadius = d["Lower Control Arm"]["Radius"].GetDouble();
+
+  // Read spring data
+  if (d["Spring"].HasMember("Curve"))
+    m_springForceCurve = ChForceCurve::Load(vehicle::GetDataFile(d["Spring"]["Curve"].GetString()));
+  else
+    m_springCoefficient = d["Spring"]["Spring Coefficient"].GetDouble();
   m_springRestLength = d["Spring"]["Free Length"].GetDouble();
 
   // Read shock data
-  assert(d.HasMember("Shock"));
-  assert(d["Shock"].IsObject());
-
-  m_points[SHOCK_C] = loadVector(d["Shock"]["Location Chassis"]);
-  m_points[SHOCK_A] = loadVector(d["Shock"]["Location Arm"]);
-  m_dampingCoefficient = d["Shock"]["Damping Coefficient"].GetDouble();
+  if (d["Shock"].HasMember("Curve"))
+    m_shockForceCurve = ChForceCurve::Load(vehicle::GetDataFile(d["Shock"]["Curve"].GetString()));
+  else
+    m_dampingCoefficient = d["Shock"]["Damping Coefficient"].GetDouble();
 
   // Read axle inertia
   assert(d.HasMember("Axle"));
@@ -148,4 +154,39 @@ void DoubleWishbone::Create(const rapidjson::Document& d)
 }
 
 
+// -----------------------------------------------------------------------------
+// The new values are read into a temporary suspension. The hardpoints and the
+// choice of linear or tabulated elements define the topology; the
+// visualization sizes are not reloaded.
+// -----------------------------------------------------------------------------
+bool DoubleWishbone::Reload(const rapidjson::Document& d)
+{
+  DoubleWishbone spec(d);
+
+  if (!spec.m_table->SameGeometry(*m_table))
+    return false;
+  if (spec.m_springForceCurve.IsNull() != m_springForceCurve.IsNull() ||
+      spec.m_shockForceCurve.IsNull() != m_shockForceCurve.IsNull())
+    return false;
+
+  // The table may be shared with other suspensions; it is replaced, not
+  // modified.
+  m_table = spec.m_table;
+  m_axleInertia = spec.m_axleInertia;
+  m_springCoefficient = spec.m_springCoefficient;
+  m_dampingCoefficient = spec.m_dampingCoefficient;
+  m_springRestLength = spec.m_springRestLength;
+
+  // The curves are shared with the force elements (and the spring bank).
+  if (!m_springForceCurve.IsNull() && spec.m_springForceCurve.get_ptr() != m_springForceCurve.get_ptr())
+    m_springForceCurve->Assign(*spec.m_springForceCurve);
+  if (!m_shockForceCurve.IsNull() && spec.m_shockForceCurve.get_ptr() != m_shockForceCurve.get_ptr())
+    m_shockForceCurve->Assign(*spec.m_shockForceCurve);
+
+  UpdateParameters();
+
+  return true;
+}
+
+
 } // end namespace chrono
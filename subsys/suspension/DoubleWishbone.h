@@ -20,6 +20,7 @@
 #define DOUBLEWISHBONE_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/suspension/ChDoubleWishbone.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API DoubleWishbone : public ChDoubleWishbone
+class CH_SUBSYS_API DoubleWishbone : public ChDoubleWishbone, public vehicle::ChReloadable
 {
 public:
 
@@ -35,10 +36,10 @@ public:
   DoubleWishbone(const rapidjson::Document& d);
   virtual ~DoubleWishbone() {}
 
-  virtual double getSpindleMass() const { return m_spindleMass; }
-  virtual double getUCAMass() const { return m_UCAMass; }
-  virtual double getLCAMass() const { return m_LCAMass; }
-  virtual double getUprightMass() const { return m_uprightMass; }
+  virtual double getSpindleMass() const { return m_table->GetMass(SPINDLE); }
+  virtual double getUCAMass() const { return m_table->GetMass(UCA_CM); }
+  virtual double getLCAMass() const { return m_table->GetMass(LCA_CM); }
+  virtual double getUprightMass() const { return m_table->GetMass(UPRIGHT); }
 
   virtual double getSpindleRadius() const { return m_spindleRadius; }
   virtual double getSpindleWidth() const { return m_spindleWidth; }
@@ -46,10 +47,10 @@ public:
   virtual double getLCARadius() const { return m_LCARadius; }
   virtual double getUprightRadius() const { return m_uprightRadius; }
 
-  virtual const ChVector<>& getSpindleInertia() const { return m_spindleInertia; }
-  virtual const ChVector<>& getUCAInertia() const { return m_UCAInertia; }
-  virtual const ChVector<>& getLCAInertia() const { return m_LCAInertia; }
-  virtual const ChVector<>& getUprightInertia() const { return m_uprightInertia; }
+  virtual const ChVector<>& getSpindleInertia() const { return m_table->GetInertia(SPINDLE); }
+  virtual const ChVector<>& getUCAInertia() const { return m_table->GetInertia(UCA_CM); }
+  virtual const ChVector<>& getLCAInertia() const { return m_table->GetInertia(LCA_CM); }
+  virtual const ChVector<>& getUprightInertia() const { return m_table->GetInertia(UPRIGHT); }
 
   virtual double getAxleInertia() const { return m_axleInertia; }
 
@@ -57,18 +58,25 @@ public:
   virtual double getDampingCoefficient() const { return m_dampingCoefficient; }
   virtual double getSpringRestLength() const { return m_springRestLength; }
 
+  virtual ChSharedPtr<ChForceCurve> getSpringForceCurve() const { return m_springForceCurve; }
+  virtual ChSharedPtr<ChForceCurve> getShockForceCurve() const  { return m_shockForceCurve; }
+
+  /// Apply the masses, inertias and spring and shock parameters of the specified
+  /// document in place (see ChHotReload). Returns false, with no change, if a
+  /// hardpoint changed or an element changed between linear and tabulated.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
-  virtual const ChVector<> getLocation(PointId which) { return m_points[which]; }
+  virtual const ChVector<> getLocation(PointId which) { return m_table->GetPoint(which); }
+  virtual ChSharedPtr<ChHardpointTable> getHardpointTable() { return m_table; }
 
   void Create(const rapidjson::Document& d);
 
-  ChVector<>  m_points[NUM_POINTS];
+  // Read the hardpoints and the mass properties of the specified document.
+  static ChSharedPtr<ChHardpointTable> CreateTable(const rapidjson::Document& d);
 
-  double      m_spindleMass;
-  double      m_UCAMass;
-  double      m_LCAMass;
-  double      m_uprightMass;
+  ChSharedPtr<ChHardpointTable>  m_table;
 
   double      m_spindleRadius;
   double      m_spindleWidth;
@@ -76,16 +84,14 @@ private:
   double      m_LCARadius;
   double      m_uprightRadius;
 
-  ChVector<>  m_spindleInertia;
-  ChVector<>  m_UCAInertia;
-  ChVector<>  m_LCAInertia;
-  ChVector<>  m_uprightInertia;
-
   double      m_axleInertia;
 
   double      m_springCoefficient;
   double      m_dampingCoefficient;
   double      m_springRestLength;
+
+  ChSharedPtr<ChForceCurve>  m_springForceCurve;
+  ChSharedPtr<ChForceCurve>  m_shockForceCurve;
 };
 
 
@@ -19,25 +19,14 @@
 #include <cstdio>
 
 #include "subsys/suspension/DoubleWishboneReduced.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // Construct a reduced double wishbone suspension using data from the specified
 // JSON file.
@@ -45,15 +34,7 @@ static ChVector<> loadVector(const Value& a)
 DoubleWishboneReduced::DoubleWishboneReduced(const std::string& filename)
 : ChDoubleWishboneReduced("")
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -138,4 +119,32 @@ void DoubleWishboneReduced::Create(const rapidjson::Document& d)
 }
 
 
+// -----------------------------------------------------------------------------
+// The new values are read into a temporary suspension. The hardpoints define
+// the topology; the visualization sizes are not reloaded.
+// -----------------------------------------------------------------------------
+bool DoubleWishboneReduced::Reload(const rapidjson::Document& d)
+{
+  DoubleWishboneReduced spec(d);
+
+  for (int i = 0; i < NUM_POINTS; i++) {
+    if (spec.m_points[i] != m_points[i])
+      return false;
+  }
+
+  m_spindleMass = spec.m_spindleMass;
+  m_uprightMass = spec.m_uprightMass;
+  m_spindleInertia = spec.m_spindleInertia;
+  m_uprightInertia = spec.m_uprightInertia;
+  m_axleInertia = spec.m_axleInertia;
+  m_springCoefficient = spec.m_springCoefficient;
+  m_dampingCoefficient = spec.m_dampingCoefficient;
+  m_springRestLength = spec.m_springRestLength;
+
+  UpdateParameters();
+
+  return true;
+}
+
+
 } // end namespace chrono
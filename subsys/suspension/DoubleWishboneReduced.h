@@ -20,6 +20,7 @@
 #define DOUBLEWISHBONEREDUCED_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/suspension/ChDoubleWishboneReduced.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API DoubleWishboneReduced : public ChDoubleWishboneReduced
+class CH_SUBSYS_API DoubleWishboneReduced : public ChDoubleWishboneReduced, public vehicle::ChReloadable
 {
 public:
 
@@ -51,6 +52,11 @@ public:
   virtual double getDampingCoefficient() const { return m_dampingCoefficient; }
   virtual double getSpringRestLength() const { return m_springRestLength; }
 
+  /// Apply the masses, inertias and spring and shock parameters of the specified
+  /// document in place (see ChHotReload). Returns false, with no change, if a
+  /// hardpoint changed.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
   virtual const ChVector<> getLocation(PointId which) { return m_points[which]; }
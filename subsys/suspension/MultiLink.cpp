@@ -19,141 +19,146 @@
 #include <cstdio>
 
 #include "subsys/suspension/MultiLink.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+#include "subsys/ChVehicleModelData.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // Construct a multi-link suspension using data from the specified JSON
-// file.
+// file. The hardpoint table is shared by all suspensions constructed from the
+// same file.
 // -----------------------------------------------------------------------------
 MultiLink::MultiLink(const std::string& filename)
-: ChMultiLink("")
+: ChMultiLink(""),
+  m_springCoefficient(0),
+  m_dampingCoefficient(0)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
+  m_table = ChHardpointTable::Load(filename, &MultiLink::CreateTable);
   Create(d);
 }
 
 MultiLink::MultiLink(const rapidjson::Document& d)
-: ChMultiLink("")
+: ChMultiLink(""),
+  m_springCoefficient(0),
+  m_dampingCoefficient(0)
 {
   Create(d);
 }
 
-void MultiLink::Create(const rapidjson::Document& d)
+ChSharedPtr<ChHardpointTable> MultiLink::CreateTable(const rapidjson::Document& d)
 {
-
-  // Read top-level data
-  assert(d.HasMember("Type"));
-  assert(d.HasMember("Template"));
-  assert(d.HasMember("Name"));
-
-  SetName(d["Name"].GetString());
+  ChSharedPtr<ChHardpointTable> table(new ChHardpointTable(NUM_POINTS, NUM_DIRS));
 
   // Read Spindle data
   assert(d.HasMember("Spindle"));
   assert(d["Spindle"].IsObject());
 
-  m_spindleMass = d["Spindle"]["Mass"].GetDouble();
-  m_points[SPINDLE] = loadVector(d["Spindle"]["COM"]);
-  m_spindleInertia = loadVector(d["Spindle"]["Inertia"]);
-  m_spindleRadius = d["Spindle"]["Radius"].GetDouble();
-  m_spindleWidth = d["Spindle"]["Width"].GetDouble();
+  table->SetPoint(SPINDLE, loadVector(d["Spindle"]["COM"]));
+  table->SetMassProperties(SPINDLE, d["Spindle"]["Mass"].GetDouble(), loadVector(d["Spindle"]["Inertia"]));
 
   // Read Upright data
   assert(d.HasMember("Upright"));
   assert(d["Upright"].IsObject());
 
-  m_uprightMass = d["Upright"]["Mass"].GetDouble();
-  m_points[UPRIGHT] = loadVector(d["Upright"]["COM"]);
-  m_uprightInertia = loadVector(d["Upright"]["Inertia"]);
-  m_uprightRadius = d["Upright"]["Radius"].GetDouble();
+  table->SetPoint(UPRIGHT, loadVector(d["Upright"]["COM"]));
+  table->SetMassProperties(UPRIGHT, d["Upright"]["Mass"].GetDouble(), loadVector(d["Upright"]["Inertia"]));
 
   // Read Upper Arm data
   assert(d.HasMember("Upper Arm"));
   assert(d["Upper Arm"].IsObject());
 
-  m_upperArmMass = d["Upper Arm"]["Mass"].GetDouble();
-  m_points[UA_CM] = loadVector(d["Upper Arm"]["COM"]);
-  m_upperArmInertia = loadVector(d["Upper Arm"]["Inertia"]);
-  m_upperArmRadius = d["Upper Arm"]["Radius"].GetDouble();
-  m_points[UA_F] = loadVector(d["Upper Arm"]["Location Chassis Front"]);
-  m_points[UA_B] = loadVector(d["Upper Arm"]["Location Chassis Back"]);
-  m_points[UA_U] = loadVector(d["Upper Arm"]["Location Upright"]);
+  const Value& ua = d["Upper Arm"];
+  table->SetPoint(UA_CM, loadVector(ua["COM"]));
+  table->SetMassProperties(UA_CM, ua["Mass"].GetDouble(), loadVector(ua["Inertia"]));
+  table->SetPoint(UA_F, loadVector(ua["Location Chassis Front"]));
+  table->SetPoint(UA_B, loadVector(ua["Location Chassis Back"]));
+  table->SetPoint(UA_U, loadVector(ua["Location Upright"]));
 
   // Read Lateral data
   assert(d.HasMember("Lateral"));
   assert(d["Lateral"].IsObject());
 
-  m_lateralMass = d["Lateral"]["Mass"].GetDouble();
-  m_points[LAT_CM] = loadVector(d["Lateral"]["COM"]);
-  m_lateralInertia = loadVector(d["Lateral"]["Inertia"]);
-  m_lateralRadius = d["Lateral"]["Radius"].GetDouble();
-  m_points[LAT_C] = loadVector(d["Lateral"]["Location Chassis"]);
-  m_points[LAT_U] = loadVector(d["Lateral"]["Location Upright"]);
-  m_directions[UNIV_AXIS_LINK_LAT] = loadVector(d["Lateral"]["Universal Joint Axis Link"]);
-  m_directions[UNIV_AXIS_CHASSIS_LAT] = loadVector(d["Lateral"]["Universal Joint Axis Chassis"]);
+  const Value& lat = d["Lateral"];
+  table->SetPoint(LAT_CM, loadVector(lat["COM"]));
+  table->SetMassProperties(LAT_CM, lat["Mass"].GetDouble(), loadVector(lat["Inertia"]));
+  table->SetPoint(LAT_C, loadVector(lat["Location Chassis"]));
+  table->SetPoint(LAT_U, loadVector(lat["Location Upright"]));
+  table->SetDirection(UNIV_AXIS_LINK_LAT, loadVector(lat["Universal Joint Axis Link"]));
+  table->SetDirection(UNIV_AXIS_CHASSIS_LAT, loadVector(lat["Universal Joint Axis Chassis"]));
 
   // Read Trailing Link data
   assert(d.HasMember("Trailing Link"));
   assert(d["Trailing Link"].IsObject());
 
-  m_trailingLinkMass = d["Trailing Link"]["Mass"].GetDouble();
-  m_points[TL_CM] = loadVector(d["Trailing Link"]["COM"]);
-  m_trailingLinkInertia = loadVector(d["Trailing Link"]["Inertia"]);
-  m_trailingLinkRadius = d["Trailing Link"]["Radius"].GetDouble();
-  m_points[TL_C] = loadVector(d["Trailing Link"]["Location Chassis"]);
-  m_points[TL_U] = loadVector(d["Trailing Link"]["Location Upright"]);
-  m_directions[UNIV_AXIS_LINK_TL] = loadVector(d["Trailing Link"]["Universal Joint Axis Link"]);
-  m_directions[UNIV_AXIS_CHASSIS_TL] = loadVector(d["Trailing Link"]["Universal Joint Axis Chassis"]);
+  const Value& tl = d["Trailing Link"];
+  table->SetPoint(TL_CM, loadVector(tl["COM"]));
+  table->SetMassProperties(TL_CM, tl["Mass"].GetDouble(), loadVector(tl["Inertia"]));
+  table->SetPoint(TL_C, loadVector(tl["Location Chassis"]));
+  table->SetPoint(TL_U, loadVector(tl["Location Upright"]));
+  table->SetDirection(UNIV_AXIS_LINK_TL, loadVector(tl["Universal Joint Axis Link"]));
+  table->SetDirection(UNIV_AXIS_CHASSIS_TL, loadVector(tl["Universal Joint Axis Chassis"]));
 
   // Read Tierod data
   assert(d.HasMember("Tierod"));
   assert(d["Tierod"].IsObject());
 
-  m_points[TIEROD_C] = loadVector(d["Tierod"]["Location Chassis"]);
-  m_points[TIEROD_U] = loadVector(d["Tierod"]["Location Upright"]);
+  table->SetPoint(TIEROD_C, loadVector(d["Tierod"]["Location Chassis"]));
+  table->SetPoint(TIEROD_U, loadVector(d["Tierod"]["Location Upright"]));
 
-  // Read spring data
+  // Read spring and shock locations
   assert(d.HasMember("Spring"));
   assert(d["Spring"].IsObject());
+  assert(d.HasMember("Shock"));
+  assert(d["Shock"].IsObject());
+
+  table->SetPoint(SPRING_C, loadVector(d["Spring"]["Location Chassis"]));
+  table->SetPoint(SPRING_L, loadVector(d["Spring"]["Location Link"]));
+  table->SetPoint(SHOCK_C, loadVector(d["Shock"]["Location Chassis"]));
+  table->SetPoint(SHOCK_L, loadVector(d["Shock"]["Location Link"]));
 
-  m_points[SPRING_C] = loadVector(d["Spring"]["Location Chassis"]);
-  m_points[SPRING_L] = loadVector(d["Spring"]["Location Link"]);
-  m_springCoefficient = d["Spring"]["Spring Coefficient"].GetDouble();
+  return table;
+}
+
+void MultiLink::Create(const rapidjson::Document& d)
+{
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  SetName(d["Name"].GetString());
+
+  // Read the hardpoints, directions and mass properties, unless shared.
+  if (m_table.IsNull())
+    m_table = CreateTable(d);
+
+  // Read visualization sizes
+  m_spindleRadius = d["Spindle"]["Radius"].GetDouble();
+  m_spindleWidth = d["Spindle"]["Width"].GetDouble();
+  m_uprightRadius = d["Upright"]["Radius"].GetDouble();
+  m_upperArmRadius = d["Upper Arm"]["Radius"].GetDouble();
+  m_lateralRadius = d["Lateral"]["Radius"].GetDouble();
+  m_trailingLinkRadius = d["Trailing Link"]["Radius"].GetDouble();
+
+  // Read spring data
+  if (d["Spring"].HasMember("Curve"))
+    m_springForceCurve = ChForceCurve::Load(vehicle::GetDataFile(d["Spring"]["Curve"].GetString()));
+  else
+    m_springCoefficient = d["Spring"]["Spring Coefficient"].GetDouble();
   m_springRestLength = d["Spring"]["Free Length"].GetDouble();
 
   // Read shock data
-  assert(d.HasMember("Shock"));
-  assert(d["Shock"].IsObject());
-
-  m_points[SHOCK_C] = loadVector(d["Shock"]["Location Chassis"]);
-  m_points[SHOCK_L] = loadVector(d["Shock"]["Location Link"]);
-  m_dampingCoefficient = d["Shock"]["Damping Coefficient"].GetDouble();
+  if (d["Shock"].HasMember("Curve"))
+    m_shockForceCurve = ChForceCurve::Load(vehicle::GetDataFile(d["Shock"]["Curve"].GetString()));
+  else
+    m_dampingCoefficient = d["Shock"]["Damping Coefficient"].GetDouble();
 
   // Read axle inertia
   assert(d.HasMember("Axle"));
@@ -163,4 +168,39 @@ void MultiLink::Create(const rapidjson::Document& d)
 }
 
 
+// -----------------------------------------------------------------------------
+// The new values are read into a temporary suspension. The hardpoints and the
+// choice of linear or tabulated elements define the topology; the
+// visualization sizes are not reloaded.
+// -----------------------------------------------------------------------------
+bool MultiLink::Reload(const rapidjson::Document& d)
+{
+  MultiLink spec(d);
+
+  if (!spec.m_table->SameGeometry(*m_table))
+    return false;
+  if (spec.m_springForceCurve.IsNull() != m_springForceCurve.IsNull() ||
+      spec.m_shockForceCurve.IsNull() != m_shockForceCurve.IsNull())
+    return false;
+
+  // The table may be shared with other suspensions; it is replaced, not
+  // modified.
+  m_table = spec.m_table;
+  m_axleInertia = spec.m_axleInertia;
+  m_springCoefficient = spec.m_springCoefficient;
+  m_dampingCoefficient = spec.m_dampingCoefficient;
+  m_springRestLength = spec.m_springRestLength;
+
+  // The curves are shared with the force elements (and the spring bank).
+  if (!m_springForceCurve.IsNull() && spec.m_springForceCurve.get_ptr() != m_springForceCurve.get_ptr())
+    m_springForceCurve->Assign(*spec.m_springForceCurve);
+  if (!m_shockForceCurve.IsNull() && spec.m_shockForceCurve.get_ptr() != m_shockForceCurve.get_ptr())
+    m_shockForceCurve->Assign(*spec.m_shockForceCurve);
+
+  UpdateParameters();
+
+  return true;
+}
+
+
 } // end namespace chrono
@@ -20,6 +20,7 @@
 #define MULTILINK_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/suspension/ChMultiLink.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API MultiLink : public ChMultiLink
+class CH_SUBSYS_API MultiLink : public ChMultiLink, public vehicle::ChReloadable
 {
 public:
 
@@ -35,11 +36,11 @@ public:
   MultiLink(const rapidjson::Document& d);
   virtual ~MultiLink() {}
 
-  virtual double getSpindleMass() const { return m_spindleMass; }
-  virtual double getUpperArmMass() const { return m_upperArmMass; }
-  virtual double getLateralMass() const { return m_lateralMass; }
-  virtual double getTrailingLinkMass() const { return m_trailingLinkMass; }
-  virtual double getUprightMass() const { return m_uprightMass; }
+  virtual double getSpindleMass() const { return m_table->GetMass(SPINDLE); }
+  virtual double getUpperArmMass() const { return m_table->GetMass(UA_CM); }
+  virtual double getLateralMass() const { return m_table->GetMass(LAT_CM); }
+  virtual double getTrailingLinkMass() const { return m_table->GetMass(TL_CM); }
+  virtual double getUprightMass() const { return m_table->GetMass(UPRIGHT); }
 
   virtual double getSpindleRadius() const { return m_spindleRadius; }
   virtual double getSpindleWidth() const { return m_spindleWidth; }
@@ -48,11 +49,11 @@ public:
   virtual double getTrailingLinkRadius() const { return m_trailingLinkRadius; }
   virtual double getUprightRadius() const { return m_uprightRadius; }
 
-  virtual const ChVector<>& getSpindleInertia() const { return m_spindleInertia; }
-  virtual const ChVector<>& getUpperArmInertia() const { return m_upperArmInertia; }
-  virtual const ChVector<>& getLateralInertia() const { return m_lateralInertia; }
-  virtual const ChVector<>& getTrailingLinkInertia() const { return m_trailingLinkInertia; }
-  virtual const ChVector<>& getUprightInertia() const { return m_uprightInertia; }
+  virtual const ChVector<>& getSpindleInertia() const { return m_table->GetInertia(SPINDLE); }
+  virtual const ChVector<>& getUpperArmInertia() const { return m_table->GetInertia(UA_CM); }
+  virtual const ChVector<>& getLateralInertia() const { return m_table->GetInertia(LAT_CM); }
+  virtual const ChVector<>& getTrailingLinkInertia() const { return m_table->GetInertia(TL_CM); }
+  virtual const ChVector<>& getUprightInertia() const { return m_table->GetInertia(UPRIGHT); }
 
   virtual double getAxleInertia() const { return m_axleInertia; }
 
@@ -60,21 +61,27 @@ public:
   virtual double getDampingCoefficient() const { return m_dampingCoefficient; }
   virtual double getSpringRestLength() const { return m_springRestLength; }
 
+  virtual ChSharedPtr<ChForceCurve> getSpringForceCurve() const { return m_springForceCurve; }
+  virtual ChSharedPtr<ChForceCurve> getShockForceCurve() const  { return m_shockForceCurve; }
+
+  /// Apply the masses, inertias and spring and shock parameters of the specified
+  /// document in place (see ChHotReload). Returns false, with no change, if a
+  /// hardpoint changed or an element changed between linear and tabulated.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
-  virtual const ChVector<> getLocation(PointId which) { return m_points[which]; }
-  virtual const ChVector<> getDirection(DirectionId which) { return m_directions[which]; }
+  virtual const ChVector<> getLocation(PointId which) { return m_table->GetPoint(which); }
+  virtual const ChVector<> getDirection(DirectionId which) { return m_table->GetDirection(which); }
+  virtual ChSharedPtr<ChHardpointTable> getHardpointTable() { return m_table; }
 
   void Create(const rapidjson::Document& d);
 
-  ChVector<>  m_points[NUM_POINTS];
-  ChVector<>  m_directions[NUM_DIRS];
+  // Read the hardpoints, directions and mass properties of the specified
+  // document.
+  static ChSharedPtr<ChHardpointTable> CreateTable(const rapidjson::Document& d);
 
-  double      m_spindleMass;
-  double      m_upperArmMass;
-  double      m_lateralMass;
-  double      m_trailingLinkMass;
-  double      m_uprightMass;
+  ChSharedPtr<ChHardpointTable>  m_table;
 
   double      m_spindleRadius;
   double      m_spindleWidth;
@@ -83,17 +90,14 @@ private:
   double      m_trailingLinkRadius;
   double      m_uprightRadius;
 
-  ChVector<>  m_spindleInertia;
-  ChVector<>  m_upperArmInertia;
-  ChVector<>  m_lateralInertia;
-  ChVector<>  m_trailingLinkInertia;
-  ChVector<>  m_uprightInertia;
-
   double      m_axleInertia;
 
   double      m_springCoefficient;
   double      m_dampingCoefficient;
   double      m_springRestLength;
+
+  ChSharedPtr<ChForceCurve>  m_springForceCurve;
+  ChSharedPtr<ChForceCurve>  m_shockForceCurve;
 };
 
 
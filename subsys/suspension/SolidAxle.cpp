@@ -19,25 +19,14 @@
 #include <cstdio>
 
 #include "subsys/suspension/SolidAxle.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // Construct a solid axle suspension using data from the specified JSON
 // file.
@@ -45,15 +34,7 @@ static ChVector<> loadVector(const Value& a)
 SolidAxle::SolidAxle(const std::string& filename)
 : ChSolidAxle("")
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -161,4 +142,44 @@ void SolidAxle::Create(const rapidjson::Document& d)
 }
 
 
+// -----------------------------------------------------------------------------
+// The new values are read into a temporary suspension. The hardpoints define
+// the topology; the visualization sizes are not reloaded.
+// -----------------------------------------------------------------------------
+bool SolidAxle::Reload(const rapidjson::Document& d)
+{
+  SolidAxle spec(d);
+
+  for (int i = 0; i < NUM_POINTS; i++) {
+    if (spec.m_points[i] != m_points[i])
+      return false;
+  }
+  for (int i = 0; i < NUM_DIRS; i++) {
+    if (spec.m_directions[i] != m_directions[i])
+      return false;
+  }
+  if (spec.m_axleTubeCOM != m_axleTubeCOM)
+    return false;
+
+  m_axleTubeMass = spec.m_axleTubeMass;
+  m_spindleMass = spec.m_spindleMass;
+  m_ULMass = spec.m_ULMass;
+  m_LLMass = spec.m_LLMass;
+  m_knuckleMass = spec.m_knuckleMass;
+  m_axleTubeInertia = spec.m_axleTubeInertia;
+  m_spindleInertia = spec.m_spindleInertia;
+  m_ULInertia = spec.m_ULInertia;
+  m_LLInertia = spec.m_LLInertia;
+  m_knuckleInertia = spec.m_knuckleInertia;
+  m_axleInertia = spec.m_axleInertia;
+  m_springCoefficient = spec.m_springCoefficient;
+  m_dampingCoefficient = spec.m_dampingCoefficient;
+  m_springRestLength = spec.m_springRestLength;
+
+  UpdateParameters();
+
+  return true;
+}
+
+
 } // end namespace chrono
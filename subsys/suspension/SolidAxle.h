@@ -20,6 +20,7 @@
 #define SOLIDAXLE_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/suspension/ChSolidAxle.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API SolidAxle : public ChSolidAxle
+class CH_SUBSYS_API SolidAxle : public ChSolidAxle, public vehicle::ChReloadable
 {
 public:
 
@@ -62,6 +63,11 @@ public:
 
   virtual const ChVector<> getAxleTubeCOM() const { return m_axleTubeCOM; }
 
+  /// Apply the masses, inertias and spring and shock parameters of the specified
+  /// document in place (see ChHotReload). Returns false, with no change, if a
+  /// hardpoint changed.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
   virtual const ChVector<> getLocation(PointId which) { return m_points[which]; }
@@ -0,0 +1,294 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static kinematics sweep of a suspension test rig.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "core/ChLog.h"
+
+#include "subsys/suspensionTest/SuspensionSweep.h"
+
+namespace chrono {
+
+using namespace vehicle;
+
+
+// -----------------------------------------------------------------------------
+// Task solving one line of the grid.
+// -----------------------------------------------------------------------------
+class SuspensionSweepTask : public ChTask
+{
+public:
+  SuspensionSweepTask(SuspensionSweep* sweep, int line) : m_sweep(sweep), m_line(line) {}
+
+  virtual void Execute(int worker) { m_sweep->SolveLine(worker, m_line); }
+
+private:
+  SuspensionSweep* m_sweep;
+  int              m_line;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+SuspensionSweep::SuspensionSweep(const std::string&  filename,
+                                 const ChCoordsys<>& rig_pos,
+                                 int                 num_threads)
+: m_filename(filename),
+  m_rig_pos(rig_pos),
+  m_warm_start(true),
+  m_kinematic(false),
+  m_pool(0)
+{
+  for (int k = 0; k < 3; k++)
+    m_num[k] = 0;
+
+  if (num_threads != 1)
+    m_pool = new ChThreadPool(num_threads);
+}
+
+SuspensionSweep::~SuspensionSweep()
+{
+  delete m_pool;
+
+  for (size_t i = 0; i < m_tasks.size(); i++)
+    delete m_tasks[i];
+  for (size_t i = 0; i < m_rigs.size(); i++)
+    delete m_rigs[i];
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int SuspensionSweep::GetIndex(int i_left, int i_right, int i_steering) const
+{
+  return (i_steering * m_num[1] + i_right) * m_num[0] + i_left;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void SuspensionSweep::Run()
+{
+  for (int k = 0; k < 3; k++) {
+    if (m_values[k].empty())
+      m_values[k].push_back(0.0);
+    m_num[k] = (int)m_values[k].size();
+  }
+
+  // Create one rig per worker and record its design configuration.
+  if (m_rigs.empty()) {
+    int num_rigs = GetNumThreads();
+    m_design.resize(num_rigs);
+    for (int w = 0; w < num_rigs; w++) {
+      SuspensionTest* rig = new SuspensionTest(m_filename);
+      rig->Initialize(m_rig_pos);
+      SaveConfiguration(rig, m_design[w]);
+      m_rigs.push_back(rig);
+    }
+  }
+
+  m_results.resize(m_num[0] * m_num[1] * m_num[2]);
+
+  int num_lines = m_num[1] * m_num[2];
+
+  if (!m_pool) {
+    for (int line = 0; line < num_lines; line++)
+      SolveLine(0, line);
+    return;
+  }
+
+  for (int line = (int)m_tasks.size(); line < num_lines; line++)
+    m_tasks.push_back(new SuspensionSweepTask(this, line));
+
+  for (int line = 0; line < num_lines; line++)
+    m_pool->Submit(m_tasks[line]);
+  m_pool->Wait();
+}
+
+// -----------------------------------------------------------------------------
+// Solve the points of one line, starting at the point closest to zero left
+// displacement and moving outwards. With warm starting, each point starts from
+// the configuration of its inner neighbour.
+// -----------------------------------------------------------------------------
+void SuspensionSweep::SolveLine(int worker, int line)
+{
+  SuspensionTest* rig = m_rigs[worker];
+  const Configuration& design = m_design[worker];
+  int first = line * m_num[0];
+
+  int start = 0;
+  for (int i = 1; i < m_num[0]; i++) {
+    if (std::abs(m_values[0][i]) < std::abs(m_values[0][start]))
+      start = i;
+  }
+
+  RestoreConfiguration(rig, design);
+  SolvePoint(rig, first + start);
+
+  Configuration start_config;
+  if (m_warm_start)
+    SaveConfiguration(rig, start_config);
+
+  for (int i = start + 1; i < m_num[0]; i++) {
+    if (!m_warm_start)
+      RestoreConfiguration(rig, design);
+    SolvePoint(rig, first + i);
+  }
+
+  RestoreConfiguration(rig, m_warm_start ? start_config : design);
+  for (int i = start - 1; i >= 0; i--) {
+    if (!m_warm_start)
+      RestoreConfiguration(rig, design);
+    SolvePoint(rig, first + i);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void SuspensionSweep::SolvePoint(SuspensionTest* rig, int index)
+{
+  int i_left = index % m_num[0];
+  int i_right = (index / m_num[0]) % m_num[1];
+  int i_steering = index / (m_num[0] * m_num[1]);
+
+  Result& res = m_results[index];
+  res.disp[LEFT] = m_values[0][i_left];
+  res.disp[RIGHT] = m_values[1][i_right];
+  res.steering = m_values[2][i_steering];
+
+  // Set the rig inputs (no tire forces) and assemble the rig.
+  if (m_kinematic) {
+    res.violation = rig->SolveKinematics(res.steering, res.disp[LEFT], res.disp[RIGHT]);
+  } else {
+    ChTireForces tire_forces(2);
+    rig->Update(rig->GetChTime(), res.steering, res.disp[LEFT], res.disp[RIGHT], tire_forces);
+    rig->DoFullAssembly();
+    res.violation = GetConstraintViolation(rig);
+  }
+
+  for (int side = LEFT; side <= RIGHT; side++) {
+    ChVehicleSide s = (ChVehicleSide)side;
+    ChWheelID wheel_id(0, s);
+
+    // The offsets use the angles computed first.
+    res.kingpin_angle[side] = rig->Get_KingpinAng(s);
+    res.kingpin_offset[side] = rig->Get_KingpinOffset(s);
+    res.caster_angle[side] = rig->Get_CasterAng(s);
+    res.caster_offset[side] = rig->Get_CasterOffset(s);
+    res.toe_angle[side] = rig->Get_ToeAng(s);
+    res.spindle_pos[side] = rig->GetWheelPos(wheel_id);
+    res.spring_length[side] = rig->GetSpringLength(wheel_id);
+    res.spring_force[side] = rig->GetSpringForce(wheel_id);
+    res.shock_length[side] = rig->GetShockLength(wheel_id);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void SuspensionSweep::SaveConfiguration(ChSystem* system, Configuration& config)
+{
+  config.clear();
+
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody)
+    config.push_back(ChCoordsys<>((*ibody)->GetPos(), (*ibody)->GetRot()));
+}
+
+void SuspensionSweep::RestoreConfiguration(ChSystem* system, const Configuration& config)
+{
+  size_t i = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end() && i < config.size(); ++ibody, ++i) {
+    (*ibody)->SetPos(config[i].pos);
+    (*ibody)->SetRot(config[i].rot);
+    (*ibody)->SetPos_dt(ChVector<>(0, 0, 0));
+    (*ibody)->SetRot_dt(ChQuaternion<>(0, 0, 0, 0));
+    (*ibody)->SetPos_dtdt(ChVector<>(0, 0, 0));
+    (*ibody)->SetRot_dtdt(ChQuaternion<>(0, 0, 0, 0));
+  }
+}
+
+double SuspensionSweep::GetConstraintViolation(ChSystem* system)
+{
+  double violation = 0;
+
+  std::vector<ChLink*>::iterator ilink = system->Get_linklist()->begin();
+  for (; ilink != system->Get_linklist()->end(); ++ilink) {
+    ChMatrix<>* C = (*ilink)->GetC();
+    if (!C)
+      continue;
+    for (int i = 0; i < C->GetRows(); i++)
+      violation = std::max(violation, std::abs(C->GetElement(i, 0)));
+  }
+
+  return violation;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool SuspensionSweep::WriteResults(const std::string&       filename,
+                                   ChOutputChannel::Format  format) const
+{
+  ChOutputChannel channel;
+
+  std::string header = "disp_L,disp_R,steering,violation";
+  const char* names[] = { "kingpin_ang", "kingpin_offset", "caster_ang", "caster_offset", "toe_ang",
+                          "spindle_x", "spindle_y", "spindle_z",
+                          "spring_length", "spring_force", "shock_length" };
+  for (int side = LEFT; side <= RIGHT; side++) {
+    for (int k = 0; k < 11; k++) {
+      header += ",";
+      header += names[k];
+      header += (side == LEFT) ? "_L" : "_R";
+    }
+  }
+
+  if (!channel.Open(filename, header, format))
+    return false;
+
+  double row[4 + 2 * 11];
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const Result& res = m_results[i];
+    row[0] = res.disp[LEFT];
+    row[1] = res.disp[RIGHT];
+    row[2] = res.steering;
+    row[3] = res.violation;
+    for (int side = LEFT; side <= RIGHT; side++) {
+      double* r = row + 4 + 11 * side;
+      r[0] = res.kingpin_angle[side];
+      r[1] = res.kingpin_offset[side];
+      r[2] = res.caster_angle[side];
+      r[3] = res.caster_offset[side];
+      r[4] = res.toe_angle[side];
+      r[5] = res.spindle_pos[side].x;
+      r[6] = res.spindle_pos[side].y;
+      r[7] = res.spindle_pos[side].z;
+      r[8] = res.spring_length[side];
+      r[9] = res.spring_force[side];
+      r[10] = res.shock_length[side];
+    }
+    channel.Write(row);
+  }
+
+  channel.Close();
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,169 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Quasi-static kinematics sweep of a suspension test rig.
+//
+// The sweep evaluates the suspension on the full grid of (left post
+// displacement, right post displacement, steering input) combinations. Each
+// grid point is an independent quasi-static solve: the rig inputs are set and
+// the rig is assembled (positions, velocities, accelerations) at these inputs,
+// without time integration.
+//
+// The grid is processed in lines along the left post displacement. Lines are
+// distributed over a thread pool, with one SuspensionTest rig per worker
+// thread. Within a line, the solves start at the point closest to zero left
+// displacement and proceed towards both ends; with warm starting enabled
+// (default), each solve starts from the converged configuration of its
+// neighbour in the line, otherwise from the design configuration of the rig.
+// Since each line starts from the design configuration, the results do not
+// depend on the number of threads.
+//
+// In kinematic mode (see SetKinematic()), each solve only satisfies the
+// position-level constraints (SuspensionTest::SolveKinematics), which is
+// enough for the alignment metrics and the spring and shock lengths; the
+// spring and shock forces are then their values at rest.
+//
+// The rig is measured as in SuspensionTest (double wishbone suspensions only).
+//
+// =============================================================================
+
+#ifndef SUSPENSIONSWEEP_H
+#define SUSPENSIONSWEEP_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChCoordsys.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChOutputChannel.h"
+#include "subsys/ChThreadPool.h"
+#include "subsys/suspensionTest/SuspensionTest.h"
+
+namespace chrono {
+
+class SuspensionSweepTask;
+
+///
+/// Parallel quasi-static sweep over a SuspensionTest rig.
+///
+class CH_SUBSYS_API SuspensionSweep
+{
+public:
+
+  /// Measurements at one grid point.
+  struct Result {
+    double  disp[2];            ///< post displacements (left/right)
+    double  steering;           ///< steering input
+    double  violation;          ///< largest constraint violation after assembly
+    double  kingpin_angle[2];   ///< kingpin angles [rad] (left/right)
+    double  kingpin_offset[2];  ///< kingpin offsets (left/right)
+    double  caster_angle[2];    ///< caster angles [rad] (left/right)
+    double  caster_offset[2];   ///< caster offsets (left/right)
+    double  toe_angle[2];       ///< toe angles [rad] (left/right)
+    ChVector<> spindle_pos[2];  ///< spindle locations (left/right)
+    double  spring_length[2];   ///< spring lengths (left/right)
+    double  spring_force[2];    ///< spring forces (left/right)
+    double  shock_length[2];    ///< shock lengths (left/right)
+  };
+
+  /// Create a sweep of the rig specified in the given suspension test JSON
+  /// file, initialized at the specified location. The sweep uses the specified
+  /// number of worker threads (if zero, the number of hardware threads; if one,
+  /// the calling thread does all the work).
+  SuspensionSweep(
+    const std::string&  filename,          ///< [in] suspension test specification file
+    const ChCoordsys<>& rig_pos,           ///< [in] global location of the rig
+    int                 num_threads = 0    ///< [in] number of worker threads
+    );
+
+  ~SuspensionSweep();
+
+  /// Set the grid values of the left and right post displacements and of the
+  /// steering input. An empty list is replaced by the single value 0.
+  void SetLeftDisplacements(const std::vector<double>& disp) { m_values[0] = disp; }
+  void SetRightDisplacements(const std::vector<double>& disp) { m_values[1] = disp; }
+  void SetSteeringInputs(const std::vector<double>& steering) { m_values[2] = steering; }
+
+  /// Enable or disable warm starting each solve from the converged
+  /// configuration of the neighbouring grid point (default: enabled).
+  void SetWarmStart(bool val) { m_warm_start = val; }
+
+  /// Enable or disable the kinematic mode, in which each solve only satisfies
+  /// the position-level constraints (default: disabled, full assembly).
+  void SetKinematic(bool val) { m_kinematic = val; }
+
+  /// Solve all grid points. The rigs are created at the first call.
+  void Run();
+
+  /// Get the number of grid points (valid after Run).
+  int GetNumPoints() const { return (int)m_results.size(); }
+
+  /// Get the index of the specified grid point. The left displacement varies
+  /// fastest, the steering input slowest.
+  int GetIndex(int i_left, int i_right, int i_steering) const;
+
+  /// Get the results at the specified grid point (valid after Run).
+  const Result& GetResult(int index) const { return m_results[index]; }
+
+  /// Get the number of worker threads.
+  int GetNumThreads() const { return m_pool ? m_pool->GetNumThreads() : 1; }
+
+  /// Write the results to the specified file, one row per grid point and one
+  /// column per measurement. Returns false if the file cannot be written.
+  bool WriteResults(
+    const std::string&                filename,                              ///< [in] output file
+    vehicle::ChOutputChannel::Format  format = vehicle::ChOutputChannel::CSV ///< [in] file format
+    ) const;
+
+private:
+
+  friend class SuspensionSweepTask;
+
+  // Positions of the bodies of a rig.
+  typedef std::vector<ChCoordsys<> > Configuration;
+
+  SuspensionSweep(const SuspensionSweep&);
+  SuspensionSweep& operator=(const SuspensionSweep&);
+
+  // Solve all points of the specified line on the rig of the specified worker.
+  void SolveLine(int worker, int line);
+
+  // Solve the specified grid point, starting from the current configuration.
+  void SolvePoint(SuspensionTest* rig, int index);
+
+  static void SaveConfiguration(ChSystem* system, Configuration& config);
+  static void RestoreConfiguration(ChSystem* system, const Configuration& config);
+  static double GetConstraintViolation(ChSystem* system);
+
+  std::string                        m_filename;
+  ChCoordsys<>                       m_rig_pos;
+  std::vector<double>                m_values[3];   // left, right, steering
+  int                                m_num[3];
+  bool                               m_warm_start;
+  bool                               m_kinematic;
+
+  vehicle::ChThreadPool*             m_pool;
+  std::vector<SuspensionTest*>       m_rigs;        // one per worker
+  std::vector<Configuration>         m_design;      // design configuration of each rig
+  std::vector<SuspensionSweepTask*>  m_tasks;       // one per line
+
+  std::vector<Result>                m_results;
+};
+
+
+} // end namespace chrono
+
+
+#endif
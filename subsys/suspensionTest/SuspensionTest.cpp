@@ -18,6 +18,8 @@
 
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
+#include <vector>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -40,9 +42,11 @@
 #include "subsys/wheel/Wheel.h"
 
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 #include "rapidjson/document.h"
-#include "rapidjson/filereadstream.h"
 
 using namespace rapidjson;
 
@@ -53,49 +57,32 @@ static const double lb2kg = 0.453592;
 static const double lbf2N = 4.44822162;
 static const double rad2deg = 180.0/CH_C_PI;
 
-// Utility functions
-// -----------------------------------------------------------------------------
-// -----------------------------------------------------------------------------
-// These utility functions return a ChVector and a ChQuaternion<>, respectively,
-// from the specified JSON array.
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
-static ChQuaternion<> loadQuaternion(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 4);
-  return ChQuaternion<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble(), a[3u].GetDouble());
-}
-
-
 // ----------------------------------------------------------
 // Constructor guaranteers that <ChBody> objects are Added to the system here
 // Links are added to the system during Initialize()
 SuspensionTest::SuspensionTest(const std::string& filename): 
-  m_num_axles(1), m_save_log_to_file(false), m_log_file_exists(false), m_log_what(0)
+  m_num_axles(1), m_save_log_to_file(false), m_log_file_exists(false), m_log_what(0),
+  m_record_what(0), m_steer(0)
 {
+  m_postDisp[0] = m_postDisp[1] = 0;
 
   // Open and parse the input file
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Read top-level data
   assert(d.HasMember("Type"));
   assert(d.HasMember("Template"));
   assert(d.HasMember("Name"));
 
+  // Solver settings (optional)
+  if (d.HasMember("Solver")) {
+    ChSolverProfile profile;
+    if (loadSolverProfile(d["Solver"], profile))
+      SetSolverProfile(profile);
+    else
+      GetLog() << "ERROR: invalid solver settings in " << filename.c_str() << "\n";
+  }
+
   // Create the ground body, no visualizastion
   m_ground = ChSharedPtr<ChBodyAuxRef>(new ChBodyAuxRef);
 
@@ -246,9 +233,12 @@ void SuspensionTest::Initialize(const ChCoordsys<>& chassisPos)
   m1_L.z -= 1.0;    // offset marker 1 location 1 meter below marker 2
   m_post_L_linact->Initialize(m_ground, m_post_L, false, ChCoordsys<>(m1_L,QUNIT), ChCoordsys<>(post_L_pos,QUNIT) );
   m_post_L_linact->Set_lin_offset( (post_L_pos - m1_L).z );
-  // displacement motion set as a constant function
+  // displacement motion set as a constant function, unless a function was specified
   ChSharedPtr<ChFunction_Const> func_L(new ChFunction_Const(0));
-  m_post_L_linact->Set_dist_funct( func_L );
+  if (m_actuator_L.IsNull())
+    m_post_L_linact->Set_dist_funct( func_L );
+  else
+    m_post_L_linact->Set_dist_funct( m_actuator_L );
   AddLink(m_post_L_linact);
 
   // right side post
@@ -266,9 +256,12 @@ void SuspensionTest::Initialize(const ChCoordsys<>& chassisPos)
   m1_R.z -= 1.0;    // offset marker 1 location 1 meter below marker 2
   m_post_R_linact->Initialize(m_ground, m_post_R, false, ChCoordsys<>(m1_R,QUNIT), ChCoordsys<>(post_R_pos,QUNIT) );
   m_post_R_linact->Set_lin_offset( (post_R_pos - m1_R).z );
-  // displacement motion set as a constant function
+  // displacement motion set as a constant function, unless a function was specified
   ChSharedPtr<ChFunction_Const> func_R(new ChFunction_Const(0));
-  m_post_R_linact->Set_dist_funct( func_R );
+  if (m_actuator_R.IsNull())
+    m_post_R_linact->Set_dist_funct( func_R );
+  else
+    m_post_R_linact->Set_dist_funct( m_actuator_R );
   AddLink(m_post_R_linact);
 
   // keep the suspension at the specified height by keeping a point on the spindle
@@ -316,6 +309,40 @@ void SuspensionTest::Update(double       time,
   m_postDisp[RIGHT] = disp_R;
 }
 
+// -----------------------------------------------------------------------------
+// The velocities are cleared before the assembly, so that the update at the end
+// of the assembly evaluates the force elements at rest.
+// -----------------------------------------------------------------------------
+double SuspensionTest::SolveKinematics(double steering,
+                                       double disp_L,
+                                       double disp_R)
+{
+  ChTireForces tire_forces(2);
+  Update(GetChTime(), steering, disp_L, disp_R, tire_forces);
+
+  std::vector<ChBody*>::iterator ibody = Get_bodylist()->begin();
+  for (; ibody != Get_bodylist()->end(); ++ibody) {
+    (*ibody)->SetPos_dt(ChVector<>(0, 0, 0));
+    (*ibody)->SetRot_dt(ChQuaternion<>(0, 0, 0, 0));
+    (*ibody)->SetPos_dtdt(ChVector<>(0, 0, 0));
+    (*ibody)->SetRot_dtdt(ChQuaternion<>(0, 0, 0, 0));
+  }
+
+  DoAssembly(ASS_POSITION);
+
+  double violation = 0;
+  std::vector<ChLink*>::iterator ilink = Get_linklist()->begin();
+  for (; ilink != Get_linklist()->end(); ++ilink) {
+    ChMatrix<>* C = (*ilink)->GetC();
+    if (!C)
+      continue;
+    for (int i = 0; i < C->GetRows(); i++)
+      violation = std::max(violation, std::abs(C->GetElement(i, 0)));
+  }
+
+  return violation;
+}
+
 // set what to save to file each time .DebugLog() is called during the simulation loop
 // creates a new file (or overwrites old existing one), and sets the first row w/ headers
 // for easy postprocessing with python pandas scripts
@@ -337,32 +364,34 @@ void SuspensionTest::Save_DebugLog(int what,
 
 void SuspensionTest::DebugLog(int console_what)
 {
-  GetLog().SetNumFormat("%10.2f");
+  ChStreamOutAscii& log = vehicle::GetContextLog();
+
+  log.SetNumFormat("%10.2f");
 
   if (console_what & DBG_SPRINGS)
   {
-    GetLog() << "\n---- Spring (left, right)\n";
-    GetLog() << "Length [inch]       "
+    log << "\n---- Spring (left, right)\n";
+    log << "Length [inch]       "
       << GetSpringLength(FRONT_LEFT) / in2m << "  "
       << GetSpringLength(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Deformation [inch]  "
+    log << "Deformation [inch]  "
       << GetSpringDeformation(FRONT_LEFT) / in2m << "  "
       << GetSpringDeformation(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Force [lbf]         "
+    log << "Force [lbf]         "
       << GetSpringForce(FRONT_LEFT) / lbf2N << "  "
       << GetSpringForce(FRONT_RIGHT) / lbf2N << "\n";
   }
 
   if (console_what & DBG_SHOCKS)
   {
-    GetLog() << "\n---- Shock (left, right,)\n";
-    GetLog() << "Length [inch]       "
+    log << "\n---- Shock (left, right,)\n";
+    log << "Length [inch]       "
       << GetShockLength(FRONT_LEFT) / in2m << "  "
       << GetShockLength(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Velocity [inch/s]   "
+    log << "Velocity [inch/s]   "
       << GetShockVelocity(FRONT_LEFT) / in2m << "  "
       << GetShockVelocity(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Force [lbf]         "
+    log << "Force [lbf]         "
       << GetShockForce(FRONT_LEFT) / lbf2N << "  "
       << GetShockForce(FRONT_RIGHT) / lbf2N << "\n";
   }
@@ -375,44 +404,44 @@ void SuspensionTest::DebugLog(int console_what)
 
   if (console_what & DBG_SUSPENSIONTEST)
   {
-    GetLog() << "\n---- suspension test (left, right)\n";
+    log << "\n---- suspension test (left, right)\n";
     /*
-    GetLog() << "Actuator Displacement [in] "
+    log << "Actuator Displacement [in] "
       << GetActuatorDisp(FRONT_LEFT) / in2m << "  "
       << GetActuatorDisp(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Actuator Force [N] "
+    log << "Actuator Force [N] "
       << GetActuatorForce(FRONT_LEFT) / in2m << "  "
       << GetActuatorForce(FRONT_RIGHT) / in2m << "\n";
-    GetLog() << "Actuator marker dist [in] "
+    log << "Actuator marker dist [in] "
       << GetActuatorMarkerDist(FRONT_LEFT) / in2m << "  "
       << GetActuatorMarkerDist(FRONT_RIGHT) / in2m << "\n";
     */
 
 
 
-//    GetLog() << "steer input: " << 
+//    log << "steer input: " << 
   
     
-    GetLog() << "Kingpin angle [deg] "
+    log << "Kingpin angle [deg] "
       << Get_KingpinAng(LEFT) * rad2deg << "  "
       << Get_KingpinAng(RIGHT) * rad2deg << "\n";
-    GetLog() << "Kingpin offset [in] "
+    log << "Kingpin offset [in] "
       << Get_KingpinOffset(LEFT) / in2m << "  "
       << Get_KingpinOffset(RIGHT) / in2m << "\n";
-    GetLog() << "Caster angle [deg] "
+    log << "Caster angle [deg] "
       << Get_CasterAng(LEFT) * rad2deg << "  "
       << Get_CasterAng(RIGHT) * rad2deg << "\n";
-    GetLog() << "Caster offset [in] "
+    log << "Caster offset [in] "
       << Get_CasterOffset(LEFT) / in2m << "  "
       << Get_CasterOffset(RIGHT) / in2m << "\n";
-    GetLog() << "Toe angle [deg] "
+    log << "Toe angle [deg] "
       << Get_ToeAng(LEFT) * rad2deg << "  "
       << Get_ToeAng(RIGHT) * rad2deg << "\n";
-    GetLog() << "suspension roll angle [deg] "
+    log << "suspension roll angle [deg] "
       << Get_LCArollAng() << "\n";
   }
 
-  GetLog().SetNumFormat("%g");
+  log.SetNumFormat("%g");
 }
 
 
@@ -486,6 +515,74 @@ void SuspensionTest::SaveLog()
   }
 }
 
+// -----------------------------------------------------------------------------
+// Structured recording: same columns as the log file, raw SI values, written
+// once at the end of the run.
+// -----------------------------------------------------------------------------
+void SuspensionTest::StartRecording(int what, size_t reserve_records)
+{
+  m_record_what = what & (DBG_SPRINGS | DBG_SHOCKS | DBG_SUSPENSIONTEST);
+  m_record.Reset(get_logHeader(m_record_what), reserve_records);
+  m_record_row.resize(m_record.GetNumColumns());
+}
+
+void SuspensionTest::Record()
+{
+  if (m_record_row.empty())
+    return;
+
+  double* row = &m_record_row[0];
+  int k = 0;
+
+  row[k++] = GetChTime();
+  row[k++] = m_steer;
+  row[k++] = m_postDisp[LEFT];
+  row[k++] = m_postDisp[RIGHT];
+
+  if (m_record_what & DBG_SPRINGS)
+  {
+    row[k++] = GetSpringLength(FRONT_LEFT);
+    row[k++] = GetSpringLength(FRONT_RIGHT);
+    row[k++] = GetSpringDeformation(FRONT_LEFT);
+    row[k++] = GetSpringDeformation(FRONT_RIGHT);
+    row[k++] = GetSpringForce(FRONT_LEFT);
+    row[k++] = GetSpringForce(FRONT_RIGHT);
+  }
+  if (m_record_what & DBG_SHOCKS)
+  {
+    row[k++] = GetShockLength(FRONT_LEFT);
+    row[k++] = GetShockLength(FRONT_RIGHT);
+    row[k++] = GetShockVelocity(FRONT_LEFT);
+    row[k++] = GetShockVelocity(FRONT_RIGHT);
+    row[k++] = GetShockForce(FRONT_LEFT);
+    row[k++] = GetShockForce(FRONT_RIGHT);
+  }
+  if (m_record_what & DBG_SUSPENSIONTEST)
+  {
+    // the offsets use the angles, so these must be computed first
+    row[k++] = Get_KingpinAng(LEFT);
+    row[k++] = Get_KingpinAng(RIGHT);
+    row[k++] = Get_KingpinOffset(LEFT);
+    row[k++] = Get_KingpinOffset(RIGHT);
+    row[k++] = Get_CasterAng(LEFT);
+    row[k++] = Get_CasterAng(RIGHT);
+    row[k++] = Get_CasterOffset(LEFT);
+    row[k++] = Get_CasterOffset(RIGHT);
+    row[k++] = Get_ToeAng(LEFT);
+    row[k++] = Get_ToeAng(RIGHT);
+    row[k++] = Get_LCArollAng();
+  }
+
+  assert(k == m_record.GetNumColumns());
+  m_record.Append(row);
+}
+
+bool SuspensionTest::WriteRecording(const std::string&               filename,
+                                    vehicle::ChOutputChannel::Format format) const
+{
+  return m_record.Write(filename, format);
+}
+
 
 // Public Accessors
 // -----------------------------------------------------------------------------
@@ -720,15 +817,7 @@ ChVector<> SuspensionTest::GetPostSurfacePos(const chrono::ChVehicleSide& side)
 // -----------------------------------------------------------------------------
 void SuspensionTest::LoadSteering(const std::string& filename)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a steering specification file.
   assert(d.HasMember("Type"));
@@ -756,15 +845,7 @@ void SuspensionTest::LoadSuspension(const std::string& filename,
                              int                axle,
                              bool               driven)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a suspension specification file.
   assert(d.HasMember("Type"));
@@ -797,15 +878,7 @@ void SuspensionTest::LoadSuspension(const std::string& filename,
 
 void SuspensionTest::LoadWheel(const std::string& filename, int axle, int side)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a wheel specification file.
   assert(d.HasMember("Type"));
@@ -869,6 +942,14 @@ void SuspensionTest::create_fileHeader(int what)
   // open the data file for writing the header
   ChStreamOutAsciiFile ofile(m_log_file_name.c_str());
   // write the headers, output types specified by "what"
+  ofile << get_logHeader(what).c_str();
+  // go to next line in file in prep. for next step.
+  ofile << "\n";
+}
+
+// CSV header line of the log file, with the columns for the specified output types
+std::string SuspensionTest::get_logHeader(int what)
+{
   std::stringstream ss;
   ss << "time,steer,postDisp_L,postDisp_R";
   if(what & DBG_SPRINGS)
@@ -889,9 +970,7 @@ void SuspensionTest::create_fileHeader(int what)
     ss << ",KA_L,KA_R,Koff_L,Koff_R,CA_L,CA_R,Coff_L,Coff_R,TA_L,TA_R,LCA_roll";
   }
 
-  // write to file, go to next line in file in prep. for next step.
-  ofile << ss.str().c_str();
-  ofile << "\n";
+  return ss.str();
 }
 
 
@@ -24,6 +24,7 @@
 #include "assets/ChColor.h"
 
 #include "subsys/ChSuspensionTest.h"
+#include "subsys/ChColumnStore.h"
 
 namespace chrono {
 
@@ -47,6 +48,16 @@ public:
                       double              disp_R,
                       const ChTireForces& tire_forces);
 
+  /// Kinematic solve: set the rig inputs and assemble the rig at these inputs,
+  /// satisfying the position-level constraints only (no time integration, no
+  /// velocity or acceleration analysis). The assembly starts from the current
+  /// configuration, so that the points of a K&C curve are warm-started from
+  /// the previous one. The body velocities are set to zero, so that the force
+  /// elements report their static values; the alignment metrics (see
+  /// Get_KingpinAng() etc.) are then evaluated on demand.
+  /// Returns the largest constraint violation after the assembly.
+  double SolveKinematics(double steering, double disp_L, double disp_R);
+
   /// Log info to console
   void DebugLog(int console_what);
 
@@ -58,6 +69,24 @@ public:
   void Save_DebugLog(int what,
                      const std::string& out_filename = "log_SuspensionTest.csv");
 
+  /// Start recording the specified data (DBG_SPRINGS, DBG_SHOCKS and/or
+  /// DBG_SUSPENSIONTEST) at each call to Record(). The data is stored in SI
+  /// units (m, N, rad), in the columns of the SaveLog() file, and storage is
+  /// preallocated for the specified number of records.
+  void StartRecording(int what, size_t reserve_records = 0);
+
+  /// Record the current rig inputs and the data selected in StartRecording().
+  /// Values are stored without any formatting or unit conversion.
+  void Record();
+
+  /// Get the data recorded so far.
+  const vehicle::ChColumnStore& GetRecording() const { return m_record; }
+
+  /// Write the data recorded so far to the specified file.
+  /// Returns false if the file cannot be written.
+  bool WriteRecording(const std::string&               filename,
+                      vehicle::ChOutputChannel::Format format = vehicle::ChOutputChannel::CSV) const;
+
   // Accessors
   double GetSpringForce(const ChWheelID& wheel_id) const;
   double GetSpringLength(const ChWheelID& wheel_id) const;
@@ -100,6 +129,9 @@ private:
   bool m_log_file_exists;                     // written the headers for log file yet?
   std::string m_log_file_name;
   int m_log_what;
+  vehicle::ChColumnStore m_record;            // recorded data, SI units
+  std::vector<double> m_record_row;           // current record
+  int m_record_what;                          // data types to be recorded
 
   // rig/steer inputs 
   double m_steer;
@@ -127,6 +159,7 @@ private:
                                 const ChColor& color = ChColor(0.1f, 0.8f, 0.15f) );
 
   void create_fileHeader(int what);
+  static std::string get_logHeader(int what);
 };
 
 
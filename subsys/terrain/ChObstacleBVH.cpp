@@ -0,0 +1,294 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Bounding volume hierarchy of static obstacle shapes.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/terrain/ChObstacleBVH.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Ray casts against the shapes, in the shape frame.
+// -----------------------------------------------------------------------------
+static bool ClipSlab(double o, double d, double half, double& tmin, double& tmax)
+{
+  if (std::abs(d) < 1e-12)
+    return std::abs(o) <= half;
+
+  double t1 = (-half - o) / d;
+  double t2 = (half - o) / d;
+  tmin = std::max(tmin, std::min(t1, t2));
+  tmax = std::min(tmax, std::max(t1, t2));
+
+  return tmin <= tmax;
+}
+
+bool ChObstacleBVH::IntersectBox(const ChVector<>& o, const ChVector<>& d, const ChVector<>& half, double& t)
+{
+  double tmin = 0;
+  double tmax = 1e30;
+  if (!ClipSlab(o.x, d.x, half.x, tmin, tmax) ||
+      !ClipSlab(o.y, d.y, half.y, tmin, tmax) ||
+      !ClipSlab(o.z, d.z, half.z, tmin, tmax))
+    return false;
+
+  t = tmin;
+  return true;
+}
+
+bool ChObstacleBVH::IntersectCylinder(const ChVector<>& o,
+                                      const ChVector<>& d,
+                                      double            radius,
+                                      double            half_length,
+                                      double&           t)
+{
+  double tmin = 0;
+  double tmax = 1e30;
+  if (!ClipSlab(o.y, d.y, half_length, tmin, tmax))
+    return false;
+
+  double a = d.x * d.x + d.z * d.z;
+  double c = o.x * o.x + o.z * o.z - radius * radius;
+  if (a < 1e-12) {
+    if (c > 0)
+      return false;
+  } else {
+    double b = 2 * (o.x * d.x + o.z * d.z);
+    double disc = b * b - 4 * a * c;
+    if (disc < 0)
+      return false;
+    disc = std::sqrt(disc);
+    tmin = std::max(tmin, (-b - disc) / (2 * a));
+    tmax = std::min(tmax, (-b + disc) / (2 * a));
+    if (tmin > tmax)
+      return false;
+  }
+
+  t = tmin;
+  return true;
+}
+
+bool ChObstacleBVH::intersect(const Shape& shape, const ChVector<>& origin, const ChVector<>& dir, double& t)
+{
+  ChVector<> o = shape.rot.RotateBack(origin - shape.pos);
+  ChVector<> d = shape.rot.RotateBack(dir);
+
+  if (shape.type == BOX)
+    return IntersectBox(o, d, shape.half, t);
+
+  return IntersectCylinder(o, d, shape.half.x, shape.half.y, t);
+}
+
+// -----------------------------------------------------------------------------
+// Construction.
+// -----------------------------------------------------------------------------
+void ChObstacleBVH::AddBox(const ChVector<>& pos, const ChQuaternion<>& rot, const ChVector<>& size)
+{
+  Shape shape;
+  shape.type = BOX;
+  shape.pos = pos;
+  shape.rot = rot;
+  shape.half = 0.5 * size;
+
+  // The extent along each absolute axis is the sum of the projections of the
+  // half dimensions.
+  ChVector<> ax = rot.Rotate(ChVector<>(shape.half.x, 0, 0));
+  ChVector<> ay = rot.Rotate(ChVector<>(0, shape.half.y, 0));
+  ChVector<> az = rot.Rotate(ChVector<>(0, 0, shape.half.z));
+  ChVector<> ext(std::abs(ax.x) + std::abs(ay.x) + std::abs(az.x),
+                 std::abs(ax.y) + std::abs(ay.y) + std::abs(az.y),
+                 std::abs(ax.z) + std::abs(ay.z) + std::abs(az.z));
+  shape.lo = pos - ext;
+  shape.hi = pos + ext;
+
+  m_shapes.push_back(shape);
+}
+
+void ChObstacleBVH::AddCylinder(const ChVector<>& pos, const ChQuaternion<>& rot, double radius, double length)
+{
+  Shape shape;
+  shape.type = CYLINDER;
+  shape.pos = pos;
+  shape.rot = rot;
+  shape.half = ChVector<>(radius, length / 2, 0);
+
+  // The extent along each absolute axis: half length times the axis component,
+  // plus the radius times the extent of the end discs.
+  ChVector<> axis = rot.Rotate(ChVector<>(0, 1, 0));
+  double a[3] = {axis.x, axis.y, axis.z};
+  double e[3];
+  for (int k = 0; k < 3; k++)
+    e[k] = std::abs(a[k]) * length / 2 + radius * std::sqrt(std::max(0.0, 1 - a[k] * a[k]));
+  ChVector<> ext(e[0], e[1], e[2]);
+  shape.lo = pos - ext;
+  shape.hi = pos + ext;
+
+  m_shapes.push_back(shape);
+}
+
+void ChObstacleBVH::Build()
+{
+  m_nodes.clear();
+  if (m_shapes.empty())
+    return;
+
+  m_nodes.reserve(2 * m_shapes.size());
+  build(0, (int)m_shapes.size(), 0);
+}
+
+static double center(const ChVector<>& lo, const ChVector<>& hi, int axis)
+{
+  return (axis == 0) ? lo.x + hi.x : (axis == 1) ? lo.y + hi.y : lo.z + hi.z;
+}
+
+struct CompareCenters {
+  int axis;
+  template <class SHAPE>
+  bool operator()(const SHAPE& a, const SHAPE& b) const { return center(a.lo, a.hi, axis) < center(b.lo, b.hi, axis); }
+};
+
+void ChObstacleBVH::build(int first, int last, int depth)
+{
+  int index = (int)m_nodes.size();
+  m_nodes.push_back(Node());
+
+  Node node;
+  node.lo = m_shapes[first].lo;
+  node.hi = m_shapes[first].hi;
+  ChVector<> clo = m_shapes[first].pos;
+  ChVector<> chi = m_shapes[first].pos;
+  for (int k = first + 1; k < last; k++) {
+    const Shape& s = m_shapes[k];
+    node.lo = ChVector<>(std::min(node.lo.x, s.lo.x), std::min(node.lo.y, s.lo.y), std::min(node.lo.z, s.lo.z));
+    node.hi = ChVector<>(std::max(node.hi.x, s.hi.x), std::max(node.hi.y, s.hi.y), std::max(node.hi.z, s.hi.z));
+    clo = ChVector<>(std::min(clo.x, s.pos.x), std::min(clo.y, s.pos.y), std::min(clo.z, s.pos.z));
+    chi = ChVector<>(std::max(chi.x, s.pos.x), std::max(chi.y, s.pos.y), std::max(chi.z, s.pos.z));
+  }
+  node.first = first;
+  node.count = last - first;
+  node.second = -1;
+
+  if (node.count <= MAX_LEAF_SHAPES || depth >= MAX_DEPTH - 2) {
+    m_nodes[index] = node;
+    return;
+  }
+
+  // Median split along the largest extent of the box centers.
+  ChVector<> ext = chi - clo;
+  CompareCenters cmp;
+  cmp.axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z) ? 1 : 2;
+  int mid = (first + last) / 2;
+  std::nth_element(m_shapes.begin() + first, m_shapes.begin() + mid, m_shapes.begin() + last, cmp);
+
+  node.count = 0;
+  build(first, mid, depth + 1);
+  node.second = (int)m_nodes.size();
+  build(mid, last, depth + 1);
+
+  m_nodes[index] = node;
+}
+
+// -----------------------------------------------------------------------------
+// Ray cast.
+// -----------------------------------------------------------------------------
+static bool ClipBox(const ChVector<>& o,
+                    const ChVector<>& inv,
+                    const ChVector<>& lo,
+                    const ChVector<>& hi,
+                    double            tmax,
+                    double&           tenter)
+{
+  double tx1 = (lo.x - o.x) * inv.x;
+  double tx2 = (hi.x - o.x) * inv.x;
+  double ty1 = (lo.y - o.y) * inv.y;
+  double ty2 = (hi.y - o.y) * inv.y;
+  double tz1 = (lo.z - o.z) * inv.z;
+  double tz2 = (hi.z - o.z) * inv.z;
+
+  double t0 = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.0));
+  double t1 = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::min(std::max(tz1, tz2), tmax));
+
+  tenter = t0;
+  return t0 <= t1;
+}
+
+bool ChObstacleBVH::CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const
+{
+  if (m_nodes.empty())
+    return false;
+
+  // Zero direction components have a large inverse, so that the slab test of
+  // the bounding boxes needs no special case.
+  const double big = 1e300;
+  ChVector<> inv(dir.x != 0 ? 1 / dir.x : big, dir.y != 0 ? 1 / dir.y : big, dir.z != 0 ? 1 / dir.z : big);
+
+  double best = max_dist;
+  bool found = false;
+
+  int stack[MAX_DEPTH];
+  int top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const Node& node = m_nodes[stack[--top]];
+    double tenter;
+    if (!ClipBox(origin, inv, node.lo, node.hi, best, tenter))
+      continue;
+
+    if (node.count > 0) {
+      for (int k = node.first; k < node.first + node.count; k++) {
+        double t;
+        if (intersect(m_shapes[k], origin, dir, t) && t <= best) {
+          best = t;
+          found = true;
+        }
+      }
+      continue;
+    }
+
+    // Visit the nearer child first (pushed last).
+    int c1 = (int)(&node - &m_nodes[0]) + 1;
+    int c2 = node.second;
+    double t1, t2;
+    bool h1 = ClipBox(origin, inv, m_nodes[c1].lo, m_nodes[c1].hi, best, t1);
+    bool h2 = ClipBox(origin, inv, m_nodes[c2].lo, m_nodes[c2].hi, best, t2);
+    if (h1 && h2) {
+      if (t1 <= t2) {
+        stack[top++] = c2;
+        stack[top++] = c1;
+      } else {
+        stack[top++] = c1;
+        stack[top++] = c2;
+      }
+    } else if (h1) {
+      stack[top++] = c1;
+    } else if (h2) {
+      stack[top++] = c2;
+    }
+  }
+
+  if (found)
+    dist = best;
+  return found;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,126 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Bounding volume hierarchy of static obstacle shapes, for ray casts by
+// perception sensors.
+//
+// The obstacles are boxes and cylinders (axis along the Y axis of their frame)
+// at fixed poses. The hierarchy is built once, after all obstacles were added,
+// by recursive median splits along the largest extent of the shape centers;
+// its nodes are stored depth first in a single array (the first child of a
+// node follows it), with axis-aligned bounding boxes. Ray casts traverse the
+// nodes nearest child first, with a fixed-size stack, and do not allocate
+// memory, so they can be made concurrently.
+//
+// =============================================================================
+
+#ifndef CH_OBSTACLE_BVH_H
+#define CH_OBSTACLE_BVH_H
+
+#include <vector>
+
+#include "core/ChVector.h"
+#include "core/ChQuaternion.h"
+
+#include "subsys/ChApiSubsys.h"
+
+
+namespace chrono {
+
+///
+/// Bounding volume hierarchy of static boxes and cylinders.
+///
+class CH_SUBSYS_API ChObstacleBVH
+{
+public:
+
+  ChObstacleBVH() {}
+  ~ChObstacleBVH() {}
+
+  /// Add a box with the specified pose and dimensions.
+  void AddBox(const ChVector<>& pos, const ChQuaternion<>& rot, const ChVector<>& size);
+
+  /// Add a cylinder with the specified pose, radius and length (the axis of
+  /// the cylinder is along the Y axis of its frame).
+  void AddCylinder(const ChVector<>& pos, const ChQuaternion<>& rot, double radius, double length);
+
+  /// Build the hierarchy of the obstacles added so far.
+  void Build();
+
+  /// Get the number of obstacles.
+  int GetNumObstacles() const { return (int)m_shapes.size(); }
+
+  /// Return the heap memory used by the obstacles and the hierarchy, in bytes.
+  size_t GetMemoryFootprint() const { return m_shapes.capacity() * sizeof(Shape) + m_nodes.capacity() * sizeof(Node); }
+
+  /// Cast a ray against the obstacles and find the distance to the nearest
+  /// intersection (zero if the origin is inside an obstacle).
+  /// Returns false if no obstacle is hit within the specified distance.
+  bool CastRay(
+    const ChVector<>&  origin,     ///< [in] ray origin
+    const ChVector<>&  dir,        ///< [in] ray direction (unit vector)
+    double             max_dist,   ///< [in] maximum distance along the ray
+    double&            dist        ///< [out] distance to the intersection
+    ) const;
+
+  /// Intersect a ray, expressed in the box frame, with a box centered at the
+  /// origin with the specified half dimensions. On success, the parameter of
+  /// the entry point (zero if the origin is inside) is returned in t.
+  static bool IntersectBox(const ChVector<>& o, const ChVector<>& d, const ChVector<>& half, double& t);
+
+  /// Intersect a ray, expressed in the cylinder frame, with a cylinder
+  /// centered at the origin, with its axis along Y.
+  static bool IntersectCylinder(const ChVector<>& o, const ChVector<>& d, double radius, double half_length, double& t);
+
+private:
+
+  enum ShapeType { BOX, CYLINDER };
+
+  struct Shape {
+    ShapeType       type;
+    ChVector<>      pos;
+    ChQuaternion<>  rot;
+    ChVector<>      half;        // box half dimensions or (radius, half length, 0)
+    ChVector<>      lo;          // bounding box
+    ChVector<>      hi;
+  };
+
+  // A leaf holds the shapes [first, first + count); an inner node (count = 0)
+  // has its first child at the next index and its second child at 'second'.
+  struct Node {
+    ChVector<>  lo;
+    ChVector<>  hi;
+    int         first;
+    int         count;
+    int         second;
+  };
+
+  static const int MAX_LEAF_SHAPES = 4;
+  static const int MAX_DEPTH = 64;
+
+  // Build the subtree of the shapes [first, last) in depth-first order.
+  void build(int first, int last, int depth);
+
+  // Intersect the ray with a shape.
+  static bool intersect(const Shape& shape, const ChVector<>& origin, const ChVector<>& dir, double& t);
+
+  std::vector<Shape>  m_shapes;
+  std::vector<Node>   m_nodes;
+};
+
+
+} // end namespace chrono
+
+
+#endif
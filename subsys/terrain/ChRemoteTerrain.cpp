@@ -0,0 +1,179 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Proxy terrain for a terrain model running in an external process.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/terrain/ChRemoteTerrain.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRemoteTerrain::ChRemoteTerrain()
+: m_max_query(0),
+  m_time(0),
+  m_num_queries(0)
+{
+}
+
+ChRemoteTerrain::~ChRemoteTerrain()
+{
+  Disconnect();
+}
+
+// A query of n locations takes 2 + 2n values and its reply 1 + 4n values.
+bool ChRemoteTerrain::Connect(const std::string& channel_name)
+{
+  Disconnect();
+
+  if (!m_channel.Open(channel_name))
+    return false;
+
+  size_t max_size = m_channel.GetMaxSize();
+  m_max_query = (max_size < 5) ? 0 : (int)std::min((max_size - 2) / 2, (max_size - 1) / 4);
+  if (m_max_query < 1) {
+    GetLog() << "ERROR: terrain channel " << channel_name.c_str() << " holds " << (int)max_size
+             << " values per message (5 needed)\n";
+    m_channel.Close();
+    return false;
+  }
+
+  return true;
+}
+
+void ChRemoteTerrain::Disconnect()
+{
+  vehicle::ChScopedLock lock(m_mutex);
+
+  if (!m_channel.IsOpen())
+    return;
+
+  if (m_channel.BeginSend())
+    m_channel.EndSend(TERRAIN_STOP, 0);
+
+  m_channel.Close();
+  m_max_query = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRemoteTerrain::Advance(double step)
+{
+  vehicle::ChScopedLock lock(m_mutex);
+
+  if (!m_channel.IsOpen())
+    return;
+
+  double* msg = m_channel.BeginSend();
+  if (!msg) {
+    GetLog() << "ERROR: terrain server does not accept requests\n";
+    return;
+  }
+  msg[0] = m_time;
+  msg[1] = step;
+  m_channel.EndSend(TERRAIN_ADVANCE, 2);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double ChRemoteTerrain::GetHeight(double x, double y) const
+{
+  double height;
+  GetHeightAndNormal(1, &x, &y, &height, 0);
+  return height;
+}
+
+ChVector<> ChRemoteTerrain::GetNormal(double x, double y) const
+{
+  double height;
+  ChVector<> normal;
+  GetHeightAndNormal(1, &x, &y, &height, &normal);
+  return normal;
+}
+
+void ChRemoteTerrain::GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const
+{
+  CH_PROFILE_SCOPE("ChRemoteTerrain::Query");
+
+  vehicle::ChScopedLock lock(m_mutex);
+
+  for (int start = 0; start < n; start += m_max_query) {
+    int count = std::min(n - start, m_max_query);
+    if (m_max_query < 1 || !Query(count, x + start, y + start, height + start, normal ? normal + start : 0)) {
+      // Not connected, or no reply: flat ground at the origin
+      for (int i = start; i < n; i++) {
+        height[i] = 0;
+        if (normal)
+          normal[i] = ChVector<>(0, 0, 1);
+      }
+      return;
+    }
+  }
+}
+
+bool ChRemoteTerrain::Query(int n, const double* x, const double* y, double* height, ChVector<>* normal) const
+{
+  double* msg = m_channel.BeginSend();
+  if (!msg) {
+    GetLog() << "ERROR: terrain server does not accept requests\n";
+    return false;
+  }
+  msg[0] = (double)n;
+  msg[1] = normal ? 1.0 : 0.0;
+  std::copy(x, x + n, msg + 2);
+  std::copy(y, y + n, msg + 2 + n);
+  m_channel.EndSend(TERRAIN_QUERY, 2 + 2 * (size_t)n);
+
+  int type;
+  size_t size;
+  const double* reply;
+  if (!m_channel.Receive(type, size, reply)) {
+    // A late reply would be taken for the reply to the next query
+    GetLog() << "ERROR: no reply from the terrain server; disconnecting\n";
+    m_channel.Close();
+    m_max_query = 0;
+    return false;
+  }
+
+  size_t expected = 1 + (size_t)n * (normal ? 4 : 1);
+  if (type != TERRAIN_HEIGHTS || size != expected || (int)reply[0] != n) {
+    GetLog() << "ERROR: unexpected reply from the terrain server\n";
+    m_channel.EndReceive();
+    return false;
+  }
+
+  std::copy(reply + 1, reply + 1 + n, height);
+  if (normal) {
+    const double* vals = reply + 1 + n;
+    for (int i = 0; i < n; i++)
+      normal[i] = ChVector<>(vals[3 * i], vals[3 * i + 1], vals[3 * i + 2]);
+  }
+  m_num_queries++;
+
+  m_channel.EndReceive();
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,122 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Proxy terrain for a terrain model running in an external process (terrain
+// server), connected through a shared-memory channel (see ChShmChannel).
+//
+// Height and normal queries are forwarded to the server; a batched query
+// (GetHeightAndNormal) is one round trip, split in as many messages as needed
+// to fit the channel.
+//
+// Messages (arrays of doubles):
+//   TERRAIN_QUERY    client to server   number of locations n, 1 if normals
+//                                       are requested (0 otherwise), n x
+//                                       coordinates, n y coordinates
+//   TERRAIN_HEIGHTS  server to client   number of locations n, n heights, and
+//                                       n normals (3 values each) if requested
+//   TERRAIN_ADVANCE  client to server   time, step (no reply)
+//   TERRAIN_STOP     client to server   (empty) the client disconnects
+//
+// If the server does not reply within the channel timeout, an error is
+// reported, the proxy disconnects, and all queries return a zero height and a
+// vertical normal.
+//
+// =============================================================================
+
+#ifndef CH_REMOTE_TERRAIN_H
+#define CH_REMOTE_TERRAIN_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChShmChannel.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+
+///
+/// Proxy of a terrain simulated by a terrain server.
+///
+class CH_SUBSYS_API ChRemoteTerrain : public ChTerrain
+{
+public:
+
+  /// Message types.
+  enum MessageType {
+    TERRAIN_QUERY = 11,
+    TERRAIN_HEIGHTS = 12,
+    TERRAIN_ADVANCE = 13,
+    TERRAIN_STOP = 14
+  };
+
+  ChRemoteTerrain();
+
+  /// Disconnect from the server (if connected).
+  ~ChRemoteTerrain();
+
+  /// Connect to the terrain server that created the named channel.
+  /// Returns false if the channel cannot be opened or cannot hold a query of
+  /// at least one location.
+  bool Connect(const std::string& channel_name);
+
+  /// Notify the server and disconnect.
+  void Disconnect();
+
+  /// Return true if connected to a server.
+  bool IsConnected() const { return m_channel.IsOpen(); }
+
+  /// Get the channel (e.g. to set its timeout).
+  vehicle::ChShmChannel& GetChannel() { return m_channel; }
+
+  /// Get the number of locations in the largest query message.
+  int GetMaxQuerySize() const { return m_max_query; }
+
+  /// Store the current time.
+  virtual void Update(double time) { m_time = time; }
+
+  /// Advance the terrain server by the specified step.
+  virtual void Advance(double step);
+
+  /// Get the terrain height at the specified (x,y) location.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations,
+  /// with one exchange per message.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get the number of queries exchanged with the server.
+  int GetNumQueries() const { return (int)m_num_queries; }
+
+private:
+
+  bool Query(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  mutable vehicle::ChShmChannel m_channel;
+  mutable vehicle::ChMutex      m_mutex;      // queries may come from several threads
+
+  mutable int                   m_max_query;
+  double                        m_time;
+  mutable size_t                m_num_queries;
+};
+
+
+} // end namespace chrono
+
+
+#endif
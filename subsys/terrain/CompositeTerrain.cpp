@@ -0,0 +1,313 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Terrain made of patches of other terrains.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <utility>
+
+#include "subsys/terrain/CompositeTerrain.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+
+static const int COMPOSITE_MAX_CELLS = 1024;   // per axis
+
+// Patch found by the last query of the calling thread.
+static CH_THREAD_LOCAL const CompositeTerrain* s_composite_terrain = 0;
+static CH_THREAD_LOCAL int                     s_composite_patch = -1;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+CompositeTerrain::CompositeTerrain()
+: m_cell_size(10),
+  m_grid_x0(0),
+  m_grid_y0(0),
+  m_grid_dx(1),
+  m_grid_dy(1),
+  m_grid_nx(0),
+  m_grid_ny(0)
+{
+}
+
+int CompositeTerrain::AddPatch(ChSharedPtr<ChTerrain> terrain,
+                               double                 xmin,
+                               double                 ymin,
+                               double                 xmax,
+                               double                 ymax,
+                               int                    priority)
+{
+  Patch patch;
+  patch.terrain = terrain;
+  patch.xmin = std::min(xmin, xmax);
+  patch.ymin = std::min(ymin, ymax);
+  patch.xmax = std::max(xmin, xmax);
+  patch.ymax = std::max(ymin, ymax);
+  patch.priority = priority;
+  patch.exclusive = true;
+  m_patches.push_back(patch);
+
+  build();
+
+  return (int)m_patches.size() - 1;
+}
+
+void CompositeTerrain::SetCellSize(double size)
+{
+  if (size <= 0)
+    return;
+  m_cell_size = size;
+  build();
+}
+
+// -----------------------------------------------------------------------------
+// Build the lookup grid over the bounding box of the patch footprints.
+// -----------------------------------------------------------------------------
+bool CompositeTerrain::precedes(int a, int b) const
+{
+  if (m_patches[a].priority != m_patches[b].priority)
+    return m_patches[a].priority > m_patches[b].priority;
+  return a > b;
+}
+
+void CompositeTerrain::build()
+{
+  int num_patches = (int)m_patches.size();
+
+  m_grid_nx = 0;
+  m_grid_ny = 0;
+  m_cell_start.clear();
+  m_cell_patches.clear();
+  if (num_patches == 0)
+    return;
+
+  double x0 = m_patches[0].xmin, x1 = m_patches[0].xmax;
+  double y0 = m_patches[0].ymin, y1 = m_patches[0].ymax;
+  for (int k = 1; k < num_patches; k++) {
+    x0 = std::min(x0, m_patches[k].xmin);
+    x1 = std::max(x1, m_patches[k].xmax);
+    y0 = std::min(y0, m_patches[k].ymin);
+    y1 = std::max(y1, m_patches[k].ymax);
+  }
+
+  m_grid_x0 = x0;
+  m_grid_y0 = y0;
+  m_grid_nx = std::min(std::max((int)std::ceil((x1 - x0) / m_cell_size), 1), COMPOSITE_MAX_CELLS);
+  m_grid_ny = std::min(std::max((int)std::ceil((y1 - y0) / m_cell_size), 1), COMPOSITE_MAX_CELLS);
+  m_grid_dx = (x1 > x0) ? (x1 - x0) / m_grid_nx : 1;
+  m_grid_dy = (y1 > y0) ? (y1 - y0) / m_grid_ny : 1;
+
+  // Candidate patches of each cell, keyed so that the patches sort by
+  // decreasing precedence.
+  std::vector<std::vector<std::pair<int, int> > > cells(m_grid_nx * m_grid_ny);
+  for (int k = 0; k < num_patches; k++) {
+    const Patch& p = m_patches[k];
+    int i0 = std::max((int)std::floor((p.xmin - x0) / m_grid_dx), 0);
+    int i1 = std::min((int)std::floor((p.xmax - x0) / m_grid_dx), m_grid_nx - 1);
+    int j0 = std::max((int)std::floor((p.ymin - y0) / m_grid_dy), 0);
+    int j1 = std::min((int)std::floor((p.ymax - y0) / m_grid_dy), m_grid_ny - 1);
+    for (int j = j0; j <= j1; j++) {
+      for (int i = i0; i <= i1; i++)
+        cells[j * m_grid_nx + i].push_back(std::make_pair(-p.priority, -k));
+    }
+  }
+
+  // Sort each list by precedence, and drop the patches hidden by a patch
+  // covering the whole cell.
+  m_cell_start.resize(cells.size() + 1);
+  for (size_t c = 0; c < cells.size(); c++) {
+    m_cell_start[c] = (int)m_cell_patches.size();
+
+    std::vector<std::pair<int, int> >& list = cells[c];
+    std::sort(list.begin(), list.end());
+
+    double cx0 = x0 + (c % m_grid_nx) * m_grid_dx;
+    double cy0 = y0 + (c / m_grid_nx) * m_grid_dy;
+    for (size_t k = 0; k < list.size(); k++) {
+      int index = -list[k].second;
+      const Patch& p = m_patches[index];
+      m_cell_patches.push_back(index);
+      if (p.xmin <= cx0 && p.xmax >= cx0 + m_grid_dx && p.ymin <= cy0 && p.ymax >= cy0 + m_grid_dy)
+        break;
+    }
+  }
+  m_cell_start[cells.size()] = (int)m_cell_patches.size();
+
+  // A patch is exclusive if no overlapping patch takes precedence over it.
+  for (int a = 0; a < num_patches; a++) {
+    Patch& p = m_patches[a];
+    p.exclusive = true;
+    for (int b = 0; b < num_patches && p.exclusive; b++) {
+      const Patch& q = m_patches[b];
+      if (b != a && precedes(b, a) && q.xmin <= p.xmax && q.xmax >= p.xmin && q.ymin <= p.ymax && q.ymax >= p.ymin)
+        p.exclusive = false;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int CompositeTerrain::FindPatch(double x, double y) const
+{
+  int last = s_composite_patch;
+  if (s_composite_terrain == this && last >= 0 && last < (int)m_patches.size()) {
+    const Patch& p = m_patches[last];
+    if (p.exclusive && x >= p.xmin && x <= p.xmax && y >= p.ymin && y <= p.ymax)
+      return last;
+  }
+
+  if (m_grid_nx == 0)
+    return -1;
+
+  double u = (x - m_grid_x0) / m_grid_dx;
+  double v = (y - m_grid_y0) / m_grid_dy;
+  if (u < 0 || v < 0 || u > m_grid_nx || v > m_grid_ny)
+    return -1;
+
+  int i = std::min((int)u, m_grid_nx - 1);
+  int j = std::min((int)v, m_grid_ny - 1);
+  int cell = j * m_grid_nx + i;
+  for (int k = m_cell_start[cell]; k < m_cell_start[cell + 1]; k++) {
+    const Patch& p = m_patches[m_cell_patches[k]];
+    if (x >= p.xmin && x <= p.xmax && y >= p.ymin && y <= p.ymax) {
+      s_composite_terrain = this;
+      s_composite_patch = m_cell_patches[k];
+      return m_cell_patches[k];
+    }
+  }
+
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void CompositeTerrain::Update(double time)
+{
+  for (size_t k = 0; k < m_patches.size(); k++)
+    m_patches[k].terrain->Update(time);
+  if (!m_background.IsNull())
+    m_background->Update(time);
+}
+
+void CompositeTerrain::Advance(double step)
+{
+  for (size_t k = 0; k < m_patches.size(); k++)
+    m_patches[k].terrain->Advance(step);
+  if (!m_background.IsNull())
+    m_background->Advance(step);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double CompositeTerrain::GetHeight(double x, double y) const
+{
+  int patch = FindPatch(x, y);
+  if (patch >= 0)
+    return m_patches[patch].terrain->GetHeight(x, y);
+  if (!m_background.IsNull())
+    return m_background->GetHeight(x, y);
+  return 0;
+}
+
+ChVector<> CompositeTerrain::GetNormal(double x, double y) const
+{
+  int patch = FindPatch(x, y);
+  if (patch >= 0)
+    return m_patches[patch].terrain->GetNormal(x, y);
+  if (!m_background.IsNull())
+    return m_background->GetNormal(x, y);
+  return ChVector<>(0, 0, 1);
+}
+
+void CompositeTerrain::GetHeightAndNormal(int           n,
+                                          const double* x,
+                                          const double* y,
+                                          double*       height,
+                                          ChVector<>*   normal) const
+{
+  int start = 0;
+  int patch = (n > 0) ? FindPatch(x[0], y[0]) : -1;
+
+  while (start < n) {
+    // Run of consecutive points on the same patch.
+    int end = start + 1;
+    int next = -1;
+    while (end < n && (next = FindPatch(x[end], y[end])) == patch)
+      end++;
+
+    const ChTerrain* terrain = (patch >= 0) ? m_patches[patch].terrain.get_ptr() : m_background.get_ptr();
+    if (terrain) {
+      terrain->GetHeightAndNormal(end - start, x + start, y + start, height + start, normal ? normal + start : 0);
+    } else {
+      for (int i = start; i < end; i++)
+        height[i] = 0;
+      for (int i = start; normal && i < end; i++)
+        normal[i] = ChVector<>(0, 0, 1);
+    }
+
+    start = end;
+    patch = next;
+  }
+}
+
+double CompositeTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  double hmax = m_background.IsNull() ? 0 : m_background->GetMaxHeight(xmin, ymin, xmax, ymax);
+
+  for (size_t k = 0; k < m_patches.size(); k++) {
+    const Patch& p = m_patches[k];
+    if (p.xmin > xmax || p.xmax < xmin || p.ymin > ymax || p.ymax < ymin)
+      continue;
+    double h = p.terrain->GetMaxHeight(std::max(xmin, p.xmin), std::max(ymin, p.ymin),
+                                       std::min(xmax, p.xmax), std::min(ymax, p.ymax));
+    hmax = std::max(hmax, h);
+  }
+
+  return hmax;
+}
+
+double CompositeTerrain::GetCoefficientFriction(double x, double y) const
+{
+  int patch = FindPatch(x, y);
+  if (patch >= 0)
+    return m_patches[patch].terrain->GetCoefficientFriction(x, y);
+  if (!m_background.IsNull())
+    return m_background->GetCoefficientFriction(x, y);
+  return ChTerrain::GetCoefficientFriction(x, y);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void CompositeTerrain::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  report.Add("terrain/objects", sizeof(*this) + vehicle::ChMemoryReport::VectorBytes(m_patches));
+  report.Add("terrain/lookup grids", vehicle::ChMemoryReport::VectorBytes(m_cell_start) +
+                                     vehicle::ChMemoryReport::VectorBytes(m_cell_patches));
+
+  for (size_t k = 0; k < m_patches.size(); k++)
+    m_patches[k].terrain->AddMemoryFootprint(report);
+  if (!m_background.IsNull())
+    m_background->AddMemoryFootprint(report);
+
+  ChTerrain::AddMemoryFootprint(report);
+}
+
+
+} // end namespace chrono
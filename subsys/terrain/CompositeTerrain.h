@@ -0,0 +1,149 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Terrain made of patches of other terrains (e.g. flat asphalt, height-map
+// off-road sections, soil pits, low-friction patches).
+//
+// Each patch is a terrain with a rectangular footprint in the x-y plane and a
+// priority; where footprints overlap, the patch with the highest priority (the
+// last one added, for equal priorities) is used. Outside all patches, the
+// background terrain is used or, without background, a horizontal plane at
+// zero height with the friction coefficient of this terrain.
+//
+// The queries are routed through a uniform grid over the patch footprints:
+// each cell lists the patches overlapping it, by decreasing precedence, and
+// its list ends at the first patch covering the whole cell, so that a lookup
+// takes constant time in the usual layouts. The patch found by the last query
+// of each thread is tried first: if it does not overlap a patch of higher
+// precedence, a point inside its footprint needs no grid lookup. Batched
+// queries are split into runs of consecutive points on the same patch, each
+// passed to the batched query of its patch.
+//
+// =============================================================================
+
+#ifndef COMPOSITETERRAIN_H
+#define COMPOSITETERRAIN_H
+
+#include <vector>
+
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+
+namespace chrono {
+
+///
+/// Concrete class for a terrain made of patches of other terrains.
+/// The patches are updated and advanced with this terrain. The queries are
+/// thread-safe if those of the patches are.
+///
+class CH_SUBSYS_API CompositeTerrain : public ChTerrain
+{
+public:
+
+  CompositeTerrain();
+  ~CompositeTerrain() {}
+
+  /// Add a patch with the specified footprint and priority. Returns the index
+  /// of the patch.
+  int AddPatch(
+    ChSharedPtr<ChTerrain>  terrain,        ///< [in] terrain of the patch
+    double                  xmin,           ///< [in] minimum x of the footprint
+    double                  ymin,           ///< [in] minimum y of the footprint
+    double                  xmax,           ///< [in] maximum x of the footprint
+    double                  ymax,           ///< [in] maximum y of the footprint
+    int                     priority = 0    ///< [in] priority over overlapping patches
+    );
+
+  /// Set the terrain used outside all patches (empty: a horizontal plane at
+  /// zero height).
+  void SetBackground(ChSharedPtr<ChTerrain> terrain) { m_background = terrain; }
+
+  /// Set the size of the cells of the lookup grid (default: 10 m). The grid
+  /// has at most 1024 cells along each axis; larger cells are used if needed.
+  void SetCellSize(double size);
+
+  /// Get the number of patches.
+  int GetNumPatches() const { return (int)m_patches.size(); }
+
+  /// Get the terrain of the specified patch.
+  ChSharedPtr<ChTerrain> GetPatch(int index) const { return m_patches[index].terrain; }
+
+  /// Get the index of the patch used at the specified (x,y) location (-1 for
+  /// the background).
+  int FindPatch(double x, double y) const;
+
+  /// Update and advance all patches and the background.
+  virtual void Update(double time);
+  virtual void Advance(double step);
+
+  /// Get the terrain height at the specified (x,y) location.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get an upper bound of the terrain height over the specified rectangle,
+  /// from the bounds of the patches overlapping it and of the background.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Get the coefficient of friction of the patch used at the specified (x,y)
+  /// location.
+  virtual double GetCoefficientFriction(double x, double y) const;
+
+  /// Add the lookup grid, the patches and the background to the specified
+  /// report.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+private:
+
+  struct Patch {
+    ChSharedPtr<ChTerrain>  terrain;
+    double                  xmin;
+    double                  ymin;
+    double                  xmax;
+    double                  ymax;
+    int                     priority;
+    bool                    exclusive;   // no overlapping patch of higher precedence
+  };
+
+  // True if patch a takes precedence over patch b.
+  bool precedes(int a, int b) const;
+
+  // Rebuild the lookup grid.
+  void build();
+
+  std::vector<Patch>       m_patches;
+  ChSharedPtr<ChTerrain>   m_background;
+
+  double                   m_cell_size;
+  double                   m_grid_x0;
+  double                   m_grid_y0;
+  double                   m_grid_dx;
+  double                   m_grid_dy;
+  int                      m_grid_nx;
+  int                      m_grid_ny;
+  std::vector<int>         m_cell_start;     // per cell, start of its list (size: num cells + 1)
+  std::vector<int>         m_cell_patches;   // patch lists of the cells
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -23,10 +23,41 @@
 namespace chrono {
 
 
-FlatTerrain::FlatTerrain(const int height)
+FlatTerrain::FlatTerrain(double height)
 : m_height(height)
 {
 }
 
+void FlatTerrain::GetHeightAndNormal(int           n,
+                                     const double* x,
+                                     const double* y,
+                                     double*       height,
+                                     ChVector<>*   normal) const
+{
+  for (int i = 0; i < n; i++)
+    height[i] = m_height;
+
+  if (!normal)
+    return;
+
+  for (int i = 0; i < n; i++)
+    normal[i] = ChVector<>(0, 0, 1);
+}
+
+bool FlatTerrain::CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const
+{
+  double depth = origin.z - m_height;
+
+  if (depth <= 0) {
+    dist = 0;
+    return true;
+  }
+  if (dir.z >= 0 || -depth / dir.z > max_dist)
+    return false;
+
+  dist = -depth / dir.z;
+  return true;
+}
+
 
 } // end namespace chrono
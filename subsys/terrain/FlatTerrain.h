@@ -37,7 +37,7 @@ class CH_SUBSYS_API FlatTerrain : public ChTerrain
 public:
 
   FlatTerrain(
-    const int height   ///< [in] terrain height
+    double height   ///< [in] terrain height
     );
 
   ~FlatTerrain() {}
@@ -50,6 +50,18 @@ public:
   /// Returns a constant unit vector along the Z axis.
   virtual ChVector<> GetNormal(double x, double y) const { return ChVector<>(0, 0, 1); }
 
+  /// Get the terrain heights and normals at the specified (x,y) locations.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get the maximum terrain height over the specified x-y rectangle.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const { return m_height; }
+
+  /// Cast a ray against the plane.
+  virtual bool CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const;
+
+  /// This terrain is a horizontal plane at the constant height.
+  virtual bool IsFlat(double& height) const { height = m_height; return true; }
+
 private:
 
   double m_height;
@@ -0,0 +1,208 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Granular terrain simulated only in a moving patch around a vehicle.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "physics/ChBodyEasy.h"
+
+#include "subsys/terrain/GranularTerrain.h"
+#include "subsys/terrain/FlatTerrain.h"
+#include "subsys/terrain/RigidTerrain.h"
+
+
+namespace chrono {
+
+// Lattice spacing of the particles, relative to their diameter.
+static const double s_spacing = 1.02;
+
+// Thickness of the pit floor and walls.
+static const double s_thickness = 0.1;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+GranularTerrain::GranularTerrain(ChSystem* system)
+: m_system(system),
+  m_surface(new FlatTerrain(0)),
+  m_length(6),
+  m_width(4),
+  m_depth(0.2),
+  m_shift(1.5),
+  m_radius(0.02),
+  m_density(2500),
+  m_mu(0.7),
+  m_num_shifts(0),
+  m_num_recycled(0)
+{
+}
+
+void GranularTerrain::SetPatchSize(double length, double width, double depth, double shift)
+{
+  m_length = length;
+  m_width = width;
+  m_depth = depth;
+  m_shift = std::min(shift, length / 2);
+}
+
+void GranularTerrain::SetParticles(double radius, double density, double mu)
+{
+  m_radius = radius;
+  m_density = density;
+  m_mu = mu;
+}
+
+// -----------------------------------------------------------------------------
+// The container is a fixed body made of the floor and four walls, reaching up
+// to one bed depth above the bed level. It is moved with the patch.
+// -----------------------------------------------------------------------------
+void GranularTerrain::Initialize(double x, double y)
+{
+  m_center = ChVector<>(x, y, m_surface->GetHeight(x, y));
+
+  double hl = m_length / 2;
+  double hw = m_width / 2;
+  double t = s_thickness;
+
+  m_container = ChSharedPtr<ChBody>(new ChBody);
+  m_container->SetIdentifier(-2);
+  m_container->SetName("granular_container");
+  m_container->SetPos(m_center);
+  m_container->SetBodyFixed(true);
+  m_container->SetCollide(true);
+  m_container->GetCollisionModel()->ClearModel();
+  m_container->GetCollisionModel()->AddBox(hl + 2 * t, hw + 2 * t, t, ChVector<>(0, 0, -m_depth - t));
+  m_container->GetCollisionModel()->AddBox(t, hw + 2 * t, m_depth, ChVector<>(-hl - t, 0, 0));
+  m_container->GetCollisionModel()->AddBox(t, hw + 2 * t, m_depth, ChVector<>(hl + t, 0, 0));
+  m_container->GetCollisionModel()->AddBox(hl, t, m_depth, ChVector<>(0, -hw - t, 0));
+  m_container->GetCollisionModel()->AddBox(hl, t, m_depth, ChVector<>(0, hw + t, 0));
+  m_container->GetCollisionModel()->BuildModel();
+  m_container->GetCollisionModel()->SetFamily(RigidTerrain::HEIGHTFIELD_FAMILY);
+  m_system->AddBody(m_container);
+
+  // Fill the pit on a cubic lattice, up to the bed level.
+  double d = 2 * m_radius * s_spacing;
+  int nx = std::max((int)(m_length / d), 1);
+  int ny = std::max((int)(m_width / d), 1);
+  int nz = std::max((int)(m_depth / d), 1);
+
+  for (int iz = 0; iz < nz; iz++) {
+    for (int iy = 0; iy < ny; iy++) {
+      for (int ix = 0; ix < nx; ix++) {
+        ChSharedPtr<ChBodyEasySphere> particle(new ChBodyEasySphere(m_radius, m_density, true, true));
+        particle->SetPos(m_center + ChVector<>(-hl + (ix + 0.5) * d, -hw + (iy + 0.5) * d, -m_depth + (iz + 0.5) * d));
+        particle->GetMaterialSurface()->SetFriction((float)m_mu);
+        m_system->AddBody(particle);
+        m_particles.push_back(particle);
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void GranularTerrain::Update(double time)
+{
+  if (m_tracked.IsNull() || m_container.IsNull())
+    return;
+
+  const ChVector<>& pos = m_tracked->GetPos();
+
+  if (pos.x > m_center.x + m_shift)
+    shift(0, 1);
+  else if (pos.x < m_center.x - m_shift)
+    shift(0, -1);
+
+  if (pos.y > m_center.y + m_shift)
+    shift(1, 1);
+  else if (pos.y < m_center.y - m_shift)
+    shift(1, -1);
+}
+
+// The recycled particles are those outside the new patch (i.e. mostly behind
+// its new rear edge) and those that escaped below the floor. They are placed
+// layer by layer, from the floor up, on a lattice of the strip uncovered at
+// the front of the patch; if the strip lattice is full, the next layer is
+// started.
+void GranularTerrain::shift(int axis, int dir)
+{
+  if (axis == 0)
+    m_center.x += dir * m_shift;
+  else
+    m_center.y += dir * m_shift;
+  m_container->SetPos(m_center);
+
+  double half_along = (axis == 0) ? m_length / 2 : m_width / 2;
+  double across = (axis == 0) ? m_width : m_length;
+  double floor = m_center.z - m_depth;
+
+  double d = 2 * m_radius * s_spacing;
+  int na = std::max((int)(m_shift / d), 1);
+  int nb = std::max((int)(across / d), 1);
+  double front = half_along - m_shift;   // start of the strip, from the patch center
+
+  int count = 0;
+  for (size_t i = 0; i < m_particles.size(); i++) {
+    ChBody* particle = m_particles[i].get_ptr();
+    ChVector<> rel = particle->GetPos() - m_center;
+    if (std::abs(rel.x) <= m_length / 2 && std::abs(rel.y) <= m_width / 2 && rel.z >= -m_depth - m_radius)
+      continue;
+
+    int layer = count / (na * nb);
+    int ia = (count % (na * nb)) % na;
+    int ib = (count % (na * nb)) / na;
+
+    double a = dir * (front + (ia + 0.5) * d);
+    double b = -across / 2 + (ib + 0.5) * d;
+    double z = floor + (layer + 0.5) * d;
+
+    particle->SetPos(ChVector<>(m_center.x + (axis == 0 ? a : b), m_center.y + (axis == 0 ? b : a), z));
+    particle->SetRot(QUNIT);
+    particle->SetPos_dt(VNULL);
+    particle->SetWvel_par(VNULL);
+    count++;
+  }
+
+  m_num_shifts++;
+  m_num_recycled += count;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool GranularTerrain::in_patch(double x, double y) const
+{
+  return !m_container.IsNull() && std::abs(x - m_center.x) < m_length / 2 && std::abs(y - m_center.y) < m_width / 2;
+}
+
+double GranularTerrain::GetHeight(double x, double y) const
+{
+  return in_patch(x, y) ? m_center.z - m_depth : m_surface->GetHeight(x, y);
+}
+
+ChVector<> GranularTerrain::GetNormal(double x, double y) const
+{
+  return in_patch(x, y) ? ChVector<>(0, 0, 1) : m_surface->GetNormal(x, y);
+}
+
+double GranularTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  return std::max(m_surface->GetMaxHeight(xmin, ymin, xmax, ymax), m_center.z);
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,154 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Granular terrain simulated only in a moving patch around a vehicle.
+//
+// The patch is a rectangular pit, aligned with the global axes, filled with
+// spherical particles up to the level of the surrounding terrain. Outside the
+// patch, the terrain is a rigid surface given by another terrain object (e.g.
+// a HeightmapTerrain). When the tracked body (typically the chassis) moves
+// farther than the shift distance from the patch center along X or Y, the
+// patch is moved by the shift distance in that direction, and the particles
+// left behind the new rear edge of the patch are recycled: they are placed at
+// rest, on a lattice, in the strip uncovered at the new front edge. The number
+// of particles, and hence the cost of a step, does not depend on the length of
+// the course.
+//
+// The pit floor and walls are a fixed collision body in the collision family
+// RigidTerrain::HEIGHTFIELD_FAMILY, so that they only contain the particles.
+// The wheels are meant to use rigid tires with both collision and height field
+// contact (see ChRigidTire::SetHeightfieldContact()): the wheel collision
+// bodies interact with the particles, while the height field contact supports
+// the wheels on the surrounding surface (GetHeight()) and on the pit floor.
+//
+// The bed level is set at initialization from the surrounding surface at the
+// patch center and is not changed by the shifts, so the surrounding surface
+// should be close to horizontal along the course.
+//
+// =============================================================================
+
+#ifndef GRANULARTERRAIN_H
+#define GRANULARTERRAIN_H
+
+#include <vector>
+
+#include "physics/ChSystem.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+
+
+namespace chrono {
+
+///
+/// Concrete class for a granular terrain simulated in a moving patch.
+///
+class CH_SUBSYS_API GranularTerrain : public ChTerrain
+{
+public:
+
+  GranularTerrain(
+    chrono::ChSystem*  system    ///< [in] pointer to the containing multibody system
+    );
+
+  ~GranularTerrain() {}
+
+  /// Set the terrain outside the patch (default: flat terrain at zero height).
+  /// Must be called before Initialize().
+  void SetSurface(ChSharedPtr<ChTerrain> surface) { m_surface = surface; }
+
+  /// Set the dimensions of the patch (default: 6 x 4 m, 0.2 m deep) and the
+  /// shift distance (default: a quarter of the patch length). Must be called
+  /// before Initialize().
+  void SetPatchSize(
+    double length,   ///< [in] patch dimension in the X direction
+    double width,    ///< [in] patch dimension in the Y direction
+    double depth,    ///< [in] depth of the granular bed
+    double shift     ///< [in] distance by which the patch is moved
+    );
+
+  /// Set the particle properties (default: 2 cm radius, 2500 kg/m^3,
+  /// friction coefficient 0.7). Must be called before Initialize().
+  void SetParticles(
+    double radius,    ///< [in] particle radius
+    double density,   ///< [in] particle density
+    double mu         ///< [in] coefficient of friction of the particles
+    );
+
+  /// Set the body followed by the patch (typically the vehicle chassis).
+  void SetTrackedBody(ChSharedPtr<ChBody> body) { m_tracked = body; }
+
+  /// Create the pit and fill it with particles, with the patch centered at
+  /// the specified (x,y) location.
+  void Initialize(double x, double y);
+
+  /// Move the patch and recycle the particles if the tracked body is farther
+  /// than the shift distance from the patch center.
+  virtual void Update(double time);
+
+  /// Get the terrain height at the specified (x,y) location.
+  /// Returns the height of the surrounding surface, or of the pit floor within
+  /// the patch.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the maximum terrain height over the specified x-y rectangle.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Get the current patch center (at the bed level).
+  const ChVector<>& GetPatchCenter() const { return m_center; }
+
+  /// Get the number of particles.
+  int GetNumParticles() const { return (int)m_particles.size(); }
+
+  /// Get the number of patch shifts and of recycled particles so far.
+  int GetNumShifts() const { return m_num_shifts; }
+  int GetNumRecycled() const { return m_num_recycled; }
+
+private:
+
+  // Return true if the specified location is within the patch.
+  bool in_patch(double x, double y) const;
+
+  // Move the patch by the shift distance along the specified axis (0: X,
+  // 1: Y) in the specified direction (+1 or -1) and recycle the particles.
+  void shift(int axis, int dir);
+
+  ChSystem*                          m_system;
+  ChSharedPtr<ChTerrain>             m_surface;
+  ChSharedPtr<ChBody>                m_tracked;
+
+  double                             m_length;
+  double                             m_width;
+  double                             m_depth;
+  double                             m_shift;
+  double                             m_radius;
+  double                             m_density;
+  double                             m_mu;
+
+  ChVector<>                         m_center;      // patch center, at the bed level
+  ChSharedPtr<ChBody>                m_container;   // pit floor and walls
+  std::vector<ChSharedPtr<ChBody> >  m_particles;
+
+  int                                m_num_shifts;
+  int                                m_num_recycled;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,798 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Height-map terrain defined on a regular grid over a rectangular x-y patch.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "core/ChLog.h"
+
+#include "subsys/terrain/HeightmapTerrain.h"
+
+
+namespace chrono {
+
+// Alignment of the cell records (cache line size).
+static const size_t CELL_ALIGNMENT = 64;
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+HeightmapTerrain::HeightmapTerrain(double sizeX,
+                                   double sizeY)
+: m_sizeX(sizeX),
+  m_sizeY(sizeY),
+  m_nx(0),
+  m_ny(0),
+  m_ncx(0),
+  m_ncy(0),
+  m_ntx(0),
+  m_xmin(-sizeX / 2),
+  m_ymin(-sizeY / 2),
+  m_inv_dx(0),
+  m_inv_dy(0),
+  m_offset(0),
+  m_num_updated_tiles(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Build the tiled cell records from the node heights.
+// -----------------------------------------------------------------------------
+bool HeightmapTerrain::SetHeights(int                       nx,
+                                  int                       ny,
+                                  const std::vector<float>& heights)
+{
+  if (nx < 2 || ny < 2 || heights.size() < (size_t)nx * ny) {
+    GetLog() << "ERROR: invalid height-map grid (" << nx << " x " << ny << ")\n";
+    return false;
+  }
+
+  m_nx = nx;
+  m_ny = ny;
+  m_ncx = nx - 1;
+  m_ncy = ny - 1;
+
+  double dx = m_sizeX / m_ncx;
+  double dy = m_sizeY / m_ncy;
+  m_inv_dx = 1 / dx;
+  m_inv_dy = 1 / dy;
+
+  // Allocate storage for a whole number of tiles in each direction.
+  m_ntx = (m_ncx + TILE_SIZE - 1) / TILE_SIZE;
+  int nty = (m_ncy + TILE_SIZE - 1) / TILE_SIZE;
+  size_t num_cells = (size_t)m_ntx * nty * TILE_SIZE * TILE_SIZE;
+
+  m_buffer.assign(num_cells * sizeof(Cell) + CELL_ALIGNMENT, 0);
+  size_t address = (size_t)&m_buffer[0];
+  m_offset = (CELL_ALIGNMENT - address % CELL_ALIGNMENT) % CELL_ALIGNMENT;
+  Cell* cells = reinterpret_cast<Cell*>(&m_buffer[m_offset]);
+
+  for (int j = 0; j < m_ncy; j++) {
+    // raster rows run from maximum to minimum y
+    const float* row0 = &heights[(size_t)(m_ny - 1 - j) * m_nx];
+    const float* row1 = &heights[(size_t)(m_ny - 2 - j) * m_nx];
+
+    for (int i = 0; i < m_ncx; i++) {
+      size_t tile = (size_t)(j / TILE_SIZE) * m_ntx + i / TILE_SIZE;
+      Cell& cell = cells[tile * TILE_SIZE * TILE_SIZE + (j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE];
+
+      cell.h00 = row0[i];
+      cell.h10 = row0[i + 1];
+      cell.h01 = row1[i];
+      cell.h11 = row1[i + 1];
+
+      compute_normal(cell);
+    }
+  }
+
+  build_max_pyramid();
+
+  m_tile_dirty.assign((size_t)m_ntx * nty, 0);
+  m_dirty_tiles.clear();
+  for (size_t k = 0; k < m_modifiers.size(); k++)
+    bind_modifier(m_modifiers[k]);
+
+  return true;
+}
+
+void HeightmapTerrain::compute_normal(Cell& cell) const
+{
+  double dzdx = 0.5 * ((cell.h10 - cell.h00) + (cell.h11 - cell.h01)) * m_inv_dx;
+  double dzdy = 0.5 * ((cell.h01 - cell.h00) + (cell.h11 - cell.h10)) * m_inv_dy;
+  double inv_len = 1 / std::sqrt(dzdx * dzdx + dzdy * dzdy + 1);
+
+  cell.nx = (float)(-dzdx * inv_len);
+  cell.ny = (float)(-dzdy * inv_len);
+  cell.nz = (float)inv_len;
+}
+
+// -----------------------------------------------------------------------------
+// Incremental modification of the heights.
+// -----------------------------------------------------------------------------
+float HeightmapTerrain::get_node_height(int i, int j) const
+{
+  // Node (i,j) is the lower-left corner of cell (i,j), except on the last
+  // column and row of nodes.
+  int ci = std::min(i, m_ncx - 1);
+  int cj = std::min(j, m_ncy - 1);
+  const Cell& cell = get_cell(ci, cj);
+
+  if (i == ci)
+    return (j == cj) ? cell.h00 : cell.h01;
+  return (j == cj) ? cell.h10 : cell.h11;
+}
+
+void HeightmapTerrain::set_node_height(int i, int j, float height)
+{
+  if (get_node_height(i, j) == height)
+    return;
+
+  // Update the corner of each cell sharing the node.
+  for (int cj = std::max(j - 1, 0); cj <= std::min(j, m_ncy - 1); cj++) {
+    for (int ci = std::max(i - 1, 0); ci <= std::min(i, m_ncx - 1); ci++) {
+      Cell& cell = get_cell(ci, cj);
+      if (ci == i)
+        (cj == j ? cell.h00 : cell.h01) = height;
+      else
+        (cj == j ? cell.h10 : cell.h11) = height;
+
+      int tile = (cj / TILE_SIZE) * m_ntx + ci / TILE_SIZE;
+      if (!m_tile_dirty[tile]) {
+        m_tile_dirty[tile] = 1;
+        m_dirty_tiles.push_back(tile);
+      }
+    }
+  }
+}
+
+void HeightmapTerrain::bind_modifier(Modifier& m)
+{
+  m.base.clear();
+  m.i0 = m.j0 = 0;
+  m.i1 = m.j1 = -1;
+  if (m_nx == 0)
+    return;
+
+  m.i0 = std::max((int)std::ceil((m.xmin - m_xmin) * m_inv_dx), 0);
+  m.i1 = std::min((int)std::floor((m.xmax - m_xmin) * m_inv_dx), m_nx - 1);
+  m.j0 = std::max((int)std::ceil((m.ymin - m_ymin) * m_inv_dy), 0);
+  m.j1 = std::min((int)std::floor((m.ymax - m_ymin) * m_inv_dy), m_ny - 1);
+  if (m.i0 > m.i1 || m.j0 > m.j1)
+    return;
+
+  m.base.resize((size_t)(m.i1 - m.i0 + 1) * (m.j1 - m.j0 + 1));
+  size_t k = 0;
+  for (int j = m.j0; j <= m.j1; j++) {
+    for (int i = m.i0; i <= m.i1; i++)
+      m.base[k++] = get_node_height(i, j);
+  }
+}
+
+bool HeightmapTerrain::SetNodeHeights(int                       i0,
+                                      int                       j0,
+                                      int                       ni,
+                                      int                       nj,
+                                      const std::vector<float>& heights)
+{
+  if (i0 < 0 || j0 < 0 || ni < 0 || nj < 0 || i0 + ni > m_nx || j0 + nj > m_ny ||
+      heights.size() < (size_t)ni * nj) {
+    GetLog() << "ERROR: invalid height-map block (" << ni << " x " << nj << " at " << i0 << ", " << j0 << ")\n";
+    return false;
+  }
+
+  for (int r = 0; r < nj; r++) {
+    // raster rows run from maximum to minimum y
+    int j = m_ny - 1 - (j0 + r);
+    for (int c = 0; c < ni; c++) {
+      int i = i0 + c;
+      float h = heights[(size_t)r * ni + c];
+      set_node_height(i, j, h);
+
+      for (size_t k = 0; k < m_modifiers.size(); k++) {
+        Modifier& m = m_modifiers[k];
+        if (i >= m.i0 && i <= m.i1 && j >= m.j0 && j <= m.j1)
+          m.base[(size_t)(j - m.j0) * (m.i1 - m.i0 + 1) + (i - m.i0)] = h;
+      }
+    }
+  }
+
+  rebuild_dirty_tiles();
+
+  return true;
+}
+
+int HeightmapTerrain::AddModifier(ChSharedPtr<ChHeightModifier> modifier,
+                                  double                        xmin,
+                                  double                        ymin,
+                                  double                        xmax,
+                                  double                        ymax)
+{
+  Modifier m;
+  m.modifier = modifier;
+  m.xmin = std::min(xmin, xmax);
+  m.ymin = std::min(ymin, ymax);
+  m.xmax = std::max(xmin, xmax);
+  m.ymax = std::max(ymin, ymax);
+  m_modifiers.push_back(m);
+
+  bind_modifier(m_modifiers.back());
+
+  return (int)m_modifiers.size() - 1;
+}
+
+void HeightmapTerrain::Update(double time)
+{
+  if (m_modifiers.empty())
+    return;
+
+  for (size_t k = 0; k < m_modifiers.size(); k++) {
+    const Modifier& m = m_modifiers[k];
+    size_t n = 0;
+    for (int j = m.j0; j <= m.j1; j++) {
+      double y = m_ymin + j / m_inv_dy;
+      for (int i = m.i0; i <= m.i1; i++) {
+        double x = m_xmin + i / m_inv_dx;
+        set_node_height(i, j, (float)m.modifier->GetHeight(time, x, y, m.base[n++]));
+      }
+    }
+  }
+
+  rebuild_dirty_tiles();
+}
+
+// -----------------------------------------------------------------------------
+// Only the cells of the dirty tiles get new normals and level-0 pyramid
+// entries; at each coarser level, the entries covering the tile are
+// recomputed from the level below.
+// -----------------------------------------------------------------------------
+void HeightmapTerrain::rebuild_dirty_tiles()
+{
+  m_num_updated_tiles = (int)m_dirty_tiles.size();
+
+  for (size_t t = 0; t < m_dirty_tiles.size(); t++) {
+    int tile = m_dirty_tiles[t];
+    m_tile_dirty[tile] = 0;
+
+    int i0 = (tile % m_ntx) * TILE_SIZE;
+    int j0 = (tile / m_ntx) * TILE_SIZE;
+    int i1 = std::min(i0 + TILE_SIZE, m_ncx) - 1;
+    int j1 = std::min(j0 + TILE_SIZE, m_ncy) - 1;
+
+    std::vector<float>& level0 = m_max_levels[0];
+    for (int j = j0; j <= j1; j++) {
+      for (int i = i0; i <= i1; i++) {
+        Cell& cell = get_cell(i, j);
+        compute_normal(cell);
+        level0[(size_t)j * m_ncx + i] = std::max(std::max(cell.h00, cell.h10), std::max(cell.h01, cell.h11));
+      }
+    }
+
+    for (size_t k = 1; k < m_max_levels.size(); k++) {
+      const std::vector<float>& fine = m_max_levels[k - 1];
+      std::vector<float>& coarse = m_max_levels[k];
+      int fnx = m_max_nx[k - 1];
+      int fny = m_max_ny[k - 1];
+      int cnx = m_max_nx[k];
+
+      i0 /= 2;
+      j0 /= 2;
+      i1 /= 2;
+      j1 /= 2;
+      for (int j = j0; j <= j1; j++) {
+        for (int i = i0; i <= i1; i++) {
+          int fi1 = std::min(2 * i + 1, fnx - 1);
+          int fj1 = std::min(2 * j + 1, fny - 1);
+          float h = std::max(fine[(size_t)(2 * j) * fnx + 2 * i], fine[(size_t)(2 * j) * fnx + fi1]);
+          h = std::max(h, std::max(fine[(size_t)fj1 * fnx + 2 * i], fine[(size_t)fj1 * fnx + fi1]));
+          coarse[(size_t)j * cnx + i] = h;
+        }
+      }
+    }
+  }
+
+  m_dirty_tiles.clear();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void HeightmapTerrain::build_max_pyramid()
+{
+  m_max_levels.clear();
+  m_max_nx.clear();
+  m_max_ny.clear();
+
+  // Level 0: maximum corner height of each cell (the bilinear interpolant is
+  // bounded by its corner values).
+  std::vector<float> level0((size_t)m_ncx * m_ncy);
+  for (int j = 0; j < m_ncy; j++) {
+    for (int i = 0; i < m_ncx; i++) {
+      double tx, ty;
+      const Cell& cell = find_cell(m_xmin + (i + 0.5) / m_inv_dx, m_ymin + (j + 0.5) / m_inv_dy, tx, ty);
+      level0[(size_t)j * m_ncx + i] = std::max(std::max(cell.h00, cell.h10), std::max(cell.h01, cell.h11));
+    }
+  }
+
+  m_max_levels.push_back(level0);
+  m_max_nx.push_back(m_ncx);
+  m_max_ny.push_back(m_ncy);
+
+  while (m_max_nx.back() > 1 || m_max_ny.back() > 1) {
+    const std::vector<float>& fine = m_max_levels.back();
+    int fnx = m_max_nx.back();
+    int fny = m_max_ny.back();
+    int cnx = (fnx + 1) / 2;
+    int cny = (fny + 1) / 2;
+
+    std::vector<float> coarse((size_t)cnx * cny);
+    for (int j = 0; j < cny; j++) {
+      for (int i = 0; i < cnx; i++) {
+        int i1 = std::min(2 * i + 1, fnx - 1);
+        int j1 = std::min(2 * j + 1, fny - 1);
+        float h = std::max(fine[(size_t)(2 * j) * fnx + 2 * i], fine[(size_t)(2 * j) * fnx + i1]);
+        h = std::max(h, std::max(fine[(size_t)j1 * fnx + 2 * i], fine[(size_t)j1 * fnx + i1]));
+        coarse[(size_t)j * cnx + i] = h;
+      }
+    }
+
+    m_max_levels.push_back(coarse);
+    m_max_nx.push_back(cnx);
+    m_max_ny.push_back(cny);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool HeightmapTerrain::LoadRaw(const std::string& filename,
+                               int                nx,
+                               int                ny,
+                               double             hScale,
+                               double             hOffset)
+{
+  if (nx < 2 || ny < 2) {
+    GetLog() << "ERROR: invalid height-map grid (" << nx << " x " << ny << ")\n";
+    return false;
+  }
+
+  std::ifstream ifile(filename.c_str(), std::ios::in | std::ios::binary);
+  std::vector<float> heights((size_t)nx * ny);
+
+  ifile.read(reinterpret_cast<char*>(&heights[0]), heights.size() * sizeof(float));
+
+  if (!ifile) {
+    GetLog() << "ERROR: cannot read " << nx << " x " << ny << " heights from " << filename.c_str() << "\n";
+    return false;
+  }
+
+  for (size_t k = 0; k < heights.size(); k++)
+    heights[k] = (float)(hScale * heights[k] + hOffset);
+
+  return SetHeights(nx, ny, heights);
+}
+
+// -----------------------------------------------------------------------------
+// Binary PGM: "P5", width, height, maxval (separated by white space, with
+// optional comments), a single white space character, then the samples, with
+// two bytes per sample (most significant first) if maxval > 255.
+// -----------------------------------------------------------------------------
+static bool ReadPGMHeader(std::ifstream& ifile, int values[3])
+{
+  std::string magic;
+  ifile >> magic;
+  if (magic != "P5")
+    return false;
+
+  for (int k = 0; k < 3; k++) {
+    ifile >> std::ws;
+    while (ifile.peek() == '#') {
+      std::string comment;
+      std::getline(ifile, comment);
+      ifile >> std::ws;
+    }
+    ifile >> values[k];
+  }
+
+  // single white space before the data
+  ifile.get();
+
+  return !ifile.fail();
+}
+
+bool HeightmapTerrain::ReadPGM(const std::string&  filename,
+                               double              vMin,
+                               double              vMax,
+                               int&                nx,
+                               int&                ny,
+                               std::vector<float>& values)
+{
+  std::ifstream ifile(filename.c_str(), std::ios::in | std::ios::binary);
+  int header[3];
+
+  if (!ReadPGMHeader(ifile, header) || header[2] <= 0 || header[2] > 65535) {
+    GetLog() << "ERROR: " << filename.c_str() << " is not a binary PGM image\n";
+    return false;
+  }
+
+  nx = header[0];
+  ny = header[1];
+  int maxval = header[2];
+  int bytes = (maxval > 255) ? 2 : 1;
+
+  if (nx < 2 || ny < 2) {
+    GetLog() << "ERROR: invalid PGM grid (" << nx << " x " << ny << ")\n";
+    return false;
+  }
+
+  std::vector<unsigned char> samples((size_t)nx * ny * bytes);
+  ifile.read(reinterpret_cast<char*>(&samples[0]), samples.size());
+
+  if (!ifile) {
+    GetLog() << "ERROR: truncated PGM image " << filename.c_str() << "\n";
+    return false;
+  }
+
+  values.resize((size_t)nx * ny);
+  double scale = (vMax - vMin) / maxval;
+
+  for (size_t k = 0; k < values.size(); k++) {
+    int value = (bytes == 2) ? (samples[2 * k] << 8) | samples[2 * k + 1] : samples[k];
+    values[k] = (float)(vMin + scale * value);
+  }
+
+  return true;
+}
+
+bool HeightmapTerrain::LoadPGM(const std::string& filename,
+                               double             hMin,
+                               double             hMax)
+{
+  int nx, ny;
+  std::vector<float> heights;
+
+  if (!ReadPGM(filename, hMin, hMax, nx, ny, heights))
+    return false;
+
+  return SetHeights(nx, ny, heights);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const HeightmapTerrain::Cell& HeightmapTerrain::find_cell(double x, double y, double& tx, double& ty) const
+{
+  double u = (x - m_xmin) * m_inv_dx;
+  double v = (y - m_ymin) * m_inv_dy;
+
+  // Clamp to the grid; outside the grid, the boundary cells are extended.
+  if (u < 0)
+    u = 0;
+  else if (u > m_ncx)
+    u = m_ncx;
+  if (v < 0)
+    v = 0;
+  else if (v > m_ncy)
+    v = m_ncy;
+
+  int i = (int)u;
+  int j = (int)v;
+  if (i > m_ncx - 1)
+    i = m_ncx - 1;
+  if (j > m_ncy - 1)
+    j = m_ncy - 1;
+
+  tx = u - i;
+  ty = v - j;
+
+  return get_cell(i, j);
+}
+
+const HeightmapTerrain::Cell& HeightmapTerrain::get_cell(int i, int j) const
+{
+  const Cell* cells = reinterpret_cast<const Cell*>(&m_buffer[m_offset]);
+  size_t tile = (size_t)(j / TILE_SIZE) * m_ntx + i / TILE_SIZE;
+
+  return cells[tile * TILE_SIZE * TILE_SIZE + (j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE];
+}
+
+HeightmapTerrain::Cell& HeightmapTerrain::get_cell(int i, int j)
+{
+  Cell* cells = reinterpret_cast<Cell*>(&m_buffer[m_offset]);
+  size_t tile = (size_t)(j / TILE_SIZE) * m_ntx + i / TILE_SIZE;
+
+  return cells[tile * TILE_SIZE * TILE_SIZE + (j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE];
+}
+
+void HeightmapTerrain::find_cell_index(double x, double y, int& i, int& j) const
+{
+  double u = (x - m_xmin) * m_inv_dx;
+  double v = (y - m_ymin) * m_inv_dy;
+
+  i = (u <= 0) ? 0 : (u >= m_ncx - 1) ? m_ncx - 1 : (int)u;
+  j = (v <= 0) ? 0 : (v >= m_ncy - 1) ? m_ncy - 1 : (int)v;
+}
+
+double HeightmapTerrain::GetHeight(double x, double y) const
+{
+  if (m_buffer.empty())
+    return 0;
+
+  double tx, ty;
+  const Cell& cell = find_cell(x, y, tx, ty);
+
+  double h0 = cell.h00 + tx * (cell.h10 - cell.h00);
+  double h1 = cell.h01 + tx * (cell.h11 - cell.h01);
+
+  return h0 + ty * (h1 - h0);
+}
+
+ChVector<> HeightmapTerrain::GetNormal(double x, double y) const
+{
+  if (m_buffer.empty())
+    return ChVector<>(0, 0, 1);
+
+  double tx, ty;
+  const Cell& cell = find_cell(x, y, tx, ty);
+
+  return ChVector<>(cell.nx, cell.ny, cell.nz);
+}
+
+void HeightmapTerrain::GetHeightAndNormal(int           n,
+                                          const double* x,
+                                          const double* y,
+                                          double*       height,
+                                          ChVector<>*   normal) const
+{
+  if (m_buffer.empty()) {
+    ChTerrain::GetHeightAndNormal(n, x, y, height, normal);
+    return;
+  }
+
+  for (int i = 0; i < n; i++) {
+    double tx, ty;
+    const Cell& cell = find_cell(x[i], y[i], tx, ty);
+
+    double h0 = cell.h00 + tx * (cell.h10 - cell.h00);
+    double h1 = cell.h01 + tx * (cell.h11 - cell.h01);
+    height[i] = h0 + ty * (h1 - h0);
+
+    if (normal)
+      normal[i] = ChVector<>(cell.nx, cell.ny, cell.nz);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Pick the finest pyramid level at which the cell range of the rectangle spans
+// at most two entries in each direction.
+// -----------------------------------------------------------------------------
+double HeightmapTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  if (m_buffer.empty())
+    return 0;
+
+  int i0, j0, i1, j1;
+  find_cell_index(xmin, ymin, i0, j0);
+  find_cell_index(xmax, ymax, i1, j1);
+
+  int level = 0;
+  while ((i1 >> level) - (i0 >> level) > 1 || (j1 >> level) - (j0 >> level) > 1)
+    level++;
+
+  const std::vector<float>& hmax = m_max_levels[level];
+  int nx = m_max_nx[level];
+  i0 >>= level;
+  i1 >>= level;
+  j0 >>= level;
+  j1 >>= level;
+
+  float h = hmax[(size_t)j0 * nx + i0];
+  h = std::max(h, hmax[(size_t)j0 * nx + i1]);
+  h = std::max(h, hmax[(size_t)j1 * nx + i0]);
+  h = std::max(h, hmax[(size_t)j1 * nx + i1]);
+
+  return h;
+}
+
+
+// -----------------------------------------------------------------------------
+// Ray cast. The ray is traversed in grid coordinates (u, v in cell units), one
+// pyramid cell at a time, from the coarsest level: a cell is skipped if the
+// lowest point of the ray over the cell is above its maximum height, and
+// refined otherwise. Cells are stepped by index (as in a DDA), moving up one
+// level when the ray crosses into another parent cell.
+// -----------------------------------------------------------------------------
+bool HeightmapTerrain::CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const
+{
+  if (m_buffer.empty())
+    return ChTerrain::CastRay(origin, dir, max_dist, dist);
+
+  double uo = (origin.x - m_xmin) * m_inv_dx;
+  double vo = (origin.y - m_ymin) * m_inv_dy;
+  double du = dir.x * m_inv_dx;
+  double dv = dir.y * m_inv_dy;
+
+  // Clip the ray to the grid.
+  double tmin = 0;
+  double tmax = max_dist;
+  if (du != 0) {
+    double ta = -uo / du;
+    double tb = (m_ncx - uo) / du;
+    tmin = std::max(tmin, std::min(ta, tb));
+    tmax = std::min(tmax, std::max(ta, tb));
+  } else if (uo < 0 || uo > m_ncx) {
+    return false;
+  }
+  if (dv != 0) {
+    double ta = -vo / dv;
+    double tb = (m_ncy - vo) / dv;
+    tmin = std::max(tmin, std::min(ta, tb));
+    tmax = std::min(tmax, std::max(ta, tb));
+  } else if (vo < 0 || vo > m_ncy) {
+    return false;
+  }
+  if (tmin > tmax)
+    return false;
+
+  int top = (int)m_max_levels.size() - 1;
+  int level = top;
+  int ci = 0;
+  int cj = 0;
+  int si = (du > 0) ? 1 : -1;
+  int sj = (dv > 0) ? 1 : -1;
+  double t = tmin;
+  const double inf = std::numeric_limits<double>::infinity();
+
+  while (true) {
+    // Extent of the cell, in grid cells, and parameter at which the ray exits.
+    int i0 = ci << level;
+    int j0 = cj << level;
+    int i1 = std::min((ci + 1) << level, m_ncx);
+    int j1 = std::min((cj + 1) << level, m_ncy);
+    double tx = (du > 0) ? (i1 - uo) / du : (du < 0) ? (i0 - uo) / du : inf;
+    double ty = (dv > 0) ? (j1 - vo) / dv : (dv < 0) ? (j0 - vo) / dv : inf;
+    double te = std::min(std::min(tx, ty), tmax);
+
+    double zmin = origin.z + dir.z * ((dir.z < 0) ? te : t);
+    if (zmin <= m_max_levels[level][(size_t)cj * m_max_nx[level] + ci]) {
+      if (level > 0) {
+        // Refine into the child cell containing the ray at t.
+        level--;
+        double u = uo + t * du;
+        double v = vo + t * dv;
+        int umid = (2 * ci + 1) << level;
+        int vmid = (2 * cj + 1) << level;
+        ci = 2 * ci + ((du < 0) ? (u > umid) : (u >= umid));
+        cj = 2 * cj + ((dv < 0) ? (v > vmid) : (v >= vmid));
+        ci = std::min(ci, m_max_nx[level] - 1);
+        cj = std::min(cj, m_max_ny[level] - 1);
+        continue;
+      }
+      if (intersect_cell(ci, cj, origin, dir, t, te, dist))
+        return true;
+    }
+
+    if (te >= tmax)
+      return false;
+
+    // Step to the next cell of this level (both indices at a corner).
+    int pi = ci >> 1;
+    int pj = cj >> 1;
+    if (tx <= ty)
+      ci += si;
+    if (ty <= tx)
+      cj += sj;
+    if (ci < 0 || ci >= m_max_nx[level] || cj < 0 || cj >= m_max_ny[level])
+      return false;
+    t = te;
+
+    if (level < top && ((ci >> 1) != pi || (cj >> 1) != pj)) {
+      level++;
+      ci >>= 1;
+      cj >>= 1;
+    }
+  }
+}
+
+// Smallest positive root of A s^2 + B s + C, with C > 0 (infinity if none).
+static double first_root(double A, double B, double C)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+
+  if (std::abs(A) <= 1e-12 * (std::abs(B) + std::abs(C)))
+    return (B < 0) ? -C / B : inf;
+
+  double disc = B * B - 4 * A * C;
+  if (disc < 0)
+    return inf;
+
+  // Stable form of the roots: q / A and C / q.
+  double q = -0.5 * (B + ((B < 0) ? -1 : 1) * std::sqrt(disc));
+  double r1 = q / A;
+  double r2 = C / q;
+  double r = inf;
+  if (r1 > 0)
+    r = r1;
+  if (r2 > 0 && r2 < r)
+    r = r2;
+
+  return r;
+}
+
+// On the cell, the height is h00 + e X + f Y + g X Y, with X and Y the local
+// coordinates, linear along the ray: the height of the ray above the surface
+// is a quadratic function of the ray parameter.
+bool HeightmapTerrain::intersect_cell(int               i,
+                                      int               j,
+                                      const ChVector<>& origin,
+                                      const ChVector<>& dir,
+                                      double            t0,
+                                      double            t1,
+                                      double&           dist) const
+{
+  const Cell& cell = get_cell(i, j);
+
+  double du = dir.x * m_inv_dx;
+  double dv = dir.y * m_inv_dy;
+  double a = (origin.x - m_xmin) * m_inv_dx + t0 * du - i;
+  double b = (origin.y - m_ymin) * m_inv_dy + t0 * dv - j;
+
+  double e = cell.h10 - cell.h00;
+  double f = cell.h01 - cell.h00;
+  double g = cell.h00 - cell.h10 - cell.h01 + cell.h11;
+
+  double C = origin.z + t0 * dir.z - (cell.h00 + e * a + f * b + g * a * b);
+  double B = dir.z - (e * du + f * dv + g * (a * dv + b * du));
+  double A = -g * du * dv;
+  double len = t1 - t0;
+
+  if (C <= 0) {
+    dist = t0;
+    return true;
+  }
+
+  double s = first_root(A, B, C);
+  if (s > len)
+    return false;
+
+  dist = t0 + s;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void HeightmapTerrain::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  size_t pyramid = vehicle::ChMemoryReport::VectorBytes(m_max_levels) +
+                   vehicle::ChMemoryReport::VectorBytes(m_max_nx) + vehicle::ChMemoryReport::VectorBytes(m_max_ny);
+  for (size_t k = 0; k < m_max_levels.size(); k++)
+    pyramid += vehicle::ChMemoryReport::VectorBytes(m_max_levels[k]);
+
+  report.Add("terrain/objects", sizeof(HeightmapTerrain));
+  report.Add("terrain/height fields", m_buffer.capacity() + pyramid);
+
+  size_t modifiers = vehicle::ChMemoryReport::VectorBytes(m_modifiers) +
+                     vehicle::ChMemoryReport::VectorBytes(m_tile_dirty) +
+                     vehicle::ChMemoryReport::VectorBytes(m_dirty_tiles);
+  for (size_t k = 0; k < m_modifiers.size(); k++)
+    modifiers += vehicle::ChMemoryReport::VectorBytes(m_modifiers[k].base);
+  report.Add("terrain/height modifiers", modifiers);
+
+  ChTerrain::AddMemoryFootprint(report);
+}
+
+
+} // end namespace chrono
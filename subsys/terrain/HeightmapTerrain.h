@@ -0,0 +1,300 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Height-map terrain defined on a regular grid over a rectangular x-y patch.
+//
+// The grid is centered at the origin of the x-y plane. Heights are obtained by
+// bilinear interpolation of the grid node heights; each grid cell has a
+// constant normal, precomputed from the average slopes of the cell. Outside the
+// grid, the terrain extends the heights and normals of the boundary cells.
+//
+// Each cell stores its four corner heights and its normal in a single 32-byte
+// record, such that a query touches exactly one record. Records are grouped in
+// square tiles of TILE_SIZE x TILE_SIZE cells, stored contiguously in a
+// cache-line aligned buffer, so that the queries of nearby contact points
+// (e.g. the discs of a tire) hit the same or adjacent cache lines.
+//
+// Height and normal queries take constant time and do not allocate memory.
+//
+// The heights can be modified after construction, either directly (a block of
+// nodes at a time) or by time-dependent height modifiers evaluated at each
+// update over their rectangular regions (e.g. moving platforms, rising water
+// levels, scripted terrain changes). The tiles with modified nodes are marked
+// dirty, and only their normals and the pyramid entries above them are
+// rebuilt, so that a change costs in proportion to the modified area rather
+// than to the whole map.
+//
+// =============================================================================
+
+#ifndef HEIGHTMAPTERRAIN_H
+#define HEIGHTMAPTERRAIN_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+
+namespace chrono {
+
+///
+/// Time-dependent modification of the heights of a height-map terrain over a
+/// rectangular region (see HeightmapTerrain::AddModifier()).
+///
+class CH_SUBSYS_API ChHeightModifier : public ChShared
+{
+public:
+  virtual ~ChHeightModifier() {}
+
+  /// Return the height of the node at the specified (x,y) location at the
+  /// specified time, given its unmodified height (e.g. max(base, level) for a
+  /// water level, or the platform height over the current platform footprint
+  /// and the base height elsewhere).
+  virtual double GetHeight(double time, double x, double y, double base) const = 0;
+};
+
+///
+/// Concrete class for a height-map terrain.
+/// The terrain heights are specified on a regular grid of nx x ny nodes,
+/// either directly or loaded from a raster file. This type of terrain can be
+/// used in conjunction with tire models that perform their own collision
+/// detection (e.g. ChPacejkaTire and ChLugreTire).
+///
+class CH_SUBSYS_API HeightmapTerrain : public ChTerrain
+{
+public:
+
+  HeightmapTerrain(
+    double sizeX,   ///< [in] terrain dimension in the X direction
+    double sizeY    ///< [in] terrain dimension in the Y direction
+    );
+
+  ~HeightmapTerrain() {}
+
+  /// Set the grid heights directly.
+  /// The heights are given row by row, with nx values per row; the first row
+  /// corresponds to the maximum y and the first value in a row to the minimum x
+  /// (i.e., the usual raster image orientation).
+  /// Returns false if the grid has fewer than 2 x 2 nodes.
+  bool SetHeights(
+    int                        nx,        ///< [in] number of grid nodes in the X direction
+    int                        ny,        ///< [in] number of grid nodes in the Y direction
+    const std::vector<float>&  heights    ///< [in] node heights (nx * ny values)
+    );
+
+  /// Set the heights of a block of ni x nj grid nodes, starting at column i0
+  /// and row j0 of the raster (see SetHeights()), with the block heights given
+  /// in raster order. Only the tiles containing the modified nodes are
+  /// rebuilt. Inside the region of a modifier, the heights set here are the
+  /// unmodified heights passed to the modifier at the next update.
+  /// Returns false if the block is not inside the grid.
+  bool SetNodeHeights(
+    int                        i0,        ///< [in] raster column of the first node of the block
+    int                        j0,        ///< [in] raster row of the first node of the block
+    int                        ni,        ///< [in] number of nodes of the block in the X direction
+    int                        nj,        ///< [in] number of nodes of the block in the Y direction
+    const std::vector<float>&  heights    ///< [in] node heights (ni * nj values)
+    );
+
+  /// Add a time-dependent modifier of the heights of the grid nodes inside
+  /// the specified x-y rectangle. The modifier is evaluated at each update,
+  /// on the nodes of its region only, and the tiles whose heights changed are
+  /// rebuilt. Regions should not overlap; where they do, the last modifier
+  /// added wins. Returns the index of the modifier.
+  int AddModifier(
+    ChSharedPtr<ChHeightModifier>  modifier,   ///< [in] height modifier
+    double                         xmin,       ///< [in] minimum x of the region
+    double                         ymin,       ///< [in] minimum y of the region
+    double                         xmax,       ///< [in] maximum x of the region
+    double                         ymax        ///< [in] maximum y of the region
+    );
+
+  /// Get the number of height modifiers.
+  int GetNumModifiers() const { return (int)m_modifiers.size(); }
+
+  /// Apply the height modifiers at the specified time and rebuild the tiles
+  /// whose heights changed.
+  virtual void Update(double time);
+
+  /// Get the number of tiles rebuilt by the last height modification.
+  int GetNumUpdatedTiles() const { return m_num_updated_tiles; }
+
+  /// Load the grid heights from a raw grid of 32-bit floats (native byte
+  /// order, no header), in the same order as for SetHeights().
+  /// Returns false if the file cannot be read.
+  bool LoadRaw(
+    const std::string&  filename,   ///< [in] name of the raw file
+    int                 nx,         ///< [in] number of grid nodes in the X direction
+    int                 ny,         ///< [in] number of grid nodes in the Y direction
+    double              hScale = 1, ///< [in] scale factor applied to all heights
+    double              hOffset = 0 ///< [in] offset added to all (scaled) heights
+    );
+
+  /// Load the grid heights from a binary (P5) PGM image with 8-bit or 16-bit
+  /// samples. Each pixel is a grid node, with the pixel values mapped linearly
+  /// from [0, maxval] to [hMin, hMax].
+  /// Returns false if the file cannot be read.
+  bool LoadPGM(
+    const std::string&  filename,   ///< [in] name of the PGM image file
+    double              hMin,       ///< [in] height corresponding to black pixels
+    double              hMax        ///< [in] height corresponding to white pixels
+    );
+
+  /// Read a binary (P5) PGM image with 8-bit or 16-bit samples, with the pixel
+  /// values mapped linearly from [0, maxval] to [vMin, vMax]. The values are
+  /// returned in raster order (see SetHeights()).
+  /// Returns false if the file cannot be read.
+  static bool ReadPGM(
+    const std::string&   filename,  ///< [in] name of the PGM image file
+    double               vMin,      ///< [in] value corresponding to black pixels
+    double               vMax,      ///< [in] value corresponding to white pixels
+    int&                 nx,        ///< [out] image width
+    int&                 ny,        ///< [out] image height
+    std::vector<float>&  values     ///< [out] pixel values (nx * ny values)
+    );
+
+  /// Get the terrain height at the specified (x,y) location.
+  /// Returns 0 if no heights were specified.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  /// Returns the normal of the grid cell containing the specified location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations,
+  /// with a single cell lookup per location.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get an upper bound of the terrain height over the specified x-y
+  /// rectangle, from a pyramid of maximum cell heights (each level halving the
+  /// resolution of the previous one). The bound is the maximum node height
+  /// over at most 2 x 2 pyramid cells covering the rectangle.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Cast a ray against the height map, with a hierarchical traversal of the
+  /// pyramid of maximum heights: the pyramid cells above which the ray passes
+  /// are skipped whole, and the ray is intersected exactly with the bilinear
+  /// patches of the grid cells it may hit. Only the part of the ray over the
+  /// grid is traced (the extension of the terrain outside the grid is not hit).
+  virtual bool CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const;
+
+  /// Add the terrain object, its cell records and its pyramid of maximum
+  /// heights to the specified report.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Get the number of grid nodes in the X and Y directions.
+  int GetNumNodesX() const { return m_nx; }
+  int GetNumNodesY() const { return m_ny; }
+
+  /// Get the terrain dimensions.
+  double GetSizeX() const { return m_sizeX; }
+  double GetSizeY() const { return m_sizeY; }
+
+  /// Number of cells along each side of a tile.
+  static const int TILE_SIZE = 8;
+
+private:
+
+  // Cell record: corner heights at (x0,y0), (x1,y0), (x0,y1), (x1,y1) and the
+  // cell normal, padded to 32 bytes.
+  struct Cell {
+    float h00, h10, h01, h11;
+    float nx, ny, nz;
+    float pad;
+  };
+
+  // Height modifier, with the range of grid nodes (indices from minimum x and
+  // minimum y) inside its region and their unmodified heights.
+  struct Modifier {
+    ChSharedPtr<ChHeightModifier>  modifier;
+    double                         xmin;
+    double                         ymin;
+    double                         xmax;
+    double                         ymax;
+    int                            i0, j0;
+    int                            i1, j1;
+    std::vector<float>             base;
+  };
+
+  // Get the record of the cell with the specified indices.
+  const Cell& get_cell(int i, int j) const;
+  Cell& get_cell(int i, int j);
+
+  // Compute the cell normal from the average slopes over the cell.
+  void compute_normal(Cell& cell) const;
+
+  // Get and set the height of the grid node with the specified indices (from
+  // minimum x and minimum y). Setting a different height marks the tiles of
+  // the cells sharing the node as dirty.
+  float get_node_height(int i, int j) const;
+  void set_node_height(int i, int j, float height);
+
+  // Find the nodes inside the region of the modifier and record their heights.
+  void bind_modifier(Modifier& m);
+
+  // Rebuild the normals and the pyramid entries of the dirty tiles.
+  void rebuild_dirty_tiles();
+
+  // Intersect the ray with the bilinear patch of the specified cell, over the
+  // specified range of the ray parameter.
+  bool intersect_cell(int i, int j, const ChVector<>& origin, const ChVector<>& dir, double t0, double t1, double& dist)
+      const;
+
+  // Find the cell containing (x,y), clamped to the grid, and the local
+  // coordinates (in [0,1]) within that cell.
+  const Cell& find_cell(double x, double y, double& tx, double& ty) const;
+
+  // Find the indices of the cell containing (x,y), clamped to the grid.
+  void find_cell_index(double x, double y, int& i, int& j) const;
+
+  // Build the pyramid of maximum heights from the cell records.
+  void build_max_pyramid();
+
+  double               m_sizeX;
+  double               m_sizeY;
+
+  int                  m_nx;           // number of nodes in each direction
+  int                  m_ny;
+  int                  m_ncx;          // number of cells in each direction
+  int                  m_ncy;
+  int                  m_ntx;          // number of tiles in the X direction
+
+  double               m_xmin;
+  double               m_ymin;
+  double               m_inv_dx;       // inverse of the cell dimensions
+  double               m_inv_dy;
+
+  std::vector<char>    m_buffer;       // storage for the cell records
+  size_t               m_offset;       // offset of the first (aligned) record in m_buffer
+
+  // Pyramid of maximum heights. Level 0 has one entry per cell (row by row,
+  // from minimum y); each entry of level k is the maximum over 2 x 2 entries of
+  // level k-1. The last level has a single entry.
+  std::vector<std::vector<float> >  m_max_levels;
+  std::vector<int>                  m_max_nx;     // number of entries in each direction, per level
+  std::vector<int>                  m_max_ny;
+
+  std::vector<Modifier>  m_modifiers;
+  std::vector<char>      m_tile_dirty;          // per tile, modified since the last rebuild
+  std::vector<int>       m_dirty_tiles;         // list of the dirty tiles
+  int                    m_num_updated_tiles;   // tiles rebuilt by the last modification
+};
+
+
+} // end namespace chrono
+
+
+#endif
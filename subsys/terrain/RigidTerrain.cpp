@@ -16,10 +16,15 @@
 //
 // =============================================================================
 
+#include <algorithm>
+#include <cmath>
+
 #include "physics/ChBodyEasy.h"
 #include "assets/ChColorAsset.h"
 #include "assets/ChTexture.h"
 
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChShapeCache.h"
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/terrain/RigidTerrain.h"
 
@@ -37,7 +42,17 @@ RigidTerrain::RigidTerrain(ChSystem*         system,
 : m_system(system),
   m_height(height),
   m_sizeX(sizeX),
-  m_sizeY(sizeY)
+  m_sizeY(sizeY),
+  m_use_heightfield(false),
+  m_hf_nx(0),
+  m_hf_ny(0),
+  m_heightfield(sizeX, sizeY),
+  m_use_sleeping(false),
+  m_sleep_speed(0),
+  m_sleep_time(0),
+  m_sleep_radius(0),
+  m_last_time(0),
+  m_num_sleeping(0)
 {
   double hDepth = 10;
 
@@ -52,54 +67,404 @@ RigidTerrain::RigidTerrain(ChSystem*         system,
   if(road_file == "none"){
     ChSharedPtr<ChColorAsset> groundColor(new ChColorAsset);
     groundColor->SetColor(ChColor(0.4f, 0.4f, 0.6f));
-    ground->AddAsset(groundColor);
+    vehicle::ChDeferredAssets::AddAsset(ground, groundColor);
   } else {
     ChSharedPtr<ChTexture> groundTexture(new ChTexture);
     groundTexture->SetTextureFilename(vehicle::GetDataFile(road_file));
-    ground->AddAsset(groundTexture);
+    vehicle::ChDeferredAssets::AddAsset(ground, groundTexture);
   }
 
   system->AddBody(ground);
+
+  m_ground = ground;
+
+  SetCoefficientFriction(mu);
+}
+
+// -----------------------------------------------------------------------------
+// In height field mode, the ground box only collides with bodies that do not
+// exclude HEIGHTFIELD_FAMILY (i.e. the moving obstacles).
+// -----------------------------------------------------------------------------
+void RigidTerrain::EnableHeightfield(double resolution)
+{
+  m_hf_nx = std::max(2, (int)std::ceil(m_sizeX / resolution) + 1);
+  m_hf_ny = std::max(2, (int)std::ceil(m_sizeY / resolution) + 1);
+  m_hf_nodes.assign((size_t)m_hf_nx * m_hf_ny, (float)m_height);
+
+  m_heightfield.SetHeights(m_hf_nx, m_hf_ny, m_hf_nodes);
+  m_use_heightfield = true;
+
+  m_ground->GetCollisionModel()->SetFamily(HEIGHTFIELD_FAMILY);
+}
+
+int RigidTerrain::AddHeightModifier(ChSharedPtr<ChHeightModifier> modifier,
+                                    double                        xmin,
+                                    double                        ymin,
+                                    double                        xmax,
+                                    double                        ymax)
+{
+  if (!m_use_heightfield) {
+    GetLog() << "ERROR: height modifiers require the height field (see EnableHeightfield)\n";
+    return -1;
+  }
+
+  return m_heightfield.AddModifier(modifier, xmin, ymin, xmax, ymax);
+}
+
+double RigidTerrain::GetHeight(double x, double y) const
+{
+  return m_use_heightfield ? m_heightfield.GetHeight(x, y) : m_height;
+}
+
+ChVector<> RigidTerrain::GetNormal(double x, double y) const
+{
+  return m_use_heightfield ? m_heightfield.GetNormal(x, y) : ChVector<>(0, 0, 1);
+}
+
+double RigidTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  return m_use_heightfield ? m_heightfield.GetMaxHeight(xmin, ymin, xmax, ymax) : m_height;
+}
+
+void RigidTerrain::GetHeightAndNormal(int           n,
+                                      const double* x,
+                                      const double* y,
+                                      double*       height,
+                                      ChVector<>*   normal) const
+{
+  if (m_use_heightfield) {
+    m_heightfield.GetHeightAndNormal(n, x, y, height, normal);
+    return;
+  }
+
+  for (int i = 0; i < n; i++)
+    height[i] = m_height;
+
+  if (!normal)
+    return;
+
+  for (int i = 0; i < n; i++)
+    normal[i] = ChVector<>(0, 0, 1);
 }
 
-void RigidTerrain::AddMovingObstacles(int numObstacles)
+// -----------------------------------------------------------------------------
+// Ray casts: the nearest of the ground and obstacle intersections. Without a
+// height field, the ground is the top face of the ground box.
+// -----------------------------------------------------------------------------
+bool RigidTerrain::CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const
+{
+  bool hit = false;
+
+  if (m_use_heightfield) {
+    hit = m_heightfield.CastRay(origin, dir, max_dist, dist);
+  } else {
+    double depth = origin.z - m_height;
+    double t = (depth <= 0) ? 0 : (dir.z < 0) ? -depth / dir.z : max_dist + 1;
+    ChVector<> p = origin + dir * t;
+    if (t <= max_dist && std::abs(p.x) <= m_sizeX / 2 && std::abs(p.y) <= m_sizeY / 2) {
+      dist = t;
+      hit = true;
+    }
+  }
+
+  double t;
+  if (m_obstacles.CastRay(origin, dir, hit ? dist : max_dist, t)) {
+    dist = t;
+    hit = true;
+  }
+
+  return hit;
+}
+
+// -----------------------------------------------------------------------------
+// The obstacles are drawn from a generator of their own (SplitMix64) rather
+// than ChRandom(), whose global state is shared by all simulations of the
+// process.
+// -----------------------------------------------------------------------------
+static unsigned long long SplitMix(unsigned long long& state)
+{
+  unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double Uniform(unsigned long long& state)
 {
+  return (SplitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void RigidTerrain::AddMovingObstacles(int numObstacles, unsigned int seed)
+{
+  unsigned long long state = seed;
+
   for (int i = 0; i < numObstacles; i++) {
-    double o_sizeX = 1.0 + 3.0 * ChRandom();
-    double o_sizeY = 0.3 + 0.2 * ChRandom();
-    double o_sizeZ = 0.05 + 0.1 * ChRandom();
+    double o_sizeX = 1.0 + 3.0 * Uniform(state);
+    double o_sizeY = 0.3 + 0.2 * Uniform(state);
+    double o_sizeZ = 0.05 + 0.1 * Uniform(state);
     ChSharedPtr<ChBodyEasyBox> obstacle(new ChBodyEasyBox(o_sizeX, o_sizeY, o_sizeZ, 2000.0, true, true));
     
-    double o_posX = (ChRandom() - 0.5)*0.6*m_sizeX;
-    double o_posY = (ChRandom() - 0.5)*0.6*m_sizeY;
+    double o_posX = (Uniform(state) - 0.5)*0.6*m_sizeX;
+    double o_posY = (Uniform(state) - 0.5)*0.6*m_sizeY;
     double o_posZ = m_height + 4;
-    ChQuaternion<> rot(ChRandom(), ChRandom(), ChRandom(), ChRandom());
+    double e0 = Uniform(state);
+    double e1 = Uniform(state);
+    double e2 = Uniform(state);
+    double e3 = Uniform(state);
+    ChQuaternion<> rot(e0, e1, e2, e3);
     rot.Normalize();
     obstacle->SetPos(ChVector<>(o_posX, o_posY, o_posZ));
     obstacle->SetRot(rot);
 
     m_system->AddBody(obstacle);
+
+    MovingObstacle moving;
+    moving.body = obstacle;
+    moving.radius = 0.5 * ChVector<>(o_sizeX, o_sizeY, o_sizeZ).Length();
+    moving.rest_time = 0;
+    moving.sleeping = false;
+    m_moving.push_back(moving);
   }
 }
 
+void RigidTerrain::AddMovingObstacles(const std::vector<ChSharedPtr<ChBody> >& obstacles, double radius)
+{
+  m_moving.reserve(m_moving.size() + obstacles.size());
+
+  for (size_t i = 0; i < obstacles.size(); i++) {
+    m_system->AddBody(obstacles[i]);
+
+    MovingObstacle moving;
+    moving.body = obstacles[i];
+    moving.radius = radius;
+    moving.rest_time = 0;
+    moving.sleeping = false;
+    m_moving.push_back(moving);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Sleeping of the moving obstacles. An obstacle is put to sleep at rest (its
+// velocities are cleared) and does not take part in the solver or in collision
+// detection until it is woken up by a proximity test. The speed of the points
+// of an obstacle is bounded by the speed of its center plus its angular speed
+// times its bounding sphere radius.
+// -----------------------------------------------------------------------------
+void RigidTerrain::EnableSleeping(double speed, double dwell_time, double radius)
+{
+  m_use_sleeping = true;
+  m_sleep_speed = speed;
+  m_sleep_time = dwell_time;
+  m_sleep_radius = radius;
+}
+
+void RigidTerrain::AddVehicle(ChSharedPtr<ChBody> body, const ChVector<>& center, const ChVector<>& half_dims)
+{
+  Vehicle vehicle;
+  vehicle.body = body;
+  vehicle.center = center;
+  vehicle.half_dims = half_dims;
+  m_vehicles.push_back(vehicle);
+}
+
+void RigidTerrain::set_sleeping(MovingObstacle& obstacle, bool sleeping)
+{
+  if (sleeping) {
+    obstacle.body->SetPos_dt(VNULL);
+    obstacle.body->SetWvel_loc(VNULL);
+  }
+  obstacle.body->SetSleeping(sleeping);
+  obstacle.body->SetCollide(!sleeping);
+  obstacle.sleeping = sleeping;
+  obstacle.rest_time = 0;
+  m_num_sleeping += sleeping ? 1 : -1;
+}
+
+bool RigidTerrain::is_near(int index) const
+{
+  const MovingObstacle& obstacle = m_moving[index];
+  const ChVector<>& pos = obstacle.body->GetPos();
+  double radius = obstacle.radius + m_sleep_radius;
+
+  // Distance to the vehicle bounding boxes.
+  for (size_t k = 0; k < m_vehicles.size(); k++) {
+    const Vehicle& vehicle = m_vehicles[k];
+    ChVector<> p = vehicle.body->GetFrame_REF_to_abs().TransformPointParentToLocal(pos) - vehicle.center;
+    ChVector<> d(std::max(std::abs(p.x) - vehicle.half_dims.x, 0.0),
+                 std::max(std::abs(p.y) - vehicle.half_dims.y, 0.0),
+                 std::max(std::abs(p.z) - vehicle.half_dims.z, 0.0));
+    if (d.Length2() < radius * radius)
+      return true;
+  }
+
+  // Distance to the awake obstacles.
+  for (int j = 0; j < (int)m_moving.size(); j++) {
+    if (j == index || m_moving[j].sleeping)
+      continue;
+    double dist = radius + m_moving[j].radius;
+    if ((m_moving[j].body->GetPos() - pos).Length2() < dist * dist)
+      return true;
+  }
+
+  return false;
+}
+
+void RigidTerrain::Update(double time)
+{
+  double dt = time - m_last_time;
+  m_last_time = time;
+
+  if (m_use_heightfield)
+    m_heightfield.Update(time);
+
+  if (!m_use_sleeping)
+    return;
+
+  for (int i = 0; i < (int)m_moving.size(); i++) {
+    MovingObstacle& obstacle = m_moving[i];
+
+    if (obstacle.sleeping) {
+      if (is_near(i))
+        set_sleeping(obstacle, false);
+      continue;
+    }
+
+    double speed = obstacle.body->GetPos_dt().Length() + obstacle.body->GetWvel_par().Length() * obstacle.radius;
+    obstacle.rest_time = (speed < m_sleep_speed) ? obstacle.rest_time + dt : 0;
+
+    if (obstacle.rest_time >= m_sleep_time && !is_near(i))
+      set_sleeping(obstacle, true);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// In height field mode, the fixed obstacles are visualization-only bodies and
+// their top surfaces are added to the height field.
+// -----------------------------------------------------------------------------
 void RigidTerrain::AddFixedObstacles()
 {
+  bool collide = !m_use_heightfield;
+
   double radius = 3;
   double length = 10;
-  ChSharedPtr<ChBodyEasyCylinder> obstacle(new ChBodyEasyCylinder(radius, length, 2000, true, true));
+  ChSharedPtr<ChBodyEasyCylinder> obstacle(new ChBodyEasyCylinder(radius, length, 2000, collide, true));
 
   obstacle->SetPos(ChVector<>(-20, 0, -2.7));
   obstacle->SetBodyFixed(true);
 
   m_system->AddBody(obstacle);
 
+  m_obstacles.AddCylinder(obstacle->GetPos(), obstacle->GetRot(), radius, length);
+  if (m_use_heightfield)
+    rasterize_cylinder(obstacle->GetPos(), obstacle->GetRot(), radius, length);
+
+  // the stone slabs share a single collision shape
   for (int i= 0; i< 8; ++i) {
-    ChSharedPtr<ChBodyEasyBox> stoneslab(new ChBodyEasyBox(0.5, 1.5, 0.2, 2000, true, true));
+    ChSharedPtr<ChBodyEasyBox> stoneslab(new ChBodyEasyBox(0.5, 1.5, 0.2, 2000, false, true));
     stoneslab->SetPos(ChVector<>(-1.2*i + 22, -1, -0.05));
     stoneslab->SetRot(Q_from_AngAxis(15 * CH_C_DEG_TO_RAD, VECT_Y));
     stoneslab->SetBodyFixed(true);
+    if (collide) {
+      ChShapeCache::SetBox(stoneslab.get_ptr(), ChVector<>(0.25, 0.75, 0.1));
+      stoneslab->SetCollide(true);
+    }
     m_system->AddBody(stoneslab);
+
+    m_obstacles.AddBox(stoneslab->GetPos(), stoneslab->GetRot(), ChVector<>(0.5, 1.5, 0.2));
+    if (m_use_heightfield)
+      rasterize_box(stoneslab->GetPos(), stoneslab->GetRot(), ChVector<>(0.5, 1.5, 0.2));
   }
+
+  m_obstacles.Build();
+
+  if (m_use_heightfield)
+    m_heightfield.SetHeights(m_hf_nx, m_hf_ny, m_hf_nodes);
+}
+
+// -----------------------------------------------------------------------------
+// Ray casts against the obstacle shapes, in the shape frame. Each returns the
+// ray parameter of the entry point, if the ray hits the shape.
+// -----------------------------------------------------------------------------
+struct RayBox {
+  ChVector<> half;
+
+  bool operator()(const ChVector<>& o, const ChVector<>& d, double& t) const
+  {
+    return ChObstacleBVH::IntersectBox(o, d, half, t);
+  }
+};
+
+struct RayCylinder {
+  double radius;
+  double half_length;
+
+  bool operator()(const ChVector<>& o, const ChVector<>& d, double& t) const
+  {
+    return ChObstacleBVH::IntersectCylinder(o, d, radius, half_length, t);
+  }
+};
+
+template <class SHAPE>
+void RigidTerrain::rasterize(const ChVector<>&     pos,
+                             const ChQuaternion<>& rot,
+                             double                bound,
+                             const SHAPE&          shape)
+{
+  double dx = m_sizeX / (m_hf_nx - 1);
+  double dy = m_sizeY / (m_hf_ny - 1);
+  double xmin = -m_sizeX / 2;
+  double ymax = m_sizeY / 2;
+
+  // Nodes within the bounding square of the shape (raster rows run from
+  // maximum to minimum y).
+  int i0 = std::max(0, (int)std::floor((pos.x - bound - xmin) / dx));
+  int i1 = std::min(m_hf_nx - 1, (int)std::ceil((pos.x + bound - xmin) / dx));
+  int r0 = std::max(0, (int)std::floor((ymax - pos.y - bound) / dy));
+  int r1 = std::min(m_hf_ny - 1, (int)std::ceil((ymax - pos.y + bound) / dy));
+
+  double ztop = pos.z + bound + 1;
+  ChVector<> dir = rot.RotateBack(ChVector<>(0, 0, -1));
+
+  for (int r = r0; r <= r1; r++) {
+    for (int i = i0; i <= i1; i++) {
+      ChVector<> origin = rot.RotateBack(ChVector<>(xmin + i * dx, ymax - r * dy, ztop) - pos);
+      double t;
+      if (!shape(origin, dir, t))
+        continue;
+      float& node = m_hf_nodes[(size_t)r * m_hf_nx + i];
+      node = std::max(node, (float)(ztop - t));
+    }
+  }
+}
+
+void RigidTerrain::rasterize_box(const ChVector<>& pos, const ChQuaternion<>& rot, const ChVector<>& size)
+{
+  RayBox box;
+  box.half = 0.5 * size;
+  rasterize(pos, rot, box.half.Length(), box);
+}
+
+void RigidTerrain::rasterize_cylinder(const ChVector<>& pos, const ChQuaternion<>& rot, double radius, double length)
+{
+  RayCylinder cyl;
+  cyl.radius = radius;
+  cyl.half_length = length / 2;
+  rasterize(pos, rot, std::sqrt(radius * radius + cyl.half_length * cyl.half_length), cyl);
+}
+
+// -----------------------------------------------------------------------------
+// The embedded height field adds its own object.
+// -----------------------------------------------------------------------------
+void RigidTerrain::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  report.Add("terrain/objects", sizeof(RigidTerrain) - sizeof(HeightmapTerrain));
+  report.Add("terrain/height fields", vehicle::ChMemoryReport::VectorBytes(m_hf_nodes));
+  report.Add("terrain/obstacles", m_obstacles.GetMemoryFootprint() + vehicle::ChMemoryReport::VectorBytes(m_moving) +
+                                  vehicle::ChMemoryReport::VectorBytes(m_vehicles));
+
+  m_heightfield.AddMemoryFootprint(report);
+
+  ChTerrain::AddMemoryFootprint(report);
 }
 
 
@@ -14,15 +14,33 @@
 //
 // Simple flat rigid terrain
 //
+// Optionally, the ground and the fixed obstacles are represented by a single
+// height field, used by tires that perform their own terrain contact (see
+// ChRigidTire::SetHeightfieldContact()). In this mode, the fixed obstacles are
+// rasterized into the height field and are visualization-only bodies, and the
+// ground collision box is placed in the collision family HEIGHTFIELD_FAMILY,
+// such that it only supports the moving obstacles; the moving obstacles remain
+// regular contact bodies.
+//
+// Optionally, the moving obstacles are put to sleep (see EnableSleeping())
+// once they have been at rest for a dwell time and are away from all vehicles;
+// a sleeping obstacle is excluded from the solver and from collision
+// detection. It is woken up when the bounding box of a vehicle (see
+// AddVehicle()), or an awake obstacle, comes within the proximity radius.
+//
 // =============================================================================
 
 #ifndef RIGIDTERRAIN_H
 #define RIGIDTERRAIN_H
 
+#include <vector>
+
 #include "physics/ChSystem.h"
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChTerrain.h"
+#include "subsys/terrain/HeightmapTerrain.h"
+#include "subsys/terrain/ChObstacleBVH.h"
 
 
 namespace chrono {
@@ -49,27 +67,155 @@ public:
 
   ~RigidTerrain() {}
 
+  /// Collision family of the ground box in height field mode.
+  static const int HEIGHTFIELD_FAMILY = 15;
+
+  /// Switch to the height field representation of the ground and the fixed
+  /// obstacles, with grid nodes at the specified spacing. Must be called
+  /// before AddFixedObstacles().
+  void EnableHeightfield(double resolution);
+
+  /// Return true if the terrain is represented by a height field.
+  bool IsHeightfield() const { return m_use_heightfield; }
+
   /// Get the terrain height at the specified (x,y) location.
-  /// Returns the constant value passed at construction.
-  virtual double GetHeight(double x, double y) const { return m_height; }
+  /// Returns the constant value passed at construction, or the height field
+  /// height in height field mode.
+  virtual double GetHeight(double x, double y) const;
 
   /// Get the terrain normal at the specified (x,y) location.
-  /// Returns a constant unit vector along the Z axis.
-  virtual chrono::ChVector<> GetNormal(double x, double y) const { return chrono::ChVector<>(0, 0, 1); }
+  /// Returns a constant unit vector along the Z axis, or the height field
+  /// normal in height field mode.
+  virtual chrono::ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get the maximum terrain height over the specified x-y rectangle.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Cast a ray against the ground (the top face of the ground box, or the
+  /// height field in height field mode) and the fixed obstacles, which are
+  /// kept in a bounding volume hierarchy. The moving obstacles are not hit.
+  virtual bool CastRay(const ChVector<>& origin, const ChVector<>& dir, double max_dist, double& dist) const;
+
+  /// Add the terrain object, its height field and its obstacle hierarchy to
+  /// the specified report. The ground and obstacle bodies belong to the system
+  /// and are reported with the vehicle (see ChVehicle::AddMemoryFootprint()).
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
 
   /// Add the specified number of rigid bodies, modeled as boxes of random size
-  /// and created at random locations above the terrain.
-  void AddMovingObstacles(int numObstacles);
+  /// and created at random locations above the terrain. The sizes and
+  /// locations only depend on the seed (e.g. from ChReplayLog::GetSeed()).
+  void AddMovingObstacles(
+    int          numObstacles,   ///< [in] number of obstacles
+    unsigned int seed = 1        ///< [in] seed of the random sizes and locations
+    );
+
+  /// Add the specified rigid bodies as moving obstacles, in one pass. The
+  /// bodies must be fully constructed (with their collision models built) and
+  /// placed by the caller, e.g. at non-overlapping locations generated with a
+  /// utils::ChPoissonDiskSampler with a minimum distance of twice the
+  /// bounding radius, so that they need no settling. Unlike the random boxes
+  /// above, such fields can be large.
+  void AddMovingObstacles(
+    const std::vector<ChSharedPtr<ChBody> >& obstacles,   ///< [in] obstacle bodies
+    double                                   radius       ///< [in] bounding sphere radius of the obstacles
+    );
 
   /// Add a few contact objects, rigidly attached to the terrain.
   void AddFixedObstacles();
 
+  /// Enable sleeping of the moving obstacles. An obstacle falls asleep when
+  /// the speeds of all its points stayed below the speed threshold during the
+  /// dwell time and no vehicle bounding box or awake obstacle is within the
+  /// proximity radius of its bounding sphere.
+  void EnableSleeping(
+    double speed,        ///< [in] speed threshold
+    double dwell_time,   ///< [in] time at rest before falling asleep
+    double radius        ///< [in] proximity radius
+    );
+
+  /// Register a vehicle for the proximity tests of the sleeping obstacles.
+  /// The vehicle bounding box is given by its center and half dimensions in
+  /// the reference frame of the specified body (typically the chassis).
+  void AddVehicle(
+    ChSharedPtr<ChBody> body,        ///< [in] body carrying the bounding box
+    const ChVector<>&   center,      ///< [in] box center, in the body frame
+    const ChVector<>&   half_dims    ///< [in] box half dimensions
+    );
+
+  /// Add a time-dependent modifier of the height field over the specified
+  /// x-y rectangle (see HeightmapTerrain::AddModifier()). The modifier only
+  /// changes the height field queries, not the ground collision geometry.
+  /// Returns -1 if the height field is not enabled.
+  int AddHeightModifier(
+    ChSharedPtr<ChHeightModifier>  modifier,   ///< [in] height modifier
+    double                         xmin,       ///< [in] minimum x of the region
+    double                         ymin,       ///< [in] minimum y of the region
+    double                         xmax,       ///< [in] maximum x of the region
+    double                         ymax        ///< [in] maximum y of the region
+    );
+
+  /// Update the height modifiers and the sleeping state of the moving
+  /// obstacles.
+  virtual void Update(double time);
+
+  /// Get the number of awake and sleeping moving obstacles.
+  int GetNumActiveObstacles() const { return (int)m_moving.size() - m_num_sleeping; }
+  int GetNumSleepingObstacles() const { return m_num_sleeping; }
+
 private:
 
+  struct MovingObstacle {
+    ChSharedPtr<ChBody>  body;
+    double               radius;       // bounding sphere radius
+    double               rest_time;    // time spent below the speed threshold
+    bool                 sleeping;
+  };
+
+  struct Vehicle {
+    ChSharedPtr<ChBody>  body;
+    ChVector<>           center;
+    ChVector<>           half_dims;
+  };
+
+  // Return true if the specified obstacle is within the proximity radius of
+  // a vehicle bounding box or of an awake obstacle.
+  bool is_near(int index) const;
+
+  void set_sleeping(MovingObstacle& obstacle, bool sleeping);
+
+  // Raise the height field nodes to the top of the specified box or cylinder
+  // (cylinder axis along the body Y axis), evaluated by vertical ray casts.
+  void rasterize_box(const ChVector<>& pos, const ChQuaternion<>& rot, const ChVector<>& size);
+  void rasterize_cylinder(const ChVector<>& pos, const ChQuaternion<>& rot, double radius, double length);
+  template <class SHAPE>
+  void rasterize(const ChVector<>& pos, const ChQuaternion<>& rot, double bound, const SHAPE& shape);
+
   ChSystem*  m_system;
   double     m_sizeX;
   double     m_sizeY;
   double     m_height;
+
+  ChSharedPtr<ChBody>  m_ground;
+
+  bool                 m_use_heightfield;
+  int                  m_hf_nx;         // number of height field nodes in each direction
+  int                  m_hf_ny;
+  std::vector<float>   m_hf_nodes;      // node heights (raster order, see HeightmapTerrain)
+  HeightmapTerrain     m_heightfield;
+
+  ChObstacleBVH        m_obstacles;     // fixed obstacles, for ray casts
+
+  std::vector<MovingObstacle>  m_moving;
+  std::vector<Vehicle>         m_vehicles;
+  bool                         m_use_sleeping;
+  double                       m_sleep_speed;
+  double                       m_sleep_time;
+  double                       m_sleep_radius;
+  double                       m_last_time;
+  int                          m_num_sleeping;
 };
 
 
@@ -0,0 +1,426 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Random road profile terrain, with the ISO 8608 roughness classes.
+//
+// =============================================================================
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <vector>
+
+#include "subsys/terrain/RoadProfileTerrain.h"
+#include "subsys/ChVehicleThreads.h"
+
+namespace chrono {
+
+// Spatial reference frequency of the ISO 8608 PSD (cycles/m).
+static const double s_n0 = 0.1;
+
+// Number of samples of a synthesis panel (two tile lengths).
+static const int s_panel_samples = 2 * RoadProfileTerrain::TILE_SAMPLES;
+
+
+// -----------------------------------------------------------------------------
+// Cached tiles, with TILE_SAMPLES + 1 samples of each track (the last sample
+// coincides with the first sample of the next tile).
+// -----------------------------------------------------------------------------
+struct RoadProfileTerrain::Tile {
+  std::vector<float>  left;
+  std::vector<float>  right;
+  float               max;
+};
+
+namespace {
+
+struct TileKey {
+  unsigned int  seed;
+  double        Gd0;
+  double        dx;
+  double        coherence;
+  int           index;
+
+  bool operator<(const TileKey& other) const
+  {
+    if (seed != other.seed) return seed < other.seed;
+    if (Gd0 != other.Gd0) return Gd0 < other.Gd0;
+    if (dx != other.dx) return dx < other.dx;
+    if (coherence != other.coherence) return coherence < other.coherence;
+    return index < other.index;
+  }
+};
+
+typedef std::map<TileKey, RoadProfileTerrain::Tile*> TileMap;
+
+vehicle::ChMutex  s_tiles_mutex;
+TileMap           s_tiles;
+int               s_num_generated = 0;
+
+}
+
+
+// -----------------------------------------------------------------------------
+// Random numbers (splitmix64), such that the phases of a panel depend only on
+// the seed, the panel index, and the track.
+// -----------------------------------------------------------------------------
+static unsigned long long SplitMix(unsigned long long& state)
+{
+  unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double Uniform(unsigned long long& state)
+{
+  return (SplitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int FloorDivide(int a, int b)
+{
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// -----------------------------------------------------------------------------
+// In-place radix-2 inverse FFT (without the 1/n scaling); n must be a power
+// of 2.
+// -----------------------------------------------------------------------------
+static void InverseFFT(std::vector<std::complex<double> >& a)
+{
+  int n = (int)a.size();
+
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(a[i], a[j]);
+  }
+
+  for (int len = 2; len <= n; len <<= 1) {
+    double ang = 2 * CH_C_PI / len;
+    std::complex<double> wlen(std::cos(ang), std::sin(ang));
+    for (int i = 0; i < n; i += len) {
+      std::complex<double> w(1, 0);
+      for (int j = 0; j < len / 2; j++) {
+        std::complex<double> u = a[i + j];
+        std::complex<double> v = a[i + j + len / 2] * w;
+        a[i + j] = u + v;
+        a[i + j + len / 2] = u - v;
+        w *= wlen;
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Synthesize the random-phase panel with the specified index and track, i.e.
+//   z(x) = sum_k A_k cos(2 pi n_k x + phi_k),  A_k = sqrt(2 Gd(n_k) dn)
+// over the panel length (the constant term is zero).
+// -----------------------------------------------------------------------------
+static void SynthesizePanel(unsigned int         seed,
+                            int                  panel,
+                            int                  track,
+                            double               Gd0,
+                            double               dx,
+                            std::vector<double>& z)
+{
+  int n = s_panel_samples;
+  double dn = 1 / (n * dx);
+
+  unsigned long long state = ((unsigned long long)seed << 32) ^ (unsigned int)panel;
+  state = SplitMix(state) ^ (unsigned long long)track;
+
+  std::vector<std::complex<double> > a(n, std::complex<double>(0, 0));
+  for (int k = 1; k < n / 2; k++) {
+    double nk = k * dn;
+    double Gd = Gd0 * (s_n0 * s_n0) / (nk * nk);
+    double amp = std::sqrt(2 * Gd * dn);
+    double phi = 2 * CH_C_PI * Uniform(state);
+    a[k] = std::polar(0.5 * amp, phi);
+    a[n - k] = std::conj(a[k]);
+  }
+
+  InverseFFT(a);
+
+  z.resize(n);
+  for (int i = 0; i < n; i++)
+    z[i] = a[i].real();
+}
+
+// -----------------------------------------------------------------------------
+// Profile of one track over the specified tile, cross-fading the second half
+// of the previous panel with the first half of the current panel.
+// -----------------------------------------------------------------------------
+static void SynthesizeTrack(unsigned int        seed,
+                            int                 tile,
+                            int                 track,
+                            double              Gd0,
+                            double              dx,
+                            std::vector<float>& z)
+{
+  int n = RoadProfileTerrain::TILE_SAMPLES;
+
+  std::vector<double> prev;
+  std::vector<double> curr;
+  SynthesizePanel(seed, tile - 1, track, Gd0, dx, prev);
+  SynthesizePanel(seed, tile, track, Gd0, dx, curr);
+
+  z.resize(n + 1);
+  for (int i = 0; i <= n; i++) {
+    double s = (0.5 * CH_C_PI * i) / n;
+    double zp = (i < n) ? prev[n + i] : curr[0];
+    z[i] = (float)(std::cos(s) * zp + std::sin(s) * curr[i]);
+  }
+}
+
+static RoadProfileTerrain::Tile* GenerateTile(const TileKey& key)
+{
+  RoadProfileTerrain::Tile* tile = new RoadProfileTerrain::Tile;
+
+  SynthesizeTrack(key.seed, key.index, 0, key.Gd0, key.dx, tile->left);
+
+  if (key.coherence >= 1) {
+    tile->right = tile->left;
+  }
+  else {
+    std::vector<float> indep;
+    SynthesizeTrack(key.seed, key.index, 1, key.Gd0, key.dx, indep);
+    double c = key.coherence;
+    double s = std::sqrt(1 - c * c);
+    tile->right.resize(indep.size());
+    for (size_t i = 0; i < indep.size(); i++)
+      tile->right[i] = (float)(c * tile->left[i] + s * indep[i]);
+  }
+
+  tile->max = tile->left[0];
+  for (size_t i = 0; i < tile->left.size(); i++) {
+    if (tile->left[i] > tile->max) tile->max = tile->left[i];
+    if (tile->right[i] > tile->max) tile->max = tile->right[i];
+  }
+
+  return tile;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+RoadProfileTerrain::RoadProfileTerrain(RoadClass     road_class,
+                                       unsigned int  seed,
+                                       double        track_width,
+                                       double        coherence,
+                                       double        sample_spacing,
+                                       double        height)
+: m_seed(seed),
+  m_track(track_width),
+  m_coherence(coherence),
+  m_dx(sample_spacing),
+  m_height(height)
+{
+  assert(track_width > 0);
+  assert(sample_spacing > 0);
+
+  m_Gd0 = 16e-6 * std::pow(4.0, (int)road_class);
+
+  if (m_coherence < 0) m_coherence = 0;
+  if (m_coherence > 1) m_coherence = 1;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const RoadProfileTerrain::Tile* RoadProfileTerrain::get_tile(int index) const
+{
+  TileKey key;
+  key.seed = m_seed;
+  key.Gd0 = m_Gd0;
+  key.dx = m_dx;
+  key.coherence = m_coherence;
+  key.index = index;
+
+  vehicle::ChScopedLock lock(s_tiles_mutex);
+
+  TileMap::iterator it = s_tiles.find(key);
+  if (it != s_tiles.end())
+    return it->second;
+
+  Tile* tile = GenerateTile(key);
+  s_tiles[key] = tile;
+  s_num_generated++;
+
+  return tile;
+}
+
+// -----------------------------------------------------------------------------
+// The tile and its index are passed in and out, such that consecutive queries
+// in the same tile need a single cache lookup.
+// -----------------------------------------------------------------------------
+void RoadProfileTerrain::eval_tracks(const Tile*& tile, int& index, double x,
+                                     double& zL, double& zR, double& sL, double& sR) const
+{
+  double u = x / m_dx;
+  double fu = std::floor(u);
+  int i = (int)fu;
+  double t = u - fu;
+
+  int ti = FloorDivide(i, TILE_SAMPLES);
+  if (!tile || ti != index) {
+    tile = get_tile(ti);
+    index = ti;
+  }
+
+  int j = i - ti * TILE_SAMPLES;
+
+  double dL = tile->left[j + 1] - tile->left[j];
+  double dR = tile->right[j + 1] - tile->right[j];
+
+  zL = tile->left[j] + t * dL;
+  zR = tile->right[j] + t * dR;
+  sL = dL / m_dx;
+  sR = dR / m_dx;
+}
+
+void RoadProfileTerrain::eval(const Tile*& tile, int& index, double x, double y, double& height, ChVector<>* normal) const
+{
+  double zL, zR, sL, sR;
+  eval_tracks(tile, index, x, zL, zR, sL, sR);
+
+  double eta = (y + 0.5 * m_track) / m_track;
+  double dzdy = (zL - zR) / m_track;
+  if (eta <= 0) { eta = 0; dzdy = 0; }
+  if (eta >= 1) { eta = 1; dzdy = 0; }
+
+  height = m_height + zR + eta * (zL - zR);
+
+  if (normal) {
+    double dzdx = sR + eta * (sL - sR);
+    ChVector<> n(-dzdx, -dzdy, 1);
+    *normal = n / n.Length();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double RoadProfileTerrain::GetHeight(double x, double y) const
+{
+  const Tile* tile = 0;
+  int index = 0;
+  double height;
+  eval(tile, index, x, y, height, 0);
+
+  return height;
+}
+
+ChVector<> RoadProfileTerrain::GetNormal(double x, double y) const
+{
+  const Tile* tile = 0;
+  int index = 0;
+  double height;
+  ChVector<> normal;
+  eval(tile, index, x, y, height, &normal);
+
+  return normal;
+}
+
+void RoadProfileTerrain::GetHeightAndNormal(int           n,
+                                            const double* x,
+                                            const double* y,
+                                            double*       height,
+                                            ChVector<>*   normal) const
+{
+  const Tile* tile = 0;
+  int index = 0;
+  for (int i = 0; i < n; i++)
+    eval(tile, index, x[i], y[i], height[i], normal ? &normal[i] : 0);
+}
+
+// -----------------------------------------------------------------------------
+// The height between the tracks is a convex combination of the track heights,
+// so the maximum of the samples of both tracks over the x range is an upper
+// bound. Tiles covered entirely use their precomputed maximum.
+// -----------------------------------------------------------------------------
+double RoadProfileTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  int i0 = (int)std::floor(xmin / m_dx);
+  int i1 = (int)std::floor(xmax / m_dx) + 1;
+
+  double max = -1e30;
+
+  int t0 = FloorDivide(i0, TILE_SAMPLES);
+  int t1 = FloorDivide(i1, TILE_SAMPLES);
+  for (int ti = t0; ti <= t1; ti++) {
+    const Tile* tile = get_tile(ti);
+    int j0 = (ti == t0) ? i0 - ti * TILE_SAMPLES : 0;
+    int j1 = (ti == t1) ? i1 - ti * TILE_SAMPLES : TILE_SAMPLES;
+    if (j0 == 0 && j1 == TILE_SAMPLES) {
+      if (tile->max > max) max = tile->max;
+      continue;
+    }
+    for (int j = j0; j <= j1; j++) {
+      if (tile->left[j] > max) max = tile->left[j];
+      if (tile->right[j] > max) max = tile->right[j];
+    }
+  }
+
+  return m_height + max;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void RoadProfileTerrain::ClearCache()
+{
+  vehicle::ChScopedLock lock(s_tiles_mutex);
+
+  for (TileMap::iterator it = s_tiles.begin(); it != s_tiles.end(); ++it)
+    delete it->second;
+
+  s_tiles.clear();
+}
+
+int RoadProfileTerrain::GetNumCachedTiles()
+{
+  vehicle::ChScopedLock lock(s_tiles_mutex);
+  return (int)s_tiles.size();
+}
+
+int RoadProfileTerrain::GetNumGeneratedTiles()
+{
+  vehicle::ChScopedLock lock(s_tiles_mutex);
+  return s_num_generated;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void RoadProfileTerrain::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  report.Add("terrain/objects", sizeof(RoadProfileTerrain));
+
+  {
+    vehicle::ChScopedLock lock(s_tiles_mutex);
+
+    for (TileMap::const_iterator it = s_tiles.begin(); it != s_tiles.end(); ++it) {
+      const Tile* tile = it->second;
+      report.AddShared("shared/road profile tiles", tile,
+                       sizeof(Tile) + vehicle::ChMemoryReport::VectorBytes(tile->left) +
+                       vehicle::ChMemoryReport::VectorBytes(tile->right));
+    }
+  }
+
+  ChTerrain::AddMemoryFootprint(report);
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,133 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Random road profile terrain, with the ISO 8608 roughness classes.
+//
+// The road runs along the global X axis. Its profile is defined along two
+// wheel tracks, at y = +track_width/2 (left) and y = -track_width/2 (right),
+// and interpolated linearly between the tracks (constant outside them). Each
+// track profile is a random process with the ISO 8608 displacement PSD
+//   Gd(n) = Gd(n0) * (n / n0)^(-2),  n0 = 0.1 cycles/m
+// with Gd(n0) the geometric mean of the selected class (16e-6 m^3 for class A,
+// four times larger for each subsequent class). The right track is a mix of
+// the left track and an independent profile, with the specified coherence (0:
+// independent tracks, 1: identical tracks).
+//
+// The profile is generated lazily, in tiles of TILE_SAMPLES samples. A tile is
+// obtained from two independent random-phase panels, each synthesized with an
+// inverse FFT over two tile lengths and seeded from the road seed and the panel
+// index; consecutive panels overlap by one tile and are cross-faded with
+// power-preserving weights, so that the profile is continuous and stationary.
+// Tiles are therefore independent of the order in which they are requested.
+//
+// Generated tiles are kept in a process-wide cache, keyed by all the profile
+// parameters, such that all terrains with the same parameters (e.g. parallel
+// runs with the same seed) share them. The cache is thread-safe; tiles are
+// released only by ClearCache().
+//
+// =============================================================================
+
+#ifndef ROADPROFILETERRAIN_H
+#define ROADPROFILETERRAIN_H
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+
+namespace chrono {
+
+///
+/// Concrete class for a random road profile terrain.
+///
+class CH_SUBSYS_API RoadProfileTerrain : public ChTerrain
+{
+public:
+
+  /// ISO 8608 road roughness classes.
+  enum RoadClass {
+    CLASS_A, CLASS_B, CLASS_C, CLASS_D, CLASS_E, CLASS_F, CLASS_G, CLASS_H
+  };
+
+  /// Number of profile samples per tile.
+  static const int TILE_SAMPLES = 1024;
+
+  RoadProfileTerrain(
+    RoadClass     road_class,             ///< [in] ISO 8608 roughness class
+    unsigned int  seed,                   ///< [in] seed of the random profile
+    double        track_width = 2,        ///< [in] distance between the left and right tracks
+    double        coherence = 0,          ///< [in] coherence of the left and right tracks (in [0,1])
+    double        sample_spacing = 0.05,  ///< [in] distance between profile samples
+    double        height = 0              ///< [in] mean height of the road
+    );
+
+  ~RoadProfileTerrain() {}
+
+  /// Get the terrain height at the specified (x,y) location.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get the maximum height of the profile samples over the specified x-y
+  /// rectangle.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Add the terrain object and the cached tiles to the specified report. The
+  /// tiles are shared by all road profiles, and reported as shared objects.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Get the displacement PSD at the reference spatial frequency, Gd(n0).
+  double GetRoughness() const { return m_Gd0; }
+
+  /// Get the length of one tile.
+  double GetTileLength() const { return TILE_SAMPLES * m_dx; }
+
+  /// Release all cached tiles. No terrain may be in use (by any thread) when
+  /// this function is called.
+  static void ClearCache();
+
+  /// Return the number of cached tiles.
+  static int GetNumCachedTiles();
+
+  /// Return the number of tiles generated so far.
+  static int GetNumGeneratedTiles();
+
+  struct Tile;
+
+private:
+
+  // Get the tile with the specified index (generated if not cached).
+  const Tile* get_tile(int index) const;
+
+  // Evaluate the left and right track heights and their slopes at x.
+  void eval_tracks(const Tile*& tile, int& index, double x,
+                   double& zL, double& zR, double& sL, double& sR) const;
+
+  void eval(const Tile*& tile, int& index, double x, double y, double& height, ChVector<>* normal) const;
+
+  double        m_Gd0;           // ISO 8608 roughness, Gd(n0)
+  unsigned int  m_seed;
+  double        m_track;         // track width
+  double        m_coherence;
+  double        m_dx;            // sample spacing
+  double        m_height;        // mean height
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,362 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Deformable soil terrain (Soil Contact Model style).
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/ChMathematics.h"
+
+#include "subsys/terrain/SoilTerrain.h"
+
+
+namespace chrono {
+
+static const int INITIAL_TABLE_SIZE = 1024;   // must be a power of 2
+
+
+// -----------------------------------------------------------------------------
+// Grid and block indices.
+// -----------------------------------------------------------------------------
+static inline int FloorDiv(int i, int n)
+{
+  return (i >= 0) ? i / n : -((-i - 1) / n) - 1;
+}
+
+static inline long long BlockKey(int bi, int bj)
+{
+  return ((long long)bi << 32) | (unsigned int)bj;
+}
+
+static inline size_t BlockHash(long long key, size_t mask)
+{
+  unsigned long long h = (unsigned long long)key * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h >> 32) & mask;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+SoilTerrain::SoilTerrain(double height,
+                         double node_size)
+: m_base(0),
+  m_height(height),
+  m_node_size(node_size),
+  m_time(0)
+{
+  init_table();
+  SetSoilParameters(2e6, 0, 1.1, 0, 30, 0.01, 2e8, 3e4);
+}
+
+SoilTerrain::SoilTerrain(const ChTerrain& base,
+                         double           node_size)
+: m_base(&base),
+  m_height(0),
+  m_node_size(node_size),
+  m_time(0)
+{
+  init_table();
+  SetSoilParameters(2e6, 0, 1.1, 0, 30, 0.01, 2e8, 3e4);
+}
+
+SoilTerrain::~SoilTerrain()
+{
+  for (size_t k = 0; k < m_blocks.size(); k++)
+    delete m_blocks[k];
+}
+
+void SoilTerrain::init_table()
+{
+  m_keys.assign(INITIAL_TABLE_SIZE, 0);
+  m_blocks.assign(INITIAL_TABLE_SIZE, (Block*)0);
+  m_num_blocks = 0;
+}
+
+void SoilTerrain::SetSoilParameters(double Bekker_Kphi,
+                                    double Bekker_Kc,
+                                    double Bekker_n,
+                                    double Mohr_cohesion,
+                                    double Mohr_friction,
+                                    double Janosi_shear,
+                                    double elastic_K,
+                                    double damping_R)
+{
+  m_Kphi = Bekker_Kphi;
+  m_Kc = Bekker_Kc;
+  m_n = Bekker_n;
+  m_cohesion = Mohr_cohesion;
+  m_tan_friction = std::tan(Mohr_friction * CH_C_DEG_TO_RAD);
+  m_janosi = Janosi_shear;
+  m_elastic_K = std::max(elastic_K, Bekker_Kphi);
+  m_damping_R = damping_R;
+}
+
+// -----------------------------------------------------------------------------
+// Block hash table (open addressing, linear probing).
+// -----------------------------------------------------------------------------
+SoilTerrain::Block* SoilTerrain::find_block(int bi, int bj) const
+{
+  long long key = BlockKey(bi, bj);
+  size_t mask = m_blocks.size() - 1;
+
+  for (size_t k = BlockHash(key, mask); m_blocks[k]; k = (k + 1) & mask) {
+    if (m_keys[k] == key)
+      return m_blocks[k];
+  }
+
+  return 0;
+}
+
+SoilTerrain::Block* SoilTerrain::get_block(int bi, int bj, bool create)
+{
+  vehicle::ChScopedLock lock(m_table_mutex);
+
+  Block* block = find_block(bi, bj);
+  if (block || !create)
+    return block;
+
+  // Keep the load factor below 1/2.
+  if (2 * (m_num_blocks + 1) > (int)m_blocks.size()) {
+    std::vector<long long> keys(2 * m_keys.size(), 0);
+    std::vector<Block*> blocks(2 * m_blocks.size(), (Block*)0);
+    size_t mask = blocks.size() - 1;
+    for (size_t k = 0; k < m_blocks.size(); k++) {
+      if (!m_blocks[k])
+        continue;
+      size_t slot = BlockHash(m_keys[k], mask);
+      while (blocks[slot])
+        slot = (slot + 1) & mask;
+      keys[slot] = m_keys[k];
+      blocks[slot] = m_blocks[k];
+    }
+    m_keys.swap(keys);
+    m_blocks.swap(blocks);
+  }
+
+  block = new Block;
+  for (int k = 0; k < BLOCK_SIZE * BLOCK_SIZE; k++)
+    block->nodes[k].init = false;
+
+  long long key = BlockKey(bi, bj);
+  size_t mask = m_blocks.size() - 1;
+  size_t slot = BlockHash(key, mask);
+  while (m_blocks[slot])
+    slot = (slot + 1) & mask;
+  m_keys[slot] = key;
+  m_blocks[slot] = block;
+  m_num_blocks++;
+
+  return block;
+}
+
+double SoilTerrain::node_sinkage(int i, int j) const
+{
+  int bi = FloorDiv(i, BLOCK_SIZE);
+  int bj = FloorDiv(j, BLOCK_SIZE);
+  const Block* block = find_block(bi, bj);
+  if (!block)
+    return 0;
+
+  const Node& node = block->nodes[(j - bj * BLOCK_SIZE) * BLOCK_SIZE + (i - bi * BLOCK_SIZE)];
+
+  return node.init ? node.sinkage : 0;
+}
+
+double SoilTerrain::base_height(double x, double y) const
+{
+  return m_base ? m_base->GetHeight(x, y) : m_height;
+}
+
+// -----------------------------------------------------------------------------
+// Height and normal queries.
+// -----------------------------------------------------------------------------
+double SoilTerrain::GetHeight(double x, double y) const
+{
+  double u = x / m_node_size;
+  double v = y / m_node_size;
+  int i = (int)std::floor(u);
+  int j = (int)std::floor(v);
+  double tx = u - i;
+  double ty = v - j;
+
+  double s0 = node_sinkage(i, j) + tx * (node_sinkage(i + 1, j) - node_sinkage(i, j));
+  double s1 = node_sinkage(i, j + 1) + tx * (node_sinkage(i + 1, j + 1) - node_sinkage(i, j + 1));
+
+  return base_height(x, y) - (s0 + ty * (s1 - s0));
+}
+
+ChVector<> SoilTerrain::GetNormal(double x, double y) const
+{
+  double h = m_node_size;
+  double dzdx = (GetHeight(x + h, y) - GetHeight(x - h, y)) / (2 * h);
+  double dzdy = (GetHeight(x, y + h) - GetHeight(x, y - h)) / (2 * h);
+
+  ChVector<> normal(-dzdx, -dzdy, 1);
+  normal.Normalize();
+
+  return normal;
+}
+
+double SoilTerrain::GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const
+{
+  return m_base ? m_base->GetMaxHeight(xmin, ymin, xmax, ymax) : m_height;
+}
+
+// -----------------------------------------------------------------------------
+// Wheel-soil forces. The wheel is a cylinder with (nearly) horizontal axis; a
+// node is in contact if it lies within the wheel width and the bottom of the
+// cylinder at the node location is below the soil surface. Each node in
+// contact carries the area of one grid cell. The blocks in the footprint are
+// processed one at a time, with the block mutex locked; a block is only
+// allocated when one of its nodes is in contact.
+// -----------------------------------------------------------------------------
+ChTireForce SoilTerrain::ComputePatchForce(const ChWheelState& wheel_state,
+                                           double              radius,
+                                           double              width,
+                                           double              step)
+{
+  ChTireForce tire_force;
+  tire_force.force = ChVector<>(0, 0, 0);
+  tire_force.moment = ChVector<>(0, 0, 0);
+  tire_force.point = wheel_state.pos;
+
+  const ChVector<>& center = wheel_state.pos;
+
+  // Horizontal longitudinal and lateral directions of the wheel.
+  ChVector<> Z_dir(0, 0, 1);
+  ChVector<> lon = Vcross(wheel_state.rot.GetYaxis(), Z_dir);
+  if (lon.Length2() < 1e-6)
+    return tire_force;
+  lon.Normalize();
+  ChVector<> lat = Vcross(Z_dir, lon);
+
+  // Footprint bounding box. No contact if the wheel is above the terrain.
+  double half_width = width / 2;
+  double ex = std::abs(lon.x) * radius + std::abs(lat.x) * half_width;
+  double ey = std::abs(lon.y) * radius + std::abs(lat.y) * half_width;
+
+  if (center.z - radius > GetMaxHeight(center.x - ex, center.y - ey, center.x + ex, center.y + ey))
+    return tire_force;
+
+  double h = m_node_size;
+  int i0 = (int)std::ceil((center.x - ex) / h);
+  int i1 = (int)std::floor((center.x + ex) / h);
+  int j0 = (int)std::ceil((center.y - ey) / h);
+  int j1 = (int)std::floor((center.y + ey) / h);
+
+  double area = h * h;
+  double bekker_k = m_Kc / width + m_Kphi;
+
+  for (int bj = FloorDiv(j0, BLOCK_SIZE); bj <= FloorDiv(j1, BLOCK_SIZE); bj++) {
+    for (int bi = FloorDiv(i0, BLOCK_SIZE); bi <= FloorDiv(i1, BLOCK_SIZE); bi++) {
+      Block* block = get_block(bi, bj, false);
+      if (block)
+        block->mutex.Lock();
+
+      int ni0 = std::max(i0, bi * BLOCK_SIZE);
+      int ni1 = std::min(i1, bi * BLOCK_SIZE + BLOCK_SIZE - 1);
+      int nj0 = std::max(j0, bj * BLOCK_SIZE);
+      int nj1 = std::min(j1, bj * BLOCK_SIZE + BLOCK_SIZE - 1);
+
+      for (int j = nj0; j <= nj1; j++) {
+        for (int i = ni0; i <= ni1; i++) {
+          double x = i * h;
+          double y = j * h;
+          ChVector<> d(x - center.x, y - center.y, 0);
+          double s = Vdot(d, lon);
+          double l = Vdot(d, lat);
+          if (std::abs(l) > half_width || std::abs(s) >= radius)
+            continue;
+
+          // Bottom of the wheel at the node location.
+          double zc = center.z - std::sqrt(radius * radius - s * s);
+
+          int k = (j - bj * BLOCK_SIZE) * BLOCK_SIZE + (i - bi * BLOCK_SIZE);
+          Node* node = block ? &block->nodes[k] : 0;
+
+          if (!node || !node->init) {
+            if (zc >= base_height(x, y))
+              continue;
+            if (!block) {
+              block = get_block(bi, bj, true);
+              block->mutex.Lock();
+              node = &block->nodes[k];
+            }
+            if (!node->init) {
+              node->init = true;
+              node->base = (float)base_height(x, y);
+              node->sinkage = 0;
+              node->shear = 0;
+              node->time = m_time;
+            }
+          }
+
+          // Total sinkage required by the wheel; no contact if the wheel is
+          // above the (plastic) soil surface.
+          double sinkage = node->base - zc;
+          if (sinkage <= node->sinkage)
+            continue;
+
+          // Elastic loading up to the Bekker limit, then plastic flow.
+          double sigma = m_elastic_K * (sinkage - node->sinkage);
+          double sigma_bekker = bekker_k * std::pow(sinkage, m_n);
+          if (sigma > sigma_bekker) {
+            sigma = sigma_bekker;
+            node->sinkage = (float)(sinkage - sigma / m_elastic_K);
+          }
+
+          // Contact point and normal (towards the wheel axis), velocity of the
+          // wheel at the contact point.
+          ChVector<> q(x, y, zc);
+          ChVector<> axis_pt = center + l * lat;
+          ChVector<> normal = (axis_pt - q) / radius;
+          ChVector<> vel = wheel_state.lin_vel + Vcross(wheel_state.ang_vel, q - center);
+          double vn = Vdot(vel, normal);
+
+          sigma -= m_damping_R * vn;
+          if (sigma <= 0)
+            continue;
+
+          // Shear displacement, reset if the node was out of contact.
+          ChVector<> vt = vel - vn * normal;
+          double vt_len = vt.Length();
+          if (m_time - node->time > 1.5 * step)
+            node->shear = 0;
+          node->shear += (float)(vt_len * step);
+          node->time = m_time;
+
+          double tau = (m_cohesion + sigma * m_tan_friction) * (1 - std::exp(-node->shear / m_janosi));
+
+          ChVector<> F = (sigma * area) * normal;
+          if (vt_len > 1e-9)
+            F -= (tau * area / vt_len) * vt;
+
+          tire_force.force += F;
+          tire_force.moment += Vcross(q - center, F);
+        }
+      }
+
+      if (block)
+        block->mutex.Unlock();
+    }
+  }
+
+  return tire_force;
+}
+
+
+} // end namespace chrono
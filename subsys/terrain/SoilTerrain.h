@@ -0,0 +1,184 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Deformable soil terrain (Soil Contact Model style).
+//
+// The soil surface is represented by the nodes of a regular grid in the x-y
+// plane, displaced vertically from a base surface (a constant height or another
+// terrain) by their plastic sinkage. The normal pressure at a node in contact
+// is elastic-plastic, bounded by the Bekker pressure-sinkage law; the shear
+// stress follows the Mohr-Coulomb limit with the Janosi-Hanamoto shear
+// displacement law.
+//
+// The node states are stored sparsely: the grid is divided in square blocks of
+// BLOCK_SIZE x BLOCK_SIZE nodes, which are allocated the first time a wheel
+// contacts any of their nodes and are found through an open-addressing hash
+// table. Outside the allocated blocks, the terrain is the base surface.
+//
+// A node in contact is loaded elastically from its plastic sinkage, with
+// stiffness elastic_K, until the pressure reaches the Bekker limit; the plastic
+// sinkage then grows such that the pressure stays on the Bekker curve. After
+// the wheel has passed, the surface recovers the elastic part of the sinkage.
+// The shear displacement of a node is accumulated while it stays in contact.
+//
+// Each block has its own mutex, so ComputePatchForce() may be called
+// concurrently for different wheels (of the same or different vehicles); only
+// the lookup of a block in the hash table is serialized. The height and normal
+// queries do not lock and must not be called concurrently with
+// ComputePatchForce().
+//
+// =============================================================================
+
+#ifndef SOILTERRAIN_H
+#define SOILTERRAIN_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChVehicleThreads.h"
+
+namespace chrono {
+
+///
+/// Concrete class for a deformable soil terrain.
+/// The wheel-soil forces are calculated by the terrain itself (see
+/// ComputePatchForce()), which also updates the soil deformation.
+///
+class CH_SUBSYS_API SoilTerrain : public ChTerrain
+{
+public:
+
+  /// Number of grid nodes along each side of a storage block.
+  static const int BLOCK_SIZE = 16;
+
+  /// Construct a soil terrain over a flat base surface at the specified height.
+  SoilTerrain(
+    double height,      ///< [in] height of the undeformed soil surface
+    double node_size    ///< [in] spacing of the grid nodes
+    );
+
+  /// Construct a soil terrain over the specified base terrain, which must
+  /// outlive this object.
+  SoilTerrain(
+    const ChTerrain& base,      ///< [in] undeformed soil surface
+    double           node_size  ///< [in] spacing of the grid nodes
+    );
+
+  ~SoilTerrain();
+
+  /// Set the soil parameters.
+  void SetSoilParameters(
+    double Bekker_Kphi,    ///< [in] frictional modulus of the Bekker model
+    double Bekker_Kc,      ///< [in] cohesive modulus of the Bekker model
+    double Bekker_n,       ///< [in] exponent of the Bekker model (usually 0.6 ... 1.8)
+    double Mohr_cohesion,  ///< [in] cohesion, for the shear failure limit [Pa]
+    double Mohr_friction,  ///< [in] friction angle, for the shear failure limit [deg]
+    double Janosi_shear,   ///< [in] shear deformation modulus [m]
+    double elastic_K,      ///< [in] elastic stiffness while unloading [Pa/m] (at least Kphi)
+    double damping_R       ///< [in] damping of the vertical deformation [Pa s/m]
+    );
+
+  /// Set the current time (used to detect nodes leaving the contact, which
+  /// resets their shear displacement).
+  virtual void Update(double time) { m_time = time; }
+
+  /// Get the height of the deformed soil surface at the specified location.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the normal of the deformed soil surface at the specified location
+  /// (from central differences of the heights over one node spacing).
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get an upper bound of the terrain height over the specified rectangle;
+  /// the soil deformation only lowers the base surface.
+  virtual double GetMaxHeight(double xmin, double ymin, double xmax, double ymax) const;
+
+  /// Calculate the soil reaction on a rigid cylindrical wheel over the
+  /// specified step and update the soil deformation under the wheel.
+  /// The wheel is assumed to have a small camber; the returned force and
+  /// moment are reduced to the wheel center.
+  ChTireForce ComputePatchForce(
+    const ChWheelState& wheel_state,   ///< [in] current state of the wheel body
+    double              radius,        ///< [in] wheel radius
+    double              width,         ///< [in] wheel width
+    double              step           ///< [in] step size
+    );
+
+  /// Get the number of allocated storage blocks.
+  int GetNumBlocks() const { return m_num_blocks; }
+
+  /// Get the spacing of the grid nodes.
+  double GetNodeSize() const { return m_node_size; }
+
+private:
+
+  // State of a grid node.
+  struct Node {
+    bool    init;        // true once the base height was evaluated
+    float   base;        // height of the base surface
+    float   sinkage;     // plastic sinkage (below the base surface)
+    float   shear;       // accumulated shear displacement
+    double  time;        // time of the last contact
+  };
+
+  // Storage block of BLOCK_SIZE x BLOCK_SIZE nodes.
+  struct Block {
+    vehicle::ChMutex  mutex;
+    Node              nodes[BLOCK_SIZE * BLOCK_SIZE];
+  };
+
+  SoilTerrain(const SoilTerrain&);
+  SoilTerrain& operator=(const SoilTerrain&);
+
+  void init_table();
+
+  // Hash table lookup; returns NULL if the block is not allocated.
+  Block* find_block(int bi, int bj) const;
+
+  // Find (and optionally allocate) a block, with m_table_mutex locked.
+  Block* get_block(int bi, int bj, bool create);
+
+  // Plastic sinkage of the node at the specified grid location (0 if the node
+  // is not allocated).
+  double node_sinkage(int i, int j) const;
+
+  double base_height(double x, double y) const;
+
+  const ChTerrain*           m_base;
+  double                     m_height;
+  double                     m_node_size;
+  double                     m_time;
+
+  double                     m_Kphi;
+  double                     m_Kc;
+  double                     m_n;
+  double                     m_cohesion;
+  double                     m_tan_friction;
+  double                     m_janosi;
+  double                     m_elastic_K;
+  double                     m_damping_R;
+
+  std::vector<long long>     m_keys;        // block keys (open addressing)
+  std::vector<Block*>        m_blocks;      // allocated blocks (NULL if the slot is empty)
+  int                        m_num_blocks;
+  vehicle::ChMutex           m_table_mutex;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,564 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Height-map terrain streamed from a memory-mapped tiled terrain file.
+//
+// File layout (native byte order):
+//   header, padded to FILE_PAGE bytes:
+//     char[8] magic, int nx, ny, tile_cells, ntx, nty, mip_stride, mip_nx,
+//     mip_ny, double sizeX, sizeY, uint64 tile_offset, tile_bytes, mip_offset
+//   ntx * nty tiles, each with (tile_cells+1)^2 heights stored by rows of
+//     increasing y, padded to a multiple of FILE_PAGE bytes
+//   mip_nx * mip_ny heights of the coarse level, by rows of increasing y
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/terrain/StreamingTerrain.h"
+
+
+namespace chrono {
+
+static const char   FILE_MAGIC[8] = { 'C', 'H', 'T', 'E', 'R', 'R', '1', 0 };
+static const size_t FILE_PAGE = 4096;
+static const size_t HEADER_BYTES = 8 + 8 * sizeof(int) + 2 * sizeof(double) + 3 * sizeof(unsigned long long);
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+StreamingTerrain::StreamingTerrain()
+: m_data(0),
+  m_size(0),
+  m_nx(0),
+  m_ny(0),
+  m_tile_cells(0),
+  m_ntx(0),
+  m_nty(0),
+  m_tile_offset(0),
+  m_tile_bytes(0),
+  m_xmin(0),
+  m_ymin(0),
+  m_dx(1),
+  m_dy(1),
+  m_mip_stride(1),
+  m_mip_nx(0),
+  m_mip_ny(0),
+  m_slot_floats(0),
+  m_frame(0),
+  m_num_resident(0),
+  m_num_fallback(0),
+  m_radius(50),
+  m_lookahead(150),
+  m_loader(this),
+  m_stop(false)
+{
+}
+
+StreamingTerrain::~StreamingTerrain()
+{
+  Close();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool StreamingTerrain::Open(const std::string& filename,
+                            int                cache_tiles)
+{
+  Close();
+
+  if (!m_file.Open(filename)) {
+    GetLog() << "ERROR: cannot map terrain file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  const char* data = m_file.GetData();
+
+  int ints[8];
+  double sizes[2];
+  unsigned long long offsets[3];
+
+  if (m_file.GetSize() < HEADER_BYTES || std::memcmp(data, FILE_MAGIC, 8) != 0) {
+    GetLog() << "ERROR: " << filename.c_str() << " is not a tiled terrain file\n";
+    m_file.Close();
+    return false;
+  }
+
+  std::memcpy(ints, data + 8, sizeof(ints));
+  std::memcpy(sizes, data + 8 + sizeof(ints), sizeof(sizes));
+  std::memcpy(offsets, data + 8 + sizeof(ints) + sizeof(sizes), sizeof(offsets));
+
+  m_nx = ints[0];
+  m_ny = ints[1];
+  m_tile_cells = ints[2];
+  m_ntx = ints[3];
+  m_nty = ints[4];
+  m_mip_stride = ints[5];
+  m_mip_nx = ints[6];
+  m_mip_ny = ints[7];
+  m_tile_offset = (size_t)offsets[0];
+  m_tile_bytes = (size_t)offsets[1];
+
+  size_t mip_offset = (size_t)offsets[2];
+  size_t mip_bytes = (size_t)m_mip_nx * m_mip_ny * sizeof(float);
+  m_slot_floats = (m_tile_cells + 1) * (m_tile_cells + 1);
+
+  if (m_nx < 2 || m_ny < 2 || m_tile_cells < 1 || m_mip_nx < 2 || m_mip_ny < 2 ||
+      m_tile_bytes < m_slot_floats * sizeof(float) ||
+      m_tile_offset + (size_t)m_ntx * m_nty * m_tile_bytes > m_file.GetSize() ||
+      mip_offset + mip_bytes > m_file.GetSize()) {
+    GetLog() << "ERROR: corrupt tiled terrain file " << filename.c_str() << "\n";
+    m_file.Close();
+    return false;
+  }
+
+  m_data = data;
+  m_size = m_file.GetSize();
+
+  m_xmin = -sizes[0] / 2;
+  m_ymin = -sizes[1] / 2;
+  m_dx = sizes[0] / (m_nx - 1);
+  m_dy = sizes[1] / (m_ny - 1);
+
+  // Load the coarse level; it stays resident.
+  m_mip.resize((size_t)m_mip_nx * m_mip_ny);
+  std::memcpy(&m_mip[0], data + mip_offset, mip_bytes);
+  m_file.ReleasePages(mip_offset, mip_bytes);
+
+  // Allocate the tile cache.
+  if (cache_tiles < 1)
+    cache_tiles = 1;
+
+  m_tile_slot.assign((size_t)m_ntx * m_nty, -1);
+  m_tile_pending.assign((size_t)m_ntx * m_nty, -1);
+  m_slot_tile.assign(cache_tiles, -1);
+  m_slot_stamp.assign(cache_tiles, 0);
+  m_slot_data.assign((size_t)cache_tiles * m_slot_floats, 0.0f);
+  m_frame = 0;
+  m_num_resident = 0;
+  m_num_fallback = 0;
+
+  m_stop = false;
+  if (!m_loader.Start()) {
+    GetLog() << "ERROR: cannot start the terrain loader thread\n";
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void StreamingTerrain::Close()
+{
+  if (m_loader.IsRunning()) {
+    m_mutex.Lock();
+    m_stop = true;
+    m_cond.Broadcast();
+    m_mutex.Unlock();
+    m_loader.Join();
+  }
+
+  m_requests.clear();
+  m_completed.clear();
+
+  m_file.Close();
+  m_data = 0;
+  m_size = 0;
+
+  m_mip.clear();
+  m_tile_slot.clear();
+  m_tile_pending.clear();
+  m_slot_tile.clear();
+  m_slot_stamp.clear();
+  m_slot_data.clear();
+  m_num_resident = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void StreamingTerrain::AddVehicle(ChSharedPtr<ChBody> chassis)
+{
+  m_vehicles.push_back(chassis);
+}
+
+void StreamingTerrain::SetPagingDistances(double radius, double lookahead)
+{
+  m_radius = radius;
+  m_lookahead = lookahead;
+}
+
+// -----------------------------------------------------------------------------
+// Loader thread: copy requested tiles from the file mapping into their cache
+// slots. All page faults on the terrain file happen here.
+// -----------------------------------------------------------------------------
+void StreamingTerrain::load_tiles()
+{
+  while (true) {
+    m_mutex.Lock();
+    while (!m_stop && m_requests.empty())
+      m_cond.Wait(m_mutex);
+    if (m_stop) {
+      m_mutex.Unlock();
+      break;
+    }
+    Request request = m_requests.front();
+    m_requests.erase(m_requests.begin());
+    m_mutex.Unlock();
+
+    size_t offset = m_tile_offset + (size_t)request.tile * m_tile_bytes;
+    std::memcpy(&m_slot_data[(size_t)request.slot * m_slot_floats], m_data + offset, m_slot_floats * sizeof(float));
+    m_file.ReleasePages(offset, m_tile_bytes);
+
+    m_mutex.Lock();
+    m_completed.push_back(request);
+    m_mutex.Unlock();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void StreamingTerrain::Update(double time)
+{
+  if (!m_data)
+    return;
+
+  m_frame++;
+
+  // Publish the tiles loaded since the last update.
+  std::vector<Request> completed;
+  m_mutex.Lock();
+  completed.swap(m_completed);
+  m_mutex.Unlock();
+
+  for (size_t k = 0; k < completed.size(); k++) {
+    m_tile_slot[completed[k].tile] = completed[k].slot;
+    m_tile_pending[completed[k].tile] = -1;
+    m_num_resident++;
+  }
+
+  // Collect the tiles needed by the tracked vehicles, nearest first.
+  std::vector<int> needed;
+
+  for (size_t iv = 0; iv < m_vehicles.size(); iv++) {
+    ChVector<> pos = m_vehicles[iv]->GetPos();
+    ChVector<> vel = m_vehicles[iv]->GetPos_dt();
+    vel.z = 0;
+
+    need_tiles(pos.x, pos.y, needed);
+
+    double speed = vel.Length();
+    if (speed < 0.1 || m_radius <= 0)
+      continue;
+
+    ChVector<> dir = vel / speed;
+    for (double d = m_radius; d <= m_lookahead; d += m_radius)
+      need_tiles(pos.x + d * dir.x, pos.y + d * dir.y, needed);
+  }
+
+  // Mark the resident and pending tiles as recently needed.
+  for (size_t k = 0; k < needed.size(); k++) {
+    int slot = (m_tile_slot[needed[k]] >= 0) ? m_tile_slot[needed[k]] : m_tile_pending[needed[k]];
+    if (slot >= 0)
+      m_slot_stamp[slot] = m_frame;
+  }
+
+  // Request the missing tiles, as long as cache slots can be recycled.
+  std::vector<Request> requests;
+
+  for (size_t k = 0; k < needed.size(); k++) {
+    int tile = needed[k];
+    if (m_tile_slot[tile] >= 0 || m_tile_pending[tile] >= 0)
+      continue;
+    if (!request_tile(tile))
+      break;
+    Request request = { tile, m_tile_pending[tile] };
+    requests.push_back(request);
+  }
+
+  if (!requests.empty()) {
+    m_mutex.Lock();
+    m_requests.insert(m_requests.end(), requests.begin(), requests.end());
+    m_cond.Signal();
+    m_mutex.Unlock();
+  }
+}
+
+void StreamingTerrain::need_tiles(double x, double y, std::vector<int>& needed)
+{
+  double tile_x = m_tile_cells * m_dx;
+  double tile_y = m_tile_cells * m_dy;
+
+  int tx0 = (int)std::floor((x - m_radius - m_xmin) / tile_x);
+  int tx1 = (int)std::floor((x + m_radius - m_xmin) / tile_x);
+  int ty0 = (int)std::floor((y - m_radius - m_ymin) / tile_y);
+  int ty1 = (int)std::floor((y + m_radius - m_ymin) / tile_y);
+
+  // The tile containing (x,y) comes first.
+  int tc = std::min(std::max((int)std::floor((x - m_xmin) / tile_x), 0), m_ntx - 1);
+  int uc = std::min(std::max((int)std::floor((y - m_ymin) / tile_y), 0), m_nty - 1);
+  int center = uc * m_ntx + tc;
+  if (std::find(needed.begin(), needed.end(), center) == needed.end())
+    needed.push_back(center);
+
+  tx0 = std::max(tx0, 0);
+  ty0 = std::max(ty0, 0);
+  tx1 = std::min(tx1, m_ntx - 1);
+  ty1 = std::min(ty1, m_nty - 1);
+
+  for (int ty = ty0; ty <= ty1; ty++) {
+    for (int tx = tx0; tx <= tx1; tx++) {
+      int tile = ty * m_ntx + tx;
+      if (std::find(needed.begin(), needed.end(), tile) == needed.end())
+        needed.push_back(tile);
+    }
+  }
+}
+
+bool StreamingTerrain::request_tile(int tile)
+{
+  // Use a free slot if available, otherwise recycle the least recently needed
+  // resident tile (tiles needed in this frame and pending tiles are kept).
+  int slot = -1;
+  int oldest = m_frame;
+
+  for (int s = 0; s < (int)m_slot_tile.size(); s++) {
+    if (m_slot_tile[s] < 0) {
+      slot = s;
+      break;
+    }
+    if (m_tile_slot[m_slot_tile[s]] == s && m_slot_stamp[s] < oldest) {
+      slot = s;
+      oldest = m_slot_stamp[s];
+    }
+  }
+
+  if (slot < 0)
+    return false;
+
+  if (m_slot_tile[slot] >= 0) {
+    m_tile_slot[m_slot_tile[slot]] = -1;
+    m_num_resident--;
+  }
+
+  m_slot_tile[slot] = tile;
+  m_slot_stamp[slot] = m_frame;
+  m_tile_pending[tile] = slot;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void StreamingTerrain::find_cell(double x, double y, float h[4], double& tx, double& ty, double& dx, double& dy) const
+{
+  int ncx = m_nx - 1;
+  int ncy = m_ny - 1;
+
+  // Grid coordinates, clamped to the grid.
+  double u = std::min(std::max((x - m_xmin) / m_dx, 0.0), (double)ncx);
+  double v = std::min(std::max((y - m_ymin) / m_dy, 0.0), (double)ncy);
+
+  int i = std::min((int)u, ncx - 1);
+  int j = std::min((int)v, ncy - 1);
+
+  int tile = (j / m_tile_cells) * m_ntx + i / m_tile_cells;
+  int slot = m_tile_slot[tile];
+
+  if (slot >= 0) {
+    int n = m_tile_cells + 1;
+    int li = i % m_tile_cells;
+    int lj = j % m_tile_cells;
+    const float* p = &m_slot_data[(size_t)slot * m_slot_floats + lj * n + li];
+    h[0] = p[0];
+    h[1] = p[1];
+    h[2] = p[n];
+    h[3] = p[n + 1];
+    tx = u - i;
+    ty = v - j;
+    dx = m_dx;
+    dy = m_dy;
+    return;
+  }
+
+  // Fall back to the coarse level.
+  vehicle::ChAtomicIncrement(&m_num_fallback);
+
+  double U = u / m_mip_stride;
+  double V = v / m_mip_stride;
+  int I = std::min((int)U, m_mip_nx - 2);
+  int J = std::min((int)V, m_mip_ny - 2);
+
+  const float* p = &m_mip[(size_t)J * m_mip_nx + I];
+  h[0] = p[0];
+  h[1] = p[1];
+  h[2] = p[m_mip_nx];
+  h[3] = p[m_mip_nx + 1];
+  tx = U - I;
+  ty = V - J;
+  dx = m_dx * m_mip_stride;
+  dy = m_dy * m_mip_stride;
+}
+
+static inline double CellHeight(const float h[4], double tx, double ty)
+{
+  double h0 = h[0] + tx * (h[1] - h[0]);
+  double h1 = h[2] + tx * (h[3] - h[2]);
+
+  return h0 + ty * (h1 - h0);
+}
+
+// Normal from the average slopes over the cell.
+static inline ChVector<> CellNormal(const float h[4], double dx, double dy)
+{
+  double dzdx = 0.5 * ((h[1] - h[0]) + (h[3] - h[2])) / dx;
+  double dzdy = 0.5 * ((h[2] - h[0]) + (h[3] - h[1])) / dy;
+  ChVector<> normal(-dzdx, -dzdy, 1);
+
+  return normal / normal.Length();
+}
+
+double StreamingTerrain::GetHeight(double x, double y) const
+{
+  if (!m_data)
+    return 0;
+
+  float h[4];
+  double tx, ty, dx, dy;
+  find_cell(x, y, h, tx, ty, dx, dy);
+
+  return CellHeight(h, tx, ty);
+}
+
+ChVector<> StreamingTerrain::GetNormal(double x, double y) const
+{
+  if (!m_data)
+    return ChVector<>(0, 0, 1);
+
+  float h[4];
+  double tx, ty, dx, dy;
+  find_cell(x, y, h, tx, ty, dx, dy);
+
+  return CellNormal(h, dx, dy);
+}
+
+void StreamingTerrain::GetHeightAndNormal(int           n,
+                                          const double* x,
+                                          const double* y,
+                                          double*       height,
+                                          ChVector<>*   normal) const
+{
+  if (!m_data) {
+    ChTerrain::GetHeightAndNormal(n, x, y, height, normal);
+    return;
+  }
+
+  for (int i = 0; i < n; i++) {
+    float h[4];
+    double tx, ty, dx, dy;
+    find_cell(x[i], y[i], h, tx, ty, dx, dy);
+
+    height[i] = CellHeight(h, tx, ty);
+    if (normal)
+      normal[i] = CellNormal(h, dx, dy);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Write a tiled terrain file.
+// -----------------------------------------------------------------------------
+bool StreamingTerrain::WriteFile(const std::string&        filename,
+                                 int                       nx,
+                                 int                       ny,
+                                 const std::vector<float>& heights,
+                                 double                    sizeX,
+                                 double                    sizeY,
+                                 int                       tile_cells,
+                                 int                       mip_level)
+{
+  if (nx < 2 || ny < 2 || tile_cells < 1 || mip_level < 0 || heights.size() < (size_t)nx * ny) {
+    GetLog() << "ERROR: invalid terrain grid (" << nx << " x " << ny << ")\n";
+    return false;
+  }
+
+  std::ofstream ofile(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!ofile) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  int ncx = nx - 1;
+  int ncy = ny - 1;
+  int ntx = (ncx + tile_cells - 1) / tile_cells;
+  int nty = (ncy + tile_cells - 1) / tile_cells;
+  int stride = 1 << mip_level;
+  int mip_nx = (ncx + stride - 1) / stride + 1;
+  int mip_ny = (ncy + stride - 1) / stride + 1;
+
+  size_t tile_floats = (size_t)(tile_cells + 1) * (tile_cells + 1);
+  size_t tile_bytes = (tile_floats * sizeof(float) + FILE_PAGE - 1) / FILE_PAGE * FILE_PAGE;
+  size_t tile_offset = FILE_PAGE;
+  size_t mip_offset = tile_offset + (size_t)ntx * nty * tile_bytes;
+
+  // Header
+  std::vector<char> page(FILE_PAGE, 0);
+  int ints[8] = { nx, ny, tile_cells, ntx, nty, stride, mip_nx, mip_ny };
+  double sizes[2] = { sizeX, sizeY };
+  unsigned long long offsets[3] = { tile_offset, tile_bytes, mip_offset };
+  std::memcpy(&page[0], FILE_MAGIC, 8);
+  std::memcpy(&page[8], ints, sizeof(ints));
+  std::memcpy(&page[8 + sizeof(ints)], sizes, sizeof(sizes));
+  std::memcpy(&page[8 + sizeof(ints) + sizeof(sizes)], offsets, sizeof(offsets));
+  ofile.write(&page[0], page.size());
+
+  // Tiles (nodes beyond the grid replicate the boundary nodes).
+  std::vector<float> tile(tile_bytes / sizeof(float), 0.0f);
+
+  for (int ty = 0; ty < nty; ty++) {
+    for (int tx = 0; tx < ntx; tx++) {
+      for (int lj = 0; lj <= tile_cells; lj++) {
+        int j = std::min(ty * tile_cells + lj, ny - 1);
+        const float* row = &heights[(size_t)(ny - 1 - j) * nx];
+        for (int li = 0; li <= tile_cells; li++)
+          tile[lj * (tile_cells + 1) + li] = row[std::min(tx * tile_cells + li, nx - 1)];
+      }
+      ofile.write(reinterpret_cast<const char*>(&tile[0]), tile_bytes);
+    }
+  }
+
+  // Coarse level
+  std::vector<float> mip((size_t)mip_nx * mip_ny);
+
+  for (int J = 0; J < mip_ny; J++) {
+    int j = std::min(J * stride, ny - 1);
+    const float* row = &heights[(size_t)(ny - 1 - j) * nx];
+    for (int I = 0; I < mip_nx; I++)
+      mip[(size_t)J * mip_nx + I] = row[std::min(I * stride, nx - 1)];
+  }
+  ofile.write(reinterpret_cast<const char*>(&mip[0]), mip.size() * sizeof(float));
+
+  if (!ofile) {
+    GetLog() << "ERROR: failed writing " << filename.c_str() << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+
+} // end namespace chrono
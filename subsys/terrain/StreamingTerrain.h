@@ -0,0 +1,209 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Height-map terrain streamed from a memory-mapped tiled terrain file, for
+// courses too large to be kept in memory at full resolution.
+//
+// The terrain file (see WriteFile()) contains the full-resolution grid split
+// into square tiles, each aligned to a page boundary, and a coarse mip level of
+// the whole grid. The coarse level is always resident. Full-resolution tiles
+// are paged in by a background thread into a fixed-size LRU tile cache, based
+// on the positions of the tracked vehicles (tiles within a given radius) and on
+// their direction of travel (tiles within the same radius of points ahead of
+// each vehicle). Paged-in tiles are copied out of the file mapping, whose pages
+// are then released.
+//
+// Tiles become visible, and cache slots are recycled, only in Update(), which
+// is called by the simulation thread. GetHeight() and GetNormal() never block:
+// if the tile containing the query point is not resident, they fall back to
+// the coarse mip level.
+//
+// =============================================================================
+
+#ifndef STREAMINGTERRAIN_H
+#define STREAMINGTERRAIN_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChSmartpointers.h"
+#include "physics/ChBody.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChVehicleThreads.h"
+
+namespace chrono {
+
+///
+/// Concrete class for a streamed, tiled height-map terrain.
+/// The terrain grid is centered at the origin of the x-y plane. Heights are
+/// obtained by bilinear interpolation and normals from the slopes of the grid
+/// cell containing the query point. This type of terrain can be used in
+/// conjunction with tire models that perform their own collision detection
+/// (e.g. ChPacejkaTire and ChLugreTire).
+///
+class CH_SUBSYS_API StreamingTerrain : public ChTerrain
+{
+public:
+
+  StreamingTerrain();
+  ~StreamingTerrain();
+
+  /// Open the specified terrain file and start the background loader.
+  /// Returns false if the file cannot be mapped or is not a valid terrain file.
+  bool Open(
+    const std::string&  filename,          ///< [in] name of the tiled terrain file
+    int                 cache_tiles = 64   ///< [in] capacity of the tile cache
+    );
+
+  /// Close the terrain file and release all tiles.
+  void Close();
+
+  /// Track the specified vehicle chassis. Tiles are paged in around the chassis
+  /// location and ahead of it, along the direction of its velocity.
+  void AddVehicle(ChSharedPtr<ChBody> chassis);
+
+  /// Set the radius around each tracked point within which tiles are paged in
+  /// (default: 50 m) and the distance ahead of each vehicle up to which tiles
+  /// are prefetched (default: 150 m).
+  void SetPagingDistances(double radius, double lookahead);
+
+  /// Publish the tiles loaded since the last call, recycle the least recently
+  /// needed tiles and queue new tile requests for the tracked vehicles.
+  virtual void Update(double time);
+
+  /// Get the terrain height at the specified (x,y) location.
+  /// Returns 0 if no terrain file is open.
+  virtual double GetHeight(double x, double y) const;
+
+  /// Get the terrain normal at the specified (x,y) location.
+  virtual ChVector<> GetNormal(double x, double y) const;
+
+  /// Get the terrain heights and normals at the specified (x,y) locations,
+  /// with a single cell lookup per location.
+  virtual void GetHeightAndNormal(int n, const double* x, const double* y, double* height, ChVector<>* normal) const;
+
+  /// Get the number of tiles currently resident at full resolution.
+  int GetNumResidentTiles() const { return m_num_resident; }
+
+  /// Get the number of queries resolved using the coarse mip level.
+  int GetNumFallbackQueries() const { return (int)m_num_fallback; }
+
+  /// Write a tiled terrain file from a height grid. The heights are given as
+  /// for HeightmapTerrain::SetHeights(): row by row, with the first row at the
+  /// maximum y. The resident coarse level samples every 2^mip_level-th node.
+  /// Returns false if the file cannot be written.
+  static bool WriteFile(
+    const std::string&         filename,        ///< [in] name of the output file
+    int                        nx,              ///< [in] number of grid nodes in the X direction
+    int                        ny,              ///< [in] number of grid nodes in the Y direction
+    const std::vector<float>&  heights,         ///< [in] node heights (nx * ny values)
+    double                     sizeX,           ///< [in] terrain dimension in the X direction
+    double                     sizeY,           ///< [in] terrain dimension in the Y direction
+    int                        tile_cells = 128,///< [in] number of cells along each side of a tile
+    int                        mip_level = 4    ///< [in] level of the resident coarse grid
+    );
+
+private:
+
+  // Queue of tile requests and completed tiles, exchanged with the loader
+  // thread (all members protected by m_mutex).
+  struct Request {
+    int tile;
+    int slot;
+  };
+
+  class Loader : public vehicle::ChThread {
+  public:
+    Loader(StreamingTerrain* terrain) : m_terrain(terrain) {}
+  protected:
+    virtual void Run() { m_terrain->load_tiles(); }
+  private:
+    StreamingTerrain* m_terrain;
+  };
+
+  // Body of the loader thread.
+  void load_tiles();
+
+  // Add the tiles within m_radius of the point (x,y) to the list of needed tiles.
+  void need_tiles(double x, double y, std::vector<int>& needed);
+
+  // Queue the specified tile for loading, recycling a cache slot if necessary.
+  // Returns false if no slot is available.
+  bool request_tile(int tile);
+
+  // Bilinear interpolation in the cell containing (x,y), either at full
+  // resolution or in the coarse mip level. The corner heights are returned in
+  // the order (x0,y0), (x1,y0), (x0,y1), (x1,y1).
+  void find_cell(double x, double y, float h[4], double& tx, double& ty, double& dx, double& dy) const;
+
+  // File mapping
+  vehicle::ChMappedFile m_file;
+  const char*          m_data;
+  size_t               m_size;
+
+  // Grid description
+  int                  m_nx;
+  int                  m_ny;
+  int                  m_tile_cells;
+  int                  m_ntx;
+  int                  m_nty;
+  size_t               m_tile_offset;
+  size_t               m_tile_bytes;
+
+  double               m_xmin;
+  double               m_ymin;
+  double               m_dx;
+  double               m_dy;
+
+  // Resident coarse mip level
+  int                  m_mip_stride;
+  int                  m_mip_nx;
+  int                  m_mip_ny;
+  std::vector<float>   m_mip;
+
+  // Tile cache (m_tile_slot and the slot bookkeeping are only accessed by the
+  // simulation thread; the loader only writes into the data of requested slots)
+  std::vector<int>     m_tile_slot;     // cache slot of each tile (-1 if not resident)
+  std::vector<int>     m_tile_pending;  // cache slot a tile is being loaded into (-1 if none)
+  std::vector<int>     m_slot_tile;     // tile held by each slot (-1 if free)
+  std::vector<int>     m_slot_stamp;    // last frame in which each slot was needed
+  std::vector<float>   m_slot_data;     // heights of the cached tiles
+  int                  m_slot_floats;   // number of heights per tile
+  int                  m_frame;
+  int                  m_num_resident;
+
+  mutable volatile long m_num_fallback;   // incremented by concurrent queries
+
+  // Tracked vehicles
+  std::vector<ChSharedPtr<ChBody> > m_vehicles;
+  double               m_radius;
+  double               m_lookahead;
+
+  // Loader thread
+  Loader               m_loader;
+  vehicle::ChMutex     m_mutex;
+  vehicle::ChCondition m_cond;
+  std::vector<Request> m_requests;
+  std::vector<Request> m_completed;
+  bool                 m_stop;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,220 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Polynomial approximations of atan, sin and cos for the Magic Formula tire
+// models, and a rational approximation of tanh for the surrogate tire networks
+// (see ChSurrogateTireModel).
+//
+// The functions use a branch-free range reduction (written with selects only)
+// followed by a minimax polynomial, such that loops calling them can be
+// vectorized (this requires relaxed floating-point semantics, e.g. the flags
+// set with ENABLE_PACEJKA_SIMD).  Even as scalar code, they are cheaper than
+// the standard library functions.  The maximum absolute errors, for arguments
+// of moderate size (|x| < 1e4 for sin and cos), are:
+//
+//   ChFastAtan   7e-9
+//   ChFastSin    2e-11
+//   ChFastCos    2e-11
+//   ChFastTanh   3e-7
+//
+// The single precision overloads (for the single precision tire kernels) use
+// the same polynomials; their errors are dominated by the float round-off
+// (about 1e-7 relative).
+//
+// The two policy classes below allow selecting between these and the standard
+// library functions at compile time (see ChPacejkaTireBatch). All functions
+// can also be called from CUDA device code (see ChPacejkaBatchDevice), so
+// they only use literal constants.
+//
+// =============================================================================
+
+#ifndef CH_FASTMATH_H
+#define CH_FASTMATH_H
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChMathematics.h"
+
+// Functions callable from both host and device code when compiled by nvcc.
+#ifdef __CUDACC__
+#define CH_TIRE_HOSTDEVICE __host__ __device__
+#else
+#define CH_TIRE_HOSTDEVICE
+#endif
+
+namespace chrono {
+
+/// Approximation of atan(x), with maximum absolute error 7e-9.
+/// |x| > 1 is reduced to [0,1] through atan(x) = pi/2 - atan(1/x).
+CH_TIRE_HOSTDEVICE inline double ChFastAtan(double x)
+{
+  double ax = std::abs(x);
+  double z = std::min(ax, 1.0) / std::max(ax, 1.0);
+  double z2 = z * z;
+
+  double p = 0.0024298220389553176;
+  p = p * z2 - 0.0142868599695008;
+  p = p * z2 + 0.039580529631358816;
+  p = p * z2 - 0.072161872140269201;
+  p = p * z2 + 0.10489051527615129;
+  p = p * z2 - 0.14158253547972563;
+  p = p * z2 + 0.19985432018484442;
+  p = p * z2 - 0.3333256300575495;
+  p = p * z2 + 0.9999998792688386;
+
+  const double pi_2 = 1.57079632679489661923;
+  double r = z * p;
+  r = (ax > 1.0) ? pi_2 - r : r;
+  return (x < 0) ? -r : r;
+}
+
+/// Approximation of sin(x), with maximum absolute error 2e-11.
+/// The argument is reduced to [-pi,pi] (in two parts, to limit the round-off
+/// for larger arguments) and then folded onto [-pi/2,pi/2].
+CH_TIRE_HOSTDEVICE inline double ChFastSin(double x)
+{
+  const double pi = 3.14159265358979323846;
+  const double inv_2pi = 0.15915494309189535;
+  const double two_pi_hi = 6.28318530717958623;
+  const double two_pi_lo = 2.4492935982947064e-16;
+
+  double k = std::floor(x * inv_2pi + 0.5);
+  double r = (x - k * two_pi_hi) - k * two_pi_lo;
+  r = std::min(r, pi - r);
+  r = std::max(r, -pi - r);
+  double r2 = r * r;
+
+  double p = -2.3806606335721181e-08;
+  p = p * r2 + 2.7519672481111852e-06;
+  p = p * r2 - 0.00019840723337265453;
+  p = p * r2 + 0.0083333294902336996;
+  p = p * r2 - 0.16666666551696754;
+  p = p * r2 + 0.99999999990314437;
+
+  return r * p;
+}
+
+/// Approximation of cos(x), with maximum absolute error 2e-11.
+CH_TIRE_HOSTDEVICE inline double ChFastCos(double x)
+{
+  return ChFastSin(x + 1.57079632679489661923);
+}
+
+/// Approximation of tanh(x), with maximum absolute error 3e-7: a (13,6)
+/// rational minimax approximation on [-7.9,7.9], where tanh(x) rounds to +-1
+/// in single precision.
+CH_TIRE_HOSTDEVICE inline double ChFastTanh(double x)
+{
+  const double x_max = 7.90531110763549805;
+  double z = std::min(std::max(x, -x_max), x_max);
+  double z2 = z * z;
+
+  double p = -2.76076847742355e-16;
+  p = p * z2 + 2.00018790482477e-13;
+  p = p * z2 - 8.60467152213735e-11;
+  p = p * z2 + 5.12229709037114e-08;
+  p = p * z2 + 1.48572235717979e-05;
+  p = p * z2 + 6.37261928875436e-04;
+  p = p * z2 + 4.89352455891786e-03;
+
+  double q = 1.19825839466702e-06;
+  q = q * z2 + 1.18534705686654e-04;
+  q = q * z2 + 2.26843463243900e-03;
+  q = q * z2 + 4.89352518554385e-03;
+
+  return z * p / q;
+}
+
+/// Single precision approximation of atan(x).
+CH_TIRE_HOSTDEVICE inline float ChFastAtan(float x)
+{
+  float ax = std::abs(x);
+  float z = std::min(ax, 1.0f) / std::max(ax, 1.0f);
+  float z2 = z * z;
+
+  float p = 0.0024298220389553176f;
+  p = p * z2 - 0.0142868599695008f;
+  p = p * z2 + 0.039580529631358816f;
+  p = p * z2 - 0.072161872140269201f;
+  p = p * z2 + 0.10489051527615129f;
+  p = p * z2 - 0.14158253547972563f;
+  p = p * z2 + 0.19985432018484442f;
+  p = p * z2 - 0.3333256300575495f;
+  p = p * z2 + 0.9999998792688386f;
+
+  const float pi_2 = 1.57079632679489661923f;
+  float r = z * p;
+  r = (ax > 1.0f) ? pi_2 - r : r;
+  return (x < 0) ? -r : r;
+}
+
+/// Single precision approximation of sin(x). The high part of 2*pi has few
+/// enough significant bits for k*two_pi_hi to be exact.
+CH_TIRE_HOSTDEVICE inline float ChFastSin(float x)
+{
+  const float pi = 3.14159265358979323846f;
+  const float inv_2pi = 0.15915494309189535f;
+  const float two_pi_hi = 6.28125f;
+  const float two_pi_lo = 1.9353071795864769e-3f;
+
+  float k = std::floor(x * inv_2pi + 0.5f);
+  float r = (x - k * two_pi_hi) - k * two_pi_lo;
+  r = std::min(r, pi - r);
+  r = std::max(r, -pi - r);
+  float r2 = r * r;
+
+  float p = -2.3806606335721181e-08f;
+  p = p * r2 + 2.7519672481111852e-06f;
+  p = p * r2 - 0.00019840723337265453f;
+  p = p * r2 + 0.0083333294902336996f;
+  p = p * r2 - 0.16666666551696754f;
+  p = p * r2 + 0.99999999990314437f;
+
+  return r * p;
+}
+
+/// Single precision approximation of cos(x).
+CH_TIRE_HOSTDEVICE inline float ChFastCos(float x)
+{
+  return ChFastSin(x + 1.57079632679489661923f);
+}
+
+/// Math policy using the standard library functions.
+struct ChStdMath {
+  CH_TIRE_HOSTDEVICE static double atan(double x) { return std::atan(x); }
+  CH_TIRE_HOSTDEVICE static double sin(double x) { return std::sin(x); }
+  CH_TIRE_HOSTDEVICE static double cos(double x) { return std::cos(x); }
+
+  CH_TIRE_HOSTDEVICE static float atan(float x) { return std::atan(x); }
+  CH_TIRE_HOSTDEVICE static float sin(float x) { return std::sin(x); }
+  CH_TIRE_HOSTDEVICE static float cos(float x) { return std::cos(x); }
+};
+
+/// Math policy using the polynomial approximations above.
+struct ChFastMath {
+  CH_TIRE_HOSTDEVICE static double atan(double x) { return ChFastAtan(x); }
+  CH_TIRE_HOSTDEVICE static double sin(double x) { return ChFastSin(x); }
+  CH_TIRE_HOSTDEVICE static double cos(double x) { return ChFastCos(x); }
+
+  CH_TIRE_HOSTDEVICE static float atan(float x) { return ChFastAtan(x); }
+  CH_TIRE_HOSTDEVICE static float sin(float x) { return ChFastSin(x); }
+  CH_TIRE_HOSTDEVICE static float cos(float x) { return ChFastCos(x); }
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -21,6 +21,7 @@
 // =============================================================================
 
 #include <algorithm>
+#include <cmath>
 
 #include "physics/ChGlobal.h"
 
@@ -29,6 +30,9 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/tire/ChLugreTire.h"
+#include "subsys/tire/ChLugreTireBatch.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChProfiler.h"
 
 
 namespace chrono {
@@ -39,7 +43,15 @@ namespace chrono {
 ChLugreTire::ChLugreTire(const std::string& name,
                          const ChTerrain&   terrain)
 : ChTire(name, terrain),
-  m_stepsize(1e-3)
+  m_stepsize(1e-3),
+  m_cache_tol(0),
+  m_num_cache_tests(0),
+  m_num_cache_hits(0),
+  m_lod_roughness(0),
+  m_lod_camber(0),
+  m_lod_disc(0),
+  m_lod_loc(0),
+  m_num_active(0)
 {
   m_tireForce.force = ChVector<>(0, 0, 0);
   m_tireForce.point = ChVector<>(0, 0, 0);
@@ -51,16 +63,43 @@ ChLugreTire::ChLugreTire(const std::string& name,
 // -----------------------------------------------------------------------------
 void ChLugreTire::Initialize()
 {
-  m_data.resize(getNumDiscs());
-  m_state.resize(getNumDiscs());
+  int num_discs = getNumDiscs();
+
+  m_center.resize(num_discs);
+  m_in_contact.resize(num_discs);
+  m_frame.resize(num_discs);
+  m_depth.resize(num_discs);
+  m_vel.resize(num_discs);
+  m_normal_force.resize(num_discs);
+  m_mu_scale.resize(num_discs, 1.0);
+  m_cache.assign(num_discs, DiscContactCache());
+
+  m_ode_a.resize(2 * num_discs);
+  m_ode_b.resize(2 * num_discs);
+  m_z_ss.resize(2 * num_discs);
+  m_z.resize(2 * num_discs);
 
   SetLugreParams();
 
   // Initialize disc states
-  for (int id = 0; id < getNumDiscs(); id++) {
-    m_state[id].z0 = 0;
-    m_state[id].z1 = 0;
+  for (int i = 0; i < 2 * num_discs; i++) {
+    m_ode_a[i] = 0;
+    m_ode_b[i] = 0;
+    m_z_ss[i] = 0;
+    m_z[i] = 0;
   }
+
+  // Disc kept active with adaptive discs.
+  const double* disc_locs = getDiscLocations();
+  m_lod_loc = 0;
+  for (int id = 0; id < num_discs; id++)
+    m_lod_loc += disc_locs[id] / num_discs;
+  m_lod_disc = 0;
+  for (int id = 1; id < num_discs; id++) {
+    if (std::abs(disc_locs[id] - m_lod_loc) < std::abs(disc_locs[m_lod_disc] - m_lod_loc))
+      m_lod_disc = id;
+  }
+  m_num_active = num_discs;
 }
 
 void ChLugreTire::Initialize(ChSharedPtr<ChBody> wheel)
@@ -78,12 +117,63 @@ void ChLugreTire::Initialize(ChSharedPtr<ChBody> wheel)
     cyl->GetCylinderGeometry().rad = disc_radius;
     cyl->GetCylinderGeometry().p1 = ChVector<>(0, disc_locs[id] + discWidth / 2, 0);
     cyl->GetCylinderGeometry().p2 = ChVector<>(0, disc_locs[id] - discWidth / 2, 0);
-    wheel->AddAsset(cyl);
+    vehicle::ChDeferredAssets::AddAsset(wheel, cyl);
   }
 
   ChSharedPtr<ChTexture> tex(new ChTexture);
   tex->SetTextureFilename(GetChronoDataFile("bluwhite.png"));
-  wheel->AddAsset(tex);
+  vehicle::ChDeferredAssets::AddAsset(wheel, tex);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChLugreTire::EnableContactCache(double tolerance)
+{
+  m_cache_tol = std::max(tolerance, 0.0);
+  m_cache.assign(m_cache.size(), DiscContactCache());
+}
+
+void ChLugreTire::EnableAdaptiveDiscs(double roughness,
+                                      double camber)
+{
+  m_lod_roughness = std::max(roughness, 0.0);
+  m_lod_camber = std::sin(std::abs(camber));
+}
+
+// -----------------------------------------------------------------------------
+// The footprint is approximated by a square around the wheel center, covering
+// the discs and half the radius along the rolling direction.
+// -----------------------------------------------------------------------------
+bool ChLugreTire::is_smooth_contact(const ChVector<>& wheel_pos, const ChVector<>& disc_normal) const
+{
+  const double* disc_locs = getDiscLocations();
+  double half_size = 0.5 * getRadius();
+  for (int id = 0; id < getNumDiscs(); id++)
+    half_size = std::max(half_size, std::abs(disc_locs[id]) + 0.1 * getRadius());
+
+  double height;
+  ChVector<> normal;
+  m_terrain.GetHeightAndNormal(1, &wheel_pos.x, &wheel_pos.y, &height, &normal);
+
+  if (std::abs(Vdot(disc_normal, normal)) > m_lod_camber)
+    return false;
+
+  double max_height = m_terrain.GetMaxHeight(wheel_pos.x - half_size, wheel_pos.y - half_size,
+                                             wheel_pos.x + half_size, wheel_pos.y + half_size);
+
+  return max_height - height < m_lod_roughness;
+}
+
+void ChLugreTire::sync_inactive_discs()
+{
+  int num_discs = getNumDiscs();
+  if (m_num_active == num_discs)
+    return;
+
+  for (int id = 0; id < num_discs; id++) {
+    m_z[id] = m_z[m_lod_disc];
+    m_z[num_discs + id] = m_z[num_discs + m_lod_disc];
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -104,58 +194,102 @@ void ChLugreTire::Update(double               time,
   ChMatrix33<> A(wheel_state.rot);
   ChVector<> disc_normal = A.Get_A_Yaxis();
 
-  // Loop over all discs, check contact with terrain, accumulate normal tire
-  // forces, and cache data that only depends on wheel state.
-  double depth;
-
-  for (int id = 0; id < getNumDiscs(); id++) {
-    // Calculate center of disk (expressed in global frame)
-    ChVector<> disc_center = wheel_state.pos + disc_locs[id] * disc_normal;
+  int num_discs = getNumDiscs();
+
+  // With adaptive discs, only the disc closest to the mean location is
+  // evaluated on smooth ground, at the mean location. The inactive discs are
+  // out of contact with a = b = 0, so that their states are not advanced,
+  // and their cache entries are dropped.
+  bool reduced = m_lod_roughness > 0 && num_discs > 1 && is_smooth_contact(wheel_state.pos, disc_normal);
+  if (reduced && m_num_active > 1) {
+    for (int id = 0; id < num_discs; id++) {
+      if (id == m_lod_disc)
+        continue;
+      m_in_contact[id] = 0;
+      m_ode_a[id] = m_ode_a[num_discs + id] = 0;
+      m_ode_b[id] = m_ode_b[num_discs + id] = 0;
+      m_cache[id] = DiscContactCache();
+    }
+  }
+  m_num_active = reduced ? 1 : num_discs;
+
+  int first = reduced ? m_lod_disc : 0;
+  int last = first + m_num_active;
+  double weight = (double)num_discs / m_num_active;
+
+  // Calculate centers of disks (expressed in global frame)
+  if (reduced) {
+    m_center[first] = wheel_state.pos + m_lod_loc * disc_normal;
+  } else {
+    for (int id = 0; id < num_discs; id++)
+      m_center[id] = wheel_state.pos + disc_locs[id] * disc_normal;
+  }
 
-    // Check contact with terrain and calculate contact points.
-    m_data[id].in_contact = disc_terrain_contact(disc_center, disc_normal, disc_radius,
-                                                 m_data[id].frame, depth);
-    if (!m_data[id].in_contact)
+  // Check contact with terrain and calculate contact points, for all active
+  // discs at once.
+  if (m_cache_tol > 0) {
+    int num_hits = disc_terrain_contact(m_num_active, &m_center[first], disc_normal, disc_radius, m_cache_tol,
+                                        &m_cache[first], &m_in_contact[first], &m_frame[first], &m_depth[first]);
+    m_num_cache_tests += m_num_active;
+    m_num_cache_hits += num_hits;
+    CH_PROFILE_COUNTER("ChLugreTire::contact_cache_hits", num_hits);
+  } else {
+    disc_terrain_contact(m_num_active, &m_center[first], disc_normal, disc_radius,
+                         &m_in_contact[first], &m_frame[first], &m_depth[first]);
+  }
+  CH_PROFILE_COUNTER("ChLugreTire::discs_in_contact", num_discs - std::count(m_in_contact.begin(), m_in_contact.end(), 0));
+  CH_PROFILE_COUNTER("ChLugreTire::active_discs", m_num_active);
+
+  // Loop over the active discs, accumulate normal tire forces, and cache data
+  // that only depends on wheel state.
+  for (int id = first; id < last; id++) {
+    // The ODE coefficients are calculated below from the magnitude of the
+    // relative velocity; zero for discs not in contact (no state change).
+    m_ode_a[id] = 0;
+    m_ode_a[num_discs + id] = 0;
+
+    if (!m_in_contact[id])
       continue;
 
     // Relative velocity at contact point (expressed in the global frame and in
     // the contact frame)
-    ChVector<> vel = wheel_state.lin_vel + Vcross(wheel_state.ang_vel, m_data[id].frame.pos - wheel_state.pos);
-    m_data[id].vel = m_data[id].frame.TransformDirectionParentToLocal(vel);
+    ChVector<> vel = wheel_state.lin_vel + Vcross(wheel_state.ang_vel, m_frame[id].pos - wheel_state.pos);
+    m_vel[id] = m_frame[id].TransformDirectionParentToLocal(vel);
 
     // Generate normal contact force and add to accumulators (recall, all forces
     // are reduced to the wheel center). If the resulting force is negative, the
     // disc is moving away from the terrain so fast that no contact force is
     // generated.
-    double Fn_mag = getNormalStiffness() * depth - getNormalDamping() * m_data[id].vel.z;
+    double Fn_mag = getNormalStiffness() * m_depth[id] - getNormalDamping() * m_vel[id].z;
     
     if (Fn_mag < 0) Fn_mag = 0;
 
-    ChVector<> Fn = Fn_mag * m_data[id].frame.rot.GetZaxis();
+    // A single active disc carries the load of all discs.
+    Fn_mag *= weight;
 
-    m_data[id].normal_force = Fn_mag;
+    ChVector<> Fn = Fn_mag * m_frame[id].rot.GetZaxis();
 
-    m_tireForce.force += Fn;
-    m_tireForce.moment += Vcross(m_data[id].frame.pos - m_tireForce.point, Fn);
+    m_normal_force[id] = Fn_mag;
 
-    // ODE coefficients for longitudinal direction: z' = a + b * z
-    {
-      double v = abs(m_data[id].vel.x);
-      double g = m_Fc[0] + (m_Fs[0] - m_Fc[0]) * exp(-sqrt(v / m_vs[0]));
-      m_data[id].ode_coef_a[0] = v;
-      m_data[id].ode_coef_b[0] = -m_sigma0[0] * v / g;
-    }
+    // Terrain friction scaling (bounded away from zero, since the ODE
+    // coefficients divide by the friction coefficient).
+    m_mu_scale[id] = std::max(friction_scale(m_frame[id].pos), 1e-3);
 
-    // ODE coefficients for lateral direction: z' = a + b * z
-    {
-      double v = abs(m_data[id].vel.y);
-      double g = m_Fc[1] + (m_Fs[1] - m_Fc[1]) * exp(-sqrt(v / m_vs[1]));
-      m_data[id].ode_coef_a[1] = v;
-      m_data[id].ode_coef_b[1] = -m_sigma0[1] * v / g;
-    }
+    m_tireForce.force += Fn;
+    m_tireForce.moment += Vcross(m_frame[id].pos - m_tireForce.point, Fn);
+
+    m_ode_a[id] = std::abs(m_vel[id].x);
+    m_ode_a[num_discs + id] = std::abs(m_vel[id].y);
 
   } // end loop over discs
 
+  // ODE coefficients for longitudinal and lateral directions: z' = a + b * z
+  for (int dir = 0; dir < 2; dir++) {
+    int offset = dir * num_discs + first;
+    ChLugreTireBatch::OdeCoefficients(m_num_active, m_Fc[dir], m_Fs[dir], m_vs[dir], m_sigma0[dir],
+                                      &m_ode_a[offset], &m_ode_b[offset], &m_z_ss[offset], &m_mu_scale[first]);
+  }
+
 }
 
 
@@ -163,76 +297,97 @@ void ChLugreTire::Update(double               time,
 // -----------------------------------------------------------------------------
 void ChLugreTire::Advance(double step)
 {
-  for (int id = 0; id < getNumDiscs(); id++) {
+  // Advance disc states, for longitudinal and lateral directions, using the
+  // closed-form solution of the ODEs with coefficients frozen over the step.
+  ChLugreTireBatch::AdvanceStates(2 * getNumDiscs(), step, &m_ode_b[0], &m_z_ss[0], &m_z[0]);
+  sync_inactive_discs();
+
+  // Evaluate friction forces and add to accumulators for tire force
+  friction_forces();
+}
+
+// -----------------------------------------------------------------------------
+// The contact data and ODE coefficients are recomputed in Update(); only the
+// disc states and the tire force (reported until the next Update) are saved.
+// -----------------------------------------------------------------------------
+void ChLugreTire::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(vehicle::ChVehicleState::TIRE_FORCE_SIZE + m_z.size());
+  state.Write(m_tireForce);
+  state.Write(&m_z[0], m_z.size());
+}
+
+bool ChLugreTire::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(vehicle::ChVehicleState::TIRE_FORCE_SIZE + m_z.size(), m_name.c_str()))
+    return false;
+
+  m_tireForce = state.ReadTireForce();
+  state.Read(&m_z[0], m_z.size());
+
+  // The wheel may have jumped; start over with full contact tests.
+  m_cache.assign(m_cache.size(), DiscContactCache());
+  return true;
+}
+
+void ChLugreTire::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  typedef vehicle::ChMemoryReport R;
+
+  report.Add("tire/objects", sizeof(ChLugreTire));
+  report.Add("tire/contact buffers", R::VectorBytes(m_center) + R::VectorBytes(m_in_contact) + R::VectorBytes(m_frame) +
+                                     R::VectorBytes(m_depth) + R::VectorBytes(m_vel) + R::VectorBytes(m_normal_force) +
+                                     R::VectorBytes(m_mu_scale) + R::VectorBytes(m_cache));
+  report.Add("tire/LuGre states", R::VectorBytes(m_ode_a) + R::VectorBytes(m_ode_b) + R::VectorBytes(m_z_ss) +
+                                  R::VectorBytes(m_z));
+
+  ChTire::AddMemoryFootprint(report);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChLugreTire::friction_forces()
+{
+  int num_discs = getNumDiscs();
+
+  for (int id = 0; id < num_discs; id++) {
 
     // Nothing to do if this disc is not in contact
-    if (!m_data[id].in_contact)
+    if (!m_in_contact[id])
       continue;
 
-    // Advance disc states, for longitudinal and lateral directions, using the
-    // trapezoidal integration scheme, written in the form:
-    //         z_{n+1} = alpha * z_{n} + beta
-    double denom;
-    double alpha;
-    double beta;
-
-    // Start from the current cached values
-    double z0 = m_state[id].z0;
-    double z1 = m_state[id].z1;
-
-    // Take as many integration steps as needed to reach the value 'step'
-    double t = 0;
-    while (t < step) {
-      // Ensure we integrate exactly to 'step'
-      double h = std::min<>(m_stepsize, step - t);
-
-      // Advance state for longitudinal direction
-      denom = (2 - m_data[id].ode_coef_b[0] * h);
-      alpha = (2 + m_data[id].ode_coef_b[0] * h) / denom;
-      beta = 2 * m_data[id].ode_coef_a[0] * h / denom;
-      z0 = alpha * z0 + beta;
-
-      // Advance state for lateral direction
-      denom = (2 - m_data[id].ode_coef_b[1] * h);
-      alpha = (2 + m_data[id].ode_coef_b[1] * h) / denom;
-      beta = 2 * m_data[id].ode_coef_a[1] * h / denom;
-      z1 = alpha * z1 + beta;
-
-      t += h;
-    }
-
-    // Cache the states for use at subsequent calls.
-    m_state[id].z0 = z0;
-    m_state[id].z1 = z1;
+    // Current disc states
+    double z0 = m_z[id];
+    double z1 = m_z[num_discs + id];
 
     // Magnitude of normal contact force for this disc
-    double Fn_mag = m_data[id].normal_force;
+    double Fn_mag = m_normal_force[id];
 
     // Evaluate friction force and add to accumulators for tire force
     {
       // Longitudinal direction
-      double zd0 = m_data[id].ode_coef_a[0] + m_data[id].ode_coef_b[0] * z0;
+      double zd0 = m_ode_a[id] + m_ode_b[id] * z0;
 
-      double v = m_data[id].vel.x;
-      double Ft_mag = Fn_mag * (m_sigma0[0] * z0 + m_sigma1[0] * zd0 + m_sigma2[0] * abs(v));
-      ChVector<> dir = (v > 0) ? m_data[id].frame.rot.GetXaxis() : -m_data[id].frame.rot.GetXaxis();
+      double v = m_vel[id].x;
+      double Ft_mag = Fn_mag * (m_sigma0[0] * z0 + m_sigma1[0] * zd0 + m_sigma2[0] * std::abs(v));
+      ChVector<> dir = (v > 0) ? m_frame[id].rot.GetXaxis() : -m_frame[id].rot.GetXaxis();
       ChVector<> Ft = -Ft_mag * dir;
 
       m_tireForce.force += Ft;
-      m_tireForce.moment += Vcross(m_data[id].frame.pos - m_tireForce.point, Ft);
+      m_tireForce.moment += Vcross(m_frame[id].pos - m_tireForce.point, Ft);
     }
 
     {
       // Lateral direction
-      double zd1 = m_data[id].ode_coef_a[1] + m_data[id].ode_coef_b[1] * z1;
+      double zd1 = m_ode_a[num_discs + id] + m_ode_b[num_discs + id] * z1;
 
-      double v = m_data[id].vel.y;
-      double Ft_mag = Fn_mag * (m_sigma0[1] * z1 + m_sigma1[1] * zd1 + m_sigma2[1] * abs(v));
-      ChVector<> dir = (v > 0) ? m_data[id].frame.rot.GetYaxis() : -m_data[id].frame.rot.GetYaxis();
+      double v = m_vel[id].y;
+      double Ft_mag = Fn_mag * (m_sigma0[1] * z1 + m_sigma1[1] * zd1 + m_sigma2[1] * std::abs(v));
+      ChVector<> dir = (v > 0) ? m_frame[id].rot.GetYaxis() : -m_frame[id].rot.GetYaxis();
       ChVector<> Ft = -Ft_mag * dir;
 
       m_tireForce.force += Ft;
-      m_tireForce.moment += Vcross(m_data[id].frame.pos - m_tireForce.point, Ft);
+      m_tireForce.moment += Vcross(m_frame[id].pos - m_tireForce.point, Ft);
     }
 
   } // end loop over discs
@@ -28,8 +28,15 @@
 
 namespace chrono {
 
+class ChLugreTireBatch;
+
 ///
 /// Tire model based on LuGre friction model.
+/// The disc data is stored as structure of arrays, and the disc ODEs are
+/// advanced with the closed-form solution over the entire step (see
+/// ChLugreTireBatch::AdvanceStates), for all discs and both directions at once.
+/// With adaptive discs (see EnableAdaptiveDiscs), a single disc is evaluated
+/// on smooth ground at small camber.
 ///
 class CH_SUBSYS_API ChLugreTire : public ChTire
 {
@@ -57,6 +64,10 @@ public:
   /// force one the wheel body.
   virtual ChTireForce GetTireForce() const { return m_tireForce; }
 
+  /// Return the relative cost of one update (proportional to the number of
+  /// active discs).
+  virtual double GetUpdateCost() const { return m_num_active > 0 ? m_num_active : getNumDiscs(); }
+
   /// Update the state of this tire system at the current time.
   /// The tire system is provided the current state of its associated wheel.
   virtual void Update(
@@ -68,11 +79,52 @@ public:
   virtual void Advance(double step);
 
   /// Set the value of the integration step size for the underlying dynamics.
+  /// Note that the disc ODEs, with coefficients frozen over the step, are
+  /// solved exactly over the entire step; this value is kept for compatibility.
   void SetStepsize(double val) { m_stepsize = val; }
 
   /// Get the current value of the integration step size.
   double GetStepsize() const { return m_stepsize; }
 
+  /// Enable the incremental disc-terrain contact test (tolerance > 0) or
+  /// disable it (tolerance = 0, default). In incremental mode, a disc in
+  /// contact whose lowest point moved by less than the tolerance since its last
+  /// full contact test reuses the terrain normal found then, and only the
+  /// terrain height at its lowest point is evaluated. The tolerance should be
+  /// small relative to the terrain resolution (e.g. a fraction of the node
+  /// spacing of a height map).
+  void EnableContactCache(double tolerance);
+
+  /// Enable the adaptive disc count (roughness > 0) or disable it (roughness =
+  /// 0, default). At each update, if the terrain over the tire footprint rises
+  /// by less than the roughness tolerance above the terrain height below the
+  /// wheel center (from the GetMaxHeight() bound of the terrain, e.g. the
+  /// pyramid of a height map) and the camber relative to the terrain normal is
+  /// below the camber tolerance, only one disc, at the mean disc location and
+  /// carrying the load of all discs, is evaluated. The other discs follow the
+  /// state of the active disc, so that they resume from a consistent state
+  /// when the ground becomes rough again.
+  void EnableAdaptiveDiscs(
+    double roughness,      ///< [in] roughness tolerance
+    double camber = 0.01   ///< [in] camber tolerance (radians)
+    );
+
+  /// Get the number of discs evaluated at the last update.
+  int GetNumActiveDiscs() const { return m_num_active; }
+
+  /// Return the fraction of disc contact tests served by the contact cache.
+  double get_contact_cache_hit_rate() const { return m_num_cache_hits / (double)m_num_cache_tests; }
+
+  /// Append the disc states and the current tire force to the snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the disc states and the tire force from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+  /// Add the tire object and its per-disc contact and friction state to the
+  /// specified report.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
 protected:
 
   /// Return the number of discs used to model this tire.
@@ -103,26 +155,53 @@ protected:
 
 private:
 
-  struct DiscContactData {
-    bool         in_contact;     // true if disc in contact with terrain
-    ChCoordsys<> frame;          // contact frame (x: long, y: lat, z: normal)
-    ChVector<>   vel;            // relative velocity expressed in contact frame
-    double       normal_force;   // magnitude of normal contact force
-    double       ode_coef_a[2];  // ODE coefficients:  z' = a + b * z
-    double       ode_coef_b[2];  //   (longitudinal/lateral)
-  };
+  // Accumulate the friction forces of all discs in contact, from the current
+  // disc states.
+  void friction_forces();
+
+  // Return true if a single disc represents the tire at the specified wheel
+  // location and disc normal (see EnableAdaptiveDiscs).
+  bool is_smooth_contact(const ChVector<>& wheel_pos, const ChVector<>& disc_normal) const;
 
-  struct DiscState {
-    double       z0;             // longitudinal direction
-    double       z1;             // lateral direction
-  };
+  // Copy the state of the active disc to the inactive discs.
+  void sync_inactive_discs();
 
   double   m_stepsize;
 
   ChTireForce                  m_tireForce;
-  std::vector<DiscContactData> m_data;
-  std::vector<DiscState>       m_state;
 
+  // Disc contact data, one entry per disc
+  std::vector<ChVector<> >     m_center;        // disc center (expressed in global frame)
+  std::vector<char>            m_in_contact;    // true if disc in contact with terrain
+  std::vector<ChCoordsys<> >   m_frame;         // contact frame (x: long, y: lat, z: normal)
+  std::vector<double>          m_depth;         // penetration depth
+  std::vector<ChVector<> >     m_vel;           // relative velocity expressed in contact frame
+  std::vector<double>          m_normal_force;  // magnitude of normal contact force
+  std::vector<double>          m_mu_scale;      // terrain friction scaling at the contact point
+
+  // Incremental contact test (see EnableContactCache)
+  double                       m_cache_tol;
+  std::vector<DiscContactCache> m_cache;
+  int                          m_num_cache_tests;
+  int                          m_num_cache_hits;
+
+  // Adaptive disc count (see EnableAdaptiveDiscs)
+  double                       m_lod_roughness;
+  double                       m_lod_camber;    // sine of the camber tolerance
+  int                          m_lod_disc;      // disc kept active, closest to the mean location
+  double                       m_lod_loc;       // mean disc location
+  int                          m_num_active;    // number of discs evaluated at the last update
+
+  // ODE coefficients z' = a + b * z and disc states, for the longitudinal
+  // direction (entries 0 ... n-1) followed by the lateral direction (entries
+  // n ... 2n-1), where n is the number of discs. For discs not in contact,
+  // a = b = 0 and the state is unchanged.
+  std::vector<double>          m_ode_a;
+  std::vector<double>          m_ode_b;
+  std::vector<double>          m_z_ss;          // steady-state value -a / b
+  std::vector<double>          m_z;
+
+  friend class ChLugreTireBatch;
 };
 
 
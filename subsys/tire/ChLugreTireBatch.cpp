@@ -0,0 +1,191 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched advance of the LuGre disc states for a collection of ChLugreTire
+// objects.
+//
+// =============================================================================
+
+#include <cmath>
+
+#include "core/ChTimer.h"
+
+#include "subsys/tire/ChLugreTireBatch.h"
+
+// Tell the compiler that the state buffers do not alias, so that the kernel
+// loops can be vectorized without run-time overlap checks.
+#if defined(_MSC_VER)
+#define CH_LUGREBATCH_IVDEP __pragma(loop(ivdep))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define CH_LUGREBATCH_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define CH_LUGREBATCH_IVDEP _Pragma("clang loop vectorize(enable)")
+#else
+#define CH_LUGREBATCH_IVDEP
+#endif
+
+namespace chrono {
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChLugreTireBatch::ChLugreTireBatch()
+: m_single(false),
+  m_num_kernel_calls(0),
+  m_sum_kernel_time(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChLugreTireBatch::AddTire(ChSharedPtr<ChLugreTire> tire)
+{
+  m_offset.push_back((int)m_z.size());
+  m_tires.push_back(tire);
+
+  size_t size = m_z.size() + tire->m_z.size();
+  m_b.resize(size);
+  m_z_ss.resize(size);
+  m_z.resize(size);
+  m_b_f.resize(size);
+  m_z_ss_f.resize(size);
+  m_z_f.resize(size);
+
+  return (int)m_tires.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Advance all tires in the batch. This replaces the individual calls to
+// ChLugreTire::Advance() and produces the same tire state.
+// -----------------------------------------------------------------------------
+void ChLugreTireBatch::Advance(double step)
+{
+  pack();
+
+  ChTimer<double> kernel_timer;
+  kernel_timer.start();
+
+  if (!m_z.empty()) {
+    if (m_single)
+      AdvanceStates((int)m_z_f.size(), (float)step, &m_b_f[0], &m_z_ss_f[0], &m_z_f[0]);
+    else
+      AdvanceStates((int)m_z.size(), step, &m_b[0], &m_z_ss[0], &m_z[0]);
+  }
+
+  kernel_timer.stop();
+  m_num_kernel_calls++;
+  m_sum_kernel_time += kernel_timer();
+
+  unpack();
+
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    m_tires[i]->sync_inactive_discs();
+    m_tires[i]->friction_forces();
+  }
+}
+
+void ChLugreTireBatch::pack()
+{
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    const ChLugreTire* tire = m_tires[i].get_ptr();
+    int offset = m_offset[i];
+    if (m_single) {
+      for (size_t j = 0; j < tire->m_z.size(); j++) {
+        m_b_f[offset + j] = (float)tire->m_ode_b[j];
+        m_z_ss_f[offset + j] = (float)tire->m_z_ss[j];
+        m_z_f[offset + j] = (float)tire->m_z[j];
+      }
+      continue;
+    }
+    for (size_t j = 0; j < tire->m_z.size(); j++) {
+      m_b[offset + j] = tire->m_ode_b[j];
+      m_z_ss[offset + j] = tire->m_z_ss[j];
+      m_z[offset + j] = tire->m_z[j];
+    }
+  }
+}
+
+void ChLugreTireBatch::unpack()
+{
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    ChLugreTire* tire = m_tires[i].get_ptr();
+    int offset = m_offset[i];
+    if (m_single) {
+      for (size_t j = 0; j < tire->m_z.size(); j++)
+        tire->m_z[j] = m_z_f[offset + j];
+      continue;
+    }
+    for (size_t j = 0; j < tire->m_z.size(); j++)
+      tire->m_z[j] = m_z[offset + j];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Kernels. Discs not in contact have a = b = 0, such that their states are not
+// modified; both loops are branch-free.
+// -----------------------------------------------------------------------------
+void ChLugreTireBatch::OdeCoefficients(int           n,
+                                       double        Fc,
+                                       double        Fs,
+                                       double        vs,
+                                       double        sigma0,
+                                       const double* a,
+                                       double*       b,
+                                       double*       z_ss,
+                                       const double* mu_scale)
+{
+  double inv_vs = 1.0 / vs;
+  double inv_sigma0 = 1.0 / sigma0;
+
+  if (mu_scale) {
+    CH_LUGREBATCH_IVDEP
+    for (int i = 0; i < n; i++) {
+      double g = mu_scale[i] * (Fc + (Fs - Fc) * std::exp(-std::sqrt(a[i] * inv_vs)));
+      b[i] = -sigma0 * a[i] / g;
+      z_ss[i] = g * inv_sigma0;
+    }
+    return;
+  }
+
+  CH_LUGREBATCH_IVDEP
+  for (int i = 0; i < n; i++) {
+    double g = Fc + (Fs - Fc) * std::exp(-std::sqrt(a[i] * inv_vs));
+    b[i] = -sigma0 * a[i] / g;
+    z_ss[i] = g * inv_sigma0;
+  }
+}
+
+void ChLugreTireBatch::AdvanceStates(int           n,
+                                     double        h,
+                                     const double* b,
+                                     const double* z_ss,
+                                     double*       z)
+{
+  CH_LUGREBATCH_IVDEP
+  for (int i = 0; i < n; i++)
+    z[i] = z_ss[i] + (z[i] - z_ss[i]) * std::exp(b[i] * h);
+}
+
+void ChLugreTireBatch::AdvanceStates(int          n,
+                                     float        h,
+                                     const float* b,
+                                     const float* z_ss,
+                                     float*       z)
+{
+  CH_LUGREBATCH_IVDEP
+  for (int i = 0; i < n; i++)
+    z[i] = z_ss[i] + (z[i] - z_ss[i]) * std::exp(b[i] * h);
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,154 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched advance of the LuGre disc states for a collection of ChLugreTire
+// objects.
+//
+// Over one step, the coefficients of the disc ODEs z' = a + b * z are frozen,
+// and the ODEs have the closed-form solution
+//     z(t+h) = z_ss + (z(t) - z_ss) * exp(b * h),   z_ss = -a / b
+// The discs and the two directions are independent, so the states of all discs
+// of all tires in the batch are stored in contiguous arrays and advanced in a
+// single loop which can be vectorized by the compiler (see the
+// ENABLE_PACEJKA_SIMD option).
+//
+// The closed-form update replaces the trapezoidal sub-stepping previously used
+// in ChLugreTire::Advance(). The trapezoidal scheme is the (1,1) Pade
+// approximation of exp(b * h); with sub-step h, the two differ by at most
+// (|b| h)^3 / 12 * |z - z_ss| per sub-step, and coincide at steady state. For
+// the HMMWV LuGre parameters, a 1 ms sub-step and slip velocities up to 10 m/s,
+// the friction forces of the two schemes agree to within 0.1% of the normal
+// force.
+//
+// Optionally, the states are advanced in single precision (see
+// SetSinglePrecision()); the tire states remain in double precision and are
+// only rounded while packed in the batch buffers.
+//
+// =============================================================================
+
+#ifndef CH_LUGRETIRE_BATCH_H
+#define CH_LUGRETIRE_BATCH_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/tire/ChLugreTire.h"
+
+namespace chrono {
+
+///
+/// Batched LuGre tire evaluator.
+/// Tires are added to the batch after they have been initialized. At each
+/// step, the user calls Update() on each individual tire (as usual) and then
+/// a single Advance() on the batch, instead of Advance() on each tire.
+///
+class CH_SUBSYS_API ChLugreTireBatch : public ChShared
+{
+public:
+
+  ChLugreTireBatch();
+  ~ChLugreTireBatch() {}
+
+  /// Add an (initialized) LuGre tire to this batch.
+  /// Returns the index of the tire in the batch.
+  int AddTire(ChSharedPtr<ChLugreTire> tire);
+
+  /// Get the number of tires in this batch.
+  int GetNumTires() const { return (int)m_tires.size(); }
+
+  /// Get the total number of disc states (all discs, both directions).
+  int GetNumStates() const { return (int)m_z.size(); }
+
+  /// Advance the state of all tires in the batch by the specified time step.
+  /// The disc states of all tires are advanced at once, then the friction
+  /// forces of each tire are evaluated.
+  void Advance(double step);
+
+  /// Advance the disc states in single precision (default: false).
+  void SetSinglePrecision(bool val) { m_single = val; }
+
+  /// Return true if the disc states are advanced in single precision.
+  bool IsSinglePrecision() const { return m_single; }
+
+  /// Get the average time per call spent in the batched kernel.
+  double get_average_kernel_time() const { return m_sum_kernel_time / (double)m_num_kernel_calls; }
+
+  /// Calculate the ODE coefficients z' = a + b * z for n discs in one
+  /// direction, from the magnitude of the relative velocity (passed in a).
+  /// If specified, the friction coefficients Fc and Fs of each disc are scaled
+  /// by the corresponding terrain friction factor.
+  static void OdeCoefficients(
+    int           n,        ///< [in] number of discs
+    double        Fc,       ///< [in] Coulomb friction coefficient
+    double        Fs,       ///< [in] static friction coefficient
+    double        vs,       ///< [in] Stribeck velocity
+    double        sigma0,   ///< [in] bristle stiffness
+    const double* a,        ///< [in] ODE coefficients a (magnitude of relative velocity)
+    double*       b,        ///< [out] ODE coefficients b
+    double*       z_ss,     ///< [out] steady-state values -a / b
+    const double* mu_scale = 0  ///< [in] friction scaling factors (optional)
+    );
+
+  /// Advance n independent states z' = a + b * z (b <= 0) over the step h,
+  /// using the closed-form solution with frozen coefficients.
+  static void AdvanceStates(
+    int           n,        ///< [in] number of states
+    double        h,        ///< [in] step size
+    const double* b,        ///< [in] ODE coefficients b
+    const double* z_ss,     ///< [in] steady-state values -a / b
+    double*       z         ///< [in,out] states
+    );
+
+  /// Single precision version of AdvanceStates().
+  static void AdvanceStates(
+    int           n,        ///< [in] number of states
+    float         h,        ///< [in] step size
+    const float*  b,        ///< [in] ODE coefficients b
+    const float*  z_ss,     ///< [in] steady-state values -a / b
+    float*        z         ///< [in,out] states
+    );
+
+private:
+
+  // copy the ODE coefficients and states of all tires into the batch buffers
+  void pack();
+
+  // copy the advanced states back into each tire
+  void unpack();
+
+  std::vector<ChSharedPtr<ChLugreTire> > m_tires;
+  std::vector<int> m_offset;     // offset of each tire's states in the buffers
+
+  std::vector<double> m_b;
+  std::vector<double> m_z_ss;
+  std::vector<double> m_z;
+
+  // single precision buffers
+  std::vector<float>  m_b_f;
+  std::vector<float>  m_z_ss_f;
+  std::vector<float>  m_z_f;
+  bool                m_single;
+
+  int m_num_kernel_calls;
+  double m_sum_kernel_time;
+};
+
+
+} // end namespace chrono
+
+
+#endif
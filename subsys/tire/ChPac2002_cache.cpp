@@ -0,0 +1,281 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Pre-parsed binary cache for Pac2002 (*.tir) tire parameter files.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "subsys/tire/ChPac2002_cache.h"
+
+namespace chrono {
+
+// -----------------------------------------------------------------------------
+// Fixed-size header of the binary cache file
+// -----------------------------------------------------------------------------
+struct Pac2002_cacheHeader {
+  char               magic[8];       // "PAC2002B"
+  unsigned int       version;        // PAC2002_CACHE_VERSION
+  unsigned int       double_size;    // sizeof(double), guards against foreign files
+  unsigned long long checksum;       // checksum of the source *.tir file
+};
+
+// Numeric sections of Pac2002_data, stored contiguously and in this order.
+struct Pac2002_cacheBody {
+  int                                 use_mode;
+  int                                 num_shape;
+  double                              vxlow;
+  double                              longvl;
+  struct dimension                    dimension;
+  struct vertical                     vertical;
+  struct long_slip_range              long_slip_range;
+  struct slip_angle_range             slip_angle_range;
+  struct inclination_angle_range      inclination_angle_range;
+  struct vertical_force_range         vertical_force_range;
+  struct scaling_coefficients         scaling;
+  struct longitudinal_coefficients    longitudinal;
+  struct overturning_coefficients     overturning;
+  struct lateral_coefficients         lateral;
+  struct rolling_coefficients         rolling;
+  struct aligning_coefficients        aligning;
+};
+
+static const char cache_magic[8] = { 'P', 'A', 'C', '2', '0', '0', '2', 'B' };
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool Pac2002_checksum(const std::string&  filename,
+                      unsigned long long& checksum)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  // 64-bit FNV-1a
+  unsigned long long hash = 14695981039346656037ULL;
+  unsigned char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      hash ^= buffer[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+  fclose(fp);
+
+  checksum = hash;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Read the entire cache file in a single call, then extract the data at the
+// known offsets.
+// -----------------------------------------------------------------------------
+bool Pac2002_readCache(const std::string&  cacheFile,
+                       unsigned long long  checksum,
+                       Pac2002_data&       data)
+{
+  FILE* fp = fopen(cacheFile.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  const size_t fixed_size = sizeof(Pac2002_cacheHeader) + sizeof(Pac2002_cacheBody);
+  if (size < (long)fixed_size) {
+    fclose(fp);
+    return false;
+  }
+
+  std::vector<char> buffer(size);
+  size_t nread = fread(&buffer[0], 1, size, fp);
+  fclose(fp);
+  if (nread != (size_t)size)
+    return false;
+
+  return Pac2002_readCacheImage(&buffer[0], buffer.size(), checksum, data);
+}
+
+bool Pac2002_readCacheImage(const char*         image,
+                            size_t              size,
+                            unsigned long long  checksum,
+                            Pac2002_data&       data)
+{
+  const size_t fixed_size = sizeof(Pac2002_cacheHeader) + sizeof(Pac2002_cacheBody);
+  if (size < fixed_size)
+    return false;
+
+  const char* ptr = image;
+  const char* end = ptr + size;
+
+  // Check the header
+  Pac2002_cacheHeader header;
+  memcpy(&header, ptr, sizeof(header));
+  ptr += sizeof(header);
+
+  if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+      header.version != PAC2002_CACHE_VERSION ||
+      header.double_size != sizeof(double) ||
+      header.checksum != checksum)
+    return false;
+
+  // Numeric sections
+  Pac2002_cacheBody body;
+  memcpy(&body, ptr, sizeof(body));
+  ptr += sizeof(body);
+
+  // Variable-length data: two strings, then the shape table
+  std::string str[2];
+  for (int k = 0; k < 2; k++) {
+    unsigned int len;
+    if (ptr + sizeof(len) > end)
+      return false;
+    memcpy(&len, ptr, sizeof(len));
+    ptr += sizeof(len);
+    if (ptr + len > end)
+      return false;
+    str[k].assign(ptr, len);
+    ptr += len;
+  }
+
+  size_t shape_bytes = 2 * body.num_shape * sizeof(double);
+  if (body.num_shape < 0 || ptr + shape_bytes != end)
+    return false;
+
+  std::vector<double> radial(body.num_shape);
+  std::vector<double> width(body.num_shape);
+  if (body.num_shape > 0) {
+    memcpy(&radial[0], ptr, body.num_shape * sizeof(double));
+    ptr += body.num_shape * sizeof(double);
+    memcpy(&width[0], ptr, body.num_shape * sizeof(double));
+  }
+
+  // Everything checks out, fill in the data
+  data.model.property_file_format = str[0];
+  data.model.tyreside = str[1];
+  data.model.use_mode = body.use_mode;
+  data.model.vxlow = body.vxlow;
+  data.model.longvl = body.longvl;
+  data.dimension = body.dimension;
+  data.shape.radial = radial;
+  data.shape.width = width;
+  data.vertical = body.vertical;
+  data.long_slip_range = body.long_slip_range;
+  data.slip_angle_range = body.slip_angle_range;
+  data.inclination_angle_range = body.inclination_angle_range;
+  data.vertical_force_range = body.vertical_force_range;
+  data.scaling = body.scaling;
+  data.longitudinal = body.longitudinal;
+  data.overturning = body.overturning;
+  data.lateral = body.lateral;
+  data.rolling = body.rolling;
+  data.aligning = body.aligning;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool Pac2002_writeCache(const std::string&   cacheFile,
+                        unsigned long long   checksum,
+                        const Pac2002_data&  data)
+{
+  std::vector<char> image;
+  if (!Pac2002_writeCacheImage(checksum, data, image))
+    return false;
+
+  FILE* fp = fopen(cacheFile.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  bool ok = fwrite(&image[0], 1, image.size(), fp) == image.size();
+  if (fclose(fp) != 0)
+    ok = false;
+
+  // Do not leave a partially written cache behind
+  if (!ok)
+    remove(cacheFile.c_str());
+
+  return ok;
+}
+
+bool Pac2002_writeCacheImage(unsigned long long   checksum,
+                             const Pac2002_data&  data,
+                             std::vector<char>&   image)
+{
+  Pac2002_cacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version = PAC2002_CACHE_VERSION;
+  header.double_size = sizeof(double);
+  header.checksum = checksum;
+
+  Pac2002_cacheBody body;
+  memset(&body, 0, sizeof(body));
+  body.use_mode = data.model.use_mode;
+  body.num_shape = (int)data.shape.radial.size();
+  body.vxlow = data.model.vxlow;
+  body.longvl = data.model.longvl;
+  body.dimension = data.dimension;
+  body.vertical = data.vertical;
+  body.long_slip_range = data.long_slip_range;
+  body.slip_angle_range = data.slip_angle_range;
+  body.inclination_angle_range = data.inclination_angle_range;
+  body.vertical_force_range = data.vertical_force_range;
+  body.scaling = data.scaling;
+  body.longitudinal = data.longitudinal;
+  body.overturning = data.overturning;
+  body.lateral = data.lateral;
+  body.rolling = data.rolling;
+  body.aligning = data.aligning;
+
+  if (data.shape.width.size() != data.shape.radial.size())
+    return false;
+
+  const std::string* str[2] = { &data.model.property_file_format, &data.model.tyreside };
+  unsigned int len[2] = { (unsigned int)str[0]->size(), (unsigned int)str[1]->size() };
+
+  image.resize(sizeof(header) + sizeof(body) + 2 * sizeof(unsigned int) + len[0] + len[1] +
+               2 * body.num_shape * sizeof(double));
+  char* ptr = &image[0];
+
+  memcpy(ptr, &header, sizeof(header));
+  ptr += sizeof(header);
+  memcpy(ptr, &body, sizeof(body));
+  ptr += sizeof(body);
+
+  for (int k = 0; k < 2; k++) {
+    memcpy(ptr, &len[k], sizeof(len[k]));
+    ptr += sizeof(len[k]);
+    if (len[k] > 0)
+      memcpy(ptr, str[k]->data(), len[k]);
+    ptr += len[k];
+  }
+
+  if (body.num_shape > 0) {
+    memcpy(ptr, &data.shape.radial[0], body.num_shape * sizeof(double));
+    ptr += body.num_shape * sizeof(double);
+    memcpy(ptr, &data.shape.width[0], body.num_shape * sizeof(double));
+  }
+
+  return true;
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,90 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Pre-parsed binary cache for Pac2002 (*.tir) tire parameter files.
+//
+// The binary file starts with a fixed-size header (magic string, format
+// version, checksum of the source *.tir file), followed by all numeric
+// sections of Pac2002_data stored contiguously as raw doubles, in the order in
+// which they are declared in ChPac2002_data.h. The variable-length data
+// (strings of the [MODEL] section and the [SHAPE] table) is stored last.
+// All offsets are fixed, so the file can be read with a single read or mapped
+// directly into memory.
+//
+// =============================================================================
+
+#ifndef CH_PAC2002_CACHE_H
+#define CH_PAC2002_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/tire/ChPac2002_data.h"
+
+namespace chrono {
+
+/// Version of the binary cache format. Increment whenever Pac2002_data changes.
+static const unsigned int PAC2002_CACHE_VERSION = 1;
+
+/// Calculate a checksum (64-bit FNV-1a) of the contents of the given file.
+/// Returns false if the file cannot be opened.
+CH_SUBSYS_API
+bool Pac2002_checksum(const std::string&   filename,   ///< [in] name of the *.tir file
+                      unsigned long long&  checksum    ///< [out] checksum of the file contents
+                      );
+
+/// Load the parameters from a binary cache file.
+/// Returns false if the cache file does not exist, was written with a
+/// different format version, or does not match the specified checksum.
+CH_SUBSYS_API
+bool Pac2002_readCache(const std::string&  cacheFile,  ///< [in] name of the binary cache file
+                       unsigned long long  checksum,   ///< [in] checksum of the source *.tir file
+                       Pac2002_data&       data        ///< [out] parameter values
+                       );
+
+/// Write the parameters to a binary cache file.
+/// Returns false if the file cannot be written.
+CH_SUBSYS_API
+bool Pac2002_writeCache(const std::string&   cacheFile,  ///< [in] name of the binary cache file
+                        unsigned long long   checksum,   ///< [in] checksum of the source *.tir file
+                        const Pac2002_data&  data        ///< [in] parameter values
+                        );
+
+/// Load the parameters from an in-memory image of a binary cache file (e.g.
+/// in the shared model data segment, see ChSharedModelData).
+/// Returns false if the image is invalid or does not match the checksum.
+CH_SUBSYS_API
+bool Pac2002_readCacheImage(const char*         image,      ///< [in] contents of the cache file
+                            size_t              size,       ///< [in] size of the image, in bytes
+                            unsigned long long  checksum,   ///< [in] checksum of the source *.tir file
+                            Pac2002_data&       data        ///< [out] parameter values
+                            );
+
+/// Build the in-memory image of the binary cache file for the parameters.
+/// Returns false if the parameters are inconsistent.
+CH_SUBSYS_API
+bool Pac2002_writeCacheImage(unsigned long long   checksum,   ///< [in] checksum of the source *.tir file
+                             const Pac2002_data&  data,       ///< [in] parameter values
+                             std::vector<char>&   image       ///< [out] contents of the cache file
+                             );
+
+/// Return the name of the binary cache file associated with a *.tir file.
+inline std::string Pac2002_cacheFile(const std::string& tirFile) { return tirFile + ".bin"; }
+
+
+} // end namespace chrono
+
+
+#endif
@@ -360,6 +360,64 @@ struct combinedTorqueCoefs{
 
 };
 
+// Magic Formula terms which depend only on the vertical load, the inclination
+// angle and the friction scaling (cached between steps, see
+// ChPacejkaTire::SetCoefCacheTolerance)
+struct loadCoefs {
+	// cache key
+	double dF_z;
+	double gamma;
+	double mu_scale;
+
+	// Fx, pure longitudinal slip
+	double S_Hx;
+	double mu_x;
+	double K_x;
+	double C_x;
+	double D_x;
+	double B_x;
+	double E_x0;      // E_x, without the (1 - pex4 * sign(kappa_x)) * lex factors
+	double S_Vx;
+
+	// Fy, pure lateral slip
+	double C_y;
+	double mu_y;
+	double D_y;
+	double K_y;
+	double B_y;
+	double S_Hy;
+	double E_y0;      // pey1 + pey2 * dF_z
+	double E_y1;      // pey3 + pey4 * gamma
+	double S_Vy;
+
+	// Mz, pure lateral slip
+	double S_Hf;
+	double S_Ht;
+	double B_r;
+	double C_r;
+	double D_r0;      // D_r, without the cos(alpha) * sign(V_cx) factors and the offset
+	double B_t;
+	double C_t;
+	double D_t0;      // D_t0, without the sign(V_cx) factor
+	double D_t1;      // 1 + qdz3 * |gamma| + qdz4 * gamma^2
+	double E_t0;      // qez1 + qez2 * dF_z + qez3 * dF_z^2
+	double E_t1;      // qez4 + qez5 * gamma
+
+	// Fx, combined slip
+	double B_xAlpha0; // rbx1 + rbx3 * gamma^2
+	double E_xAlpha;
+
+	// Fy, combined slip
+	double S_HyKappa;
+	double B_yKappa0; // rby1 + rby4 * gamma^2
+	double E_yKappa;
+	double D_VyKappa0; // D_VyKappa, without the cos(atan(rvy4 * alpha)) * z2 factors
+
+	// Mz, combined slip
+	double s_gamma;   // (ssz3 + ssz4 * dF_z) * gamma
+	double K_ratio;   // K_x / K_y
+};
+
 struct relaxationL {
 	double C_Falpha;
 	double sigma_alpha;
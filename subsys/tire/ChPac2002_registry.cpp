@@ -0,0 +1,118 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Process-wide registry of read-only Pac2002 parameter blocks.
+//
+// =============================================================================
+
+#include "subsys/tire/ChPac2002_registry.h"
+
+namespace chrono {
+
+// A simulation uses only a handful of distinct tire parameter files, so a
+// linear search through the registered blocks is sufficient.
+std::vector<ChPac2002Params*> ChPac2002Registry::m_blocks;
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const ChPac2002Params* ChPac2002Registry::Acquire(const std::string& filename,
+                                                  unsigned long long checksum)
+{
+  ChPac2002Params* match = 0;
+  int node = vehicle::ChThread::GetCurrentNumaNode();
+
+  for (size_t i = 0; i < m_blocks.size(); i++) {
+    if (m_blocks[i]->checksum != checksum || m_blocks[i]->node != node)
+      continue;
+    // prefer a block loaded from the same file
+    if (m_blocks[i]->filename == filename) {
+      match = m_blocks[i];
+      break;
+    }
+    if (!match)
+      match = m_blocks[i];
+  }
+
+  if (match)
+    match->num_users++;
+
+  return match;
+}
+
+const ChPac2002Params* ChPac2002Registry::Register(ChPac2002Params* block)
+{
+  block->num_users = 1;
+  m_blocks.push_back(block);
+
+  return block;
+}
+
+void ChPac2002Registry::Release(const ChPac2002Params* block)
+{
+  for (size_t i = 0; i < m_blocks.size(); i++) {
+    if (m_blocks[i] != block)
+      continue;
+    if (--m_blocks[i]->num_users == 0) {
+      delete m_blocks[i];
+      m_blocks.erase(m_blocks.begin() + i);
+    }
+    return;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const ChPacejkaTable* ChPac2002Registry::FindTable(const ChPac2002Params*          block,
+                                                   const ChPacejkaTable::Settings& settings)
+{
+  for (size_t i = 0; i < block->tables.size(); i++) {
+    if (block->tables[i]->GetSettings() == settings)
+      return block->tables[i];
+  }
+
+  return 0;
+}
+
+const ChPacejkaTable* ChPac2002Registry::AddTable(const ChPac2002Params* block, ChPacejkaTable* table)
+{
+  for (size_t i = 0; i < m_blocks.size(); i++) {
+    if (m_blocks[i] == block) {
+      m_blocks[i]->tables.push_back(table);
+      return table;
+    }
+  }
+
+  // not a registered block; nobody would own the table
+  delete table;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChPac2002Registry::GetNumBlocks()
+{
+  return (int)m_blocks.size();
+}
+
+int ChPac2002Registry::GetNumUsers()
+{
+  int count = 0;
+  for (size_t i = 0; i < m_blocks.size(); i++)
+    count += m_blocks[i]->num_users;
+
+  return count;
+}
+
+
+}  // end namespace chrono
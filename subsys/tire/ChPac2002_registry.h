@@ -0,0 +1,125 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Process-wide registry of read-only Pac2002 parameter blocks.
+//
+// All ChPacejkaTire objects using the same parameter file (identified by its
+// path or by the checksum of its contents) share a single parameter block.
+// A block is reference counted and deleted when the last tire using it
+// releases it. Tabulated Magic Formula curves derived from a block are owned by
+// that block and shared in the same way.
+//
+// Blocks are shared only by tires created on the same NUMA node: a thread
+// pinned to a node (see ChThread::PinToNumaNode) acquires the blocks loaded
+// on that node, so that each node reads its own copy of the parameters.
+//
+// Across processes, the parameter blocks and tables are shared through the
+// shared model data segment of the node, if open (see ChSharedModelData): a
+// tire copies its parameters from the segment instead of parsing its file, and
+// uses the tabulated curves in place. The builder of the segment adds the
+// blocks it loads and the tables it builds.
+//
+// =============================================================================
+
+#ifndef CH_PAC2002_REGISTRY_H
+#define CH_PAC2002_REGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChPacejkaTable.h"
+
+namespace chrono {
+
+///
+/// Block of Pac2002 parameters loaded from one *.tir file.
+/// A block is read-only once registered.
+///
+class CH_SUBSYS_API ChPac2002Params
+{
+public:
+  ChPac2002Params(const std::string& file, unsigned long long hash)
+    : filename(file), checksum(hash), node(vehicle::ChThread::GetCurrentNumaNode()), num_users(0) {}
+
+  ~ChPac2002Params()
+  {
+    for (size_t i = 0; i < tables.size(); i++)
+      delete tables[i];
+  }
+
+  Pac2002_data        data;       ///< parsed parameter values
+  std::string         filename;   ///< source *.tir file
+  unsigned long long  checksum;   ///< checksum of the source file contents
+  int                 node;       ///< NUMA node of the thread that loaded the block (-1: not pinned)
+  int                 num_users;  ///< number of tires using this block
+
+  std::vector<ChPacejkaTable*> tables;  ///< tabulated curves built from this block
+};
+
+///
+/// Registry of Pac2002 parameter blocks.
+/// Note that the registry is not thread safe; tires should be created and
+/// destroyed from a single thread.
+///
+class CH_SUBSYS_API ChPac2002Registry
+{
+public:
+
+  /// Find a registered parameter block for the specified file.
+  /// A block matches if it was loaded from the same file and the contents are
+  /// unchanged, or if it was loaded from any file with identical contents.
+  /// Only blocks loaded on the NUMA node of the calling thread are considered.
+  /// If found, the block's use count is incremented; otherwise return NULL.
+  static const ChPac2002Params* Acquire(
+    const std::string&  filename,   ///< [in] name of the *.tir file
+    unsigned long long  checksum    ///< [in] checksum of the file contents
+    );
+
+  /// Register a newly loaded parameter block, with a use count of 1.
+  /// The registry takes ownership of the block.
+  static const ChPac2002Params* Register(ChPac2002Params* block);
+
+  /// Release a parameter block. The block is deleted when its use count
+  /// reaches zero.
+  static void Release(const ChPac2002Params* block);
+
+  /// Find the tabulated Magic Formula curves built from the specified block
+  /// with the given settings. Return NULL if no such table exists.
+  static const ChPacejkaTable* FindTable(
+    const ChPac2002Params*           block,     ///< [in] registered parameter block
+    const ChPacejkaTable::Settings&  settings   ///< [in] table settings
+    );
+
+  /// Attach a newly built table to the specified block.
+  /// The block takes ownership of the table.
+  static const ChPacejkaTable* AddTable(const ChPac2002Params* block, ChPacejkaTable* table);
+
+  /// Return the number of parameter blocks currently registered.
+  static int GetNumBlocks();
+
+  /// Return the total number of tires using registered parameter blocks.
+  static int GetNumUsers();
+
+private:
+  static std::vector<ChPac2002Params*> m_blocks;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,195 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// CUDA evaluation of the lane kernels of a batch of Pacejka tires.
+//
+// =============================================================================
+
+#include <cuda_runtime.h>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChPacejkaBatchDevice.h"
+
+
+namespace chrono {
+
+
+static const int BLOCK_SIZE = 128;
+
+static bool CheckCuda(cudaError_t err, const char* what)
+{
+  if (err == cudaSuccess)
+    return true;
+  GetLog() << "ERROR: " << what << ": " << cudaGetErrorString(err) << "\n";
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// One thread per lane; the lane data is passed by value and the slip blending
+// and Magic Formula are evaluated in sequence, as in ChPacejkaTireBatch.
+// -----------------------------------------------------------------------------
+template <class MATH>
+__global__ void PacejkaBatchKernel(ChPacejkaBatchLanes lanes, int n)
+{
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= n)
+    return;
+
+  lanes.BlendSlips(i);
+  lanes.Evaluate<MATH>(i);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaBatchDevice::ChPacejkaBatchDevice()
+: m_device(0),
+  m_stream(0),
+  m_done(0),
+  m_dev_par(0),
+  m_dev_lanes(0),
+  m_stride(0),
+  m_pending(false)
+{
+}
+
+ChPacejkaBatchDevice* ChPacejkaBatchDevice::Create(int device)
+{
+  int count = 0;
+  if (!CheckCuda(cudaGetDeviceCount(&count), "cannot query the CUDA devices"))
+    return 0;
+  if (device < 0 || device >= count) {
+    GetLog() << "ERROR: no CUDA device " << device << " (" << count << " found)\n";
+    return 0;
+  }
+  if (!CheckCuda(cudaSetDevice(device), "cannot select the CUDA device"))
+    return 0;
+
+  cudaStream_t stream;
+  cudaEvent_t done;
+  if (!CheckCuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cannot create a CUDA stream"))
+    return 0;
+  if (!CheckCuda(cudaEventCreateWithFlags(&done, cudaEventDisableTiming), "cannot create a CUDA event")) {
+    cudaStreamDestroy(stream);
+    return 0;
+  }
+
+  ChPacejkaBatchDevice* dev = new ChPacejkaBatchDevice;
+  dev->m_device = device;
+  dev->m_stream = stream;
+  dev->m_done = done;
+
+  return dev;
+}
+
+ChPacejkaBatchDevice::~ChPacejkaBatchDevice()
+{
+  cudaSetDevice(m_device);
+  Wait();
+  cudaFree(m_dev_par);
+  cudaFree(m_dev_lanes);
+  cudaEventDestroy((cudaEvent_t)m_done);
+  cudaStreamDestroy((cudaStream_t)m_stream);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+double* ChPacejkaBatchDevice::AllocHost(size_t count)
+{
+  void* ptr = 0;
+  cudaSetDevice(m_device);
+  if (!CheckCuda(cudaHostAlloc(&ptr, count * sizeof(double), cudaHostAllocPortable), "cannot allocate page-locked memory"))
+    return 0;
+  return static_cast<double*>(ptr);
+}
+
+void ChPacejkaBatchDevice::FreeHost(double* ptr)
+{
+  if (ptr)
+    cudaFreeHost(ptr);
+}
+
+bool ChPacejkaBatchDevice::SetParams(const double* par, int stride)
+{
+  cudaSetDevice(m_device);
+  Wait();
+
+  if (stride != m_stride) {
+    cudaFree(m_dev_par);
+    cudaFree(m_dev_lanes);
+    m_dev_par = 0;
+    m_dev_lanes = 0;
+    m_stride = 0;
+    size_t par_size = (size_t)ChPacejkaBatchLanes::NUM_PARAMS * stride * sizeof(double);
+    size_t lane_size = (size_t)ChPacejkaBatchLanes::NUM_LANE_SLOTS * stride * sizeof(double);
+    if (!CheckCuda(cudaMalloc((void**)&m_dev_par, par_size), "cannot allocate the tire parameters") ||
+        !CheckCuda(cudaMalloc((void**)&m_dev_lanes, lane_size), "cannot allocate the tire lanes")) {
+      cudaFree(m_dev_par);
+      m_dev_par = 0;
+      return false;
+    }
+    m_stride = stride;
+  }
+
+  size_t par_size = (size_t)ChPacejkaBatchLanes::NUM_PARAMS * stride * sizeof(double);
+  return CheckCuda(cudaMemcpy(m_dev_par, par, par_size, cudaMemcpyHostToDevice), "cannot copy the tire parameters");
+}
+
+// -----------------------------------------------------------------------------
+// The inputs and the outputs are contiguous ranges of the lane data (see
+// ChPacejkaBatchLanes), each transferred with a single copy.
+// -----------------------------------------------------------------------------
+void ChPacejkaBatchDevice::Launch(double* lanes, int n, bool fast_math)
+{
+  if (n <= 0 || !m_dev_lanes)
+    return;
+
+  cudaSetDevice(m_device);
+  cudaStream_t stream = (cudaStream_t)m_stream;
+
+  size_t stride = (size_t)m_stride;
+  size_t in_size = ChPacejkaBatchLanes::NUM_LANE_INPUTS * stride * sizeof(double);
+  size_t out_offset = ChPacejkaBatchLanes::FIRST_LANE_OUTPUT * stride;
+  size_t out_size = (ChPacejkaBatchLanes::NUM_LANE_SLOTS - ChPacejkaBatchLanes::FIRST_LANE_OUTPUT) * stride * sizeof(double);
+
+  cudaMemcpyAsync(m_dev_lanes, lanes, in_size, cudaMemcpyHostToDevice, stream);
+
+  ChPacejkaBatchLanes dev_lanes;
+  dev_lanes.par = m_dev_par;
+  dev_lanes.lanes = m_dev_lanes;
+  dev_lanes.stride = m_stride;
+
+  int blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  if (fast_math)
+    PacejkaBatchKernel<ChFastMath><<<blocks, BLOCK_SIZE, 0, stream>>>(dev_lanes, n);
+  else
+    PacejkaBatchKernel<ChStdMath><<<blocks, BLOCK_SIZE, 0, stream>>>(dev_lanes, n);
+
+  cudaMemcpyAsync(lanes + out_offset, m_dev_lanes + out_offset, out_size, cudaMemcpyDeviceToHost, stream);
+  cudaEventRecord((cudaEvent_t)m_done, stream);
+
+  m_pending = true;
+}
+
+bool ChPacejkaBatchDevice::Wait()
+{
+  if (!m_pending)
+    return true;
+
+  m_pending = false;
+  return CheckCuda(cudaEventSynchronize((cudaEvent_t)m_done), "tire batch evaluation failed");
+}
+
+
+} // end namespace chrono
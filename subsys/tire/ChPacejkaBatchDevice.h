@@ -0,0 +1,93 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// CUDA evaluation of the lane kernels of a batch of Pacejka tires (see
+// ChPacejkaTireBatch and ChPacejkaBatchKernels.h). Only available if the
+// library was built with ENABLE_TIRE_CUDA.
+//
+// The host lane data is allocated in page-locked memory, so that the copies to
+// and from the device are asynchronous. A launch queues, on a stream of its
+// own, the upload of the lane inputs, the kernel (one thread per lane) and
+// the download of the lane outputs, and returns at once; Wait() blocks until
+// the outputs are back in the host lane data.
+//
+// The device evaluates the same expressions as the host loops, but its math
+// functions and fused multiply-adds round differently: the reactions agree
+// with those of the host evaluation to round-off, not bitwise.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKA_BATCH_DEVICE_H
+#define CH_PACEJKA_BATCH_DEVICE_H
+
+#include <cstddef>
+
+#include "subsys/tire/ChPacejkaBatchKernels.h"
+
+namespace chrono {
+
+///
+/// CUDA evaluator of the lanes of a Pacejka tire batch.
+///
+class ChPacejkaBatchDevice
+{
+public:
+
+  /// Create an evaluator on the specified CUDA device.
+  /// Returns NULL (and reports the error) if the device cannot be used.
+  static ChPacejkaBatchDevice* Create(int device);
+
+  ~ChPacejkaBatchDevice();
+
+  /// Allocate page-locked host memory for the specified number of values.
+  /// Returns NULL if the allocation fails.
+  double* AllocHost(size_t count);
+
+  /// Free host memory returned by AllocHost().
+  void FreeHost(double* ptr);
+
+  /// Copy the parameters of the batch to the device (synchronous), and size
+  /// the device lane data for the same stride.
+  /// Returns false if the device memory cannot be allocated.
+  bool SetParams(const double* par, int stride);
+
+  /// Queue the evaluation of the first n lanes of the host lane data (which
+  /// must have been returned by AllocHost(), with the stride of the last call
+  /// to SetParams()) and return.
+  void Launch(double* lanes, int n, bool fast_math);
+
+  /// Wait for the outputs of the last launch.
+  /// Returns false if the evaluation failed.
+  bool Wait();
+
+private:
+
+  ChPacejkaBatchDevice();
+  ChPacejkaBatchDevice(const ChPacejkaBatchDevice&);
+  ChPacejkaBatchDevice& operator=(const ChPacejkaBatchDevice&);
+
+  int     m_device;
+  void*   m_stream;       // cudaStream_t
+  void*   m_done;         // cudaEvent_t, recorded after the download
+  double* m_dev_par;
+  double* m_dev_lanes;
+  int     m_stride;
+  bool    m_pending;
+};
+
+
+} // end namespace chrono
+
+
+#endif
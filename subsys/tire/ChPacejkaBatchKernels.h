@@ -0,0 +1,628 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Lane layout and per-lane kernels of the batched Pacejka tire evaluation
+// (see ChPacejkaTireBatch).
+//
+// The lane data of a batch is stored in two blocks of arrays, one array per
+// quantity, all with the same stride (the capacity of the batch): the
+// parameters, set when tires are added, and the per-step lane data. The
+// per-step arrays are ordered such that the inputs and the outputs of the
+// kernels are two contiguous ranges (overlapping on the slips, which are both),
+// so each can be transferred with a single copy (see ChPacejkaBatchDevice).
+//
+// The kernels evaluate one lane and are called in loops over all lanes on the
+// host, and from the CUDA kernels on the device; they are compiled by both
+// compilers and must not use anything but the lane data and ChFastMath.h.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKA_BATCH_KERNELS_H
+#define CH_PACEJKA_BATCH_KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "subsys/tire/ChFastMath.h"
+
+// The kernels are inlined in the lane loops, which could not be vectorized
+// otherwise (they are too large for the default inlining heuristics).
+#if defined(__CUDACC__)
+#define CH_PACBATCH_INLINE __forceinline__
+#elif defined(_MSC_VER)
+#define CH_PACBATCH_INLINE __forceinline
+#elif defined(__GNUC__)
+#define CH_PACBATCH_INLINE inline __attribute__((always_inline))
+#else
+#define CH_PACBATCH_INLINE inline
+#endif
+
+namespace chrono {
+
+///
+/// Lane data of a batch of Pacejka tires and the per-lane kernels, in the
+/// specified precision (see ChPacejkaBatchLanes and ChPacejkaBatchLanesF).
+///
+template <typename Real>
+struct ChPacejkaBatchLanesT
+{
+  /// Per-lane constant parameters.
+  enum ParamSlot {
+    P_FNOMIN, P_R0,
+    // longitudinal, pure slip
+    P_PCX1, P_PDX1, P_PDX2, P_PDX3, P_PEX1, P_PEX2, P_PEX3, P_PEX4,
+    P_PKX1, P_PKX2, P_PKX3, P_PHX1, P_PHX2, P_PVX1, P_PVX2,
+    // longitudinal, combined slip
+    P_RBX1, P_RBX2, P_RCX1, P_REX1, P_REX2, P_RHX1,
+    // lateral, pure slip
+    P_PCY1, P_PDY1, P_PDY2, P_PDY3, P_PEY1, P_PEY2, P_PEY3, P_PEY4,
+    P_PKY1, P_PKY2, P_PKY3, P_PHY1, P_PHY2, P_PHY3, P_PVY1, P_PVY2, P_PVY3, P_PVY4,
+    // lateral, combined slip
+    P_RBY1, P_RBY2, P_RBY3, P_RCY1, P_REY1, P_REY2, P_RHY1, P_RHY2,
+    P_RVY1, P_RVY2, P_RVY3, P_RVY4, P_RVY5, P_RVY6,
+    // aligning
+    P_QBZ1, P_QBZ2, P_QBZ3, P_QBZ4, P_QBZ5, P_QBZ9, P_QBZ10, P_QCZ1,
+    P_QDZ1, P_QDZ2, P_QDZ3, P_QDZ4, P_QDZ6, P_QDZ7, P_QDZ8, P_QDZ9,
+    P_QEZ1, P_QEZ2, P_QEZ3, P_QEZ4, P_QEZ5, P_QHZ1, P_QHZ2, P_QHZ3, P_QHZ4,
+    P_SSZ1, P_SSZ2, P_SSZ3, P_SSZ4,
+    // scaling
+    P_LCX, P_LMUX, P_LEX, P_LKX, P_LHX, P_LVX, P_LCY, P_LMUY, P_LEY, P_LKY,
+    P_LHY, P_LVY, P_LTR, P_LRES, P_LXAL, P_LYKA, P_LVYKA, P_LS,
+    // spin slip
+    P_Z0, P_Z1, P_Z2, P_Z3, P_Z4, P_Z5, P_Z6, P_Z7, P_Z8,
+    // low speed damping
+    P_LONGVL,
+    NUM_PARAMS
+  };
+
+  /// Per-step lane data.
+  enum LaneSlot {
+    // inputs
+    L_FZ, L_DF_Z, L_COS_ALPHA, L_V_CX, L_SAME_SIDE, L_MU_SCALE,
+    L_UV_MASK, L_IN_CONTACT, L_V_SX, L_V_SY, L_PSI_DOT, L_U, L_V_ALPHA, L_V_GAMMA, L_V_PHI,
+    L_SIGMA_KAPPA, L_SIGMA_ALPHA, L_C_FKAPPA, L_C_FALPHA, L_C_FGAMMA, L_C_FPHI,
+    L_BESSEL_CX, L_BESSEL_CY, L_BESSEL_V_LOW,
+    // slips, inputs and outputs (kinematic or transient)
+    L_KAPPAP, L_ALPHAP, L_GAMMAP,
+    // outputs of the low speed slip blending
+    L_PHIP, L_PHIT, L_U_BESSEL, L_U_SIGMA, L_V_BESSEL, L_V_SIGMA,
+    // reactions
+    L_FX_PURE, L_FY_PURE, L_MZ_PURE, L_FX_COMBINED, L_FY_COMBINED, L_MZ_COMBINED,
+    // intermediate coefficients needed by the tires after the evaluation
+    L_MU_Y, L_D_Y, L_K_X, L_K_Y, L_MP_Z, L_M_ZR_PURE, L_S, L_T, L_ALPHA_R_EQ,
+    L_M_ZR, L_M_Z_X, L_M_Z_Y,
+    NUM_LANE_SLOTS
+  };
+
+  /// Ranges of the kernel inputs and outputs in the per-step lane data.
+  enum {
+    NUM_LANE_INPUTS = L_PHIP,           ///< slots [0, NUM_LANE_INPUTS) are read
+    FIRST_LANE_OUTPUT = L_KAPPAP        ///< slots [FIRST_LANE_OUTPUT, NUM_LANE_SLOTS) are written
+  };
+
+  const Real*   par;      ///< parameters, NUM_PARAMS arrays
+  Real*         lanes;    ///< per-step lane data, NUM_LANE_SLOTS arrays
+  int           stride;   ///< length of each array (at least the number of lanes)
+
+  CH_TIRE_HOSTDEVICE const Real* Param(int slot) const { return par + (size_t)slot * stride; }
+  CH_TIRE_HOSTDEVICE Real* Lane(int slot) const { return lanes + (size_t)slot * stride; }
+
+  /// Low speed slip blending of lane i.
+  /// This is the lane-wise equivalent of ChPacejkaTire::slip_from_uv(). Both
+  /// forms of the Besselink damping (cosine blend below V_low, exponential
+  /// decay above) are evaluated and the one to use is selected with a mask, as
+  /// is the clamping of the damped slips. Lanes of tires without transient
+  /// slips keep the kinematic slips.
+  CH_TIRE_HOSTDEVICE CH_PACBATCH_INLINE void BlendSlips(int i) const
+  {
+    const Real pi = Real(3.14159265358979323846);
+
+    const Real* longvl = Param(P_LONGVL);
+
+    const Real* mask = Lane(L_UV_MASK);
+    const Real* contact = Lane(L_IN_CONTACT);
+    const Real* V_cx = Lane(L_V_CX);
+    const Real* V_sx = Lane(L_V_SX);
+    const Real* V_sy = Lane(L_V_SY);
+    const Real* psi_dot = Lane(L_PSI_DOT);
+    const Real* side = Lane(L_SAME_SIDE);
+    const Real* u = Lane(L_U);
+    const Real* v_alpha = Lane(L_V_ALPHA);
+    const Real* v_gamma = Lane(L_V_GAMMA);
+    const Real* v_phi = Lane(L_V_PHI);
+    const Real* sigma_kappa = Lane(L_SIGMA_KAPPA);
+    const Real* sigma_alpha = Lane(L_SIGMA_ALPHA);
+    const Real* C_Fkappa = Lane(L_C_FKAPPA);
+    const Real* C_Falpha = Lane(L_C_FALPHA);
+    const Real* C_Fgamma = Lane(L_C_FGAMMA);
+    const Real* C_Fphi = Lane(L_C_FPHI);
+    const Real* bessel_Cx = Lane(L_BESSEL_CX);
+    const Real* bessel_Cy = Lane(L_BESSEL_CY);
+    const Real* V_low = Lane(L_BESSEL_V_LOW);
+
+    Real* kappaP = Lane(L_KAPPAP);
+    Real* alphaP = Lane(L_ALPHAP);
+    Real* gammaP = Lane(L_GAMMAP);
+    Real* phiP = Lane(L_PHIP);
+    Real* phiT = Lane(L_PHIT);
+    Real* out_u_Bessel = Lane(L_U_BESSEL);
+    Real* out_u_sigma = Lane(L_U_SIGMA);
+    Real* out_v_Bessel = Lane(L_V_BESSEL);
+    Real* out_v_sigma = Lane(L_V_SIGMA);
+
+    Real V_cx_abs = std::abs(V_cx[i]);
+
+    // damping factor, between 2 and 1 for V_cx in (0, V_low) when in contact
+    Real low = ((V_cx_abs <= V_low[i]) ? Real(1.0) : Real(0.0)) * contact[i];
+    Real d_low = Real(1.0) + std::cos(pi * V_cx_abs / Real(2.0) * V_low[i]);
+    Real d_high = std::exp(-(V_cx_abs - V_low[i]) / longvl[i]);
+    Real d = (low != 0) ? d_low : d_high;
+    Real d_Vxlow = bessel_Cx[i] * d;
+    Real d_Vylow = bessel_Cy[i] * d;
+
+    // longitudinal; damping may not switch the sign of kappa
+    Real u_sigma = u[i] / sigma_kappa[i];
+    Real u_Bessel = d_Vxlow * V_sx[i] / C_Fkappa[i];
+    Real kappa_p = u_sigma - u_Bessel;
+    kappa_p = (u_sigma * kappa_p < 0) ? Real(0.0) : kappa_p;
+
+    // lateral; damping may not switch the sign of alpha
+    Real v_sigma = -v_alpha[i] / sigma_alpha[i];
+    Real v_Bessel = -d_Vylow * V_sy[i] * side[i] / C_Falpha[i];
+    Real alpha_p = v_sigma - v_Bessel;
+    alpha_p = (v_sigma * alpha_p < 0) ? Real(0.0) : alpha_p;
+
+    // camber and turn slip, not damped
+    Real gamma_p = C_Falpha[i] * v_gamma[i] / (C_Fgamma[i] * sigma_alpha[i]);
+    Real phi_p = (C_Falpha[i] * v_phi[i]) / (C_Fphi[i] * sigma_alpha[i]);
+    Real phi_t = -psi_dot[i] / V_cx[i];
+
+    bool transient = (mask[i] != 0);
+    kappaP[i] = transient ? kappa_p : kappaP[i];
+    alphaP[i] = transient ? alpha_p : alphaP[i];
+    gammaP[i] = transient ? gamma_p : gammaP[i];
+    phiP[i] = phi_p;
+    phiT[i] = phi_t;
+    out_u_Bessel[i] = u_Bessel;
+    out_u_sigma[i] = u_sigma;
+    out_v_Bessel[i] = v_Bessel;
+    out_v_sigma[i] = v_sigma;
+  }
+
+  /// Magic Formula of lane i.
+  /// This is the lane-wise equivalent of ChPacejkaTire::pureSlipReactions()
+  /// and ChPacejkaTire::combinedSlipReactions(). Sign switches are written as
+  /// selects so that the lane loops have no branches. The transcendental
+  /// functions are provided by the MATH policy (ChStdMath or ChFastMath).
+  template <class MATH>
+  CH_TIRE_HOSTDEVICE CH_PACBATCH_INLINE void Evaluate(int i) const
+  {
+    const Real pi = Real(3.14159265358979323846);
+
+    const Real* fnomin = Param(P_FNOMIN);
+    const Real* R0 = Param(P_R0);
+
+    const Real* pcx1 = Param(P_PCX1);
+    const Real* pdx1 = Param(P_PDX1);
+    const Real* pdx2 = Param(P_PDX2);
+    const Real* pdx3 = Param(P_PDX3);
+    const Real* pex1 = Param(P_PEX1);
+    const Real* pex2 = Param(P_PEX2);
+    const Real* pex3 = Param(P_PEX3);
+    const Real* pex4 = Param(P_PEX4);
+    const Real* pkx1 = Param(P_PKX1);
+    const Real* pkx2 = Param(P_PKX2);
+    const Real* pkx3 = Param(P_PKX3);
+    const Real* phx1 = Param(P_PHX1);
+    const Real* phx2 = Param(P_PHX2);
+    const Real* pvx1 = Param(P_PVX1);
+    const Real* pvx2 = Param(P_PVX2);
+
+    const Real* rbx1 = Param(P_RBX1);
+    const Real* rbx2 = Param(P_RBX2);
+    const Real* rcx1 = Param(P_RCX1);
+    const Real* rex1 = Param(P_REX1);
+    const Real* rex2 = Param(P_REX2);
+    const Real* rhx1 = Param(P_RHX1);
+
+    const Real* pcy1 = Param(P_PCY1);
+    const Real* pdy1 = Param(P_PDY1);
+    const Real* pdy2 = Param(P_PDY2);
+    const Real* pdy3 = Param(P_PDY3);
+    const Real* pey1 = Param(P_PEY1);
+    const Real* pey2 = Param(P_PEY2);
+    const Real* pey3 = Param(P_PEY3);
+    const Real* pey4 = Param(P_PEY4);
+    const Real* pky1 = Param(P_PKY1);
+    const Real* pky2 = Param(P_PKY2);
+    const Real* pky3 = Param(P_PKY3);
+    const Real* phy1 = Param(P_PHY1);
+    const Real* phy2 = Param(P_PHY2);
+    const Real* phy3 = Param(P_PHY3);
+    const Real* pvy1 = Param(P_PVY1);
+    const Real* pvy2 = Param(P_PVY2);
+    const Real* pvy3 = Param(P_PVY3);
+    const Real* pvy4 = Param(P_PVY4);
+
+    const Real* rby1 = Param(P_RBY1);
+    const Real* rby2 = Param(P_RBY2);
+    const Real* rby3 = Param(P_RBY3);
+    const Real* rcy1 = Param(P_RCY1);
+    const Real* rey1 = Param(P_REY1);
+    const Real* rey2 = Param(P_REY2);
+    const Real* rhy1 = Param(P_RHY1);
+    const Real* rhy2 = Param(P_RHY2);
+    const Real* rvy1 = Param(P_RVY1);
+    const Real* rvy2 = Param(P_RVY2);
+    const Real* rvy3 = Param(P_RVY3);
+    const Real* rvy4 = Param(P_RVY4);
+    const Real* rvy5 = Param(P_RVY5);
+    const Real* rvy6 = Param(P_RVY6);
+
+    const Real* qbz1 = Param(P_QBZ1);
+    const Real* qbz2 = Param(P_QBZ2);
+    const Real* qbz3 = Param(P_QBZ3);
+    const Real* qbz4 = Param(P_QBZ4);
+    const Real* qbz5 = Param(P_QBZ5);
+    const Real* qbz9 = Param(P_QBZ9);
+    const Real* qbz10 = Param(P_QBZ10);
+    const Real* qcz1 = Param(P_QCZ1);
+    const Real* qdz1 = Param(P_QDZ1);
+    const Real* qdz2 = Param(P_QDZ2);
+    const Real* qdz3 = Param(P_QDZ3);
+    const Real* qdz4 = Param(P_QDZ4);
+    const Real* qdz6 = Param(P_QDZ6);
+    const Real* qdz7 = Param(P_QDZ7);
+    const Real* qdz8 = Param(P_QDZ8);
+    const Real* qdz9 = Param(P_QDZ9);
+    const Real* qez1 = Param(P_QEZ1);
+    const Real* qez2 = Param(P_QEZ2);
+    const Real* qez3 = Param(P_QEZ3);
+    const Real* qez4 = Param(P_QEZ4);
+    const Real* qez5 = Param(P_QEZ5);
+    const Real* qhz1 = Param(P_QHZ1);
+    const Real* qhz2 = Param(P_QHZ2);
+    const Real* qhz3 = Param(P_QHZ3);
+    const Real* qhz4 = Param(P_QHZ4);
+    const Real* ssz1 = Param(P_SSZ1);
+    const Real* ssz2 = Param(P_SSZ2);
+    const Real* ssz3 = Param(P_SSZ3);
+    const Real* ssz4 = Param(P_SSZ4);
+
+    const Real* lcx = Param(P_LCX);
+    const Real* lmux = Param(P_LMUX);
+    const Real* lex = Param(P_LEX);
+    const Real* lkx = Param(P_LKX);
+    const Real* lhx = Param(P_LHX);
+    const Real* lvx = Param(P_LVX);
+    const Real* lcy = Param(P_LCY);
+    const Real* lmuy = Param(P_LMUY);
+    const Real* ley = Param(P_LEY);
+    const Real* lky = Param(P_LKY);
+    const Real* lhy = Param(P_LHY);
+    const Real* lvy = Param(P_LVY);
+    const Real* ltr = Param(P_LTR);
+    const Real* lres = Param(P_LRES);
+    const Real* lxal = Param(P_LXAL);
+    const Real* lyka = Param(P_LYKA);
+    const Real* lvyka = Param(P_LVYKA);
+    const Real* ls = Param(P_LS);
+
+    const Real* z0 = Param(P_Z0);
+    const Real* z1 = Param(P_Z1);
+    const Real* z2 = Param(P_Z2);
+    const Real* z3 = Param(P_Z3);
+    const Real* z4 = Param(P_Z4);
+    const Real* z5 = Param(P_Z5);
+    const Real* z6 = Param(P_Z6);
+    const Real* z7 = Param(P_Z7);
+    const Real* z8 = Param(P_Z8);
+
+    const Real* Fz = Lane(L_FZ);
+    const Real* dFz = Lane(L_DF_Z);
+    const Real* kappaP = Lane(L_KAPPAP);
+    const Real* alphaP = Lane(L_ALPHAP);
+    const Real* gammaP = Lane(L_GAMMAP);
+    const Real* cosP = Lane(L_COS_ALPHA);
+    const Real* V_cx = Lane(L_V_CX);
+    const Real* side = Lane(L_SAME_SIDE);
+    const Real* mu_scale = Lane(L_MU_SCALE);
+
+    Real* Fx_pure = Lane(L_FX_PURE);
+    Real* Fy_pure = Lane(L_FY_PURE);
+    Real* Mz_pure = Lane(L_MZ_PURE);
+    Real* Fx_comb = Lane(L_FX_COMBINED);
+    Real* Fy_comb = Lane(L_FY_COMBINED);
+    Real* Mz_comb = Lane(L_MZ_COMBINED);
+
+    Real* out_mu_y = Lane(L_MU_Y);
+    Real* out_D_y = Lane(L_D_Y);
+    Real* out_K_x = Lane(L_K_X);
+    Real* out_K_y = Lane(L_K_Y);
+    Real* out_MP_z = Lane(L_MP_Z);
+    Real* out_M_zr_pure = Lane(L_M_ZR_PURE);
+    Real* out_s = Lane(L_S);
+    Real* out_t = Lane(L_T);
+    Real* out_alpha_r_eq = Lane(L_ALPHA_R_EQ);
+    Real* out_M_zr = Lane(L_M_ZR);
+    Real* out_M_z_x = Lane(L_M_Z_X);
+    Real* out_M_z_y = Lane(L_M_Z_Y);
+
+    Real kappa = kappaP[i];
+    Real alpha = alphaP[i];
+    Real gamma = gammaP[i];
+    Real dF = dFz[i];
+    Real dF2 = dF * dF;
+    Real gamma2 = gamma * gamma;
+    Real gamma_abs = std::abs(gamma);
+    Real lmux_i = lmux[i] * mu_scale[i];
+    Real lmuy_i = lmuy[i] * mu_scale[i];
+
+    // Fx, pure longitudinal slip (see ChPacejkaTire::Fx_pureLong)
+    Real S_Hx = (phx1[i] + phx2[i] * dF) * lhx[i];
+    Real kappa_x = kappa + S_Hx;
+    Real mu_x = (pdx1[i] + pdx2[i] * dF) * (Real(1.0) - pdx3[i] * gamma2) * lmux_i;
+    Real K_x = Fz[i] * (pkx1[i] + pkx2[i] * dF) * std::exp(pkx3[i] * dF) * lkx[i];
+    Real C_x = pcx1[i] * lcx[i];
+    Real D_x = mu_x * Fz[i] * z1[i];
+    Real B_x = K_x / (C_x * D_x);
+    Real sign_kap = (kappa_x >= 0) ? Real(1.0) : -Real(1.0);
+    Real E_x = (pex1[i] + pex2[i] * dF + pex3[i] * dF2) * (Real(1.0) - pex4[i] * sign_kap) * lex[i];
+    Real S_Vx = Fz[i] * (pvx1[i] + pvx2[i] * dF) * lvx[i] * lmux_i * z1[i];
+    Real Bx_k = B_x * kappa_x;
+    Real F_x = D_x * MATH::sin(C_x * MATH::atan(Bx_k - E_x * (Bx_k - MATH::atan(Bx_k)))) - S_Vx;
+
+    // Fy, pure lateral slip (see ChPacejkaTire::Fy_pureLat)
+    Real C_y = pcy1[i] * lcy[i];
+    Real mu_y = (pdy1[i] + pdy2[i] * dF) * (Real(1.0) - pdy3[i] * gamma2) * lmuy_i;
+    Real D_y = mu_y * Fz[i] * z2[i];
+    Real K_y = pky1[i] * fnomin[i] * MATH::sin(Real(2.0) * MATH::atan(Fz[i] / (pky2[i] * fnomin[i]))) * (Real(1.0) - pky3[i] * gamma_abs) * z3[i] * lyka[i];
+    Real B_y = K_y / (C_y * D_y);
+    Real S_Hy = (phy1[i] + phy2[i] * dF) * lhy[i] + (phy3[i] * gamma * z0[i]) + z4[i] - Real(1.0);
+    Real alpha_y = alpha + S_Hy;
+    Real sign_alpha = (alpha_y >= 0) ? Real(1.0) : -Real(1.0);
+    Real E_y = (pey1[i] + pey2[i] * dF) * (Real(1.0) - (pey3[i] + pey4[i] * gamma) * sign_alpha) * ley[i];
+    Real S_Vy = Fz[i] * ((pvy1[i] + pvy2[i] * dF) * lvy[i] + (pvy3[i] + pvy4[i] * dF) * gamma) * lmuy_i * z2[i];
+    Real By_a = B_y * alpha_y;
+    Real F_y = D_y * MATH::sin(C_y * MATH::atan(By_a - E_y * (By_a - MATH::atan(By_a)))) + S_Vy;
+
+    // Mz, pure lateral slip (see ChPacejkaTire::Mz_pureLat)
+    Real sign_Vx = (V_cx[i] >= 0) ? Real(1.0) : -Real(1.0);
+    Real S_Hf = S_Hy + S_Vy / K_y;
+    Real alpha_r = alpha + S_Hf;
+    Real S_Ht = qhz1[i] + qhz2[i] * dF + (qhz3[i] + qhz4[i] * dF) * gamma;
+    Real alpha_t = alpha + S_Ht;
+    Real B_r = (qbz9[i] * (lky[i] / lmuy_i) + qbz10[i] * B_y * C_y) * z6[i];
+    Real C_r = z7[i];
+    Real D_r = Fz[i] * R0[i] * ((qdz6[i] + qdz7[i] * dF) * lres[i] + (qdz8[i] + qdz9[i] * dF) * gamma) * lmuy_i * cosP[i] * sign_Vx + z8[i] - Real(1.0);
+    Real B_t = (qbz1[i] + qbz2[i] * dF + qbz3[i] * dF2) * (Real(1.0) + qbz4[i] * gamma + qbz5[i] * gamma_abs) * lvyka[i] / lmuy_i;
+    Real C_t = qcz1[i];
+    Real D_t0 = Fz[i] * (R0[i] / fnomin[i]) * (qdz1[i] + qdz2[i] * dF) * sign_Vx;
+    Real D_t = D_t0 * (Real(1.0) + qdz3[i] * gamma_abs + qdz4[i] * gamma2) * z5[i] * ltr[i];
+    Real E_t = (qez1[i] + qez2[i] * dF + qez3[i] * dF2) * (Real(1.0) + (qez4[i] + qez5[i] * gamma) * (Real(2.0) / pi) * MATH::atan(B_t * C_t * alpha_t));
+    Real Bt_a = B_t * alpha_t;
+    Real t_pure = D_t * MATH::cos(C_t * MATH::atan(Bt_a - E_t * (Bt_a - MATH::atan(Bt_a)))) * cosP[i];
+    Real MP_z = -t_pure * F_y;
+    Real M_zr_pure = D_r * MATH::cos(C_r * MATH::atan(B_r * alpha_r));
+    Real M_z_pure = MP_z + M_zr_pure;
+
+    // Fx, combined slip (see ChPacejkaTire::Fx_combined)
+    Real S_HxAlpha = rhx1[i];
+    Real alpha_S = alpha + S_HxAlpha;
+    Real B_xAlpha = (rbx1[i] + gamma2) * MATH::cos(MATH::atan(rbx2[i] * kappa)) * lxal[i];
+    Real C_xAlpha = rcx1[i];
+    Real E_xAlpha = rex1[i] + rex2[i] * dF;
+    Real Bxa_S = B_xAlpha * S_HxAlpha;
+    Real G_xAlpha0 = MATH::cos(C_xAlpha * MATH::atan(Bxa_S - E_xAlpha * (Bxa_S - MATH::atan(Bxa_S))));
+    Real Bxa_a = B_xAlpha * alpha_S;
+    Real G_xAlpha = MATH::cos(C_xAlpha * MATH::atan(Bxa_a - E_xAlpha * (Bxa_a - MATH::atan(Bxa_a)))) / G_xAlpha0;
+    Real F_xc = G_xAlpha * F_x;
+
+    // Fy, combined slip (see ChPacejkaTire::Fy_combined)
+    Real S_HyKappa = rhy1[i] + rhy2[i] * dF;
+    Real kappa_S = kappa + S_HyKappa;
+    Real B_yKappa = rby1[i] * MATH::cos(MATH::atan(rby2[i] * (alpha - rby3[i]))) * lyka[i];
+    Real C_yKappa = rcy1[i];
+    Real E_yKappa = rey1[i] + rey2[i] * dF;
+    Real D_VyKappa = mu_y * Fz[i] * (rvy1[i] + rvy2[i] * dF + rvy3[i] * gamma) * MATH::cos(MATH::atan(rvy4[i] * alpha)) * z2[i];
+    Real S_VyKappa = D_VyKappa * MATH::sin(rvy5[i] * MATH::atan(rvy6[i] * kappa)) * lvyka[i];
+    Real Byk_S = B_yKappa * S_HyKappa;
+    Real G_yKappa0 = MATH::cos(C_yKappa * MATH::atan(Byk_S - E_yKappa * (Byk_S - MATH::atan(Byk_S))));
+    Real Byk_k = B_yKappa * kappa_S;
+    Real G_yKappa = MATH::cos(C_yKappa * MATH::atan(Byk_k - E_yKappa * (Byk_k - MATH::atan(Byk_k)))) / G_yKappa0;
+    Real F_yc = G_yKappa * F_y + S_VyKappa;
+
+    // Mz, combined slip (see ChPacejkaTire::Mz_combined)
+    Real FP_y = F_yc - S_VyKappa;
+    Real s = R0[i] * (ssz1[i] + ssz2[i] * (F_yc / fnomin[i]) + (ssz3[i] + ssz4[i] * dF) * gamma) * ls[i];
+    Real sign_alpha_t = (alpha_t >= 0) ? Real(1.0) : -Real(1.0);
+    Real sign_alpha_r = (alpha_r >= 0) ? Real(1.0) : -Real(1.0);
+    Real K_ratio = K_x / K_y;
+    Real kappa_term = K_ratio * K_ratio * kappa * kappa;
+    Real alpha_t_eq = sign_alpha_t * std::sqrt(alpha_t * alpha_t + kappa_term);
+    Real alpha_r_eq = sign_alpha_r * std::sqrt(alpha_r * alpha_r + kappa_term);
+    Real M_zr = D_r * MATH::cos(C_r * MATH::atan(B_r * alpha_r_eq)) * cosP[i];
+    Real Bt_aeq = B_t * alpha_t_eq;
+    Real t = D_t * MATH::cos(C_t * MATH::atan(Bt_aeq - E_t * (Bt_aeq - MATH::atan(Bt_aeq)))) * cosP[i];
+    Real M_z_y = -t * FP_y;
+    Real M_z_x = s * F_xc;
+    Real M_zc = M_z_y + M_zr + M_z_x;
+
+    // Store results, accounting for the tire side
+    Fx_pure[i] = F_x;
+    Fy_pure[i] = side[i] * F_y;
+    Mz_pure[i] = side[i] * M_z_pure;
+    Fx_comb[i] = F_xc;
+    Fy_comb[i] = side[i] * F_yc;
+    Mz_comb[i] = side[i] * M_zc;
+
+    out_mu_y[i] = mu_y;
+    out_D_y[i] = D_y;
+    out_K_x[i] = K_x;
+    out_K_y[i] = K_y;
+    out_MP_z[i] = MP_z;
+    out_M_zr_pure[i] = M_zr_pure;
+    out_s[i] = s;
+    out_t[i] = t;
+    out_alpha_r_eq[i] = alpha_r_eq;
+    out_M_zr[i] = M_zr;
+    out_M_z_x[i] = M_z_x;
+    out_M_z_y[i] = M_z_y;
+  }
+
+  /// Status of an inverse slip problem (see InverseSlip).
+  enum SlipStatus {
+    SLIP_CONVERGED,     ///< slip found to the tolerance
+    SLIP_SATURATED,     ///< target beyond the peak force, peak slip returned
+    SLIP_FAILED         ///< no solution (e.g. invalid load), zero slip returned
+  };
+
+  /// Inverse pure slip Magic Formula of lane i: find the longitudinal slip
+  /// (lateral = false) or the slip angle (lateral = true), at zero slip in the
+  /// other direction and nominal friction, for which the pure slip force F of
+  /// Evaluate() (before the tire side is applied) at the specified load and
+  /// camber equals the target. The sine and the outer arctangent of the Magic
+  /// Formula are inverted in closed form; the remaining monotone equation in
+  /// the normalized slip u = B * (slip + S_H) is solved by a Newton iteration
+  /// with analytic derivatives, safeguarded by bisection, starting from the
+  /// value of u on input (e.g. the solution of a neighbouring problem; ignored
+  /// if outside the bracket of the root). Targets beyond the peak force get
+  /// the peak slip. On return, u is the solution and stiffness the derivative
+  /// of the force with respect to the slip. Returns a SlipStatus.
+  CH_TIRE_HOSTDEVICE int InverseSlip(int   i,
+                                     bool  lateral,
+                                     Real  F,
+                                     Real  Fz,
+                                     Real  gamma,
+                                     Real  tol,
+                                     int   max_iter,
+                                     Real& u,
+                                     Real& slip,
+                                     Real& stiffness,
+                                     int&  num_iter) const
+  {
+    const Real pi = Real(3.14159265358979323846);
+
+    Real fnomin = Param(P_FNOMIN)[i];
+    Real dF = (Fz - fnomin) / fnomin;
+    Real dF2 = dF * dF;
+    Real gamma2 = gamma * gamma;
+
+    // Magic Formula coefficients: F = D sin(C atan(Bx - E (Bx - atan(Bx)))) + S_V,
+    // with x = slip + S_H and E depending on the sign of x.
+    Real B, C, D, E_pos, E_neg, S_H, S_V;
+    if (!lateral) {
+      Real lmux = Param(P_LMUX)[i];
+      Real z1 = Param(P_Z1)[i];
+      Real mu_x = (Param(P_PDX1)[i] + Param(P_PDX2)[i] * dF) * (Real(1.0) - Param(P_PDX3)[i] * gamma2) * lmux;
+      Real K_x = Fz * (Param(P_PKX1)[i] + Param(P_PKX2)[i] * dF) * std::exp(Param(P_PKX3)[i] * dF) * Param(P_LKX)[i];
+      Real E_x = (Param(P_PEX1)[i] + Param(P_PEX2)[i] * dF + Param(P_PEX3)[i] * dF2) * Param(P_LEX)[i];
+      C = Param(P_PCX1)[i] * Param(P_LCX)[i];
+      D = mu_x * Fz * z1;
+      B = K_x / (C * D);
+      E_pos = E_x * (Real(1.0) - Param(P_PEX4)[i]);
+      E_neg = E_x * (Real(1.0) + Param(P_PEX4)[i]);
+      S_H = (Param(P_PHX1)[i] + Param(P_PHX2)[i] * dF) * Param(P_LHX)[i];
+      S_V = -Fz * (Param(P_PVX1)[i] + Param(P_PVX2)[i] * dF) * Param(P_LVX)[i] * lmux * z1;
+    } else {
+      Real lmuy = Param(P_LMUY)[i];
+      Real z2 = Param(P_Z2)[i];
+      Real mu_y = (Param(P_PDY1)[i] + Param(P_PDY2)[i] * dF) * (Real(1.0) - Param(P_PDY3)[i] * gamma2) * lmuy;
+      Real K_y = Param(P_PKY1)[i] * fnomin * std::sin(Real(2.0) * std::atan(Fz / (Param(P_PKY2)[i] * fnomin))) *
+                 (Real(1.0) - Param(P_PKY3)[i] * std::abs(gamma)) * Param(P_Z3)[i] * Param(P_LYKA)[i];
+      Real E_y = (Param(P_PEY1)[i] + Param(P_PEY2)[i] * dF) * Param(P_LEY)[i];
+      Real E_g = Param(P_PEY3)[i] + Param(P_PEY4)[i] * gamma;
+      C = Param(P_PCY1)[i] * Param(P_LCY)[i];
+      D = mu_y * Fz * z2;
+      B = K_y / (C * D);
+      E_pos = E_y * (Real(1.0) - E_g);
+      E_neg = E_y * (Real(1.0) + E_g);
+      S_H = (Param(P_PHY1)[i] + Param(P_PHY2)[i] * dF) * Param(P_LHY)[i] + Param(P_PHY3)[i] * gamma * Param(P_Z0)[i] +
+            Param(P_Z4)[i] - Real(1.0);
+      S_V = Fz * ((Param(P_PVY1)[i] + Param(P_PVY2)[i] * dF) * Param(P_LVY)[i] + (Param(P_PVY3)[i] + Param(P_PVY4)[i] * dF) * gamma) *
+            lmuy * z2;
+    }
+
+    num_iter = 0;
+    slip = 0;
+    stiffness = 0;
+
+    // The sign of u is that of r, and the sign of x that of u / B (B < 0 for
+    // the usual lateral parameters).
+    Real r = (F - S_V) / D;
+    Real sign = (r >= 0) ? Real(1.0) : -Real(1.0);
+    Real E = ((r >= 0) == (B > 0)) ? E_pos : E_neg;
+
+    // The branch through zero slip is monotone for C > 0 and E < 1; it reaches
+    // the peak D (at C atan(.) = pi/2) only for C > 1.
+    if (!(Fz > 0 && B != 0 && C > 0 && D != 0 && E < Real(1.0)))
+      return SLIP_FAILED;
+
+    int status = SLIP_CONVERGED;
+    Real theta;
+    if (std::abs(r) < ((C > Real(1.0)) ? Real(1.0) : std::sin(C * pi / Real(2.0)))) {
+      theta = std::tan(std::asin(r) / C);
+    } else if (C > Real(1.0)) {
+      theta = sign * std::tan(pi / (Real(2.0) * C));
+      status = SLIP_SATURATED;
+    } else {
+      return SLIP_FAILED;
+    }
+
+    // g(u) = u - E (u - atan(u)) is increasing, and lies between (1 - E) u and
+    // u, so that its root is bracketed by theta and theta / (1 - E).
+    Real lo = theta;
+    Real hi = theta / (Real(1.0) - E);
+    if (lo > hi) {
+      Real tmp = lo;
+      lo = hi;
+      hi = tmp;
+    }
+    if (!(u >= lo && u <= hi))
+      u = theta;
+
+    Real g = u - E * (u - std::atan(u)) - theta;
+    Real g_tol = tol * (Real(1.0) + std::abs(theta));
+    while (std::abs(g) > g_tol && num_iter < max_iter) {
+      if (g > 0)
+        hi = u;
+      else
+        lo = u;
+      Real dg = Real(1.0) - E + E / (Real(1.0) + u * u);
+      Real u_new = u - g / dg;
+      u = (u_new >= lo && u_new <= hi) ? u_new : Real(0.5) * (lo + hi);
+      g = u - E * (u - std::atan(u)) - theta;
+      num_iter++;
+    }
+
+    slip = u / B - S_H;
+    stiffness = D * C * std::cos(C * std::atan(theta)) / (Real(1.0) + theta * theta) *
+                (Real(1.0) - E + E / (Real(1.0) + u * u)) * B;
+
+    return (std::abs(g) > g_tol) ? SLIP_FAILED : status;
+  }
+};
+
+/// Lane data and kernels in double precision (the precision of the tires).
+typedef ChPacejkaBatchLanesT<double> ChPacejkaBatchLanes;
+
+/// Lane data and kernels in single precision (see
+/// ChPacejkaTireBatch::SetSinglePrecision()).
+typedef ChPacejkaBatchLanesT<float>  ChPacejkaBatchLanesF;
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,671 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Identification of Pacejka 2002 Magic Formula coefficients from measured tire
+// data.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cctype>
+#include <cfloat>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChPacejkaFit.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChPac2002_cache.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+
+namespace chrono {
+
+
+typedef ChPacejkaBatchLanes PACFIT_Lanes;
+
+// Names of the Magic Formula coefficients in the *.tir files, in parameter
+// slot order, from P_PCX1 to P_SSZ4.
+static const char* PACFIT_names[] = {
+  "PCX1", "PDX1", "PDX2", "PDX3", "PEX1", "PEX2", "PEX3", "PEX4",
+  "PKX1", "PKX2", "PKX3", "PHX1", "PHX2", "PVX1", "PVX2",
+  "RBX1", "RBX2", "RCX1", "REX1", "REX2", "RHX1",
+  "PCY1", "PDY1", "PDY2", "PDY3", "PEY1", "PEY2", "PEY3", "PEY4",
+  "PKY1", "PKY2", "PKY3", "PHY1", "PHY2", "PHY3", "PVY1", "PVY2", "PVY3", "PVY4",
+  "RBY1", "RBY2", "RBY3", "RCY1", "REY1", "REY2", "RHY1", "RHY2",
+  "RVY1", "RVY2", "RVY3", "RVY4", "RVY5", "RVY6",
+  "QBZ1", "QBZ2", "QBZ3", "QBZ4", "QBZ5", "QBZ9", "QBZ10", "QCZ1",
+  "QDZ1", "QDZ2", "QDZ3", "QDZ4", "QDZ6", "QDZ7", "QDZ8", "QDZ9",
+  "QEZ1", "QEZ2", "QEZ3", "QEZ4", "QEZ5", "QHZ1", "QHZ2", "QHZ3", "QHZ4",
+  "SSZ1", "SSZ2", "SSZ3", "SSZ4"
+};
+
+static const int PACFIT_first = PACFIT_Lanes::P_PCX1;
+static const int PACFIT_last = PACFIT_Lanes::P_SSZ4;
+
+typedef char PACFIT_names_check[(sizeof(PACFIT_names) / sizeof(PACFIT_names[0]) == PACFIT_last - PACFIT_first + 1) ? 1 : -1];
+
+// Relative step of the central differences.
+static const double PACFIT_step = 1e-6;
+
+// Evaluation modes of the tasks.
+enum { PACFIT_RESIDUAL, PACFIT_JACOBIAN };
+
+// Parameter slot of the specified coefficient name (-1 if unknown).
+static int PACFIT_slot(const std::string& name)
+{
+  std::string key;
+  for (size_t k = 0; k < name.size(); k++)
+    key += (char)std::toupper((unsigned char)name[k]);
+
+  for (int slot = PACFIT_first; slot <= PACFIT_last; slot++) {
+    if (key == PACFIT_names[slot - PACFIT_first])
+      return slot;
+  }
+
+  return -1;
+}
+
+// Coefficient group of the specified parameter slot.
+static int PACFIT_group(int slot)
+{
+  if (slot <= PACFIT_Lanes::P_PVX2)
+    return ChPacejkaFit::LONGITUDINAL;
+  if (slot <= PACFIT_Lanes::P_RHX1)
+    return ChPacejkaFit::COMBINED;
+  if (slot <= PACFIT_Lanes::P_PVY4)
+    return ChPacejkaFit::LATERAL;
+  if (slot <= PACFIT_Lanes::P_RVY6)
+    return ChPacejkaFit::COMBINED;
+  if (slot <= PACFIT_Lanes::P_QHZ4)
+    return ChPacejkaFit::ALIGNING;
+  return ChPacejkaFit::COMBINED;
+}
+
+// Solve A x = b, with A symmetric positive definite (n x n, overwritten by
+// its Cholesky factor). Returns false if A is not positive definite.
+static bool PACFIT_solve(std::vector<double>& A, int n, const std::vector<double>& b, std::vector<double>& x)
+{
+  for (int j = 0; j < n; j++) {
+    double d = A[j * n + j];
+    for (int k = 0; k < j; k++)
+      d -= A[j * n + k] * A[j * n + k];
+    if (!(d > 0))
+      return false;
+    d = std::sqrt(d);
+    A[j * n + j] = d;
+    for (int i = j + 1; i < n; i++) {
+      double s = A[i * n + j];
+      for (int k = 0; k < j; k++)
+        s -= A[i * n + k] * A[j * n + k];
+      A[i * n + j] = s / d;
+    }
+  }
+
+  x = b;
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < i; k++)
+      x[i] -= A[i * n + k] * x[k];
+    x[i] /= A[i * n + i];
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    for (int k = i + 1; k < n; k++)
+      x[i] -= A[k * n + i] * x[k];
+    x[i] /= A[i * n + i];
+  }
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Task evaluating one chunk of samples, packed in the lanes of the batched
+// Magic Formula kernels. The residuals of a sample are the scaled errors of
+// its three reactions (zero for the reactions not measured). In Jacobian
+// mode, the task also evaluates the derivatives of its residuals by central
+// differences and adds its rows into its part of the normal equations.
+// -----------------------------------------------------------------------------
+class ChPacejkaFitTask : public vehicle::ChTask
+{
+public:
+  ChPacejkaFitTask(const ChPacejkaFit* fit, int first, int count);
+
+  void Set(int mode, const std::vector<double>* par) { m_mode = mode; m_x = par; }
+
+  virtual void Execute(int worker);
+
+  double GetCost() const { return m_cost; }
+  const std::vector<double>& GetJtJ() const { return m_JtJ; }
+  const std::vector<double>& GetJtr() const { return m_Jtr; }
+  double GetSquaredError(int channel) const { return m_sq_error[channel]; }
+  int GetNumMeasured(int channel) const { return m_num_measured[channel]; }
+
+private:
+  PACFIT_Lanes get_lanes()
+  {
+    PACFIT_Lanes lanes;
+    lanes.par = &m_par[0];
+    lanes.lanes = &m_lanes[0];
+    lanes.stride = m_stride;
+    return lanes;
+  }
+
+  void set_param(int slot, double value)
+  {
+    double* p = &m_par[(size_t)slot * m_stride];
+    std::fill(p, p + m_count, value);
+  }
+
+  // Evaluate the residuals of the chunk; returns half their squared norm.
+  double evaluate(double* res, bool stats);
+
+  const ChPacejkaFit*        m_fit;
+  int                        m_first;
+  int                        m_count;
+  int                        m_stride;
+  std::vector<double>        m_par;
+  std::vector<double>        m_lanes;
+
+  int                        m_mode;
+  const std::vector<double>* m_x;
+
+  std::vector<double>        m_res;
+  std::vector<double>        m_res_plus;
+  std::vector<double>        m_res_minus;
+  std::vector<double>        m_jac;        // one column of 3 * m_count rows per fitted slot
+  std::vector<double>        m_JtJ;
+  std::vector<double>        m_Jtr;
+  double                     m_cost;
+  double                     m_sq_error[3];
+  int                        m_num_measured[3];
+};
+
+// The array stride is one cache line longer than the number of lanes (see
+// ChPacejkaTireBatch::reserve()).
+ChPacejkaFitTask::ChPacejkaFitTask(const ChPacejkaFit* fit, int first, int count)
+: m_fit(fit),
+  m_first(first),
+  m_count(count),
+  m_stride(count + 8),
+  m_par((size_t)PACFIT_Lanes::NUM_PARAMS * (count + 8), 0.0),
+  m_lanes((size_t)PACFIT_Lanes::NUM_LANE_SLOTS * (count + 8), 0.0),
+  m_mode(PACFIT_RESIDUAL),
+  m_x(0),
+  m_res(3 * count),
+  m_res_plus(3 * count),
+  m_res_minus(3 * count),
+  m_cost(0)
+{
+  for (int slot = 0; slot < PACFIT_Lanes::NUM_PARAMS; slot++)
+    set_param(slot, fit->m_par[slot]);
+
+  PACFIT_Lanes lanes = get_lanes();
+  double fnomin = fit->m_par[PACFIT_Lanes::P_FNOMIN];
+  for (int i = 0; i < count; i++) {
+    const ChPacejkaFit::Sample& sample = fit->m_samples[first + i];
+    lanes.Lane(PACFIT_Lanes::L_FZ)[i] = sample.Fz;
+    lanes.Lane(PACFIT_Lanes::L_DF_Z)[i] = (sample.Fz - fnomin) / fnomin;
+    lanes.Lane(PACFIT_Lanes::L_KAPPAP)[i] = sample.kappa;
+    lanes.Lane(PACFIT_Lanes::L_ALPHAP)[i] = sample.alpha;
+    lanes.Lane(PACFIT_Lanes::L_GAMMAP)[i] = sample.gamma;
+    lanes.Lane(PACFIT_Lanes::L_COS_ALPHA)[i] = std::cos(sample.alpha);
+    lanes.Lane(PACFIT_Lanes::L_V_CX)[i] = 1;
+    lanes.Lane(PACFIT_Lanes::L_SAME_SIDE)[i] = 1;
+    lanes.Lane(PACFIT_Lanes::L_MU_SCALE)[i] = 1;
+  }
+
+  int n = (int)fit->m_free.size();
+  m_jac.resize((size_t)n * 3 * count);
+  m_JtJ.resize((size_t)n * n);
+  m_Jtr.resize(n);
+}
+
+double ChPacejkaFitTask::evaluate(double* res, bool stats)
+{
+  PACFIT_Lanes lanes = get_lanes();
+  for (int i = 0; i < m_count; i++)
+    lanes.Evaluate<ChStdMath>(i);
+
+  const double* model[3] = {
+    lanes.Lane(PACFIT_Lanes::L_FX_COMBINED),
+    lanes.Lane(PACFIT_Lanes::L_FY_COMBINED),
+    lanes.Lane(PACFIT_Lanes::L_MZ_COMBINED)
+  };
+
+  if (stats) {
+    for (int c = 0; c < 3; c++) {
+      m_sq_error[c] = 0;
+      m_num_measured[c] = 0;
+    }
+  }
+
+  double cost = 0;
+  for (int i = 0; i < m_count; i++) {
+    const ChPacejkaFit::Sample& sample = m_fit->m_samples[m_first + i];
+    double measured[3] = { sample.Fx, sample.Fy, sample.Mz };
+    for (int c = 0; c < 3; c++) {
+      double r = 0;
+      if (sample.channels & (1 << c)) {
+        double error = model[c][i] - measured[c];
+        r = m_fit->m_scale[c] * error;
+        if (stats) {
+          m_sq_error[c] += error * error;
+          m_num_measured[c]++;
+        }
+      }
+      res[3 * i + c] = r;
+      cost += r * r;
+    }
+  }
+
+  return 0.5 * cost;
+}
+
+void ChPacejkaFitTask::Execute(int worker)
+{
+  const std::vector<double>& x = *m_x;
+  const std::vector<int>& free = m_fit->m_free;
+  int n = (int)free.size();
+  int rows = 3 * m_count;
+
+  for (int j = 0; j < n; j++)
+    set_param(free[j], x[free[j]]);
+
+  m_cost = evaluate(&m_res[0], true);
+
+  if (m_mode != PACFIT_JACOBIAN)
+    return;
+
+  for (int j = 0; j < n; j++) {
+    int slot = free[j];
+    double h = PACFIT_step * std::max(std::abs(x[slot]), 1e-3);
+    set_param(slot, x[slot] + h);
+    evaluate(&m_res_plus[0], false);
+    set_param(slot, x[slot] - h);
+    evaluate(&m_res_minus[0], false);
+    set_param(slot, x[slot]);
+
+    double* col = &m_jac[(size_t)j * rows];
+    for (int r = 0; r < rows; r++)
+      col[r] = (m_res_plus[r] - m_res_minus[r]) / (2 * h);
+  }
+
+  for (int a = 0; a < n; a++) {
+    const double* col_a = &m_jac[(size_t)a * rows];
+    double g = 0;
+    for (int r = 0; r < rows; r++)
+      g += col_a[r] * m_res[r];
+    m_Jtr[a] = g;
+    for (int b = 0; b <= a; b++) {
+      const double* col_b = &m_jac[(size_t)b * rows];
+      double s = 0;
+      for (int r = 0; r < rows; r++)
+        s += col_a[r] * col_b[r];
+      m_JtJ[a * n + b] = m_JtJ[b * n + a] = s;
+    }
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaFit::ChPacejkaFit()
+: m_loaded(false),
+  m_groups(LONGITUDINAL | LATERAL | ALIGNING),
+  m_fixed(PACFIT_Lanes::NUM_PARAMS, false),
+  m_max_iter(100),
+  m_tol(1e-10),
+  m_chunk_size(256),
+  m_num_iter(0),
+  m_initial_cost(0),
+  m_final_cost(0)
+{
+  for (int c = 0; c < 3; c++) {
+    m_weights[c] = 1;
+    m_scale[c] = 1;
+    m_rms[c] = 0;
+  }
+}
+
+ChPacejkaFit::~ChPacejkaFit()
+{
+  for (size_t k = 0; k < m_tasks.size(); k++)
+    delete m_tasks[k];
+}
+
+// -----------------------------------------------------------------------------
+// The *.tir files are read with the reader of ChPacejkaTire, through a tire
+// that is only initialized (its parameters loaded).
+// -----------------------------------------------------------------------------
+bool ChPacejkaFit::load_tire(const std::string& filename, std::vector<double>* par, Pac2002_data* data)
+{
+  FlatTerrain terrain(0);
+  ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire("fit", filename, terrain));
+  tire->Initialize(LEFT, false);
+
+  if (!tire->m_params_defined) {
+    GetLog() << "ERROR: cannot load Pacejka parameters from " << filename.c_str() << "\n";
+    return false;
+  }
+
+  if (par) {
+    par->resize(PACFIT_Lanes::NUM_PARAMS);
+    ChPacejkaTireBatch::PackParameters(*tire, &(*par)[0]);
+  }
+  if (data)
+    *data = *tire->m_params;
+
+  return true;
+}
+
+bool ChPacejkaFit::LoadTemplate(const std::string& filename)
+{
+  m_loaded = load_tire(filename, &m_par, 0);
+  if (m_loaded)
+    m_template = filename;
+
+  return m_loaded;
+}
+
+void ChPacejkaFit::AddSample(const Sample& sample)
+{
+  m_samples.push_back(sample);
+}
+
+void ChPacejkaFit::AddLoadCase(double        Fz,
+                               double        gamma,
+                               int           n,
+                               const double* kappa,
+                               const double* alpha,
+                               const double* Fx,
+                               const double* Fy,
+                               const double* Mz)
+{
+  for (int k = 0; k < n; k++) {
+    Sample sample;
+    sample.Fz = Fz;
+    sample.kappa = kappa[k];
+    sample.alpha = alpha[k];
+    sample.gamma = gamma;
+    sample.Fx = Fx ? Fx[k] : 0;
+    sample.Fy = Fy ? Fy[k] : 0;
+    sample.Mz = Mz ? Mz[k] : 0;
+    sample.channels = (Fx ? FX : 0) | (Fy ? FY : 0) | (Mz ? MZ : 0);
+    m_samples.push_back(sample);
+  }
+}
+
+bool ChPacejkaFit::FixCoefficient(const std::string& name)
+{
+  int slot = PACFIT_slot(name);
+  if (slot < 0)
+    return false;
+
+  m_fixed[slot] = true;
+  return true;
+}
+
+void ChPacejkaFit::SetWeights(double wFx, double wFy, double wMz)
+{
+  m_weights[0] = wFx;
+  m_weights[1] = wFy;
+  m_weights[2] = wMz;
+}
+
+double ChPacejkaFit::GetCoefficient(const std::string& name) const
+{
+  int slot = PACFIT_slot(name);
+
+  return (m_loaded && slot >= 0) ? m_par[slot] : 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaFit::setup_tasks()
+{
+  double sum[3] = { 0, 0, 0 };
+  int num[3] = { 0, 0, 0 };
+  for (size_t k = 0; k < m_samples.size(); k++) {
+    double measured[3] = { m_samples[k].Fx, m_samples[k].Fy, m_samples[k].Mz };
+    for (int c = 0; c < 3; c++) {
+      if (m_samples[k].channels & (1 << c)) {
+        sum[c] += measured[c] * measured[c];
+        num[c]++;
+      }
+    }
+  }
+  for (int c = 0; c < 3; c++) {
+    double rms = (num[c] > 0) ? std::sqrt(sum[c] / num[c]) : 0;
+    m_scale[c] = (rms > 0) ? m_weights[c] / rms : m_weights[c];
+  }
+
+  for (size_t k = 0; k < m_tasks.size(); k++)
+    delete m_tasks[k];
+  m_tasks.clear();
+
+  int chunk = std::max(m_chunk_size, 1);
+  int num_samples = (int)m_samples.size();
+  for (int first = 0; first < num_samples; first += chunk)
+    m_tasks.push_back(new ChPacejkaFitTask(this, first, std::min(chunk, num_samples - first)));
+}
+
+double ChPacejkaFit::run_tasks(vehicle::ChThreadPool* pool, int mode, const std::vector<double>& par)
+{
+  for (size_t k = 0; k < m_tasks.size(); k++) {
+    m_tasks[k]->Set(mode, &par);
+    if (pool && m_tasks.size() > 1)
+      pool->Submit(m_tasks[k]);
+    else
+      m_tasks[k]->Execute(0);
+  }
+  if (pool && m_tasks.size() > 1)
+    pool->Wait();
+
+  double cost = 0;
+  for (size_t k = 0; k < m_tasks.size(); k++)
+    cost += m_tasks[k]->GetCost();
+
+  return (cost == cost && cost <= DBL_MAX) ? cost : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Levenberg-Marquardt iteration on the normal equations, with the damping
+// scaled by the diagonal of J^T J (floored, so that coefficients without
+// influence on the measured data, e.g. camber terms without camber sweeps,
+// stay at their value). A step is accepted if it decreases the error;
+// otherwise the damping is increased and the step recomputed.
+// -----------------------------------------------------------------------------
+bool ChPacejkaFit::Fit(vehicle::ChThreadPool* pool)
+{
+  if (!m_loaded) {
+    GetLog() << "ERROR: no template tire file loaded for the Pacejka fit\n";
+    return false;
+  }
+
+  m_free.clear();
+  for (int slot = PACFIT_first; slot <= PACFIT_last; slot++) {
+    if ((PACFIT_group(slot) & m_groups) && !m_fixed[slot])
+      m_free.push_back(slot);
+  }
+
+  if (m_free.empty() || m_samples.empty()) {
+    GetLog() << "ERROR: no coefficients or no samples for the Pacejka fit\n";
+    return false;
+  }
+
+  setup_tasks();
+
+  int n = (int)m_free.size();
+  std::vector<double> JtJ(n * n);
+  std::vector<double> g(n);
+  std::vector<double> A(n * n);
+  std::vector<double> rhs(n);
+  std::vector<double> delta(n);
+  std::vector<double> trial;
+
+  double cost = run_tasks(pool, PACFIT_JACOBIAN, m_par);
+  if (cost < 0) {
+    GetLog() << "ERROR: Pacejka fit error not finite at the initial coefficients\n";
+    return false;
+  }
+  m_initial_cost = cost;
+
+  double lambda = 1e-3;
+  for (m_num_iter = 0; m_num_iter < m_max_iter; m_num_iter++) {
+    std::fill(JtJ.begin(), JtJ.end(), 0.0);
+    std::fill(g.begin(), g.end(), 0.0);
+    for (size_t k = 0; k < m_tasks.size(); k++) {
+      const std::vector<double>& JtJ_k = m_tasks[k]->GetJtJ();
+      const std::vector<double>& Jtr_k = m_tasks[k]->GetJtr();
+      for (int a = 0; a < n * n; a++)
+        JtJ[a] += JtJ_k[a];
+      for (int a = 0; a < n; a++)
+        g[a] += Jtr_k[a];
+    }
+
+    double max_diag = 0;
+    for (int a = 0; a < n; a++)
+      max_diag = std::max(max_diag, JtJ[a * n + a]);
+    if (max_diag == 0)
+      break;
+
+    double trial_cost = -1;
+    while (lambda < 1e16) {
+      A = JtJ;
+      for (int a = 0; a < n; a++) {
+        A[a * n + a] += lambda * std::max(JtJ[a * n + a], 1e-12 * max_diag);
+        rhs[a] = -g[a];
+      }
+
+      if (PACFIT_solve(A, n, rhs, delta)) {
+        trial = m_par;
+        for (int a = 0; a < n; a++)
+          trial[m_free[a]] += delta[a];
+        trial_cost = run_tasks(pool, PACFIT_RESIDUAL, trial);
+        if (trial_cost >= 0 && trial_cost < cost)
+          break;
+      }
+
+      trial_cost = -1;
+      lambda *= 10;
+    }
+
+    // no step decreases the error: converged (or stalled)
+    if (trial_cost < 0)
+      break;
+
+    double decrease = cost - trial_cost;
+    m_par.swap(trial);
+    lambda = std::max(0.1 * lambda, 1e-12);
+
+    cost = run_tasks(pool, PACFIT_JACOBIAN, m_par);
+
+    if (decrease <= m_tol * cost) {
+      m_num_iter++;
+      break;
+    }
+  }
+
+  // error statistics at the final coefficients
+  m_final_cost = run_tasks(pool, PACFIT_RESIDUAL, m_par);
+  for (int c = 0; c < 3; c++) {
+    double sq = 0;
+    int num = 0;
+    for (size_t k = 0; k < m_tasks.size(); k++) {
+      sq += m_tasks[k]->GetSquaredError(c);
+      num += m_tasks[k]->GetNumMeasured(c);
+    }
+    m_rms[c] = (num > 0) ? std::sqrt(sq / num) : 0;
+  }
+
+  return true;
+}
+
+double ChPacejkaFit::GetRmsError(Channel channel) const
+{
+  switch (channel) {
+  case FX: return m_rms[0];
+  case FY: return m_rms[1];
+  case MZ: return m_rms[2];
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// The coefficient lines of the template ("NAME = value $comment") get the
+// current values, keeping the position of the comments; all other lines are
+// copied.
+// -----------------------------------------------------------------------------
+bool ChPacejkaFit::WriteTir(const std::string& filename) const
+{
+  if (!m_loaded) {
+    GetLog() << "ERROR: no template tire file loaded for the Pacejka fit\n";
+    return false;
+  }
+
+  std::ifstream in(m_template.c_str(), std::ios::in);
+  if (!in.is_open()) {
+    GetLog() << "ERROR: cannot open " << m_template.c_str() << "\n";
+    return false;
+  }
+
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t eq = line.find('=');
+    if (eq != std::string::npos && line[0] != '$' && line[0] != '!') {
+      size_t begin = line.find_first_not_of(" \t");
+      size_t end = line.find_last_not_of(" \t", eq - 1);
+      int slot = (begin < eq && end != std::string::npos) ? PACFIT_slot(line.substr(begin, end - begin + 1)) : -1;
+      if (slot >= 0) {
+        char value[32];
+        sprintf(value, "%.12g", m_par[slot]);
+        std::string out = line.substr(0, eq + 1) + " " + value;
+        size_t comment = line.find('$', eq);
+        if (comment != std::string::npos) {
+          out += ' ';
+          if (out.size() < comment)
+            out.resize(comment, ' ');
+          out += line.substr(comment);
+        }
+        line = out;
+      }
+    }
+    fprintf(fp, "%s\n", line.c_str());
+  }
+
+  if (fclose(fp) != 0) {
+    GetLog() << "ERROR: cannot write " << filename.c_str() << "\n";
+    return false;
+  }
+
+  Pac2002_data data;
+  unsigned long long checksum;
+  if (!load_tire(filename, 0, &data) || !Pac2002_checksum(filename, checksum))
+    return false;
+
+  return Pac2002_writeCache(Pac2002_cacheFile(filename), checksum, data);
+}
+
+
+} // end namespace chrono
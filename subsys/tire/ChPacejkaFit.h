@@ -0,0 +1,221 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Identification of Pacejka 2002 Magic Formula coefficients from measured tire
+// data (e.g. flat-track or trailer tests).
+//
+// The fit starts from a template *.tir file, which provides the initial guess
+// of the coefficients and all the data that is not fitted (dimensions,
+// vertical properties, nominal load, scaling factors). The measurements are
+// steady-state samples, usually recorded as slip sweeps at a few load and
+// camber cases: for each sample, the load, the slips as used by the Magic
+// Formula (longitudinal slip, slip angle, camber) and the measured reactions
+// (any of Fx, Fy and Mz) in the tire frame of the template tire side.
+//
+// The selected coefficient groups are fitted with a Levenberg-Marquardt
+// solver on the weighted least-squares error of the combined slip reactions
+// (which reduce to the pure slip reactions at zero slip in the other
+// direction). The samples are packed in the lanes of the batched Magic
+// Formula kernels (see ChPacejkaBatchLanes), in chunks evaluated in parallel
+// on a ChThreadPool. The Jacobian is obtained by central differences, each
+// column being one more batched evaluation of the chunk; each chunk then
+// reduces its rows into the normal equations, so that the full Jacobian is
+// never assembled.
+//
+// The result is written as a *.tir file (the template, with the values of
+// the fitted coefficients replaced), together with its binary parameter cache
+// (see ChPac2002_cache.h), so that the fitted tire loads without parsing:
+//
+//   ChPacejkaFit fit;
+//   fit.LoadTemplate("template.tir");
+//   fit.AddLoadCase(Fz, gamma, n, kappa, alpha, Fx, Fy, Mz);
+//   ...
+//   fit.SetGroups(ChPacejkaFit::LATERAL | ChPacejkaFit::ALIGNING);
+//   fit.Fit(&pool);
+//   fit.WriteTir("fitted.tir");
+//
+// =============================================================================
+
+#ifndef CH_PACEJKA_FIT_H
+#define CH_PACEJKA_FIT_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChThreadPool.h"
+#include "subsys/tire/ChPacejkaBatchKernels.h"
+
+namespace chrono {
+
+struct Pac2002_data;
+class ChPacejkaFitTask;
+
+///
+/// Levenberg-Marquardt fit of Magic Formula coefficients to measured data.
+///
+class CH_SUBSYS_API ChPacejkaFit
+{
+public:
+
+  /// Measured reactions.
+  enum Channel {
+    FX = 1,        ///< longitudinal force
+    FY = 2,        ///< lateral force
+    MZ = 4         ///< aligning moment
+  };
+
+  /// Coefficient groups (combined as a bit mask, see SetGroups()).
+  enum Group {
+    LONGITUDINAL = 1,   ///< pure slip longitudinal force (PCX1 ... PVX2)
+    LATERAL = 2,        ///< pure slip lateral force (PCY1 ... PVY4)
+    ALIGNING = 4,       ///< pure slip aligning moment (QBZ1 ... QHZ4)
+    COMBINED = 8        ///< combined slip (RBX1 ... RHX1, RBY1 ... RVY6, SSZ1 ... SSZ4)
+  };
+
+  /// One measurement.
+  struct Sample {
+    double  Fz;           ///< vertical load
+    double  kappa;        ///< longitudinal slip
+    double  alpha;        ///< slip angle
+    double  gamma;        ///< camber angle
+    double  Fx;           ///< measured longitudinal force
+    double  Fy;           ///< measured lateral force
+    double  Mz;           ///< measured aligning moment
+    int     channels;     ///< measured reactions (bit mask of Channel)
+  };
+
+  ChPacejkaFit();
+  ~ChPacejkaFit();
+
+  /// Load the template *.tir file (initial guess and fixed data).
+  /// Returns false if the file cannot be loaded.
+  bool LoadTemplate(const std::string& filename);
+
+  /// Add one measurement.
+  void AddSample(const Sample& sample);
+
+  /// Add a slip sweep at the specified load and camber. Channels not measured
+  /// are passed as NULL.
+  void AddLoadCase(
+    double         Fz,       ///< [in] vertical load
+    double         gamma,    ///< [in] camber angle
+    int            n,        ///< [in] number of samples
+    const double*  kappa,    ///< [in] longitudinal slips
+    const double*  alpha,    ///< [in] slip angles
+    const double*  Fx,       ///< [in] measured longitudinal forces (or NULL)
+    const double*  Fy,       ///< [in] measured lateral forces (or NULL)
+    const double*  Mz        ///< [in] measured aligning moments (or NULL)
+    );
+
+  /// Remove all measurements.
+  void ClearSamples() { m_samples.clear(); }
+
+  /// Get the number of measurements.
+  int GetNumSamples() const { return (int)m_samples.size(); }
+
+  /// Select the fitted coefficient groups (default: LONGITUDINAL | LATERAL |
+  /// ALIGNING).
+  void SetGroups(int groups) { m_groups = groups; }
+
+  /// Keep the specified coefficient (e.g. "PDX3") at its template value.
+  /// Returns false if the name is not a Magic Formula coefficient.
+  bool FixCoefficient(const std::string& name);
+
+  /// Set the weights of the reactions (default: 1). The error of each
+  /// reaction is scaled by its weight divided by the RMS of its measurements,
+  /// so that forces and moments contribute alike. A zero weight excludes the
+  /// reaction from the fit.
+  void SetWeights(double wFx, double wFy, double wMz);
+
+  /// Set the maximum number of iterations and the relative tolerance on the
+  /// decrease of the error (default: 100 and 1e-10).
+  void SetTolerance(int max_iter, double tol) { m_max_iter = max_iter; m_tol = tol; }
+
+  /// Set the number of samples evaluated by each task (default: 256).
+  void SetChunkSize(int size) { m_chunk_size = size; }
+
+  /// Fit the selected coefficients, evaluating the chunks of samples on the
+  /// specified pool (if any). Can be called again (e.g. for another group of
+  /// coefficients), starting from the current values. Returns false if no
+  /// template was loaded, there is nothing to fit, or the error cannot be
+  /// evaluated at the initial guess.
+  bool Fit(vehicle::ChThreadPool* pool = NULL);
+
+  /// Get the number of iterations and the weighted error (half the sum of the
+  /// squared scaled residuals) before and after the last fit.
+  int    GetNumIterations() const { return m_num_iter; }
+  double GetInitialError() const { return m_initial_cost; }
+  double GetFinalError() const { return m_final_cost; }
+
+  /// Get the RMS difference between the model and the measurements of the
+  /// specified reaction, at the end of the last fit.
+  double GetRmsError(Channel channel) const;
+
+  /// Get the current value of the specified coefficient (0 if unknown).
+  double GetCoefficient(const std::string& name) const;
+
+  /// Write the fitted tire: the template file with the values of all Magic
+  /// Formula coefficients replaced by the current ones, and its binary
+  /// parameter cache (see Pac2002_cacheFile()). The written file is loaded
+  /// back through the *.tir reader of ChPacejkaTire, so that the cache holds
+  /// exactly the values a tire reads from it. Returns false on failure.
+  bool WriteTir(const std::string& filename) const;
+
+private:
+
+  ChPacejkaFit(const ChPacejkaFit&);
+  ChPacejkaFit& operator=(const ChPacejkaFit&);
+
+  // Load the lane parameters and (or) the parameter values of the specified
+  // *.tir file.
+  static bool load_tire(const std::string& filename, std::vector<double>* par, Pac2002_data* data);
+
+  // Pack the samples in tasks and set the scaling of the residuals.
+  void setup_tasks();
+
+  // Evaluate all tasks in the specified mode, with the specified lane
+  // parameters; returns the total error, or a negative value if it is not
+  // finite.
+  double run_tasks(vehicle::ChThreadPool* pool, int mode, const std::vector<double>& par);
+
+  std::string                     m_template;
+  std::vector<double>             m_par;           // all lane parameters (NUM_PARAMS)
+  bool                            m_loaded;
+
+  std::vector<Sample>             m_samples;
+  int                             m_groups;
+  std::vector<bool>               m_fixed;         // per parameter slot
+  double                          m_weights[3];
+  int                             m_max_iter;
+  double                          m_tol;
+  int                             m_chunk_size;
+
+  std::vector<int>                m_free;          // fitted parameter slots
+  double                          m_scale[3];      // residual scaling of each reaction
+  std::vector<ChPacejkaFitTask*>  m_tasks;
+
+  int                             m_num_iter;
+  double                          m_initial_cost;
+  double                          m_final_cost;
+  double                          m_rms[3];
+
+  friend class ChPacejkaFitTask;
+};
+
+
+} // end namespace chrono
+
+
+#endif
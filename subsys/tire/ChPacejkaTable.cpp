@@ -0,0 +1,216 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Tabulated Magic Formula curves for the Pacejka tire model.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstring>
+
+#include "subsys/tire/ChPacejkaTable.h"
+
+namespace chrono {
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaTable::ChPacejkaTable(const Settings& settings,
+                               const double    min[NUM_AXES],
+                               const double    max[NUM_AXES],
+                               const double*   values)
+: m_settings(settings)
+{
+  m_num[KAPPA] = settings.num_kappa;
+  m_num[ALPHA] = settings.num_alpha;
+  m_num[GAMMA] = settings.num_gamma;
+  m_num[FZ] = settings.num_Fz;
+
+  int refine = (settings.pure_refinement > 1) ? settings.pure_refinement : 1;
+
+  for (int i = 0; i < NUM_AXES; i++) {
+    // need at least one cell along each axis
+    if (m_num[i] < 2)
+      m_num[i] = 2;
+    m_min[i] = min[i];
+    m_max[i] = max[i];
+    m_delta[i] = (max[i] - min[i]) / (m_num[i] - 1);
+    m_inv_delta[i] = (m_delta[i] > 0) ? 1.0 / m_delta[i] : 0;
+
+    // the pure slip curves are refined along the slip axes only
+    m_num_pure[i] = (i == KAPPA || i == ALPHA) ? (m_num[i] - 1) * refine + 1 : m_num[i];
+    m_delta_pure[i] = (max[i] - min[i]) / (m_num_pure[i] - 1);
+    m_inv_delta_pure[i] = (m_delta_pure[i] > 0) ? 1.0 / m_delta_pure[i] : 0;
+  }
+
+  m_num_long = m_num_pure[KAPPA] * m_num[GAMMA] * m_num[FZ];
+  m_num_lat = 2 * m_num_pure[ALPHA] * m_num[GAMMA] * m_num[FZ];
+  m_num_combined = NUM_COMBINED * m_num[KAPPA] * m_num[ALPHA] * m_num[GAMMA] * m_num[FZ];
+
+  if (values) {
+    ShareValues(values);
+  } else {
+    m_values.resize(GetNumValues(), 0.0);
+    set_values(&m_values[0]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Layout of the values: the estimated errors (pure, combined), then the pure
+// longitudinal, pure lateral and combined slip values.
+// -----------------------------------------------------------------------------
+void ChPacejkaTable::set_values(const double* values)
+{
+  // the values are only written through the accessors of an owning table
+  double* v = const_cast<double*>(values) + 6;
+  m_long = v;
+  m_lat = m_long + m_num_long;
+  m_combined = m_lat + m_num_lat;
+}
+
+void ChPacejkaTable::WriteValues(double* values) const
+{
+  values[0] = m_err_pure.x;
+  values[1] = m_err_pure.y;
+  values[2] = m_err_pure.z;
+  values[3] = m_err_combined.x;
+  values[4] = m_err_combined.y;
+  values[5] = m_err_combined.z;
+  if (values + 6 != m_long)
+    memcpy(values + 6, m_long, (m_num_long + m_num_lat + m_num_combined) * sizeof(double));
+}
+
+void ChPacejkaTable::ShareValues(const double* values)
+{
+  m_err_pure = ChVector<>(values[0], values[1], values[2]);
+  m_err_combined = ChVector<>(values[3], values[4], values[5]);
+  set_values(values);
+
+  std::vector<double> none;
+  m_values.swap(none);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChPacejkaTable::InRange(double kappa, double alpha, double gamma, double Fz) const
+{
+  return kappa >= m_min[KAPPA] && kappa <= m_max[KAPPA] &&
+         alpha >= m_min[ALPHA] && alpha <= m_max[ALPHA] &&
+         gamma >= m_min[GAMMA] && gamma <= m_max[GAMMA] &&
+         Fz >= m_min[FZ] && Fz <= m_max[FZ];
+}
+
+// -----------------------------------------------------------------------------
+// Find the cell containing x and the interpolation weights of the neighboring
+// grid points. For cubic interpolation, indices outside the grid are clamped to
+// the first/last grid point.
+// -----------------------------------------------------------------------------
+void ChPacejkaTable::stencil(int num, double min, double inv_delta, double x, bool cubic, Stencil& s)
+{
+  double u = (x - min) * inv_delta;
+  int i = (int)std::floor(u);
+  if (i < 0)
+    i = 0;
+  if (i > num - 2)
+    i = num - 2;
+  double t = u - i;
+
+  if (!cubic) {
+    s.n = 2;
+    s.idx[0] = i;
+    s.idx[1] = i + 1;
+    s.w[0] = 1 - t;
+    s.w[1] = t;
+    return;
+  }
+
+  double t2 = t * t;
+  double t3 = t2 * t;
+
+  s.n = 4;
+  s.idx[0] = (i > 0) ? i - 1 : 0;
+  s.idx[1] = i;
+  s.idx[2] = i + 1;
+  s.idx[3] = (i + 2 < num) ? i + 2 : num - 1;
+  s.w[0] = 0.5 * (-t3 + 2 * t2 - t);
+  s.w[1] = 0.5 * (3 * t3 - 5 * t2 + 2);
+  s.w[2] = 0.5 * (-3 * t3 + 4 * t2 + t);
+  s.w[3] = 0.5 * (t3 - t2);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTable::Evaluate(double  kappa,
+                              double  alpha,
+                              double  gamma,
+                              double  Fz,
+                              double& Fx,
+                              double  lat[2],
+                              double  combined[NUM_COMBINED]) const
+{
+  bool cubic = (m_settings.interpolation == CUBIC);
+
+  Stencil sk, sa, sg, sF;
+  Stencil sk_pure, sa_pure;
+  stencil(m_num[KAPPA], m_min[KAPPA], m_inv_delta[KAPPA], kappa, cubic, sk);
+  stencil(m_num[ALPHA], m_min[ALPHA], m_inv_delta[ALPHA], alpha, cubic, sa);
+  stencil(m_num_pure[KAPPA], m_min[KAPPA], m_inv_delta_pure[KAPPA], kappa, cubic, sk_pure);
+  stencil(m_num_pure[ALPHA], m_min[ALPHA], m_inv_delta_pure[ALPHA], alpha, cubic, sa_pure);
+  stencil(m_num[GAMMA], m_min[GAMMA], m_inv_delta[GAMMA], gamma, false, sg);
+  stencil(m_num[FZ], m_min[FZ], m_inv_delta[FZ], Fz, false, sF);
+
+  int nk = m_num[KAPPA];
+  int na = m_num[ALPHA];
+  int ng = m_num[GAMMA];
+  int nk_pure = m_num_pure[KAPPA];
+  int na_pure = m_num_pure[ALPHA];
+
+  Fx = 0;
+  lat[0] = 0;
+  lat[1] = 0;
+  for (int c = 0; c < NUM_COMBINED; c++)
+    combined[c] = 0;
+
+  for (int f = 0; f < sF.n; f++) {
+    for (int g = 0; g < sg.n; g++) {
+      double w_gF = sF.w[f] * sg.w[g];
+      int slice = sF.idx[f] * ng + sg.idx[g];
+
+      // pure slip, (kappa, gamma, Fz) and (alpha, gamma, Fz)
+      for (int k = 0; k < sk_pure.n; k++)
+        Fx += w_gF * sk_pure.w[k] * m_long[slice * nk_pure + sk_pure.idx[k]];
+
+      for (int a = 0; a < sa_pure.n; a++) {
+        const double* p = &m_lat[2 * (slice * na_pure + sa_pure.idx[a])];
+        double w = w_gF * sa_pure.w[a];
+        lat[0] += w * p[0];
+        lat[1] += w * p[1];
+      }
+
+      // combined slip, (kappa, alpha, gamma, Fz)
+      for (int a = 0; a < sa.n; a++) {
+        int row = (slice * na + sa.idx[a]) * nk;
+        double w_a = w_gF * sa.w[a];
+        for (int k = 0; k < sk.n; k++) {
+          const double* p = &m_combined[NUM_COMBINED * (row + sk.idx[k])];
+          double w = w_a * sk.w[k];
+          for (int c = 0; c < NUM_COMBINED; c++)
+            combined[c] += w * p[c];
+        }
+      }
+    }
+  }
+}
+
+
+}  // end namespace chrono
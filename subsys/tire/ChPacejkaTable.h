@@ -0,0 +1,238 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Tabulated Magic Formula curves for the Pacejka tire model.
+//
+// The table stores the transcendental parts of the Pac2002 equations on a
+// regular (kappa, alpha, gamma, Fz) grid:
+//   - pure longitudinal force Fx(kappa, gamma, Fz)
+//   - pure lateral force Fy and aligning moment Mz(alpha, gamma, Fz)
+//   - combined slip weighting functions, combined pneumatic trail and residual
+//     torque (kappa, alpha, gamma, Fz)
+// The pure slip curves have sharp peaks at small slips but only depend on three
+// of the inputs, so they are stored on a finer slip grid than the smoother
+// combined slip values.
+// The remaining (algebraic) parts of the combined slip equations are evaluated
+// by ChPacejkaTire, such that the tabulated values do not depend on the tire
+// side, the sign of the forward velocity or the cosine of the slip angle.
+//
+// Values are obtained by multilinear interpolation or, optionally, by cubic
+// (Catmull-Rom) interpolation along the slip axes and linear interpolation
+// along the camber and load axes.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKATABLE_H
+#define CH_PACEJKATABLE_H
+
+#include <vector>
+
+#include "core/ChVector.h"
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Tabulated Magic Formula curves, shared (read-only) by all tires using the
+/// same parameter file and table settings.
+///
+class CH_SUBSYS_API ChPacejkaTable
+{
+public:
+
+  enum Interpolation {
+    LINEAR,   ///< multilinear interpolation
+    CUBIC     ///< Catmull-Rom along kappa and alpha, linear along gamma and Fz
+  };
+
+  enum Axis {
+    KAPPA,
+    ALPHA,
+    GAMMA,
+    FZ,
+    NUM_AXES
+  };
+
+  /// Values tabulated over the 4D grid.
+  enum CombinedValue {
+    G_XALPHA,     ///< combined slip weighting function for Fx
+    G_YKAPPA,     ///< combined slip weighting function for Fy
+    S_VYKAPPA,    ///< kappa induced lateral force
+    TRAIL,        ///< combined pneumatic trail, for cos(alpha') = 1 and Vx > 0
+    M_ZR,         ///< combined residual torque, for cos(alpha') = 1 and Vx > 0
+    ALPHA_R_EQ,   ///< magnitude of the equivalent slip angle for the residual torque
+    NUM_COMBINED
+  };
+
+  /// Settings of the table.
+  /// The slip ranges default to the valid ranges specified in the *.tir file;
+  /// the camber and load ranges are always taken from the *.tir file.
+  struct Settings {
+    Settings()
+      : enabled(false), interpolation(LINEAR),
+        num_kappa(61), num_alpha(61), num_gamma(11), num_Fz(9),
+        pure_refinement(8), kappa_lim(0), alpha_lim(0) {}
+
+    bool operator==(const Settings& other) const {
+      return enabled == other.enabled && interpolation == other.interpolation &&
+             num_kappa == other.num_kappa && num_alpha == other.num_alpha &&
+             num_gamma == other.num_gamma && num_Fz == other.num_Fz &&
+             pure_refinement == other.pure_refinement &&
+             kappa_lim == other.kappa_lim && alpha_lim == other.alpha_lim;
+    }
+
+    bool           enabled;        ///< use the tabulated Magic Formula
+    Interpolation  interpolation;  ///< interpolation type
+    int            num_kappa;      ///< number of grid points along kappa
+    int            num_alpha;      ///< number of grid points along alpha
+    int            num_gamma;      ///< number of grid points along gamma
+    int            num_Fz;         ///< number of grid points along Fz
+    int            pure_refinement; ///< subdivision of the kappa, alpha cells for the pure slip curves
+    double         kappa_lim;      ///< if positive, tabulate kappa over [-kappa_lim, kappa_lim]
+    double         alpha_lim;      ///< if positive, tabulate alpha over [-alpha_lim, alpha_lim]
+  };
+
+  /// Allocate the table for the specified grid. The values are filled in
+  /// node by node through the Long(), Lat() and Combined() accessors.
+  /// Alternatively, the table uses the specified values in place, as written
+  /// by WriteValues() for the same settings and grid (e.g. in the shared model
+  /// data segment); such a table is read-only.
+  ChPacejkaTable(
+    const Settings& settings,          ///< [in] table settings
+    const double    min[NUM_AXES],     ///< [in] lower bounds of the grid
+    const double    max[NUM_AXES],     ///< [in] upper bounds of the grid
+    const double*   values = 0         ///< [in] values used in place (NULL: allocate the table)
+    );
+
+  ~ChPacejkaTable() {}
+
+  /// Return the table settings.
+  const Settings& GetSettings() const { return m_settings; }
+
+  /// Return the number of grid points along the specified axis.
+  int GetNumNodes(Axis axis) const { return m_num[axis]; }
+
+  /// Return the value of the specified axis at the given grid point.
+  double GetNode(Axis axis, int i) const { return m_min[axis] + i * m_delta[axis]; }
+
+  /// Return the number of grid points of the pure slip curves along the
+  /// specified axis (refined along kappa and alpha).
+  int GetNumPureNodes(Axis axis) const { return m_num_pure[axis]; }
+
+  /// Return the value of the specified axis at the given grid point of the
+  /// pure slip curves.
+  double GetPureNode(Axis axis, int i) const { return m_min[axis] + i * m_delta_pure[axis]; }
+
+  /// Check if the specified inputs lie within the tabulated ranges.
+  bool InRange(double kappa, double alpha, double gamma, double Fz) const;
+
+  /// Access the pure longitudinal force at the given grid point.
+  double& Long(int ik, int ig, int iF) { return m_long[(iF * m_num[GAMMA] + ig) * m_num_pure[KAPPA] + ik]; }
+
+  /// Access the pure lateral force (0) and aligning moment (1) at the given
+  /// grid point.
+  double* Lat(int ia, int ig, int iF) { return &m_lat[2 * ((iF * m_num[GAMMA] + ig) * m_num_pure[ALPHA] + ia)]; }
+
+  /// Access the combined slip values at the given grid point.
+  double* Combined(int ik, int ia, int ig, int iF) { return &m_combined[NUM_COMBINED * (((iF * m_num[GAMMA] + ig) * m_num[ALPHA] + ia) * m_num[KAPPA] + ik)]; }
+
+  /// Return the number of values written by WriteValues().
+  size_t GetNumValues() const { return 6 + m_num_long + m_num_lat + m_num_combined; }
+
+  /// Write the estimated errors and the tabulated values, in a layout that
+  /// can be used in place by another table (see the constructor).
+  void WriteValues(double* values) const;
+
+  /// Use the specified values in place, as written by WriteValues() for this
+  /// table, and release the values owned by the table.
+  void ShareValues(const double* values);
+
+  /// Interpolate the tabulated values. The inputs must lie within the
+  /// tabulated ranges (see InRange()).
+  void Evaluate(
+    double  kappa,                     ///< [in] longitudinal slip
+    double  alpha,                     ///< [in] slip angle
+    double  gamma,                     ///< [in] camber angle
+    double  Fz,                        ///< [in] vertical load
+    double& Fx,                        ///< [out] pure longitudinal force
+    double  lat[2],                    ///< [out] pure lateral force and aligning moment
+    double  combined[NUM_COMBINED]     ///< [out] combined slip values
+    ) const;
+
+  /// Set the estimated interpolation error.
+  void SetError(const ChVector<>& pure, const ChVector<>& combined) { m_err_pure = pure; m_err_combined = combined; }
+
+  /// Return the estimated interpolation error (Fx, Fy, Mz) of the pure slip
+  /// reactions, as the maximum deviation from the analytical Magic Formula at
+  /// the centers of the (refined) grid cells.
+  const ChVector<>& GetErrorPure() const { return m_err_pure; }
+
+  /// Return the estimated interpolation error (Fx, Fy, Mz) of the combined
+  /// slip reactions, as the maximum deviation from the analytical Magic
+  /// Formula at the centers of the grid cells.
+  const ChVector<>& GetErrorCombined() const { return m_err_combined; }
+
+  /// Return the size of this table and of its tabulated values, in bytes.
+  size_t GetMemoryFootprint() const {
+    return sizeof(*this) + m_values.capacity() * sizeof(double);
+  }
+
+private:
+
+  ChPacejkaTable(const ChPacejkaTable&);
+  ChPacejkaTable& operator=(const ChPacejkaTable&);
+
+  struct Stencil {
+    int    n;
+    int    idx[4];
+    double w[4];
+  };
+
+  // interpolation indices and weights along an axis with num grid points
+  static void stencil(int num, double min, double inv_delta, double x, bool cubic, Stencil& s);
+
+  Settings             m_settings;
+
+  int                  m_num[NUM_AXES];
+  double               m_min[NUM_AXES];
+  double               m_max[NUM_AXES];
+  double               m_delta[NUM_AXES];
+  double               m_inv_delta[NUM_AXES];
+
+  int                  m_num_pure[NUM_AXES];
+  double               m_delta_pure[NUM_AXES];
+  double               m_inv_delta_pure[NUM_AXES];
+
+  // Point to the values laid out as by WriteValues(), owned or shared.
+  void set_values(const double* values);
+
+  double*              m_long;       // (kappa, gamma, Fz)
+  double*              m_lat;        // (alpha, gamma, Fz) x 2
+  double*              m_combined;   // (kappa, alpha, gamma, Fz) x NUM_COMBINED
+  size_t               m_num_long;
+  size_t               m_num_lat;
+  size_t               m_num_combined;
+
+  std::vector<double>  m_values;     // values owned by the table (empty if shared)
+
+  ChVector<>           m_err_pure;
+  ChVector<>           m_err_combined;
+};
+
+
+} // end namespace chrono
+
+
+#endif
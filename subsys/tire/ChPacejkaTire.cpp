@@ -17,12 +17,20 @@
 // =============================================================================
 
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 
 #include "core/ChTimer.h"
 
 #include "subsys/tire/ChPacejkaTire.h"
 #include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChPac2002_cache.h"
+#include "subsys/tire/ChPac2002_registry.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChStartupProfiler.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChSharedModelData.h"
 
 namespace chrono {
 
@@ -42,26 +50,86 @@ static double Mx_thresh = Fz_thresh/20.0;
 static double My_thresh = Fx_thresh/20.0;
 static double Mz_thresh = Fz_thresh/20.0;
 
-static double kappaP_thresh = 0.01;
-static double alphaP_thresh = 0.1;
-static double gammaP_thresh = 0.05;
-static double phiP_thresh = 99;
-static double phiT_thresh = 99;
+// camber reduction factor of the turn slip (hard-coded, for now)
+static const double eps_gamma = 0.6;
+
+// capacity of the diagnostic record queue
+static const size_t diag_queue_size = 64;
+
+bool ChPacejkaTire::m_use_param_cache = true;
+
+// Keys of the parameter blocks and tables in the shared model data segment.
+static std::string PAC_sharedKey(unsigned long long checksum)
+{
+  char buf[64];
+  sprintf(buf, "pac2002/%016llx", checksum);
+  return buf;
+}
+
+static std::string PAC_sharedKey(unsigned long long checksum, const ChPacejkaTable::Settings& s)
+{
+  char buf[256];
+  sprintf(buf, "pac2002_table/%016llx/%d/%d/%d/%d/%d/%d/%.17g/%.17g", checksum, (int)s.interpolation,
+          s.num_kappa, s.num_alpha, s.num_gamma, s.num_Fz, s.pure_refinement, s.kappa_lim, s.alpha_lim);
+  return buf;
+}
 
 // -----------------------------------------------------------------------------
 // Constructors
 // -----------------------------------------------------------------------------
 ChPacejkaTire::ChPacejkaTire(const std::string& name,
                              const std::string& pacTire_paramFile,
-                             const ChTerrain&   terrain)
+                             const ChTerrain&   terrain,
+                             const ChPacejkaTable::Settings& tabulation)
 : ChTire(name, terrain),
   m_paramFile(pacTire_paramFile),
   m_params_defined(false),
+  m_paramBlock(0),
+  m_params(0),
+  m_tabulation(tabulation),
+  m_table(0),
   m_use_transient_slip(true),
   m_use_Fz_override(false),
-  m_step_size(default_step_size)
+  m_step_size(default_step_size),
+  m_integrator(RK4_FIXED),
+  m_substep_factor(0.5),
+  m_bessel_Cx(600),
+  m_bessel_Cy(100),
+  m_bessel_V_low(2),
+  m_defer_slip_from_uv(false),
+  m_implicit_Fz(false),
+  m_implicit_Fz_mass(0),
+  m_Fz_prev(0),
+  m_contact_vz(0),
+  m_coupling_step(0),
+  m_auto_transient(false),
+  m_auto_rate_tol(0.05),
+  m_auto_lag_tol(1e-4),
+  m_auto_speed_factor(4),
+  m_quasi_steady(false),
+  m_env_num_long(1),
+  m_env_num_lat(1),
+  m_env_length(0),
+  m_env_width(0),
+  m_mu_scale(1),
+  m_fast_math(false),
+  m_use_thermal(false),
+  m_grip_tol(1e-3),
+  m_grip_scale(1),
+  m_loadCoefs_valid(false),
+  m_coef_tol_dF_z(0),
+  m_coef_tol_gamma(0),
+  m_num_coef_cache_hits(0),
+  m_num_coef_cache_misses(0),
+  m_out_format(vehicle::ChOutputChannel::CSV),
+  m_out(0),
+  m_out_max_gap(0),
+  m_diag_dropped(0),
+  m_diag_active(0),
+  m_diag_queue(diag_queue_size)
 {
-
+  for (int i = 0; i < NUM_DIAGNOSTICS; i++)
+    m_diag_count[i] = 0;
 }
 
 
@@ -69,16 +137,58 @@ ChPacejkaTire::ChPacejkaTire(const std::string& name,
                              const std::string& pacTire_paramFile,
                              const ChTerrain&   terrain,
                              double             Fz_override,
-                             bool               use_transient_slip)
+                             bool               use_transient_slip,
+                             const ChPacejkaTable::Settings& tabulation)
 : ChTire(name, terrain),
   m_paramFile(pacTire_paramFile),
   m_params_defined(false),
+  m_paramBlock(0),
+  m_params(0),
+  m_tabulation(tabulation),
+  m_table(0),
   m_use_transient_slip(use_transient_slip),
   m_use_Fz_override(Fz_override > 0),
   m_Fz_override(Fz_override),
-  m_step_size(default_step_size)
+  m_step_size(default_step_size),
+  m_integrator(RK4_FIXED),
+  m_substep_factor(0.5),
+  m_bessel_Cx(600),
+  m_bessel_Cy(100),
+  m_bessel_V_low(2),
+  m_defer_slip_from_uv(false),
+  m_implicit_Fz(false),
+  m_implicit_Fz_mass(0),
+  m_Fz_prev(0),
+  m_contact_vz(0),
+  m_coupling_step(0),
+  m_auto_transient(false),
+  m_auto_rate_tol(0.05),
+  m_auto_lag_tol(1e-4),
+  m_auto_speed_factor(4),
+  m_quasi_steady(false),
+  m_env_num_long(1),
+  m_env_num_lat(1),
+  m_env_length(0),
+  m_env_width(0),
+  m_mu_scale(1),
+  m_fast_math(false),
+  m_use_thermal(false),
+  m_grip_tol(1e-3),
+  m_grip_scale(1),
+  m_loadCoefs_valid(false),
+  m_coef_tol_dF_z(0),
+  m_coef_tol_gamma(0),
+  m_num_coef_cache_hits(0),
+  m_num_coef_cache_misses(0),
+  m_out_format(vehicle::ChOutputChannel::CSV),
+  m_out(0),
+  m_out_max_gap(0),
+  m_diag_dropped(0),
+  m_diag_active(0),
+  m_diag_queue(diag_queue_size)
 {
-
+  for (int i = 0; i < NUM_DIAGNOSTICS; i++)
+    m_diag_count[i] = 0;
 }
 
 
@@ -89,8 +199,11 @@ ChPacejkaTire::ChPacejkaTire(const std::string& name,
 // -----------------------------------------------------------------------------
 ChPacejkaTire::~ChPacejkaTire()
 {
+  ReportDiagnostics();
+
   delete m_slip;
-  delete m_params;
+  if (m_paramBlock)
+    ChPac2002Registry::Release(m_paramBlock);
   delete m_pureLong;
   delete m_pureLat;
   delete m_pureTorque;
@@ -98,8 +211,10 @@ ChPacejkaTire::~ChPacejkaTire()
   delete m_combinedLat;
   delete m_combinedTorque;
   delete m_zeta;
+  delete m_loadCoefs;
   delete m_relaxation;
   delete m_bessel;
+  delete m_out;
 }
 
 
@@ -111,7 +226,6 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   m_driven = driven;
   // Create private structures
   m_slip = new slips;
-  m_params = new Pac2002_data;
 
   m_pureLong = new pureLongCoefs;
   m_pureLat = new pureLatCoefs;
@@ -124,6 +238,8 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   // m_combinedTorque->M_z_x = 0;
   // m_combinedTorque->M_z_y = 0;
   m_zeta = new zetaCoefs;
+  m_loadCoefs = new loadCoefs;
+  m_loadCoefs_valid = false;
   m_relaxation = new relaxationL;
   m_bessel = new bessel;
 
@@ -131,9 +247,17 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   m_time_since_last_step = 0;
   m_initial_step = false; // have not taken a step at time = 0 yet
   m_num_ODE_calls = 0;
+  m_num_ODE_substeps = 0;
   m_sum_ODE_time = 0.0;
   m_num_Advance_calls = 0;
   m_sum_Advance_time = 0.0;
+  m_quasi_steady = false;
+  m_slip_prev_valid = false;
+  m_kappa_prev = 0;
+  m_alpha_prev = 0;
+  m_gamma_prev = 0;
+  m_sum_transient_time = 0.0;
+  m_sum_steady_time = 0.0;
 
   // load all the empirical tire parameters from *.tir file
   loadPacTireParamFile();
@@ -142,7 +266,7 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   ////        Right now, we cannot have this function throw an exception since
   ////        it's called from the constructor!   Must fix this...
   if (!m_params_defined) {
-    GetLog() << " couldn't load pacTire parameters from file, not updating initial quantities \n\n";
+    vehicle::GetContextLog() << " couldn't load pacTire parameters from file, not updating initial quantities \n\n";
     return;
   }
 
@@ -184,48 +308,243 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   // init all other variables
   m_Num_WriteOutData = 0;
   zero_slips();  // zeros slips, and some other vars
+
+  // tabulate the Magic Formula curves, shared by all tires using this
+  // parameter block with the same settings
+  if (m_tabulation.enabled)
+    buildTable();
 }
 
 
 // -----------------------------------------------------------------------------
 // Return computed tire forces and moment (pure slip or combined slip and in
 // local or global frame). The main GetTireForce() function returns the combined
-// slip tire forces, expressed in the global frame.
+// slip tire forces, expressed in the global frame. The global (and wheel) frame
+// reactions are evaluated in update_reaction_frames(), whenever the reactions
+// or the contact frame change.
 // -----------------------------------------------------------------------------
 ChTireForce ChPacejkaTire::GetTireForce() const
 {
-  return GetTireForce_combinedSlip(false);
+  return m_FM_combined_global;
 }
 
 ChTireForce ChPacejkaTire::GetTireForce_pureSlip(const bool local) const
 {
-  if (local)
-    return m_FM_pure;
+  return local ? m_FM_pure : m_FM_pure_global;
+}
 
-  // reactions are on wheel CM
-  ChTireForce m_FM_global;
-  m_FM_global.point = m_tireState.pos;
-  // only transform the directions of the forces, moments, from local to global
-  m_FM_global.force = m_W_frame.TransformDirectionLocalToParent(m_FM_pure.force);
-  m_FM_global.moment = m_W_frame.TransformDirectionLocalToParent(m_FM_pure.moment);
+ChTireForce ChPacejkaTire::GetTireForce_combinedSlip(const bool local) const
+{
+  return local ? m_FM_combined : m_FM_combined_global;
+}
+
+// -----------------------------------------------------------------------------
+// Linearization of the combined slip reactions, in the contact frame:
+//   kappa = (omega R_eff - V_x) / |V_x|  ->  dFx/dV_x = -C_Fx omega R_eff / (V_x |V_x|)
+//                                            dFx/domega = C_Fx R_eff / |V_x|
+//   alpha = V_y / |V_x|                  ->  dFy/dV_y = -C_Fy / |V_x|
+//   Fz = k depth - c v_z                 ->  dFz/dz = -k, dFz/dv_z = -c
+// The slip stiffnesses are scaled by (1 - |F| / D), the slope of a force that
+// saturates exponentially at its peak value D, so that the linearization does
+// not overshoot the friction limit.
+// -----------------------------------------------------------------------------
+bool ChPacejkaTire::GetForceJacobian(ChTireForceJacobian& jacobian) const
+{
+  if (!m_params_defined || !m_in_contact || (m_diag_active & (1 << DIAG_LOW_VELOCITY)))
+    return false;
 
-  return m_FM_global;
+  ChVector<> V = m_W_frame.TransformDirectionParentToLocal(m_tireState.lin_vel);
+  double V_x_abs = std::max(std::abs(V.x), m_params->model.vxlow);
+  double V_x = (V.x < 0) ? -V_x_abs : V_x_abs;
+
+  double f_x = (m_pureLong->D_x > 0) ? std::max(1 - std::abs(m_FM_combined.force.x) / m_pureLong->D_x, 0.0) : 0;
+  double f_y = (m_pureLat->D_y > 0) ? std::max(1 - std::abs(m_FM_combined.force.y) / m_pureLat->D_y, 0.0) : 0;
+
+  double dFx_dvx = -m_C_Fx * f_x * m_tireState.omega * m_R_eff / (V_x * V_x_abs);
+  double dFy_dvy = -m_C_Fy * f_y / V_x_abs;
+  double dFz_dvz = -m_params->vertical.vertical_damping;
+  double dFz_dz = -m_params->vertical.vertical_stiffness;
+
+  // Columns of the global Jacobians, R D R^T e_k, with R the rotation of the
+  // contact frame and D the (diagonal) Jacobian in the contact frame.
+  ChVector<>* dF_dp[3] = {&jacobian.dF_dpx, &jacobian.dF_dpy, &jacobian.dF_dpz};
+  ChVector<>* dF_dv[3] = {&jacobian.dF_dvx, &jacobian.dF_dvy, &jacobian.dF_dvz};
+  for (int k = 0; k < 3; k++) {
+    ChVector<> e(k == 0 ? 1 : 0, k == 1 ? 1 : 0, k == 2 ? 1 : 0);
+    ChVector<> e_loc = m_W_frame.TransformDirectionParentToLocal(e);
+    *dF_dp[k] = m_W_frame.TransformDirectionLocalToParent(ChVector<>(0, 0, dFz_dz * e_loc.z));
+    *dF_dv[k] = m_W_frame.TransformDirectionLocalToParent(
+      ChVector<>(dFx_dvx * e_loc.x, dFy_dvy * e_loc.y, dFz_dvz * e_loc.z));
+  }
+  jacobian.dF_domega = m_W_frame.TransformDirectionLocalToParent(
+    ChVector<>(m_C_Fx * f_x * m_R_eff / V_x_abs, 0, 0));
+
+  return true;
 }
 
-/// Return the reactions for the combined slip EQs, in local or global coords
-ChTireForce ChPacejkaTire::GetTireForce_combinedSlip(const bool local) const
+// -----------------------------------------------------------------------------
+// Frictional power in the contact patch, from the slip velocities and the
+// combined slip forces. The grip factor applied to the Magic Formula follows
+// the thermal model in increments of at least m_grip_tol, such that the
+// friction dependent coefficients are only recomputed then.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::update_thermal(double step)
 {
-  if (local)
-    return m_FM_combined;
+  if (!m_use_thermal)
+    return;
+
+  double power = 0;
+  if (m_in_contact)
+    power = std::abs(m_FM_combined.force.x * m_slip->V_sx) + std::abs(m_FM_combined.force.y * m_slip->V_sy);
+
+  if (!m_thermal.Accumulate(power, m_slip->V_cx, step))
+    return;
+
+  double grip = m_thermal.GetGripFactor();
+  if (std::abs(grip - m_grip_scale) > m_grip_tol)
+    m_grip_scale = grip;
+}
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::update_reaction_frames()
+{
   // reactions are on wheel CM
-  ChTireForce m_FM_global;
-  m_FM_global.point = m_W_frame.pos;
   // only transform the directions of the forces, moments, from local to global
-  m_FM_global.force = m_W_frame.TransformDirectionLocalToParent(m_FM_combined.force);
-  m_FM_global.moment = m_W_frame.TransformDirectionLocalToParent(m_FM_combined.moment);
+  m_FM_pure_global.point = m_tireState.pos;
+  m_FM_pure_global.force = m_W_frame.TransformDirectionLocalToParent(m_FM_pure.force);
+  m_FM_pure_global.moment = m_W_frame.TransformDirectionLocalToParent(m_FM_pure.moment);
+
+  m_FM_combined_global.point = m_W_frame.pos;
+  m_FM_combined_global.force = m_W_frame.TransformDirectionLocalToParent(m_FM_combined.force);
+  m_FM_combined_global.moment = m_W_frame.TransformDirectionLocalToParent(m_FM_combined.moment);
+
+  // wheel frame, from the global frame
+  m_FM_combined_wheel.point = m_tireState.rot.RotateBack(m_W_frame.pos - m_tireState.pos);
+  m_FM_combined_wheel.force = m_tireState.rot.RotateBack(m_FM_combined_global.force);
+  m_FM_combined_wheel.moment = m_tireState.rot.RotateBack(m_FM_combined_global.moment);
+}
+
+
+// -----------------------------------------------------------------------------
+// Save and restore the internal tire state. The slips, relaxation and bessel
+// structures contain only doubles and are copied as such. Model coefficients
+// that are recomputed at every step from these quantities are not saved.
+// -----------------------------------------------------------------------------
+static const size_t SLIPS_SIZE = sizeof(slips) / sizeof(double);
+static const size_t RELAXATION_SIZE = sizeof(relaxationL) / sizeof(double);
+static const size_t BESSEL_SIZE = sizeof(bessel) / sizeof(double);
+
+static const size_t PACEJKA_STATE_SIZE = vehicle::ChVehicleState::WHEEL_STATE_SIZE +
+                                         vehicle::ChVehicleState::COORDSYS_SIZE +
+                                         4 * vehicle::ChVehicleState::TIRE_FORCE_SIZE + 9 +
+                                         SLIPS_SIZE + RELAXATION_SIZE + BESSEL_SIZE +
+                                         ChTireThermal::STATE_SIZE + 2;
+
+void ChPacejkaTire::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(PACEJKA_STATE_SIZE);
+
+  state.Write(m_tireState);
+  state.Write(m_W_frame);
+
+  state.Write(m_FM_pure);
+  state.Write(m_FM_combined);
+  state.Write(m_FM_pure_last);
+  state.Write(m_FM_combined_last);
+
+  state.Write(m_simTime);
+  state.Write(m_in_contact ? 1.0 : 0.0);
+  state.Write(m_depth);
+  state.Write(m_R_eff);
+  state.Write(m_R_l);
+  state.Write(m_Fz);
+  state.Write(m_dF_z);
+  state.Write(m_time_since_last_step);
+  state.Write(m_initial_step ? 1.0 : 0.0);
+
+  state.Write(reinterpret_cast<const double*>(m_slip), SLIPS_SIZE);
+  state.Write(reinterpret_cast<const double*>(m_relaxation), RELAXATION_SIZE);
+  state.Write(reinterpret_cast<const double*>(m_bessel), BESSEL_SIZE);
+
+  double thermal[ChTireThermal::STATE_SIZE];
+  m_thermal.GetState(thermal);
+  state.Write(thermal, ChTireThermal::STATE_SIZE);
+  state.Write(m_grip_scale);
+  state.Write(m_Fz_prev);
+}
+
+bool ChPacejkaTire::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(PACEJKA_STATE_SIZE, m_name.c_str()))
+    return false;
+
+  m_tireState = state.ReadWheelState();
+  m_W_frame = state.ReadCoordsys();
+
+  m_FM_pure = state.ReadTireForce();
+  m_FM_combined = state.ReadTireForce();
+  m_FM_pure_last = state.ReadTireForce();
+  m_FM_combined_last = state.ReadTireForce();
+
+  m_simTime = state.Read();
+  m_in_contact = (state.Read() != 0);
+  m_depth = state.Read();
+  m_R_eff = state.Read();
+  m_R_l = state.Read();
+  m_Fz = state.Read();
+  m_dF_z = state.Read();
+  m_time_since_last_step = state.Read();
+  m_initial_step = (state.Read() != 0);
+
+  state.Read(reinterpret_cast<double*>(m_slip), SLIPS_SIZE);
+  state.Read(reinterpret_cast<double*>(m_relaxation), RELAXATION_SIZE);
+  state.Read(reinterpret_cast<double*>(m_bessel), BESSEL_SIZE);
+
+  double thermal[ChTireThermal::STATE_SIZE];
+  state.Read(thermal, ChTireThermal::STATE_SIZE);
+  m_thermal.SetState(thermal);
+  m_grip_scale = state.Read();
+  m_Fz_prev = state.Read();
+
+  // the slip rates are not part of the state
+  m_quasi_steady = false;
+  m_slip_prev_valid = false;
+  update_reaction_frames();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  typedef vehicle::ChMemoryReport R;
+
+  report.Add("tire/objects", sizeof(ChPacejkaTire) + R::StringBytes(m_paramFile) + R::StringBytes(m_outFilename) +
+                             R::VectorBytes(m_out_tol));
+
+  if (m_slip) {
+    report.Add("tire/Pacejka coefficients",
+               sizeof(slips) + sizeof(pureLongCoefs) + sizeof(pureLatCoefs) + sizeof(pureTorqueCoefs) +
+               sizeof(combinedLongCoefs) + sizeof(combinedLatCoefs) + sizeof(combinedTorqueCoefs) +
+               sizeof(zetaCoefs) + sizeof(loadCoefs) + sizeof(relaxationL) + sizeof(bessel));
+  }
 
-  return m_FM_global;
+  report.Add("tire/diagnostics", m_diag_queue.GetCapacity() * sizeof(DiagnosticRecord));
+
+  if (m_out)
+    report.Add("output/tire channels", sizeof(vehicle::ChOutputChannel) + m_out->GetMemoryFootprint());
+
+  if (m_paramBlock) {
+    report.AddShared("shared/Pacejka parameters", m_paramBlock,
+                     sizeof(ChPac2002Params) + R::StringBytes(m_paramBlock->filename) +
+                     R::VectorBytes(m_paramBlock->tables));
+    for (size_t i = 0; i < m_paramBlock->tables.size(); i++)
+      report.AddShared("shared/Pacejka tables", m_paramBlock->tables[i], m_paramBlock->tables[i]->GetMemoryFootprint());
+  }
+
+  ChTire::AddMemoryFootprint(report);
 }
 
 
@@ -242,7 +561,7 @@ void ChPacejkaTire::Update(double               time,
   // Check that input tire model parameters are defined
   if (!m_params_defined)
   {
-    GetLog() << " ERROR: cannot update tire w/o setting the model parameters first! \n\n\n";
+    record_diagnostics(1 << DIAG_NO_PARAMS, 1 << DIAG_NO_PARAMS);
     return;
   }
 
@@ -254,9 +573,10 @@ void ChPacejkaTire::Update(double               time,
   // If not using the transient slip model, check that the tangential forward
   // velocity is not too small.
   ChVector<> V = m_W_frame.TransformDirectionParentToLocal(m_tireState.lin_vel);
-  if (!m_use_transient_slip && std::abs(V.x) < 0.1)
-  {
-    GetLog() << " ERROR: tangential forward velocity below threshold.... \n\n";
+  int low_velocity = (!m_use_transient_slip && std::abs(V.x) < 0.1) << DIAG_LOW_VELOCITY;
+  record_diagnostics(low_velocity, 1 << DIAG_LOW_VELOCITY);
+  if (low_velocity) {
+    update_reaction_frames();
     return;
   }
 
@@ -273,6 +593,7 @@ void ChPacejkaTire::Update(double               time,
   m_FM_combined.point = ChVector<>();
   m_FM_combined.force = ChVector<>();
   m_FM_combined.moment = ChVector<>();
+  update_reaction_frames();
 }
 
 
@@ -298,10 +619,65 @@ void ChPacejkaTire::Advance(double step)
   }
   */
 
+  // only count the time take to do actual calculations in Adanvce time
+  advance_time.start();
+
+  // Calculate the slip quantities used as input to the Magic Formula
+#if PROFILING_ENABLED
+  int num_substeps = m_num_ODE_substeps;
+#endif
+  advance_slips(step);
+  CH_PROFILE_COUNTER("ChPacejkaTire::substeps", m_num_ODE_substeps - num_substeps);
+
+  // Use the tabulated curves if available and the slips are within range
+  if (!m_table || !tabulatedSlipReactions( ))
+  {
+    // Calculate the force and moment reaction, pure slip case
+    pureSlipReactions( );
+
+    // Update m_FM_combined.forces, m_FM_combined.moment.z
+    combinedSlipReactions( );
+  }
+
+  // all the reactions have been calculated, stop the advance timer
+  advance_time.stop();
+  m_sum_Advance_time += advance_time();
+
+  // Update Mx, My and evaluate the reaction forces calculated
+  finalize_reactions();
+  update_thermal(step);
+}
+
+// -----------------------------------------------------------------------------
+// Advance the slip quantities over the specified step.
+// If using the transient slip model, perform integration taking as many
+// integration steps as needed; otherwise, use the kinematic slips.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::advance_slips(double step)
+{
+  m_coupling_step = step;
+
   // If using single point contact model, slips are calculated from compliance
   // between tire and contact patch.
   if (m_use_transient_slip)
   {
+    // In quasi-steady conditions, skip the integration of the slip ODEs and
+    // use their equilibrium instead.
+    if (m_auto_transient)
+    {
+      update_verticalLoad(step);
+      slip_kinematic();
+      relaxationLengths();
+      m_quasi_steady = check_quasi_steady(step);
+      if (m_quasi_steady)
+      {
+        slip_steady_transient();
+        m_sum_steady_time += step;
+        return;
+      }
+    }
+    m_sum_transient_time += step;
+
     // 1 of 2 ways to deal with user input time step increment
 
     
@@ -309,18 +685,32 @@ void ChPacejkaTire::Advance(double step)
     // a) step <= m_step_size, so integrate using input step
     // b) step > m_step_size, use m_step_size until step <= m_step_size
     double remaining_time = step;
-    // only count the time take to do actual calculations in Adanvce time
-    advance_time.start();
     // keep track of the ODE calculation time
     ChTimer<double> ODE_timer;
     ODE_timer.start();
-    while (remaining_time > m_step_size)
+    if (m_integrator == EXPONENTIAL)
     {
-      advance_tire(m_step_size);
-      remaining_time -= m_step_size;
+      // sub-step from the relaxation lengths at the current vertical load
+      update_verticalLoad(step);
+      relaxationLengths();
+      while (remaining_time > 0)
+      {
+        double h = transient_substep(remaining_time);
+        advance_tire(h);
+        remaining_time -= h;
+        m_num_ODE_substeps++;
+      }
+    } else {
+      while (remaining_time > m_step_size)
+      {
+        advance_tire(m_step_size);
+        remaining_time -= m_step_size;
+        m_num_ODE_substeps++;
+      }
+      // take one final step to reach the specified time.
+      advance_tire(remaining_time);
+      m_num_ODE_substeps++;
     }
-    // take one final step to reach the specified time.
-    advance_tire(remaining_time);
     
     // stop the timers
     ODE_timer.stop();
@@ -337,8 +727,6 @@ void ChPacejkaTire::Advance(double step)
     // enough time has accumulated to do a macro step, OR, it's the first step
     if( m_time_since_last_step >= m_step_size || !m_initial_step)
     {
-      // only count the time take to do actual calculations in Adanvce time
-      advance_time.start();
       // keep track of the ODE calculation time
       ChTimer<double> ODE_timer;
       ODE_timer.start();
@@ -362,12 +750,16 @@ void ChPacejkaTire::Advance(double step)
     // Calculate kinematic slip quantities
     slip_kinematic();
   }
+}
 
-  // Calculate the force and moment reaction, pure slip case
-  pureSlipReactions( );
-
-  // Update m_FM_combined.forces, m_FM_combined.moment.z
-  combinedSlipReactions( );
+// -----------------------------------------------------------------------------
+// Calculate the overturning and rolling resistance moments from the combined
+// slip reactions, then evaluate the complete set of reactions.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::finalize_reactions()
+{
+  // vertical load of this step, for the implicit vertical load of the next one
+  m_Fz_prev = m_in_contact ? m_Fz : 0;
 
   // Update M_x, apply to both m_FM and m_FM_combined
   // gamma should already be corrected for L/R side, so need to swap Fy if on opposite side
@@ -381,18 +773,16 @@ void ChPacejkaTire::Advance(double step)
   m_FM_pure.moment.y = My;
   m_FM_combined.moment.y = My;
 
-  // all the reactions have been calculated, stop the advance timer
-  advance_time.stop();
-  m_sum_Advance_time += advance_time();
-
-
   // DEBUGGING
   //m_FM_combined.moment.y = 0;
   // m_FM_combined.moment.z = 0;
 
 
-  // evaluate the reaction forces calculated
+  // check the slips and the reaction forces calculated
+  evaluate_slips();
   evaluate_reactions(false, false);
+
+  update_reaction_frames();
 }
 
 void ChPacejkaTire::advance_tire(double step)
@@ -411,6 +801,34 @@ void ChPacejkaTire::advance_tire(double step)
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::SetEnvelopingContact(int    num_long,
+                                         int    num_lat,
+                                         double length,
+                                         double width)
+{
+  m_env_num_long = (num_long > 1) ? num_long : 1;
+  m_env_num_lat = (num_lat > 1) ? num_lat : 1;
+  m_env_length = length;
+  m_env_width = width;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::SetAutoTransient(bool   enable,
+                                     double slip_rate_tol,
+                                     double slip_lag_tol,
+                                     double speed_factor)
+{
+  m_auto_transient = enable;
+  m_auto_rate_tol = slip_rate_tol;
+  m_auto_lag_tol = slip_lag_tol;
+  m_auto_speed_factor = speed_factor;
+  m_quasi_steady = false;
+}
+
+
 // Calculate the tire contact coordinate system.
 // TYDEX W-axis system is at the contact point "C", Z-axis normal to the terrain
 //  and X-axis along the wheel centerline.
@@ -420,10 +838,23 @@ void ChPacejkaTire::advance_tire(double step)
 void ChPacejkaTire::update_W_frame()
 {
   // Check contact with terrain, using a disc of radius R0.
+  // This also returns the terrain normal at the wheel center location
+  // (expressed in global frame), from the same batched terrain query.
+  // With the enveloping contact model, the terrain is replaced by the
+  // effective road plane under the footprint.
   ChCoordsys<> contact_frame;
   double       depth;
-  m_in_contact = disc_terrain_contact(m_tireState.pos, m_tireState.rot.GetYaxis(), m_R0,
-                                      contact_frame, depth);
+  ChVector<>   Z_dir;
+  if (IsEnvelopingContact()) {
+    m_in_contact = envelope_terrain_contact(m_tireState.pos, m_tireState.rot.GetYaxis(), m_R0,
+                                            m_env_num_long, m_env_num_lat, m_env_length, m_env_width,
+                                            contact_frame, depth, Z_dir);
+  } else {
+    char in_contact;
+    disc_terrain_contact(1, &m_tireState.pos, m_tireState.rot.GetYaxis(), m_R0,
+                         &in_contact, &contact_frame, &depth, &Z_dir);
+    m_in_contact = (in_contact != 0);
+  }
 
   // set the depth if there is contact with terrain
   m_depth = (m_in_contact) ? depth : 0;
@@ -431,9 +862,6 @@ void ChPacejkaTire::update_W_frame()
   // Wheel normal (expressed in global frame)
   ChVector<> wheel_normal = m_tireState.rot.GetYaxis();
 
-  // Terrain normal at wheel center location (expressed in global frame)
-  ChVector<> Z_dir = m_terrain.GetNormal(m_tireState.pos.x, m_tireState.pos.y);
-
   // Longitudinal (heading) and lateral directions, in the terrain plane.
   ChVector<> X_dir = Vcross(wheel_normal, Z_dir);
   X_dir.Normalize();
@@ -446,6 +874,11 @@ void ChPacejkaTire::update_W_frame()
   // W-Axis system position at the contact point
   m_W_frame.pos = contact_frame.pos;
   m_W_frame.rot = rot.Get_A_quaternion();
+
+  // Terrain friction and thermal grip scaling of the lambda_mu factors at the
+  // contact point (bounded away from zero, since the Magic Formula divides by
+  // the peak value)
+  m_mu_scale = m_in_contact ? std::max(friction_scale(contact_frame.pos) * m_grip_scale, 1e-3) : 1;
 }
 
 
@@ -475,6 +908,8 @@ void ChPacejkaTire::update_verticalLoad(double step)
     // this also sets the statically loaded radius m_R_l, as well as the boolean
     // flag m_in_contact.
     Fz = calc_Fz();
+    if (m_implicit_Fz && m_in_contact)
+      Fz = implicit_Fz(Fz);
     // assert( Fz >= m_params->vertical_force_range.fzmin);
 
     double capped_Fz = 0;
@@ -503,13 +938,14 @@ void ChPacejkaTire::update_verticalLoad(double step)
 
   // Calculate tire vertical deflection, rho.
   double qV1 = 0.000071;      // from example
-  double K1 = pow(m_tireState.omega * m_R0 / m_params->model.longvl, 2);
+  double V_ratio = m_tireState.omega * m_R0 / m_params->model.longvl;
+  double K1 = V_ratio * V_ratio;
   double rho = m_R0 - m_R_l + qV1 * m_R0 * K1;
   double rho_Fz0 = m_params->vertical.fnomin / (m_params->vertical.vertical_stiffness);
   double rho_d = rho / rho_Fz0;
 
   // Calculate tire rolling radius, R_eff.  Clamp this value to R0.
-  m_R_eff = m_R0 + qV1 * m_R0 * K1 - rho_Fz0 * (m_params->vertical.dreff * std::atan(m_params->vertical.breff * rho_d) + m_params->vertical.freff * rho_d);
+  m_R_eff = m_R0 + qV1 * m_R0 * K1 - rho_Fz0 * (m_params->vertical.dreff * mf_atan(m_params->vertical.breff * rho_d) + m_params->vertical.freff * rho_d);
   if (m_R_eff > m_R0)
     m_R_eff = m_R0;
 
@@ -535,6 +971,7 @@ double ChPacejkaTire::calc_Fz()
   // global frame and then express it in the contact frame.
   ChVector<> relvel_abs = m_tireState.lin_vel + Vcross(m_tireState.ang_vel, m_W_frame.pos - m_tireState.pos);
   ChVector<> relvel_loc = m_W_frame.TransformDirectionParentToLocal(relvel_abs);
+  m_contact_vz = relvel_loc.z;
 
   // Calculate normal contact force, using a spring-damper model.
   // Note: depth is always positive, so the damping should always subtract
@@ -573,6 +1010,28 @@ double ChPacejkaTire::calc_Fz()
   // return Fz_adams;
 }
 
+// -----------------------------------------------------------------------------
+// Backward Euler value of the linear spring-damper over the coupling step h,
+// for the effective wheel mass m: with depth' = depth - h v' and
+// v' - v = h / m (Fz' - Fz_prev),
+//   Fz' = (Fz - k h v + beta Fz_prev) / (1 + beta),  beta = (k h + c) h / m
+// The step h does not depend on the sub-steps of the transient slip ODEs, so
+// the result is the same for all calls during one step.
+// -----------------------------------------------------------------------------
+double ChPacejkaTire::implicit_Fz(double Fz) const
+{
+  if (Fz <= m_params->vertical_force_range.fzmin)
+    return Fz;
+
+  double h = m_coupling_step;
+  double k = m_params->vertical.vertical_stiffness;
+  double c = m_params->vertical.vertical_damping;
+  double beta = (k * h + c) * h / m_implicit_Fz_mass;
+  double Fz_imp = (Fz - k * h * m_contact_vz + beta * m_Fz_prev) / (1 + beta);
+
+  return std::max(Fz_imp, m_params->vertical_force_range.fzmin);
+}
+
 
 // -----------------------------------------------------------------------------
 // Calculate kinematic slip quantities from the current wheel state.
@@ -673,8 +1132,6 @@ void ChPacejkaTire::zero_slips( )
 // -----------------------------------------------------------------------------
 void ChPacejkaTire::advance_slip_transient(double step_size)
 {
-  // hard-coded, for now
-  double EPS_GAMMA = 0.6;
   // update relaxation lengths
   relaxationLengths();
 
@@ -687,6 +1144,11 @@ void ChPacejkaTire::advance_slip_transient(double step_size)
   double gamma = m_slip->gamma * m_sameSide;  // due to asymmetry
   // see if low velocity considerations should be made
   double alpha_sl = std::abs( 3.0 * m_pureLat->D_y / m_relaxation->C_Falpha);
+  // with the EXPONENTIAL integrator, the linear ODEs are solved exactly over
+  // the step, for the coefficients at the start of the step
+  bool exact = (m_integrator == EXPONENTIAL);
+  double lambda_kappa = V_cx_abs / m_relaxation->sigma_kappa;
+  double lambda_alpha = V_cx_abs / m_relaxation->sigma_alpha;
   // Eq. 7.25 from Pacejka (2006), solve du_dt and dvalpha_dt
   if ((std::abs(m_combinedTorque->alpha_r_eq) > alpha_sl) && (V_cx_abs < V_cx_low))
   {
@@ -694,7 +1156,8 @@ void ChPacejkaTire::advance_slip_transient(double step_size)
     if ((V_sx + V_cx_abs * m_slip->u / m_relaxation->sigma_kappa) * m_slip->u >= 0)
     {
       // solve the ODE using RK - 45 integration
-      m_slip->Idu_dt = ODE_RK_uv(V_sx, m_relaxation->sigma_kappa, V_cx, step_size, m_slip->u);
+      m_slip->Idu_dt = exact ? ODE_exp(-V_sx, lambda_kappa, step_size, m_slip->u) :
+                               ODE_RK_uv(V_sx, m_relaxation->sigma_kappa, V_cx, step_size, m_slip->u);
       m_slip->u += m_slip->Idu_dt;
     } else {
       m_slip->Idu_dt = 0;
@@ -703,7 +1166,8 @@ void ChPacejkaTire::advance_slip_transient(double step_size)
     // Eq. 7.7, else dv/dt = 0 and v remains unchanged
     if ((V_sy + std::abs(V_cx) * m_slip->v_alpha / m_relaxation->sigma_alpha) * m_slip->v_alpha >= 0)
     {
-      m_slip->Idv_alpha_dt = ODE_RK_uv(V_sy, m_relaxation->sigma_alpha, V_cx, step_size, m_slip->v_alpha);
+      m_slip->Idv_alpha_dt = exact ? ODE_exp(-V_sy, lambda_alpha, step_size, m_slip->v_alpha) :
+                                     ODE_RK_uv(V_sy, m_relaxation->sigma_alpha, V_cx, step_size, m_slip->v_alpha);
       m_slip->v_alpha +=  m_slip->Idv_alpha_dt;
     } else {
       m_slip->Idv_alpha_dt = 0;
@@ -713,112 +1177,302 @@ void ChPacejkaTire::advance_slip_transient(double step_size)
     // don't check for du/dt =0 or dv/dt = 0
 
     // Eq 7.9 
-    m_slip->Idu_dt = ODE_RK_uv(V_sx, m_relaxation->sigma_kappa, V_cx, step_size, m_slip->u);
+    m_slip->Idu_dt = exact ? ODE_exp(-V_sx, lambda_kappa, step_size, m_slip->u) :
+                             ODE_RK_uv(V_sx, m_relaxation->sigma_kappa, V_cx, step_size, m_slip->u);
     m_slip->u += m_slip->Idu_dt;
 
     // Eq. 7.7
-    m_slip->Idv_alpha_dt = ODE_RK_uv(V_sy, m_relaxation->sigma_alpha, V_cx, step_size, m_slip->v_alpha);
+    m_slip->Idv_alpha_dt = exact ? ODE_exp(-V_sy, lambda_alpha, step_size, m_slip->v_alpha) :
+                                   ODE_RK_uv(V_sy, m_relaxation->sigma_alpha, V_cx, step_size, m_slip->v_alpha);
     m_slip->v_alpha +=  m_slip->Idv_alpha_dt;
   }
 
   // Eq. 7.11, lateral force from wheel camber
-  m_slip->Idv_gamma_dt = ODE_RK_gamma(m_relaxation->C_Fgamma, m_relaxation->C_Falpha, m_relaxation->sigma_alpha,
-    V_cx, step_size, gamma, m_slip->v_gamma);
+  if (exact) {
+    double g0 = m_relaxation->C_Fgamma / m_relaxation->C_Falpha * V_cx_abs * gamma;
+    m_slip->Idv_gamma_dt = ODE_exp(g0, lambda_alpha, step_size, m_slip->v_gamma);
+  } else {
+    m_slip->Idv_gamma_dt = ODE_RK_gamma(m_relaxation->C_Fgamma, m_relaxation->C_Falpha, m_relaxation->sigma_alpha,
+      V_cx, step_size, gamma, m_slip->v_gamma);
+  }
   m_slip->v_gamma += m_slip->Idv_gamma_dt;
 
   // Eq. 7.12, total spin, phi, including slip and camber
-  m_slip->Idv_phi_dt = ODE_RK_phi(m_relaxation->C_Fphi, m_relaxation->C_Falpha,
-    V_cx, m_slip->psi_dot, m_tireState.omega, gamma, m_relaxation->sigma_alpha,
-    m_slip->v_phi, EPS_GAMMA, step_size);
+  if (exact) {
+    double sign_Vcx = (V_cx < 0) ? -1 : 1;
+    double p0 = (m_relaxation->C_Fphi / m_relaxation->C_Falpha) * sign_Vcx * (m_slip->psi_dot - (1.0 - eps_gamma) * m_tireState.omega * std::sin(gamma));
+    m_slip->Idv_phi_dt = ODE_exp(-p0, lambda_alpha, step_size, m_slip->v_phi);
+  } else {
+    m_slip->Idv_phi_dt = ODE_RK_phi(m_relaxation->C_Fphi, m_relaxation->C_Falpha,
+      V_cx, m_slip->psi_dot, m_tireState.omega, gamma, m_relaxation->sigma_alpha,
+      m_slip->v_phi, eps_gamma, step_size);
+  }
   m_slip->v_phi += m_slip->Idv_phi_dt;
 
-  // calculate slips from contact point deflections u and v
-  slip_from_uv(m_in_contact, 600.0, 100.0, 2.0);
+  // calculate slips from contact point deflections u and v (unless these are
+  // evaluated for all tires by the batch)
+  if (!m_defer_slip_from_uv)
+    slip_from_uv(m_in_contact, m_bessel_Cx, m_bessel_Cy, m_bessel_V_low);
 
 }
 
-// don't have to call this each advance_tire(), but once per macro-step (at least)
-void ChPacejkaTire::evaluate_slips()
+// -----------------------------------------------------------------------------
+// Quasi-steady conditions for automatic transient switching. The slip rates are
+// estimated from the kinematic slips of the previous step. In the steady-state
+// mode the transient slips equal their equilibrium, so the lag condition only
+// matters when entering it: the transient slips must have settled first.
+// -----------------------------------------------------------------------------
+bool ChPacejkaTire::check_quasi_steady(double step)
 {
-  if( std::abs(m_slip->kappaP) > kappaP_thresh ) {
-    GetLog() << "\n ~~~~~~~~~  kappaP exceeded threshold:, tire " << m_name << ", = " << m_slip->kappaP << "\n";
-  }
-  if( std::abs(m_slip->alphaP) > alphaP_thresh) {
-     GetLog() << "\n ~~~~~~~~~  alphaP exceeded threshold:, tire " << m_name << ", = " << m_slip->alphaP << "\n";
-  }
-  if( std::abs(m_slip->gammaP) > gammaP_thresh) {
-     GetLog() << "\n ~~~~~~~~~  gammaP exceeded threshold:, tire " << m_name << ", = " << m_slip->gammaP << "\n";
-  }
-  if( std::abs(m_slip->phiP) > phiP_thresh) {
-     GetLog() << "\n ~~~~~~~~~  phiP exceeded threshold:, tire " << m_name << ", = " << m_slip->phiP << "\n";
-  }
-  if( std::abs(m_slip->phiT) > phiT_thresh) {
-     GetLog() << "\n ~~~~~~~~~  phiT exceeded threshold:, tire " << m_name << ", = " << m_slip->phiT << "\n";
+  double kappa = m_slip->kappa;
+  double alpha = m_slip->alpha_star;
+  double gamma = m_slip->gamma;
+
+  bool steady = m_in_contact && m_slip_prev_valid && step > 0 &&
+                std::abs(m_slip->V_cx) > m_auto_speed_factor * m_bessel_V_low &&
+                std::abs(kappa - m_kappa_prev) <= m_auto_rate_tol * step &&
+                std::abs(alpha - m_alpha_prev) <= m_auto_rate_tol * step &&
+                std::abs(gamma - m_gamma_prev) <= m_auto_rate_tol * step;
+
+  if (steady && !m_quasi_steady)
+  {
+    // normalized deflections, compared with their equilibrium values
+    double kappa_lag = m_slip->u / m_relaxation->sigma_kappa - kappa;
+    double alpha_lag = m_slip->v_alpha / m_relaxation->sigma_alpha + alpha * m_sameSide;
+    double gamma_lag = m_relaxation->C_Falpha * m_slip->v_gamma / (m_relaxation->C_Fgamma * m_relaxation->sigma_alpha) - gamma * m_sameSide;
+    steady = std::abs(kappa_lag) <= m_auto_lag_tol &&
+             std::abs(alpha_lag) <= m_auto_lag_tol &&
+             std::abs(gamma_lag) <= m_auto_lag_tol;
   }
+
+  m_kappa_prev = kappa;
+  m_alpha_prev = alpha;
+  m_gamma_prev = gamma;
+  m_slip_prev_valid = true;
+
+  return steady;
 }
 
-// after calculating all the reactions, evaluate output for any fishy business
-void ChPacejkaTire::evaluate_reactions(bool write_violations, bool enforce_threshold)
+// -----------------------------------------------------------------------------
+// Steady-state solution of the slip ODEs of advance_slip_transient(), i.e. the
+// values x_inf = a / lambda of the exponential scheme (|V_cx| is above the low
+// speed cut-off, so Eq. 7.25 does not apply).
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::slip_steady_transient()
 {
-  // any thresholds exceeded? then print some details about slip state
-  bool output_slip_to_console = false;
+  double V_cx = m_slip->V_cx;
+  double V_cx_abs = std::abs(V_cx);
+  double V_sx = m_slip->V_sx;
+  double V_sy = m_slip->V_sy * m_sameSide;    // due to asymmetry about centerline
+  double gamma = m_slip->gamma * m_sameSide;  // due to asymmetry
+  double sign_Vcx = (V_cx < 0) ? -1 : 1;
+
+  double u = -V_sx * m_relaxation->sigma_kappa / V_cx_abs;
+  double v_alpha = -V_sy * m_relaxation->sigma_alpha / V_cx_abs;
+  double v_gamma = m_relaxation->C_Fgamma / m_relaxation->C_Falpha * m_relaxation->sigma_alpha * gamma;
+  double p0 = (m_relaxation->C_Fphi / m_relaxation->C_Falpha) * sign_Vcx * (m_slip->psi_dot - (1.0 - eps_gamma) * m_tireState.omega * std::sin(gamma));
+  double v_phi = -p0 * m_relaxation->sigma_alpha / V_cx_abs;
+
+  m_slip->Idu_dt = u - m_slip->u;
+  m_slip->Idv_alpha_dt = v_alpha - m_slip->v_alpha;
+  m_slip->Idv_gamma_dt = v_gamma - m_slip->v_gamma;
+  m_slip->Idv_phi_dt = v_phi - m_slip->v_phi;
+  m_slip->u = u;
+  m_slip->v_alpha = v_alpha;
+  m_slip->v_gamma = v_gamma;
+  m_slip->v_phi = v_phi;
+
+  if (!m_defer_slip_from_uv)
+    slip_from_uv(m_in_contact, m_bessel_Cx, m_bessel_Cy, m_bessel_V_low);
+}
 
-  if( abs(m_FM_combined.force.x) > Fx_thresh)
-  {
-    // GetLog() << "\n ***  !!!  ***  Fx exceeded threshold, tire " << m_name << ", = " << m_FM_combined.force.x << "\n";
-    output_slip_to_console = true;
-    if(enforce_threshold)
-      m_FM_combined.force.x = m_FM_combined.force.x * ( Fx_thresh / std::abs(m_FM_combined.force.x) );
-  }
-  if(abs(m_FM_combined.force.y) > Fy_thresh)
+// -----------------------------------------------------------------------------
+// Sub-step for the EXPONENTIAL integrator.
+// The slip ODEs relax with the time constants sigma / |V_cx|. Since the linear
+// parts are integrated exactly, the sub-step only has to resolve changes of the
+// coefficients (vertical load, relaxation lengths) and of the low speed
+// switching conditions, and can be a sizeable fraction of the shortest time
+// constant. It is never smaller than the fixed step size m_step_size. At low
+// speeds, where the ODEs switch between the two forms of Eq. 7.25, the fixed
+// step size is used.
+// -----------------------------------------------------------------------------
+double ChPacejkaTire::transient_substep(double remaining_time) const
+{
+  double V_cx_abs = std::abs(m_slip->V_cx);
+  double V_cx_low = 2.5;   // same cut-off as in advance_slip_transient()
+
+  double h = m_step_size;
+  if (V_cx_abs >= V_cx_low)
   {
-     // GetLog() << "\n ***  !!!  ***  Fy exceeded threshold, tire " << m_name << ", = " << m_FM_combined.force.y << "\n";
-     output_slip_to_console = true;
-     if(enforce_threshold)
-       m_FM_combined.force.y = m_FM_combined.force.y * ( Fy_thresh / std::abs(m_FM_combined.force.y) );
+    double sigma_min = std::min(m_relaxation->sigma_kappa, m_relaxation->sigma_alpha);
+    h = std::max(m_step_size, m_substep_factor * sigma_min / V_cx_abs);
   }
-  
+
+  return std::min(h, remaining_time);
+}
+
+// -----------------------------------------------------------------------------
+// Exact increment of dx/dt = a - lambda * x over the step, for constant a and
+// lambda >= 0:  x(t+h) = x_inf + (x - x_inf) * exp(-lambda * h), x_inf = a / lambda
+// -----------------------------------------------------------------------------
+double ChPacejkaTire::ODE_exp(double a, double lambda, double step_size, double x_curr)
+{
+  double lh = lambda * step_size;
+
+  // for very small lambda*h, use the first order expansion (avoids a / lambda)
+  if (lh < 1e-8)
+    return (a - lambda * x_curr) * step_size;
+
+  return (a / lambda - x_curr) * (1.0 - std::exp(-lh));
+}
+
+// -----------------------------------------------------------------------------
+// Check the slips and the vertical load against the ranges of validity of the
+// parameter file (RANGES sections). Out of range values are only counted and
+// queued (see record_diagnostics); the flags are set without branches.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::evaluate_slips()
+{
+  const Pac2002_data& p = *m_params;
+  int flags =
+    ((m_slip->kappaP < p.long_slip_range.kpumin) | (m_slip->kappaP > p.long_slip_range.kpumax)) << DIAG_KAPPA_RANGE |
+    ((m_slip->alphaP < p.slip_angle_range.alpmin) | (m_slip->alphaP > p.slip_angle_range.alpmax)) << DIAG_ALPHA_RANGE |
+    ((m_slip->gammaP < p.inclination_angle_range.cammin) | (m_slip->gammaP > p.inclination_angle_range.cammax)) << DIAG_GAMMA_RANGE |
+    ((m_Fz < p.vertical_force_range.fzmin) | (m_Fz > p.vertical_force_range.fzmax)) << DIAG_FZ_RANGE;
+
+  // the ranges are irrelevant without contact
+  if (!m_in_contact)
+    flags = 0;
+
+  record_diagnostics(flags, (1 << DIAG_KAPPA_RANGE) | (1 << DIAG_ALPHA_RANGE) | (1 << DIAG_GAMMA_RANGE) | (1 << DIAG_FZ_RANGE));
+}
+
+// -----------------------------------------------------------------------------
+// After calculating all the reactions, check them against the thresholds and
+// optionally clamp them. Violations are counted and queued (see
+// record_diagnostics), never written from here.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::evaluate_reactions(bool write_violations, bool enforce_threshold)
+{
+  ChVector<>& F = m_FM_combined.force;
+  ChVector<>& M = m_FM_combined.moment;
+
   //  m_Fz, the Fz input to the tire model, must be limited based on the Fz_threshold
-  // e.g., should never need t;his
-  if(abs(m_Fz) > Fz_thresh)
+  // e.g., should never need this
+  int flags =
+    (std::abs(F.x) > Fx_thresh) << DIAG_FX |
+    (std::abs(F.y) > Fy_thresh) << DIAG_FY |
+    (std::abs(m_Fz) > Fz_thresh) << DIAG_FZ |
+    (std::abs(M.x) > Mx_thresh) << DIAG_MX |
+    (std::abs(M.y) > My_thresh) << DIAG_MY |
+    (std::abs(M.z) > Mz_thresh) << DIAG_MZ;
+
+  record_diagnostics(flags, (1 << DIAG_FX) | (1 << DIAG_FY) | (1 << DIAG_FZ) | (1 << DIAG_MX) | (1 << DIAG_MY) | (1 << DIAG_MZ));
+
+  if (enforce_threshold) {
+    F.x = std::max(-Fx_thresh, std::min(F.x, Fx_thresh));
+    F.y = std::max(-Fy_thresh, std::min(F.y, Fy_thresh));
+    M.x = std::max(-Mx_thresh, std::min(M.x, Mx_thresh));
+    M.y = std::max(-My_thresh, std::min(M.y, My_thresh));
+    M.z = std::max(-Mz_thresh, std::min(M.z, Mz_thresh));
+  }
+
+  if (write_violations && flags)
   {
-    GetLog() << "\n ***  !!!  ***  Fz exceeded threshold:, tire " << m_name << ", = " << m_Fz << "\n";
-    output_slip_to_console = true;
+    vehicle::GetContextLog() << " ***********  time = " << m_simTime << ", slip data:  \n(u,v_alpha,v_gamma) = " << m_slip->u <<", " << m_slip->v_alpha <<", " << m_slip->v_gamma
+      << "\n velocity, center (x,y) = " << m_slip->V_cx <<", "<< m_slip->V_cy 
+      << "\n velocity, slip (x,y) = " << m_slip->V_sx <<", "<< m_slip->V_sy << "\n\n";
+
   }
+}
 
-  if( abs(m_FM_combined.moment.x) > Mx_thresh )
-  {
-    // GetLog() << " ***  !!!  ***  Mx exceeded threshold, tire " << m_name << ", = " << m_FM_combined.moment.x << "\n";
-    if(enforce_threshold)
-      m_FM_combined.moment.x = m_FM_combined.moment.x * ( Mx_thresh / std::abs(m_FM_combined.moment.x) );
-    output_slip_to_console = true;
+// -----------------------------------------------------------------------------
+// Diagnostics.
+// The counts are updated at every step with a violation, but a record is queued
+// only at the onset of a violation, so that a persistent condition does not
+// fill the queue. If the queue is full, the record is dropped (and counted).
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::record_diagnostics(int flags, int mask)
+{
+  if ((flags | (m_diag_active & mask)) == 0)
+    return;
+
+  int onset = flags & ~m_diag_active;
+  m_diag_active = (m_diag_active & ~mask) | flags;
+
+  for (int i = 0; i < NUM_DIAGNOSTICS; i++) {
+    if (!(flags & (1 << i)))
+      continue;
+    m_diag_count[i]++;
+    if (onset & (1 << i)) {
+      DiagnosticRecord rec = { m_simTime, (Diagnostic)i, diagnostic_value((Diagnostic)i) };
+      if (!m_diag_queue.Push(rec))
+        m_diag_dropped++;
+    }
   }
-  
-  if(abs(m_FM_combined.moment.y) > My_thresh )
-  {
-    // GetLog() << " ***  !!!  ***  My exceeded threshold, tire " << m_name << ", = " << m_FM_combined.moment.y << "\n";
-    if(enforce_threshold)
-       m_FM_combined.moment.y = m_FM_combined.moment.y * ( My_thresh / std::abs(m_FM_combined.moment.y) );
-    output_slip_to_console = true;
+}
 
+double ChPacejkaTire::diagnostic_value(Diagnostic type) const
+{
+  switch (type) {
+  case DIAG_FX:           return m_FM_combined.force.x;
+  case DIAG_FY:           return m_FM_combined.force.y;
+  case DIAG_FZ:           return m_Fz;
+  case DIAG_MX:           return m_FM_combined.moment.x;
+  case DIAG_MY:           return m_FM_combined.moment.y;
+  case DIAG_MZ:           return m_FM_combined.moment.z;
+  case DIAG_KAPPA_RANGE:  return m_slip->kappaP;
+  case DIAG_ALPHA_RANGE:  return m_slip->alphaP;
+  case DIAG_GAMMA_RANGE:  return m_slip->gammaP;
+  case DIAG_FZ_RANGE:     return m_Fz;
+  case DIAG_LOW_VELOCITY: return m_W_frame.TransformDirectionParentToLocal(m_tireState.lin_vel).x;
+  default:                return 0;
   }
-  
-  if(abs(m_FM_combined.moment.z) > Mz_thresh)
-  {
-    if(enforce_threshold)
-      m_FM_combined.moment.z = m_FM_combined.moment.z * ( Mz_thresh / std::abs(m_FM_combined.moment.z) );
+}
+
+const char* ChPacejkaTire::GetDiagnosticName(Diagnostic type)
+{
+  static const char* names[NUM_DIAGNOSTICS] = {
+    "Fx exceeded threshold",
+    "Fy exceeded threshold",
+    "Fz exceeded threshold",
+    "Mx exceeded threshold",
+    "My exceeded threshold",
+    "Mz exceeded threshold",
+    "kappa outside of the parameter file range",
+    "alpha outside of the parameter file range",
+    "gamma outside of the parameter file range",
+    "Fz outside of the parameter file range",
+    "model parameters not set",
+    "tangential forward velocity below threshold"
+  };
+
+  return (type >= 0 && type < NUM_DIAGNOSTICS) ? names[type] : "unknown";
+}
 
-    GetLog() << " ***  !!!  ***  Mz exceeded threshold, tire " << m_name << ", = " << m_FM_combined.moment.z << "\n";
-    output_slip_to_console = true;
+void ChPacejkaTire::ReportDiagnostics()
+{
+  DiagnosticRecord rec;
+  while (m_diag_queue.Pop(rec)) {
+    vehicle::GetContextLog() << " tire " << m_name.c_str() << ", time = " << rec.time << ": "
+                             << GetDiagnosticName(rec.type) << ", = " << rec.value << "\n";
   }
 
-  if( write_violations )
-  {
-    GetLog() << " ***********  time = " << m_simTime << ", slip data:  \n(u,v_alpha,v_gamma) = " << m_slip->u <<", " << m_slip->v_alpha <<", " << m_slip->v_gamma
-      << "\n velocity, center (x,y) = " << m_slip->V_cx <<", "<< m_slip->V_cy 
-      << "\n velocity, slip (x,y) = " << m_slip->V_sx <<", "<< m_slip->V_sy << "\n\n";
+  bool any = m_diag_dropped > 0;
+  for (int i = 0; i < NUM_DIAGNOSTICS; i++)
+    any = any || m_diag_count[i] > 0;
+  if (!any)
+    return;
 
+  vehicle::GetContextLog() << " tire " << m_name.c_str() << ", diagnostics summary (number of steps):\n";
+  for (int i = 0; i < NUM_DIAGNOSTICS; i++) {
+    if (m_diag_count[i] > 0)
+      vehicle::GetContextLog() << "   " << GetDiagnosticName((Diagnostic)i) << ": " << m_diag_count[i] << "\n";
+    m_diag_count[i] = 0;
   }
+  if (m_diag_dropped > 0)
+    vehicle::GetContextLog() << "   records dropped (queue full): " << m_diag_dropped << "\n";
+  m_diag_dropped = 0;
 }
 
 
@@ -1033,6 +1687,259 @@ void ChPacejkaTire::combinedSlipReactions( )
   }
 }
 
+// -----------------------------------------------------------------------------
+// Tabulated Magic Formula.
+// The tabulated values are evaluated with cos(alpha') = 1 and Vx > 0. With the
+// spin slip coefficients zeta equal to 1, the pure slip aligning moment, the
+// combined pneumatic trail and the combined residual torque scale with
+// cos(alpha') and sign(Vx) (see Mz_pureLat and Mz_combined), which are applied
+// in table_reactions().
+// The table is built with the friction scaling factors of the parameter file;
+// where the terrain friction differs from the reference friction, the Magic
+// Formula is evaluated directly.
+// -----------------------------------------------------------------------------
+bool ChPacejkaTire::tabulatedSlipReactions( )
+{
+  if (std::abs(m_mu_scale - 1) > 1e-3)
+    return false;
+
+  if (!m_table->InRange(m_slip->kappaP, m_slip->alphaP, m_slip->gammaP, m_Fz))
+    return false;
+
+  if(m_in_contact)
+  {
+    int sign_Vx = (m_slip->V_cx >= 0) ? 1 : -1;
+    ChVector<> pure;
+    ChVector<> comb;
+    double combined[ChPacejkaTable::NUM_COMBINED];
+    table_reactions(m_slip->kappaP, m_slip->alphaP, m_slip->gammaP, m_slip->cosPrime_alpha, sign_Vx, pure, comb, combined);
+
+    // same sign conventions as in pureSlipReactions() and combinedSlipReactions()
+    m_FM_pure.force.x = pure.x;
+    m_FM_pure.force.y = m_sameSide * pure.y;
+    m_FM_pure.moment.z = m_sameSide * pure.z;
+
+    m_FM_combined.force.x = comb.x;
+    m_FM_combined.force.y = m_sameSide * comb.y;
+    m_FM_combined.moment.z = m_sameSide * comb.z;
+
+    // factors needed by the low speed check in advance_slip_transient()
+    m_pureLat->mu_y = (m_params->lateral.pdy1 + m_params->lateral.pdy2 * m_dF_z) * (1.0 - m_params->lateral.pdy3 * pow(m_slip->gammaP,2) ) * m_params->scaling.lmuy;
+    m_pureLat->D_y = m_pureLat->mu_y * m_Fz * m_zeta->z2;
+    m_combinedTorque->alpha_r_eq = combined[ChPacejkaTable::ALPHA_R_EQ];
+  }
+
+  return true;
+}
+
+void ChPacejkaTire::table_reactions(double kappa, double alpha, double gamma,
+                                    double cosPrime_alpha, int sign_Vx,
+                                    ChVector<>& pure, ChVector<>& comb,
+                                    double combined[ChPacejkaTable::NUM_COMBINED])
+{
+  double Fx;
+  double lat[2];
+  m_table->Evaluate(kappa, alpha, gamma, m_Fz, Fx, lat, combined);
+
+  double cs = cosPrime_alpha * sign_Vx;
+
+  pure = ChVector<>(Fx, lat[0], cs * lat[1]);
+
+  // remaining algebraic terms of Fx_combined, Fy_combined and Mz_combined
+  double F_x = combined[ChPacejkaTable::G_XALPHA] * Fx;
+  double FP_y = combined[ChPacejkaTable::G_YKAPPA] * lat[0];
+  double F_y = FP_y + combined[ChPacejkaTable::S_VYKAPPA];
+  double s = m_R0 * (m_params->aligning.ssz1 + m_params->aligning.ssz2*(F_y/m_params->vertical.fnomin) + (m_params->aligning.ssz3 + m_params->aligning.ssz4*m_dF_z)*gamma)*m_params->scaling.ls;
+  double M_z = -cs * combined[ChPacejkaTable::TRAIL] * FP_y + cs * cosPrime_alpha * combined[ChPacejkaTable::M_ZR] + s * F_x;
+
+  comb = ChVector<>(F_x, F_y, M_z);
+}
+
+void ChPacejkaTire::analytic_curves(double kappa, double alpha, double gamma, double Fz,
+                                    double& Fx, double lat[2], double combined[ChPacejkaTable::NUM_COMBINED],
+                                    ChVector<>& pure, ChVector<>& comb)
+{
+  m_Fz = Fz;
+  m_dF_z = (Fz - m_params->vertical.fnomin) / m_params->vertical.fnomin;
+
+  Fx = Fx_pureLong(gamma, kappa);
+  lat[0] = Fy_pureLat(alpha, gamma);
+  lat[1] = Mz_pureLat(alpha, gamma, lat[0]);
+
+  double F_x = Fx_combined(alpha, gamma, kappa, Fx);
+  double F_y = Fy_combined(alpha, gamma, kappa, lat[0]);
+  double M_z = Mz_combined(m_pureTorque->alpha_r, m_pureTorque->alpha_t, gamma, kappa, F_x, F_y);
+
+  combined[ChPacejkaTable::G_XALPHA] = m_combinedLong->G_xAlpha;
+  combined[ChPacejkaTable::G_YKAPPA] = m_combinedLat->G_yKappa;
+  combined[ChPacejkaTable::S_VYKAPPA] = m_combinedLat->S_VyKappa;
+  combined[ChPacejkaTable::TRAIL] = m_combinedTorque->t;
+  combined[ChPacejkaTable::M_ZR] = m_combinedTorque->M_zr;
+  // alpha_r_eq changes sign with alpha_r, only its magnitude is used
+  combined[ChPacejkaTable::ALPHA_R_EQ] = std::abs(m_combinedTorque->alpha_r_eq);
+
+  pure = ChVector<>(Fx, lat[0], lat[1]);
+  comb = ChVector<>(F_x, F_y, M_z);
+}
+
+// component-wise maximum deviation between two sets of reactions
+static void update_max_deviation(ChVector<>& err, const ChVector<>& a, const ChVector<>& b)
+{
+  err.x = std::max(err.x, std::abs(a.x - b.x));
+  err.y = std::max(err.y, std::abs(a.y - b.y));
+  err.z = std::max(err.z, std::abs(a.z - b.z));
+}
+
+void ChPacejkaTire::buildTable()
+{
+  m_table = ChPac2002Registry::FindTable(m_paramBlock, m_tabulation);
+  if (m_table)
+    return;
+
+  double min[ChPacejkaTable::NUM_AXES];
+  double max[ChPacejkaTable::NUM_AXES];
+  if (m_tabulation.kappa_lim > 0) {
+    min[ChPacejkaTable::KAPPA] = -m_tabulation.kappa_lim;
+    max[ChPacejkaTable::KAPPA] = m_tabulation.kappa_lim;
+  } else {
+    min[ChPacejkaTable::KAPPA] = m_params->long_slip_range.kpumin;
+    max[ChPacejkaTable::KAPPA] = m_params->long_slip_range.kpumax;
+  }
+  if (m_tabulation.alpha_lim > 0) {
+    min[ChPacejkaTable::ALPHA] = -m_tabulation.alpha_lim;
+    max[ChPacejkaTable::ALPHA] = m_tabulation.alpha_lim;
+  } else {
+    min[ChPacejkaTable::ALPHA] = m_params->slip_angle_range.alpmin;
+    max[ChPacejkaTable::ALPHA] = m_params->slip_angle_range.alpmax;
+  }
+  min[ChPacejkaTable::GAMMA] = m_params->inclination_angle_range.cammin;
+  max[ChPacejkaTable::GAMMA] = m_params->inclination_angle_range.cammax;
+  min[ChPacejkaTable::FZ] = m_params->vertical_force_range.fzmin;
+  max[ChPacejkaTable::FZ] = m_params->vertical_force_range.fzmax;
+
+  // a table built by another process of the node is used in place
+  std::string key = PAC_sharedKey(m_paramBlock->checksum, m_tabulation);
+  size_t bytes = 0;
+  const double* shared = static_cast<const double*>(vehicle::ChSharedModelData::Find(key, bytes));
+  if (shared) {
+    ChPacejkaTable* table = new ChPacejkaTable(m_tabulation, min, max, shared);
+    if (bytes == table->GetNumValues() * sizeof(double)) {
+      m_table = ChPac2002Registry::AddTable(m_paramBlock, table);
+      return;
+    }
+    delete table;
+  }
+
+  ChPacejkaTable* table = new ChPacejkaTable(m_tabulation, min, max);
+
+  // the analytical functions use the current tire state, restore it when done;
+  // the table is shared by all tires with these parameters, so it is always
+  // built with the exact functions
+  double Fz = m_Fz;
+  bool fast_math = m_fast_math;
+  m_fast_math = false;
+  m_loadCoefs_valid = false;
+  double dF_z = m_dF_z;
+  slips slip = *m_slip;
+  m_slip->cosPrime_alpha = 1;
+  m_slip->V_cx = 1;
+
+  int nk = table->GetNumNodes(ChPacejkaTable::KAPPA);
+  int na = table->GetNumNodes(ChPacejkaTable::ALPHA);
+  int ng = table->GetNumNodes(ChPacejkaTable::GAMMA);
+  int nF = table->GetNumNodes(ChPacejkaTable::FZ);
+
+  double Fx;
+  double lat[2];
+  double combined[ChPacejkaTable::NUM_COMBINED];
+  ChVector<> pure;
+  ChVector<> comb;
+
+  int nk_pure = table->GetNumPureNodes(ChPacejkaTable::KAPPA);
+  int na_pure = table->GetNumPureNodes(ChPacejkaTable::ALPHA);
+
+  // fill in the grid; the pure slip curves don't depend on all four inputs,
+  // they are stored once per (kappa | alpha, gamma, Fz) on the refined grid
+  for (int iF = 0; iF < nF; iF++) {
+    double F_z = table->GetNode(ChPacejkaTable::FZ, iF);
+    for (int ig = 0; ig < ng; ig++) {
+      double gamma = table->GetNode(ChPacejkaTable::GAMMA, ig);
+      for (int ik = 0; ik < nk_pure; ik++) {
+        analytic_curves(table->GetPureNode(ChPacejkaTable::KAPPA, ik), 0, gamma, F_z, Fx, lat, combined, pure, comb);
+        table->Long(ik, ig, iF) = Fx;
+      }
+      for (int ia = 0; ia < na_pure; ia++) {
+        analytic_curves(0, table->GetPureNode(ChPacejkaTable::ALPHA, ia), gamma, F_z, Fx, lat, combined, pure, comb);
+        table->Lat(ia, ig, iF)[0] = lat[0];
+        table->Lat(ia, ig, iF)[1] = lat[1];
+      }
+      for (int ia = 0; ia < na; ia++) {
+        double alpha = table->GetNode(ChPacejkaTable::ALPHA, ia);
+        for (int ik = 0; ik < nk; ik++) {
+          analytic_curves(table->GetNode(ChPacejkaTable::KAPPA, ik), alpha, gamma, F_z, Fx, lat, combined, pure, comb);
+          double* node = table->Combined(ik, ia, ig, iF);
+          for (int c = 0; c < ChPacejkaTable::NUM_COMBINED; c++)
+            node[c] = combined[c];
+        }
+      }
+    }
+  }
+
+  // estimate the interpolation error at the cell centers (of the refined grid
+  // for the pure slip reactions)
+  m_table = table;
+  ChVector<> err_pure;
+  ChVector<> err_comb;
+  ChVector<> pure_t;
+  ChVector<> comb_t;
+  double half[ChPacejkaTable::NUM_AXES];
+  double half_pure[ChPacejkaTable::NUM_AXES];
+  for (int i = 0; i < ChPacejkaTable::NUM_AXES; i++) {
+    ChPacejkaTable::Axis axis = (ChPacejkaTable::Axis)i;
+    half[i] = 0.5 * (max[i] - min[i]) / (table->GetNumNodes(axis) - 1);
+    half_pure[i] = 0.5 * (max[i] - min[i]) / (table->GetNumPureNodes(axis) - 1);
+  }
+
+  for (int iF = 0; iF < nF - 1; iF++) {
+    double F_z = table->GetNode(ChPacejkaTable::FZ, iF) + half[ChPacejkaTable::FZ];
+    for (int ig = 0; ig < ng - 1; ig++) {
+      double gamma = table->GetNode(ChPacejkaTable::GAMMA, ig) + half[ChPacejkaTable::GAMMA];
+      for (int i = 0; i < std::max(nk_pure, na_pure) - 1; i++) {
+        double kappa = table->GetPureNode(ChPacejkaTable::KAPPA, std::min(i, nk_pure - 2)) + half_pure[ChPacejkaTable::KAPPA];
+        double alpha = table->GetPureNode(ChPacejkaTable::ALPHA, std::min(i, na_pure - 2)) + half_pure[ChPacejkaTable::ALPHA];
+        analytic_curves(kappa, alpha, gamma, F_z, Fx, lat, combined, pure, comb);
+        table_reactions(kappa, alpha, gamma, 1, 1, pure_t, comb_t, combined);
+        update_max_deviation(err_pure, pure_t, pure);
+      }
+      for (int ia = 0; ia < na - 1; ia++) {
+        double alpha = table->GetNode(ChPacejkaTable::ALPHA, ia) + half[ChPacejkaTable::ALPHA];
+        for (int ik = 0; ik < nk - 1; ik++) {
+          double kappa = table->GetNode(ChPacejkaTable::KAPPA, ik) + half[ChPacejkaTable::KAPPA];
+          analytic_curves(kappa, alpha, gamma, F_z, Fx, lat, combined, pure, comb);
+          table_reactions(kappa, alpha, gamma, 1, 1, pure_t, comb_t, combined);
+          update_max_deviation(err_comb, comb_t, comb);
+        }
+      }
+    }
+  }
+  table->SetError(err_pure, err_comb);
+
+  m_Fz = Fz;
+  m_dF_z = dF_z;
+  *m_slip = slip;
+  m_fast_math = fast_math;
+  m_loadCoefs_valid = false;
+
+  // the builder of the shared segment adds the table, and uses it from there
+  double* values = static_cast<double*>(vehicle::ChSharedModelData::Allocate(key, table->GetNumValues() * sizeof(double)));
+  if (values) {
+    table->WriteValues(values);
+    table->ShareValues(values);
+  }
+
+  m_table = ChPac2002Registry::AddTable(m_paramBlock, table);
+}
+
 void ChPacejkaTire::relaxationLengths()
 {
   double p_Ky4 = 2; // according to Pac2002 model
@@ -1065,29 +1972,112 @@ void ChPacejkaTire::relaxationLengths()
   }
 }
 
-double ChPacejkaTire::Fx_pureLong(double gamma, double kappa)
+// -----------------------------------------------------------------------------
+// Update the Magic Formula terms which depend only on the vertical load, the
+// inclination angle and the friction scaling. These are recomputed only if
+// dF_z or gamma moved by more than the cache tolerances since the last update
+// (or if the friction scaling changed).
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::update_loadCoefs(double gamma)
 {
+  if (m_loadCoefs_valid &&
+      std::abs(m_dF_z - m_loadCoefs->dF_z) <= m_coef_tol_dF_z &&
+      std::abs(gamma - m_loadCoefs->gamma) <= m_coef_tol_gamma &&
+      m_mu_scale == m_loadCoefs->mu_scale) {
+    m_num_coef_cache_hits++;
+    return;
+  }
+
+  m_num_coef_cache_misses++;
+  m_loadCoefs_valid = true;
+
+  loadCoefs& c = *m_loadCoefs;
+  c.dF_z = m_dF_z;
+  c.gamma = gamma;
+  c.mu_scale = m_mu_scale;
+
+  double lmux = m_params->scaling.lmux * m_mu_scale;
+  double lmuy = m_params->scaling.lmuy * m_mu_scale;
+
+  // Fx, pure long slip
   // double eps_Vx = 0.6;
   double eps_x = 0;
-  // Fx, pure long slip
-  double S_Hx = (m_params->longitudinal.phx1 + m_params->longitudinal.phx2*m_dF_z)*m_params->scaling.lhx;
-  double kappa_x = kappa + S_Hx;  // * 0.1;
+  c.S_Hx = (m_params->longitudinal.phx1 + m_params->longitudinal.phx2*m_dF_z)*m_params->scaling.lhx;
+  c.mu_x = (m_params->longitudinal.pdx1 + m_params->longitudinal.pdx2*m_dF_z) * (1.0 - m_params->longitudinal.pdx3 * (gamma * gamma) ) * lmux;	// >0
+  c.K_x = m_Fz * (m_params->longitudinal.pkx1 + m_params->longitudinal.pkx2 * m_dF_z) * exp(m_params->longitudinal.pkx3 * m_dF_z) * m_params->scaling.lkx;
+  c.C_x = m_params->longitudinal.pcx1 * m_params->scaling.lcx;	// >0
+  c.D_x = c.mu_x * m_Fz * m_zeta->z1;  // >0
+  c.B_x = c.K_x / (c.C_x * c.D_x + eps_x);
+  c.E_x0 = m_params->longitudinal.pex1 + m_params->longitudinal.pex2 * m_dF_z + m_params->longitudinal.pex3 *  (m_dF_z * m_dF_z);
+  c.S_Vx = m_Fz * (m_params->longitudinal.pvx1 + m_params->longitudinal.pvx2 * m_dF_z) * m_params->scaling.lvx * lmux * m_zeta->z1;
+
+  // Fy, pure lat slip
+  c.C_y = m_params->lateral.pcy1 * m_params->scaling.lcy;  // > 0
+  c.mu_y = (m_params->lateral.pdy1 + m_params->lateral.pdy2 * m_dF_z) * (1.0 - m_params->lateral.pdy3 * (gamma * gamma) ) * lmuy;	// > 0
+  c.D_y = c.mu_y * m_Fz * m_zeta->z2;
+
+  // doesn't make sense to ever have K_y be negative (it can be interpreted as lateral stiffnesss)
+  c.K_y = m_params->lateral.pky1 * m_params->vertical.fnomin * mf_sin(2.0 * mf_atan(m_Fz / (m_params->lateral.pky2 * m_params->vertical.fnomin) ) ) * (1.0 - m_params->lateral.pky3 * std::abs(gamma) ) * m_zeta->z3 * m_params->scaling.lyka;
+  c.B_y = c.K_y / (c.C_y * c.D_y);
+
+  // double S_Hy = (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (K_yGamma_0 * m_slip->gammaP - S_VyGamma) * m_zeta->z0 / (K_yAlpha + 0.1) + m_zeta->z4 - 1.0;
+  // Adasms S_Hy is a bit different
+  c.S_Hy =  (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (m_params->lateral.phy3 * gamma * m_zeta->z0) + m_zeta->z4 - 1;
+
+  c.E_y0 = m_params->lateral.pey1 + m_params->lateral.pey2 * m_dF_z;
+  c.E_y1 = m_params->lateral.pey3 + m_params->lateral.pey4 * gamma;  // + p_Ey5 * pow(gamma,2)
+  c.S_Vy = m_Fz * ((m_params->lateral.pvy1 + m_params->lateral.pvy2 * m_dF_z) * m_params->scaling.lvy + (m_params->lateral.pvy3 + m_params->lateral.pvy4 * m_dF_z) * gamma) * lmuy * m_zeta->z2;
+
+  // Mz, pure lat slip
+  c.S_Hf = c.S_Hy + c.S_Vy / c.K_y;
+  c.S_Ht = m_params->aligning.qhz1 + m_params->aligning.qhz2*m_dF_z + (m_params->aligning.qhz3 + m_params->aligning.qhz4*m_dF_z) * gamma;
+  c.B_r = (m_params->aligning.qbz9 * (m_params->scaling.lky / lmuy) + m_params->aligning.qbz10*c.B_y*c.C_y) * m_zeta->z6;
+  c.C_r = m_zeta->z7;
+  // no terms (Dz10, Dz11) for gamma^2 term seen in Pacejka
+  // double D_r = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7 * m_dF_z)*m_params->scaling.lres*m_zeta->z2 + (m_params->aligning.qdz8 + m_params->aligning.qdz9 * m_dF_z)*gamma*m_params->scaling.lgaz*m_zeta->z0) * m_slip->cosPrime_alpha*m_params->scaling.lmuy*sign_Vx + m_zeta->z8 - 1.0;
+  // reference
+  c.D_r0 = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7*m_dF_z)*m_params->scaling.lres + (m_params->aligning.qdz8 + m_params->aligning.qdz9*m_dF_z)*gamma) * lmuy;
+  // qbz4 is not in Pacejka
+  c.B_t = (m_params->aligning.qbz1 + m_params->aligning.qbz2*m_dF_z + m_params->aligning.qbz3*(m_dF_z * m_dF_z)) * (1.0 + m_params->aligning.qbz4*gamma + m_params->aligning.qbz5*std::abs(gamma)) * m_params->scaling.lvyka/lmuy;
+  c.C_t = m_params->aligning.qcz1;
+  c.D_t0 = m_Fz * (m_R0/m_params->vertical.fnomin) * (m_params->aligning.qdz1 + m_params->aligning.qdz2*m_dF_z);
+  // no abs on qdz3 gamma in reference
+  c.D_t1 = 1.0 + m_params->aligning.qdz3*std::abs(gamma) + m_params->aligning.qdz4 * (gamma * gamma);
+  c.E_t0 = m_params->aligning.qez1 + m_params->aligning.qez2*m_dF_z + m_params->aligning.qez3*(m_dF_z * m_dF_z);
+  c.E_t1 = m_params->aligning.qez4 + m_params->aligning.qez5*gamma;
+
+  // Fx, combined slip
+  double rbx3 = 1.0;
+  c.B_xAlpha0 = m_params->longitudinal.rbx1 + rbx3 * (gamma * gamma);
+  c.E_xAlpha = m_params->longitudinal.rex1 + m_params->longitudinal.rex2 * m_dF_z;
+
+  // Fy, combined slip
+  double rby4 = 0;
+  c.S_HyKappa = m_params->lateral.rhy1 + m_params->lateral.rhy2 * m_dF_z;
+  c.B_yKappa0 = m_params->lateral.rby1 + rby4 * (gamma * gamma);
+  c.E_yKappa = m_params->lateral.rey1 + m_params->lateral.rey2 * m_dF_z;
+  c.D_VyKappa0 = c.mu_y * m_Fz * (m_params->lateral.rvy1 + m_params->lateral.rvy2 * m_dF_z + m_params->lateral.rvy3 * gamma);
+
+  // Mz, combined slip
+  c.s_gamma = (m_params->aligning.ssz3 + m_params->aligning.ssz4*m_dF_z)*gamma;
+  c.K_ratio = c.K_x / c.K_y;
+}
 
-  double mu_x = (m_params->longitudinal.pdx1 + m_params->longitudinal.pdx2*m_dF_z) * (1.0 - m_params->longitudinal.pdx3 * pow(gamma,2) ) * m_params->scaling.lmux;	// >0
-  double K_x = m_Fz * (m_params->longitudinal.pkx1 + m_params->longitudinal.pkx2 * m_dF_z) * exp(m_params->longitudinal.pkx3 * m_dF_z) * m_params->scaling.lkx;
-  double C_x = m_params->longitudinal.pcx1 * m_params->scaling.lcx;	// >0
-  double D_x = mu_x * m_Fz * m_zeta->z1;  // >0
-  double B_x = K_x / (C_x * D_x + eps_x);
+double ChPacejkaTire::Fx_pureLong(double gamma, double kappa)
+{
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
+
+  double kappa_x = kappa + c.S_Hx;  // * 0.1;
 
   double sign_kap = (kappa_x >= 0) ? 1 : -1;
 
-  double E_x = (m_params->longitudinal.pex1 + m_params->longitudinal.pex2 * m_dF_z + m_params->longitudinal.pex3 *  pow(m_dF_z,2) ) * (1.0 - m_params->longitudinal.pex4*sign_kap)*m_params->scaling.lex;
-  double S_Vx = m_Fz * (m_params->longitudinal.pvx1 + m_params->longitudinal.pvx2 * m_dF_z) * m_params->scaling.lvx * m_params->scaling.lmux * m_zeta->z1;
-  double F_x = D_x * std::sin(C_x * std::atan(B_x * kappa_x - E_x * (B_x * kappa_x - std::atan(B_x * kappa_x)))) - S_Vx;
+  double E_x = c.E_x0 * (1.0 - m_params->longitudinal.pex4*sign_kap)*m_params->scaling.lex;
+  double F_x = c.D_x * mf_sin(c.C_x * mf_atan(c.B_x * kappa_x - E_x * (c.B_x * kappa_x - mf_atan(c.B_x * kappa_x)))) - c.S_Vx;
 
   // hold onto these coefs
   {
-    pureLongCoefs tmp = { S_Hx, kappa_x, mu_x, K_x, B_x, C_x, D_x, E_x, F_x, S_Vx };
+    pureLongCoefs tmp = { c.S_Hx, kappa_x, c.mu_x, c.K_x, c.B_x, c.C_x, c.D_x, E_x, F_x, c.S_Vx };
     *m_pureLong = tmp;
   }
 
@@ -1096,30 +2086,19 @@ double ChPacejkaTire::Fx_pureLong(double gamma, double kappa)
 
 double ChPacejkaTire::Fy_pureLat(double alpha, double gamma)
 {
-  double C_y = m_params->lateral.pcy1 * m_params->scaling.lcy;  // > 0
-  double mu_y = (m_params->lateral.pdy1 + m_params->lateral.pdy2 * m_dF_z) * (1.0 - m_params->lateral.pdy3 * pow(gamma,2) ) * m_params->scaling.lmuy;	// > 0
-  double D_y = mu_y * m_Fz * m_zeta->z2;
-
-  // doesn't make sense to ever have K_y be negative (it can be interpreted as lateral stiffnesss)
-  double K_y = m_params->lateral.pky1 * m_params->vertical.fnomin * std::sin(2.0 * std::atan(m_Fz / (m_params->lateral.pky2 * m_params->vertical.fnomin) ) ) * (1.0 - m_params->lateral.pky3 * std::abs(gamma) ) * m_zeta->z3 * m_params->scaling.lyka;
-  double B_y = K_y / (C_y * D_y);
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
 
-  // double S_Hy = (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (K_yGamma_0 * m_slip->gammaP - S_VyGamma) * m_zeta->z0 / (K_yAlpha + 0.1) + m_zeta->z4 - 1.0;
-  // Adasms S_Hy is a bit different
-  double S_Hy =  (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (m_params->lateral.phy3 * gamma * m_zeta->z0) + m_zeta->z4 - 1;
-
-  double alpha_y = alpha + S_Hy;
+  double alpha_y = alpha + c.S_Hy;
 
   int sign_alpha = (alpha_y >=0) ? 1 : -1;
 
-  double E_y = (m_params->lateral.pey1 + m_params->lateral.pey2 * m_dF_z) * (1.0 - (m_params->lateral.pey3 + m_params->lateral.pey4 *gamma) * sign_alpha) * m_params->scaling.ley;  // + p_Ey5 * pow(gamma,2)
-  double S_Vy = m_Fz * ((m_params->lateral.pvy1 + m_params->lateral.pvy2 * m_dF_z) * m_params->scaling.lvy + (m_params->lateral.pvy3 + m_params->lateral.pvy4 * m_dF_z) * gamma) * m_params->scaling.lmuy * m_zeta->z2;
-  
-  double F_y = D_y * std::sin(C_y * std::atan(B_y * alpha_y - E_y * (B_y * alpha_y - std::atan(B_y * alpha_y)))) + S_Vy;
+  double E_y = c.E_y0 * (1.0 - c.E_y1 * sign_alpha) * m_params->scaling.ley;
+  double F_y = c.D_y * mf_sin(c.C_y * mf_atan(c.B_y * alpha_y - E_y * (c.B_y * alpha_y - mf_atan(c.B_y * alpha_y)))) + c.S_Vy;
 
   // hold onto coefs
   {
-    pureLatCoefs tmp = { S_Hy, alpha_y, mu_y, K_y, S_Vy, B_y, C_y, D_y, E_y };
+    pureLatCoefs tmp = { c.S_Hy, alpha_y, c.mu_y, c.K_y, c.S_Vy, c.B_y, c.C_y, c.D_y, E_y };
     *m_pureLat = tmp;
   }
 
@@ -1128,40 +2107,32 @@ double ChPacejkaTire::Fy_pureLat(double alpha, double gamma)
 
 double ChPacejkaTire::Mz_pureLat(double alpha, double gamma, double Fy_pureSlip)
 {
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
+
   // some constants
   int sign_Vx = (m_slip->V_cx >= 0) ? 1 : -1;
 
-  double S_Hf = m_pureLat->S_Hy + m_pureLat->S_Vy / m_pureLat->K_y;
-  double alpha_r = alpha + S_Hf;
-  double S_Ht = m_params->aligning.qhz1 + m_params->aligning.qhz2*m_dF_z + (m_params->aligning.qhz3 + m_params->aligning.qhz4*m_dF_z) * gamma;
-  double alpha_t = alpha + S_Ht;
+  double alpha_r = alpha + c.S_Hf;
+  double alpha_t = alpha + c.S_Ht;
 
-  double B_r = (m_params->aligning.qbz9 * (m_params->scaling.lky / m_params->scaling.lmuy) + m_params->aligning.qbz10*m_pureLat->B_y*m_pureLat->C_y) * m_zeta->z6;
-  double C_r = m_zeta->z7;
-  // no terms (Dz10, Dz11) for gamma^2 term seen in Pacejka
-  // double D_r = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7 * m_dF_z)*m_params->scaling.lres*m_zeta->z2 + (m_params->aligning.qdz8 + m_params->aligning.qdz9 * m_dF_z)*gamma*m_params->scaling.lgaz*m_zeta->z0) * m_slip->cosPrime_alpha*m_params->scaling.lmuy*sign_Vx + m_zeta->z8 - 1.0;
-  // reference
-  double D_r = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7*m_dF_z)*m_params->scaling.lres + (m_params->aligning.qdz8 + m_params->aligning.qdz9*m_dF_z)*gamma) * m_params->scaling.lmuy*m_slip->cosPrime_alpha*sign_Vx + m_zeta->z8 - 1.0;
-  // qbz4 is not in Pacejka
-  double B_t = (m_params->aligning.qbz1 + m_params->aligning.qbz2*m_dF_z + m_params->aligning.qbz3*pow(m_dF_z,2)) * (1.0 + m_params->aligning.qbz4*gamma + m_params->aligning.qbz5*std::abs(gamma)) * m_params->scaling.lvyka/m_params->scaling.lmuy;
-  double C_t = m_params->aligning.qcz1;
-  double D_t0 = m_Fz * (m_R0/m_params->vertical.fnomin) * (m_params->aligning.qdz1 + m_params->aligning.qdz2*m_dF_z) * sign_Vx;
-  // no abs on qdz3 gamma in reference
-  double D_t = D_t0 * (1.0 + m_params->aligning.qdz3*std::abs(gamma) + m_params->aligning.qdz4 * pow(gamma,2)) * m_zeta->z5*m_params->scaling.ltr;
-  double E_t = (m_params->aligning.qez1 + m_params->aligning.qez2*m_dF_z + m_params->aligning.qez3*pow(m_dF_z,2)) * (1.0 + (m_params->aligning.qez4 + m_params->aligning.qez5*gamma)*(2.0/chrono::CH_C_PI)*std::atan(B_t*C_t*alpha_t) );
-  double t = D_t * std::cos(C_t * std::atan(B_t*alpha_t - E_t*(B_t*alpha_t - std::atan(B_t*alpha_t)))) * m_slip->cosPrime_alpha;
+  double D_r = c.D_r0 * m_slip->cosPrime_alpha*sign_Vx + m_zeta->z8 - 1.0;
+  double D_t0 = c.D_t0 * sign_Vx;
+  double D_t = D_t0 * c.D_t1 * m_zeta->z5*m_params->scaling.ltr;
+  double E_t = c.E_t0 * (1.0 + c.E_t1*(2.0/chrono::CH_C_PI)*mf_atan(c.B_t*c.C_t*alpha_t) );
+  double t = D_t * mf_cos(c.C_t * mf_atan(c.B_t*alpha_t - E_t*(c.B_t*alpha_t - mf_atan(c.B_t*alpha_t)))) * m_slip->cosPrime_alpha;
 
   double MP_z = -t * Fy_pureSlip;
-  double M_zr = D_r * std::cos(C_r*std::atan(B_r*alpha_r)); // this is in the D_r term: * m_slip->cosPrime_alpha;
+  double M_zr = D_r * mf_cos(c.C_r*mf_atan(c.B_r*alpha_r)); // this is in the D_r term: * m_slip->cosPrime_alpha;
 
   double M_z = MP_z + M_zr;
 
   // hold onto coefs
   {
     pureTorqueCoefs tmp = {
-      S_Hf, alpha_r, S_Ht, alpha_t, m_slip->cosPrime_alpha, m_pureLat->K_y,
-      B_r, C_r, D_r,
-      B_t, C_t, D_t0, D_t, E_t, t,
+      c.S_Hf, alpha_r, c.S_Ht, alpha_t, m_slip->cosPrime_alpha, c.K_y,
+      c.B_r, c.C_r, D_r,
+      c.B_t, c.C_t, D_t0, D_t, E_t, t,
       MP_z, M_zr };
     *m_pureTorque = tmp;
   }
@@ -1171,19 +2142,20 @@ double ChPacejkaTire::Mz_pureLat(double alpha, double gamma, double Fy_pureSlip)
 
 double ChPacejkaTire::Fx_combined(double alpha, double gamma, double kappa, double Fx_pureSlip)
 {
-  double rbx3 = 1.0;
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
 
   double S_HxAlpha = m_params->longitudinal.rhx1;
   double alpha_S = alpha + S_HxAlpha;
-  double B_xAlpha = (m_params->longitudinal.rbx1 + rbx3 * pow(gamma, 2)) * std::cos(std::atan(m_params->longitudinal.rbx2 * kappa)) * m_params->scaling.lxal;
+  double B_xAlpha = c.B_xAlpha0 * mf_cos(mf_atan(m_params->longitudinal.rbx2 * kappa)) * m_params->scaling.lxal;
   double C_xAlpha = m_params->longitudinal.rcx1;
-  double E_xAlpha = m_params->longitudinal.rex1 + m_params->longitudinal.rex2 * m_dF_z;
+  double E_xAlpha = c.E_xAlpha;
 
   // double G_xAlpha0 = std::cos(C_xAlpha * std::atan(B_xAlpha * S_HxAlpha - E_xAlpha * (B_xAlpha * S_HxAlpha - std::atan(B_xAlpha * S_HxAlpha)) ) );
-  double G_xAlpha0 = std::cos(C_xAlpha * std::atan(B_xAlpha * S_HxAlpha - E_xAlpha * (B_xAlpha * S_HxAlpha - std::atan(B_xAlpha * S_HxAlpha))));
+  double G_xAlpha0 = mf_cos(C_xAlpha * mf_atan(B_xAlpha * S_HxAlpha - E_xAlpha * (B_xAlpha * S_HxAlpha - mf_atan(B_xAlpha * S_HxAlpha))));
 
   // double G_xAlpha = std::cos(C_xAlpha * std::atan(B_xAlpha * alpha_S - E_xAlpha * (B_xAlpha * alpha_S - std::atan(B_xAlpha * alpha_S)) ) ) / G_xAlpha0;
-  double G_xAlpha = std::cos(C_xAlpha * std::atan(B_xAlpha * alpha_S - E_xAlpha * (B_xAlpha * alpha_S - std::atan(B_xAlpha * alpha_S)))) / G_xAlpha0;
+  double G_xAlpha = mf_cos(C_xAlpha * mf_atan(B_xAlpha * alpha_S - E_xAlpha * (B_xAlpha * alpha_S - mf_atan(B_xAlpha * alpha_S)))) / G_xAlpha0;
 
   double F_x = G_xAlpha * Fx_pureSlip;
 
@@ -1197,17 +2169,18 @@ double ChPacejkaTire::Fx_combined(double alpha, double gamma, double kappa, doub
 
 double ChPacejkaTire::Fy_combined(double alpha, double gamma, double kappa, double Fy_pureSlip)
 {
-  double rby4 = 0;
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
 
-  double S_HyKappa = m_params->lateral.rhy1 + m_params->lateral.rhy2 * m_dF_z;
+  double S_HyKappa = c.S_HyKappa;
   double kappa_S = kappa + S_HyKappa;
-  double B_yKappa = (m_params->lateral.rby1 + rby4 * pow(gamma,2) ) * std::cos( std::atan(m_params->lateral.rby2 * (alpha - m_params->lateral.rby3) ) )*m_params->scaling.lyka;
+  double B_yKappa = c.B_yKappa0 * mf_cos( mf_atan(m_params->lateral.rby2 * (alpha - m_params->lateral.rby3) ) )*m_params->scaling.lyka;
   double C_yKappa = m_params->lateral.rcy1;
-  double E_yKappa = m_params->lateral.rey1 + m_params->lateral.rey2 * m_dF_z;
-  double D_VyKappa = m_pureLat->mu_y * m_Fz * (m_params->lateral.rvy1 + m_params->lateral.rvy2 * m_dF_z + m_params->lateral.rvy3 * gamma) * std::cos(std::atan(m_params->lateral.rvy4 * alpha)) * m_zeta->z2;
-  double S_VyKappa = D_VyKappa * std::sin(m_params->lateral.rvy5 * std::atan(m_params->lateral.rvy6 * kappa)) * m_params->scaling.lvyka;
-  double G_yKappa0 = std::cos(C_yKappa * std::atan(B_yKappa * S_HyKappa - E_yKappa * (B_yKappa * S_HyKappa - std::atan(B_yKappa * S_HyKappa))));
-  double G_yKappa = std::cos(C_yKappa * std::atan(B_yKappa * kappa_S - E_yKappa * (B_yKappa * kappa_S - std::atan(B_yKappa * kappa_S)))) / G_yKappa0;
+  double E_yKappa = c.E_yKappa;
+  double D_VyKappa = c.D_VyKappa0 * mf_cos(mf_atan(m_params->lateral.rvy4 * alpha)) * m_zeta->z2;
+  double S_VyKappa = D_VyKappa * mf_sin(m_params->lateral.rvy5 * mf_atan(m_params->lateral.rvy6 * kappa)) * m_params->scaling.lvyka;
+  double G_yKappa0 = mf_cos(C_yKappa * mf_atan(B_yKappa * S_HyKappa - E_yKappa * (B_yKappa * S_HyKappa - mf_atan(B_yKappa * S_HyKappa))));
+  double G_yKappa = mf_cos(C_yKappa * mf_atan(B_yKappa * kappa_S - E_yKappa * (B_yKappa * kappa_S - mf_atan(B_yKappa * kappa_S)))) / G_yKappa0;
 
   double F_y = G_yKappa * Fy_pureSlip + S_VyKappa;
 
@@ -1221,16 +2194,19 @@ double ChPacejkaTire::Fy_combined(double alpha, double gamma, double kappa, doub
 
 double ChPacejkaTire::Mz_combined(double alpha_r, double alpha_t, double gamma, double kappa, double Fx_combined, double Fy_combined)
 {
+  update_loadCoefs(gamma);
+  const loadCoefs& c = *m_loadCoefs;
+
   double FP_y = Fy_combined - m_combinedLat->S_VyKappa;
-  double s = m_R0 * (m_params->aligning.ssz1 + m_params->aligning.ssz2*(Fy_combined/m_params->vertical.fnomin) + (m_params->aligning.ssz3 + m_params->aligning.ssz4*m_dF_z)*gamma)*m_params->scaling.ls;
+  double s = m_R0 * (m_params->aligning.ssz1 + m_params->aligning.ssz2*(Fy_combined/m_params->vertical.fnomin) + c.s_gamma)*m_params->scaling.ls;
   int sign_alpha_t = (alpha_t >= 0) ? 1 : -1;
   int sign_alpha_r = (alpha_r >=0) ? 1 : -1;
  
-  double alpha_t_eq = sign_alpha_t * sqrt(pow(alpha_t,2) + pow(m_pureLong->K_x/m_pureTorque->K_y,2)*pow(kappa,2) );
-  double alpha_r_eq = sign_alpha_r * sqrt(pow(alpha_r,2) + pow(m_pureLong->K_x/m_pureTorque->K_y,2)*pow(kappa,2) );
+  double alpha_t_eq = sign_alpha_t * sqrt(alpha_t * alpha_t + c.K_ratio * c.K_ratio * kappa * kappa);
+  double alpha_r_eq = sign_alpha_r * sqrt(alpha_r * alpha_r + c.K_ratio * c.K_ratio * kappa * kappa);
 
-  double M_zr = m_pureTorque->D_r * std::cos(m_pureTorque->C_r * std::atan(m_pureTorque->B_r * alpha_r_eq)) * m_slip->cosPrime_alpha;
-  double t = m_pureTorque->D_t * std::cos(m_pureTorque->C_t * std::atan(m_pureTorque->B_t*alpha_t_eq - m_pureTorque->E_t * (m_pureTorque->B_t * alpha_t_eq - std::atan(m_pureTorque->B_t * alpha_t_eq)))) * m_slip->cosPrime_alpha;
+  double M_zr = m_pureTorque->D_r * mf_cos(m_pureTorque->C_r * mf_atan(m_pureTorque->B_r * alpha_r_eq)) * m_slip->cosPrime_alpha;
+  double t = m_pureTorque->D_t * mf_cos(m_pureTorque->C_t * mf_atan(m_pureTorque->B_t*alpha_t_eq - m_pureTorque->E_t * (m_pureTorque->B_t * alpha_t_eq - mf_atan(m_pureTorque->B_t * alpha_t_eq)))) * m_slip->cosPrime_alpha;
 
   double M_z_y = -t * FP_y;
   double M_z_x = s * Fx_combined;
@@ -1278,27 +2254,72 @@ double ChPacejkaTire::calc_My(double Fx_combined)
 // -----------------------------------------------------------------------------
 void ChPacejkaTire::loadPacTireParamFile()
 {
-  // try to load the file
-  std::ifstream inFile(this->getPacTireParamFile().c_str(), std::ios::in);
+  CH_STARTUP_SCOPE("ChPacejkaTire::LoadParameters");
+
+  // the checksum of the file contents identifies the shared parameter blocks
+  // and validates the binary cache
+  unsigned long long checksum;
 
   // if not loaded, say something and exit
-  if (!inFile.is_open())
+  if (!Pac2002_checksum(getPacTireParamFile(), checksum))
   {
-    GetLog() << "\n\n !!!!!!! couldn't load the pac tire file: " << getPacTireParamFile().c_str() << "\n\n";
-    GetLog() << " pacTire param file opened in a text editor somewhere ??? \n\n\n";
+    vehicle::GetContextLog() << "\n\n !!!!!!! couldn't load the pac tire file: " << getPacTireParamFile().c_str() << "\n\n";
+    vehicle::GetContextLog() << " pacTire param file opened in a text editor somewhere ??? \n\n\n";
     return;
   }
 
-  // success in opening file, load the data, broken down into sections
-  // according to what is found in the PacTire input file
-  readPacTireInput(inFile);
+  // reuse the parameters if another tire already loaded this file
+  m_paramBlock = ChPac2002Registry::Acquire(getPacTireParamFile(), checksum);
+
+  if (!m_paramBlock)
+  {
+    ChPac2002Params* block = new ChPac2002Params(getPacTireParamFile(), checksum);
+    std::string cacheFile = Pac2002_cacheFile(getPacTireParamFile());
+
+    // parameters parsed by another process of the node
+    size_t image_size = 0;
+    const char* image = static_cast<const char*>(vehicle::ChSharedModelData::Find(PAC_sharedKey(checksum), image_size));
+    bool loaded = image && Pac2002_readCacheImage(image, image_size, checksum, block->data);
+
+    if (!loaded && (!m_use_param_cache || !Pac2002_readCache(cacheFile, checksum, block->data)))
+    {
+      // try to load the file
+      std::ifstream inFile(this->getPacTireParamFile().c_str(), std::ios::in);
+
+      if (!inFile.is_open())
+      {
+        vehicle::GetContextLog() << "\n\n !!!!!!! couldn't load the pac tire file: " << getPacTireParamFile().c_str() << "\n\n";
+        delete block;
+        return;
+      }
+
+      // success in opening file, load the data, broken down into sections
+      // according to what is found in the PacTire input file
+      readPacTireInput(inFile, block->data);
+
+      // save the parsed data for the next time this file is used (failure to
+      // write the cache, e.g. in a read-only data directory, is not an error)
+      if (m_use_param_cache)
+        Pac2002_writeCache(cacheFile, checksum, block->data);
+    }
+
+    if (!loaded && vehicle::ChSharedModelData::GetRole() == vehicle::ChSharedModelData::BUILDER) {
+      std::vector<char> shared_image;
+      if (Pac2002_writeCacheImage(checksum, block->data, shared_image))
+        vehicle::ChSharedModelData::Add(PAC_sharedKey(checksum), &shared_image[0], shared_image.size());
+    }
+
+    m_paramBlock = ChPac2002Registry::Register(block);
+  }
+
+  m_params = &m_paramBlock->data;
 
   // this bool will allow you to query the pac tire for output
   // Forces, moments based on wheel state info.
   m_params_defined = true;
 }
 
-void ChPacejkaTire::readPacTireInput(std::ifstream& inFile)
+void ChPacejkaTire::readPacTireInput(std::ifstream& inFile, Pac2002_data& params)
 {
   // advance to the first part of the file with data we need to read
   std::string tline;
@@ -1315,44 +2336,44 @@ void ChPacejkaTire::readPacTireInput(std::ifstream& inFile)
   // where these section read functions can be reused
 
   // 0:  [UNITS], all token values are strings
-  readSection_UNITS(inFile);
+  readSection_UNITS(inFile, params);
 
   // 1: [MODEL]
-  readSection_MODEL(inFile);
+  readSection_MODEL(inFile, params);
 
   // 2: [DIMENSION]
-  readSection_DIMENSION(inFile);
+  readSection_DIMENSION(inFile, params);
 
   // 3: [SHAPE]
-  readSection_SHAPE(inFile);
+  readSection_SHAPE(inFile, params);
 
   // 4: [VERTICAL]
-  readSection_VERTICAL(inFile);
+  readSection_VERTICAL(inFile, params);
 
   // 5-8, ranges for: LONG_SLIP, SLIP_ANGLE, INCLINATION_ANGLE, VETRICAL_FORCE,
   // in that order
-  readSection_RANGES(inFile);
+  readSection_RANGES(inFile, params);
 
   // 9: [scaling]
-  readSection_scaling(inFile);
+  readSection_scaling(inFile, params);
 
   // 10: [longitudinal]
-  readSection_longitudinal(inFile);
+  readSection_longitudinal(inFile, params);
 
   // 11: [overturning]
-  readSection_overturning(inFile);
+  readSection_overturning(inFile, params);
 
   // 12: [lateral]
-  readSection_lateral(inFile);
+  readSection_lateral(inFile, params);
 
   // 13: [rolling]
-  readSection_rolling(inFile);
+  readSection_rolling(inFile, params);
 
   // 14: [aligning]
-  readSection_aligning(inFile);
+  readSection_aligning(inFile, params);
 }
 
-void ChPacejkaTire::readSection_UNITS(std::ifstream& inFile)
+void ChPacejkaTire::readSection_UNITS(std::ifstream& inFile, Pac2002_data& params)
 {
   // skip the first line
   std::string tline;
@@ -1370,7 +2391,7 @@ void ChPacejkaTire::readSection_UNITS(std::ifstream& inFile)
   }
 }
 
-void ChPacejkaTire::readSection_MODEL(std::ifstream& inFile)
+void ChPacejkaTire::readSection_MODEL(std::ifstream& inFile, Pac2002_data& params)
 {
   // skip the first line
   std::string tline;
@@ -1385,23 +2406,23 @@ void ChPacejkaTire::readSection_MODEL(std::ifstream& inFile)
 
   // get the token / value
   split = splitStr(tline, '=');
-  m_params->model.property_file_format = splitStr(split[1], '\'')[1];
+  params.model.property_file_format = splitStr(split[1], '\'')[1];
 
   std::getline(inFile, tline);
-  m_params->model.use_mode = fromTline<int>(tline);
+  params.model.use_mode = fromTline<int>(tline);
 
   std::getline(inFile, tline);
-  m_params->model.vxlow = fromTline<double>(tline);
+  params.model.vxlow = fromTline<double>(tline);
 
   std::getline(inFile, tline);
-  m_params->model.longvl = fromTline<double>(tline);
+  params.model.longvl = fromTline<double>(tline);
 
   std::getline(inFile, tline);
   split = splitStr(tline, '=');
-  m_params->model.tyreside = splitStr(split[1], '\'')[1];
+  params.model.tyreside = splitStr(split[1], '\'')[1];
 }
 
-void ChPacejkaTire::readSection_DIMENSION(std::ifstream& inFile)
+void ChPacejkaTire::readSection_DIMENSION(std::ifstream& inFile, Pac2002_data& params)
 {
   // skip the first two lines
   std::string tline;
@@ -1420,15 +2441,15 @@ void ChPacejkaTire::readSection_DIMENSION(std::ifstream& inFile)
   }
 
   if (dat.size() != 5) {
-    GetLog() << " error reading DIMENSION section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading DIMENSION section of pactire input file!!! \n\n";
     return;
   }
   // right size, create the struct
   struct dimension dim = { dat[0], dat[1], dat[2], dat[3], dat[4] };
-  m_params->dimension = dim;
+  params.dimension = dim;
 }
 
-void ChPacejkaTire::readSection_SHAPE(std::ifstream& inFile)
+void ChPacejkaTire::readSection_SHAPE(std::ifstream& inFile, Pac2002_data& params)
 {
   // skip the first two lines
   std::string tline;
@@ -1448,11 +2469,11 @@ void ChPacejkaTire::readSection_SHAPE(std::ifstream& inFile)
     rad.push_back(std::atof(split[1].c_str()));
     wid.push_back(std::atof(split[5].c_str()));
   }
-  m_params->shape.radial = rad;
-  m_params->shape.width = wid;
+  params.shape.radial = rad;
+  params.shape.width = wid;
 }
 
-void ChPacejkaTire::readSection_VERTICAL(std::ifstream& inFile){
+void ChPacejkaTire::readSection_VERTICAL(std::ifstream& inFile, Pac2002_data& params){
   // skip the first line
   std::string tline;
   std::getline(inFile, tline);
@@ -1468,15 +2489,15 @@ void ChPacejkaTire::readSection_VERTICAL(std::ifstream& inFile){
   }
 
   if (dat.size() != 6) {
-    GetLog() << " error reading VERTICAL section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading VERTICAL section of pactire input file!!! \n\n";
     return;
   }
   // right size, create the struct
   struct vertical vert = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5] };
-  m_params->vertical = vert;
+  params.vertical = vert;
 }
 
-void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
+void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile, Pac2002_data& params){
   // skip the first line
   std::string tline;
   std::getline(inFile, tline);
@@ -1494,12 +2515,12 @@ void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
   }
 
   if (dat.size() != 2) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
     return;
   }
   // right size, create the struct
   struct long_slip_range long_slip = { dat[0], dat[1] };
-  m_params->long_slip_range = long_slip;
+  params.long_slip_range = long_slip;
   dat.clear();
   std::getline(inFile, tline);
 
@@ -1512,12 +2533,12 @@ void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
   }
 
   if (dat.size() != 2) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
     return;
   }
   // right size, create the struct
   struct slip_angle_range slip_ang = { dat[0], dat[1] };
-  m_params->slip_angle_range = slip_ang;
+  params.slip_angle_range = slip_ang;
   dat.clear();
   std::getline(inFile, tline);
 
@@ -1530,11 +2551,11 @@ void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
   }
 
   if (dat.size() != 2) {
-    GetLog() << " error reading INCLINATION_ANGLE_RANGE section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading INCLINATION_ANGLE_RANGE section of pactire input file!!! \n\n";
     return;
   }
   struct inclination_angle_range incl_ang = { dat[0], dat[1] };
-  m_params->inclination_angle_range = incl_ang;
+  params.inclination_angle_range = incl_ang;
   dat.clear();
   std::getline(inFile, tline);
 
@@ -1547,14 +2568,14 @@ void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
   }
 
   if (dat.size() != 2) {
-    GetLog() << " error reading VERTICAL_FORCE_RANGE section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading VERTICAL_FORCE_RANGE section of pactire input file!!! \n\n";
     return;
   }
   struct vertical_force_range vert_range = { dat[0], dat[1] };
-  m_params->vertical_force_range = vert_range;
+  params.vertical_force_range = vert_range;
 }
 
-void ChPacejkaTire::readSection_scaling(std::ifstream& inFile)
+void ChPacejkaTire::readSection_scaling(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1571,16 +2592,16 @@ void ChPacejkaTire::readSection_scaling(std::ifstream& inFile)
   }
 
   if (dat.size() != 28) {
-    GetLog() << " error reading scaling section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading scaling section of pactire input file!!! \n\n";
     return;
   }
   struct scaling_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
     dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
     dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27] };
-  m_params->scaling = coefs;
+  params.scaling = coefs;
 }
 
-void ChPacejkaTire::readSection_longitudinal(std::ifstream& inFile)
+void ChPacejkaTire::readSection_longitudinal(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1594,16 +2615,16 @@ void ChPacejkaTire::readSection_longitudinal(std::ifstream& inFile)
   }
 
   if (dat.size() != 24) {
-    GetLog() << " error reading longitudinal section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading longitudinal section of pactire input file!!! \n\n";
     return;
   }
   struct longitudinal_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
     dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
     dat[18], dat[19], dat[20], dat[21], dat[22], dat[23] };
-  m_params->longitudinal = coefs;
+  params.longitudinal = coefs;
 }
 
-void ChPacejkaTire::readSection_overturning(std::ifstream& inFile)
+void ChPacejkaTire::readSection_overturning(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1617,14 +2638,14 @@ void ChPacejkaTire::readSection_overturning(std::ifstream& inFile)
   }
 
   if (dat.size() != 3) {
-    GetLog() << " error reading  overturning section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading  overturning section of pactire input file!!! \n\n";
     return;
   }
   struct overturning_coefficients coefs = { dat[0], dat[1], dat[2] };
-  m_params->overturning = coefs;
+  params.overturning = coefs;
 }
 
-void ChPacejkaTire::readSection_lateral(std::ifstream& inFile)
+void ChPacejkaTire::readSection_lateral(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1638,17 +2659,17 @@ void ChPacejkaTire::readSection_lateral(std::ifstream& inFile)
   }
 
   if (dat.size() != 34) {
-    GetLog() << " error reading lateral section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading lateral section of pactire input file!!! \n\n";
     return;
   }
   struct lateral_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
     dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
     dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27],
     dat[28], dat[29], dat[30], dat[31], dat[32], dat[33] };
-  m_params->lateral = coefs;
+  params.lateral = coefs;
 }
 
-void ChPacejkaTire::readSection_rolling(std::ifstream& inFile)
+void ChPacejkaTire::readSection_rolling(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1662,14 +2683,14 @@ void ChPacejkaTire::readSection_rolling(std::ifstream& inFile)
   }
 
   if (dat.size() != 4) {
-    GetLog() << " error reading rolling section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading rolling section of pactire input file!!! \n\n";
     return;
   }
   struct rolling_coefficients coefs = { dat[0], dat[1], dat[2], dat[3] };
-  m_params->rolling = coefs;
+  params.rolling = coefs;
 }
 
-void ChPacejkaTire::readSection_aligning(std::ifstream& inFile)
+void ChPacejkaTire::readSection_aligning(std::ifstream& inFile, Pac2002_data& params)
 {
   std::string tline;
   std::getline(inFile, tline);
@@ -1683,14 +2704,14 @@ void ChPacejkaTire::readSection_aligning(std::ifstream& inFile)
   }
 
   if (dat.size() != 31) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
+    vehicle::GetContextLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
     return;
   }
   struct aligning_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
     dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
     dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27],
     dat[28], dat[29], dat[30] };
-  m_params->aligning = coefs;
+  params.aligning = coefs;
 }
 
 
@@ -1698,6 +2719,18 @@ void ChPacejkaTire::readSection_aligning(std::ifstream& inFile)
 // -----------------------------------------------------------------------------
 // Functions providing access to private structures
 // -----------------------------------------------------------------------------
+double ChPacejkaTire::get_transient_time_fraction() const
+{
+  double total = m_sum_transient_time + m_sum_steady_time;
+  return (total > 0) ? m_sum_transient_time / total : 0;
+}
+
+double ChPacejkaTire::get_steady_time_fraction() const
+{
+  double total = m_sum_transient_time + m_sum_steady_time;
+  return (total > 0) ? m_sum_steady_time / total : 0;
+}
+
 double ChPacejkaTire::get_kappa() const
 {
   return m_slip->kappa;
@@ -1755,56 +2788,65 @@ double ChPacejkaTire::get_longvl() const
 
 // -----------------------------------------------------------------------------
 // Write output file for post-processing with the Python pandas module.
+//
+// The output file is opened on the first call and kept open by a buffered
+// output channel; rows are formatted and written by the channel's writer
+// thread. Binary output files can be converted with
+// ChOutputChannel::ConvertToCSV().
 // -----------------------------------------------------------------------------
+static const char* OUTPUT_HEADER =
+  "time,kappa,alpha,gamma,kappaP,alphaP,gammaP,Vx,Vy,omega,Fx,Fy,Fz,Mx,My,Mz,Fxc,Fyc,Mzc,Mzx,Mzy,M_zrc,contact,m_Fz,m_dF_z,u,valpha,vgamma,vphi,du,dvalpha,dvgamma,dvphi,R0,R_l,Reff,MP_z,M_zr,t,s,FX,FY,FZ,MX,MY,MZ,u_Bessel,u_sigma,v_Bessel,v_sigma";
+
+static const int OUTPUT_COLUMNS = 50;
+
 void ChPacejkaTire::WriteOutData(double             time,
                                  const std::string& outFilename)
 {
-  // first time thru, write headers
+  // first time thru, open the output channel and write the headers
+  // Fx, Fy are pure forces, Fxc and Fyc are the combined forces
   if (m_Num_WriteOutData == 0) {
-    m_outFilename = outFilename;
-    std::ofstream oFile(outFilename.c_str(), std::ios_base::out);
-    if (!oFile.is_open()) {
+    if (!m_out)
+      m_out = new vehicle::ChOutputChannel;
+    m_out->SetAdaptiveSampling(m_out_tol, m_out_max_gap);
+    if (!m_out->Open(outFilename, OUTPUT_HEADER, m_out_format)) {
       std::cout << " couldn't open file for writing: " << outFilename << " \n\n";
       return;
     }
-    else {
-      // write the headers, Fx, Fy are pure forces, Fxc and Fyc are the combined forces
-      oFile << "time,kappa,alpha,gamma,kappaP,alphaP,gammaP,Vx,Vy,omega,Fx,Fy,Fz,Mx,My,Mz,Fxc,Fyc,Mzc,Mzx,Mzy,M_zrc,contact,m_Fz,m_dF_z,u,valpha,vgamma,vphi,du,dvalpha,dvgamma,dvphi,R0,R_l,Reff,MP_z,M_zr,t,s,FX,FY,FZ,MX,MY,MZ,u_Bessel,u_sigma,v_Bessel,v_sigma" << std::endl;
-      m_Num_WriteOutData++;
-      oFile.close();
-    }
-  }
-  else {
-    // already written the headers, just increment the function counter
-    m_Num_WriteOutData++;
-  }
-  // ensure file was able to be opened, headers are written
-  if (m_Num_WriteOutData > 0) {
-    // open file, append
-    std::ofstream appFile(outFilename.c_str(), std::ios_base::app);
-    // global force/moments applied to wheel rigid body
-    ChTireForce global_FM = GetTireForce_combinedSlip(false);
-    // write the slip info, reaction forces for pure & combined slip cases
-    appFile << time << "," << m_slip->kappa << "," << m_slip->alpha*180. / 3.14159 << "," << m_slip->gamma << ","
-      << m_slip->kappaP << "," << m_slip->alphaP << "," << m_slip->gammaP << ","
-      << m_slip->V_cx <<"," << m_slip->V_cy <<","<< m_tireState.omega << ","    // m_tireState.lin_vel.x <<","<< m_tireState.lin_vel.y <<"," 
-      << m_FM_pure.force.x << "," << m_FM_pure.force.y << "," << m_FM_pure.force.z << ","
-      << m_FM_pure.moment.x << "," << m_FM_pure.moment.y << "," << m_FM_pure.moment.z << ","
-      << m_FM_combined.force.x << "," << m_FM_combined.force.y << "," << m_FM_combined.moment.z <<","
-      << m_combinedTorque->M_z_x <<","<< m_combinedTorque->M_z_y <<","<< m_combinedTorque->M_zr <<","<< (int)m_in_contact <<","
-      << m_Fz <<","<< m_dF_z <<","
-      << m_slip->u <<","<< m_slip->v_alpha << "," << m_slip->v_gamma <<"," << m_slip->v_phi <<","
-      << m_slip->Idu_dt <<","<< m_slip->Idv_alpha_dt <<"," << m_slip->Idv_gamma_dt <<"," << m_slip->Idv_phi_dt<<","
-      << m_R0 <<","<< m_R_l << "," << m_R_eff <<","
-      << m_pureTorque->MP_z <<","<< m_pureTorque->M_zr <<"," << m_combinedTorque->t <<","<< m_combinedTorque->s<<","
-      << global_FM.force.x <<","<< global_FM.force.y <<","<< global_FM.force.z <<"," 
-      << global_FM.moment.x <<","<< global_FM.moment.y <<","<< global_FM.moment.z <<","
-      << m_bessel->u_Bessel <<","<<  m_bessel->u_sigma <<","
-      << m_bessel->v_Bessel <<","<< m_bessel->v_sigma
-      << std::endl;
-    // close the file
-    appFile.close();
+    m_outFilename = outFilename;
   }
+  m_Num_WriteOutData++;
+
+  // global force/moments applied to wheel rigid body
+  ChTireForce global_FM = GetTireForce_combinedSlip(false);
+
+  // the slip info, reaction forces for pure & combined slip cases
+  double row[OUTPUT_COLUMNS] = {
+    time, m_slip->kappa, m_slip->alpha*180. / 3.14159, m_slip->gamma,
+    m_slip->kappaP, m_slip->alphaP, m_slip->gammaP,
+    m_slip->V_cx, m_slip->V_cy, m_tireState.omega,
+    m_FM_pure.force.x, m_FM_pure.force.y, m_FM_pure.force.z,
+    m_FM_pure.moment.x, m_FM_pure.moment.y, m_FM_pure.moment.z,
+    m_FM_combined.force.x, m_FM_combined.force.y, m_FM_combined.moment.z,
+    m_combinedTorque->M_z_x, m_combinedTorque->M_z_y, m_combinedTorque->M_zr, (double)(int)m_in_contact,
+    m_Fz, m_dF_z,
+    m_slip->u, m_slip->v_alpha, m_slip->v_gamma, m_slip->v_phi,
+    m_slip->Idu_dt, m_slip->Idv_alpha_dt, m_slip->Idv_gamma_dt, m_slip->Idv_phi_dt,
+    m_R0, m_R_l, m_R_eff,
+    m_pureTorque->MP_z, m_pureTorque->M_zr, m_combinedTorque->t, m_combinedTorque->s,
+    global_FM.force.x, global_FM.force.y, global_FM.force.z,
+    global_FM.moment.x, global_FM.moment.y, global_FM.moment.z,
+    m_bessel->u_Bessel, m_bessel->u_sigma,
+    m_bessel->v_Bessel, m_bessel->v_sigma
+  };
+
+  m_out->Write(row);
+}
+
+void ChPacejkaTire::CloseOutData()
+{
+  if (m_out)
+    m_out->Close();
+  m_Num_WriteOutData = 0;
 }
 
 
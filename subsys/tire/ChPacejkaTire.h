@@ -28,6 +28,11 @@
 
 #include "subsys/ChTire.h"
 #include "subsys/ChTerrain.h"
+#include "subsys/ChOutputChannel.h"
+#include "subsys/ChSpscQueue.h"
+#include "subsys/tire/ChPacejkaTable.h"
+#include "subsys/tire/ChFastMath.h"
+#include "subsys/tire/ChTireThermal.h"
 
 namespace chrono {
 
@@ -41,9 +46,13 @@ struct combinedLongCoefs;
 struct combinedLatCoefs;
 struct combinedTorqueCoefs;
 struct zetaCoefs;
+struct loadCoefs;
 struct relaxationL;
 struct bessel;
 
+class ChPac2002Params;
+class ChPacejkaTireBatch;
+
 ///
 /// Concrete tire class that implements the Pacejka tire model.
 /// Detailed description goes here...
@@ -52,14 +61,23 @@ class CH_SUBSYS_API ChPacejkaTire : public ChTire
 {
 public:
 
+  /// Integration scheme for the transient slip ODEs.
+  enum TransientIntegrator {
+    RK4_FIXED,     ///< classic RK4 with the fixed step size (see SetStepsize())
+    EXPONENTIAL    ///< exact exponential update, sub-step picked from the relaxation lengths
+  };
+
   /// Default constructor for a Pacejka tire.
   /// Construct a Pacejka tire for which the vertical load is calculated
   /// internally.  The model includes transient slip calculations.
   /// chrono can suggest a time step for use with the ODE slips
+  /// Optionally, the Magic Formula curves are tabulated in Initialize() and
+  /// interpolated at run time (see ChPacejkaTable).
   ChPacejkaTire(
     const std::string& name,              ///< [in] name of this tire
     const std::string& pacTire_paramFile, ///< [in] name of the parameter file
-    const ChTerrain&   terrain            ///< [in] reference to the terrain system
+    const ChTerrain&   terrain,           ///< [in] reference to the terrain system
+    const ChPacejkaTable::Settings& tabulation = ChPacejkaTable::Settings()  ///< [in] tabulated Magic Formula settings
     );
 
   /// Construct a Pacejka tire with specified vertical load, for testing purposes
@@ -68,7 +86,8 @@ public:
     const std::string& pacTire_paramFile,          ///< [in] name of the parameter file
     const ChTerrain&   terrain,                    ///< [in] reference to the terrain system
     double             Fz_override,                ///< [in] prescribed vertical load
-    bool               use_transient_slip = true   ///< [in] indicate if using transient slip model
+    bool               use_transient_slip = true,  ///< [in] indicate if using transient slip model
+    const ChPacejkaTable::Settings& tabulation = ChPacejkaTable::Settings()  ///< [in] tabulated Magic Formula settings
     );
 
 
@@ -89,6 +108,15 @@ public:
   /// Return the reactions for the combined slip EQs, in local or global coords
   ChTireForce GetTireForce_combinedSlip(const bool local = true) const;
 
+  /// Return the combined slip reactions expressed in the contact frame (TYDEX
+  /// W-axis), in the wheel frame (the point relative to the wheel center) or
+  /// in the global frame. The reactions in all frames are evaluated once per
+  /// step and returned by reference, such that the vehicle dynamics, logging
+  /// and visualization share them.
+  const ChTireForce& GetTireForceLocal() const { return m_FM_combined; }
+  const ChTireForce& GetTireForceWheel() const { return m_FM_combined_wheel; }
+  const ChTireForce& GetTireForceGlobal() const { return m_FM_combined_global; }
+
   /// Update the state of this tire system at the current time.
   /// Set the PacTire spindle state data from the global wheel body state.
   virtual void Update(
@@ -101,12 +129,58 @@ public:
   /// time increment.
   virtual void Advance(double step);
 
+  /// Return the relative cost of one update (higher with transient slip).
+  virtual double GetUpdateCost() const { return m_use_transient_slip ? 20 : 8; }
+
+  /// Linearize the combined slip reactions about the last wheel state, from
+  /// the longitudinal and lateral slip stiffnesses (reduced as the forces
+  /// approach their peak values) and the vertical stiffness and damping.
+  /// Returns false if the tire is not in contact.
+  virtual bool GetForceJacobian(ChTireForceJacobian& jacobian) const;
+
   /// Write output data to a file.
+  /// The file is opened on the first call (the file name passed to subsequent
+  /// calls is ignored) and written asynchronously; it is closed when the tire
+  /// is destroyed or in CloseOutData().
   void WriteOutData(
     double             time,
     const std::string& outFilename
     );
 
+  /// Write all pending output data and close the output file. A subsequent
+  /// call to WriteOutData() starts a new file.
+  void CloseOutData();
+
+  /// Append the internal tire state to the specified snapshot. This includes
+  /// the cached wheel state and contact frame, the vertical load, the slip
+  /// quantities (including the transient slip displacements u, v_alpha,
+  /// v_gamma and v_phi) and the current and previous tire forces.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the internal tire state from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+  /// Add the tire object, its coefficient structures, its diagnostics queue
+  /// and its output channel to the specified report. The parameter block and
+  /// the tabulated curves, shared by the tires using the same parameter file,
+  /// are reported as shared objects.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+  /// Set the format of the output file (default: CSV). Must be called before
+  /// the first call to WriteOutData().
+  void SetOutputFormat(vehicle::ChOutputChannel::Format format) { m_out_format = format; }
+
+  /// Enable change-triggered sampling of the output file, with one absolute
+  /// tolerance per column of the output (see WriteOutData() and
+  /// ChOutputChannel::SetAdaptiveSampling()). Rows are then written only when
+  /// a value deviates from the linear extrapolation of the last rows written,
+  /// or after the maximum time gap. Must be called before the first call to
+  /// WriteOutData().
+  void SetOutputSampling(
+    const std::vector<double>& tolerances,  ///< [in] tolerance of each output column
+    double                     max_gap = 0  ///< [in] maximum time between rows (0: no limit)
+    ) { m_out_tol = tolerances; m_out_max_gap = max_gap; }
+
   /// Manually set the vertical wheel load as an input.
   void set_Fz_override(double Fz) { m_Fz_override = Fz; }
 
@@ -126,6 +200,17 @@ public:
   /// Get the average simulation time per step spent in calculating ODEs
   double get_average_ODE_time() { return m_sum_ODE_time/(double)m_num_ODE_calls; }
 
+  /// Get the average number of ODE sub-steps taken per step
+  double get_average_ODE_substeps() { return m_num_ODE_substeps/(double)m_num_ODE_calls; }
+
+  /// Get the fraction of the simulated time in which the transient slip ODEs
+  /// were integrated (see SetAutoTransient).
+  double get_transient_time_fraction() const;
+
+  /// Get the fraction of the simulated time in which the steady-state slips
+  /// were used instead of the transient slip ODEs (see SetAutoTransient).
+  double get_steady_time_fraction() const;
+
   /// Get current wheel longitudinal slip.
   double get_kappa() const;
 
@@ -168,6 +253,205 @@ public:
   /// Get the current value of the integration step size.
   double GetStepsize() const { return m_step_size; }
 
+  /// Select the integration scheme for the transient slip ODEs (default RK4_FIXED).
+  /// The slip ODEs are linear in the deflections and their coefficients are
+  /// frozen over a sub-step, so the EXPONENTIAL scheme integrates them exactly.
+  /// Its sub-step is the given fraction of the shortest relaxation time
+  /// sigma / |V_cx|, but never smaller than the fixed step size; this only
+  /// limits how often the coefficients and the low speed switching conditions
+  /// are re-evaluated.
+  void SetTransientIntegrator(
+    TransientIntegrator integrator,        ///< [in] integration scheme
+    double              substep_factor = 0.5  ///< [in] sub-step, as a fraction of the shortest relaxation time
+    ) { m_integrator = integrator; m_substep_factor = substep_factor; }
+
+  /// Get the integration scheme for the transient slip ODEs.
+  TransientIntegrator GetTransientIntegrator() const { return m_integrator; }
+
+  /// Set the Besselink low speed damping of the transient slips. Below the
+  /// cut-off speed V_low, the damping coefficients blend from 2*C to C; above
+  /// it, they decay exponentially with |V_cx| (default: 600, 100, 2 m/s).
+  void SetLowSpeedDamping(
+    double Cx,      ///< [in] longitudinal damping coefficient
+    double Cy,      ///< [in] lateral damping coefficient
+    double V_low    ///< [in] cut-off speed
+    ) { m_bessel_Cx = Cx; m_bessel_Cy = Cy; m_bessel_V_low = V_low; }
+
+  /// Enable a linearly implicit vertical load (disabled by default). The
+  /// vertical load is applied to the wheel as a constant force over the step
+  /// passed to Advance(), which with a stiff vertical spring limits the stable
+  /// step size. With this option, the load is the backward Euler value of the
+  /// spring-damper for a wheel of the specified effective (unsprung) mass,
+  /// linearized about the current state and assuming the other forces on the
+  /// wheel balance the load of the previous step:
+  ///   Fz = (Fz0 - k h v + beta Fz_prev) / (1 + beta),  beta = (k h + c) h / m
+  /// where v is the separation velocity at the contact point. Static loads are
+  /// unchanged.
+  void SetImplicitVerticalLoad(
+    bool   enable,     ///< [in] enable the implicit vertical load
+    double mass        ///< [in] effective mass of the wheel
+    ) { m_implicit_Fz = enable && mass > 0; m_implicit_Fz_mass = mass; }
+
+  /// Return true if the linearly implicit vertical load is enabled.
+  bool IsImplicitVerticalLoad() const { return m_implicit_Fz; }
+
+  /// Enable the thermal and wear model (disabled by default). The frictional
+  /// power in the contact patch is accumulated at every step; at the slower
+  /// update rate of the model (see ChTireThermal::SetUpdateInterval), its grip
+  /// factor scales lmux and lmuy, together with the terrain friction. The
+  /// applied grip factor only changes when it moved by more than grip_tol, so
+  /// that the friction dependent Magic Formula terms are not recomputed at
+  /// every step (see SetCoefCacheTolerance).
+  void EnableThermalModel(
+    bool   enable,            ///< [in] enable the thermal and wear model
+    double grip_tol = 1e-3    ///< [in] change of the grip factor applied to the Magic Formula
+    ) { m_use_thermal = enable; m_grip_tol = grip_tol; if (!enable) m_grip_scale = 1; }
+
+  /// Return true if the thermal and wear model is enabled.
+  bool IsThermalModel() const { return m_use_thermal; }
+
+  /// Access the thermal and wear model (parameters and state).
+  ChTireThermal& GetThermalModel() { return m_thermal; }
+  const ChTireThermal& GetThermalModel() const { return m_thermal; }
+
+  /// Get the grip factor currently applied to lmux and lmuy.
+  double GetGripScale() const { return m_grip_scale; }
+
+  /// Enable automatic switching between the transient slip ODEs and their
+  /// steady-state solution (disabled by default; only used with transient
+  /// slips). The tire is quasi-steady while it is in contact, |V_cx| exceeds
+  /// speed_factor times the cut-off speed of the low speed damping (see
+  /// SetLowSpeedDamping), the rates of the kinematic slips kappa, tan(alpha)
+  /// and gamma are below slip_rate_tol, and the transient slips are within
+  /// slip_lag_tol of the kinematic ones. The slip ODEs are then not
+  /// integrated; instead, the deflections u, v_alpha, v_gamma and v_phi are
+  /// set to their equilibrium values. Integration resumes from these values
+  /// as soon as one of the conditions fails, so the switch back to transient
+  /// slips is continuous.
+  void SetAutoTransient(
+    bool   enable,                ///< [in] enable automatic switching
+    double slip_rate_tol = 0.05,  ///< [in] max. rate of the kinematic slips [1/s]
+    double slip_lag_tol = 1e-4,   ///< [in] max. difference between transient and kinematic slips
+    double speed_factor = 4       ///< [in] min. |V_cx|, as a multiple of the low speed cut-off
+    );
+
+  /// Return true if automatic transient switching is enabled.
+  bool IsAutoTransient() const { return m_auto_transient; }
+
+  /// Return true if the last step used the steady-state slips.
+  bool IsQuasiSteady() const { return m_quasi_steady; }
+
+  /// Enable the enveloping contact model (disabled by default).
+  /// Instead of the single point below the wheel, the terrain is sampled on a
+  /// num_long x num_lat grid over a footprint of the specified length and
+  /// width, and the tire contact is evaluated against the least squares plane
+  /// through these samples (see ChTire::envelope_terrain_contact()). On rough
+  /// terrain this filters the vertical load and the contact frame used by the
+  /// Magic Formula. A 1 x 1 grid reverts to the single point contact model.
+  void SetEnvelopingContact(
+    int    num_long,   ///< [in] number of samples along the rolling direction
+    int    num_lat,    ///< [in] number of samples across the footprint
+    double length,     ///< [in] footprint length
+    double width       ///< [in] footprint width
+    );
+
+  /// Return true if the enveloping contact model is enabled.
+  bool IsEnvelopingContact() const { return m_env_num_long * m_env_num_lat > 1; }
+
+  /// Enable/disable the use of pre-parsed binary parameter files.
+  /// If enabled (default), the parameters of a *.tir file are loaded from the
+  /// binary file with the same name and extension ".bin" if it exists and it
+  /// matches the current contents of the *.tir file; otherwise, the *.tir
+  /// file is parsed and the binary file is (re)generated.
+  static void EnableParamCache(bool val) { m_use_param_cache = val; }
+
+  /// Return true if this tire uses the tabulated Magic Formula.
+  /// Slips or loads outside of the tabulated ranges are still evaluated with
+  /// the analytical Magic Formula.
+  bool IsTabulated() const { return m_table != 0; }
+
+  /// Get the estimated error bound (Fx, Fy, Mz) of the tabulated combined slip
+  /// reactions, relative to the analytical Magic Formula. This is the maximum
+  /// deviation found at the centers of all grid cells, where the interpolation
+  /// error of smooth curves is largest. Zero if not tabulated.
+  ChVector<> get_tabulation_error() const { return m_table ? m_table->GetErrorCombined() : ChVector<>(); }
+
+  /// Enable/disable the polynomial approximations of atan, sin and cos in the
+  /// analytical Magic Formula (default: disabled). See ChFastMath.h for their
+  /// error bounds; the resulting reactions differ from the exact ones by a
+  /// small fraction of the force range. The tabulated curves, if any, are
+  /// always computed with the exact functions.
+  void SetFastMath(bool val) { m_fast_math = val; m_loadCoefs_valid = false; }
+
+  /// Return true if this tire uses the approximated transcendental functions.
+  bool IsFastMath() const { return m_fast_math; }
+
+  /// Set the tolerances for reusing the Magic Formula terms which depend only
+  /// on the vertical load and the inclination angle (default: 0, 0).
+  /// These terms are cached and recomputed only if dF_z = (Fz - Fz,nom) / Fz,nom
+  /// or gamma moved by more than the given tolerances since they were last
+  /// computed. With zero tolerances, they are reused only while the load and
+  /// inclination are unchanged (e.g. with a prescribed vertical load), and the
+  /// results are identical to recomputing them at each call.
+  void SetCoefCacheTolerance(
+    double dF_z_tol,   ///< [in] tolerance on the normalized load change
+    double gamma_tol   ///< [in] tolerance on the inclination angle [rad]
+    ) { m_coef_tol_dF_z = dF_z_tol; m_coef_tol_gamma = gamma_tol; m_loadCoefs_valid = false; }
+
+  /// Get the number of Magic Formula evaluations which reused the cached
+  /// load/camber dependent terms.
+  long get_num_coef_cache_hits() const { return m_num_coef_cache_hits; }
+
+  /// Get the number of Magic Formula evaluations which recomputed the
+  /// load/camber dependent terms.
+  long get_num_coef_cache_misses() const { return m_num_coef_cache_misses; }
+
+  /// Types of diagnostics recorded by the tire. The reaction thresholds are
+  /// fixed sanity limits; the ranges are those of the RANGES sections of the
+  /// parameter file.
+  enum Diagnostic {
+    DIAG_FX,            ///< |Fx| above threshold
+    DIAG_FY,            ///< |Fy| above threshold
+    DIAG_FZ,            ///< |Fz| above threshold
+    DIAG_MX,            ///< |Mx| above threshold
+    DIAG_MY,            ///< |My| above threshold
+    DIAG_MZ,            ///< |Mz| above threshold
+    DIAG_KAPPA_RANGE,   ///< longitudinal slip outside [kpumin, kpumax]
+    DIAG_ALPHA_RANGE,   ///< slip angle outside [alpmin, alpmax]
+    DIAG_GAMMA_RANGE,   ///< inclination angle outside [cammin, cammax]
+    DIAG_FZ_RANGE,      ///< vertical load outside [fzmin, fzmax]
+    DIAG_NO_PARAMS,     ///< Update() called before the parameters were loaded
+    DIAG_LOW_VELOCITY,  ///< Update() skipped, forward velocity too small
+    NUM_DIAGNOSTICS
+  };
+
+  /// Diagnostic record, queued at the onset of each violation.
+  struct DiagnosticRecord {
+    double     time;    ///< simulation time
+    Diagnostic type;    ///< type of violation
+    double     value;   ///< offending value
+  };
+
+  /// Get the number of steps (or Update() calls) with the specified violation.
+  long GetDiagnosticCount(Diagnostic type) const { return m_diag_count[type]; }
+
+  /// Get the number of diagnostic records dropped because the queue was full.
+  long GetNumDroppedDiagnostics() const { return m_diag_dropped; }
+
+  /// Remove the oldest queued diagnostic record. Returns false if there is none.
+  /// The records are queued without locking by the thread advancing the tire;
+  /// this function may be called from one other thread (e.g. a logging thread)
+  /// while the simulation runs.
+  bool PopDiagnostic(DiagnosticRecord& rec) { return m_diag_queue.Pop(rec); }
+
+  /// Write the queued records and a summary of the violation counts to the
+  /// log, then reset the counts. Nothing is written if there were no
+  /// violations. Called by the destructor.
+  void ReportDiagnostics();
+
+  /// Get the name of the specified diagnostic type.
+  static const char* GetDiagnosticName(Diagnostic type);
+
 private:
 
   // where to find the input parameter file
@@ -178,21 +462,21 @@ private:
 
   // once Pac tire input text file has been succesfully opened, read the input
   // data, and populate the data struct
-  virtual void readPacTireInput(std::ifstream& inFile);
+  virtual void readPacTireInput(std::ifstream& inFile, Pac2002_data& params);
 
   // functions for reading each section in the paramter file
-  void readSection_UNITS(std::ifstream& inFile);
-  void readSection_MODEL(std::ifstream& inFile);
-  void readSection_DIMENSION(std::ifstream& inFile);
-  void readSection_SHAPE(std::ifstream& inFile);
-  void readSection_VERTICAL(std::ifstream& inFile);
-  void readSection_RANGES(std::ifstream& inFile);
-  void readSection_scaling(std::ifstream& inFile);
-  void readSection_longitudinal(std::ifstream& inFile);
-  void readSection_overturning(std::ifstream& inFile);
-  void readSection_lateral(std::ifstream& inFile);
-  void readSection_rolling(std::ifstream& inFile);
-  void readSection_aligning(std::ifstream& inFile);
+  void readSection_UNITS(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_MODEL(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_DIMENSION(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_SHAPE(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_VERTICAL(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_RANGES(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_scaling(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_longitudinal(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_overturning(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_lateral(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_rolling(std::ifstream& inFile, Pac2002_data& params);
+  void readSection_aligning(std::ifstream& inFile, Pac2002_data& params);
 
   /// update the tire contact coordinate system, TYDEX W-Axis
   /// checks for contact, sets m_in_contact and m_depth
@@ -204,6 +488,9 @@ private:
   // find the vertical load, using a spring-damper model
   double calc_Fz();
 
+  // linearly implicit vertical load over the coupling step
+  double implicit_Fz(double Fz) const;
+
   // calculate the various stiffness/relaxation lengths
   void relaxationLengths();
 
@@ -214,21 +501,50 @@ private:
   // set the tire m_slip vector to all zeros
   void zero_slips();
 
-  // check if slips fall within a specified valid range
+  // check if slips and load fall within the ranges of the parameter file
   void evaluate_slips();
 
   // after calculating all the reactions, evaluate output for any fishy business
-  // write_violations: any output threshold exceeded gets written to console
+  // write_violations: write the slip state to the log when a threshold is exceeded
   // enforce_threshold: enforce the limits when forces/moments exceed thresholds (except on Fz)
   void evaluate_reactions(bool write_violations, bool enforce_threshold);
 
   void advance_tire(double step);
 
+  // advance the slip quantities over the specified step, either kinematically
+  // or through the transient slip ODEs (timed in m_sum_ODE_time)
+  void advance_slips(double step);
+
+  // check the quasi-steady conditions for the current kinematic slips (see
+  // SetAutoTransient) and update the previous kinematic slips
+  bool check_quasi_steady(double step);
+
+  // set the transient slip deflections to the equilibrium of the slip ODEs,
+  // then the transient slips from these
+  void slip_steady_transient();
+
+  // calculate Mx, My from the combined slip forces and check the reactions;
+  // called once the pure and combined slip reactions are available
+  void finalize_reactions();
+
+  // express the current reactions in the wheel and global frames
+  void update_reaction_frames();
+
+  // accumulate the frictional power in the thermal model and, after its
+  // update, the grip factor to apply
+  void update_thermal(double step);
+
   // calculate transient slip properties, using first order ODEs to find slip
   // displacements from velocities
   // appends m_slips for the slip displacements, and integrated slip velocity terms
   void advance_slip_transient(double step);
 
+  // sub-step for the EXPONENTIAL integrator, from the current relaxation lengths
+  double transient_substep(double remaining_time) const;
+
+  // exact increment of the linear ODE dx/dt = a - lambda * x over step_size
+  static double ODE_exp(double a, double lambda, double step_size, double x_curr);
+
   // calculate the increment delta_x using RK 45 integration for linear u, v_alpha
   // Eq. 7.9 and 7.7, respectively
   double ODE_RK_uv(
@@ -288,6 +604,37 @@ private:
   /// assign Fx, Fy, Mz
   void combinedSlipReactions( );
 
+  /// calculate the pure and combined slip reactions from the tabulated curves
+  /// return false if the slips or the load are outside the tabulated ranges
+  /// only the intermediate factors used by the transient slip model are updated
+  bool tabulatedSlipReactions( );
+
+  // find or build the tabulated Magic Formula curves for this parameter block
+  void buildTable();
+
+  // evaluate the analytical Magic Formula with cos(alpha') = 1, Vx > 0;
+  // return the values stored in ChPacejkaTable and the pure/combined reactions
+  void analytic_curves(double kappa, double alpha, double gamma, double Fz,
+    double& Fx, double lat[2], double combined[ChPacejkaTable::NUM_COMBINED],
+    ChVector<>& pure, ChVector<>& comb);
+
+  // pure/combined reactions (Fx, Fy, Mz) from the tabulated curves, at the
+  // current vertical load
+  void table_reactions(double kappa, double alpha, double gamma,
+    double cosPrime_alpha, int sign_Vx,
+    ChVector<>& pure, ChVector<>& comb, double combined[ChPacejkaTable::NUM_COMBINED]);
+
+  /// count the violations flagged in 'flags' (bits of the Diagnostic types in
+  /// 'mask'); queue a record for each violation that was not active before
+  void record_diagnostics(int flags, int mask);
+
+  /// current value of the quantity checked by the specified diagnostic
+  double diagnostic_value(Diagnostic type) const;
+
+  /// update the cached terms which depend only on the load, the inclination
+  /// angle and the friction scaling, if these changed beyond the tolerances
+  void update_loadCoefs(double gamma);
+
   /// longitudinal force, alpha ~= 0
   /// assign to m_FM.force.x
   /// assign m_pureLong, trionometric function calculated constants
@@ -323,6 +670,11 @@ private:
   /// assign m_FM.moment.x and m_FM_combined.moment.x
   double calc_Mx(double gamma, double Fy_combined);
 
+  // transcendental functions of the Magic Formula (see SetFastMath)
+  double mf_atan(double x) const { return m_fast_math ? ChFastAtan(x) : std::atan(x); }
+  double mf_sin(double x) const { return m_fast_math ? ChFastSin(x) : std::sin(x); }
+  double mf_cos(double x) const { return m_fast_math ? ChFastCos(x) : std::cos(x); }
+
   /// calculate the rolling resistance moment,
   /// assign m_FM.moment.y and m_FM_combined.moment.y
   double calc_My(double Fx_combined);
@@ -353,7 +705,45 @@ private:
   double m_time_since_last_step; // init. to -1 in Initialize()
   bool m_initial_step;         // so Advance() gets called at time = 0
   int m_num_ODE_calls;
+  int m_num_ODE_substeps;
   double m_sum_ODE_time;
+  TransientIntegrator m_integrator;  // scheme for the transient slip ODEs
+  double m_substep_factor;     // EXPONENTIAL sub-step / shortest relaxation time
+  double m_bessel_Cx;          // Besselink low speed damping, longitudinal
+  double m_bessel_Cy;          // Besselink low speed damping, lateral
+  double m_bessel_V_low;       // Besselink low speed damping cut-off speed
+  bool m_defer_slip_from_uv;   // transient slips evaluated by ChPacejkaTireBatch
+  bool m_implicit_Fz;          // use the linearly implicit vertical load
+  double m_implicit_Fz_mass;   // effective wheel mass for the implicit vertical load
+  double m_Fz_prev;            // vertical load applied at the previous step
+  double m_contact_vz;         // separation velocity at the contact point
+  double m_coupling_step;      // step of the last call to Advance()
+  bool m_auto_transient;       // switch to steady-state slips when quasi-steady
+  double m_auto_rate_tol;      // max. kinematic slip rate for quasi-steady
+  double m_auto_lag_tol;       // max. transient slip lag for quasi-steady
+  double m_auto_speed_factor;  // min. |V_cx| for quasi-steady, times the low speed cut-off
+  bool m_quasi_steady;         // last step used the steady-state slips
+  bool m_slip_prev_valid;      // previous kinematic slips are set
+  double m_kappa_prev;         // previous kinematic slips, for the slip rates
+  double m_alpha_prev;
+  double m_gamma_prev;
+  double m_sum_transient_time; // simulated time with the slip ODEs integrated
+  double m_sum_steady_time;    // simulated time with the steady-state slips
+  int m_env_num_long;          // enveloping contact: samples along the footprint
+  int m_env_num_lat;           // enveloping contact: samples across the footprint
+  double m_env_length;         // enveloping contact: footprint length
+  double m_env_width;          // enveloping contact: footprint width
+  double m_mu_scale;           // terrain friction scaling of lmux and lmuy
+  bool m_fast_math;            // use the approximated atan, sin and cos
+  bool m_use_thermal;          // use the thermal and wear model
+  double m_grip_tol;           // min. change of the applied grip factor
+  double m_grip_scale;         // thermal and wear scaling of lmux and lmuy
+  ChTireThermal m_thermal;     // thermal and wear model
+  bool m_loadCoefs_valid;      // m_loadCoefs holds the terms for the cached key
+  double m_coef_tol_dF_z;      // cache tolerance on dF_z
+  double m_coef_tol_gamma;     // cache tolerance on gamma
+  long m_num_coef_cache_hits;
+  long m_num_coef_cache_misses;
   int m_num_Advance_calls;
   double m_sum_Advance_time;
 
@@ -362,6 +752,10 @@ private:
   // previous steps calculated reaction
   ChTireForce m_FM_pure_last;
   ChTireForce m_FM_combined_last;
+  // current reactions in the global and wheel frames (see update_reaction_frames)
+  ChTireForce m_FM_pure_global;
+  ChTireForce m_FM_combined_global;
+  ChTireForce m_FM_combined_wheel;
 
   // TODO: could calculate these using sigma_kappa_adams and sigma_alpha_adams, in getRelaxationLengths()
   // HARDCODED IN Initialize() for now
@@ -373,6 +767,17 @@ private:
 
   int m_Num_WriteOutData;      // number of times WriteOut was called
 
+  vehicle::ChOutputChannel::Format m_out_format;  // output file format
+  vehicle::ChOutputChannel*        m_out;         // output channel (created on first use)
+  std::vector<double>              m_out_tol;     // output sampling tolerances (empty: all rows)
+  double                           m_out_max_gap; // maximum time between sampled rows
+
+  // diagnostics
+  long m_diag_count[NUM_DIAGNOSTICS];  // number of violations, per type
+  long m_diag_dropped;                 // records dropped (queue full)
+  int m_diag_active;                   // bit mask of the currently active violations
+  vehicle::ChSpscQueue<DiagnosticRecord> m_diag_queue;
+
   bool m_params_defined;       // indicates if model params. have been defined/loaded
 
   // MODEL PARAMETERS
@@ -380,8 +785,16 @@ private:
   // important slip quantities
   slips*               m_slip;
 
-  // model parameter factors stored here
-  Pac2002_data*        m_params;
+  // model parameter factors stored here, shared (read-only) by all tires
+  // using the same parameter file
+  const ChPac2002Params* m_paramBlock;
+  const Pac2002_data*  m_params;
+
+  static bool          m_use_param_cache;
+
+  // tabulated Magic Formula, owned by the parameter block
+  ChPacejkaTable::Settings m_tabulation;
+  const ChPacejkaTable* m_table;
 
   // for keeping track of intermediate factors in the PacTire model
   pureLongCoefs*       m_pureLong;
@@ -394,10 +807,15 @@ private:
 
   zetaCoefs*           m_zeta;
 
+  // load/camber dependent terms, cached between steps
+  loadCoefs*           m_loadCoefs;
+
   // for transient contact point tire model
   relaxationL*         m_relaxation;
   bessel* m_bessel;
 
+  friend class ChPacejkaTireBatch;
+  friend class ChPacejkaFit;
 };
 
 
@@ -405,7 +823,7 @@ private:
 // String manipulation utility functions.
 // -----------------------------------------------------------------------------
 
-std::vector<std::string>& splitStr(const std::string &s, char delim, std::vector<std::string> &elems){
+inline std::vector<std::string>& splitStr(const std::string &s, char delim, std::vector<std::string> &elems){
   std::stringstream ss(s);
   std::string item;
   while (getline(ss, item, delim)) {
@@ -414,7 +832,7 @@ std::vector<std::string>& splitStr(const std::string &s, char delim, std::vector
   return elems;
 }
 
-std::vector<std::string> splitStr(const std::string &s, char delim) {
+inline std::vector<std::string> splitStr(const std::string &s, char delim) {
   std::vector<std::string> elems;
   return splitStr(s, delim, elems);
 }
@@ -0,0 +1,627 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Batched evaluation of the Pacejka 2002 Magic Formula for a collection of
+// ChPacejkaTire objects.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChTimer.h"
+
+#include "ChronoVehicle_config.h"
+
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/tire/ChPac2002_data.h"
+#if TIRE_CUDA_ENABLED
+#include "subsys/tire/ChPacejkaBatchDevice.h"
+#endif
+
+// Tell the compiler that the lane buffers do not alias, so that the kernel
+// loop can be vectorized without run-time overlap checks.
+#if defined(_MSC_VER)
+#define CH_PACBATCH_IVDEP __pragma(loop(ivdep))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define CH_PACBATCH_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define CH_PACBATCH_IVDEP _Pragma("clang loop vectorize(enable)")
+#else
+#define CH_PACBATCH_IVDEP
+#endif
+
+namespace chrono {
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaTireBatch::ChPacejkaTireBatch()
+: m_lanes(0),
+  m_stride(0),
+  m_capacity(0),
+  m_single(false),
+  m_device(0),
+  m_params_changed(false),
+  m_advancing(false),
+  m_step(0),
+  m_fast_math(false),
+  m_num_kernel_calls(0),
+  m_sum_kernel_time(0),
+  m_kernel_time(0),
+  m_slip_tol(1e-12),
+  m_slip_max_iter(50),
+  m_num_slip_problems(0),
+  m_num_slip_iterations(0)
+{
+}
+
+ChPacejkaTireBatch::~ChPacejkaTireBatch()
+{
+  DisableDevice();
+  free_lanes();
+}
+
+// -----------------------------------------------------------------------------
+// Magic Formula parameters of a tire, in lane parameter order.
+// -----------------------------------------------------------------------------
+void ChPacejkaTireBatch::PackParameters(const ChPacejkaTire& tire, double* values)
+{
+  const Pac2002_data& p = *tire.m_params;
+  const zetaCoefs& z = *tire.m_zeta;
+
+  double packed[Lanes::NUM_PARAMS] = {
+    p.vertical.fnomin, tire.m_R0,
+    p.longitudinal.pcx1, p.longitudinal.pdx1, p.longitudinal.pdx2, p.longitudinal.pdx3,
+    p.longitudinal.pex1, p.longitudinal.pex2, p.longitudinal.pex3, p.longitudinal.pex4,
+    p.longitudinal.pkx1, p.longitudinal.pkx2, p.longitudinal.pkx3, p.longitudinal.phx1,
+    p.longitudinal.phx2, p.longitudinal.pvx1, p.longitudinal.pvx2,
+    p.longitudinal.rbx1, p.longitudinal.rbx2, p.longitudinal.rcx1, p.longitudinal.rex1,
+    p.longitudinal.rex2, p.longitudinal.rhx1,
+    p.lateral.pcy1, p.lateral.pdy1, p.lateral.pdy2, p.lateral.pdy3,
+    p.lateral.pey1, p.lateral.pey2, p.lateral.pey3, p.lateral.pey4,
+    p.lateral.pky1, p.lateral.pky2, p.lateral.pky3, p.lateral.phy1, p.lateral.phy2, p.lateral.phy3,
+    p.lateral.pvy1, p.lateral.pvy2, p.lateral.pvy3, p.lateral.pvy4,
+    p.lateral.rby1, p.lateral.rby2, p.lateral.rby3, p.lateral.rcy1, p.lateral.rey1, p.lateral.rey2,
+    p.lateral.rhy1, p.lateral.rhy2,
+    p.lateral.rvy1, p.lateral.rvy2, p.lateral.rvy3, p.lateral.rvy4, p.lateral.rvy5, p.lateral.rvy6,
+    p.aligning.qbz1, p.aligning.qbz2, p.aligning.qbz3, p.aligning.qbz4, p.aligning.qbz5,
+    p.aligning.qbz9, p.aligning.qbz10, p.aligning.qcz1,
+    p.aligning.qdz1, p.aligning.qdz2, p.aligning.qdz3, p.aligning.qdz4,
+    p.aligning.qdz6, p.aligning.qdz7, p.aligning.qdz8, p.aligning.qdz9,
+    p.aligning.qez1, p.aligning.qez2, p.aligning.qez3, p.aligning.qez4, p.aligning.qez5,
+    p.aligning.qhz1, p.aligning.qhz2, p.aligning.qhz3, p.aligning.qhz4,
+    p.aligning.ssz1, p.aligning.ssz2, p.aligning.ssz3, p.aligning.ssz4,
+    p.scaling.lcx, p.scaling.lmux, p.scaling.lex, p.scaling.lkx, p.scaling.lhx, p.scaling.lvx,
+    p.scaling.lcy, p.scaling.lmuy, p.scaling.ley, p.scaling.lky, p.scaling.lhy, p.scaling.lvy,
+    p.scaling.ltr, p.scaling.lres, p.scaling.lxal, p.scaling.lyka, p.scaling.lvyka, p.scaling.ls,
+    z.z0, z.z1, z.z2, z.z3, z.z4, z.z5, z.z6, z.z7, z.z8,
+    p.model.longvl
+  };
+
+  std::copy(packed, packed + Lanes::NUM_PARAMS, values);
+}
+
+// -----------------------------------------------------------------------------
+// Add a tire to the batch and copy its Magic Formula parameters in the
+// corresponding lane of the parameter buffers.
+// -----------------------------------------------------------------------------
+int ChPacejkaTireBatch::AddTire(ChSharedPtr<ChPacejkaTire> tire)
+{
+  if (!tire->m_params_defined) {
+    GetLog() << " ERROR: cannot add tire " << tire->m_name.c_str() << " to batch, parameters not loaded \n\n";
+    return -1;
+  }
+
+  double values[Lanes::NUM_PARAMS];
+  PackParameters(*tire, values);
+
+  int lane = (int)m_tires.size();
+  if (lane == m_capacity)
+    reserve(std::max(2 * m_capacity, 16));
+
+  for (int k = 0; k < Lanes::NUM_PARAMS; k++) {
+    m_par[(size_t)k * m_stride + lane] = values[k];
+    m_par_f[(size_t)k * m_stride + lane] = (float)values[k];
+  }
+  m_params_changed = true;
+
+  m_tires.push_back(tire);
+
+  return lane;
+}
+
+// -----------------------------------------------------------------------------
+// The lane arrays have room for m_capacity tires; they grow by doubling, so
+// that tires can be added one at a time. Only the parameters need to be kept,
+// the per-step lane data is packed again at each step. The arrays are one
+// cache line longer than the capacity: with a power of two stride, all arrays
+// would start in the same cache sets, and the lane loops, which access all of
+// them at once, would keep evicting their own data.
+// -----------------------------------------------------------------------------
+void ChPacejkaTireBatch::reserve(int capacity)
+{
+  int stride = capacity + 8;
+  std::vector<double> par((size_t)Lanes::NUM_PARAMS * stride, 0.0);
+  for (int k = 0; k < Lanes::NUM_PARAMS; k++)
+    std::copy(m_par.begin() + (size_t)k * m_stride, m_par.begin() + (size_t)k * m_stride + m_tires.size(),
+              par.begin() + (size_t)k * stride);
+  m_par.swap(par);
+
+  std::vector<float> par_f((size_t)Lanes::NUM_PARAMS * stride, 0.0f);
+  for (int k = 0; k < Lanes::NUM_PARAMS; k++)
+    std::copy(m_par_f.begin() + (size_t)k * m_stride, m_par_f.begin() + (size_t)k * m_stride + m_tires.size(),
+              par_f.begin() + (size_t)k * stride);
+  m_par_f.swap(par_f);
+  m_lanes_f.assign((size_t)Lanes::NUM_LANE_SLOTS * stride, 0.0f);
+
+  free_lanes();
+  m_capacity = capacity;
+  m_stride = stride;
+  alloc_lanes();
+}
+
+void ChPacejkaTireBatch::alloc_lanes()
+{
+  size_t size = (size_t)Lanes::NUM_LANE_SLOTS * m_stride;
+#if TIRE_CUDA_ENABLED
+  if (m_device) {
+    m_lanes = m_device->AllocHost(size);
+    if (m_lanes) {
+      std::fill(m_lanes, m_lanes + size, 0.0);
+      return;
+    }
+    GetLog() << " WARNING: tire batch back to host evaluation \n";
+    delete m_device;
+    m_device = 0;
+  }
+#endif
+  m_lanes = new double[size];
+  std::fill(m_lanes, m_lanes + size, 0.0);
+}
+
+void ChPacejkaTireBatch::free_lanes()
+{
+#if TIRE_CUDA_ENABLED
+  if (m_device) {
+    m_device->FreeHost(m_lanes);
+    m_lanes = 0;
+    return;
+  }
+#endif
+  delete[] m_lanes;
+  m_lanes = 0;
+}
+
+ChPacejkaBatchLanes ChPacejkaTireBatch::get_lanes() const
+{
+  Lanes lanes;
+  lanes.par = m_par.empty() ? 0 : &m_par[0];
+  lanes.lanes = m_lanes;
+  lanes.stride = m_stride;
+  return lanes;
+}
+
+ChPacejkaBatchLanesF ChPacejkaTireBatch::get_lanes_f() const
+{
+  LanesF lanes;
+  lanes.par = m_par_f.empty() ? 0 : &m_par_f[0];
+  lanes.lanes = m_lanes_f.empty() ? 0 : const_cast<float*>(&m_lanes_f[0]);
+  lanes.stride = m_stride;
+  return lanes;
+}
+
+// -----------------------------------------------------------------------------
+// The host lane data is reallocated in page-locked (or back in pageable)
+// memory when the device is enabled (or disabled).
+// -----------------------------------------------------------------------------
+bool ChPacejkaTireBatch::EnableDevice(int device)
+{
+#if TIRE_CUDA_ENABLED
+  EndAdvance();
+  DisableDevice();
+
+  ChPacejkaBatchDevice* dev = ChPacejkaBatchDevice::Create(device);
+  if (!dev)
+    return false;
+
+  free_lanes();
+  m_device = dev;
+  m_params_changed = true;
+  alloc_lanes();
+
+  return m_device != 0;
+#else
+  GetLog() << " ERROR: tire batch device evaluation requires ENABLE_TIRE_CUDA \n";
+  return false;
+#endif
+}
+
+void ChPacejkaTireBatch::DisableDevice()
+{
+#if TIRE_CUDA_ENABLED
+  if (!m_device)
+    return;
+
+  EndAdvance();
+  free_lanes();
+  delete m_device;
+  m_device = 0;
+  alloc_lanes();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Advance all tires in the batch. This replaces the individual calls to
+// ChPacejkaTire::Advance() and produces the same tire state.
+// -----------------------------------------------------------------------------
+void ChPacejkaTireBatch::Advance(double step)
+{
+  BeginAdvance(step);
+  EndAdvance();
+}
+
+void ChPacejkaTireBatch::BeginAdvance(double step)
+{
+  EndAdvance();
+
+  if (m_tires.empty())
+    return;
+
+  // Per-tire slip quantities (kinematic or transient). The transient slips
+  // are only evaluated from the slip deflections in blend_slips().
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    ChPacejkaTire* tire = m_tires[i].get_ptr();
+    tire->m_num_Advance_calls++;
+    tire->m_defer_slip_from_uv = tire->m_use_transient_slip;
+    tire->advance_slips(step);
+    tire->m_defer_slip_from_uv = false;
+  }
+
+  m_advancing = true;
+  m_step = step;
+
+  // Magic Formula, all lanes at once
+  ChTimer<double> kernel_timer;
+  kernel_timer.start();
+
+  pack();
+
+#if TIRE_CUDA_ENABLED
+  if (m_device && m_params_changed) {
+    m_params_changed = !m_device->SetParams(&m_par[0], m_stride);
+    if (m_params_changed) {
+      GetLog() << " WARNING: tire batch back to host evaluation \n";
+      DisableDevice();
+      pack();
+    }
+  }
+  if (m_device) {
+    m_device->Launch(m_lanes, (int)m_tires.size(), m_fast_math);
+    kernel_timer.stop();
+    m_kernel_time = kernel_timer();
+    return;
+  }
+#endif
+
+  blend_slips();
+  evaluate();
+
+  kernel_timer.stop();
+  m_kernel_time = kernel_timer();
+}
+
+void ChPacejkaTireBatch::EndAdvance()
+{
+  if (!m_advancing)
+    return;
+
+  m_advancing = false;
+
+  ChTimer<double> kernel_timer;
+  kernel_timer.start();
+
+#if TIRE_CUDA_ENABLED
+  if (m_device && !m_device->Wait()) {
+    // evaluate the lanes again on the host
+    GetLog() << " WARNING: tire batch back to host evaluation \n";
+    DisableDevice();
+    pack();
+    blend_slips();
+    evaluate();
+  }
+#endif
+
+  unpack();
+
+  kernel_timer.stop();
+  m_num_kernel_calls++;
+  m_sum_kernel_time += m_kernel_time + kernel_timer();
+
+  // Per-tire overturning and rolling resistance moments, thermal model
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    m_tires[i]->finalize_reactions();
+    m_tires[i]->update_thermal(m_step);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The lane data is packed, evaluated and unpacked in double precision, or in
+// single precision if requested (the conversions are done while packing and
+// unpacking, so there are no additional passes over the lanes).
+// -----------------------------------------------------------------------------
+void ChPacejkaTireBatch::pack()
+{
+  if (use_single())
+    pack_lanes(get_lanes_f());
+  else
+    pack_lanes(get_lanes());
+}
+
+void ChPacejkaTireBatch::blend_slips()
+{
+  if (use_single())
+    blend_lanes(get_lanes_f());
+  else
+    blend_lanes(get_lanes());
+}
+
+void ChPacejkaTireBatch::evaluate()
+{
+  if (use_single()) {
+    if (m_fast_math)
+      evaluate_lanes<ChFastMath>(get_lanes_f());
+    else
+      evaluate_lanes<ChStdMath>(get_lanes_f());
+  } else {
+    if (m_fast_math)
+      evaluate_lanes<ChFastMath>(get_lanes());
+    else
+      evaluate_lanes<ChStdMath>(get_lanes());
+  }
+}
+
+void ChPacejkaTireBatch::unpack()
+{
+  if (use_single())
+    unpack_lanes(get_lanes_f());
+  else
+    unpack_lanes(get_lanes());
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+template <typename Real>
+void ChPacejkaTireBatch::pack_lanes(const ChPacejkaBatchLanesT<Real>& lanes)
+{
+  Real* Fz = lanes.Lane(Lanes::L_FZ);
+  Real* dF_z = lanes.Lane(Lanes::L_DF_Z);
+  Real* kappaP = lanes.Lane(Lanes::L_KAPPAP);
+  Real* alphaP = lanes.Lane(Lanes::L_ALPHAP);
+  Real* gammaP = lanes.Lane(Lanes::L_GAMMAP);
+  Real* cosPrime_alpha = lanes.Lane(Lanes::L_COS_ALPHA);
+  Real* V_cx = lanes.Lane(Lanes::L_V_CX);
+  Real* sameSide = lanes.Lane(Lanes::L_SAME_SIDE);
+  Real* mu_scale = lanes.Lane(Lanes::L_MU_SCALE);
+  Real* uv_mask = lanes.Lane(Lanes::L_UV_MASK);
+  Real* in_contact = lanes.Lane(Lanes::L_IN_CONTACT);
+  Real* V_sx = lanes.Lane(Lanes::L_V_SX);
+  Real* V_sy = lanes.Lane(Lanes::L_V_SY);
+  Real* psi_dot = lanes.Lane(Lanes::L_PSI_DOT);
+  Real* u = lanes.Lane(Lanes::L_U);
+  Real* v_alpha = lanes.Lane(Lanes::L_V_ALPHA);
+  Real* v_gamma = lanes.Lane(Lanes::L_V_GAMMA);
+  Real* v_phi = lanes.Lane(Lanes::L_V_PHI);
+  Real* sigma_kappa = lanes.Lane(Lanes::L_SIGMA_KAPPA);
+  Real* sigma_alpha = lanes.Lane(Lanes::L_SIGMA_ALPHA);
+  Real* C_Fkappa = lanes.Lane(Lanes::L_C_FKAPPA);
+  Real* C_Falpha = lanes.Lane(Lanes::L_C_FALPHA);
+  Real* C_Fgamma = lanes.Lane(Lanes::L_C_FGAMMA);
+  Real* C_Fphi = lanes.Lane(Lanes::L_C_FPHI);
+  Real* bessel_Cx = lanes.Lane(Lanes::L_BESSEL_CX);
+  Real* bessel_Cy = lanes.Lane(Lanes::L_BESSEL_CY);
+  Real* bessel_V_low = lanes.Lane(Lanes::L_BESSEL_V_LOW);
+
+  m_fast_math = true;
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    const ChPacejkaTire* tire = m_tires[i].get_ptr();
+    m_fast_math = m_fast_math && tire->m_fast_math;
+    Fz[i] = Real(tire->m_Fz);
+    dF_z[i] = Real(tire->m_dF_z);
+    kappaP[i] = Real(tire->m_slip->kappaP);
+    alphaP[i] = Real(tire->m_slip->alphaP);
+    gammaP[i] = Real(tire->m_slip->gammaP);
+    cosPrime_alpha[i] = Real(tire->m_slip->cosPrime_alpha);
+    V_cx[i] = Real(tire->m_slip->V_cx);
+    sameSide[i] = Real(tire->m_sameSide);
+    mu_scale[i] = Real(tire->m_mu_scale);
+
+    // The relaxation data is only set for tires with transient slips; the
+    // other lanes get neutral values and are masked out.
+    bool transient = tire->m_use_transient_slip;
+    const relaxationL& r = *tire->m_relaxation;
+    uv_mask[i] = Real(transient ? 1.0 : 0.0);
+    in_contact[i] = Real(tire->m_in_contact ? 1.0 : 0.0);
+    V_sx[i] = Real(tire->m_slip->V_sx);
+    V_sy[i] = Real(tire->m_slip->V_sy);
+    psi_dot[i] = Real(tire->m_slip->psi_dot);
+    u[i] = Real(tire->m_slip->u);
+    v_alpha[i] = Real(tire->m_slip->v_alpha);
+    v_gamma[i] = Real(tire->m_slip->v_gamma);
+    v_phi[i] = Real(tire->m_slip->v_phi);
+    sigma_kappa[i] = Real(transient ? r.sigma_kappa : 1.0);
+    sigma_alpha[i] = Real(transient ? r.sigma_alpha : 1.0);
+    C_Fkappa[i] = Real(transient ? r.C_Fkappa : 1.0);
+    C_Falpha[i] = Real(transient ? r.C_Falpha : 1.0);
+    C_Fgamma[i] = Real(transient ? r.C_Fgamma : 1.0);
+    C_Fphi[i] = Real(transient ? r.C_Fphi : 1.0);
+    bessel_Cx[i] = Real(tire->m_bessel_Cx);
+    bessel_Cy[i] = Real(tire->m_bessel_Cy);
+    bessel_V_low[i] = Real(tire->m_bessel_V_low);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Lane loops of the low speed slip blending and the Magic Formula kernels (see
+// ChPacejkaBatchLanes). The lane data does not alias, so that the loops can be
+// vectorized; the transcendental functions used by the Magic Formula are
+// provided by the MATH policy (ChStdMath or ChFastMath).
+// -----------------------------------------------------------------------------
+template <typename Real>
+void ChPacejkaTireBatch::blend_lanes(const ChPacejkaBatchLanesT<Real>& lanes)
+{
+  const int n = (int)m_tires.size();
+
+  CH_PACBATCH_IVDEP
+  for (int i = 0; i < n; i++)
+    lanes.BlendSlips(i);
+}
+
+template <class MATH, typename Real>
+void ChPacejkaTireBatch::evaluate_lanes(const ChPacejkaBatchLanesT<Real>& lanes)
+{
+  const int n = (int)m_tires.size();
+
+  CH_PACBATCH_IVDEP
+  for (int i = 0; i < n; i++)
+    lanes.template Evaluate<MATH>(i);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the lane results back to the tires. As in the scalar path, the
+// transient slips are set for all tires with transient slips, while reactions
+// and the intermediate coefficients are only set for tires in contact.
+// Only the coefficients used later by the tire (transient slip, output) are
+// copied back.
+// -----------------------------------------------------------------------------
+template <typename Real>
+void ChPacejkaTireBatch::unpack_lanes(const ChPacejkaBatchLanesT<Real>& lanes)
+{
+  const Real* uv_mask = lanes.Lane(Lanes::L_UV_MASK);
+  const Real* kappaP = lanes.Lane(Lanes::L_KAPPAP);
+  const Real* alphaP = lanes.Lane(Lanes::L_ALPHAP);
+  const Real* gammaP = lanes.Lane(Lanes::L_GAMMAP);
+  const Real* phiP = lanes.Lane(Lanes::L_PHIP);
+  const Real* phiT = lanes.Lane(Lanes::L_PHIT);
+  const Real* u_Bessel = lanes.Lane(Lanes::L_U_BESSEL);
+  const Real* u_sigma = lanes.Lane(Lanes::L_U_SIGMA);
+  const Real* v_Bessel = lanes.Lane(Lanes::L_V_BESSEL);
+  const Real* v_sigma = lanes.Lane(Lanes::L_V_SIGMA);
+  const Real* Fx_pure = lanes.Lane(Lanes::L_FX_PURE);
+  const Real* Fy_pure = lanes.Lane(Lanes::L_FY_PURE);
+  const Real* Mz_pure = lanes.Lane(Lanes::L_MZ_PURE);
+  const Real* Fx_combined = lanes.Lane(Lanes::L_FX_COMBINED);
+  const Real* Fy_combined = lanes.Lane(Lanes::L_FY_COMBINED);
+  const Real* Mz_combined = lanes.Lane(Lanes::L_MZ_COMBINED);
+  const Real* K_x = lanes.Lane(Lanes::L_K_X);
+  const Real* mu_y = lanes.Lane(Lanes::L_MU_Y);
+  const Real* D_y = lanes.Lane(Lanes::L_D_Y);
+  const Real* K_y = lanes.Lane(Lanes::L_K_Y);
+  const Real* MP_z = lanes.Lane(Lanes::L_MP_Z);
+  const Real* M_zr_pure = lanes.Lane(Lanes::L_M_ZR_PURE);
+  const Real* s = lanes.Lane(Lanes::L_S);
+  const Real* t = lanes.Lane(Lanes::L_T);
+  const Real* alpha_r_eq = lanes.Lane(Lanes::L_ALPHA_R_EQ);
+  const Real* M_zr = lanes.Lane(Lanes::L_M_ZR);
+  const Real* M_z_x = lanes.Lane(Lanes::L_M_Z_X);
+  const Real* M_z_y = lanes.Lane(Lanes::L_M_Z_Y);
+
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    ChPacejkaTire* tire = m_tires[i].get_ptr();
+
+    // transient slips, regardless of contact
+    if (uv_mask[i] != 0) {
+      tire->m_slip->kappaP = kappaP[i];
+      tire->m_slip->alphaP = alphaP[i];
+      tire->m_slip->gammaP = gammaP[i];
+      tire->m_slip->phiP = phiP[i];
+      tire->m_slip->phiT = phiT[i];
+      bessel tmp = {u_Bessel[i], u_sigma[i], v_Bessel[i], v_sigma[i]};
+      *tire->m_bessel = tmp;
+    }
+
+    if (!tire->m_in_contact)
+      continue;
+
+    tire->m_FM_pure.force.x = Fx_pure[i];
+    tire->m_FM_pure.force.y = Fy_pure[i];
+    tire->m_FM_pure.moment.z = Mz_pure[i];
+
+    tire->m_FM_combined.force.x = Fx_combined[i];
+    tire->m_FM_combined.force.y = Fy_combined[i];
+    tire->m_FM_combined.moment.z = Mz_combined[i];
+
+    tire->m_pureLong->K_x = K_x[i];
+    tire->m_pureLat->mu_y = mu_y[i];
+    tire->m_pureLat->D_y = D_y[i];
+    tire->m_pureLat->K_y = K_y[i];
+    tire->m_pureTorque->K_y = K_y[i];
+    tire->m_pureTorque->MP_z = MP_z[i];
+    tire->m_pureTorque->M_zr = M_zr_pure[i];
+    tire->m_combinedTorque->s = s[i];
+    tire->m_combinedTorque->t = t[i];
+    tire->m_combinedTorque->alpha_r_eq = alpha_r_eq[i];
+    tire->m_combinedTorque->M_zr = M_zr[i];
+    tire->m_combinedTorque->M_z_x = M_z_x[i];
+    tire->m_combinedTorque->M_z_y = M_z_y[i];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Inverse slip problems, on the host, in double precision. The lateral forces
+// of the lanes are reported with the tire side applied (see Evaluate()).
+// -----------------------------------------------------------------------------
+int ChPacejkaTireBatch::SolveSlips(int           lane,
+                                   SlipDirection dir,
+                                   int           n,
+                                   const double* force,
+                                   const double* Fz,
+                                   const double* gamma,
+                                   double*       slip,
+                                   double*       stiffness,
+                                   int*          status)
+{
+  if (lane < 0 || lane >= (int)m_tires.size()) {
+    GetLog() << " ERROR: invalid tire batch lane " << lane << "\n";
+    return 0;
+  }
+
+  Lanes lanes = get_lanes();
+  bool lateral = (dir == LATERAL);
+  double side = lateral ? m_tires[lane]->m_sameSide : 1;
+
+  int num_solved = 0;
+  double u = 0;
+  for (int k = 0; k < n; k++) {
+    double dFdslip;
+    int num_iter;
+    int result = lanes.InverseSlip(lane, lateral, side * force[k], Fz[k], gamma[k], m_slip_tol, m_slip_max_iter,
+                                   u, slip[k], dFdslip, num_iter);
+    if (stiffness)
+      stiffness[k] = side * dFdslip;
+    if (status)
+      status[k] = result;
+
+    if (result == Lanes::SLIP_CONVERGED)
+      num_solved++;
+    else if (result == Lanes::SLIP_FAILED)
+      u = 0;
+    m_num_slip_iterations += num_iter;
+  }
+  m_num_slip_problems += n;
+
+  return num_solved;
+}
+
+
+}  // end namespace chrono
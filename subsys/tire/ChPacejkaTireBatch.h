@@ -0,0 +1,251 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Batched evaluation of the Pacejka 2002 Magic Formula for a collection of
+// ChPacejkaTire objects.
+//
+// The slip, load and parameter data of all tires in the batch are packed into
+// structure-of-arrays buffers (one contiguous array per quantity, one entry per
+// tire "lane").  The transient slips of the tires (including the Besselink low
+// speed damping) and the pure and combined slip reactions are then evaluated in
+// branch-free loops over all lanes.  The loop is written such that it can
+// be vectorized by the compiler (see the ENABLE_PACEJKA_SIMD option); without
+// vector instructions it reduces to the scalar fallback.
+//
+// Each ChPacejkaTire in the batch keeps its complete API.  After a call to
+// ChPacejkaTireBatch::Advance(), the reactions of each lane are copied back to
+// the corresponding tire.
+//
+// If the library was built with ENABLE_TIRE_CUDA, the lane kernels can instead
+// be evaluated on a CUDA device (see EnableDevice() and ChPacejkaBatchDevice).
+// Advance() is then split in BeginAdvance(), which packs the lanes and queues
+// their evaluation, and EndAdvance(), which waits for the reactions, so that
+// the caller can overlap the transfers and the kernel with other work (e.g.
+// the multibody step, see ChFleetSimulation).
+//
+// Optionally, the host lane kernels are evaluated in single precision (see
+// SetSinglePrecision()), which halves the memory traffic of the lane loops and
+// doubles the width of their vector instructions. The tire state and the
+// reactions exchanged with the vehicle remain in double precision: the inputs
+// are rounded when the lanes are packed and the results are widened when they
+// are copied back to the tires.
+//
+// The batch also solves the inverse problem, for tire studies and controller
+// work: the pure slips that produce target forces at given loads and cambers
+// (see SolveSlips()), with the parameters of one of its lanes.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKATIRE_BATCH_H
+#define CH_PACEJKATIRE_BATCH_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChPacejkaBatchKernels.h"
+
+namespace chrono {
+
+class ChPacejkaBatchDevice;
+
+///
+/// Batched Pacejka tire evaluator.
+/// Tires are added to the batch after they have been initialized. At each
+/// step, the user calls Update() on each individual tire (as usual) and then
+/// a single Advance() on the batch, instead of Advance() on each tire.
+///
+class CH_SUBSYS_API ChPacejkaTireBatch : public ChShared
+{
+public:
+
+  /// Direction of the inverse slip problems (see SolveSlips()).
+  enum SlipDirection {
+    LONGITUDINAL,   ///< longitudinal slip producing the target Fx, at zero slip angle
+    LATERAL         ///< slip angle producing the target Fy, at zero longitudinal slip
+  };
+
+  ChPacejkaTireBatch();
+  ~ChPacejkaTireBatch();
+
+  /// Add an (initialized) Pacejka tire to this batch.
+  /// Returns the lane index of the tire in the batch, or -1 if the tire
+  /// parameters were not loaded.
+  int AddTire(ChSharedPtr<ChPacejkaTire> tire);
+
+  /// Pack the Magic Formula parameters of the specified (initialized) tire in
+  /// lane parameter order, i.e. into ChPacejkaBatchLanes::NUM_PARAMS values
+  /// indexed by ChPacejkaBatchLanes::ParamSlot.
+  static void PackParameters(const ChPacejkaTire& tire, double* values);
+
+  /// Get the number of tires (lanes) in this batch.
+  int GetNumTires() const { return (int)m_tires.size(); }
+
+  /// Get the tire associated with the specified lane.
+  ChSharedPtr<ChPacejkaTire> GetTire(int lane) const { return m_tires[lane]; }
+
+  /// Advance the state of all tires in the batch by the specified time step.
+  /// The slip quantities of each tire are advanced individually, then the
+  /// Magic Formula reactions are evaluated for all tires at once.
+  void Advance(double step);
+
+  /// Start advancing all tires in the batch: advance the slip quantities of
+  /// each tire and evaluate (on the host) or queue the evaluation of (on the
+  /// device) the Magic Formula reactions. Must be followed by EndAdvance()
+  /// before the tires are used again. Advance() is BeginAdvance() followed by
+  /// EndAdvance().
+  void BeginAdvance(double step);
+
+  /// Complete the step started by BeginAdvance(): wait for the device
+  /// evaluation (if any) and copy the reactions back to the tires.
+  void EndAdvance();
+
+  /// Evaluate the Magic Formula on the specified CUDA device.
+  /// Returns false, and keeps the host evaluation, if the library was built
+  /// without ENABLE_TIRE_CUDA or the device cannot be used.
+  bool EnableDevice(int device = 0);
+
+  /// Go back to evaluating the Magic Formula on the host.
+  void DisableDevice();
+
+  /// Return true if the Magic Formula is evaluated on a CUDA device.
+  bool IsDeviceEnabled() const { return m_device != 0; }
+
+  /// Evaluate the lane kernels in single precision (default: false).
+  /// Only used for the host evaluation; the device evaluation is always in
+  /// double precision.
+  void SetSinglePrecision(bool val) { m_single = val; }
+
+  /// Return true if the host lane kernels are evaluated in single precision.
+  bool IsSinglePrecision() const { return m_single; }
+
+  /// Return true if the last evaluation used the approximated transcendental
+  /// functions. This is the case only if all tires in the batch have fast math
+  /// enabled (see ChPacejkaTire::SetFastMath).
+  bool IsFastMath() const { return m_fast_math; }
+
+  /// Solve a batch of inverse pure slip problems with the Magic Formula
+  /// parameters of the tire in the specified lane: for each problem k, find
+  /// the slip for which the pure slip force in the specified direction, at the
+  /// load Fz[k] and the camber gamma[k], equals force[k] (in the tire frame,
+  /// as reported by the tire, at nominal friction). Each problem is warm
+  /// started from the solution of the previous one, so that sweeps (e.g. of
+  /// the target force or of the load) converge in a few Newton iterations.
+  /// Targets beyond the peak force get the peak slip. The slips can be passed
+  /// to ChPacejkaTire::getState_from_KAG() to build the wheel states. Returns
+  /// the number of problems solved to the tolerance.
+  int SolveSlips(
+    int            lane,             ///< [in] lane of the tire
+    SlipDirection  dir,              ///< [in] direction of the slips and forces
+    int            n,                ///< [in] number of problems
+    const double*  force,            ///< [in] target forces (Fx or Fy)
+    const double*  Fz,               ///< [in] vertical loads
+    const double*  gamma,            ///< [in] camber angles
+    double*        slip,             ///< [out] slips (kappa or alpha)
+    double*        stiffness = 0,    ///< [out] derivatives of the forces with respect to the slips (optional)
+    int*           status = 0        ///< [out] ChPacejkaBatchLanes::SlipStatus of each problem (optional)
+    );
+
+  /// Set the relative tolerance and the maximum number of Newton iterations
+  /// of the inverse slip problems (default: 1e-12 and 50).
+  void SetSlipSolverTolerance(double tol, int max_iter) { m_slip_tol = tol; m_slip_max_iter = max_iter; }
+
+  /// Get the average number of Newton iterations per inverse slip problem.
+  double get_average_slip_iterations() const { return m_num_slip_iterations / (double)m_num_slip_problems; }
+
+  /// Get the average time per call spent in the batched Magic Formula kernel.
+  /// With device evaluation, this is the host time spent packing the lanes,
+  /// waiting for the device and unpacking the lanes.
+  double get_average_kernel_time() const { return m_sum_kernel_time / (double)m_num_kernel_calls; }
+
+private:
+
+  typedef ChPacejkaBatchLanes Lanes;
+  typedef ChPacejkaBatchLanesF LanesF;
+
+  ChPacejkaTireBatch(const ChPacejkaTireBatch&);
+  ChPacejkaTireBatch& operator=(const ChPacejkaTireBatch&);
+
+  // (re)allocate the parameter and lane arrays for the specified number of
+  // tires, keeping the parameters of the current tires
+  void reserve(int capacity);
+
+  // allocate the host lane data (page-locked if a device is used)
+  void alloc_lanes();
+  void free_lanes();
+
+  // lane data of this batch, on the host, in double and single precision
+  Lanes get_lanes() const;
+  LanesF get_lanes_f() const;
+
+  // return true if the host lanes are evaluated in single precision
+  bool use_single() const { return m_single && !m_device; }
+
+  // copy the current slip and load state of each tire into the lane buffers
+  void pack();
+  template <typename Real> void pack_lanes(const ChPacejkaBatchLanesT<Real>& lanes);
+
+  // evaluate the transient slips from the slip deflections, with the Besselink
+  // low speed damping, for the lanes of tires with transient slips
+  void blend_slips();
+  template <typename Real> void blend_lanes(const ChPacejkaBatchLanesT<Real>& lanes);
+
+  // evaluate the pure and combined slip Magic Formula for all lanes, with the
+  // exact or the approximated transcendental functions
+  void evaluate();
+  template <class MATH, typename Real> void evaluate_lanes(const ChPacejkaBatchLanesT<Real>& lanes);
+
+  // copy the lane results back into each tire
+  void unpack();
+  template <typename Real> void unpack_lanes(const ChPacejkaBatchLanesT<Real>& lanes);
+
+  std::vector<ChSharedPtr<ChPacejkaTire> > m_tires;
+
+  // lane data (see ChPacejkaBatchLanes): parameters and per-step data, one
+  // array of m_stride values per slot
+  std::vector<double> m_par;
+  double*             m_lanes;
+  int                 m_stride;
+  int                 m_capacity;
+
+  // single precision copies of the parameters and lane data (host only)
+  std::vector<float>  m_par_f;
+  std::vector<float>  m_lanes_f;
+  bool                m_single;
+
+  ChPacejkaBatchDevice* m_device;
+  bool                  m_params_changed;   // parameters not yet copied to the device
+  bool                  m_advancing;        // between BeginAdvance() and EndAdvance()
+  double                m_step;
+
+  bool m_fast_math;
+
+  int m_num_kernel_calls;
+  double m_sum_kernel_time;
+  double m_kernel_time;
+
+  double m_slip_tol;
+  int m_slip_max_iter;
+  int m_num_slip_problems;
+  int m_num_slip_iterations;
+};
+
+
+} // end namespace chrono
+
+
+#endif
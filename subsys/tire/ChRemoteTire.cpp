@@ -0,0 +1,210 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Proxy tires for a tire model running in an external process.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChRemoteTire.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRemoteTireLink::ChRemoteTireLink(int num_wheels)
+: m_num_wheels(num_wheels),
+  m_forces(num_wheels),
+  m_request(0),
+  m_num_set(0),
+  m_sent(false),
+  m_sent_time(0),
+  m_num_steps(0)
+{
+  for (int i = 0; i < num_wheels; i++) {
+    m_forces[i].force = ChVector<>(0, 0, 0);
+    m_forces[i].point = ChVector<>(0, 0, 0);
+    m_forces[i].moment = ChVector<>(0, 0, 0);
+  }
+}
+
+ChRemoteTireLink::~ChRemoteTireLink()
+{
+  Disconnect();
+}
+
+bool ChRemoteTireLink::Connect(const std::string& channel_name)
+{
+  Disconnect();
+
+  if (!m_channel.Open(channel_name))
+    return false;
+
+  size_t size = std::max(GetStepSize(m_num_wheels), GetForcesSize(m_num_wheels));
+  if (m_channel.GetMaxSize() < size) {
+    GetLog() << "ERROR: tire channel " << channel_name.c_str() << " holds " << (int)m_channel.GetMaxSize()
+             << " values per message (" << (int)size << " needed)\n";
+    m_channel.Close();
+    return false;
+  }
+
+  return true;
+}
+
+void ChRemoteTireLink::Disconnect()
+{
+  if (!m_channel.IsOpen())
+    return;
+
+  if (m_sent)
+    Receive();
+  if (!m_request)
+    m_request = m_channel.BeginSend();
+  if (m_request)
+    m_channel.EndSend(TIRE_STOP, 0);
+
+  m_request = 0;
+  m_num_set = 0;
+  m_channel.Close();
+}
+
+// -----------------------------------------------------------------------------
+// The wheel states are written directly in the request slot, taken when the
+// first wheel of a step is set.
+// -----------------------------------------------------------------------------
+void ChRemoteTireLink::SetWheelState(int wheel, double time, const ChWheelState& state)
+{
+  vehicle::ChScopedLock lock(m_mutex);
+
+  if (!m_channel.IsOpen())
+    return;
+
+  if (m_sent)
+    Receive();
+
+  if (!m_request) {
+    m_request = m_channel.BeginSend();
+    if (!m_request) {
+      GetLog() << "ERROR: tire server does not accept requests\n";
+      return;
+    }
+    m_num_set = 0;
+  }
+
+  m_request[0] = time;
+  m_request[1] = (double)m_num_wheels;
+
+  double* vals = m_request + 2 + (size_t)wheel * vehicle::ChVehicleState::WHEEL_STATE_SIZE;
+  vals[0] = state.pos.x;     vals[1] = state.pos.y;     vals[2] = state.pos.z;
+  vals[3] = state.rot.e0;    vals[4] = state.rot.e1;    vals[5] = state.rot.e2;    vals[6] = state.rot.e3;
+  vals[7] = state.lin_vel.x; vals[8] = state.lin_vel.y; vals[9] = state.lin_vel.z;
+  vals[10] = state.ang_vel.x; vals[11] = state.ang_vel.y; vals[12] = state.ang_vel.z;
+  vals[13] = state.omega;
+
+  if (++m_num_set == m_num_wheels)
+    Send();
+}
+
+bool ChRemoteTireLink::Send()
+{
+  if (!m_request)
+    return false;
+
+  m_sent_time = m_request[0];
+  m_channel.EndSend(TIRE_STEP, GetStepSize(m_num_wheels));
+  m_request = 0;
+  m_num_set = 0;
+  m_sent = true;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRemoteTireLink::Complete()
+{
+  vehicle::ChScopedLock lock(m_mutex);
+
+  if (m_sent || Send())
+    Receive();
+}
+
+void ChRemoteTireLink::Receive()
+{
+  CH_PROFILE_SCOPE("ChRemoteTireLink::Wait");
+
+  m_sent = false;
+
+  int type;
+  size_t size;
+  const double* reply;
+  for (;;) {
+    if (!m_channel.Receive(type, size, reply)) {
+      GetLog() << "ERROR: no reply from the tire server\n";
+      return;
+    }
+    if (type != TIRE_FORCES || size != GetForcesSize(m_num_wheels) || (int)reply[1] != m_num_wheels) {
+      GetLog() << "ERROR: unexpected reply from the tire server\n";
+      m_channel.EndReceive();
+      return;
+    }
+    if (reply[0] == m_sent_time)
+      break;
+
+    // Late reply to a request that timed out
+    m_channel.EndReceive();
+  }
+
+  for (int i = 0; i < m_num_wheels; i++) {
+    const double* vals = reply + 2 + (size_t)i * vehicle::ChVehicleState::TIRE_FORCE_SIZE;
+    m_forces[i].force = ChVector<>(vals[0], vals[1], vals[2]);
+    m_forces[i].point = ChVector<>(vals[3], vals[4], vals[5]);
+    m_forces[i].moment = ChVector<>(vals[6], vals[7], vals[8]);
+  }
+  m_num_steps++;
+
+  m_channel.EndReceive();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChRemoteTire::ChRemoteTire(const std::string&            name,
+                           const ChTerrain&              terrain,
+                           ChSharedPtr<ChRemoteTireLink> link,
+                           const ChWheelID&              wheel_id)
+: ChTire(name, terrain),
+  m_link(link),
+  m_wheel(wheel_id.id())
+{
+}
+
+void ChRemoteTire::Update(double time, const ChWheelState& wheel_state)
+{
+  m_link->SetWheelState(m_wheel, time, wheel_state);
+}
+
+void ChRemoteTire::Advance(double step)
+{
+  m_link->Complete();
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,170 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Proxy tires for a tire model running in an external process (tire server),
+// connected through a shared-memory channel (see ChShmChannel).
+//
+// The proxies of all wheels of a vehicle share a ChRemoteTireLink, which
+// exchanges one batch per step: each proxy writes its wheel state, in place,
+// in the request message; once all wheels were updated, the request is sent,
+// so that the server computes the tire forces while the powertrain and the
+// vehicle are updated. The first proxy advanced then waits for the reply, and
+// all proxies return the forces from it.
+//
+// Messages (arrays of doubles):
+//   TIRE_STEP    client to server   time, number of wheels n, n wheel states
+//                                   (pos, rot, lin_vel, ang_vel, omega: 14
+//                                   values each)
+//   TIRE_FORCES  server to client   time of the request, number of wheels n,
+//                                   n tire forces (force, point, moment: 9
+//                                   values each)
+//   TIRE_STOP    client to server   (empty) the client disconnects
+// The step is not known when the request is sent, so the server first
+// advances its tire states from the time of the previous request to the
+// given time (with the previous wheel states), then calculates the forces
+// from the new wheel states. This is the sequence of ChTire::Advance() and
+// ChTire::Update() of an in-process tire, deferred by one exchange.
+//
+// If the server does not reply within the channel timeout, an error is
+// reported and the proxies keep the previous forces; a late reply is
+// recognized from its time, and dropped, at the next exchange.
+//
+// =============================================================================
+
+#ifndef CH_REMOTE_TIRE_H
+#define CH_REMOTE_TIRE_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChShmChannel.h"
+#include "subsys/ChVehicleThreads.h"
+
+
+namespace chrono {
+
+///
+/// Connection of the proxy tires of a vehicle to a tire server.
+///
+class CH_SUBSYS_API ChRemoteTireLink : public ChShared
+{
+public:
+
+  /// Message types.
+  enum MessageType {
+    TIRE_STEP = 1,
+    TIRE_FORCES = 2,
+    TIRE_STOP = 3
+  };
+
+  ChRemoteTireLink(
+    int num_wheels   ///< [in] number of wheels (proxies) of the vehicle
+    );
+
+  /// Disconnect from the server (if connected).
+  ~ChRemoteTireLink();
+
+  /// Connect to the tire server that created the named channel.
+  /// Returns false if the channel cannot be opened or is too small for the
+  /// messages of all wheels.
+  bool Connect(const std::string& channel_name);
+
+  /// Notify the server and disconnect.
+  void Disconnect();
+
+  /// Return true if connected to a server.
+  bool IsConnected() const { return m_channel.IsOpen(); }
+
+  /// Get the channel (e.g. to set its timeout).
+  vehicle::ChShmChannel& GetChannel() { return m_channel; }
+
+  /// Get the size of the TIRE_STEP and TIRE_FORCES messages, in doubles.
+  static size_t GetStepSize(int num_wheels) { return 2 + (size_t)num_wheels * vehicle::ChVehicleState::WHEEL_STATE_SIZE; }
+  static size_t GetForcesSize(int num_wheels) { return 2 + (size_t)num_wheels * vehicle::ChVehicleState::TIRE_FORCE_SIZE; }
+
+  /// Set the state of the specified wheel in the current request; the request
+  /// is sent once all wheels were set.
+  void SetWheelState(int wheel, double time, const ChWheelState& state);
+
+  /// Complete the exchange of the current step: send the request if it was
+  /// not sent yet and wait for the tire forces. Only the first call after
+  /// the wheel states were set waits; the following calls return at once.
+  void Complete();
+
+  /// Get the force on the specified wheel, from the last reply.
+  const ChTireForce& GetTireForce(int wheel) const { return m_forces[wheel]; }
+
+  /// Get the number of steps exchanged with the server.
+  int GetNumSteps() const { return m_num_steps; }
+
+private:
+
+  bool Send();
+  void Receive();
+
+  vehicle::ChShmChannel m_channel;
+  vehicle::ChMutex      m_mutex;
+
+  int                   m_num_wheels;
+  ChTireForces          m_forces;
+
+  double*               m_request;    // request being written, in its slot
+  int                   m_num_set;    // wheel states set in the request
+  bool                  m_sent;       // request sent, reply not received
+  double                m_sent_time;  // time of the last request sent
+
+  int                   m_num_steps;
+};
+
+///
+/// Proxy of a tire simulated by a tire server.
+///
+class CH_SUBSYS_API ChRemoteTire : public ChTire
+{
+public:
+
+  ChRemoteTire(
+    const std::string&            name,     ///< [in] name of this tire
+    const ChTerrain&              terrain,  ///< [in] terrain (not used by the proxy)
+    ChSharedPtr<ChRemoteTireLink> link,     ///< [in] connection shared by the proxies of the vehicle
+    const ChWheelID&              wheel_id  ///< [in] wheel of this tire
+    );
+
+  ~ChRemoteTire() {}
+
+  /// Set the wheel state of this tire in the request of the link.
+  virtual void Update(double time, const ChWheelState& wheel_state);
+
+  /// Complete the exchange of the current step.
+  virtual void Advance(double step);
+
+  /// Get the tire force from the last reply of the server.
+  virtual ChTireForce GetTireForce() const { return m_link->GetTireForce(m_wheel); }
+
+  /// The proxies only copy their wheel state and share one exchange, so
+  /// they are not worth updating concurrently.
+  virtual double GetUpdateCost() const { return 0; }
+
+private:
+
+  ChSharedPtr<ChRemoteTireLink> m_link;
+  int                           m_wheel;
+};
+
+
+} // end namespace chrono
+
+
+#endif
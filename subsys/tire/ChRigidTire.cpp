@@ -17,7 +17,11 @@
 // =============================================================================
 
 
+#include <cmath>
+
 #include "ChRigidTire.h"
+#include "subsys/ChShapeCache.h"
+#include "subsys/terrain/RigidTerrain.h"
 
 
 namespace chrono {
@@ -27,28 +31,160 @@ namespace chrono {
 // -----------------------------------------------------------------------------
 ChRigidTire::ChRigidTire(const std::string& name,
                          const ChTerrain&   terrain)
-: ChTire(name, terrain)
+: ChTire(name, terrain),
+  m_hf_contact(false),
+  m_collide(true),
+  m_hf_stiffness(0),
+  m_hf_damping(0),
+  m_num_discs(0)
 {
+  m_tireForce.force = ChVector<>(0, 0, 0);
+  m_tireForce.point = ChVector<>(0, 0, 0);
+  m_tireForce.moment = ChVector<>(0, 0, 0);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRigidTire::SetHeightfieldContact(double stiffness,
+                                        double damping,
+                                        int    num_discs)
+{
+  m_hf_contact = true;
+  m_collide = true;
+  m_hf_stiffness = stiffness;
+  m_hf_damping = damping;
+  m_num_discs = (num_discs > 1) ? num_discs : 1;
+
+  m_center.resize(m_num_discs);
+  m_in_contact.resize(m_num_discs);
+  m_frame.resize(m_num_discs);
+  m_depth.resize(m_num_discs);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRigidTire::SetAnalyticContact(double stiffness,
+                                     double damping,
+                                     int    num_discs)
+{
+  SetHeightfieldContact(stiffness, damping, num_discs);
+  m_collide = false;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChRigidTire::SetContactParameters(double stiffness,
+                                       double damping,
+                                       int    num_discs)
+{
+  if (!m_hf_contact || ((num_discs > 1) ? num_discs : 1) != m_num_discs)
+    return false;
+
+  m_hf_stiffness = stiffness;
+  m_hf_damping = damping;
+
+  return true;
+}
+
+void ChRigidTire::UpdateFriction()
+{
+  if (m_collide)
+    m_wheel->GetMaterialSurface()->SetFriction(getFrictionCoefficient());
 }
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChRigidTire::Initialize(ChSharedBodyPtr wheel)
 {
+  m_wheel = wheel;
+
+  if (!m_collide) {
+    wheel->SetCollide(false);
+    return;
+  }
+
   wheel->SetCollide(true);
 
-  wheel->GetCollisionModel()->ClearModel();
-  wheel->GetCollisionModel()->AddCylinder(getRadius(), getRadius(), getWidth() / 2);
-  wheel->GetCollisionModel()->BuildModel();
+  // all tires with the same dimensions share the collision shape
+  ChShapeCache::SetCylinder(wheel.get_ptr(), getRadius(), getWidth() / 2);
+
+  if (m_hf_contact)
+    wheel->GetCollisionModel()->SetFamilyMaskNoCollisionWithFamily(RigidTerrain::HEIGHTFIELD_FAMILY);
 
   wheel->GetMaterialSurface()->SetFriction(getFrictionCoefficient());
 
 }
 
+// -----------------------------------------------------------------------------
+// Height field contact. Each disc in contact generates a spring-damper normal
+// force and a friction force opposing the slip velocity at its contact point,
+// with the Coulomb law regularized below the velocity s_slip_vel. All forces
+// are reduced to the wheel center.
+// Without the height field contact, a friction map is accounted for through
+// the friction coefficient of the wheel material (which Chrono combines with
+// that of the ground by taking the minimum of the two).
+// -----------------------------------------------------------------------------
+static const double s_slip_vel = 0.1;
+
+void ChRigidTire::Update(double               time,
+                         const ChWheelState&  wheel_state)
+{
+  if (!m_hf_contact) {
+    if (m_terrain.HasFrictionMap() && !m_wheel.IsNull()) {
+      double mu = getFrictionCoefficient() * friction_scale(wheel_state.pos);
+      m_wheel->GetMaterialSurface()->SetFriction((float)mu);
+    }
+    return;
+  }
+
+  m_tireForce.force = ChVector<>(0, 0, 0);
+  m_tireForce.moment = ChVector<>(0, 0, 0);
+  m_tireForce.point = wheel_state.pos;
+
+  ChVector<> disc_normal = wheel_state.rot.GetYaxis();
+  double width = getWidth();
+
+  for (int id = 0; id < m_num_discs; id++) {
+    double offset = (m_num_discs > 1) ? width * ((double)id / (m_num_discs - 1) - 0.5) : 0;
+    m_center[id] = wheel_state.pos + offset * disc_normal;
+  }
+
+  disc_terrain_contact(m_num_discs, &m_center[0], disc_normal, getRadius(),
+                       &m_in_contact[0], &m_frame[0], &m_depth[0]);
+
+  double k = m_hf_stiffness / m_num_discs;
+  double c = m_hf_damping / m_num_discs;
+  double mu_tire = getFrictionCoefficient();
+
+  for (int id = 0; id < m_num_discs; id++) {
+    if (!m_in_contact[id])
+      continue;
+
+    const ChVector<>& pt = m_frame[id].pos;
+    double mu = mu_tire * friction_scale(pt);
+    ChVector<> normal = m_frame[id].rot.GetZaxis();
+    ChVector<> vel = wheel_state.lin_vel + Vcross(wheel_state.ang_vel, pt - wheel_state.pos);
+
+    double vn = Vdot(vel, normal);
+    double Fn = k * m_depth[id] - c * vn;
+    if (Fn <= 0)
+      continue;
+
+    ChVector<> vt = vel - vn * normal;
+    ChVector<> F = Fn * normal - (mu * Fn / std::sqrt(vt.Length2() + s_slip_vel * s_slip_vel)) * vt;
+
+    m_tireForce.force += F;
+    m_tireForce.moment += Vcross(pt - m_tireForce.point, F);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 ChTireForce ChRigidTire::GetTireForce() const
 {
+  if (m_hf_contact)
+    return m_tireForce;
+
   ChTireForce tire_force;
 
   tire_force.force = ChVector<>(0, 0, 0);
@@ -58,5 +194,18 @@ ChTireForce ChRigidTire::GetTireForce() const
   return tire_force;
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRigidTire::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  typedef vehicle::ChMemoryReport R;
+
+  report.Add("tire/objects", sizeof(ChRigidTire));
+  report.Add("tire/contact buffers", R::VectorBytes(m_center) + R::VectorBytes(m_in_contact) + R::VectorBytes(m_frame) +
+                                     R::VectorBytes(m_depth));
+
+  ChTire::AddMemoryFootprint(report);
+}
+
 
 } // end namespace chrono
@@ -19,6 +19,8 @@
 #ifndef CH_RIGIDTIRE_H
 #define CH_RIGIDTIRE_H
 
+#include <vector>
+
 #include "physics/ChBody.h"
 
 #include "subsys/ChTire.h"
@@ -30,6 +32,12 @@ namespace chrono {
 /// Rigid tire model.
 /// This tire is modeled as a rigid cylinder.  Requires a terrain system that
 /// supports rigid contact with friction.
+/// Alternatively, the contact with a height field terrain (e.g. a RigidTerrain
+/// in height field mode) is evaluated by the tire itself, with the cylinder
+/// represented by a set of parallel discs and penalty normal forces with
+/// regularized Coulomb friction (see SetHeightfieldContact()). The same contact
+/// model may also replace the collision shape entirely (see
+/// SetAnalyticContact()), for terrains without obstacles.
 ///
 class CH_SUBSYS_API ChRigidTire : public ChTire
 {
@@ -44,17 +52,73 @@ public:
 
   /// Get the tire force and moment.
   /// For a rigid tire, the tire forces are automatically applied to the
-  /// associated wheel (through Chrono's frictional contact system). The values
-  /// returned here are never used.
+  /// associated wheel (through Chrono's frictional contact system) and the
+  /// returned force is zero, unless the height field contact is enabled.
   virtual ChTireForce GetTireForce() const;
 
+  /// Enable the contact with the terrain height field (disabled by default).
+  /// The cylinder is represented by the specified number of discs across its
+  /// width; the given stiffness and damping are those of the whole tire. Must
+  /// be called before Initialize(). The collision shape of the wheel then
+  /// excludes the collision family RigidTerrain::HEIGHTFIELD_FAMILY, so that
+  /// it only collides with the moving obstacles.
+  void SetHeightfieldContact(
+    double stiffness,      ///< [in] normal contact stiffness
+    double damping,        ///< [in] normal contact damping
+    int    num_discs = 5   ///< [in] number of discs across the tire width
+    );
+
+  /// Evaluate the contact with the terrain analytically, for any terrain type,
+  /// with the same model as the height field contact (see
+  /// SetHeightfieldContact()). No collision shape is created and collision is
+  /// disabled for the wheel body, which therefore does not interact with
+  /// Chrono's collision system at all (and in particular with moving
+  /// obstacles). Must be called before Initialize().
+  void SetAnalyticContact(
+    double stiffness,      ///< [in] normal contact stiffness
+    double damping,        ///< [in] normal contact damping
+    int    num_discs = 5   ///< [in] number of discs across the tire width
+    );
+
+  /// Change the stiffness and damping of the height field (or analytic)
+  /// contact, keeping the state of the tire (e.g. while tuning the tire).
+  /// Returns false, with no change, if that contact is not enabled or has a
+  /// different number of discs.
+  bool SetContactParameters(
+    double stiffness,      ///< [in] normal contact stiffness
+    double damping,        ///< [in] normal contact damping
+    int    num_discs       ///< [in] number of discs across the tire width
+    );
+
+  /// Apply the current friction coefficient (see getFrictionCoefficient()) to
+  /// the wheel material. Must be called after Initialize().
+  void UpdateFriction();
+
   /// Initialize this tire system.
   /// This function creates the tire contact shape and attaches it to the 
-  /// associated wheel body.
+  /// associated wheel body (unless the analytic contact is enabled).
   void Initialize(
     ChSharedBodyPtr wheel  ///< handle to the associated wheel body
     );
 
+  /// Update the state of this tire system at the current time.
+  /// With the height field contact enabled, this calculates the tire force,
+  /// with the friction coefficient of each disc scaled by the terrain friction
+  /// at its contact point. Otherwise, if the terrain has a friction map, this
+  /// sets the friction coefficient of the wheel material from the terrain
+  /// friction below the wheel center.
+  virtual void Update(
+    double               time,          ///< [in] current time
+    const ChWheelState&  wheel_state    ///< [in] current state of associated wheel body
+    );
+
+  /// Return the relative cost of one update.
+  virtual double GetUpdateCost() const { return m_hf_contact ? m_num_discs : 1; }
+
+  /// Add the tire object and its disc contact buffers to the specified
+  /// report. The collision shape, if any, belongs to the wheel body.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
 protected:
 
   /// Return the coefficient of friction for the tire material.
@@ -65,6 +129,23 @@ protected:
 
   /// Return the tire width.
   virtual double getWidth() const = 0;
+
+private:
+
+  ChSharedBodyPtr           m_wheel;
+
+  bool                      m_hf_contact;     // contact evaluated by the tire
+  bool                      m_collide;        // wheel has a collision shape
+  double                    m_hf_stiffness;
+  double                    m_hf_damping;
+  int                       m_num_discs;
+
+  ChTireForce               m_tireForce;
+
+  std::vector<ChVector<> >  m_center;
+  std::vector<char>         m_in_contact;
+  std::vector<ChCoordsys<> > m_frame;
+  std::vector<double>       m_depth;
 };
 
 
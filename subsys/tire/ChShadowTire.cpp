@@ -0,0 +1,409 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tire validating a cheap tire model online against a reference tire model.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChShadowTire.h"
+#include "subsys/ChSimulationContext.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChShadowTire::ChShadowTire(const std::string&  name,
+                           ChSharedPtr<ChTire> model,
+                           ChSharedPtr<ChTire> reference,
+                           const ChTerrain&    terrain)
+: ChTire(name, terrain),
+  m_model(model),
+  m_reference(reference),
+  m_period(10),
+  m_phase(0),
+  m_num_steps(0),
+  m_sampled(false),
+  m_pool(0),
+  m_task(this),
+  m_pending(false),
+  m_done(true),
+  m_time(0),
+  m_step(0),
+  m_min_load(10),
+  m_fallback_bound(0),
+  m_fallback_samples(3),
+  m_num_exceeded(0),
+  m_fallback(false)
+{
+  std::vector<double> alpha_edges;
+  alpha_edges.push_back(0.02);
+  alpha_edges.push_back(0.05);
+  alpha_edges.push_back(0.1);
+
+  std::vector<double> util_edges;
+  util_edges.push_back(0.3);
+  util_edges.push_back(0.6);
+  util_edges.push_back(0.9);
+
+  SetRegions(alpha_edges, util_edges);
+}
+
+ChShadowTire::~ChShadowTire()
+{
+  wait_reference();
+}
+
+void ChShadowTire::SetSamplePeriod(int period, int phase)
+{
+  m_period = std::max(period, 1);
+  m_phase = std::max(phase, 0);
+}
+
+void ChShadowTire::SetRegions(const std::vector<double>& slip_angle_edges,
+                              const std::vector<double>& utilization_edges)
+{
+  m_alpha_edges = slip_angle_edges;
+  m_util_edges = utilization_edges;
+  std::sort(m_alpha_edges.begin(), m_alpha_edges.end());
+  std::sort(m_util_edges.begin(), m_util_edges.end());
+
+  m_regions.resize((m_alpha_edges.size() + 1) * (m_util_edges.size() + 1));
+  ResetErrors();
+}
+
+void ChShadowTire::SetFallback(double bound, int num_samples)
+{
+  m_fallback_bound = bound;
+  m_fallback_samples = std::max(num_samples, 1);
+  m_num_exceeded = 0;
+}
+
+void ChShadowTire::ResetFallback()
+{
+  m_fallback = false;
+  m_num_exceeded = 0;
+}
+
+// -----------------------------------------------------------------------------
+// The reference model is only evaluated on sampled steps of the cheap model.
+// With a thread pool, the sample is collected at the next update, before
+// either model is touched again.
+// -----------------------------------------------------------------------------
+void ChShadowTire::Update(double time, const ChWheelState& wheel_state)
+{
+  if (m_pending) {
+    wait_reference();
+    m_pending = false;
+    record();
+  }
+
+  if (m_fallback) {
+    m_sampled = false;
+    m_reference->Update(time, wheel_state);
+    return;
+  }
+
+  m_sampled = m_num_steps >= m_phase && (m_num_steps - m_phase) % m_period == 0;
+  m_model->Update(time, wheel_state);
+  if (m_sampled) {
+    m_time = time;
+    m_wheel_state = wheel_state;
+  }
+}
+
+void ChShadowTire::Advance(double step)
+{
+  m_num_steps++;
+
+  if (m_fallback) {
+    m_reference->Advance(step);
+    return;
+  }
+
+  m_model->Advance(step);
+  if (!m_sampled)
+    return;
+
+  m_sampled = false;
+  m_step = step;
+  m_model_force = m_model->GetTireForce();
+
+  if (m_pool) {
+    m_done = false;
+    m_pending = true;
+    m_pool->Submit(&m_task);
+    return;
+  }
+
+  run_reference();
+  record();
+}
+
+ChTireForce ChShadowTire::GetTireForce() const
+{
+  return m_fallback ? m_reference->GetTireForce() : m_model->GetTireForce();
+}
+
+bool ChShadowTire::GetForceJacobian(ChTireForceJacobian& jacobian) const
+{
+  return m_fallback ? m_reference->GetForceJacobian(jacobian) : m_model->GetForceJacobian(jacobian);
+}
+
+double ChShadowTire::GetUpdateCost() const
+{
+  if (m_fallback)
+    return m_reference->GetUpdateCost();
+  double cost = m_model->GetUpdateCost();
+  if (!m_pool)
+    cost += m_reference->GetUpdateCost() / m_period;
+  return cost;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChShadowTire::ReferenceTask::Execute(int worker)
+{
+  m_tire->run_reference();
+
+  vehicle::ChScopedLock lock(m_tire->m_mutex);
+  m_tire->m_done = true;
+  m_tire->m_cond.Broadcast();
+}
+
+void ChShadowTire::run_reference()
+{
+  m_reference->Update(m_time, m_wheel_state);
+  m_reference->Advance(m_step);
+  m_reference_force = m_reference->GetTireForce();
+}
+
+void ChShadowTire::wait_reference() const
+{
+  if (!m_pending)
+    return;
+
+  vehicle::ChScopedLock lock(m_mutex);
+  while (!m_done)
+    m_cond.Wait(m_mutex);
+}
+
+// -----------------------------------------------------------------------------
+// Compare the forces of both models in the wheel frame (heading, lateral and
+// normal directions), with the moments about the normal through the wheel
+// center.
+// -----------------------------------------------------------------------------
+void ChShadowTire::record()
+{
+  const ChWheelState& ws = m_wheel_state;
+
+  ChVector<> up = m_terrain.GetNormal(ws.pos.x, ws.pos.y);
+  ChVector<> heading = Vcross(ws.rot.GetYaxis(), up);
+  if (heading.Length() < 1e-6)
+    return;
+  heading.Normalize();
+  ChVector<> lateral = Vcross(up, heading);
+
+  double Fz_ref = Vdot(m_reference_force.force, up);
+  if (Fz_ref < m_min_load)
+    return;
+
+  const ChTireForce* forces[2] = { &m_model_force, &m_reference_force };
+  double comp[2][4];
+  for (int i = 0; i < 2; i++) {
+    const ChTireForce& f = *forces[i];
+    comp[i][0] = Vdot(f.force, heading);
+    comp[i][1] = Vdot(f.force, lateral);
+    comp[i][2] = Vdot(f.force, up);
+    comp[i][3] = Vdot(f.moment + Vcross(f.point - ws.pos, f.force), up);
+  }
+
+  double err[4];
+  for (int k = 0; k < 4; k++)
+    err[k] = std::abs(comp[0][k] - comp[1][k]);
+  double relative = std::sqrt(err[0] * err[0] + err[1] * err[1]) / Fz_ref;
+
+  // Operating region of the sample.
+  double vx = Vdot(ws.lin_vel, heading);
+  double vy = Vdot(ws.lin_vel, lateral);
+  double alpha = (std::abs(vx) + std::abs(vy) > 0.1) ? std::atan2(std::abs(vy), std::abs(vx)) : 0;
+  double util = std::sqrt(comp[1][0] * comp[1][0] + comp[1][1] * comp[1][1]) / Fz_ref;
+
+  add(m_total, err, relative);
+  add(m_regions[GetRegion(alpha, util)], err, relative);
+
+  if (m_fallback_bound <= 0)
+    return;
+
+  if (relative <= m_fallback_bound) {
+    m_num_exceeded = 0;
+    return;
+  }
+
+  if (++m_num_exceeded >= m_fallback_samples) {
+    m_fallback = true;
+    vehicle::GetContextLog() << "WARNING: tire " << m_name.c_str() << " falls back to its reference model at time "
+                             << m_time << " (relative error " << relative << ")\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChShadowTire::GetRegion(double slip_angle, double utilization) const
+{
+  int ia = (int)(std::upper_bound(m_alpha_edges.begin(), m_alpha_edges.end(), std::abs(slip_angle)) -
+                 m_alpha_edges.begin());
+  int iu = (int)(std::upper_bound(m_util_edges.begin(), m_util_edges.end(), utilization) - m_util_edges.begin());
+  return ia * ((int)m_util_edges.size() + 1) + iu;
+}
+
+void ChShadowTire::ResetErrors()
+{
+  clear(m_total);
+  for (size_t k = 0; k < m_regions.size(); k++)
+    clear(m_regions[k]);
+}
+
+void ChShadowTire::clear(Accumulator& acc)
+{
+  acc.num_samples = 0;
+  for (int k = 0; k < 4; k++) {
+    acc.sum[k] = 0;
+    acc.sum_sq[k] = 0;
+    acc.max[k] = 0;
+  }
+  acc.sum_relative = 0;
+  acc.max_relative = 0;
+}
+
+void ChShadowTire::add(Accumulator& acc, const double err[4], double relative)
+{
+  acc.num_samples++;
+  for (int k = 0; k < 4; k++) {
+    acc.sum[k] += err[k];
+    acc.sum_sq[k] += err[k] * err[k];
+    acc.max[k] = std::max(acc.max[k], err[k]);
+  }
+  acc.sum_relative += relative;
+  acc.max_relative = std::max(acc.max_relative, relative);
+}
+
+ChShadowTireErrors ChShadowTire::get_errors(const Accumulator& acc)
+{
+  ChShadowTireErrors errors;
+  int n = std::max(acc.num_samples, 1);
+
+  errors.num_samples = acc.num_samples;
+  for (int k = 0; k < 4; k++) {
+    errors.mean[k] = acc.sum[k] / n;
+    errors.rms[k] = std::sqrt(acc.sum_sq[k] / n);
+    errors.max[k] = acc.max[k];
+  }
+  errors.mean_relative = acc.sum_relative / n;
+  errors.max_relative = acc.max_relative;
+
+  return errors;
+}
+
+bool ChShadowTire::WriteErrors(const std::string& filename) const
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if (!fp) {
+    GetLog() << "ERROR: cannot open " << filename.c_str() << " for writing\n";
+    return false;
+  }
+
+  fprintf(fp, "alpha_lo,alpha_hi,util_lo,util_hi,samples,mean_Fx,max_Fx,mean_Fy,max_Fy,mean_Fz,max_Fz,"
+              "mean_Mz,max_Mz,mean_relative,max_relative\n");
+
+  int num_alpha = (int)m_alpha_edges.size() + 1;
+  int num_util = (int)m_util_edges.size() + 1;
+  for (int ia = 0; ia < num_alpha; ia++) {
+    for (int iu = 0; iu < num_util; iu++) {
+      const Accumulator& acc = m_regions[ia * num_util + iu];
+      if (acc.num_samples == 0)
+        continue;
+
+      ChShadowTireErrors e = get_errors(acc);
+      double alpha_lo = (ia > 0) ? m_alpha_edges[ia - 1] : 0;
+      double util_lo = (iu > 0) ? m_util_edges[iu - 1] : 0;
+      if (ia < num_alpha - 1)
+        fprintf(fp, "%.10g,%.10g,", alpha_lo, m_alpha_edges[ia]);
+      else
+        fprintf(fp, "%.10g,,", alpha_lo);
+      if (iu < num_util - 1)
+        fprintf(fp, "%.10g,%.10g,", util_lo, m_util_edges[iu]);
+      else
+        fprintf(fp, "%.10g,,", util_lo);
+      fprintf(fp, "%d", e.num_samples);
+      for (int k = 0; k < 4; k++)
+        fprintf(fp, ",%.10g,%.10g", e.mean[k], e.max[k]);
+      fprintf(fp, ",%.10g,%.10g\n", e.mean_relative, e.max_relative);
+    }
+  }
+
+  return fclose(fp) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// A sample pending at a snapshot is discarded on restore.
+// -----------------------------------------------------------------------------
+void ChShadowTire::SaveState(vehicle::ChVehicleState& state) const
+{
+  wait_reference();
+
+  state.BeginBlock(1);
+  state.Write(m_fallback ? 1.0 : 0.0);
+
+  m_model->SaveState(state);
+  m_reference->SaveState(state);
+}
+
+bool ChShadowTire::RestoreState(vehicle::ChVehicleState& state)
+{
+  wait_reference();
+  m_pending = false;
+  m_sampled = false;
+  m_num_exceeded = 0;
+
+  if (!state.OpenBlock(1, m_name.c_str()))
+    return false;
+  m_fallback = (state.Read() != 0);
+
+  return m_model->RestoreState(state) && m_reference->RestoreState(state);
+}
+
+void ChShadowTire::AddMemoryFootprint(vehicle::ChMemoryReport& report) const
+{
+  typedef vehicle::ChMemoryReport R;
+
+  report.Add("tire/objects", sizeof(ChShadowTire));
+  report.Add("tire/shadow statistics", R::VectorBytes(m_alpha_edges) + R::VectorBytes(m_util_edges) +
+                                       R::VectorBytes(m_regions));
+
+  m_model->AddMemoryFootprint(report);
+  m_reference->AddMemoryFootprint(report);
+
+  ChTire::AddMemoryFootprint(report);
+}
+
+
+} // end namespace chrono
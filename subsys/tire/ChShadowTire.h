@@ -0,0 +1,251 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tire validating a cheap tire model (e.g. a tabulated Pacejka tire, a
+// surrogate tire or a batched single precision tire) online, against a
+// reference tire model (typically a ChPacejkaTire).
+//
+// The cheap model provides the tire forces at every step. On one step out of
+// the sampling period, the reference tire is also updated with the same wheel
+// state and advanced by the same step, either inline or as a task of a thread
+// pool, in which case the sample is collected at the next update. The
+// reference state is not advanced between samples: with a sampling period
+// above one, the reference should be a steady-state model (e.g. a Pacejka tire
+// without transient slip).
+//
+// Each sample compares the forces of both models, expressed along the heading,
+// lateral and normal directions of the wheel, and their moments about the
+// normal through the wheel center. The errors are accumulated in total and by
+// operating region: the slip angle of the wheel center velocity and the force
+// utilization (horizontal over vertical force) of the reference tire, each
+// split by a list of bin edges. Samples with a reference vertical load below
+// the minimum load (airborne wheel) are not recorded.
+//
+// Optionally, when the horizontal force error relative to the reference
+// vertical load exceeds a bound on a number of consecutive samples, the tire
+// falls back to the reference model, which then provides the forces and is
+// advanced at every step.
+//
+// =============================================================================
+
+#ifndef CH_SHADOW_TIRE_H
+#define CH_SHADOW_TIRE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChThreadPool.h"
+
+
+namespace chrono {
+
+///
+/// Errors of a cheap tire model against its reference over a set of samples.
+/// The components are the heading, lateral and normal forces and the moment
+/// about the normal.
+///
+struct ChShadowTireErrors {
+  int     num_samples;     ///< number of samples
+  double  mean[4];         ///< mean absolute errors
+  double  rms[4];          ///< RMS errors
+  double  max[4];          ///< largest absolute errors
+  double  mean_relative;   ///< mean horizontal force error, relative to the vertical load
+  double  max_relative;    ///< largest relative horizontal force error
+};
+
+///
+/// Tire running a cheap tire model, validated on sampled steps against a
+/// reference tire model.
+///
+class CH_SUBSYS_API ChShadowTire : public ChTire
+{
+public:
+
+  /// Construct a shadow tire from two initialized tires.
+  ChShadowTire(
+    const std::string&   name,       ///< [in] name of this tire
+    ChSharedPtr<ChTire>  model,      ///< [in] cheap tire model
+    ChSharedPtr<ChTire>  reference,  ///< [in] reference tire model
+    const ChTerrain&     terrain     ///< [in] reference to the terrain system
+    );
+
+  ~ChShadowTire();
+
+  /// Set the sampling period, in steps, and the step of the first sample
+  /// (default: every 10 steps, from the first one). Different phases spread
+  /// the samples of the tires of a vehicle over the steps.
+  void SetSamplePeriod(int period, int phase = 0);
+
+  /// Evaluate the reference tire as a task of the specified thread pool
+  /// (default: NULL, inline). The pool must not be the one updating the tires.
+  void SetThreadPool(vehicle::ChThreadPool* pool) { m_pool = pool; }
+
+  /// Set the bin edges of the operating regions, on the absolute slip angle
+  /// (rad) and on the force utilization of the reference tire (defaults:
+  /// 0.02, 0.05, 0.1 rad and 0.3, 0.6, 0.9). The statistics are reset.
+  void SetRegions(
+    const std::vector<double>& slip_angle_edges,   ///< [in] increasing slip angle edges
+    const std::vector<double>& utilization_edges   ///< [in] increasing utilization edges
+    );
+
+  /// Set the minimum reference vertical load of a recorded sample (default:
+  /// 10 N).
+  void SetMinLoad(double load) { m_min_load = load; }
+
+  /// Enable the fall back to the reference model when the relative horizontal
+  /// force error exceeds the bound on the specified number of consecutive
+  /// samples (default: disabled, bound 0).
+  void SetFallback(double bound, int num_samples = 3);
+
+  /// Return true if the tire fell back to the reference model.
+  bool IsFallback() const { return m_fallback; }
+
+  /// Return to the cheap model after a fall back.
+  void ResetFallback();
+
+  /// Get the cheap tire model.
+  ChSharedPtr<ChTire> GetModel() const { return m_model; }
+
+  /// Get the reference tire model.
+  ChSharedPtr<ChTire> GetReference() const { return m_reference; }
+
+  /// Update the cheap model (or, after a fall back, the reference model) and,
+  /// on a sampled step, prepare the reference sample. A sample pending on
+  /// the thread pool is collected first.
+  virtual void Update(
+    double               time,          ///< [in] current time
+    const ChWheelState&  wheel_state    ///< [in] current state of associated wheel body
+    );
+
+  /// Advance the cheap model (or the reference model) and, on a sampled step,
+  /// evaluate the reference model.
+  virtual void Advance(double step);
+
+  /// Get the tire force of the cheap model (or of the reference model).
+  virtual ChTireForce GetTireForce() const;
+
+  /// Get the linearization of the cheap model (or of the reference model).
+  virtual bool GetForceJacobian(ChTireForceJacobian& jacobian) const;
+
+  /// Return the cost of the cheap model plus, without thread pool, that of the
+  /// reference model over the sampling period.
+  virtual double GetUpdateCost() const;
+
+  /// Get the errors over all samples.
+  ChShadowTireErrors GetErrors() const { return get_errors(m_total); }
+
+  /// Get the number of operating regions.
+  int GetNumRegions() const { return (int)m_regions.size(); }
+
+  /// Get the operating region of the specified slip angle and reference force
+  /// utilization.
+  int GetRegion(double slip_angle, double utilization) const;
+
+  /// Get the errors in the specified operating region.
+  ChShadowTireErrors GetErrors(int region) const { return get_errors(m_regions[region]); }
+
+  /// Discard the statistics.
+  void ResetErrors();
+
+  /// Write the errors, one CSV row per operating region with samples (slip
+  /// angle and utilization bins, samples, mean and max of each component,
+  /// mean and max relative error). Returns false if the file cannot be written.
+  bool WriteErrors(const std::string& filename) const;
+
+  /// Append the states of both models and the fall back flag to the snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the states of both models and the fall back flag.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+  /// Add both models and the statistics to the specified report.
+  virtual void AddMemoryFootprint(vehicle::ChMemoryReport& report) const;
+
+private:
+
+  struct Accumulator {
+    int     num_samples;
+    double  sum[4];
+    double  sum_sq[4];
+    double  max[4];
+    double  sum_relative;
+    double  max_relative;
+  };
+
+  class ReferenceTask : public vehicle::ChTask {
+  public:
+    ReferenceTask(ChShadowTire* tire) : m_tire(tire) {}
+    virtual void Execute(int worker);
+  private:
+    ChShadowTire* m_tire;
+  };
+
+  ChShadowTire(const ChShadowTire&);
+  ChShadowTire& operator=(const ChShadowTire&);
+
+  // Update and advance the reference model with the sampled wheel state.
+  void run_reference();
+
+  // Record the errors of the sample, and check the fall back bound.
+  void record();
+
+  // Wait until the submitted reference task, if any, was executed.
+  void wait_reference() const;
+
+  static void clear(Accumulator& acc);
+  static void add(Accumulator& acc, const double err[4], double relative);
+  static ChShadowTireErrors get_errors(const Accumulator& acc);
+
+  ChSharedPtr<ChTire>          m_model;
+  ChSharedPtr<ChTire>          m_reference;
+
+  int                          m_period;
+  int                          m_phase;
+  int                          m_num_steps;      // steps advanced
+  bool                         m_sampled;        // the current step is sampled
+
+  vehicle::ChThreadPool*       m_pool;
+  ReferenceTask                m_task;
+  bool                         m_pending;        // task submitted, not collected
+  bool                         m_done;           // task executed (protected by m_mutex)
+  mutable vehicle::ChMutex     m_mutex;
+  mutable vehicle::ChCondition m_cond;
+
+  double                       m_time;           // sampled time and wheel state
+  ChWheelState                 m_wheel_state;
+  double                       m_step;
+  ChTireForce                  m_model_force;    // forces of both models at the sampled step
+  ChTireForce                  m_reference_force;
+
+  std::vector<double>          m_alpha_edges;
+  std::vector<double>          m_util_edges;
+  Accumulator                  m_total;
+  std::vector<Accumulator>     m_regions;
+  double                       m_min_load;
+
+  double                       m_fallback_bound;
+  int                          m_fallback_samples;
+  int                          m_num_exceeded;   // consecutive samples above the bound
+  bool                         m_fallback;
+};
+
+
+} // end namespace chrono
+
+
+#endif
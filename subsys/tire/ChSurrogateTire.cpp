@@ -0,0 +1,270 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tire evaluating a neural network surrogate of the Magic Formula.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/ChMatrix33.h"
+
+#include "subsys/tire/ChSurrogateTire.h"
+
+
+namespace chrono {
+
+
+static const size_t SURROGATE_STATE_SIZE = vehicle::ChVehicleState::WHEEL_STATE_SIZE +
+                                           vehicle::ChVehicleState::COORDSYS_SIZE +
+                                           2 * vehicle::ChVehicleState::TIRE_FORCE_SIZE + 15;
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSurrogateTire::ChSurrogateTire(const std::string& filename,
+                                 const ChTerrain&   terrain)
+: ChTire("", terrain),
+  m_model(ChSurrogateTireModel::Get(filename)),
+  m_side_sign(1),
+  m_transient(true)
+{
+  if (!m_model.IsNull()) {
+    SetName(m_model->GetName());
+    m_work.resize(m_model->GetWorkSize(1));
+  }
+  clear_reactions();
+}
+
+ChSurrogateTire::ChSurrogateTire(const std::string&                 name,
+                                 ChSharedPtr<ChSurrogateTireModel>  model,
+                                 const ChTerrain&                   terrain)
+: ChTire(name, terrain),
+  m_model(model),
+  m_side_sign(1),
+  m_transient(true)
+{
+  if (!m_model.IsNull())
+    m_work.resize(m_model->GetWorkSize(1));
+  clear_reactions();
+}
+
+void ChSurrogateTire::Initialize(ChVehicleSide side)
+{
+  if (m_model.IsNull())
+    return;
+
+  m_side_sign = ((side == RIGHT) == m_model->IsRightSide()) ? 1 : -1;
+  clear_reactions();
+}
+
+void ChSurrogateTire::clear_reactions()
+{
+  m_in_contact = false;
+  m_depth = 0;
+  m_Fz = 0;
+  m_R_eff = m_model.IsNull() ? 0 : m_model->GetRadius();
+  m_mu_scale = 1;
+  m_V_cx = m_V_sx = m_V_sy = 0;
+  m_kappa = m_alpha = m_gamma = 0;
+  m_u = m_v = 0;
+  m_kappaP = m_alphaP = 0;
+
+  m_FM.point = ChVector<>();
+  m_FM.force = ChVector<>();
+  m_FM.moment = ChVector<>();
+  m_FM_global = m_FM;
+}
+
+// -----------------------------------------------------------------------------
+// The contact frame, vertical load and kinematic slips are evaluated as in
+// ChPacejkaTire::update_W_frame(), calc_Fz() and slip_kinematic(). The contact
+// point deflections are kept while the tire is in contact.
+// -----------------------------------------------------------------------------
+void ChSurrogateTire::Update(double time, const ChWheelState& wheel_state)
+{
+  if (m_model.IsNull())
+    return;
+
+  m_state = wheel_state;
+
+  ChVector<> wheel_normal = m_state.rot.GetYaxis();
+  double R0 = m_model->GetRadius();
+
+  char in_contact;
+  ChCoordsys<> contact;
+  double depth = 0;
+  ChVector<> Z_dir;
+  disc_terrain_contact(1, &m_state.pos, wheel_normal, R0, &in_contact, &contact, &depth, &Z_dir);
+
+  if (!in_contact) {
+    clear_reactions();
+    return;
+  }
+
+  ChVector<> X_dir = Vcross(wheel_normal, Z_dir);
+  X_dir.Normalize();
+  ChVector<> Y_dir = Vcross(Z_dir, X_dir);
+  ChMatrix33<> rot;
+  rot.Set_A_axis(X_dir, Y_dir, Z_dir);
+  m_W_frame.pos = contact.pos;
+  m_W_frame.rot = rot.Get_A_quaternion();
+
+  m_in_contact = true;
+  m_depth = depth;
+  m_mu_scale = friction_scale(contact.pos);
+
+  // Vertical load.
+  ChVector<> relvel = m_state.lin_vel + Vcross(m_state.ang_vel, m_W_frame.pos - m_state.pos);
+  double vz = m_W_frame.TransformDirectionParentToLocal(relvel).z;
+  m_Fz = std::max(m_model->GetVerticalStiffness() * depth - m_model->GetVerticalDamping() * vz,
+                  m_model->GetMinimumLoad());
+  m_R_eff = m_model->GetRollingRadius(depth, m_state.omega);
+
+  // Kinematic slips.
+  ChVector<> V = m_W_frame.TransformDirectionParentToLocal(m_state.lin_vel);
+  m_V_cx = V.x;
+  m_V_sx = V.x - m_state.omega * m_R_eff;
+  m_V_sy = V.y;
+
+  double V_x_abs = std::max(std::abs(V.x), m_model->GetLowVelocity());
+  ChVector<> n = m_W_frame.TransformDirectionParentToLocal(wheel_normal);
+  m_kappa = -m_V_sx / V_x_abs;
+  m_alpha = std::atan(V.y / V_x_abs);
+  m_gamma = std::atan2(n.z, n.y);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSurrogateTire::Advance(double step)
+{
+  if (m_model.IsNull() || !m_in_contact)
+    return;
+
+  double in[ChSurrogateTireModel::NUM_INPUTS];
+  double out[ChSurrogateTireModel::NUM_OUTPUTS];
+
+  advance_slips(step);
+  get_inputs(in, 1, 0);
+  m_model->Evaluate(1, 1, in, out, &m_work[0]);
+  set_reactions(out, 1, 0);
+}
+
+// -----------------------------------------------------------------------------
+// The deflection ODEs dx/dt = a - lambda x are linear with coefficients frozen
+// over the step, so that
+//    x(t+h) = x(t) + (a - lambda x(t)) (1 - exp(-lambda h)) / lambda
+// which tends to the explicit Euler update for a small lambda h.
+// -----------------------------------------------------------------------------
+void ChSurrogateTire::advance_slips(double step)
+{
+  double sigma_kappa;
+  double sigma_alpha;
+  m_model->GetRelaxationLengths(m_Fz, sigma_kappa, sigma_alpha);
+
+  if (!m_transient) {
+    m_kappaP = m_kappa;
+    m_alphaP = m_alpha;
+    m_u = m_kappa * sigma_kappa;
+    m_v = std::tan(m_alpha) * sigma_alpha;
+    return;
+  }
+
+  double V_cx_abs = std::abs(m_V_cx);
+  double lambda[2] = { V_cx_abs / sigma_kappa, V_cx_abs / sigma_alpha };
+  double a[2] = { -m_V_sx, -m_V_sy };
+  double* x[2] = { &m_u, &m_v };
+
+  for (int i = 0; i < 2; i++) {
+    double lh = lambda[i] * step;
+    double factor = (lh < 1e-6) ? step * (1 - 0.5 * lh) : (1 - std::exp(-lh)) / lambda[i];
+    *x[i] += (a[i] - lambda[i] * *x[i]) * factor;
+  }
+
+  m_kappaP = m_u / sigma_kappa;
+  m_alphaP = std::atan(m_v / sigma_alpha);
+}
+
+void ChSurrogateTire::get_inputs(double* in, int stride, int l) const
+{
+  in[ChSurrogateTireModel::KAPPA * stride + l] = m_kappaP;
+  in[ChSurrogateTireModel::ALPHA * stride + l] = m_side_sign * m_alphaP;
+  in[ChSurrogateTireModel::GAMMA * stride + l] = m_side_sign * m_gamma;
+  in[ChSurrogateTireModel::FZ * stride + l] = m_Fz;
+  in[ChSurrogateTireModel::VX * stride + l] = std::abs(m_V_cx);
+}
+
+void ChSurrogateTire::set_reactions(const double* out, int stride, int l)
+{
+  m_FM.point = m_W_frame.pos;
+  m_FM.force.x = m_mu_scale * out[ChSurrogateTireModel::FX * stride + l];
+  m_FM.force.y = m_mu_scale * m_side_sign * out[ChSurrogateTireModel::FY * stride + l];
+  m_FM.force.z = m_Fz;
+  m_FM.moment = ChVector<>(0, 0, m_mu_scale * m_side_sign * out[ChSurrogateTireModel::MZ * stride + l]);
+
+  m_FM_global.point = m_W_frame.pos;
+  m_FM_global.force = m_W_frame.TransformDirectionLocalToParent(m_FM.force);
+  m_FM_global.moment = m_W_frame.TransformDirectionLocalToParent(m_FM.moment);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSurrogateTire::SaveState(vehicle::ChVehicleState& state) const
+{
+  state.BeginBlock(SURROGATE_STATE_SIZE);
+
+  state.Write(m_state);
+  state.Write(m_W_frame);
+  state.Write(m_FM);
+  state.Write(m_FM_global);
+
+  double vals[15] = { m_in_contact ? 1.0 : 0.0, m_depth, m_Fz, m_R_eff, m_mu_scale,
+                      m_V_cx, m_V_sx, m_V_sy, m_kappa, m_alpha, m_gamma,
+                      m_u, m_v, m_kappaP, m_alphaP };
+  state.Write(vals, 15);
+}
+
+bool ChSurrogateTire::RestoreState(vehicle::ChVehicleState& state)
+{
+  if (!state.OpenBlock(SURROGATE_STATE_SIZE, m_name.c_str()))
+    return false;
+
+  m_state = state.ReadWheelState();
+  m_W_frame = state.ReadCoordsys();
+  m_FM = state.ReadTireForce();
+  m_FM_global = state.ReadTireForce();
+
+  double vals[15];
+  state.Read(vals, 15);
+  m_in_contact = (vals[0] != 0);
+  m_depth = vals[1];
+  m_Fz = vals[2];
+  m_R_eff = vals[3];
+  m_mu_scale = vals[4];
+  m_V_cx = vals[5];
+  m_V_sx = vals[6];
+  m_V_sy = vals[7];
+  m_kappa = vals[8];
+  m_alpha = vals[9];
+  m_gamma = vals[10];
+  m_u = vals[11];
+  m_v = vals[12];
+  m_kappaP = vals[13];
+  m_alphaP = vals[14];
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,177 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Tire evaluating a neural network surrogate of the steady-state reactions of
+// a Pacejka tire (see ChSurrogateTireModel), for large traffic simulations.
+//
+// The contact, the vertical load and the kinematic slips are those of
+// ChPacejkaTire: a single disc of the unloaded radius against the terrain, a
+// linear spring-damper vertical load, and the slips from the velocity of the
+// wheel center in the contact frame with the Pac2002 rolling radius. The
+// transient behavior follows the contact point deflection (relaxation length)
+// model of ChPacejkaTire:
+//    du/dt = -V_sx - |V_x| u / sigma_kappa,   dv/dt = -V_sy - |V_x| v / sigma_alpha
+//    kappa' = u / sigma_kappa,                 tan(alpha') = v / sigma_alpha
+// with the relaxation lengths of the surrogate file, solved exactly over the
+// step; the Besselink low speed damping is not modeled. The surrogate is then
+// evaluated at the transient slips. The reactions are scaled by the terrain
+// friction (see ChTire::SetReferenceFriction()); the overturning and rolling
+// resistance moments are not modeled.
+//
+// A tire can be advanced on its own (Advance()) or, to evaluate the surrogate
+// for many tires at once, by a ChSurrogateTireBatch.
+//
+// =============================================================================
+
+#ifndef CH_SURROGATE_TIRE_H
+#define CH_SURROGATE_TIRE_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChCoordsys.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/tire/ChSurrogateTireModel.h"
+
+namespace chrono {
+
+class ChSurrogateTireBatch;
+
+///
+/// Tire model evaluating a neural network surrogate of the Magic Formula.
+///
+class CH_SUBSYS_API ChSurrogateTire : public ChTire
+{
+public:
+
+  /// Construct a surrogate tire from the specified JSON file (see
+  /// ChSurrogateTireModel).
+  ChSurrogateTire(
+    const std::string& filename,   ///< [in] surrogate tire file
+    const ChTerrain&   terrain     ///< [in] reference to the terrain system
+    );
+
+  /// Construct a surrogate tire with the specified (shared) model.
+  ChSurrogateTire(
+    const std::string&                  name,     ///< [in] name of this tire
+    ChSharedPtr<ChSurrogateTireModel>   model,    ///< [in] surrogate model
+    const ChTerrain&                    terrain   ///< [in] reference to the terrain system
+    );
+
+  ~ChSurrogateTire() {}
+
+  /// Initialize this tire for the specified side of the vehicle. The lateral
+  /// reactions of the surrogate are mirrored on the side opposite to that of
+  /// the characterized tire.
+  void Initialize(ChVehicleSide side);
+
+  /// Return true if the surrogate model was loaded.
+  bool IsValid() const { return !m_model.IsNull(); }
+
+  /// Get the surrogate model.
+  ChSharedPtr<ChSurrogateTireModel> GetModel() const { return m_model; }
+
+  /// Enable or disable the transient slips (default: enabled). Without them,
+  /// the surrogate is evaluated at the kinematic slips.
+  void SetTransientSlip(bool val) { m_transient = val; }
+
+  /// Get the tire force and moment, in the global frame.
+  virtual ChTireForce GetTireForce() const { return m_FM_global; }
+
+  /// Get the tire force and moment in the contact frame (TYDEX W-axis).
+  const ChTireForce& GetTireForceLocal() const { return m_FM; }
+
+  /// Return the relative cost of one update.
+  virtual double GetUpdateCost() const { return m_model.IsNull() ? 1 : 2 + m_model->GetNumOperations() / 100.0; }
+
+  /// Update the contact, the vertical load and the kinematic slips from the
+  /// specified wheel state.
+  virtual void Update(
+    double               time,          ///< [in] current time
+    const ChWheelState&  wheel_state    ///< [in] current state of associated wheel body
+    );
+
+  /// Advance the transient slips by the specified time step and evaluate the
+  /// reactions.
+  virtual void Advance(double step);
+
+  /// Append the internal state of this tire to the snapshot.
+  virtual void SaveState(vehicle::ChVehicleState& state) const;
+
+  /// Restore the internal state of this tire from the snapshot.
+  virtual bool RestoreState(vehicle::ChVehicleState& state);
+
+  /// Get the kinematic slips, the transient slips and the vertical load.
+  double get_kappa() const { return m_kappa; }
+  double get_alpha() const { return m_alpha; }
+  double get_gamma() const { return m_gamma; }
+  double get_kappaPrime() const { return m_kappaP; }
+  double get_alphaPrime() const { return m_alphaP; }
+  double get_Fz() const { return m_Fz; }
+
+private:
+
+  // Advance the contact point deflections over the step and set the
+  // transient slips.
+  void advance_slips(double step);
+
+  // Write the surrogate inputs of this tire to lane l of the input arrays.
+  void get_inputs(double* in, int stride, int l) const;
+
+  // Set the reactions from lane l of the surrogate outputs.
+  void set_reactions(const double* out, int stride, int l);
+
+  // Set the reactions to zero (no contact).
+  void clear_reactions();
+
+  ChSharedPtr<ChSurrogateTireModel>  m_model;
+  double               m_side_sign;    // -1: mirrored
+  bool                 m_transient;
+
+  ChWheelState         m_state;
+  ChCoordsys<>         m_W_frame;      // contact frame
+  bool                 m_in_contact;
+  double               m_depth;
+  double               m_Fz;
+  double               m_R_eff;
+  double               m_mu_scale;
+
+  double               m_V_cx;         // velocities of the wheel center and slip velocities,
+  double               m_V_sx;         // in the contact frame
+  double               m_V_sy;
+  double               m_kappa;        // kinematic slips
+  double               m_alpha;
+  double               m_gamma;
+  double               m_u;            // contact point deflections
+  double               m_v;
+  double               m_kappaP;       // transient slips
+  double               m_alphaP;
+
+  ChTireForce          m_FM;           // reactions in the contact frame
+  ChTireForce          m_FM_global;    // reactions in the global frame
+
+  std::vector<double>  m_work;
+
+  friend class ChSurrogateTireBatch;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,101 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched advance of a collection of ChSurrogateTire objects.
+//
+// =============================================================================
+
+#include "core/ChTimer.h"
+
+#include "subsys/tire/ChSurrogateTireBatch.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSurrogateTireBatch::ChSurrogateTireBatch()
+: m_num_kernel_calls(0),
+  m_sum_kernel_time(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChSurrogateTireBatch::AddTire(ChSharedPtr<ChSurrogateTire> tire)
+{
+  if (!tire->IsValid())
+    return -1;
+
+  size_t g = 0;
+  while (g < m_groups.size() && m_groups[g].model.get_ptr() != tire->m_model.get_ptr())
+    g++;
+  if (g == m_groups.size()) {
+    m_groups.push_back(Group());
+    m_groups[g].model = tire->m_model;
+  }
+
+  Group& group = m_groups[g];
+  group.tires.push_back((int)m_tires.size());
+  m_tires.push_back(tire);
+
+  int n = (int)group.tires.size();
+  group.lanes.reserve(n);
+  group.in.resize(ChSurrogateTireModel::NUM_INPUTS * n);
+  group.out.resize(ChSurrogateTireModel::NUM_OUTPUTS * n);
+  group.work.resize(group.model->GetWorkSize(n));
+
+  return (int)m_tires.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Only the tires in contact are packed, into the first lanes of their group;
+// the buffers are sized for all the tires of the group, which is the stride
+// of the input and output arrays.
+// -----------------------------------------------------------------------------
+void ChSurrogateTireBatch::Advance(double step)
+{
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    Group& group = m_groups[g];
+    int stride = (int)group.tires.size();
+
+    group.lanes.clear();
+    for (size_t i = 0; i < group.tires.size(); i++) {
+      ChSurrogateTire* tire = m_tires[group.tires[i]].get_ptr();
+      if (!tire->m_in_contact)
+        continue;
+      tire->advance_slips(step);
+      tire->get_inputs(&group.in[0], stride, (int)group.lanes.size());
+      group.lanes.push_back(group.tires[i]);
+    }
+
+    if (group.lanes.empty())
+      continue;
+
+    ChTimer<double> kernel_timer;
+    kernel_timer.start();
+
+    group.model->Evaluate((int)group.lanes.size(), stride, &group.in[0], &group.out[0], &group.work[0]);
+
+    kernel_timer.stop();
+    m_num_kernel_calls++;
+    m_sum_kernel_time += kernel_timer();
+
+    for (size_t l = 0; l < group.lanes.size(); l++)
+      m_tires[group.lanes[l]]->set_reactions(&group.out[0], stride, (int)l);
+  }
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,96 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched advance of a collection of ChSurrogateTire objects.
+//
+// The tires of the batch are grouped by surrogate model. At each step, the
+// transient slips of each tire are advanced, the network inputs of the tires
+// in contact are packed into structure-of-arrays buffers (one contiguous array
+// per input, one entry per tire "lane"), and the network of each group is
+// evaluated for all its lanes at once (see ChSurrogateTireModel::Evaluate()),
+// before the reactions are copied back to the tires. The result is the same
+// as calling ChSurrogateTire::Advance() on each tire.
+//
+// =============================================================================
+
+#ifndef CH_SURROGATE_TIRE_BATCH_H
+#define CH_SURROGATE_TIRE_BATCH_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/tire/ChSurrogateTire.h"
+
+namespace chrono {
+
+///
+/// Batched surrogate tire evaluator.
+/// Tires are added to the batch after they have been initialized. At each
+/// step, the user calls Update() on each individual tire (as usual) and then
+/// a single Advance() on the batch, instead of Advance() on each tire.
+///
+class CH_SUBSYS_API ChSurrogateTireBatch : public ChShared
+{
+public:
+
+  ChSurrogateTireBatch();
+  ~ChSurrogateTireBatch() {}
+
+  /// Add an (initialized) surrogate tire to this batch.
+  /// Returns the index of the tire in the batch, or -1 if its model was not
+  /// loaded.
+  int AddTire(ChSharedPtr<ChSurrogateTire> tire);
+
+  /// Get the number of tires in this batch.
+  int GetNumTires() const { return (int)m_tires.size(); }
+
+  /// Get the number of distinct surrogate models in this batch.
+  int GetNumModels() const { return (int)m_groups.size(); }
+
+  /// Get the tire with the specified index.
+  ChSharedPtr<ChSurrogateTire> GetTire(int index) const { return m_tires[index]; }
+
+  /// Advance the state of all tires in the batch by the specified time step.
+  void Advance(double step);
+
+  /// Get the average time per call spent evaluating the networks.
+  double get_average_kernel_time() const { return m_sum_kernel_time / (double)m_num_kernel_calls; }
+
+private:
+
+  // Tires sharing a surrogate model, with their lane buffers.
+  struct Group {
+    ChSharedPtr<ChSurrogateTireModel>  model;
+    std::vector<int>                   tires;    // indices of the tires in the batch
+    std::vector<int>                   lanes;    // tires in contact at the current step
+    std::vector<double>                in;       // inputs, one array of tires.size() values per input
+    std::vector<double>                out;      // reactions, one array per output
+    std::vector<double>                work;
+  };
+
+  std::vector<ChSharedPtr<ChSurrogateTire> > m_tires;
+  std::vector<Group>                         m_groups;
+
+  int    m_num_kernel_calls;
+  double m_sum_kernel_time;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,320 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Neural network surrogate of the steady-state tire reactions.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+#include <map>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChVehicleThreads.h"
+#include "subsys/tire/ChSurrogateTireModel.h"
+#include "subsys/tire/ChFastMath.h"
+
+// Tell the compiler that the activation arrays do not alias, so that the layer
+// loops can be vectorized without run-time overlap checks.
+#if defined(_MSC_VER)
+#define CH_SURROGATE_IVDEP __pragma(loop(ivdep))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define CH_SURROGATE_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define CH_SURROGATE_IVDEP _Pragma("clang loop vectorize(enable)")
+#else
+#define CH_SURROGATE_IVDEP
+#endif
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// Models loaded so far, by file name.
+static std::map<std::string, ChSharedPtr<ChSurrogateTireModel> > s_surrogate_models;
+static vehicle::ChMutex s_surrogate_mutex;
+
+// Read an array of n numbers. Returns false if the member is not such an array.
+static bool ReadSurrogateArray(const Value& object, const char* name, int n, double* vals)
+{
+  if (!object.HasMember(name) || !object[name].IsArray() || object[name].Size() != (SizeType)n)
+    return false;
+  for (SizeType i = 0; i < (SizeType)n; i++) {
+    if (!object[name][i].IsNumber())
+      return false;
+    vals[i] = object[name][i].GetDouble();
+  }
+  return true;
+}
+
+static bool ReadSurrogateVector(const Value& object, const char* name, std::vector<double>& vals)
+{
+  if (!object.HasMember(name) || !object[name].IsArray() || object[name].Size() == 0)
+    return false;
+  vals.resize(object[name].Size());
+  return ReadSurrogateArray(object, name, (int)vals.size(), &vals[0]);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSurrogateTireModel::ChSurrogateTireModel()
+: m_right(false),
+  m_radius(0),
+  m_vert_stiffness(0),
+  m_vert_damping(0),
+  m_Fz_nom(0),
+  m_Fz_min(0),
+  m_long_vl(0),
+  m_vx_low(0),
+  m_dreff(0),
+  m_breff(0),
+  m_freff(0),
+  m_relu(false),
+  m_max_width(0),
+  m_num_ops(0)
+{
+}
+
+ChSharedPtr<ChSurrogateTireModel> ChSurrogateTireModel::Get(const std::string& filename)
+{
+  vehicle::ChScopedLock lock(s_surrogate_mutex);
+
+  std::map<std::string, ChSharedPtr<ChSurrogateTireModel> >::iterator it = s_surrogate_models.find(filename);
+  if (it != s_surrogate_models.end())
+    return it->second;
+
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+  ChSharedPtr<ChSurrogateTireModel> model(new ChSurrogateTireModel);
+  if (d.HasParseError() || !model->Load(d)) {
+    GetLog() << "ERROR: invalid surrogate tire file " << filename.c_str() << "\n";
+    return ChSharedPtr<ChSurrogateTireModel>();
+  }
+
+  s_surrogate_models[filename] = model;
+  return model;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChSurrogateTireModel::Load(const Document& d)
+{
+  static const char* scalars[] = { "Radius", "Vertical Stiffness", "Vertical Damping", "Nominal Load",
+                                   "Minimum Load", "Reference Velocity", "Low Velocity" };
+
+  if (!d.IsObject() || !d.HasMember("Template") || !d["Template"].IsString() ||
+      std::string(d["Template"].GetString()) != "SurrogateTire")
+    return false;
+  for (int i = 0; i < 7; i++) {
+    if (!d.HasMember(scalars[i]) || !d[scalars[i]].IsNumber())
+      return false;
+  }
+  if (!d.HasMember("Rolling Radius") || !d.HasMember("Relaxation Lengths") || !d.HasMember("Network"))
+    return false;
+
+  m_name = (d.HasMember("Name") && d["Name"].IsString()) ? d["Name"].GetString() : "";
+  m_right = d.HasMember("Side") && d["Side"].IsString() && std::string(d["Side"].GetString()) == "RIGHT";
+  m_radius = d["Radius"].GetDouble();
+  m_vert_stiffness = d["Vertical Stiffness"].GetDouble();
+  m_vert_damping = d["Vertical Damping"].GetDouble();
+  m_Fz_nom = d["Nominal Load"].GetDouble();
+  m_Fz_min = d["Minimum Load"].GetDouble();
+  m_long_vl = d["Reference Velocity"].GetDouble();
+  m_vx_low = d["Low Velocity"].GetDouble();
+
+  const Value& rolling = d["Rolling Radius"];
+  if (!rolling.IsObject() || !rolling.HasMember("DREFF") || !rolling.HasMember("BREFF") || !rolling.HasMember("FREFF"))
+    return false;
+  m_dreff = rolling["DREFF"].GetDouble();
+  m_breff = rolling["BREFF"].GetDouble();
+  m_freff = rolling["FREFF"].GetDouble();
+
+  const Value& relax = d["Relaxation Lengths"];
+  if (!relax.IsObject() || !ReadSurrogateVector(relax, "Fz", m_relax_Fz) ||
+      !ReadSurrogateVector(relax, "Kappa", m_relax_kappa) || !ReadSurrogateVector(relax, "Alpha", m_relax_alpha) ||
+      m_relax_kappa.size() != m_relax_Fz.size() || m_relax_alpha.size() != m_relax_Fz.size())
+    return false;
+
+  const Value& net = d["Network"];
+  if (!net.IsObject() || !net.HasMember("Activation") || !net["Activation"].IsString() ||
+      !ReadSurrogateArray(net, "Input Min", NUM_INPUTS, m_in_min) ||
+      !ReadSurrogateArray(net, "Input Max", NUM_INPUTS, m_in_max) ||
+      !ReadSurrogateArray(net, "Input Offset", NUM_INPUTS, m_in_offset) ||
+      !ReadSurrogateArray(net, "Input Scale", NUM_INPUTS, m_in_scale) ||
+      !ReadSurrogateArray(net, "Output Offset", NUM_OUTPUTS, m_out_offset) ||
+      !ReadSurrogateArray(net, "Output Scale", NUM_OUTPUTS, m_out_scale))
+    return false;
+
+  std::string activation = net["Activation"].GetString();
+  if (activation != "tanh" && activation != "relu")
+    return false;
+  m_relu = (activation == "relu");
+
+  if (!net.HasMember("Layers") || !net["Layers"].IsArray() || net["Layers"].Size() == 0)
+    return false;
+
+  // Read the layers, checking that their sizes are consistent.
+  m_layers.clear();
+  m_max_width = NUM_INPUTS;
+  m_num_ops = 0;
+  int num_in = NUM_INPUTS;
+  for (SizeType k = 0; k < net["Layers"].Size(); k++) {
+    const Value& layer = net["Layers"][k];
+    if (!layer.IsObject() || !layer.HasMember("Weights") || !layer["Weights"].IsArray())
+      return false;
+
+    Layer l;
+    l.num_in = num_in;
+    l.num_out = (int)layer["Weights"].Size();
+    if (l.num_out == 0 || !ReadSurrogateVector(layer, "Biases", l.biases) || (int)l.biases.size() != l.num_out)
+      return false;
+
+    l.weights.resize(l.num_out * l.num_in);
+    for (int o = 0; o < l.num_out; o++) {
+      const Value& row = layer["Weights"][SizeType(o)];
+      if (!row.IsArray() || row.Size() != (SizeType)l.num_in)
+        return false;
+      for (int i = 0; i < l.num_in; i++) {
+        if (!row[SizeType(i)].IsNumber())
+          return false;
+        l.weights[o * l.num_in + i] = row[SizeType(i)].GetDouble();
+      }
+    }
+
+    m_layers.push_back(l);
+    m_max_width = std::max(m_max_width, l.num_out);
+    m_num_ops += l.num_in * l.num_out;
+    num_in = l.num_out;
+  }
+
+  return num_in == NUM_OUTPUTS;
+}
+
+// -----------------------------------------------------------------------------
+// Effective rolling radius of the Pac2002 model (see
+// ChPacejkaTire::update_verticalLoad), with the same speed correction.
+// -----------------------------------------------------------------------------
+double ChSurrogateTireModel::GetRollingRadius(double deflection, double omega) const
+{
+  const double qV1 = 0.000071;
+  double V_ratio = omega * m_radius / m_long_vl;
+  double K1 = V_ratio * V_ratio;
+  double rho = deflection + qV1 * m_radius * K1;
+  double rho_Fz0 = m_Fz_nom / m_vert_stiffness;
+  double rho_d = rho / rho_Fz0;
+
+  double R_eff = m_radius + qV1 * m_radius * K1 - rho_Fz0 * (m_dreff * std::atan(m_breff * rho_d) + m_freff * rho_d);
+  return std::min(R_eff, m_radius);
+}
+
+void ChSurrogateTireModel::GetRelaxationLengths(double Fz, double& sigma_kappa, double& sigma_alpha) const
+{
+  size_t n = m_relax_Fz.size();
+  if (n == 1 || Fz <= m_relax_Fz[0]) {
+    sigma_kappa = m_relax_kappa[0];
+    sigma_alpha = m_relax_alpha[0];
+    return;
+  }
+  if (Fz >= m_relax_Fz[n - 1]) {
+    sigma_kappa = m_relax_kappa[n - 1];
+    sigma_alpha = m_relax_alpha[n - 1];
+    return;
+  }
+
+  size_t i = std::upper_bound(m_relax_Fz.begin(), m_relax_Fz.end(), Fz) - m_relax_Fz.begin() - 1;
+  double t = (Fz - m_relax_Fz[i]) / (m_relax_Fz[i + 1] - m_relax_Fz[i]);
+  sigma_kappa = m_relax_kappa[i] + t * (m_relax_kappa[i + 1] - m_relax_kappa[i]);
+  sigma_alpha = m_relax_alpha[i] + t * (m_relax_alpha[i + 1] - m_relax_alpha[i]);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSurrogateTireModel::Evaluate(int n, int stride, const double* in, double* out, double* work) const
+{
+  for (int first = 0; first < n; first += BLOCK_SIZE)
+    evaluate_block(std::min(n - first, (int)BLOCK_SIZE), stride, in + first, out + first, work);
+}
+
+// The activations of the current and the next layer alternate between the two
+// halves of the work array; neuron j of a layer holds the values of the lanes
+// at [j * n, (j + 1) * n).
+void ChSurrogateTireModel::evaluate_block(int n, int stride, const double* in, double* out, double* work) const
+{
+  double* x = work;
+  double* y = work + m_max_width * n;
+
+  // Clamped and normalized inputs.
+  for (int i = 0; i < NUM_INPUTS; i++) {
+    const double* src = in + i * stride;
+    double* dst = x + i * n;
+    double lo = m_in_min[i];
+    double hi = m_in_max[i];
+    double offset = m_in_offset[i];
+    double scale = m_in_scale[i];
+    CH_SURROGATE_IVDEP
+    for (int l = 0; l < n; l++)
+      dst[l] = (std::min(std::max(src[l], lo), hi) - offset) * scale;
+  }
+
+  int num_layers = (int)m_layers.size();
+  for (int k = 0; k < num_layers; k++) {
+    const Layer& layer = m_layers[k];
+    bool hidden = (k < num_layers - 1);
+
+    for (int o = 0; o < layer.num_out; o++) {
+      double* acc = y + o * n;
+      const double* w = &layer.weights[o * layer.num_in];
+      double b = layer.biases[o];
+      for (int l = 0; l < n; l++)
+        acc[l] = b;
+      for (int i = 0; i < layer.num_in; i++) {
+        const double* xi = x + i * n;
+        double wi = w[i];
+        CH_SURROGATE_IVDEP
+        for (int l = 0; l < n; l++)
+          acc[l] += wi * xi[l];
+      }
+      if (hidden && m_relu) {
+        CH_SURROGATE_IVDEP
+        for (int l = 0; l < n; l++)
+          acc[l] = std::max(acc[l], 0.0);
+      }
+      else if (hidden) {
+        CH_SURROGATE_IVDEP
+        for (int l = 0; l < n; l++)
+          acc[l] = ChFastTanh(acc[l]);
+      }
+    }
+
+    std::swap(x, y);
+  }
+
+  // Denormalized, load-scaled reactions (the actual load, not the clamped one).
+  const double* Fz = in + FZ * stride;
+  for (int o = 0; o < NUM_OUTPUTS; o++) {
+    const double* src = x + o * n;
+    double* dst = out + o * stride;
+    double offset = m_out_offset[o];
+    double scale = m_out_scale[o];
+    CH_SURROGATE_IVDEP
+    for (int l = 0; l < n; l++)
+      dst[l] = Fz[l] * (src[l] * scale + offset);
+  }
+}
+
+
+} // end namespace chrono
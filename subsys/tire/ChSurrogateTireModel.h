@@ -0,0 +1,203 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Neural network surrogate of the steady-state reactions of a tire, with the
+// parameters of its vertical and transient models (see ChSurrogateTire).
+//
+// The network is a small multilayer perceptron mapping the operating point
+//    (kappa, alpha, gamma, Fz, Vx)
+// to the load-normalized combined slip reactions in the contact frame
+//    (Fx / Fz, Fy / Fz, Mz / Fz)
+// with a tanh or ReLU activation on the hidden layers and a linear output
+// layer. It is trained offline from the steady-state characterization of a
+// Pacejka tire (see test_pacSweep and PacTire_surrogate.py). The inputs are
+// clamped to the ranges of the training data, so that the reactions saturate
+// outside of them; the load normalization extends the reactions linearly in
+// Fz beyond the load range.
+//
+// The network is evaluated for a batch of operating points ("lanes") at once,
+// in blocks of lanes. Within a block, the activations of a layer are stored
+// with one contiguous array per neuron (structure of arrays), so that the
+// inner loop of each layer runs over the lanes with a broadcast weight, and
+// can be vectorized by the compiler (see the ENABLE_PACEJKA_SIMD option). The
+// tanh activation uses the branch-free approximation ChFastTanh(). There is no
+// dependency on an external inference runtime.
+//
+// The model is loaded from a JSON file:
+//   {
+//     "Type": "Tire", "Template": "SurrogateTire", "Name": ...,
+//     "Side": "LEFT" or "RIGHT",        (side of the characterized tire)
+//     "Radius": ..., "Vertical Stiffness": ..., "Vertical Damping": ...,
+//     "Nominal Load": ..., "Minimum Load": ...,
+//     "Reference Velocity": ..., "Low Velocity": ...,
+//     "Rolling Radius": { "DREFF": ..., "BREFF": ..., "FREFF": ... },
+//     "Relaxation Lengths": { "Fz": [...], "Kappa": [...], "Alpha": [...] },
+//     "Network": {
+//       "Activation": "tanh" or "relu",
+//       "Input Min": [5], "Input Max": [5],
+//       "Input Offset": [5], "Input Scale": [5],
+//       "Output Offset": [3], "Output Scale": [3],
+//       "Layers": [ { "Weights": [ [row], ... ], "Biases": [...] }, ... ]
+//     }
+//   }
+// where the weights of a layer are listed one row per output neuron, a network
+// input is (x - offset) * scale, and a reaction is Fz (y * scale + offset).
+// Models are cached by file name and shared by all the tires using them.
+//
+// =============================================================================
+
+#ifndef CH_SURROGATE_TIRE_MODEL_H
+#define CH_SURROGATE_TIRE_MODEL_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "core/ChSmartpointers.h"
+
+#include "subsys/ChApiSubsys.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Surrogate tire network and parameters, shared (read-only) by all the tires
+/// using the same file.
+///
+class CH_SUBSYS_API ChSurrogateTireModel : public ChShared
+{
+public:
+
+  /// Network inputs.
+  enum Input {
+    KAPPA,
+    ALPHA,
+    GAMMA,
+    FZ,
+    VX,
+    NUM_INPUTS
+  };
+
+  /// Network outputs (reactions in the contact frame).
+  enum Output {
+    FX,
+    FY,
+    MZ,
+    NUM_OUTPUTS
+  };
+
+  /// Number of lanes evaluated together by Evaluate().
+  static const int BLOCK_SIZE = 64;
+
+  ChSurrogateTireModel();
+  ~ChSurrogateTireModel() {}
+
+  /// Get the model loaded from the specified JSON file, shared with all
+  /// previous calls for the same file. Returns an empty pointer if the file
+  /// cannot be loaded.
+  static ChSharedPtr<ChSurrogateTireModel> Get(const std::string& filename);
+
+  /// Load the model from the specified JSON document.
+  /// Returns false if the document is not a valid surrogate tire.
+  bool Load(const rapidjson::Document& d);
+
+  /// Evaluate the reactions of n lanes. The inputs of lane l are in[i * stride + l]
+  /// and its reactions are written to out[o * stride + l]. The work array must
+  /// hold GetWorkSize(n) values.
+  void Evaluate(
+    int           n,        ///< [in] number of lanes
+    int           stride,   ///< [in] stride of the input and output arrays
+    const double* in,       ///< [in] inputs, one array per input
+    double*       out,      ///< [out] reactions, one array per output
+    double*       work      ///< [in] work array
+    ) const;
+
+  /// Get the size of the work array needed to evaluate n lanes.
+  int GetWorkSize(int n) const { return 2 * m_max_width * (n < BLOCK_SIZE ? n : BLOCK_SIZE); }
+
+  /// Get the number of multiply-adds of one evaluation.
+  int GetNumOperations() const { return m_num_ops; }
+
+  /// Get the name of the model.
+  const std::string& GetName() const { return m_name; }
+
+  /// Return true if the network was characterized on the right side.
+  bool IsRightSide() const { return m_right; }
+
+  /// Get the parameters of the vertical model.
+  double GetRadius() const { return m_radius; }
+  double GetVerticalStiffness() const { return m_vert_stiffness; }
+  double GetVerticalDamping() const { return m_vert_damping; }
+  double GetNominalLoad() const { return m_Fz_nom; }
+  double GetMinimumLoad() const { return m_Fz_min; }
+
+  /// Get the reference velocity (LONGVL) and the low velocity threshold of
+  /// the slip definitions (VXLOW).
+  double GetReferenceVelocity() const { return m_long_vl; }
+  double GetLowVelocity() const { return m_vx_low; }
+
+  /// Get the effective rolling radius at the specified deflection and spin.
+  double GetRollingRadius(double deflection, double omega) const;
+
+  /// Get the longitudinal and lateral relaxation lengths at the specified
+  /// vertical load (interpolated linearly in the table, held outside of it).
+  void GetRelaxationLengths(double Fz, double& sigma_kappa, double& sigma_alpha) const;
+
+private:
+
+  struct Layer {
+    int                  num_in;
+    int                  num_out;
+    std::vector<double>  weights;   // row-major, one row per output neuron
+    std::vector<double>  biases;
+  };
+
+  // Evaluate one block of at most BLOCK_SIZE lanes.
+  void evaluate_block(int n, int stride, const double* in, double* out, double* work) const;
+
+  std::string          m_name;
+  bool                 m_right;
+  double               m_radius;
+  double               m_vert_stiffness;
+  double               m_vert_damping;
+  double               m_Fz_nom;
+  double               m_Fz_min;
+  double               m_long_vl;
+  double               m_vx_low;
+  double               m_dreff;
+  double               m_breff;
+  double               m_freff;
+
+  std::vector<double>  m_relax_Fz;
+  std::vector<double>  m_relax_kappa;
+  std::vector<double>  m_relax_alpha;
+
+  bool                 m_relu;
+  double               m_in_min[NUM_INPUTS];
+  double               m_in_max[NUM_INPUTS];
+  double               m_in_offset[NUM_INPUTS];
+  double               m_in_scale[NUM_INPUTS];
+  double               m_out_offset[NUM_OUTPUTS];
+  double               m_out_scale[NUM_OUTPUTS];
+  std::vector<Layer>   m_layers;
+  int                  m_max_width;
+  int                  m_num_ops;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,143 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thermal and wear state of a tire, driving a grip factor on the tire friction.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/tire/ChTireThermal.h"
+
+
+namespace chrono {
+
+
+ChTireThermal::ChTireThermal()
+: m_interval(0.1)
+{
+  m_params.C_tread = 15000;
+  m_params.C_carcass = 40000;
+  m_params.h_tread_carcass = 150;
+  m_params.h_tread_air = 30;
+  m_params.h_tread_air_vel = 10;
+  m_params.h_carcass_air = 40;
+  m_params.T_ambient = 20;
+  m_params.T_optimal = 70;
+  m_params.heat_fraction = 0.7;
+  m_params.grip_temp_coef = 2e-5;
+  m_params.grip_min = 0.5;
+  m_params.wear_rate = 1e-11;
+  m_params.tread_depth = 0.012;
+  m_params.wear_grip_loss = 0.1;
+
+  Reset();
+}
+
+void ChTireThermal::Reset()
+{
+  m_T_tread = m_params.T_ambient;
+  m_T_carcass = m_params.T_ambient;
+  m_wear = 0;
+  m_energy = 0;
+  m_distance = 0;
+  m_time = 0;
+
+  eval_grip();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChTireThermal::Accumulate(double power, double speed, double step)
+{
+  m_energy += std::max(power, 0.0) * step;
+  m_distance += std::abs(speed) * step;
+  m_time += step;
+
+  if (m_time < m_interval || m_time <= 0)
+    return false;
+
+  advance();
+  eval_grip();
+
+  m_energy = 0;
+  m_distance = 0;
+  m_time = 0;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Backward Euler step of the two-node model over the accumulated time, with the
+// mean frictional power and the mean speed (for the convection at the tread):
+//   C_t (T_t' - T_t) / dt = Q - h_tc (T_t' - T_c') - h_ta (T_t' - T_a)
+//   C_c (T_c' - T_c) / dt = h_tc (T_t' - T_c') - h_ca (T_c' - T_a)
+// -----------------------------------------------------------------------------
+void ChTireThermal::advance()
+{
+  const Parameters& p = m_params;
+
+  double Q = p.heat_fraction * m_energy / m_time;
+  double h_ta = p.h_tread_air + p.h_tread_air_vel * (m_distance / m_time);
+
+  double a11 = p.C_tread / m_time + p.h_tread_carcass + h_ta;
+  double a22 = p.C_carcass / m_time + p.h_tread_carcass + p.h_carcass_air;
+  double a12 = -p.h_tread_carcass;
+  double b1 = p.C_tread / m_time * m_T_tread + Q + h_ta * p.T_ambient;
+  double b2 = p.C_carcass / m_time * m_T_carcass + p.h_carcass_air * p.T_ambient;
+
+  double det = a11 * a22 - a12 * a12;
+  m_T_tread = (b1 * a22 - a12 * b2) / det;
+  m_T_carcass = (a11 * b2 - a12 * b1) / det;
+
+  m_wear = std::min(m_wear + p.wear_rate * m_energy, p.tread_depth);
+}
+
+void ChTireThermal::eval_grip()
+{
+  const Parameters& p = m_params;
+
+  double dT = m_T_tread - p.T_optimal;
+  double grip_temp = 1 - p.grip_temp_coef * dT * dT;
+  double grip_wear = 1 - p.wear_grip_loss * (p.tread_depth > 0 ? m_wear / p.tread_depth : 0);
+  m_grip = std::max(grip_temp * grip_wear, p.grip_min);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChTireThermal::GetState(double* state) const
+{
+  state[0] = m_T_tread;
+  state[1] = m_T_carcass;
+  state[2] = m_wear;
+  state[3] = m_energy;
+  state[4] = m_distance;
+  state[5] = m_time;
+}
+
+void ChTireThermal::SetState(const double* state)
+{
+  m_T_tread = state[0];
+  m_T_carcass = state[1];
+  m_wear = state[2];
+  m_energy = state[3];
+  m_distance = state[4];
+  m_time = state[5];
+
+  eval_grip();
+}
+
+
+}  // end namespace chrono
@@ -0,0 +1,141 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thermal and wear state of a tire, driving a grip factor on the tire friction.
+//
+// The frictional power in the contact patch (slip velocities times tire forces)
+// is accumulated at every tire step. At a slower, fixed rate the accumulated
+// energy heats the tread, which exchanges heat with the carcass and, by forced
+// convection, with the ambient air; the carcass also cools to the ambient air.
+// The two temperatures are advanced with an implicit (backward Euler) step over
+// the update interval. The same energy wears the tread, at a constant rate per
+// unit of frictional work (Archard's law).
+//
+// The grip factor decreases quadratically with the deviation of the tread
+// temperature from the optimal temperature, and linearly with the worn fraction
+// of the tread depth. Since it only changes at the update rate, it can scale
+// the tire friction without recomputing the friction dependent terms of the
+// tire model at every step.
+//
+// =============================================================================
+
+#ifndef CH_TIRETHERMAL_H
+#define CH_TIRETHERMAL_H
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Two-node (tread, carcass) thermal model and tread wear model of a tire.
+///
+class CH_SUBSYS_API ChTireThermal
+{
+public:
+
+  /// Model parameters (SI units, temperatures in degrees C).
+  struct Parameters {
+    double C_tread;          ///< heat capacity of the tread [J/K]
+    double C_carcass;        ///< heat capacity of the carcass [J/K]
+    double h_tread_carcass;  ///< heat transfer coefficient tread-carcass [W/K]
+    double h_tread_air;      ///< heat transfer coefficient tread-air, at rest [W/K]
+    double h_tread_air_vel;  ///< increase of the tread-air coefficient with speed [W s/(K m)]
+    double h_carcass_air;    ///< heat transfer coefficient carcass-air [W/K]
+    double T_ambient;        ///< ambient temperature
+    double T_optimal;        ///< tread temperature of maximum grip
+    double heat_fraction;    ///< fraction of the frictional power heating the tread
+    double grip_temp_coef;   ///< grip loss per squared degree from the optimal temperature [1/K^2]
+    double grip_min;         ///< lower bound of the grip factor
+    double wear_rate;        ///< tread wear per unit of frictional work [m/J]
+    double tread_depth;      ///< usable tread depth [m]
+    double wear_grip_loss;   ///< grip loss at a completely worn tread
+  };
+
+  /// Number of values in the state vector (see GetState()).
+  static const int STATE_SIZE = 6;
+
+  /// Construct a model with default parameters (a light truck tire), at
+  /// ambient temperature and without wear.
+  ChTireThermal();
+
+  /// Set the model parameters. This does not change the current state.
+  void SetParameters(const Parameters& params) { m_params = params; }
+
+  /// Get the model parameters.
+  const Parameters& GetParameters() const { return m_params; }
+
+  /// Set the interval between updates of the temperatures, wear and grip
+  /// factor (default: 0.1 s).
+  void SetUpdateInterval(double interval) { m_interval = interval; }
+
+  /// Get the interval between updates of the temperatures, wear and grip.
+  double GetUpdateInterval() const { return m_interval; }
+
+  /// Reset the state: both temperatures to the ambient temperature, no wear
+  /// and no accumulated energy.
+  void Reset();
+
+  /// Add the frictional power over a tire step. Once the accumulated time
+  /// reaches the update interval, the temperatures, wear and grip factor are
+  /// updated with the mean power and speed over the interval.
+  /// Returns true if the state was updated.
+  bool Accumulate(
+    double power,   ///< [in] frictional power in the contact patch (>= 0)
+    double speed,   ///< [in] forward speed of the tire center
+    double step     ///< [in] tire step size
+    );
+
+  /// Get the current tread temperature.
+  double GetTreadTemperature() const { return m_T_tread; }
+
+  /// Get the current carcass temperature.
+  double GetCarcassTemperature() const { return m_T_carcass; }
+
+  /// Get the current tread wear (depth).
+  double GetWear() const { return m_wear; }
+
+  /// Get the current grip factor, as of the last update.
+  double GetGripFactor() const { return m_grip; }
+
+  /// Copy the state into the specified array of STATE_SIZE values.
+  void GetState(double* state) const;
+
+  /// Set the state from the specified array of STATE_SIZE values.
+  void SetState(const double* state);
+
+private:
+
+  // advance the temperatures and wear over the accumulated interval
+  void advance();
+
+  // evaluate the grip factor from the tread temperature and wear
+  void eval_grip();
+
+  Parameters m_params;
+  double m_interval;
+
+  double m_T_tread;       // tread temperature
+  double m_T_carcass;     // carcass temperature
+  double m_wear;          // tread wear
+  double m_energy;        // frictional energy accumulated since the last update
+  double m_distance;      // distance travelled since the last update
+  double m_time;          // time since the last update
+  double m_grip;          // grip factor
+};
+
+
+} // end namespace chrono
+
+
+#endif
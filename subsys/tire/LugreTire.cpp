@@ -17,25 +17,14 @@
 // =============================================================================
 
 #include "subsys/tire/LugreTire.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 LugreTire::LugreTire(const std::string&       filename,
@@ -43,15 +32,7 @@ LugreTire::LugreTire(const std::string&       filename,
 : ChLugreTire("", terrain),
   m_discLocs(NULL)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -88,6 +69,11 @@ void LugreTire::Create(const rapidjson::Document& d)
     m_discLocs[i] = d["Disc Locations"][SizeType(i)].GetDouble();
   }
 
+  ReadParameters(d);
+}
+
+void LugreTire::ReadParameters(const rapidjson::Document& d)
+{
   // Read normal stiffness and damping
   m_normalStiffness = d["Normal Stiffness"].GetDouble();
   m_normalDamping = d["Normal Damping"].GetDouble();
@@ -112,6 +98,23 @@ void LugreTire::Create(const rapidjson::Document& d)
   m_vs[1] = d["Lugre Parameters"]["vs"][1u].GetDouble();  // lateral
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool LugreTire::Reload(const rapidjson::Document& d)
+{
+  if (d["Radius"].GetDouble() != m_radius || (int)d["Disc Locations"].Size() != m_numDiscs)
+    return false;
+
+  for (int i = 0; i < m_numDiscs; i++) {
+    if (d["Disc Locations"][SizeType(i)].GetDouble() != m_discLocs[i])
+      return false;
+  }
+
+  ReadParameters(d);
+
+  return true;
+}
+
 
 
 }  // end namespace chrono
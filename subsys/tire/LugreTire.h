@@ -20,6 +20,7 @@
 #define LUGRE_TIRE_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/tire/ChLugreTire.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API LugreTire : public ChLugreTire
+class CH_SUBSYS_API LugreTire : public ChLugreTire, public vehicle::ChReloadable
 {
 public:
 
@@ -46,9 +47,15 @@ public:
 
   virtual void SetLugreParams() {}
 
+  /// Apply the normal stiffness and damping and the LuGre parameters of the
+  /// specified document in place (see ChHotReload). Returns false, with no
+  /// change, if the radius or the discs changed.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
   void Create(const rapidjson::Document& d);
+  void ReadParameters(const rapidjson::Document& d);
 
   double   m_radius;
   int      m_numDiscs;
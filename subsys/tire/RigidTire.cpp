@@ -18,8 +18,7 @@
 
 #include "subsys/tire/RigidTire.h"
 #include "subsys/ChVehicleModelData.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
 
 using namespace rapidjson;
 
@@ -32,15 +31,7 @@ RigidTire::RigidTire(const std::string&       filename,
                      const chrono::ChTerrain& terrain)
 : ChRigidTire("", terrain)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -64,6 +55,38 @@ void RigidTire::Create(const rapidjson::Document& d)
   m_mu = d["Coefficient of Friction"].GetDouble();
   m_radius = d["Radius"].GetDouble();
   m_width = d["Width"].GetDouble();
+
+  // Optional analytic terrain contact (no collision shape)
+  if (d.HasMember("Analytic Contact")) {
+    const Value& contact = d["Analytic Contact"];
+    int num_discs = contact.HasMember("Number of Discs") ? contact["Number of Discs"].GetInt() : 5;
+    SetAnalyticContact(contact["Normal Stiffness"].GetDouble(),
+                       contact["Normal Damping"].GetDouble(),
+                       num_discs);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool RigidTire::Reload(const rapidjson::Document& d)
+{
+  if (d["Radius"].GetDouble() != m_radius || d["Width"].GetDouble() != m_width)
+    return false;
+
+  if (d.HasMember("Analytic Contact")) {
+    const Value& contact = d["Analytic Contact"];
+    int num_discs = contact.HasMember("Number of Discs") ? contact["Number of Discs"].GetInt() : 5;
+    if (!SetContactParameters(contact["Normal Stiffness"].GetDouble(),
+                              contact["Normal Damping"].GetDouble(),
+                              num_discs))
+      return false;
+  }
+
+  m_mu = (float)d["Coefficient of Friction"].GetDouble();
+  UpdateFriction();
+
+  return true;
 }
 
 
@@ -20,6 +20,7 @@
 #define RIGID_TIRE_H
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChHotReload.h"
 #include "subsys/tire/ChRigidTire.h"
 
 #include "rapidjson/document.h"
@@ -27,7 +28,7 @@
 namespace chrono {
 
 
-class CH_SUBSYS_API RigidTire : public ChRigidTire
+class CH_SUBSYS_API RigidTire : public ChRigidTire, public vehicle::ChReloadable
 {
 public:
 
@@ -41,6 +42,11 @@ public:
   virtual double getRadius() const             { return m_radius; }
   virtual double getWidth() const              { return m_width; }
 
+  /// Apply the friction coefficient and the contact stiffness and damping of
+  /// the specified document in place (see ChHotReload). Returns false, with no
+  /// change, if the tire dimensions or the number of contact discs changed.
+  virtual bool Reload(const rapidjson::Document& d);
+
 private:
 
   void Create(const rapidjson::Document& d);
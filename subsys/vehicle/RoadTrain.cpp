@@ -0,0 +1,310 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Multi-unit vehicle (road train) constructed from a JSON specification file
+//
+// =============================================================================
+
+#include "core/ChLog.h"
+
+#include "subsys/vehicle/RoadTrain.h"
+
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChLugreTire.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChSystemOrdering.h"
+
+#include "rapidjson/document.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+RoadTrain::RoadTrain(const std::string& filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+  assert(d.HasMember("Vehicle Input File"));
+
+  m_vehicle = ChSharedPtr<Vehicle>(new Vehicle(vehicle::GetDataFile(d["Vehicle Input File"].GetString())));
+  Create(filename);
+}
+
+RoadTrain::RoadTrain(ChSystem*          system,
+                     const std::string& filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+  assert(d.HasMember("Vehicle Input File"));
+
+  m_vehicle = ChSharedPtr<Vehicle>(new Vehicle(system, vehicle::GetDataFile(d["Vehicle Input File"].GetString())));
+  Create(filename);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void RoadTrain::Create(const std::string& filename)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+  assert(d.HasMember("Trailers"));
+  assert(d["Trailers"].IsArray());
+
+  int num_trailers = d["Trailers"].Size();
+
+  m_trailers.resize(num_trailers);
+  m_towLocations.resize(num_trailers);
+
+  m_first_wheel.resize(num_trailers + 2);
+  m_first_wheel[0] = 0;
+  m_first_wheel[1] = 2 * m_vehicle->GetNumberAxles();
+
+  for (int i = 0; i < num_trailers; i++) {
+    std::string file_name = d["Trailers"][i]["Input File"].GetString();
+    m_trailers[i] = ChSharedPtr<Trailer>(new Trailer(m_vehicle->GetSystem(), vehicle::GetDataFile(file_name)));
+    m_towLocations[i] = loadVector(d["Trailers"][i]["Tow Location"]);
+
+    m_first_wheel[i + 2] = m_first_wheel[i + 1] + 2 * m_trailers[i]->GetNumberAxles();
+  }
+
+  m_wheel_states.resize(GetNumWheels());
+  m_tire_forces.resize(GetNumWheels());
+}
+
+
+// -----------------------------------------------------------------------------
+// Each trailer is placed with its hitch point at the tow location of the unit
+// in front of it.
+// -----------------------------------------------------------------------------
+void RoadTrain::Initialize(const ChCoordsys<>& chassisPos)
+{
+  m_vehicle->Initialize(chassisPos);
+
+  ChCoordsys<> pullerPos = chassisPos;
+  ChSharedPtr<ChBodyAuxRef> puller = m_vehicle->GetChassis();
+
+  for (size_t i = 0; i < m_trailers.size(); i++) {
+    ChVector<> tow = pullerPos.TransformLocalToParent(m_towLocations[i]);
+
+    ChCoordsys<> trailerPos;
+    trailerPos.rot = chassisPos.rot;
+    trailerPos.pos = tow - chassisPos.rot.Rotate(m_trailers[i]->GetHitchLocation());
+
+    m_trailers[i]->Initialize(trailerPos, puller);
+
+    pullerPos = trailerPos;
+    puller = m_trailers[i]->GetChassis();
+  }
+
+  // Group the bodies and links of the shared system unit by unit.
+  vehicle::ChSystemOrdering ordering;
+  ordering.AddVehicle(*m_vehicle);
+  for (size_t i = 0; i < m_trailers.size(); i++) {
+    ordering.AddUnit(m_trailers[i]->GetChassis().get_ptr());
+    std::vector<ChLink*> links;
+    for (int j = 0; j < m_trailers[i]->GetNumberAxles(); j++) {
+      links.clear();
+      m_trailers[i]->GetSuspension(j)->GetConstraints(links);
+      ordering.AddSubsystem(links);
+    }
+  }
+  ordering.Apply(GetSystem());
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChBody> RoadTrain::GetWheelBody(int wheel) const
+{
+  if (wheel < m_first_wheel[1])
+    return m_vehicle->GetWheelBody(wheel);
+
+  int unit = 1;
+  while (wheel >= m_first_wheel[unit + 1])
+    unit++;
+
+  return m_trailers[unit - 1]->GetWheelBody(wheel - m_first_wheel[unit]);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool RoadTrain::CreateTires(const ChTerrain&                    terrain,
+                            std::vector<ChSharedPtr<ChTire> >&  tires)
+{
+  tires.clear();
+
+  std::vector<ChSharedPtr<ChTire> > created;
+  if (!m_vehicle->CreateTires(terrain, created))
+    return false;
+
+  for (size_t i = 0; i < m_trailers.size(); i++) {
+    std::vector<ChSharedPtr<ChTire> > unit_tires;
+    if (!m_trailers[i]->CreateTires(terrain, unit_tires))
+      return false;
+    created.insert(created.end(), unit_tires.begin(), unit_tires.end());
+  }
+
+  tires.swap(created);
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool RoadTrain::SetTires(const std::vector<ChSharedPtr<ChTire> >& tires,
+                         bool                                     batching)
+{
+  if ((int)tires.size() != GetNumWheels()) {
+    GetLog() << "ERROR: road train with " << GetNumWheels() << " wheels given "
+             << (int)tires.size() << " tires\n";
+    return false;
+  }
+
+  m_tires = tires;
+  m_batched.assign(tires.size(), 0);
+  m_pacejka_batch = ChSharedPtr<ChPacejkaTireBatch>();
+  m_lugre_batch = ChSharedPtr<ChLugreTireBatch>();
+
+  if (!batching)
+    return true;
+
+  m_pacejka_batch = ChSharedPtr<ChPacejkaTireBatch>(new ChPacejkaTireBatch);
+  m_lugre_batch = ChSharedPtr<ChLugreTireBatch>(new ChLugreTireBatch);
+
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    if (ChSharedPtr<ChPacejkaTire> tire = m_tires[i].DynamicCastTo<ChPacejkaTire>()) {
+      m_batched[i] = (m_pacejka_batch->AddTire(tire) >= 0);
+    }
+    else if (ChSharedPtr<ChLugreTire> tire = m_tires[i].DynamicCastTo<ChLugreTire>()) {
+      m_lugre_batch->AddTire(tire);
+      m_batched[i] = 1;
+    }
+  }
+
+  return true;
+}
+
+int RoadTrain::GetNumBatchedTires() const
+{
+  int num = 0;
+  if (!m_pacejka_batch.IsNull())
+    num += m_pacejka_batch->GetNumTires();
+  if (!m_lugre_batch.IsNull())
+    num += m_lugre_batch->GetNumTires();
+  return num;
+}
+
+
+// -----------------------------------------------------------------------------
+// The per-unit states and forces are exchanged through the unit wheel banks.
+// -----------------------------------------------------------------------------
+void RoadTrain::GetWheelStates(std::vector<ChWheelState>& states) const
+{
+  states.resize(GetNumWheels());
+
+  ChWheelStates unit_states;
+  m_vehicle->GetWheelStates(unit_states);
+  for (int j = 0; j < (int)unit_states.size(); j++)
+    states[j] = unit_states[j];
+
+  for (size_t i = 0; i < m_trailers.size(); i++) {
+    m_trailers[i]->GetWheelStates(unit_states);
+    int first = m_first_wheel[i + 1];
+    for (int j = 0; j < (int)unit_states.size(); j++)
+      states[first + j] = unit_states[j];
+  }
+}
+
+void RoadTrain::Update(double                           time,
+                       double                           steering,
+                       double                           braking,
+                       double                           powertrain_torque,
+                       const std::vector<ChTireForce>&  tire_forces)
+{
+  assert((int)tire_forces.size() == GetNumWheels());
+
+  ChTireForces unit_forces(m_first_wheel[1]);
+  for (int j = 0; j < m_first_wheel[1]; j++)
+    unit_forces[j] = tire_forces[j];
+  m_vehicle->Update(time, steering, braking, powertrain_torque, unit_forces);
+
+  for (size_t i = 0; i < m_trailers.size(); i++) {
+    int first = m_first_wheel[i + 1];
+    unit_forces.resize(m_first_wheel[i + 2] - first);
+    for (int j = 0; j < (int)unit_forces.size(); j++)
+      unit_forces[j] = tire_forces[first + j];
+    m_trailers[i]->Update(time, braking, unit_forces);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Same sequence of module updates as in the single vehicle loop (see
+// ChVehicleSimulation), with the tires of all units in one set of buffers.
+// -----------------------------------------------------------------------------
+void RoadTrain::DoStep(double  time,
+                       double  step,
+                       double  steering,
+                       double  braking,
+                       double  powertrain_torque)
+{
+  assert(m_tires.size() == m_tire_forces.size());
+
+  // Collect output data from the tires and the wheels of all units.
+  for (size_t i = 0; i < m_tires.size(); i++)
+    m_tire_forces[i] = m_tires[i]->GetTireForce();
+  GetWheelStates(m_wheel_states);
+
+  // Update the tires and all units.
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    CH_PROFILE_SCOPE("ChTire::Update");
+    m_tires[i]->Update(time, m_wheel_states[i]);
+  }
+  {
+    CH_PROFILE_SCOPE("RoadTrain::Update");
+    Update(time, steering, braking, powertrain_torque, m_tire_forces);
+  }
+
+  // Advance the batched tires, the other tires and all units.
+  if (!m_pacejka_batch.IsNull() && m_pacejka_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChPacejkaTireBatch::Advance");
+    m_pacejka_batch->Advance(step);
+  }
+  if (!m_lugre_batch.IsNull() && m_lugre_batch->GetNumTires() > 0) {
+    CH_PROFILE_SCOPE("ChLugreTireBatch::Advance");
+    m_lugre_batch->Advance(step);
+  }
+  for (size_t i = 0; i < m_tires.size(); i++) {
+    if (!m_batched[i]) {
+      CH_PROFILE_SCOPE("ChTire::Advance");
+      m_tires[i]->Advance(step);
+    }
+  }
+
+  Advance(step);
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,169 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Multi-unit vehicle (road train) constructed from a JSON specification file.
+//
+// A road train is a pulling vehicle (a Vehicle specification file) followed by
+// any number of trailers (Trailer specification files), each connected to the
+// previous unit at its hitch point. All units share the Chrono system of the
+// pulling vehicle.
+//
+// The wheels of all units are numbered consecutively, unit by unit (the wheels
+// of the pulling vehicle first) and in wheel ID order within each unit. The
+// wheel states and tire forces of all units are exchanged in single buffers
+// with this numbering. If tires are attached to the road train (SetTires()),
+// DoStep() updates and advances all tires and all units in one call; the
+// Pacejka and LuGre tires of all units are then advanced by one
+// ChPacejkaTireBatch and one ChLugreTireBatch.
+//
+// =============================================================================
+
+#ifndef ROADTRAIN_H
+#define ROADTRAIN_H
+
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/vehicle/Vehicle.h"
+#include "subsys/vehicle/Trailer.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/tire/ChLugreTireBatch.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API RoadTrain : public ChShared
+{
+public:
+
+  RoadTrain(const std::string& filename);
+
+  RoadTrain(ChSystem*          system,
+            const std::string& filename);
+
+  ~RoadTrain() {}
+
+  /// Get a pointer to the Chrono system shared by all units.
+  ChSystem* GetSystem() { return m_vehicle->GetSystem(); }
+
+  /// Get a handle to the pulling vehicle.
+  ChSharedPtr<Vehicle> GetVehicle() const { return m_vehicle; }
+
+  /// Get the number of trailers.
+  int GetNumTrailers() const { return (int)m_trailers.size(); }
+
+  /// Get a handle to the specified trailer (counted from the pulling vehicle).
+  ChSharedPtr<Trailer> GetTrailer(int index) const { return m_trailers[index]; }
+
+  /// Get the total number of wheels of all units.
+  int GetNumWheels() const { return m_first_wheel.back(); }
+
+  /// Get the index of the first wheel of the specified unit (0 for the pulling
+  /// vehicle, 1 + i for the i-th trailer).
+  int GetFirstWheel(int unit) const { return m_first_wheel[unit]; }
+
+  /// Get a handle to the body of the specified wheel.
+  ChSharedPtr<ChBody> GetWheelBody(int wheel) const;
+
+  /// Initialize the road train with the chassis reference frame of the pulling
+  /// vehicle at the specified global location and orientation. The trailers
+  /// are initialized in line behind it, with the same orientation. The body
+  /// and link lists of the shared system are then grouped unit by unit (see
+  /// ChSystemOrdering).
+  void Initialize(
+    const ChCoordsys<>& chassisPos  ///< [in] initial global position and orientation
+    );
+
+  /// Create and initialize the tires listed in the specification files of all
+  /// units, over the specified terrain. Must be called after Initialize().
+  /// Returns false (with no tires) if a unit does not list its tires or a tire
+  /// file is invalid.
+  bool CreateTires(
+    const ChTerrain&                    terrain,   ///< [in] terrain for the tires
+    std::vector<ChSharedPtr<ChTire> >&  tires      ///< [out] tires, one per wheel
+    );
+
+  /// Attach the specified tires, one per wheel, for use in DoStep(). If
+  /// batching is enabled (default), the Pacejka and LuGre tires are put in
+  /// batches. Returns false if the number of tires does not match the number
+  /// of wheels.
+  bool SetTires(
+    const std::vector<ChSharedPtr<ChTire> >& tires,     ///< [in] tires, one per wheel
+    bool                                     batching = true
+    );
+
+  /// Get the states of all wheels, in road train wheel order.
+  void GetWheelStates(
+    std::vector<ChWheelState>& states   ///< [out] wheel states, one per wheel
+    ) const;
+
+  /// Update the state of all units at the current time, with the driver inputs
+  /// (steering for the pulling vehicle, braking for all units), the torque
+  /// from the powertrain and the tire forces in road train wheel order.
+  void Update(
+    double                           time,               ///< [in] current time
+    double                           steering,           ///< [in] current steering input [-1,+1]
+    double                           braking,            ///< [in] current braking input [0,1]
+    double                           powertrain_torque,  ///< [in] input torque from powertrain
+    const std::vector<ChTireForce>&  tire_forces         ///< [in] tire forces, one per wheel
+    );
+
+  /// Advance the state of all units by the specified time step.
+  void Advance(double step) { m_vehicle->Advance(step); }
+
+  /// Perform one step of the road train and its attached tires: collect the
+  /// tire forces and wheel states of all units, update the tires and all
+  /// units, then advance the tires (batched, if enabled) and all units.
+  /// The driver and powertrain are updated and advanced by the caller.
+  void DoStep(
+    double  time,                ///< [in] current time
+    double  step,                ///< [in] time step
+    double  steering,            ///< [in] current steering input [-1,+1]
+    double  braking,             ///< [in] current braking input [0,1]
+    double  powertrain_torque    ///< [in] input torque from powertrain
+    );
+
+  /// Get the wheel states and tire forces exchanged at the last DoStep().
+  const std::vector<ChWheelState>& GetLastWheelStates() const { return m_wheel_states; }
+  const std::vector<ChTireForce>&  GetLastTireForces() const { return m_tire_forces; }
+
+  /// Get the number of tires advanced by the Pacejka and LuGre batches.
+  int GetNumBatchedTires() const;
+
+private:
+
+  void Create(const std::string& filename);
+
+  ChSharedPtr<Vehicle>                m_vehicle;
+  std::vector<ChSharedPtr<Trailer> >  m_trailers;
+  std::vector<ChVector<> >            m_towLocations;   // hitch points on the pulling units, in their chassis frames
+
+  std::vector<int>                    m_first_wheel;    // first wheel of each unit, plus the total
+
+  std::vector<ChSharedPtr<ChTire> >   m_tires;
+  std::vector<char>                   m_batched;        // non-zero if the tire is advanced by a batch
+  ChSharedPtr<ChPacejkaTireBatch>     m_pacejka_batch;
+  ChSharedPtr<ChLugreTireBatch>       m_lugre_batch;
+
+  std::vector<ChWheelState>           m_wheel_states;
+  std::vector<ChTireForce>            m_tire_forces;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,420 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Trailer model constructed from a JSON specification file
+//
+// =============================================================================
+
+#include <cstdio>
+
+#include "assets/ChSphereShape.h"
+#include "assets/ChTriangleMeshShape.h"
+#include "core/ChLog.h"
+
+#include "subsys/vehicle/Trailer.h"
+
+#include "subsys/suspension/DoubleWishbone.h"
+#include "subsys/suspension/DoubleWishboneReduced.h"
+#include "subsys/suspension/SolidAxle.h"
+#include "subsys/suspension/MultiLink.h"
+
+#include "subsys/wheel/Wheel.h"
+#include "subsys/brake/BrakeSimple.h"
+#include "subsys/brake/BrakeThermal.h"
+#include "subsys/tire/RigidTire.h"
+#include "subsys/tire/LugreTire.h"
+#include "subsys/tire/ChPacejkaTire.h"
+
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+
+#include "rapidjson/document.h"
+
+using namespace rapidjson;
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Trailer::LoadSuspension(const std::string& filename,
+                             int                axle)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Check that the given file is a suspension specification file.
+  assert(d.HasMember("Type"));
+  std::string type = d["Type"].GetString();
+  assert(type.compare("Suspension") == 0);
+
+  // Extract the suspension type.
+  assert(d.HasMember("Template"));
+  std::string subtype = d["Template"].GetString();
+
+  // Create the suspension using the appropriate template.
+  if (subtype.compare("DoubleWishbone") == 0)
+  {
+    m_suspensions[axle] = ChSharedPtr<ChSuspension>(new DoubleWishbone(d));
+  }
+  else if (subtype.compare("DoubleWishboneReduced") == 0)
+  {
+    m_suspensions[axle] = ChSharedPtr<ChSuspension>(new DoubleWishboneReduced(d));
+  }
+  else if (subtype.compare("SolidAxle") == 0)
+  {
+    m_suspensions[axle] = ChSharedPtr<ChSuspension>(new SolidAxle(d));
+  }
+  else if (subtype.compare("MultiLink") == 0)
+  {
+    m_suspensions[axle] = ChSharedPtr<ChSuspension>(new MultiLink(d));
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Trailer::LoadWheel(const std::string& filename, int axle, int side)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Check that the given file is a wheel specification file.
+  assert(d.HasMember("Type"));
+  std::string type = d["Type"].GetString();
+  assert(type.compare("Wheel") == 0);
+
+  // Extract the wheel type.
+  assert(d.HasMember("Template"));
+  std::string subtype = d["Template"].GetString();
+
+  // Create the wheel using the appropriate template.
+  if (subtype.compare("Wheel") == 0)
+  {
+    m_wheels[2 * axle + side] = ChSharedPtr<ChWheel>(new Wheel(filename));
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Trailer::LoadBrake(const std::string& filename, int axle, int side)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Check that the given file is a brake specification file.
+  assert(d.HasMember("Type"));
+  std::string type = d["Type"].GetString();
+  assert(type.compare("Brake") == 0);
+
+  // Extract the brake type.
+  assert(d.HasMember("Template"));
+  std::string subtype = d["Template"].GetString();
+
+  // Create the brake using the appropriate template.
+  if (subtype.compare("BrakeSimple") == 0)
+  {
+    m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(new BrakeSimple(filename));
+  }
+  else if (subtype.compare("BrakeThermal") == 0)
+  {
+    // All thermal brakes of the trailer are evaluated in the same bank.
+    if (m_brake_bank.IsNull())
+      m_brake_bank = ChSharedPtr<ChBrakeBank>(new ChBrakeBank);
+
+    BrakeThermal* brake = new BrakeThermal(filename);
+    brake->SetBrakeBank(m_brake_bank);
+    m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(brake);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Same as Vehicle::LoadTire(); trailer wheels are never driven.
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChTire> Trailer::LoadTire(const std::string& filename, int wheel, const ChTerrain& terrain)
+{
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Check that the given file is a tire specification file.
+  if (!d.IsObject() || !d.HasMember("Type") || !d.HasMember("Template")) {
+    GetLog() << "ERROR: invalid tire specification file " << filename.c_str() << "\n";
+    return ChSharedPtr<ChTire>();
+  }
+  std::string type = d["Type"].GetString();
+  assert(type.compare("Tire") == 0);
+
+  // Extract the tire type.
+  std::string subtype = d["Template"].GetString();
+
+  // Create the tire using the appropriate template.
+  ChWheelID wheel_id(wheel);
+
+  if (subtype.compare("RigidTire") == 0)
+  {
+    ChSharedPtr<RigidTire> tire(new RigidTire(d, terrain));
+    tire->Initialize(GetWheelBody(wheel_id));
+    return tire;
+  }
+  else if (subtype.compare("LugreTire") == 0)
+  {
+    ChSharedPtr<LugreTire> tire(new LugreTire(d, terrain));
+    tire->Initialize();
+    return tire;
+  }
+  else if (subtype.compare("PacejkaTire") == 0)
+  {
+    assert(d.HasMember("Parameter File"));
+    char name[16];
+    sprintf(name, "T%d", wheel);
+    std::string param_file = vehicle::GetDataFile(d["Parameter File"].GetString());
+
+    ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire(name, param_file, terrain));
+    if (d.HasMember("Step Size"))
+      tire->SetStepsize(d["Step Size"].GetDouble());
+    if (d.HasMember("Low Speed Damping")) {
+      const Value& damping = d["Low Speed Damping"];
+      assert(damping.HasMember("Cx") && damping.HasMember("Cy") && damping.HasMember("Cut-off Speed"));
+      tire->SetLowSpeedDamping(damping["Cx"].GetDouble(), damping["Cy"].GetDouble(), damping["Cut-off Speed"].GetDouble());
+    }
+    if (d.HasMember("Implicit Vertical Load")) {
+      assert(d["Implicit Vertical Load"].HasMember("Wheel Mass"));
+      tire->SetImplicitVerticalLoad(true, d["Implicit Vertical Load"]["Wheel Mass"].GetDouble());
+    }
+    tire->Initialize(wheel_id.side(), false);
+    return tire;
+  }
+
+  GetLog() << "ERROR: unknown tire template " << subtype.c_str() << "\n";
+  return ChSharedPtr<ChTire>();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+Trailer::Trailer(ChSystem*          system,
+                 const std::string& filename)
+: m_system(system)
+{
+  // -------------------------------------------
+  // Open and parse the input file
+  // -------------------------------------------
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Read top-level data
+  assert(d.HasMember("Type"));
+  assert(d.HasMember("Template"));
+  assert(d.HasMember("Name"));
+
+  // -------------------------------------------
+  // Create the chassis body
+  // -------------------------------------------
+
+  m_chassis = ChSharedPtr<ChBodyAuxRef>(new ChBodyAuxRef);
+
+  ChVector<> chassisCOM = loadVector(d["Chassis"]["COM"]);
+
+  m_chassis->SetName("trailer");
+  m_chassis->SetMass(d["Chassis"]["Mass"].GetDouble());
+  m_chassis->SetFrame_COG_to_REF(ChFrame<>(chassisCOM, ChQuaternion<>(1, 0, 0, 0)));
+  m_chassis->SetInertiaXX(loadVector(d["Chassis"]["Inertia"]));
+
+  if (d.HasMember("Visualization"))
+  {
+    assert(d["Visualization"].HasMember("Mesh Filename"));
+    assert(d["Visualization"].HasMember("Mesh Name"));
+
+    vehicle::ChDeferredAssets::AddMesh(m_chassis,
+      vehicle::GetDataFile(d["Visualization"]["Mesh Filename"].GetString()),
+      d["Visualization"]["Mesh Name"].GetString());
+  }
+  else
+  {
+    ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
+    sphere->GetSphereGeometry().rad = 0.1;
+    sphere->Pos = chassisCOM;
+    vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
+  }
+
+  m_system->Add(m_chassis);
+
+  // ---------------------------------
+  // More validations of the JSON file
+  // ---------------------------------
+
+  assert(d.HasMember("Hitch Location"));
+  assert(d.HasMember("Axles"));
+  assert(d["Axles"].IsArray());
+
+  m_hitchLoc = loadVector(d["Hitch Location"]);
+
+  // Extract the number of axles.
+  m_num_axles = d["Axles"].Size();
+
+  // Resize arrays
+  m_suspensions.resize(m_num_axles);
+  m_suspLocations.resize(m_num_axles);
+  m_wheels.resize(2 * m_num_axles);
+  m_brakes.resize(2 * m_num_axles);
+
+  // ---------------------------------------------------
+  // Create the suspension, wheel, and brake subsystems.
+  // ---------------------------------------------------
+
+  for (int i = 0; i < m_num_axles; i++) {
+    // Suspension
+    std::string file_name = d["Axles"][i]["Suspension Input File"].GetString();
+    LoadSuspension(vehicle::GetDataFile(file_name), i);
+    m_suspLocations[i] = loadVector(d["Axles"][i]["Suspension Location"]);
+
+    // Left and right wheels
+    file_name = d["Axles"][i]["Left Wheel Input File"].GetString();
+    LoadWheel(vehicle::GetDataFile(file_name), i, 0);
+    file_name = d["Axles"][i]["Right Wheel Input File"].GetString();
+    LoadWheel(vehicle::GetDataFile(file_name), i, 1);
+
+    // Left and right brakes
+    file_name = d["Axles"][i]["Left Brake Input File"].GetString();
+    LoadBrake(vehicle::GetDataFile(file_name), i, 0);
+
+    file_name = d["Axles"][i]["Right Brake Input File"].GetString();
+    LoadBrake(vehicle::GetDataFile(file_name), i, 1);
+  }
+
+  // ------------------------------------------
+  // Tire input files, one per axle (optional).
+  // ------------------------------------------
+
+  bool has_tires = true;
+  for (int i = 0; i < m_num_axles; i++)
+    has_tires = has_tires && d["Axles"][i].HasMember("Tire Input File");
+
+  if (has_tires) {
+    m_tireFiles.resize(m_num_axles);
+    for (int i = 0; i < m_num_axles; i++)
+      m_tireFiles[i] = vehicle::GetDataFile(d["Axles"][i]["Tire Input File"].GetString());
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Trailer::Initialize(const ChCoordsys<>&        chassisPos,
+                         ChSharedPtr<ChBodyAuxRef>  puller)
+{
+  m_chassis->SetFrame_REF_to_abs(ChFrame<>(chassisPos));
+
+  // Connect the trailer to the pulling unit at the hitch point.
+  m_hitch = ChSharedPtr<ChLinkLockSpherical>(new ChLinkLockSpherical);
+  m_hitch->Initialize(m_chassis, puller, ChCoordsys<>(m_hitchLoc) >> chassisPos);
+  m_system->Add(m_hitch);
+
+  // Initialize the suspension, wheel, and brake subsystems.
+  for (int i = 0; i < m_num_axles; i++)
+  {
+    m_suspensions[i]->Initialize(m_chassis, m_suspLocations[i], m_chassis);
+
+    m_wheels[2 * i]->Initialize(m_suspensions[i]->GetSpindle(LEFT));
+    m_wheels[2 * i + 1]->Initialize(m_suspensions[i]->GetSpindle(RIGHT));
+
+    m_brakes[2 * i]->Initialize(m_suspensions[i]->GetRevolute(LEFT));
+    m_brakes[2 * i + 1]->Initialize(m_suspensions[i]->GetRevolute(RIGHT));
+  }
+
+  // Collect the spindles, in wheel ID order, for batched wheel states and tire
+  // forces.
+  m_wheel_bank = ChSharedPtr<ChWheelBank>(new ChWheelBank);
+  for (int i = 0; i < m_num_axles; i++) {
+    m_wheel_bank->AddWheel(m_suspensions[i]->GetSpindle(LEFT));
+    m_wheel_bank->AddWheel(m_suspensions[i]->GetSpindle(RIGHT));
+  }
+
+  // Collect the tabulated spring and shock elements for batched evaluation.
+  m_spring_bank = ChSharedPtr<ChSpringForceBank>(new ChSpringForceBank);
+  for (int i = 0; i < m_num_axles; i++)
+    m_suspensions[i]->AddSpringForceElements(*m_spring_bank.get_ptr());
+  if (m_spring_bank->GetNumElements() == 0)
+    m_spring_bank = ChSharedPtr<ChSpringForceBank>();
+  // Filter the collision pairs between vehicle bodies (default families of
+  // the vehicles, i.e. no pairs between vehicle bodies).
+  ChVehicle::SetCollisionFamily(m_chassis.get_ptr(), ChVehicle::CHASSIS_FAMILY, false, false);
+  for (int i = 0; i < m_num_axles; i++) {
+    ChVehicle::SetCollisionFamily(m_suspensions[i]->GetSpindleBody(LEFT), ChVehicle::WHEEL_FAMILY, false, false);
+    ChVehicle::SetCollisionFamily(m_suspensions[i]->GetSpindleBody(RIGHT), ChVehicle::WHEEL_FAMILY, false, false);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChBody> Trailer::GetWheelBody(const ChWheelID& wheel_id) const
+{
+  return m_suspensions[wheel_id.axle()]->GetSpindle(wheel_id.side());
+}
+
+void Trailer::GetWheelStates(ChWheelStates& states) const
+{
+  states.resize(m_wheel_bank->GetNumWheels());
+  if (states.size())
+    m_wheel_bank->GetWheelStates(&states[0]);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool Trailer::CreateTires(const ChTerrain&                    terrain,
+                          std::vector<ChSharedPtr<ChTire> >&  tires)
+{
+  tires.clear();
+
+  if (m_tireFiles.empty())
+    return false;
+
+  std::vector<ChSharedPtr<ChTire> > created(2 * m_num_axles);
+  for (int i = 0; i < 2 * m_num_axles; i++) {
+    created[i] = LoadTire(m_tireFiles[i / 2], i, terrain);
+    if (created[i].IsNull())
+      return false;
+  }
+
+  tires.swap(created);
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Trailer::Update(double              time,
+                     double              braking,
+                     const ChTireForces& tire_forces)
+{
+  // Apply tire forces to spindle bodies (all wheels in one pass) and apply
+  // braking.
+  m_wheel_bank->ApplyTireForces(tire_forces);
+
+  for (int i = 0; i < 2 * m_num_axles; i++)
+    m_brakes[i]->ApplyBrakeModulation(braking);
+
+  // Evaluate the batched brakes, if any.
+  if (!m_brake_bank.IsNull())
+    m_brake_bank->Update(time);
+
+  // Evaluate the tabulated spring and shock forces ahead of the solver.
+  if (!m_spring_bank.IsNull())
+    m_spring_bank->Update();
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,133 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Trailer model constructed from a JSON specification file.
+//
+// A trailer has a chassis, any number of axles (each with a suspension, two
+// wheels and two brakes, as in a Vehicle specification file) and no steering
+// or driveline. It is connected to the pulling unit (a vehicle or another
+// trailer) through a spherical joint at its hitch point.
+//
+// =============================================================================
+
+#ifndef TRAILER_H
+#define TRAILER_H
+
+#include "core/ChCoordsys.h"
+#include "physics/ChSystem.h"
+#include "physics/ChBodyAuxRef.h"
+#include "physics/ChLinkLock.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChSuspension.h"
+#include "subsys/ChWheel.h"
+#include "subsys/ChBrake.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/brake/ChBrakeBank.h"
+#include "subsys/suspension/ChSpringForceBank.h"
+#include "subsys/wheel/ChWheelBank.h"
+
+namespace chrono {
+
+class CH_SUBSYS_API Trailer : public ChShared
+{
+public:
+
+  Trailer(ChSystem*          system,
+          const std::string& filename);
+
+  ~Trailer() {}
+
+  int GetNumberAxles() const { return m_num_axles; }
+
+  /// Get a handle to the trailer chassis body.
+  ChSharedPtr<ChBodyAuxRef> GetChassis() const { return m_chassis; }
+
+  /// Get a handle to the suspension subsystem of the specified axle.
+  const ChSharedPtr<ChSuspension> GetSuspension(int axle) const { return m_suspensions[axle]; }
+
+  /// Get the location of the hitch point, in the trailer chassis reference
+  /// frame.
+  const ChVector<>& GetHitchLocation() const { return m_hitchLoc; }
+
+  /// Get a handle to the specified wheel body.
+  ChSharedPtr<ChBody> GetWheelBody(const ChWheelID& wheel_id) const;
+
+  /// Get the states of all wheels, in wheel ID order (see ChWheelBank).
+  void GetWheelStates(ChWheelStates& states) const;
+
+  /// Initialize this trailer at the specified global location and orientation
+  /// of its chassis reference frame, and connect it to the specified pulling
+  /// body at the hitch point.
+  void Initialize(
+    const ChCoordsys<>&        chassisPos,   ///< [in] initial global position and orientation
+    ChSharedPtr<ChBodyAuxRef>  puller        ///< [in] chassis of the pulling unit
+    );
+
+  /// Update the state of this trailer at the current time: apply the tire
+  /// forces (in wheel ID order) and the braking input [0,1].
+  void Update(
+    double              time,          ///< [in] current time
+    double              braking,       ///< [in] current braking input [0,1]
+    const ChTireForces& tire_forces    ///< [in] tire forces, one per wheel
+    );
+
+  /// Return true if the specification file lists a tire input file for each
+  /// axle ("Tire Input File").
+  bool HasTires() const { return !m_tireFiles.empty(); }
+
+  /// Create and initialize the tires listed in the specification file, over
+  /// the specified terrain, in wheel order. Must be called after Initialize().
+  /// Returns false (with no tires) if the specification file does not list
+  /// the tires or a tire file is invalid.
+  bool CreateTires(
+    const ChTerrain&                    terrain,   ///< [in] terrain for the tires
+    std::vector<ChSharedPtr<ChTire> >&  tires      ///< [out] tires, one per wheel
+    );
+
+private:
+
+  void LoadSuspension(const std::string& filename, int axle);
+  void LoadWheel(const std::string& filename, int axle, int side);
+  void LoadBrake(const std::string& filename, int axle, int side);
+  ChSharedPtr<ChTire> LoadTire(const std::string& filename, int wheel, const ChTerrain& terrain);
+
+private:
+
+  ChSystem*                m_system;
+
+  int                      m_num_axles;       // number of axles for this trailer
+
+  ChSharedPtr<ChBodyAuxRef>        m_chassis;       // handle to the chassis body
+  ChSuspensionList                 m_suspensions;   // list of handles to suspension subsystems
+  ChWheelList                      m_wheels;        // list of handles to wheel subsystems
+  ChBrakeList                      m_brakes;        // list of handles to brake subsystems
+  ChSharedPtr<ChBrakeBank>         m_brake_bank;    // batched brakes (empty if there are none)
+  ChSharedPtr<ChWheelBank>         m_wheel_bank;    // batched wheel states and tire forces
+  ChSharedPtr<ChSpringForceBank>   m_spring_bank;   // batched tabulated spring and shock elements (empty if there are none)
+  ChSharedPtr<ChLinkLockSpherical> m_hitch;         // joint to the pulling unit
+
+  std::vector<ChVector<> > m_suspLocations;   // locations of the suspensions relative to chassis
+  ChVector<>               m_hitchLoc;        // location of the hitch point relative to chassis
+
+  std::vector<std::string> m_tireFiles;       // tire input files, one per axle (empty if not specified)
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -16,6 +16,7 @@
 //
 // =============================================================================
 
+#include <algorithm>
 #include <cstdio>
 
 #include "assets/ChSphereShape.h"
@@ -23,6 +24,7 @@
 #include "assets/ChTriangleMeshShape.h"
 #include "assets/ChTexture.h"
 #include "assets/ChColorAsset.h"
+#include "core/ChLog.h"
 #include "physics/ChGlobal.h"
 
 #include "subsys/vehicle/Vehicle.h"
@@ -38,51 +40,34 @@
 #include "subsys/driveline/ShaftsDriveline2WD.h"
 #include "subsys/driveline/ShaftsDriveline4WD.h"
 #include "subsys/driveline/SimpleDriveline.h"
+#include "subsys/driveline/AnalyticalDriveline4WD.h"
 #include "subsys/wheel/Wheel.h"
 #include "subsys/brake/BrakeSimple.h"
+#include "subsys/brake/BrakeThermal.h"
+#include "subsys/tire/RigidTire.h"
+#include "subsys/tire/LugreTire.h"
+#include "subsys/tire/ChPacejkaTire.h"
 
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
+#include "subsys/ChStartupProfiler.h"
 
 #include "rapidjson/document.h"
-#include "rapidjson/filereadstream.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// These utility functions return a ChVector and a ChQuaternion<>, respectively,
-// from the specified JSON array.
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
-static ChQuaternion<> loadQuaternion(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 4);
-  return ChQuaternion<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble(), a[3u].GetDouble());
-}
-
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void Vehicle::LoadSteering(const std::string& filename)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
+  CH_STARTUP_SCOPE("Vehicle::LoadSteering");
 
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a steering specification file.
   assert(d.HasMember("Type"));
@@ -110,15 +95,9 @@ void Vehicle::LoadSteering(const std::string& filename)
 // -----------------------------------------------------------------------------
 void Vehicle::LoadDriveline(const std::string& filename)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
+  CH_STARTUP_SCOPE("Vehicle::LoadDriveline");
 
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a driveline specification file.
   assert(d.HasMember("Type"));
@@ -141,6 +120,9 @@ void Vehicle::LoadDriveline(const std::string& filename)
   else if (subtype.compare("SimpleDriveline") == 0) {
     m_driveline = ChSharedPtr<ChDriveline>(new SimpleDriveline(d));
   }
+  else if (subtype.compare("AnalyticalDriveline4WD") == 0) {
+    m_driveline = ChSharedPtr<ChDriveline>(new AnalyticalDriveline4WD(d));
+  }
 }
 
 
@@ -149,15 +131,9 @@ void Vehicle::LoadDriveline(const std::string& filename)
 void Vehicle::LoadSuspension(const std::string& filename,
                              int                axle)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
+  CH_STARTUP_SCOPE("Vehicle::LoadSuspension");
 
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a suspension specification file.
   assert(d.HasMember("Type"));
@@ -192,15 +168,9 @@ void Vehicle::LoadSuspension(const std::string& filename,
 // -----------------------------------------------------------------------------
 void Vehicle::LoadWheel(const std::string& filename, int axle, int side)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
+  CH_STARTUP_SCOPE("Vehicle::LoadWheel");
 
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a wheel specification file.
   assert(d.HasMember("Type"));
@@ -223,15 +193,9 @@ void Vehicle::LoadWheel(const std::string& filename, int axle, int side)
 // -----------------------------------------------------------------------------
 void Vehicle::LoadBrake(const std::string& filename, int axle, int side)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
+  CH_STARTUP_SCOPE("Vehicle::LoadBrake");
 
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   // Check that the given file is a wheel specification file.
   assert(d.HasMember("Type"));
@@ -247,6 +211,82 @@ void Vehicle::LoadBrake(const std::string& filename, int axle, int side)
   {
     m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(new BrakeSimple(filename));
   }
+  else if (subtype.compare("BrakeThermal") == 0)
+  {
+    // All thermal brakes of the vehicle are evaluated in the same bank.
+    if (m_brake_bank.IsNull())
+      m_brake_bank = ChSharedPtr<ChBrakeBank>(new ChBrakeBank);
+
+    BrakeThermal* brake = new BrakeThermal(filename);
+    brake->SetBrakeBank(m_brake_bank);
+    m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(brake);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// A Pacejka tire specification file references the tire parameter file (in the
+// Pacejka .tir format) and, optionally, the integration step size and the
+// Besselink low speed damping of the transient slips.
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChTire> Vehicle::LoadTire(const std::string& filename, int wheel, const ChTerrain& terrain)
+{
+  CH_STARTUP_SCOPE("Vehicle::LoadTire");
+
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+
+  // Check that the given file is a tire specification file.
+  if (!d.IsObject() || !d.HasMember("Type") || !d.HasMember("Template")) {
+    GetLog() << "ERROR: invalid tire specification file " << filename.c_str() << "\n";
+    return ChSharedPtr<ChTire>();
+  }
+  std::string type = d["Type"].GetString();
+  assert(type.compare("Tire") == 0);
+
+  // Extract the tire type.
+  std::string subtype = d["Template"].GetString();
+
+  // Create the tire using the appropriate template.
+  ChWheelID wheel_id(wheel);
+
+  if (subtype.compare("RigidTire") == 0)
+  {
+    ChSharedPtr<RigidTire> tire(new RigidTire(d, terrain));
+    tire->Initialize(GetWheelBody(wheel_id));
+    return tire;
+  }
+  else if (subtype.compare("LugreTire") == 0)
+  {
+    ChSharedPtr<LugreTire> tire(new LugreTire(d, terrain));
+    tire->Initialize();
+    return tire;
+  }
+  else if (subtype.compare("PacejkaTire") == 0)
+  {
+    assert(d.HasMember("Parameter File"));
+    char name[16];
+    sprintf(name, "W%d", wheel);
+    std::string param_file = vehicle::GetDataFile(d["Parameter File"].GetString());
+    bool driven = std::find(m_driven_susp.begin(), m_driven_susp.end(), wheel_id.axle()) != m_driven_susp.end();
+
+    ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire(name, param_file, terrain));
+    if (d.HasMember("Step Size"))
+      tire->SetStepsize(d["Step Size"].GetDouble());
+    if (d.HasMember("Low Speed Damping")) {
+      const Value& damping = d["Low Speed Damping"];
+      assert(damping.HasMember("Cx") && damping.HasMember("Cy") && damping.HasMember("Cut-off Speed"));
+      tire->SetLowSpeedDamping(damping["Cx"].GetDouble(), damping["Cy"].GetDouble(), damping["Cut-off Speed"].GetDouble());
+    }
+    if (d.HasMember("Implicit Vertical Load")) {
+      assert(d["Implicit Vertical Load"].HasMember("Wheel Mass"));
+      tire->SetImplicitVerticalLoad(true, d["Implicit Vertical Load"]["Wheel Mass"].GetDouble());
+    }
+    tire->Initialize(wheel_id.side(), driven);
+    return tire;
+  }
+
+  GetLog() << "ERROR: unknown tire template " << subtype.c_str() << "\n";
+  return ChSharedPtr<ChTire>();
 }
 
 
@@ -271,24 +311,33 @@ Vehicle::Vehicle(ChSystem*          system,
 // -----------------------------------------------------------------------------
 void Vehicle::Create(const std::string& filename)
 {
+  CH_STARTUP_SCOPE("Vehicle::Create");
+
   // -------------------------------------------
   // Open and parse the input file
   // -------------------------------------------
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
+  m_filename = filename;
 
   // Read top-level data
   assert(d.HasMember("Type"));
   assert(d.HasMember("Template"));
   assert(d.HasMember("Name"));
 
+  // -------------------------------------------
+  // Solver settings (optional)
+  // -------------------------------------------
+
+  if (d.HasMember("Solver")) {
+    ChSolverProfile profile;
+    if (loadSolverProfile(d["Solver"], profile))
+      SetSolverProfile(profile);
+    else
+      GetLog() << "ERROR: invalid solver settings in " << filename.c_str() << "\n";
+    if (d["Solver"].IsObject() && d["Solver"].HasMember("Direct If Contact Free"))
+      EnableDirectSolver(d["Solver"]["Direct If Contact Free"].GetBool());
+  }
+
   // -------------------------------------------
   // Create the chassis body
   // -------------------------------------------
@@ -313,13 +362,7 @@ void Vehicle::Create(const std::string& filename)
     m_chassisMeshFile = d["Visualization"]["Mesh Filename"].GetString();
     m_chassisMeshName = d["Visualization"]["Mesh Name"].GetString();
 
-    geometry::ChTriangleMeshConnected trimesh;
-    trimesh.LoadWavefrontMesh(vehicle::GetDataFile(m_chassisMeshFile), false, false);
-
-    ChSharedPtr<ChTriangleMeshShape> trimesh_shape(new ChTriangleMeshShape);
-    trimesh_shape->SetMesh(trimesh);
-    trimesh_shape->SetName(m_chassisMeshName);
-    m_chassis->AddAsset(trimesh_shape);
+    vehicle::ChDeferredAssets::AddMesh(m_chassis, vehicle::GetDataFile(m_chassisMeshFile), m_chassisMeshName);
 
     m_chassisUseMesh = true;
   }
@@ -328,7 +371,7 @@ void Vehicle::Create(const std::string& filename)
     ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
     sphere->GetSphereGeometry().rad = 0.1;
     sphere->Pos = m_chassisCOM;
-    m_chassis->AddAsset(sphere);
+    vehicle::ChDeferredAssets::AddAsset(m_chassis, sphere);
   }
 
   m_system->Add(m_chassis);
@@ -350,6 +393,8 @@ void Vehicle::Create(const std::string& filename)
   m_suspLocations.resize(m_num_axles);
   m_wheels.resize(2 * m_num_axles);
   m_brakes.resize(2 * m_num_axles);
+  m_suspFiles.resize(m_num_axles);
+  m_brakeFiles.resize(2 * m_num_axles);
 
   // -----------------------------
   // Create the steering subsystem
@@ -386,7 +431,8 @@ void Vehicle::Create(const std::string& filename)
   for (int i = 0; i < m_num_axles; i++) {
     // Suspension
     std::string file_name = d["Axles"][i]["Suspension Input File"].GetString();
-    LoadSuspension(vehicle::GetDataFile(file_name), i);
+    m_suspFiles[i] = vehicle::GetDataFile(file_name);
+    LoadSuspension(m_suspFiles[i], i);
     m_suspLocations[i] = loadVector(d["Axles"][i]["Suspension Location"]);
 
     // Left and right wheels
@@ -397,10 +443,27 @@ void Vehicle::Create(const std::string& filename)
 
     // Left and right brakes
     file_name = d["Axles"][i]["Left Brake Input File"].GetString();
-    LoadBrake(vehicle::GetDataFile(file_name), i, 0);
+    m_brakeFiles[2 * i] = vehicle::GetDataFile(file_name);
+    LoadBrake(m_brakeFiles[2 * i], i, 0);
 
     file_name = d["Axles"][i]["Right Brake Input File"].GetString();
-    LoadBrake(vehicle::GetDataFile(file_name), i, 1);
+    m_brakeFiles[2 * i + 1] = vehicle::GetDataFile(file_name);
+    LoadBrake(m_brakeFiles[2 * i + 1], i, 1);
+  }
+
+  // ------------------------------------------------------------------
+  // Tire input files, one per axle (optional; see CreateTires()). Tires
+  // are created only on request, as they require a terrain.
+  // ------------------------------------------------------------------
+
+  bool has_tires = true;
+  for (int i = 0; i < m_num_axles; i++)
+    has_tires = has_tires && d["Axles"][i].HasMember("Tire Input File");
+
+  if (has_tires) {
+    m_tireFiles.resize(m_num_axles);
+    for (int i = 0; i < m_num_axles; i++)
+      m_tireFiles[i] = vehicle::GetDataFile(d["Axles"][i]["Tire Input File"].GetString());
   }
 
   // -----------------------
@@ -416,6 +479,8 @@ void Vehicle::Create(const std::string& filename)
 // -----------------------------------------------------------------------------
 void Vehicle::Initialize(const ChCoordsys<>& chassisPos)
 {
+  CH_STARTUP_SCOPE("Vehicle::Initialize");
+
   m_chassis->SetFrame_REF_to_abs(ChFrame<>(chassisPos));
 
   // Initialize the steering subsystem.
@@ -438,6 +503,89 @@ void Vehicle::Initialize(const ChCoordsys<>& chassisPos)
 
   // Initialize the driveline
   m_driveline->Initialize(m_chassis, m_suspensions, m_driven_susp);
+
+  // Collect the spindles, in wheel ID order, for batched wheel states and tire
+  // forces.
+  m_wheel_bank = ChSharedPtr<ChWheelBank>(new ChWheelBank);
+  for (int i = 0; i < m_num_axles; i++) {
+    m_wheel_bank->AddWheel(m_suspensions[i]->GetSpindle(LEFT));
+    m_wheel_bank->AddWheel(m_suspensions[i]->GetSpindle(RIGHT));
+  }
+
+  // Collect the tabulated spring and shock elements for batched evaluation.
+  m_spring_bank = ChSharedPtr<ChSpringForceBank>(new ChSpringForceBank);
+  for (int i = 0; i < m_num_axles; i++)
+    m_suspensions[i]->AddSpringForceElements(*m_spring_bank.get_ptr());
+  if (m_spring_bank->GetNumElements() == 0)
+    m_spring_bank = ChSharedPtr<ChSpringForceBank>();
+  // Filter the collision pairs between vehicle bodies
+  InitializeCollisionFamilies();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool Vehicle::CreateTires(const ChTerrain&                    terrain,
+                          std::vector<ChSharedPtr<ChTire> >&  tires)
+{
+  CH_STARTUP_SCOPE("Vehicle::CreateTires");
+
+  tires.clear();
+
+  if (m_tireFiles.empty())
+    return false;
+
+  std::vector<ChSharedPtr<ChTire> > created(2 * m_num_axles);
+  for (int i = 0; i < 2 * m_num_axles; i++) {
+    created[i] = LoadTire(m_tireFiles[i / 2], i, terrain);
+    if (created[i].IsNull())
+      return false;
+  }
+
+  tires.swap(created);
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Only the subsystems built from a reloadable template are watched (e.g. not a
+// thermal brake or a Pacejka tire).
+// -----------------------------------------------------------------------------
+void Vehicle::AddHotReload(vehicle::ChHotReload&                     reload,
+                           const std::vector<ChSharedPtr<ChTire> >&  tires)
+{
+  reload.Add(m_filename, this);
+
+  for (int i = 0; i < m_num_axles; i++) {
+    if (vehicle::ChReloadable* susp = dynamic_cast<vehicle::ChReloadable*>(m_suspensions[i].get_ptr()))
+      reload.Add(m_suspFiles[i], susp);
+  }
+
+  for (int i = 0; i < 2 * m_num_axles; i++) {
+    if (vehicle::ChReloadable* brake = dynamic_cast<vehicle::ChReloadable*>(m_brakes[i].get_ptr()))
+      reload.Add(m_brakeFiles[i], brake);
+  }
+
+  if (m_tireFiles.empty())
+    return;
+
+  for (size_t i = 0; i < tires.size() && i < 2 * m_tireFiles.size(); i++) {
+    if (vehicle::ChReloadable* tire = dynamic_cast<vehicle::ChReloadable*>(tires[i].get_ptr()))
+      reload.Add(m_tireFiles[i / 2], tire);
+  }
+}
+
+bool Vehicle::Reload(const rapidjson::Document& d)
+{
+  if (loadVector(d["Chassis"]["COM"]) != m_chassisCOM)
+    return false;
+
+  m_chassisMass = d["Chassis"]["Mass"].GetDouble();
+  m_chassisInertia = loadVector(d["Chassis"]["Inertia"]);
+  m_chassis->SetMass(m_chassisMass);
+  m_chassis->SetInertiaXX(m_chassisInertia);
+
+  return true;
 }
 
 
@@ -455,14 +603,20 @@ void Vehicle::Update(double              time,
   // Let the steering subsystem process the steering input.
   m_steering->Update(time, steering);
 
-  // Apply tire forces to spindle bodies and apply braking.
-  for (int i = 0; i < m_num_axles; i++) {
-    m_suspensions[i]->ApplyTireForce(LEFT, tire_forces[2 * i]);
-    m_suspensions[i]->ApplyTireForce(RIGHT, tire_forces[2 * i + 1]);
+  // Apply tire forces to spindle bodies (all wheels in one pass) and apply
+  // braking.
+  m_wheel_bank->ApplyTireForces(tire_forces);
 
-    m_brakes[2 * i]->ApplyBrakeModulation(braking);
-    m_brakes[2 * i + 1]->ApplyBrakeModulation(braking);
-  }
+  for (int i = 0; i < 2 * m_num_axles; i++)
+    m_brakes[i]->ApplyBrakeModulation(braking);
+
+  // Evaluate the batched brakes, if any.
+  if (!m_brake_bank.IsNull())
+    m_brake_bank->Update(time);
+
+  // Evaluate the tabulated spring and shock forces ahead of the solver.
+  if (!m_spring_bank.IsNull())
+    m_spring_bank->Update();
 }
 
 
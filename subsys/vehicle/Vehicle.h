@@ -22,11 +22,14 @@
 #include "core/ChCoordsys.h"
 #include "physics/ChSystem.h"
 
+#include "subsys/ChHotReload.h"
 #include "subsys/ChVehicle.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChTerrain.h"
 
 namespace chrono {
 
-class CH_SUBSYS_API Vehicle : public ChVehicle
+class CH_SUBSYS_API Vehicle : public ChVehicle, public vehicle::ChReloadable
 {
 public:
 
@@ -48,6 +51,32 @@ public:
                       double              powertrain_torque,
                       const ChTireForces& tire_forces);
 
+  /// Return true if the specification file lists a tire input file for each
+  /// axle ("Tire Input File").
+  bool HasTires() const { return !m_tireFiles.empty(); }
+
+  /// Create and initialize the tires listed in the specification file, over
+  /// the specified terrain, in wheel order (see ChWheelID). Must be called
+  /// after Initialize(). Returns false (with no tires) if the specification
+  /// file does not list the tires or a tire file is invalid.
+  bool CreateTires(
+    const ChTerrain&                    terrain,   ///< [in] terrain for the tires
+    std::vector<ChSharedPtr<ChTire> >&  tires      ///< [out] tires, one per wheel
+    );
+
+  /// Watch the specification files of the vehicle (chassis), of its
+  /// suspensions and brakes, and of the specified tires (as created by
+  /// CreateTires()) with the specified hot reload watcher.
+  void AddHotReload(
+    vehicle::ChHotReload&                     reload,   ///< [in,out] watcher
+    const std::vector<ChSharedPtr<ChTire> >&  tires = std::vector<ChSharedPtr<ChTire> >()   ///< [in] tires, one per wheel
+    );
+
+  /// Apply the chassis mass and inertia of the specified document in place
+  /// (see ChHotReload). Returns false, with no change, if the chassis COM
+  /// changed. The subsystem files are reloaded separately.
+  virtual bool Reload(const rapidjson::Document& d);
+
   bool UseVisualizationMesh() const          { return m_chassisUseMesh; }
   const std::string& GetMeshFilename() const { return m_chassisMeshFile; }
   const std::string& GetMeshName() const     { return m_chassisMeshName; }
@@ -61,6 +90,7 @@ private:
   void LoadSuspension(const std::string& filename, int axle);
   void LoadWheel(const std::string& filename, int axle, int side);
   void LoadBrake(const std::string& filename, int axle, int side);
+  ChSharedPtr<ChTire> LoadTire(const std::string& filename, int wheel, const ChTerrain& terrain);
 
 private:
 
@@ -74,6 +104,12 @@ private:
 
   std::vector<int>         m_driven_susp;     // indexes of the driven suspensions
 
+  std::vector<std::string> m_tireFiles;       // tire input files, one per axle (empty if not specified)
+
+  std::string              m_filename;        // vehicle specification file
+  std::vector<std::string> m_suspFiles;       // suspension input files, one per axle
+  std::vector<std::string> m_brakeFiles;      // brake input files, one per wheel
+
   bool        m_chassisUseMesh;               // true if using a mesh for chassis visualization
   std::string m_chassisMeshName;              // name of the chassis visualization mesh
   std::string m_chassisMeshFile;              // name of the Waveform file with the chassis mesh
@@ -0,0 +1,87 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched wheel states and tire force application.
+//
+// =============================================================================
+
+#include <cassert>
+
+#include "subsys/wheel/ChWheelBank.h"
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChWheelBank::AddWheel(ChSharedPtr<ChBody> spindle)
+{
+  int index = (int)m_spindles.size();
+  assert(index < CH_MAX_WHEELS);
+
+  m_spindles.resize(index + 1);
+  m_states.resize(index + 1);
+  m_spindles[index] = spindle.get_ptr();
+
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Same as ChSuspension::ApplyTireForce(), for all wheels.
+// -----------------------------------------------------------------------------
+void ChWheelBank::ApplyTireForces(const ChTireForces& tire_forces)
+{
+  assert(tire_forces.size() == m_spindles.size());
+
+  if (!m_spindles.size())
+    return;
+
+  ApplyTireForces(&tire_forces[0]);
+}
+
+void ChWheelBank::ApplyTireForces(const ChTireForce* tire_forces)
+{
+  for (int i = 0; i < (int)m_spindles.size(); i++) {
+    ChBody* spindle = m_spindles[i];
+    spindle->Empty_forces_accumulators();
+    spindle->Accumulate_force(tire_forces[i].force, tire_forces[i].point, false);
+    spindle->Accumulate_torque(tire_forces[i].moment, false);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Same as ChVehicle::GetWheelState(), for all wheels.
+// -----------------------------------------------------------------------------
+void ChWheelBank::Update()
+{
+  if (m_spindles.size())
+    GetWheelStates(&m_states[0]);
+}
+
+void ChWheelBank::GetWheelStates(ChWheelState* states) const
+{
+  for (int i = 0; i < (int)m_spindles.size(); i++) {
+    ChBody* spindle = m_spindles[i];
+    ChWheelState& state = states[i];
+
+    state.pos = spindle->GetPos();
+    state.rot = spindle->GetRot();
+    state.lin_vel = spindle->GetPos_dt();
+    state.ang_vel = spindle->GetWvel_par();
+    state.omega = state.rot.RotateBack(state.ang_vel).y;
+  }
+}
+
+
+} // end namespace chrono
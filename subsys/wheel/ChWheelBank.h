@@ -0,0 +1,88 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batched wheel states and tire force application.
+//
+// A wheel bank holds the spindle bodies of all wheels of a vehicle, in wheel ID
+// order (axle by axle, left then right), and the wheel states in contiguous
+// fixed-capacity arrays (see ChWheelArray). The tire forces of all wheels are
+// applied and the states of all wheels are collected in a single pass, instead
+// of one call through the suspension subsystem of each axle per wheel. This
+// matters for vehicles with many axles (e.g. 8x8 or 10x10 trucks).
+//
+// =============================================================================
+
+#ifndef CH_WHEELBANK_H
+#define CH_WHEELBANK_H
+
+#include "core/ChShared.h"
+#include "physics/ChBody.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+
+namespace chrono {
+
+///
+/// Batched wheels of one vehicle.
+///
+class CH_SUBSYS_API ChWheelBank : public ChShared
+{
+public:
+
+  ChWheelBank() {}
+  ~ChWheelBank() {}
+
+  /// Add the next wheel, with the specified spindle body, and return its index
+  /// in the bank (i.e. its wheel ID). At most CH_MAX_WHEELS wheels can be
+  /// added; the spindle body must outlive the bank.
+  int AddWheel(ChSharedPtr<ChBody> spindle);
+
+  /// Return the number of wheels in this bank.
+  int GetNumWheels() const { return (int)m_spindles.size(); }
+
+  /// Apply the specified tire forces (indexed by wheel ID) to the spindles.
+  /// The force accumulators of the spindle bodies are reset first.
+  void ApplyTireForces(const ChTireForces& tire_forces);
+
+  /// Apply the tire forces in the specified buffer (one entry per wheel of the
+  /// bank, indexed by wheel ID) to the spindles.
+  void ApplyTireForces(const ChTireForce* tire_forces);
+
+  /// Collect the current states of all wheels from the spindle bodies.
+  void Update();
+
+  /// Collect the current states of all wheels from the spindle bodies directly
+  /// into the specified buffer (one entry per wheel of the bank, indexed by
+  /// wheel ID), e.g. the wheel state inputs of a batch of tires. The states
+  /// returned by GetWheelStates() are not updated.
+  void GetWheelStates(ChWheelState* states) const;
+
+  /// Return the state of the specified wheel, as of the last Update().
+  const ChWheelState& GetWheelState(int index) const { return m_states[index]; }
+
+  /// Return the states of all wheels, as of the last Update().
+  const ChWheelStates& GetWheelStates() const { return m_states; }
+
+private:
+
+  ChWheelArray<ChBody*>  m_spindles;
+  ChWheelStates          m_states;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -23,40 +23,22 @@
 #include "physics/ChGlobal.h"
 
 #include "subsys/wheel/Wheel.h"
+#include "subsys/ChDeferredAssets.h"
 #include "subsys/ChVehicleModelData.h"
-
-#include "rapidjson/filereadstream.h"
+#include "subsys/ChJsonCache.h"
+#include "subsys/ChJsonUtils.h"
 
 using namespace rapidjson;
 
 namespace chrono {
 
 
-// -----------------------------------------------------------------------------
-// This utility function returns a ChVector from the specified JSON array
-// -----------------------------------------------------------------------------
-static ChVector<> loadVector(const Value& a)
-{
-  assert(a.IsArray());
-  assert(a.Size() == 3);
-
-  return ChVector<>(a[0u].GetDouble(), a[1u].GetDouble(), a[2u].GetDouble());
-}
-
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 Wheel::Wheel(const std::string& filename)
 : m_vis(NONE)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  const Document& d = vehicle::ChJsonCache::Get(filename);
 
   Create(d);
 }
@@ -109,26 +91,20 @@ void Wheel::Initialize(ChSharedBodyPtr spindle)
     cyl->GetCylinderGeometry().rad = m_radius;
     cyl->GetCylinderGeometry().p1 = ChVector<>(0, m_width / 2, 0);
     cyl->GetCylinderGeometry().p2 = ChVector<>(0, -m_width / 2, 0);
-    spindle->AddAsset(cyl);
+    vehicle::ChDeferredAssets::AddAsset(spindle, cyl);
 
     ChSharedPtr<ChTexture> tex(new ChTexture);
     tex->SetTextureFilename(GetChronoDataFile("bluwhite.png"));
-    spindle->AddAsset(tex);
+    vehicle::ChDeferredAssets::AddAsset(spindle, tex);
 
     break;
   }
   case MESH:
   {
-    geometry::ChTriangleMeshConnected trimesh;
-    trimesh.LoadWavefrontMesh(vehicle::GetDataFile(m_meshFile), false, false);
-
-    ChSharedPtr<ChTriangleMeshShape> trimesh_shape(new ChTriangleMeshShape);
-    trimesh_shape->SetMesh(trimesh);
-    trimesh_shape->SetName(m_meshName);
-    spindle->AddAsset(trimesh_shape);
+    vehicle::ChDeferredAssets::AddMesh(spindle, vehicle::GetDataFile(m_meshFile), m_meshName);
 
     ChSharedPtr<ChColorAsset> mcolor(new ChColorAsset(0.3f, 0.3f, 0.3f));
-    spindle->AddAsset(mcolor);
+    vehicle::ChDeferredAssets::AddAsset(spindle, mcolor);
 
     break;
   }
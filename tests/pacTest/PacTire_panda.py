@@ -11,6 +11,59 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib
 import pylab as py
+import struct
+import io
+
+def open_output(filename):
+    '''
+    Open an output file for reading as a binary file object, decompressing it
+    if it was written compressed (see ChCompressedFile): LZ4 frames require the
+    lz4 package, Zstandard frames the zstandard package.
+    '''
+    f = open(filename, 'rb')
+    magic = f.read(4)
+    f.seek(0)
+    if magic == b'\x04\x22\x4d\x18':
+        import lz4.frame
+        return lz4.frame.LZ4FrameFile(f, 'rb')
+    if magic == b'\x28\xb5\x2f\xfd':
+        import zstandard
+        return io.BytesIO(zstandard.ZstdDecompressor().stream_reader(f).read())
+    return f
+
+def read_output(filename):
+    '''
+    Read an output file written by a ChOutputChannel (e.g. ChPacejkaTire
+    WriteOutData, SuspensionTest WriteRecording) into a DataFrame: CSV, binary
+    (magic "CHOUT1") or Arrow IPC (magic "ARROW1", memory-mapped with pyarrow),
+    possibly compressed (see open_output).
+    '''
+    f = open_output(filename)
+    magic = f.read(8)
+    if magic[0:6] == b'ARROW1':
+        import pyarrow as pa
+        if isinstance(f, io.BufferedReader):
+            f.close()
+            return pa.ipc.open_file(pa.memory_map(filename, 'r')).read_all().to_pandas()
+        data = magic + f.read()
+        f.close()
+        return pa.ipc.open_file(pa.BufferReader(data)).read_all().to_pandas()
+    if magic[0:6] != b'CHOUT1':
+        data = magic + f.read()
+        f.close()
+        return pd.read_csv(io.BytesIO(data), header=0, sep=',')
+    ncols, hlen = struct.unpack('=II', f.read(8))
+    names = f.read(hlen).decode('ascii').split(',')
+    cols = [[] for c in range(ncols)]
+    while True:
+        buf = f.read(4)
+        if len(buf) < 4:
+            break
+        nrows = struct.unpack('=I', buf)[0]
+        for c in range(ncols):
+            cols[c].extend(struct.unpack('=%dd' % nrows, f.read(8 * nrows)))
+    f.close()
+    return pd.DataFrame(dict(zip(names, cols)), columns=names)
 
 class PacTire_panda:
     '''
@@ -30,12 +83,12 @@ class PacTire_panda:
         else:
             self._use_transient_slip = True
             self._m_filename_T = fileName_transient
-            df_T = pd.read_csv(self._m_filename_T, header=0, sep=',')   # index_col=0,
+            df_T = read_output(self._m_filename_T)
             self._m_df_T = df_T
             
         # Header Form:
         # time,kappa,alpha,gamma,kappaP,alphaP,gammaP,Vx,Vy,Fx,Fy,Fz,Mx,My,Mz,Fxc,Fyc,Mzc
-        df = pd.read_csv(self._m_filename_SS, header=0, sep=',')    # index_col=0, 
+        df = read_output(self._m_filename_SS)
         self._m_df = df
         
     
@@ -0,0 +1,254 @@
+# -*- coding: utf-8 -*-
+"""
+Train a neural network surrogate of a Pacejka tire for ChSurrogateTire.
+
+The training data is the steady-state characterization of the tire written by
+test_pacSweep (any of its output formats, see PacTire_panda.read_output); the
+tire file provides the vertical, rolling radius and low speed parameters. The
+network maps (kappa, alpha, gamma, Fz, Vx) to the load-normalized combined
+slip reactions (Fx/Fz, Fy/Fz, Mz/Fz), and is written with these parameters to
+a JSON file read by ChSurrogateTireModel. The relaxation lengths are those of
+ChPacejkaTire: the slip stiffnesses at zero slip, estimated from the sweep for
+each load, divided by its carcass stiffnesses.
+
+The sweep should cover the load and velocity ranges the tire will see, e.g.
+  test_pacSweep -Fz 2000 12000 11 -gamma -0.1 0.1 5 -Vx 5 35 4 pactest.tir
+
+Usage: python PacTire_surrogate.py SWEEP_FILE TIR_FILE OUT_JSON [options]
+  --layers N N ...   hidden layer widths (default: 32 32)
+  --activation A     tanh or relu (default: tanh)
+  --epochs N         number of training epochs (default: 200)
+  --batch N          minibatch size (default: 256)
+  --rate R           Adam learning rate (default: 2e-3)
+  --seed N           random seed (default: 0)
+
+Requires numpy (no other training framework).
+
+@author: Radu Serban
+"""
+
+import argparse
+import json
+import os
+
+import numpy as np
+
+from PacTire_panda import read_output
+
+# Carcass stiffnesses of ChPacejkaTire (N/m), used to convert the slip
+# stiffnesses into relaxation lengths.
+C_FX = 161000.0
+C_FY = 144000.0
+
+INPUTS = ['kappa', 'alpha', 'gamma', 'Fz', 'Vx']
+OUTPUTS = ['Fx', 'Fy', 'Mz']
+
+
+def read_tir(filename):
+    '''
+    Read the numeric parameters of a tire property file into a dictionary
+    (upper case keys), ignoring the section headers and the comments.
+    '''
+    params = {}
+    for line in open(filename):
+        line = line.split('$')[0].strip()
+        if '=' not in line or line.startswith('['):
+            continue
+        key, val = [s.strip() for s in line.split('=', 1)]
+        try:
+            params[key.upper()] = float(val.strip("'"))
+        except ValueError:
+            pass
+    return params
+
+
+def slope_at_zero(x, y, width):
+    '''
+    Slope of the least squares line through the points with |x| < width.
+    '''
+    sel = np.abs(x) < width
+    if np.count_nonzero(sel) < 2 or np.ptp(x[sel]) == 0:
+        return None
+    return np.polyfit(x[sel], y[sel], 1)[0]
+
+
+def relaxation_lengths(df):
+    '''
+    Relaxation lengths of ChPacejkaTire for each load of the sweep, from the
+    pure slip stiffnesses at zero slip, zero camber and the lowest velocity.
+    '''
+    Vx0 = df['Vx'].min()
+    base = df[(df['Vx'] == Vx0) & (np.abs(df['gamma']) == np.abs(df['gamma']).min())]
+
+    loads, sigma_kappa, sigma_alpha = [], [], []
+    for Fz, pts in base.groupby('Fz'):
+        a0 = pts[np.abs(pts['alpha']) == np.abs(pts['alpha']).min()]
+        k0 = pts[np.abs(pts['kappa']) == np.abs(pts['kappa']).min()]
+        C_Fkappa = slope_at_zero(a0['kappa'].values, a0['Fx_pure'].values, 0.02)
+        C_Falpha = slope_at_zero(k0['alpha'].values, k0['Fy_pure'].values, 0.02)
+        if C_Fkappa is None or C_Falpha is None:
+            continue
+        loads.append(float(Fz))
+        sigma_kappa.append(abs(C_Fkappa) / C_FX)
+        sigma_alpha.append(abs(C_Falpha) / C_FY)
+
+    if not loads:
+        raise RuntimeError('the sweep does not resolve the slip stiffnesses at zero slip')
+    return loads, sigma_kappa, sigma_alpha
+
+
+class MLP:
+    '''
+    Multilayer perceptron with tanh or ReLU hidden layers and a linear output
+    layer, trained with Adam on the mean squared error.
+    '''
+
+    def __init__(self, sizes, activation, rng):
+        self.relu = (activation == 'relu')
+        self.W = []
+        self.b = []
+        for n_in, n_out in zip(sizes[:-1], sizes[1:]):
+            gain = np.sqrt(2.0) if self.relu else 1.0
+            self.W.append(rng.standard_normal((n_out, n_in)) * gain / np.sqrt(n_in))
+            self.b.append(np.zeros(n_out))
+        self.params = self.W + self.b
+        self.m = [np.zeros_like(p) for p in self.params]
+        self.v = [np.zeros_like(p) for p in self.params]
+        self.t = 0
+
+    def act(self, z):
+        return np.maximum(z, 0) if self.relu else np.tanh(z)
+
+    def dact(self, a):
+        return (a > 0).astype(a.dtype) if self.relu else 1 - a * a
+
+    def forward(self, x):
+        acts = [x]
+        for k, (W, b) in enumerate(zip(self.W, self.b)):
+            z = acts[-1].dot(W.T) + b
+            acts.append(z if k == len(self.W) - 1 else self.act(z))
+        return acts
+
+    def predict(self, x):
+        return self.forward(x)[-1]
+
+    def step(self, x, y, rate, beta1=0.9, beta2=0.999, eps=1e-8):
+        acts = self.forward(x)
+        err = acts[-1] - y
+        delta = 2 * err / err.size
+        gW = [None] * len(self.W)
+        gb = [None] * len(self.b)
+        for k in reversed(range(len(self.W))):
+            gW[k] = delta.T.dot(acts[k])
+            gb[k] = delta.sum(axis=0)
+            if k > 0:
+                delta = delta.dot(self.W[k]) * self.dact(acts[k])
+
+        self.t += 1
+        for p, g, m, v in zip(self.params, gW + gb, self.m, self.v):
+            m *= beta1
+            m += (1 - beta1) * g
+            v *= beta2
+            v += (1 - beta2) * g * g
+            m_hat = m / (1 - beta1 ** self.t)
+            v_hat = v / (1 - beta2 ** self.t)
+            p -= rate * m_hat / (np.sqrt(v_hat) + eps)
+        return np.mean(err * err)
+
+
+def train(df, args):
+    '''
+    Train the network on the load-normalized reactions of the sweep. Returns
+    the network and the input and output normalizations.
+    '''
+    X = df[INPUTS].values.astype(float)
+    Y = df[OUTPUTS].values.astype(float) / df[['Fz']].values.astype(float)
+
+    in_min = X.min(axis=0)
+    in_max = X.max(axis=0)
+    in_offset = 0.5 * (in_min + in_max)
+    span = 0.5 * (in_max - in_min)
+    in_scale = np.where(span > 0, 1 / np.where(span > 0, span, 1), 0)
+    out_offset = Y.mean(axis=0)
+    out_std = Y.std(axis=0)
+    out_scale = np.where(out_std > 0, out_std, 1)
+
+    Xn = (X - in_offset) * in_scale
+    Yn = (Y - out_offset) / out_scale
+
+    rng = np.random.default_rng(args.seed)
+    net = MLP([len(INPUTS)] + args.layers + [len(OUTPUTS)], args.activation, rng)
+
+    n = Xn.shape[0]
+    for epoch in range(args.epochs):
+        # cosine decay of the learning rate
+        rate = args.rate * 0.5 * (1 + np.cos(np.pi * epoch / args.epochs))
+        perm = rng.permutation(n)
+        loss = 0.0
+        for first in range(0, n, args.batch):
+            idx = perm[first:first + args.batch]
+            loss += net.step(Xn[idx], Yn[idx], rate) * len(idx)
+        if epoch % 20 == 0 or epoch == args.epochs - 1:
+            print('epoch %4d  mse %.3e' % (epoch, loss / n))
+
+    # worst case errors, in N and N-m
+    F = (net.predict(Xn) * out_scale + out_offset) * df[['Fz']].values
+    err = np.abs(F - df[OUTPUTS].values)
+    for i, name in enumerate(OUTPUTS):
+        print('%s: max error %.1f, rms error %.1f' % (name, err[:, i].max(), np.sqrt(np.mean(err[:, i] ** 2))))
+
+    return net, (in_min, in_max, in_offset, in_scale), (out_offset, out_scale)
+
+
+def write_model(filename, name, tir, relax, net, in_norm, out_norm, activation):
+    layers = [{'Weights': W.tolist(), 'Biases': b.tolist()} for W, b in zip(net.W, net.b)]
+    model = {
+        'Name': name,
+        'Type': 'Tire',
+        'Template': 'SurrogateTire',
+        'Side': 'LEFT',
+        'Radius': tir['UNLOADED_RADIUS'],
+        'Vertical Stiffness': tir['VERTICAL_STIFFNESS'],
+        'Vertical Damping': tir['VERTICAL_DAMPING'],
+        'Nominal Load': tir['FNOMIN'],
+        'Minimum Load': tir.get('FZMIN', 0.0),
+        'Reference Velocity': tir['LONGVL'],
+        'Low Velocity': tir.get('VXLOW', 1.0),
+        'Rolling Radius': {'DREFF': tir['DREFF'], 'BREFF': tir['BREFF'], 'FREFF': tir['FREFF']},
+        'Relaxation Lengths': {'Fz': relax[0], 'Kappa': relax[1], 'Alpha': relax[2]},
+        'Network': {
+            'Activation': activation,
+            'Input Min': in_norm[0].tolist(),
+            'Input Max': in_norm[1].tolist(),
+            'Input Offset': in_norm[2].tolist(),
+            'Input Scale': in_norm[3].tolist(),
+            'Output Offset': out_norm[0].tolist(),
+            'Output Scale': out_norm[1].tolist(),
+            'Layers': layers
+        }
+    }
+    with open(filename, 'w') as f:
+        json.dump(model, f, indent=2)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Train a surrogate tire from a test_pacSweep output file')
+    parser.add_argument('sweep')
+    parser.add_argument('tir')
+    parser.add_argument('out')
+    parser.add_argument('--layers', type=int, nargs='+', default=[32, 32])
+    parser.add_argument('--activation', choices=['tanh', 'relu'], default='tanh')
+    parser.add_argument('--epochs', type=int, default=200)
+    parser.add_argument('--batch', type=int, default=256)
+    parser.add_argument('--rate', type=float, default=2e-3)
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    df = read_output(args.sweep)
+    tir = read_tir(args.tir)
+    relax = relaxation_lengths(df)
+    net, in_norm, out_norm = train(df, args)
+
+    name = os.path.splitext(os.path.basename(args.tir))[0] + '_surrogate'
+    write_model(args.out, name, tir, relax, net, in_norm, out_norm, args.activation)
+    print('wrote %s' % args.out)
@@ -0,0 +1,156 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Justin Madsen
+// =============================================================================
+//
+// Throughput benchmark for the batched Pacejka tire evaluation.
+//
+// Two identical sets of tires are driven through the same combined slip
+// history: the first set is advanced one tire at a time (scalar path), the
+// second through a ChPacejkaTireBatch. The program reports the time spent in
+// each path and the maximum deviation between the two sets of reactions.
+//
+// =============================================================================
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "core/ChTimer.h"
+#include "physics/ChGlobal.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "ChronoVehicle_config.h"
+
+using namespace chrono;
+using std::cout;
+using std::endl;
+
+// -----------------------------------------------------------------------------
+// Kinematic slips for the specified tire at the given time. Lanes are given
+// different phases so that the batch sees a spread of slip conditions.
+// -----------------------------------------------------------------------------
+void getSlips(int tire, double time, double& kappa, double& alpha, double& gamma)
+{
+  double phase = 0.1 * tire;
+  kappa = 0.2 * std::sin(2.0 * CH_C_PI * 0.5 * time + phase);
+  alpha = 0.15 * std::sin(2.0 * CH_C_PI * 0.25 * time + 2.0 * phase);
+  gamma = 0.02 * std::cos(2.0 * CH_C_PI * 0.1 * time + phase);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const int num_vehicles = (argc > 1) ? std::atoi(argv[1]) : 100;
+  const int num_steps = 500;
+  const double step_size = 0.01;
+  const double F_z = 8000;
+  const bool use_transient_slip = true;
+  const double tolerance = 1e-6;   // relative to the nominal wheel load
+
+  const std::string pacParamFile = vehicle::GetDataFile("hmmwv/pactest.tir");
+
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  // Flat rigid terrain, height = 0 for all (x,y)
+  FlatTerrain flat_terrain(0);
+
+  // Create two identical sets of tires, 4 per vehicle
+  const int num_tires = 4 * num_vehicles;
+  std::vector<ChSharedPtr<ChPacejkaTire> > scalar_tires(num_tires);
+  std::vector<ChSharedPtr<ChPacejkaTire> > batch_tires(num_tires);
+
+  ChPacejkaTireBatch batch;
+
+  for (int i = 0; i < num_tires; i++) {
+    ChVehicleSide side = (i % 2 == 0) ? LEFT : RIGHT;
+
+    scalar_tires[i] = ChSharedPtr<ChPacejkaTire>(new ChPacejkaTire("SCALAR", pacParamFile, flat_terrain, F_z, use_transient_slip));
+    scalar_tires[i]->Initialize(side, i % 4 >= 2);
+
+    batch_tires[i] = ChSharedPtr<ChPacejkaTire>(new ChPacejkaTire("BATCH", pacParamFile, flat_terrain, F_z, use_transient_slip));
+    batch_tires[i]->Initialize(side, i % 4 >= 2);
+
+    if (batch.AddTire(batch_tires[i]) < 0)
+      return 1;
+  }
+
+  double vel_xy = scalar_tires[0]->get_longvl();
+
+  ChTimer<double> scalar_timer;
+  ChTimer<double> batch_timer;
+  double scalar_time = 0;
+  double batch_time = 0;
+  double max_dev = 0;
+
+  double time = 0;
+
+  for (int step = 0; step < num_steps; step++) {
+    // Update all tires with the same wheel states
+    for (int i = 0; i < num_tires; i++) {
+      double kappa, alpha, gamma;
+      getSlips(i, time, kappa, alpha, gamma);
+      ChWheelState state = scalar_tires[i]->getState_from_KAG(kappa, alpha, gamma, vel_xy);
+      scalar_tires[i]->Update(time, state);
+      batch_tires[i]->Update(time, state);
+    }
+
+    // Scalar path
+    scalar_timer.reset();
+    scalar_timer.start();
+    for (int i = 0; i < num_tires; i++)
+      scalar_tires[i]->Advance(step_size);
+    scalar_timer.stop();
+    scalar_time += scalar_timer();
+
+    // Batched path
+    batch_timer.reset();
+    batch_timer.start();
+    batch.Advance(step_size);
+    batch_timer.stop();
+    batch_time += batch_timer();
+
+    // Compare the reactions
+    for (int i = 0; i < num_tires; i++) {
+      ChTireForce fs = scalar_tires[i]->GetTireForce_combinedSlip(true);
+      ChTireForce fb = batch_tires[i]->GetTireForce_combinedSlip(true);
+      double dev = std::max((fs.force - fb.force).Length(), (fs.moment - fb.moment).Length()) / F_z;
+      if (dev > max_dev)
+        max_dev = dev;
+    }
+
+    time += step_size;
+  }
+
+  double num_evals = (double)num_tires * num_steps;
+
+  cout << "Tires: " << num_tires << "   steps: " << num_steps << endl;
+  cout << "Scalar path:  " << scalar_time << " s  (" << num_evals / scalar_time << " tire evaluations/s)" << endl;
+  cout << "Batched path: " << batch_time << " s  (" << num_evals / batch_time << " tire evaluations/s)" << endl;
+  cout << "  kernel time per call: " << batch.get_average_kernel_time() << " s" << endl;
+  cout << "Speedup: " << scalar_time / batch_time << endl;
+  cout << "Max deviation (relative to Fz): " << max_dev << endl;
+
+  if (max_dev > tolerance) {
+    cout << "FAILED: batched results differ from the scalar path" << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,373 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Steady-state characterization of Pacejka tires over a grid of operating
+// points (kappa, alpha, gamma, Fz, Vx).
+//
+// Usage: test_pacSweep [options] [tir file ...]
+//   -kappa MIN MAX N   longitudinal slip range (default: -1 1 201)
+//   -alpha MIN MAX N   slip angle range, rad (default: -pi/12 pi/12 61)
+//   -gamma MIN MAX N   camber angle range, rad (default: 0 0 1)
+//   -Fz MIN MAX N      vertical load range, N (default: 8000 8000 1)
+//   -Vx MIN MAX N      forward velocity range, m/s (default: LONGVL of the
+//                      tire file)
+//   -threads N         number of worker threads (default: hardware threads)
+//   -out DIR           output directory (default: ../PACTEST)
+//   -binary            write ChOutputChannel binary files instead of CSV
+//   -arrow             write Arrow IPC files instead of CSV
+// Without tire files, hmmwv/pactest.tir is characterized.
+//
+// The tires use the kinematic (steady-state) slips, so that each grid point
+// is independent of all others. The grid is split into chunks evaluated in
+// parallel; each worker thread owns a ChPacejkaTireBatch and evaluates the
+// points of a chunk a batch at a time. The pure and combined slip reactions
+// (in the tire frame) of all points are written to one columnar file per tire
+// file, named after the tire file.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/ChFileutils.h"
+#include "core/ChTimer.h"
+#include "physics/ChGlobal.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/ChThreadPool.h"
+#include "subsys/ChColumnStore.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "ChronoVehicle_config.h"
+
+using namespace chrono;
+using std::cout;
+using std::endl;
+
+// -----------------------------------------------------------------------------
+
+// Number of lanes of the batch owned by each worker, and of grid points per task.
+static const int num_lanes = 32;
+static const int chunk_size = 32 * num_lanes;
+
+// Step passed to Advance (irrelevant with the kinematic slips)
+static const double step_size = 0.01;
+
+// Output columns
+enum Column {
+  KAPPA, ALPHA, GAMMA, FZ, VX,
+  FX, FY, MX, MY, MZ,
+  FX_PURE, FY_PURE, MZ_PURE,
+  NUM_COLUMNS
+};
+
+static const char* header = "kappa,alpha,gamma,Fz,Vx,Fx,Fy,Mx,My,Mz,Fx_pure,Fy_pure,Mz_pure";
+
+// -----------------------------------------------------------------------------
+// Range of one of the grid variables.
+// -----------------------------------------------------------------------------
+struct Range {
+  Range(double vmin, double vmax, int n) : min(vmin), max(vmax), num(n) {}
+  double value(int i) const { return (num > 1) ? min + (max - min) * i / (num - 1) : min; }
+  double min;
+  double max;
+  int    num;
+};
+
+// -----------------------------------------------------------------------------
+// Grid of operating points. The index of a point runs fastest over kappa, then
+// alpha, gamma, Fz and Vx (such that consecutive points share the same load).
+// -----------------------------------------------------------------------------
+struct Grid {
+  Grid(const Range& k, const Range& a, const Range& g, const Range& f, const Range& v)
+    : kappa(k), alpha(a), gamma(g), Fz(f), Vx(v) {}
+
+  int size() const { return kappa.num * alpha.num * gamma.num * Fz.num * Vx.num; }
+
+  void point(int index, double* values) const {
+    values[KAPPA] = kappa.value(index % kappa.num);  index /= kappa.num;
+    values[ALPHA] = alpha.value(index % alpha.num);  index /= alpha.num;
+    values[GAMMA] = gamma.value(index % gamma.num);  index /= gamma.num;
+    values[FZ] = Fz.value(index % Fz.num);           index /= Fz.num;
+    values[VX] = Vx.value(index);
+  }
+
+  Range kappa;
+  Range alpha;
+  Range gamma;
+  Range Fz;
+  Range Vx;
+};
+
+// -----------------------------------------------------------------------------
+// Tires of one worker thread, with the vertical load last set on each lane.
+// -----------------------------------------------------------------------------
+struct WorkerTires {
+  ChSharedPtr<ChPacejkaTireBatch> batch;
+  std::vector<double>             Fz;
+};
+
+// -----------------------------------------------------------------------------
+// Evaluation of a chunk of consecutive grid points.
+// The results are written directly in the output columns (different tasks
+// write different rows).
+// -----------------------------------------------------------------------------
+class SweepTask : public vehicle::ChTask
+{
+public:
+  SweepTask(const Grid& grid, int begin, int end,
+            std::vector<WorkerTires>& workers, std::vector<std::vector<double> >& columns)
+    : m_grid(grid), m_begin(begin), m_end(end), m_workers(workers), m_columns(columns) {}
+
+  virtual void Execute(int worker)
+  {
+    WorkerTires& tires = m_workers[worker];
+    double values[NUM_COLUMNS];
+
+    for (int first = m_begin; first < m_end; first += num_lanes) {
+      int n = std::min(num_lanes, m_end - first);
+
+      for (int j = 0; j < n; j++) {
+        ChSharedPtr<ChPacejkaTire> tire = tires.batch->GetTire(j);
+        m_grid.point(first + j, values);
+
+        // The rolling radius used to set the wheel spin from kappa depends on
+        // the vertical load, so a new load requires one more evaluation.
+        if (values[FZ] != tires.Fz[j]) {
+          tire->set_Fz_override(values[FZ]);
+          tire->Update(0, tire->getState_from_KAG(values[KAPPA], values[ALPHA], values[GAMMA], values[VX]));
+          tire->Advance(step_size);
+          tires.Fz[j] = values[FZ];
+        }
+
+        tire->Update(0, tire->getState_from_KAG(values[KAPPA], values[ALPHA], values[GAMMA], values[VX]));
+      }
+
+      // Unused lanes of the last block are evaluated again at their last state.
+      tires.batch->Advance(step_size);
+
+      for (int j = 0; j < n; j++) {
+        ChSharedPtr<ChPacejkaTire> tire = tires.batch->GetTire(j);
+        ChTireForce combined = tire->GetTireForce_combinedSlip(true);
+        ChTireForce pure = tire->GetTireForce_pureSlip(true);
+        size_t row = first + j;
+
+        m_grid.point(first + j, values);
+        values[FX] = combined.force.x;
+        values[FY] = combined.force.y;
+        values[MX] = combined.moment.x;
+        values[MY] = combined.moment.y;
+        values[MZ] = combined.moment.z;
+        values[FX_PURE] = pure.force.x;
+        values[FY_PURE] = pure.force.y;
+        values[MZ_PURE] = pure.moment.z;
+
+        for (int k = 0; k < NUM_COLUMNS; k++)
+          m_columns[k][row] = values[k];
+      }
+    }
+  }
+
+private:
+  const Grid&                          m_grid;
+  int                                  m_begin;
+  int                                  m_end;
+  std::vector<WorkerTires>&            m_workers;
+  std::vector<std::vector<double> >&   m_columns;
+};
+
+// -----------------------------------------------------------------------------
+// Characterize the specified tire file over the grid and write the results.
+// If the velocity range is not specified (num = 0), it is set to the reference
+// velocity of the tire file.
+// -----------------------------------------------------------------------------
+bool Characterize(const std::string& tir_file,
+                  Grid grid,
+                  vehicle::ChThreadPool& pool,
+                  const std::string& out_file,
+                  vehicle::ChOutputChannel::Format format)
+{
+  FlatTerrain flat_terrain(0);
+
+  // One batch of tires per worker thread (created here, such that the tire
+  // files are read once, from the main thread).
+  std::vector<WorkerTires> workers(pool.GetNumThreads());
+
+  for (size_t w = 0; w < workers.size(); w++) {
+    workers[w].batch = ChSharedPtr<ChPacejkaTireBatch>(new ChPacejkaTireBatch);
+    workers[w].Fz.assign(num_lanes, -1.0);
+
+    for (int j = 0; j < num_lanes; j++) {
+      ChSharedPtr<ChPacejkaTire> tire(new ChPacejkaTire("SWEEP", tir_file, flat_terrain, grid.Fz.min, false));
+      tire->Initialize(LEFT, true);
+      if (workers[w].batch->AddTire(tire) < 0)
+        return false;
+    }
+  }
+
+  if (grid.Vx.num == 0) {
+    double longvl = workers[0].batch->GetTire(0)->get_longvl();
+    grid.Vx = Range(longvl, longvl, 1);
+  }
+
+  int num_points = grid.size();
+  std::vector<std::vector<double> > columns(NUM_COLUMNS, std::vector<double>(num_points));
+
+  ChTimer<double> timer;
+  timer.start();
+
+  std::vector<SweepTask*> tasks;
+  for (int begin = 0; begin < num_points; begin += chunk_size) {
+    tasks.push_back(new SweepTask(grid, begin, std::min(begin + chunk_size, num_points), workers, columns));
+    pool.Submit(tasks.back());
+  }
+  pool.Wait();
+
+  timer.stop();
+
+  for (size_t i = 0; i < tasks.size(); i++)
+    delete tasks[i];
+
+  // Columnar output
+  vehicle::ChColumnStore store;
+  store.Reset(header, num_points);
+  std::vector<double> row(NUM_COLUMNS);
+  for (int i = 0; i < num_points; i++) {
+    for (int k = 0; k < NUM_COLUMNS; k++)
+      row[k] = columns[k][i];
+    store.Append(&row[0]);
+  }
+
+  if (!store.Write(out_file, format)) {
+    cout << "Cannot write " << out_file << endl;
+    return false;
+  }
+
+  cout << tir_file << ": " << num_points << " points in " << timer() << " s ("
+       << num_points / timer() << " points/s) -> " << out_file << endl;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Name of the output file for the specified tire file.
+// -----------------------------------------------------------------------------
+std::string OutputFile(const std::string& out_dir, const std::string& tir_file, const std::string& ext)
+{
+  size_t slash = tir_file.find_last_of("/\\");
+  std::string name = (slash == std::string::npos) ? tir_file : tir_file.substr(slash + 1);
+  size_t dot = name.find_last_of('.');
+  if (dot != std::string::npos)
+    name = name.substr(0, dot);
+
+  return out_dir + "/" + name + "_sweep" + ext;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  Range kappa(-1, 1, 201);
+  Range alpha(-CH_C_PI / 12, CH_C_PI / 12, 61);
+  Range gamma(0, 0, 1);
+  Range Fz(8000, 8000, 1);
+  Range Vx(0, 0, 0);
+  int num_threads = 0;
+  std::string out_dir = "../PACTEST";
+  vehicle::ChOutputChannel::Format format = vehicle::ChOutputChannel::CSV;
+  std::string ext = ".csv";
+  std::vector<std::string> tir_files;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    int left = argc - 1 - i;
+    Range* range = 0;
+
+    if (arg == "-kappa")
+      range = &kappa;
+    else if (arg == "-alpha")
+      range = &alpha;
+    else if (arg == "-gamma")
+      range = &gamma;
+    else if (arg == "-Fz")
+      range = &Fz;
+    else if (arg == "-Vx")
+      range = &Vx;
+
+    if (range && left >= 3) {
+      range->min = std::atof(argv[++i]);
+      range->max = std::atof(argv[++i]);
+      range->num = std::atoi(argv[++i]);
+      if (range->num < 1) {
+        cout << "Invalid number of points for " << arg << endl;
+        return 1;
+      }
+    } else if (arg == "-threads" && left >= 1) {
+      num_threads = std::atoi(argv[++i]);
+    } else if (arg == "-out" && left >= 1) {
+      out_dir = argv[++i];
+    } else if (arg == "-binary") {
+      format = vehicle::ChOutputChannel::BINARY;
+      ext = ".bin";
+    } else if (arg == "-arrow") {
+      format = vehicle::ChOutputChannel::ARROW;
+      ext = ".arrow";
+    } else if (arg[0] == '-') {
+      cout << "Unknown or incomplete option " << arg << endl;
+      return 1;
+    } else {
+      tir_files.push_back(arg);
+    }
+  }
+
+  if (tir_files.empty())
+    tir_files.push_back(vehicle::GetDataFile("hmmwv/pactest.tir"));
+
+  if (Fz.min <= 0 || Fz.max <= 0) {
+    cout << "The vertical load must be positive" << endl;
+    return 1;
+  }
+
+  // The kinematic slips are not defined at low forward velocity.
+  if (Vx.num > 0 && (std::abs(Vx.min) < 0.1 || std::abs(Vx.max) < 0.1 || Vx.min * Vx.max < 0)) {
+    cout << "The forward velocity must be at least 0.1 m/s in magnitude" << endl;
+    return 1;
+  }
+
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  if (ChFileutils::MakeDirectory(out_dir.c_str()) < 0) {
+    cout << "Error creating directory " << out_dir << endl;
+    return 1;
+  }
+
+  Grid grid(kappa, alpha, gamma, Fz, Vx);
+  vehicle::ChThreadPool pool(num_threads);
+
+  cout << "Threads: " << pool.GetNumThreads() << endl;
+
+  int num_failed = 0;
+  for (size_t i = 0; i < tir_files.size(); i++) {
+    if (!Characterize(tir_files[i], grid, pool, OutputFile(out_dir, tir_files[i], ext), format))
+      num_failed++;
+  }
+
+  return (num_failed > 0) ? 1 : 0;
+}
@@ -21,22 +21,40 @@
 // we will run our vehicle with default rigid tires, but calculate the output
 // for the pacjeka tire in the background
 //
+// finally, repeat the combined slip case with the tabulated Magic Formula
+// (linear and cubic interpolation) and report the speedup and the maximum
+// deviation from the analytical Magic Formula
+//
+// the combined slip case is also repeated with the approximated atan/sin/cos
+// (fast math); the test fails if the deviation from the exact functions
+// exceeds a given fraction of the range of each reaction
+//
+// the combined slip case is also repeated with a tire advanced through a
+// single precision tire batch (the same check, against the double precision
+// scalar tire)
+//
 // =============================================================================
 
 #include <vector>
+#include <iostream>
+#include <algorithm>
 
 #include "core/ChFileutils.h"
 #include "core/ChStream.h"
+#include "core/ChTimer.h"
 #include "physics/ChSystem.h"
 #include "physics/ChLinkDistance.h"
 
 #include "subsys/ChVehicleModelData.h"
 #include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/tire/ChPacejkaTireBatch.h"
 #include "subsys/terrain/FlatTerrain.h"
 
 #include "ChronoVehicle_config.h"
 
 using namespace chrono;
+using std::cout;
+using std::endl;
 
 
 int main(int argc, char* argv[])
@@ -211,6 +229,207 @@ int main(int argc, char* argv[])
 
   }
 
+  // compare the tabulated Magic Formula with the analytical one, using the same
+  // combined slip history
+  ChPacejkaTable::Interpolation interp_types[2] = { ChPacejkaTable::LINEAR, ChPacejkaTable::CUBIC };
+  const char* interp_names[2] = { "linear", "cubic" };
+
+  for (int it = 0; it < 2; it++)
+  {
+    ChPacejkaTable::Settings tabulation;
+    tabulation.enabled = true;
+    tabulation.interpolation = interp_types[it];
+    tabulation.kappa_lim = kappa_lim;
+    tabulation.alpha_lim = alpha_lim;
+
+    ChPacejkaTire tire_analytic("ANALYTIC", pacParamFile, flat_terrain, F_z, use_transient_slip);
+    ChPacejkaTire tire_tab("TABULATED", pacParamFile, flat_terrain, F_z, use_transient_slip, tabulation);
+    tire_analytic.Initialize(m_side, true);
+    tire_tab.Initialize(m_side, true);
+
+    ChTimer<double> timer;
+    double time_analytic = 0;
+    double time_tab = 0;
+    ChVector<> max_dev;
+
+    time = 0;
+    kappa_t = k_min;
+    alpha_t = use_transient_slip ? 0 : a_min;
+
+    for (size_t step = 0; step < num_pts; step++)
+    {
+      ChWheelState state = tire_analytic.getState_from_KAG(kappa_t, alpha_t, 0.1 * alpha_t, vel_xy);
+      tire_analytic.Update(time, state);
+      tire_tab.Update(time, state);
+
+      timer.reset();
+      timer.start();
+      tire_analytic.Advance(step_size);
+      timer.stop();
+      time_analytic += timer();
+
+      timer.reset();
+      timer.start();
+      tire_tab.Advance(step_size);
+      timer.stop();
+      time_tab += timer();
+
+      ChTireForce fa = tire_analytic.GetTireForce_combinedSlip(true);
+      ChTireForce ft = tire_tab.GetTireForce_combinedSlip(true);
+      max_dev.x = std::max(max_dev.x, std::abs(fa.force.x - ft.force.x));
+      max_dev.y = std::max(max_dev.y, std::abs(fa.force.y - ft.force.y));
+      max_dev.z = std::max(max_dev.z, std::abs(fa.moment.z - ft.moment.z));
+
+      time += step_size;
+      kappa_t += kappa_incr;
+      if (use_transient_slip)
+        alpha_t = std::abs(a_max) * sin(2.0 * chrono::CH_C_PI * time / time_end);
+      else
+        alpha_t += alpha_incr;
+    }
+
+    ChVector<> bound = tire_tab.get_tabulation_error();
+
+    cout << "Tabulated Magic Formula, " << interp_names[it] << " interpolation" << endl;
+    cout << "  analytic Advance: " << time_analytic << " s,  tabulated Advance: " << time_tab << " s" << endl;
+    cout << "  speedup: " << time_analytic / time_tab << endl;
+    cout << "  max deviation  Fx: " << max_dev.x << "  Fy: " << max_dev.y << "  Mz: " << max_dev.z << endl;
+    cout << "  error bound    Fx: " << bound.x << "  Fy: " << bound.y << "  Mz: " << bound.z << endl;
+  }
+
+  // compare the fast math Magic Formula with the exact one, using the same
+  // combined slip history
+  {
+    const double fast_math_tol = 1e-4;    // relative to the range of each reaction
+
+    ChPacejkaTire tire_exact("EXACT", pacParamFile, flat_terrain, F_z, use_transient_slip);
+    ChPacejkaTire tire_fast("FAST_MATH", pacParamFile, flat_terrain, F_z, use_transient_slip);
+    tire_fast.SetFastMath(true);
+    tire_exact.Initialize(m_side, true);
+    tire_fast.Initialize(m_side, true);
+
+    ChTimer<double> timer;
+    double time_exact = 0;
+    double time_fast = 0;
+    ChVector<> max_dev;
+    ChVector<> f_min(1e30, 1e30, 1e30);
+    ChVector<> f_max(-1e30, -1e30, -1e30);
+
+    time = 0;
+    kappa_t = k_min;
+    alpha_t = use_transient_slip ? 0 : a_min;
+
+    for (size_t step = 0; step < num_pts; step++)
+    {
+      ChWheelState state = tire_exact.getState_from_KAG(kappa_t, alpha_t, 0.1 * alpha_t, vel_xy);
+      tire_exact.Update(time, state);
+      tire_fast.Update(time, state);
+
+      timer.reset();
+      timer.start();
+      tire_exact.Advance(step_size);
+      timer.stop();
+      time_exact += timer();
+
+      timer.reset();
+      timer.start();
+      tire_fast.Advance(step_size);
+      timer.stop();
+      time_fast += timer();
+
+      ChTireForce fe = tire_exact.GetTireForce_combinedSlip(true);
+      ChTireForce ff = tire_fast.GetTireForce_combinedSlip(true);
+      ChVector<> e(fe.force.x, fe.force.y, fe.moment.z);
+      f_min = ChVector<>(std::min(f_min.x, e.x), std::min(f_min.y, e.y), std::min(f_min.z, e.z));
+      f_max = ChVector<>(std::max(f_max.x, e.x), std::max(f_max.y, e.y), std::max(f_max.z, e.z));
+      max_dev.x = std::max(max_dev.x, std::abs(fe.force.x - ff.force.x));
+      max_dev.y = std::max(max_dev.y, std::abs(fe.force.y - ff.force.y));
+      max_dev.z = std::max(max_dev.z, std::abs(fe.moment.z - ff.moment.z));
+
+      time += step_size;
+      kappa_t += kappa_incr;
+      if (use_transient_slip)
+        alpha_t = std::abs(a_max) * sin(2.0 * chrono::CH_C_PI * time / time_end);
+      else
+        alpha_t += alpha_incr;
+    }
+
+    ChVector<> range = f_max - f_min;
+    ChVector<> rel_dev(max_dev.x / range.x, max_dev.y / range.y, max_dev.z / range.z);
+
+    cout << "Fast math Magic Formula" << endl;
+    cout << "  exact Advance: " << time_exact << " s,  fast math Advance: " << time_fast << " s" << endl;
+    cout << "  speedup: " << time_exact / time_fast << endl;
+    cout << "  max deviation  Fx: " << max_dev.x << "  Fy: " << max_dev.y << "  Mz: " << max_dev.z << endl;
+    cout << "  rel. to range  Fx: " << rel_dev.x << "  Fy: " << rel_dev.y << "  Mz: " << rel_dev.z << endl;
+
+    if (!(rel_dev.x <= fast_math_tol && rel_dev.y <= fast_math_tol && rel_dev.z <= fast_math_tol)) {
+      cout << "FAILED: fast math deviation exceeds " << fast_math_tol << " of the reaction range" << endl;
+      return 1;
+    }
+  }
+
+  // compare the single precision batched Magic Formula with the double
+  // precision one, using the same combined slip history
+  {
+    const double single_tol = 1e-4;       // relative to the range of each reaction
+
+    ChPacejkaTire tire_exact("EXACT", pacParamFile, flat_terrain, F_z, use_transient_slip);
+    ChSharedPtr<ChPacejkaTire> tire_single(new ChPacejkaTire("SINGLE", pacParamFile, flat_terrain, F_z, use_transient_slip));
+    tire_exact.Initialize(m_side, true);
+    tire_single->Initialize(m_side, true);
+
+    ChPacejkaTireBatch batch;
+    batch.SetSinglePrecision(true);
+    batch.AddTire(tire_single);
+
+    ChVector<> max_dev;
+    ChVector<> f_min(1e30, 1e30, 1e30);
+    ChVector<> f_max(-1e30, -1e30, -1e30);
+
+    time = 0;
+    kappa_t = k_min;
+    alpha_t = use_transient_slip ? 0 : a_min;
+
+    for (size_t step = 0; step < num_pts; step++)
+    {
+      ChWheelState state = tire_exact.getState_from_KAG(kappa_t, alpha_t, 0.1 * alpha_t, vel_xy);
+      tire_exact.Update(time, state);
+      tire_single->Update(time, state);
+
+      tire_exact.Advance(step_size);
+      batch.Advance(step_size);
+
+      ChTireForce fe = tire_exact.GetTireForce_combinedSlip(true);
+      ChTireForce fs = tire_single->GetTireForce_combinedSlip(true);
+      ChVector<> e(fe.force.x, fe.force.y, fe.moment.z);
+      f_min = ChVector<>(std::min(f_min.x, e.x), std::min(f_min.y, e.y), std::min(f_min.z, e.z));
+      f_max = ChVector<>(std::max(f_max.x, e.x), std::max(f_max.y, e.y), std::max(f_max.z, e.z));
+      max_dev.x = std::max(max_dev.x, std::abs(fe.force.x - fs.force.x));
+      max_dev.y = std::max(max_dev.y, std::abs(fe.force.y - fs.force.y));
+      max_dev.z = std::max(max_dev.z, std::abs(fe.moment.z - fs.moment.z));
+
+      time += step_size;
+      kappa_t += kappa_incr;
+      if (use_transient_slip)
+        alpha_t = std::abs(a_max) * sin(2.0 * chrono::CH_C_PI * time / time_end);
+      else
+        alpha_t += alpha_incr;
+    }
+
+    ChVector<> range = f_max - f_min;
+    ChVector<> rel_dev(max_dev.x / range.x, max_dev.y / range.y, max_dev.z / range.z);
+
+    cout << "Single precision batched Magic Formula" << endl;
+    cout << "  max deviation  Fx: " << max_dev.x << "  Fy: " << max_dev.y << "  Mz: " << max_dev.z << endl;
+    cout << "  rel. to range  Fx: " << rel_dev.x << "  Fy: " << rel_dev.y << "  Mz: " << rel_dev.z << endl;
+
+    if (!(rel_dev.x <= single_tol && rel_dev.y <= single_tol && rel_dev.z <= single_tol)) {
+      cout << "FAILED: single precision deviation exceeds " << single_tol << " of the reaction range" << endl;
+      return 1;
+    }
+  }
+
   // clean up anything
 
 
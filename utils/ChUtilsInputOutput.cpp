@@ -16,14 +16,289 @@
 //
 // =============================================================================
 
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
 #include "assets/ChColorAsset.h"
 
+#include "subsys/ChContentHash.h"
+#include "subsys/ChDeferredAssets.h"
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChMeshCache.h"
+#include "subsys/ChVehicleThreads.h"
+
 #include "utils/ChUtilsInputOutput.h"
 
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/internal/dtoa.h"
+
 namespace chrono {
 namespace utils {
 
 
+// -----------------------------------------------------------------------------
+// CSV_stream
+//
+// Output file and writer thread of a streaming CSV_writer. The simulation
+// thread hands a full chunk to the writer thread by swapping it with the
+// (empty) pending buffer; it only waits if the previous chunk is still being
+// written. A chunk can request a flush of the file after it is written.
+// -----------------------------------------------------------------------------
+struct CSV_stream {
+  class Writer : public vehicle::ChThread {
+  public:
+    Writer(CSV_stream* stream) : m_stream(stream) {}
+  protected:
+    virtual void Run() { m_stream->write_chunks(); }
+  private:
+    CSV_stream* m_stream;
+  };
+
+  CSV_stream(size_t chunk_size)
+  : m_chunk_size(chunk_size), m_offset(0), m_busy(false), m_flush(false), m_stop(false), m_writer(this) {}
+
+  // Hand the specified chunk to the writer thread (the argument is left empty).
+  void submit(std::string& chunk, bool flush = false)
+  {
+    m_offset += chunk.size();
+    m_mutex.Lock();
+    while (m_busy)
+      m_cond.Wait(m_mutex);
+    m_pending.swap(chunk);
+    m_busy = true;
+    m_flush = flush;
+    m_cond.Broadcast();
+    m_mutex.Unlock();
+  }
+
+  // Wait for the pending chunk, then stop the writer thread.
+  void stop()
+  {
+    m_mutex.Lock();
+    m_stop = true;
+    m_cond.Broadcast();
+    m_mutex.Unlock();
+
+    m_writer.Join();
+  }
+
+  // Body of the writer thread.
+  void write_chunks()
+  {
+    while (true) {
+      m_mutex.Lock();
+      while (!m_busy && !m_stop)
+        m_cond.Wait(m_mutex);
+      if (!m_busy) {
+        m_mutex.Unlock();
+        break;
+      }
+      m_mutex.Unlock();
+
+      m_file.Write(m_pending);
+      if (m_flush)
+        m_file.Flush();
+
+      m_mutex.Lock();
+      m_pending.clear();
+      m_busy = false;
+      m_cond.Broadcast();
+      m_mutex.Unlock();
+    }
+  }
+
+  vehicle::ChCompressedFile m_file;
+  size_t             m_chunk_size;
+  size_t             m_offset;    // bytes submitted so far (simulation thread only)
+  std::string        m_pending;   // chunk being written (protected by m_busy)
+  bool               m_busy;
+  bool               m_flush;     // flush the file after the pending chunk
+  bool               m_stop;
+  vehicle::ChMutex   m_mutex;
+  vehicle::ChCondition m_cond;
+  Writer             m_writer;
+};
+
+bool CSV_writer::open(const std::string& filename,
+                      const std::string& header,
+                      size_t             chunk_size)
+{
+  close();
+
+  m_stream = new CSV_stream(chunk_size);
+  if (!m_stream->m_file.OpenWrite(filename, vehicle::ChCompressedFile::AUTO, 0, true)) {
+    delete m_stream;
+    m_stream = 0;
+    return false;
+  }
+
+  m_stream->m_file.Write(header);
+  m_stream->m_offset = header.size();
+
+  if (!m_stream->m_writer.Start()) {
+    delete m_stream;
+    m_stream = 0;
+    return false;
+  }
+
+  return true;
+}
+
+// The kept part of the file is copied from the previous file (renamed first),
+// so that it is decompressed and compressed again as needed.
+bool CSV_writer::resume(const std::string& filename,
+                        size_t             offset,
+                        size_t             chunk_size)
+{
+  close();
+
+  std::string old_filename = filename + ".resume";
+  std::remove(old_filename.c_str());
+  if (std::rename(filename.c_str(), old_filename.c_str()) != 0)
+    return false;
+
+  vehicle::ChCompressedFile ifile;
+  m_stream = new CSV_stream(chunk_size);
+  bool ok = ifile.OpenRead(old_filename) &&
+            m_stream->m_file.OpenWrite(filename, vehicle::ChCompressedFile::AUTO, 0, true);
+
+  std::vector<char> buffer(1 << 16);
+  size_t copied = 0;
+  while (ok && copied < offset) {
+    size_t count = ifile.Read(&buffer[0], std::min(buffer.size(), offset - copied));
+    ok = (count > 0) && m_stream->m_file.Write(&buffer[0], count);
+    copied += count;
+  }
+  ifile.Close();
+
+  if (!ok || !m_stream->m_writer.Start()) {
+    m_stream->m_file.Close();
+    delete m_stream;
+    m_stream = 0;
+    std::remove(filename.c_str());
+    std::rename(old_filename.c_str(), filename.c_str());
+    return false;
+  }
+
+  m_stream->m_offset = offset;
+  std::remove(old_filename.c_str());
+
+  return true;
+}
+
+size_t CSV_writer::tell() const
+{
+  if (!m_stream)
+    return 0;
+
+  return m_stream->m_offset + m_ss.str().size();
+}
+
+size_t CSV_writer::memory_footprint() const
+{
+  std::streamoff buffered = m_ss.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+  size_t bytes = (buffered > 0) ? (size_t)buffered : 0;
+
+  if (m_stream) {
+    m_stream->m_mutex.Lock();
+    bytes += sizeof(CSV_stream) + m_stream->m_pending.capacity() + m_stream->m_file.GetMemoryFootprint();
+    m_stream->m_mutex.Unlock();
+  }
+
+  return bytes;
+}
+
+void CSV_writer::flush()
+{
+  if (!m_stream)
+    return;
+
+  std::string chunk = m_ss.str();
+  m_ss.str(std::string());
+  m_stream->submit(chunk, true);
+}
+
+void CSV_writer::close()
+{
+  if (!m_stream)
+    return;
+
+  std::string chunk = m_ss.str();
+  m_ss.str(std::string());
+  if (!chunk.empty())
+    m_stream->submit(chunk);
+
+  m_stream->stop();
+
+  m_stream->m_file.Close();
+  delete m_stream;
+  m_stream = 0;
+}
+
+void CSV_writer::end_row()
+{
+  if ((size_t)m_ss.tellp() < m_stream->m_chunk_size)
+    return;
+
+  std::string chunk = m_ss.str();
+  m_ss.str(std::string());
+  m_stream->submit(chunk);
+}
+
+// -----------------------------------------------------------------------------
+// Shortest round-trip formatting.
+//
+// Integral values (the common case for counters and time stamps) are converted
+// directly. Other doubles are converted with the Grisu2 algorithm shipped with
+// rapidjson, which produces the shortest (in all but rare cases) digit string
+// that reads back as the same value. Floats, which Grisu2 would print with the
+// digits of the equivalent double, use the smallest precision (6 to 9 digits)
+// that round-trips.
+// -----------------------------------------------------------------------------
+void CSV_writer::write_shortest(double t, bool is_float)
+{
+  char buf[40];
+  char* str = buf;
+
+  if (t != t) {
+    str = (char*)"nan";
+  }
+  else if (t == std::floor(t) && std::abs(t) < 4294967295.0) {
+    // Integral value: convert the digits directly.
+    unsigned long val = (unsigned long)std::abs(t);
+    char* end = buf + sizeof(buf) - 1;
+    *end = 0;
+    str = end;
+    do {
+      *--str = (char)('0' + val % 10);
+      val /= 10;
+    } while (val > 0);
+    if (t < 0 || (t == 0 && 1 / t < 0))
+      *--str = '-';
+  }
+  else if (std::abs(t) > DBL_MAX) {
+    str = (char*)(t > 0 ? "inf" : "-inf");
+  }
+  else if (is_float) {
+    for (int digits = 6; digits <= 9; digits++) {
+      sprintf(buf, "%.*g", digits, t);
+      if ((float)std::strtod(buf, 0) == (float)t)
+        break;
+    }
+  }
+  else {
+    *rapidjson::internal::dtoa(t, buf) = 0;
+  }
+
+  m_ss << str << m_delim;
+}
+
+
 // -----------------------------------------------------------------------------
 // WriteBodies
 //
@@ -60,6 +335,9 @@ void WriteBodies(ChSystem*          system,
 bool WriteCheckpoint(ChSystem*          system,
                      const std::string& filename)
 {
+  // The checkpoint records the visualization assets, deferred ones included.
+  vehicle::ChDeferredAssets::Materialize(system);
+
   CSV_writer csv(" ");
 
   std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
@@ -332,169 +610,689 @@ void ReadCheckpoint(ChSystem*          system,
 
 
 // -----------------------------------------------------------------------------
-// WriteShapesPovray
-//
-// Write CSV output file for PovRay.
-// First line contains the number of visual assets and links to follow.
-// A line with information about a visualization asset contains:
-//    bodyId, bodyActive, x, y, z, e0, e1, e2, e3, shapeType, [shape Data]
-// A line with information about a link contains:
-//    linkType, [linkData]
-//
-// NOTE: we do not account for any transform specified for the ChGeometry of
-// a visual asset (except for cylinders where that is implicit)!
+// Binary checkpoint file layout (native byte order):
+//   CheckpointHeader
+//   num_bodies CheckpointBody records
+//   num_assets CheckpointAsset records; the assets of each body are stored
+//     contiguously, starting at its first_asset index
+// The record sizes are stored in the header and checked on reading, so that a
+// change of layout requires a new version number.
 // -----------------------------------------------------------------------------
-void WriteShapesPovray(ChSystem*          system,
+static const char CHECKPOINT_MAGIC[8] = {'C', 'H', 'C', 'K', 'P', 'T', 0, 0};
+static const unsigned int CHECKPOINT_VERSION = 1;
+
+struct CheckpointHeader {
+  char         magic[8];
+  unsigned int version;
+  unsigned int num_bodies;
+  unsigned int num_assets;
+  unsigned int body_bytes;
+  unsigned int asset_bytes;
+  unsigned int reserved[9];
+};
+
+struct CheckpointBody {
+  int    type;            // 0: DVI, 1: DEM
+  int    identifier;
+  int    fixed;
+  int    collide;
+  int    first_asset;
+  int    num_assets;
+  double mass;
+  double inertiaXX[3];
+  double pos[3];
+  double rot[4];
+  double pos_dt[3];
+  double rot_dt[4];
+  double material[11];    // DVI: 11 values, DEM: 6 values (as in WriteCheckpoint)
+};
+
+struct CheckpointAsset {
+  int    type;            // collision::ShapeType
+  int    reserved;
+  double pos[3];
+  double rot[4];
+  double geometry[4];     // as in WriteCheckpoint
+};
+
+static void CopyVector(const ChVector<>& v, double* a)          { a[0] = v.x; a[1] = v.y; a[2] = v.z; }
+static void CopyQuaternion(const ChQuaternion<>& q, double* a)  { a[0] = q.e0; a[1] = q.e1; a[2] = q.e2; a[3] = q.e3; }
+static ChVector<> GetVector(const double* a)                    { return ChVector<>(a[0], a[1], a[2]); }
+static ChQuaternion<> GetQuaternion(const double* a)            { return ChQuaternion<>(a[0], a[1], a[2], a[3]); }
+
+
+// -----------------------------------------------------------------------------
+// Binary body state dumps
+// -----------------------------------------------------------------------------
+static const char BODYDUMP_MAGIC[8] = {'C', 'H', 'B', 'O', 'D', 'Y', 0, 0};
+static const unsigned int BODYDUMP_VERSION = 1;
+
+struct BodyDumpHeader {
+  char         magic[8];
+  unsigned int version;
+  unsigned int num_records;
+  unsigned int record_bytes;
+  unsigned int reserved;
+  double       time;
+};
+
+void Body_filter::set_identifiers(const std::vector<int>& ids)
+{
+  identifiers = ids;
+  std::sort(identifiers.begin(), identifiers.end());
+}
+
+void Body_filter::set_region(const ChVector<>& min, const ChVector<>& max)
+{
+  use_region = true;
+  region_min = min;
+  region_max = max;
+}
+
+bool Body_filter::accept(ChBody* body) const
+{
+  if (active_only && !body->IsActive())
+    return false;
+  if (!identifiers.empty() && !std::binary_search(identifiers.begin(), identifiers.end(), body->GetIdentifier()))
+    return false;
+  if (use_region) {
+    const ChVector<>& p = body->GetPos();
+    if (p.x < region_min.x || p.y < region_min.y || p.z < region_min.z ||
+        p.x > region_max.x || p.y > region_max.y || p.z > region_max.z)
+      return false;
+  }
+  return true;
+}
+
+// Capture the header and the records of the selected bodies in the specified
+// buffer. Returns the number of records.
+static int CaptureBodies(ChSystem* system, const Body_filter& filter, std::vector<char>& buffer)
+{
+  std::vector<ChBody*>& bodies = *system->Get_bodylist();
+  buffer.resize(sizeof(BodyDumpHeader) + bodies.size() * sizeof(Body_record));
+
+  Body_record* rec = reinterpret_cast<Body_record*>(&buffer[0] + sizeof(BodyDumpHeader));
+  int num_records = 0;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    ChBody* body = bodies[i];
+    if (!filter.accept(body))
+      continue;
+    rec->identifier = body->GetIdentifier();
+    rec->flags = (body->IsActive() ? Body_record::ACTIVE : 0) | (body->GetBodyFixed() ? Body_record::FIXED : 0);
+    CopyVector(body->GetPos(), rec->pos);
+    CopyQuaternion(body->GetRot(), rec->rot);
+    CopyVector(body->GetPos_dt(), rec->pos_dt);
+    CopyVector(body->GetWvel_loc(), rec->wvel_loc);
+    rec++;
+    num_records++;
+  }
+  buffer.resize(sizeof(BodyDumpHeader) + num_records * sizeof(Body_record));
+
+  BodyDumpHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, BODYDUMP_MAGIC, sizeof(header.magic));
+  header.version = BODYDUMP_VERSION;
+  header.num_records = (unsigned int)num_records;
+  header.record_bytes = sizeof(Body_record);
+  header.time = system->GetChTime();
+  std::memcpy(&buffer[0], &header, sizeof(header));
+
+  return num_records;
+}
+
+static bool WriteBodyDump(const std::string& filename, const std::vector<char>& buffer)
+{
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+  bool ok = fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+  return (fclose(fp) == 0) && ok;
+}
+
+bool WriteBodiesBinary(ChSystem*          system,
                        const std::string& filename,
-                       bool               body_info,
-                       const std::string& delim)
+                       const Body_filter& filter)
 {
-  CSV_writer csv(delim);
+  std::vector<char> buffer;
+  CaptureBodies(system, filter, buffer);
 
-  // If requested, Loop over all bodies and write out their position and
-  // orientation.  Otherwise, body count is left at 0.
-  int b_count = 0;
+  if (!WriteBodyDump(filename, buffer)) {
+    GetLog() << "ERROR: cannot write body dump " << filename.c_str() << "\n";
+    return false;
+  }
+  return true;
+}
 
-  if (body_info) {
-    std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
-    for (; ibody != system->Get_bodylist()->end(); ++ibody)
-    {
-      const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
-      const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
+bool ReadBodiesBinary(const std::string&        filename,
+                      double&                   time,
+                      std::vector<Body_record>& records)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  BodyDumpHeader header;
+  bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+            std::memcmp(header.magic, BODYDUMP_MAGIC, sizeof(header.magic)) == 0 &&
+            header.version == BODYDUMP_VERSION && header.record_bytes == sizeof(Body_record);
+  if (ok) {
+    records.resize(header.num_records);
+    ok = records.empty() || fread(&records[0], sizeof(Body_record), records.size(), fp) == records.size();
+    time = header.time;
+  }
+  fclose(fp);
 
-      csv << (*ibody)->GetIdentifier() << (*ibody)->IsActive() << body_pos << body_rot << std::endl;
+  if (!ok)
+    records.clear();
+  return ok;
+}
 
-      b_count++;
+// -----------------------------------------------------------------------------
+// Body_dump_stream
+//
+// Writer thread of a Body_dump_writer: the simulation thread hands a captured
+// dump over by swapping its buffer with the (empty) pending one, as in
+// CSV_stream.
+// -----------------------------------------------------------------------------
+struct Body_dump_stream {
+  class Writer : public vehicle::ChThread {
+  public:
+    Writer(Body_dump_stream* stream) : m_stream(stream) {}
+  protected:
+    virtual void Run() { m_stream->write_dumps(); }
+  private:
+    Body_dump_stream* m_stream;
+  };
+
+  Body_dump_stream() : m_busy(false), m_stop(false), m_failed(false), m_writer(this) {}
+
+  // Hand the specified dump to the writer thread (the buffer is swapped with
+  // the previous, written one).
+  void submit(std::vector<char>& buffer, const std::string& filename)
+  {
+    m_mutex.Lock();
+    while (m_busy)
+      m_cond.Wait(m_mutex);
+    m_pending.swap(buffer);
+    m_filename = filename;
+    m_busy = true;
+    m_cond.Broadcast();
+    m_mutex.Unlock();
+  }
+
+  // Wait for the pending dump. Returns false if a dump failed since the last call.
+  bool wait()
+  {
+    m_mutex.Lock();
+    while (m_busy)
+      m_cond.Wait(m_mutex);
+    bool ok = !m_failed;
+    m_failed = false;
+    m_mutex.Unlock();
+    return ok;
+  }
+
+  // Wait for the pending dump, then stop the writer thread.
+  void stop()
+  {
+    m_mutex.Lock();
+    m_stop = true;
+    m_cond.Broadcast();
+    m_mutex.Unlock();
+
+    m_writer.Join();
+  }
+
+  // Body of the writer thread.
+  void write_dumps()
+  {
+    while (true) {
+      m_mutex.Lock();
+      while (!m_busy && !m_stop)
+        m_cond.Wait(m_mutex);
+      if (!m_busy) {
+        m_mutex.Unlock();
+        break;
+      }
+      m_mutex.Unlock();
+
+      bool ok = WriteBodyDump(m_filename, m_pending);
+      if (!ok)
+        GetLog() << "ERROR: cannot write body dump " << m_filename.c_str() << "\n";
+
+      m_mutex.Lock();
+      m_failed = m_failed || !ok;
+      m_busy = false;
+      m_cond.Broadcast();
+      m_mutex.Unlock();
     }
   }
 
-  // Loop over all bodies and over all their assets.
-  int a_count = 0;
+  std::vector<char>    m_pending;    // dump being written (protected by m_busy)
+  std::string          m_filename;
+  bool                 m_busy;
+  bool                 m_stop;
+  bool                 m_failed;
+  vehicle::ChMutex     m_mutex;
+  vehicle::ChCondition m_cond;
+  Writer               m_writer;
+};
+
+Body_dump_writer::~Body_dump_writer()
+{
+  if (m_stream) {
+    m_stream->stop();
+    delete m_stream;
+  }
+}
+
+// If the writer thread cannot be started, the dumps are written synchronously.
+void Body_dump_writer::write(ChSystem*          system,
+                             const std::string& filename,
+                             const Body_filter& filter)
+{
+  m_num_records = CaptureBodies(system, filter, m_buffer);
+
+  if (!m_stream) {
+    m_stream = new Body_dump_stream;
+    if (!m_stream->m_writer.Start()) {
+      delete m_stream;
+      m_stream = 0;
+    }
+  }
+
+  if (m_stream) {
+    m_stream->submit(m_buffer, filename);
+  } else if (!WriteBodyDump(filename, m_buffer)) {
+    GetLog() << "ERROR: cannot write body dump " << filename.c_str() << "\n";
+  }
+}
+
+bool Body_dump_writer::wait()
+{
+  return m_stream ? m_stream->wait() : true;
+}
+
+
+// -----------------------------------------------------------------------------
+// WriteCheckpointBinary
+// -----------------------------------------------------------------------------
+bool WriteCheckpointBinary(ChSystem*          system,
+                           const std::string& filename)
+{
+  vehicle::ChDeferredAssets::Materialize(system);
+
+  std::vector<CheckpointBody>  bodies;
+  std::vector<CheckpointAsset> assets;
+
   std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
   for (; ibody != system->Get_bodylist()->end(); ++ibody)
   {
-    const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
-    const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
-
-    ChColor color(0.8f, 0.8f, 0.8f);
-
-    // First loop over assets -- search for a color asset
-    std::vector<ChSharedPtr<ChAsset> >::iterator iasset = (*ibody)->GetAssets().begin();
-    for (; iasset != (*ibody)->GetAssets().end(); ++iasset)
-    {
-      if (ChSharedPtr<ChColorAsset> color_asset = (*iasset).DynamicCastTo<ChColorAsset>())
-        color = color_asset->GetColor();
+    ChBody* body = *ibody;
+    CheckpointBody rec;
+    std::memset(&rec, 0, sizeof(rec));
+
+    rec.type = (dynamic_cast<ChBodyDEM*>(body)) ? 1 : 0;
+    rec.identifier = body->GetIdentifier();
+    rec.fixed = body->GetBodyFixed();
+    rec.collide = body->GetCollide();
+
+    rec.mass = body->GetMass();
+    CopyVector(body->GetInertiaXX(), rec.inertiaXX);
+    CopyVector(body->GetPos(), rec.pos);
+    CopyQuaternion(body->GetRot(), rec.rot);
+    CopyVector(body->GetPos_dt(), rec.pos_dt);
+    CopyQuaternion(body->GetRot_dt(), rec.rot_dt);
+
+    double* m = rec.material;
+    if (rec.type == 0) {
+      ChSharedPtr<ChMaterialSurface>& mat = body->GetMaterialSurface();
+      m[0] = mat->static_friction;  m[1] = mat->sliding_friction;  m[2] = mat->rolling_friction;  m[3] = mat->spinning_friction;
+      m[4] = mat->restitution;      m[5] = mat->cohesion;          m[6] = mat->dampingf;
+      m[7] = mat->compliance;       m[8] = mat->complianceT;       m[9] = mat->complianceRoll;    m[10] = mat->complianceSpin;
+    } else {
+      ChSharedPtr<ChMaterialSurfaceDEM>& mat = static_cast<ChBodyDEM*>(body)->GetMaterialSurfaceDEM();
+      m[0] = mat->young_modulus;    m[1] = mat->poisson_ratio;
+      m[2] = mat->static_friction;  m[3] = mat->sliding_friction;
+      m[4] = mat->restitution;      m[5] = mat->cohesion;
     }
 
-    // Loop over assets once again -- write information for supported types.
-    iasset = (*ibody)->GetAssets().begin();
-    for (; iasset != (*ibody)->GetAssets().end(); ++iasset)
+    rec.first_asset = (int)assets.size();
+
+    std::vector<ChSharedPtr<ChAsset> >::iterator iasset = body->GetAssets().begin();
+    for (; iasset != body->GetAssets().end(); ++iasset)
     {
       ChSharedPtr<ChVisualization> visual_asset = (*iasset).DynamicCastTo<ChVisualization>();
       if (visual_asset.IsNull())
         continue;
 
-      const Vector& asset_pos = visual_asset->Pos;
-      Quaternion    asset_rot = visual_asset->Rot.Get_A_quaternion();
-
-      Vector     pos = body_pos + body_rot.Rotate(asset_pos);
-      Quaternion rot = body_rot % asset_rot;
-
-      std::stringstream gss;
+      CheckpointAsset arec;
+      std::memset(&arec, 0, sizeof(arec));
+      CopyVector(visual_asset->Pos, arec.pos);
+      CopyQuaternion(visual_asset->Rot.Get_A_quaternion(), arec.rot);
 
+      double* g = arec.geometry;
       if (ChSharedPtr<ChSphereShape> sphere = visual_asset.DynamicCastTo<ChSphereShape>())
       {
-        gss << collision::SPHERE << delim << sphere->GetSphereGeometry().rad;
-        a_count++;
+        arec.type = collision::SPHERE;
+        g[0] = sphere->GetSphereGeometry().rad;
       }
-      else if (ChSharedPtr<ChEllipsoidShape> ellipsoid = visual_asset.DynamicCastTo<ChEllipsoidShape>()) {
-        const Vector& size = ellipsoid->GetEllipsoidGeometry().rad;
-        gss << collision::ELLIPSOID << delim << size.x << delim << size.y << delim << size.z;
-        a_count++;
+      else if (ChSharedPtr<ChEllipsoidShape> ellipsoid = visual_asset.DynamicCastTo<ChEllipsoidShape>())
+      {
+        arec.type = collision::ELLIPSOID;
+        CopyVector(ellipsoid->GetEllipsoidGeometry().rad, g);
       }
       else if (ChSharedPtr<ChBoxShape> box = visual_asset.DynamicCastTo<ChBoxShape>())
       {
-        const Vector& size = box->GetBoxGeometry().Size;
-        gss << collision::BOX << delim << size.x << delim << size.y << delim << size.z;
-        a_count++;
+        arec.type = collision::BOX;
+        CopyVector(box->GetBoxGeometry().Size, g);
       }
       else if (ChSharedPtr<ChCapsuleShape> capsule = visual_asset.DynamicCastTo<ChCapsuleShape>())
       {
         const geometry::ChCapsule& geom = capsule->GetCapsuleGeometry();
-        gss << collision::CAPSULE << delim << geom.rad << delim << geom.hlen;
-        a_count++;
-      }
-      else if (ChSharedPtr<ChCylinderShape> cylinder = visual_asset.DynamicCastTo<ChCylinderShape>())
-      {
-        const geometry::ChCylinder& geom = cylinder->GetCylinderGeometry();
-        gss << collision::CYLINDER << delim << geom.rad << delim
-            << geom.p1.x << delim << geom.p1.y << delim << geom.p1.z << delim
-            << geom.p2.x << delim << geom.p2.y << delim << geom.p2.z;
-        a_count++;
+        arec.type = collision::CAPSULE;
+        g[0] = geom.rad;
+        g[1] = geom.hlen;
       }
       else if (ChSharedPtr<ChConeShape> cone = visual_asset.DynamicCastTo<ChConeShape>())
       {
         const geometry::ChCone& geom = cone->GetConeGeometry();
-        gss << collision::CONE << delim << geom.rad.x << delim << geom.rad.y;
-        a_count++;
+        arec.type = collision::CONE;
+        g[0] = geom.rad.x;
+        g[1] = geom.rad.y;
       }
       else if (ChSharedPtr<ChRoundedBoxShape> rbox = visual_asset.DynamicCastTo<ChRoundedBoxShape>())
       {
         const geometry::ChRoundedBox& geom = rbox->GetRoundedBoxGeometry();
-        gss << collision::ROUNDEDBOX << delim << geom.Size.x << delim << geom.Size.y << delim << geom.Size.z << delim << geom.radsphere;
-        a_count++;
+        arec.type = collision::ROUNDEDBOX;
+        CopyVector(geom.Size, g);
+        g[3] = geom.radsphere;
       }
       else if (ChSharedPtr<ChRoundedCylinderShape> rcyl = visual_asset.DynamicCastTo<ChRoundedCylinderShape>())
       {
         const geometry::ChRoundedCylinder& geom = rcyl->GetRoundedCylinderGeometry();
-        gss << collision::ROUNDEDCYL << delim << geom.rad << delim << geom.hlen << delim << geom.radsphere;
-        a_count++;
+        arec.type = collision::ROUNDEDCYL;
+        g[0] = geom.rad;
+        g[1] = geom.hlen;
+        g[2] = geom.radsphere;
       }
-      else if (ChSharedPtr<ChTriangleMeshShape> mesh = visual_asset.DynamicCastTo<ChTriangleMeshShape>())
+      else
       {
-        gss << collision::TRIANGLEMESH << delim << "\"" << mesh->GetName() << "\"";
-        a_count++;
+        // Unsupported visual asset type.
+        return false;
       }
 
-      csv << (*ibody)->GetIdentifier() << (*ibody)->IsActive() 
-          << pos << rot 
-          << color
-          << gss.str() << std::endl;
+      assets.push_back(arec);
     }
+
+    rec.num_assets = (int)assets.size() - rec.first_asset;
+    bodies.push_back(rec);
   }
 
-  // Loop over all links.  Write information on selected types of links.
-  int l_count = 0;
-  std::vector<ChLink*>::iterator ilink = system->Get_linklist()->begin();
-  for (; ilink != system->Get_linklist()->end(); ++ilink)
-  {
-    int type = (*ilink)->GetType();
+  // Assemble the whole file in memory and write it at once.
+  CheckpointHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.num_bodies = (unsigned int)bodies.size();
+  header.num_assets = (unsigned int)assets.size();
+  header.body_bytes = sizeof(CheckpointBody);
+  header.asset_bytes = sizeof(CheckpointAsset);
+
+  size_t body_bytes = bodies.size() * sizeof(CheckpointBody);
+  size_t asset_bytes = assets.size() * sizeof(CheckpointAsset);
+  std::vector<char> buffer(sizeof(header) + body_bytes + asset_bytes);
+
+  std::memcpy(&buffer[0], &header, sizeof(header));
+  if (body_bytes)
+    std::memcpy(&buffer[sizeof(header)], &bodies[0], body_bytes);
+  if (asset_bytes)
+    std::memcpy(&buffer[sizeof(header) + body_bytes], &assets[0], asset_bytes);
+
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  bool ok = fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+  ok = (fclose(fp) == 0) && ok;
+
+  return ok;
+}
 
-    if (ChLinkLockRevolute* link = dynamic_cast<ChLinkLockRevolute*>(*ilink))
-    {
-      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
-      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
 
-      csv << type << frA_abs.GetPos() << frA_abs.GetA().Get_A_Zaxis() << std::endl;
-      l_count++;
-    }
-    else if (ChLinkLockSpherical* link = dynamic_cast<ChLinkLockSpherical*>(*ilink))
-    {
-      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
-      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
+// -----------------------------------------------------------------------------
+// ReadCheckpointBinary
+// -----------------------------------------------------------------------------
+bool ReadCheckpointBinary(ChSystem*          system,
+                          const std::string& filename)
+{
+  vehicle::ChMappedFile file;
+  if (!file.Open(filename))
+    return false;
+
+  // Validate the header and the file size before creating any body.
+  if (file.GetSize() < sizeof(CheckpointHeader))
+    return false;
+
+  const CheckpointHeader* header = reinterpret_cast<const CheckpointHeader*>(file.GetData());
+  if (std::memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != CHECKPOINT_VERSION ||
+      header->body_bytes != sizeof(CheckpointBody) ||
+      header->asset_bytes != sizeof(CheckpointAsset))
+    return false;
+
+  size_t expected = sizeof(CheckpointHeader) + (size_t)header->num_bodies * sizeof(CheckpointBody) +
+                    (size_t)header->num_assets * sizeof(CheckpointAsset);
+  if (file.GetSize() < expected)
+    return false;
+
+  const CheckpointBody* bodies = reinterpret_cast<const CheckpointBody*>(file.GetData() + sizeof(CheckpointHeader));
+  const CheckpointAsset* assets = reinterpret_cast<const CheckpointAsset*>(bodies + header->num_bodies);
+
+  for (unsigned int i = 0; i < header->num_bodies; i++) {
+    const CheckpointBody& rec = bodies[i];
+    if (rec.first_asset < 0 || rec.num_assets < 0 ||
+        (size_t)rec.first_asset + rec.num_assets > header->num_assets)
+      return false;
+  }
 
-      csv << type << frA_abs.GetPos() << std::endl;
-      l_count++;
-    }
-    if (ChLinkLockPrismatic* link = dynamic_cast<ChLinkLockPrismatic*>(*ilink))
-    {
-      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
-      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
+  for (unsigned int i = 0; i < header->num_bodies; i++) {
+    const CheckpointBody& rec = bodies[i];
+    const double* m = rec.material;
 
-      csv << type << frA_abs.GetPos() << frA_abs.GetA().Get_A_Zaxis() << std::endl;
-      l_count++;
+    // Create a body of the appropriate type and apply material properties
+    ChBody* body;
+    if (rec.type == 0) {
+      body = new ChBody();
+      ChSharedPtr<ChMaterialSurface>& mat = body->GetMaterialSurface();
+      mat->static_friction = (float)m[0];  mat->sliding_friction = (float)m[1];  mat->rolling_friction = (float)m[2];  mat->spinning_friction = (float)m[3];
+      mat->restitution = (float)m[4];      mat->cohesion = (float)m[5];          mat->dampingf = (float)m[6];
+      mat->compliance = (float)m[7];       mat->complianceT = (float)m[8];       mat->complianceRoll = (float)m[9];    mat->complianceSpin = (float)m[10];
+    } else {
+      body = new ChBodyDEM();
+      ChSharedPtr<ChMaterialSurfaceDEM>& mat = static_cast<ChBodyDEM*>(body)->GetMaterialSurfaceDEM();
+      mat->young_modulus = (float)m[0];    mat->poisson_ratio = (float)m[1];
+      mat->static_friction = (float)m[2];  mat->sliding_friction = (float)m[3];
+      mat->restitution = (float)m[4];      mat->cohesion = (float)m[5];
     }
-    else if (ChLinkUniversal* link = dynamic_cast<ChLinkUniversal*>(*ilink))
+
+    // Set body properties and state
+    body->SetPos(GetVector(rec.pos));
+    body->SetRot(GetQuaternion(rec.rot));
+    body->SetPos_dt(GetVector(rec.pos_dt));
+    body->SetRot_dt(GetQuaternion(rec.rot_dt));
+
+    body->SetIdentifier(rec.identifier);
+    body->SetBodyFixed(rec.fixed != 0);
+    body->SetCollide(rec.collide != 0);
+
+    body->SetMass(rec.mass);
+    body->SetInertiaXX(GetVector(rec.inertiaXX));
+
+    // Add the geometry of each asset to the body
+    body->GetCollisionModel()->ClearModel();
+
+    for (int j = 0; j < rec.num_assets; j++) {
+      const CheckpointAsset& arec = assets[rec.first_asset + j];
+      ChVector<> apos = GetVector(arec.pos);
+      ChQuaternion<> arot = GetQuaternion(arec.rot);
+      const double* g = arec.geometry;
+
+      switch (collision::ShapeType(arec.type)) {
+      case collision::SPHERE:
+        AddSphereGeometry(body, g[0], apos, arot);
+        break;
+      case collision::ELLIPSOID:
+        AddEllipsoidGeometry(body, GetVector(g), apos, arot);
+        break;
+      case collision::BOX:
+        AddBoxGeometry(body, GetVector(g), apos, arot);
+        break;
+      case collision::CAPSULE:
+        AddCapsuleGeometry(body, g[0], g[1], apos, arot);
+        break;
+      case collision::CONE:
+        AddConeGeometry(body, g[0], g[1], apos, arot);
+        break;
+      case collision::ROUNDEDBOX:
+        AddRoundedBoxGeometry(body, GetVector(g), g[3], apos, arot);
+        break;
+      case collision::ROUNDEDCYL:
+        AddRoundedCylinderGeometry(body, g[0], g[1], g[2], apos, arot);
+        break;
+      }
+    }
+
+    body->GetCollisionModel()->BuildModel();
+
+    // Attach the body to the system.
+    system->AddBody(ChSharedPtr<ChBody>(body));
+  }
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Helper functions for the PovRay output.
+// -----------------------------------------------------------------------------
+
+// Return the color of the specified body (the last color asset, if any).
+static ChColor GetBodyColor(ChBody* body)
+{
+  ChColor color(0.8f, 0.8f, 0.8f);
+
+  std::vector<ChSharedPtr<ChAsset> >::iterator iasset = body->GetAssets().begin();
+  for (; iasset != body->GetAssets().end(); ++iasset)
+  {
+    if (ChSharedPtr<ChColorAsset> color_asset = (*iasset).DynamicCastTo<ChColorAsset>())
+      color = color_asset->GetColor();
+  }
+
+  return color;
+}
+
+// Write the type and geometry of the specified visualization asset to 'gss'.
+// Returns false if the asset shape is not supported.
+static bool WriteAssetGeometry(const ChSharedPtr<ChVisualization>& visual_asset,
+                               const std::string&                  delim,
+                               std::stringstream&                  gss)
+{
+  bool supported = false;
+
+  if (ChSharedPtr<ChSphereShape> sphere = visual_asset.DynamicCastTo<ChSphereShape>())
+  {
+    gss << collision::SPHERE << delim << sphere->GetSphereGeometry().rad;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChEllipsoidShape> ellipsoid = visual_asset.DynamicCastTo<ChEllipsoidShape>()) {
+    const Vector& size = ellipsoid->GetEllipsoidGeometry().rad;
+    gss << collision::ELLIPSOID << delim << size.x << delim << size.y << delim << size.z;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChBoxShape> box = visual_asset.DynamicCastTo<ChBoxShape>())
+  {
+    const Vector& size = box->GetBoxGeometry().Size;
+    gss << collision::BOX << delim << size.x << delim << size.y << delim << size.z;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChCapsuleShape> capsule = visual_asset.DynamicCastTo<ChCapsuleShape>())
+  {
+    const geometry::ChCapsule& geom = capsule->GetCapsuleGeometry();
+    gss << collision::CAPSULE << delim << geom.rad << delim << geom.hlen;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChCylinderShape> cylinder = visual_asset.DynamicCastTo<ChCylinderShape>())
+  {
+    const geometry::ChCylinder& geom = cylinder->GetCylinderGeometry();
+    gss << collision::CYLINDER << delim << geom.rad << delim
+        << geom.p1.x << delim << geom.p1.y << delim << geom.p1.z << delim
+        << geom.p2.x << delim << geom.p2.y << delim << geom.p2.z;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChConeShape> cone = visual_asset.DynamicCastTo<ChConeShape>())
+  {
+    const geometry::ChCone& geom = cone->GetConeGeometry();
+    gss << collision::CONE << delim << geom.rad.x << delim << geom.rad.y;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChRoundedBoxShape> rbox = visual_asset.DynamicCastTo<ChRoundedBoxShape>())
+  {
+    const geometry::ChRoundedBox& geom = rbox->GetRoundedBoxGeometry();
+    gss << collision::ROUNDEDBOX << delim << geom.Size.x << delim << geom.Size.y << delim << geom.Size.z << delim << geom.radsphere;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChRoundedCylinderShape> rcyl = visual_asset.DynamicCastTo<ChRoundedCylinderShape>())
+  {
+    const geometry::ChRoundedCylinder& geom = rcyl->GetRoundedCylinderGeometry();
+    gss << collision::ROUNDEDCYL << delim << geom.rad << delim << geom.hlen << delim << geom.radsphere;
+    supported = true;
+  }
+  else if (ChSharedPtr<ChTriangleMeshShape> mesh = visual_asset.DynamicCastTo<ChTriangleMeshShape>())
+  {
+    gss << collision::TRIANGLEMESH << delim << "\"" << mesh->GetName() << "\"";
+    supported = true;
+  }
+
+  return supported;
+}
+
+// Write information on selected types of links. Returns the number of links
+// written.
+static int WriteLinksPovray(ChSystem* system, CSV_writer& csv)
+{
+  int l_count = 0;
+
+  std::vector<ChLink*>::iterator ilink = system->Get_linklist()->begin();
+  for (; ilink != system->Get_linklist()->end(); ++ilink)
+  {
+    int type = (*ilink)->GetType();
+
+    if (ChLinkLockRevolute* link = dynamic_cast<ChLinkLockRevolute*>(*ilink))
+    {
+      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
+      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
+
+      csv << type << frA_abs.GetPos() << frA_abs.GetA().Get_A_Zaxis() << std::endl;
+      l_count++;
+    }
+    else if (ChLinkLockSpherical* link = dynamic_cast<ChLinkLockSpherical*>(*ilink))
+    {
+      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
+      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
+
+      csv << type << frA_abs.GetPos() << std::endl;
+      l_count++;
+    }
+    if (ChLinkLockPrismatic* link = dynamic_cast<ChLinkLockPrismatic*>(*ilink))
+    {
+      chrono::ChFrame<> frA_abs = *(link->GetMarker1()) >> *(link->GetBody1());
+      chrono::ChFrame<> frB_abs = *(link->GetMarker2()) >> *(link->GetBody2());
+
+      csv << type << frA_abs.GetPos() << frA_abs.GetA().Get_A_Zaxis() << std::endl;
+      l_count++;
+    }
+    else if (ChLinkUniversal* link = dynamic_cast<ChLinkUniversal*>(*ilink))
     {
       chrono::ChFrame<> frA_abs = link->GetFrame1Abs();
       chrono::ChFrame<> frB_abs = link->GetFrame2Abs();
@@ -533,6 +1331,88 @@ void WriteShapesPovray(ChSystem*          system,
     }
   }
 
+  return l_count;
+}
+
+
+// -----------------------------------------------------------------------------
+// WriteShapesPovray
+//
+// Write CSV output file for PovRay.
+// First line contains the number of visual assets and links to follow.
+// A line with information about a visualization asset contains:
+//    bodyId, bodyActive, x, y, z, e0, e1, e2, e3, shapeType, [shape Data]
+// A line with information about a link contains:
+//    linkType, [linkData]
+//
+// NOTE: we do not account for any transform specified for the ChGeometry of
+// a visual asset (except for cylinders where that is implicit)!
+// -----------------------------------------------------------------------------
+void WriteShapesPovray(ChSystem*          system,
+                       const std::string& filename,
+                       bool               body_info,
+                       const std::string& delim)
+{
+  vehicle::ChDeferredAssets::Materialize(system);
+
+  CSV_writer csv(delim);
+
+  // If requested, Loop over all bodies and write out their position and
+  // orientation.  Otherwise, body count is left at 0.
+  int b_count = 0;
+
+  if (body_info) {
+    std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+    for (; ibody != system->Get_bodylist()->end(); ++ibody)
+    {
+      const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
+      const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
+
+      csv << (*ibody)->GetIdentifier() << (*ibody)->IsActive() << body_pos << body_rot << std::endl;
+
+      b_count++;
+    }
+  }
+
+  // Loop over all bodies and over all their assets.
+  int a_count = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody)
+  {
+    const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
+    const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
+
+    ChColor color = GetBodyColor(*ibody);
+
+    // Loop over assets -- write information for supported types.
+    std::vector<ChSharedPtr<ChAsset> >::iterator iasset = (*ibody)->GetAssets().begin();
+    for (; iasset != (*ibody)->GetAssets().end(); ++iasset)
+    {
+      ChSharedPtr<ChVisualization> visual_asset = (*iasset).DynamicCastTo<ChVisualization>();
+      if (visual_asset.IsNull())
+        continue;
+
+      const Vector& asset_pos = visual_asset->Pos;
+      Quaternion    asset_rot = visual_asset->Rot.Get_A_quaternion();
+
+      Vector     pos = body_pos + body_rot.Rotate(asset_pos);
+      Quaternion rot = body_rot % asset_rot;
+
+      std::stringstream gss;
+
+      if (WriteAssetGeometry(visual_asset, delim, gss))
+        a_count++;
+
+      csv << (*ibody)->GetIdentifier() << (*ibody)->IsActive() 
+          << pos << rot 
+          << color
+          << gss.str() << std::endl;
+    }
+  }
+
+  // Loop over all links.  Write information on selected types of links.
+  int l_count = WriteLinksPovray(system, csv);
+
   // Write the output file, including a first line with number of bodies, visual
   // assets, and links.
   std::stringstream header;
@@ -543,37 +1423,509 @@ void WriteShapesPovray(ChSystem*          system,
 
 
 // -----------------------------------------------------------------------------
-// WriteMeshPovray
+// WriteAssetsPovray
 //
-// Write the triangular mesh from the specified OBJ file as a macro in a PovRay
-// include file.
+// Write the table of visualization assets for incremental PovRay output.
+// First line contains the number of bodies and visual assets to follow.
+// A line with information about a body contains:
+//    bodyId
+// A line with information about a visualization asset contains:
+//    bodyIndex, x, y, z, e0, e1, e2, e3, cR, cG, cB, shapeType, [shape Data]
+// where bodyIndex is the position of the body in the system's body list and
+// the asset location and orientation are relative to the body reference frame.
 // -----------------------------------------------------------------------------
-void WriteMeshPovray(const std::string&    obj_filename,
-                     const std::string&    mesh_name,
-                     const std::string&    out_dir,
-                     const ChColor&        col,
-                     const ChVector<>&     pos,
-                     const ChQuaternion<>& rot)
+void WriteAssetsPovray(ChSystem*          system,
+                       const std::string& filename,
+                       const std::string& delim)
 {
-  // Read trimesh from OBJ file
-  geometry::ChTriangleMeshConnected trimesh;
-  trimesh.LoadWavefrontMesh(obj_filename, false, false);
+  vehicle::ChDeferredAssets::Materialize(system);
+
+  CSV_writer csv(delim);
 
-  // Transform vertices.
-  for (int i = 0; i < trimesh.m_vertices.size(); i++)
-    trimesh.m_vertices[i] = pos + rot.Rotate(trimesh.m_vertices[i]);
+  int b_count = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody)
+  {
+    csv << (*ibody)->GetIdentifier() << std::endl;
+    b_count++;
+  }
 
-  // Open output file.
-  std::string pov_filename = out_dir + "/" + mesh_name + ".inc";
-  std::ofstream  ofile(pov_filename.c_str());
+  int a_count = 0;
+  int index = 0;
+  ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody, ++index)
+  {
+    ChColor color = GetBodyColor(*ibody);
 
+    std::vector<ChSharedPtr<ChAsset> >::iterator iasset = (*ibody)->GetAssets().begin();
+    for (; iasset != (*ibody)->GetAssets().end(); ++iasset)
+    {
+      ChSharedPtr<ChVisualization> visual_asset = (*iasset).DynamicCastTo<ChVisualization>();
+      if (visual_asset.IsNull())
+        continue;
+
+      std::stringstream gss;
+      if (!WriteAssetGeometry(visual_asset, delim, gss))
+        continue;
+
+      csv << index
+          << visual_asset->Pos << visual_asset->Rot.Get_A_quaternion()
+          << color
+          << gss.str() << std::endl;
+      a_count++;
+    }
+  }
+
+  std::stringstream header;
+  header << b_count << delim << a_count << delim << std::endl;
+
+  csv.write_to_file(filename, header.str());
+}
+
+
+// -----------------------------------------------------------------------------
+// WriteBodiesPovray
+//
+// Write one frame of incremental PovRay output.
+// First line contains the number of bodies and links to follow.
+// A line with information about a body contains:
+//    bodyId, bodyActive, x, y, z, e0, e1, e2, e3
+// A line with information about a link contains:
+//    linkType, [linkData]
+// -----------------------------------------------------------------------------
+void WriteBodiesPovray(ChSystem*          system,
+                       const std::string& filename,
+                       bool               link_info,
+                       const std::string& delim)
+{
+  CSV_writer csv(delim);
+
+  int b_count = 0;
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody)
+  {
+    const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
+    const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
+
+    csv << (*ibody)->GetIdentifier() << (*ibody)->IsActive() << body_pos << body_rot << std::endl;
+    b_count++;
+  }
+
+  int l_count = link_info ? WriteLinksPovray(system, csv) : 0;
+
+  std::stringstream header;
+  header << b_count << delim << l_count << delim << std::endl;
+
+  csv.write_to_file(filename, header.str());
+}
+
+
+// -----------------------------------------------------------------------------
+// Pose_writer
+//
+// Each row of the binary output file contains the time followed, for each
+// body, by   active, x, y, z, e0, e1, e2, e3   (the body reference frame).
+// -----------------------------------------------------------------------------
+static const int POSE_SIZE = 8;
+
+bool Pose_writer::open(ChSystem*          system,
+                       const std::string& filename)
+{
+  int num_bodies = (int)system->Get_bodylist()->size();
+
+  std::stringstream header;
+  header << "time";
+  for (int i = 0; i < num_bodies; i++) {
+    header << ",active_" << i << ",x_" << i << ",y_" << i << ",z_" << i
+           << ",e0_" << i << ",e1_" << i << ",e2_" << i << ",e3_" << i;
+  }
+
+  m_row.resize(1 + num_bodies * POSE_SIZE);
+  m_num_frames = 0;
+
+  return m_channel.Open(filename, header.str(), vehicle::ChOutputChannel::BINARY);
+}
+
+void Pose_writer::write(ChSystem* system)
+{
+  if (!m_channel.IsOpen())
+    return;
+
+  if (system->Get_bodylist()->size() * POSE_SIZE + 1 != m_row.size()) {
+    GetLog() << "ERROR: the number of bodies changed since the pose file was opened\n";
+    return;
+  }
+
+  double* row = &m_row[0];
+  *row++ = system->GetChTime();
+
+  std::vector<ChBody*>::iterator ibody = system->Get_bodylist()->begin();
+  for (; ibody != system->Get_bodylist()->end(); ++ibody)
+  {
+    const ChVector<>& body_pos = (*ibody)->GetFrame_REF_to_abs().GetPos();
+    const ChQuaternion<>& body_rot = (*ibody)->GetFrame_REF_to_abs().GetRot();
+
+    *row++ = (*ibody)->IsActive() ? 1 : 0;
+    *row++ = body_pos.x;
+    *row++ = body_pos.y;
+    *row++ = body_pos.z;
+    *row++ = body_rot.e0;
+    *row++ = body_rot.e1;
+    *row++ = body_rot.e2;
+    *row++ = body_rot.e3;
+  }
+
+  m_channel.Write(&m_row[0]);
+  m_num_frames++;
+}
+
+void Pose_writer::close()
+{
+  m_channel.Close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Pose_reader
+//
+// The asset table is parsed line by line; the pose file is read in memory as
+// columns (see Pose_writer).
+// -----------------------------------------------------------------------------
+
+// Split a line of the asset table into its fields.
+static void SplitFields(const std::string& line, const std::string& delim, std::vector<std::string>& fields)
+{
+  fields.clear();
+
+  size_t start = 0;
+  while (true) {
+    size_t end = line.find(delim, start);
+    std::string field = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (!field.empty())
+      fields.push_back(field);
+    if (end == std::string::npos)
+      break;
+    start = end + delim.size();
+  }
+}
+
+bool Pose_reader::open(const std::string& assets_filename,
+                       const std::string& poses_filename,
+                       const std::string& delim)
+{
+  if (!open_assets(assets_filename, delim))
+    return false;
+
+  int num_bodies = m_num_bodies;
+  m_num_bodies = 0;
+
+  // Read the body poses.
+  std::string header;
+  if (!vehicle::ChOutputChannel::ReadBinary(poses_filename, header, m_columns))
+    return false;
+
+  if ((int)m_columns.size() != 1 + num_bodies * POSE_SIZE) {
+    GetLog() << "ERROR: " << poses_filename.c_str() << " does not match the asset table\n";
+    m_columns.clear();
+    return false;
+  }
+
+  m_num_bodies = num_bodies;
+
+  return true;
+}
+
+bool Pose_reader::open_assets(const std::string& assets_filename,
+                              const std::string& delim)
+{
+  m_num_bodies = 0;
+  m_identifiers.clear();
+  m_assets.clear();
+  m_columns.clear();
+
+  // The asset table may be compressed (see WriteAssetsPovray).
+  std::string contents;
+  if (!vehicle::ChCompressedFile::ReadAll(assets_filename, contents))
+    return false;
+  std::istringstream ifile(contents);
+
+  std::string line;
+  std::vector<std::string> fields;
+
+  std::getline(ifile, line);
+  SplitFields(line, delim, fields);
+  if (fields.size() < 2) {
+    GetLog() << "ERROR: " << assets_filename.c_str() << " is not a PovRay asset table\n";
+    return false;
+  }
+
+  int num_bodies = std::atoi(fields[0].c_str());
+  int num_assets = std::atoi(fields[1].c_str());
+
+  m_identifiers.resize(num_bodies);
+  for (int i = 0; i < num_bodies && std::getline(ifile, line); i++) {
+    SplitFields(line, delim, fields);
+    m_identifiers[i] = fields.empty() ? "0" : fields[0];
+  }
+
+  while ((int)m_assets.size() < num_assets && std::getline(ifile, line)) {
+    SplitFields(line, delim, fields);
+    if (fields.size() < 12)
+      break;
+
+    Asset asset;
+    asset.body = std::atoi(fields[0].c_str());
+    asset.pos = ChVector<>(std::atof(fields[1].c_str()), std::atof(fields[2].c_str()), std::atof(fields[3].c_str()));
+    asset.rot = ChQuaternion<>(std::atof(fields[4].c_str()), std::atof(fields[5].c_str()),
+                               std::atof(fields[6].c_str()), std::atof(fields[7].c_str()));
+    asset.color = ChColor((float)std::atof(fields[8].c_str()), (float)std::atof(fields[9].c_str()),
+                          (float)std::atof(fields[10].c_str()));
+    asset.type = std::atoi(fields[11].c_str());
+
+    for (size_t k = 12; k < fields.size(); k++) {
+      if (asset.type == collision::TRIANGLEMESH) {
+        asset.name = fields[k];
+        if (asset.name.size() >= 2 && asset.name[0] == '"')
+          asset.name = asset.name.substr(1, asset.name.size() - 2);
+      } else {
+        asset.geometry.push_back(std::atof(fields[k].c_str()));
+      }
+    }
+
+    for (size_t k = 8; k < fields.size(); k++)
+      asset.data += (k > 8) ? delim + fields[k] : fields[k];
+
+    if (asset.body < 0 || asset.body >= num_bodies)
+      break;
+
+    m_assets.push_back(asset);
+  }
+
+  if ((int)m_assets.size() != num_assets) {
+    GetLog() << "ERROR: invalid or truncated asset table " << assets_filename.c_str() << "\n";
+    m_assets.clear();
+    return false;
+  }
+
+  m_num_bodies = num_bodies;
+
+  return true;
+}
+
+bool Pose_reader::get_active(int frame, int body) const
+{
+  return m_columns[1 + body * POSE_SIZE][frame] != 0;
+}
+
+ChVector<> Pose_reader::get_pos(int frame, int body) const
+{
+  const std::vector<double>* pose = &m_columns[1 + body * POSE_SIZE];
+  return ChVector<>(pose[1][frame], pose[2][frame], pose[3][frame]);
+}
+
+ChQuaternion<> Pose_reader::get_rot(int frame, int body) const
+{
+  const std::vector<double>* pose = &m_columns[1 + body * POSE_SIZE];
+  return ChQuaternion<>(pose[4][frame], pose[5][frame], pose[6][frame], pose[7][frame]);
+}
+
+
+// -----------------------------------------------------------------------------
+// CreateAssetShape
+//
+// The shape parameters are those written by WriteAssetGeometry.
+// -----------------------------------------------------------------------------
+ChSharedPtr<ChVisualization> CreateAssetShape(const Pose_reader::Asset& asset,
+                                              const std::string&        mesh_filename)
+{
+  const std::vector<double>& g = asset.geometry;
+  ChSharedPtr<ChVisualization> shape;
+
+  switch (asset.type) {
+  case collision::SPHERE:
+    if (g.size() >= 1) {
+      ChSharedPtr<ChSphereShape> sphere(new ChSphereShape);
+      sphere->GetSphereGeometry().rad = g[0];
+      shape = sphere;
+    }
+    break;
+  case collision::ELLIPSOID:
+    if (g.size() >= 3) {
+      ChSharedPtr<ChEllipsoidShape> ellipsoid(new ChEllipsoidShape);
+      ellipsoid->GetEllipsoidGeometry().rad = ChVector<>(g[0], g[1], g[2]);
+      shape = ellipsoid;
+    }
+    break;
+  case collision::BOX:
+    if (g.size() >= 3) {
+      ChSharedPtr<ChBoxShape> box(new ChBoxShape);
+      box->GetBoxGeometry().Size = ChVector<>(g[0], g[1], g[2]);
+      shape = box;
+    }
+    break;
+  case collision::CAPSULE:
+    if (g.size() >= 2) {
+      ChSharedPtr<ChCapsuleShape> capsule(new ChCapsuleShape);
+      capsule->GetCapsuleGeometry().rad = g[0];
+      capsule->GetCapsuleGeometry().hlen = g[1];
+      shape = capsule;
+    }
+    break;
+  case collision::CYLINDER:
+    if (g.size() >= 7) {
+      ChSharedPtr<ChCylinderShape> cylinder(new ChCylinderShape);
+      cylinder->GetCylinderGeometry().rad = g[0];
+      cylinder->GetCylinderGeometry().p1 = ChVector<>(g[1], g[2], g[3]);
+      cylinder->GetCylinderGeometry().p2 = ChVector<>(g[4], g[5], g[6]);
+      shape = cylinder;
+    }
+    break;
+  case collision::CONE:
+    if (g.size() >= 2) {
+      ChSharedPtr<ChConeShape> cone(new ChConeShape);
+      cone->GetConeGeometry().rad = ChVector<>(g[0], g[1], 0);
+      shape = cone;
+    }
+    break;
+  case collision::ROUNDEDBOX:
+    if (g.size() >= 4) {
+      ChSharedPtr<ChRoundedBoxShape> rbox(new ChRoundedBoxShape);
+      rbox->GetRoundedBoxGeometry().Size = ChVector<>(g[0], g[1], g[2]);
+      rbox->GetRoundedBoxGeometry().radsphere = g[3];
+      shape = rbox;
+    }
+    break;
+  case collision::ROUNDEDCYL:
+    if (g.size() >= 3) {
+      ChSharedPtr<ChRoundedCylinderShape> rcyl(new ChRoundedCylinderShape);
+      rcyl->GetRoundedCylinderGeometry().rad = g[0];
+      rcyl->GetRoundedCylinderGeometry().hlen = g[1];
+      rcyl->GetRoundedCylinderGeometry().radsphere = g[2];
+      shape = rcyl;
+    }
+    break;
+  case collision::TRIANGLEMESH:
+  {
+    std::ifstream test(mesh_filename.c_str());
+    if (mesh_filename.empty() || !test) {
+      GetLog() << "Warning: cannot read the OBJ file of mesh " << asset.name.c_str() << "\n";
+      break;
+    }
+    test.close();
+
+    ChSharedPtr<ChTriangleMeshShape> mesh(new ChTriangleMeshShape);
+    mesh->GetMesh().LoadWavefrontMesh(mesh_filename, false, false);
+    mesh->SetName(asset.name);
+    shape = mesh;
+    break;
+  }
+  default:
+    break;
+  }
+
+  if (!shape.IsNull()) {
+    shape->Pos = asset.pos;
+    shape->Rot.Set_A_quaternion(asset.rot);
+  }
+
+  return shape;
+}
+
+
+// -----------------------------------------------------------------------------
+// ExpandShapesPovray
+//
+// Combine the asset table with each frame in a binary pose file and write the
+// frames in the format of WriteShapesPovray (without links).
+// -----------------------------------------------------------------------------
+bool ExpandShapesPovray(const std::string& assets_filename,
+                        const std::string& poses_filename,
+                        const std::string& out_dir,
+                        const std::string& delim)
+{
+  Pose_reader reader;
+  if (!reader.open(assets_filename, poses_filename, delim))
+    return false;
+
+  int num_bodies = reader.get_num_bodies();
+  int num_frames = reader.get_num_frames();
+  const std::vector<Pose_reader::Asset>& assets = reader.get_assets();
+
+  std::vector<ChVector<> > body_pos(num_bodies);
+  std::vector<ChQuaternion<> > body_rot(num_bodies);
+  std::vector<bool> body_active(num_bodies);
+  char filename[300];
+
+  for (int frame = 0; frame < num_frames; frame++) {
+    CSV_writer csv(delim);
+
+    for (int i = 0; i < num_bodies; i++) {
+      body_pos[i] = reader.get_pos(frame, i);
+      body_rot[i] = reader.get_rot(frame, i);
+      body_active[i] = reader.get_active(frame, i);
+
+      csv << reader.get_identifier(i) << (bool)body_active[i] << body_pos[i] << body_rot[i] << std::endl;
+    }
+
+    for (size_t k = 0; k < assets.size(); k++) {
+      const Pose_reader::Asset& asset = assets[k];
+      int i = asset.body;
+
+      Vector     pos = body_pos[i] + body_rot[i].Rotate(asset.pos);
+      Quaternion rot = body_rot[i] % asset.rot;
+
+      csv << reader.get_identifier(i) << (bool)body_active[i] << pos << rot << asset.data << std::endl;
+    }
+
+    std::stringstream count;
+    count << num_bodies << delim << assets.size() << delim << 0 << delim << std::endl;
+
+    sprintf(filename, "%s/data_%03d.dat", out_dir.c_str(), frame + 1);
+    csv.write_to_file(filename, count.str());
+  }
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// WriteMeshPovray
+//
+// The first line of an exported file holds its key: the hash of the contents
+// of the OBJ file, of the mesh name, the color and the transform. An existing
+// file with the same key is up to date and is not written again. Files are
+// written under a temporary name (unique per node, process and thread) and
+// then renamed, so that concurrent runs exporting the same mesh never see a
+// partial file.
+// -----------------------------------------------------------------------------
+static std::string s_povray_mesh_dir;
+
+void SetPovrayMeshDirectory(const std::string& dir)
+{
+  s_povray_mesh_dir = dir;
+}
+
+static bool PovrayFileCurrent(const std::string& filename, const std::string& key_line)
+{
+  std::ifstream ifile(filename.c_str());
+  std::string line;
+  return std::getline(ifile, line) && line == key_line;
+}
+
+static void WritePovrayMesh(std::ofstream&                            ofile,
+                            const geometry::ChTriangleMeshConnected&  trimesh,
+                            const std::string&                        mesh_name,
+                            const ChColor&                            col,
+                            const ChVector<>&                         pos,
+                            const ChQuaternion<>&                     rot)
+{
   ofile << "#declare " << mesh_name << "_mesh = mesh2 {" << std::endl;
 
-  // Write vertices.
+  // Write vertices, transformed to the specified frame.
   ofile << "vertex_vectors {" << std::endl;
   ofile << trimesh.m_vertices.size();
-  for (int i = 0; i < trimesh.m_vertices.size(); i++) {
-    ChVector<> v = trimesh.m_vertices[i];
+  for (size_t i = 0; i < trimesh.m_vertices.size(); i++) {
+    ChVector<> v = pos + rot.Rotate(trimesh.m_vertices[i]);
     ofile << ",\n<" << v.x << ", " << v.z << ", " << v.y << ">";
   }
   ofile << "\n}" << std::endl;
@@ -581,8 +1933,8 @@ void WriteMeshPovray(const std::string&    obj_filename,
   // Write face connectivity.
   ofile << "face_indices {" << std::endl;
   ofile << trimesh.m_face_v_indices.size();
-  for (int i = 0; i < trimesh.m_face_v_indices.size(); i++) {
-    ChVector<int> face = trimesh.m_face_v_indices[i];
+  for (size_t i = 0; i < trimesh.m_face_v_indices.size(); i++) {
+    const ChVector<int>& face = trimesh.m_face_v_indices[i];
     ofile << ",\n<" << face.x << ", " << face.y << ", " << face.z << ">";
   }
   ofile << "\n}" << std::endl;
@@ -600,6 +1952,68 @@ void WriteMeshPovray(const std::string&    obj_filename,
   ofile << "}" << std::endl;
 }
 
+void WriteMeshPovray(const std::string&    obj_filename,
+                     const std::string&    mesh_name,
+                     const std::string&    out_dir,
+                     const ChColor&        col,
+                     const ChVector<>&     pos,
+                     const ChQuaternion<>& rot)
+{
+  vehicle::ChMappedFile obj_file;
+  if (!obj_file.Open(obj_filename)) {
+    GetLog() << "ERROR: cannot open mesh file " << obj_filename.c_str() << "\n";
+    return;
+  }
+
+  vehicle::ChContentHash hash;
+  hash.Add(obj_file.GetData(), obj_file.GetSize());
+  hash.Add(mesh_name);
+  hash.Add(col.R);
+  hash.Add(col.G);
+  hash.Add(col.B);
+  hash.Add(pos.x);
+  hash.Add(pos.y);
+  hash.Add(pos.z);
+  hash.Add(rot.e0);
+  hash.Add(rot.e1);
+  hash.Add(rot.e2);
+  hash.Add(rot.e3);
+  obj_file.Close();
+
+  std::string key = hash.GetKey();
+  std::string key_line = "// mesh export " + key;
+
+  std::string pov_filename = out_dir + "/" + mesh_name + ".inc";
+  std::string mesh_filename = s_povray_mesh_dir.empty() ? pov_filename
+                                                        : s_povray_mesh_dir + "/" + mesh_name + "_" + key + ".inc";
+
+  std::string suffix = vehicle::ChTempFileSuffix(&hash);
+
+  if (!PovrayFileCurrent(mesh_filename, key_line)) {
+    std::string tmp_filename = mesh_filename + suffix;
+    std::ofstream ofile(tmp_filename.c_str());
+    ofile << key_line << std::endl;
+    WritePovrayMesh(ofile, vehicle::ChMeshCache::GetMesh(obj_filename), mesh_name, col, pos, rot);
+    ofile.close();
+    if (ofile.fail()) {
+      GetLog() << "ERROR: cannot write PovRay mesh file " << mesh_filename.c_str() << "\n";
+      std::remove(tmp_filename.c_str());
+      return;
+    }
+    vehicle::ChReplaceFile(tmp_filename, mesh_filename);
+  }
+
+  // Reference the shared export from the output directory.
+  if (mesh_filename != pov_filename && !PovrayFileCurrent(pov_filename, key_line)) {
+    std::string tmp_filename = pov_filename + suffix;
+    std::ofstream ofile(tmp_filename.c_str());
+    ofile << key_line << std::endl;
+    ofile << "#include \"" << mesh_filename << "\"" << std::endl;
+    ofile.close();
+    vehicle::ChReplaceFile(tmp_filename, pov_filename);
+  }
+}
+
 
 }  // namespace utils
 }  // namespace chrono
@@ -20,6 +20,7 @@
 #define CH_UTILS_INOUT_H
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -27,6 +28,8 @@
 #include "physics/ChSystem.h"
 #include "assets/ChColor.h"
 
+#include "subsys/ChOutputChannel.h"
+
 #include "utils/ChApiUtils.h"
 #include "utils/ChUtilsCreators.h"
 
@@ -39,42 +42,106 @@ namespace utils {
 // CSV_writer
 //
 // Simple class to output to a Comma-Separated Values file.
+//
+// By default, all output is accumulated in memory and written with
+// write_to_file(). Alternatively, the writer can stream its output to a file
+// opened with open(): whenever a row ends (std::endl) and the buffered output
+// exceeds the specified chunk size, the buffer is handed to a background
+// thread which writes it to disk while the next chunk is being filled. At most
+// one chunk is pending, so memory use is bounded by a few times the chunk size.
+//
+// Optionally (set_fast_float), floating point values are written in their
+// shortest form that round-trips exactly, formatted without iostreams.
+//
+// In both cases, the file is compressed if its name has a ".lz4" or ".zst"
+// extension (see vehicle::ChCompressedFile); a streamed file is compressed on
+// the background thread.
+//
+// A streamed file can be continued by a later run (e.g. one resumed from a
+// checkpoint) with resume(), after the output written up to a position
+// obtained with tell() and made readable with flush().
 // -----------------------------------------------------------------------------
+struct CSV_stream;
+
 class CH_UTILS_API CSV_writer {
 public:
-  explicit CSV_writer(const std::string& delim = ",") : m_delim(delim) {}
+  explicit CSV_writer(const std::string& delim = ",") : m_delim(delim), m_fast_float(false), m_stream(0) {}
 
-  CSV_writer(const CSV_writer& source) : m_delim(source.m_delim)
+  CSV_writer(const CSV_writer& source) : m_delim(source.m_delim), m_fast_float(source.m_fast_float), m_stream(0)
   {
     // Note that we do not copy the stream buffer (as then it would be shared!)
     m_ss.copyfmt(source.m_ss);          // copy all data
     m_ss.clear(source.m_ss.rdstate());  // copy the error state
   }
 
-  ~CSV_writer() {}
+  ~CSV_writer() { close(); }
 
   void write_to_file(const std::string& filename,
                      const std::string& header = "")
   {
-    std::ofstream ofile(filename.c_str());
-    ofile << header;
-    ofile << m_ss.str();
-    ofile.close();
+    vehicle::ChCompressedFile ofile;
+    if (!ofile.OpenWrite(filename, vehicle::ChCompressedFile::AUTO, 0, true))
+      return;
+    ofile.Write(header);
+    ofile.Write(m_ss.str());
+    ofile.Close();
   }
 
+  // Stream all subsequent output to the specified file, starting with the
+  // given header. Returns false if the file cannot be opened.
+  bool open(const std::string& filename,
+            const std::string& header = "",
+            size_t             chunk_size = 1 << 20);
+
+  // Stream all subsequent output to the specified file, after its first
+  // 'offset' (uncompressed) bytes, which are kept. Returns false if the file
+  // cannot be opened or holds fewer bytes (it is then left unchanged).
+  bool resume(const std::string& filename,
+              size_t             offset,
+              size_t             chunk_size = 1 << 20);
+
+  // Get the number of (uncompressed) bytes output so far to the file opened
+  // with open() or resume(), including the header.
+  size_t tell() const;
+
+  // Hand all buffered output to the writer thread, which writes it to the file
+  // (flushing the codec) without further delay.
+  void flush();
+
+  // Write all buffered output and close the file opened with open().
+  void close();
+
+  // Get an estimate of the memory used by the output buffered in memory, the
+  // chunk pending on the writer thread and the file buffers, in bytes.
+  size_t memory_footprint() const;
+
+  // Enable or disable shortest round-trip formatting of floating point values.
+  void set_fast_float(bool val) { m_fast_float = val; }
+
   const std::string&  delim() const { return m_delim; }
   std::ostringstream& stream() { return m_ss; }
 
   template <typename T>
   CSV_writer& operator<< (const T& t)                          { m_ss << t << m_delim; return *this; }
 
-  CSV_writer& operator<<(std::ostream& (*t)(std::ostream&))    { m_ss << t; return *this; }
+  CSV_writer& operator<<(const double& t)                      { if (m_fast_float) write_shortest(t, false); else m_ss << t << m_delim; return *this; }
+  CSV_writer& operator<<(const float& t)                       { if (m_fast_float) write_shortest(t, true); else m_ss << t << m_delim; return *this; }
+
+  CSV_writer& operator<<(std::ostream& (*t)(std::ostream&))    { m_ss << t; if (m_stream) end_row(); return *this; }
   CSV_writer& operator<<(std::ios& (*t)(std::ios&))            { m_ss << t; return *this; }
   CSV_writer& operator<<(std::ios_base& (*t)(std::ios_base&))  { m_ss << t; return *this; }
 
 private:
+  // Write a value in its shortest round-trip form (as a float or a double).
+  void write_shortest(double t, bool is_float);
+
+  // Hand the buffered output to the writer thread if it exceeds the chunk size.
+  void end_row();
+
   std::string m_delim;
   std::ostringstream m_ss;
+  bool m_fast_float;
+  CSV_stream* m_stream;
 };
 
 inline CSV_writer& operator<< (CSV_writer& out, const ChVector<>& v)
@@ -109,6 +176,89 @@ void WriteBodies(ChSystem*          system,
                  bool               dump_vel = false,
                  const std::string& delim = ",");
 
+// Binary body state dump.
+// A dump file holds a fixed-size header (magic number, version, number of
+// records, record size and simulation time) followed by one fixed-layout
+// Body_record per selected body, in the order of the system's body list
+// (native byte order).
+struct Body_record {
+  enum { ACTIVE = 1, FIXED = 2 };
+
+  int    identifier;
+  int    flags;         // ACTIVE, FIXED
+  double pos[3];        // reference frame location
+  double rot[4];        // reference frame orientation
+  double pos_dt[3];     // linear velocity (absolute frame)
+  double wvel_loc[3];   // angular velocity (body frame)
+};
+
+// Selection of the bodies of a dump: optionally only the active bodies, only
+// the bodies with the specified identifiers and only the bodies with their
+// reference frame in the specified box (all conditions must hold).
+struct CH_UTILS_API Body_filter {
+  Body_filter() : active_only(false), use_region(false) {}
+
+  // Select only the bodies with the specified identifiers.
+  void set_identifiers(const std::vector<int>& ids);
+
+  // Select only the bodies in the specified axis-aligned box.
+  void set_region(const ChVector<>& min, const ChVector<>& max);
+
+  bool accept(ChBody* body) const;
+
+  bool              active_only;
+  std::vector<int>  identifiers;   // sorted; empty: all identifiers
+  bool              use_region;
+  ChVector<>        region_min;
+  ChVector<>        region_max;
+};
+
+// Write a binary dump of the states of the selected bodies (see Body_record).
+// Returns false if the file cannot be written.
+CH_UTILS_API
+bool WriteBodiesBinary(ChSystem*          system,
+                       const std::string& filename,
+                       const Body_filter& filter = Body_filter());
+
+// Read a binary body state dump. Returns false if the file cannot be read or
+// is not a valid dump.
+CH_UTILS_API
+bool ReadBodiesBinary(const std::string&        filename,
+                      double&                   time,
+                      std::vector<Body_record>& records);
+
+// Asynchronous binary body state dumps. write() captures the states of the
+// selected bodies into a buffer (a copy of a few doubles per body) and hands
+// the buffer to a background thread, which writes the file while the
+// simulation continues. The calling thread only waits if the previous dump is
+// still being written; at most one dump is pending.
+struct Body_dump_stream;
+
+class CH_UTILS_API Body_dump_writer {
+public:
+  Body_dump_writer() : m_stream(0), m_num_records(0) {}
+  ~Body_dump_writer();
+
+  void write(ChSystem*          system,
+             const std::string& filename,
+             const Body_filter& filter = Body_filter());
+
+  // Wait until all dumps are written. Returns false if a file could not be
+  // written since the last call.
+  bool wait();
+
+  // Get the number of bodies in the last dump.
+  int get_num_records() const { return m_num_records; }
+
+private:
+  Body_dump_writer(const Body_dump_writer&);
+  Body_dump_writer& operator=(const Body_dump_writer&);
+
+  Body_dump_stream*  m_stream;
+  std::vector<char>  m_buffer;
+  int                m_num_records;
+};
+
 // Create a CSV file with a checkpoint...
 CH_UTILS_API
 bool WriteCheckpoint(ChSystem*          system,
@@ -119,21 +269,155 @@ CH_UTILS_API
 void ReadCheckpoint(ChSystem*          system,
                     const std::string& filename);
 
+// Write a binary checkpoint file with the same contents as WriteCheckpoint():
+// a fixed-size header, an array of fixed-layout body records and an array of
+// visualization asset records, written with a single call to fwrite. Returns
+// false if a body has an unsupported visualization asset or if the file cannot
+// be written.
+CH_UTILS_API
+bool WriteCheckpointBinary(ChSystem*          system,
+                           const std::string& filename);
+
+// Read a binary checkpoint file (through a read-only memory mapping) and add
+// the bodies it contains to the system. Returns false if the file cannot be
+// mapped or is not a valid binary checkpoint (in which case no bodies are
+// added).
+CH_UTILS_API
+bool ReadCheckpointBinary(ChSystem*          system,
+                          const std::string& filename);
+
 // Write CSV output file for PovRay.
 // Each line contains information about one visualization asset shape, as
 // follows:
 //    index, x, y, z, e0, e1, e2, e3, type, geometry
 // where 'geometry' depends on 'type' (an enum).
+// As for all PovRay output below, the file is compressed if its name has a
+// ".lz4" or ".zst" extension (the frames must then be decompressed, e.g. with
+// the lz4 or zstd tools, before rendering).
 CH_UTILS_API
 void WriteShapesPovray(ChSystem*          system,
                        const std::string& filename,
                        bool               body_info = true,
                        const std::string& delim = ",");
 
+// Incremental PovRay output.
+// Since the visualization assets do not change during a simulation, the asset
+// table can be written only once (WriteAssetsPovray) and each frame reduced to
+// the body poses (and links), either as a CSV file per frame
+// (WriteBodiesPovray) or as rows in a single binary file (Pose_writer). The
+// script renderZ.pov can render the CSV frames directly (set incremental to
+// true); ExpandShapesPovray converts a binary pose file back to a sequence of
+// WriteShapesPovray files (without link information).
+
+// Write the table of visualization assets. The first line contains the number
+// of bodies and assets, followed by one line with the identifier of each body
+// and one line per supported asset shape:
+//    body index, x, y, z, e0, e1, e2, e3, cR, cG, cB, type, geometry
+// where the body index is the position of the body in the system's body list
+// and the asset pose is relative to the body reference frame.
+CH_UTILS_API
+void WriteAssetsPovray(ChSystem*          system,
+                       const std::string& filename,
+                       const std::string& delim = ",");
+
+// Write one frame of incremental PovRay output. The first line contains the
+// number of bodies and links, followed by one line per body:
+//    identifier, active, x, y, z, e0, e1, e2, e3
+// and the link information (as in WriteShapesPovray).
+CH_UTILS_API
+void WriteBodiesPovray(ChSystem*          system,
+                       const std::string& filename,
+                       bool               link_info = true,
+                       const std::string& delim = ",");
+
+// Write the body poses of successive frames to a binary file (see
+// vehicle::ChOutputChannel). Each row holds the time and, for each body,
+// its active flag, location and orientation. The number of bodies in the
+// system must not change after open().
+class CH_UTILS_API Pose_writer {
+public:
+  Pose_writer() : m_num_frames(0) {}
+
+  bool open(ChSystem* system, const std::string& filename);
+  void write(ChSystem* system);
+  void close();
+
+  int get_num_frames() const { return m_num_frames; }
+
+private:
+  vehicle::ChOutputChannel  m_channel;
+  std::vector<double>       m_row;
+  int                       m_num_frames;
+};
+
+// Read an asset table (see WriteAssetsPovray) and a binary pose file (see
+// Pose_writer) for replay. All frames are loaded in memory by open(); the
+// poses of a frame are then available in any order, from any thread.
+class CH_UTILS_API Pose_reader {
+public:
+  struct Asset {
+    int                  body;       // index of the body in the pose file
+    ChVector<>           pos;        // pose relative to the body reference frame
+    ChQuaternion<>       rot;
+    ChColor              color;
+    int                  type;       // shape type (collision::ShapeType)
+    std::vector<double>  geometry;   // shape parameters (as in WriteShapesPovray)
+    std::string          name;       // mesh name (TRIANGLEMESH only)
+    std::string          data;       // color, type and geometry, as read
+  };
+
+  Pose_reader() : m_num_bodies(0) {}
+
+  bool open(const std::string& assets_filename,
+            const std::string& poses_filename,
+            const std::string& delim = ",");
+
+  // Read the asset table only (e.g. for poses received over the network).
+  bool open_assets(const std::string& assets_filename,
+                   const std::string& delim = ",");
+
+  int get_num_bodies() const { return m_num_bodies; }
+  int get_num_frames() const { return m_columns.empty() ? 0 : (int)m_columns[0].size(); }
+
+  const std::string&        get_identifier(int body) const { return m_identifiers[body]; }
+  const std::vector<Asset>& get_assets() const { return m_assets; }
+
+  double get_time(int frame) const { return m_columns[0][frame]; }
+  bool get_active(int frame, int body) const;
+  ChVector<> get_pos(int frame, int body) const;
+  ChQuaternion<> get_rot(int frame, int body) const;
+
+private:
+  int                                 m_num_bodies;
+  std::vector<std::string>            m_identifiers;
+  std::vector<Asset>                  m_assets;
+  std::vector<std::vector<double> >   m_columns;
+};
+
+// Create the visualization shape of an asset read by Pose_reader, relative to
+// its body (NULL if the shape type is not supported). For a triangle mesh, the
+// mesh is loaded from the specified OBJ file (NULL if it cannot be read).
+CH_UTILS_API
+ChSharedPtr<ChVisualization> CreateAssetShape(const Pose_reader::Asset& asset,
+                                              const std::string&        mesh_filename = "");
+
+// Combine the asset table with each frame in the binary pose file and write
+// the frames as [out_dir]/data_001.dat, data_002.dat, ... in the format of
+// WriteShapesPovray (with no links). Returns false if either file cannot be
+// read or if they do not match.
+CH_UTILS_API
+bool ExpandShapesPovray(const std::string& assets_filename,
+                        const std::string& poses_filename,
+                        const std::string& out_dir,
+                        const std::string& delim = ",");
+
 // Write the triangular mesh from the specified OBJ file as a macro in a PovRay
 // include file. The output file will be "[out_dir]/[mesh_name].inc". The mesh
 // vertices will be tramsformed to the frame with specified offset and
-// orientation.
+// orientation. The mesh is taken from the mesh cache (see ChMeshCache), and
+// the file is not written again if it is up to date (same OBJ file contents,
+// color and transform). If a shared mesh directory is set, the mesh is written
+// there, once for all runs, and the output file only includes it.
 CH_UTILS_API
 void WriteMeshPovray(const std::string&    obj_filename,
                      const std::string&    mesh_name,
@@ -142,6 +426,13 @@ void WriteMeshPovray(const std::string&    obj_filename,
                      const ChVector<>&     pos = ChVector<>(0, 0, 0),
                      const ChQuaternion<>& rot = ChQuaternion<>(1, 0, 0, 0));
 
+// Set the directory of the mesh exports shared by the output directories of
+// WriteMeshPovray (default: none, each output directory holds its own). It
+// should be an absolute path, since PovRay resolves included files relative to
+// its working directory. Must be set before meshes are exported.
+CH_UTILS_API
+void SetPovrayMeshDirectory(const std::string& dir);
+
 
 } // namespace utils
 } // namespace chrono
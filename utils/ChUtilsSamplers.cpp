@@ -0,0 +1,353 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parallel Poisson-disk sampler and Sobol sequence.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "subsys/ChThreadPool.h"
+
+#include "utils/ChUtilsSamplers.h"
+
+
+namespace chrono {
+namespace utils {
+
+
+// -----------------------------------------------------------------------------
+// Random generator of the blocks (SplitMix64).
+// -----------------------------------------------------------------------------
+static unsigned long long SplitMix(unsigned long long& state)
+{
+  unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double Uniform(unsigned long long& state)
+{
+  return (SplitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// -----------------------------------------------------------------------------
+// Background grid. Along each sampled axis, the cells are at most the minimum
+// distance over sqrt(d) wide (so a cell holds at most one point), a point can
+// only conflict with the points of the cells within 'range' cells, and the
+// blocks are 'range' cells wide. Along an axis that is not sampled, there is
+// a single cell of zero width and a single block.
+// -----------------------------------------------------------------------------
+struct PDGrid {
+  double       min_dist2;
+  double       lo[3];        // corner of the box
+  int          n[3];         // number of cells
+  double       size[3];      // cell width
+  int          range[3];     // neighbor range, in cells
+  int          block[3];     // block width, in cells
+  int          num_blocks[3];
+
+  std::vector<ChVector<> >     points;   // point of each cell
+  std::vector<unsigned char>   filled;   // 1 if the cell has a point
+
+  int Index(int i, int j, int k) const { return (k * n[1] + j) * n[0] + i; }
+};
+
+static int CellCoord(const PDGrid& grid, int axis, double x)
+{
+  if (grid.size[axis] == 0)
+    return 0;
+  int i = (int)((x - grid.lo[axis]) / grid.size[axis]);
+  return std::max(0, std::min(i, grid.n[axis] - 1));
+}
+
+// Return true if the specified point, in the specified cell, is at least the
+// minimum distance from the points of the neighboring cells.
+static bool IsFree(const PDGrid& grid, const ChVector<>& p, const int c[3])
+{
+  int c0[3], c1[3];
+  for (int a = 0; a < 3; a++) {
+    c0[a] = std::max(c[a] - grid.range[a], 0);
+    c1[a] = std::min(c[a] + grid.range[a], grid.n[a] - 1);
+  }
+
+  for (int k = c0[2]; k <= c1[2]; k++) {
+    for (int j = c0[1]; j <= c1[1]; j++) {
+      for (int i = c0[0]; i <= c1[0]; i++) {
+        int idx = grid.Index(i, j, k);
+        if (grid.filled[idx] && (grid.points[idx] - p).Length2() < grid.min_dist2)
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Sample the specified block by dart throwing. Only the cells of the block are
+// written; the cells read belong to the block or to blocks of other phases.
+static void SampleBlock(PDGrid& grid, const int b[3], unsigned int seed, int attempts)
+{
+  int c0[3], c1[3];
+  int num_cells = 1;
+  for (int a = 0; a < 3; a++) {
+    c0[a] = b[a] * grid.block[a];
+    c1[a] = std::min(c0[a] + grid.block[a], grid.n[a]);
+    num_cells *= c1[a] - c0[a];
+  }
+
+  unsigned long long state = ((unsigned long long)seed << 32) ^ (unsigned long long)((b[2] * grid.num_blocks[1] + b[1]) * grid.num_blocks[0] + b[0]);
+  SplitMix(state);
+
+  int num_darts = attempts * num_cells;
+  for (int t = 0; t < num_darts; t++) {
+    double x[3];
+    int c[3];
+    for (int a = 0; a < 3; a++) {
+      x[a] = grid.lo[a] + (c0[a] + (c1[a] - c0[a]) * Uniform(state)) * grid.size[a];
+      c[a] = CellCoord(grid, a, x[a]);
+    }
+
+    int idx = grid.Index(c[0], c[1], c[2]);
+    if (grid.filled[idx])
+      continue;
+
+    ChVector<> p(x[0], x[1], x[2]);
+    if (!IsFree(grid, p, c))
+      continue;
+
+    grid.points[idx] = p;
+    grid.filled[idx] = 1;
+  }
+}
+
+// A set of blocks of the same phase, sampled by one thread pool task.
+class SampleBlocksTask : public vehicle::ChTask
+{
+public:
+  SampleBlocksTask() : m_grid(0), m_seed(0), m_attempts(0) {}
+
+  virtual void Execute(int worker)
+  {
+    for (size_t i = 0; i < m_blocks.size(); i += 3)
+      SampleBlock(*m_grid, &m_blocks[i], m_seed, m_attempts);
+  }
+
+  PDGrid*           m_grid;
+  unsigned int      m_seed;
+  int               m_attempts;
+  std::vector<int>  m_blocks;    // block indices, 3 per block
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPoissonDiskSampler::ChPoissonDiskSampler(double min_dist, unsigned int seed, int num_threads)
+: m_min_dist(min_dist),
+  m_seed(seed),
+  m_num_threads(num_threads),
+  m_attempts(30)
+{
+  if (m_num_threads <= 0)
+    m_num_threads = vehicle::ChThread::GetNumHardwareThreads();
+}
+
+int ChPoissonDiskSampler::SampleBox(const ChVector<>&         center,
+                                    const ChVector<>&         half_dims,
+                                    std::vector<ChVector<> >& points) const
+{
+  double half[3] = { half_dims.x, half_dims.y, half_dims.z };
+  double mid[3] = { center.x, center.y, center.z };
+
+  int dim = 0;
+  for (int a = 0; a < 3; a++) {
+    if (half[a] > 0)
+      dim++;
+  }
+
+  if (dim == 0 || m_min_dist <= 0) {
+    points.push_back(center);
+    return 1;
+  }
+
+  // Set up the background grid.
+  PDGrid grid;
+  grid.min_dist2 = m_min_dist * m_min_dist;
+
+  double max_size = m_min_dist / std::sqrt((double)dim);
+  int num_cells = 1;
+  for (int a = 0; a < 3; a++) {
+    if (half[a] > 0) {
+      grid.lo[a] = mid[a] - half[a];
+      grid.n[a] = std::max((int)std::ceil(2 * half[a] / max_size), 1);
+      grid.size[a] = 2 * half[a] / grid.n[a];
+      grid.range[a] = (int)std::ceil(m_min_dist / grid.size[a]);
+      grid.block[a] = grid.range[a];
+    } else {
+      grid.lo[a] = mid[a];
+      grid.n[a] = 1;
+      grid.size[a] = 0;
+      grid.range[a] = 0;
+      grid.block[a] = 1;
+    }
+    grid.num_blocks[a] = (grid.n[a] + grid.block[a] - 1) / grid.block[a];
+    num_cells *= grid.n[a];
+  }
+
+  grid.points.resize(num_cells);
+  grid.filled.assign(num_cells, 0);
+
+  int num_tasks = std::max(std::min(m_num_threads, grid.num_blocks[0] * grid.num_blocks[1] * grid.num_blocks[2] / 8), 1);
+  std::vector<SampleBlocksTask> tasks(num_tasks);
+  for (int i = 0; i < num_tasks; i++) {
+    tasks[i].m_grid = &grid;
+    tasks[i].m_seed = m_seed;
+    tasks[i].m_attempts = m_attempts;
+  }
+
+  vehicle::ChThreadPool* pool = (num_tasks > 1) ? new vehicle::ChThreadPool(num_tasks) : 0;
+
+  // Sample the blocks phase by phase, distributing the blocks of a phase
+  // round-robin over the tasks.
+  for (int phase = 0; phase < 8; phase++) {
+    int next = 0;
+    for (int k = phase >> 2 & 1; k < grid.num_blocks[2]; k += 2) {
+      for (int j = phase >> 1 & 1; j < grid.num_blocks[1]; j += 2) {
+        for (int i = phase & 1; i < grid.num_blocks[0]; i += 2) {
+          std::vector<int>& blocks = tasks[next].m_blocks;
+          blocks.push_back(i);
+          blocks.push_back(j);
+          blocks.push_back(k);
+          next = (next + 1) % num_tasks;
+        }
+      }
+    }
+
+    for (int i = 0; i < num_tasks; i++) {
+      if (tasks[i].m_blocks.empty())
+        continue;
+      if (pool)
+        pool->Submit(&tasks[i]);
+      else
+        tasks[i].Execute(0);
+    }
+    if (pool)
+      pool->Wait();
+
+    for (int i = 0; i < num_tasks; i++)
+      tasks[i].m_blocks.clear();
+  }
+
+  delete pool;
+
+  // Collect the points, in cell order.
+  int count = 0;
+  for (int i = 0; i < num_cells; i++) {
+    if (grid.filled[i]) {
+      points.push_back(grid.points[i]);
+      count++;
+    }
+  }
+
+  return count;
+}
+
+
+// -----------------------------------------------------------------------------
+// Sobol direction numbers (Joe and Kuo, new-joe-kuo-6.21201) of dimensions 2
+// and up: degree s of the primitive polynomial, its coefficients a, and the
+// initial direction integers m_1..m_s. The first dimension is the van der
+// Corput sequence in base 2.
+// -----------------------------------------------------------------------------
+struct SobolPolynomial {
+  int           s;
+  unsigned int  a;
+  unsigned int  m[6];
+};
+
+static const SobolPolynomial SOBOL_POLYNOMIALS[ChSobolSequence::MAX_DIMENSION - 1] = {
+  { 1,  0, { 1 } },
+  { 2,  1, { 1, 3 } },
+  { 3,  1, { 1, 3, 1 } },
+  { 3,  2, { 1, 1, 1 } },
+  { 4,  1, { 1, 1, 3, 3 } },
+  { 4,  4, { 1, 3, 5, 13 } },
+  { 5,  2, { 1, 1, 5, 5, 17 } },
+  { 5,  4, { 1, 1, 5, 5, 5 } },
+  { 5,  7, { 1, 1, 7, 11, 19 } },
+  { 5, 11, { 1, 1, 5, 1, 1 } },
+  { 5, 13, { 1, 1, 1, 3, 11 } },
+  { 5, 14, { 1, 3, 5, 5, 31 } },
+  { 6,  1, { 1, 3, 3, 9, 7, 49 } },
+  { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+  { 6, 16, { 1, 3, 1, 13, 27, 49 } }
+};
+
+ChSobolSequence::ChSobolSequence(int dim, unsigned int seed)
+: m_dim(std::max(std::min(dim, (int)MAX_DIMENSION), 0))
+{
+  m_dir.resize(32 * m_dim);
+  m_shift.assign(m_dim, 0);
+
+  for (int j = 0; j < m_dim; j++) {
+    unsigned int* v = &m_dir[32 * j];
+
+    if (j == 0) {
+      for (int k = 0; k < 32; k++)
+        v[k] = 1u << (31 - k);
+      continue;
+    }
+
+    const SobolPolynomial& p = SOBOL_POLYNOMIALS[j - 1];
+    for (int k = 0; k < p.s; k++)
+      v[k] = p.m[k] << (31 - k);
+    for (int k = p.s; k < 32; k++) {
+      v[k] = v[k - p.s] ^ (v[k - p.s] >> p.s);
+      for (int i = 1; i < p.s; i++) {
+        if ((p.a >> (p.s - 1 - i)) & 1)
+          v[k] ^= v[k - i];
+      }
+    }
+  }
+
+  if (seed != 0) {
+    unsigned long long state = seed;
+    for (int j = 0; j < m_dim; j++)
+      m_shift[j] = (unsigned int)(SplitMix(state) >> 32);
+  }
+}
+
+// The point of index n combines the direction numbers of the bits of the Gray
+// code of n (the same set of points as the recursive construction, in a
+// different order within each block of 2^m points).
+void ChSobolSequence::GetPoint(unsigned int index, double* u) const
+{
+  unsigned int gray = index ^ (index >> 1);
+
+  for (int j = 0; j < m_dim; j++) {
+    const unsigned int* v = &m_dir[32 * j];
+    unsigned int x = m_shift[j];
+    for (int k = 0; gray >> k; k++) {
+      if ((gray >> k) & 1)
+        x ^= v[k];
+    }
+    u[j] = x * (1.0 / 4294967296.0);
+  }
+}
+
+
+} // end namespace utils
+} // end namespace chrono
@@ -0,0 +1,128 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parallel Poisson-disk sampler, for generating non-overlapping initial
+// locations of obstacles or granular particles in bulk.
+//
+// The sampled box is covered by a background grid with cells small enough to
+// hold at most one point. The cells are grouped in blocks at least one minimum
+// distance wide, and the blocks in 2^d phases (by the parity of their indices
+// along each sampled axis): blocks of the same phase are separated by at least
+// one block, so their points cannot conflict and they are sampled in parallel,
+// by dart throwing. Each block uses a random generator seeded from the sampler
+// seed and the block index, so the points do not depend on the number of
+// threads.
+//
+// Sobol low-discrepancy sequence in the unit hypercube, for quasi-random
+// sampling of parameter spaces (e.g. Monte-Carlo studies over scenario
+// parameters). The direction numbers are those of Joe and Kuo (2008); the
+// points can be randomized by a digital shift (a random bit pattern per
+// dimension, XOR-ed into the points), which preserves their stratification.
+//
+// =============================================================================
+
+#ifndef CH_UTILS_SAMPLERS_H
+#define CH_UTILS_SAMPLERS_H
+
+#include <vector>
+
+#include "core/ChVector.h"
+
+#include "utils/ChApiUtils.h"
+
+
+namespace chrono {
+namespace utils {
+
+///
+/// Poisson-disk sampler of an axis-aligned box. Generates points at least the
+/// minimum distance apart, with no other structure (blue noise).
+///
+class CH_UTILS_API ChPoissonDiskSampler
+{
+public:
+
+  ChPoissonDiskSampler(
+    double       min_dist,          ///< [in] minimum distance between points
+    unsigned int seed = 1,          ///< [in] seed of the random locations
+    int          num_threads = 0    ///< [in] number of threads (0: number of hardware threads)
+    );
+
+  ~ChPoissonDiskSampler() {}
+
+  /// Set the number of dart throws per grid cell of a block (default: 30).
+  /// More attempts give a denser (closer to maximal) sampling.
+  void SetNumAttempts(int attempts) { m_attempts = attempts; }
+
+  /// Generate points in the box with the specified center and half-dimensions.
+  /// A zero half-dimension samples a rectangle (e.g. obstacle locations at a
+  /// given height) or a segment. The points are appended to the specified
+  /// vector, ordered by grid cell.
+  /// Returns the number of points generated.
+  int SampleBox(
+    const ChVector<>&         center,      ///< [in] center of the box
+    const ChVector<>&         half_dims,   ///< [in] half-dimensions of the box
+    std::vector<ChVector<> >& points       ///< [out] generated points
+    ) const;
+
+private:
+
+  double        m_min_dist;
+  unsigned int  m_seed;
+  int           m_num_threads;
+  int           m_attempts;
+};
+
+///
+/// Sobol sequence in the unit hypercube, with up to MAX_DIMENSION dimensions.
+/// Any point can be generated directly from its index; the first 2^m points
+/// of each dimension are stratified in 2^m equal intervals.
+///
+class CH_UTILS_API ChSobolSequence
+{
+public:
+
+  static const int MAX_DIMENSION = 16;
+
+  ChSobolSequence(
+    int          dim,          ///< [in] number of dimensions (at most MAX_DIMENSION)
+    unsigned int seed = 0      ///< [in] seed of the digital shift (0: no shift)
+    );
+
+  ~ChSobolSequence() {}
+
+  /// Get the number of dimensions (the requested dimension, clamped to
+  /// MAX_DIMENSION).
+  int GetDimension() const { return m_dim; }
+
+  /// Get the point with the specified index, as GetDimension() coordinates in
+  /// [0,1).
+  void GetPoint(
+    unsigned int index,        ///< [in] index of the point in the sequence
+    double*      u             ///< [out] coordinates of the point
+    ) const;
+
+private:
+
+  int                        m_dim;
+  std::vector<unsigned int>  m_dir;     // 32 direction numbers per dimension
+  std::vector<unsigned int>  m_shift;   // digital shift of each dimension
+};
+
+
+} // end namespace utils
+} // end namespace chrono
+
+
+#endif
@@ -16,11 +16,25 @@
 //
 // =============================================================================
 
+#include <cstdlib>
+#include <cstring>
+
+#include "subsys/ChCompressedFile.h"
+#include "subsys/ChMappedFile.h"
+#include "subsys/ChOutputChannel.h"
+#include "subsys/ChSimulationContext.h"
+#include "subsys/ChThreadPool.h"
+
 #include "utils/ChUtilsValidation.h"
 
 namespace chrono {
 namespace utils {
 
+// Files smaller than this are parsed on the calling thread.
+static const size_t PARALLEL_PARSE_BYTES = 1 << 20;
+
+static bool IsBinaryDataFile(const std::string& filename);
+
 
 
 // -----------------------------------------------------------------------------
@@ -29,6 +43,9 @@ bool ChValidation::Process(const std::string& sim_filename,
                            const std::string& ref_filename,
                            char               delim)
 {
+  if (m_streaming && !IsBinaryDataFile(sim_filename) && !IsBinaryDataFile(ref_filename))
+    return ProcessStream(sim_filename, &ref_filename, delim);
+
   // Read the simulation results file.
   m_num_rows = ReadDataFile(sim_filename, delim, m_sim_headers, m_sim_data);
   m_num_cols = m_sim_headers.size();
@@ -69,11 +86,8 @@ bool ChValidation::Process(const std::string& sim_filename,
   m_INF_norms.resize(m_num_cols - 1);
 
   // Calculate norms of the differences.
-  for (size_t col = 0; col < m_num_cols - 1; col++) {
-    m_L2_norms[col] = L2norm(m_sim_data[col + 1] - m_ref_data[col + 1]);
-    m_RMS_norms[col] = RMSnorm(m_sim_data[col + 1] - m_ref_data[col + 1]);
-    m_INF_norms[col] = INFnorm(m_sim_data[col + 1] - m_ref_data[col + 1]);
-  }
+  for (size_t col = 0; col < m_num_cols - 1; col++)
+    CalcNorms(m_sim_data[col + 1], &m_ref_data[col + 1], col);
 
   return true;
 }
@@ -84,6 +98,9 @@ bool ChValidation::Process(const std::string& sim_filename,
 bool ChValidation::Process(const std::string& sim_filename,
                            char               delim)
 {
+  if (m_streaming && !IsBinaryDataFile(sim_filename))
+    return ProcessStream(sim_filename, 0, delim);
+
   // Read the simulation results file.
   m_num_rows = ReadDataFile(sim_filename, delim, m_sim_headers, m_sim_data);
   m_num_cols = m_sim_headers.size();
@@ -94,11 +111,8 @@ bool ChValidation::Process(const std::string& sim_filename,
   m_INF_norms.resize(m_num_cols - 1);
 
   // Calculate norms of the column vectors.
-  for (size_t col = 0; col < m_num_cols - 1; col++) {
-    m_L2_norms[col] = L2norm(m_sim_data[col + 1]);
-    m_RMS_norms[col] = RMSnorm(m_sim_data[col + 1]);
-    m_INF_norms[col] = INFnorm(m_sim_data[col + 1]);
-  }
+  for (size_t col = 0; col < m_num_cols - 1; col++)
+    CalcNorms(m_sim_data[col + 1], 0, col);
 
   return true;
 }
@@ -120,53 +134,579 @@ double ChValidation::INFnorm(const DataVector& v)
    return std::abs(v).max();
 }
 
+// Calculate all three norms of the specified column (or of its difference from
+// the corresponding reference column) in a single pass, without temporaries.
+void ChValidation::CalcNorms(const DataVector& v, const DataVector* ref, size_t col)
+{
+  size_t n = v.size();
+  const double* a = n > 0 ? &v[0] : 0;
+  const double* b = (ref && n > 0) ? &(*ref)[0] : 0;
+
+  double sum = 0;
+  double max = 0;
+
+  if (b) {
+    for (size_t i = 0; i < n; i++) {
+      double d = a[i] - b[i];
+      double ad = std::abs(d);
+      sum += d * d;
+      max = ad > max ? ad : max;
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      double ad = std::abs(a[i]);
+      sum += a[i] * a[i];
+      max = ad > max ? ad : max;
+    }
+  }
+
+  m_L2_norms[col] = std::sqrt(sum);
+  m_RMS_norms[col] = std::sqrt(sum / n);
+  m_INF_norms[col] = max;
+}
+
+
+// -----------------------------------------------------------------------------
+// Parsing of text data files.
+// -----------------------------------------------------------------------------
+
+// Exact powers of ten (the largest ones representable as doubles).
+static const double EXACT_POW10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parse a number starting at 'p'. Numbers with at most 15 significant digits
+// and a small decimal exponent are converted directly (without rounding error,
+// since both the mantissa and the power of ten are exact doubles); all others
+// are handed to strtod. In both cases, the result is the same as with strtod.
+// Returns the end of the number, or 'p' if no number could be parsed.
+static const char* ParseDouble(const char* p, const char* end, double& val)
+{
+  const char* start = p;
+  bool negative = false;
+
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  unsigned long long mantissa = 0;
+  int num_digits = 0;     // significant digits in mantissa
+  int exponent = 0;       // decimal exponent of the mantissa
+  bool any_digits = false;
+  bool exact = true;
+
+  for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    any_digits = true;
+    if (mantissa == 0 && *p == '0')
+      continue;
+    if (num_digits < 15)
+      mantissa = 10 * mantissa + (*p - '0');
+    else
+      exact = false;
+    num_digits++;
+  }
+  if (num_digits > 15)
+    exponent += num_digits - 15;
+
+  if (p < end && *p == '.') {
+    p++;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      any_digits = true;
+      if (mantissa == 0 && *p == '0') {
+        exponent--;
+        continue;
+      }
+      if (num_digits < 15) {
+        mantissa = 10 * mantissa + (*p - '0');
+        exponent--;
+      } else {
+        exact = false;
+      }
+      num_digits++;
+    }
+  }
+
+  if (!any_digits)
+    exact = false;
+
+  if (any_digits && p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool exp_negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+      exp_negative = (*q == '-');
+      q++;
+    }
+    if (q < end && *q >= '0' && *q <= '9') {
+      int e = 0;
+      for (; q < end && *q >= '0' && *q <= '9'; q++) {
+        if (e < 10000)
+          e = 10 * e + (*q - '0');
+      }
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+
+  if (exact && exponent >= -22 && exponent <= 22) {
+    double v = (double)mantissa;
+    v = exponent < 0 ? v / EXACT_POW10[-exponent] : v * EXACT_POW10[exponent];
+    val = negative ? -v : v;
+    return p;
+  }
+
+  // Slow path (long mantissas, large exponents, inf, nan, ...). The mapped
+  // file is not null-terminated, so copy the token first.
+  char buf[128];
+  size_t len = 0;
+  for (const char* q = start; q < end && len < sizeof(buf) - 1; q++, len++) {
+    if (*q == ' ' || *q == '\t' || *q == '\r' || *q == '\n' || *q == ',')
+      break;
+    buf[len] = *q;
+  }
+  buf[len] = 0;
+
+  char* buf_end;
+  val = std::strtod(buf, &buf_end);
+  return start + (buf_end - buf);
+}
+
+// Parse the values of one row (a line without its terminator) into the array
+// vals of num_cols values. Missing or invalid values are left unchanged.
+static void ParseValues(const char* p, const char* end, char delim, double* vals, size_t num_cols)
+{
+  for (size_t col = 0; col < num_cols; col++) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == delim))
+      p++;
+    if (p == end)
+      return;
+    const char* next = ParseDouble(p, end, vals[col]);
+    if (next == p)
+      return;
+    p = next;
+  }
+}
+
+// Return the number of lines in [begin, end), counting a last line without
+// terminator.
+static size_t CountLines(const char* begin, const char* end)
+{
+  size_t count = 0;
+  const char* p = begin;
+  while (p < end) {
+    const char* eol = (const char*)std::memchr(p, '\n', end - p);
+    count++;
+    if (!eol)
+      break;
+    p = eol + 1;
+  }
+  return count;
+}
+
+// Parse all lines in [begin, end) into consecutive rows, starting at first_row.
+// Missing or invalid values are set to zero.
+static void ParseRows(const char* begin, const char* end, char delim, Data& data, size_t first_row)
+{
+  size_t num_cols = data.size();
+  std::vector<double> vals(num_cols);
+
+  size_t row = first_row;
+  const char* p = begin;
+  while (p < end) {
+    const char* eol = (const char*)std::memchr(p, '\n', end - p);
+    const char* line_end = eol ? eol : end;
+    std::fill(vals.begin(), vals.end(), 0.0);
+    ParseValues(p, line_end, delim, num_cols ? &vals[0] : 0, num_cols);
+    for (size_t col = 0; col < num_cols; col++)
+      data[col][row] = vals[col];
+    row++;
+    if (!eol)
+      break;
+    p = eol + 1;
+  }
+}
+
+// A contiguous range of lines, processed by one thread pool task: first the
+// lines are counted, then (once the first row of each range is known) parsed.
+class ParseRowsTask : public vehicle::ChTask
+{
+public:
+  ParseRowsTask() : m_data(0), m_num_rows(0), m_first_row(0) {}
+
+  virtual void Execute(int worker)
+  {
+    if (m_data)
+      ParseRows(m_begin, m_end, m_delim, *m_data, m_first_row);
+    else
+      m_num_rows = CountLines(m_begin, m_end);
+  }
+
+  const char* m_begin;
+  const char* m_end;
+  char        m_delim;
+  Data*       m_data;        // NULL while counting lines
+  size_t      m_num_rows;
+  size_t      m_first_row;
+};
+
+// Split a string of column headers at the specified delimiter.
+static void SplitHeaders(const std::string& line, char delim, Headers& headers)
+{
+  std::stringstream iss(line);
+  std::string col_header = "";
+
+  while (std::getline(iss, col_header, delim))
+    headers.push_back(col_header);
+}
+
+// Skip the first two lines of a text data file and read the line with column
+// headers. Returns the start of the data lines.
+static const char* ReadHeaders(const char* p, const char* end, char delim, Headers& headers)
+{
+  for (int i = 0; i < 3 && p < end; i++) {
+    const char* eol = (const char*)std::memchr(p, '\n', end - p);
+    const char* line_end = eol ? eol : end;
+    if (i == 2) {
+      std::string line(p, line_end);
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+      SplitHeaders(line, delim, headers);
+    }
+    p = eol ? eol + 1 : end;
+  }
+
+  return p;
+}
+
+// Return true if the file contents were written by vehicle::ChOutputChannel in
+// BINARY format.
+static bool IsBinaryDataFile(const char* begin, const char* end)
+{
+  return end - begin >= 6 && std::memcmp(begin, "CHOUT1", 6) == 0;
+}
+
+static bool IsBinaryDataFile(const std::string& filename)
+{
+  vehicle::ChCompressedFile file;
+  if (!file.OpenRead(filename))
+    return false;
+
+  char magic[6];
+  return file.Read(magic, sizeof(magic)) == sizeof(magic) && IsBinaryDataFile(magic, magic + sizeof(magic));
+}
+
+// Map the specified data file in memory or, if it is compressed (see
+// vehicle::ChCompressedFile), decompress it in the specified string. Returns
+// false, and sets an empty range, if the file cannot be read.
+static bool OpenDataFile(const std::string&     filename,
+                         vehicle::ChMappedFile& file,
+                         std::string&           contents,
+                         const char*&           begin,
+                         const char*&           end)
+{
+  begin = 0;
+  end = 0;
+
+  if (!file.Open(filename))
+    return false;
+
+  if (vehicle::ChCompressedFile::DetectCodec(file.GetData(), file.GetSize()) == vehicle::ChCompressedFile::NONE) {
+    begin = file.GetData();
+    end = begin + file.GetSize();
+    return true;
+  }
+
+  file.Close();
+  if (!vehicle::ChCompressedFile::ReadAll(filename, contents))
+    return false;
+
+  begin = contents.data();
+  end = begin + contents.size();
+  return true;
+}
+
+// Read a binary file written by vehicle::ChOutputChannel.
+static size_t ReadBinaryDataFile(const std::string& filename,
+                                 Headers&           headers,
+                                 Data&              data)
+{
+  std::string header;
+  std::vector<std::vector<double> > columns;
+
+  if (!vehicle::ChOutputChannel::ReadBinary(filename, header, columns))
+    return 0;
+
+  SplitHeaders(header, ',', headers);
+
+  data.resize(columns.size());
+  for (size_t col = 0; col < columns.size(); col++) {
+    data[col].resize(columns[col].size());
+    if (!columns[col].empty())
+      std::memcpy(&data[col][0], &columns[col][0], columns[col].size() * sizeof(double));
+  }
+
+  return columns.empty() ? 0 : columns[0].size();
+}
 
 // -----------------------------------------------------------------------------
+// Read the specified data file. Text files have two lines of free text, a line
+// with column headers and one line of values per data point. The file is
+// mapped in memory (or decompressed, if compressed) and, if large enough, its
+// lines are parsed in parallel. Binary files written by vehicle::ChOutputChannel
+// (BINARY format) are also accepted (in this case, the delimiter is ignored).
 // -----------------------------------------------------------------------------
 size_t ChValidation::ReadDataFile(const std::string& filename,
                                   char               delim,
                                   Headers&           headers,
                                   Data&              data)
 {
-  std::ifstream ifile(filename.c_str());
-  std::string   line;
+  headers.clear();
+  data.clear();
+
+  vehicle::ChMappedFile file;
+  std::string contents;
+  const char* begin;
+  const char* end;
+  if (!OpenDataFile(filename, file, contents, begin, end)) {
+    std::cout << "ERROR: cannot read data file " << filename << std::endl;
+    return 0;
+  }
 
-  // Count the number of lines in the file then rewind the input file stream.
-  size_t num_lines = std::count(std::istreambuf_iterator<char>(ifile),
-                                std::istreambuf_iterator<char>(), '\n');
-  ifile.seekg(0, ifile.beg);
+  if (IsBinaryDataFile(begin, end)) {
+    file.Close();
+    return ReadBinaryDataFile(filename, headers, data);
+  }
 
-  size_t num_data_points = num_lines - 3;
+  // Skip the first two lines and read the line with column headers.
+  const char* p = ReadHeaders(begin, end, delim, headers);
 
-  // Skip the first two lines.
-  std::getline(ifile, line);
-  std::getline(ifile, line);
+  size_t num_cols = headers.size();
+  data.resize(num_cols);
 
-  // Read the line with column headers.
-  std::getline(ifile, line);
-  std::stringstream iss1(line);
-  std::string col_header = "";
+  // Split the data lines in ranges starting at line boundaries.
+  int num_tasks = 1;
+  if ((size_t)(end - p) >= PARALLEL_PARSE_BYTES)
+    num_tasks = vehicle::ChThread::GetNumHardwareThreads();
+
+  std::vector<ParseRowsTask> tasks(num_tasks);
+  const char* range_begin = p;
+  for (int i = 0; i < num_tasks; i++) {
+    const char* range_end = end;
+    if (i < num_tasks - 1) {
+      range_end = range_begin + (end - range_begin) / (num_tasks - i);
+      const char* eol = (const char*)std::memchr(range_end, '\n', end - range_end);
+      range_end = eol ? eol + 1 : end;
+    }
+    tasks[i].m_begin = range_begin;
+    tasks[i].m_end = range_end;
+    tasks[i].m_delim = delim;
+    range_begin = range_end;
+  }
 
-  while (std::getline(iss1, col_header, delim))
-    headers.push_back(col_header);
+  if (num_tasks == 1) {
+    size_t num_rows = CountLines(p, end);
+    for (size_t col = 0; col < num_cols; col++)
+      data[col].resize(num_rows);
+    ParseRows(p, end, delim, data, 0);
+    return num_rows;
+  }
 
-  size_t num_cols = headers.size();
+  vehicle::ChThreadPool pool(num_tasks);
+
+  // Count the lines in each range, then parse all ranges.
+  for (int i = 0; i < num_tasks; i++)
+    pool.Submit(&tasks[i]);
+  pool.Wait();
+
+  size_t num_rows = 0;
+  for (int i = 0; i < num_tasks; i++) {
+    tasks[i].m_first_row = num_rows;
+    tasks[i].m_data = &data;
+    num_rows += tasks[i].m_num_rows;
+  }
 
-  // Resize data
-  data.resize(num_cols);
   for (size_t col = 0; col < num_cols; col++)
-    data[col].resize(num_data_points);
+    data[col].resize(num_rows);
 
-  // Read the actual data, one line at a time.
-  size_t row = 0;
-  while (std::getline(ifile, line)) {
-    std::stringstream iss(line);
-    for (size_t col = 0; col < num_cols; col++)
-      iss >> data[col][row];
-    row++;
+  for (int i = 0; i < num_tasks; i++)
+    pool.Submit(&tasks[i]);
+  pool.Wait();
+
+  return num_rows;
+}
+
+
+// -----------------------------------------------------------------------------
+// Sequential reader of the data lines of a text data file. If the file is
+// mapped, pages of the mapping are released once read, so that the memory use
+// stays bounded.
+// -----------------------------------------------------------------------------
+class DataLineReader
+{
+public:
+  DataLineReader(const vehicle::ChMappedFile& file, const char* begin, const char* end, char delim, Headers& headers)
+  : m_file(file),
+    m_begin(begin),
+    m_end(end),
+    m_delim(delim),
+    m_released(0)
+  {
+    m_pos = ReadHeaders(m_begin, m_end, delim, headers);
+  }
+
+  // Parse the next line into vals (missing values are set to zero). Returns
+  // false if there are no more lines.
+  bool Next(std::vector<double>& vals)
+  {
+    if (m_pos >= m_end)
+      return false;
+
+    const char* eol = (const char*)std::memchr(m_pos, '\n', m_end - m_pos);
+    const char* line_end = eol ? eol : m_end;
+    std::fill(vals.begin(), vals.end(), 0.0);
+    ParseValues(m_pos, line_end, m_delim, vals.empty() ? 0 : &vals[0], vals.size());
+    m_pos = eol ? eol + 1 : m_end;
+
+    size_t offset = m_pos - m_begin;
+    if (m_file.IsOpen() && offset - m_released >= RELEASE_BYTES) {
+      m_file.ReleasePages(m_released, offset - m_released);
+      m_released = offset;
+    }
+
+    return true;
+  }
+
+private:
+  static const size_t RELEASE_BYTES = 16 << 20;
+
+  const vehicle::ChMappedFile& m_file;
+  const char*                  m_begin;
+  const char*                  m_end;
+  const char*                  m_pos;
+  char                         m_delim;
+  size_t                       m_released;
+};
+
+// -----------------------------------------------------------------------------
+// Calculate the norms (of the column differences, if a reference file is
+// given) while reading the data files, without storing the data.
+// -----------------------------------------------------------------------------
+bool ChValidation::ProcessStream(const std::string& sim_filename,
+                                  const std::string* ref_filename,
+                                  char               delim)
+{
+  m_sim_headers.clear();
+  m_ref_headers.clear();
+  m_sim_data.clear();
+  m_ref_data.clear();
+  m_num_rows = 0;
+  m_num_cols = 0;
+
+  m_L2_norms.resize(0);
+  m_RMS_norms.resize(0);
+  m_INF_norms.resize(0);
+
+  // Compressed files are decompressed in memory.
+  vehicle::ChMappedFile sim_file;
+  vehicle::ChMappedFile ref_file;
+  std::string sim_contents;
+  std::string ref_contents;
+  const char* sim_begin = 0;
+  const char* sim_end = 0;
+  const char* ref_begin = 0;
+  const char* ref_end = 0;
+
+  if (!OpenDataFile(sim_filename, sim_file, sim_contents, sim_begin, sim_end)) {
+    std::cout << "ERROR: cannot read data file " << sim_filename << std::endl;
+    return false;
+  }
+  if (ref_filename && !OpenDataFile(*ref_filename, ref_file, ref_contents, ref_begin, ref_end)) {
+    std::cout << "ERROR: cannot read data file " << *ref_filename << std::endl;
+    return false;
+  }
+
+  DataLineReader sim_lines(sim_file, sim_begin, sim_end, delim, m_sim_headers);
+  DataLineReader ref_lines(ref_file, ref_begin, ref_end, delim, m_ref_headers);
+
+  m_num_cols = m_sim_headers.size();
+
+  if (ref_filename && m_num_cols != m_ref_headers.size()) {
+    std::cout << "ERROR: the number of columns in the two files is different:" << std::endl;
+    std::cout << "   File " << sim_filename << " has " << m_num_cols << " columns" << std::endl;
+    std::cout << "   File " << *ref_filename << " has " << m_ref_headers.size() << " columns" << std::endl;
+    return false;
+  }
+
+  if (m_num_cols == 0) {
+    std::cout << "ERROR: no data columns in " << sim_filename << std::endl;
+    return false;
+  }
+
+  std::vector<double> sim_vals(m_num_cols);
+  std::vector<double> ref_vals(m_num_cols);
+  std::vector<double> sum(m_num_cols, 0.0);
+  std::vector<double> max(m_num_cols, 0.0);
+  size_t num_ref_rows = 0;
+
+  while (true) {
+    bool sim_row = sim_lines.Next(sim_vals);
+    bool ref_row = ref_filename && ref_lines.Next(ref_vals);
+
+    if (sim_row)
+      m_num_rows++;
+    if (ref_row)
+      num_ref_rows++;
+
+    if (!sim_row || (ref_filename && !ref_row))
+      break;
+
+    // Accumulate the squares and maximum absolute values of all columns,
+    // including the time column (only used in the comparison of the time
+    // sequences).
+    if (ref_filename) {
+      for (size_t col = 0; col < m_num_cols; col++)
+        sim_vals[col] -= ref_vals[col];
+    }
+    for (size_t col = 0; col < m_num_cols; col++) {
+      double d = sim_vals[col];
+      double ad = std::abs(d);
+      sum[col] += d * d;
+      max[col] = ad > max[col] ? ad : max[col];
+    }
+  }
+
+  if (ref_filename) {
+    // Count the remaining rows of the longer file.
+    while (sim_lines.Next(sim_vals))
+      m_num_rows++;
+    while (ref_lines.Next(ref_vals))
+      num_ref_rows++;
+
+    if (m_num_rows != num_ref_rows) {
+      std::cout << "ERROR: the number of rows in the two files is different:" << std::endl;
+      std::cout << "   File " << sim_filename << " has " << m_num_rows << " columns" << std::endl;
+      std::cout << "   File " << *ref_filename << " has " << num_ref_rows << " columns" << std::endl;
+      return false;
+    }
+
+    if (std::sqrt(sum[0]) > 1e-10) {
+      std::cout << "ERROR: time sequences do not match." << std::endl;
+      return false;
+    }
+  }
+
+  m_L2_norms.resize(m_num_cols - 1);
+  m_RMS_norms.resize(m_num_cols - 1);
+  m_INF_norms.resize(m_num_cols - 1);
+
+  for (size_t col = 0; col < m_num_cols - 1; col++) {
+    m_L2_norms[col] = std::sqrt(sum[col + 1]);
+    m_RMS_norms[col] = std::sqrt(sum[col + 1] / m_num_rows);
+    m_INF_norms[col] = max[col + 1];
   }
 
-  return row;
+  return true;
 }
 
 
@@ -257,6 +797,9 @@ void SetValidationDataPath(const std::string& path)
 // Obtain the current path to the directory containing reference validation data.
 const std::string& GetValidationDataPath()
 {
+  vehicle::ChSimulationContext* context = vehicle::ChSimulationContext::GetCurrent();
+  if (context && !context->GetValidationDataPath().empty())
+    return context->GetValidationDataPath();
   return validation_data_path;
 }
 
@@ -264,7 +807,7 @@ const std::string& GetValidationDataPath()
 // directory containing reference validation data.
 std::string GetValidationDataFile(const std::string& filename)
 {
-  return validation_data_path + filename;
+  return GetValidationDataPath() + filename;
 }
 
 }  // namespace utils
@@ -64,9 +64,17 @@ class CH_UTILS_API ChValidation
 {
 public:
 
-  ChValidation() {}
+  ChValidation() : m_streaming(false), m_num_cols(0), m_num_rows(0) {}
   ~ChValidation() {}
 
+  /// Enable or disable streaming (default: disabled).
+  /// In streaming mode, text data files are read one line at a time and the
+  /// norms are accumulated on the fly, so that the memory use does not depend
+  /// on the file sizes. The data tables (GetSimData, GetRefData) are then left
+  /// empty. Binary data files are always read in full, and compressed text
+  /// files are decompressed in memory.
+  void SetStreaming(bool val) { m_streaming = val; }
+
   /// Read the data from the specified files and process it.
   /// Excluding the first column (which must contain identical values in the two
   /// input files), we subtract the data in corresponding columns in the two
@@ -114,7 +122,10 @@ public:
   const DataVector& GetINFnorms() const { return m_INF_norms; }
 
   /// Read the specified data file.
-  /// The file is assumed to be delimited by the specified character.
+  /// The file is assumed to be delimited by the specified character. Binary
+  /// files written by vehicle::ChOutputChannel are also accepted (and the
+  /// delimiter is then ignored), as well as LZ4 or Zstandard compressed files
+  /// (see vehicle::ChCompressedFile).
   /// The return value is the actual number of data points read from the file.
   static size_t ReadDataFile(
     const std::string& filename,        ///< [in] name of the data file
@@ -128,6 +139,13 @@ private:
   double L2norm(const DataVector& v);
   double RMSnorm(const DataVector& v);
   double INFnorm(const DataVector& v);
+  void CalcNorms(const DataVector& v, const DataVector* ref, size_t col);
+
+  bool ProcessStream(const std::string& sim_filename,
+                      const std::string* ref_filename,
+                      char               delim);
+
+  bool   m_streaming;
 
   size_t m_num_cols;
   size_t m_num_rows;
@@ -186,7 +204,8 @@ bool Validate(
 /// (ATTENTION: not thread safe)
 CH_UTILS_API void SetValidationDataPath(const std::string& path);
 
-/// Obtain the current path to the reference validation data directory.
+/// Obtain the current path to the reference validation data directory, from
+/// the current simulation context if it sets one (see ChSimulationContext).
 /// (thread safe)
 CH_UTILS_API const std::string& GetValidationDataPath();
 